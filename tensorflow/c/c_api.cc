@@ -1743,15 +1743,16 @@ void TF_DeleteImportGraphDefResults(TF_ImportGraphDefResults* results) {
   delete results;
 }
 
-static void GraphImportGraphDefLocked(TF_Graph* graph, const GraphDef& def,
+static void GraphImportGraphDefLocked(TF_Graph* graph, GraphDef def,
                                       const TF_ImportGraphDefOptions* opts,
                                       TF_ImportGraphDefResults* tf_results,
                                       TF_Status* status)
     TF_EXCLUSIVE_LOCKS_REQUIRED(graph->mu) {
   const int last_node_id = graph->graph.num_node_ids();
   tensorflow::ImportGraphDefResults results;
-  status->status = tensorflow::ImportGraphDef(opts->opts, def, &graph->graph,
-                                              &graph->refiner, &results);
+  status->status =
+      tensorflow::ImportGraphDef(opts->opts, std::move(def), &graph->graph,
+                                 &graph->refiner, &results);
   if (!status->status.ok()) return;
 
   // Add new nodes to name_map
@@ -1805,7 +1806,7 @@ TF_ImportGraphDefResults* TF_GraphImportGraphDefWithResults(
   }
   auto results = new TF_ImportGraphDefResults();
   mutex_lock l(graph->mu);
-  GraphImportGraphDefLocked(graph, def, options, results, status);
+  GraphImportGraphDefLocked(graph, std::move(def), options, results, status);
   if (!status->status.ok()) {
     delete results;
     return nullptr;
@@ -1836,7 +1837,7 @@ void TF_GraphImportGraphDefWithReturnOutputs(
   }
   TF_ImportGraphDefResults results;
   mutex_lock l(graph->mu);
-  GraphImportGraphDefLocked(graph, def, options, &results, status);
+  GraphImportGraphDefLocked(graph, std::move(def), options, &results, status);
   DCHECK_EQ(results.return_tensors.size(), num_return_outputs);
   memcpy(return_outputs, results.return_tensors.data(),
          num_return_outputs * sizeof(TF_Output));
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/c/eager/c_api_experimental.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/c/eager/c_api_internal.h"
 #include "tensorflow/c/eager/tfe_context_internal.h"
@@ -39,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/platform/casts.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/tsl/distributed_runtime/coordination/coordination_service_agent.h"
 
@@ -600,6 +604,168 @@ TFE_Executor* TFE_ContextGetExecutorForThread(TFE_Context* ctx) {
   return new TFE_Executor(&tensorflow::unwrap(ctx)->Executor());
 }
 
+struct TFE_OpBatch {
+  struct Op {
+    // Holds the name, device and attributes of the op, but no inputs.
+    tensorflow::ImmediateOpPtr prototype;
+    std::vector<TFE_OpBatchValue> inputs;
+    int num_outputs;
+  };
+
+  tensorflow::ImmediateExecutionContext* context;
+  std::vector<Op> ops;
+  std::vector<TFE_OpBatchValue> outputs;
+  // The number of inputs used by the ops.
+  int num_inputs = 0;
+  // Reset for each op when the batch is executed.
+  tensorflow::ImmediateOpPtr op;
+};
+
+namespace {
+
+tensorflow::Status CheckOpBatchValue(const TFE_OpBatch& batch,
+                                     const TFE_OpBatchValue& value) {
+  if (value.op == -1 && value.index >= 0) return ::tensorflow::OkStatus();
+  if (value.op < 0 || value.op >= batch.ops.size() || value.index < 0 ||
+      value.index >= batch.ops[value.op].num_outputs) {
+    return tensorflow::errors::InvalidArgument(
+        "Invalid value (op: ", value.op, ", index: ", value.index,
+        ") for an op batch of ", batch.ops.size(), " ops");
+  }
+  return ::tensorflow::OkStatus();
+}
+
+tensorflow::Status ExecuteOpBatch(
+    TFE_OpBatch* batch,
+    absl::Span<tensorflow::ImmediateExecutionTensorHandle* const> inputs,
+    TFE_TensorHandle** retvals, int num_retvals) {
+  if (inputs.size() < batch->num_inputs) {
+    return tensorflow::errors::InvalidArgument(
+        "The op batch has ", batch->num_inputs, " inputs, but got ",
+        inputs.size());
+  }
+  if (num_retvals != batch->outputs.size()) {
+    return tensorflow::errors::InvalidArgument(
+        "The op batch has ", batch->outputs.size(),
+        " outputs, but got room for ", num_retvals);
+  }
+
+  // The outputs of each op, released when the batch has been executed.
+  std::vector<std::vector<tensorflow::ImmediateExecutionTensorHandle*>>
+      op_outputs(batch->ops.size());
+  auto release_outputs = absl::MakeCleanup([&op_outputs]() {
+    for (const auto& handles : op_outputs) {
+      for (tensorflow::ImmediateExecutionTensorHandle* handle : handles) {
+        if (handle != nullptr) handle->Unref();
+      }
+    }
+  });
+  auto get_value = [&](const TFE_OpBatchValue& value)
+      -> tensorflow::StatusOr<tensorflow::ImmediateExecutionTensorHandle*> {
+    if (value.op == -1) return inputs[value.index];
+    if (value.index >= op_outputs[value.op].size()) {
+      return tensorflow::errors::InvalidArgument(
+          "Op ", value.op, " of the op batch has only ",
+          op_outputs[value.op].size(), " outputs");
+    }
+    return op_outputs[value.op][value.index];
+  };
+
+  tensorflow::ImmediateExecutionOperation* op = batch->op.get();
+  for (int i = 0; i < batch->ops.size(); ++i) {
+    const TFE_OpBatch::Op& batch_op = batch->ops[i];
+    op->Clear();
+    TF_RETURN_IF_ERROR(op->Reset(batch_op.prototype->Name().c_str(),
+                                 batch_op.prototype->DeviceName().c_str()));
+    op->AddAttrs(batch_op.prototype->GetOpAttrs());
+    for (const TFE_OpBatchValue& value : batch_op.inputs) {
+      TF_ASSIGN_OR_RETURN(tensorflow::ImmediateExecutionTensorHandle * input,
+                          get_value(value));
+      TF_RETURN_IF_ERROR(op->AddInput(input));
+    }
+    op_outputs[i].resize(batch_op.num_outputs, nullptr);
+    int num_outputs = batch_op.num_outputs;
+    TF_RETURN_IF_ERROR(batch->context->GetCustomDeviceOpHandler().Execute(
+        op, op_outputs[i].data(), &num_outputs));
+    op_outputs[i].resize(num_outputs);
+  }
+  op->Clear();
+
+  for (int i = 0; i < num_retvals; ++i) {
+    TF_ASSIGN_OR_RETURN(tensorflow::ImmediateExecutionTensorHandle * output,
+                        get_value(batch->outputs[i]));
+    output->Ref();
+    retvals[i] = tensorflow::wrap(output);
+  }
+  return ::tensorflow::OkStatus();
+}
+
+}  // namespace
+
+TFE_OpBatch* TFE_NewOpBatch(TFE_Context* ctx) {
+  TFE_OpBatch* batch = new TFE_OpBatch;
+  batch->context = tensorflow::unwrap(ctx);
+  batch->op.reset(batch->context->CreateOperation());
+  return batch;
+}
+
+void TFE_DeleteOpBatch(TFE_OpBatch* batch) { delete batch; }
+
+int TFE_OpBatchAddOp(TFE_OpBatch* batch, const TFE_Op* op,
+                     const TFE_OpBatchValue* inputs, int num_inputs,
+                     int num_outputs, TF_Status* status) {
+  if (num_outputs < 0) {
+    status->status = tensorflow::errors::InvalidArgument(
+        "Invalid number of outputs: ", num_outputs);
+    return -1;
+  }
+  for (int i = 0; i < num_inputs; ++i) {
+    status->status = CheckOpBatchValue(*batch, inputs[i]);
+    if (!status->status.ok()) return -1;
+  }
+
+  const tensorflow::ImmediateExecutionOperation* source =
+      tensorflow::unwrap(op);
+  tensorflow::ImmediateOpPtr prototype(batch->context->CreateOperation());
+  status->status =
+      prototype->Reset(source->Name().c_str(), source->DeviceName().c_str());
+  if (!status->status.ok()) return -1;
+  prototype->AddAttrs(source->GetOpAttrs());
+
+  for (int i = 0; i < num_inputs; ++i) {
+    if (inputs[i].op == -1) {
+      batch->num_inputs = std::max(batch->num_inputs, inputs[i].index + 1);
+    }
+  }
+  batch->ops.push_back(
+      {std::move(prototype),
+       std::vector<TFE_OpBatchValue>(inputs, inputs + num_inputs),
+       num_outputs});
+  return batch->ops.size() - 1;
+}
+
+void TFE_OpBatchAddOutput(TFE_OpBatch* batch, TFE_OpBatchValue value,
+                          TF_Status* status) {
+  status->status = CheckOpBatchValue(*batch, value);
+  if (!status->status.ok()) return;
+  if (value.op == -1) {
+    batch->num_inputs = std::max(batch->num_inputs, value.index + 1);
+  }
+  batch->outputs.push_back(value);
+}
+
+void TFE_ExecuteOpBatch(TFE_OpBatch* batch, TFE_TensorHandle** inputs,
+                        int num_inputs, TFE_TensorHandle** retvals,
+                        int num_retvals, TF_Status* status) {
+  status->status = ExecuteOpBatch(
+      batch,
+      absl::MakeConstSpan(
+          reinterpret_cast<tensorflow::ImmediateExecutionTensorHandle**>(
+              inputs),
+          num_inputs),
+      retvals, num_retvals);
+}
+
 void TFE_HostAddressSpace(TFE_Context* ctx, TF_Buffer* buf) {
   auto address_space = tensorflow::DeviceNameUtils::AddressSpace(
       tensorflow::unwrap(ctx)->HostCPUParsedName());
@@ -376,6 +376,53 @@ TF_CAPI_EXPORT extern void TFE_ContextSetExecutorForThread(TFE_Context*,
 TF_CAPI_EXPORT extern TFE_Executor* TFE_ContextGetExecutorForThread(
     TFE_Context*);
 
+// -----------------------------------------------------------------------------
+// Op batch APIs.
+//
+// A TFE_OpBatch is a sequence of ops that is set up once and then executed by
+// single TFE_ExecuteOpBatch calls, e.g. to run a small program from a language
+// binding without crossing the C API and setting up a TFE_Op for every op.
+// A TFE_OpBatch must not be used concurrently from several threads.
+typedef struct TFE_OpBatch TFE_OpBatch;
+
+// A value used by the ops of a batch: the `index`th output of the `op`th op
+// added to the batch, or the `index`th input of the batch if `op` is -1.
+typedef struct TFE_OpBatchValue {
+  int op;
+  int index;
+} TFE_OpBatchValue;
+
+TF_CAPI_EXPORT extern TFE_OpBatch* TFE_NewOpBatch(TFE_Context* ctx);
+
+TF_CAPI_EXPORT extern void TFE_DeleteOpBatch(TFE_OpBatch* batch);
+
+// Appends an op with the name, device and attributes of `op` to `batch`, and
+// returns its index in the batch. The inputs of `op`, if any, are ignored: the
+// op takes `num_inputs` `inputs` instead, which refer to the inputs of the
+// batch or to outputs of the ops added before it. `num_outputs` is the number
+// of outputs of the op. `op` is only used during this call: the attributes are
+// copied once, and reused by every execution of the batch.
+TF_CAPI_EXPORT extern int TFE_OpBatchAddOp(TFE_OpBatch* batch, const TFE_Op* op,
+                                           const TFE_OpBatchValue* inputs,
+                                           int num_inputs, int num_outputs,
+                                           TF_Status* status);
+
+// Appends `value` to the outputs of `batch`.
+TF_CAPI_EXPORT extern void TFE_OpBatchAddOutput(TFE_OpBatch* batch,
+                                                TFE_OpBatchValue value,
+                                                TF_Status* status);
+
+// Executes the ops of `batch` in order, on the `num_inputs` `inputs`. On
+// success, `retvals` is filled with new handles to the outputs of the batch,
+// which are owned by the caller. `num_retvals` must be the number of outputs of
+// the batch.
+TF_CAPI_EXPORT extern void TFE_ExecuteOpBatch(TFE_OpBatch* batch,
+                                              TFE_TensorHandle** inputs,
+                                              int num_inputs,
+                                              TFE_TensorHandle** retvals,
+                                              int num_retvals,
+                                              TF_Status* status);
+
 // -----------------------------------------------------------------------------
 // Dynamic cluster API.
 
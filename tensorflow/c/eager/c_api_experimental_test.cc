@@ -368,6 +368,72 @@ void Executor_MatMul_CPU(bool async) {
 TEST(CAPI, Executor_MatMul_CPU) { Executor_MatMul_CPU(false); }
 TEST(CAPI, Executor_MatMul_CPUAsync) { Executor_MatMul_CPU(true); }
 
+TEST(CAPI, OpBatch_MatMul_CPU) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  // Computes (m * m) * m, and m * m.
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  TFE_OpBatch* batch = TFE_NewOpBatch(ctx);
+  const TFE_OpBatchValue square_inputs[] = {{-1, 0}, {-1, 0}};
+  const int square = TFE_OpBatchAddOp(batch, matmul, square_inputs, 2,
+                                      /*num_outputs=*/1, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  const TFE_OpBatchValue cube_inputs[] = {{square, 0}, {-1, 1}};
+  const int cube = TFE_OpBatchAddOp(batch, matmul, cube_inputs, 2,
+                                    /*num_outputs=*/1, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpBatchAddOutput(batch, {cube, 0}, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_OpBatchAddOutput(batch, {square, 0}, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  // Only the ops added before an op can be used as its inputs.
+  const TFE_OpBatchValue invalid_inputs[] = {{cube + 1, 0}};
+  TFE_OpBatchAddOp(batch, matmul, invalid_inputs, 1, 1, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+  TFE_DeleteOp(matmul);
+
+  TFE_TensorHandle* inputs[] = {m, m};
+  TFE_TensorHandle* retvals[2] = {nullptr, nullptr};
+  TFE_ExecuteOpBatch(batch, inputs, 1, retvals, 2, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status));
+
+  // The batch can be executed several times.
+  for (int i = 0; i < 2; ++i) {
+    TFE_ExecuteOpBatch(batch, inputs, 2, retvals, 2, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    float product[4] = {0};
+    TF_Tensor* t = TFE_TensorHandleResolve(retvals[0], status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+    TF_DeleteTensor(t);
+    EXPECT_EQ(37, product[0]);
+    EXPECT_EQ(54, product[1]);
+    EXPECT_EQ(81, product[2]);
+    EXPECT_EQ(118, product[3]);
+    t = TFE_TensorHandleResolve(retvals[1], status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+    TF_DeleteTensor(t);
+    EXPECT_EQ(7, product[0]);
+    EXPECT_EQ(10, product[1]);
+    EXPECT_EQ(15, product[2]);
+    EXPECT_EQ(22, product[3]);
+    TFE_DeleteTensorHandle(retvals[0]);
+    TFE_DeleteTensorHandle(retvals[1]);
+  }
+
+  TFE_DeleteOpBatch(batch);
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 void Deleter(void* data, size_t unused, void* tensor_handle) {
   TFE_DeleteTensorHandle(static_cast<TFE_TensorHandle*>(tensor_handle));
 }
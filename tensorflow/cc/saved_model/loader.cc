@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <memory>
 #include <string>
 #include <unordered_set>
 
@@ -284,12 +285,31 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
-  TF_RETURN_IF_ERROR(
-      ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
-  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
-      session_options, bundle->meta_graph_def, &bundle->session));
+  load_latency_by_stage->GetCell(export_dir, "read_meta_graph")
+      ->Add(GetLatencyMicroseconds(read_start_microseconds));
+
+  // The debug info isn't needed to create the session, so it is read while the
+  // session is created.
+  Status debug_info_status;
+  Status session_status;
+  {
+    std::unique_ptr<Thread> debug_info_thread(Env::Default()->StartThread(
+        ThreadOptions(), "read_saved_model_debug_info",
+        [&export_dir, bundle, &debug_info_status]() {
+          debug_info_status =
+              ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info);
+        }));
+    const uint64 session_start_microseconds = Env::Default()->NowMicros();
+    session_status = LoadMetagraphIntoSession(
+        session_options, bundle->meta_graph_def, &bundle->session);
+    load_latency_by_stage->GetCell(export_dir, "create_session")
+        ->Add(GetLatencyMicroseconds(session_start_microseconds));
+  }
+  TF_RETURN_IF_ERROR(debug_info_status);
+  TF_RETURN_IF_ERROR(session_status);
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return OkStatus();
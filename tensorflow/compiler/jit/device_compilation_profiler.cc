@@ -65,6 +65,10 @@ constexpr int64_t kDefaultCompilationThreshold = 2;
 // Maximum number of ongoing compilations.
 constexpr int64_t kMaxNumOngoingCompilations = kNumAsyncDeviceCompilerThreads;
 
+// Maximum number of compilations waiting for a compiler thread.
+constexpr int64_t kMaxNumQueuedCompilations =
+    kMaxNumQueuedAsyncDeviceCompilations;
+
 }  // namespace
 
 DeviceCompilationProfiler::~DeviceCompilationProfiler() {
@@ -94,6 +98,28 @@ void DeviceCompilationProfiler::RegisterExecution(
   RegisterExecutionForCluster(function, &it->second);
 }
 
+void DeviceCompilationProfiler::RegisterCacheLookup(
+    const NameAttrList& function, bool hit) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  if (hit) {
+    ++it->second.cache_hit_count;
+  } else {
+    ++it->second.cache_miss_count;
+  }
+}
+
+void DeviceCompilationProfiler::RegisterLowering(const NameAttrList& function,
+                                                 int64_t lowering_time_us) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  it->second.cumulative_lowering_time_us += lowering_time_us;
+}
+
 Status DeviceCompilationProfiler::RegisterCompilation(
     const NameAttrList& function, int64_t compile_time_us,
     bool used_persistent_cache) {
@@ -181,9 +207,10 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
 
   if (compile_mode == DeviceCompileMode::kAsync) {
     // Asynchronous compilation is enabled.
-    if (num_ongoing_compilations_ >= kMaxNumOngoingCompilations) {
+    if (num_ongoing_compilations_ + num_queued_compilations_ >=
+        kMaxNumOngoingCompilations + kMaxNumQueuedCompilations) {
       VLOG(2) << "Not asynchronously compiling cluster " << function.name()
-              << " because of too many ongoing compilations.";
+              << " because of too many ongoing and queued compilations.";
       return false;
     }
   }
@@ -198,6 +225,38 @@ bool DeviceCompilationProfiler::ShouldCompileCluster(
   return reached_compile_threshold;
 }
 
+void DeviceCompilationProfiler::RegisterQueuedAsyncCompilation(
+    const NameAttrList& function) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  ++it->second.queued_async_compilation_count;
+  num_queued_compilations_++;
+}
+
+void DeviceCompilationProfiler::RegisterStartedAsyncCompilation(
+    const NameAttrList& function) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  --it->second.queued_async_compilation_count;
+  ++it->second.ongoing_async_compilation_count;
+  num_queued_compilations_--;
+  num_ongoing_compilations_++;
+}
+
+void DeviceCompilationProfiler::RegisterFinishedAsyncCompilation(
+    const NameAttrList& function) {
+  mutex_lock lock(mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  --it->second.ongoing_async_compilation_count;
+  num_ongoing_compilations_--;
+}
+
 void DeviceCompilationProfiler::IncrementOngoingAsyncCompilations() {
   mutex_lock lock(mu_);
   num_ongoing_compilations_++;
@@ -213,6 +272,11 @@ int64_t DeviceCompilationProfiler::GetNumOngoingAsyncCompilations() const {
   return num_ongoing_compilations_;
 }
 
+int64_t DeviceCompilationProfiler::GetNumQueuedAsyncCompilations() const {
+  mutex_lock lock(mu_);
+  return num_queued_compilations_;
+}
+
 std::string DeviceCompilationProfiler::DebugString() const {
   std::string debug_string =
       "DeviceCompilationProfiler {\ncluster_compile_stats: {\n";
@@ -225,7 +289,9 @@ std::string DeviceCompilationProfiler::DebugString() const {
   }
 
   absl::StrAppend(&debug_string, "}\nnum_ongoing_compilations=",
-                  GetNumOngoingAsyncCompilations(), "\n}\n");
+                  GetNumOngoingAsyncCompilations(),
+                  "\nnum_queued_compilations=",
+                  GetNumQueuedAsyncCompilations(), "\n}\n");
 
   return debug_string;
 }
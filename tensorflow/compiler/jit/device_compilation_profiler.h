@@ -41,17 +41,37 @@ class DeviceCompilationProfiler : public ResourceBase {
     // Cumulative time spent compiling the cluster.
     int64_t cumulative_compile_time_us = 0;
 
+    // Cumulative time spent lowering the cluster to HLO, which is part of the
+    // compile time.
+    int64_t cumulative_lowering_time_us = 0;
+
+    // Number of lookups in the compilation cache which found, respectively
+    // didn't find, an executable compiled for the requested signature.
+    int64_t cache_hit_count = 0;
+    int64_t cache_miss_count = 0;
+
     // True if we have decided that this cluster is too dynamic (i.e. its shapes
     // change too frequently) to profitably JIT compile.  Once a cluster is
     // tagged megamorphic, it stays megamorphic forever.
     bool is_megamorphic = false;
 
+    // Number of asynchronous compilations of this cluster that are waiting for
+    // a compiler thread, respectively running on one.
+    int64_t queued_async_compilation_count = 0;
+    int64_t ongoing_async_compilation_count = 0;
+
     std::string DebugString() const {
       return absl::StrCat(
           "DeviceCompilationProfiler::ClusterCompileStats {compile_count=",
           compile_count, ", execution_count=", execution_count,
           ", cumulative_compile_time_us=", cumulative_compile_time_us,
-          ", is_megamorphic=", is_megamorphic, "}");
+          ", cumulative_lowering_time_us=", cumulative_lowering_time_us,
+          ", cache_hit_count=", cache_hit_count,
+          ", cache_miss_count=", cache_miss_count,
+          ", is_megamorphic=", is_megamorphic,
+          ", queued_async_compilation_count=", queued_async_compilation_count,
+          ", ongoing_async_compilation_count=",
+          ongoing_async_compilation_count, "}");
     }
   };
 
@@ -71,6 +91,15 @@ class DeviceCompilationProfiler : public ResourceBase {
   // sets the megamorphic bit accordingly).
   void RegisterExecution(const NameAttrList& function);
 
+  // Registers a lookup of the cluster in the compilation cache, which found a
+  // compiled executable if `hit` is true.
+  void RegisterCacheLookup(const NameAttrList& function, bool hit);
+
+  // Registers that lowering `function` to HLO took `lowering_time_us`, either
+  // as part of a compilation or when reusing a lowering cached by another
+  // compiler.
+  void RegisterLowering(const NameAttrList& function, int64_t lowering_time_us);
+
   // Registers a cluster compilation. Increments the compilation count and
   // accumulates the compile time for the given cluster. Also broadcasts an
   // XlaJitCompilationActivity.
@@ -78,9 +107,17 @@ class DeviceCompilationProfiler : public ResourceBase {
                                      int64_t compile_time_us,
                                      bool used_persistent_cache);
 
+  // Registers that an asynchronous compilation of `function` has been queued,
+  // has started running on a compiler thread, respectively has finished. Also
+  // updates the process-wide counts of queued and ongoing compilations.
+  void RegisterQueuedAsyncCompilation(const NameAttrList& function);
+  void RegisterStartedAsyncCompilation(const NameAttrList& function);
+  void RegisterFinishedAsyncCompilation(const NameAttrList& function);
+
   void IncrementOngoingAsyncCompilations();
   void DecrementOngoingAsyncCompilations();
   int64_t GetNumOngoingAsyncCompilations() const;
+  int64_t GetNumQueuedAsyncCompilations() const;
   std::string DebugString() const override;
 
  private:
@@ -91,6 +128,7 @@ class DeviceCompilationProfiler : public ResourceBase {
       TF_GUARDED_BY(mu_);
 
   int64_t num_ongoing_compilations_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_queued_compilations_ TF_GUARDED_BY(mu_) = 0;
 
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceCompilationProfiler);
 };
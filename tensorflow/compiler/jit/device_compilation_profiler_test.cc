@@ -42,6 +42,36 @@ TEST(DeviceCompilationProfilerTest, RegisterExecution) {
   EXPECT_EQ(stats.execution_count, 5);
 }
 
+TEST(DeviceCompilationProfilerTest, RegisterCacheLookup) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  profiler->RegisterCacheLookup(function, /*hit=*/false);
+  for (int i = 0; i < 3; ++i) {
+    profiler->RegisterCacheLookup(function, /*hit=*/true);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.cache_hit_count, 3);
+  EXPECT_EQ(stats.cache_miss_count, 1);
+}
+
+TEST(DeviceCompilationProfilerTest, RegisterLowering) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  profiler->RegisterLowering(function, 3);
+  profiler->RegisterLowering(function, 5);
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.cumulative_lowering_time_us, 8);
+  EXPECT_EQ(stats.compile_count, 0);
+}
+
 TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -190,6 +220,7 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
   function.set_name("TestFunc");
 
   const int64_t kMaxNumOngoingCompilations = 10;
+  const int64_t kMaxNumQueuedCompilations = 20;
   for (int i = 0; i < kMaxNumOngoingCompilations; ++i) {
     profiler->IncrementOngoingAsyncCompilations();
   }
@@ -199,9 +230,20 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
   EXPECT_TRUE(
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 
-  // Should not allow compilation since this is not the first execution and
-  // we've already reached the maximum number of ongoing compilations allowed.
+  // Should still allow compilation since the compilation can be queued until a
+  // compiler thread frees up.
   profiler->RegisterExecution(function);
+  EXPECT_TRUE(
+      profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
+
+  NameAttrList other_function;
+  other_function.set_name("OtherFunc");
+  for (int i = 0; i < kMaxNumQueuedCompilations; ++i) {
+    profiler->RegisterQueuedAsyncCompilation(other_function);
+  }
+
+  // Should not allow compilation since this is not the first execution and
+  // both the compiler threads and the queue are full.
   EXPECT_FALSE(
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 
@@ -212,6 +254,34 @@ TEST(DeviceCompilationProfilerTest, ShouldCompileClusterAsync) {
       profiler->ShouldCompileCluster(function, DeviceCompileMode::kAsync, 0));
 }
 
+TEST(DeviceCompilationProfilerTest, AsyncCompilationStatsPerCluster) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  profiler->RegisterQueuedAsyncCompilation(function);
+  profiler->RegisterQueuedAsyncCompilation(function);
+  profiler->RegisterStartedAsyncCompilation(function);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.queued_async_compilation_count, 1);
+  EXPECT_EQ(stats.ongoing_async_compilation_count, 1);
+  EXPECT_EQ(profiler->GetNumQueuedAsyncCompilations(), 1);
+  EXPECT_EQ(profiler->GetNumOngoingAsyncCompilations(), 1);
+
+  profiler->RegisterFinishedAsyncCompilation(function);
+  profiler->RegisterStartedAsyncCompilation(function);
+  profiler->RegisterFinishedAsyncCompilation(function);
+
+  TF_ASSERT_OK_AND_ASSIGN(stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.queued_async_compilation_count, 0);
+  EXPECT_EQ(stats.ongoing_async_compilation_count, 0);
+  EXPECT_EQ(profiler->GetNumQueuedAsyncCompilations(), 0);
+  EXPECT_EQ(profiler->GetNumOngoingAsyncCompilations(), 0);
+}
+
 TEST(DeviceCompilationProfilerTest, ShouldCompileClusterLazy) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
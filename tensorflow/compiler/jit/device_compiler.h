@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILER_H_
 
+#include <functional>
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <queue>
 #include <string>
 #include <utility>
 #include <variant>
@@ -159,6 +161,10 @@ class DeviceCompiler : public ResourceBase {
                              OpKernelContext* ctx,
                              DeviceCompilationProfiler* profiler);
 
+  // Runs the highest priority compilation in `pending_async_compilations_` on
+  // the calling thread.
+  void RunNextAsyncCompilation();
+
   std::unique_ptr<DeviceExecutablePersistor<ExecutableType, ClientType>>
       persistor_;
   std::unique_ptr<DeviceCompilerClient<ExecutableType, ClientType>>
@@ -168,6 +174,28 @@ class DeviceCompiler : public ResourceBase {
   // Pool of threads for asynchronous compilations.
   std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
 
+  // An asynchronous compilation waiting for a compiler thread. Compilations of
+  // clusters that have been executed more often run first; ties are broken in
+  // FIFO order.
+  struct PendingAsyncCompilation {
+    int64_t priority;
+    int64_t sequence_number;
+    std::function<void()> compile;
+
+    bool operator<(const PendingAsyncCompilation& other) const {
+      if (priority != other.priority) return priority < other.priority;
+      return sequence_number > other.sequence_number;
+    }
+  };
+
+  // Every entry has a matching closure scheduled on `async_compiler_threads_`,
+  // which runs whichever entry has the highest priority when a thread frees up.
+  mutex pending_async_compilations_mu_;
+  std::priority_queue<PendingAsyncCompilation> pending_async_compilations_
+      TF_GUARDED_BY(pending_async_compilations_mu_);
+  int64_t next_async_compilation_sequence_number_
+      TF_GUARDED_BY(pending_async_compilations_mu_) = 0;
+
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
                       DeviceCompilationClusterSignature::Hash>
@@ -305,6 +333,7 @@ DeviceCompiler<ExecutableType, ClientType>::CompileStrict(
         compile_options, function, args, out_compilation_result.get());
   }
   TF_RETURN_IF_ERROR(cache_value.compilation_status);
+  profiler->RegisterLowering(function, env->NowMicros() - compile_start_us);
   TF_RET_CHECK(cache_value.executable == nullptr);
   TF_RET_CHECK(out_compilation_result->computation != nullptr);
 
@@ -358,10 +387,17 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // Update compilation state in cache.
   cache_->Store(signature, DeviceCompileState::kCompiling, std::nullopt,
                 std::nullopt, std::nullopt);
-  profiler->IncrementOngoingAsyncCompilations();
+  profiler->RegisterQueuedAsyncCompilation(function);
   // Don't move the above code into the thread function as it synchronously
   // updates the async compilation state!
 
+  // Clusters that are executed often benefit the most from being compiled, so
+  // they jump ahead of the rest of the queue.
+  int64_t priority = 0;
+  if (auto stats = profiler->GetCompileStats(function); stats.ok()) {
+    priority = stats->execution_count;
+  }
+
   // When the ThreadPool for the compilation cache is destroyed, it waits for
   // compilations to have finished. This means that both 'entry' and 'this' will
   // be alive for the duration of the compilation.
@@ -369,9 +405,10 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  auto compile = [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
+    profiler->RegisterStartedAsyncCompilation(function);
     // We don't need to lock mu, but do it anyway to satisfy thread safety
     // analysis.
     mutex mu;
@@ -381,16 +418,35 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
                            cache_value, scope, ctx, profiler, &mu);
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
-    profiler->DecrementOngoingAsyncCompilations();
+    profiler->RegisterFinishedAsyncCompilation(function);
     // Update compilation status in cache.
     if (!s.ok()) {
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
-  });
+  };
+  {
+    mutex_lock lock(pending_async_compilations_mu_);
+    pending_async_compilations_.push(
+        {priority, next_async_compilation_sequence_number_++,
+         std::move(compile)});
+  }
+  async_compiler_threads_->Schedule([this] { RunNextAsyncCompilation(); });
   return OkStatus();
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceCompiler<ExecutableType, ClientType>::RunNextAsyncCompilation() {
+  std::function<void()> compile;
+  {
+    mutex_lock lock(pending_async_compilations_mu_);
+    DCHECK(!pending_async_compilations_.empty());
+    compile = pending_async_compilations_.top().compile;
+    pending_async_compilations_.pop();
+  }
+  compile();
+}
+
 template <typename ExecutableType, typename ClientType>
 Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     const XlaCompiler::CompileOptions& compile_options,
@@ -442,6 +498,8 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
           << current_request_count;
 
   DeviceCompileState state = cache_value.compile_state;
+  profiler->RegisterCacheLookup(function,
+                                /*hit=*/state == DeviceCompileState::kCompiled);
   *out_compilation_result = nullptr;
   *out_executable = nullptr;
 
@@ -261,6 +261,10 @@ TEST_F(DeviceCompilerTest, CompileCacheHit) {
   // request.
   EXPECT_EQ(compilation_result, new_compilation_result);
   EXPECT_EQ(xla_executable, new_xla_executable);
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler_->GetCompileStats(fn));
+  EXPECT_EQ(stats.cache_miss_count, 1);
+  EXPECT_EQ(stats.cache_hit_count, 1);
 }
 
 TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
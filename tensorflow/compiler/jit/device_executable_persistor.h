@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -27,9 +31,15 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/version_info.h"
 #include "tensorflow/tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -37,6 +47,11 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// Persisted entries are keyed by the cluster signature, the HLO of the cluster
+// and a fingerprint of the TensorFlow build and device they were compiled for.
+// Entries persisted by a different build or for a different device are evicted
+// from the directory when they are encountered, and the cluster is recompiled.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -45,10 +60,14 @@ class DeviceExecutablePersistor {
     Config() = default;
     explicit Config(absl::string_view persistent_cache_directory,
                     bool disable_strict_signature_checks,
-                    absl::string_view persistence_prefix)
+                    absl::string_view persistence_prefix,
+                    bool async_load = false,
+                    absl::string_view device_fingerprint = "")
         : persistent_cache_directory(persistent_cache_directory),
           disable_strict_signature_checks(disable_strict_signature_checks),
-          persistence_prefix(persistence_prefix) {}
+          persistence_prefix(persistence_prefix),
+          async_load(async_load),
+          device_fingerprint(device_fingerprint) {}
 
     // If non-empty, JIT-compiled executables are saved to and loaded from the
     // specified file system directory path.
@@ -60,12 +79,26 @@ class DeviceExecutablePersistor {
 
     // The cache persistence prefix to use if serializing/deserialzing entries.
     std::string persistence_prefix;
+
+    // If true, the entries of `persistent_cache_directory` are read in the
+    // background as soon as the persistor is created, so that clusters
+    // compiled while the process warms up are loaded from memory. Entries
+    // requested before the background load is done are read from disk.
+    bool async_load = false;
+
+    // Identifies the device executables are compiled for (eg. its platform and
+    // model). It is part of the compiler fingerprint of the persisted entries.
+    std::string device_fingerprint;
   };
 
   DeviceExecutablePersistor(const Config& config,
                             const DeviceType& device_type);
   virtual ~DeviceExecutablePersistor() = default;
 
+  // Blocks until the background load of the persisted entries is done. Returns
+  // immediately if `async_load` is disabled.
+  void WaitForAsyncLoad();
+
   // Returns std::nullopt if persistence is not enabled (i.e.
   // `persistent_cache_directory_` is empty) or if the serialized entry is not
   // found on disk. Otherwise, loads and returns the serialized executable
@@ -95,8 +128,14 @@ class DeviceExecutablePersistor {
   const std::string& persistent_cache_directory() const {
     return persistent_cache_directory_;
   }
+  uint64 compiler_fingerprint() const { return compiler_fingerprint_; }
 
  private:
+  // Returns a fingerprint of the TensorFlow build, the compiler and the device
+  // identified by `device_type` and `device_fingerprint`.
+  static uint64 ComputeCompilerFingerprint(
+      const DeviceType& device_type, absl::string_view device_fingerprint);
+
   // Returns a cache key proto that identifies an entry in the compilation
   // cache.
   XlaSerializedCacheKey BuildSerializedCacheKey(
@@ -123,6 +162,20 @@ class DeviceExecutablePersistor {
   StatusOr<std::optional<XlaSerializedCacheEntry>> TryToReadSerializedEntry(
       const XlaSerializedCacheKey& key) const;
 
+  // Reads all the entries of the persistent cache directory belonging to this
+  // persistor into `preloaded_entries_`, and evicts the stale ones.
+  void LoadPersistedEntries();
+
+  // Returns the preloaded entry for `key`, if any, removing it from
+  // `preloaded_entries_`.
+  std::optional<XlaSerializedCacheEntry> TakePreloadedEntry(
+      const XlaSerializedCacheKey& key) const;
+
+  // Returns true if `entry` was compiled by another TensorFlow build or for
+  // another device, in which case `file_path` it was read from is deleted.
+  bool EvictIfStale(const XlaSerializedCacheEntry& entry,
+                    const std::string& file_path) const;
+
   // Checks if the loaded `entry` matches the expected `key` and `hlo_module`.
   Status VerifyLoadedCacheEntry(const XlaSerializedCacheKey& key,
                                 const xla::HloModuleProto& hlo_module,
@@ -140,6 +193,20 @@ class DeviceExecutablePersistor {
   // specified file system directory path.
   const std::string persistent_cache_directory_;
 
+  const uint64 compiler_fingerprint_;
+
+  // Entries read by the background load, keyed by the string representation of
+  // their key. Entries are removed once they are loaded, as the executables are
+  // then owned by the in-memory compilation cache.
+  mutable mutex preloaded_entries_mu_;
+  mutable absl::flat_hash_map<std::string, XlaSerializedCacheEntry>
+      preloaded_entries_ TF_GUARDED_BY(preloaded_entries_mu_);
+  Notification async_load_done_;
+
+  // Declared last so that the background load is joined before the members it
+  // uses are destroyed.
+  std::unique_ptr<Thread> async_load_thread_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(DeviceExecutablePersistor);
 };
 
@@ -150,7 +217,34 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
     : device_type_(device_type),
       disable_strict_signature_checks_(config.disable_strict_signature_checks),
       persistence_prefix_(config.persistence_prefix),
-      persistent_cache_directory_(config.persistent_cache_directory) {}
+      persistent_cache_directory_(config.persistent_cache_directory),
+      compiler_fingerprint_(
+          ComputeCompilerFingerprint(device_type, config.device_fingerprint)) {
+  if (!config.async_load || persistent_cache_directory_.empty()) {
+    async_load_done_.Notify();
+    return;
+  }
+  async_load_thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "xla_persistent_cache_load", [this] {
+        LoadPersistedEntries();
+        async_load_done_.Notify();
+      }));
+}
+
+template <typename ExecutableType, typename ClientType>
+uint64 DeviceExecutablePersistor<ExecutableType, ClientType>::
+    ComputeCompilerFingerprint(const DeviceType& device_type,
+                               absl::string_view device_fingerprint) {
+  return Fingerprint64(absl::StrCat(TF_VERSION_STRING, "|", TF_GIT_VERSION, "|",
+                                    TF_COMPILER_VERSION, "|",
+                                    device_type.type_string(), "|",
+                                    device_fingerprint));
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType, ClientType>::WaitForAsyncLoad() {
+  async_load_done_.WaitForNotification();
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -185,6 +279,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_fingerprint(compiler_fingerprint_);
   return key;
 }
 
@@ -220,6 +315,81 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType,
+                               ClientType>::LoadPersistedEntries() {
+  XLA_SCOPED_LOGGING_TIMER(absl::StrCat("Loading persisted cache entries from ",
+                                        persistent_cache_directory_));
+  Env* env = Env::Default();
+  std::vector<std::string> file_names;
+  Status status = env->GetChildren(persistent_cache_directory_, &file_names);
+  if (!status.ok()) {
+    VLOG(1) << "Not loading persisted cache entries: " << status;
+    return;
+  }
+  // Only the entries persisted by persistors created for the same device type,
+  // prefix and client are read. The signature and cluster fingerprints of the
+  // key are not known yet.
+  const XlaSerializedCacheKey own_key =
+      BuildSerializedCacheKey(/*signature_hash=*/0, xla::HloModuleProto());
+  const std::string file_suffix = absl::StrCat(
+      own_key.device_type(), own_key.compiled_using_pjrt() ? "__pjrt" : "",
+      ".pb");
+  int num_loaded = 0;
+  for (const std::string& file_name : file_names) {
+    if (!absl::EndsWith(file_name, file_suffix)) continue;
+    const std::string file_path =
+        io::JoinPath(persistent_cache_directory_, file_name);
+    XlaSerializedCacheEntry entry;
+    status = ReadTextOrBinaryProto(env, file_path, &entry);
+    if (!status.ok()) {
+      VLOG(1) << "Skipping persisted cache entry " << file_path << ": "
+              << status;
+      continue;
+    }
+    if (entry.key().prefix() != own_key.prefix() ||
+        entry.key().device_type() != own_key.device_type() ||
+        entry.key().compiled_using_pjrt() != own_key.compiled_using_pjrt() ||
+        EvictIfStale(entry, file_path)) {
+      continue;
+    }
+    const std::string key_str = XlaSerializedCacheKeyToString(entry.key());
+    mutex_lock lock(preloaded_entries_mu_);
+    preloaded_entries_.emplace(key_str, std::move(entry));
+    ++num_loaded;
+  }
+  VLOG(1) << "Loaded " << num_loaded << " persisted cache entries from "
+          << persistent_cache_directory_;
+}
+
+template <typename ExecutableType, typename ClientType>
+std::optional<XlaSerializedCacheEntry>
+DeviceExecutablePersistor<ExecutableType, ClientType>::TakePreloadedEntry(
+    const XlaSerializedCacheKey& key) const {
+  mutex_lock lock(preloaded_entries_mu_);
+  auto it = preloaded_entries_.find(XlaSerializedCacheKeyToString(key));
+  if (it == preloaded_entries_.end()) {
+    return std::nullopt;
+  }
+  std::optional<XlaSerializedCacheEntry> entry = std::move(it->second);
+  preloaded_entries_.erase(it);
+  return entry;
+}
+
+template <typename ExecutableType, typename ClientType>
+bool DeviceExecutablePersistor<ExecutableType, ClientType>::EvictIfStale(
+    const XlaSerializedCacheEntry& entry, const std::string& file_path) const {
+  if (entry.key().compiler_fingerprint() == compiler_fingerprint_) {
+    return false;
+  }
+  VLOG(1) << "Evicting cache entry " << file_path
+          << " persisted by a different TensorFlow build or device.";
+  if (Status status = Env::Default()->DeleteFile(file_path); !status.ok()) {
+    VLOG(1) << "Failed to evict cache entry " << file_path << ": " << status;
+  }
+  return true;
+}
+
 template <typename ExecutableType, typename ClientType>
 Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -316,14 +486,18 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
   XlaSerializedCacheKey cache_key =
       BuildSerializedCacheKey(signature_hash, hlo_module);
 
-  std::optional<XlaSerializedCacheEntry> serialized_entry;
-  {
+  std::optional<XlaSerializedCacheEntry> serialized_entry =
+      TakePreloadedEntry(cache_key);
+  // The entry may not have been read yet by the background load, or may have
+  // been persisted after it.
+  if (!serialized_entry.has_value()) {
     XLA_SCOPED_LOGGING_TIMER(
         absl::StrCat("Try loading serialized cache entry:", signature_str));
     TF_ASSIGN_OR_RETURN(serialized_entry, TryToReadSerializedEntry(cache_key));
   }
 
-  if (!serialized_entry.has_value()) {
+  if (!serialized_entry.has_value() ||
+      EvictIfStale(*serialized_entry, GetFilePath(cache_key))) {
     return std::nullopt;
   }
 
@@ -460,6 +460,8 @@ TEST_F(DeviceExecutionPersistorTest, LoadSerializedHloMismatch) {
       &entry));
   // Change the entry's key to key2.
   *entry.mutable_key() = key2;
+  entry.mutable_key()->set_compiler_fingerprint(
+      persistor.compiler_fingerprint());
   // Write the modified entry to file corresponding to key2.
   TF_ASSERT_OK(WriteBinaryProto(
       Env::Default(), GetFilePath(key2, persistor.persistent_cache_directory()),
@@ -503,6 +505,8 @@ TEST_F(DeviceExecutionPersistorTest, LoadStrictChecksDisabled) {
       &entry));
   // Change the entry's key to key2.
   *entry.mutable_key() = key2;
+  entry.mutable_key()->set_compiler_fingerprint(
+      persistor.compiler_fingerprint());
   // Write the modified entry to file corresponding to key2.
   TF_ASSERT_OK(WriteBinaryProto(
       Env::Default(), GetFilePath(key2, persistor.persistent_cache_directory()),
@@ -606,5 +610,109 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadCompilerFingerprintMismatch) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla_fingerprint");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // A persistor for another device (or TensorFlow build) evicts the entry
+  // instead of loading it.
+  XlaDeviceExecutablePersistor::Config other_config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla_fingerprint", /*async_load=*/false,
+      /*device_fingerprint=*/"other_device");
+  XlaDeviceExecutablePersistor other_persistor(other_config,
+                                               DefaultXlaOptions().device_type);
+  EXPECT_NE(persistor.compiler_fingerprint(),
+            other_persistor.compiler_fingerprint());
+
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, _)).Times(0);
+  auto loaded_executable = other_persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  EXPECT_FALSE(loaded_executable.has_value());
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  EXPECT_FALSE(Env::Default()->FileExists(GetFilePath(key, cache_dir_)).ok());
+}
+
+TEST_F(DeviceExecutionPersistorTest, AsyncLoad) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "async_load");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_ASSERT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // A stale entry, persisted by another TensorFlow build.
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  auto stale_key =
+      CreateCacheKey(/*signature_hash=*/456, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  TF_ASSERT_OK_AND_ASSIGN(auto stale_entry,
+                          ReadCacheEntryFromFile(key, cache_dir));
+  *stale_entry.mutable_key() = stale_key;
+  stale_entry.mutable_key()->set_compiler_fingerprint(
+      persistor.compiler_fingerprint() + 1);
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(),
+                                GetFilePath(stale_key, cache_dir),
+                                stale_entry));
+
+  XlaDeviceExecutablePersistor::Config async_config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla", /*async_load=*/true);
+  XlaDeviceExecutablePersistor async_persistor(async_config,
+                                               DefaultXlaOptions().device_type);
+  async_persistor.WaitForAsyncLoad();
+
+  // The stale entry is evicted by the background load, while the other entry
+  // is served from memory once its file is gone.
+  EXPECT_FALSE(
+      Env::Default()->FileExists(GetFilePath(stale_key, cache_dir)).ok());
+  TF_ASSERT_OK(Env::Default()->DeleteFile(GetFilePath(key, cache_dir)));
+
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = async_persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  EXPECT_TRUE(loaded_executable.has_value());
+  EXPECT_TRUE(loaded_executable->ok());
+
+  // Preloaded entries are only handed out once.
+  EXPECT_FALSE(async_persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+}
+
 }  // namespace
 }  // namespace tensorflow
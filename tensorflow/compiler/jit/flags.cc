@@ -137,6 +137,17 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_clustering_fuel,
            "Places an artificial limit on the number of ops marked as "
            "eligible for clustering."),
+      Flag("tf_xla_clustering_profile",
+           &mark_for_compilation_flags->tf_xla_clustering_profile,
+           "(experimental) Path to a StepStats proto collected from a previous "
+           "run.  If set, clusters whose nodes took less than "
+           "--tf_xla_min_cluster_benefit_micros in that profile are not "
+           "compiled."),
+      Flag("tf_xla_min_cluster_benefit_micros",
+           &mark_for_compilation_flags->tf_xla_min_cluster_benefit_micros,
+           "(experimental) Minimum total profiled execution time of a "
+           "cluster, in microseconds, for it to be compiled.  Only used "
+           "with --tf_xla_clustering_profile."),
       Flag("tf_xla_disable_deadness_safety_checks_for_debugging",
            &mark_for_compilation_flags
                 ->tf_xla_disable_deadness_safety_checks_for_debugging,
@@ -162,7 +173,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_prefix",
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
-           "\"xla_compile_cache\"")};
+           "\"xla_compile_cache\""),
+      Flag("tf_xla_persistent_cache_async_load",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_async_load,
+           "If true, the entries of the persistent cache directory are loaded "
+           "in the background when the XLA compile cache is created, instead "
+           "of being read when each cluster is first compiled. Defaults to "
+           "true.")};
   flag_list->insert(flag_list->end(), new_flags.begin(), new_flags.end());
 }
 
@@ -205,6 +222,8 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
       std::numeric_limits<int64_t>::max();
+  mark_for_compilation_flags->tf_xla_clustering_profile = "";
+  mark_for_compilation_flags->tf_xla_min_cluster_benefit_micros = 1;
   mark_for_compilation_flags
       ->tf_xla_disable_deadness_safety_checks_for_debugging = false;
   mark_for_compilation_flags
@@ -214,6 +233,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_persistent_cache_async_load = true;
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -222,6 +242,7 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_share_function_lowerings = false;
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = false;
@@ -284,6 +305,12 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_share_function_lowerings",
+            &ops_flags->tf_xla_share_function_lowerings,
+            "If true, the lowerings of functions to HLO are cached in a cache "
+            "shared by all the compilers of the process, so that identical "
+            "clusters, e.g. the same cluster in several models, are only "
+            "lowered once."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -77,6 +77,16 @@ struct MarkForCompilationPassFlags {
   // eligible for clustering.
   int64_t tf_xla_clustering_fuel;
 
+  // If non-empty, path to a StepStats proto (binary or text) collected from a
+  // previous run of the graph.  Clusters whose nodes spent less than
+  // tf_xla_min_cluster_benefit_micros in total in that profile are not
+  // compiled.  Ignored for operators explicitly marked for compilation.
+  string tf_xla_clustering_profile;
+
+  // Minimum total profiled execution time, in microseconds, of a cluster for
+  // it to be compiled.  Only used if tf_xla_clustering_profile is set.
+  int64_t tf_xla_min_cluster_benefit_micros;
+
   // If tf_xla_disable_deadness_safety_checks_for_debugging is set to true then
   // we do not do deadness related safety checks.  This is unsound in general,
   // but can be used as a debugging aid.
@@ -103,6 +113,10 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If true, the entries of `tf_xla_persistent_cache_directory` are loaded in
+  // the background when the XLA compile cache is created. Defaults to true.
+  bool tf_xla_persistent_cache_async_load;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -125,6 +139,9 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If true, the lowerings of functions to HLO are shared by all the compilers
+  // of the process, so that identical clusters are only lowered once.
+  bool tf_xla_share_function_lowerings;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
@@ -33,6 +33,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
@@ -55,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -62,6 +64,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -123,6 +126,12 @@ class MarkForCompilationPassImpl {
     std::atomic<int64_t>* fuel;
 
     bool dump_graphs;
+
+    // If non-null, the execution time in microseconds of each node, keyed by
+    // node name, as recorded in a previous run.  Clusters that spent less than
+    // `min_cluster_benefit_micros` in total are not worth compiling.
+    const absl::flat_hash_map<string, int64_t>* node_time_micros = nullptr;
+    int64_t min_cluster_benefit_micros = 0;
   };
 
   MarkForCompilationPassImpl(DebugOptions debug_options, Graph* graph,
@@ -959,6 +968,22 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   // * have more than debug_options_.xla_min_cluster_size elements (applicable
   //   only if compilation is enabled, otherwise there will be no such
   //   candidates).
+  //
+  // If an execution profile is available, clusters that spent less than
+  // debug_options_.min_cluster_benefit_micros in it are additionally skipped
+  // unless they are explicitly marked for compilation.
+  absl::flat_hash_map<int, int64_t> cluster_time_micros;
+  if (debug_options_.node_time_micros != nullptr) {
+    for (Node* n : compilation_candidates_) {
+      auto it = debug_options_.node_time_micros->find(n->name());
+      int64_t& time =
+          cluster_time_micros[GetClusterForNode(n)->cycles_graph_node_id()];
+      if (it != debug_options_.node_time_micros->end()) {
+        time += it->second;
+      }
+    }
+  }
+
   for (Node* n : compilation_candidates_) {
     Cluster* cluster = GetClusterForNode(n);
     TF_ASSIGN_OR_RETURN(bool should_compile_cluster,
@@ -967,6 +992,18 @@ Status MarkForCompilationPassImpl::CreateClusters() {
       continue;
     }
 
+    if (debug_options_.node_time_micros != nullptr &&
+        !cluster->is_xla_compile_attr_true()) {
+      int64_t time = cluster_time_micros[cluster->cycles_graph_node_id()];
+      if (time < debug_options_.min_cluster_benefit_micros) {
+        VLOG(3) << "Not clustering " << n->name() << " in "
+                << cluster->DebugString(*graph_) << ": profiled time " << time
+                << "us is below the benefit threshold of "
+                << debug_options_.min_cluster_benefit_micros << "us";
+        continue;
+      }
+    }
+
     // We assume that functional If and While nodes have at least
     // min_cluster_size non-trivial nodes in them.  It would be more principled
     // to (recursively) verify this fact, but that's probably not worth the
@@ -1884,6 +1921,61 @@ std::atomic<int64_t>* GetPointerToFuel(int64_t initial_value) {
 
   return fuel;
 }
+
+// Returns the per-node execution times recorded in the StepStats proto at
+// `path`, summed over all devices.  Profiles are loaded once per path.
+StatusOr<const absl::flat_hash_map<string, int64_t>*> GetNodeTimeProfile(
+    const string& path) {
+  static mutex* mu = new mutex;
+  static auto* profiles =
+      new absl::flat_hash_map<string,
+                              absl::flat_hash_map<string, int64_t>>;
+  mutex_lock lock(*mu);
+  auto it = profiles->find(path);
+  if (it != profiles->end()) {
+    return &it->second;
+  }
+
+  StepStats step_stats;
+  Status status = ReadBinaryProto(Env::Default(), path, &step_stats);
+  if (!status.ok()) {
+    step_stats.Clear();
+    Status text_status = ReadTextProto(Env::Default(), path, &step_stats);
+    if (!text_status.ok()) {
+      return errors::InvalidArgument(
+          "Could not read XLA clustering profile ", path, ": ",
+          status.message());
+    }
+  }
+
+  absl::flat_hash_map<string, int64_t> node_time_micros;
+  for (const DeviceStepStats& device_stats : step_stats.dev_stats()) {
+    // GPU stream stats duplicate the ops already recorded on the device.
+    if (absl::StrContains(device_stats.device(), "/stream:")) continue;
+    for (const NodeExecStats& node_stats : device_stats.node_stats()) {
+      node_time_micros[node_stats.node_name()] +=
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+    }
+  }
+  VLOG(1) << "Loaded XLA clustering profile " << path << " with "
+          << node_time_micros.size() << " nodes";
+  return &profiles->emplace(path, std::move(node_time_micros)).first->second;
+}
+
+// Fills in the profile-guided clustering fields of `debug_options` from
+// `flags`.
+Status SetProfileDebugOptions(
+    const MarkForCompilationPassFlags& flags,
+    MarkForCompilationPassImpl::DebugOptions* debug_options) {
+  if (flags.tf_xla_clustering_profile.empty()) {
+    return OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(debug_options->node_time_micros,
+                      GetNodeTimeProfile(flags.tf_xla_clustering_profile));
+  debug_options->min_cluster_benefit_micros =
+      flags.tf_xla_min_cluster_benefit_micros;
+  return OkStatus();
+}
 }  // anonymous namespace
 
 Status MarkForCompilationPass::Run(
@@ -1902,6 +1994,7 @@ Status MarkForCompilationPass::Run(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  TF_RETURN_IF_ERROR(SetProfileDebugOptions(*flags, &debug_options));
 
   return MarkForCompilation(options, debug_options);
 }
@@ -1921,6 +2014,7 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
+  TF_RETURN_IF_ERROR(SetProfileDebugOptions(*flags, &debug_options));
 
   return MarkForCompilation(options, debug_options);
 }
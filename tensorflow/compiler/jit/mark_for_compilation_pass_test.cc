@@ -48,9 +48,12 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_def_builder_util.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -142,6 +145,52 @@ TEST(XlaCompilationTest, Chains) {
   EXPECT_TRUE(clusters.find("D") == clusters.cend());
 }
 
+TEST(XlaCompilationTest, ProfileGuidedClustering) {
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  {
+    GraphDefBuilder builder(GraphDefBuilder::kFailImmediately);
+    Node* a =
+        ops::SourceOp("UncompilableNullary", builder.opts().WithName("A"));
+    Node* b = ops::UnaryOp("Relu", a, builder.opts().WithName("B"));
+    Node* c = ops::UnaryOp("Relu", b, builder.opts().WithName("C"));
+    Node* d =
+        ops::UnaryOp("UncompilableUnary", c, builder.opts().WithName("D"));
+    Node* e = ops::UnaryOp("Relu", d, builder.opts().WithName("E"));
+    ops::UnaryOp("Relu", e, builder.opts().WithName("F"));
+    TF_EXPECT_OK(GraphDefBuilderToGraph(builder, graph.get()));
+  }
+
+  // Only E and F spent a meaningful amount of time in the profile, so the B-C
+  // cluster is not worth compiling.
+  StepStats step_stats;
+  DeviceStepStats* device_stats = step_stats.add_dev_stats();
+  device_stats->set_device("/job:localhost/replica:0/task:0/device:CPU:0");
+  for (const auto& [name, micros] :
+       std::vector<std::pair<string, int64_t>>{{"B", 1}, {"E", 40}}) {
+    NodeExecStats* node_stats = device_stats->add_node_stats();
+    node_stats->set_node_name(name);
+    node_stats->set_op_start_rel_micros(0);
+    node_stats->set_op_end_rel_micros(micros);
+  }
+  string profile_path =
+      io::JoinPath(testing::TmpDir(), "profile_guided_clustering.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), profile_path, step_stats));
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  MarkForCompilationPassFlags saved_flags = *flags;
+  flags->tf_xla_clustering_profile = profile_path;
+  flags->tf_xla_min_cluster_benefit_micros = 10;
+  Status status = MarkForCompilationPassTestHelper::MarkForCompilation(&graph);
+  *flags = saved_flags;
+  TF_ASSERT_OK(status);
+
+  auto clusters = GetClusters(*graph);
+  EXPECT_EQ(2, clusters.size());
+  EXPECT_EQ(clusters["E"], clusters["F"]);
+  EXPECT_TRUE(clusters.find("B") == clusters.cend());
+  EXPECT_TRUE(clusters.find("C") == clusters.cend());
+}
+
 TEST(XlaCompilationTest, UncompilableCycles) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
   {
@@ -26,6 +26,11 @@ namespace tensorflow {
 // The number of compiler threads to use for asynchronous device compilation.
 inline constexpr int64_t kNumAsyncDeviceCompilerThreads = 10;
 
+// The number of asynchronous device compilations that may wait for a free
+// compiler thread. Further compilation requests are dropped (and the cluster
+// keeps running on the fallback path) until the queue drains.
+inline constexpr int64_t kMaxNumQueuedAsyncDeviceCompilations = 20;
+
 enum class DeviceCompileMode {
   kLazy,
   kStrict,
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compiler_options_util.h"
 
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 
 namespace tensorflow {
@@ -65,6 +66,10 @@ XlaCompiler::Options GenerateCompilerOptions(
   // passthrough parameters without performing a copy.
   options.alias_passthrough_params =
       !has_ref_vars && !platform_info.is_on_xla_device();
+  // The shared lowerings assume the default shape determination functions.
+  options.share_function_lowerings =
+      GetXlaOpsCommonFlags()->tf_xla_share_function_lowerings &&
+      !platform_info.xla_device_metadata();
 
   LogOptions(options);
   return options;
@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
@@ -48,8 +49,17 @@ using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
-    const XlaDeviceExecutablePersistor::Config& persistor_config,
+    XlaDeviceExecutablePersistor::Config persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
+  // Executables persisted for another model of device must not be loaded.
+  if (local_client != nullptr) {
+    persistor_config.device_fingerprint =
+        absl::StrCat(local_client->platform()->Name(), "|",
+                     local_client->backend()
+                         .default_stream_executor()
+                         ->GetDeviceDescription()
+                         .model_str());
+  }
   return new XlaDeviceCompiler(
       std::make_unique<XlaDeviceExecutablePersistor>(
           std::move(persistor_config), compilation_device_type),
@@ -61,7 +71,10 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
   PjRtDeviceExecutablePersistor::Config persistor_config(
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
-      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix);
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_async_load,
+      absl::StrCat(pjrt_client->platform_name(), "|",
+                   pjrt_client->platform_version()));
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -164,7 +177,8 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
   XlaDeviceExecutablePersistor::Config persistor_config(
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
-      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix);
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_async_load);
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
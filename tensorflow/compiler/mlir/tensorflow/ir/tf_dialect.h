@@ -20,7 +20,10 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_MLIR_TENSORFLOW_IR_TF_DIALECT_H_
 
 #include <functional>
+#include <map>
+#include <mutex>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
 #include "mlir/IR/Dialect.h"  // from @llvm-project
@@ -31,6 +34,35 @@ namespace TF {
 
 class TensorFlowRegistryEffectInterfaceFallback;
 
+// Remembers the results of constant folding through the fold hook, so that
+// identical ops, e.g. repeated across the many functions of a large model, are
+// only evaluated once. The key holds the opaque pointers of the op name,
+// attributes, operand values and result types, which are all uniqued in the
+// MLIRContext owning the dialect. It is thread safe, as nested pass managers
+// fold the functions in parallel.
+class ConstantFoldCache {
+ public:
+  using Key = std::vector<const void *>;
+
+  bool Lookup(const Key &key, SmallVectorImpl<Attribute> &results) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = results_.find(key);
+    if (it == results_.end()) return false;
+    results.assign(it->second.begin(), it->second.end());
+    return true;
+  }
+
+  void Insert(Key key, ArrayRef<Attribute> results) {
+    std::lock_guard<std::mutex> lock(mu_);
+    results_.emplace(std::move(key),
+                     SmallVector<Attribute, 1>(results.begin(), results.end()));
+  }
+
+ private:
+  std::mutex mu_;
+  std::map<Key, SmallVector<Attribute, 1>> results_;
+};
+
 class TensorFlowDialect final : public Dialect {
  public:
   explicit TensorFlowDialect(MLIRContext *context);
@@ -96,6 +128,9 @@ class TensorFlowDialect final : public Dialect {
 
   static bool HasConstantFoldHook() { return constant_fold_hook_; }
 
+  // Results of the constant fold hook for ops of this dialect's context.
+  ConstantFoldCache &GetConstantFoldCache() { return constant_fold_cache_; }
+
   // Provides a hook for op interface.
   void *getRegisteredInterfaceForOp(mlir::TypeID interface,
                                     mlir::OperationName opName) override;
@@ -103,6 +138,8 @@ class TensorFlowDialect final : public Dialect {
  private:
   static ConstantFoldHook constant_fold_hook_;
 
+  ConstantFoldCache constant_fold_cache_;
+
   // Storage for a custom fallback interface.
   TensorFlowRegistryEffectInterfaceFallback *fallback_effect_op_interface_;
 };
@@ -16,10 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tensorflow/transforms/constant_fold.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
 #include "mlir/IR/OpDefinition.h"  // from @llvm-project
 #include "mlir/Support/LogicalResult.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_dialect.h"
 #include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
 #include "tensorflow/compiler/mlir/tensorflow/ir/tf_types.h"
 #include "tensorflow/compiler/mlir/tensorflow/transforms/constant_fold_utils.h"
@@ -122,12 +124,41 @@ LogicalResult ConstantFoldFallbackHook(
     inputs.push_back(input.cast<ElementsAttr>());
   }
 
+  // Identical ops are only evaluated once, which also spares the functions
+  // folded in parallel from waiting on the evaluation mutex below. Operands
+  // and result types are separated by a null pointer, as op names with
+  // variadic operands or results don't fix their count.
+  auto* dialect = llvm::dyn_cast_or_null<TensorFlowDialect>(inst->getDialect());
+  ConstantFoldCache::Key key;
+  SmallVector<Attribute> constants;
+  if (dialect) {
+    key.reserve(3 + operands.size() + inst->getNumResults());
+    key.push_back(inst->getName().getAsOpaquePointer());
+    key.push_back(inst->getAttrDictionary().getAsOpaquePointer());
+    for (Attribute operand : operands) {
+      key.push_back(operand.getAsOpaquePointer());
+    }
+    key.push_back(nullptr);
+    for (Type type : inst->getResultTypes()) {
+      key.push_back(type.getAsOpaquePointer());
+    }
+    if (dialect->GetConstantFoldCache().Lookup(key, constants)) {
+      results.assign(constants.begin(), constants.end());
+      return success();
+    }
+  }
+
   // Avoid overlapping folds with the same context.
   // TODO(jpienaar): Avoid using global context & mutex here.
   static auto* mu = new tensorflow::mutex();
-  tensorflow::mutex_lock l(*mu);
-  SmallVector<Attribute> constants;
-  LogicalResult status = EvaluateOperation(inst, inputs, constants);
+  LogicalResult status = failure();
+  {
+    tensorflow::mutex_lock l(*mu);
+    status = EvaluateOperation(inst, inputs, constants);
+  }
+  if (succeeded(status) && dialect) {
+    dialect->GetConstantFoldCache().Insert(std::move(key), constants);
+  }
   results.assign(constants.begin(), constants.end());
   return status;
 }
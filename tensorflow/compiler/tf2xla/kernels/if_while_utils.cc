@@ -56,9 +56,10 @@ absl::InlinedVector<int, 5> ConvertCompileTimeConstArgumentsToConst(
           (bounds.ok() && bounds->has_value())) {
         StatusOr<Tensor> values_are_dynamic = expression.ResolveDynamism();
         bool all_values_are_static = false;
-        if (values_are_dynamic.ok()) {
-          xla::Literal literal =
-              HostTensorToLiteral(values_are_dynamic.value()).value();
+        xla::BorrowingLiteral literal;
+        if (values_are_dynamic.ok() &&
+            HostTensorToBorrowingLiteral(values_are_dynamic.value(), &literal)
+                .ok()) {
           all_values_are_static = literal.IsAll(0);
         }
 
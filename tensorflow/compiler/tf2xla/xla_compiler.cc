@@ -69,6 +69,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/tpu/tpu_defs.h"
 #include "tensorflow/core/util/dump_graph.h"
@@ -798,6 +799,95 @@ Status XlaCompiler::CompileSingleOp(
   return compile_with_old_bridge();
 }
 
+namespace {
+
+// Lowerings shared by the compilers with Options::share_function_lowerings set.
+class SharedFunctionLowerings {
+ public:
+  using Key = std::pair<string, std::vector<XlaCompiler::Argument>>;
+
+  static SharedFunctionLowerings* Global() {
+    static SharedFunctionLowerings* lowerings = new SharedFunctionLowerings;
+    return lowerings;
+  }
+
+  bool Lookup(const Key& key, XlaCompiler::CompilationResult* result) {
+    mutex_lock lock(mu_);
+    auto it = results_.find(key);
+    if (it == results_.end()) return false;
+    *result = it->second;
+    return true;
+  }
+
+  void Store(Key key, const XlaCompiler::CompilationResult& result) {
+    mutex_lock lock(mu_);
+    // Bounds the memory held by the computations of the process.
+    if (results_.size() >= kMaxSharedFunctionLowerings) return;
+    results_.emplace(std::move(key), result);
+  }
+
+ private:
+  static constexpr int kMaxSharedFunctionLowerings = 4096;
+
+  struct KeyHash {
+    uint64 operator()(const Key& key) const {
+      return std::hash<string>()(key.first);
+    }
+  };
+
+  mutex mu_;
+  std::unordered_map<Key, XlaCompiler::CompilationResult, KeyHash> results_
+      TF_GUARDED_BY(mu_);
+};
+
+// Returns a fingerprint of `fdef` and of the definitions of the functions it
+// calls.
+uint64 FingerprintFunction(const FunctionLibraryDefinition& flib_def,
+                           const FunctionDef& fdef) {
+  uint64 fingerprint = FunctionDefHash(fdef);
+  const FunctionLibraryDefinition reachable =
+      flib_def.ReachableDefinitions(fdef);
+  std::vector<string> names = reachable.ListFunctionNames();
+  std::sort(names.begin(), names.end());
+  for (const string& name : names) {
+    fingerprint =
+        Hash64Combine(fingerprint, FunctionDefHash(*reachable.Find(name)));
+  }
+  return fingerprint;
+}
+
+}  // namespace
+
+std::optional<std::pair<string, std::vector<XlaCompiler::Argument>>>
+XlaCompiler::SharedLoweringKey(const CompileOptions& options,
+                               const NameAttrList& fn_name_attrs,
+                               const string& function_id,
+                               absl::Span<const Argument> args) const {
+  if (!options_.share_function_lowerings) return std::nullopt;
+  // Functions created by this compiler, and functions which send to or
+  // receive from channels of this compiler, can't be shared.
+  if (local_flib_def_->Find(fn_name_attrs.name()) != nullptr ||
+      !channels_.empty() || !host_compute_sends_.empty() ||
+      !host_compute_recvs_.empty() || !host_compute_control_output_.empty()) {
+    return std::nullopt;
+  }
+  const FunctionDef* fdef = options_.flib_def->Find(fn_name_attrs.name());
+  if (fdef == nullptr) return std::nullopt;
+  return std::make_pair(
+      absl::StrCat(options_.device_type.type_string(), ";",
+                   options_.graph_def_version, ";",
+                   options_.allow_cpu_custom_calls, ";",
+                   options_.alias_passthrough_params, ";",
+                   options.use_tuple_arg, ";",
+                   options.return_updated_values_for_all_resources, ";",
+                   options.always_return_tuple, ";",
+                   options.is_entry_computation, ";",
+                   options.add_token_input_output, ";",
+                   options.alias_resource_update, ";", function_id, ";",
+                   FingerprintFunction(*options_.flib_def, *fdef)),
+      std::vector<Argument>(args.begin(), args.end()));
+}
+
 Status XlaCompiler::CompileFunction(
     const XlaCompiler::CompileOptions& options,
     const NameAttrList& fn_name_attrs,
@@ -813,6 +903,14 @@ Status XlaCompiler::CompileFunction(
     *result = it->second;
     return OkStatus();
   }
+  auto shared_key =
+      SharedLoweringKey(options, fn_name_attrs, function_id, args);
+  if (shared_key.has_value() &&
+      SharedFunctionLowerings::Global()->Lookup(*shared_key, result)) {
+    VLOG(1) << "Reusing the shared lowering of " << function_id;
+    cache_[{function_id, arg_vector}] = *result;
+    return OkStatus();
+  }
 
   const FunctionBody* fbody;
   const ConfigProto* config = nullptr;
@@ -923,6 +1021,12 @@ Status XlaCompiler::CompileFunction(
   VLOG(1) << "====================================================";
 
   cache_[{function_id, arg_vector}] = *result;
+  // The lowering can't be shared if it allocated channels of this compiler.
+  if (shared_key.has_value() && channels_.empty() &&
+      host_compute_sends_.empty() && host_compute_recvs_.empty() &&
+      host_compute_control_output_.empty()) {
+    SharedFunctionLowerings::Global()->Store(std::move(*shared_key), *result);
+  }
   return OkStatus();
 }
 
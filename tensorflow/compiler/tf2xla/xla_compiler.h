@@ -201,6 +201,16 @@ class XlaCompiler {
 
     // Enable detailed logging of compilation metadata.
     bool detailed_logging = true;
+
+    // If true, CompileFunction() looks up and stores its results in a cache
+    // shared by all the compilers of the process that set this option, keyed
+    // by a fingerprint of the function and of the functions it calls, the
+    // arguments and the compile options. Identical function bodies, e.g. the
+    // same cluster in several models, are then only lowered once.
+    //
+    // Must only be set if the `shape_determination_fns` are the defaults, as
+    // they are not part of the key.
+    bool share_function_lowerings = false;
   };
 
   // Argument for compiling a single op.
@@ -362,6 +372,12 @@ class XlaCompiler {
   FunctionLibraryRuntime* local_flib_runtime_;  // owned by local_pflr_.
   FunctionLibraryRuntime* flib_runtime_;        // owned by pflr_.
 
+  // Returns the key of the lowering of the function in the cache shared by the
+  // compilers of the process, or nullopt if it can't be shared.
+  std::optional<std::pair<string, std::vector<Argument>>> SharedLoweringKey(
+      const CompileOptions& options, const NameAttrList& fn_name_attrs,
+      const string& function_id, absl::Span<const Argument> args) const;
+
   struct SignatureHash {
     uint64 operator()(
         const std::pair<string, std::vector<Argument>>& signature) const;
@@ -1028,6 +1028,42 @@ TEST_F(XlaCompilerTest, LocalFunctionWithWrongArgumentsFail) {
       << status.message();
 }
 
+// Tests that compilers sharing function lowerings only lower a function once.
+TEST_F(XlaCompilerTest, SharedFunctionLowerings) {
+  TF_ASSERT_OK(flib_def_->AddFunctionDef(test::function::XTimesTwo()));
+  NameAttrList name_attr;
+  name_attr.set_name("XTimesTwo");
+  AttrValue type;
+  type.set_type(DT_FLOAT);
+  (*name_attr.mutable_attr())["T"] = type;
+
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2});
+
+  XlaCompiler::Options options = DefaultOptions();
+  options.share_function_lowerings = true;
+  XlaCompiler compiler0(options);
+  XlaCompiler compiler1(options);
+  XlaCompiler unshared_compiler(DefaultOptions());
+  XlaCompiler::CompilationResult result0, result1, unshared_result;
+  TF_ASSERT_OK(compiler0.CompileFunction(XlaCompiler::CompileOptions(),
+                                         name_attr, args, &result0));
+  TF_ASSERT_OK(compiler1.CompileFunction(XlaCompiler::CompileOptions(),
+                                         name_attr, args, &result1));
+  TF_ASSERT_OK(unshared_compiler.CompileFunction(
+      XlaCompiler::CompileOptions(), name_attr, args, &unshared_result));
+  EXPECT_EQ(result0.computation, result1.computation);
+  EXPECT_NE(result0.computation, unshared_result.computation);
+
+  // Different arguments are lowered again.
+  args[0].shape = TensorShape({3});
+  TF_ASSERT_OK(compiler1.CompileFunction(XlaCompiler::CompileOptions(),
+                                         name_attr, args, &result1));
+  EXPECT_NE(result0.computation, result1.computation);
+}
+
 FunctionDef SliceFn() {
   return FunctionDefHelper::Define(
       // Name
@@ -568,8 +568,11 @@ Status ReadVariableInputTensor(const Tensor& tensor, DataType type,
   }
 
   if (!variable->IsOverwritten() && expression->constant_value()) {
-    TF_ASSIGN_OR_RETURN(xla::Literal literal,
-                        HostTensorToLiteral(*expression->constant_value()));
+    // Borrows the buffer of the constant instead of copying it, the builder
+    // makes its own copy.
+    xla::BorrowingLiteral literal;
+    TF_RETURN_IF_ERROR(
+        HostTensorToBorrowingLiteral(*expression->constant_value(), &literal));
     *value = xla::ConstantLiteral(ctx->builder(), literal);
     return OkStatus();
   }
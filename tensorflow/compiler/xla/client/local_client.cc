@@ -492,7 +492,7 @@ StatusOr<int> LocalClient::ReplicaNumberToDeviceOrdinal(int replica_number) {
 }
 
 StatusOr<TransferToServerResponse> LocalClient::TransferToLocalServer(
-    const ::xla::BorrowingLiteral& literal, int device_ordinal) {
+    const LiteralSlice& literal, int device_ordinal) {
   const ::xla::Shape& shape = literal.shape();
 
   TF_ASSIGN_OR_RETURN(::xla::ScopedShapedBuffer shaped_buffer,
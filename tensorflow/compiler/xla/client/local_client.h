@@ -169,9 +169,11 @@ class LocalClient : public Client {
       const LiteralSlice& literal, int device_ordinal,
       se::DeviceMemoryAllocator* allocator = nullptr);
 
-  // Transfer the BorrowingLiteral to the device with the given ordinal.
+  // Transfer the literal to the device with the given ordinal. The data is
+  // transferred directly from the buffers of `literal`, which may be borrowed
+  // from the caller, e.g. by a BorrowingLiteral.
   StatusOr<TransferToServerResponse> TransferToLocalServer(
-      const ::xla::BorrowingLiteral& literal, int device_ordinal);
+      const LiteralSlice& literal, int device_ordinal);
 
   // Copy the data from the device contained in the given ShapedBuffer and
   // return as a Literal.
@@ -59,6 +59,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 #endif
   opts.set_xla_cpu_use_xla_runtime(false);
   opts.set_xla_cpu_sparse_cuda_threads(0);
+  opts.set_xla_cpu_parallel_codegen_split_count(0);
 
   opts.set_xla_cpu_enable_fast_math(false);
   // Disable forms of fast math that have caused users problems in the past.
@@ -79,8 +80,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   // flag.
   opts.set_xla_gpu_enable_cublaslt(false);
 
-  // TODO(b/258036887): Enable once CUDA Graphs are fully supported.
-  opts.set_xla_gpu_cuda_graph_level(0);
+  opts.set_xla_gpu_cuda_graph_level(2);
   opts.set_xla_gpu_cuda_graph_instantiation_threshold(2);
   opts.set_xla_gpu_enable_persistent_temp_buffers(false);
   opts.set_xla_gpu_cuda_graph_capture_threshold(2);
@@ -134,6 +134,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_enable_triton_gemm(true);
   opts.set_xla_gpu_enable_cudnn_int8x32_convolution_reordering(true);
   opts.set_xla_gpu_triton_gemm_any(false);
+  opts.set_xla_gpu_enable_priority_fusion(false);
 
   // Moving reduce-scatter out of while loops can increase memory footprint, so
   // turning it off by default.
@@ -516,6 +517,13 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_cpu_sparse_cuda_threads(),
       "Sets number fo CUDA threads for sparse GPU acceleration in the CPU "
       "backend (0 = off)."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "Splits the LLVM module of a CPU program into this many parts, which "
+      "are compiled concurrently. 0 and 1 compile a single module."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_crash_on_verification_failures",
       bool_setter_for(
@@ -1048,6 +1056,27 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
                     &DebugOptions::set_xla_gpu_enable_experimental_block_size),
                 debug_options->xla_gpu_enable_experimental_block_size(),
                 "Enable experimental block size."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_shared_autotune_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_shared_autotune_cache_dir),
+      debug_options->xla_gpu_shared_autotune_cache_dir(),
+      "Directory shared between processes from which autotuning results are "
+      "read and into which they are merged, so that shapes autotuned by one "
+      "process are not autotuned again by the others."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_collective_profile_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_collective_profile_path),
+      debug_options->xla_gpu_collective_profile_path(),
+      "Path of a CollectiveProfileProto with measured collective running "
+      "times, from which the collective combine thresholds are derived."));
+  flag_list->push_back(
+      tsl::Flag("xla_gpu_enable_priority_fusion",
+                bool_setter_for(
+                    &DebugOptions::set_xla_gpu_enable_priority_fusion),
+                debug_options->xla_gpu_enable_priority_fusion(),
+                "Fuse producers in the order of the run time saved, as "
+                "estimated by the GPU performance model, instead of "
+                "greedily."));
 }  // NOLINT(readability/fn_size)
 
 // Allocates flag_values and flag_objects; this function must not be called more
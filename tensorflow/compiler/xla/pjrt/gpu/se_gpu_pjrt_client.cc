@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/gpu/se_gpu_pjrt_client.h"
 
+#include <cstring>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -112,7 +113,7 @@ class AsyncHostToDeviceTransferManager
 
     return std::make_unique<AsyncHostToDeviceTransferManager>(
         std::move(buffers), std::move(buffer_ptrs),
-        std::move(definition_events), device);
+        std::move(definition_events), device, client);
   }
 
   AsyncHostToDeviceTransferManager(
@@ -120,13 +121,19 @@ class AsyncHostToDeviceTransferManager
       absl::InlinedVector<std::shared_ptr<TrackedDeviceBuffer>, 4> buffer_ptrs,
       absl::InlinedVector<std::shared_ptr<BufferSequencingEvent>, 4>
           definition_events,
-      PjRtStreamExecutorDevice* device)
+      PjRtStreamExecutorDevice* device, PjRtStreamExecutorClient* client)
       : buffers_(std::move(buffers)),
         buffer_ptrs_(std::move(buffer_ptrs)),
         definition_events_(std::move(definition_events)),
         remaining_buffer_count_(buffer_ptrs_.size()),
         transfers_in_flight_(0),
-        device_(device) {
+        device_(device),
+        client_(client),
+        // All the transfers of a batch are ordered on a single stream, so that
+        // the event recorded after the last transfer into a buffer also covers
+        // the earlier sub-buffer transfers. Different batches use different
+        // streams and may overlap.
+        stream_(device->local_device_state()->GetHostToDeviceStream()) {
     buffer_sizes_.reserve(buffer_ptrs_.size());
     for (const auto& ptr : buffer_ptrs_) {
       DCHECK_EQ(ptr->device_memory().size(), 1);
@@ -167,7 +174,7 @@ class AsyncHostToDeviceTransferManager
       absl::AnyInvocable<void() &&> on_done) override {
     tsl::profiler::TraceMe traceme(
         "AsyncHostToDeviceTransferManager::TransferLiteralToBuffer");
-    auto* stream = device_->local_device_state()->host_to_device_stream();
+    auto* stream = stream_;
     auto* se_client =
         tensorflow::down_cast<PjRtStreamExecutorClient*>(device_->client());
     DCHECK(se_client);
@@ -263,7 +270,32 @@ class AsyncHostToDeviceTransferManager
   Status TransferRawDataToSubBuffer(
       int buffer_index, const void* data, int64_t offset, int64_t transfer_size,
       bool is_last_transfer, absl::AnyInvocable<void() &&> on_done) override {
-    auto* stream = device_->local_device_state()->host_to_device_stream();
+    auto* stream = stream_;
+
+    // When the client stages host to device transfers, copy the data into
+    // pinned host memory from the client's host allocator, which pools and
+    // reuses it, so that the DMA runs asynchronously instead of going through
+    // pageable memory. This is done before taking the lock so that concurrent
+    // transfers into other buffers can be staged in parallel.
+    std::shared_ptr<void> staging_buffer;
+    if (transfer_size != 0 &&
+        client_->should_stage_host_to_device_transfers()) {
+      tsl::Allocator* host_memory_allocator = client_->host_memory_allocator();
+      void* ptr = host_memory_allocator->AllocateRaw(
+          tsl::Allocator::kAllocatorAlignment, transfer_size);
+      if (ptr == nullptr) {
+        return ResourceExhausted(
+            "Failed to allocate %d bytes of host memory to stage a transfer "
+            "into buffer index %d",
+            transfer_size, buffer_index);
+      }
+      staging_buffer = std::shared_ptr<void>(
+          ptr, [host_memory_allocator](void* ptr) {
+            host_memory_allocator->DeallocateRaw(ptr);
+          });
+      std::memcpy(staging_buffer.get(), data, transfer_size);
+      data = staging_buffer.get();
+    }
 
     absl::ReleasableMutexLock l(&mu_);
     DCHECK_LT(buffer_index, buffer_ptrs_.size());
@@ -309,9 +341,11 @@ class AsyncHostToDeviceTransferManager
     // could be called on this thread, to avoid deadlock.
     l.Release();
 
+    // The staging buffer is returned to the host allocator once the transfer
+    // has completed.
     auto cleanup = [this, buffer_index, event = std::move(event).value(),
-                    stream, is_last_transfer,
-                    on_done = std::move(on_done)]() mutable {
+                    stream, is_last_transfer, on_done = std::move(on_done),
+                    staging_buffer = std::move(staging_buffer)]() mutable {
       CleanUp(buffer_index, std::move(event), stream, is_last_transfer,
               std::move(on_done));
     };
@@ -381,6 +415,9 @@ class AsyncHostToDeviceTransferManager
   int transfers_in_flight_ ABSL_GUARDED_BY(mu_);
 
   PjRtStreamExecutorDevice* device_;  // not owned.
+  PjRtStreamExecutorClient* client_;  // not owned.
+  // The stream on which all the transfers are enqueued.
+  se::Stream* stream_;
 };
 
 absl::string_view StreamExecutorGpuClient::platform_version() const {
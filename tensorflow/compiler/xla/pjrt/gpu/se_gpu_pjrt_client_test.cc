@@ -339,6 +339,47 @@ TEST(StreamExecutorGpuClientTest, FromHostAsync) {
         literals[i]->Relayout(src_literals[i].shape().layout()).data<float>());
   }
 }
+
+TEST(StreamExecutorGpuClientTest, FromHostAsyncInChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client, GetStreamExecutorGpuClient(true, /*allocator_config=*/{},
+                                              /*node_id=*/0));
+  ASSERT_GE(client->addressable_devices().size(), 1);
+
+  constexpr int kNumChunks = 4;
+  constexpr int kChunkSize = 1024;
+  std::vector<float> data(kNumChunks * kChunkSize);
+  std::iota(data.begin(), data.end(), 0.0f);
+  Literal src_literal = LiteralUtil::CreateR1<float>(data);
+  TF_ASSERT_OK_AND_ASSIGN(auto transfer_manager,
+                          client->CreateBuffersForAsyncHostToDevice(
+                              {src_literal.shape()},
+                              client->addressable_devices()[0]));
+  std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(0);
+
+  absl::Mutex mu;
+  int done_count = 0;
+  for (int i = 0; i < kNumChunks; ++i) {
+    TF_ASSERT_OK(transfer_manager->TransferRawDataToSubBuffer(
+        0, data.data() + i * kChunkSize, i * kChunkSize * sizeof(float),
+        kChunkSize * sizeof(float), /*is_last_transfer=*/i == kNumChunks - 1,
+        [&]() {
+          absl::MutexLock l(&mu);
+          ++done_count;
+        }));
+  }
+  TF_ASSERT_OK(buffer->GetReadyFuture().Await());
+  {
+    auto done = [&]() { return done_count == kNumChunks; };
+    absl::MutexLock l(&mu);
+    mu.Await(absl::Condition(&done));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                          buffer->ToLiteralSync());
+  EXPECT_TRUE(LiteralTestUtil::Equal(src_literal, *literal));
+}
+
 TEST(StreamExecutorGpuClientTest, CopyRawToHostFullBuffer) {
   TF_ASSERT_OK_AND_ASSIGN(
       auto client, GetStreamExecutorGpuClient(true, /*allocator_config=*/{},
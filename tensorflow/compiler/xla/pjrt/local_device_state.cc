@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 
+#include <algorithm>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -49,6 +50,9 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
   device_ordinal_ =
       device_ordinal != -1 ? device_ordinal : executor->device_ordinal();
 
+  int num_host_to_device_streams =
+      stream_options.has_value() ? stream_options->num_host_to_device_streams
+                                 : kNumHostToDeviceStreams;
   int num_device_to_host_streams =
       stream_options.has_value() ? stream_options->num_device_to_host_streams
                                  : kNumDeviceToHostStreams;
@@ -59,13 +63,19 @@ LocalDeviceState::LocalDeviceState(se::StreamExecutor* executor,
   if (stream_options.has_value()) {
     compute_stream_->implementation()->SetPriority(stream_options->priority);
   }
-  host_to_device_stream_ = std::make_unique<se::Stream>(executor);
-  if (stream_options.has_value()) {
-    host_to_device_stream_->implementation()->SetPriority(
-        stream_options->priority);
-  }
   compute_stream_->Init();
-  host_to_device_stream_->Init();
+  // There is always at least one host to device stream, which is the one
+  // returned by host_to_device_stream().
+  num_host_to_device_streams = std::max(num_host_to_device_streams, 1);
+  host_to_device_streams_.reserve(num_host_to_device_streams);
+  for (int i = 0; i < num_host_to_device_streams; ++i) {
+    auto stream = std::make_unique<se::Stream>(executor);
+    if (stream_options.has_value()) {
+      stream->implementation()->SetPriority(stream_options->priority);
+    }
+    stream->Init();
+    host_to_device_streams_.push_back(std::move(stream));
+  }
   if (use_callback_stream) {
     callback_stream_map_ =
         absl::flat_hash_map<se::Stream*, std::unique_ptr<se::Stream>>();
@@ -114,6 +124,9 @@ Status LocalDeviceState::SynchronizeAllActivity() {
       status.Update(callback_stream.second->BlockHostUntilDone());
     }
   }
+  for (auto& stream : host_to_device_streams_) {
+    status.Update(stream->BlockHostUntilDone());
+  }
   for (auto& stream : device_to_host_streams_) {
     status.Update(stream->BlockHostUntilDone());
   }
@@ -155,6 +168,14 @@ void LocalDeviceState::ThenExecuteCallback(se::Stream* stream,
   });
 }
 
+se::Stream* LocalDeviceState::GetHostToDeviceStream() {
+  absl::MutexLock lock(&mu_);
+  int i = next_host_to_device_stream_;
+  next_host_to_device_stream_ =
+      (next_host_to_device_stream_ + 1) % host_to_device_streams_.size();
+  return host_to_device_streams_.at(i).get();
+}
+
 se::Stream* LocalDeviceState::GetDeviceToHostStream() {
   absl::MutexLock lock(&mu_);
   int i = next_device_to_host_stream_;
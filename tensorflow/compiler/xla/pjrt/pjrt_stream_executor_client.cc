@@ -770,10 +770,12 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
     }
   }
 
+  // Transfers are spread over the host to device streams of the device, so
+  // that the transfers of independent buffers overlap.
+  se::Stream* h2d_stream = local_device->GetHostToDeviceStream();
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<PjRtStreamExecutorBuffer> py_buffer,
-      AllocateDestinationBuffer(device_shape, device, local_device,
-                                local_device->host_to_device_stream(),
+      AllocateDestinationBuffer(device_shape, device, local_device, h2d_stream,
                                 /*is_uninitialized_create=*/false, this));
 
   PjRtStreamExecutorBuffer::ScopedHold device_buffer(
@@ -829,9 +831,9 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   // TODO(misard) assess if it would be preferable to introduce a heuristic to
   // put the transfer into the calling thread for small literals.
   auto transfer_h2d =
-      [local_client = client(), transfer_manager, local_device, data, size,
-       movable_device_buffer{device_buffer.ToClosure()}, device_shape,
-       py_buffer{py_buffer.get()},
+      [local_client = client(), transfer_manager, local_device, h2d_stream,
+       data, size, movable_device_buffer{device_buffer.ToClosure()},
+       device_shape, py_buffer{py_buffer.get()},
        on_device_shape{py_buffer->on_device_shape()},
        staging_buffer{std::move(staging_buffer)},
        on_done_with_host_buffer{std::move(on_done_with_host_buffer)},
@@ -865,24 +867,23 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
               static_cast<const char*>(staging_buffer.get()),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         } else {
           BorrowingLiteral literal(
               reinterpret_cast<const char*>(data),
               ShapeUtil::DeviceShapeToHostShape(on_device_shape));
           // Otherwise, just transfer the literal.
           TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
-              local_device->host_to_device_stream(), literal, buffer));
+              h2d_stream, literal, buffer));
         }
 
         std::shared_ptr<BufferSequencingEvent> event =
             device_buffer->definition_events()[0];
         TF_CHECK_OK(AddDestinationBufferSynchronization(
-            local_device, std::move(device_buffer), event,
-            local_device->host_to_device_stream()));
+            local_device, std::move(device_buffer), event, h2d_stream));
 
         local_device->ThenExecuteCallback(
-            local_device->host_to_device_stream(),
+            h2d_stream,
             [staging_buffer{std::move(staging_buffer)},
              on_done_with_host_buffer{std::move(on_done_with_host_buffer)}]() {
               if (on_done_with_host_buffer) {
@@ -957,10 +958,10 @@ PjRtStreamExecutorClient::BufferFromHostLiteral(const LiteralSlice& literal,
   TF_ASSIGN_OR_RETURN(
       Shape compact_shape,
       transfer_manager->ChooseCompactLayoutForShape(literal.shape()));
+  se::Stream* h2d_stream = local_device->GetHostToDeviceStream();
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<PjRtStreamExecutorBuffer> py_buffer,
-      AllocateDestinationBuffer(compact_shape, device, local_device,
-                                local_device->host_to_device_stream(),
+      AllocateDestinationBuffer(compact_shape, device, local_device, h2d_stream,
                                 /*is_uninitialized_create=*/false, this));
 
   PjRtStreamExecutorBuffer::ScopedHold device_buffer(
@@ -974,6 +975,7 @@ PjRtStreamExecutorClient::BufferFromHostLiteral(const LiteralSlice& literal,
   // TODO(misard) assess if it would be preferable to introduce a heuristic to
   // put the transfer into the calling thread for small literals.
   auto transfer_h2d = [local_client = client(), transfer_manager, local_device,
+                       h2d_stream,
                        movable_device_buffer{device_buffer.ToClosure()},
                        literal, py_buffer{py_buffer.get()},
                        on_device_shape{py_buffer->on_device_shape()}]() {
@@ -984,7 +986,6 @@ PjRtStreamExecutorClient::BufferFromHostLiteral(const LiteralSlice& literal,
     // memory that has already been allocated, and a possible Event
     // allocation.
 
-    se::Stream* h2d_stream = local_device->host_to_device_stream();
     ShapedBuffer buffer = device_buffer->AsShapedBuffer(on_device_shape);
     TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
         h2d_stream, literal, buffer));
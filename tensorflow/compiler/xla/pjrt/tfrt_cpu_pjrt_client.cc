@@ -403,7 +403,7 @@ static StatusOr<std::vector<std::unique_ptr<TfrtCpuDevice>>> GetTfrtCpuDevices(
 
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
     bool asynchronous, int cpu_device_count,
-    int max_inflight_computations_per_device) {
+    int max_inflight_computations_per_device, int num_intra_op_partitions) {
   // Need at least CpuDeviceCount threads to launch one collective.
   size_t num_threads = std::max(DefaultThreadPoolSize(), cpu_device_count);
 
@@ -411,8 +411,13 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
                       GetTfrtCpuDevices(cpu_device_count,
                                         max_inflight_computations_per_device));
 
+  if (num_intra_op_partitions < 1) {
+    return InvalidArgument("num_intra_op_partitions must be positive, got %d",
+                           num_intra_op_partitions);
+  }
   return std::unique_ptr<PjRtClient>(std::make_unique<TfrtCpuClient>(
-      /*process_index=*/0, std::move(devices), num_threads));
+      /*process_index=*/0, std::move(devices), num_threads,
+      num_intra_op_partitions));
 }
 
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
@@ -421,7 +426,7 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous) {
 
 TfrtCpuClient::TfrtCpuClient(
     int process_index, std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-    size_t num_threads)
+    size_t num_threads, int num_intra_op_partitions)
     : process_index_(process_index),
       owned_devices_(std::move(devices)),
       computation_placer_(std::make_unique<ComputationPlacer>()),
@@ -429,14 +434,20 @@ TfrtCpuClient::TfrtCpuClient(
           tsl::Env::Default(), "XLATfrtCpuClient", num_threads)),
       async_work_runner_(std::make_unique<ThreadPoolAsyncWorkRunner>(
           pjrt_client_thread_pool_.get())),
-      eigen_intraop_pool_(new tsl::thread::ThreadPool(
-          tsl::Env::Default(), "XLAEigen", DefaultThreadPoolSize())),
-      eigen_intraop_device_(
-          new Eigen::ThreadPoolDevice(eigen_intraop_pool_->AsEigenThreadPool(),
-                                      eigen_intraop_pool_->NumThreads())),
       last_collective_launch_event_(
           tfrt::MakeAvailableAsyncValueRef<CpuEvent>()),
       transpose_cache_(1024) {
+  CHECK_GE(num_intra_op_partitions, 1);
+  const int num_threads_per_partition =
+      std::max(1, DefaultThreadPoolSize() / num_intra_op_partitions);
+  for (int i = 0; i < num_intra_op_partitions; ++i) {
+    auto partition = std::make_unique<IntraOpPartition>();
+    partition->pool = std::make_unique<tsl::thread::ThreadPool>(
+        tsl::Env::Default(), "XLAEigen", num_threads_per_partition);
+    partition->device = std::make_unique<Eigen::ThreadPoolDevice>(
+        partition->pool->AsEigenThreadPool(), partition->pool->NumThreads());
+    intra_op_partitions_.push_back(std::move(partition));
+  }
   for (const std::unique_ptr<TfrtCpuDevice>& device : owned_devices_) {
     devices_.push_back(device.get());
     CHECK(id_to_device_.insert({device->id(), device.get()}).second)
@@ -460,6 +471,19 @@ TfrtCpuClient::TfrtCpuClient(
 
 TfrtCpuClient::~TfrtCpuClient() { LOG(INFO) << "TfrtCpuClient destroyed."; }
 
+TfrtCpuClient::IntraOpPartitionReservation
+TfrtCpuClient::AcquireIntraOpPartition() {
+  IntraOpPartition* least_loaded = intra_op_partitions_.front().get();
+  for (const auto& partition : intra_op_partitions_) {
+    if (partition->num_running_executions.load() <
+        least_loaded->num_running_executions.load()) {
+      least_loaded = partition.get();
+    }
+  }
+  least_loaded->num_running_executions.fetch_add(1);
+  return IntraOpPartitionReservation(least_loaded);
+}
+
 StatusOr<PjRtDevice*> TfrtCpuClient::LookupDevice(int device_id) const {
   auto it = id_to_device_.find(device_id);
   if (it != id_to_device_.end()) {
@@ -1271,7 +1295,10 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
   run_options.set_device_ordinal(device->local_hardware_id());
   // Need to keep device_assignment alive until execution completes.
   run_options.set_device_assignment(device_assignment.get());
-  run_options.set_intra_op_thread_pool(client_->eigen_intraop_device());
+  // Executions running concurrently are spread over the intra-op partitions.
+  TfrtCpuClient::IntraOpPartitionReservation intra_op_partition =
+      client_->AcquireIntraOpPartition();
+  run_options.set_intra_op_thread_pool(intra_op_partition->device.get());
 
   // Schedule only one collective at a time.
   bool is_a_collective_launch = !!last_collective_launch_event;
@@ -1342,6 +1369,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
          cpu_executable_copy = cpu_executable_,
          device_assignment = std::move(device_assignment),
          compute_reservation = std::move(compute_reservation),
+         intra_op_partition = std::move(intra_op_partition),
          tuplized_arg = std::move(tuplized_arg),
          donation_transactions = std::move(donation_transactions),
          execute_event = std::move(ready_on_exit).Release(),
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -135,9 +136,11 @@ class TfrtCpuDevice final : public PjRtDevice {
 
 class TfrtCpuClient final : public PjRtClient {
  public:
+  // The intra-op threads are split into `num_intra_op_partitions` thread
+  // pools; see AcquireIntraOpPartition().
   TfrtCpuClient(int process_index,
                 std::vector<std::unique_ptr<TfrtCpuDevice>> devices,
-                size_t num_threads);
+                size_t num_threads, int num_intra_op_partitions = 1);
   ~TfrtCpuClient() override;
 
   int process_index() const override { return process_index_; }
@@ -249,9 +252,33 @@ class TfrtCpuClient final : public PjRtClient {
   }
 
   Eigen::ThreadPoolDevice* eigen_intraop_device() const {
-    return eigen_intraop_device_.get();
+    return intra_op_partitions_.front()->device.get();
   }
 
+  // A partition of the intra-op threads. Each execution parallelizes its
+  // computation over the threads of one partition only, which bounds the
+  // threads it uses and keeps concurrent executions from contending for the
+  // same threads.
+  struct IntraOpPartition {
+    std::unique_ptr<tsl::thread::ThreadPool> pool;
+    std::unique_ptr<Eigen::ThreadPoolDevice> device;
+    std::atomic<int> num_running_executions{0};
+  };
+
+  struct IntraOpPartitionReleaser {
+    void operator()(IntraOpPartition* partition) const {
+      partition->num_running_executions.fetch_sub(1);
+    }
+  };
+  using IntraOpPartitionReservation =
+      std::unique_ptr<IntraOpPartition, IntraOpPartitionReleaser>;
+
+  // Reserves the partition with the fewest running executions, until the
+  // reservation is destroyed.
+  IntraOpPartitionReservation AcquireIntraOpPartition();
+
+  int num_intra_op_partitions() const { return intra_op_partitions_.size(); }
+
   tfrt::AsyncValueRef<runtime::CpuEvent> GetLastCollectiveLaunchEvent() {
     absl::MutexLock lock(&mu_);
     return last_collective_launch_event_.CopyRef();
@@ -280,8 +307,7 @@ class TfrtCpuClient final : public PjRtClient {
   std::unique_ptr<AsyncWorkRunner> async_work_runner_;
 
   // TODO(zhangqiaorjc): Use tfrt::compat::EigenHostContextThreadPool.
-  std::unique_ptr<tsl::thread::ThreadPool> eigen_intraop_pool_;
-  std::unique_ptr<Eigen::ThreadPoolDevice> eigen_intraop_device_;
+  std::vector<std::unique_ptr<IntraOpPartition>> intra_op_partitions_;
 
   // Launching collectives are prone to deadlock when we use fixed-sized
   // threadpools since ExecuteHelper will block until all replicas reach the
@@ -492,9 +518,15 @@ StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(bool asynchronous);
 
 // Similar to the function above, but you can set the number of devices and max
 // number of inflight computations per device explicitly.
+//
+// A server running many small computations concurrently can also split the
+// intra-op threads into `num_intra_op_partitions` pools, so that each
+// computation runs on the least loaded pool instead of all of them contending
+// for the same threads.
 StatusOr<std::unique_ptr<PjRtClient>> GetTfrtCpuClient(
     bool asynchronous, int cpu_device_count,
-    int max_inflight_computations_per_device = 32);
+    int max_inflight_computations_per_device = 32,
+    int num_intra_op_partitions = 1);
 
 }  // namespace xla
 
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/test_utils.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/casts.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/file_system.h"
@@ -304,5 +305,54 @@ TEST(TfrtCpuClientTest, AsyncTransferRawDataToSubBuffer) {
   EXPECT_THAT(literal->data<uint32_t>(), Each(0x42424242));
 }
 
+TEST(TfrtCpuClientTest, IntraOpPartitions) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto client,
+      GetTfrtCpuClient(/*asynchronous=*/true, /*cpu_device_count=*/1,
+                       /*max_inflight_computations_per_device=*/32,
+                       /*num_intra_op_partitions=*/2));
+  auto* cpu_client = tensorflow::down_cast<TfrtCpuClient*>(client.get());
+  EXPECT_EQ(cpu_client->num_intra_op_partitions(), 2);
+
+  // Concurrent executions are spread over the partitions.
+  auto first = cpu_client->AcquireIntraOpPartition();
+  auto second = cpu_client->AcquireIntraOpPartition();
+  EXPECT_NE(first.get(), second.get());
+  TfrtCpuClient::IntraOpPartition* first_partition = first.get();
+  first.reset();
+  EXPECT_EQ(cpu_client->AcquireIntraOpPartition().get(), first_partition);
+
+  constexpr char kProgram[] = R"(
+HloModule Add
+ENTRY Add {
+  p0 = f32[1024] parameter(0)
+  ROOT add = f32[1024] add(p0, p0)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                          ParseAndReturnUnverifiedModule(kProgram, {}));
+  XlaComputation xla_computation(hlo_module->ToProto());
+  TF_ASSERT_OK_AND_ASSIGN(auto pjrt_executable,
+                          client->Compile(xla_computation, {}));
+  std::vector<float> data(1024, 1);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto buffer,
+      client->BufferFromHostBuffer(
+          data.data(), F32, {1024}, /*byte_strides=*/std::nullopt,
+          PjRtClient::HostBufferSemantics::kImmutableOnlyDuringCall, nullptr,
+          client->addressable_devices()[0]));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto result, pjrt_executable->Execute(
+                       /*argument_handles=*/{{buffer.get()}}, /*options=*/{}));
+  TF_ASSERT_OK_AND_ASSIGN(auto literal, result[0][0]->ToLiteralSync());
+  EXPECT_THAT(literal->data<float>(), Each(2.0f));
+}
+
+TEST(TfrtCpuClientTest, InvalidIntraOpPartitions) {
+  EXPECT_FALSE(GetTfrtCpuClient(/*asynchronous=*/true, /*cpu_device_count=*/1,
+                                /*max_inflight_computations_per_device=*/32,
+                                /*num_intra_op_partitions=*/0)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace xla
@@ -0,0 +1,77 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/collective_combine_threshold.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+
+StatusOr<int64_t> CombineThresholdFromProfile(
+    const tsl::protobuf::RepeatedPtrField<
+        CollectiveProfileProto::Measurement>& measurements,
+    double bandwidth_efficiency) {
+  CHECK(bandwidth_efficiency > 0.0 && bandwidth_efficiency < 1.0);
+  if (measurements.size() < 2) {
+    return InvalidArgument(
+        "At least two measurements are needed to fit a collective profile, got "
+        "%d",
+        measurements.size());
+  }
+
+  // Least squares fit of `time_us = latency_us + size_bytes * us_per_byte`.
+  double mean_size = 0.0;
+  double mean_time = 0.0;
+  for (const CollectiveProfileProto::Measurement& m : measurements) {
+    mean_size += m.size_bytes();
+    mean_time += m.time_us();
+  }
+  mean_size /= measurements.size();
+  mean_time /= measurements.size();
+  double covariance = 0.0;
+  double variance = 0.0;
+  for (const CollectiveProfileProto::Measurement& m : measurements) {
+    covariance += (m.size_bytes() - mean_size) * (m.time_us() - mean_time);
+    variance += (m.size_bytes() - mean_size) * (m.size_bytes() - mean_size);
+  }
+  if (variance <= 0.0) {
+    return InvalidArgument(
+        "Collective profile measurements must have different sizes");
+  }
+  const double us_per_byte = covariance / variance;
+  const double latency_us = mean_time - us_per_byte * mean_size;
+  if (!(us_per_byte > 0.0) || !(latency_us > 0.0)) {
+    return InvalidArgument(
+        "Collective profile does not fit a positive latency and bandwidth, got "
+        "latency %f us and %f us per byte",
+        latency_us, us_per_byte);
+  }
+
+  // A message of `size` bytes reaches `bandwidth_efficiency` of the bandwidth
+  // when `size * us_per_byte / (latency_us + size * us_per_byte)` is equal to
+  // `bandwidth_efficiency`.
+  const double threshold = bandwidth_efficiency / (1.0 - bandwidth_efficiency) *
+                           latency_us / us_per_byte;
+  return static_cast<int64_t>(std::min<double>(
+      std::ceil(threshold), std::numeric_limits<int64_t>::max()));
+}
+
+}  // namespace xla
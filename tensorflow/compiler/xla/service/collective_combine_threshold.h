@@ -0,0 +1,47 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_COLLECTIVE_COMBINE_THRESHOLD_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_COLLECTIVE_COMBINE_THRESHOLD_H_
+
+#include <cstdint>
+
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/tsl/platform/protobuf.h"
+
+namespace xla {
+
+// Returns the combine threshold in bytes of a collective whose running times
+// by message size are `measurements`.
+//
+// The running time of a collective is modeled as `latency + size / bandwidth`,
+// fitted to `measurements` by least squares. Combining collectives amortizes
+// their latency, but also delays their start until all their operands are
+// ready, which leaves less computation for the latency hiding scheduler to
+// overlap them with. So collectives are only combined until the combined
+// message is large enough to reach a `bandwidth_efficiency` fraction of the
+// bandwidth, beyond which combining them further saves little time.
+//
+// Returns an error if `measurements` do not determine a positive latency and
+// bandwidth.
+StatusOr<int64_t> CombineThresholdFromProfile(
+    const tsl::protobuf::RepeatedPtrField<
+        CollectiveProfileProto::Measurement>& measurements,
+    double bandwidth_efficiency = 0.9);
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_COLLECTIVE_COMBINE_THRESHOLD_H_
@@ -0,0 +1,78 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/collective_combine_threshold.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/tsl/platform/statusor.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace {
+
+CollectiveProfileProto MakeProfile(
+    const std::vector<std::pair<int64_t, double>>& measurements) {
+  CollectiveProfileProto profile;
+  for (const auto& [size_bytes, time_us] : measurements) {
+    CollectiveProfileProto::Measurement* m = profile.add_all_reduce();
+    m->set_size_bytes(size_bytes);
+    m->set_time_us(time_us);
+  }
+  return profile;
+}
+
+TEST(CollectiveCombineThresholdTest, ReachesBandwidthEfficiency) {
+  // 10us of latency and 10 bytes per ns of bandwidth.
+  CollectiveProfileProto profile = MakeProfile(
+      {{1 << 10, 10.1024}, {1 << 20, 114.8576}, {1 << 24, 1687.7216}});
+  TF_ASSERT_OK_AND_ASSIGN(
+      int64_t threshold,
+      CombineThresholdFromProfile(profile.all_reduce(),
+                                  /*bandwidth_efficiency=*/0.9));
+  // 90% of the bandwidth is reached when the transfer takes 9x the latency.
+  EXPECT_NEAR(threshold, 900000, 10);
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      int64_t lower_threshold,
+      CombineThresholdFromProfile(profile.all_reduce(),
+                                  /*bandwidth_efficiency=*/0.5));
+  EXPECT_NEAR(lower_threshold, 100000, 10);
+}
+
+TEST(CollectiveCombineThresholdTest, RejectsTooFewMeasurements) {
+  CollectiveProfileProto profile = MakeProfile({{1 << 10, 10.1024}});
+  EXPECT_FALSE(CombineThresholdFromProfile(profile.all_reduce()).ok());
+}
+
+TEST(CollectiveCombineThresholdTest, RejectsMeasurementsOfOneSize) {
+  CollectiveProfileProto profile =
+      MakeProfile({{1 << 10, 10.0}, {1 << 10, 11.0}});
+  EXPECT_FALSE(CombineThresholdFromProfile(profile.all_reduce()).ok());
+}
+
+TEST(CollectiveCombineThresholdTest, RejectsProfileWithoutLatency) {
+  // The fitted latency is negative, so there is no latency to amortize by
+  // combining.
+  CollectiveProfileProto profile =
+      MakeProfile({{1 << 10, 0.5}, {1 << 20, 1024.0}});
+  EXPECT_FALSE(CombineThresholdFromProfile(profile.all_reduce()).ok());
+}
+
+}  // namespace
+}  // namespace xla
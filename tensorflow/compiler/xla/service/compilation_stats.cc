@@ -15,16 +15,38 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/compilation_stats.h"
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/const_init.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/tsl/platform/env.h"
 
 namespace xla {
+namespace {
+
+absl::Mutex process_pass_stats_mu(absl::kConstInit);
+
+absl::flat_hash_map<std::string, HloPassStats>& ProcessPassStatsMap()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(process_pass_stats_mu) {
+  static auto* stats = new absl::flat_hash_map<std::string, HloPassStats>();
+  return *stats;
+}
+
+}  // namespace
 
 class NoopStats : public CompilationStats {
  public:
@@ -140,4 +162,79 @@ void Stats::CompilationReport() {
 
 int Stats::GetPassesSize() { return passes_.size(); }
 
+/* static */
+void CompilationStats::RecordPassRun(absl::string_view pass_name,
+                                     double duration_ms,
+                                     int64_t instruction_count_delta,
+                                     int64_t peak_memory_growth_bytes) {
+  absl::MutexLock lock(&process_pass_stats_mu);
+  HloPassStats& stats = ProcessPassStatsMap()[pass_name];
+  ++stats.num_runs;
+  stats.duration_ms += duration_ms;
+  stats.instruction_count_delta += instruction_count_delta;
+  stats.peak_memory_growth_bytes =
+      std::max(stats.peak_memory_growth_bytes, peak_memory_growth_bytes);
+}
+
+/* static */
+void CompilationStats::RecordFixedPointIterations(absl::string_view pass_name,
+                                                  int64_t iterations) {
+  absl::MutexLock lock(&process_pass_stats_mu);
+  ProcessPassStatsMap()[pass_name].fixed_point_iterations += iterations;
+}
+
+/* static */
+absl::flat_hash_map<std::string, HloPassStats>
+CompilationStats::ProcessPassStats() {
+  absl::MutexLock lock(&process_pass_stats_mu);
+  return ProcessPassStatsMap();
+}
+
+/* static */
+void CompilationStats::ResetProcessPassStats() {
+  absl::MutexLock lock(&process_pass_stats_mu);
+  ProcessPassStatsMap().clear();
+}
+
+/* static */
+std::string CompilationStats::ProcessPassStatsReport() {
+  std::vector<std::pair<std::string, HloPassStats>> sorted_stats;
+  for (auto& [name, stats] : ProcessPassStats()) {
+    sorted_stats.emplace_back(name, stats);
+  }
+  absl::c_sort(sorted_stats, [](const auto& a, const auto& b) {
+    // Sort passes that take the longest first, break ties using pass names.
+    return std::make_pair(b.second.duration_ms, a.first) <
+           std::make_pair(a.second.duration_ms, b.first);
+  });
+  std::string report =
+      "Pass name, num runs, time (ms), instruction count delta, "
+      "peak memory growth (bytes), fixed point iterations\n";
+  for (const auto& [name, stats] : sorted_stats) {
+    absl::StrAppend(&report, name, ", ", stats.num_runs, ", ",
+                    stats.duration_ms, ", ", stats.instruction_count_delta,
+                    ", ", stats.peak_memory_growth_bytes, ", ",
+                    stats.fixed_point_iterations, "\n");
+  }
+  return report;
+}
+
+/* static */
+int64_t CompilationStats::PeakResidentMemoryBytes() {
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  // Linux reports kilobytes.
+  return int64_t{usage.ru_maxrss} * 1024;
+#endif
+#else
+  return 0;
+#endif
+}
+
 }  // namespace xla
@@ -16,14 +16,29 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_COMPILATION_STATS_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_COMPILATION_STATS_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 
 namespace xla {
 
+// Statistics about the runs of an HLO pass, aggregated across all the
+// compilations of the process.
+struct HloPassStats {
+  int64_t num_runs = 0;
+  double duration_ms = 0;
+  // Sum over all runs of the change in the number of instructions of the HLO.
+  int64_t instruction_count_delta = 0;
+  // Largest growth of the peak resident memory of the process during a run.
+  int64_t peak_memory_growth_bytes = 0;
+  // Number of iterations run to reach a fixed point, for HloPassFix passes.
+  int64_t fixed_point_iterations = 0;
+};
+
 // This class is used to collect information about HLO passes and print some
 // statistics at the end of compilation. From HloPassPipeline, we call StartPass
 // before the execution of a pass, and EndPass after. Currently, we only collect
@@ -47,6 +62,32 @@ class CompilationStats {
 
   virtual void RecordPassError(absl::string_view pass_name,
                                absl::string_view err) = 0;
+
+  // Process-wide statistics, which every HloPassPipeline records regardless of
+  // the CompilationStats instance it was given.
+
+  // Records a run of `pass_name` into the process-wide statistics.
+  static void RecordPassRun(absl::string_view pass_name, double duration_ms,
+                            int64_t instruction_count_delta,
+                            int64_t peak_memory_growth_bytes);
+
+  // Records that a run of the HloPassFix pass `pass_name` took `iterations`
+  // iterations to reach a fixed point.
+  static void RecordFixedPointIterations(absl::string_view pass_name,
+                                         int64_t iterations);
+
+  // Returns the process-wide statistics, keyed by pass name.
+  static absl::flat_hash_map<std::string, HloPassStats> ProcessPassStats();
+
+  // Clears the process-wide statistics.
+  static void ResetProcessPassStats();
+
+  // Returns a table of the process-wide statistics, slowest passes first.
+  static std::string ProcessPassStatsReport();
+
+  // Returns the peak resident memory of the process in bytes, or 0 if it is
+  // unknown on this platform.
+  static int64_t PeakResidentMemoryBytes();
 };
 
 }  // namespace xla
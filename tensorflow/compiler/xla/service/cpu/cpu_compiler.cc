@@ -39,6 +39,8 @@ limitations under the License.
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
@@ -48,12 +50,14 @@ limitations under the License.
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/TargetParser/X86TargetParser.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"  // from @llvm-project
 #include "mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h"  // from @llvm-project
 #include "mlir/Dialect/Affine/IR/AffineOps.h"  // from @llvm-project
@@ -191,8 +195,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/translate/hlo_to_mhlo/hlo_to_mlir_hlo.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace {
 
@@ -960,6 +966,81 @@ Status VerifyLlvmModule(const llvm::Module& llvm_module) {
   return OkStatus();
 }
 
+// Splits `llvm_module` into `split_count` parts, which are optimized and
+// compiled to object files concurrently, and adds these to `jit`. Each part is
+// moved to its own LLVM context, as a context can't be used by several threads.
+//
+// The optimized IR and the object files of the parts are not passed to the
+// post-optimization and post-codegen hooks.
+Status CompileSplitModule(const HloModuleConfig& config,
+                          llvm::Module& llvm_module, int split_count,
+                          SimpleOrcJIT* jit) {
+  XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Compiling split LLVM module");
+
+  std::vector<std::string> parts_bitcode;
+  // Locals are kept in the part of their users, so that the constants of a
+  // computation are still visible to its optimizations.
+  llvm::SplitModule(
+      llvm_module, split_count,
+      [&](std::unique_ptr<llvm::Module> part) {
+        std::string bitcode;
+        llvm::raw_string_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*part, os);
+        os.flush();
+        parts_bitcode.push_back(std::move(bitcode));
+      },
+      /*PreserveLocals=*/true);
+
+  const int num_parts = parts_bitcode.size();
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> obj_files(num_parts);
+  std::vector<Status> statuses(num_parts);
+  {
+    tsl::thread::ThreadPool pool(tsl::Env::Default(), "xla_cpu_codegen",
+                                 num_parts);
+    for (int i = 0; i < num_parts; ++i) {
+      pool.Schedule([&, i] {
+        llvm::LLVMContext context;
+        llvm::Expected<std::unique_ptr<llvm::Module>> part =
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(parts_bitcode[i], "__compute_module"),
+                context);
+        if (!part) {
+          statuses[i] = InternalError("Parsing the part %d of the module: %s",
+                                      i, llvm::toString(part.takeError()));
+          return;
+        }
+        std::unique_ptr<llvm::TargetMachine> target_machine =
+            SimpleOrcJIT::InferTargetMachineForJIT(
+                CompilerTargetOptions(config), CodeGenOptLevel(config));
+        CompilerFunctor compiler_functor(
+            target_machine.get(), CodeGenOptLevel(config),
+            options::OptimizeForSizeRequested(config),
+            config.debug_options().xla_llvm_disable_expensive_passes(),
+            options::SlpVectorizerDisabled(config),
+            llvm_ir::GetCpuFastMathFlags(config));
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> obj_file =
+            compiler_functor(**part);
+        if (!obj_file) {
+          statuses[i] =
+              InternalError("Compiling the part %d of the module: %s", i,
+                            llvm::toString(obj_file.takeError()));
+          return;
+        }
+        obj_files[i] = std::move(*obj_file);
+      });
+    }
+  }
+
+  for (int i = 0; i < num_parts; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    if (llvm::Error err = jit->AddObjFile(std::move(obj_files[i]))) {
+      return InternalError("Adding the part %d of the module to the JIT: %s",
+                           i, llvm::toString(std::move(err)));
+    }
+  }
+  return OkStatus();
+}
+
 Status CreateHloProfilingArtifacts(
     const HloModule& module,
     absl::flat_hash_map<const HloInstruction*, int64_t>*
@@ -1396,9 +1477,17 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (split_count > 1) {
+    pre_optimization_ir_hook(*llvm_module);
+    TF_RETURN_IF_ERROR(CompileSplitModule(module->config(), *llvm_module,
+                                          split_count, jit->get()));
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
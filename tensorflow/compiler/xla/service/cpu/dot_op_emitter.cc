@@ -1157,22 +1157,26 @@ bool CanEmitTiledLlvmIrGemm(
     const TargetMachineFeatures& target_machine_features) {
   CHECK(IsAlignedGemm(dot_info, target_machine_features));
 
-  if (ShouldUseMultiThreadedEigen(config)) {
-    return false;
-  }
-
   int m = dot_info.result_shape.dimensions(0);
   int k = dot_info.lhs_shape.dimensions(
       dot_info.dim_nums.lhs_contracting_dimensions(0));
   int n = dot_info.result_shape.dimensions(1);
 
-  if (!options::ForceEnableExperimentalLlvmIrGemm(config)) {
-    // TODO(sanjoy):  We should make these numbers micro-arch specific.
-    bool small_gemm =
-        k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
+  // TODO(sanjoy):  We should make these numbers micro-arch specific.
+  bool small_gemm =
+      k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
+
+  // Small GEMMs are too small to be split across Eigen's thread pool, and the
+  // setup of the runtime call dominates their cost, so we emit them inline even
+  // when larger GEMMs go to multi-threaded Eigen.  Batch dots of small GEMMs
+  // are then lowered into a loop of these inline GEMMs.
+  if (ShouldUseMultiThreadedEigen(config)) {
     if (!small_gemm) {
       return false;
     }
+  } else if (!options::ForceEnableExperimentalLlvmIrGemm(config) &&
+             !small_gemm) {
+    return false;
   }
 
   bool lhs_canonical = dot_info.dim_nums.lhs_contracting_dimensions(0) == 1;
@@ -54,6 +54,10 @@ class SimpleCostModel : public ParallelCostModel {
 
 class DefaultCostModel : public ParallelCostModel {
  public:
+  // Maximum number of parallel tasks per thread for compute bound
+  // instructions.
+  static constexpr int64_t kTasksPerThread = 4;
+
   DefaultCostModel(const int64_t max_parallelism,
                    const HloCostAnalysis::ShapeSizeFunction& shape_size,
                    std::unique_ptr<HloCostAnalysis> cost_analysis)
@@ -67,11 +71,13 @@ class DefaultCostModel : public ParallelCostModel {
     int64_t instruction_cost;
     int64_t min_cost_per_thread;
     int64_t max_parallelism;
-    // Calculate flops-to-bytes-ratio for 'instruction'.
+    // Calculate flops-to-bytes-ratio for 'instruction'. Transcendentals are
+    // weighted as in the compute bound instruction cost below.
     const int64_t bytes_accessed =
         std::max(int64_t{1}, cost_analysis_->bytes_accessed(*instruction));
     const float flops_to_bytes_ratio =
-        cost_analysis_->flop_count(*instruction) /
+        (cost_analysis_->flop_count(*instruction) +
+         2 * cost_analysis_->transcendental_count(*instruction)) /
         static_cast<float>(bytes_accessed);
     // Check for I/O bound instructions.
     if (flops_to_bytes_ratio <= 1.0) {
@@ -84,8 +90,12 @@ class DefaultCostModel : public ParallelCostModel {
       instruction_cost = shape_size_(instruction->shape());
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
-      // Use max parallelism for compute bound instructions.
-      max_parallelism = max_parallelism_;
+      // Over-partition compute bound instructions, so that the fork-join
+      // runtime can balance the tasks across threads which do not all make
+      // progress at the same rate. I/O bound instructions are not
+      // over-partitioned, as they are limited by memory bandwidth rather than
+      // by the progress of individual threads.
+      max_parallelism = kTasksPerThread * max_parallelism_;
       // Calculate the instruction cost in cycles.
       // TODO(b/29630486) Improve on this linear cost model.
       // Consider making 'min_cost_per_thread' be a function of the target
@@ -97,7 +107,7 @@ class DefaultCostModel : public ParallelCostModel {
       // Minimum per-thread cost is 100us of work on a 2GHz core.
       min_cost_per_thread = 100000;
     }
-    // Return target parallel task count in [1, max_parallelism_].
+    // Return target parallel task count in [1, max_parallelism].
     return std::min(
         max_parallelism,
         std::max(int64_t{1}, instruction_cost / min_cost_per_thread));
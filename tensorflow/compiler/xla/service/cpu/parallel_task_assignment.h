@@ -35,7 +35,10 @@ class ParallelCostModel {
 // ParallelTaskAssignment computes parallel task counts for HLOs in 'module'.
 class ParallelTaskAssignment {
  public:
-  // 'max_parallelism': the maximum parallel task count per instruction.
+  // 'max_parallelism': the number of threads available to an instruction.
+  //                    Compute bound instructions may be assigned a multiple
+  //                    of this many tasks, which the fork-join runtime
+  //                    balances across the threads.
   // 'shape_size': shape size function used by HloCostAnalysis during parallel
   //               task assignment.
   // 'module': the containing HloModule.
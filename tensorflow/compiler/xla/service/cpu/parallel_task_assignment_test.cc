@@ -206,5 +206,50 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ComputeBoundOperationIsOverPartitioned) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_compute_bound
+    fused_computation {
+      p = f32[4194304] parameter(0)
+      e0 = f32[4194304] exponential(p)
+      e1 = f32[4194304] exponential(e0)
+      e2 = f32[4194304] exponential(e1)
+      e3 = f32[4194304] exponential(e2)
+      ROOT e4 = f32[4194304] exponential(e3)
+    }
+    ENTRY compute_bound {
+      p = f32[4194304] parameter(0)
+      ROOT fusion = f32[4194304] fusion(p), kind=kLoop, calls=fused_computation
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  cpu::ParallelTaskAssignment assignment(max_parallelism_, shape_size_func_,
+                                         m.get(), &target_machine_features_);
+  EXPECT_GT(assignment.GetTargetParallelTaskCount(
+                m->entry_computation()->root_instruction()),
+            max_parallelism_);
+}
+
+TEST_F(ParallelTaskAssignmentTest, IoBoundOperationIsNotOverPartitioned) {
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_io_bound
+    ENTRY io_bound {
+      p0 = f32[4194304] parameter(0)
+      p1 = f32[4194304] parameter(1)
+      ROOT add = f32[4194304] add(p0, p1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  cpu::ParallelTaskAssignment assignment(max_parallelism_, shape_size_func_,
+                                         m.get(), &target_machine_features_);
+  EXPECT_LE(assignment.GetTargetParallelTaskCount(
+                m->entry_computation()->root_instruction()),
+            max_parallelism_);
+}
+
 }  // namespace
 }  // namespace xla
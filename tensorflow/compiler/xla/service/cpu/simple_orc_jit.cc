@@ -242,6 +242,11 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddObjFile(
+    std::unique_ptr<llvm::MemoryBuffer> obj_file) {
+  return object_layer_.add(*main_jit_dylib_, std::move(obj_file));
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
@@ -27,6 +27,7 @@ limitations under the License.
 #include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/TargetParser/Triple.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
@@ -81,6 +82,10 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Adds an object file that was compiled outside of the JIT, e.g. from one of
+  // the parts of a module that was split to be compiled concurrently.
+  llvm::Error AddObjFile(std::unique_ptr<llvm::MemoryBuffer> obj_file);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
 #include "tensorflow/compiler/xla/service/cpu/test_target_triple_helper.h"
@@ -111,6 +112,52 @@ INSTANTIATE_TEST_SUITE_P(CpuEigenDotOperationTestInstantiation,
                          ::testing::ValuesIn(GetDotTestCases()),
                          DotTestSpecToString);
 
+class CpuSmallDotOperationTest : public CpuCodegenTest {
+ protected:
+  void CompileAndCheck(absl::string_view hlo_text,
+                       const std::string& filecheck_lines) {
+    TF_ASSERT_OK_AND_ASSIGN(auto hlo_module,
+                            ParseAndReturnVerifiedModule(hlo_text));
+    CpuAotCompilationOptions options{
+        /*triple=*/kTargetTripleForHost, /*cpu_name=*/kTargetCpuForHost,
+        /*features=*/"",
+        /*entry_point_name=*/"entry",
+        /*relocation_model=*/CpuAotCompilationOptions::RelocationModel::Static};
+
+    CompileAheadOfTimeAndVerifyIr(std::move(hlo_module), options,
+                                  filecheck_lines,
+                                  /*match_optimized_ir=*/true);
+  }
+};
+
+TEST_F(CpuSmallDotOperationTest, SmallDotOpIsEmittedInline) {
+  const char* hlo_text = R"(
+HloModule SmallDot
+
+ENTRY main {
+  lhs = f32[16,64] parameter(0)
+  rhs = f32[64,32] parameter(1)
+  ROOT dot = f32[16,32] dot(lhs, rhs),
+      lhs_contracting_dims={1}, rhs_contracting_dims={0}
+}
+)";
+  CompileAndCheck(hlo_text, R"(CHECK-NOT: call void @__xla_cpu_runtime_)");
+}
+
+TEST_F(CpuSmallDotOperationTest, SmallBatchDotOpIsEmittedInline) {
+  const char* hlo_text = R"(
+HloModule SmallBatchDot
+
+ENTRY main {
+  lhs = f32[8,16,64] parameter(0)
+  rhs = f32[8,64,32] parameter(1)
+  ROOT dot = f32[8,16,32] dot(lhs, rhs), lhs_batch_dims={0},
+      lhs_contracting_dims={2}, rhs_batch_dims={0}, rhs_contracting_dims={1}
+}
+)";
+  CompileAndCheck(hlo_text, R"(CHECK-NOT: call void @__xla_cpu_runtime_)");
+}
+
 }  // namespace
 }  // namespace cpu
 }  // namespace xla
@@ -0,0 +1,93 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Tests that programs compiled from several LLVM modules compute the same
+// results as the reference backend.
+class CpuSplitModuleTest : public CpuCodegenTest {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuSplitModuleTest, SeveralComputations) {
+  constexpr char hlo_string[] = R"(
+HloModule SeveralComputations
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+max {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT max = f32[] maximum(lhs, rhs)
+}
+
+cond {
+  state = (s32[], f32[64]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(5)
+  ROOT lt = pred[] compare(i, limit), direction=LT
+}
+
+body {
+  state = (s32[], f32[64]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  x = f32[64] get-tuple-element(state), index=1
+  half = f32[] constant(0.5)
+  halves = f32[64] broadcast(half), dimensions={}
+  next_x = f32[64] multiply(x, halves)
+  exp = f32[64] exponential(next_x)
+  ROOT next_state = (s32[], f32[64]) tuple(next_i, exp)
+}
+
+ENTRY main {
+  p0 = f32[64,32] parameter(0)
+  p1 = f32[32,64] parameter(1)
+  dot = f32[64,64] dot(p0, p1), lhs_contracting_dims={1},
+      rhs_contracting_dims={0}
+  zero = f32[] constant(0)
+  sum = f32[64] reduce(dot, zero), dimensions={1}, to_apply=add
+  lowest = f32[] constant(-inf)
+  maximum = f32[64] reduce(dot, lowest), dimensions={1}, to_apply=max
+  tanh = f32[64] tanh(sum)
+  i0 = s32[] constant(0)
+  init = (s32[], f32[64]) tuple(i0, tanh)
+  loop = (s32[], f32[64]) while(init), condition=cond, body=body
+  x = f32[64] get-tuple-element(loop), index=1
+  ROOT result = (f32[64], f32[64]) tuple(x, maximum)
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_string, ErrorSpec{1e-4, 1e-4}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
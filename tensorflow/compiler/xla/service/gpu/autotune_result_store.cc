@@ -0,0 +1,122 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/fingerprint.h"
+#include "tensorflow/tsl/platform/path.h"
+
+namespace xla {
+namespace gpu {
+
+StatusOr<std::optional<std::string>> DirectoryAutotuneResultStore::Read(
+    absl::string_view key) {
+  tsl::Env* env = tsl::Env::Default();
+  const std::string path = FilePath(key);
+  if (!env->FileExists(path).ok()) {
+    return std::optional<std::string>();
+  }
+  std::string results;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env, path, &results));
+  return std::make_optional(std::move(results));
+}
+
+Status DirectoryAutotuneResultStore::Write(absl::string_view key,
+                                           absl::string_view results) {
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory_));
+  const std::string path = FilePath(key);
+  // The temporary file name is unique across hosts, so that concurrent writers
+  // do not clobber each other's temporary files.
+  std::string temp_path = absl::StrCat(path, ".");
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return tsl::errors::Internal("Failed to create a temporary file name for ",
+                                 path);
+  }
+  TF_RETURN_IF_ERROR(tsl::WriteStringToFile(env, temp_path, results));
+  Status status = env->RenameFile(temp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return status;
+}
+
+std::string DirectoryAutotuneResultStore::FilePath(
+    absl::string_view key) const {
+  return tsl::io::JoinPath(
+      directory_,
+      absl::StrCat(absl::Hex(tsl::Fingerprint64(key), absl::kZeroPad16),
+                   ".autotune_results"));
+}
+
+std::string AutotuneResultStoreKey(const se::DeviceDescription& device) {
+  return absl::StrCat(device.model_str(), ";driver=", device.driver_version());
+}
+
+namespace {
+
+absl::Mutex shared_store_mu(absl::kConstInit);
+
+std::unique_ptr<AutotuneResultStore>& SharedStore()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(shared_store_mu) {
+  static auto* store = new std::unique_ptr<AutotuneResultStore>();
+  return *store;
+}
+
+absl::flat_hash_map<std::string, std::unique_ptr<AutotuneResultStore>>&
+DirectoryStores() ABSL_EXCLUSIVE_LOCKS_REQUIRED(shared_store_mu) {
+  static auto* stores = new absl::flat_hash_map<
+      std::string, std::unique_ptr<AutotuneResultStore>>();
+  return *stores;
+}
+
+}  // namespace
+
+void SetSharedAutotuneResultStore(std::unique_ptr<AutotuneResultStore> store) {
+  absl::MutexLock lock(&shared_store_mu);
+  SharedStore() = std::move(store);
+}
+
+AutotuneResultStore* GetSharedAutotuneResultStore(
+    const DebugOptions& debug_options) {
+  absl::MutexLock lock(&shared_store_mu);
+  if (SharedStore() != nullptr) {
+    return SharedStore().get();
+  }
+  const std::string& directory =
+      debug_options.xla_gpu_shared_autotune_cache_dir();
+  if (directory.empty()) {
+    return nullptr;
+  }
+  std::unique_ptr<AutotuneResultStore>& store = DirectoryStores()[directory];
+  if (store == nullptr) {
+    store = std::make_unique<DirectoryAutotuneResultStore>(directory);
+  }
+  return store.get();
+}
+
+}  // namespace gpu
+}  // namespace xla
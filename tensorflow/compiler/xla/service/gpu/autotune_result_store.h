@@ -0,0 +1,86 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULT_STORE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULT_STORE_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/stream_executor/device_description.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+
+namespace xla {
+namespace gpu {
+
+// A store of serialized autotuning results (see autotune_serialize.h) which is
+// shared between processes, e.g. between the replicas of a job, so that only
+// the first process to compile a program has to autotune it.
+//
+// Results are stored under a key identifying the device model and the driver
+// version they were measured with, see `AutotuneResultStoreKey`.
+class AutotuneResultStore {
+ public:
+  virtual ~AutotuneResultStore() = default;
+
+  // Returns the results stored under `key`, or nullopt if there are none.
+  virtual StatusOr<std::optional<std::string>> Read(absl::string_view key) = 0;
+
+  // Replaces the results stored under `key` with `results`. Concurrent `Read`s
+  // must observe either the previous or the new results, never a mix of both.
+  virtual Status Write(absl::string_view key, absl::string_view results) = 0;
+};
+
+// An `AutotuneResultStore` with one file per key in a directory, which may be
+// on a file system shared by all the processes (any file system supported by
+// tsl::Env). Files are replaced atomically by renaming a temporary file.
+class DirectoryAutotuneResultStore : public AutotuneResultStore {
+ public:
+  explicit DirectoryAutotuneResultStore(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  StatusOr<std::optional<std::string>> Read(absl::string_view key) override;
+  Status Write(absl::string_view key, absl::string_view results) override;
+
+ private:
+  std::string FilePath(absl::string_view key) const;
+
+  const std::string directory_;
+};
+
+// Returns the key under which the autotuning results measured on `device` are
+// stored.
+std::string AutotuneResultStoreKey(const se::DeviceDescription& device);
+
+// Makes `store` the shared store of the process, instead of the directory set
+// by --xla_gpu_shared_autotune_cache_dir.
+void SetSharedAutotuneResultStore(std::unique_ptr<AutotuneResultStore> store);
+
+// Returns the shared store of the process: the one set with
+// `SetSharedAutotuneResultStore` if any, else the directory set in
+// `debug_options`, else null.
+AutotuneResultStore* GetSharedAutotuneResultStore(
+    const DebugOptions& debug_options);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_RESULT_STORE_H_
@@ -0,0 +1,99 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/compiler/xla/stream_executor/device_description.h"
+#include "tensorflow/compiler/xla/xla.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/status_matchers.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+using ::testing::Optional;
+using ::tsl::testing::IsOkAndHolds;
+
+std::string TestDirectory(const std::string& name) {
+  return tsl::io::JoinPath(tsl::testing::TmpDir(), name);
+}
+
+TEST(DirectoryAutotuneResultStoreTest, ReadsWhatWasWritten) {
+  DirectoryAutotuneResultStore store(TestDirectory("reads_what_was_written"));
+  EXPECT_THAT(store.Read("key"), IsOkAndHolds(std::nullopt));
+
+  TF_ASSERT_OK(store.Write("key", "results"));
+  EXPECT_THAT(store.Read("key"),
+              IsOkAndHolds(Optional(std::string("results"))));
+  EXPECT_THAT(store.Read("other key"), IsOkAndHolds(std::nullopt));
+
+  TF_ASSERT_OK(store.Write("key", "new results"));
+  EXPECT_THAT(store.Read("key"),
+              IsOkAndHolds(Optional(std::string("new results"))));
+}
+
+TEST(DirectoryAutotuneResultStoreTest, LeavesNoTemporaryFiles) {
+  const std::string directory = TestDirectory("leaves_no_temporary_files");
+  DirectoryAutotuneResultStore store(directory);
+  TF_ASSERT_OK(store.Write("key", "results"));
+  TF_ASSERT_OK(store.Write("key", "new results"));
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(tsl::Env::Default()->GetChildren(directory, &children));
+  EXPECT_EQ(children.size(), 1);
+}
+
+std::string KeyForDevice(const std::string& model_str,
+                         const std::string& driver_version) {
+  se::internal::DeviceDescriptionBuilder builder;
+  builder.set_model_str(model_str);
+  builder.set_driver_version(driver_version);
+  return AutotuneResultStoreKey(*builder.Build());
+}
+
+TEST(AutotuneResultStoreKeyTest, DependsOnModelAndDriverVersion) {
+  EXPECT_EQ(KeyForDevice("model", "1"), KeyForDevice("model", "1"));
+  EXPECT_NE(KeyForDevice("model", "1"), KeyForDevice("other model", "1"));
+  EXPECT_NE(KeyForDevice("model", "1"), KeyForDevice("model", "2"));
+}
+
+TEST(SharedAutotuneResultStoreTest, UsesDirectoryFromDebugOptions) {
+  DebugOptions debug_options;
+  EXPECT_EQ(GetSharedAutotuneResultStore(debug_options), nullptr);
+
+  debug_options.set_xla_gpu_shared_autotune_cache_dir(
+      TestDirectory("uses_directory_from_debug_options"));
+  AutotuneResultStore* store = GetSharedAutotuneResultStore(debug_options);
+  ASSERT_NE(store, nullptr);
+  EXPECT_EQ(GetSharedAutotuneResultStore(debug_options), store);
+  TF_ASSERT_OK(store->Write("key", "results"));
+  EXPECT_THAT(DirectoryAutotuneResultStore(
+                  debug_options.xla_gpu_shared_autotune_cache_dir())
+                  .Read("key"),
+              IsOkAndHolds(Optional(std::string("results"))));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
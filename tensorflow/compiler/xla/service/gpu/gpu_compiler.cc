@@ -66,6 +66,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/broadcast_canonicalizer.h"
 #include "tensorflow/compiler/xla/service/buffer_assignment.h"
 #include "tensorflow/compiler/xla/service/call_inliner.h"
+#include "tensorflow/compiler/xla/service/collective_combine_threshold.h"
 #include "tensorflow/compiler/xla/service/collectives_schedule_linearizer.h"
 #include "tensorflow/compiler/xla/service/comparison_expander.h"
 #include "tensorflow/compiler/xla/service/conditional_canonicalizer.h"
@@ -89,6 +90,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gather_simplifier.h"
 #include "tensorflow/compiler/xla/service/gpu/alias_passthrough_params.h"
 #include "tensorflow/compiler/xla/service/gpu/all_reduce_blueconnect.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_result_store.h"
 #include "tensorflow/compiler/xla/service/gpu/compile_module_to_llvm_ir.h"
 #include "tensorflow/compiler/xla/service/gpu/conv_layout_normalization.h"
 #include "tensorflow/compiler/xla/service/gpu/copy_fusion.h"
@@ -123,6 +125,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/metrics.h"
 #include "tensorflow/compiler/xla/service/gpu/move_copy_to_users.h"
 #include "tensorflow/compiler/xla/service/gpu/multi_output_fusion.h"
+#include "tensorflow/compiler/xla/service/gpu/priority_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_degenerate_dim_remover.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_dimension_grouper.h"
 #include "tensorflow/compiler/xla/service/gpu/reduction_layout_normalizer.h"
@@ -196,6 +199,7 @@ limitations under the License.
 #include "tensorflow/tsl/profiler/lib/traceme.h"
 
 #if GOOGLE_CUDA
+#include "tensorflow/compiler/xla/autotune_serialize.h"
 #include "tensorflow/compiler/xla/service/gpu/gemm_algorithm_picker.h"
 #include "tensorflow/compiler/xla/service/gpu/triton_autotuner.h"
 #elif TENSORFLOW_USE_ROCM
@@ -232,6 +236,87 @@ bool RequiresCollectiveScheduleLinearizer(const HloModule* module) {
   return false;
 }
 
+struct CollectiveCombineThresholds {
+  int64_t all_reduce;
+  int64_t all_gather;
+  int64_t reduce_scatter;
+};
+
+// Returns the combine thresholds in bytes of the collectives, derived from the
+// collective profile if there is one.
+CollectiveCombineThresholds GetCollectiveCombineThresholds(
+    const DebugOptions& debug_options) {
+  CollectiveCombineThresholds thresholds{
+      debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
+      debug_options.xla_gpu_all_gather_combine_threshold_bytes(),
+      debug_options.xla_gpu_reduce_scatter_combine_threshold_bytes()};
+  const std::string& profile_path =
+      debug_options.xla_gpu_collective_profile_path();
+  if (profile_path.empty()) {
+    return thresholds;
+  }
+  CollectiveProfileProto profile;
+  Status status =
+      tsl::ReadTextOrBinaryProto(tsl::Env::Default(), profile_path, &profile);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read collective profile " << profile_path
+                 << ": " << status;
+    return thresholds;
+  }
+  // Collectives without usable measurements keep their static threshold.
+  auto update = [&](absl::string_view name, const auto& measurements,
+                    int64_t* threshold) {
+    if (measurements.empty()) return;
+    StatusOr<int64_t> profiled = CombineThresholdFromProfile(measurements);
+    if (!profiled.ok()) {
+      LOG(WARNING) << "Ignoring " << name << " collective profile: "
+                   << profiled.status();
+      return;
+    }
+    VLOG(1) << "Using profiled " << name << " combine threshold of "
+            << *profiled << " bytes";
+    *threshold = *profiled;
+  };
+  update("all-reduce", profile.all_reduce(), &thresholds.all_reduce);
+  update("all-gather", profile.all_gather(), &thresholds.all_gather);
+  update("reduce-scatter", profile.reduce_scatter(),
+         &thresholds.reduce_scatter);
+  return thresholds;
+}
+
+#if GOOGLE_CUDA
+// Loads the autotuning results in `store` for the device of `stream_exec` into
+// the autotuners' caches. Returns the serialized results, if any.
+StatusOr<std::optional<std::string>> LoadSharedAutotuneResults(
+    AutotuneResultStore* store, se::StreamExecutor* stream_exec) {
+  TF_ASSIGN_OR_RETURN(
+      std::optional<std::string> results,
+      store->Read(AutotuneResultStoreKey(stream_exec->GetDeviceDescription())));
+  if (results.has_value()) {
+    TF_RETURN_IF_ERROR(xla::LoadAutotuneResults(*results));
+  }
+  return results;
+}
+
+// Merges the autotuners' caches into the autotuning results in `store` for the
+// device of `stream_exec`.
+Status StoreSharedAutotuneResults(AutotuneResultStore* store,
+                                  se::StreamExecutor* stream_exec) {
+  const std::string key =
+      AutotuneResultStoreKey(stream_exec->GetDeviceDescription());
+  // Load the results again first, so that the results which other processes
+  // stored since they were last loaded are kept.
+  TF_ASSIGN_OR_RETURN(std::optional<std::string> stored_results,
+                      LoadSharedAutotuneResults(store, stream_exec));
+  TF_ASSIGN_OR_RETURN(std::string results, xla::SerializeAutotuneResults());
+  if (stored_results == results) {
+    // Nothing new was autotuned.
+    return OkStatus();
+  }
+  return store->Write(key, results);
+}
+#endif  // GOOGLE_CUDA
+
 }  // end anonymous namespace
 
 StatusOr<std::unique_ptr<Executable>>
@@ -687,10 +772,15 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
         HloVerifierOpts{}.MakeLayoutSensitive().WithInstructionCanChangeLayout(
             LayoutAssignment::InstructionCanChangeLayout),
         /*debug_only=*/true);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false,
-                                         gpu_device_info);
-    fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true,
-                                         gpu_device_info);
+    if (hlo_module->config().debug_options().xla_gpu_enable_priority_fusion()) {
+      fusion.AddPass<GpuPriorityFusion>(gpu_device_info,
+                                        ShapeSizeBytesFunction());
+    } else {
+      fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/false,
+                                           gpu_device_info);
+      fusion.AddPass<GpuInstructionFusion>(/*may_duplicate=*/true,
+                                           gpu_device_info);
+    }
     fusion.AddPass<FusionMerger>(gpu_device_info, ShapeSizeBytesFunction());
     // Running CSE affects how many users an op has. This plays a role in what
     // we detect as a tiled transpose fusion.
@@ -722,15 +812,14 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
 
   {
     HloPassPipeline pipeline("post-fusion optimization");
-    pipeline.AddPass<AllGatherCombiner>(
-        debug_options.xla_gpu_all_gather_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
-    pipeline.AddPass<AllReduceCombiner>(
-        debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
-    pipeline.AddPass<ReduceScatterCombiner>(
-        debug_options.xla_gpu_reduce_scatter_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
+    CollectiveCombineThresholds thresholds =
+        GetCollectiveCombineThresholds(debug_options);
+    pipeline.AddPass<AllGatherCombiner>(thresholds.all_gather,
+                                        /*combine_threshold_count=*/256);
+    pipeline.AddPass<AllReduceCombiner>(thresholds.all_reduce,
+                                        /*combine_threshold_count=*/256);
+    pipeline.AddPass<ReduceScatterCombiner>(thresholds.reduce_scatter,
+                                            /*combine_threshold_count=*/256);
 
     if (debug_options.xla_gpu_all_reduce_contiguous()) {
       pipeline.AddPass<AllReduceContiguous>();
@@ -943,6 +1032,21 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
     TF_RETURN_IF_ERROR(TritonAutotuner::LoadAutotuneResults(*autotune_results));
 #endif  // GOOGLE_CUDA
   }
+#if GOOGLE_CUDA
+  // Autotuning results shared with the other processes of the job, if any.
+  AutotuneResultStore* shared_autotune_results =
+      autotune_config.is_online() ? GetSharedAutotuneResultStore(debug_options)
+                                  : nullptr;
+  if (shared_autotune_results != nullptr) {
+    // The shared results are only a cache: on failure, we autotune as usual.
+    Status status =
+        LoadSharedAutotuneResults(shared_autotune_results, stream_exec)
+            .status();
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to load shared autotuning results: " << status;
+    }
+  }
+#endif  // GOOGLE_CUDA
   if (GpuConvAlgorithmPicker::IsEnabled(hlo_module)) {
     pipeline.AddPass<GpuConvAlgorithmPicker>(autotune_config);
   }
@@ -1002,6 +1106,16 @@ Status GpuCompiler::OptimizeHloPostLayoutAssignment(
   pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/true);
   TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
 
+#if GOOGLE_CUDA
+  if (shared_autotune_results != nullptr) {
+    Status status =
+        StoreSharedAutotuneResults(shared_autotune_results, stream_exec);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to store shared autotuning results: " << status;
+    }
+  }
+#endif  // GOOGLE_CUDA
+
   return OkStatus();
 }
 
@@ -0,0 +1,197 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/priority_fusion.h"
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
+#include "tensorflow/compiler/xla/service/instruction_fusion.h"
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// A fusion queue which hands out the consumers of the producer whose fusion
+// into all its consumers saves the most run time first.
+class GpuPriorityFusionQueue : public FusionQueue {
+  // The run time saved by fusing a producer into all its consumers. Ties are
+  // broken by the unique id of the producer to make the order deterministic.
+  using Priority = std::pair<absl::Duration, int>;
+  using PriorityQueue = std::map<Priority, HloInstruction*>;
+  using CanFuseCallback = std::function<FusionDecision(
+      HloInstruction* /*consumer*/, int64_t /*operand_index*/)>;
+
+ public:
+  GpuPriorityFusionQueue(
+      HloComputation* computation,
+      HloCostAnalysis::ShapeSizeFunction shape_size_function,
+      const GpuDeviceInfo& gpu_device_info, CanFuseCallback can_fuse)
+      : cost_analysis_(GpuHloCostAnalysis::Options{
+            shape_size_function,
+            /*per_second_rates=*/{},
+            /*count_multiple_input_accesses=*/true}),
+        gpu_device_info_(gpu_device_info),
+        can_fuse_(std::move(can_fuse)) {
+    VLOG(2) << "Running full HLO cost analysis for " << computation->name();
+    TF_CHECK_OK(computation->Accept(&cost_analysis_));
+    for (HloInstruction* instruction :
+         computation->MakeInstructionPostOrder()) {
+      UpdatePriority(instruction);
+    }
+  }
+
+  std::pair<HloInstruction*, std::vector<int64_t>>
+  DequeueNextInstructionAndOperandsToFuseInOrder() override {
+    while (current_consumers_.empty()) {
+      current_producer_ = nullptr;
+      if (producer_priority_queue_.empty()) {
+        return {nullptr, {}};
+      }
+      auto next = std::prev(producer_priority_queue_.end());
+      current_producer_ = next->second;
+      VLOG(2) << "Fusing " << current_producer_->name()
+              << " into all its users, saving " << next->first.first;
+      reverse_map_.erase(current_producer_);
+      producer_priority_queue_.erase(next);
+      current_consumers_ = current_producer_->users();
+    }
+    HloInstruction* consumer = current_consumers_.back();
+    current_consumers_.pop_back();
+    return {consumer, {consumer->operand_index(current_producer_)}};
+  }
+
+  void PreFusion(HloInstruction* producer, HloInstruction* consumer) override {
+    // The consumer is either replaced by a new fusion or changes, so it is
+    // dropped from the analysis and revisited after the fusion.
+    TF_CHECK_OK(cost_analysis_.RemoveInstruction(consumer));
+    RemoveFromQueue(consumer);
+  }
+
+  void OnFusingInstruction(HloInstruction* fusion,
+                           HloInstruction* original_producer,
+                           HloInstruction* original_consumer) override {
+    TF_CHECK_OK(cost_analysis_.RevisitInstruction(fusion));
+    // The operands of the fusion have a new consumer, which changes the run
+    // time saved by fusing them.
+    for (HloInstruction* operand : fusion->operands()) {
+      UpdatePriority(operand);
+    }
+    UpdatePriority(fusion);
+  }
+
+  void RemoveInstruction(HloInstruction* instruction) override {
+    RemoveFromQueue(instruction);
+    TF_CHECK_OK(cost_analysis_.RemoveInstruction(instruction));
+  }
+
+  const std::vector<bool>* FusionConfiguration() override {
+    return &fusion_config_;
+  }
+
+ private:
+  // Returns the run time saved by fusing `producer` into all its consumers, or
+  // nullopt if it can't be fused into all of them.
+  std::optional<absl::Duration> CalculateProducerPriority(
+      HloInstruction* producer) {
+    if (!producer->IsFusible() || producer->user_count() == 0) {
+      return std::nullopt;
+    }
+    for (HloInstruction* user : producer->users()) {
+      FusionDecision decision =
+          can_fuse_(user, user->operand_index(producer));
+      if (!decision.CanFuse()) {
+        VLOG(5) << "Not fusing " << producer->name() << " into "
+                << user->name() << ": " << decision.Explain();
+        return std::nullopt;
+      }
+    }
+    GpuPerformanceModel::RunTimes run_times =
+        GpuPerformanceModel::EstimateRunTimes(producer, &cost_analysis_,
+                                              gpu_device_info_,
+                                              producer->users());
+    return run_times.time_unfused - run_times.time_fused;
+  }
+
+  // Recomputes the priority of `producer`, and only keeps it in the queue if
+  // fusing it saves time.
+  void UpdatePriority(HloInstruction* producer) {
+    RemoveFromQueue(producer);
+    // The consumers of the current producer are being handed out, and the ones
+    // it could not be fused into must not be revisited.
+    if (producer == current_producer_) {
+      return;
+    }
+    std::optional<absl::Duration> saved_time =
+        CalculateProducerPriority(producer);
+    if (!saved_time.has_value() || *saved_time <= absl::ZeroDuration()) {
+      return;
+    }
+    auto it = producer_priority_queue_
+                  .emplace(Priority(*saved_time, producer->unique_id()),
+                           producer)
+                  .first;
+    reverse_map_[producer] = it;
+  }
+
+  void RemoveFromQueue(HloInstruction* instruction) {
+    auto it = reverse_map_.find(instruction);
+    if (it == reverse_map_.end()) {
+      return;
+    }
+    producer_priority_queue_.erase(it->second);
+    reverse_map_.erase(it);
+  }
+
+  GpuHloCostAnalysis cost_analysis_;
+  const GpuDeviceInfo& gpu_device_info_;
+  CanFuseCallback can_fuse_;
+
+  PriorityQueue producer_priority_queue_;
+  absl::flat_hash_map<HloInstruction*, PriorityQueue::iterator> reverse_map_;
+
+  // The producer whose consumers are being handed out, and the consumers left.
+  HloInstruction* current_producer_ = nullptr;
+  std::vector<HloInstruction*> current_consumers_;
+
+  std::vector<bool> fusion_config_;
+};
+
+}  // namespace
+
+std::unique_ptr<FusionQueue> GpuPriorityFusion::GetFusionQueue(
+    HloComputation* computation) {
+  return std::make_unique<GpuPriorityFusionQueue>(
+      computation, shape_size_function_, gpu_device_info_,
+      [this](HloInstruction* consumer, int64_t operand_index) {
+        return ShouldFuse(consumer, operand_index);
+      });
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,65 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRIORITY_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRIORITY_FUSION_H_
+
+#include <memory>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/fusion_queue.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info.h"
+#include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+
+namespace xla {
+namespace gpu {
+
+// An instruction fusion pass which fuses producers into all their consumers in
+// the order of the run time the fusions save, as estimated by the
+// GpuPerformanceModel.
+//
+// Unlike GpuInstructionFusion, which visits consumers in reverse post order and
+// fuses every producer the heuristics allow, this pass keeps all producers of
+// a computation in a priority queue keyed by the estimated difference between
+// their unfused and fused run times. The most beneficial fusion is applied
+// first, and the priorities of the producers whose consumers changed are
+// recomputed after each fusion. Producers are only fused if they can be fused
+// into all their consumers and the model predicts a speedup, which avoids
+// duplicating expensive producers into many consumers.
+class GpuPriorityFusion : public GpuInstructionFusion {
+ public:
+  GpuPriorityFusion(const GpuDeviceInfo& d,
+                    HloCostAnalysis::ShapeSizeFunction f)
+      : GpuInstructionFusion(/*may_duplicate=*/true, d),
+        gpu_device_info_(d),
+        shape_size_function_(f) {}
+
+  absl::string_view name() const override { return "priority-fusion"; }
+
+ protected:
+  std::unique_ptr<FusionQueue> GetFusionQueue(
+      HloComputation* computation) override;
+
+ private:
+  const GpuDeviceInfo gpu_device_info_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_PRIORITY_FUSION_H_
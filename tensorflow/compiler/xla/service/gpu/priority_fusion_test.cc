@@ -0,0 +1,83 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/priority_fusion.h"
+
+#include "tensorflow/compiler/xla/hlo/utils/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_device_info_for_tests.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+class PriorityFusionTest : public HloTestBase {
+  HloCostAnalysis::ShapeSizeFunction ShapeSizeBytesFunction() const {
+    return [&](const Shape& shape) {
+      constexpr int64_t kPointerSize = 8;
+      return ShapeUtil::ByteSizeOf(shape, kPointerSize);
+    };
+  }
+
+ public:
+  GpuPriorityFusion priority_fusion_{TestGpuDeviceInfo::RTXA6000DeviceInfo(),
+                                     ShapeSizeBytesFunction()};
+};
+
+TEST_F(PriorityFusionTest, FusesElementwiseChain) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule FusesElementwiseChain
+
+ENTRY main {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  p1 = f32[1024,1024]{1,0} parameter(1)
+  exp = f32[1024,1024]{1,0} exponential(p0)
+  neg = f32[1024,1024]{1,0} negate(exp)
+  ROOT add = f32[1024,1024]{1,0} add(neg, p1)
+})")
+                    .value();
+  EXPECT_TRUE(priority_fusion_.Run(module.get()).value());
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Fusion(op::Parameter(), op::Parameter()));
+  EXPECT_THAT(root->fused_expression_root(),
+              op::Add(op::Negate(op::Exp(op::Parameter())), op::Parameter()));
+}
+
+TEST_F(PriorityFusionTest, DoesNotFuseIntoSomeUsers) {
+  // `exp` can't be fused into the custom call, so it is not fused into the
+  // add either, which would compute it twice.
+  auto module = ParseAndReturnVerifiedModule(R"(
+HloModule DoesNotFuseIntoSomeUsers
+
+ENTRY main {
+  p0 = f32[1024,1024]{1,0} parameter(0)
+  p1 = f32[1024,1024]{1,0} parameter(1)
+  exp = f32[1024,1024]{1,0} exponential(p0)
+  add = f32[1024,1024]{1,0} add(exp, p1)
+  custom = f32[1024,1024]{1,0} custom-call(exp), custom_call_target="foo"
+  ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) tuple(add, custom)
+})")
+                    .value();
+  priority_fusion_.Run(module.get()).value();
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Tuple(op::Add(op::Exp(), op::Parameter()),
+                              op::CustomCall(op::Exp())));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
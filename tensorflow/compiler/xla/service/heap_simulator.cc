@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/heap_simulator.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -645,49 +646,155 @@ void GlobalDecreasingSizeBestFitHeap<BufferType>::Free(const BufferType* buffer,
 
 using Chunk = HeapSimulator::Chunk;
 
+namespace {
+
+// Returns the number of nodes in the subtree rooted at `node`.
+int64_t SubtreeSize(const BufferIntervalTreeNode* node) {
+  int64_t size = 0;
+  std::vector<const BufferIntervalTreeNode*> visiting_stack;
+  if (node != nullptr) {
+    visiting_stack.push_back(node);
+  }
+  while (!visiting_stack.empty()) {
+    const BufferIntervalTreeNode* top = visiting_stack.back();
+    visiting_stack.pop_back();
+    ++size;
+    if (top->left != nullptr) {
+      visiting_stack.push_back(top->left);
+    }
+    if (top->right != nullptr) {
+      visiting_stack.push_back(top->right);
+    }
+  }
+  return size;
+}
+
+// Links the in-order sorted `nodes` into a perfectly balanced tree under
+// `parent`, and returns its root.
+BufferIntervalTreeNode* BuildBalancedTree(
+    absl::Span<BufferIntervalTreeNode* const> nodes,
+    BufferIntervalTreeNode* parent) {
+  if (nodes.empty()) {
+    return nullptr;
+  }
+  const size_t middle = nodes.size() / 2;
+  BufferIntervalTreeNode* node = nodes[middle];
+  node->parent = parent;
+  node->left = BuildBalancedTree(nodes.subspan(0, middle), node);
+  node->right = BuildBalancedTree(nodes.subspan(middle + 1), node);
+  node->subtree_end = node->end;
+  if (node->left != nullptr) {
+    node->subtree_end = std::max(node->subtree_end, node->left->subtree_end);
+  }
+  if (node->right != nullptr) {
+    node->subtree_end = std::max(node->subtree_end, node->right->subtree_end);
+  }
+  return node;
+}
+
+}  // namespace
+
 void BufferIntervalTree::Add(int64_t start, int64_t end, const Chunk& chunk) {
   node_storage_.emplace_back(BufferIntervalTreeNode{
       start, end, end, chunk,
       /*left=*/nullptr, /*right=*/nullptr, /*parent=*/nullptr});
+  BufferIntervalTreeNode* node = &node_storage_.back();
+  ++num_nodes_;
+  max_num_nodes_ = std::max(max_num_nodes_, num_nodes_);
   if (root_ == nullptr) {
-    root_ = &node_storage_.back();
+    root_ = node;
     // This is root.
     return;
   }
 
   BufferIntervalTreeNode* parent = root_;
+  int64_t depth = 1;
   while (true) {
     parent->subtree_end = std::max(parent->subtree_end, end);
     if (parent->start > start) {
       if (parent->left == nullptr) {
-        parent->left = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
+        parent->left = node;
+        break;
       }
       parent = parent->left;
     } else {
       if (parent->right == nullptr) {
-        parent->right = &node_storage_.back();
-        node_storage_.back().parent = parent;
-        return;
+        parent->right = node;
+        break;
       }
       parent = parent->right;
     }
+    ++depth;
+  }
+  node->parent = parent;
+
+  // A tree of n nodes is balanced enough as long as no node is deeper than
+  // log_{3/2}(n). Otherwise one of the ancestors of the new node, the
+  // scapegoat, has a child holding more than 2/3 of its subtree: rebuild it.
+  if (depth <= std::log(num_nodes_) / std::log(1.5)) {
+    return;
   }
+  BufferIntervalTreeNode* child = node;
+  int64_t child_size = 1;
+  for (BufferIntervalTreeNode* ancestor = parent; ancestor != nullptr;
+       ancestor = ancestor->parent) {
+    const BufferIntervalTreeNode* sibling =
+        ancestor->left == child ? ancestor->right : ancestor->left;
+    const int64_t size = child_size + 1 + SubtreeSize(sibling);
+    if (3 * child_size > 2 * size) {
+      Rebuild(ancestor);
+      return;
+    }
+    child = ancestor;
+    child_size = size;
+  }
+}
+
+void BufferIntervalTree::Rebuild(BufferIntervalTreeNode* subtree_root) {
+  BufferIntervalTreeNode* parent = subtree_root->parent;
+  BufferIntervalTreeNode** link = &root_;
+  if (parent != nullptr) {
+    link = parent->left == subtree_root ? &parent->left : &parent->right;
+  }
+  // Collect the nodes in order, then relink them.
+  std::vector<BufferIntervalTreeNode*> nodes;
+  std::vector<BufferIntervalTreeNode*> visiting_stack;
+  BufferIntervalTreeNode* node = subtree_root;
+  while (node != nullptr || !visiting_stack.empty()) {
+    while (node != nullptr) {
+      visiting_stack.push_back(node);
+      node = node->left;
+    }
+    node = visiting_stack.back();
+    visiting_stack.pop_back();
+    nodes.push_back(node);
+    node = node->right;
+  }
+  *link = BuildBalancedTree(nodes, parent);
 }
 
 bool BufferIntervalTree::Remove(int64_t start, int64_t end,
                                 const Chunk& chunk) {
-  BufferIntervalTreeNode* to_delete = root_;
-  while (to_delete != nullptr) {
-    if (to_delete->start == start && to_delete->end == end &&
-        to_delete->chunk.offset == chunk.offset) {
+  // Rebuilding a subtree may move nodes with the same start to either side of
+  // each other, so both children are searched on a tie.
+  BufferIntervalTreeNode* to_delete = nullptr;
+  std::vector<BufferIntervalTreeNode*> visiting_stack;
+  if (root_ != nullptr) {
+    visiting_stack.push_back(root_);
+  }
+  while (!visiting_stack.empty()) {
+    BufferIntervalTreeNode* top = visiting_stack.back();
+    visiting_stack.pop_back();
+    if (top->start == start && top->end == end &&
+        top->chunk.offset == chunk.offset) {
+      to_delete = top;
       break;
     }
-    if (start < to_delete->start) {
-      to_delete = to_delete->left;
-    } else {
-      to_delete = to_delete->right;
+    if (start <= top->start && top->left != nullptr) {
+      visiting_stack.push_back(top->left);
+    }
+    if (start >= top->start && top->right != nullptr) {
+      visiting_stack.push_back(top->right);
     }
   }
   if (to_delete == nullptr) {
@@ -735,23 +842,25 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
     if (root_ == to_delete) {
       // Deleting root is simply reseting root;
       root_ = to_delete->left;
-      return true;
-    }
-
-    if (to_delete == to_delete->parent->left) {
-      // to_delete is left child of parent.
-      to_delete->parent->left = to_delete->left;
-    }
-    if (to_delete == to_delete->parent->right) {
-      // to_delete is right child of parent.
-      to_delete->parent->right = to_delete->left;
-    }
-    // Rewire parent to the node being moved up.
-    if (to_delete->left) {
-      to_delete->left->parent = to_delete->parent;
+      if (root_ != nullptr) {
+        root_->parent = nullptr;
+      }
+    } else {
+      if (to_delete == to_delete->parent->left) {
+        // to_delete is left child of parent.
+        to_delete->parent->left = to_delete->left;
+      }
+      if (to_delete == to_delete->parent->right) {
+        // to_delete is right child of parent.
+        to_delete->parent->right = to_delete->left;
+      }
+      // Rewire parent to the node being moved up.
+      if (to_delete->left) {
+        to_delete->left->parent = to_delete->parent;
+      }
+      // Fix up starting from subroot.
+      fix_up(to_delete);
     }
-    // Fix up starting from subroot.
-    fix_up(to_delete);
   } else {
     // 1. Find left-most node of the right subtree, promote it to the position
     // of to_delete.
@@ -800,6 +909,15 @@ bool BufferIntervalTree::Remove(int64_t start, int64_t end,
     // `to_promote_parent`.
     fix_up(to_promote_parent);
   }
+  // Rebuild the whole tree once a third of its nodes have been removed, so
+  // that it stays balanced relative to its current size.
+  --num_nodes_;
+  if (3 * num_nodes_ < 2 * max_num_nodes_) {
+    if (root_ != nullptr) {
+      Rebuild(root_);
+    }
+    max_num_nodes_ = num_nodes_;
+  }
   // Don't free the entry in node_storage_ until we free the entire tree.
   return true;
 }
@@ -356,6 +356,13 @@ struct BufferIntervalTreeNode {
 };
 
 // An interval tree that can query buffers overlapping in time.
+//
+// The tree is a scapegoat tree keyed by the alloc time: buffers are added in
+// decreasing size order, which is often close to their alloc time order, so an
+// unbalanced tree would degenerate into a list and make the heap simulation of
+// large modules quadratic. Whenever an insertion is too deep, or enough nodes
+// have been removed, a subtree is rebuilt perfectly balanced, which keeps all
+// operations O(log n) amortized.
 class BufferIntervalTree {
  public:
   using Chunk = HeapSimulator::Chunk;
@@ -373,7 +380,14 @@ class BufferIntervalTree {
   BufferIntervalTreeNode* GetRoot() { return root_; }
 
  private:
+  // Rebuilds the subtree rooted at `subtree_root` perfectly balanced, in place.
+  void Rebuild(BufferIntervalTreeNode* subtree_root);
+
   BufferIntervalTreeNode* root_ = nullptr;
+  // Number of nodes in the tree.
+  int64_t num_nodes_ = 0;
+  // Maximum number of nodes since the whole tree was last rebuilt.
+  int64_t max_num_nodes_ = 0;
   std::list<BufferIntervalTreeNode> node_storage_;
 };
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/heap_simulator.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <limits>
@@ -23,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
@@ -37,6 +39,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
 
 namespace xla {
 namespace {
@@ -1709,6 +1712,58 @@ TEST_F(IntervalTreeTest, ThreeLevelsRightLeftChunkDifferent) {
   ASSERT_EQ(tree.GetRoot(), nullptr);
 }
 
+int64_t Height(const BufferIntervalTreeNode* node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  return 1 + std::max(Height(node->left), Height(node->right));
+}
+
+TEST_F(IntervalTreeTest, StaysBalancedWithIncreasingStarts) {
+  // Inserting the intervals by increasing start would build a list if the tree
+  // was not rebalanced.
+  constexpr int64_t kNumIntervals = 4096;
+  BufferIntervalTree tree;
+  for (int64_t i = 0; i < kNumIntervals; ++i) {
+    tree.Add(i, i + 2, HeapSimulator::Chunk::FromOffsetSize(i, 1));
+  }
+  // No node is deeper than log_{3/2}(4096) < 21.
+  EXPECT_LE(Height(tree.GetRoot()), 21);
+  EXPECT_EQ(tree.GetRoot()->subtree_end, kNumIntervals + 1);
+
+  std::vector<HeapSimulator::Chunk> chunks =
+      tree.ChunksOverlappingInTime(100, 100);
+  absl::c_sort(chunks, [](const auto& a, const auto& b) {
+    return a.offset < b.offset;
+  });
+  ASSERT_EQ(chunks.size(), 3);
+  EXPECT_EQ(chunks[0].offset, 98);
+  EXPECT_EQ(chunks[1].offset, 99);
+  EXPECT_EQ(chunks[2].offset, 100);
+
+  // Removing most of the intervals keeps the tree balanced too.
+  for (int64_t i = 0; i < kNumIntervals - 16; ++i) {
+    EXPECT_TRUE(
+        tree.Remove(i, i + 2, HeapSimulator::Chunk::FromOffsetSize(i, 1)));
+  }
+  // The tree was last rebuilt with at most 24 nodes.
+  EXPECT_LE(Height(tree.GetRoot()), 5);
+  EXPECT_EQ(tree.GetRoot()->subtree_end, kNumIntervals + 1);
+}
+
+TEST_F(IntervalTreeTest, RemovesIntervalsWithEqualStarts) {
+  constexpr int64_t kNumIntervals = 256;
+  BufferIntervalTree tree;
+  for (int64_t i = 0; i < kNumIntervals; ++i) {
+    tree.Add(0, i, HeapSimulator::Chunk::FromOffsetSize(i, 1));
+  }
+  EXPECT_EQ(tree.ChunksOverlappingInTime(0, 0).size(), kNumIntervals);
+  for (int64_t i = kNumIntervals - 1; i >= 0; --i) {
+    EXPECT_TRUE(tree.Remove(0, i, HeapSimulator::Chunk::FromOffsetSize(i, 1)));
+  }
+  ASSERT_EQ(tree.GetRoot(), nullptr);
+}
+
 class SlicedBufferIntervalTest : public ::testing::Test {
  public:
   using HeapTy = GlobalDecreasingSizeBestFitHeap<HloValue>;
@@ -2664,5 +2719,43 @@ t0 |xxxxx000        xxxx      xxxxxxxxxxxxxx   xxxxxxxxxxxxxxxxxxxxxxxxxxxx
                                      Chunk::FromOffsetSize(11, 0)));
 }
 
+// Simulates a heap of `state.range(0)` buffers of the same size, each of them
+// live for a short time, in the order of a long sequential program.
+void BM_GlobalDecreasingSizeBestFitHeap(::testing::benchmark::State& state) {
+  const int64_t num_buffers = state.range(0);
+  constexpr int64_t kLiveTime = 16;
+
+  HloModuleConfig config;
+  HloModule module("BM_GlobalDecreasingSizeBestFitHeap", config);
+  auto builder = HloComputation::Builder("BM_GlobalDecreasingSizeBestFitHeap");
+  HloInstruction* param =
+      builder.AddInstruction(HloInstruction::CreateParameter(
+          0, ShapeUtil::MakeShape(F32, {4}), "param"));
+  module.AddEntryComputation(builder.Build());
+  std::vector<std::unique_ptr<HloValue>> values;
+  values.reserve(num_buffers);
+  for (int64_t i = 0; i < num_buffers; ++i) {
+    values.push_back(std::make_unique<HloValue>(i, param, ShapeIndex{}));
+  }
+
+  for (auto s : state) {
+    GlobalDecreasingSizeBestFitHeap<HloValue> heap(/*alignment=*/1);
+    for (int64_t i = 0; i < num_buffers + kLiveTime; ++i) {
+      if (i < num_buffers) {
+        heap.Alloc(values[i].get(), 16);
+      }
+      if (i >= kLiveTime) {
+        heap.Free(values[i - kLiveTime].get(), 16);
+      }
+    }
+    heap.Finish();
+  }
+}
+
+BENCHMARK(BM_GlobalDecreasingSizeBestFitHeap)
+    ->Arg(1 << 10)
+    ->Arg(1 << 14)
+    ->Arg(1 << 17);
+
 }  // namespace
 }  // namespace xla
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module_group.h"
+#include "tensorflow/compiler/xla/service/compilation_stats.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/statusor.h"
@@ -76,10 +77,14 @@ class HloPassFix : public Pass {
       if (iteration_count == kIterationLimit) {
         VLOG(1) << "Unexpectedly high number of iterations in HLO passes, "
                    "exiting fixed point loop.";
+        CompilationStats::RecordFixedPointIterations(Pass::name(),
+                                                     iteration_count);
         // Return false in case this is fixed point is nested.
         return false;
       }
     }
+    CompilationStats::RecordFixedPointIterations(Pass::name(),
+                                                 iteration_count);
     return changed;
   }
 
@@ -104,6 +109,8 @@ class HloPassFix : public Pass {
         break;
       }
     }
+    CompilationStats::RecordFixedPointIterations(Pass::name(),
+                                                 run_state->iteration);
     return OkStatus();
   }
 
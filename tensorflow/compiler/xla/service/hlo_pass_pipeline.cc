@@ -28,14 +28,29 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/profiler/lib/traceme.h"
+#include "tensorflow/tsl/profiler/lib/traceme_encode.h"
 
 namespace xla {
 
 namespace {
 
+int64_t InstructionCount(const HloModule& module) {
+  return module.instruction_count();
+}
+
+int64_t InstructionCount(const HloModuleGroup& module_group) {
+  int64_t count = 0;
+  for (const HloModule* module : module_group.modules()) {
+    count += module->instruction_count();
+  }
+  return count;
+}
+
 void RecordPassStartMetadata(HloModule& module, const std::string& pass_name,
                              const std::string& pipeline_name) {
   module.metadata()->RecordPassStart();
@@ -180,6 +195,16 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
     }
+    // Passes show up in the host trace of the profiler (XPlane) when it is
+    // active.
+    tsl::profiler::TraceMe trace_me([&] {
+      return tsl::profiler::TraceMeEncode(
+          "HloPass", {{"name", pass_name}, {"module", hlo->name()}});
+    });
+    const int64_t instruction_count_before = InstructionCount(*hlo);
+    const int64_t peak_memory_before =
+        CompilationStats::PeakResidentMemoryBytes();
+    const uint64_t start_micros = tsl::Env::Default()->NowMicros();
     RecordPassStartMetadata(*hlo, pass_name, pipeline_name);
     // Embed RunHelper into lambda to enable recording of error statuses
     auto run_helper_lambda =
@@ -219,8 +244,20 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
       };
       TF_RETURN_IF_ERROR(run_invariant_checkers_lambda(hlo, pass_name));
     }
+    const int64_t instruction_count_after = InstructionCount(*hlo);
+    trace_me.AppendMetadata([&] {
+      return tsl::profiler::TraceMeEncode(
+          {{"instructions_before", instruction_count_before},
+           {"instructions_after", instruction_count_after}});
+    });
+    trace_me.Stop();
     if (!pass->IsPassPipeline()) {
       compilation_stats_->EndPass(pass_name);
+      // Nested pipelines are not recorded, their passes are.
+      CompilationStats::RecordPassRun(
+          pass_name, (tsl::Env::Default()->NowMicros() - start_micros) / 1000.0,
+          instruction_count_after - instruction_count_before,
+          CompilationStats::PeakResidentMemoryBytes() - peak_memory_before);
     }
   }
   return changed;
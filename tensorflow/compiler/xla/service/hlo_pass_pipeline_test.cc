@@ -18,7 +18,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/compilation_stats.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
@@ -27,6 +29,7 @@ namespace xla {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::HasSubstr;
 using ::testing::SizeIs;
 using ::testing::StrEq;
 
@@ -46,6 +49,7 @@ class HloPassPipelineTest : public HloTestBase {
 
 // A module pass which renames instructions named 'foo' to 'bar'.
 class FooToBarModulePass : public HloModulePass {
+ public:
   absl::string_view name() const override { return "foo2bar"; }
 
   using HloPassInterface::Run;
@@ -112,6 +116,22 @@ class BazToQuxModuleGroupPass : public HloModuleGroupPass {
   }
 };
 
+// A module pass which negates the root of the entry computation.
+class NegateRootModulePass : public HloModulePass {
+  absl::string_view name() const override { return "negate-root"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(HloModule* module,
+                     const absl::flat_hash_set<absl::string_view>&
+                         execution_threads) override {
+    HloComputation* entry = module->entry_computation();
+    HloInstruction* root = entry->root_instruction();
+    entry->set_root_instruction(entry->AddInstruction(
+        HloInstruction::CreateUnary(root->shape(), HloOpcode::kNegate, root)));
+    return true;
+  }
+};
+
 // An invariant checker pass which returns an error if there exists an
 // instruction named 'bar'.
 class BarBlowerUpper : public HloModulePass {
@@ -400,5 +420,42 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
   }
 }
 
+TEST_F(HloPassPipelineTest, RecordsProcessPassStats) {
+  const std::string module_str = R"(
+HloModule RecordsProcessPassStats
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT foo = f32[] multiply(a, b)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerifiedHloModule> module,
+                          ParseAndReturnVerifiedModule(module_str));
+  CompilationStats::ResetProcessPassStats();
+  HloPassPipeline pipeline(TestName());
+  pipeline.AddPass<HloPassFix<FooToBarModulePass>>();
+  pipeline.AddPass<NegateRootModulePass>();
+  pipeline.AddPass<NegateRootModulePass>();
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, pipeline.Run(module.get()));
+  EXPECT_TRUE(changed);
+
+  absl::flat_hash_map<std::string, HloPassStats> stats =
+      CompilationStats::ProcessPassStats();
+  ASSERT_TRUE(stats.contains("foo2bar"));
+  EXPECT_EQ(stats["foo2bar"].num_runs, 1);
+  EXPECT_EQ(stats["foo2bar"].instruction_count_delta, 0);
+  // The first iteration renames foo, the second one finds nothing to rename.
+  EXPECT_EQ(stats["foo2bar"].fixed_point_iterations, 2);
+  ASSERT_TRUE(stats.contains("negate-root"));
+  EXPECT_EQ(stats["negate-root"].num_runs, 2);
+  EXPECT_EQ(stats["negate-root"].instruction_count_delta, 2);
+  EXPECT_EQ(stats["negate-root"].fixed_point_iterations, 0);
+  EXPECT_GE(stats["negate-root"].duration_ms, 0);
+  EXPECT_GE(stats["negate-root"].peak_memory_growth_bytes, 0);
+  EXPECT_THAT(CompilationStats::ProcessPassStatsReport(),
+              HasSubstr("negate-root, 2, "));
+}
+
 }  // namespace
 }  // namespace xla
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -699,6 +700,14 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // The hierarchical ring reduction is selected explicitly, as it only pays
+  // off when the links between tasks are much slower than within tasks.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->group.device_type == DEVICE_CPU &&
+      absl::StartsWith(cp->instance.impl_details.communication_hint,
+                       "hierarchical_ring")) {
+    cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
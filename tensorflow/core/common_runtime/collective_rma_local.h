@@ -42,7 +42,7 @@ class CollectiveRemoteAccessLocal : public CollectiveRemoteAccess {
                     DeviceContext* to_device_ctx,
                     const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
                     const DeviceLocality& client_locality,
-                    int dev_to_dev_stream_index,
+                    int dev_to_dev_stream_index, int64_t sub_chunk_bytes,
                     CancellationManager* cancellation_manager,
                     const StatusCallback& done) override;
 
@@ -52,6 +52,7 @@ class CollectiveRemoteAccessLocal : public CollectiveRemoteAccess {
                   const AllocatorAttributes& from_alloc_attr,
                   const Tensor* from_tensor,
                   const DeviceLocality& client_locality,
+                  int64_t sub_chunk_bytes,
                   CancellationManager* cancellation_manager,
                   const StatusCallback& done) override;
 
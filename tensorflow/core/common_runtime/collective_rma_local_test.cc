@@ -77,7 +77,7 @@ TEST_F(CollectiveRemoteAccessLocalTest, PostRecvCPU0) {
   rma_->RecvFromPeer(kTaskName + "/device:CPU:0", kTaskName, true /*is_local*/,
                      "key_0", cpu0 /*to_device*/, nullptr /*to_device_ctx*/,
                      attr /*to_alloc_attr*/, &sink_tensor, dev_locality,
-                     0 /*stream_index*/, cm_.get(),
+                     0 /*stream_index*/, 0 /*sub_chunk_bytes*/, cm_.get(),
                      [&recv_note, &recv_status](const Status& s) {
                        recv_status = s;
                        recv_note.Notify();
@@ -93,7 +93,8 @@ TEST_F(CollectiveRemoteAccessLocalTest, PostRecvCPU0) {
   rma_->PostToPeer(kTaskName + "/device:CPU:0", kTaskName, "key_0",
                    cpu0 /*from_device*/, nullptr /*from_device_ctx*/,
                    attr /*to_alloc_attr*/, &source_tensor, dev_locality,
-                   cm_.get(), [&send_note, &send_status](const Status& s) {
+                   0 /*sub_chunk_bytes*/, cm_.get(),
+                   [&send_note, &send_status](const Status& s) {
                      send_status = s;
                      send_note.Notify();
                    });
@@ -120,7 +121,7 @@ TEST_F(CollectiveRemoteAccessLocalTest, PostRecvCPU1_2) {
   rma_->RecvFromPeer(kTaskName + "/device:CPU:1", kTaskName, true /*is_local*/,
                      "key_0", cpu2 /*to_device*/, nullptr /*to_device_ctx*/,
                      attr /*to_alloc_attr*/, &sink_tensor, dev_locality,
-                     0 /*stream_index*/, cm_.get(),
+                     0 /*stream_index*/, 0 /*sub_chunk_bytes*/, cm_.get(),
                      [&recv_note, &recv_status](const Status& s) {
                        recv_status = s;
                        recv_note.Notify();
@@ -138,7 +139,8 @@ TEST_F(CollectiveRemoteAccessLocalTest, PostRecvCPU1_2) {
   rma_->PostToPeer(kTaskName + "/device:CPU:2", kTaskName, "key_0",
                    cpu1 /*from_device*/, nullptr /*from_device_ctx*/,
                    attr /*to_alloc_attr*/, &source_tensor, dev_locality,
-                   cm_.get(), [&send_note, &send_status](const Status& s) {
+                   0 /*sub_chunk_bytes*/, cm_.get(),
+                   [&send_note, &send_status](const Status& s) {
                      send_status = s;
                      send_note.Notify();
                    });
@@ -177,7 +179,7 @@ TEST_F(CollectiveRemoteAccessLocalTest, RecvThenCancel) {
   rma_->RecvFromPeer(kTaskName + "/device:CPU:0", kTaskName, true /*is_local*/,
                      "key_0", cpu0 /*to_device*/, nullptr /*to_device_ctx*/,
                      attr /*to_alloc_attr*/, &sink_tensor, dev_locality,
-                     0 /*stream_index*/, cm_.get(),
+                     0 /*stream_index*/, 0 /*sub_chunk_bytes*/, cm_.get(),
                      [&recv_note, &recv_status](const Status& s) {
                        recv_status = s;
                        recv_note.Notify();
@@ -200,7 +202,7 @@ TEST_F(CollectiveRemoteAccessLocalTest, CancelThenRecv) {
   rma_->RecvFromPeer(kTaskName + "/device:CPU:0", kTaskName, true /*is_local*/,
                      "key_0", cpu0 /*to_device*/, nullptr /*to_device_ctx*/,
                      attr /*to_alloc_attr*/, &sink_tensor, dev_locality,
-                     0 /*stream_index*/, cm_.get(),
+                     0 /*stream_index*/, 0 /*sub_chunk_bytes*/, cm_.get(),
                      [&recv_note, &recv_status](const Status& s) {
                        recv_status = s;
                        recv_note.Notify();
@@ -221,7 +223,8 @@ TEST_F(CollectiveRemoteAccessLocalTest, PostThenCancel) {
   rma_->PostToPeer(kTaskName + "/device:CPU:0", kTaskName, "key_0",
                    cpu0 /*from_device*/, nullptr /*from_device_ctx*/,
                    attr /*to_alloc_attr*/, &source_tensor, dev_locality,
-                   cm_.get(), [&send_note, &send_status](const Status& s) {
+                   0 /*sub_chunk_bytes*/, cm_.get(),
+                   [&send_note, &send_status](const Status& s) {
                      send_status = s;
                      send_note.Notify();
                    });
@@ -243,7 +246,8 @@ TEST_F(CollectiveRemoteAccessLocalTest, CancelThenPost) {
   rma_->PostToPeer(kTaskName + "/device:CPU:0", kTaskName, "key_0",
                    cpu0 /*from_device*/, nullptr /*from_device_ctx*/,
                    attr /*to_alloc_attr*/, &source_tensor, dev_locality,
-                   cm_.get(), [&send_note, &send_status](const Status& s) {
+                   0 /*sub_chunk_bytes*/, cm_.get(),
+                   [&send_note, &send_status](const Status& s) {
                      send_status = s;
                      send_note.Notify();
                    });
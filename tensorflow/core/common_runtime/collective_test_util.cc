@@ -61,12 +61,13 @@ void FailTestRMA::RecvFromPeer(
     const string& key, Device* to_device, DeviceContext* to_device_ctx,
     const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
     const DeviceLocality& client_locality, int dev_to_dev_stream_index,
-    CancellationManager* cancellation_manager, const StatusCallback& done) {
+    int64_t sub_chunk_bytes, CancellationManager* cancellation_manager,
+    const StatusCallback& done) {
   if (MaybeFail(done)) return;
   CollectiveRemoteAccessLocal::RecvFromPeer(
       peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
       to_alloc_attr, to_tensor, client_locality, dev_to_dev_stream_index,
-      cancellation_manager, done);
+      sub_chunk_bytes, cancellation_manager, done);
 }
 
 void FailTestRMA::PostToPeer(const string& peer_device, const string& peer_task,
@@ -75,13 +76,14 @@ void FailTestRMA::PostToPeer(const string& peer_device, const string& peer_task,
                              const AllocatorAttributes& from_alloc_attr,
                              const Tensor* from_tensor,
                              const DeviceLocality& client_locality,
+                             int64_t sub_chunk_bytes,
                              CancellationManager* cancellation_manager,
                              const StatusCallback& done) {
   if (MaybeFail(done)) return;
   CollectiveRemoteAccessLocal::PostToPeer(
       peer_device, peer_task, key, from_device, from_device_ctx,
-      from_alloc_attr, from_tensor, client_locality, cancellation_manager,
-      done);
+      from_alloc_attr, from_tensor, client_locality, sub_chunk_bytes,
+      cancellation_manager, done);
 }
 
 namespace {
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/colocation_graph.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -24,6 +26,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -161,6 +164,61 @@ bool HasHostMemoryOutType(const Node& node) {
 
   return false;
 }
+
+// Returns the key under which the supported device types of `node` are
+// memoized. The kernels matching a node are selected by its op, its "_kernel"
+// label and constraints on its type, string, int and bool attrs, and a node
+// without any kernel may fall back to the type of its requested device, so the
+// key is made of all of these.
+std::string SupportedDeviceTypesCacheKey(const Node& node) {
+  std::vector<std::pair<StringPiece, const AttrValue*>> attrs;
+  for (const auto& attr : node.def().attr()) {
+    const AttrValue& value = attr.second;
+    switch (value.value_case()) {
+      case AttrValue::kType:
+      case AttrValue::kS:
+      case AttrValue::kI:
+      case AttrValue::kB:
+        attrs.emplace_back(attr.first, &value);
+        break;
+      case AttrValue::kList:
+        if (value.list().type_size() > 0) {
+          attrs.emplace_back(attr.first, &value);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  std::sort(attrs.begin(), attrs.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::string key =
+      absl::StrCat(node.type_string(), "|", node.def().device().size(), ":",
+                   node.def().device());
+  for (const auto& [name, value] : attrs) {
+    absl::StrAppend(&key, "|", name, "=");
+    switch (value->value_case()) {
+      case AttrValue::kType:
+        absl::StrAppend(&key, value->type());
+        break;
+      case AttrValue::kS:
+        absl::StrAppend(&key, value->s().size(), ":", value->s());
+        break;
+      case AttrValue::kI:
+        absl::StrAppend(&key, value->i());
+        break;
+      case AttrValue::kB:
+        absl::StrAppend(&key, value->b());
+        break;
+      default:
+        absl::StrAppend(&key, "[", absl::StrJoin(value->list().type(), ","),
+                        "]");
+        break;
+    }
+  }
+  return key;
+}
 }  // namespace
 
 Status Member::SetParentAndSupportedDevices(
@@ -176,6 +234,18 @@ Status Member::SetParentAndSupportedDevices(
       types, node.def(), &supported_device_types_, local_address_spec);
 }
 
+Status Member::SetParentAndSupportedDevices(
+    const Node& node, const PrioritizedDeviceTypeVector& supported_types) {
+  int id = node.id();
+  if (id < 0) {
+    return errors::Internal("Placer should not be creating a Member for node: ",
+                            node.DebugString());
+  }
+  parent_ = id;
+  supported_device_types_ = supported_types;
+  return OkStatus();
+}
+
 Status Member::SetAssignedDeviceName(const string& device_name) {
   if (DeviceNameUtils::HasSomeDetails(requested_device_name_)) {
     return errors::Internal(
@@ -1491,9 +1561,29 @@ Status ColocationGraph::InitializeMemberWithAssignedDevice(
                           node_type);
 }
 
+Status ColocationGraph::GetSupportedDeviceTypes(
+    const Node& node, PrioritizedDeviceTypeVector* supported_types) {
+  std::string key = SupportedDeviceTypesCacheKey(node);
+  auto it = supported_device_types_cache_.find(key);
+  if (it != supported_device_types_cache_.end()) {
+    *supported_types = it->second;
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(SupportedDeviceTypesForNode(
+      device_types_, node.def(), supported_types, &local_address_spec_));
+  // Nodes without any kernel are validated by SupportedDeviceTypesForNode(),
+  // on all of their attrs, so they aren't memoized.
+  if (!supported_types->empty()) {
+    supported_device_types_cache_.emplace(std::move(key), *supported_types);
+  }
+  return OkStatus();
+}
+
 Status ColocationGraph::InitializeMember(const Node& node, Member* member) {
-  TF_RETURN_IF_ERROR(member->SetParentAndSupportedDevices(
-      node, device_types_, &local_address_spec_));
+  PrioritizedDeviceTypeVector supported_types;
+  TF_RETURN_IF_ERROR(GetSupportedDeviceTypes(node, &supported_types));
+  TF_RETURN_IF_ERROR(
+      member->SetParentAndSupportedDevices(node, supported_types));
 
   if (node.has_assigned_device_name()) {
     TF_RETURN_IF_ERROR(InitializeMemberWithAssignedDevice(
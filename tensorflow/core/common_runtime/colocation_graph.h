@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLOCATION_GRAPH_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_COLOCATION_GRAPH_H_
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/inspecting_placer.h"
@@ -41,6 +43,10 @@ class Member {
       const Node& node, const std::vector<DeviceType>& types,
       const DeviceNameUtils::ParsedName* local_address_spec);
 
+  // Same as above, with the supported device types of `node` already known.
+  Status SetParentAndSupportedDevices(
+      const Node& node, const PrioritizedDeviceTypeVector& supported_types);
+
   const DeviceNameUtils::ParsedName& requested_device_name() const {
     return requested_device_name_;
   }
@@ -362,6 +368,12 @@ class ColocationGraph {
 
   Status InitializeMember(const Node& node, Member* member);
 
+  // Returns in `supported_types` the device types, among `device_types_`, that
+  // have a kernel for `node`. The result is memoized per op type and kernel
+  // selecting attributes, which nodes of large graphs mostly share.
+  Status GetSupportedDeviceTypes(const Node& node,
+                                 PrioritizedDeviceTypeVector* supported_types);
+
   // Returns the root node of the disjoint tree to which the node with the
   // given id is connected.
   // FindRoot should be called only for debugging or after the members have
@@ -384,6 +396,11 @@ class ColocationGraph {
   const bool allow_soft_placement_;
   const bool log_device_placement_;
 
+  // Memoized results of GetSupportedDeviceTypes(), see
+  // SupportedDeviceTypesCacheKey().
+  absl::flat_hash_map<std::string, PrioritizedDeviceTypeVector>
+      supported_device_types_cache_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ColocationGraph);
 };
 
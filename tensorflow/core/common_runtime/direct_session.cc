@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -73,6 +74,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -90,6 +92,18 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// Returns the options of the threads of a pool configured by
+// `thread_pool_options`.
+ThreadOptions ThreadOptionsFromThreadPoolOptions(
+    const ThreadPoolOptionProto& thread_pool_options) {
+  ThreadOptions thread_options;
+  for (const auto& cpu_set : thread_pool_options.cpu_sets()) {
+    thread_options.cpu_sets.emplace_back(cpu_set.cpus().begin(),
+                                         cpu_set.cpus().end());
+  }
+  return thread_options;
+}
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -98,13 +112,15 @@ Status NewThreadPoolFromThreadPoolOptions(
   if (num_threads == 0) {
     num_threads = NumInterOpThreadsFromSessionOptions(options);
   }
+  const ThreadOptions thread_options =
+      ThreadOptionsFromThreadPoolOptions(thread_pool_options);
   const string& name = thread_pool_options.global_name();
   if (name.empty()) {
     // Session-local threadpool.
     VLOG(1) << "Direct session inter op parallelism threads for pool "
             << pool_number << ": " << num_threads;
     *pool = new thread::ThreadPool(
-        options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
+        options.env, thread_options, strings::StrCat("Compute", pool_number),
         num_threads, !options.config.experimental().disable_thread_spinning(),
         /*allocator=*/nullptr);
     *owned = true;
@@ -121,7 +137,7 @@ Status NewThreadPoolFromThreadPoolOptions(
   if (mvalue->second == nullptr) {
     mvalue->first = thread_pool_options.num_threads();
     mvalue->second = new thread::ThreadPool(
-        options.env, ThreadOptions(), strings::StrCat("Compute", pool_number),
+        options.env, thread_options, strings::StrCat("Compute", pool_number),
         num_threads, !options.config.experimental().disable_thread_spinning(),
         /*allocator=*/nullptr);
   } else {
@@ -148,6 +164,36 @@ thread::ThreadPool* GlobalThreadPool(const SessionOptions& options,
   return thread_pool;
 }
 
+// Creates one inter-op thread pool per NUMA node, with threads bound to the
+// node, sharing the inter-op threads of `options` evenly.
+std::vector<thread::ThreadPool*> NewNumaThreadPools(
+    const SessionOptions& options) {
+  const int num_nodes = port::NUMANumNodes();
+  const int32_t num_threads =
+      std::max(1, NumInterOpThreadsFromSessionOptions(options) / num_nodes);
+  std::vector<thread::ThreadPool*> pools;
+  for (int node = 0; node < num_nodes; ++node) {
+    VLOG(1) << "Direct session inter op parallelism threads for NUMA node "
+            << node << ": " << num_threads;
+    ThreadOptions thread_options;
+    thread_options.numa_node = node;
+    pools.push_back(new thread::ThreadPool(
+        options.env, thread_options, strings::StrCat("numa_", node, "_Compute"),
+        num_threads, !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr));
+  }
+  return pools;
+}
+
+// Global version of `NewNumaThreadPools()`, shared by all the sessions that
+// do not use per-session threads.
+const std::vector<thread::ThreadPool*>& GlobalNumaThreadPools(
+    const SessionOptions& options) {
+  static const std::vector<thread::ThreadPool*>* const pools =
+      new std::vector<thread::ThreadPool*>(NewNumaThreadPools(options));
+  return *pools;
+}
+
 // TODO(vrv): Figure out how to unify the many different functions
 // that generate RendezvousKey, since many of them have to be
 // consistent with each other.
@@ -358,6 +404,17 @@ DirectSession::DirectSession(const SessionOptions& options,
         GlobalThreadPool(options, run_in_caller_thread_ ? 1 : 0),
         false /* owned */);
   }
+  // Explicitly configured inter-op pools are used as is.
+  if (thread_pool_size == 0 && !run_in_caller_thread_ &&
+      options_.config.experimental().use_numa_affinity() &&
+      port::NUMAEnabled() && port::NUMANumNodes() > 1) {
+    if (options_.config.use_per_session_threads()) {
+      numa_thread_pools_ = NewNumaThreadPools(options_);
+      owns_numa_thread_pools_ = true;
+    } else {
+      numa_thread_pools_ = GlobalNumaThreadPools(options_);
+    }
+  }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -411,6 +468,9 @@ DirectSession::~DirectSession() {
   for (const auto& p_and_owned : thread_pools_) {
     if (p_and_owned.second) delete p_and_owned.first;
   }
+  if (owns_numa_thread_pools_) {
+    for (thread::ThreadPool* pool : numa_thread_pools_) delete pool;
+  }
 
   execution_state_.reset(nullptr);
   flib_def_.reset(nullptr);
@@ -716,9 +776,35 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // The allocators planned for this step are released once the executors are
+  // done, and delete themselves when the tensors they allocated are freed.
+  std::vector<PlannedStepAllocator*> step_allocators;
+  step_allocators.reserve(num_executors);
+  auto release_step_allocators = gtl::MakeCleanup([&step_allocators] {
+    for (PlannedStepAllocator* allocator : step_allocators) {
+      allocator->Release();
+    }
+  });
+  auto set_step_allocator_for_item =
+      [&step_allocators](const PerPartitionExecutorsAndLib& item,
+                         Executor::Args* args) {
+        args->step_allocator = nullptr;
+        if (item.memory_plan == nullptr) return;
+        PlannedStepAllocator* allocator = item.memory_plan->BeginStep();
+        if (allocator == nullptr) return;
+        step_allocators.push_back(allocator);
+        args->step_allocator = allocator;
+      };
+
+  // Partitions placed on a NUMA node run on the inter-op pool of the node,
+  // unless the step uses a pool other than the default one.
+  const bool use_numa_thread_pools =
+      !numa_thread_pools_.empty() && !inline_execution_requested &&
+      handler_ptr == nullptr && pool == thread_pools_[0].first;
+
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [this, &default_runner, &handler, use_numa_thread_pools](
+          const PerPartitionExecutorsAndLib& item, Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
@@ -727,7 +813,14 @@ Status DirectSession::RunInternal(
             item.device->tensorflow_device_thread_pool();
         // TODO(crk): Investigate usage of RunHandlerPool when using device
         // specific thread pool(s).
-        if (!device_thread_pool) {
+        const int numa_node = item.device->attributes().locality().numa_node();
+        if (!device_thread_pool && use_numa_thread_pools && numa_node >= 0 &&
+            numa_node < static_cast<int>(numa_thread_pools_.size())) {
+          thread::ThreadPool* numa_pool = numa_thread_pools_[numa_node];
+          args->runner = [numa_pool](Executor::Args::Closure c) {
+            numa_pool->Schedule(std::move(c));
+          };
+        } else if (!device_thread_pool) {
           args->runner = default_runner;
         } else {
           args->runner = [device_thread_pool](Executor::Args::Closure c) {
@@ -746,6 +839,7 @@ Status DirectSession::RunInternal(
 
     const auto& item = executors_and_keys->items[0];
     set_threadpool_args_for_item(item, &args);
+    set_step_allocator_for_item(item, &args);
     run_status = item.executor->Run(args);
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
@@ -766,6 +860,7 @@ Status DirectSession::RunInternal(
 
     for (const auto& item : executors_and_keys->items) {
       set_threadpool_args_for_item(item, &args);
+      set_step_allocator_for_item(item, &args);
       item.executor->RunAsync(args, barrier->Get());
     }
 
@@ -1445,6 +1540,12 @@ Status DirectSession::CreateExecutors(
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    if (options_.config.experimental().enable_static_memory_plan() &&
+        !run_state_args->is_partial_run &&
+        device->device_type() == DEVICE_CPU) {
+      item->memory_plan = std::make_unique<StaticMemoryPlan>(
+          device->GetAllocator(AllocatorAttributes()));
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1696,6 +1797,8 @@ Status DirectSession::CreateGraphs(
   };
   popts.flib_def = flib_def->get();
   popts.control_flow_added = false;
+  popts.sendrecv_packing_threshold_bytes =
+      options_.config.graph_options().sendrecv_packing_threshold_bytes();
 
   std::unordered_map<string, GraphDef> partitions;
   TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -148,6 +149,9 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Plans the allocations of the steps, if the static memory plan is
+    // enabled and the partition runs on a CPU.
+    std::unique_ptr<StaticMemoryPlan> memory_plan;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -350,6 +354,13 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // With `use_numa_affinity` on a NUMA host, one inter-op thread pool per NUMA
+  // node, indexed by node, whose threads are bound to the node. They run the
+  // partitions placed on devices of the node in place of the default pool.
+  // Owned iff `owns_numa_thread_pools_`.
+  std::vector<thread::ThreadPool*> numa_thread_pools_;
+  bool owns_numa_thread_pools_ = false;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -647,6 +648,59 @@ TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestNumaAffinity) {
+  Initialize({1, 2, 3, 4});
+
+  SessionOptions options;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  options.config.set_use_per_session_threads(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // There is one CPU device per NUMA node.
+  std::vector<DeviceAttributes> devices;
+  TF_ASSERT_OK(session->ListDevices(&devices));
+  int num_cpu_devices = 0;
+  for (const DeviceAttributes& device : devices) {
+    if (device.device_type() == DEVICE_CPU) ++num_cpu_devices;
+  }
+  EXPECT_EQ(num_cpu_devices, port::NUMANumNodes());
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(3.0, outputs[0].matrix<float>()(0, 0));
+}
+
+TEST_F(DirectSessionMinusAXTest, StaticMemoryPlan) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_enable_static_memory_plan(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The first steps warm up and record the plan, the others run on it. The
+  // outputs of every step are kept, and outlive the arena of their step.
+  std::vector<std::vector<Tensor>> outputs(5);
+  for (int i = 0; i < outputs.size(); ++i) {
+    Tensor x(DT_FLOAT, TensorShape({2, 1}));
+    test::FillValues<float>(&x, {static_cast<float>(i), 1});
+    TF_ASSERT_OK(
+        session->Run({{x_, x}}, {y_ + ":0", z_ + ":0"}, {}, &outputs[i]));
+  }
+  for (int i = 0; i < outputs.size(); ++i) {
+    ASSERT_EQ(2, outputs[i].size());
+    test::ExpectTensorEqual<float>(
+        outputs[i][0], test::AsTensor<float>({3.0f * i + 2, -1.0f * i},
+                                             TensorShape({2, 1})));
+    test::ExpectTensorEqual<float>(
+        outputs[i][1], test::AsTensor<float>({-3.0f * i - 2, 1.0f * i},
+                                             TensorShape({2, 1})));
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, TwoCreateCallsFails) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -453,6 +453,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
     kernel_cache_.clear();
+    dispatch_cache_.clear();
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
@@ -1065,6 +1066,8 @@ Status EagerContext::RemoveFunction(const string& func) {
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
+      // Primitive ops can refer to functions through their attributes.
+      dispatch_cache_.clear();
       registered_functions_.erase(func);
     }
     registered_function->Unref();
@@ -1156,6 +1159,18 @@ core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
   return new_ref;
 }
 
+core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedDispatch(
+    Fprint128 dispatch_cache_key) {
+  tf_shared_lock l(cache_mu_);
+  auto iter = dispatch_cache_.find(dispatch_cache_key);
+  if (iter == dispatch_cache_.end()) {
+    return nullptr;
+  }
+  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
+  new_ref->Ref();
+  return new_ref;
+}
+
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
   tf_shared_lock l(device_cache_mu_);
   auto iter = device_cache_.find(device_cache_key);
@@ -1180,6 +1195,14 @@ void EagerContext::AddKernelToCache(Fprint128 cache_key,
   }
 }
 
+void EagerContext::AddDispatchToCache(Fprint128 dispatch_cache_key,
+                                      KernelAndDevice* kernel) {
+  mutex_lock ml(cache_mu_);
+  core::RefCountPtr<KernelAndDevice> new_ref(kernel);
+  new_ref->Ref();
+  dispatch_cache_[dispatch_cache_key] = std::move(new_ref);
+}
+
 void EagerContext::AddDeviceToCache(Fprint128 device_cache_key,
                                     Device* device) {
   mutex_lock l(device_cache_mu_);
@@ -275,6 +275,14 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
+  // The dispatch cache memoizes the kernel, and thus the device, resolved for
+  // primitive ops, keyed by their attributes and requested device. It is
+  // cleared along with the kernel cache, and whenever a function is removed.
+  core::RefCountPtr<KernelAndDevice> GetCachedDispatch(
+      Fprint128 dispatch_cache_key);
+  void AddDispatchToCache(Fprint128 dispatch_cache_key,
+                          KernelAndDevice* kernel);
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -767,6 +775,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  absl::flat_hash_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
+                      Fprint128Hasher>
+      dispatch_cache_ TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
       TF_GUARDED_BY(device_cache_mu_);
   std::unordered_map<std::string, std::vector<std::function<void()>>>
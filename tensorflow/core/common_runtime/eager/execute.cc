@@ -1322,6 +1322,21 @@ Fprint128 GetDeviceCacheKey(EagerOperation* op, const EagerContext& ctx) {
   return device_cache_key;
 }
 
+// Passes `kernel` to the caller of `GetOrCreateKernelAndDevice`.
+Status SetOutKernel(core::RefCountPtr<KernelAndDevice> kernel,
+                    int* num_retvals,
+                    core::RefCountPtr<KernelAndDevice>* out_kernel) {
+  int num_outputs = kernel->num_outputs();
+  if (num_outputs > *num_retvals) {
+    return errors::InvalidArgument("Expecting ", num_outputs,
+                                   " outputs, but *num_retvals is ",
+                                   *num_retvals);
+  }
+  *num_retvals = num_outputs;
+  *out_kernel = std::move(kernel);
+  return OkStatus();
+}
+
 Status GetOrCreateKernelAndDevice(
     EagerOperation* op, TensorHandle** retvals, int* num_retvals,
     core::RefCountPtr<KernelAndDevice>* out_kernel) {
@@ -1346,6 +1361,29 @@ Status GetOrCreateKernelAndDevice(
     op->UpdateName(summary_optimizer::StrippedFunctionName(op->Name()));
   }
 
+  // Primitive ops run with their op kernel have their selected device and
+  // kernel memoized by the context, keyed by their attributes, requested device
+  // and execution policies. Dispatching them again skips the device
+  // selection, the kernel registry lookup and the kernel cache key. Neither
+  // depends on the inputs of the op, whose placement is handled by the kernel.
+  const bool use_dispatch_cache =
+      !op->is_function() && !ctx.RunEagerOpAsFunction();
+  Fprint128 dispatch_cache_key;
+  if (use_dispatch_cache) {
+    dispatch_cache_key =
+        tsl::FingerprintCat128(GetDeviceCacheKey(op, ctx), device != nullptr);
+    dispatch_cache_key = tsl::FingerprintCat128(
+        dispatch_cache_key, ctx.GetReuseRendezvousForFunctions());
+    core::RefCountPtr<KernelAndDevice> kernel =
+        ctx.GetCachedDispatch(dispatch_cache_key);
+    if (kernel != nullptr) {
+      if (device == nullptr) {
+        op->SetDevice(kernel->device());
+      }
+      return SetOutKernel(std::move(kernel), num_retvals, out_kernel);
+    }
+  }
+
   // Set the EagerOperation's device prior to extracting the input_device_ptrs
   // to avoid any redundant H2D/D2H copies.
   if (device == nullptr && !op->is_function()) {
@@ -1389,6 +1427,7 @@ Status GetOrCreateKernelAndDevice(
                         input_device_ptrs,
                         input_resource_variable_dtypes_and_shapes));
   core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  bool kernel_cached = kernel != nullptr;
   AbstractOperationPtr wrapped_op_releaser;
   // We can eliminate some overhead by running simple functions using regular
   // CallOp kernel. However, it is tricky to figure out which functions should
@@ -1559,21 +1598,16 @@ Status GetOrCreateKernelAndDevice(
       TF_RETURN_IF_ERROR(OpDefForOp(op->Name().data(), &op_def));
       if (KernelCacheEnabled(*op_def)) {
         ctx.AddKernelToCache(cache_key, kernel.get());
+        kernel_cached = true;
       }
     }
   }
 
-  int num_outputs = kernel->num_outputs();
-  if (num_outputs > *num_retvals) {
-    return errors::InvalidArgument("Expecting ", num_outputs,
-                                   " outputs, but *num_retvals is ",
-                                   *num_retvals);
+  // Kernels excluded from the kernel cache are not memoized either.
+  if (use_dispatch_cache && kernel_cached) {
+    ctx.AddDispatchToCache(dispatch_cache_key, kernel.get());
   }
-  *num_retvals = num_outputs;
-
-  kernel->Ref();  // Ownership of reference is passed to out_kernel.
-  out_kernel->reset(kernel.get());
-  return OkStatus();
+  return SetOutKernel(std::move(kernel), num_retvals, out_kernel);
 }
 
 Status CreateUnshapedOutput(
@@ -1832,6 +1866,79 @@ Status StoreResourceDtypesAndShapes(const eager::Operation& remote_op,
   return OkStatus();
 }
 
+// Copies the local inputs of `op`, which runs on the remote `op_device`, to
+// the CPU of that task with a single SendTensor request instead of one request
+// per input. The copies are added as remote mirrors of the inputs, so that the
+// per-input copies in EagerRemoteExecute find them and only serialize them.
+// Inputs which the device placement policy doesn't copy silently are left to
+// those copies, which report them.
+Status PackInputCopiesToRemoteDevice(EagerContext* ctx, EagerOperation* op,
+                                     Device* op_device) {
+  if (!ctx->UseSendTensorRPC()) {
+    return OkStatus();
+  }
+  const ContextDevicePlacementPolicy policy = ctx->GetDevicePlacementPolicy();
+  if (policy != DEVICE_PLACEMENT_SILENT &&
+      policy != DEVICE_PLACEMENT_SILENT_FOR_INT32) {
+    return OkStatus();
+  }
+  Device* remote_cpu_device;
+  TF_RETURN_IF_ERROR(ctx->CPUDeviceOnTask(op_device, &remote_cpu_device));
+  const uint64 context_view_id = ctx->GetContextViewId();
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+
+  std::vector<TensorHandle*> packed_inputs;
+  absl::flat_hash_set<TensorHandle*> seen_inputs;
+  for (TensorHandle* input : *inputs) {
+    Device* handle_device = input->DeviceOrHostCPU(*ctx);
+    if (input->Type() != TensorHandle::LOCAL || op_device == input->device() ||
+        ctx->OnSameTask(op_device, input->device()) ||
+        handle_device == remote_cpu_device || !handle_device->IsLocal() ||
+        input->dtype == DT_RESOURCE || input->dtype == DT_VARIANT ||
+        (policy == DEVICE_PLACEMENT_SILENT_FOR_INT32 &&
+         input->dtype != DT_INT32) ||
+        input->HasRemoteMirror(remote_cpu_device, context_view_id) ||
+        !seen_inputs.insert(input).second) {
+      continue;
+    }
+    packed_inputs.push_back(input);
+  }
+  // A single input is copied just as cheaply by RemoteCopyNode.
+  if (packed_inputs.size() < 2) {
+    return OkStatus();
+  }
+
+  string remote_task;
+  if (!DeviceNameUtils::GetTaskName(remote_cpu_device->parsed_name(),
+                                    &remote_task)) {
+    return errors::InvalidArgument(
+        "Unable to find remote task corresponding to device ",
+        remote_cpu_device->name());
+  }
+  const uint64 recv_op_id = ctx->RemoteMgr()->NextOpId();
+  for (int i = 0, end = packed_inputs.size(); i < end; ++i) {
+    Status s = packed_inputs[i]->AddUnshapedRemoteMirror(
+        remote_cpu_device, recv_op_id, i, remote_task, ctx);
+    if (!s.ok()) {
+      // The mirrors added so far would otherwise never become ready.
+      for (int j = 0; j < i; ++j) {
+        packed_inputs[j]->PoisonRemote(s, remote_cpu_device, context_view_id);
+      }
+      return s;
+    }
+  }
+  profiler::TraceMe activity(
+      [&] {
+        return absl::StrCat("SendTensor ", packed_inputs.size(),
+                            " inputs to ", remote_cpu_device->name());
+      },
+      profiler::TraceMeLevel::kInfo);
+  auto node = std::make_unique<eager::RemoteSendTensorsNode>(
+      ctx, std::move(packed_inputs), remote_cpu_device, recv_op_id);
+  return op->Executor().AddOrExecute(std::move(node));
+}
+
 Status EagerRemoteExecute(EagerOperation* op, TensorHandle** retvals,
                           int* num_retvals) {
   EagerContext& ctx = op->EagerContext();
@@ -1863,6 +1970,7 @@ Status EagerRemoteExecute(EagerOperation* op, TensorHandle** retvals,
   {
     profiler::TraceMe activity("CopyInputToExpectedDevice",
                                profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(PackInputCopiesToRemoteDevice(&ctx, op, op_device));
     const bool is_function = op->is_function();
     const absl::InlinedVector<TensorHandle*, 4>* inputs;
     TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
@@ -61,6 +61,48 @@ TEST(ExecuteTest, EagerOperationAsFunction) {
   ctx->Unref();
 }
 
+TEST(ExecuteTest, DispatchCacheReusesSelectedDevice) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+  ctx->SetRunEagerOpAsFunction(false);
+
+  Tensor input1_tensor = test::AsScalar<int64_t>(3);
+  auto input1 = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      ctx->CreateLocalHandleFromTFTensor(input1_tensor,
+                                         ctx->HostCPUName().c_str()));
+  Tensor input2_tensor = test::AsScalar<int64_t>(2);
+  auto input2 = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      ctx->CreateLocalHandleFromTFTensor(input2_tensor,
+                                         ctx->HostCPUName().c_str()));
+
+  // The first execution selects the device and creates the kernel, the next
+  // ones reuse them, until the caches are cleared.
+  for (int i = 0; i < 3; ++i) {
+    if (i == 2) {
+      ctx->ClearCachesAndDefaultExecutor();
+    }
+    auto op = std::make_unique<EagerOperation>(ctx);
+    TF_ASSERT_OK(op->Reset(/*op=*/"Mul", /*raw_device_name=*/""));
+    TF_ASSERT_OK(op->AddInput(input1.get()));
+    TF_ASSERT_OK(op->AddInput(input2.get()));
+
+    std::vector<TensorHandle*> retvals(1);
+    int num_retvals = retvals.size();
+    TF_ASSERT_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+    EXPECT_EQ(std::get<Device*>(op->Device()), device_mgr.HostCPU());
+
+    const Tensor* output;
+    TF_ASSERT_OK(retvals[0]->Tensor(&output));
+    test::ExpectEqual(*output, test::AsScalar<int64_t>(6));
+    retvals[0]->Unref();
+  }
+  ctx->Unref();
+}
+
 TEST(ExecuteTest, SimpleFunction) {
   StaticDeviceMgr device_mgr(
       DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
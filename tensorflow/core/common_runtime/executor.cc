@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -67,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/profile_utils/cpu_utils.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -79,6 +81,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
@@ -144,9 +147,33 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// Identifies the work-stealing worker, if any, running on the current thread.
+struct WorkStealingWorker {
+  const void* executor_state = nullptr;
+  int index = -1;
+};
+
+WorkStealingWorker& CurrentWorkStealingWorker() {
+  static thread_local WorkStealingWorker worker;
+  return worker;
+}
+
+// Returns the maximum number of concurrent workers per step for executors
+// created with the "WORK_STEALING" executor type.
+int NumWorkStealingWorkers() {
+  static const int num_workers = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_WORK_STEALING_EXECUTOR_NUM_WORKERS",
+                                    port::MaxParallelism(), &value));
+    return static_cast<int>(std::max<int64_t>(value, 1));
+  }();
+  return num_workers;
+}
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  ExecutorImpl(const LocalExecutorParams& p, bool work_stealing)
+      : immutable_state_(p), work_stealing_(work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -224,6 +251,9 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, ready nodes are scheduled on per-worker deques; see
+  // `ExecutorState::ScheduleReadyWorkStealing()`.
+  const bool work_stealing_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -282,7 +312,7 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_, bool work_stealing);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -338,6 +368,28 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Work-stealing variant of `ScheduleReady()`. If `inline_ready` is empty the
+  // first ready node is run inline, and the remaining nodes are pushed onto the
+  // deque of the current worker, where idle workers can steal them.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready,
+                                 int64_t scheduled_nsec);
+
+  // Starts workers via `runner_` while there are fewer active workers than
+  // both `num_workers_` and the number of queued nodes.
+  void MaybeStartWorkers();
+
+  // The loop run by each work-stealing worker: processes nodes from its own
+  // deque (newest first) and steals from the other deques (oldest first) until
+  // no queued node is left.
+  void RunWorker(int worker_index);
+
+  struct WorkItem {
+    TaggedNode node;
+    int64_t scheduled_nsec;
+  };
+  absl::optional<WorkItem> PopOrStealWork(int worker_index);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -377,6 +429,7 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  Allocator* step_allocator_;
   StepStatsCollectorInterface* const stats_collector_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
@@ -398,6 +451,20 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Work-stealing scheduling state, only used if `work_stealing_` is true.
+  // Every active worker holds a reference on `num_outstanding_ops_`, so the
+  // step cannot finish while a worker is still running.
+  struct WorkerDeque {
+    mutex mu;
+    std::deque<WorkItem> items TF_GUARDED_BY(mu);
+  };
+  const bool work_stealing_;
+  const int num_workers_;
+  std::unique_ptr<WorkerDeque[]> worker_deques_;
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<int64_t> num_queued_nodes_{0};
+  std::atomic<uint32> next_worker_deque_{0};
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -416,7 +483,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool work_stealing)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -430,6 +497,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       session_metadata_(immutable_state.params().session_metadata),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_allocator_(args.step_allocator),
       stats_collector_(args.stats_collector),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
@@ -445,7 +513,12 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
+      work_stealing_(work_stealing && !run_all_kernels_inline_),
+      num_workers_(work_stealing_ ? NumWorkStealingWorkers() : 0),
       num_outstanding_ops_(0) {
+  if (work_stealing_) {
+    worker_deques_.reset(new WorkerDeque[num_workers_]);
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -740,6 +813,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->function_library = immutable_state_.params().function_library;
   params->resource_manager = device->resource_manager();
   params->step_container = step_container_;
+  params->step_allocator = step_allocator_;
   params->slice_reader_cache = slice_reader_cache_;
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
@@ -1248,7 +1322,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
-  if (run_all_kernels_inline_) {
+  if (work_stealing_) {
+    ScheduleReadyWorkStealing(ready, inline_ready, scheduled_nsec);
+  } else if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
       // regardless of the `runner_` implementation, all kernels will run
@@ -1341,6 +1417,118 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int64_t scheduled_nsec) {
+  auto it = ready->begin();
+  if (inline_ready != nullptr && inline_ready->empty()) {
+    // Keep following the current chain of nodes on this thread.
+    inline_ready->push_back(*it);
+    ++it;
+  }
+  if (it == ready->end()) return;
+
+  // Nodes made ready by a worker stay on that worker's deque. Nodes made ready
+  // elsewhere (e.g. by the root activation or an async kernel's callback) are
+  // spread over the deques.
+  const WorkStealingWorker& worker = CurrentWorkStealingWorker();
+  const int deque_index =
+      worker.executor_state == this
+          ? worker.index
+          : next_worker_deque_.fetch_add(1, std::memory_order_relaxed) %
+                num_workers_;
+  const int64_t num_pushed = std::distance(it, ready->end());
+  {
+    WorkerDeque& deque = worker_deques_[deque_index];
+    mutex_lock l(deque.mu);
+    for (; it != ready->end(); ++it) {
+      deque.items.push_back({*it, scheduled_nsec});
+    }
+  }
+  num_queued_nodes_.fetch_add(num_pushed, std::memory_order_release);
+
+  // Hold a reference on the step while starting workers: if `runner_` runs
+  // closures inline, a started worker may otherwise complete the step and
+  // delete `this` before `MaybeStartWorkers()` returns.
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+  MaybeStartWorkers();
+  if (num_outstanding_ops_.fetch_sub(1) == 1) {
+    ScheduleFinish();
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartWorkers() {
+  int active = num_active_workers_.load(std::memory_order_acquire);
+  while (active < num_workers_ &&
+         active < num_queued_nodes_.load(std::memory_order_acquire)) {
+    if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+      num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+      RunTask([this, worker_index = active]() { RunWorker(worker_index); });
+      ++active;
+    }
+  }
+}
+
+template <class PropagatorStateType>
+absl::optional<typename ExecutorState<PropagatorStateType>::WorkItem>
+ExecutorState<PropagatorStateType>::PopOrStealWork(int worker_index) {
+  if (num_queued_nodes_.load(std::memory_order_acquire) == 0) {
+    return absl::nullopt;
+  }
+  {
+    WorkerDeque& own = worker_deques_[worker_index];
+    mutex_lock l(own.mu);
+    if (!own.items.empty()) {
+      WorkItem item = own.items.back();
+      own.items.pop_back();
+      num_queued_nodes_.fetch_sub(1, std::memory_order_relaxed);
+      return item;
+    }
+  }
+  for (int i = 1; i < num_workers_; ++i) {
+    WorkerDeque& victim = worker_deques_[(worker_index + i) % num_workers_];
+    mutex_lock l(victim.mu);
+    if (!victim.items.empty()) {
+      WorkItem item = victim.items.front();
+      victim.items.pop_front();
+      num_queued_nodes_.fetch_sub(1, std::memory_order_relaxed);
+      return item;
+    }
+  }
+  return absl::nullopt;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorker(int worker_index) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat("ExecutorState::RunWorker#worker=",
+                               worker_index, "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+  // Workers may nest when `runner_` runs closures inline, or when a kernel
+  // synchronously runs another executor on this thread.
+  WorkStealingWorker& worker = CurrentWorkStealingWorker();
+  const WorkStealingWorker saved_worker = worker;
+  worker = {this, worker_index};
+  while (absl::optional<WorkItem> item = PopOrStealWork(worker_index)) {
+    Process(item->node, item->scheduled_nsec);
+  }
+  worker = saved_worker;
+
+  num_active_workers_.fetch_sub(1, std::memory_order_acq_rel);
+  // A node may have been queued after our last failed pop but before the
+  // decrement above, in which case its producer did not start a worker.
+  if (num_queued_nodes_.load(std::memory_order_acquire) > 0) {
+    MaybeStartWorkers();
+  }
+  if (num_outstanding_ops_.fetch_sub(1) == 1) {
+    ScheduleFinish();
+  }
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1479,24 +1667,32 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
+    // Deterministic op order is incompatible with stealing.
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+                                               &kernel_stats_,
+                                               /*work_stealing=*/false))
+        ->RunAsync(std::move(done));
+  } else if (immutable_state_.has_scheduling_order()) {
+    // Following the memory-aware schedule is incompatible with stealing.
+    (new ExecutorState<ScheduledPropagatorState>(args, immutable_state_,
+                                                 &kernel_stats_,
+                                                 /*work_stealing=*/false))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        work_stealing_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_, work_stealing_))
         ->RunAsync(std::move(done));
   }
 }
 
-}  // namespace
-
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph, bool work_stealing,
+                            Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, work_stealing);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1506,6 +1702,13 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph, /*work_stealing=*/false, executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1541,6 +1744,30 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers an executor that schedules ready nodes on per-worker deques with
+// work stealing, instead of dispatching each expensive node to `runner_` as a
+// separate closure. Select it by setting the executor type to
+// "WORK_STEALING", e.g. via `ConfigProto.Experimental.executor_type`.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(
+          NewLocalExecutorImpl(params, graph, /*work_stealing=*/true, &ret));
+      out_executor->reset(ret);
+      return OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
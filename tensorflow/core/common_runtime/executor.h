@@ -105,6 +105,9 @@ class Executor {
     string session_handle;
     TensorStore* tensor_store = nullptr;
     ScopedStepContainer* step_container = nullptr;
+    // If not null, serves the allocations of the kernels from the device
+    // allocator with default attributes. See `OpKernelContext::Params`.
+    Allocator* step_allocator = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -77,8 +78,10 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. An empty
+  // `executor_type` selects the default executor.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -93,7 +96,9 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    std::unique_ptr<Executor> executor;
+    TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+    exec_ = executor.release();
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -186,6 +191,33 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, SimpleAddWithSchedulingOrder) {
+  // c = (a + b) + (a + b), with nodes annotated by a memory-aware schedule.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+  auto tmp0 = test::graph::Add(g.get(), in0, in1);
+  auto tmp1 = test::graph::Add(g.get(), in1, in0);
+  auto sum = test::graph::Add(g.get(), tmp0, tmp1);
+  test::graph::Send(g.get(), sum, "c", BOB, 1, ALICE);
+  int order = 0;
+  for (Node* n : {tmp1, tmp0, sum}) {
+    n->AddAttr("_scheduling_order", order++);
+  }
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "b"), args, V(2.0),
+                             false));  // in1 = 2.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(6.0, V(out));  // out = (1.0 + 2.0) + (2.0 + 1.0) = 6.0
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -266,6 +298,69 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
+TEST_F(ExecutorTest, WideGraphWorkStealing) {
+  // out = sum of 2048 independent Add nodes, each fed by the same constant.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto one = test::graph::Constant(g.get(), V(1.0));
+  std::vector<Node*> nodes;
+  for (int i = 0; i < 2048; ++i) {
+    nodes.push_back(test::graph::Add(g.get(), one, one));
+  }
+  while (nodes.size() > 1) {
+    Node* a = nodes.back();
+    nodes.pop_back();
+    Node* b = nodes.back();
+    nodes.pop_back();
+    nodes.insert(nodes.begin(), test::graph::Add(g.get(), a, b));
+  }
+  test::graph::Send(g.get(), nodes.back(), "b", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING");
+  for (int iters = 0; iters < 8; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez));
+    Rendezvous::Args args;
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                              &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+    rendez->Unref();
+  }
+}
+
+TEST_F(ExecutorTest, InlineRunnerWorkStealing) {
+  // With a runner that executes closures inline, workers nest on the calling
+  // thread.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(1024, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  runner_ = [](std::function<void()> fn) { fn(); };
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(1024.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -340,6 +435,24 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+TEST_F(ExecutorTest, SimpleSwitchDeadWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   auto g = std::make_unique<Graph>(OpRegistry::Global());
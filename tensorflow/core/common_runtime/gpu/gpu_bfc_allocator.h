@@ -46,6 +46,9 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+
+    // See BFCAllocator::Options::thread_cache_bytes.
+    size_t thread_cache_bytes = 0;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
@@ -251,6 +251,114 @@ TEST_P(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST_P(GPUBFCAllocatorTest, ThreadCacheReusesChunks) {
+  GPUBFCAllocator::Options opts;
+  opts.thread_cache_bytes = 1 << 20;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  // Small requests are rounded up to their power-of-two size class.
+  void* p1 = a.AllocateRaw(1, 700);
+  EXPECT_EQ(700, a.RequestedSize(p1));
+  EXPECT_EQ(1024, a.AllocatedSize(p1));
+  const int64_t first_id = a.AllocationId(p1);
+  CheckStats(&a, 1, 1024, 1024, 1024);
+
+  // A freed chunk is parked in the thread cache and handed out again to the
+  // next request of the same class, with a fresh allocation id.
+  a.DeallocateRaw(p1);
+  CheckStats(&a, 1, 0, 1024, 1024);
+  void* p2 = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(p1, p2);
+  EXPECT_EQ(1000, a.RequestedSize(p2));
+  EXPECT_EQ(1024, a.AllocatedSize(p2));
+  EXPECT_GT(a.AllocationId(p2), first_id);
+  CheckStats(&a, 2, 1024, 1024, 1024);
+
+  // Requests of a different class do not reuse the cached chunk.
+  void* p3 = a.AllocateRaw(1, 300);
+  EXPECT_NE(p2, p3);
+  EXPECT_EQ(512, a.AllocatedSize(p3));
+  CheckStats(&a, 3, 1536, 1536, 1024);
+
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p3);
+  CheckStats(&a, 3, 0, 1536, 1024);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCacheReleasesToBins) {
+  GPUBFCAllocator::Options opts;
+  opts.thread_cache_bytes = 4096;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1024));
+  }
+  // Freeing more than the cache can hold returns chunks to the bins in
+  // batches; the stats must not depend on where the chunks ended up.
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  CheckStats(&a, 64, 0, 64 * 1024, 1024);
+
+  // Large allocations bypass the cache and can reuse the released memory.
+  void* large = a.AllocateRaw(1, 64 * 1024 + 1);
+  EXPECT_NE(nullptr, large);
+  EXPECT_EQ(64 * 1024 + 256, a.AllocatedSize(large));
+  a.DeallocateRaw(large);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCacheFlushedOnOOM) {
+  GPUBFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.thread_cache_bytes = 2 << 20;
+  // A 1MiB allocator whose memory is entirely parked in a thread cache must
+  // still satisfy a 1MiB request.
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 20, "GPU_0_bfc", opts);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 64 << 10));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (void* p : ptrs) {
+    a.DeallocateRaw(p);
+  }
+  void* all = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, all);
+  a.DeallocateRaw(all);
+}
+
+TEST_P(GPUBFCAllocatorTest, ThreadCacheMultiThreaded) {
+  GPUBFCAllocator::Options opts;
+  opts.thread_cache_bytes = 64 << 10;
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+  {
+    thread::ThreadPool pool(Env::Default(), "bfc_thread_cache", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        random::PhiloxRandom philox(123, t);
+        random::SimplePhilox rand(&philox);
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 2000; ++i) {
+          if (!ptrs.empty() && rand.Rand32() % 2 == 0) {
+            a.DeallocateRaw(ptrs.back());
+            ptrs.pop_back();
+          } else {
+            ptrs.push_back(a.AllocateRaw(1, 1 + rand.Rand32() % 70000));
+            CHECK(ptrs.back() != nullptr);
+          }
+        }
+        for (void* p : ptrs) {
+          a.DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+}
+
 TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   // Configure a 2MiB byte limit
   GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", {});
@@ -542,6 +650,30 @@ class GPUBFCAllocatorPrivateMethodsTest
     }
   }
 
+  void TestThreadCacheBinDebugInfo() {
+    GPUBFCAllocator::Options opts;
+    opts.thread_cache_bytes = 1 << 20;
+    GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", opts);
+
+    void* in_use = a.AllocateRaw(1, 1024);
+    void* cached = a.AllocateRaw(1, 1024);
+    a.DeallocateRaw(cached);
+    {
+      mutex_lock l(a.lock_);
+      const std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
+          bin_infos = a.get_bin_debug_info();
+      // The cached chunk still occupies bin 2, but is not in use.
+      const BFCAllocator::BinDebugInfo& bin_info = bin_infos[2];
+      EXPECT_EQ(2048, bin_info.total_bytes_in_bin);
+      EXPECT_EQ(1024, bin_info.total_bytes_in_use);
+      EXPECT_EQ(1024, bin_info.total_requested_bytes_in_use);
+      EXPECT_EQ(1, bin_info.total_chunks_in_use);
+      EXPECT_TRUE(a.FlushThreadCaches());
+      EXPECT_FALSE(a.FlushThreadCaches());
+    }
+    a.DeallocateRaw(in_use);
+  }
+
   void TestLog2FloorNonZeroSlow() {
     GPUBFCAllocator a(GetParam()(1ull << 32), 1 /* total_memory */, "GPU_0_bfc",
                       {});
@@ -593,6 +725,10 @@ class GPUBFCAllocatorPrivateMethodsTest
 
 TEST_P(GPUBFCAllocatorPrivateMethodsTest, BinDebugInfo) { TestBinDebugInfo(); }
 
+TEST_P(GPUBFCAllocatorPrivateMethodsTest, ThreadCacheBinDebugInfo) {
+  TestThreadCacheBinDebugInfo();
+}
+
 TEST_P(GPUBFCAllocatorPrivateMethodsTest, Log2FloorNonZeroSlow) {
   TestLog2FloorNonZeroSlow();
 }
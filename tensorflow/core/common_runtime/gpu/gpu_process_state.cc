@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/bfc_allocator.h"
 #include "tensorflow/tsl/framework/device_id.h"
@@ -55,6 +56,22 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+auto* gpu_host_sub_allocator_calls = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu_host_allocator/sub_allocator_calls",
+    "The number of pinned host memory regions allocated or freed by the GPU "
+    "host allocator.",
+    "operation");
+
+auto* gpu_host_sub_allocator_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/gpu_host_allocator/sub_allocator_bytes",
+    "The number of bytes of pinned host memory allocated or freed by the GPU "
+    "host allocator.",
+    "operation");
+
+}  // namespace
+
 // NOLINTNEXTLINE(clang-diagnostic-unused-function)
 static bool UseCudaMallocAllocator() {
   const char* allocator_env = std::getenv("TF_GPU_ALLOCATOR");
@@ -384,6 +401,17 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     mem_limit_bytes = limit_mb * (1LL << 20);
   }
 
+  // Pinning host memory is expensive and serializes with other GPU work, so
+  // allow reserving the expected working set of the allocator up front.
+  int64_t preallocate_mb = 0;
+  Status status = tsl::ReadInt64FromEnvVar("TF_GPU_HOST_MEM_PREALLOCATE_IN_MB",
+                                           0, &preallocate_mb);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetGpuHostAllocator: " << status.message();
+  }
+  const int64_t preallocate_bytes =
+      std::min<int64_t>(preallocate_mb * (1LL << 20), mem_limit_bytes);
+
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
     while (gpu_host_alloc_visitors_.size() <= numa_node) {
       gpu_host_alloc_visitors_.push_back({});
@@ -391,9 +419,23 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     while (gpu_host_free_visitors_.size() <= numa_node) {
       gpu_host_free_visitors_.push_back({});
     }
+    // Every region allocated or freed by the sub-allocator is a call to the
+    // driver, so count them to monitor how well the pool absorbs the
+    // allocations.
+    std::vector<SubAllocator::Visitor> alloc_visitors =
+        gpu_host_alloc_visitors_[numa_node];
+    alloc_visitors.push_back([](void* ptr, int index, size_t num_bytes) {
+      gpu_host_sub_allocator_calls->GetCell("alloc")->IncrementBy(1);
+      gpu_host_sub_allocator_bytes->GetCell("alloc")->IncrementBy(num_bytes);
+    });
+    std::vector<SubAllocator::Visitor> free_visitors =
+        gpu_host_free_visitors_[numa_node];
+    free_visitors.push_back([](void* ptr, int index, size_t num_bytes) {
+      gpu_host_sub_allocator_calls->GetCell("free")->IncrementBy(1);
+      gpu_host_sub_allocator_bytes->GetCell("free")->IncrementBy(num_bytes);
+    });
     SubAllocator* sub_allocator = new DeviceHostAllocator(
-        se, numa_node, gpu_host_alloc_visitors_[numa_node],
-        gpu_host_free_visitors_[numa_node]);
+        se, numa_node, alloc_visitors, free_visitors);
 
     tsl::BFCAllocator::Options allocator_opts;
     allocator_opts.allow_growth =
@@ -402,6 +444,22 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
         new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
                               /*name=*/"gpu_host_bfc", allocator_opts);
 
+    if (preallocate_bytes > 0) {
+      // The BFC allocator keeps the regions that it allocates, so a single
+      // allocation reserves the memory for all later ones, whatever their
+      // sizes.
+      void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                         preallocate_bytes);
+      if (ptr != nullptr) {
+        allocator->DeallocateRaw(ptr);
+        VLOG(1) << "Preallocated " << preallocate_bytes
+                << " bytes of GPU host memory on NUMA node " << numa_node;
+      } else {
+        LOG(WARNING) << "Failed to preallocate " << preallocate_bytes
+                     << " bytes of GPU host memory on NUMA node " << numa_node;
+      }
+    }
+
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
       // at the cost of performance.
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/reffed_status_callback.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -394,6 +395,146 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       });
 }
 
+/*static*/
+void GPUUtil::CopyCPUTensorsToGPU(absl::Span<const Tensor* const> cpu_tensors,
+                                  const DeviceContext* device_context,
+                                  Device* gpu_device,
+                                  std::vector<Tensor>* gpu_tensors,
+                                  StatusCallback done, bool sync_dst_compute) {
+  VLOG(1) << "CopyCPUTensorsToGPU: " << cpu_tensors.size() << " tensors";
+  // `done` is called once this function and all the copies release their
+  // reference.
+  auto* status_cb = new ReffedStatusCallback(std::move(done));
+  core::ScopedUnref status_cb_unref(status_cb);
+
+  Allocator* gpu_allocator = gpu_device->GetAllocator(AllocatorAttributes());
+  Allocator* host_memory_allocator =
+      device_context == nullptr ? nullptr
+                                : device_context->host_memory_allocator();
+
+  // Lay out the small tensors in the staging buffer. Each one starts at an
+  // aligned offset, so that its device view is as aligned as a separately
+  // allocated tensor.
+  const int64_t kAlignment = Allocator::kAllocatorAlignment;
+  std::vector<int64_t> offsets(cpu_tensors.size(), -1);
+  int64_t staging_bytes = 0;
+  int num_coalesced = 0;
+  for (size_t i = 0; i < cpu_tensors.size(); ++i) {
+    const Tensor* cpu_tensor = cpu_tensors[i];
+    const int64_t total_bytes = cpu_tensor->TotalBytes();
+    if (total_bytes > 0 && total_bytes <= kMaxCoalescedCopyBytes &&
+        DMAHelper::CanUseDMA(cpu_tensor)) {
+      offsets[i] = staging_bytes;
+      staging_bytes +=
+          (total_bytes + kAlignment - 1) / kAlignment * kAlignment;
+      ++num_coalesced;
+    }
+  }
+
+  // Coalescing only pays off for two or more tensors, and needs a pinned
+  // staging buffer. Byte buffers can only be viewed as other types without a
+  // copy on little-endian hosts.
+  Tensor packed_gpu_tensor;
+  void* staging_buffer = nullptr;
+  if (num_coalesced >= 2 && host_memory_allocator != nullptr &&
+      port::kLittleEndian) {
+    packed_gpu_tensor =
+        Tensor(gpu_allocator, DT_INT8, TensorShape({staging_bytes}));
+    staging_buffer = host_memory_allocator->AllocateRaw(
+        Allocator::kAllocatorAlignment, staging_bytes);
+  }
+  if (staging_buffer == nullptr || !packed_gpu_tensor.IsInitialized()) {
+    // Fall back to copying every tensor individually.
+    if (staging_buffer != nullptr) {
+      host_memory_allocator->DeallocateRaw(staging_buffer);
+    }
+    std::fill(offsets.begin(), offsets.end(), -1);
+    num_coalesced = 0;
+  } else {
+    const DeviceBase::AcceleratorDeviceInfo* dev_info = nullptr;
+    se::Stream* recv_stream = nullptr;
+    const Tensor* first_coalesced = cpu_tensors[std::distance(
+        offsets.begin(),
+        std::find_if(offsets.begin(), offsets.end(),
+                     [](int64_t offset) { return offset >= 0; }))];
+    Status s = PrepareCopy(gpu_device, device_context, *first_coalesced,
+                           /*dst=*/nullptr, &dev_info, &recv_stream);
+    auto recv_host_to_device_stream =
+        s.ok() ? static_cast<const GPUDeviceContext*>(device_context)
+                     ->host_to_device_stream()
+               : nullptr;
+    if (s.ok() && recv_host_to_device_stream == nullptr) {
+      s = errors::Internal("No send gpu copy-out-stream is available.");
+    }
+    if (!s.ok()) {
+      host_memory_allocator->DeallocateRaw(staging_buffer);
+      status_cb->UpdateStatus(s);
+      return;
+    }
+    // Wait for the recv-stream to make sure the buffer is truly available.
+    if (sync_dst_compute) {
+      recv_host_to_device_stream->ThenWaitFor(recv_stream);
+    }
+
+    char* staging_base = static_cast<char*>(staging_buffer);
+    for (size_t i = 0; i < cpu_tensors.size(); ++i) {
+      if (offsets[i] >= 0) {
+        std::memcpy(staging_base + offsets[i], GetBase(cpu_tensors[i]),
+                    cpu_tensors[i]->TotalBytes());
+      }
+    }
+    DeviceMemoryBase gpu_dst_ptr(GetBase(&packed_gpu_tensor), staging_bytes);
+    recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, staging_buffer,
+                                           staging_bytes);
+
+    status_cb->Ref();
+    dev_info->event_mgr->ThenExecute(
+        recv_host_to_device_stream,
+        [recv_host_to_device_stream, status_cb, staging_buffer,
+         host_memory_allocator, packed_gpu_tensor]() {
+          host_memory_allocator->DeallocateRaw(staging_buffer);
+          if (!recv_host_to_device_stream->ok()) {
+            LOG(FATAL) << "CPU->GPU Memcpy failed";
+          }
+          status_cb->Unref();
+        });
+  }
+  VLOG(2) << "Coalesced " << num_coalesced << " of " << cpu_tensors.size()
+          << " CPU->GPU copies into " << staging_bytes << " bytes";
+
+  gpu_tensors->clear();
+  gpu_tensors->reserve(cpu_tensors.size());
+  for (size_t i = 0; i < cpu_tensors.size(); ++i) {
+    const Tensor* cpu_tensor = cpu_tensors[i];
+    if (offsets[i] >= 0) {
+      // A view of the tensor's bytes in the packed device buffer.
+      Tensor& gpu_tensor = gpu_tensors->emplace_back();
+      status_cb->UpdateStatus(gpu_tensor.BitcastFrom(
+          packed_gpu_tensor.Slice(offsets[i],
+                                  offsets[i] + cpu_tensor->TotalBytes()),
+          cpu_tensor->dtype(), cpu_tensor->shape()));
+      continue;
+    }
+    Tensor& gpu_tensor = gpu_tensors->emplace_back(
+        gpu_allocator, cpu_tensor->dtype(), cpu_tensor->shape());
+    if (cpu_tensor->TotalBytes() > 0 && !gpu_tensor.IsInitialized()) {
+      status_cb->UpdateStatus(errors::ResourceExhausted(
+          "OOM when allocating tensor of shape ",
+          cpu_tensor->shape().DebugString(), " and type ",
+          DataTypeString(cpu_tensor->dtype()), " for a CPU->GPU copy"));
+      continue;
+    }
+    status_cb->Ref();
+    CopyCPUTensorToGPU(
+        cpu_tensor, device_context, gpu_device, &gpu_tensor,
+        [status_cb](const Status& s) {
+          status_cb->UpdateStatus(s);
+          status_cb->Unref();
+        },
+        sync_dst_compute);
+  }
+}
+
 Status GPUUtil::Sync(Device* gpu_device) {
   VLOG(1) << "GPUUtil::Sync";
   auto* dev_info = gpu_device->tensorflow_accelerator_device_info();
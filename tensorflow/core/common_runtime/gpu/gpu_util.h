@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_UTIL_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_UTIL_H_
 
+#include <vector>
+
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -90,6 +93,22 @@ class GPUUtil {
                                  Device* gpu_device, Tensor* gpu_tensor,
                                  StatusCallback done, bool sync_dst_compute);
 
+  // Tensors of at most this many bytes are coalesced by CopyCPUTensorsToGPU.
+  static constexpr int64_t kMaxCoalescedCopyBytes = 16 << 10;
+
+  // Copies each of 'cpu_tensors' to 'gpu_device', into a tensor allocated on
+  // 'gpu_device' and stored at the same index of 'gpu_tensors'. Small tensors
+  // (see kMaxCoalescedCopyBytes) are packed into one host staging buffer and
+  // transferred with a single memcpy; their copies are views into one device
+  // buffer. This avoids paying the per-copy launch overhead for each of them.
+  // Other tensors are copied as by CopyCPUTensorToGPU(). 'done' is called once
+  // all the copies have completed.
+  static void CopyCPUTensorsToGPU(absl::Span<const Tensor* const> cpu_tensors,
+                                  const DeviceContext* device_context,
+                                  Device* gpu_device,
+                                  std::vector<Tensor>* gpu_tensors,
+                                  StatusCallback done, bool sync_dst_compute);
+
   static void DeviceToDeviceCopy(
       DeviceContext* send_dev_context, DeviceContext* recv_dev_context,
       Device* src, Device* dst, AllocatorAttributes src_alloc_attr,
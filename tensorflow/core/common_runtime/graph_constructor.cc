@@ -1563,9 +1563,10 @@ Status ConvertNodeDefsToGraph(const GraphConstructorOptions& opts,
                                      /*missing_unused_input_map_keys=*/nullptr);
 }
 
-Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
-                      Graph* g, ShapeRefiner* refiner,
-                      ImportGraphDefResults* results) {
+namespace {
+
+Status ValidateImportGraphDefArgs(const ImportGraphDefOptions& opts,
+                                  const ImportGraphDefResults* results) {
   if (!opts.return_tensors.empty()) {
     if (results == nullptr) {
       return errors::InvalidArgument(
@@ -1594,24 +1595,25 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
           "All fields in results argument to ImportGraphDef() must be empty.");
     }
   }
+  return OkStatus();
+}
 
-  ShapeRefiner default_refiner(gdef.versions().producer(), g->op_registry());
-  if (refiner == nullptr) {
-    refiner = &default_refiner;
-  } else {
-    // Log a warning if we are importing a GraphDef at an older
-    // producer version after already having added non-source/sink
-    // nodes to the graph in the past.
-    if (gdef.versions().producer() > 0 &&
-        gdef.versions().producer() < refiner->graph_def_version() &&
-        g->num_nodes() > 2) {
-      LOG(WARNING) << "Importing a graph with a lower producer version "
-                   << gdef.versions().producer()
-                   << " into an existing graph with producer version "
-                   << refiner->graph_def_version() << ". Shape inference will "
-                   << "have run different parts of the graph with different "
-                   << "producer versions.";
-    }
+// Sets the graph def version of `refiner`, which is about to be used to import
+// a graph with `versions` into `g`.
+void UpdateRefinerGraphDefVersion(const VersionDef& versions, const Graph& g,
+                                  ShapeRefiner* refiner) {
+  // Log a warning if we are importing a GraphDef at an older
+  // producer version after already having added non-source/sink
+  // nodes to the graph in the past.
+  if (versions.producer() > 0 &&
+      versions.producer() < refiner->graph_def_version() &&
+      g.num_nodes() > 2) {
+    LOG(WARNING) << "Importing a graph with a lower producer version "
+                 << versions.producer()
+                 << " into an existing graph with producer version "
+                 << refiner->graph_def_version() << ". Shape inference will "
+                 << "have run different parts of the graph with different "
+                 << "producer versions.";
   }
 
   // Set the graph def version of the refiner as the min of the
@@ -1622,7 +1624,22 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
   // on the entire graph if the producer version has changed.  For now
   // we log the warning above.
   refiner->set_graph_def_version(
-      std::min(refiner->graph_def_version(), gdef.versions().producer()));
+      std::min(refiner->graph_def_version(), versions.producer()));
+}
+
+}  // namespace
+
+Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
+                      Graph* g, ShapeRefiner* refiner,
+                      ImportGraphDefResults* results) {
+  TF_RETURN_IF_ERROR(ValidateImportGraphDefArgs(opts, results));
+
+  ShapeRefiner default_refiner(gdef.versions().producer(), g->op_registry());
+  if (refiner == nullptr) {
+    refiner = &default_refiner;
+  } else {
+    UpdateRefinerGraphDefVersion(gdef.versions(), *g, refiner);
+  }
 
   if (results == nullptr) {
     return GraphConstructor::Construct(opts, gdef.node(), &gdef.versions(),
@@ -1636,6 +1653,28 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
   }
 }
 
+Status ImportGraphDef(const ImportGraphDefOptions& opts, GraphDef&& gdef,
+                      Graph* g, ShapeRefiner* refiner,
+                      ImportGraphDefResults* results) {
+  TF_RETURN_IF_ERROR(ValidateImportGraphDefArgs(opts, results));
+
+  ShapeRefiner default_refiner(gdef.versions().producer(), g->op_registry());
+  if (refiner == nullptr) {
+    refiner = &default_refiner;
+  } else {
+    UpdateRefinerGraphDefVersion(gdef.versions(), *g, refiner);
+  }
+
+  if (results == nullptr) {
+    return GraphConstructor::Construct(opts, std::move(gdef), g, refiner,
+                                       nullptr, nullptr, nullptr);
+  } else {
+    return GraphConstructor::Construct(
+        opts, std::move(gdef), g, refiner, &results->return_tensors,
+        &results->return_nodes, &results->missing_unused_input_map_keys);
+  }
+}
+
 void CopyGraph(const Graph& src, Graph* dest) { dest->Copy(src); }
 
 }  // namespace tensorflow
@@ -198,6 +198,13 @@ extern Status ImportGraphDef(const ImportGraphDefOptions& opts,
                              ShapeRefiner* refiner,
                              ImportGraphDefResults* results = nullptr);
 
+// Same as above, but takes ownership of `gdef` and moves its NodeDefs into the
+// nodes of `g` instead of copying them, so that large graphs, e.g. with big
+// constants, don't have to be held in memory twice while they are imported.
+extern Status ImportGraphDef(const ImportGraphDefOptions& opts,
+                             GraphDef&& gdef, Graph* g, ShapeRefiner* refiner,
+                             ImportGraphDefResults* results = nullptr);
+
 // Make a copy of "src" into "*dest".
 //
 // REQUIRES: "*dest" is a freshly allocated graph without any nodes or edges
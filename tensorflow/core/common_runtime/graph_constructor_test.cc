@@ -1782,6 +1782,34 @@ TEST_F(GraphConstructorTest, ImportGraphDef_ReturnNodes) {
   EXPECT_EQ(results.return_nodes[0]->name(), "new_input");
 }
 
+TEST_F(GraphConstructorTest, ImportGraphDef_MovedGraphDef) {
+  ShapeRefiner refiner(TF_GRAPH_DEF_VERSION, graph_.op_registry());
+
+  GraphDef gdef;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: ['input:0', 'input:1'] }",
+      &gdef));
+  ImportGraphDefOptions opts;
+  opts.prefix = "import";
+  opts.return_tensors.push_back({"t1", 0});
+  opts.return_nodes.push_back("input");
+  ImportGraphDefResults results;
+  TF_ASSERT_OK(
+      ImportGraphDef(opts, std::move(gdef), &graph_, &refiner, &results));
+
+  EXPECT_TRUE(HasNode("import/input"));
+  EXPECT_TRUE(HasNode("import/t1"));
+  EXPECT_TRUE(HasEdge("import/input", 0, "import/t1", 0));
+  EXPECT_TRUE(HasEdge("import/input", 1, "import/t1", 1));
+
+  ASSERT_EQ(results.return_tensors.size(), 1);
+  EXPECT_EQ(results.return_tensors[0].first->name(), "import/t1");
+  EXPECT_EQ(results.return_tensors[0].second, 0);
+  ASSERT_EQ(results.return_nodes.size(), 1);
+  EXPECT_EQ(results.return_nodes[0]->name(), "import/input");
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef_ReturnNodesErrors) {
   // Null results with non-empty opts.return_nodes
   ImportGraphDefOptions opts;
@@ -56,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/util/util.h"
 
 #ifndef IS_MOBILE_PLATFORM
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
@@ -810,11 +811,37 @@ Status GraphExecutionState::OptimizeGraph(
       }
     }
 
+    // Reuse the graph optimized by any session of the process (or written to
+    // the cache directory) for the same item, if the cache is enabled.
+    const ConfigProto::Experimental& experimental =
+        session_options_->config.experimental();
+    const string& cache_directory =
+        experimental.optimized_graph_cache_directory();
+    const bool use_cache = experimental.enable_optimized_graph_cache() ||
+                           !cache_directory.empty();
+    string cache_key;
+    std::shared_ptr<const GraphDef> cached_graph;
+    if (use_cache) {
+      cache_key = OptimizedGraphCache::ComputeKey(item, *device_set_,
+                                                  session_options_->config);
+      cached_graph =
+          OptimizedGraphCache::Global()->Lookup(cache_key, cache_directory);
+    }
+
     // Now we can run the MetaOptimizer on the constructed GrapplerItem.
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(
-        grappler::RunMetaOptimizer(std::move(item), session_options_->config,
-                                   cpu_device, &cluster, &new_graph));
+    if (cached_graph != nullptr) {
+      VLOG(1) << "Using cached optimized graph " << cache_key;
+      new_graph = *cached_graph;
+    } else {
+      TF_RETURN_IF_ERROR(
+          grappler::RunMetaOptimizer(std::move(item), session_options_->config,
+                                     cpu_device, &cluster, &new_graph));
+      if (use_cache) {
+        OptimizedGraphCache::Global()->Insert(cache_key, cache_directory,
+                                              new_graph);
+      }
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
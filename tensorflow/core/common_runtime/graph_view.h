@@ -107,6 +107,10 @@ struct NodeItem {
   // Number of output control edges.
   int32 num_output_control_edges;
 
+  // Position of this node in the memory-aware schedule that Grappler attached
+  // as the "_scheduling_order" attr, or -1 if the node has no such attr.
+  int32 scheduling_order = -1;
+
   // If non-null, contains an array of num_outputs bools, where the ith bool
   // is true if and only if the ith output is consumed by another node.
   std::unique_ptr<bool[]> outputs_required;
@@ -0,0 +1,322 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+
+// Stages of the algorithm, used to key the transfers.
+enum Stage {
+  kLocalReduceScatter = 0,
+  kCrossTaskReduceScatter = 1,
+  kCrossTaskAllGather = 2,
+  kLocalAllGather = 3,
+};
+
+// Converts `src` into the pre-allocated `dst`, between float and the wire
+// types used for compression.
+void CastOnHost(const Tensor& src, Tensor* dst) {
+  if (src.dtype() == DT_FLOAT && dst->dtype() == DT_BFLOAT16) {
+    dst->flat<bfloat16>() = src.flat<float>().cast<bfloat16>();
+  } else if (src.dtype() == DT_FLOAT && dst->dtype() == DT_HALF) {
+    dst->flat<Eigen::half>() = src.flat<float>().cast<Eigen::half>();
+  } else if (src.dtype() == DT_BFLOAT16 && dst->dtype() == DT_FLOAT) {
+    dst->flat<float>() = src.flat<bfloat16>().cast<float>();
+  } else {
+    DCHECK(src.dtype() == DT_HALF && dst->dtype() == DT_FLOAT);
+    dst->flat<float>() = src.flat<Eigen::half>().cast<float>();
+  }
+}
+
+Tensor CastOnHost(const Tensor& src, DataType dtype) {
+  Tensor dst(dtype, src.shape());
+  CastOnHost(src, &dst);
+  return dst;
+}
+
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::Unimplemented(
+        "HierarchicalRingReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  Status s = RunAllReduce();
+  if (!s.ok()) {
+    LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+    // Unless the op is being cancelled, abort the transfers of the other
+    // devices of the group.
+    CancellationManager* cm = col_ctx_->op_ctx->cancellation_manager();
+    if (cm == nullptr || (!cm->IsCancelled() && !cm->IsCancelling())) {
+      col_ctx_->col_exec->StartAbort(s);
+    }
+  }
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << s;
+  done(s);
+}
+
+Status HierarchicalRingReducer::RunAllReduce() {
+  // Start by copying input to output if they're not already the same.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+  if (col_ctx_->output->NumElements() == 0) return OkStatus();
+
+  // Devices of the same task are adjacent in the group. Split the group into
+  // the ring of the devices of this task and the ring of the devices with the
+  // same local index in every task, when all the tasks have the same number of
+  // devices.
+  const std::vector<CollGroupMember>& members = col_params_->group.members;
+  const int group_size = col_params_->group.group_size;
+  const int rank = col_params_->default_rank;
+  int num_local = 0;
+  bool uniform = true;
+  for (int begin = 0; begin < group_size;) {
+    int end = begin + 1;
+    while (end < group_size && members[end].task == members[begin].task) {
+      ++end;
+    }
+    if (num_local == 0) num_local = end - begin;
+    uniform &= (end - begin == num_local);
+    begin = end;
+  }
+  if (!uniform) num_local = group_size;
+  const int num_tasks = group_size / num_local;
+  Ring local_ring;
+  Ring cross_task_ring;
+  const int task_begin = rank - rank % num_local;
+  for (int i = 0; i < num_local; ++i) {
+    local_ring.members.push_back(task_begin + i);
+  }
+  local_ring.rank = rank % num_local;
+  for (int t = 0; t < num_tasks; ++t) {
+    cross_task_ring.members.push_back(t * num_local + local_ring.rank);
+  }
+  cross_task_ring.rank = rank / num_local;
+
+  const DataType dtype = col_params_->instance.data_type;
+  DataType wire_type = dtype;
+  const string& hint = col_params_->instance.impl_details.communication_hint;
+  if (dtype == DT_FLOAT && hint == "hierarchical_ring_bf16") {
+    wire_type = DT_BFLOAT16;
+  } else if (dtype == DT_FLOAT && hint == "hierarchical_ring_fp16") {
+    wire_type = DT_HALF;
+  }
+  VLOG(1) << "HierarchicalRingReducer::Run for device "
+          << col_ctx_->device_name << " default_rank " << rank << " tasks "
+          << num_tasks << " local devices " << num_local << " wire type "
+          << DataTypeString(wire_type);
+
+  Allocator* allocator = col_ctx_->device->GetAllocator(
+      col_ctx_->op_ctx->output_alloc_attr(0));
+  std::unique_ptr<CollectiveAdapter> local_ca(
+      MakeCollectiveAdapter(col_ctx_->output, num_local, allocator));
+  Status status = [&]() -> Status {
+    TF_RETURN_IF_ERROR(
+        ReduceScatter(kLocalReduceScatter, local_ring, dtype, local_ca.get()));
+
+    // The shard of this device may be empty for tiny tensors, in which case
+    // it is empty for all the devices of the cross-task ring too.
+    Tensor shard = local_ca->ChunkAlias((local_ring.rank + 1) % num_local);
+    if (shard.NumElements() > 0) {
+      std::unique_ptr<CollectiveAdapter> cross_task_ca(
+          MakeCollectiveAdapter(&shard, num_tasks, allocator));
+      TF_RETURN_IF_ERROR(ReduceScatter(kCrossTaskReduceScatter,
+                                       cross_task_ring, wire_type,
+                                       cross_task_ca.get()));
+      // This device is the only one holding the total of its chunk.
+      Tensor chunk = cross_task_ca->ChunkAlias((cross_task_ring.rank + 1) %
+                                               num_tasks);
+      if (col_params_->final_op != nullptr) {
+        Tensor group_size_tensor = cross_task_ca->Scalar(group_size);
+        TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+            col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+            col_params_->final_op, &chunk, &group_size_tensor));
+      }
+      if (wire_type != dtype) {
+        // Round the chunk like the copies sent to the other tasks, so that all
+        // the devices get the same value.
+        CastOnHost(CastOnHost(chunk, wire_type), &chunk);
+      }
+      TF_RETURN_IF_ERROR(AllGather(kCrossTaskAllGather, cross_task_ring,
+                                   wire_type, cross_task_ca.get()));
+    }
+    return AllGather(kLocalAllGather, local_ring, dtype, local_ca.get());
+  }();
+  if (status.ok()) {
+    local_ca->ConsumeFinalValue(col_ctx_->output);
+  }
+  return status;
+}
+
+Status HierarchicalRingReducer::ReduceScatter(int stage, const Ring& ring,
+                                             DataType wire_type,
+                                             CollectiveAdapter* ca) {
+  profiler::TraceMe activity("ReduceScatter", profiler::TraceMeLevel::kInfo);
+  const int n = ring.members.size();
+  const bool compress = wire_type != col_params_->instance.data_type;
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_chunk = (ring.rank - step + n) % n;
+    const int recv_chunk = (ring.rank - step - 1 + 2 * n) % n;
+    Tensor received = ca->TempChunk(recv_chunk);
+    if (compress) {
+      Tensor wire_received(wire_type, received.shape());
+      TF_RETURN_IF_ERROR(SendRecv(stage, step, ring,
+                                  CastOnHost(ca->ChunkAlias(send_chunk),
+                                             wire_type),
+                                  &wire_received));
+      CastOnHost(wire_received, &received);
+    } else {
+      TF_RETURN_IF_ERROR(
+          SendRecv(stage, step, ring, ca->ChunkAlias(send_chunk), &received));
+    }
+    Tensor chunk = ca->ChunkAlias(recv_chunk);
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &chunk, &received));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::AllGather(int stage, const Ring& ring,
+                                         DataType wire_type,
+                                         CollectiveAdapter* ca) {
+  profiler::TraceMe activity("AllGather", profiler::TraceMeLevel::kInfo);
+  const int n = ring.members.size();
+  const bool compress = wire_type != col_params_->instance.data_type;
+  for (int step = 0; step < n - 1; ++step) {
+    const int send_chunk = (ring.rank + 1 - step + n) % n;
+    const int recv_chunk = (ring.rank - step + n) % n;
+    Tensor chunk = ca->ChunkAlias(recv_chunk);
+    if (compress) {
+      Tensor wire_received(wire_type, chunk.shape());
+      TF_RETURN_IF_ERROR(SendRecv(stage, step, ring,
+                                  CastOnHost(ca->ChunkAlias(send_chunk),
+                                             wire_type),
+                                  &wire_received));
+      CastOnHost(wire_received, &chunk);
+    } else {
+      TF_RETURN_IF_ERROR(
+          SendRecv(stage, step, ring, ca->ChunkAlias(send_chunk), &chunk));
+    }
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::SendRecv(int stage, int step, const Ring& ring,
+                                         const Tensor& send, Tensor* recv) {
+  const int n = ring.members.size();
+  const int self = ring.members[ring.rank];
+  const CollGroupMember& next = col_params_->group.members[ring.members[
+      (ring.rank + 1) % n]];
+  const int prev_idx = ring.members[(ring.rank + n - 1) % n];
+  const CollGroupMember& prev = col_params_->group.members[prev_idx];
+  // Each device sends a single tensor per step of each stage.
+  auto buf_key = [this, stage, step](int sender) {
+    return strings::StrCat(col_ctx_->exec_key, ":hring:", stage, ":", step,
+                           ":", sender);
+  };
+  VLOG(3) << "SendRecv stage " << stage << " step " << step << " to "
+          << next.device.name() << " from " << prev.device.name();
+
+  mutex mu;
+  Status status;
+  BlockingCounter pending(2);
+  auto done = [&mu, &status, &pending](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      next.device.name(), next.task, buf_key(self), col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), &send, col_ctx_->device_locality,
+      col_params_->instance.impl_details.sub_chunk_bytes,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      prev.device.name(), prev.task, prev.is_local, buf_key(prev_idx),
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), recv, col_ctx_->device_locality,
+      0 /*stream_index*/, col_params_->instance.impl_details.sub_chunk_bytes,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
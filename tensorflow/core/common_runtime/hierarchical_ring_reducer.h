@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical ring implementation of collective all-reduce, for CPU devices.
+//
+// The flat ring of `RingReducer` sends the whole tensor across every link of
+// the ring, including the links between tasks. This implementation instead
+// runs three stages:
+//   1. a ring reduce-scatter among the devices of each task, after which each
+//      local device owns one shard of the task's partial sum;
+//   2. a ring all-reduce of each shard among the devices of the same local
+//      index in every task, so that only 1/num_local_devices of the tensor
+//      crosses task boundaries per device;
+//   3. a ring all-gather among the devices of each task.
+//
+// It is selected with the "hierarchical_ring" communication hint. With the
+// "hierarchical_ring_bf16" and "hierarchical_ring_fp16" hints, float tensors
+// are sent between tasks as bfloat16 or half, at the cost of precision; every
+// device still ends up with the same value. When tasks have different numbers
+// of devices, the group is reduced with a single flat ring.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // The group members forming one ring, in ring order, and the position of
+  // this device in the ring.
+  struct Ring {
+    std::vector<int> members;
+    int rank = 0;
+  };
+
+  Status RunAllReduce();
+
+  // Reduces the chunks of `ca` over `ring`. On return, this device holds the
+  // reduced chunk (ring.rank + 1) % ring size.
+  Status ReduceScatter(int stage, const Ring& ring, DataType wire_type,
+                       CollectiveAdapter* ca);
+
+  // Inverse of `ReduceScatter`, sending the chunk owned by this device to
+  // every other device of `ring`.
+  Status AllGather(int stage, const Ring& ring, DataType wire_type,
+                   CollectiveAdapter* ca);
+
+  // Sends `send` to the next device of `ring`, while receiving `recv` from
+  // the previous one.
+  Status SendRecv(int stage, int step, const Ring& ring, const Tensor& send,
+                  Tensor* recv);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
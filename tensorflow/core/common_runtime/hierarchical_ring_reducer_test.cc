@@ -0,0 +1,156 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinaryOp(const string& op, DataType dtype,
+                                      DeviceBase* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder("binary_op", op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> kernel = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return kernel;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  // Computes the mean of one tensor of `tensor_len` elements per device, and
+  // checks that every device gets the same result, within `tolerance`.
+  void RunTest(int num_workers, int num_devices, int tensor_len,
+               const string& communication_hint, float tolerance) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<float> expected(tensor_len, 0.0f);
+    for (int rank = 0; rank < group_size; ++rank) {
+      auto instance = std::make_unique<DeviceInstance>();
+      instance->col_params = CreateCollectiveParams(
+          *test_env_, rank, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+          DT_FLOAT, TensorShape({tensor_len}));
+      instance->col_params->instance.impl_details.communication_hint =
+          communication_hint;
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          instance->col_params->group.members[rank].device.name(),
+          &instance->device));
+      instance->merge_op = GetBinaryOp("Add", DT_FLOAT, instance->device);
+      instance->final_op = GetBinaryOp("Div", DT_FLOAT, instance->device);
+      instance->col_params->merge_op = instance->merge_op.get();
+      instance->col_params->final_op = instance->final_op.get();
+      instance->tensor = Tensor(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        const float value = rank * 0.5f + i;
+        instance->tensor.flat<float>()(i) = value;
+        expected[i] += value;
+      }
+      instances_.push_back(std::move(instance));
+    }
+    for (float& value : expected) value /= group_size;
+
+    std::atomic<int> done(0);
+    for (auto& instance : instances_) {
+      SchedClosure([this, &instance, &done] {
+        instance->status =
+            RunCollective(test_env_.get(), instance->col_params.get(),
+                          instance->device, &instance->tensor,
+                          &instance->tensor);
+        ++done;
+      });
+    }
+    while (done < group_size) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+
+    for (const auto& instance : instances_) {
+      TF_ASSERT_OK(instance->status);
+      test::ExpectClose(test::AsTensor<float>(expected), instance->tensor,
+                        /*atol=*/tolerance, /*rtol=*/tolerance);
+      // Compression must not make the devices disagree.
+      test::ExpectTensorEqual<float>(instances_[0]->tensor, instance->tensor);
+    }
+  }
+
+  struct DeviceInstance {
+    core::RefCountPtr<CollectiveParams> col_params;
+    Device* device = nullptr;
+    std::unique_ptr<OpKernel> merge_op;
+    std::unique_ptr<OpKernel> final_op;
+    Tensor tensor;
+    Status status;
+  };
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalRingReducerTest, SingleWorker) {
+  RunTest(/*num_workers=*/1, /*num_devices=*/4, /*tensor_len=*/1001,
+          "hierarchical_ring", /*tolerance=*/1e-5);
+}
+
+TEST_F(HierarchicalRingReducerTest, SingleDevicePerWorker) {
+  RunTest(/*num_workers=*/3, /*num_devices=*/1, /*tensor_len=*/1001,
+          "hierarchical_ring", /*tolerance=*/1e-5);
+}
+
+TEST_F(HierarchicalRingReducerTest, MultipleWorkers) {
+  RunTest(/*num_workers=*/3, /*num_devices=*/4, /*tensor_len=*/4095,
+          "hierarchical_ring", /*tolerance=*/1e-5);
+}
+
+TEST_F(HierarchicalRingReducerTest, TinyTensor) {
+  // Leaves some devices without any element to reduce across workers.
+  RunTest(/*num_workers=*/2, /*num_devices=*/4, /*tensor_len=*/3,
+          "hierarchical_ring", /*tolerance=*/1e-5);
+}
+
+TEST_F(HierarchicalRingReducerTest, Bfloat16Compression) {
+  RunTest(/*num_workers=*/2, /*num_devices=*/2, /*tensor_len=*/1001,
+          "hierarchical_ring_bf16", /*tolerance=*/1e-2);
+}
+
+TEST_F(HierarchicalRingReducerTest, HalfCompression) {
+  RunTest(/*num_workers=*/2, /*num_devices=*/2, /*tensor_len=*/1001,
+          "hierarchical_ring_fp16", /*tolerance=*/1e-2);
+}
+
+}  // namespace
+}  // namespace tensorflow
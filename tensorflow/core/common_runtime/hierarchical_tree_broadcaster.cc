@@ -426,8 +426,9 @@ void HierarchicalTreeBroadcaster::DispatchSend(int subdiv, int dst_rank,
       col_params_->group.members[dst_idx].task, send_buf_key, col_ctx_->device,
       col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
-      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      col_ctx_->device_locality,
+      col_params_->instance.impl_details.sub_chunk_bytes,
+      col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
 void HierarchicalTreeBroadcaster::DispatchRecv(int subdiv, int src_rank,
@@ -448,6 +449,7 @@ void HierarchicalTreeBroadcaster::DispatchRecv(int subdiv, int src_rank,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
       col_ctx_->device_locality, 0 /*stream_index*/,
+      col_params_->instance.impl_details.sub_chunk_bytes,
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
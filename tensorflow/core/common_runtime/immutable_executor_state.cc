@@ -28,6 +28,9 @@ limitations under the License.
 namespace tensorflow {
 
 namespace {
+// Attached by Grappler's memory optimizer, see EstimateMemoryAwareSchedule.
+constexpr char kSchedulingOrderAttr[] = "_scheduling_order";
+
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
@@ -99,6 +102,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
+  has_scheduling_order_ = false;
   for (const Node* n : graph.nodes()) {
     if (IsSink(n)) continue;
     if (IsSwitch(n) || IsMerge(n) || IsEnter(n) || IsExit(n)) {
@@ -196,6 +200,10 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    if (TryGetNodeAttr(n->attrs(), kSchedulingOrderAttr,
+                       &item->scheduling_order)) {
+      has_scheduling_order_ = true;
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
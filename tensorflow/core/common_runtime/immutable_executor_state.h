@@ -101,6 +101,10 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // True if any node carries a memory-aware scheduling order, in which case
+  // ready nodes should be run in that order.
+  bool has_scheduling_order() const { return has_scheduling_order_; }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -132,6 +136,7 @@ class ImmutableExecutorState {
   LocalExecutorParams params_;
   GraphView gview_;
   bool requires_control_flow_;
+  bool has_scheduling_order_;
   std::vector<PendingCounts::Handle> pending_ids_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
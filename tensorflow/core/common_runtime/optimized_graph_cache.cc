@@ -0,0 +1,181 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/version_info.h"
+
+namespace tensorflow {
+namespace {
+
+std::string GetFilePath(const std::string& directory, const std::string& key) {
+  return io::JoinPath(directory, absl::StrCat(key, ".graph_def.pb"));
+}
+
+Status WriteGraph(const std::string& directory, const std::string& key,
+                  const GraphDef& graph) {
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  // Write to a temporary file first, so that other processes sharing the
+  // directory never read a partially written graph.
+  const std::string file_path = GetFilePath(directory, key);
+  std::string temp_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            file_path);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, graph));
+  return env->RenameFile(temp_path, file_path);
+}
+
+}  // namespace
+
+/* static */ OptimizedGraphCache* OptimizedGraphCache::Global() {
+  static OptimizedGraphCache* cache = new OptimizedGraphCache();
+  return cache;
+}
+
+/* static */ std::string OptimizedGraphCache::ComputeKey(
+    const grappler::GrapplerItem& item, const DeviceSet& device_set,
+    const ConfigProto& config) {
+  std::string serialized_graph;
+  SerializeToStringDeterministic(item.graph, &serialized_graph);
+
+  // Graphs written to disk may be read by another TensorFlow build, whose
+  // optimizers can differ.
+  std::string metadata =
+      absl::StrCat(TF_VERSION_STRING, "|", TF_GIT_VERSION, "\n");
+  for (const auto& feed : item.feed) {
+    absl::StrAppend(&metadata, "feed:", feed.first, ":",
+                    DataTypeString(feed.second.dtype()), ":",
+                    feed.second.shape().DebugString(), "\n");
+  }
+  for (const std::string& fetch : item.fetch) {
+    absl::StrAppend(&metadata, "fetch:", fetch, "\n");
+  }
+  for (const Device* device : device_set.devices()) {
+    absl::StrAppend(&metadata, "device:", device->name(), ":",
+                    device->attributes().memory_limit(), ":",
+                    device->attributes().physical_device_desc(), "\n");
+  }
+  // The session metadata and the cache options do not change the optimized
+  // graph, so they should not prevent sessions from sharing it.
+  ConfigProto optimization_config = config;
+  optimization_config.mutable_experimental()->clear_session_metadata();
+  optimization_config.mutable_experimental()
+      ->clear_enable_optimized_graph_cache();
+  optimization_config.mutable_experimental()
+      ->clear_optimized_graph_cache_directory();
+  std::string serialized_config;
+  SerializeToStringDeterministic(optimization_config, &serialized_config);
+  absl::StrAppend(&metadata, "config:", serialized_config);
+
+  const Fprint128 fingerprint = FingerprintCat128(
+      Fingerprint128(serialized_graph), Fingerprint128(metadata));
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+std::shared_ptr<const GraphDef> OptimizedGraphCache::Lookup(
+    const std::string& key, const std::string& directory) {
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_position);
+      return it->second.graph;
+    }
+  }
+  if (directory.empty()) {
+    return nullptr;
+  }
+
+  Env* env = Env::Default();
+  const std::string file_path = GetFilePath(directory, key);
+  if (!env->FileExists(file_path).ok()) {
+    return nullptr;
+  }
+  auto graph = std::make_shared<GraphDef>();
+  Status s = ReadBinaryProto(env, file_path, graph.get());
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read optimized graph " << file_path << ": "
+                 << s;
+    return nullptr;
+  }
+  VLOG(1) << "Read optimized graph " << file_path;
+  mutex_lock l(mu_);
+  InsertInMemory(key, graph);
+  return graph;
+}
+
+void OptimizedGraphCache::Insert(const std::string& key,
+                                 const std::string& directory,
+                                 const GraphDef& graph) {
+  {
+    mutex_lock l(mu_);
+    InsertInMemory(key, std::make_shared<GraphDef>(graph));
+  }
+  if (!directory.empty()) {
+    Status s = WriteGraph(directory, key, graph);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write optimized graph to " << directory
+                   << ": " << s;
+    }
+  }
+}
+
+int64_t OptimizedGraphCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+void OptimizedGraphCache::InsertInMemory(
+    const std::string& key, std::shared_ptr<const GraphDef> graph) {
+  const int64_t size_bytes = graph->ByteSizeLong();
+  if (size_bytes > capacity_bytes_) {
+    return;
+  }
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    total_bytes_ -= it->second.size_bytes;
+    lru_.erase(it->second.lru_position);
+    entries_.erase(it);
+  }
+  while (total_bytes_ + size_bytes > capacity_bytes_) {
+    auto lru = entries_.find(lru_.back());
+    total_bytes_ -= lru->second.size_bytes;
+    entries_.erase(lru);
+    lru_.pop_back();
+  }
+  lru_.push_front(key);
+  entries_[key] = Entry{std::move(graph), size_bytes, lru_.begin()};
+  total_bytes_ += size_bytes;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// A process-wide cache of the graphs produced by the Grappler meta optimizer,
+// keyed by the content of the optimized item.
+//
+// `GraphExecutionState` optimizes a new graph for every feed/fetch combination
+// a session sees, which can take seconds for large models. When sessions are
+// created with `ConfigProto.Experimental.enable_optimized_graph_cache`, the
+// optimized graphs are shared by all the sessions of the process running the
+// same graph with the same feeds, fetches, devices and configuration. When
+// `optimized_graph_cache_directory` is set, they are also written to that
+// directory, so that they are reused across processes.
+class OptimizedGraphCache {
+ public:
+  static constexpr int64_t kDefaultCapacityBytes = 1LL << 30;
+
+  // Graphs are evicted, least recently used first, when the total size of the
+  // cached graphs exceeds `capacity_bytes`.
+  explicit OptimizedGraphCache(int64_t capacity_bytes = kDefaultCapacityBytes)
+      : capacity_bytes_(capacity_bytes) {}
+
+  // Returns the cache shared by all the sessions of the process.
+  static OptimizedGraphCache* Global();
+
+  // Returns the key identifying the optimization of `item`, on the devices of
+  // `device_set`, with the Grappler configuration of `config`.
+  static std::string ComputeKey(const grappler::GrapplerItem& item,
+                                const DeviceSet& device_set,
+                                const ConfigProto& config);
+
+  // Returns the graph cached for `key`, if any. Graphs that are not in memory
+  // are read from `directory`, unless it is empty.
+  std::shared_ptr<const GraphDef> Lookup(const std::string& key,
+                                         const std::string& directory);
+
+  // Caches `graph` for `key`, and writes it to `directory` unless it is empty.
+  void Insert(const std::string& key, const std::string& directory,
+              const GraphDef& graph);
+
+  // Returns the number of graphs cached in memory.
+  int64_t size() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<const GraphDef> graph;
+    int64_t size_bytes;
+    // Position of the key in `lru_`.
+    std::list<std::string>::iterator lru_position;
+  };
+
+  void InsertInMemory(const std::string& key,
+                      std::shared_ptr<const GraphDef> graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t capacity_bytes_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, Entry> entries_ TF_GUARDED_BY(mu_);
+  // Keys of `entries_`, most recently used first.
+  std::list<std::string> lru_ TF_GUARDED_BY(mu_);
+  int64_t total_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
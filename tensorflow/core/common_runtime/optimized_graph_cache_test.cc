@@ -0,0 +1,156 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace {
+
+class FakeDevice : public Device {
+ public:
+  explicit FakeDevice(const string& name) : Device(nullptr, Attributes(name)) {}
+
+  Status Sync() override { return errors::Unimplemented("FakeDevice::Sync()"); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override { return nullptr; }
+
+ private:
+  static DeviceAttributes Attributes(const string& name) {
+    DeviceAttributes attributes;
+    attributes.set_name(name);
+    attributes.set_device_type(DEVICE_CPU);
+    return attributes;
+  }
+};
+
+GraphDef MakeGraph(const string& node_name) {
+  GraphDef graph;
+  NodeDef* node = graph.add_node();
+  node->set_name(node_name);
+  node->set_op("NoOp");
+  return graph;
+}
+
+class OptimizedGraphCacheTest : public ::testing::Test {
+ protected:
+  OptimizedGraphCacheTest()
+      : device_("/job:localhost/replica:0/task:0/device:CPU:0") {
+    device_set_.AddDevice(&device_);
+    item_.graph = MakeGraph("a");
+    item_.fetch.push_back("a");
+  }
+
+  FakeDevice device_;
+  DeviceSet device_set_;
+  grappler::GrapplerItem item_;
+  ConfigProto config_;
+};
+
+TEST_F(OptimizedGraphCacheTest, ComputeKey) {
+  const string key =
+      OptimizedGraphCache::ComputeKey(item_, device_set_, config_);
+  EXPECT_EQ(key, OptimizedGraphCache::ComputeKey(item_, device_set_, config_));
+
+  // Sessions only differing by their metadata share the optimized graphs.
+  ConfigProto other_config = config_;
+  other_config.mutable_experimental()->mutable_session_metadata()->set_name(
+      "model");
+  other_config.mutable_experimental()->set_enable_optimized_graph_cache(true);
+  EXPECT_EQ(key,
+            OptimizedGraphCache::ComputeKey(item_, device_set_, other_config));
+
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_meta_optimizer(true);
+  EXPECT_NE(key,
+            OptimizedGraphCache::ComputeKey(item_, device_set_, other_config));
+
+  grappler::GrapplerItem other_item = item_;
+  other_item.fetch.push_back("a:1");
+  EXPECT_NE(key,
+            OptimizedGraphCache::ComputeKey(other_item, device_set_, config_));
+
+  other_item = item_;
+  other_item.graph = MakeGraph("b");
+  EXPECT_NE(key,
+            OptimizedGraphCache::ComputeKey(other_item, device_set_, config_));
+
+  FakeDevice other_device("/job:localhost/replica:0/task:0/device:CPU:1");
+  DeviceSet other_device_set;
+  other_device_set.AddDevice(&device_);
+  other_device_set.AddDevice(&other_device);
+  EXPECT_NE(key,
+            OptimizedGraphCache::ComputeKey(item_, other_device_set, config_));
+}
+
+TEST_F(OptimizedGraphCacheTest, InsertAndLookup) {
+  OptimizedGraphCache cache;
+  EXPECT_EQ(nullptr, cache.Lookup("key", /*directory=*/""));
+
+  cache.Insert("key", /*directory=*/"", MakeGraph("optimized"));
+  std::shared_ptr<const GraphDef> graph = cache.Lookup("key", "");
+  ASSERT_NE(nullptr, graph);
+  EXPECT_EQ("optimized", graph->node(0).name());
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST_F(OptimizedGraphCacheTest, EvictsLeastRecentlyUsed) {
+  const int64_t graph_size = MakeGraph("a").ByteSizeLong();
+  OptimizedGraphCache cache(/*capacity_bytes=*/2 * graph_size);
+  cache.Insert("a", "", MakeGraph("a"));
+  cache.Insert("b", "", MakeGraph("b"));
+  // Makes "b" the least recently used graph.
+  EXPECT_NE(nullptr, cache.Lookup("a", ""));
+  cache.Insert("c", "", MakeGraph("c"));
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_NE(nullptr, cache.Lookup("a", ""));
+  EXPECT_EQ(nullptr, cache.Lookup("b", ""));
+  EXPECT_NE(nullptr, cache.Lookup("c", ""));
+}
+
+TEST_F(OptimizedGraphCacheTest, PersistsToDirectory) {
+  const string directory =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache");
+  OptimizedGraphCache cache;
+  cache.Insert("key", directory, MakeGraph("optimized"));
+
+  // Another process, with an empty cache, reads the graph from the directory.
+  OptimizedGraphCache other_cache;
+  EXPECT_EQ(nullptr, other_cache.Lookup("key", /*directory=*/""));
+  std::shared_ptr<const GraphDef> graph = other_cache.Lookup("key", directory);
+  ASSERT_NE(nullptr, graph);
+  EXPECT_EQ("optimized", graph->node(0).name());
+  EXPECT_EQ(1, other_cache.size());
+
+  EXPECT_EQ(nullptr, other_cache.Lookup("other_key", directory));
+}
+
+}  // namespace
+}  // namespace tensorflow
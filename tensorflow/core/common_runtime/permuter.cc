@@ -90,6 +90,7 @@ void Permuter::DispatchSend(int src_rank, int target_rank, const Tensor* tensor,
       col_params_->group.members[target_rank].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), tensor, col_ctx_->device_locality,
+      col_params_->instance.impl_details.sub_chunk_bytes,
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
@@ -107,7 +108,8 @@ void Permuter::DispatchRecv(int src_rank, int target_rank, Tensor* tensor,
       col_params_->group.members[src_rank].is_local, recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), tensor, col_ctx_->device_locality,
-      0, col_ctx_->op_ctx->cancellation_manager(), done);
+      0, col_params_->instance.impl_details.sub_chunk_bytes,
+      col_ctx_->op_ctx->cancellation_manager(), done);
 }
 namespace {
 REGISTER_COLLECTIVE(Permute, Permuter);
@@ -213,6 +213,17 @@ REGISTER_OP("TestTypedConsumer").Input("i: variant");
 REGISTER_KERNEL_BUILDER(Name("TestTypedConsumer").Device("FakeCPU"), DummyOp);
 REGISTER_KERNEL_BUILDER(Name("TestTypedConsumer").Device("FakeGPU"), DummyOp);
 
+// Op whose kernel on FakeGPU only supports some of its types.
+REGISTER_OP("TestTypeConstrainedOp")
+    .Output("o: T")
+    .Attr("T: {float, int32}");
+REGISTER_KERNEL_BUILDER(Name("TestTypeConstrainedOp").Device("FakeCPU"),
+                        DummyOp);
+REGISTER_KERNEL_BUILDER(Name("TestTypeConstrainedOp")
+                            .Device("FakeGPU")
+                            .TypeConstraint<float>("T"),
+                        DummyOp);
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // A PlacerTest method has three phases:
@@ -431,6 +442,30 @@ TEST_F(PlacerTest, TestNoConstraints) {
   EXPECT_DEVICE_TYPE(g, "n2", "FakeGPU");
 }
 
+// Test that nodes of the same op type are placed according to the kernels
+// registered for their own attrs, and not for those of other nodes of that op.
+TEST_F(PlacerTest, TestSameOpWithDifferentTypeConstraints) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    ops::SourceOp("TestTypeConstrainedOp",
+                  b.opts().WithName("f1").WithAttr("T", DT_FLOAT));
+    ops::SourceOp("TestTypeConstrainedOp",
+                  b.opts().WithName("i1").WithAttr("T", DT_INT32));
+    ops::SourceOp("TestTypeConstrainedOp",
+                  b.opts().WithName("f2").WithAttr("T", DT_FLOAT));
+    ops::SourceOp("TestTypeConstrainedOp",
+                  b.opts().WithName("i2").WithAttr("T", DT_INT32));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+
+  TF_EXPECT_OK(Place(&g));
+  EXPECT_DEVICE_TYPE(g, "f1", "FakeGPU");
+  EXPECT_DEVICE_TYPE(g, "f2", "FakeGPU");
+  EXPECT_DEVICE_TYPE(g, "i1", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g, "i2", "FakeCPU");
+}
+
 // Test that a graph with no constraints but using kernels that have a specified
 // device priority will successfully assign nodes to the device with higher
 // priority
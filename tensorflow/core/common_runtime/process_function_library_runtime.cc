@@ -375,6 +375,14 @@ ProcessFunctionLibraryRuntime::IsMultiDevice(
 }
 
 namespace {
+// Component functions are instantiated on the default thread pool if there are
+// more than this many of them, since they can't all be cheap.
+constexpr int kMaxComponentsToInstantiateInline = 8;
+// Otherwise, only the local component functions with at least this many op
+// nodes are, since for small graphs switching threads costs more than it
+// saves.
+constexpr int kMinNodesToInstantiateInParallel = 256;
+
 // Returns the local tensors referred by `args`.
 std::vector<Tensor> GetLocalArgs(gtl::ArraySlice<FunctionArg> args) {
   std::vector<Tensor> tensors;
@@ -638,11 +646,8 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   const int num_subgraphs = subgraphs->size();
   gtl::InlinedVector<Status, 4> instantiate_status(num_subgraphs);
   BlockingCounter counter(static_cast<int>(num_subgraphs));
-  auto runner = [this, num_subgraphs](std::function<void()> fn) {
-    // NOTE: Only use thread pool to instantiate sub-function when there are
-    // more than 8 sub-functions. We want to avoid cost of switching thread when
-    // there are only a few sub-functions.
-    if (default_thread_pool_ != nullptr && num_subgraphs > 8) {
+  auto runner = [this](bool in_parallel, std::function<void()> fn) {
+    if (default_thread_pool_ != nullptr && in_parallel) {
       default_thread_pool_->Schedule(fn);
     } else {
       fn();
@@ -665,13 +670,34 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     }
   }
 
-  // Instantiate each component function (subgraph).
+  // Remote component functions are instantiated asynchronously, so they are
+  // started first to overlap with the local ones. Large local component
+  // functions are instantiated concurrently, with the calling thread
+  // instantiating the last one.
+  std::vector<const std::pair<const string, std::unique_ptr<Graph>>*>
+      components;
+  components.reserve(num_subgraphs);
+  for (const auto& pair : *subgraphs) {
+    if (GetFLR(pair.first) == nullptr) components.push_back(&pair);
+  }
   for (const auto& pair : *subgraphs) {
+    if (GetFLR(pair.first) != nullptr) components.push_back(&pair);
+  }
+
+  // Instantiate each component function (subgraph).
+  for (const auto* component : components) {
+    const auto& pair = *component;
     Status* status = &instantiate_status[i];
     string unique_name = name_generator.GetName();
     ComponentFunctionData* comp_data = &data->glue_[pair.first];
-    runner([this, &pair, dev_set, comp_data, unique_name, data_lib_def,
-            &control_ret, &options, status, &counter, &data] {
+    const bool in_parallel =
+        i + 1 < num_subgraphs &&
+        (num_subgraphs > kMaxComponentsToInstantiateInline ||
+         (GetFLR(pair.first) != nullptr &&
+          pair.second->num_op_nodes() >= kMinNodesToInstantiateInParallel));
+    runner(in_parallel, [this, &pair, dev_set, comp_data, unique_name,
+                         data_lib_def, &control_ret, &options, status,
+                         &counter, &data] {
       const string& target = pair.first;
 
       const string& device_type =
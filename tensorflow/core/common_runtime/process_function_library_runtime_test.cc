@@ -138,7 +138,8 @@ class ProcessFunctionLibraryRuntimeTest : public ::testing::Test {
   void Init(const std::vector<FunctionDef>& flib,
             const SessionMetadata* session_metadata = nullptr,
             const std::vector<OptimizedFunctionGraph>&
-                optimized_function_graphs = {}) {
+                optimized_function_graphs = {},
+            thread::ThreadPool* thread_pool = nullptr) {
     FunctionDefLibrary proto;
     for (const auto& fdef : flib) *(proto.add_function()) = fdef;
     lib_def_.reset(new FunctionLibraryDefinition(OpRegistry::Global(), proto));
@@ -149,8 +150,8 @@ class ProcessFunctionLibraryRuntimeTest : public ::testing::Test {
     cluster_flr_.reset(new TestClusterFLR(device_mgr_.get()));
     proc_flr_.reset(new ProcessFunctionLibraryRuntime(
         device_mgr_.get(), Env::Default(), /*config=*/nullptr,
-        TF_GRAPH_DEF_VERSION, lib_def_.get(), opts,
-        /*thread_pool=*/nullptr, cluster_flr_.get(), session_metadata,
+        TF_GRAPH_DEF_VERSION, lib_def_.get(), opts, thread_pool,
+        cluster_flr_.get(), session_metadata,
         Rendezvous::Factory{[this](const int64_t step_id,
                                    const DeviceMgr* device_mgr,
                                    tsl::core::RefCountPtr<Rendezvous>* r) {
@@ -1122,6 +1123,36 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_CreateKernelsEagerly) {
   EXPECT_TRUE(errors::IsInternal(status));
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDevice_InstantiatesLargeComponentsInParallel) {
+  // A chain of identities, half of them on each device, so that both
+  // component functions are large enough to be instantiated in parallel.
+  std::vector<FunctionDefHelper::Node> nodes;
+  string input = "x";
+  const int num_nodes = 600;
+  for (int i = 0; i < num_nodes; ++i) {
+    const string name = i + 1 < num_nodes ? absl::StrCat("id", i) : "y";
+    const string device = i < num_nodes / 2
+                              ? "/job:a/replica:0/task:0/device:CPU:0"
+                              : "/job:a/replica:0/task:0/device:CPU:1";
+    nodes.push_back(
+        {{name}, "Identity", {input}, {{"T", DT_FLOAT}}, {}, device});
+    input = name;
+  }
+  FunctionDef identity_chain = FunctionDefHelper::Define(
+      "IdentityChain", {"x: float"}, {"y: float"}, {}, nodes);
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Init({identity_chain}, /*session_metadata=*/nullptr,
+       /*optimized_function_graphs=*/{}, &thread_pool);
+
+  FunctionLibraryRuntime::Options opts;
+  Tensor x = test::AsTensor<float>({1, 2, 3});
+  Tensor y;
+  TF_CHECK_OK(Run("IdentityChain", opts, {},
+                  MakeOptions("CPU:0", {"CPU:0"}, {"CPU:1"}), {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, x);
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_StateHandle) {
   auto T = DT_INT32;
   // The expected sequence of outputs from this function is [6, 4, 0, 1, ...].
@@ -592,6 +592,46 @@ class OrderedPropagatorState : public PropagatorState {
   };
 };
 
+// `ScheduledPropagatorState` replaces `PropagatorState`s `TaggedNodeReadyQueue`
+// with a priority queue that follows the memory-aware schedule Grappler
+// attached to the graph (see `NodeItem::scheduling_order`). When several nodes
+// are ready to run inline, the one scheduled earliest runs first, so that large
+// intermediate tensors tend to be consumed before further ones are produced.
+// Nodes without a schedule position (e.g. Send/Recv nodes added by graph
+// partitioning) run before all others.
+//
+// This codepath is enabled in executor.cc when any node in the graph has a
+// schedule position.
+class ScheduledPropagatorState : public PropagatorState {
+  using PropagatorState::PropagatorState;
+
+ public:
+  class TaggedNodeReadyQueue : PropagatorState::TaggedNodeReadyQueue {
+   public:
+    TaggedNodeReadyQueue() : readyp_(compare) {}
+    void push_back(const TaggedNode& node) { readyp_.push(node); }
+    TaggedNode front() const { return readyp_.top(); }
+    void pop_front() { readyp_.pop(); }
+    bool empty() const { return readyp_.empty(); }
+    int size() const { return readyp_.size(); }
+
+   private:
+    // Returns true if `lhs` should run after `rhs`.
+    static bool compare(TaggedNode const& lhs, TaggedNode const& rhs) {
+      std::tuple<int, int64_t, int> lhs_prio{lhs.node_item->scheduling_order,
+                                             lhs.input_iter->iter_num,
+                                             lhs.node_item->node_id};
+      std::tuple<int, int64_t, int> rhs_prio{rhs.node_item->scheduling_order,
+                                             rhs.input_iter->iter_num,
+                                             rhs.node_item->node_id};
+      return lhs_prio > rhs_prio;
+    }
+
+    std::priority_queue<TaggedNode, std::vector<TaggedNode>, decltype(&compare)>
+        readyp_;
+  };
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PROPAGATOR_STATE_H_
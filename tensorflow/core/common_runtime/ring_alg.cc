@@ -409,8 +409,9 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
-      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      col_ctx_->device_locality,
+      col_params_->instance.impl_details.sub_chunk_bytes,
+      col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
@@ -431,6 +432,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
+      col_params_->instance.impl_details.sub_chunk_bytes,
       col_ctx_->op_ctx->cancellation_manager(), done);
 }
 
@@ -18,15 +18,18 @@ limitations under the License.
 #include <limits>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -64,6 +67,38 @@ namespace {
 constexpr char kArgOp[] = "_Arg";
 constexpr char kRetvalOp[] = "_Retval";
 
+// Returns the key under which the output shapes of a call of `fname` with
+// `attributes` and the inputs of `outer_context` are memoized.
+std::string FunctionShapesKey(const string& fname, AttrSlice attributes,
+                              InferenceContext* outer_context) {
+  std::string key = Canonicalize(fname, attributes);
+  for (int i = 0; i < outer_context->num_inputs(); ++i) {
+    absl::StrAppend(&key, "|",
+                    outer_context->DebugString(outer_context->input(i)));
+    const std::vector<ShapeAndType>* handle_data =
+        outer_context->input_handle_shapes_and_types(i);
+    if (handle_data != nullptr) {
+      absl::StrAppend(&key, outer_context->DebugString(*handle_data));
+      for (const ShapeAndType& shape_and_type : *handle_data) {
+        const std::string type = shape_and_type.type.SerializeAsString();
+        absl::StrAppend(&key, ",", type.size(), ":", type);
+      }
+    }
+  }
+  return key;
+}
+
+// Returns whether the values of input tensors of `c` were requested, or were
+// available, during shape inference.
+bool UsesInputTensors(InferenceContext* c) {
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    if (c->requested_input_tensor(i) || c->input_tensor(i) != nullptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 // Runs shape inference for the given node using the given ShapeRefiner.
@@ -161,8 +196,34 @@ Status ShapeRefiner::InferShapesForFunctionSubNode(
 Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
                                             AttrSlice attributes,
                                             InferenceContext* outer_context) {
-  const Graph* graph;
   const string& fname = function_def->signature().name();
+  std::string memo_key = FunctionShapesKey(fname, attributes, outer_context);
+  auto memo_it = function_shapes_.find(memo_key);
+  if (memo_it != function_shapes_.end()) {
+    const FunctionOutputShapes& memo = memo_it->second;
+    for (int i = 0; i < memo.shapes.size(); ++i) {
+      if (memo.shapes[i].has_value()) {
+        ShapeHandle handle;
+        TF_RETURN_IF_ERROR(
+            outer_context->MakeShapeFromShapeProto(*memo.shapes[i], &handle));
+        outer_context->set_output(i, handle);
+      }
+      if (memo.handle_shapes_and_types[i].has_value()) {
+        std::vector<ShapeAndType> shapes_and_types;
+        for (const auto& shape_and_type : *memo.handle_shapes_and_types[i]) {
+          ShapeHandle handle;
+          TF_RETURN_IF_ERROR(outer_context->MakeShapeFromShapeProto(
+              shape_and_type.shape, &handle));
+          shapes_and_types.push_back(
+              ShapeAndType(handle, shape_and_type.dtype, shape_and_type.type));
+        }
+        outer_context->set_output_handle_shapes_and_types(i, shapes_and_types);
+      }
+    }
+    return OkStatus();
+  }
+
+  const Graph* graph;
   auto it = functions_.find(fname);
   if (it != functions_.end()) {
     graph = it->second.get();
@@ -205,6 +266,31 @@ Status ShapeRefiner::InferShapesForFunction(const FunctionDef* function_def,
     node_to_context_.erase(node);
   }
 
+  if (inference_status.ok() && !UsesInputTensors(outer_context)) {
+    FunctionOutputShapes memo;
+    for (int i = 0; i < outer_context->num_outputs(); ++i) {
+      ShapeHandle output = outer_context->output(i);
+      memo.shapes.push_back(
+          output.SameHandle(ShapeHandle())
+              ? std::nullopt
+              : std::make_optional(outer_context->ShapeHandleToProto(output)));
+      const std::vector<ShapeAndType>* handle_data =
+          outer_context->output_handle_shapes_and_types(i);
+      if (handle_data == nullptr) {
+        memo.handle_shapes_and_types.push_back(std::nullopt);
+        continue;
+      }
+      std::vector<FunctionOutputShapes::HandleShapeAndType> shapes_and_types;
+      for (const ShapeAndType& shape_and_type : *handle_data) {
+        shapes_and_types.push_back(
+            {outer_context->ShapeHandleToProto(shape_and_type.shape),
+             shape_and_type.dtype, shape_and_type.type});
+      }
+      memo.handle_shapes_and_types.push_back(std::move(shapes_and_types));
+    }
+    function_shapes_.emplace(std::move(memo_key), std::move(memo));
+  }
+
   return inference_status;
 }
 
@@ -16,14 +16,18 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
+#include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -183,6 +187,11 @@ class ShapeRefiner {
   //
   // On success:
   // - outer_context will contain output shapes inferred from input shapes
+  //
+  // The output shapes are memoized by function, attributes and input shapes,
+  // so that calls of a function with the same input shapes only run shape
+  // inference on its body once. Calls whose inference requests the values of
+  // input tensors aren't memoized.
   Status InferShapesForFunction(
       const FunctionDef* function_def, AttrSlice attributes,
       shape_inference::InferenceContext* outer_context);
@@ -326,6 +335,24 @@ class ShapeRefiner {
   // are refined.
   absl::flat_hash_map<std::string, std::unique_ptr<const Graph>> functions_;
 
+  // The output shapes inferred for a function call, as copied to the outer
+  // inference context by the _Retval nodes of the function.
+  struct FunctionOutputShapes {
+    struct HandleShapeAndType {
+      TensorShapeProto shape;
+      DataType dtype = DT_INVALID;
+      FullTypeDef type;
+    };
+    // Unset for the outputs that the function body didn't set.
+    std::vector<std::optional<TensorShapeProto>> shapes;
+    std::vector<std::optional<std::vector<HandleShapeAndType>>>
+        handle_shapes_and_types;
+  };
+
+  // Memoizes the output shapes of InferShapesForFunction, by function name,
+  // attributes, and input shapes and handle data.
+  absl::flat_hash_map<std::string, FunctionOutputShapes> function_shapes_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
@@ -1527,6 +1527,38 @@ TEST_F(ShapeRefinerTest, ChainedFunctionShapeInferenceWithMultipleInputs) {
   EXPECT_SHAPE("[3,3]", m, wxplusb16, 0);
 }
 
+TEST_F(ShapeRefinerTest, RepeatedFunctionCallsShapeInference) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x = ops::Const(root, {{1.0f, 2.0f}});
+  auto y = ops::Const(root, {1.0f, 2.0f, 3.0f});
+  auto x2 = test::function::Call(&root, "x2", "XTimesTwo", {x});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {y});
+  auto x4 = test::function::Call(&root, "x4", "XTimesTwo", {x2});
+  auto y4 = test::function::Call(&root, "y4", "XTimesTwo", {y2});
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+  m.set_function_library_for_shape_inference(&f_lib);
+
+  TF_ASSERT_OK(m.AddNode(x.node()));
+  TF_ASSERT_OK(m.AddNode(y.node()));
+  TF_ASSERT_OK(m.AddNode(x2.node()));
+  TF_ASSERT_OK(m.AddNode(y2.node()));
+  TF_ASSERT_OK(m.AddNode(x4.node()));
+  TF_ASSERT_OK(m.AddNode(y4.node()));
+
+  // The calls with the same input shapes share their inferred output shapes,
+  // but not with the calls with other input shapes.
+  EXPECT_SHAPE("[1,2]", m, x2, 0);
+  EXPECT_SHAPE("[3]", m, y2, 0);
+  EXPECT_SHAPE("[1,2]", m, x4, 0);
+  EXPECT_SHAPE("[3]", m, y4, 0);
+}
+
 TEST_F(ShapeRefinerTest, FunctionShapeInferenceWorksForResourceHandles) {
   FunctionDefLibrary f_lib_proto;
   *(f_lib_proto.add_function()) = test::function::Swap();
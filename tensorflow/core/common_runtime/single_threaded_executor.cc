@@ -40,9 +40,9 @@ Status ValidateOpIsSafeForSyncExecution(
           DataTypeString(dt), " in outputs of node ", n.name());
     }
   }
-  // Executing Switch nodes requires propagating deadness which is
-  // not currently supported in the SingleThreadedExecutor.
-  if (n.IsSwitch()) {
+  // Executing Switch nodes requires propagating deadness, which the
+  // SingleThreadedExecutor only does when control flow is allowed.
+  if (n.IsSwitch() && !allow_control_flow_sync_execution) {
     return errors::FailedPrecondition(
         "Single-threaded executor does not support switch op, but saw node ",
         n.name(),
@@ -57,6 +57,15 @@ Status ValidateOpIsSafeForSyncExecution(
         ".  Perhaps your graph contains old-style control flow primitives? "
         "Try using tf.compat.v1.enable_control_flow_v2().");
   }
+  // Loops require executing nodes more than once per step, which is not
+  // possible with the static schedule of the SingleThreadedExecutor.
+  if (n.IsNextIteration()) {
+    return errors::FailedPrecondition(
+        "Single-threaded executor does not support loops, but saw node ",
+        n.name(),
+        ". Perhaps your graph contains old-style control flow primitives? "
+        "Try using tf.compat.v1.enable_control_flow_v2().");
+  }
   return OkStatus();
 }
 
@@ -68,6 +77,33 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 static const string& kSingleThreadedExecutor =
     *new string("SINGLE_THREADED_EXECUTOR");
 
+// Passed to transfer nodes in place of their dead inputs.
+static const Tensor* const kEmptyTensor = new Tensor;
+
+// Returns true if `n` may be dead when it is executed, given which of the
+// nodes before it in topological order may be dead. A node is dead if any of
+// its inputs is dead, except for a Merge, which is dead only if all of its data
+// inputs are dead. Deadness originates from the untaken output of a Switch.
+bool MayBeDead(const Node& n, const std::vector<bool>& may_be_dead) {
+  if (n.IsSwitch()) {
+    return true;
+  }
+  if (n.IsMerge()) {
+    for (const Edge* e : n.in_edges()) {
+      if (!e->IsControlEdge() && !may_be_dead[e->src()->id()]) {
+        return false;
+      }
+    }
+    return n.num_inputs() > 0;
+  }
+  for (const Edge* e : n.in_edges()) {
+    if (may_be_dead[e->src()->id()]) {
+      return true;
+    }
+  }
+  return false;
+}
+
 class SingleThreadedExecutorImpl : public Executor {
  public:
   explicit SingleThreadedExecutorImpl(const LocalExecutorParams& params)
@@ -104,6 +140,10 @@ class SingleThreadedExecutorImpl : public Executor {
     std::map<size_t, Node*> arg_index_to_node_map;
     absl::flat_hash_map<Node*, size_t> node_to_index_map;
 
+    // Nodes that may be dead are checked for deadness before they execute.
+    // Graphs without Switch nodes have none, and pay nothing for it.
+    std::vector<bool> may_be_dead(graph.num_node_ids(), false);
+
     // Create the kernel and input-related structures for each node in `graph`.
     for (Node* n : ordered_nodes) {
       if (n->IsSource() || n->IsSink()) {
@@ -111,6 +151,7 @@ class SingleThreadedExecutorImpl : public Executor {
       }
       TF_RETURN_IF_ERROR(ValidateOpIsSafeForSyncExecution(
           *n, params_.allow_control_flow_sync_execution));
+      may_be_dead[n->id()] = MayBeDead(*n, may_be_dead);
       if (n->IsArg()) {
         int32_t arg_index;
         TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &arg_index));
@@ -128,10 +169,13 @@ class SingleThreadedExecutorImpl : public Executor {
       TF_RETURN_IF_ERROR(params_.create_kernel(n->properties(), &kernel));
 
       const Tensor* const_tensor;
-      if (n->num_outputs() == 1 && (const_tensor = kernel->const_tensor())) {
+      if (n->num_outputs() == 1 && !may_be_dead[n->id()] &&
+          (const_tensor = kernel->const_tensor())) {
         // Nodes that produce a single constant tensor are handled specially:
         // we evaluate the tensor once, and propagate it to its consumers as
-        // a `const Tensor*`, to avoid refcount manipulation.
+        // a `const Tensor*`, to avoid refcount manipulation. Constants that
+        // may be dead (e.g. inside a conditional branch) are executed as
+        // regular kernels instead.
         const size_t kernel_index = const_tensor_kernels_.size();
         const_tensor_kernels_.push_back({});
         nodes_with_const_tensor_kernels.push_back(n);
@@ -147,6 +191,10 @@ class SingleThreadedExecutorImpl : public Executor {
         kernel_state.kernel = kernel;
         kernel_state.num_inputs = n->num_inputs();
         kernel_state.num_outputs = n->num_outputs();
+        kernel_state.may_be_dead = may_be_dead[n->id()];
+        kernel_state.is_merge = n->IsMerge();
+        kernel_state.is_switch = n->IsSwitch();
+        kernel_state.is_transfer_node = IsTransferNode(n);
         node_to_index_map[n] = kernel_index;
         if (kernel_index == 0) {
           kernel_state.input_start_index = 0;
@@ -218,6 +266,23 @@ class SingleThreadedExecutorImpl : public Executor {
         }
       }
 
+      // A node whose control input is dead is also dead, so we record the
+      // deadness of the control inputs that may be dead. Merge nodes ignore
+      // the deadness of their control inputs.
+      if (kernel_state.may_be_dead && !kernel_state.is_merge) {
+        for (const Edge* e : n->in_edges()) {
+          if (!e->IsControlEdge() || !may_be_dead[e->src()->id()]) {
+            continue;
+          }
+          KernelState& src_kernel_state = kernels_[node_to_index_map[e->src()]];
+          if (src_kernel_state.dead_flag_index < 0) {
+            src_kernel_state.dead_flag_index = num_dead_flags_++;
+          }
+          kernel_state.control_input_dead_flags.push_back(
+              src_kernel_state.dead_flag_index);
+        }
+      }
+
       // Compute allocator attributes for each node output, and corresponding
       // node input.
       kernel_state.output_alloc_attrs.resize(kernel_state.num_outputs);
@@ -290,6 +355,10 @@ class SingleThreadedExecutorImpl : public Executor {
     //   initialized, and manually destroy them.
     std::vector<Entry> inputs(total_num_inputs_);
 
+    // Whether each kernel with a `dead_flag_index` was dead in this step. This
+    // is empty unless the graph contains control flow.
+    std::vector<bool> dead_flags(num_dead_flags_);
+
     // TODO(mrry): Can we avoid copying into these vectors? Consider modifying
     // OpKernelContext to take the TensorValueVec as a pointer into `inputs`.
     TensorValueVec node_inputs;
@@ -329,7 +398,7 @@ class SingleThreadedExecutorImpl : public Executor {
     params.stats_collector = args.stats_collector;
     params.executor_type = &kSingleThreadedExecutor;
 
-    // NOTE(mrry): We are assuming that the graph is loopless and condless.
+    // NOTE(mrry): We are assuming that the graph is loopless.
     params.frame_iter = FrameAndIter(0, 0);
     params.is_input_dead = false;
 
@@ -413,6 +482,41 @@ class SingleThreadedExecutorImpl : public Executor {
       const size_t num_inputs = kernel_state.num_inputs;
       const size_t num_outputs = kernel_state.num_outputs;
 
+      // Determine whether the kernel is dead. Since kernels run in topological
+      // order, every input that is still missing at this point is dead.
+      bool is_dead = false;
+      if (TF_PREDICT_FALSE(kernel_state.may_be_dead)) {
+        if (kernel_state.is_merge) {
+          is_dead = true;
+          for (size_t j = 0; j < num_inputs; ++j) {
+            if (inputs[input_start_index + j].state !=
+                Entry::State::NO_VALUE) {
+              is_dead = false;
+              break;
+            }
+          }
+        } else {
+          for (int dead_flag_index : kernel_state.control_input_dead_flags) {
+            is_dead = is_dead || dead_flags[dead_flag_index];
+          }
+          for (size_t j = 0; !is_dead && j < num_inputs; ++j) {
+            is_dead =
+                inputs[input_start_index + j].state == Entry::State::NO_VALUE;
+          }
+        }
+        if (kernel_state.dead_flag_index >= 0) {
+          dead_flags[kernel_state.dead_flag_index] = is_dead;
+        }
+        // A dead kernel is not executed, and all of its outputs are dead.
+        // Transfer nodes are executed, so that they can forward the deadness.
+        if (is_dead && !kernel_state.is_transfer_node) {
+          for (size_t j = 0; j < num_inputs; ++j) {
+            inputs[input_start_index + j].ClearVal();
+          }
+          continue;
+        }
+      }
+
       node_inputs.clear();
       node_inputs.resize(num_inputs);
       input_alloc_attrs.clear();
@@ -430,6 +534,15 @@ class SingleThreadedExecutorImpl : public Executor {
           case Entry::State::HAS_VALUE:
             node_inputs[j].tensor = input.val.get();
             break;
+          case Entry::State::NO_VALUE:
+            // A dead input. Merge nodes see it as a missing input, and transfer
+            // nodes as an empty tensor.
+            DCHECK(kernel_state.is_merge || kernel_state.is_transfer_node)
+                << "Input did not have a valid value.";
+            if (kernel_state.is_transfer_node) {
+              node_inputs[j].tensor = const_cast<Tensor*>(kEmptyTensor);
+            }
+            break;
           default:
             DCHECK(false) << "Input did not have a valid value.";
         }
@@ -439,6 +552,7 @@ class SingleThreadedExecutorImpl : public Executor {
       params.input_alloc_attrs = input_alloc_attrs;
       params.op_kernel = kernel_state.kernel;
       params.output_attr_array = kernel_state.output_alloc_attrs.data();
+      params.is_input_dead = is_dead;
       OpKernelContext ctx(&params, num_outputs);
 
       // Actually execute the kernel.
@@ -453,6 +567,11 @@ class SingleThreadedExecutorImpl : public Executor {
       // Forward the outputs of the kernel to the inputs of subsequent kernels.
       for (size_t j = 0; j < num_outputs; ++j) {
         TensorValue val = ctx.release_output(j);
+        if (val.tensor == nullptr && kernel_state.is_switch) {
+          // The untaken output of a Switch is dead: leave its destinations
+          // without a value.
+          continue;
+        }
         const size_t num_destinations = kernel_state.output_locations[j].size();
         if (num_destinations > 0) {
           // TODO(mrry): Consider flattening the `output_locations` vector
@@ -503,6 +622,10 @@ class SingleThreadedExecutorImpl : public Executor {
   // `RunAsync()` for details.
   size_t total_num_inputs_;
 
+  // The number of kernels whose deadness is recorded in the per-step
+  // `dead_flags` vector. See `KernelState::dead_flag_index`.
+  int num_dead_flags_ = 0;
+
   // Represents cached graph structure state for each kernel.
   struct KernelState {
     // The kernel object. Not owned.
@@ -518,6 +641,21 @@ class SingleThreadedExecutorImpl : public Executor {
 
     size_t num_outputs;
 
+    // Whether the kernel may be dead, and must be checked for deadness before
+    // it executes. See `MayBeDead()`.
+    bool may_be_dead = false;
+    bool is_merge = false;
+    bool is_switch = false;
+    bool is_transfer_node = false;
+
+    // The index in the per-step `dead_flags` vector at which the deadness of
+    // this kernel is recorded, or -1 if no kernel depends on it.
+    int dead_flag_index = -1;
+
+    // The indices in the per-step `dead_flags` vector of the control inputs of
+    // this kernel that may be dead.
+    std::vector<int> control_input_dead_flags;
+
     // For the `j`th output of `kernel`, `output_locations[j]` contains the
     // locations in the flat `inputs` vector to which that output must be
     // copied. See comment at the beginning of `Run()` for details.
@@ -34,10 +34,11 @@ namespace tensorflow {
 //
 // 1. Reference-typed tensors are not supported and will not be supported in
 //    future.
-// 2. Graphs with control flow (containing "Switch" and "Merge" nodes) are not
-//    currently supported. The current plan is to extend support to "functional"
-//    control flow after the TensorFlow APIs transition to building graphs in
-//    that form (e.g. `tf.cond_v2()`).
+// 2. Graphs with low-level control flow are only supported when
+//    `LocalExecutorParams::allow_control_flow_sync_execution` is set, and then
+//    only for conditionals: "Switch" and "Merge" nodes, and the dead tensors
+//    that they produce, are supported, but loops ("NextIteration" nodes) are
+//    not, because kernels are executed at most once per step.
 // 3. Partitioned graphs (containing "_Recv" nodes) are not currently supported.
 //    The present implementation executes kernels one at a time in topological
 //    order, and cannot currently distinguish between disconnected subgraphs
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/single_threaded_executor.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/rendezvous.h"
@@ -86,10 +87,13 @@ class ExecutorTest : public ::testing::Test {
 
   // Resets executor_ with a new executor based on a graph 'gdef'.
   void Create(std::unique_ptr<const Graph> graph,
-              std::function<void(OpKernelContext*)> mock_fn = nullptr) {
+              std::function<void(OpKernelContext*)> mock_fn = nullptr,
+              bool allow_control_flow_sync_execution = false) {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.allow_control_flow_sync_execution =
+        allow_control_flow_sync_execution;
     params.create_kernel =
         [this, mock_fn = std::move(mock_fn), version](
             const std::shared_ptr<const NodeProperties>& props,
@@ -357,6 +361,51 @@ TEST_F(ExecutorTest, ControlDependenciesFromSpecialNodes) {
   EXPECT_EQ(3.0, V(retvals[0]));  // out = 1.0 + 2.0 = 3.0
 }
 
+TEST_F(ExecutorTest, Conditional) {
+  // y = pred ? x + 1 : x + x
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto x = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  auto pred = test::graph::Arg(g.get(), 1, DT_BOOL);
+  auto sw = test::graph::Switch(g.get(), x, pred);
+  auto x_false = test::graph::Identity(g.get(), sw, 0);
+  auto x_true = test::graph::Identity(g.get(), sw, 1);
+  // The constant is only live in the true branch.
+  auto one = test::graph::Constant(g.get(), V(1.0));
+  g->AddControlEdge(x_true, one);
+  auto add_false = test::graph::Add(g.get(), x_false, x_false);
+  auto add_true = test::graph::Add(g.get(), x_true, one);
+  auto merge = test::graph::Merge(g.get(), add_false, add_true);
+  test::graph::Retval(g.get(), 0, merge);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g), /*mock_fn=*/nullptr,
+         /*allow_control_flow_sync_execution=*/true);
+
+  for (bool pred_value : {true, false}) {
+    FunctionCallFrame call_frame({DT_FLOAT, DT_BOOL}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(2.0), Tensor(pred_value)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    std::vector<Tensor> retvals;
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(pred_value ? 3.0 : 4.0, V(retvals[0]));
+  }
+}
+
+TEST_F(ExecutorTest, ControlFlowRequiresOptIn) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto x = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  auto pred = test::graph::Arg(g.get(), 1, DT_BOOL);
+  auto sw = test::graph::Switch(g.get(), x, pred);
+  test::graph::Retval(g.get(), 0, sw, 1);
+  FixupSourceAndSinkEdges(g.get());
+  for (Node* n : g->op_nodes()) {
+    Status s = ValidateOpIsSafeForSyncExecution(
+        *n, /*allow_control_flow_sync_execution=*/false);
+    EXPECT_EQ(n->IsSwitch(), !s.ok()) << n->name();
+    TF_EXPECT_OK(ValidateOpIsSafeForSyncExecution(
+        *n, /*allow_control_flow_sync_execution=*/true));
+  }
+}
+
 void BM_executor(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int depth = state.range(1);
@@ -0,0 +1,250 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// The number of steps run on the base allocator before recording one.
+constexpr int64_t kNumWarmupSteps = 1;
+
+// Blocks of the arena are aligned like the allocations of the base allocator.
+constexpr size_t kBlockAlignment = Allocator::kAllocatorAlignment;
+
+size_t RoundUpToBlockAlignment(size_t num_bytes) {
+  return (num_bytes + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment;
+}
+
+}  // namespace
+
+MemoryPlanLayout ComputeMemoryPlanLayout(
+    const std::vector<size_t>& sizes, const std::vector<int64_t>& alloc_times,
+    const std::vector<int64_t>& free_times) {
+  const size_t num_blocks = sizes.size();
+  MemoryPlanLayout layout;
+  layout.offsets.resize(num_blocks, 0);
+  layout.sizes.resize(num_blocks, 0);
+  for (size_t i = 0; i < num_blocks; ++i) {
+    layout.sizes[i] = RoundUpToBlockAlignment(sizes[i]);
+  }
+
+  std::vector<size_t> order(num_blocks);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return layout.sizes[a] > layout.sizes[b];
+  });
+
+  std::vector<size_t> placed;
+  placed.reserve(num_blocks);
+  // The placed blocks live at the same time as the block being placed, as
+  // (offset, end) pairs.
+  std::vector<std::pair<size_t, size_t>> conflicts;
+  for (size_t block : order) {
+    const size_t size = layout.sizes[block];
+    if (size == 0) continue;
+    conflicts.clear();
+    for (size_t other : placed) {
+      if (alloc_times[block] < free_times[other] &&
+          alloc_times[other] < free_times[block]) {
+        conflicts.emplace_back(layout.offsets[other],
+                               layout.offsets[other] + layout.sizes[other]);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end());
+    size_t offset = 0;
+    for (const auto& conflict : conflicts) {
+      if (conflict.first >= offset + size) break;
+      offset = std::max(offset, conflict.second);
+    }
+    layout.offsets[block] = offset;
+    layout.arena_size = std::max(layout.arena_size, offset + size);
+    placed.push_back(block);
+  }
+  return layout;
+}
+
+StaticMemoryPlan::StaticMemoryPlan(Allocator* base_allocator)
+    : base_allocator_(base_allocator) {}
+
+PlannedStepAllocator* StaticMemoryPlan::BeginStep() {
+  mutex_lock l(mu_);
+  if (layout_ != nullptr) {
+    return new PlannedStepAllocator(base_allocator_, /*plan=*/nullptr,
+                                    layout_);
+  }
+  // Steps running while another one is recorded use the base allocator.
+  if (num_steps_++ < kNumWarmupSteps || recording_) return nullptr;
+  recording_ = true;
+  return new PlannedStepAllocator(base_allocator_, this, /*layout=*/nullptr);
+}
+
+std::shared_ptr<const MemoryPlanLayout> StaticMemoryPlan::layout() const {
+  tf_shared_lock l(mu_);
+  return layout_;
+}
+
+void StaticMemoryPlan::SetLayout(
+    std::shared_ptr<const MemoryPlanLayout> layout) {
+  mutex_lock l(mu_);
+  recording_ = false;
+  layout_ = std::move(layout);
+}
+
+PlannedStepAllocator::PlannedStepAllocator(
+    Allocator* base_allocator, StaticMemoryPlan* plan,
+    std::shared_ptr<const MemoryPlanLayout> layout)
+    : base_allocator_(base_allocator),
+      plan_(plan),
+      layout_(std::move(layout)) {}
+
+PlannedStepAllocator::~PlannedStepAllocator() {
+  if (arena_ != nullptr) base_allocator_->DeallocateRaw(arena_);
+}
+
+std::string PlannedStepAllocator::Name() {
+  return absl::StrCat("planned_", base_allocator_->Name());
+}
+
+void* PlannedStepAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  mutex_lock l(mu_);
+  const size_t index = next_index_++;
+  if (plan_ == nullptr && !released_) {
+    void* ptr = AllocateFromArena(index, alignment, num_bytes);
+    if (ptr != nullptr) {
+      ++num_planned_;
+      ++num_live_;
+      return ptr;
+    }
+  }
+  void* ptr =
+      base_allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr == nullptr) return nullptr;
+  ++num_fallback_;
+  ++num_live_;
+  if (plan_ != nullptr && !released_) {
+    live_records_[ptr] = records_.size();
+    records_.push_back({num_bytes, clock_++,
+                        /*free_time=*/std::numeric_limits<int64_t>::max()});
+  }
+  return ptr;
+}
+
+void* PlannedStepAllocator::AllocateFromArena(size_t index, size_t alignment,
+                                              size_t num_bytes) {
+  if (num_bytes == 0 || alignment > kBlockAlignment ||
+      index >= layout_->sizes.size() || num_bytes > layout_->sizes[index]) {
+    return nullptr;
+  }
+  if (arena_ == nullptr) {
+    if (arena_failed_) return nullptr;
+    AllocationAttributes attr;
+    attr.retry_on_failure = false;
+    arena_ = static_cast<char*>(base_allocator_->AllocateRaw(
+        kBlockAlignment, layout_->arena_size, attr));
+    if (arena_ == nullptr) {
+      arena_failed_ = true;
+      return nullptr;
+    }
+  }
+  const size_t offset = layout_->offsets[index];
+  const size_t end = offset + layout_->sizes[index];
+  // The block must not overlap a block still in use.
+  auto next = live_blocks_.lower_bound(offset);
+  if (next != live_blocks_.end() && next->first < end) return nullptr;
+  if (next != live_blocks_.begin() && std::prev(next)->second > offset) {
+    return nullptr;
+  }
+  live_blocks_.emplace(offset, end);
+  return arena_ + offset;
+}
+
+void PlannedStepAllocator::DeallocateRaw(void* ptr) {
+  bool delete_this = false;
+  {
+    mutex_lock l(mu_);
+    char* p = static_cast<char*>(ptr);
+    if (arena_ != nullptr && p >= arena_ && p < arena_ + layout_->arena_size) {
+      live_blocks_.erase(p - arena_);
+    } else {
+      if (plan_ != nullptr && !released_) {
+        auto it = live_records_.find(ptr);
+        if (it != live_records_.end()) {
+          records_[it->second].free_time = clock_++;
+          live_records_.erase(it);
+        }
+      }
+      base_allocator_->DeallocateRaw(ptr);
+    }
+    delete_this = --num_live_ == 0 && released_;
+  }
+  if (delete_this) delete this;
+}
+
+void PlannedStepAllocator::Release() {
+  bool delete_this = false;
+  std::shared_ptr<const MemoryPlanLayout> layout;
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    if (plan_ != nullptr) {
+      std::vector<size_t> sizes;
+      std::vector<int64_t> alloc_times;
+      std::vector<int64_t> free_times;
+      sizes.reserve(records_.size());
+      alloc_times.reserve(records_.size());
+      free_times.reserve(records_.size());
+      for (const Record& record : records_) {
+        sizes.push_back(record.size);
+        alloc_times.push_back(record.alloc_time);
+        free_times.push_back(record.free_time);
+      }
+      layout = std::make_shared<const MemoryPlanLayout>(
+          ComputeMemoryPlanLayout(sizes, alloc_times, free_times));
+      VLOG(1) << "Planned " << records_.size() << " allocations of "
+              << base_allocator_->Name() << " in an arena of "
+              << layout->arena_size << " bytes";
+      records_.clear();
+      live_records_.clear();
+    }
+    delete_this = num_live_ == 0;
+  }
+  if (plan_ != nullptr) plan_->SetLayout(std::move(layout));
+  if (delete_this) delete this;
+}
+
+int64_t PlannedStepAllocator::num_planned_allocations() const {
+  tf_shared_lock l(mu_);
+  return num_planned_;
+}
+
+int64_t PlannedStepAllocator::num_fallback_allocations() const {
+  tf_shared_lock l(mu_);
+  return num_fallback_;
+}
+
+}  // namespace tensorflow
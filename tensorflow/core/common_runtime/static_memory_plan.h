@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// The arena layout of the allocations of one step. The i-th allocation of a
+// step is served from `offsets[i]` of the arena, if its size is at most
+// `sizes[i]`.
+struct MemoryPlanLayout {
+  std::vector<size_t> offsets;
+  std::vector<size_t> sizes;
+  size_t arena_size = 0;
+};
+
+class PlannedStepAllocator;
+
+// Plans the allocations of the steps of an executor whose allocation pattern
+// repeats from step to step, e.g. inference on fixed shapes.
+//
+// The first step runs on the base allocator, as it usually performs one-time
+// allocations. The allocations of the second step are recorded, and an arena
+// layout is computed from their sizes and lifetimes, so that allocations whose
+// lifetimes don't overlap share memory. Each later step allocates a single
+// arena from the base allocator, and serves its allocations from it in order.
+//
+// Serving a step never relies on the plan being exact: an allocation which is
+// larger than planned, overaligned, or whose planned block overlaps a block
+// still in use (e.g. because the ops ran in another order), is served by the
+// base allocator instead.
+//
+// This class is thread-safe.
+class StaticMemoryPlan {
+ public:
+  explicit StaticMemoryPlan(Allocator* base_allocator);
+
+  // Returns the allocator for a new step, or nullptr if the step should use
+  // the base allocator. A non-null allocator must be released with
+  // `PlannedStepAllocator::Release()` once the step is done; it deletes itself
+  // once all of its allocations are freed, which may be after the step.
+  PlannedStepAllocator* BeginStep();
+
+  // Returns the planned layout, or nullptr if there is none yet.
+  std::shared_ptr<const MemoryPlanLayout> layout() const;
+
+ private:
+  friend class PlannedStepAllocator;
+
+  void SetLayout(std::shared_ptr<const MemoryPlanLayout> layout);
+
+  Allocator* const base_allocator_;
+
+  mutable mutex mu_;
+  int64_t num_steps_ TF_GUARDED_BY(mu_) = 0;
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+  std::shared_ptr<const MemoryPlanLayout> layout_ TF_GUARDED_BY(mu_);
+};
+
+// Computes an arena layout for allocations of the given sizes, live from
+// `alloc_times[i]` (inclusive) to `free_times[i]` (exclusive). Blocks are
+// placed from the largest to the smallest, at the lowest offset that doesn't
+// overlap a block with an overlapping lifetime.
+MemoryPlanLayout ComputeMemoryPlanLayout(
+    const std::vector<size_t>& sizes, const std::vector<int64_t>& alloc_times,
+    const std::vector<int64_t>& free_times);
+
+// Serves the allocations of one step, either recording them for a
+// `StaticMemoryPlan` or serving them from an arena laid out by the plan.
+class PlannedStepAllocator : public Allocator {
+ public:
+  std::string Name() override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_allocator_->GetMemoryType();
+  }
+
+  // Marks the end of the step. When recording, this computes the layout of
+  // the plan from the allocations of the step. The allocator must not be used
+  // for new allocations afterwards.
+  void Release();
+
+  // The number of allocations served from the arena and from the base
+  // allocator.
+  int64_t num_planned_allocations() const;
+  int64_t num_fallback_allocations() const;
+
+ private:
+  friend class StaticMemoryPlan;
+
+  struct Record {
+    size_t size;
+    int64_t alloc_time;
+    int64_t free_time;
+  };
+
+  // Records the allocations of the step for `plan`, if not null. Otherwise,
+  // serves them from an arena with the given layout.
+  PlannedStepAllocator(Allocator* base_allocator, StaticMemoryPlan* plan,
+                       std::shared_ptr<const MemoryPlanLayout> layout);
+  ~PlannedStepAllocator() override;
+
+  void* AllocateFromArena(size_t index, size_t alignment, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_allocator_;
+  StaticMemoryPlan* const plan_;
+  const std::shared_ptr<const MemoryPlanLayout> layout_;
+
+  mutable mutex mu_;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  // The number of allocations not freed yet.
+  int64_t num_live_ TF_GUARDED_BY(mu_) = 0;
+  size_t next_index_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_planned_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_fallback_ TF_GUARDED_BY(mu_) = 0;
+
+  // Recording state: the allocations of the step in order, the index of the
+  // live ones, and a clock ticking on each allocation and deallocation.
+  std::vector<Record> records_ TF_GUARDED_BY(mu_);
+  std::unordered_map<void*, size_t> live_records_ TF_GUARDED_BY(mu_);
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+
+  // Serving state: the arena, allocated on first use, and the offset and end
+  // of the blocks of the arena in use.
+  char* arena_ TF_GUARDED_BY(mu_) = nullptr;
+  bool arena_failed_ TF_GUARDED_BY(mu_) = false;
+  std::map<size_t, size_t> live_blocks_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlannedStepAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
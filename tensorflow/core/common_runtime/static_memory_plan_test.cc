@@ -0,0 +1,153 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Counts the allocations made on the CPU allocator.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    ++num_deallocations_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations_ = 0;
+  int num_deallocations_ = 0;
+};
+
+struct StepBuffers {
+  void* a;
+  void* b;
+  void* c;
+};
+
+// Allocates three buffers. If `free_a_before_c`, the last one can reuse the
+// memory of the first.
+StepBuffers RunStep(Allocator* allocator, bool free_a_before_c) {
+  StepBuffers buffers;
+  buffers.a = allocator->AllocateRaw(64, 100);
+  buffers.b = allocator->AllocateRaw(64, 200);
+  if (free_a_before_c) allocator->DeallocateRaw(buffers.a);
+  buffers.c = allocator->AllocateRaw(64, 100);
+  if (!free_a_before_c) allocator->DeallocateRaw(buffers.a);
+  allocator->DeallocateRaw(buffers.b);
+  allocator->DeallocateRaw(buffers.c);
+  return buffers;
+}
+
+TEST(StaticMemoryPlanTest, ComputeLayoutReusesMemoryOfDisjointLifetimes) {
+  MemoryPlanLayout layout =
+      ComputeMemoryPlanLayout({100, 200, 100}, {0, 1, 3}, {2, 4, 5});
+  ASSERT_EQ(layout.offsets.size(), 3);
+  EXPECT_EQ(layout.sizes[0], 128);
+  EXPECT_EQ(layout.sizes[1], 256);
+  // The largest block comes first, the two others share the space after it.
+  EXPECT_EQ(layout.offsets[1], 0);
+  EXPECT_EQ(layout.offsets[0], 256);
+  EXPECT_EQ(layout.offsets[2], 256);
+  EXPECT_EQ(layout.arena_size, 384);
+}
+
+TEST(StaticMemoryPlanTest, ComputeLayoutSeparatesOverlappingLifetimes) {
+  MemoryPlanLayout layout =
+      ComputeMemoryPlanLayout({64, 64, 64}, {0, 1, 2}, {10, 10, 10});
+  EXPECT_EQ(layout.arena_size, 192);
+  EXPECT_NE(layout.offsets[0], layout.offsets[1]);
+  EXPECT_NE(layout.offsets[1], layout.offsets[2]);
+  EXPECT_NE(layout.offsets[0], layout.offsets[2]);
+}
+
+TEST(StaticMemoryPlanTest, ServesStepsFromArenaAfterRecording) {
+  CountingAllocator base;
+  StaticMemoryPlan plan(&base);
+
+  // The warmup step uses the base allocator directly.
+  EXPECT_EQ(plan.BeginStep(), nullptr);
+
+  PlannedStepAllocator* recording = plan.BeginStep();
+  ASSERT_NE(recording, nullptr);
+  // Steps running during the recording use the base allocator.
+  EXPECT_EQ(plan.BeginStep(), nullptr);
+  RunStep(recording, /*free_a_before_c=*/true);
+  recording->Release();
+  ASSERT_NE(plan.layout(), nullptr);
+  EXPECT_EQ(plan.layout()->arena_size, 384);
+
+  base.num_allocations_ = 0;
+  base.num_deallocations_ = 0;
+  PlannedStepAllocator* step = plan.BeginStep();
+  ASSERT_NE(step, nullptr);
+  StepBuffers buffers = RunStep(step, /*free_a_before_c=*/true);
+  EXPECT_EQ(buffers.a, buffers.c);
+  EXPECT_NE(buffers.a, buffers.b);
+  EXPECT_EQ(step->num_planned_allocations(), 3);
+  EXPECT_EQ(step->num_fallback_allocations(), 0);
+  // Only the arena is allocated from the base allocator, and it is freed with
+  // the step.
+  EXPECT_EQ(base.num_allocations_, 1);
+  step->Release();
+  EXPECT_EQ(base.num_deallocations_, 1);
+}
+
+TEST(StaticMemoryPlanTest, FallsBackWhenPlannedBlockIsInUse) {
+  CountingAllocator base;
+  StaticMemoryPlan plan(&base);
+  EXPECT_EQ(plan.BeginStep(), nullptr);
+  PlannedStepAllocator* recording = plan.BeginStep();
+  RunStep(recording, /*free_a_before_c=*/true);
+  recording->Release();
+
+  PlannedStepAllocator* step = plan.BeginStep();
+  // `c` is planned where `a` is, but `a` is still alive when `c` is allocated.
+  StepBuffers buffers = RunStep(step, /*free_a_before_c=*/false);
+  EXPECT_NE(buffers.a, buffers.c);
+  EXPECT_EQ(step->num_planned_allocations(), 2);
+  EXPECT_EQ(step->num_fallback_allocations(), 1);
+  step->Release();
+}
+
+TEST(StaticMemoryPlanTest, ArenaOutlivesStep) {
+  CountingAllocator base;
+  StaticMemoryPlan plan(&base);
+  EXPECT_EQ(plan.BeginStep(), nullptr);
+  PlannedStepAllocator* recording = plan.BeginStep();
+  RunStep(recording, /*free_a_before_c=*/true);
+  recording->Release();
+
+  PlannedStepAllocator* step = plan.BeginStep();
+  void* output = step->AllocateRaw(64, 100);
+  step->Release();
+  // E.g. a fetched tensor, released by the caller after the step.
+  EXPECT_EQ(base.num_deallocations_, 3);
+  static_cast<char*>(output)[99] = 1;
+  step->DeallocateRaw(output);
+  EXPECT_EQ(base.num_deallocations_, 4);
+}
+
+}  // namespace
+}  // namespace tensorflow
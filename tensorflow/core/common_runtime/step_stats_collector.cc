@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -49,6 +50,14 @@ bool IsSend(const NodeDef* node) {
   return node->op() == "_Send" || node->op() == "_HostSend";
 }
 
+// Finalizer of the SplitMix64 generator: maps consecutive integers to
+// well-distributed values, so sampling on its output picks a random subset.
+inline uint64 MixBits(uint64 x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
 }  // namespace
 
 NodeExecStatsWrapper::NodeExecStatsWrapper(
@@ -558,4 +567,137 @@ void StepStatsCollector::FinalizeInternal() {
     }
   }
 }
+
+void SampledNodeExecStats::Reset(const NodeDef* node) {
+  node_ = node;
+  done_ = false;
+  all_start_nanos_ = 0;
+  op_start_nanos_ = 0;
+  op_end_nanos_ = 0;
+  all_end_nanos_ = 0;
+}
+
+void SampledNodeExecStats::Done(const string& device) {
+  // Assigning into the reused string only allocates the first time a slot
+  // sees a device name of this length.
+  device_ = device;
+  done_ = true;
+}
+
+void SampledNodeExecStats::RecordExecutorStarted() {
+  all_start_nanos_ = Env::Default()->NowNanos();
+}
+
+void SampledNodeExecStats::RecordComputeStarted() {
+  op_start_nanos_ = Env::Default()->NowNanos();
+}
+
+void SampledNodeExecStats::RecordComputeEnded() {
+  op_end_nanos_ = Env::Default()->NowNanos();
+}
+
+void SampledNodeExecStats::RecordExecutorEnded() {
+  all_end_nanos_ = Env::Default()->NowNanos();
+}
+
+SampledStepStatsCollector::SampledStepStatsCollector(int64_t sample_period,
+                                                     int64_t max_sampled_nodes)
+    : sample_period_(std::max<int64_t>(sample_period, 1)),
+      slots_(std::max<int64_t>(max_sampled_nodes, 0)) {
+  StartStep();
+}
+
+void SampledStepStatsCollector::StartStep() {
+  step_seed_ = random::New64();
+  num_seen_nodes_.store(0, std::memory_order_relaxed);
+  num_used_slots_.store(0, std::memory_order_relaxed);
+}
+
+void SampledStepStatsCollector::EndStep() {
+  mutex_lock l(mu_);
+  const int64_t num_used_slots =
+      std::min<int64_t>(num_used_slots_.load(std::memory_order_relaxed),
+                        static_cast<int64_t>(slots_.size()));
+  // Compacts the completed slots to the front, so that BuildCostModel() only
+  // has to look at the first `num_sampled_nodes_` slots.
+  int64_t num_sampled = 0;
+  for (int64_t i = 0; i < num_used_slots; ++i) {
+    SampledNodeExecStats& stats = slots_[i];
+    if (stats.done_) {
+      op_type_histograms_[stats.node_->op()].Add(
+          static_cast<double>(stats.op_end_nanos_ - stats.op_start_nanos_) /
+          EnvTime::kMicrosToNanos);
+      stats.node_name_ = stats.node_->name();
+      if (i != num_sampled) std::swap(stats, slots_[num_sampled]);
+      ++num_sampled;
+    }
+    slots_[i].node_ = nullptr;
+  }
+  num_sampled_nodes_ = num_sampled;
+  num_used_slots_.store(0, std::memory_order_relaxed);
+}
+
+void SampledStepStatsCollector::BuildCostModel(
+    CostModelManager* cost_model_manager,
+    const std::unordered_map<string, const Graph*>& device_map) {
+  mutex_lock l(mu_);
+  for (const auto& itr : device_map) {
+    const Graph* graph = itr.second;
+    CostModel* cm = nullptr;
+    std::unordered_map<StringPiece, const Node*, StringPieceHasher>
+        name_to_node;
+    for (int64_t i = 0; i < num_sampled_nodes_; ++i) {
+      const SampledNodeExecStats& stats = slots_[i];
+      if (stats.device_ != itr.first) {
+        continue;
+      }
+      if (cm == nullptr) {
+        // Only touch graphs that had nodes sampled on their device.
+        cm = cost_model_manager->FindOrCreateCostModel(graph);
+        cm->IncrementUpdateTimes();
+        for (const Node* n : graph->nodes()) {
+          name_to_node.emplace(n->name(), n);
+        }
+      }
+      auto node_it = name_to_node.find(stats.node_name_);
+      if (node_it == name_to_node.end()) {
+        continue;
+      }
+      // Matches the op_end_rel_micros used by StepStatsCollector.
+      cm->RecordMaxExecutionTime(
+          node_it->second,
+          Microseconds((stats.op_end_nanos_ - stats.all_start_nanos_) /
+                       EnvTime::kMicrosToNanos));
+    }
+  }
+}
+
+void SampledStepStatsCollector::GetOpTypeHistograms(
+    std::unordered_map<string, HistogramProto>* histograms) const {
+  mutex_lock l(mu_);
+  histograms->clear();
+  for (const auto& itr : op_type_histograms_) {
+    itr.second.EncodeToProto(&(*histograms)[itr.first],
+                             /*preserve_zero_buckets=*/false);
+  }
+}
+
+NodeExecStatsInterface* SampledStepStatsCollector::CreateNodeExecStats(
+    const NodeDef* node) {
+  // Only collect statistics for non-transfer nodes.
+  if (IsSend(node) || IsRecv(node)) {
+    return nullptr;
+  }
+  const uint64 n = num_seen_nodes_.fetch_add(1, std::memory_order_relaxed);
+  if (MixBits(step_seed_ + n) % sample_period_ != 0) {
+    return nullptr;
+  }
+  const int64_t slot = num_used_slots_.fetch_add(1, std::memory_order_relaxed);
+  if (slot >= static_cast<int64_t>(slots_.size())) {
+    return nullptr;
+  }
+  slots_[slot].Reset(node);
+  return &slots_[slot];
+}
+
 }  // namespace tensorflow
@@ -15,14 +15,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -36,6 +39,7 @@ class Graph;
 class NodeDef;
 class NodeExecStats;
 class OpKernelContext;
+class SampledStepStatsCollector;
 class StepStats;
 class StepStatsCollector;
 class Tensor;
@@ -203,6 +207,99 @@ class StepStatsCollector : public StepStatsCollectorInterface {
   uint64 collected_nodes_ TF_GUARDED_BY(mu_) = 0;
 };
 
+// Records only the timestamps of a node's execution. Instances are owned by a
+// `SampledStepStatsCollector` and reused across steps, so recording a sampled
+// node does not allocate.
+class SampledNodeExecStats : public NodeExecStatsInterface {
+ public:
+  SampledNodeExecStats() = default;
+
+  void Done(const string& device) override;
+  void RecordExecutorStarted() override;
+  void RecordComputeStarted() override;
+  void RecordComputeEnded() override;
+  void RecordExecutorEnded() override;
+  bool TrackAllocations() const override { return false; }
+  void SetMemory(OpKernelContext* ctx) override {}
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64_t nanos) override {}
+
+ private:
+  friend class SampledStepStatsCollector;
+
+  void Reset(const NodeDef* node);
+
+  const NodeDef* node_ = nullptr;  // Not owned. Cleared by EndStep().
+  string node_name_;               // Set by EndStep().
+  string device_;
+  bool done_ = false;
+  int64_t all_start_nanos_ = 0;
+  int64_t op_start_nanos_ = 0;
+  int64_t op_end_nanos_ = 0;
+  int64_t all_end_nanos_ = 0;
+};
+
+// SampledStepStatsCollector records the execution times of a random subset of
+// the nodes run in each step. Unlike `StepStatsCollector`, it does not track
+// memory or outputs and never allocates per node, which keeps its overhead low
+// enough to leave enabled in production.
+//
+// About one in `sample_period` eligible nodes is recorded, into at most
+// `max_sampled_nodes` preallocated slots. A different subset is chosen on every
+// step. The compute times of the sampled nodes are accumulated into per-op-type
+// histograms that persist across steps.
+//
+// The collector records one step at a time: call StartStep() before running a
+// step with it, and EndStep() once every executor using it has finished.
+class SampledStepStatsCollector : public StepStatsCollectorInterface {
+ public:
+  SampledStepStatsCollector(int64_t sample_period, int64_t max_sampled_nodes);
+
+  // Resets the slots and picks the subset of nodes to sample for a new step.
+  void StartStep();
+
+  // Folds the nodes sampled since StartStep() into the per-op-type histograms.
+  // Must be called while the NodeDefs of the sampled nodes are still alive.
+  void EndStep();
+
+  // Updates the CostModels managed by `cost_model_manager` with the nodes
+  // sampled in the last completed step, using the devices in `device_map`.
+  // Meant to be called between every EndStep() and the following StartStep(),
+  // so that the cost models are refined incrementally as steps run.
+  void BuildCostModel(
+      CostModelManager* cost_model_manager,
+      const std::unordered_map<string, const Graph*>& device_map);
+
+  // Fills `histograms` with the compute times, in microseconds, of every node
+  // sampled so far, keyed by op type.
+  void GetOpTypeHistograms(
+      std::unordered_map<string, HistogramProto>* histograms) const;
+
+  // Returns the number of nodes recorded in the last completed step.
+  int64_t num_sampled_nodes() const { return num_sampled_nodes_; }
+
+  NodeExecStatsInterface* CreateNodeExecStats(const NodeDef* node) override;
+  string ReportAllocsOnResourceExhausted(absl::string_view err) override {
+    return "";
+  }
+
+ private:
+  const uint64 sample_period_;
+  std::vector<SampledNodeExecStats> slots_;
+
+  // Only written by StartStep() and EndStep(), so they can be read without
+  // synchronization while a step runs.
+  uint64 step_seed_ = 0;
+  int64_t num_sampled_nodes_ = 0;
+
+  std::atomic<uint64> num_seen_nodes_{0};
+  std::atomic<int64_t> num_used_slots_{0};
+
+  mutable mutex mu_;
+  std::unordered_map<string, histogram::Histogram> op_type_histograms_
+      TF_GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <zlib.h>
+
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <vector>
@@ -63,8 +66,108 @@ class Iov {
   size_t num_bytes_;
 };
 
+namespace {
+
+// Compresses the bytes of `iov` with zlib at `level` into `out`.
+// REQUIRES: iov.NumBytes() <= kuint32max.
+Status ZlibCompressFromIOVec(Iov& iov, int level, std::string* out) {
+  z_stream stream = {};
+  if (deflateInit(&stream, level) != Z_OK) {
+    return errors::InvalidArgument(
+        "Failed to initialize zlib compression with level ", level, ".");
+  }
+  // The output is large enough to compress everything in one pass.
+  out->resize(deflateBound(&stream, iov.NumBytes()));
+  stream.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+  stream.avail_out = static_cast<uInt>(
+      std::min<size_t>(out->size(), std::numeric_limits<uInt>::max()));
+  int result = Z_OK;
+  for (size_t i = 0; i < iov.NumPieces() && result == Z_OK; ++i) {
+    // deflate fails on empty input, as it can't make progress.
+    if (iov.Data()[i].iov_len == 0) continue;
+    stream.next_in = static_cast<Bytef*>(iov.Data()[i].iov_base);
+    stream.avail_in = iov.Data()[i].iov_len;
+    result = deflate(&stream, Z_NO_FLUSH);
+  }
+  if (result == Z_OK) {
+    result = deflate(&stream, Z_FINISH);
+  }
+  out->resize(stream.total_out);
+  deflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    return errors::Internal("Failed to compress using zlib.");
+  }
+  return OkStatus();
+}
+
+// Uncompresses the zlib stream `compressed` into the pieces of `iov`.
+Status ZlibUncompressToIOVec(const std::string& compressed, Iov& iov) {
+  z_stream stream = {};
+  if (inflateInit(&stream) != Z_OK) {
+    return errors::Internal("Failed to initialize zlib decompression.");
+  }
+  stream.next_in =
+      reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+  stream.avail_in = compressed.size();
+  int result = Z_OK;
+  for (size_t i = 0; i < iov.NumPieces() && result == Z_OK; ++i) {
+    stream.next_out = static_cast<Bytef*>(iov.Data()[i].iov_base);
+    stream.avail_out = iov.Data()[i].iov_len;
+    while (stream.avail_out > 0 && result == Z_OK) {
+      result = inflate(&stream, Z_NO_FLUSH);
+    }
+  }
+  if (result == Z_OK) {
+    // All the pieces are filled, only the end of the stream is left.
+    Bytef end;
+    stream.next_out = &end;
+    stream.avail_out = 0;
+    result = inflate(&stream, Z_FINISH);
+  }
+  const uint64 uncompressed_size = stream.total_out;
+  inflateEnd(&stream);
+  if (result != Z_STREAM_END) {
+    return errors::Internal("Failed to perform zlib decompression.");
+  }
+  if (uncompressed_size != iov.NumBytes()) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Zlib produced ", uncompressed_size,
+        " bytes whereas the tensor metadata suggests ", iov.NumBytes());
+  }
+  return OkStatus();
+}
+
+// Uncompresses the Snappy data `compressed` into the pieces of `iov`.
+Status SnappyUncompressToIOVec(const std::string& compressed, Iov& iov) {
+  size_t uncompressed_size;
+  if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
+                                          &uncompressed_size)) {
+    return errors::Internal(
+        "Could not get snappy uncompressed length. Compressed data size: ",
+        compressed.size());
+  }
+  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+    return errors::Internal(
+        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+        " whereas the tensor metadata suggests ", iov.NumBytes());
+  }
+  if (!port::Snappy_UncompressToIOVec(compressed.data(), compressed.size(),
+                                      iov.Data(), iov.NumPieces())) {
+    return errors::Internal("Failed to perform snappy decompression.");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, CompressElementOptions(), out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressElementOptions& options,
+                       CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -122,15 +225,20 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
+  const bool use_zlib = options.codec == CompressedElement::ZLIB;
   if (iov.NumBytes() > kuint32max) {
     return errors::OutOfRange("Encountered dataset element of size ",
-                              iov.NumBytes(),
-                              ", exceeding the 4GB Snappy limit.");
+                              iov.NumBytes(), ", exceeding the 4GB ",
+                              use_zlib ? "zlib" : "Snappy", " limit.");
   }
-  if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
-                                      out->mutable_data())) {
+  if (use_zlib) {
+    TF_RETURN_IF_ERROR(ZlibCompressFromIOVec(
+        iov, options.zlib_compression_level, out->mutable_data()));
+  } else if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
+                                             out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
+  out->set_codec(options.codec);
   out->set_version(kCompressedElementVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
           << out->data().size() << " bytes";
@@ -193,22 +301,13 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.codec() == CompressedElement::ZLIB) {
+    TF_RETURN_IF_ERROR(ZlibUncompressToIOVec(compressed_data, iov));
+  } else if (compressed.codec() != CompressedElement::SNAPPY) {
+    return errors::Internal("Unsupported compressed element codec: ",
+                            compressed.codec());
+  } else {
+    TF_RETURN_IF_ERROR(SnappyUncompressToIOVec(compressed_data, iov));
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
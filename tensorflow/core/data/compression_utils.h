@@ -26,12 +26,27 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Options of `CompressElement`.
+struct CompressElementOptions {
+  // The codec of the compressed bytes. Zlib has a better compression ratio
+  // than Snappy, but is slower.
+  CompressedElement::Codec codec = CompressedElement::SNAPPY;
+  // The zlib compression level, from 0 (no compression) to 9 (best
+  // compression), or -1 for the default level of zlib.
+  int zlib_compression_level = -1;
+};
+
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
 // out the per-component metadata for the `CompressedElement`.
 //
 // Returns an error if the uncompressed size of the element exceeds 4GB.
+Status CompressElement(const std::vector<Tensor>& element,
+                       const CompressElementOptions& options,
+                       CompressedElement* out);
+
+// Compresses `element` with Snappy.
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
@@ -104,6 +104,46 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
               StatusIs(error::INTERNAL));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, ZlibRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  for (int level : {-1, 0, 1, 9}) {
+    CompressElementOptions options;
+    options.codec = CompressedElement::ZLIB;
+    options.zlib_compression_level = level;
+    CompressedElement compressed;
+    TF_ASSERT_OK(CompressElement(element, options, &compressed));
+    EXPECT_EQ(compressed.codec(), CompressedElement::ZLIB);
+    EXPECT_EQ(0, compressed.version());
+    std::vector<Tensor> round_trip_element;
+    TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+    TF_EXPECT_OK(
+        ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+  }
+}
+
+TEST_P(ParameterizedCompressionUtilsTest, CodecMismatch) {
+  std::vector<Tensor> element = GetParam();
+  CompressElementOptions options;
+  options.codec = CompressedElement::ZLIB;
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, options, &compressed));
+
+  compressed.set_codec(CompressedElement::SNAPPY);
+  std::vector<Tensor> round_trip_element;
+  EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
+              StatusIs(error::INTERNAL));
+}
+
+TEST(CompressionUtilsTest, InvalidZlibLevel) {
+  CompressElementOptions options;
+  options.codec = CompressedElement::ZLIB;
+  options.zlib_compression_level = 10;
+  CompressedElement compressed;
+  EXPECT_THAT(CompressElement(CreateTensors<int64_t>(TensorShape{1}, {{1}}),
+                              options, &compressed),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_def_builder.h"
 #include "tensorflow/core/framework/op_def_util.h"
@@ -51,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/batch_util.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/work_sharder.h"
 
@@ -102,6 +104,7 @@ constexpr char kSlackPeriodOpt[] = "slack_period";
 constexpr char kMakeDeterministicOpt[] = "make_deterministic";
 constexpr char kFilterParallelizationOpt[] = "filter_parallelization";
 constexpr char kWarmStartOpt[] = "warm_start";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
 
 void DefaultOptimizationGraphRewrites(
     const Options& options, absl::flat_hash_set<tstring>* optimization_enabled,
@@ -227,6 +230,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kWarmStartOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
 }
 
 // Returns whether an op has been allowlisted as stateless. Uses a heuristic to
@@ -773,8 +784,24 @@ Status CopyBatch(CopyBatchParams params,
   const size_t num_tuple_components = batch_elements.at(0).size();
   out_tensors->reserve(num_tuple_components);
   const int64_t num_batch_elements = batch_elements.size();
+  // Components whose batch aliases the elements, which need no copy.
+  std::vector<bool> aliased_components(num_tuple_components, false);
   for (size_t component_index = 0; component_index < num_tuple_components;
        ++component_index) {
+    {
+      std::vector<Tensor> component_elements;
+      component_elements.reserve(num_batch_elements);
+      for (const std::vector<Tensor>& element : batch_elements) {
+        component_elements.push_back(element[component_index]);
+      }
+      Tensor batch_component;
+      if (batch_util::MaybeBatchWithoutCopy(component_elements,
+                                            &batch_component)) {
+        out_tensors->push_back(std::move(batch_component));
+        aliased_components[component_index] = true;
+        continue;
+      }
+    }
     const Tensor& first_element = batch_elements.at(0)[component_index];
     TensorShape first_element_shape(first_element.shape());
     TensorShape batch_component_shape({num_batch_elements});
@@ -792,6 +819,7 @@ Status CopyBatch(CopyBatchParams params,
   }
   for (size_t component_index = 0; component_index < num_tuple_components;
        ++component_index) {
+    if (aliased_components[component_index]) continue;
     Tensor& batch_component = out_tensors->at(component_index);
     const Tensor& first_element = batch_elements.at(0)[component_index];
     TensorShape first_element_shape(first_element.shape());
@@ -961,10 +989,14 @@ namespace {
 
 REGISTER_DATASET_EXPERIMENT("allow_small_function_optimizations",
                             RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT(model::kAvailableCpuBudgetExperiment,
+                            RandomJobSamplePercentage<0>, IndependentHostTasks);
 REGISTER_DATASET_EXPERIMENT("autotune_buffer_optimization",
                             RandomJobSamplePercentage<0>, IndependentHostTasks);
 REGISTER_DATASET_EXPERIMENT(kFilterParallelizationOpt,
                             RandomJobSamplePercentage<0>, AllTasks);
+REGISTER_DATASET_EXPERIMENT("interleave_reorder_buffer",
+                            RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("min_outer_interleave_parallelism",
                             RandomJobSamplePercentage<0>, AllTasks);
 REGISTER_DATASET_EXPERIMENT("reduce_interleave_prefetch",
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/hash_utils.h"
 
+#include <algorithm>
 #include <array>
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
@@ -40,8 +42,12 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/regexp.h"
 #include "tensorflow/core/platform/status.h"
@@ -61,6 +67,9 @@ constexpr std::array<const char*, 3> kOpsWithSeed = {
 constexpr char kSeedInputName[] = "seed";
 constexpr char kSeed2InputName[] = "seed2";
 constexpr char kSeedGeneratorInputName[] = "seed_generator";
+// Tensor attributes at least this large are hashed ahead of the traversal of
+// the graph, in parallel.
+constexpr size_t kLargeTensorBytes = 64 << 10;
 
 template <std::size_t SIZE>
 bool IsNodeOfType(const NodeDef& node,
@@ -116,6 +125,78 @@ Status ShouldIgnoreInput(const NodeDef& node, int i, bool* result) {
   return OkStatus();
 }
 
+template <typename T>
+uint64 HashRepeatedField(const protobuf::RepeatedField<T>& field) {
+  return Hash64(reinterpret_cast<const char*>(field.data()),
+                field.size() * sizeof(T));
+}
+
+// Returns a hash of `proto` computed from the contents of its fields. Unlike
+// hashing its deterministic serialization, this doesn't copy the values of
+// large constants such as vocabularies or lookup tables.
+uint64 HashTensorProto(const TensorProto& proto) {
+  uint64 hash = Hash64Combine(proto.dtype(), proto.version_number());
+  hash = Hash64Combine(hash, DeterministicProtoHash64(proto.tensor_shape()));
+  hash = Hash64Combine(hash, Hash64(proto.tensor_content()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.half_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.float_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.double_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.int_val()));
+  hash = Hash64Combine(hash, proto.string_val_size());
+  for (const std::string& value : proto.string_val()) {
+    hash = Hash64Combine(hash, Hash64(value));
+  }
+  hash = Hash64Combine(hash, HashRepeatedField(proto.scomplex_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.int64_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.bool_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.dcomplex_val()));
+  for (const auto& value : proto.resource_handle_val()) {
+    hash = Hash64Combine(hash, DeterministicProtoHash64(value));
+  }
+  for (const auto& value : proto.variant_val()) {
+    hash = Hash64Combine(hash, DeterministicProtoHash64(value));
+  }
+  hash = Hash64Combine(hash, HashRepeatedField(proto.uint32_val()));
+  hash = Hash64Combine(hash, HashRepeatedField(proto.uint64_val()));
+  return Hash64Combine(hash, Hash64(proto.float8_val()));
+}
+
+// Returns a hash of the instantiation attributes of a function, which doesn't
+// depend on the order of the map.
+uint64 HashFunctionAttrs(const AttrValueMap& attrs) {
+  uint64 hash = 0;
+  for (const auto& attr : attrs) {
+    hash = Hash64CombineUnordered(
+        hash, Hash64Combine(Hash64(attr.first),
+                            DeterministicProtoHash64(attr.second)));
+  }
+  return hash;
+}
+
+// Runs `fn(i)` for each `i` in [0, n) on up to `max_parallelism` threads, and
+// returns the first error by index.
+Status ParallelFor(int64_t n, int max_parallelism,
+                   const std::function<Status(int64_t)>& fn) {
+  std::vector<Status> statuses(n);
+  {
+    const int num_threads =
+        static_cast<int>(std::min<int64_t>(n, max_parallelism));
+    thread::ThreadPool pool(Env::Default(), "hash_graph", num_threads);
+    BlockingCounter counter(n);
+    for (int64_t i = 0; i < n; ++i) {
+      pool.Schedule([&fn, &statuses, &counter, i]() {
+        statuses[i] = fn(i);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
 Status ParseInputNodeName(absl::string_view input_name,
                           absl::string_view* node_name,
                           absl::string_view* suffix, bool* is_control_input) {
@@ -143,7 +224,9 @@ Status ParseInputNodeName(absl::string_view input_name,
 // https://stackoverflow.com/questions/11338746/directed-graphs-with-a-given-root-node-match-another-directed-graph-for-equali
 class GraphHasher {
   using NodeCache = absl::flat_hash_map<const NodeDef*, uint64>;
-  using FunctionCache = absl::flat_hash_map<const FunctionDef*, uint64>;
+  // Keyed by function and hash of its instantiation attributes.
+  using FunctionCache =
+      absl::flat_hash_map<std::pair<const FunctionDef*, uint64>, uint64>;
   using AttrCache =
       absl::flat_hash_map<std::pair<const NodeDef*, bool>, uint64>;
 
@@ -241,6 +324,75 @@ class GraphHasher {
 
   Status HashRoot(uint64* hash) { return HashNode(root_, hash); }
 
+  // Hashes the large constants and the functions of the nodes of the graph in
+  // parallel ahead of `HashRoot`, which then finds their hashes in the caches.
+  // These are the independent and most expensive parts of hashing a dataset
+  // graph. The resulting hash is the same as without precomputation.
+  Status PrecomputeHashes() {
+    std::vector<const TensorProto*> tensors;
+    absl::flat_hash_set<std::pair<const FunctionDef*, uint64>> function_keys;
+    std::vector<std::pair<const std::string*, const AttrValueMap*>> functions;
+    auto add_function = [&](const std::string& name,
+                            const AttrValueMap& attrs) {
+      const FunctionDef* fdef = flib_->Find(name);
+      if (fdef == nullptr) return;
+      if (function_keys.emplace(fdef, HashFunctionAttrs(attrs)).second) {
+        functions.emplace_back(&name, &attrs);
+      }
+    };
+    for (const NodeDef& node : graph_->node()) {
+      if (!nodes_.contains(&node)) continue;
+      const OpRegistrationData* reg;
+      if (flib_->LookUp(node.op(), &reg).ok() && reg->is_function_op) {
+        add_function(node.op(), node.attr());
+      }
+      for (const auto& attr : node.attr()) {
+        const AttrValue& value = attr.second;
+        if (value.has_tensor()) {
+          if (value.tensor().ByteSizeLong() >= kLargeTensorBytes) {
+            tensors.push_back(&value.tensor());
+          }
+        } else if (value.has_func()) {
+          add_function(value.func().name(), value.func().attr());
+        } else if (value.has_list()) {
+          for (const auto& func : value.list().func()) {
+            add_function(func.name(), func.attr());
+          }
+        }
+      }
+    }
+    const int64_t num_tensors = tensors.size();
+    const int64_t num_tasks = num_tensors + functions.size();
+    const int max_parallelism = port::MaxParallelism();
+    if (num_tasks < 2 || max_parallelism < 2) return OkStatus();
+
+    // Each function is hashed by its own hasher, since the caches are not
+    // thread-safe. Functions they have in common are hashed more than once.
+    std::vector<uint64> hashes(num_tasks);
+    TF_RETURN_IF_ERROR(
+        ParallelFor(num_tasks, max_parallelism, [&](int64_t i) -> Status {
+          if (i < num_tensors) {
+            hashes[i] = HashTensorProto(*tensors[i]);
+            return OkStatus();
+          }
+          const auto& function = functions[i - num_tensors];
+          GraphHasher hasher(graph_, root_, flib_);
+          return hasher.HashFunction(*function.first, *function.second,
+                                     &hashes[i]);
+        }));
+    for (int64_t i = 0; i < num_tensors; ++i) {
+      tensor_cache_.emplace(tensors[i], hashes[i]);
+    }
+    for (int64_t i = 0; i < num_tasks - num_tensors; ++i) {
+      const auto& function = functions[i];
+      function_cache_->emplace(
+          std::make_pair(flib_->Find(*function.first),
+                         HashFunctionAttrs(*function.second)),
+          hashes[num_tensors + i]);
+    }
+    return OkStatus();
+  }
+
   Status CheckEqual(GraphHasher* that) {
     return CheckNodesEqual(root_, that, that->root_);
   }
@@ -468,6 +620,8 @@ class GraphHasher {
           value_hash = Hash64Combine(value_hash, func_hash);
         }
       }
+    } else if (attr_value.has_tensor()) {
+      value_hash = HashTensorAttr(attr_value.tensor());
     } else {
       value_hash = DeterministicProtoHash64(attr_value);
     }
@@ -475,6 +629,18 @@ class GraphHasher {
     return OkStatus();
   }
 
+  // Constants are hashed once per graph, since nodes are hashed both with and
+  // without their functions, and again when checking graphs for equality.
+  uint64 HashTensorAttr(const TensorProto& tensor) {
+    auto it = tensor_cache_.find(&tensor);
+    if (it != tensor_cache_.end()) {
+      return it->second;
+    }
+    const uint64 hash = HashTensorProto(tensor);
+    tensor_cache_.emplace(&tensor, hash);
+    return hash;
+  }
+
   Status CheckAttrsEqual(const std::string& attr_name,
                          const AttrValue& this_attr, GraphHasher* that,
                          const AttrValue& that_attr, bool compare_functions) {
@@ -529,7 +695,8 @@ class GraphHasher {
   Status HashFunction(const std::string& name, const AttrValueMap& attrs,
                       uint64* hash) {
     const FunctionDef* fdef = flib_->Find(name);
-    auto it = function_cache_->find(fdef);
+    const auto cache_key = std::make_pair(fdef, HashFunctionAttrs(attrs));
+    auto it = function_cache_->find(cache_key);
     if (it != function_cache_->end()) {
       *hash = it->second;
       return OkStatus();
@@ -563,7 +730,7 @@ class GraphHasher {
         HashControlInputs(control_rets, &control_ret_nodes_hash));
 
     *hash = Hash64Combine(ret_nodes_hash, control_ret_nodes_hash);
-    auto result = function_cache_->emplace(fdef, *hash);
+    auto result = function_cache_->emplace(cache_key, *hash);
     if (!result.second) {
       return errors::Internal(
           absl::StrCat("Computed the hash for function ", name, " twice!"));
@@ -717,6 +884,8 @@ class GraphHasher {
   // Edges that need to be pruned as their presence will cause cycles.
   absl::flat_hash_set<uint64> cycle_forming_edges_;
   absl::flat_hash_map<const NodeDef*, NodeRep> nodes_;
+  // Hashes of the tensor attributes of the nodes of `graph_`.
+  absl::flat_hash_map<const TensorProto*, uint64> tensor_cache_;
   std::shared_ptr<NodeCache> node_cache_;
   std::shared_ptr<FunctionCache> function_cache_;
   std::shared_ptr<AttrCache> attr_cache_;
@@ -760,6 +929,7 @@ Status HashNode(const GraphDef& graph, const NodeDef& node,
                 const FunctionLibraryDefinition& flib_def, uint64* hash) {
   GraphHasher hasher(&graph, &node, &flib_def);
   TF_RETURN_IF_ERROR(hasher.Init());
+  TF_RETURN_IF_ERROR(hasher.PrecomputeHashes());
   return hasher.HashRoot(hash);
 }
 
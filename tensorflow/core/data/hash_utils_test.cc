@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/hash_utils.h"
 
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -853,6 +855,115 @@ TEST_F(DatasetHashUtilsTest, HashNodeDifferentFunctionLists) {
       ContainsRegex("Functions AddAndMul and AddAndMul2 are not the same"));
 }
 
+// Returns a graph adding two constants, whose nodes have names starting with
+// `prefix`, and which are large enough to be hashed ahead of the graph.
+GraphDef LargeConstantsGraph(const std::string& prefix, const Tensor& x,
+                             const Tensor& y) {
+  GraphDef gd;
+  NodeDef* x_node = gd.add_node();
+  TF_CHECK_OK(NodeDefBuilder(absl::StrCat(prefix, "/x"), "Const")
+                  .Attr("dtype", x.dtype())
+                  .Attr("value", x)
+                  .Finalize(x_node));
+  NodeDef* y_node = gd.add_node();
+  TF_CHECK_OK(NodeDefBuilder(absl::StrCat(prefix, "/y"), "Const")
+                  .Attr("dtype", y.dtype())
+                  .Attr("value", y)
+                  .Finalize(y_node));
+  TF_CHECK_OK(NodeDefBuilder(absl::StrCat(prefix, "/add"), "Add")
+                  .Input(x_node->name(), 0, x.dtype())
+                  .Input(y_node->name(), 0, y.dtype())
+                  .Finalize(gd.add_node()));
+  return gd;
+}
+
+TEST_F(DatasetHashUtilsTest, HashNodeLargeConstants) {
+  Tensor x(DT_FLOAT, TensorShape({1 << 16}));
+  x.flat<float>().setConstant(1.0f);
+  Tensor y(DT_FLOAT, TensorShape({1 << 16}));
+  y.flat<float>().setConstant(2.0f);
+  Tensor z = tensor::DeepCopy(y);
+  z.flat<float>()(z.NumElements() - 1) = 3.0f;
+
+  const GraphDef gd1 = LargeConstantsGraph("graph_1", x, y);
+  const GraphDef gd2 = LargeConstantsGraph("graph_2", x, y);
+  const GraphDef gd3 = LargeConstantsGraph("graph_3", x, z);
+  EXPECT_EQ(GetHash(gd1, gd1.node(2)), GetHash(gd2, gd2.node(2)));
+  EXPECT_NE(GetHash(gd1, gd1.node(2)), GetHash(gd3, gd3.node(2)));
+  TF_EXPECT_OK(CheckSubgraphsEqual(gd1, &gd1.node(2), gd2, &gd2.node(2)));
+  EXPECT_FALSE(
+      CheckSubgraphsEqual(gd1, &gd1.node(2), gd3, &gd3.node(2)).ok());
+}
+
+TEST_F(DatasetHashUtilsTest, HashNodeLargeStringConstants) {
+  Tensor x(DT_STRING, TensorShape({1 << 13}));
+  Tensor y(DT_STRING, TensorShape({1 << 13}));
+  for (int i = 0; i < x.NumElements(); ++i) {
+    x.flat<tstring>()(i) = absl::StrCat("token_", i);
+    y.flat<tstring>()(i) = absl::StrCat("other_token_", i);
+  }
+  Tensor z = tensor::DeepCopy(y);
+  z.flat<tstring>()(0) = "changed_token";
+
+  const GraphDef gd1 = LargeConstantsGraph("graph_1", x, y);
+  const GraphDef gd2 = LargeConstantsGraph("graph_2", x, y);
+  const GraphDef gd3 = LargeConstantsGraph("graph_3", x, z);
+  EXPECT_EQ(GetHash(gd1, gd1.node(2)), GetHash(gd2, gd2.node(2)));
+  EXPECT_NE(GetHash(gd1, gd1.node(2)), GetHash(gd3, gd3.node(2)));
+}
+
+TEST_F(DatasetHashUtilsTest, HashNodeSameFunctionDifferentInstantiations) {
+  GraphDef gd;
+  *gd.mutable_library()->add_function() = FunctionDefHelper::Create(
+      "Double", {"i: T"}, {"o: T"}, {"T: {float, int32}"},
+      {{{"ret"}, "Add", {"i", "i"}, {{"T", "$T"}}}},
+      /*ret_def=*/{{"o", "ret:z:0"}});
+
+  auto bodies = [](DataType second_body_type) {
+    AttrValue bodies;
+    NameAttrList* first = bodies.mutable_list()->add_func();
+    first->set_name("Double");
+    (*first->mutable_attr())["T"].set_type(DT_FLOAT);
+    NameAttrList* second = bodies.mutable_list()->add_func();
+    second->set_name("Double");
+    (*second->mutable_attr())["T"].set_type(second_body_type);
+    return bodies;
+  };
+
+  NodeDef* n1 = gd.add_node();
+  TF_CHECK_OK(NodeDefBuilder("graph_1/node_1", "Const")
+                  .Attr("value", 1)
+                  .Device("CPU:0")
+                  .Finalize(n1));
+
+  std::vector<NodeDefBuilder::NodeOut> func_inputs;
+  func_inputs.emplace_back(n1->name(), 0, DT_FLOAT);
+
+  NodeDef* n2 = gd.add_node();
+  TF_CHECK_OK(NodeDefBuilder("graph_1/node_2", "For")
+                  .Input(n1->name(), 0, DT_INT32)
+                  .Input(n1->name(), 0, DT_INT32)
+                  .Input(n1->name(), 0, DT_INT32)
+                  .Input(func_inputs)
+                  .Attr("body", bodies(DT_FLOAT))
+                  .Device("CPU:0")
+                  .Finalize(n2));
+
+  NodeDef* n3 = gd.add_node();
+  TF_CHECK_OK(NodeDefBuilder("graph_1/node_3", "For")
+                  .Input(n1->name(), 0, DT_INT32)
+                  .Input(n1->name(), 0, DT_INT32)
+                  .Input(n1->name(), 0, DT_INT32)
+                  .Input(func_inputs)
+                  .Attr("body", bodies(DT_INT32))
+                  .Device("CPU:0")
+                  .Finalize(n3));
+
+  // The bodies instantiate the same function with different types, which must
+  // not share a cached hash.
+  EXPECT_NE(GetHash(gd, *n2), GetHash(gd, *n3));
+}
+
 TEST_F(DatasetHashUtilsTest, HashNodeDifferentControlInputs) {
   GraphDef gd;
 
@@ -1354,6 +1465,41 @@ static void BM_ComposedFunctionCallsGraph(benchmark::State& state) {
 }
 BENCHMARK(BM_ComposedFunctionCallsGraph);
 
+// Benchmark that simulates a graph with large embedded constants, such as
+// vocabularies.
+static void BM_LargeConstantsGraph(benchmark::State& state) {
+  const int num_constants = state.range(0);
+  const int num_elements = state.range(1);
+
+  GraphDef graph_def;
+  NodeDef* target = graph_def.add_node();
+  target->set_name("Target");
+  target->set_op("IdentityN");
+  std::vector<DataType> types(num_constants, DT_STRING);
+  AddNodeAttr("T", types, target);
+  for (int i = 0; i < num_constants; ++i) {
+    Tensor vocabulary(DT_STRING, TensorShape({num_elements}));
+    for (int j = 0; j < num_elements; ++j) {
+      vocabulary.flat<tstring>()(j) = absl::StrCat("vocabulary_", i, "_", j);
+    }
+    NodeDef* node = graph_def.add_node();
+    TF_CHECK_OK(NodeDefBuilder(absl::StrCat("Const_", i), "Const")
+                    .Attr("dtype", DT_STRING)
+                    .Attr("value", vocabulary)
+                    .Finalize(node));
+    *target->add_input() = node->name();
+  }
+
+  uint64 hash_value;
+  for (auto _ : state) {
+    TF_CHECK_OK(HashNode(graph_def, graph_def.node(0), &hash_value));
+  }
+}
+BENCHMARK(BM_LargeConstantsGraph)
+    ->ArgPair(1, 1 << 20)
+    ->ArgPair(8, 1 << 17)
+    ->ArgPair(64, 1 << 14);
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
@@ -165,6 +166,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       if (experiments.contains("autotune_buffer_optimization")) {
         model_->AddExperiment("autotune_buffer_optimization");
       }
+      if (experiments.contains(model::kAvailableCpuBudgetExperiment)) {
+        model_->AddExperiment(model::kAvailableCpuBudgetExperiment);
+      }
     }
     if (dataset()->params_.max_intra_op_parallelism >= 0) {
       max_intra_op_parallelism_ =
@@ -186,6 +190,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
 
   bool SymbolicCheckpointCompatible() const override { return true; }
 
+  std::shared_ptr<model::Model> GetModel() const override { return model_; }
+
   Status Initialize(IteratorContext* ctx) override {
     IteratorContext iter_ctx(CreateParams(ctx));
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
@@ -89,6 +89,21 @@ Status FindStatefulOps(const GraphDef& graph_def,
   return OkStatus();
 }
 
+// Writes the element at `index` of `elements` under `key_prefix`.
+Status WriteElement(IteratorStateWriter* writer, StringPiece key_prefix,
+                    const std::vector<std::vector<Tensor>>& elements,
+                    int64_t index) {
+  const std::vector<Tensor>& element = elements[index];
+  std::string element_prefix = absl::StrCat(key_prefix, "::", index);
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(element_prefix, kNumComponents, element.size()));
+  for (int j = 0; j < element.size(); ++j) {
+    TF_RETURN_IF_ERROR(writer->WriteTensor(
+        element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 Status ReadElementsFromCheckpoint(IteratorContext* ctx,
@@ -124,14 +139,24 @@ Status WriteElementsToCheckpoint(
   TF_RETURN_IF_ERROR(
       writer->WriteScalar(key_prefix, kNumElements, elements.size()));
   for (int i = 0; i < elements.size(); ++i) {
-    const std::vector<Tensor>& element = elements[i];
-    std::string element_prefix = absl::StrCat(key_prefix, "::", i);
-    TF_RETURN_IF_ERROR(
-        writer->WriteScalar(element_prefix, kNumComponents, element.size()));
-    for (int j = 0; j < elements[i].size(); ++j) {
-      TF_RETURN_IF_ERROR(writer->WriteTensor(
-          element_prefix, absl::StrCat(kComponent, "[", j, "]"), element[j]));
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, elements, i));
+  }
+  return OkStatus();
+}
+
+Status UpdateCheckpointElements(
+    IteratorStateWriter* writer, StringPiece key_prefix,
+    const std::vector<std::vector<Tensor>>& elements,
+    const absl::flat_hash_set<int64_t>& checkpoint_indices) {
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key_prefix, kNumElements, elements.size()));
+  for (int64_t i : checkpoint_indices) {
+    if (i < 0 || i >= elements.size()) {
+      return errors::InvalidArgument("Cannot checkpoint element ", i,
+                                     " of a list of ", elements.size(),
+                                     " elements.");
     }
+    TF_RETURN_IF_ERROR(WriteElement(writer, key_prefix, elements, i));
   }
   return OkStatus();
 }
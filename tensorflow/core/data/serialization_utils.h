@@ -24,6 +24,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/variant_tensor_data.h"
@@ -47,6 +48,17 @@ Status WriteElementsToCheckpoint(
     IteratorStateWriter* writer, StringPiece key_prefix,
     const std::vector<std::vector<Tensor>>& elements);
 
+// Updates the elements at `checkpoint_indices` and the number of elements in a
+// checkpoint written by WriteElementsToCheckpoint with the same key prefix.
+// This is only a complete checkpoint of `elements` if `writer` retains the
+// elements of the previous writes, e.g. a symbolic checkpoint, in which case
+// saving a large buffer costs time proportional to the number of changed
+// elements rather than to the size of the buffer.
+Status UpdateCheckpointElements(
+    IteratorStateWriter* writer, StringPiece key_prefix,
+    const std::vector<std::vector<Tensor>>& elements,
+    const absl::flat_hash_set<int64_t>& checkpoint_indices);
+
 // Helper class for reading data from a vector of VariantTensorData objects.
 class VariantTensorDataReader : public IteratorStateReader {
  public:
@@ -81,6 +81,42 @@ TEST(SerializationUtilsTest, CheckpointElementsRoundTrip) {
   }
 }
 
+TEST(SerializationUtilsTest, UpdateCheckpointElements) {
+  std::vector<std::vector<Tensor>> elements;
+  elements.push_back(CreateTensors<int32>(TensorShape({3}), {{1, 2, 3}}));
+  elements.push_back(CreateTensors<int32>(TensorShape({2}), {{4, 5}}));
+  MemoryCheckpoint checkpoint = MemoryCheckpoint::CreateRootCheckpoint(
+      std::make_shared<MemoryCheckpoint::IdRegistry>());
+  tstring test_prefix = full_name("test_prefix");
+  TF_ASSERT_OK(WriteElementsToCheckpoint(&checkpoint, test_prefix, elements));
+
+  // Only the updated elements are written again, the others are kept from the
+  // previous write.
+  elements[1] = CreateTensors<int32>(TensorShape({1}), {{6}});
+  elements.push_back(CreateTensors<int32>(TensorShape({1}), {{7}}));
+  TF_ASSERT_OK(UpdateCheckpointElements(&checkpoint, test_prefix, elements,
+                                        /*checkpoint_indices=*/{1, 2}));
+  EXPECT_FALSE(UpdateCheckpointElements(&checkpoint, test_prefix, elements,
+                                        /*checkpoint_indices=*/{3})
+                   .ok());
+
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(checkpoint.Save(&writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  std::vector<std::vector<Tensor>> read_elements;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> ctx,
+                          TestContext::Create());
+  TF_ASSERT_OK(ReadElementsFromCheckpoint(ctx->iter_ctx(), &reader, test_prefix,
+                                          &read_elements));
+  ASSERT_EQ(read_elements.size(), 3);
+  for (int i = 0; i < elements.size(); ++i) {
+    ASSERT_EQ(read_elements[i].size(), 1);
+    test::ExpectEqual(read_elements[i][0], elements[i][0]);
+  }
+}
+
 TEST(SerializationUtilsTest, VariantTensorDataRoundtrip) {
   VariantTensorDataWriter writer;
   TF_ASSERT_OK(writer.WriteScalar(full_name("Int64"), 24));
@@ -16,12 +16,14 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/logging_utils.h"
@@ -91,6 +93,32 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// An optional second cache tier, e.g. on local disk, that holds elements
+// evicted from memory so that lagging trainers can still read them. Element
+// indices are the absolute indices within the sequence.
+template <class ElementType>
+class SecondaryCacheTier {
+ public:
+  virtual ~SecondaryCacheTier() = default;
+
+  // Stores the element at `index`, and returns its stored size in bytes.
+  virtual StatusOr<size_t> Write(size_t index, const ElementType& element) = 0;
+
+  // Reads the element at `index`. Returns a NotFound error if the element has
+  // been deleted.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Deletes the element at `index`.
+  virtual Status Delete(size_t index) = 0;
+};
+
+// Number of `CrossTrainerCache` queries served from each tier.
+struct CrossTrainerCacheTierStats {
+  int64_t memory_hits = 0;
+  int64_t secondary_hits = 0;
+  int64_t misses = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -98,9 +126,14 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  //
+  // If `secondary_tier` is set, elements evicted from memory are written to it
+  // and kept until it holds more than `max_secondary_size_bytes`.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<SecondaryCacheTier<ElementType>> secondary_tier = nullptr,
+      size_t max_secondary_size_bytes = 0);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -120,10 +153,14 @@ class CrossTrainerCache {
   // Returns true if the cache has been cancelled.
   bool IsCancelled() const;
 
+  // Returns the number of queries served from each tier so far.
+  CrossTrainerCacheTierStats GetTierStats() const;
+
  private:
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
     bool cache_hit;
+    bool secondary_hit = false;
   };
 
   // Returns the next element and metrics about this query.
@@ -134,10 +171,20 @@ class CrossTrainerCache {
   // data is not ready, one of the trainers need to extend the cache.
   bool IsElementReady(const std::string& trainer_id);
 
+  // Returns true if the next element for `trainer_id` has been evicted from
+  // memory but is in the secondary tier.
+  bool IsElementInSecondaryTier(const std::string& trainer_id);
+
   // Returns the absolute element index relative to the dataset (not relative to
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
 
+  // Reads the element at `index` from the secondary tier for `trainer_id`.
+  // Returns a NotFound error if it has been deleted in the meantime, or the
+  // error of the secondary tier if the element cannot be read.
+  StatusOr<CacheQueryResult> GetElementFromSecondaryTier(
+      const std::string& trainer_id, size_t index);
+
   // Returns the next element for `trainer_id`.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
       const std::string& trainer_id);
@@ -145,6 +192,17 @@ class CrossTrainerCache {
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
+  // Writes the elements that `FreeSpace(new_element_size_bytes)` would evict
+  // to the secondary tier. Returns the sizes of the written elements, which
+  // may be fewer than the evicted elements if a write fails.
+  std::vector<size_t> SpillElements(size_t new_element_size_bytes);
+
+  // Records the elements written by `SpillElements` after they have been
+  // evicted, trims the secondary tier to `max_secondary_size_bytes_`, and
+  // returns the indices of the elements to delete from it.
+  std::vector<size_t> UpdateSecondaryTier(
+      const std::vector<size_t>& spilled_sizes);
+
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
@@ -158,6 +216,10 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // Optional tier for elements evicted from memory, and its size limit.
+  const std::unique_ptr<SecondaryCacheTier<ElementType>> secondary_tier_;
+  const size_t max_secondary_size_bytes_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,6 +232,14 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // Sizes of the elements in the secondary tier, which are the elements with
+  // indices in [`secondary_start_index_`, `cache_start_index_`).
+  std::deque<size_t> secondary_element_sizes_ TF_GUARDED_BY(mu_);
+  size_t secondary_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t secondary_start_index_ TF_GUARDED_BY(mu_) = 0;
+
+  CrossTrainerCacheTierStats tier_stats_ TF_GUARDED_BY(mu_);
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
@@ -183,9 +253,13 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<SecondaryCacheTier<ElementType>> secondary_tier,
+    size_t max_secondary_size_bytes)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      secondary_tier_(std::move(secondary_tier)),
+      max_secondary_size_bytes_(max_secondary_size_bytes) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
@@ -212,6 +286,8 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    size_t secondary_index = 0;
+    bool read_secondary_tier = false;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
@@ -222,10 +298,14 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
                                 /*is_cache_hit=*/!should_extend_cache};
       }
 
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+      // Reads an evicted element from the secondary tier without holding the
+      // lock. Otherwise, extends the cache or waits for another thread to
+      // extend the cache. When concurrent trainers wait for the next element,
+      // only one of them should extend the cache.
+      if (IsElementInSecondaryTier(trainer_id)) {
+        read_secondary_tier = true;
+        secondary_index = GetElementIndex(trainer_id);
+      } else if (extending_cache_) {
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +314,25 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (read_secondary_tier) {
+      StatusOr<CacheQueryResult> result =
+          GetElementFromSecondaryTier(trainer_id, secondary_index);
+      if (result.ok()) {
+        return result;
+      }
+      // The element was deleted by a concurrent `ExtendCache`, or could not be
+      // read. Either way, moves on to the next element, like for elements
+      // evicted from the cache.
+      if (!errors::IsNotFound(result.status())) {
+        LOG(WARNING) << "Failed to read element " << secondary_index
+                     << " from the tf.data service cross-trainer cache "
+                     << "secondary tier: " << result.status();
+      }
+      mutex_lock l(mu_);
+      trainer_to_element_index_map_[trainer_id] = secondary_index + 1;
+      continue;
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -250,6 +349,24 @@ bool CrossTrainerCache<ElementType>::IsElementReady(
   return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
 }
 
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementInSecondaryTier(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return secondary_tier_ != nullptr &&
+         GetElementIndex(trainer_id) < cache_start_index_;
+}
+
+template <class ElementType>
+StatusOr<typename CrossTrainerCache<ElementType>::CacheQueryResult>
+CrossTrainerCache<ElementType>::GetElementFromSecondaryTier(
+    const std::string& trainer_id, size_t index) TF_LOCKS_EXCLUDED(mu_) {
+  TF_ASSIGN_OR_RETURN(ElementType element, secondary_tier_->Read(index));
+  mutex_lock l(mu_);
+  trainer_to_element_index_map_[trainer_id] = index + 1;
+  return CacheQueryResult{std::make_shared<ElementType>(std::move(element)),
+                          /*is_cache_hit=*/true, /*secondary_hit=*/true};
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
@@ -271,8 +388,10 @@ template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  const size_t oldest_index =
+      secondary_tier_ != nullptr ? secondary_start_index_ : cache_start_index_;
+  if (element_index < oldest_index) {
+    element_index = oldest_index;
   }
   return element_index;
 }
@@ -289,14 +408,98 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
-  mutex_lock l(mu_);
-  TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
-  cache_.push_back(std::make_shared<ElementType>(std::move(element)));
-  cache_size_bytes_ += new_element_size_bytes;
+  std::vector<size_t> spilled_sizes;
+  if (secondary_tier_ != nullptr) {
+    spilled_sizes = SpillElements(new_element_size_bytes);
+  }
+
+  std::vector<size_t> indices_to_delete;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    FreeSpace(new_element_size_bytes);
+    cache_.push_back(std::make_shared<ElementType>(std::move(element)));
+    cache_size_bytes_ += new_element_size_bytes;
+    if (secondary_tier_ != nullptr) {
+      indices_to_delete = UpdateSecondaryTier(spilled_sizes);
+    }
+  }
+  for (size_t index : indices_to_delete) {
+    Status s = secondary_tier_->Delete(index);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete element " << index << " from the "
+                   << "tf.data service cross-trainer cache secondary tier: "
+                   << s;
+    }
+  }
   return OkStatus();
 }
 
+template <class ElementType>
+std::vector<size_t> CrossTrainerCache<ElementType>::SpillElements(
+    size_t new_element_size_bytes) TF_LOCKS_EXCLUDED(mu_) {
+  // Only the thread extending the cache evicts elements, so the elements to
+  // evict don't change while they are written without holding the lock.
+  std::vector<std::pair<size_t, std::shared_ptr<const ElementType>>> to_spill;
+  {
+    mutex_lock l(mu_);
+    size_t cache_size_bytes = cache_size_bytes_;
+    for (size_t i = 0; i < cache_.size() &&
+                       cache_size_bytes + new_element_size_bytes >
+                           max_cache_size_bytes_;
+         ++i) {
+      cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*cache_[i]);
+      to_spill.emplace_back(cache_start_index_ + i, cache_[i]);
+    }
+  }
+
+  std::vector<size_t> spilled_sizes;
+  for (const auto& [index, element] : to_spill) {
+    StatusOr<size_t> size = secondary_tier_->Write(index, *element);
+    if (!size.ok()) {
+      LOG(WARNING) << "Failed to write element " << index << " to the "
+                   << "tf.data service cross-trainer cache secondary tier: "
+                   << size.status();
+      break;
+    }
+    spilled_sizes.push_back(*size);
+  }
+  return spilled_sizes;
+}
+
+template <class ElementType>
+std::vector<size_t> CrossTrainerCache<ElementType>::UpdateSecondaryTier(
+    const std::vector<size_t>& spilled_sizes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<size_t> indices_to_delete;
+  if (secondary_start_index_ + secondary_element_sizes_.size() +
+          spilled_sizes.size() !=
+      cache_start_index_) {
+    // A write failed, so the secondary tier no longer holds the elements right
+    // before the ones in memory. Starts over from the current window.
+    for (size_t i = 0;
+         i < secondary_element_sizes_.size() + spilled_sizes.size(); ++i) {
+      indices_to_delete.push_back(secondary_start_index_ + i);
+    }
+    secondary_element_sizes_.clear();
+    secondary_size_bytes_ = 0;
+    secondary_start_index_ = cache_start_index_;
+    return indices_to_delete;
+  }
+
+  for (size_t size : spilled_sizes) {
+    secondary_element_sizes_.push_back(size);
+    secondary_size_bytes_ += size;
+  }
+  while (!secondary_element_sizes_.empty() &&
+         secondary_size_bytes_ > max_secondary_size_bytes_) {
+    indices_to_delete.push_back(secondary_start_index_);
+    secondary_size_bytes_ -= secondary_element_sizes_.front();
+    secondary_element_sizes_.pop_front();
+    ++secondary_start_index_;
+  }
+  return indices_to_delete;
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -336,6 +539,13 @@ bool CrossTrainerCache<ElementType>::IsCancelled() const
   return !status_.ok();
 }
 
+template <class ElementType>
+CrossTrainerCacheTierStats CrossTrainerCache<ElementType>::GetTierStats() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  return tier_stats_;
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
     const CacheQueryResult& result) {
@@ -344,6 +554,13 @@ void CrossTrainerCache<ElementType>::RecordMetrics(
   {
     mutex_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
+    if (result.secondary_hit) {
+      ++tier_stats_.secondary_hits;
+    } else if (result.cache_hit) {
+      ++tier_stats_.memory_hits;
+    } else {
+      ++tier_stats_.misses;
+    }
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
 }
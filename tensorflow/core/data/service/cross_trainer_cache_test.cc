@@ -121,6 +121,43 @@ size_t ElementOrErrorDataset<Tensor>::GetElementSizeBytes(
   return element.TotalBytes();
 }
 
+// Secondary tier keeping elements in a map. If `fail_writes` is true, all the
+// writes fail.
+class MapSecondaryTier : public SecondaryCacheTier<int64_t> {
+ public:
+  explicit MapSecondaryTier(bool fail_writes = false)
+      : fail_writes_(fail_writes) {}
+
+  StatusOr<size_t> Write(size_t index, const int64_t& element) override {
+    if (fail_writes_) {
+      return errors::Unavailable("Disk is full.");
+    }
+    mutex_lock l(mu_);
+    elements_[index] = element;
+    return sizeof(element);
+  }
+
+  StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index, " not found.");
+    }
+    return it->second;
+  }
+
+  Status Delete(size_t index) override {
+    mutex_lock l(mu_);
+    elements_.erase(index);
+    return OkStatus();
+  }
+
+ private:
+  const bool fail_writes_;
+  mutex mu_;
+  absl::flat_hash_map<size_t, int64_t> elements_ TF_GUARDED_BY(mu_);
+};
+
 std::vector<int64_t> GetRange(const size_t range) {
   std::vector<int64_t> result;
   for (int64_t i = 0; i < range; ++i) {
@@ -190,6 +227,43 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromSecondaryTier) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::make_unique<MapSecondaryTier>(),
+      /*max_secondary_size_bytes=*/10 * sizeof(int64_t));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // When 19 is cached, 15 to 19 are in memory and 5 to 14 are in the secondary
+  // tier.
+  for (int i = 5; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  CrossTrainerCacheTierStats stats = cache.GetTierStats();
+  EXPECT_EQ(stats.secondary_hits, 10);
+  EXPECT_EQ(stats.memory_hits, 6);
+  EXPECT_EQ(stats.misses, 20);
+}
+
+TEST(CrossTrainerCacheTest, FailedSecondaryTierWritesSkipData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapSecondaryTier>(/*fail_writes=*/true),
+      /*max_secondary_size_bytes=*/10 * sizeof(int64_t));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(15)));
+  EXPECT_EQ(cache.GetTierStats().secondary_hits, 0);
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
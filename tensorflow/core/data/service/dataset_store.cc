@@ -70,11 +70,11 @@ Status MemoryDatasetStore::Put(const std::string& key,
 
 Status MemoryDatasetStore::Get(const std::string& key,
                                std::shared_ptr<const DatasetDef>& dataset_def) {
-  auto& stored_dataset = datasets_[key];
-  if (!stored_dataset) {
+  auto it = datasets_.find(key);
+  if (it == datasets_.end() || !it->second) {
     return errors::NotFound("Dataset with key ", key, " not found");
   }
-  dataset_def = stored_dataset;
+  dataset_def = it->second;
   return OkStatus();
 }
 
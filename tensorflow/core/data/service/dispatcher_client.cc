@@ -125,16 +125,15 @@ Status DataServiceDispatcherClient::GetDatasetDef(const std::string& dataset_id,
   return OkStatus();
 }
 
-Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
-                                             int64_t repetition,
-                                             int64_t split_provider_index,
-                                             Tensor& split,
-                                             bool& end_of_splits) {
+Status DataServiceDispatcherClient::GetSplit(
+    int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
+    Tensor& split, bool& end_of_splits, const std::string& worker_address) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetSplitRequest req;
   req.set_iteration_id(iteration_id);
   req.set_repetition(repetition);
   req.set_split_provider_index(split_provider_index);
+  req.set_worker_address(worker_address);
   GetSplitResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
@@ -62,10 +62,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   Status GetDatasetDef(const std::string& dataset_id, DatasetDef& dataset_def);
 
   // Gets the next split for the specified iteration id, repetition, and split
-  // provider index.
+  // provider index. `worker_address` identifies the requesting worker, so the
+  // dispatcher can prefer splits whose data is local to it.
   Status GetSplit(int64_t iteration_id, int64_t repetition,
                   int64_t split_provider_index, Tensor& split,
-                  bool& end_of_splits);
+                  bool& end_of_splits, const std::string& worker_address = "");
 
   // Gets the next split for the specified source of a stream of the snapshot in
   // `base_path`. If `end_of_splits` returns true, then there are no more splits
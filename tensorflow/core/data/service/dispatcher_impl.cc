@@ -84,6 +84,7 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(2);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr int64_t kDefaultJournalCheckpointIntervalUpdates = 10000;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -159,6 +160,10 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_timeout_ms(
         absl::ToInt64Milliseconds(kDefaultWorkerTimeout));
   }
+  if (new_config.journal_checkpoint_interval_updates() == 0) {
+    new_config.set_journal_checkpoint_interval_updates(
+        kDefaultJournalCheckpointIntervalUpdates);
+  }
   return new_config;
 }
 }  // namespace
@@ -221,6 +226,8 @@ Status DataServiceDispatcherImpl::Start() {
   } else {
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      updates_since_checkpoint_ =
+          update.has_checkpoint() ? 0 : updates_since_checkpoint_ + 1;
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
   }
@@ -230,11 +237,14 @@ Status DataServiceDispatcherImpl::Start() {
           *iteration, split_providers_[iteration->iteration_id]));
     }
   }
-  for (const auto& client_id : state_.ListActiveClientIds()) {
-    // Conservatively pretend we just received a heartbeat from all clients, so
-    // that we don't garbage collect iterations too early.
-    latest_client_heartbeats_time_[client_id] =
-        absl::FromUnixMicros(env_->NowMicros());
+  {
+    mutex_lock heartbeat_lock(heartbeat_mu_);
+    for (const auto& client_id : state_.ListActiveClientIds()) {
+      // Conservatively pretend we just received a heartbeat from all clients,
+      // so that we don't garbage collect iterations too early.
+      latest_client_heartbeats_time_[client_id] =
+          absl::FromUnixMicros(env_->NowMicros());
+    }
   }
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
@@ -310,20 +320,39 @@ Status DataServiceDispatcherImpl::FindNewTasks(
     WorkerHeartbeatResponse* response) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   // Check for round-robin iterations that had tasks on the worker removed. Now
   // that the worker is back, we create a new pending task for the worker.
+  for (const auto& iteration :
+       RoundRobinIterationsWithoutTasks(assigned_tasks)) {
+    VLOG(1) << "Creating pending task for reconnected worker "
+            << worker_address;
+    TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
+  }
+  // Refresh assigned_tasks to include newly added pending tasks.
+  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+  return AddNewTasks(current_tasks, assigned_tasks, response);
+}
+
+std::vector<std::shared_ptr<const Iteration>>
+DataServiceDispatcherImpl::RoundRobinIterationsWithoutTasks(
+    const std::vector<std::shared_ptr<const Task>>& assigned_tasks) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
   absl::flat_hash_set<int64_t> assigned_iteration_ids;
   for (const auto& task : assigned_tasks) {
     assigned_iteration_ids.insert(task->iteration->iteration_id);
   }
+  std::vector<std::shared_ptr<const Iteration>> iterations;
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
         iteration->IsRoundRobin() && !iteration->finished) {
-      VLOG(1) << "Creating pending task for reconnected worker "
-              << worker_address;
-      TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
+      iterations.push_back(iteration);
     }
   }
-  // Refresh assigned_tasks to include newly added pending tasks.
-  TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+  return iterations;
+}
+
+Status DataServiceDispatcherImpl::AddNewTasks(
+    const absl::flat_hash_set<int64_t>& current_tasks,
+    const std::vector<std::shared_ptr<const Task>>& assigned_tasks,
+    WorkerHeartbeatResponse* response) const TF_SHARED_LOCKS_REQUIRED(mu_) {
   for (const auto& task : assigned_tasks) {
     if (current_tasks.contains(task->task_id)) {
       continue;
@@ -334,15 +363,80 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::ReadOnlyWorkerHeartbeat(
+    const WorkerHeartbeatRequest& request, WorkerHeartbeatResponse& response,
+    bool& handled) TF_SHARED_LOCKS_REQUIRED(mu_) {
+  handled = false;
+  // Snapshot managers update their state on every heartbeat.
+  if (!snapshots_.empty()) {
+    return OkStatus();
+  }
+  std::vector<std::shared_ptr<const Task>> assigned_tasks;
+  Status s = state_.TasksForWorker(request.worker_address(), assigned_tasks);
+  if (errors::IsNotFound(s)) {
+    // The worker needs to be registered.
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(s);
+  if (!RoundRobinIterationsWithoutTasks(assigned_tasks).empty()) {
+    // The worker needs new pending tasks.
+    return OkStatus();
+  }
+  absl::flat_hash_set<int64_t> current_tasks;
+  current_tasks.insert(request.current_tasks().cbegin(),
+                       request.current_tasks().cend());
+  TF_RETURN_IF_ERROR(
+      FindTasksToDelete(current_tasks, assigned_tasks, &response));
+  TF_RETURN_IF_ERROR(AddNewTasks(current_tasks, assigned_tasks, &response));
+  handled = true;
+  return OkStatus();
+}
+
 Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const WorkerHeartbeatRequest* request, WorkerHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
   VLOG(4) << "Received worker heartbeat request from worker "
           << request->worker_address();
-  mutex_lock l(mu_);
   const std::string& worker_address = request->worker_address();
-  latest_worker_heartbeats_time_[worker_address] =
-      absl::FromUnixMicros(env_->NowMicros());
+  {
+    mutex_lock l(heartbeat_mu_);
+    latest_worker_heartbeats_time_[worker_address] =
+        absl::FromUnixMicros(env_->NowMicros());
+    if (!request->cross_trainer_cache_stats().empty()) {
+      std::vector<CrossTrainerCacheStats>& cache_stats =
+          worker_cache_stats_[worker_address];
+      cache_stats.assign(request->cross_trainer_cache_stats().begin(),
+                         request->cross_trainer_cache_stats().end());
+      for (CrossTrainerCacheStats& stats : cache_stats) {
+        stats.set_worker_address(worker_address);
+        VLOG(2) << "Cross-trainer cache of task " << stats.task_id()
+                << " on worker " << worker_address << ": "
+                << stats.memory_hits() << " memory hits, "
+                << stats.disk_hits() << " disk hits, " << stats.misses()
+                << " misses.";
+      }
+    } else {
+      worker_cache_stats_.erase(worker_address);
+    }
+    if (config_.split_locality_lookahead() > 0) {
+      worker_local_split_keys_[worker_address] =
+          absl::flat_hash_set<std::string>(request->local_split_keys().begin(),
+                                           request->local_split_keys().end());
+    }
+  }
+  {
+    // Heartbeats from registered workers usually don't change the dispatcher
+    // state, so they are handled under a shared lock.
+    tf_shared_lock l(mu_);
+    bool handled = false;
+    TF_RETURN_IF_ERROR(ReadOnlyWorkerHeartbeat(*request, *response, handled));
+    if (handled) {
+      VLOG(4) << "Finished worker heartbeat for worker at address "
+              << worker_address;
+      return OkStatus();
+    }
+  }
+  mutex_lock l(mu_);
   // Assigned tasks from the perspective of the dispatcher.
   std::vector<std::shared_ptr<const Task>> assigned_tasks;
   Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -454,7 +548,16 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   DCHECK(split_provider != nullptr);
   Tensor split;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  if (config_.split_locality_lookahead() > 0) {
+    // All split providers are locality-aware if the lookahead is positive.
+    mutex_lock heartbeat_lock(heartbeat_mu_);
+    TF_RETURN_IF_ERROR(
+        static_cast<LocalityAwareSplitProvider*>(split_provider)
+            ->GetNextLocal(worker_local_split_keys_[request->worker_address()],
+                           &split, &end_of_splits));
+  } else {
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  }
   TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
                                          request->split_provider_index(),
                                          end_of_splits));
@@ -478,6 +581,12 @@ Status DataServiceDispatcherImpl::MakeSplitProviders(
   std::shared_ptr<const DatasetDef> dataset_def;
   TF_RETURN_IF_ERROR(GetDatasetDef(*dataset, dataset_def));
   TF_RETURN_IF_ERROR(CreateSplitProviders(*dataset_def, split_providers));
+  if (config_.split_locality_lookahead() > 0) {
+    for (std::unique_ptr<SplitProvider>& split_provider : split_providers) {
+      split_provider = std::make_unique<LocalityAwareSplitProvider>(
+          std::move(split_provider), config_.split_locality_lookahead());
+    }
+  }
   return OkStatus();
 }
 
@@ -801,6 +910,7 @@ Status DataServiceDispatcherImpl::AcquireIterationClientId(
   acquire_iteration_client->set_iteration_id(iteration->iteration_id);
   TF_RETURN_IF_ERROR(Apply(update));
   // Does not release clients before they start to read from the dataset.
+  mutex_lock heartbeat_lock(heartbeat_mu_);
   latest_client_heartbeats_time_[iteration_client_id] = absl::InfiniteFuture();
   return OkStatus();
 }
@@ -829,8 +939,11 @@ Status DataServiceDispatcherImpl::CreatePendingTask(
   create_task->set_task_id(task_id);
   create_task->set_iteration_id(iteration->iteration_id);
   create_task->set_worker_address(worker_address);
-  create_task->set_starting_round(round_robin_rounds_[iteration->iteration_id] +
-                                  1);
+  {
+    mutex_lock heartbeat_lock(heartbeat_mu_);
+    create_task->set_starting_round(
+        round_robin_rounds_[iteration->iteration_id] + 1);
+  }
   std::shared_ptr<const Worker> worker;
   TF_RETURN_IF_ERROR(state_.WorkerFromAddress(worker_address, worker));
   *create_task->mutable_transfer_servers() = {worker->transfer_servers.begin(),
@@ -930,20 +1043,20 @@ Status DataServiceDispatcherImpl::AssignTask(std::shared_ptr<const Task> task)
   return OkStatus();
 }
 
-Status DataServiceDispatcherImpl::ClientHeartbeat(
-    const ClientHeartbeatRequest* request, ClientHeartbeatResponse* response) {
-  TF_RETURN_IF_ERROR(CheckStarted());
-  mutex_lock l(mu_);
-  VLOG(4) << "Received heartbeat from client id "
-          << request->iteration_client_id();
-  latest_client_heartbeats_time_[request->iteration_client_id()] =
-      absl::FromUnixMicros(env_->NowMicros());
-  std::shared_ptr<const Iteration> iteration;
-  Status s = state_.IterationForIterationClientId(
-      request->iteration_client_id(), iteration);
+Status DataServiceDispatcherImpl::RecordClientHeartbeat(
+    const ClientHeartbeatRequest& request,
+    std::shared_ptr<const Iteration>& iteration)
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  {
+    mutex_lock l(heartbeat_mu_);
+    latest_client_heartbeats_time_[request.iteration_client_id()] =
+        absl::FromUnixMicros(env_->NowMicros());
+  }
+  Status s = state_.IterationForIterationClientId(request.iteration_client_id(),
+                                                  iteration);
   if (errors::IsNotFound(s) && !config_.fault_tolerant_mode()) {
     return errors::NotFound(
-        "Unknown iteration client id ", request->iteration_client_id(),
+        "Unknown iteration client id ", request.iteration_client_id(),
         ". The dispatcher is not configured to be fault tolerant, so this "
         "could be caused by a dispatcher restart.");
   }
@@ -954,12 +1067,65 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
         "Consider configuring the dispatcher with a higher "
         "`iteration_gc_timeout_ms`.");
   }
-  if (request->optional_current_round_case() ==
+  if (request.optional_current_round_case() ==
       ClientHeartbeatRequest::kCurrentRound) {
-    round_robin_rounds_[request->iteration_client_id()] =
-        std::max(round_robin_rounds_[request->iteration_client_id()],
-                 request->current_round());
+    mutex_lock l(heartbeat_mu_);
+    round_robin_rounds_[request.iteration_client_id()] =
+        std::max(round_robin_rounds_[request.iteration_client_id()],
+                 request.current_round());
+  }
+  return OkStatus();
+}
+
+Status DataServiceDispatcherImpl::PopulateClientHeartbeatResponse(
+    const Iteration& iteration, ClientHeartbeatResponse& response) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (!iteration.pending_tasks.empty()) {
+    response.set_block_round(iteration.pending_tasks.front().target_round);
   }
+
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration.iteration_id, tasks));
+  for (const auto& task : tasks) {
+    TaskInfo* task_info = response.mutable_task_info()->Add();
+    task_info->set_worker_address(task->worker_address);
+    *task_info->mutable_transfer_servers() = {task->transfer_servers.begin(),
+                                              task->transfer_servers.end()};
+    *task_info->mutable_worker_tags() = {task->worker_tags.begin(),
+                                         task->worker_tags.end()};
+    task_info->set_task_id(task->task_id);
+    task_info->set_iteration_id(iteration.iteration_id);
+    task_info->set_worker_uid(task->worker_uid);
+    task_info->set_starting_round(task->starting_round);
+  }
+  response.set_iteration_finished(iteration.finished);
+  response.set_deployment_mode(config_.deployment_mode());
+  return OkStatus();
+}
+
+Status DataServiceDispatcherImpl::ClientHeartbeat(
+    const ClientHeartbeatRequest* request, ClientHeartbeatResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  VLOG(4) << "Received heartbeat from client id "
+          << request->iteration_client_id();
+  {
+    // Unless the iteration has a pending task, a client heartbeat only reads
+    // the dispatcher state, so it is handled under a shared lock.
+    tf_shared_lock l(mu_);
+    std::shared_ptr<const Iteration> iteration;
+    TF_RETURN_IF_ERROR(RecordClientHeartbeat(*request, iteration));
+    if (iteration->pending_tasks.empty()) {
+      TF_RETURN_IF_ERROR(
+          PopulateClientHeartbeatResponse(*iteration, *response));
+      VLOG(4) << "Found " << response->task_info_size()
+              << " tasks for iteration client id "
+              << request->iteration_client_id();
+      return OkStatus();
+    }
+  }
+  mutex_lock l(mu_);
+  std::shared_ptr<const Iteration> iteration;
+  TF_RETURN_IF_ERROR(RecordClientHeartbeat(*request, iteration));
   if (!iteration->pending_tasks.empty()) {
     const auto& task = iteration->pending_tasks.front();
     Update update;
@@ -984,6 +1150,7 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
       for (int i = 0; i < task.failures; ++i) {
         round_offset *= 2;
       }
+      mutex_lock heartbeat_lock(heartbeat_mu_);
       rejected->set_new_target_round(
           round_robin_rounds_[request->iteration_client_id()] + round_offset);
       apply_update = true;
@@ -998,26 +1165,7 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
       TF_RETURN_IF_ERROR(Apply(update));
     }
   }
-  if (!iteration->pending_tasks.empty()) {
-    response->set_block_round(iteration->pending_tasks.front().target_round);
-  }
-
-  std::vector<std::shared_ptr<const Task>> tasks;
-  TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration->iteration_id, tasks));
-  for (const auto& task : tasks) {
-    TaskInfo* task_info = response->mutable_task_info()->Add();
-    task_info->set_worker_address(task->worker_address);
-    *task_info->mutable_transfer_servers() = {task->transfer_servers.begin(),
-                                              task->transfer_servers.end()};
-    *task_info->mutable_worker_tags() = {task->worker_tags.begin(),
-                                         task->worker_tags.end()};
-    task_info->set_task_id(task->task_id);
-    task_info->set_iteration_id(iteration->iteration_id);
-    task_info->set_worker_uid(task->worker_uid);
-    task_info->set_starting_round(task->starting_round);
-  }
-  response->set_iteration_finished(iteration->finished);
-  response->set_deployment_mode(config_.deployment_mode());
+  TF_RETURN_IF_ERROR(PopulateClientHeartbeatResponse(*iteration, *response));
   VLOG(4) << "Found " << response->task_info_size()
           << " tasks for iteration client id "
           << request->iteration_client_id();
@@ -1132,7 +1280,7 @@ Status DataServiceDispatcherImpl::PopulateTaskDef(
 }
 
 Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
-  mutex_lock l(mu_);
+  tf_shared_lock l(mu_);
   if (!started_) {
     return errors::Unavailable("Dispatcher has not started yet.");
   }
@@ -1161,7 +1309,32 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
   }
-  return state_.Apply(update);
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  MaybeCheckpointJournal();
+  return OkStatus();
+}
+
+void DataServiceDispatcherImpl::MaybeCheckpointJournal()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!journal_writer_.has_value() ||
+      config_.journal_checkpoint_interval_updates() < 0) {
+    return;
+  }
+  if (++updates_since_checkpoint_ <
+      config_.journal_checkpoint_interval_updates()) {
+    return;
+  }
+  Update checkpoint;
+  *checkpoint.mutable_checkpoint() = state_.Checkpoint();
+  Status s = journal_writer_.value()->WriteCheckpoint(checkpoint);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to checkpoint the dispatcher journal after "
+                 << updates_since_checkpoint_ << " updates: " << s;
+    return;
+  }
+  VLOG(1) << "Checkpointed the dispatcher journal after "
+          << updates_since_checkpoint_ << " updates";
+  updates_since_checkpoint_ = 0;
 }
 
 void DataServiceDispatcherImpl::MaintenanceThread() {
@@ -1198,8 +1371,13 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
   for (const auto& client_id : state_.ListActiveClientIds()) {
+    absl::Time latest_heartbeat_time;
+    {
+      mutex_lock l(heartbeat_mu_);
+      latest_heartbeat_time = latest_client_heartbeats_time_[client_id];
+    }
     if (absl::FromUnixMicros(now) >
-        latest_client_heartbeats_time_[client_id] +
+        latest_heartbeat_time +
             absl::Milliseconds(config_.client_timeout_ms())) {
       LOG(INFO) << "Releasing timed-out client with id " << client_id;
       Update update;
@@ -1217,11 +1395,14 @@ Status DataServiceDispatcherImpl::ReleaseMissingClients()
 void DataServiceDispatcherImpl::DetectMissingWorkers()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
+  mutex_lock l(heartbeat_mu_);
   for (auto it = latest_worker_heartbeats_time_.begin();
        it != latest_worker_heartbeats_time_.end();) {
     if (absl::FromUnixMicros(now) >
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
+      worker_local_split_keys_.erase(it->first);
+      worker_cache_stats_.erase(it->first);
       latest_worker_heartbeats_time_.erase(it++);
     } else {
       ++it;
@@ -1311,6 +1492,13 @@ DispatcherStateExport DataServiceDispatcherImpl::ExportState() const
     iteration_export->set_finished(iteration->finished);
     iteration_export->set_garbage_collected(iteration->garbage_collected);
   }
+
+  mutex_lock heartbeat_lock(heartbeat_mu_);
+  for (const auto& [worker_address, cache_stats] : worker_cache_stats_) {
+    for (const CrossTrainerCacheStats& stats : cache_stats) {
+      *dispatcher_state_export.add_cross_trainer_cache_stats() = stats;
+    }
+  }
   return dispatcher_state_export;
 }
 
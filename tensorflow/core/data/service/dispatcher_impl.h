@@ -245,7 +245,38 @@ class DataServiceDispatcherImpl {
       const std::string& worker_address,
       const absl::flat_hash_set<int64_t>& current_tasks,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& assigned_tasks,
-      WorkerHeartbeatResponse* response);
+      WorkerHeartbeatResponse* response) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the unfinished round robin iterations which have no task among
+  // `assigned_tasks`, e.g. because their task was removed while the worker was
+  // missing.
+  std::vector<std::shared_ptr<const DispatcherState::Iteration>>
+  RoundRobinIterationsWithoutTasks(
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>&
+          assigned_tasks) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Adds the tasks in `assigned_tasks` which are not in `current_tasks` to the
+  // heartbeat response.
+  Status AddNewTasks(
+      const absl::flat_hash_set<int64_t>& current_tasks,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>&
+          assigned_tasks,
+      WorkerHeartbeatResponse* response) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Handles a heartbeat from a registered worker without modifying the
+  // dispatcher state. Sets `handled` to false if the heartbeat needs to modify
+  // the state, in which case it must be handled under an exclusive lock.
+  Status ReadOnlyWorkerHeartbeat(const WorkerHeartbeatRequest& request,
+                                 WorkerHeartbeatResponse& response,
+                                 bool& handled) TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Records a heartbeat from an iteration client and stores the iteration the
+  // client reads from in `iteration`.
+  Status RecordClientHeartbeat(
+      const ClientHeartbeatRequest& request,
+      std::shared_ptr<const DispatcherState::Iteration>& iteration)
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Fills out the tasks and status of `iteration` in a client heartbeat
+  // response.
+  Status PopulateClientHeartbeatResponse(
+      const DispatcherState::Iteration& iteration,
+      ClientHeartbeatResponse& response) const TF_SHARED_LOCKS_REQUIRED(mu_);
   // Acquires an iteration client id to read from the given iteration and sets
   // `iteration_client_id`.
   Status AcquireIterationClientId(
@@ -293,7 +324,7 @@ class DataServiceDispatcherImpl {
   // Fills out a TaskDef with information about a task.
   Status PopulateTaskDef(std::shared_ptr<const DispatcherState::Task> task,
                          TaskDef* task_def) const
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+      TF_SHARED_LOCKS_REQUIRED(mu_);
   // Checks that the dispatcher has started, returning UNAVAILABLE if it hasn't.
   Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
   // Records that a split was produced by a call to `GetSplit`.
@@ -302,6 +333,10 @@ class DataServiceDispatcherImpl {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, updating both the journal and the in-memory state.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Writes a checkpoint of the dispatcher state to the journal if enough
+  // updates have been journaled since the last checkpoint. Failures are only
+  // logged, since the journal is still complete without the checkpoint.
+  void MaybeCheckpointJournal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
@@ -342,19 +377,33 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
-  // Mapping from round robin iteration id to the round the iteration is
-  // currently on. This is based on the data provided by client heartbeats,
-  // and may be stale.
-  absl::flat_hash_map<int64_t, int64_t> round_robin_rounds_ TF_GUARDED_BY(mu_);
   // Map from task id to a TaskRemover which determines when to remove the task.
   absl::flat_hash_map<int64_t, std::shared_ptr<TaskRemover>>
       remove_task_requests_ TF_GUARDED_BY(mu_);
+
+  // Guards the heartbeat bookkeeping below, so that heartbeats which only read
+  // the dispatcher state can be handled concurrently under a shared `mu_`. If
+  // both are held, `mu_` must be acquired first.
+  mutable mutex heartbeat_mu_ TF_ACQUIRED_AFTER(mu_);
+  // Mapping from round robin iteration id to the round the iteration is
+  // currently on. This is based on the data provided by client heartbeats,
+  // and may be stale.
+  absl::flat_hash_map<int64_t, int64_t> round_robin_rounds_
+      TF_GUARDED_BY(heartbeat_mu_);
   // Map from client id to the time of the client's last heartbeat.
   absl::flat_hash_map<int64_t, absl::Time> latest_client_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(heartbeat_mu_);
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(heartbeat_mu_);
+  // Map from worker address to the keys of the splits whose data is local to
+  // the worker, as of the worker's last heartbeat.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<std::string>>
+      worker_local_split_keys_ TF_GUARDED_BY(heartbeat_mu_);
+  // Map from worker address to the cross-trainer cache hit counts of the
+  // worker's tasks, as of the worker's last heartbeat.
+  absl::flat_hash_map<std::string, std::vector<CrossTrainerCacheStats>>
+      worker_cache_stats_ TF_GUARDED_BY(heartbeat_mu_);
 
   // Managers for all snapshot processes created or recovered during the
   // lifetime of this dispatcher instance.
@@ -363,6 +412,8 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Number of updates written to the journal since its last checkpoint.
+  int64_t updates_since_checkpoint_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
@@ -17,7 +17,10 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <queue>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -85,6 +88,9 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kSnapshot:
       Snapshot(update.snapshot());
       break;
+    case Update::kCheckpoint:
+      Restore(update.checkpoint());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -391,12 +397,14 @@ int64_t DispatcherState::NextAvailableIterationId() const {
 }
 
 Status DispatcherState::IterationForIterationClientId(
-    int64_t iteration_client_id, std::shared_ptr<const Iteration>& iteration) {
-  iteration = iterations_for_client_ids_[iteration_client_id];
-  if (!iteration) {
+    int64_t iteration_client_id,
+    std::shared_ptr<const Iteration>& iteration) const {
+  auto it = iterations_for_client_ids_.find(iteration_client_id);
+  if (it == iterations_for_client_ids_.end() || !it->second) {
     return errors::NotFound("Iteration client id not found: ",
                             iteration_client_id);
   }
+  iteration = it->second;
   return OkStatus();
 }
 
@@ -473,5 +481,231 @@ void DispatcherState::Snapshot(const SnapshotUpdate& snapshot) {
   snapshot_paths_.insert(snapshot.path());
 }
 
+CheckpointUpdate DispatcherState::Checkpoint() const {
+  CheckpointUpdate checkpoint;
+  for (const auto& [dataset_id, dataset] : datasets_by_id_) {
+    RegisterDatasetUpdate* register_dataset = checkpoint.add_datasets();
+    register_dataset->set_dataset_id(dataset_id);
+    *register_dataset->mutable_metadata() = dataset->metadata;
+  }
+
+  // Workers are registered in the order of their indices, so that restoring
+  // them resolves the configured worker addresses to the same indices.
+  std::vector<std::pair<int64_t, std::shared_ptr<Worker>>> workers;
+  for (const auto& [address, worker] : workers_) {
+    StatusOr<int64_t> index = worker_index_resolver_.GetWorkerIndex(address);
+    workers.push_back({index.ok() ? *index : -1, worker});
+  }
+  std::sort(workers.begin(), workers.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return std::tie(lhs.first, lhs.second->address) <
+                     std::tie(rhs.first, rhs.second->address);
+            });
+  for (const auto& [unused, worker] : workers) {
+    RegisterWorkerUpdate* register_worker = checkpoint.add_workers();
+    register_worker->set_worker_address(worker->address);
+    *register_worker->mutable_transfer_servers() = {
+        worker->transfer_servers.begin(), worker->transfer_servers.end()};
+    *register_worker->mutable_worker_tags() = {worker->tags.begin(),
+                                               worker->tags.end()};
+    register_worker->set_worker_uid(worker->uid);
+  }
+
+  std::vector<std::shared_ptr<Job>> jobs;
+  for (const auto& [unused, job] : jobs_by_id_) {
+    jobs.push_back(job);
+  }
+  std::sort(jobs.begin(), jobs.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs->id < rhs->id; });
+  for (const auto& job : jobs) {
+    CreateJobUpdate* create_job = checkpoint.add_jobs();
+    create_job->set_job_id(job->id);
+    create_job->set_job_name(job->job_name);
+    create_job->set_dataset_id(job->dataset_id);
+    *create_job->mutable_processing_mode_def() = job->processing_mode;
+    if (job->num_consumers.has_value()) {
+      create_job->set_num_consumers(*job->num_consumers);
+    }
+    create_job->set_target_workers(job->target_workers);
+    create_job->set_use_cross_trainer_cache(job->use_cross_trainer_cache);
+  }
+
+  // Iterations are restored in the order of their ids, so that a repetition of
+  // a job replaces the garbage collected iteration with the same key.
+  std::vector<std::shared_ptr<Iteration>> iterations;
+  for (const auto& [unused, iteration] : iterations_) {
+    iterations.push_back(iteration);
+  }
+  std::sort(iterations.begin(), iterations.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs->iteration_id < rhs->iteration_id;
+            });
+  for (const auto& iteration : iterations) {
+    IterationCheckpoint* iteration_checkpoint = checkpoint.add_iterations();
+    CreateIterationUpdate* create_iteration =
+        iteration_checkpoint->mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration->iteration_id);
+    create_iteration->set_job_id(iteration->job->id);
+    create_iteration->set_repetition(iteration->iteration_key.repetition);
+    if (iteration->distributed_epoch_state.has_value()) {
+      const DistributedEpochState& state = *iteration->distributed_epoch_state;
+      create_iteration->set_num_split_providers(state.indices.size());
+      *iteration_checkpoint->mutable_split_repetitions() = {
+          state.repetitions.begin(), state.repetitions.end()};
+      *iteration_checkpoint->mutable_split_indices() = {state.indices.begin(),
+                                                        state.indices.end()};
+    }
+    iteration_checkpoint->set_last_client_released_micros(
+        iteration->last_client_released_micros);
+    iteration_checkpoint->set_finished(iteration->finished);
+    iteration_checkpoint->set_garbage_collected(iteration->garbage_collected);
+
+    for (const auto& task : tasks_by_iteration_.at(iteration->iteration_id)) {
+      TaskCheckpoint* task_checkpoint = iteration_checkpoint->add_tasks();
+      CreateTaskUpdate* create_task = task_checkpoint->mutable_create_task();
+      create_task->set_task_id(task->task_id);
+      create_task->set_iteration_id(iteration->iteration_id);
+      create_task->set_worker_address(task->worker_address);
+      *create_task->mutable_transfer_servers() = {
+          task->transfer_servers.begin(), task->transfer_servers.end()};
+      *create_task->mutable_worker_tags() = {task->worker_tags.begin(),
+                                             task->worker_tags.end()};
+      create_task->set_worker_uid(task->worker_uid);
+      task_checkpoint->set_starting_round(task->starting_round);
+      task_checkpoint->set_finished(task->finished);
+    }
+
+    std::queue<PendingTask> pending_tasks = iteration->pending_tasks;
+    for (; !pending_tasks.empty(); pending_tasks.pop()) {
+      const PendingTask& pending_task = pending_tasks.front();
+      const Task& task = *pending_task.task;
+      PendingTaskCheckpoint* pending_checkpoint =
+          iteration_checkpoint->add_pending_tasks();
+      CreatePendingTaskUpdate* create_pending_task =
+          pending_checkpoint->mutable_create_pending_task();
+      create_pending_task->set_task_id(task.task_id);
+      create_pending_task->set_iteration_id(iteration->iteration_id);
+      create_pending_task->set_worker_address(task.worker_address);
+      *create_pending_task->mutable_transfer_servers() = {
+          task.transfer_servers.begin(), task.transfer_servers.end()};
+      *create_pending_task->mutable_worker_tags() = {task.worker_tags.begin(),
+                                                     task.worker_tags.end()};
+      create_pending_task->set_worker_uid(task.worker_uid);
+      create_pending_task->set_starting_round(task.starting_round);
+      pending_checkpoint->set_target_round(pending_task.target_round);
+      *pending_checkpoint->mutable_ready_consumers() = {
+          pending_task.ready_consumers.begin(),
+          pending_task.ready_consumers.end()};
+      pending_checkpoint->set_failures(pending_task.failures);
+      pending_checkpoint->set_removed(task.removed);
+    }
+  }
+
+  for (const auto& [iteration_client_id, iteration] :
+       iterations_for_client_ids_) {
+    if (iteration) {
+      (*checkpoint.mutable_iteration_client_ids())[iteration_client_id] =
+          iteration->iteration_id;
+    }
+  }
+  for (const std::string& path : snapshot_paths_) {
+    checkpoint.add_snapshot_paths(path);
+  }
+  checkpoint.set_next_available_dataset_id(next_available_dataset_id_);
+  checkpoint.set_next_available_job_id(next_available_job_id_);
+  checkpoint.set_next_available_iteration_id(next_available_iteration_id_);
+  checkpoint.set_next_available_iteration_client_id(
+      next_available_iteration_client_id_);
+  checkpoint.set_next_available_task_id(next_available_task_id_);
+  return checkpoint;
+}
+
+void DispatcherState::Restore(const CheckpointUpdate& checkpoint) {
+  datasets_by_id_.clear();
+  workers_.clear();
+  jobs_by_id_.clear();
+  jobs_by_name_.clear();
+  iterations_.clear();
+  iterations_by_key_.clear();
+  iterations_for_client_ids_.clear();
+  tasks_.clear();
+  tasks_by_iteration_.clear();
+  tasks_by_worker_.clear();
+  snapshot_paths_.clear();
+
+  for (const RegisterDatasetUpdate& register_dataset : checkpoint.datasets()) {
+    RegisterDataset(register_dataset);
+  }
+  for (const RegisterWorkerUpdate& register_worker : checkpoint.workers()) {
+    RegisterWorker(register_worker);
+  }
+  for (const CreateJobUpdate& create_job : checkpoint.jobs()) {
+    CreateJob(create_job);
+  }
+  for (const IterationCheckpoint& iteration_checkpoint :
+       checkpoint.iterations()) {
+    CreateIteration(iteration_checkpoint.create_iteration());
+    const int64_t iteration_id =
+        iteration_checkpoint.create_iteration().iteration_id();
+    std::shared_ptr<Iteration>& iteration = iterations_[iteration_id];
+    if (iteration->distributed_epoch_state.has_value()) {
+      DistributedEpochState& state = *iteration->distributed_epoch_state;
+      DCHECK_EQ(iteration_checkpoint.split_indices_size(),
+                state.indices.size());
+      state.repetitions = {iteration_checkpoint.split_repetitions().begin(),
+                           iteration_checkpoint.split_repetitions().end()};
+      state.indices = {iteration_checkpoint.split_indices().begin(),
+                       iteration_checkpoint.split_indices().end()};
+    }
+    iteration->last_client_released_micros =
+        iteration_checkpoint.last_client_released_micros();
+    iteration->finished = iteration_checkpoint.finished();
+    iteration->garbage_collected = iteration_checkpoint.garbage_collected();
+
+    for (const TaskCheckpoint& task_checkpoint : iteration_checkpoint.tasks()) {
+      CreateTask(task_checkpoint.create_task());
+      std::shared_ptr<Task>& task =
+          tasks_[task_checkpoint.create_task().task_id()];
+      task->starting_round = task_checkpoint.starting_round();
+      task->finished = task_checkpoint.finished();
+      if (task->finished) {
+        tasks_by_worker_[task->worker_address].erase(task->task_id);
+      }
+    }
+    for (const PendingTaskCheckpoint& pending_checkpoint :
+         iteration_checkpoint.pending_tasks()) {
+      CreatePendingTask(pending_checkpoint.create_pending_task());
+      PendingTask& pending_task = iteration->pending_tasks.back();
+      pending_task.target_round = pending_checkpoint.target_round();
+      pending_task.ready_consumers = {
+          pending_checkpoint.ready_consumers().begin(),
+          pending_checkpoint.ready_consumers().end()};
+      pending_task.failures = pending_checkpoint.failures();
+      if (pending_checkpoint.removed()) {
+        pending_task.task->removed = true;
+        tasks_by_worker_[pending_task.task->worker_address].erase(
+            pending_task.task->task_id);
+        tasks_.erase(pending_task.task->task_id);
+      }
+    }
+  }
+  for (const auto& [iteration_client_id, iteration_id] :
+       checkpoint.iteration_client_ids()) {
+    AcquireIterationClientUpdate acquire_iteration_client;
+    acquire_iteration_client.set_iteration_client_id(iteration_client_id);
+    acquire_iteration_client.set_iteration_id(iteration_id);
+    AcquireIterationClient(acquire_iteration_client);
+  }
+  for (const std::string& path : checkpoint.snapshot_paths()) {
+    snapshot_paths_.insert(path);
+  }
+  next_available_dataset_id_ = checkpoint.next_available_dataset_id();
+  next_available_job_id_ = checkpoint.next_available_job_id();
+  next_available_iteration_id_ = checkpoint.next_available_iteration_id();
+  next_available_iteration_client_id_ =
+      checkpoint.next_available_iteration_client_id();
+  next_available_task_id_ = checkpoint.next_available_task_id();
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -72,6 +72,10 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Returns a checkpoint of the dispatcher's state. Applying an update with
+  // this checkpoint to any state restores the current state.
+  CheckpointUpdate Checkpoint() const;
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(const std::string& dataset_id,
@@ -260,7 +264,8 @@ class DispatcherState {
   // Returns NOT_FOUND if the iteration_client_id is unknown or has been
   // released.
   Status IterationForIterationClientId(
-      int64_t iteration_client_id, std::shared_ptr<const Iteration>& iteration);
+      int64_t iteration_client_id,
+      std::shared_ptr<const Iteration>& iteration) const;
   // Returns a list of all active client ids.
   std::vector<int64_t> ListActiveClientIds();
   // Returns the next available iteration client id.
@@ -313,6 +318,7 @@ class DispatcherState {
   void CreateTask(const CreateTaskUpdate& create_task);
   void FinishTask(const FinishTaskUpdate& finish_task);
   void Snapshot(const SnapshotUpdate& snapshot);
+  void Restore(const CheckpointUpdate& checkpoint);
 
   // Updates the next available dataset ID.
   void UpdateNextAvailableDatasetId();
@@ -639,5 +639,62 @@ TEST(DispatcherState, ListSnapshotPaths) {
   EXPECT_EQ(state.ListSnapshotPaths(), snapshot_paths);
 }
 
+TEST(DispatcherState, RestoreFromCheckpoint) {
+  std::string dataset_id = "dataset_id";
+  int64_t iteration_id = 3;
+  int64_t iteration_client_id = 7;
+  std::string worker_address_1 = "worker_1";
+  std::string worker_address_2 = "worker_2";
+  DispatcherState state;
+  TF_EXPECT_OK(RegisterDataset(dataset_id, state));
+  TF_EXPECT_OK(RegisterWorker(worker_address_1, state));
+  TF_EXPECT_OK(RegisterWorker(worker_address_2, state));
+  TF_EXPECT_OK(CreateIteration(iteration_id, dataset_id, state));
+  TF_EXPECT_OK(
+      AcquireIterationClientId(iteration_id, iteration_client_id, state));
+  TF_EXPECT_OK(
+      CreateTask(/*task_id=*/4, iteration_id, worker_address_1, state));
+  TF_EXPECT_OK(
+      CreateTask(/*task_id=*/5, iteration_id, worker_address_2, state));
+  TF_EXPECT_OK(FinishTask(/*task_id=*/4, state));
+  TF_EXPECT_OK(Snapshot("snapshot_path", state));
+
+  Update update;
+  *update.mutable_checkpoint() = state.Checkpoint();
+  DispatcherState restored;
+  TF_EXPECT_OK(RegisterDataset("stale_dataset_id", restored));
+  TF_EXPECT_OK(restored.Apply(update));
+
+  std::shared_ptr<const Dataset> dataset;
+  TF_EXPECT_OK(restored.DatasetFromId(dataset_id, dataset));
+  EXPECT_THAT(restored.DatasetFromId("stale_dataset_id", dataset),
+              StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(restored.ListWorkers(), SizeIs(2));
+  std::shared_ptr<const Iteration> iteration;
+  TF_EXPECT_OK(
+      restored.IterationForIterationClientId(iteration_client_id, iteration));
+  EXPECT_EQ(iteration->iteration_id, iteration_id);
+  EXPECT_EQ(iteration->num_clients, 1);
+  EXPECT_FALSE(iteration->finished);
+  std::shared_ptr<const Task> task;
+  TF_EXPECT_OK(restored.TaskFromId(/*id=*/4, task));
+  EXPECT_TRUE(task->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_EXPECT_OK(restored.TasksForIteration(iteration_id, tasks));
+  EXPECT_THAT(tasks, SizeIs(2));
+  TF_EXPECT_OK(restored.TasksForWorker(worker_address_1, tasks));
+  EXPECT_THAT(tasks, IsEmpty());
+  TF_EXPECT_OK(restored.TasksForWorker(worker_address_2, tasks));
+  EXPECT_THAT(tasks, SizeIs(1));
+  EXPECT_EQ(restored.ListSnapshotPaths(), state.ListSnapshotPaths());
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableIterationId(),
+            state.NextAvailableIterationId());
+  EXPECT_EQ(restored.NextAvailableIterationClientId(),
+            state.NextAvailableIterationClientId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), state.NextAvailableTaskId());
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -44,6 +44,22 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return OkStatus();
 }
+
+// Returns the sequence numbers of the journal files in `journal_dir`, in
+// increasing order.
+Status ListSequenceNumbers(Env* env, const std::string& journal_dir,
+                           std::vector<int64_t>& sequence_numbers) {
+  std::vector<std::string> journal_files;
+  TF_RETURN_IF_ERROR(env->GetChildren(journal_dir, &journal_files));
+  sequence_numbers.clear();
+  for (const auto& file : journal_files) {
+    int64_t sequence_number;
+    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
+    sequence_numbers.push_back(sequence_number);
+  }
+  std::sort(sequence_numbers.begin(), sequence_numbers.end());
+  return OkStatus();
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -59,17 +75,12 @@ Status FileJournalWriter::EnsureInitialized() {
   if (writer_) {
     return OkStatus();
   }
-  std::vector<std::string> journal_files;
   TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(journal_dir_));
-  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
-  int64_t latest_sequence_number = -1;
-  for (const auto& file : journal_files) {
-    int64_t sequence_number;
-    TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
-    latest_sequence_number = std::max(latest_sequence_number, sequence_number);
-  }
+  std::vector<int64_t> sequence_numbers;
+  TF_RETURN_IF_ERROR(ListSequenceNumbers(env_, journal_dir_, sequence_numbers));
+  sequence_number_ = sequence_numbers.empty() ? 0 : sequence_numbers.back() + 1;
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number_);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
   VLOG(1) << "Created journal writer to write to " << journal_file;
@@ -92,6 +103,35 @@ Status FileJournalWriter::Write(const Update& update) {
   return OkStatus();
 }
 
+Status FileJournalWriter::WriteCheckpoint(const Update& checkpoint) {
+  if (writer_) {
+    TF_RETURN_IF_ERROR(writer_->Close());
+    TF_RETURN_IF_ERROR(file_->Close());
+    writer_.reset();
+    file_.reset();
+  }
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  TF_RETURN_IF_ERROR(Write(checkpoint));
+  // If the dispatcher fails before the old files are deleted, they are
+  // replayed before the checkpoint, which then replaces the state they built.
+  return DeleteOldFiles();
+}
+
+Status FileJournalWriter::DeleteOldFiles() {
+  std::vector<int64_t> sequence_numbers;
+  TF_RETURN_IF_ERROR(ListSequenceNumbers(env_, journal_dir_, sequence_numbers));
+  for (int64_t sequence_number : sequence_numbers) {
+    if (sequence_number >= sequence_number_) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(env_->DeleteFile(
+        DataServiceJournalFile(journal_dir_, sequence_number)));
+  }
+  VLOG(1) << "Deleted journal files before "
+          << DataServiceJournalFile(journal_dir_, sequence_number_);
+  return OkStatus();
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -99,7 +139,14 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return OkStatus();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  std::vector<int64_t> sequence_numbers;
+  TF_RETURN_IF_ERROR(ListSequenceNumbers(env_, journal_dir_, sequence_numbers));
+  if (sequence_numbers.empty()) {
+    return errors::NotFound("No journal file found in ", journal_dir_);
+  }
+  // Earlier journal files may have been deleted after a checkpoint.
+  sequence_number_ = sequence_numbers.front();
+  return UpdateFile(DataServiceJournalFile(journal_dir_, sequence_number_));
 }
 
 Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
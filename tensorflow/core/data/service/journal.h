@@ -39,6 +39,10 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Writes and syncs an update with a checkpoint of the whole state to the
+  // journal. The updates written before it are no longer needed to restore the
+  // state, so the writer may discard them.
+  virtual Status WriteCheckpoint(const Update& checkpoint) = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -57,6 +61,9 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// A checkpoint is written to the beginning of a new journal file, after which
+// the previous journal files are deleted.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -68,10 +75,16 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  Status WriteCheckpoint(const Update& checkpoint) override;
 
  private:
+  // Deletes the journal files before the current one.
+  Status DeleteOldFiles();
+
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of the current journal file.
+  int64_t sequence_number_ = 0;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -89,7 +102,8 @@ class JournalReader {
 // used by multiple threads.
 //
 // The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// directory, in order of their sequence numbers, starting from the lowest one.
+// See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
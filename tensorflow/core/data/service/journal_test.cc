@@ -32,6 +32,7 @@ namespace tensorflow {
 namespace data {
 
 namespace {
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 bool NewJournalDir(std::string& journal_dir) {
@@ -115,6 +116,30 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, WriteCheckpoint) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_EXPECT_OK(writer.Write(MakeCreateIterationUpdate()));
+    TF_EXPECT_OK(writer.Write(MakeRegisterDatasetUpdate()));
+  }
+  Update checkpoint;
+  checkpoint.mutable_checkpoint()->set_next_available_task_id(9);
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_EXPECT_OK(writer.WriteCheckpoint(checkpoint));
+  TF_EXPECT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  // The journal files written before the checkpoint are deleted.
+  std::vector<std::string> journal_files;
+  TF_EXPECT_OK(Env::Default()->GetChildren(journal_dir, &journal_files));
+  EXPECT_THAT(journal_files, ElementsAre(io::Basename(
+                                 DataServiceJournalFile(journal_dir, 2))));
+  TF_EXPECT_OK(
+      CheckJournalContent(journal_dir, {checkpoint, MakeFinishTaskUpdate()}));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -0,0 +1,923 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/url.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint64_t kSegmentMagic = 0x7466646174617368;  // "tfdatash"
+constexpr uint32_t kSegmentVersion = 1;
+constexpr size_t kMaxRequestBytes = 4096;
+constexpr size_t kMaxMessageBytes = 4096;
+// Alignment of the slots, and of the tensor contents in the ring buffers.
+constexpr size_t kAlignment = 64;
+// How often blocked server threads and clients check that their peer is
+// still alive.
+constexpr int64_t kPollIntervalMicros = 100 * 1000;
+constexpr int kMaxPortAttempts = 100;
+constexpr uint64_t kMaxPort = 1 << 30;
+
+enum SlotState : uint32_t { kSlotFree = 0, kSlotClaimed = 1 };
+enum ElementLocation : uint32_t { kNoElement = 0, kRing = 1, kOverflow = 2 };
+enum ElementKind : uint32_t { kCompressed = 0, kUncompressed = 1 };
+
+// Layout of a server segment: a SegmentHeader, then `num_slots` slots of
+// `slot_bytes` bytes, each made of a SlotControl and its ring buffer.
+struct SegmentHeader {
+  uint64_t magic;
+  uint32_t version;
+  int32_t num_slots;
+  uint64_t slot_bytes;
+  uint64_t buffer_bytes;
+  int64_t server_pid;
+  std::atomic<uint32_t> shutdown;
+};
+
+// Mailbox of a slot, guarded by `mu`. Both sides broadcast `cv` whenever they
+// update it.
+struct SlotControl {
+  pthread_mutex_t mu;
+  pthread_cond_t cv;
+  uint32_t state;
+  int64_t client_pid;
+  // Incremented each time a client claims the slot, so that the responses to
+  // the requests of a previous client are dropped.
+  uint64_t generation;
+
+  // Request, written by the client.
+  uint64_t request_id;
+  uint32_t request_bytes;
+  char request[kMaxRequestBytes];
+
+  // Response, written by the server.
+  uint64_t response_id;
+  int32_t status_code;
+  uint32_t message_bytes;
+  char message[kMaxMessageBytes];
+  uint32_t end_of_sequence;
+  uint32_t skip;
+  int64_t element_index;
+  uint32_t location;
+  uint64_t element_offset;
+  uint64_t element_bytes;
+  // Ring buffer position right after the element.
+  uint64_t element_end;
+  uint64_t overflow_id;
+
+  // Ring buffer positions, as running byte counts. The server appends at
+  // `write_pos`; the client advances `release_pos` past the elements it no
+  // longer references.
+  uint64_t write_pos;
+  uint64_t release_pos;
+};
+
+// Serialized element:
+//   ElementHeader
+//   ComponentHeader[num_components]
+//   metadata of each component
+//   content of each component that is not part of its metadata
+// Compressed elements have a single component, whose metadata is the
+// serialized CompressedElement. The metadata of uncompressed components is a
+// TensorProto holding the dtype and the shape, and the content of the tensors
+// that cannot be memcpy-ed. All offsets are relative to the ElementHeader.
+struct ElementHeader {
+  uint32_t kind;
+  uint32_t num_components;
+};
+
+struct ComponentHeader {
+  uint64_t metadata_offset;
+  uint64_t metadata_bytes;
+  uint64_t content_offset;
+  uint64_t content_bytes;
+};
+
+size_t RoundUp(size_t n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+std::string SegmentName(int port) {
+  return absl::StrCat("/tf_data_shm_", port);
+}
+
+std::string OverflowSegmentName(int port, int slot, uint64_t id) {
+  return absl::StrCat(SegmentName(port), "_", slot, "_", id);
+}
+
+bool ProcessAlive(int64_t pid) { return kill(pid, 0) == 0 || errno == EPERM; }
+
+// A mapping of a POSIX shared memory object.
+class MappedRegion {
+ public:
+  // Creates the shared memory object `name` of `size` bytes. Returns
+  // AlreadyExists if it exists already.
+  static StatusOr<std::unique_ptr<MappedRegion>> Create(const std::string& name,
+                                                        size_t size) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("Failed to create ", name), errno);
+    }
+    if (ftruncate(fd, size) != 0) {
+      Status s = errors::IOError(absl::StrCat("Failed to size ", name), errno);
+      close(fd);
+      shm_unlink(name.c_str());
+      return s;
+    }
+    StatusOr<std::unique_ptr<MappedRegion>> region = Map(name, fd, size);
+    if (!region.ok()) {
+      shm_unlink(name.c_str());
+    }
+    return region;
+  }
+
+  // Maps the existing shared memory object `name`.
+  static StatusOr<std::unique_ptr<MappedRegion>> Open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      return errors::IOError(absl::StrCat("Failed to open ", name), errno);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      Status s = errors::IOError(absl::StrCat("Failed to stat ", name), errno);
+      close(fd);
+      return s;
+    }
+    return Map(name, fd, st.st_size);
+  }
+
+  ~MappedRegion() { munmap(data_, size_); }
+  MappedRegion(const MappedRegion&) = delete;
+  MappedRegion& operator=(const MappedRegion&) = delete;
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedRegion(char* data, size_t size) : data_(data), size_(size) {}
+
+  // Maps `size` bytes of `fd`, and closes it.
+  static StatusOr<std::unique_ptr<MappedRegion>> Map(const std::string& name,
+                                                     int fd, size_t size) {
+    void* data = size == 0 ? MAP_FAILED
+                           : mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED, fd, 0);
+    int mmap_errno = size == 0 ? EINVAL : errno;
+    close(fd);
+    if (data == MAP_FAILED) {
+      return errors::IOError(absl::StrCat("Failed to map ", name), mmap_errno);
+    }
+    return absl::WrapUnique(new MappedRegion(static_cast<char*>(data), size));
+  }
+
+  char* const data_;
+  const size_t size_;
+};
+
+SegmentHeader* GetHeader(const MappedRegion& region) {
+  return reinterpret_cast<SegmentHeader*>(region.data());
+}
+
+SlotControl* GetSlot(const MappedRegion& region, int index) {
+  const SegmentHeader* header = GetHeader(region);
+  return reinterpret_cast<SlotControl*>(region.data() +
+                                        RoundUp(sizeof(SegmentHeader)) +
+                                        index * header->slot_bytes);
+}
+
+char* GetRingBuffer(SlotControl* slot) {
+  return reinterpret_cast<char*>(slot) + RoundUp(sizeof(SlotControl));
+}
+
+// Locks the robust, process-shared mutex of a slot. If its owner died while
+// holding it, the mutex is marked consistent again: the peer liveness checks
+// take care of resetting the slot.
+class SlotLock {
+ public:
+  explicit SlotLock(SlotControl* slot) : slot_(slot) {
+    if (pthread_mutex_lock(&slot_->mu) == EOWNERDEAD) {
+      pthread_mutex_consistent(&slot_->mu);
+    }
+  }
+  ~SlotLock() { pthread_mutex_unlock(&slot_->mu); }
+  SlotLock(const SlotLock&) = delete;
+  SlotLock& operator=(const SlotLock&) = delete;
+
+  // Waits for an update of the slot, for at most kPollIntervalMicros.
+  void Wait() {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += kPollIntervalMicros * 1000;
+    deadline.tv_sec += deadline.tv_nsec / 1000000000;
+    deadline.tv_nsec %= 1000000000;
+    if (pthread_cond_timedwait(&slot_->cv, &slot_->mu, &deadline) ==
+        EOWNERDEAD) {
+      pthread_mutex_consistent(&slot_->mu);
+    }
+  }
+
+  void NotifyAll() { pthread_cond_broadcast(&slot_->cv); }
+
+ private:
+  SlotControl* const slot_;
+};
+
+Status InitSlot(SlotControl* slot) {
+  new (slot) SlotControl();
+  pthread_mutexattr_t mutex_attr;
+  pthread_mutexattr_init(&mutex_attr);
+  pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+  int err = pthread_mutex_init(&slot->mu, &mutex_attr);
+  pthread_mutexattr_destroy(&mutex_attr);
+  if (err != 0) {
+    return errors::IOError("Failed to initialize a shared mutex", err);
+  }
+  pthread_condattr_t cond_attr;
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  err = pthread_cond_init(&slot->cv, &cond_attr);
+  pthread_condattr_destroy(&cond_attr);
+  if (err != 0) {
+    return errors::IOError("Failed to initialize a shared condition variable",
+                           err);
+  }
+  return OkStatus();
+}
+
+// Serializes the components of an element into shared memory.
+class ElementWriter {
+ public:
+  explicit ElementWriter(const std::vector<Tensor>& components)
+      : components_(components) {}
+
+  Status Init() {
+    if (components_.size() == 1 && components_[0].dtype() == DT_VARIANT &&
+        TensorShapeUtils::IsScalar(components_[0].shape())) {
+      const Variant& variant = components_[0].scalar<Variant>()();
+      const CompressedElement* compressed = variant.get<CompressedElement>();
+      if (compressed == nullptr) {
+        return errors::FailedPrecondition(
+            "Expected dataset to produce a CompressedElement variant tensor, "
+            "but it produced ",
+            variant.TypeName());
+      }
+      kind_ = kCompressed;
+      metadata_.push_back(compressed->SerializeAsString());
+    } else {
+      kind_ = kUncompressed;
+      for (const Tensor& component : components_) {
+        TensorProto proto;
+        if (DataTypeCanUseMemcpy(component.dtype())) {
+          proto.set_dtype(component.dtype());
+          component.shape().AsProto(proto.mutable_tensor_shape());
+        } else {
+          component.AsProtoTensorContent(&proto);
+        }
+        metadata_.push_back(proto.SerializeAsString());
+      }
+    }
+
+    headers_.resize(metadata_.size());
+    size_ = RoundUp(sizeof(ElementHeader) +
+                    headers_.size() * sizeof(ComponentHeader));
+    for (size_t i = 0; i < headers_.size(); ++i) {
+      headers_[i].metadata_offset = size_;
+      headers_[i].metadata_bytes = metadata_[i].size();
+      size_ += metadata_[i].size();
+    }
+    size_ = RoundUp(size_);
+    if (kind_ == kUncompressed) {
+      for (size_t i = 0; i < headers_.size(); ++i) {
+        if (!DataTypeCanUseMemcpy(components_[i].dtype())) {
+          continue;
+        }
+        headers_[i].content_offset = size_;
+        headers_[i].content_bytes = components_[i].tensor_data().size();
+        size_ = RoundUp(size_ + headers_[i].content_bytes);
+      }
+    }
+    return OkStatus();
+  }
+
+  // Size of the serialized element.
+  size_t size() const { return size_; }
+
+  // Writes the serialized element to `dst`, which must have room for size()
+  // bytes and be aligned to kAlignment.
+  void Write(char* dst) const {
+    ElementHeader header{kind_, static_cast<uint32_t>(headers_.size())};
+    std::memcpy(dst, &header, sizeof(header));
+    std::memcpy(dst + sizeof(header), headers_.data(),
+                headers_.size() * sizeof(ComponentHeader));
+    for (size_t i = 0; i < headers_.size(); ++i) {
+      std::memcpy(dst + headers_[i].metadata_offset, metadata_[i].data(),
+                  metadata_[i].size());
+      if (headers_[i].content_bytes > 0) {
+        std::memcpy(dst + headers_[i].content_offset,
+                    components_[i].tensor_data().data(),
+                    headers_[i].content_bytes);
+      }
+    }
+  }
+
+ private:
+  const std::vector<Tensor>& components_;
+  uint32_t kind_ = kUncompressed;
+  std::vector<std::string> metadata_;
+  std::vector<ComponentHeader> headers_;
+  size_t size_ = 0;
+};
+
+// Tensor buffer pointing to the content of a tensor in shared memory. `owner`
+// keeps the memory from being reused while the tensor is alive.
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(void* data, size_t size, std::shared_ptr<const void> owner)
+      : TensorBuffer(data), size_(size), owner_(std::move(owner)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shm_data_transfer");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<const void> owner_;
+};
+
+// Parses the serialized element of `size` bytes at `data`. The uncompressed
+// tensors reference `data` and hold on to `owner`.
+Status ReadElement(char* data, size_t size,
+                   const std::shared_ptr<const void>& owner,
+                   std::vector<Tensor>& components) {
+  ElementHeader header;
+  if (size < sizeof(header)) {
+    return errors::DataLoss("Truncated shared memory element.");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (sizeof(header) + header.num_components * sizeof(ComponentHeader) >
+      size) {
+    return errors::DataLoss("Truncated shared memory element.");
+  }
+  std::vector<ComponentHeader> headers(header.num_components);
+  std::memcpy(headers.data(), data + sizeof(header),
+              headers.size() * sizeof(ComponentHeader));
+  for (const ComponentHeader& component : headers) {
+    if (component.metadata_offset + component.metadata_bytes > size ||
+        component.content_offset + component.content_bytes > size) {
+      return errors::DataLoss("Corrupted shared memory element.");
+    }
+  }
+
+  if (header.kind == kCompressed) {
+    if (headers.size() != 1) {
+      return errors::DataLoss("Corrupted shared memory element.");
+    }
+    CompressedElement compressed;
+    if (!compressed.ParseFromArray(data + headers[0].metadata_offset,
+                                   headers[0].metadata_bytes)) {
+      return errors::Internal("Failed to parse compressed element.");
+    }
+    Tensor tensor(DT_VARIANT, TensorShape{});
+    tensor.scalar<Variant>()() = std::move(compressed);
+    components.push_back(tensor);
+    return OkStatus();
+  }
+
+  for (const ComponentHeader& component : headers) {
+    TensorProto proto;
+    if (!proto.ParseFromArray(data + component.metadata_offset,
+                              component.metadata_bytes)) {
+      return errors::Internal("Failed to parse tensor.");
+    }
+    if (!DataTypeCanUseMemcpy(proto.dtype())) {
+      components.emplace_back();
+      if (!components.back().FromProto(proto)) {
+        return errors::Internal("Failed to parse tensor.");
+      }
+      continue;
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShape(proto.tensor_shape(), &shape));
+    if (static_cast<uint64_t>(shape.num_elements()) *
+            DataTypeSize(proto.dtype()) !=
+        component.content_bytes) {
+      return errors::DataLoss("Corrupted shared memory tensor.");
+    }
+    auto* buffer = new ShmTensorBuffer(data + component.content_offset,
+                                       component.content_bytes, owner);
+    components.push_back(Tensor(proto.dtype(), shape, buffer));
+    buffer->Unref();
+  }
+  return OkStatus();
+}
+
+// Client side of a slot. The tensors handed out by the client share ownership
+// of the channel, so that the slot is only freed, and its ring buffer reused
+// by another client, once they are all destroyed.
+class ShmChannel : public std::enable_shared_from_this<ShmChannel> {
+ public:
+  // Claims a free slot of the server listening on `port`.
+  static StatusOr<std::shared_ptr<ShmChannel>> Connect(int port) {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<MappedRegion> region,
+                        MappedRegion::Open(SegmentName(port)));
+    const SegmentHeader* header = GetHeader(*region);
+    if (region->size() < sizeof(SegmentHeader) ||
+        header->magic != kSegmentMagic || header->version != kSegmentVersion) {
+      return errors::FailedPrecondition(
+          "Shared memory segment ", SegmentName(port),
+          " does not belong to a compatible tf.data data transfer server.");
+    }
+    for (int i = 0; i < header->num_slots; ++i) {
+      SlotControl* slot = GetSlot(*region, i);
+      SlotLock l(slot);
+      if (slot->state != kSlotFree) {
+        continue;
+      }
+      slot->state = kSlotClaimed;
+      slot->client_pid = getpid();
+      ++slot->generation;
+      slot->request_id = 0;
+      slot->response_id = 0;
+      slot->write_pos = 0;
+      slot->release_pos = 0;
+      l.NotifyAll();
+      return std::shared_ptr<ShmChannel>(
+          new ShmChannel(port, i, std::move(region)));
+    }
+    return errors::Unavailable("All ", header->num_slots,
+                               " slots of shared memory data transfer server ",
+                               port, " are in use.");
+  }
+
+  ~ShmChannel() {
+    SlotLock l(slot_);
+    slot_->state = kSlotFree;
+    l.NotifyAll();
+  }
+
+  Status GetElement(const GetElementRequest& req, GetElementResult& result,
+                    const std::atomic<bool>& cancelled) {
+    std::string request = req.SerializeAsString();
+    if (request.size() > kMaxRequestBytes) {
+      return errors::InvalidArgument("GetElement request of ", request.size(),
+                                     " bytes exceeds the ", kMaxRequestBytes,
+                                     " bytes supported over shared memory.");
+    }
+    const uint64_t request_id = ++last_request_id_;
+    SlotControl response;
+    {
+      SlotLock l(slot_);
+      std::memcpy(slot_->request, request.data(), request.size());
+      slot_->request_bytes = request.size();
+      slot_->request_id = request_id;
+      l.NotifyAll();
+      while (slot_->response_id != request_id) {
+        if (cancelled) {
+          return errors::Cancelled("Client was cancelled.");
+        }
+        if (header_->shutdown || !ProcessAlive(header_->server_pid)) {
+          return errors::Unavailable("Shared memory data transfer server ",
+                                     port_, " is no longer available.");
+        }
+        l.Wait();
+      }
+      response.status_code = slot_->status_code;
+      response.message_bytes = slot_->message_bytes;
+      std::memcpy(response.message, slot_->message, slot_->message_bytes);
+      response.end_of_sequence = slot_->end_of_sequence;
+      response.skip = slot_->skip;
+      response.element_index = slot_->element_index;
+      response.location = slot_->location;
+      response.element_offset = slot_->element_offset;
+      response.element_bytes = slot_->element_bytes;
+      response.element_end = slot_->element_end;
+      response.overflow_id = slot_->overflow_id;
+    }
+
+    if (response.status_code !=
+        static_cast<int32_t>(absl::StatusCode::kOk)) {
+      return Status(static_cast<absl::StatusCode>(response.status_code),
+                    absl::string_view(response.message,
+                                      response.message_bytes));
+    }
+    result.end_of_sequence = response.end_of_sequence;
+    result.skip = response.skip;
+    result.element_index = response.element_index;
+    switch (response.location) {
+      case kRing: {
+        auto region = std::make_shared<RingRegion>(shared_from_this(),
+                                                   response.element_end);
+        return ReadElement(GetRingBuffer(slot_) + response.element_offset,
+                           response.element_bytes, region, result.components);
+      }
+      case kOverflow: {
+        // The server removes the segment once it gets the next request; it is
+        // removed right away to not leak it if the server dies first.
+        std::string name =
+            OverflowSegmentName(port_, index_, response.overflow_id);
+        TF_ASSIGN_OR_RETURN(std::shared_ptr<MappedRegion> region,
+                            MappedRegion::Open(name));
+        shm_unlink(name.c_str());
+        if (region->size() < response.element_bytes) {
+          return errors::DataLoss("Truncated shared memory element.");
+        }
+        return ReadElement(region->data(), response.element_bytes, region,
+                           result.components);
+      }
+      default:
+        return OkStatus();
+    }
+  }
+
+ private:
+  // An element in the ring buffer, released on destruction.
+  class RingRegion {
+   public:
+    RingRegion(std::shared_ptr<ShmChannel> channel, uint64_t end)
+        : channel_(std::move(channel)), end_(end) {
+      channel_->Acquire(end_);
+    }
+    ~RingRegion() { channel_->Release(end_); }
+
+   private:
+    const std::shared_ptr<ShmChannel> channel_;
+    const uint64_t end_;
+  };
+
+  ShmChannel(int port, int index, std::unique_ptr<MappedRegion> region)
+      : port_(port),
+        index_(index),
+        region_(std::move(region)),
+        header_(GetHeader(*region_)),
+        slot_(GetSlot(*region_, index)) {}
+
+  void Acquire(uint64_t end) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    regions_.push_back({end, /*released=*/false});
+  }
+
+  // Marks the element ending at `end` as released, and hands the ring buffer
+  // space back to the server up to the oldest element still referenced.
+  void Release(uint64_t end) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    for (auto& region : regions_) {
+      if (region.first == end) {
+        region.second = true;
+        break;
+      }
+    }
+    uint64_t release_pos = 0;
+    while (!regions_.empty() && regions_.front().second) {
+      release_pos = regions_.front().first;
+      regions_.pop_front();
+    }
+    if (release_pos > 0) {
+      SlotLock slot_lock(slot_);
+      slot_->release_pos = release_pos;
+      slot_lock.NotifyAll();
+    }
+  }
+
+  const int port_;
+  const int index_;
+  const std::unique_ptr<MappedRegion> region_;
+  SegmentHeader* const header_;
+  SlotControl* const slot_;
+  uint64_t last_request_id_ = 0;
+
+  mutex mu_;
+  // End positions of the elements handed out, in ring buffer order, and
+  // whether they have been released.
+  std::deque<std::pair<uint64_t, bool>> regions_ TF_GUARDED_BY(mu_);
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  explicit ShmDataTransferClient(std::shared_ptr<ShmChannel> channel)
+      : channel_(std::move(channel)) {}
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id()
+            << " from shared memory worker server.";
+    if (cancelled_) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    return channel_->GetElement(req, result, cancelled_);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    cancelled_ = true;
+  }
+
+  Status CheckCompatibility(
+      const std::string& compatibility_info) const override {
+    if (compatibility_info != port::Hostname()) {
+      return errors::FailedPrecondition(
+          "Shared memory data transfer requires the tf.data service worker to "
+          "run on the same host as the client, but the worker runs on ",
+          compatibility_info, " and the client on ", port::Hostname(), ".");
+    }
+    return OkStatus();
+  }
+
+ private:
+  const std::shared_ptr<ShmChannel> channel_;
+  std::atomic<bool> cancelled_ = false;
+};
+
+}  // namespace
+
+struct ShmDataTransferServer::Segment {
+  std::unique_ptr<MappedRegion> region;
+};
+
+StatusOr<ShmDataTransferServer::Options>
+ShmDataTransferServer::OptionsFromEnv() {
+  Options options;
+  int64_t num_slots, buffer_bytes;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_SHM_TRANSFER_SLOTS",
+                                         options.num_slots, &num_slots));
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_SHM_TRANSFER_BUFFER_BYTES",
+                                         options.buffer_bytes, &buffer_bytes));
+  options.num_slots = num_slots;
+  options.buffer_bytes = buffer_bytes;
+  return options;
+}
+
+ShmDataTransferServer::ShmDataTransferServer(GetElementT get_element,
+                                             const Options& options)
+    : get_element_(std::move(get_element)), options_(options) {}
+
+ShmDataTransferServer::~ShmDataTransferServer() {
+  cancelled_ = true;
+  if (segment_ == nullptr) {
+    return;
+  }
+  GetHeader(*segment_->region)->shutdown = 1;
+  for (int i = 0; i < options_.num_slots; ++i) {
+    SlotLock l(GetSlot(*segment_->region, i));
+    l.NotifyAll();
+  }
+  threads_.clear();
+  shm_unlink(segment_name_.c_str());
+}
+
+Status ShmDataTransferServer::Start() {
+  if (options_.num_slots <= 0 || options_.buffer_bytes == 0) {
+    return errors::InvalidArgument(
+        "Shared memory data transfer server needs at least one slot and a "
+        "non-empty buffer, got ",
+        options_.num_slots, " slots of ", options_.buffer_bytes, " bytes.");
+  }
+  const size_t buffer_bytes = RoundUp(options_.buffer_bytes);
+  const size_t slot_bytes = RoundUp(sizeof(SlotControl)) + buffer_bytes;
+  const size_t size =
+      RoundUp(sizeof(SegmentHeader)) + options_.num_slots * slot_bytes;
+  std::unique_ptr<MappedRegion> region;
+  for (int attempt = 1; region == nullptr; ++attempt) {
+    port_ = 1 + random::New64() % kMaxPort;
+    segment_name_ = SegmentName(port_);
+    StatusOr<std::unique_ptr<MappedRegion>> created =
+        MappedRegion::Create(segment_name_, size);
+    if (errors::IsAlreadyExists(created.status()) &&
+        attempt < kMaxPortAttempts) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(created.status());
+    region = std::move(created).value();
+  }
+  segment_ = std::make_unique<Segment>();
+  segment_->region = std::move(region);
+
+  SegmentHeader* header = new (segment_->region->data()) SegmentHeader();
+  header->version = kSegmentVersion;
+  header->num_slots = options_.num_slots;
+  header->slot_bytes = slot_bytes;
+  header->buffer_bytes = buffer_bytes;
+  header->server_pid = getpid();
+  for (int i = 0; i < options_.num_slots; ++i) {
+    TF_RETURN_IF_ERROR(InitSlot(GetSlot(*segment_->region, i)));
+  }
+  header->magic = kSegmentMagic;
+
+  for (int i = 0; i < options_.num_slots; ++i) {
+    threads_.push_back(absl::WrapUnique(Env::Default()->StartThread(
+        {}, absl::StrCat("tf_data_shm_transfer_", i),
+        [this, i] { ServeSlot(i); })));
+  }
+  VLOG(1) << "Started shared memory data transfer server " << segment_name_;
+  return OkStatus();
+}
+
+StatusOr<std::string> ShmDataTransferServer::GetCompatibilityInfo() const {
+  return port::Hostname();
+}
+
+void ShmDataTransferServer::ServeSlot(int index) {
+  SlotControl* slot = GetSlot(*segment_->region, index);
+  const uint64_t capacity = GetHeader(*segment_->region)->buffer_bytes;
+  // Dedicated segment holding the last element that did not fit in the ring
+  // buffer. It is removed once the client sends its next request, by which
+  // time the client has mapped it.
+  std::string overflow_segment;
+  auto remove_overflow_segment = [&overflow_segment] {
+    if (!overflow_segment.empty()) {
+      shm_unlink(overflow_segment.c_str());
+      overflow_segment.clear();
+    }
+  };
+
+  while (true) {
+    GetElementRequest request;
+    uint64_t generation, request_id;
+    bool parsed;
+    {
+      SlotLock l(slot);
+      while (slot->state != kSlotClaimed ||
+             slot->request_id == slot->response_id) {
+        if (cancelled_) {
+          remove_overflow_segment();
+          return;
+        }
+        if (slot->state == kSlotClaimed && !ProcessAlive(slot->client_pid)) {
+          VLOG(2) << "Client " << slot->client_pid << " of shared memory "
+                  << "transfer slot " << index << " exited.";
+          slot->state = kSlotFree;
+        }
+        l.Wait();
+      }
+      generation = slot->generation;
+      request_id = slot->request_id;
+      parsed = request.ParseFromArray(slot->request, slot->request_bytes);
+    }
+    remove_overflow_segment();
+
+    GetElementResult result;
+    Status s = parsed ? get_element_(&request, &result)
+                      : errors::Internal("Failed to parse GetElement request.");
+    ElementWriter writer(result.components);
+    if (s.ok() && !result.components.empty()) {
+      s = writer.Init();
+    }
+
+    // Places the element in the ring buffer if there is room for it past the
+    // elements the client still references, or in a dedicated segment.
+    uint32_t location = kNoElement;
+    uint64_t offset = 0, end = 0, overflow_id = 0;
+    if (s.ok() && !result.components.empty()) {
+      uint64_t write_pos, release_pos;
+      {
+        SlotLock l(slot);
+        write_pos = slot->write_pos;
+        release_pos = slot->release_pos;
+      }
+      offset = write_pos % capacity;
+      if (offset + writer.size() > capacity) {
+        write_pos += capacity - offset;
+        offset = 0;
+      }
+      if (write_pos + writer.size() - release_pos <= capacity) {
+        location = kRing;
+        end = write_pos + writer.size();
+        writer.Write(GetRingBuffer(slot) + offset);
+      } else {
+        location = kOverflow;
+        overflow_id = next_overflow_id_++;
+        std::string name = OverflowSegmentName(port_, index, overflow_id);
+        StatusOr<std::unique_ptr<MappedRegion>> region =
+            MappedRegion::Create(name, writer.size());
+        s = region.status();
+        if (s.ok()) {
+          overflow_segment = name;
+          writer.Write((*region)->data());
+        }
+      }
+    }
+
+    SlotLock l(slot);
+    if (slot->generation != generation) {
+      continue;
+    }
+    slot->status_code = static_cast<int32_t>(s.code());
+    slot->message_bytes = std::min(s.message().size(), kMaxMessageBytes);
+    std::memcpy(slot->message, s.message().data(), slot->message_bytes);
+    slot->end_of_sequence = result.end_of_sequence;
+    slot->skip = result.skip;
+    slot->element_index = result.element_index;
+    slot->location = s.ok() ? location : kNoElement;
+    slot->element_offset = offset;
+    slot->element_bytes = writer.size();
+    slot->element_end = end;
+    slot->overflow_id = overflow_id;
+    if (s.ok() && location == kRing) {
+      slot->write_pos = end;
+    }
+    slot->response_id = request_id;
+    l.NotifyAll();
+  }
+}
+
+class ShmTransferServerRegistrar {
+ public:
+  ShmTransferServerRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol, [](DataTransferServer::GetElementT get_element,
+                                 std::shared_ptr<DataTransferServer>* out) {
+          TF_ASSIGN_OR_RETURN(ShmDataTransferServer::Options options,
+                              ShmDataTransferServer::OptionsFromEnv());
+          *out = std::make_shared<ShmDataTransferServer>(std::move(get_element),
+                                                         options);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferServerRegistrar shm_server_registrar;
+
+class ShmTransferClientRegistrar {
+ public:
+  ShmTransferClientRegistrar() {
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          URL url(config.address);
+          int port;
+          if (!url.has_port() || !absl::SimpleAtoi(url.port(), &port)) {
+            return errors::InvalidArgument(
+                "Invalid shared memory data transfer address ", config.address,
+                "; expected host:port.");
+          }
+          TF_ASSIGN_OR_RETURN(std::shared_ptr<ShmChannel> channel,
+                              ShmChannel::Connect(port));
+          *out = std::make_unique<ShmDataTransferClient>(std::move(channel));
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferClientRegistrar shm_client_registrar;
+
+}  // namespace data
+}  // namespace tensorflow
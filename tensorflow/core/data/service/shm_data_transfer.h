@@ -0,0 +1,96 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for tf.data service workers colocated with their
+// trainer. Set it as the worker's `data_transfer_protocol`.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+// Data transfer server handing elements to clients on the same host through
+// POSIX shared memory.
+//
+// The server owns a shared memory segment named after its port. The segment is
+// split into `num_slots` slots, one per connected client, each holding a
+// request/response mailbox and a ring buffer of `buffer_bytes` bytes. Elements
+// are serialized straight into the ring buffer, and the client maps the
+// tensors of the element onto it without copying. Ring buffer space is only
+// reused once the client has destroyed these tensors; an element that does not
+// fit in the free space is passed in a dedicated segment instead.
+//
+// Only one request per client is in flight at a time, like for the gRPC
+// transfer client. Clients that cannot claim a slot fail to build, which makes
+// the tf.data service client fall back to gRPC.
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  struct Options {
+    // Maximum number of concurrently connected clients.
+    int num_slots = 8;
+    // Size of the ring buffer of each slot.
+    size_t buffer_bytes = 64 << 20;
+  };
+
+  // Reads the options from the TF_DATA_SHM_TRANSFER_SLOTS and
+  // TF_DATA_SHM_TRANSFER_BUFFER_BYTES environment variables.
+  static StatusOr<Options> OptionsFromEnv();
+
+  ShmDataTransferServer(GetElementT get_element, const Options& options);
+  ~ShmDataTransferServer() override;
+  ShmDataTransferServer(const ShmDataTransferServer&) = delete;
+  ShmDataTransferServer& operator=(const ShmDataTransferServer&) = delete;
+
+  Status Start() override;
+  int get_port() override { return port_; }
+
+  // Returns the host name, as shared memory is only reachable from the host
+  // running the server.
+  StatusOr<std::string> GetCompatibilityInfo() const override;
+
+ private:
+  struct Segment;
+
+  // Serves the requests of the client connected to slot `index`.
+  void ServeSlot(int index);
+
+  const GetElementT get_element_;
+  const Options options_;
+  int port_ = 0;
+  std::string segment_name_;
+  std::unique_ptr<Segment> segment_;
+  std::atomic<bool> cancelled_ = false;
+  std::atomic<uint64_t> next_overflow_id_ = 0;
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_DATA_TRANSFER_H_
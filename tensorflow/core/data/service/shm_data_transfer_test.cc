@@ -0,0 +1,293 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_data_transfer.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Returns a function producing `elements` in order, then end of sequence.
+DataTransferServer::GetElementT ProduceElements(
+    std::vector<std::vector<Tensor>> elements) {
+  auto next_index = std::make_shared<std::atomic<size_t>>(0);
+  return [elements = std::move(elements), next_index](
+             const GetElementRequest* request, GetElementResult* result) {
+    size_t index = (*next_index)++;
+    if (index >= elements.size()) {
+      result->end_of_sequence = true;
+      return OkStatus();
+    }
+    result->components = elements[index];
+    result->element_index = index;
+    return OkStatus();
+  };
+}
+
+std::vector<Tensor> Range(int64_t size) {
+  Tensor tensor(DT_INT64, TensorShape({size}));
+  for (int64_t i = 0; i < size; ++i) {
+    tensor.vec<int64_t>()(i) = i;
+  }
+  return {tensor};
+}
+
+StatusOr<std::unique_ptr<DataTransferClient>> CreateClient(
+    DataTransferServer& server) {
+  std::unique_ptr<DataTransferClient> client;
+  TF_RETURN_IF_ERROR(DataTransferClient::Build(
+      kShmTransferProtocol,
+      {"grpc", absl::StrCat("localhost:", server.get_port())}, &client));
+  return client;
+}
+
+StatusOr<GetElementResult> GetElement(DataTransferClient& client) {
+  GetElementRequest request;
+  request.set_task_id(1);
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(client.GetElement(request, result));
+  return result;
+}
+
+TEST(ShmDataTransferTest, TransferUncompressedElements) {
+  std::vector<std::vector<Tensor>> elements = {
+      {Tensor(int64_t{1}), Tensor(tstring("a"))},
+      {Tensor(int64_t{2}), Tensor(tstring("bb"))},
+      {Tensor(int64_t{3}), Tensor(tstring("ccc"))}};
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(DataTransferServer::Build(kShmTransferProtocol,
+                                         ProduceElements(elements), &server));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+
+  for (int i = 0; i < elements.size(); ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+    EXPECT_FALSE(result.end_of_sequence);
+    EXPECT_EQ(result.element_index, i);
+    ASSERT_EQ(result.components.size(), 2);
+    test::ExpectEqual(result.components[0], elements[i][0]);
+    test::ExpectEqual(result.components[1], elements[i][1]);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  EXPECT_TRUE(result.end_of_sequence);
+  EXPECT_TRUE(result.components.empty());
+}
+
+TEST(ShmDataTransferTest, TransferCompressedElement) {
+  std::vector<Tensor> element = Range(1000);
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  Tensor variant(DT_VARIANT, TensorShape({}));
+  variant.scalar<Variant>()() = compressed;
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({{variant}}), ShmDataTransferServer::Options());
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  ASSERT_EQ(result.components.size(), 1);
+  const CompressedElement* received =
+      result.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(received, nullptr);
+  std::vector<Tensor> uncompressed;
+  TF_ASSERT_OK(UncompressElement(*received, &uncompressed));
+  ASSERT_EQ(uncompressed.size(), 1);
+  test::ExpectEqual(uncompressed[0], element[0]);
+}
+
+TEST(ShmDataTransferTest, ReuseRingBuffer) {
+  std::vector<std::vector<Tensor>> elements;
+  for (int i = 0; i < 100; ++i) {
+    elements.push_back(Range(i));
+  }
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements(elements),
+      ShmDataTransferServer::Options{/*num_slots=*/1, /*buffer_bytes=*/4096});
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+
+  for (int i = 0; i < elements.size(); ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+    ASSERT_EQ(result.components.size(), 1);
+    test::ExpectEqual(result.components[0], elements[i][0]);
+  }
+}
+
+TEST(ShmDataTransferTest, KeepReferencedElements) {
+  std::vector<std::vector<Tensor>> elements;
+  for (int i = 0; i < 100; ++i) {
+    elements.push_back(Range(i));
+  }
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements(elements),
+      ShmDataTransferServer::Options{/*num_slots=*/1, /*buffer_bytes=*/4096});
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+
+  // Once the ring buffer is full, the elements go through dedicated segments
+  // instead of overwriting the ones still referenced.
+  std::vector<GetElementResult> results;
+  for (int i = 0; i < elements.size(); ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+    results.push_back(std::move(result));
+  }
+  for (int i = 0; i < elements.size(); ++i) {
+    ASSERT_EQ(results[i].components.size(), 1);
+    test::ExpectEqual(results[i].components[0], elements[i][0]);
+  }
+}
+
+TEST(ShmDataTransferTest, ElementLargerThanRingBuffer) {
+  std::vector<Tensor> element = Range(100000);
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({element}),
+      ShmDataTransferServer::Options{/*num_slots=*/1, /*buffer_bytes=*/1024});
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], element[0]);
+}
+
+TEST(ShmDataTransferTest, TensorsOutliveClient) {
+  std::vector<Tensor> element = Range(1000);
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({element, element}),
+      ShmDataTransferServer::Options{/*num_slots=*/1, /*buffer_bytes=*/65536});
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result, GetElement(*client));
+  client.reset();
+
+  // The slot stays claimed while the tensors reference its ring buffer.
+  EXPECT_THAT(CreateClient(*server), StatusIs(error::UNAVAILABLE));
+  test::ExpectEqual(result.components[0], element[0]);
+  result.components.clear();
+  TF_EXPECT_OK(CreateClient(*server).status());
+}
+
+TEST(ShmDataTransferTest, PropagateErrors) {
+  std::shared_ptr<DataTransferServer> server;
+  TF_ASSERT_OK(DataTransferServer::Build(
+      kShmTransferProtocol,
+      [](const GetElementRequest* request, GetElementResult* result) {
+        return errors::NotFound("Task ", request->task_id(), " not found.");
+      },
+      &server));
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+  EXPECT_THAT(GetElement(*client),
+              StatusIs(error::NOT_FOUND, HasSubstr("Task 1 not found.")));
+}
+
+TEST(ShmDataTransferTest, AllSlotsInUse) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({}), ShmDataTransferServer::Options{/*num_slots=*/2});
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client1,
+                          CreateClient(*server));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client2,
+                          CreateClient(*server));
+  EXPECT_THAT(CreateClient(*server), StatusIs(error::UNAVAILABLE));
+  client1.reset();
+  TF_EXPECT_OK(CreateClient(*server).status());
+}
+
+TEST(ShmDataTransferTest, ServerUnavailable) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({}), ShmDataTransferServer::Options());
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+  int port = server->get_port();
+  server.reset();
+
+  EXPECT_THAT(GetElement(*client), StatusIs(error::UNAVAILABLE));
+  std::unique_ptr<DataTransferClient> new_client;
+  EXPECT_FALSE(DataTransferClient::Build(kShmTransferProtocol,
+                                         {"grpc", absl::StrCat("host:", port)},
+                                         &new_client)
+                   .ok());
+}
+
+TEST(ShmDataTransferTest, CancelClient) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({Range(10)}), ShmDataTransferServer::Options());
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+  client->TryCancel();
+  EXPECT_THAT(GetElement(*client), StatusIs(error::CANCELLED));
+}
+
+TEST(ShmDataTransferTest, CheckCompatibility) {
+  auto server = std::make_shared<ShmDataTransferServer>(
+      ProduceElements({}), ShmDataTransferServer::Options());
+  TF_ASSERT_OK(server->Start());
+  TF_ASSERT_OK_AND_ASSIGN(std::string compatibility_info,
+                          server->GetCompatibilityInfo());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataTransferClient> client,
+                          CreateClient(*server));
+  TF_EXPECT_OK(client->CheckCompatibility(compatibility_info));
+  EXPECT_THAT(client->CheckCompatibility("another-host"),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("same host as the client")));
+}
+
+TEST(ShmDataTransferTest, InvalidAddress) {
+  std::unique_ptr<DataTransferClient> client;
+  EXPECT_THAT(DataTransferClient::Build(kShmTransferProtocol,
+                                        {"grpc", "localhost"}, &client),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
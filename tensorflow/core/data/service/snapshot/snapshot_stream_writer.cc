@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -51,6 +52,9 @@ namespace {
 constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
 constexpr int64_t kUnknownNumElements = -1;
 
+// Maximum number of elements buffered for each chunk writer thread.
+constexpr int64_t kMaxBufferedElementsPerChunk = 16;
+
 // Extracts the index from `filename`. If `filename` is `prefix_<index>`, this
 // returns <index>. If `filename` does not start with `prefix`, returns an
 // internal error.
@@ -67,10 +71,122 @@ StatusOr<int64_t> GetFileIndex(const std::string& filename,
 
 }  // namespace
 
+class SnapshotStreamWriter::ChunkWriter {
+ public:
+  ChunkWriter(const std::string& chunk_file_path,
+              const std::string& compression)
+      : writer_(chunk_file_path, compression) {}
+
+  ~ChunkWriter() { StopThread(); }
+
+  // Opens the chunk file and starts the writer thread.
+  Status Initialize(Env* env, int64_t chunk_index) {
+    TF_RETURN_IF_ERROR(writer_.Initialize(env));
+    thread_ = absl::WrapUnique(env->StartThread(
+        /*thread_options=*/{},
+        /*name=*/absl::StrCat("tf_data_service_snapshot_chunk_", chunk_index),
+        [this]() { WriterThread(); }));
+    return OkStatus();
+  }
+
+  // Buffers `element` to be written. Blocks while the buffer is full. Returns
+  // the error of the writer thread if it has failed.
+  Status Write(std::vector<Tensor> element, int64_t element_size_bytes)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    while (status_.ok() && buffer_.size() >= kMaxBufferedElementsPerChunk) {
+      cv_.wait(l);
+    }
+    TF_RETURN_IF_ERROR(status_);
+    buffer_.push_back(std::move(element));
+    size_bytes_ += element_size_bytes;
+    ++num_elements_;
+    cv_.notify_all();
+    return OkStatus();
+  }
+
+  // Waits for the buffered elements to be written and closes the chunk file.
+  Status Close() {
+    StopThread();
+    {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(status_);
+    }
+    return writer_.Close();
+  }
+
+  int64_t size_bytes() const TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    return size_bytes_;
+  }
+
+  int64_t num_elements() const TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    return num_elements_;
+  }
+
+ private:
+  void WriterThread() TF_LOCKS_EXCLUDED(mu_) {
+    while (true) {
+      std::vector<Tensor> element;
+      {
+        mutex_lock l(mu_);
+        while (buffer_.empty() && !done_) {
+          cv_.wait(l);
+        }
+        if (buffer_.empty()) {
+          return;
+        }
+        element = std::move(buffer_.front());
+        buffer_.pop_front();
+        cv_.notify_all();
+      }
+      tsl::profiler::TraceMe activity("SnapshotWriteRecord",
+                                      tsl::profiler::TraceMeLevel::kInfo);
+      Status status = writer_.WriteTensors(element);
+      if (!status.ok()) {
+        mutex_lock l(mu_);
+        status_ = std::move(status);
+        buffer_.clear();
+        cv_.notify_all();
+        return;
+      }
+    }
+  }
+
+  // Signals the writer thread to finish once the buffer is drained and waits
+  // for it.
+  void StopThread() TF_LOCKS_EXCLUDED(mu_) {
+    {
+      mutex_lock l(mu_);
+      done_ = true;
+      cv_.notify_all();
+    }
+    thread_.reset();
+  }
+
+  snapshot_util::TFRecordWriter writer_;
+
+  mutable mutex mu_;
+  condition_variable cv_;
+  std::deque<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+  bool done_ TF_GUARDED_BY(mu_) = false;
+  Status status_ TF_GUARDED_BY(mu_);
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
+
+  // Must be destroyed before the other members, since the writer thread uses
+  // them.
+  std::unique_ptr<Thread> thread_;
+};
+
 SnapshotStreamWriter::SnapshotStreamWriter(
     const SnapshotWriterParams& params, std::unique_ptr<TaskIterator> iterator)
-    : params_(params), iterator_(std::move(iterator)) {
+    : params_(params),
+      iterator_(std::move(iterator)),
+      chunk_size_target_bytes_(params_.max_chunk_size_bytes) {
   DCHECK_NE(iterator_.get(), nullptr);
+  DCHECK_GT(params_.num_writer_threads, 0);
   last_checkpoint_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   snapshot_thread_ = absl::WrapUnique(params_.env->StartThread(
       /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_thread",
@@ -112,7 +228,7 @@ Status SnapshotStreamWriter::WriteSnapshot() TF_LOCKS_EXCLUDED(mu_) {
   TF_RETURN_IF_ERROR(InitializeDirectories());
   TF_RETURN_IF_ERROR(Restore());
   while (ShouldWriteChunk()) {
-    TF_RETURN_IF_ERROR(WriteChunk());
+    TF_RETURN_IF_ERROR(WriteChunks());
   }
   mutex_lock l(mu_);
   return completed_.status();
@@ -137,70 +253,136 @@ bool SnapshotStreamWriter::ShouldWriteChunk() const TF_LOCKS_EXCLUDED(mu_) {
   return !end_of_sequence_ && completed_.ok();
 }
 
-Status SnapshotStreamWriter::WriteChunk() {
+Status SnapshotStreamWriter::WriteChunks() {
+  const int64_t num_chunks = params_.num_writer_threads;
   LOG(INFO) << "Writing distributed tf.data snapshot " << params_.snapshot_path
-            << ", stream " << params_.stream_index << ", chunk " << chunk_index_
+            << ", stream " << params_.stream_index << ", chunks "
+            << chunk_index_ << " to " << chunk_index_ + num_chunks - 1
+            << ", target chunk size in bytes: " << chunk_size_target_bytes_
             << ".";
 
-  std::string chunk_file_path = GetChunkFilePath();
-  snapshot_util::TFRecordWriter writer(chunk_file_path, params_.compression);
-  TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
+  const absl::Time round_start_time =
+      absl::FromUnixMicros(params_.env->NowMicros());
+  std::vector<std::unique_ptr<ChunkWriter>> writers;
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    writers.push_back(std::make_unique<ChunkWriter>(
+        GetChunkFilePath(chunk_index_ + i), params_.compression));
+    TF_RETURN_IF_ERROR(
+        writers.back()->Initialize(params_.env, chunk_index_ + i));
+  }
   while (ShouldWriteRecord()) {
-    TF_RETURN_IF_ERROR(WriteRecord(writer));
+    TF_RETURN_IF_ERROR(WriteRecord(writers));
+  }
+  for (const std::unique_ptr<ChunkWriter>& writer : writers) {
+    TF_RETURN_IF_ERROR(writer->Close());
   }
-  TF_RETURN_IF_ERROR(writer.Close());
-  return CommitChunk();
+  UpdateChunkSizeTarget(round_start_time);
+  return CommitChunks(writers);
 }
 
-Status SnapshotStreamWriter::CommitChunk() {
-  // Writes the checkpoint before committing the chunk. If the worker fails in
+Status SnapshotStreamWriter::CommitChunks(
+    const std::vector<std::unique_ptr<ChunkWriter>>& writers) {
+  // Empty chunks are dropped, unless the whole round is empty, in which case
+  // its first chunk is committed so the stream always ends with a chunk.
+  std::vector<std::pair<int64_t, int64_t>> chunks_to_commit;
+  for (int64_t i = 0; i < writers.size(); ++i) {
+    const int64_t num_elements = writers[i]->num_elements();
+    if (num_elements > 0 || (i == 0 && chunk_num_elements_ == 0)) {
+      chunks_to_commit.push_back({chunk_index_ + i, num_elements});
+    } else {
+      TF_RETURN_IF_ERROR(
+          params_.env->DeleteFile(GetChunkFilePath(chunk_index_ + i)));
+    }
+  }
+
+  // Writes the checkpoint before committing the chunks. If the worker fails in
   // between, the restarted worker will synchronize the checkpoint with the
   // committed chunks.
+  const int64_t last_chunk_index = chunk_index_ + writers.size() - 1;
   if (ShouldSave()) {
-    TF_RETURN_IF_ERROR(Save());
+    TF_RETURN_IF_ERROR(Save(last_chunk_index, writers.back()->num_elements()));
   }
-  TF_RETURN_IF_ERROR(
-      params_.env->RenameFile(GetChunkFilePath(), GetCommittedChunkFilePath()));
-  ++chunk_index_;
+  for (const auto& [chunk_index, chunk_num_elements] : chunks_to_commit) {
+    TF_RETURN_IF_ERROR(params_.env->RenameFile(
+        GetChunkFilePath(chunk_index),
+        GetCommittedChunkFilePath(chunk_index, chunk_num_elements)));
+  }
+  chunk_index_ = last_chunk_index + 1;
   metrics::RecordTFDataServiceSnapshotBytesCommitted(chunk_size_bytes_);
   chunk_size_bytes_ = 0;
   chunk_num_elements_ = 0;
   return OkStatus();
 }
 
-std::string SnapshotStreamWriter::GetChunkFilePath() const {
+std::string SnapshotStreamWriter::GetChunkFilePath(int64_t chunk_index) const {
   return tsl::io::JoinPath(params_.UncommittedChunksDirectory(),
-                           absl::StrCat("chunk_", chunk_index_));
+                           absl::StrCat("chunk_", chunk_index));
 }
 
-std::string SnapshotStreamWriter::GetCommittedChunkFilePath() const {
+std::string SnapshotStreamWriter::GetCommittedChunkFilePath(
+    int64_t chunk_index, int64_t chunk_num_elements) const {
   return tsl::io::JoinPath(
       params_.CommittedChunksDirectory(),
-      absl::StrCat("chunk_", params_.stream_index, "_", chunk_index_, "_",
-                   chunk_num_elements_));
+      absl::StrCat("chunk_", params_.stream_index, "_", chunk_index, "_",
+                   chunk_num_elements));
 }
 
 bool SnapshotStreamWriter::ShouldWriteRecord() const TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  return chunk_size_bytes_ < params_.max_chunk_size_bytes &&
+  // Since the elements go to the smallest chunk, the round is complete once
+  // the average chunk reaches the target size.
+  return chunk_size_bytes_ / params_.num_writer_threads <
+             chunk_size_target_bytes_ &&
          !end_of_sequence_ && completed_.ok();
 }
 
 Status SnapshotStreamWriter::WriteRecord(
-    snapshot_util::TFRecordWriter& writer) {
+    const std::vector<std::unique_ptr<ChunkWriter>>& writers) {
   std::vector<Tensor> element;
   TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_sequence_));
   if (end_of_sequence_) {
-    return writer.Close();
+    return OkStatus();
   }
-  tsl::profiler::TraceMe activity("SnapshotWriteRecord",
-                                  tsl::profiler::TraceMeLevel::kInfo);
-  TF_RETURN_IF_ERROR(writer.WriteTensors(element));
-  chunk_size_bytes_ += EstimatedSizeBytes(element);
+  ChunkWriter* smallest_chunk = writers.front().get();
+  for (const std::unique_ptr<ChunkWriter>& writer : writers) {
+    if (writer->size_bytes() < smallest_chunk->size_bytes()) {
+      smallest_chunk = writer.get();
+    }
+  }
+  const int64_t element_size_bytes = EstimatedSizeBytes(element);
+  TF_RETURN_IF_ERROR(
+      smallest_chunk->Write(std::move(element), element_size_bytes));
+  chunk_size_bytes_ += element_size_bytes;
   ++chunk_num_elements_;
   return OkStatus();
 }
 
+void SnapshotStreamWriter::UpdateChunkSizeTarget(absl::Time round_start_time) {
+  if (params_.target_chunk_write_time <= absl::ZeroDuration() ||
+      chunk_num_elements_ == 0) {
+    return;
+  }
+  const absl::Duration round_time =
+      absl::FromUnixMicros(params_.env->NowMicros()) - round_start_time;
+  if (round_time <= absl::ZeroDuration()) {
+    return;
+  }
+  // The chunks of a round are written concurrently, so each of them is
+  // written at the throughput of the round divided by the number of chunks.
+  const double chunk_bytes_per_second =
+      static_cast<double>(chunk_size_bytes_) / params_.num_writer_threads /
+      absl::ToDoubleSeconds(round_time);
+  const double target_bytes =
+      chunk_bytes_per_second *
+      absl::ToDoubleSeconds(params_.target_chunk_write_time);
+  const int64_t min_bytes =
+      std::min(params_.min_chunk_size_bytes, params_.max_chunk_size_bytes);
+  chunk_size_target_bytes_ =
+      target_bytes >= static_cast<double>(params_.max_chunk_size_bytes)
+          ? params_.max_chunk_size_bytes
+          : std::max(min_bytes, static_cast<int64_t>(target_bytes));
+}
+
 Status SnapshotStreamWriter::FinalizeStream(Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -270,16 +452,16 @@ bool SnapshotStreamWriter::ShouldSave() const TF_LOCKS_EXCLUDED(mu_) {
   return completed_.ok();
 }
 
-Status SnapshotStreamWriter::Save() {
+Status SnapshotStreamWriter::Save(int64_t chunk_index,
+                                  int64_t chunk_num_elements) {
   LOG(INFO) << "Checkpointing distributed tf.data snapshot writer. Stream "
-            << params_.stream_index << ", chunk " << chunk_index_
+            << params_.stream_index << ", chunk " << chunk_index
             << ", chunk size in bytes: " << chunk_size_bytes_
-            << ", number of elements in chunk: " << chunk_num_elements_ << ".";
+            << ", number of elements in chunk: " << chunk_num_elements << ".";
   tsl::profiler::TraceMe activity("SnapshotCheckpoint",
                                   tsl::profiler::TraceMeLevel::kInfo);
   absl::Time start_time = absl::FromUnixMicros(params_.env->NowMicros());
-  std::string checkpoint_path =
-      CheckpointPath(chunk_index_, chunk_num_elements_);
+  std::string checkpoint_path = CheckpointPath(chunk_index, chunk_num_elements);
   TF_ASSIGN_OR_RETURN(std::vector<Tensor> serialized_iterator,
                       iterator_->Save());
   TF_RETURN_IF_ERROR(AtomicallyWriteTFRecords(
@@ -289,10 +471,11 @@ Status SnapshotStreamWriter::Save() {
             << "Checkpointing distributed tf.data snapshot writer took "
             << (end_time - start_time);
   last_checkpoint_time_ = end_time;
-  return DeleteOutdatedCheckpoints();
+  return DeleteOutdatedCheckpoints(chunk_index);
 }
 
-Status SnapshotStreamWriter::DeleteOutdatedCheckpoints() {
+Status SnapshotStreamWriter::DeleteOutdatedCheckpoints(
+    int64_t checkpoint_index) {
   if (params_.test_only_keep_temp_files) {
     return OkStatus();
   }
@@ -310,8 +493,8 @@ Status SnapshotStreamWriter::DeleteOutdatedCheckpoints() {
 
     TF_ASSIGN_OR_RETURN(auto checkpoint_filename_tokens,
                         ParseCheckpointFilename(checkpoint_filename));
-    auto [checkpoint_index, unused] = checkpoint_filename_tokens;
-    if (checkpoint_index < chunk_index_) {
+    auto [index, unused] = checkpoint_filename_tokens;
+    if (index < checkpoint_index) {
       TF_RETURN_IF_ERROR(params_.env->DeleteFile(checkpoint_filepath));
     }
   }
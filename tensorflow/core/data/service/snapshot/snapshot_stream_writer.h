@@ -21,6 +21,7 @@ limitations under the License.
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
@@ -40,6 +41,7 @@ namespace tensorflow {
 namespace data {
 
 constexpr int64_t kDefaultMaxChunkSizeBytes = 2 * (size_t{1} << 30);  // 2GB
+constexpr int64_t kDefaultMinChunkSizeBytes = 64 * (size_t{1} << 20);  // 64MB
 constexpr absl::Duration kDefaultCheckpointInterval = absl::Minutes(20);
 
 struct SnapshotWriterParams {
@@ -67,6 +69,21 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // The number of chunks written concurrently. Each chunk is serialized and
+  // compressed by its own thread, so this bounds the number of cores a stream
+  // uses for compression.
+  int64_t num_writer_threads = 1;
+
+  // If positive, the chunk size adapts to the write throughput of the stream
+  // so that writing a chunk takes about this long, within
+  // [`min_chunk_size_bytes`, `max_chunk_size_bytes`]. Otherwise, chunks are
+  // `max_chunk_size_bytes` large.
+  absl::Duration target_chunk_write_time = absl::ZeroDuration();
+
+  // The minimum number of bytes in each chunk when the chunk size adapts to
+  // the write throughput.
+  int64_t min_chunk_size_bytes = kDefaultMinChunkSizeBytes;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -86,8 +103,9 @@ struct SnapshotWriterParams {
 
   std::string DebugString() const {
     return absl::Substitute(
-        "SnapshotWriterParams { base_path: $0, stream: $1, compression: $2 }",
-        snapshot_path, stream_index, compression);
+        "SnapshotWriterParams { base_path: $0, stream: $1, compression: $2, "
+        "writer threads: $3 }",
+        snapshot_path, stream_index, compression, num_writer_threads);
   }
 };
 
@@ -111,6 +129,10 @@ struct SnapshotWriterParams {
 //       - checkpoints
 //         - checkpoint_<chunk_index>_<num_elements>
 //
+// Chunks are written in rounds of `num_writer_threads` chunks. The elements of
+// a round are distributed to the chunk with the fewest bytes, and each chunk
+// is written by a background thread. A checkpoint is taken after every round.
+//
 // This class is thread-safe.
 class SnapshotStreamWriter {
  public:
@@ -136,6 +158,9 @@ class SnapshotStreamWriter {
   void Cancel();
 
  private:
+  // Writes one chunk of the current round on a background thread.
+  class ChunkWriter;
+
   // Writes the snapshot and any debugging log when necessary.
   void WriteSnapshotAndLog();
 
@@ -155,22 +180,27 @@ class SnapshotStreamWriter {
   // cancelled.
   bool ShouldWriteChunk() const;
 
-  // Writes the next chunk.
-  Status WriteChunk();
+  // Writes the next round of chunks.
+  Status WriteChunks();
 
-  // Commits the current chunk.
-  Status CommitChunk();
+  // Commits the chunks of the current round.
+  Status CommitChunks(const std::vector<std::unique_ptr<ChunkWriter>>& writers);
 
-  // Returns the path of the current chunk.
-  std::string GetChunkFilePath() const;
-  std::string GetCommittedChunkFilePath() const;
+  // Returns the path of the chunk with index `chunk_index`.
+  std::string GetChunkFilePath(int64_t chunk_index) const;
+  std::string GetCommittedChunkFilePath(int64_t chunk_index,
+                                        int64_t chunk_num_elements) const;
 
   // Returns true if the writer should write the next record to the current
-  // chunk.
+  // round of chunks.
   bool ShouldWriteRecord() const;
 
-  // Writes the next record to the current chunk.
-  Status WriteRecord(snapshot_util::TFRecordWriter& writer);
+  // Writes the next record to the chunk of `writers` with the fewest bytes.
+  Status WriteRecord(const std::vector<std::unique_ptr<ChunkWriter>>& writers);
+
+  // Adapts the target chunk size to the throughput of a round that started at
+  // `round_start_time`, if `target_chunk_write_time` is set.
+  void UpdateChunkSizeTarget(absl::Time round_start_time);
 
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
@@ -181,11 +211,13 @@ class SnapshotStreamWriter {
   // Returns true if the writer should write an iterator checkpoint.
   bool ShouldSave() const;
 
-  // Saves an iterator checkpoint.
-  Status Save();
+  // Saves an iterator checkpoint for the chunk `chunk_index` with
+  // `chunk_num_elements` elements.
+  Status Save(int64_t chunk_index, int64_t chunk_num_elements);
 
-  // After committing a checkpoint, deletes the previous checkpoints.
-  Status DeleteOutdatedCheckpoints();
+  // After committing the checkpoint for `checkpoint_index`, deletes the
+  // previous checkpoints.
+  Status DeleteOutdatedCheckpoints(int64_t checkpoint_index);
 
   // Deletes all checkpoints.
   Status DeleteCheckpoints();
@@ -216,12 +248,14 @@ class SnapshotStreamWriter {
   // The dataset iterator that produces the dataset elements.
   std::unique_ptr<TaskIterator> iterator_;
 
-  // Index of the current chunk.
+  // Index of the first chunk of the current round.
   int64_t chunk_index_ = 0;
-  // Size of the current chunk.
+  // Size of the chunks of the current round.
   int64_t chunk_size_bytes_ = 0;
-  // Number of elements in current chunk.
+  // Number of elements in the chunks of the current round.
   int64_t chunk_num_elements_ = 0;
+  // The number of bytes after which a chunk is committed.
+  int64_t chunk_size_target_bytes_;
   // Timestamp when the last checkpoint is taken.
   absl::Time last_checkpoint_time_ = absl::Now();
 
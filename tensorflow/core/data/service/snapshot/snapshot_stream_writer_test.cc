@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
@@ -230,6 +231,68 @@ TEST_P(SnapshotStreamWriterParameterizedTest, WriteSnapshotChunks) {
   }
 }
 
+TEST_P(SnapshotStreamWriterParameterizedTest, ParallelChunkWriters) {
+  int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  std::string compression = GetParam();
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     compression, Env::Default(),
+                                     /*max_chunk_size_bytes=*/1};
+  writer_params.num_writer_threads = 3;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  // Each round writes one element to each of its 3 chunks. The empty chunks of
+  // the last round are dropped.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(ReadSnapshot<int64_t>(
+                    tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                      absl::StrCat("chunk_0_", i, "_1")),
+                    compression,
+                    /*num_elements=*/1),
+                IsOkAndHolds(ElementsAre(i)));
+  }
+  std::vector<std::string> chunks;
+  TF_ASSERT_OK(Env::Default()->GetChildren(
+      writer_params.CommittedChunksDirectory(), &chunks));
+  EXPECT_EQ(chunks.size(), 10);
+}
+
+TEST_P(SnapshotStreamWriterParameterizedTest, AdaptiveChunkSize) {
+  int64_t range = 5;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  std::string compression = GetParam();
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{snapshot_path, /*stream_index=*/0,
+                                     compression, Env::Default(),
+                                     /*max_chunk_size_bytes=*/16};
+  writer_params.target_chunk_write_time = absl::Nanoseconds(1);
+  writer_params.min_chunk_size_bytes = 8;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  // The first chunk has the maximum size. No chunk is written within the
+  // target time, so the following chunks have the minimum size.
+  EXPECT_THAT(ReadSnapshot<int64_t>(
+                  tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                    "chunk_0_0_2"),
+                  compression, /*num_elements=*/2),
+              IsOkAndHolds(ElementsAre(0, 1)));
+  for (int i = 1; i < 4; ++i) {
+    EXPECT_THAT(ReadSnapshot<int64_t>(
+                    tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                      absl::StrCat("chunk_0_", i, "_1")),
+                    compression,
+                    /*num_elements=*/1),
+                IsOkAndHolds(ElementsAre(i + 1)));
+  }
+}
+
 TEST_P(SnapshotStreamWriterParameterizedTest, WriteDoneFile) {
   int64_t range = 10;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
@@ -20,6 +20,8 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -45,7 +47,7 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return dispatcher_->GetSplit(iteration_id_, repetition_,
                                      split_provider_index_, *split,
-                                     *end_of_splits);
+                                     *end_of_splits, worker_address_);
       },
       "get next split",
       /*deadline_micros=*/Env::Default()->NowMicros() +
@@ -57,6 +59,9 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
     VLOG(1) << "Requested split: " << split->DebugString()
             << "; with iteration_id=" << iteration_id_
             << ", repetition=" << repetition_;
+    if (split_callback_) {
+      split_callback_(*split);
+    }
   }
   return OkStatus();
 }
@@ -81,6 +86,85 @@ Status DataServiceSplitProvider::Restore(
       "Restore is not implemented for DataServiceSplitProvider");
 }
 
+std::string SplitLocalityKey(const Tensor& split) {
+  if (split.dims() != 0) {
+    return "";
+  }
+  switch (split.dtype()) {
+    case DT_STRING:
+      return std::string(split.scalar<tstring>()());
+    case DT_INT32:
+      return absl::StrCat(split.scalar<int32_t>()());
+    case DT_INT64:
+      return absl::StrCat(split.scalar<int64_t>()());
+    default:
+      return "";
+  }
+}
+
+Status LocalityAwareSplitProvider::GetNextLocal(
+    const absl::flat_hash_set<std::string>& local_keys, Tensor* split,
+    bool* end_of_splits) TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(FillBuffer());
+  if (buffer_.empty()) {
+    *end_of_splits = true;
+    return OkStatus();
+  }
+  auto it = buffer_.begin();
+  if (!local_keys.empty()) {
+    for (auto candidate = buffer_.begin(); candidate != buffer_.end();
+         ++candidate) {
+      if (local_keys.contains(SplitLocalityKey(*candidate))) {
+        it = candidate;
+        break;
+      }
+    }
+  }
+  *split = std::move(*it);
+  buffer_.erase(it);
+  *end_of_splits = false;
+  return OkStatus();
+}
+
+Status LocalityAwareSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
+    TF_LOCKS_EXCLUDED(mu_) {
+  return GetNextLocal(/*local_keys=*/{}, split, end_of_splits);
+}
+
+Status LocalityAwareSplitProvider::FillBuffer()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  while (!end_of_splits_ && static_cast<int64_t>(buffer_.size()) < lookahead_) {
+    Tensor split;
+    TF_RETURN_IF_ERROR(split_provider_->GetNext(&split, &end_of_splits_));
+    if (!end_of_splits_) {
+      buffer_.push_back(std::move(split));
+    }
+  }
+  return OkStatus();
+}
+
+Status LocalityAwareSplitProvider::Reset() TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  buffer_.clear();
+  end_of_splits_ = false;
+  return split_provider_->Reset();
+}
+
+Status LocalityAwareSplitProvider::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) {
+  return errors::Unimplemented(
+      "Save is not implemented for LocalityAwareSplitProvider");
+}
+
+Status LocalityAwareSplitProvider::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) {
+  return errors::Unimplemented(
+      "Restore is not implemented for LocalityAwareSplitProvider");
+}
+
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
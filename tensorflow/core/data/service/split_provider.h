@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -35,14 +37,20 @@ namespace data {
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
 class DataServiceSplitProvider : public SplitProvider {
  public:
-  DataServiceSplitProvider(const std::string& address,
-                           const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+  // `worker_address` is sent with each request for locality-aware sharding.
+  // If set, `split_callback` is called with each split read.
+  DataServiceSplitProvider(
+      const std::string& address, const std::string& protocol,
+      int64_t iteration_id, int64_t split_provider_index, int64_t timeout_ms,
+      const std::string& worker_address = "",
+      std::function<void(const Tensor&)> split_callback = nullptr)
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        worker_address_(worker_address),
+        split_callback_(std::move(split_callback)) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -57,12 +65,53 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const std::string worker_address_;
+  const std::function<void(const Tensor&)> split_callback_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
 };
 
+// Returns the key matching `split` against the data local to a worker: the
+// value of a scalar string split, or the decimal representation of a scalar
+// integer split. Returns an empty string for other splits.
+std::string SplitLocalityKey(const Tensor& split);
+
+// SplitProvider which reads up to `lookahead` splits ahead of `split_provider`,
+// so that `GetNextLocal` can hand out a split whose data is local to the
+// requesting worker before the splits in front of it.
+class LocalityAwareSplitProvider : public SplitProvider {
+ public:
+  LocalityAwareSplitProvider(std::unique_ptr<SplitProvider> split_provider,
+                             int64_t lookahead)
+      : split_provider_(std::move(split_provider)), lookahead_(lookahead) {}
+
+  // Returns the oldest buffered split whose `SplitLocalityKey` is in
+  // `local_keys`, or the oldest buffered split if none of them is.
+  Status GetNextLocal(const absl::flat_hash_set<std::string>& local_keys,
+                      Tensor* split, bool* end_of_splits);
+
+  Status GetNext(Tensor* split, bool* end_of_splits) override;
+  Status Reset() override;
+  Status Save(std::function<std::string(std::string)> full_name,
+              IteratorStateWriter* writer) override;
+  Status Restore(std::function<std::string(std::string)> full_name,
+                 IteratorStateReader* reader) override;
+
+ private:
+  // Reads splits from `split_provider_` until `lookahead_` are buffered or the
+  // splits are exhausted.
+  Status FillBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::unique_ptr<SplitProvider> split_provider_;
+  const int64_t lookahead_;
+
+  mutex mu_;
+  std::deque<Tensor> buffer_ TF_GUARDED_BY(mu_);
+  bool end_of_splits_ TF_GUARDED_BY(mu_) = false;
+};
+
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
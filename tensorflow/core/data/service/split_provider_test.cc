@@ -0,0 +1,94 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/split_provider.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/data/split_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Reads the remaining splits of `split_provider`, preferring `local_keys`.
+std::vector<int64_t> ReadSplits(
+    LocalityAwareSplitProvider& split_provider,
+    const absl::flat_hash_set<std::string>& local_keys = {}) {
+  std::vector<int64_t> splits;
+  while (true) {
+    Tensor split;
+    bool end_of_splits = false;
+    TF_EXPECT_OK(
+        split_provider.GetNextLocal(local_keys, &split, &end_of_splits));
+    if (end_of_splits) {
+      return splits;
+    }
+    splits.push_back(split.scalar<int64_t>()());
+  }
+}
+
+TEST(SplitLocalityKeyTest, KeysScalarSplits) {
+  EXPECT_EQ(SplitLocalityKey(Tensor(tstring("/data/file_3"))),
+            "/data/file_3");
+  EXPECT_EQ(SplitLocalityKey(Tensor(int64_t{42})), "42");
+  EXPECT_EQ(SplitLocalityKey(Tensor(int32_t{7})), "7");
+  EXPECT_EQ(SplitLocalityKey(Tensor(1.0f)), "");
+  EXPECT_EQ(SplitLocalityKey(Tensor(DT_INT64, TensorShape({2}))), "");
+}
+
+TEST(LocalityAwareSplitProviderTest, ReturnsSplitsInOrderWithoutLocalKeys) {
+  LocalityAwareSplitProvider split_provider(
+      std::make_unique<IndexSplitProvider>(5), /*lookahead=*/3);
+  EXPECT_EQ(ReadSplits(split_provider), std::vector<int64_t>({0, 1, 2, 3, 4}));
+}
+
+TEST(LocalityAwareSplitProviderTest, PrefersLocalSplitsWithinLookahead) {
+  LocalityAwareSplitProvider split_provider(
+      std::make_unique<IndexSplitProvider>(6), /*lookahead=*/3);
+  Tensor split;
+  bool end_of_splits = false;
+  // Split 2 is within the lookahead, split 5 is not yet.
+  TF_ASSERT_OK(
+      split_provider.GetNextLocal({"2", "5"}, &split, &end_of_splits));
+  ASSERT_FALSE(end_of_splits);
+  EXPECT_EQ(split.scalar<int64_t>()(), 2);
+  TF_ASSERT_OK(
+      split_provider.GetNextLocal({"2", "5"}, &split, &end_of_splits));
+  ASSERT_FALSE(end_of_splits);
+  EXPECT_EQ(split.scalar<int64_t>()(), 0);
+  EXPECT_EQ(ReadSplits(split_provider, {"5"}),
+            std::vector<int64_t>({1, 5, 3, 4}));
+}
+
+TEST(LocalityAwareSplitProviderTest, Reset) {
+  LocalityAwareSplitProvider split_provider(
+      std::make_unique<IndexSplitProvider>(4), /*lookahead=*/2);
+  Tensor split;
+  bool end_of_splits = false;
+  TF_ASSERT_OK(split_provider.GetNextLocal({"1"}, &split, &end_of_splits));
+  EXPECT_EQ(split.scalar<int64_t>()(), 1);
+  TF_ASSERT_OK(split_provider.Reset());
+  EXPECT_EQ(ReadSplits(split_provider), std::vector<int64_t>({0, 1, 2, 3}));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
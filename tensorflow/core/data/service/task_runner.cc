@@ -16,9 +16,14 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -34,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -46,6 +52,8 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheDiskSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
 
 }  // namespace
 
@@ -94,8 +102,22 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    std::unique_ptr<CompressedFileCacheTier> disk_tier;
+    size_t max_disk_size_bytes = 0;
+    if (!worker_config.cross_trainer_cache_disk_dir().empty()) {
+      TF_ASSIGN_OR_RETURN(
+          disk_tier,
+          CompressedFileCacheTier::Create(io::JoinPath(
+              worker_config.cross_trainer_cache_disk_dir(),
+              absl::StrCat("task_", task_def.task_id()))));
+      max_disk_size_bytes =
+          worker_config.cross_trainer_cache_disk_size_bytes() > 0
+              ? worker_config.cross_trainer_cache_disk_size_bytes()
+              : kDefaultCrossTrainerCacheDiskSizeBytes;
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(disk_tier),
+        max_disk_size_bytes);
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -163,13 +185,80 @@ void FirstComeFirstServedTaskRunner::Cancel() {
   buffer_.Cancel(errors::Cancelled("tf.data service FCFS task is cancelled."));
 }
 
-CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+StatusOr<std::unique_ptr<CompressedFileCacheTier>>
+CompressedFileCacheTier::Create(const std::string& directory) {
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new CompressedFileCacheTier(directory));
+}
+
+CompressedFileCacheTier::~CompressedFileCacheTier() {
+  int64_t undeleted_files = 0, undeleted_dirs = 0;
+  Status s = Env::Default()->DeleteRecursively(directory_, &undeleted_files,
+                                               &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                 << "directory " << directory_ << ": " << s;
+  }
+}
+
+StatusOr<size_t> CompressedFileCacheTier::Write(
+    size_t index, const GetElementResult& element) {
+  CompressedElement compressed;
+  TF_RETURN_IF_ERROR(CompressElement(element.components, &compressed));
+  std::string serialized = compressed.SerializeAsString();
+  TF_RETURN_IF_ERROR(
+      WriteStringToFile(Env::Default(), FilePath(index), serialized));
+  mutex_lock l(mu_);
+  element_indices_[index] = element.element_index;
+  return serialized.size();
+}
+
+StatusOr<GetElementResult> CompressedFileCacheTier::Read(size_t index) {
+  GetElementResult result;
+  {
+    mutex_lock l(mu_);
+    auto it = element_indices_.find(index);
+    if (it == element_indices_.end()) {
+      return errors::NotFound("Element ", index,
+                              " is not in the cross-trainer cache disk tier.");
+    }
+    result.element_index = it->second;
+  }
+  std::string serialized;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), FilePath(index), &serialized));
+  CompressedElement compressed;
+  if (!compressed.ParseFromString(serialized)) {
+    return errors::DataLoss("Failed to parse cross-trainer cache file ",
+                            FilePath(index));
+  }
+  TF_RETURN_IF_ERROR(UncompressElement(compressed, &result.components));
+  return result;
+}
+
+Status CompressedFileCacheTier::Delete(size_t index) {
+  {
+    mutex_lock l(mu_);
+    element_indices_.erase(index);
+  }
+  return Env::Default()->DeleteFile(FilePath(index));
+}
+
+std::string CompressedFileCacheTier::FilePath(size_t index) const {
+  return io::JoinPath(directory_, absl::StrCat("element_", index));
+}
+
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    std::unique_ptr<CompressedFileCacheTier> disk_tier,
+    size_t max_disk_size_bytes)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::move(disk_tier), max_disk_size_bytes) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
-            << FormatBytes(max_cache_size_bytes) << " of memory.";
+            << FormatBytes(max_cache_size_bytes) << " of memory and "
+            << FormatBytes(max_disk_size_bytes) << " of disk.";
 }
 
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
@@ -203,6 +292,11 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+std::optional<CrossTrainerCacheTierStats>
+CachingTaskRunner::GetCacheTierStats() const {
+  return cache_.GetTierStats();
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
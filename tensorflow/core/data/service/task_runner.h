@@ -15,9 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -95,6 +100,11 @@ class TaskRunner {
                          GetElementResult& result) = 0;
   // Cancels in-progress `GetNext` requests.
   virtual void Cancel() = 0;
+  // Returns the per-tier hit counts of the cross-trainer cache, if the task
+  // runner uses one.
+  virtual std::optional<CrossTrainerCacheTierStats> GetCacheTierStats() const {
+    return std::nullopt;
+  }
 };
 
 // A task runner which provides elements on a first-come first-served basis.
@@ -133,6 +143,37 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   TF_DISALLOW_COPY_AND_ASSIGN(FirstComeFirstServedTaskRunner);
 };
 
+// Cross-trainer cache tier which stores elements as compressed files in a local
+// directory, e.g. on local disk or NVMe. The directory is deleted when the tier
+// is destroyed.
+class CompressedFileCacheTier : public SecondaryCacheTier<GetElementResult> {
+ public:
+  // Creates a tier storing its files in `directory`, creating the directory if
+  // it doesn't exist.
+  static StatusOr<std::unique_ptr<CompressedFileCacheTier>> Create(
+      const std::string& directory);
+  ~CompressedFileCacheTier() override;
+
+  StatusOr<size_t> Write(size_t index,
+                         const GetElementResult& element) override;
+  StatusOr<GetElementResult> Read(size_t index) override;
+  Status Delete(size_t index) override;
+
+ private:
+  explicit CompressedFileCacheTier(const std::string& directory)
+      : directory_(directory) {}
+
+  // Returns the path of the file storing the element at `index`.
+  std::string FilePath(size_t index) const;
+
+  const std::string directory_;
+
+  mutex mu_;
+  // Maps element indices to the `GetElementResult::element_index` of the
+  // stored elements.
+  absl::flat_hash_map<size_t, int64_t> element_indices_ TF_GUARDED_BY(mu_);
+};
+
 // A task runner which prefetches elements on a first-come first-served basis
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
@@ -140,8 +181,12 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // read the full dataset.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  // If `disk_tier` is set, the elements evicted from memory are spilled to it
+  // until it holds `max_disk_size_bytes`.
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      std::unique_ptr<CompressedFileCacheTier> disk_tier = nullptr,
+      size_t max_disk_size_bytes = 0);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -154,6 +199,8 @@ class CachingTaskRunner : public TaskRunner {
   // return a Cancelled status.
   void Cancel() override;
 
+  std::optional<CrossTrainerCacheTierStats> GetCacheTierStats() const override;
+
  private:
   // The `GetElementResultSequence` generates a sequence of elements from the
   // `FirstComeFirstServedTaskRunner`. It is used for the `CrossTrainerCache` to
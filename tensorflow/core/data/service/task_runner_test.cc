@@ -16,6 +16,7 @@ limitations under the License.
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -382,6 +384,39 @@ TEST(CachingTaskRunnerTest, ConcurrentTrainers) {
   }
 }
 
+TEST(CachingTaskRunnerTest, SlowTrainersReadFromDisk) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompressedFileCacheTier> disk_tier,
+      CompressedFileCacheTier::Create(
+          io::JoinPath(testing::TmpDir(), "SlowTrainersReadFromDisk")));
+  CachingTaskRunner runner(std::make_unique<InfiniteRangeIterator>(),
+                           /*max_cache_size_bytes=*/kSmallCache,
+                           std::move(disk_tier),
+                           /*max_disk_size_bytes=*/1 << 20);
+  GetElementRequest fast_request;
+  fast_request.set_trainer_id("Fast trainer");
+  GetElementRequest slow_request;
+  slow_request.set_trainer_id("Slow trainer");
+  EXPECT_THAT(GetNextFromTaskRunner<int64_t>(runner, fast_request),
+              IsOkAndHolds(0));
+  EXPECT_THAT(GetNextFromTaskRunner<int64_t>(runner, slow_request),
+              IsOkAndHolds(0));
+  for (int64_t i = 1; i < 100; ++i) {
+    EXPECT_THAT(GetNextFromTaskRunner<int64_t>(runner, fast_request),
+                IsOkAndHolds(i));
+  }
+
+  // The elements evicted from memory are still read from disk.
+  for (int64_t i = 1; i < 4; ++i) {
+    EXPECT_THAT(GetNextFromTaskRunner<int64_t>(runner, slow_request),
+                IsOkAndHolds(i));
+  }
+  std::optional<CrossTrainerCacheTierStats> stats = runner.GetCacheTierStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->secondary_hits, 3);
+  EXPECT_EQ(stats->misses, 100);
+}
+
 TEST(CachingTaskRunnerTest, Cancel) {
   CachingTaskRunner runner(std::make_unique<InfiniteRangeIterator>(),
                            /*max_cache_size_bytes=*/kLargeCache);
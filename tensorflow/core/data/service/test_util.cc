@@ -182,6 +182,25 @@ DatasetDef InfiniteDataset() {
   return dataset_def;
 }
 
+DatasetDef RepeatedTensorDataset(const Tensor& tensor) {
+  DatasetDef dataset_def;
+  *dataset_def.mutable_graph() = GDef(
+      {NDef("tensor", "Const", /*inputs=*/{},
+            {{"value", tensor}, {"dtype", tensor.dtype()}}),
+       NDef("from_tensors", "TensorDataset", /*inputs=*/{"tensor"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{tensor.shape()}},
+             {"Toutput_types", gtl::ArraySlice<DataType>{tensor.dtype()}}}),
+       NDef("count", "Const", /*inputs=*/{},
+            {{"value", AsScalar<int64_t>(-1)}, {"dtype", DT_INT64}}),
+       NDef("repeat", "RepeatDataset", /*inputs=*/{"from_tensors", "count"},
+            {{"output_shapes", gtl::ArraySlice<TensorShape>{tensor.shape()}},
+             {"output_types", gtl::ArraySlice<DataType>{tensor.dtype()}}}),
+       NDef("dataset", "_Retval", /*inputs=*/{"repeat"},
+            {{"T", DT_VARIANT}, {"index", 0}})},
+      {});
+  return dataset_def;
+}
+
 StatusOr<DatasetDef> ChooseFromDatasets() {
   DatasetDef dataset;
   std::string graph_file = io::JoinPath(kTestdataDir, kChooseFromDatasetsFile);
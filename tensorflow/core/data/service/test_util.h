@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
@@ -51,6 +52,10 @@ DatasetDef RangeDatasetWithShardHint(int64_t range);
 // tf.data.Dataset.range(100000000).repeat().
 DatasetDef InfiniteDataset();
 
+// Returns a test dataset representing
+// tf.data.Dataset.from_tensors(tensor).repeat().
+DatasetDef RepeatedTensorDataset(const Tensor& tensor);
+
 // Returns a test dataset representing
 // datasets = [tf.data.Dataset.from_tensor_slices(["a", "a", "a", "a", "a"]),
 //             tf.data.Dataset.from_tensor_slices(["b", "b", "b", "b", "b"]),
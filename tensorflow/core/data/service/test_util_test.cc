@@ -104,6 +104,25 @@ TEST(TestUtilTest, InfiniteDataset) {
   }
 }
 
+TEST(TestUtilTest, RepeatedTensorDataset) {
+  const Tensor tensor = test::AsTensor<float>({1.0, 2.0, 3.0});
+  const auto dataset_def = RepeatedTensorDataset(tensor);
+  standalone::Dataset::Params params;
+  std::unique_ptr<standalone::Dataset> dataset;
+  TF_ASSERT_OK(
+      standalone::Dataset::FromGraph(params, dataset_def.graph(), &dataset));
+  std::unique_ptr<standalone::Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+
+  for (int64_t i = 0; i < 3; ++i) {
+    std::vector<tensorflow::Tensor> outputs;
+    bool end_of_sequence;
+    TF_ASSERT_OK(iterator->GetNext(&outputs, &end_of_sequence));
+    EXPECT_FALSE(end_of_sequence);
+    test::ExpectEqual(outputs[0], tensor);
+  }
+}
+
 TEST(TestUtilTest, EmptyDataset) {
   const auto dataset_def = RangeSquareDataset(/*range=*/0);
   standalone::Dataset::Params params;
@@ -14,12 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_client.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/data/service/common.h"
@@ -35,11 +38,16 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
@@ -49,6 +57,8 @@ namespace data {
 namespace {
 
 using ::tensorflow::data::testing::RangeSquareDataset;
+using ::tensorflow::data::testing::RepeatedTensorDataset;
+using ::tensorflow::data::testing::WaitWhile;
 using ::tensorflow::testing::StatusIs;
 using ::testing::MatchesRegex;
 
@@ -232,6 +242,113 @@ TEST_F(WorkerClientTest, CancelClient) {
                        MatchesRegex("Client for worker.*has been cancelled.")));
 }
 
+// Measures GetElement over gRPC: `concurrency` clients read elements of
+// `tensor_size` floats from `num_workers` in-process workers, spread over the
+// workers round-robin. The data transfer clients are built directly so that
+// the reads don't take the local transfer shortcut for in-process workers.
+void BM_GetElement(::testing::benchmark::State& state) {
+  const int num_workers = state.range(0);
+  const int tensor_size = state.range(1);
+  const int concurrency = state.range(2);
+
+  TestCluster cluster(num_workers);
+  TF_CHECK_OK(cluster.Initialize());
+  DataServiceDispatcherClient dispatcher(cluster.DispatcherAddress(),
+                                         kProtocol);
+  Tensor tensor(DT_FLOAT, TensorShape({tensor_size}));
+  tensor.flat<float>().setConstant(1.0f);
+  std::string dataset_id;
+  TF_CHECK_OK(dispatcher.RegisterDataset(
+      RepeatedTensorDataset(tensor), DataServiceMetadata(),
+      /*requested_dataset_id=*/std::nullopt, dataset_id));
+  ProcessingModeDef processing_mode;
+  processing_mode.set_sharding_policy(ProcessingModeDef::OFF);
+  int64_t job_id = 0;
+  TF_CHECK_OK(dispatcher.GetOrCreateJob(
+      dataset_id, processing_mode, /*job_name=*/std::nullopt,
+      /*num_consumers=*/std::nullopt, /*use_cross_trainer_cache=*/false,
+      TARGET_WORKERS_AUTO, job_id));
+  int64_t iteration_client_id = 0;
+  TF_CHECK_OK(dispatcher.GetOrCreateIteration(job_id, /*repetition=*/0,
+                                              iteration_client_id));
+
+  // Waits for the tasks of all workers.
+  ClientHeartbeatResponse heartbeat;
+  TF_CHECK_OK(WaitWhile([&]() -> StatusOr<bool> {
+    ClientHeartbeatRequest request;
+    request.set_iteration_client_id(iteration_client_id);
+    TF_RETURN_IF_ERROR(dispatcher.ClientHeartbeat(request, heartbeat));
+    return heartbeat.task_info_size() < num_workers;
+  }));
+
+  struct Reader {
+    int64_t task_id;
+    std::unique_ptr<DataTransferClient> client;
+  };
+  std::vector<Reader> readers(concurrency);
+  for (int i = 0; i < concurrency; ++i) {
+    const TaskInfo& task = heartbeat.task_info(i % num_workers);
+    readers[i].task_id = task.task_id();
+    TF_CHECK_OK(DataTransferClient::Build(
+        kGrpcTransferProtocol, {kProtocol, task.worker_address()},
+        &readers[i].client));
+  }
+  auto read = [](Reader& reader) {
+    GetElementRequest request;
+    request.set_task_id(reader.task_id);
+    GetElementResult result;
+    TF_CHECK_OK(reader.client->GetElement(request, result));
+    CHECK(!result.end_of_sequence);
+  };
+  for (Reader& reader : readers) {
+    read(reader);
+  }
+
+  thread::ThreadPool pool(Env::Default(), "get_element_clients", concurrency);
+  mutex mu;
+  std::vector<int64_t> latencies_us;
+  for (auto s : state) {
+    BlockingCounter done(concurrency);
+    for (Reader& reader : readers) {
+      pool.Schedule([&, reader = &reader]() {
+        const uint64 start_us = Env::Default()->NowMicros();
+        read(*reader);
+        const int64_t latency_us = Env::Default()->NowMicros() - start_us;
+        {
+          mutex_lock l(mu);
+          latencies_us.push_back(latency_us);
+        }
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+
+  if (!latencies_us.empty()) {
+    std::sort(latencies_us.begin(), latencies_us.end());
+    auto percentile = [&](double p) {
+      return static_cast<double>(
+          latencies_us[static_cast<size_t>(p * (latencies_us.size() - 1))]);
+    };
+    state.counters["p50_us"] = percentile(0.5);
+    state.counters["p99_us"] = percentile(0.99);
+  }
+  state.SetItemsProcessed(state.iterations() * concurrency);
+  state.SetBytesProcessed(state.iterations() * concurrency * tensor_size *
+                          sizeof(float));
+  state.SetLabel(absl::StrCat(num_workers, " workers; ", concurrency,
+                              " concurrent clients; tensor bytes: ",
+                              tensor_size * sizeof(float)));
+}
+BENCHMARK(BM_GetElement)
+    ->Args({1, 1, 1})
+    ->Args({1, 1, 16})
+    ->Args({1, 1 << 20, 1})
+    ->Args({1, 1 << 20, 4})
+    ->Args({4, 1 << 16, 4})
+    ->Args({4, 1 << 16, 16})
+    ->UseRealTime();
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -14,8 +14,11 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -115,6 +118,9 @@ WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
   if (new_config.snapshot_max_chunk_size_bytes() == 0) {
     new_config.set_snapshot_max_chunk_size_bytes(kDefaultMaxChunkSizeBytes);
   }
+  if (new_config.snapshot_num_writer_threads() == 0) {
+    new_config.set_snapshot_num_writer_threads(1);
+  }
   return new_config;
 }
 
@@ -406,10 +412,22 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
   if (IsDynamicShard(task_def.processing_mode_def())) {
     std::vector<std::unique_ptr<SplitProvider>> split_providers;
     split_providers.reserve(task_def.num_split_providers());
+    std::function<void(const Tensor&)> split_callback;
+    if (config_.report_processed_splits_as_local()) {
+      split_callback = [this](const Tensor& split) {
+        std::string key = SplitLocalityKey(split);
+        if (key.empty()) {
+          return;
+        }
+        mutex_lock l(local_split_keys_mu_);
+        processed_split_keys_.insert(std::move(key));
+      };
+    }
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          worker_address_, split_callback));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -558,10 +576,27 @@ Status DataServiceWorkerImpl::Heartbeat() {
 WorkerHeartbeatRequest DataServiceWorkerImpl::BuildWorkerHeartbeatRequest()
     const TF_LOCKS_EXCLUDED(mu_) {
   std::vector<int64_t> current_tasks;
+  std::vector<CrossTrainerCacheStats> cache_stats;
   {
     mutex_lock l(mu_);
     for (const auto& task : tasks_) {
       current_tasks.push_back(task.first);
+      // Skips tasks being initialized, rather than delaying the heartbeat.
+      mutex_lock task_lock(task.second->mu, std::try_to_lock);
+      if (!task_lock || !task.second->initialized ||
+          !task.second->task_runner) {
+        continue;
+      }
+      std::optional<CrossTrainerCacheTierStats> tier_stats =
+          task.second->task_runner->GetCacheTierStats();
+      if (!tier_stats.has_value()) {
+        continue;
+      }
+      CrossTrainerCacheStats& stats = cache_stats.emplace_back();
+      stats.set_task_id(task.first);
+      stats.set_memory_hits(tier_stats->memory_hits);
+      stats.set_disk_hits(tier_stats->secondary_hits);
+      stats.set_misses(tier_stats->misses);
     }
   }
 
@@ -573,6 +608,15 @@ WorkerHeartbeatRequest DataServiceWorkerImpl::BuildWorkerHeartbeatRequest()
   request.set_worker_uid(worker_uid_);
   *request.mutable_current_tasks() = {current_tasks.begin(),
                                       current_tasks.end()};
+  *request.mutable_cross_trainer_cache_stats() = {cache_stats.begin(),
+                                                  cache_stats.end()};
+  *request.mutable_local_split_keys() = config_.local_split_keys();
+  {
+    mutex_lock l(local_split_keys_mu_);
+    for (const std::string& key : processed_split_keys_) {
+      request.add_local_split_keys(key);
+    }
+  }
   for (const auto& snapshot_task_progress : GetSnapshotTaskProgress()) {
     request.mutable_snapshot_task_progress()->insert(
         {snapshot_task_progress.snapshot_task().base_path(),
@@ -655,15 +699,18 @@ Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams writer_params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        config_.snapshot_max_chunk_size_bytes()};
+    writer_params.num_writer_threads = config_.snapshot_num_writer_threads();
+    writer_params.target_chunk_write_time =
+        absl::Milliseconds(config_.snapshot_target_chunk_write_time_ms());
     mutex_lock l(mu_);
     snapshot_writers_.emplace(
         snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                config_.snapshot_max_chunk_size_bytes()},
-            std::move(iterator)));
+        std::make_unique<SnapshotStreamWriter>(writer_params,
+                                               std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
@@ -200,6 +200,12 @@ class DataServiceWorkerImpl {
                       absl::Hash<SnapshotTask>>
       snapshot_writers_ TF_GUARDED_BY(mu_);
 
+  mutable mutex local_split_keys_mu_;
+  // Keys of the dynamic sharding splits processed by the worker. Only tracked
+  // if `config_.report_processed_splits_as_local()` is true.
+  mutable absl::flat_hash_set<std::string> processed_split_keys_
+      TF_GUARDED_BY(local_split_keys_mu_);
+
   // A thread for notifying the dispatcher when tasks complete.
   std::unique_ptr<Thread> task_completion_thread_;
   // A thread for performing regular heartbeats to the dispatcher.
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -151,22 +152,13 @@ Status TFRecordWriter::Initialize(tensorflow::Env* env) {
 
 Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
   for (const auto& tensor : tensors) {
-    TensorProto proto;
-    tensor.AsProtoTensorContent(&proto);
 #if defined(TF_CORD_SUPPORT)
-    // Creating raw pointer here because std::move() in a releases in OSS TF
-    // will result in a smart pointer being moved upon function creation, which
-    // will result in proto_buffer == nullptr when WriteRecord happens.
-    auto* proto_buffer = new std::string();
-    if (!proto.SerializeToString(proto_buffer)) {
-      delete proto_buffer;
-      return errors::DataLoss(ProtoSerializationErrorMessage(proto, filename_));
-    }
-    absl::Cord proto_serialized = absl::MakeCordFromExternal(
-        *proto_buffer,
-        [proto_buffer](absl::string_view) { delete proto_buffer; });
-    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(proto_serialized));
+    // The serialized record references the tensor's buffer rather than a copy.
+    TF_RETURN_IF_ERROR(
+        record_writer_->WriteRecord(tensor::SerializeTensorToCord(tensor)));
 #else   // TF_CORD_SUPPORT
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
     std::string proto_serialized;
     if (!proto.SerializeToString(&proto_serialized)) {
       return errors::DataLoss(ProtoSerializationErrorMessage(proto, filename_));
@@ -787,10 +779,10 @@ StatusOr<Tensor> TFRecordReaderImpl::Parse(const tstring& record) {
   }
 
   Tensor tensor;
-  if (!tensor.FromProto(proto)) {
+  if (!tensor.FromProto(std::move(proto))) {
     return errors::DataLoss(
         "Unable to parse tensor from stored proto in file: ", filename_,
-        ", record ", offset_, ". TensorProto: ", proto.ShortDebugString());
+        ", record ", offset_, ". Serialized proto: ", record);
   }
   return tensor;
 }
@@ -899,7 +891,7 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
         return errors::Internal("Could not parse TensorProto");
       }
       Tensor t;
-      if (!t.FromProto(tp)) {
+      if (!t.FromProto(std::move(tp))) {
         return errors::Internal("Could not parse Tensor");
       }
       read_tensors->push_back(std::move(t));
@@ -923,7 +915,8 @@ Status CustomReader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
   read_tensors->reserve(record.tensor_size());
   for (int i = 0; i < record.tensor_size(); ++i) {
     read_tensors->emplace_back();
-    if (!read_tensors->back().FromProto(record.tensor(i))) {
+    Tensor& tensor = read_tensors->back();
+    if (!tensor.FromProto(std::move(*record.mutable_tensor(i)))) {
       return errors::DataLoss("Unable to parse tensor from proto.");
     }
   }
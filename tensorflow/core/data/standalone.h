@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -89,6 +90,11 @@ class Iterator {
   // iterator saved by calling `Save()`.
   Status Restore(const std::vector<Tensor>& saved_iterator);
 
+  // Returns the autotuning model of the iterator, or nullptr if the input
+  // pipeline is not autotuned. The model records the number of elements,
+  // processing time and buffered bytes of each node of the pipeline.
+  std::shared_ptr<model::Model> model() const;
+
  private:
   friend class Dataset;
 
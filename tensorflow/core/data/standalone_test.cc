@@ -19,6 +19,8 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -301,6 +303,28 @@ TEST(Scalar, Standalone) {
   }
 }
 
+TEST(Model, Standalone) {
+  GraphDef graph_def;
+  protobuf::TextFormat::ParseFromString(kMapGraphProto, &graph_def);
+  std::unique_ptr<Dataset> dataset;
+  TF_ASSERT_OK(Dataset::FromGraph({}, graph_def, &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_ASSERT_OK(dataset->MakeIterator(&iterator));
+  bool end_of_input = false;
+  while (!end_of_input) {
+    std::vector<tensorflow::Tensor> outputs;
+    TF_ASSERT_OK(iterator->GetNext(&outputs, &end_of_input));
+  }
+
+  // Input pipelines are autotuned by default.
+  std::shared_ptr<model::Model> model = iterator->model();
+  ASSERT_NE(model, nullptr);
+  ASSERT_NE(model->output(), nullptr);
+  model::ModelProto model_proto;
+  TF_ASSERT_OK(model->ToProto(&model_proto));
+  EXPECT_FALSE(model_proto.nodes().empty());
+}
+
 }  // namespace
 }  // namespace standalone
 }  // namespace data
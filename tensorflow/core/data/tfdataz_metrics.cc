@@ -22,7 +22,9 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -121,6 +123,29 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+int64_t TfDatazMetricsCollector::GetAutotuneCpuBudget() {
+  std::shared_ptr<model::Model> model = iterator_->GetModel();
+  return model ? model->cpu_budget() : 0;
+}
+
+absl::flat_hash_map<std::string, int64_t>
+TfDatazMetricsCollector::GetAutotuneParallelism() {
+  std::shared_ptr<model::Model> model = iterator_->GetModel();
+  if (!model) {
+    return {};
+  }
+  return model->TunedParallelism();
+}
+
+absl::flat_hash_map<std::string, int64_t>
+TfDatazMetricsCollector::GetBufferedBytesPerNode() {
+  std::shared_ptr<model::Model> model = iterator_->GetModel();
+  if (!model) {
+    return {};
+  }
+  return model->BufferedBytesPerNode();
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
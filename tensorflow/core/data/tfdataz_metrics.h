@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -115,6 +116,21 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the CPU budget the iterator was last autotuned for, or 0 if it has
+  // not been autotuned. Without the `autotune_available_cpu_budget`
+  // experiment, this is the configured budget; with it, the number of cores
+  // measured to be available.
+  int64_t GetAutotuneCpuBudget();
+
+  // Returns the `parallelism` picked by autotuning for each node of the
+  // iterator, keyed by node name.
+  absl::flat_hash_map<std::string, int64_t> GetAutotuneParallelism();
+
+  // Returns the bytes currently buffered by each node of the iterator that
+  // buffers any, keyed by node name. The process-wide total and budget are
+  // available from `model::RamBudgetManager`.
+  absl::flat_hash_map<std::string, int64_t> GetBufferedBytesPerNode();
+
  private:
   IteratorBase* iterator_;  // not owned
   ApproximateLatencyEstimator latency_estimator_;
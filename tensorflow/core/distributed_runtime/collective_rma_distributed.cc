@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/distributed_runtime/collective_rma_distributed.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
@@ -28,6 +30,9 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
 #include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
@@ -104,6 +109,34 @@ Status PopulateTensorFromResponse(const RecvBufResponse& response,
   return OkStatus();
 }
 
+// Returns the key of sub-chunk `index` of the tensor exchanged under `key`.
+string SubChunkKey(const string& key, int index) {
+  return strings::StrCat(key, ":sub", index);
+}
+
+// Splits `tensor` into sub-chunks of about `sub_chunk_bytes` bytes, which
+// alias the buffer of `tensor`. Returns `tensor` itself when it is not larger
+// than a sub-chunk. The sender and the receiver of a tensor split it the same
+// way, since both sides have the same shape and `sub_chunk_bytes`.
+std::vector<Tensor> SplitIntoSubChunks(const Tensor& tensor,
+                                       int64_t sub_chunk_bytes) {
+  if (sub_chunk_bytes <= 0 || tensor.TotalBytes() <= sub_chunk_bytes) {
+    return {tensor};
+  }
+  const int64_t num_elements = tensor.NumElements();
+  const int64_t elements_per_sub_chunk =
+      std::max<int64_t>(1, sub_chunk_bytes / DataTypeSize(tensor.dtype()));
+  Tensor flat;
+  CHECK(flat.CopyFrom(tensor, TensorShape({num_elements})));
+  std::vector<Tensor> sub_chunks;
+  for (int64_t start = 0; start < num_elements;
+       start += elements_per_sub_chunk) {
+    sub_chunks.push_back(flat.Slice(
+        start, std::min(num_elements, start + elements_per_sub_chunk)));
+  }
+  return sub_chunks;
+}
+
 }  // namespace
 
 void CollectiveRemoteAccessDistributed::RecvFromPeer(
@@ -111,43 +144,51 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
     const string& key, Device* to_device, DeviceContext* to_device_ctx,
     const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
     const DeviceLocality& client_locality, int dev_to_dev_stream_index,
-    CancellationManager* cancellation_manager, const StatusCallback& done) {
+    int64_t sub_chunk_bytes, CancellationManager* cancellation_manager,
+    const StatusCallback& done) {
   if (peer_is_local) {
     CollectiveRemoteAccessLocal::RecvFromPeer(
         peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
         to_alloc_attr, to_tensor, client_locality, dev_to_dev_stream_index,
-        cancellation_manager, done);
+        sub_chunk_bytes, cancellation_manager, done);
     return;
   }
 
   // State that needs to be threaded through a couple of async calls
-  // in order to make this function completely non-blocking.
+  // in order to make this function completely non-blocking. It is shared by
+  // the RecvBufAsync calls of all sub-chunks.
   struct State {
     DeviceAttributes server_attributes;
-    std::unique_ptr<RecvBufCall> call;
     std::unique_ptr<Tensor> cpu_tensor;
+    // Sub-chunk i is received into dst_sub_chunks[i], then copied to
+    // to_sub_chunks[i] when to_device is a GPU.
+    std::vector<Tensor> dst_sub_chunks;
+    std::vector<Tensor> to_sub_chunks;
+    std::vector<std::unique_ptr<RecvBufCall>> calls;
+    mutex mu;
+    int num_pending TF_GUARDED_BY(mu) = 0;
+    Status status TF_GUARDED_BY(mu);
   };
-  State* state = new State;
+  auto state = std::make_shared<State>();
 
-  DeviceAttributes server_attributes;
   Status s = dev_resolver_->GetDeviceAttributes(peer_device,
                                                 &state->server_attributes);
   if (!s.ok()) {
-    delete state;
     done(s);
     return;
   }
 
   Tensor* dst_tensor = nullptr;
   Device* cpu_dev = nullptr;
-  if (to_device->tensorflow_accelerator_device_info()) {
+  const bool to_accelerator =
+      to_device->tensorflow_accelerator_device_info() != nullptr;
+  if (to_accelerator) {
     // Move the bytes into a CPU tensor then use tensor-to-tensor copy.
     // Use GPU-registered memory for the CPU tensor so the transfer
     // goes faster.
 
     Status status = dev_mgr_->LookupDevice("CPU:0", &cpu_dev);
     if (!status.ok()) {
-      delete state;
       done(s);
       return;
     }
@@ -167,67 +208,146 @@ void CollectiveRemoteAccessDistributed::RecvFromPeer(
     dst_tensor = to_tensor;
   }
 
-  // Logic to be executed on the RecvBufAsync callback.
-  auto recv_buf_callback =
-      [this, state, to_device, to_alloc_attr, to_device_ctx, to_tensor, cpu_dev,
-       dev_to_dev_stream_index, dst_tensor, done](const Status& s) {
-        if (s.ok()) {
-          // In this generic implementation the bytes come back in one of 2
-          // ways:
-          // 1. In the response protobuf transport_options field (OR)
-          // 2. It has already been copied over into RecvBufCall::req_.buf_ptr()
-          // provided in request. buf_ptr is set to dst_tensor and points to
-          // either the temporary cpu_tensor in case to_device is a GPU device
-          // OR directly to to_tensor if to_device is not a GPU device.
-          //
-          // PopulateTensorFromResponse handles both cases.
-          // (NOP in 2nd case) In case the final to_tensor is on GPU, buf_ptr
-          // points to a tmp CPU buffer and needs to be copied over to
-          // to_tensor.
-          Status status =
-              PopulateTensorFromResponse(state->call->resp_, dst_tensor);
-          if (!status.ok()) {
-            done(status);
-            delete state;
-            return;
-          }
+  // Large tensors are received in sub-chunks, each with its own RecvBufAsync
+  // call, so that copying a sub-chunk to the GPU overlaps with receiving the
+  // following ones.
+  state->dst_sub_chunks = SplitIntoSubChunks(*dst_tensor, sub_chunk_bytes);
+  state->to_sub_chunks = SplitIntoSubChunks(*to_tensor, sub_chunk_bytes);
+  const int num_sub_chunks = state->dst_sub_chunks.size();
+  {
+    mutex_lock l(state->mu);
+    state->num_pending = num_sub_chunks;
+  }
 
-          if (to_device->tensorflow_accelerator_device_info()) {
-            AllocatorAttributes cpu_attr;
-            cpu_attr.set_gpu_compatible(true);
-            CopyTensor::ViaDMA("",  // edge name (non-existent)
-                               nullptr /*send_dev_ctx*/, to_device_ctx, cpu_dev,
-                               to_device, cpu_attr, to_alloc_attr, dst_tensor,
-                               to_tensor, dev_to_dev_stream_index,
-                               [this, state, done](const Status& s) {
-                                 delete state;
-                                 // This callback must not block, so execute
-                                 // done in another thread.
-                                 work_queue_->Schedule([s, done] { done(s); });
-                               });
-            return;
-          }
-        }
-        delete state;
+  // Called once per sub-chunk, when it has landed in to_tensor.
+  auto sub_chunk_done = [this, state, to_accelerator,
+                         done](const Status& s) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->num_pending > 0) return;
+      status = state->status;
+    }
+    if (to_accelerator) {
+      // This callback may run in the GPU event manager and must not block,
+      // so execute done in another thread.
+      work_queue_->Schedule([status, done] { done(status); });
+    } else {
+      done(status);
+    }
+  };
+
+  for (int i = 0; i < num_sub_chunks; ++i) {
+    state->calls.push_back(std::make_unique<RecvBufCall>(
+        step_id_, peer_device, peer_task,
+        num_sub_chunks == 1 ? key : SubChunkKey(key, i), to_device,
+        to_device_ctx, to_alloc_attr, &state->dst_sub_chunks[i],
+        client_locality, state->server_attributes, cancellation_manager,
+        worker_cache_));
+  }
+  for (int i = 0; i < num_sub_chunks; ++i) {
+    // Logic to be executed on the RecvBufAsync callback.
+    auto recv_buf_callback = [state, i, to_device, to_alloc_attr,
+                              to_device_ctx, cpu_dev, to_accelerator,
+                              dev_to_dev_stream_index,
+                              sub_chunk_done](const Status& s) {
+      if (!s.ok()) {
+        sub_chunk_done(s);
+        return;
+      }
+      // In this generic implementation the bytes come back in one of 2
+      // ways:
+      // 1. In the response protobuf transport_options field (OR)
+      // 2. It has already been copied over into RecvBufCall::req_.buf_ptr()
+      // provided in request. buf_ptr is set to the sub-chunk of dst_tensor,
+      // which is either the temporary cpu_tensor in case to_device is a GPU
+      // device OR directly to_tensor if to_device is not a GPU device.
+      //
+      // PopulateTensorFromResponse handles both cases.
+      // (NOP in 2nd case) In case the final to_tensor is on GPU, buf_ptr
+      // points to a tmp CPU buffer and needs to be copied over to
+      // to_tensor.
+      Status status = PopulateTensorFromResponse(state->calls[i]->resp_,
+                                                 &state->dst_sub_chunks[i]);
+      if (!status.ok() || !to_accelerator) {
+        sub_chunk_done(status);
+        return;
+      }
+      AllocatorAttributes cpu_attr;
+      cpu_attr.set_gpu_compatible(true);
+      CopyTensor::ViaDMA("",  // edge name (non-existent)
+                         nullptr /*send_dev_ctx*/, to_device_ctx, cpu_dev,
+                         to_device, cpu_attr, to_alloc_attr,
+                         &state->dst_sub_chunks[i], &state->to_sub_chunks[i],
+                         dev_to_dev_stream_index, sub_chunk_done);
+    };
+
+    RecvBufCall* call = state->calls[i].get();
+    CancellationToken abortion_token =
+        abortion_cancel_mgr_.get_cancellation_token();
+    bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+        abortion_token, [call] { call->Cancel(); });
+    if (already_aborted) {
+      recv_buf_callback(errors::Cancelled("collective ops already aborted"));
+    } else {
+      call->Start([this, abortion_token,
+                   done = std::move(recv_buf_callback)](const Status& s) {
+        abortion_cancel_mgr_.DeregisterCallback(abortion_token);
         done(s);
-      };
-
-  state->call.reset(new RecvBufCall(
-      step_id_, peer_device, peer_task, key, to_device, to_device_ctx,
-      to_alloc_attr, dst_tensor, client_locality, state->server_attributes,
-      cancellation_manager, worker_cache_));
-  CancellationToken abortion_token =
-      abortion_cancel_mgr_.get_cancellation_token();
-  bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
-      abortion_token, [state] { state->call->Cancel(); });
-  if (already_aborted) {
-    recv_buf_callback(errors::Cancelled("collective ops already aborted"));
-  } else {
-    state->call->Start([this, abortion_token,
-                        done = std::move(recv_buf_callback)](const Status& s) {
-      abortion_cancel_mgr_.DeregisterCallback(abortion_token);
-      done(s);
-    });
+      });
+    }
+  }
+}
+
+void CollectiveRemoteAccessDistributed::PostToPeer(
+    const string& peer_device, const string& peer_task, const string& key,
+    Device* from_device, DeviceContext* from_device_ctx,
+    const AllocatorAttributes& from_alloc_attr, const Tensor* from_tensor,
+    const DeviceLocality& client_locality, int64_t sub_chunk_bytes,
+    CancellationManager* cancellation_manager, const StatusCallback& done) {
+  std::vector<Tensor> sub_chunks;
+  if (peer_task != task_name_) {
+    sub_chunks = SplitIntoSubChunks(*from_tensor, sub_chunk_bytes);
+  }
+  if (sub_chunks.size() <= 1) {
+    CollectiveRemoteAccessLocal::PostToPeer(
+        peer_device, peer_task, key, from_device, from_device_ctx,
+        from_alloc_attr, from_tensor, client_locality, sub_chunk_bytes,
+        cancellation_manager, done);
+    return;
+  }
+
+  // Provides each sub-chunk under its own key, matching the RecvBufAsync
+  // calls of the peer's RecvFromPeer.
+  struct State {
+    std::vector<Tensor> sub_chunks;
+    mutex mu;
+    int num_pending TF_GUARDED_BY(mu) = 0;
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<State>();
+  state->sub_chunks = std::move(sub_chunks);
+  const int num_sub_chunks = state->sub_chunks.size();
+  {
+    mutex_lock l(state->mu);
+    state->num_pending = num_sub_chunks;
+  }
+  for (int i = 0; i < num_sub_chunks; ++i) {
+    buf_rendezvous_.ProvideBuf(
+        SubChunkKey(key, i), from_device, from_device_ctx,
+        &state->sub_chunks[i], from_alloc_attr,
+        [state, done](const Status& s) {
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->num_pending > 0) return;
+            status = state->status;
+          }
+          done(status);
+        },
+        cancellation_manager);
   }
 }
 
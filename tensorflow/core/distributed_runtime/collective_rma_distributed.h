@@ -37,15 +37,30 @@ class CollectiveRemoteAccessDistributed : public CollectiveRemoteAccessLocal {
 
   ~CollectiveRemoteAccessDistributed() override {}
 
+  // Receives tensors larger than `sub_chunk_bytes` from other tasks in
+  // sub-chunks, with one RecvBuf RPC each, and copies every sub-chunk to a GPU
+  // `to_device` as soon as it lands.
   void RecvFromPeer(const string& peer_device, const string& peer_task,
                     bool peer_is_local, const string& key, Device* to_device,
                     DeviceContext* to_device_ctx,
                     const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
                     const DeviceLocality& client_locality,
-                    int dev_to_dev_stream_index,
+                    int dev_to_dev_stream_index, int64_t sub_chunk_bytes,
                     CancellationManager* cancellation_manager,
                     const StatusCallback& done) override;
 
+  // Splits tensors sent to other tasks into sub-chunks when they are larger
+  // than `sub_chunk_bytes`, see `RecvFromPeer`.
+  void PostToPeer(const string& peer_device, const string& peer_task,
+                  const string& key, Device* from_device,
+                  DeviceContext* from_device_ctx,
+                  const AllocatorAttributes& from_alloc_attr,
+                  const Tensor* from_tensor,
+                  const DeviceLocality& client_locality,
+                  int64_t sub_chunk_bytes,
+                  CancellationManager* cancellation_manager,
+                  const StatusCallback& done) override;
+
   void CheckPeerHealth(const string& peer_task, int64_t timeout_in_ms,
                        const StatusCallback& done) override;
 
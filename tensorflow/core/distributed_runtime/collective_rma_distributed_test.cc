@@ -85,6 +85,7 @@ class FakeWorker : public TestWorkerInterface {
         device_mgr_(dev_mgr),
         device_resolver_(dres),
         buf_rendezvous_(kStepId, dev_mgr),
+        rendezvous_(&buf_rendezvous_),
         is_failed_(is_failed),
         set_tensor_in_extra_(set_tensor_in_extra) {}
 
@@ -92,6 +93,10 @@ class FakeWorker : public TestWorkerInterface {
   // worker is supposed to have.
   BufRendezvous* buf_rendezvous() { return &buf_rendezvous_; }
 
+  // Serves RecvBuf requests from `rendezvous` instead, e.g. the one of the
+  // remote worker's CollectiveRemoteAccess.
+  void set_rendezvous(BufRendezvous* rendezvous) { rendezvous_ = rendezvous; }
+
   void GetStatusAsync(CallOptions* opts, const GetStatusRequest* request,
                       GetStatusResponse* response, bool fail_fast,
                       StatusCallback done) override {
@@ -121,13 +126,13 @@ class FakeWorker : public TestWorkerInterface {
       // more consistent with that situation and avoid mutex deadlock.
       SchedClosure([this]() {
         Env::Default()->SleepForMicroseconds(100);
-        buf_rendezvous_.StartAbort(errors::Internal("Cancelled"));
+        rendezvous_->StartAbort(errors::Internal("Cancelled"));
       });
     });
     VLOG(2) << "ConsumeBuf key=" << request->buf_rendezvous_key()
             << " src_device=" << request->src_device()
             << " src_incarnation=" << request->src_incarnation();
-    buf_rendezvous_.ConsumeBuf(
+    rendezvous_->ConsumeBuf(
         request->buf_rendezvous_key(), request->src_device(),
         request->src_incarnation(),
         [this, opts, request, response, done](const Status& status,
@@ -165,6 +170,7 @@ class FakeWorker : public TestWorkerInterface {
   DeviceMgr* device_mgr_;
   DeviceResolverDistributed* device_resolver_;
   BufRendezvous buf_rendezvous_;
+  BufRendezvous* rendezvous_;  // Not owned
   bool is_failed_;
   const bool set_tensor_in_extra_;
 };
@@ -395,7 +401,55 @@ TEST_P(CollRMADistTest, ProdFirstOK) {
       "/job:worker/replica:0/task:1",                     // peer_task
       false,                                              // peer_is_local
       kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
-      device_locality_, 0 /*dev_to_dev_stream_index*/,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, 0 /*sub_chunk_bytes*/,
+      nullptr /*cancellation_manager*/,
+      [&consumer_status, &consumer_note](const Status& s) {
+        consumer_status = s;
+        consumer_note.Notify();
+      });
+  consumer_note.WaitForNotification();
+  TF_EXPECT_OK(consumer_status);
+  producer_note.WaitForNotification();
+  TF_EXPECT_OK(producer_status);
+  ValidateResultTensor();
+}
+
+TEST_P(CollRMADistTest, SubChunksOK) {
+  ResolveDeviceAttributes();
+  const string kTask1 = "/job:worker/replica:0/task:1";
+  CollectiveRemoteAccessDistributed rma1(device_mgrs_[1],
+                                         dev_resolvers_[kTask1], work_queue_,
+                                         &wc_, kStepId, kTask1);
+  workers_[1]->set_rendezvous(rma1.buf_rendezvous());
+  // Splits the 8 floats into sub-chunks of 3, 3 and 2 elements.
+  const int64_t kSubChunkBytes = 3 * sizeof(float);
+  Notification consumer_note;
+  Notification producer_note;
+  Status consumer_status;
+  Status producer_status;
+  const string kBufKey = "fake_buf_key";
+  Device* src_device = nullptr;
+  TF_EXPECT_OK(device_mgrs_[1]->LookupDevice("CPU:0", &src_device));
+  rma1.PostToPeer("/job:worker/replica:0/task:0/device:CPU:0",
+                  "/job:worker/replica:0/task:0", kBufKey, src_device,
+                  nullptr /*from_device_ctx*/, AllocatorAttributes(),
+                  &expected_value_, device_locality_, kSubChunkBytes,
+                  nullptr /*cancellation_manager*/,
+                  [&producer_status, &producer_note](const Status& s) {
+                    producer_status = s;
+                    producer_note.Notify();
+                  });
+  Device* dst_device = nullptr;
+  string dev_name = "CPU:0";
+  TF_EXPECT_OK(device_mgrs_[0]->LookupDevice(dev_name, &dst_device));
+  DeviceContext* to_device_ctx = nullptr;
+  MaybeSetGPUDevice(dst_device);
+  rma_->RecvFromPeer(
+      kTask1 + "/device:" + dev_name,  // peer_dev
+      kTask1,                          // peer_task
+      false,                           // peer_is_local
+      kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, kSubChunkBytes,
       nullptr /*cancellation_manager*/,
       [&consumer_status, &consumer_note](const Status& s) {
         consumer_status = s;
@@ -426,7 +480,7 @@ TEST_P(CollRMADistTest, ConsFirstOK) {
       "/job:worker/replica:0/task:1",                     // peer_task
       false,                                              // peer_is_local
       kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
-      device_locality_, 0 /*dev_to_dev_stream_index*/,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, 0 /*sub_chunk_bytes*/,
       nullptr /*cancellation_manager*/,
       [&consumer_status, &consumer_note](const Status& s) {
         consumer_status = s;
@@ -462,7 +516,7 @@ TEST_P(CollRMADistTest, ConsFirstAbort) {
       "/job:worker/replica:0/task:1",                     // peer_task
       false,                                              // peer_is_local
       kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
-      device_locality_, 0 /*dev_to_dev_stream_index*/,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, 0 /*sub_chunk_bytes*/,
       nullptr /*cancellation_manager*/,
       [&consumer_status, &consumer_note](const Status& s) {
         consumer_status = s;
@@ -499,7 +553,7 @@ TEST_P(CollRMADistTest, ResponseTooLarge) {
       "/job:worker/replica:0/task:1",                     // peer_task
       false,                                              // peer_is_local
       kBufKey, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
-      device_locality_, 0 /*dev_to_dev_stream_index*/,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, 0 /*sub_chunk_bytes*/,
       nullptr /*cancellation_manager*/,
       [&consumer_status, &consumer_note](const Status& s) {
         consumer_status = s;
@@ -531,7 +585,7 @@ TEST_P(CollRMADistTest, WorkerRestart) {
       "/job:worker/replica:0/task:1",                     // peer_task
       false,                                              // peer_is_local
       buf_key, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
-      device_locality_, 0 /*dev_to_dev_stream_index*/,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, 0 /*sub_chunk_bytes*/,
       nullptr /*cancellation_manager*/,
       [&consumer_status, &consumer_note](const Status& s) {
         consumer_status = s;
@@ -559,7 +613,7 @@ TEST_P(CollRMADistTest, WorkerRestart) {
       "/job:worker/replica:0/task:1",                     // peer_task
       false,                                              // peer_is_local
       buf_key, dst_device, to_device_ctx, alloc_attr_, &to_tensor_,
-      device_locality_, 0 /*dev_to_dev_stream_index*/,
+      device_locality_, 0 /*dev_to_dev_stream_index*/, 0 /*sub_chunk_bytes*/,
       nullptr /*cancellation_manager*/,
       [&consumer_status, &post_restart_note](const Status& s) {
         consumer_status = s;
@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+
+EnqueueBatcher::EnqueueBatcher(Env* env, int64_t window_micros,
+                               int max_batch_items, SendFn send)
+    : env_(env),
+      window_micros_(window_micros),
+      max_batch_items_(max_batch_items),
+      send_(std::move(send)) {}
+
+EnqueueBatcher::~EnqueueBatcher() {
+  Flush();
+  mutex_lock l(mu_);
+  while (num_pending_timers_ > 0) {
+    timers_done_.wait(l);
+  }
+}
+
+void EnqueueBatcher::Enqueue(const EnqueueRequest* request,
+                             EnqueueResponse* response, StatusCallback done) {
+  {
+    mutex_lock l(mu_);
+    // A batch is sent to a single remote context.
+    if (batch_ != nullptr &&
+        batch_->request.context_id() != request->context_id()) {
+      CloseBatch();
+    }
+    if (batch_ == nullptr) {
+      batch_ = std::make_unique<Batch>();
+      batch_->request.set_context_id(request->context_id());
+      ++batch_id_;
+      ++num_pending_timers_;
+      env_->SchedClosureAfter(window_micros_,
+                              [this, batch_id = batch_id_]() {
+                                OnTimer(batch_id);
+                              });
+    }
+    for (const QueueItem& item : request->queue()) {
+      *batch_->request.add_queue() = item;
+    }
+    batch_->callers.push_back(
+        Caller{response, request->queue_size(), std::move(done)});
+    if (batch_->request.queue_size() >= max_batch_items_) {
+      CloseBatch();
+    }
+  }
+  SendReadyBatches();
+}
+
+void EnqueueBatcher::Flush() {
+  {
+    mutex_lock l(mu_);
+    if (batch_ != nullptr) {
+      CloseBatch();
+    }
+  }
+  SendReadyBatches();
+}
+
+void EnqueueBatcher::CloseBatch() {
+  ready_.push_back(std::move(batch_));
+  batch_ = nullptr;
+}
+
+void EnqueueBatcher::OnTimer(int64_t batch_id) {
+  {
+    mutex_lock l(mu_);
+    if (batch_ != nullptr && batch_id == batch_id_) {
+      CloseBatch();
+    }
+  }
+  SendReadyBatches();
+  mutex_lock l(mu_);
+  if (--num_pending_timers_ == 0) {
+    timers_done_.notify_all();
+  }
+}
+
+void EnqueueBatcher::SendReadyBatches() {
+  {
+    mutex_lock l(mu_);
+    // The thread already sending sends the batches closed meanwhile, in order.
+    // This also lets `send_` call back into `Enqueue` inline.
+    if (sending_) return;
+    sending_ = true;
+  }
+  while (true) {
+    std::shared_ptr<Batch> batch;
+    {
+      mutex_lock l(mu_);
+      if (ready_.empty()) {
+        sending_ = false;
+        return;
+      }
+      batch = std::move(ready_.front());
+      ready_.pop_front();
+    }
+    VLOG(3) << "Sending " << batch->request.queue_size()
+            << " queue items of " << batch->callers.size()
+            << " enqueue requests";
+    auto response = std::make_shared<EnqueueResponse>();
+    send_(&batch->request, response.get(),
+          [batch, response](const Status& status) {
+            int offset = 0;
+            for (Caller& caller : batch->callers) {
+              if (status.ok()) {
+                const int end = std::min(offset + caller.num_items,
+                                         response->queue_response_size());
+                for (int i = offset; i < end; ++i) {
+                  *caller.response->add_queue_response() =
+                      response->queue_response(i);
+                }
+              }
+              offset += caller.num_items;
+              caller.done(status);
+            }
+          });
+  }
+}
+
+}  // namespace eager
+}  // namespace tensorflow
@@ -0,0 +1,110 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces the `EnqueueRequest`s sent to one remote worker.
+//
+// In async mode, remote ops are sent as soon as they are queued, one
+// `EnqueueRequest` each, so that a client running many small ops is bound by
+// the RPC overhead. `EnqueueBatcher` buffers the requests for up to
+// `window_micros` after the first one, and sends their queue items as a single
+// request. The items of the batch are executed remotely in the order they were
+// enqueued, and batches are sent in order, so the ordering of the remote ops
+// is unchanged.
+//
+// Each caller gets the responses of its own items. When the batch fails, all
+// its callers get the error, as they would for an earlier failed request of
+// the same stream.
+class EnqueueBatcher {
+ public:
+  using SendFn =
+      std::function<void(const EnqueueRequest* request,
+                         EnqueueResponse* response, StatusCallback done)>;
+
+  // `send` is called, one batch at a time and in order, to send the batches.
+  // A batch is sent when its window elapses, when it reaches `max_batch_items`
+  // queue items, or when `Flush` is called.
+  EnqueueBatcher(Env* env, int64_t window_micros, int max_batch_items,
+                 SendFn send);
+
+  // Sends the pending requests, and waits for the pending timers.
+  ~EnqueueBatcher();
+
+  // Adds `request` to the current batch. `response` is filled with the
+  // responses of the items of `request` before `done` is called. Like for
+  // `EagerClient::StreamingEnqueueAsync`, `request` can be deleted as soon
+  // as `Enqueue` returns.
+  void Enqueue(const EnqueueRequest* request, EnqueueResponse* response,
+               StatusCallback done);
+
+  // Sends the current batch, if any, without waiting for its window.
+  void Flush();
+
+ private:
+  struct Caller {
+    EnqueueResponse* response;
+    int num_items;
+    StatusCallback done;
+  };
+
+  struct Batch {
+    EnqueueRequest request;
+    std::vector<Caller> callers;
+  };
+
+  // Moves the current batch to `ready_`.
+  void CloseBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Sends the batches of `ready_`, unless another thread is already sending.
+  void SendReadyBatches();
+
+  void OnTimer(int64_t batch_id);
+
+  Env* const env_;
+  const int64_t window_micros_;
+  const int max_batch_items_;
+  const SendFn send_;
+
+  mutex mu_;
+  condition_variable timers_done_;
+  std::unique_ptr<Batch> batch_ TF_GUARDED_BY(mu_);
+  // Incremented for every new batch, so that timers can tell whether the
+  // batch they were started for is still open.
+  int64_t batch_id_ TF_GUARDED_BY(mu_) = 0;
+  int num_pending_timers_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<std::unique_ptr<Batch>> ready_ TF_GUARDED_BY(mu_);
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,166 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+constexpr int64_t kLongWindowMicros = 100 * 1000;
+
+// Records the requests it is asked to send and answers each queue item with
+// the id of its operation.
+class FakeSender {
+ public:
+  explicit FakeSender(Status status = OkStatus()) : status_(status) {}
+
+  EnqueueBatcher::SendFn send_fn() {
+    return [this](const EnqueueRequest* request, EnqueueResponse* response,
+                  StatusCallback done) {
+      {
+        mutex_lock l(mu_);
+        requests_.push_back(*request);
+      }
+      for (const QueueItem& item : request->queue()) {
+        response->add_queue_response()->add_device(
+            absl::StrCat(item.operation().id()));
+      }
+      done(status_);
+    };
+  }
+
+  std::vector<EnqueueRequest> requests() {
+    mutex_lock l(mu_);
+    return requests_;
+  }
+
+ private:
+  const Status status_;
+  mutex mu_;
+  std::vector<EnqueueRequest> requests_ TF_GUARDED_BY(mu_);
+};
+
+EnqueueRequest MakeRequest(int64_t context_id, std::vector<int64_t> op_ids) {
+  EnqueueRequest request;
+  request.set_context_id(context_id);
+  for (int64_t op_id : op_ids) {
+    request.add_queue()->mutable_operation()->set_id(op_id);
+  }
+  return request;
+}
+
+TEST(EnqueueBatcherTest, SendsFullBatches) {
+  FakeSender sender;
+  EnqueueBatcher batcher(Env::Default(), kLongWindowMicros,
+                         /*max_batch_items=*/3, sender.send_fn());
+  EnqueueResponse response1, response2;
+  Status status1 = errors::Unknown("not done");
+  Status status2 = errors::Unknown("not done");
+  EnqueueRequest request1 = MakeRequest(1, {10, 11});
+  batcher.Enqueue(&request1, &response1,
+                  [&status1](const Status& s) { status1 = s; });
+  EXPECT_TRUE(sender.requests().empty());
+  EnqueueRequest request2 = MakeRequest(1, {12});
+  batcher.Enqueue(&request2, &response2,
+                  [&status2](const Status& s) { status2 = s; });
+
+  ASSERT_EQ(1, sender.requests().size());
+  EXPECT_EQ(1, sender.requests()[0].context_id());
+  EXPECT_EQ(3, sender.requests()[0].queue_size());
+  TF_EXPECT_OK(status1);
+  TF_EXPECT_OK(status2);
+  ASSERT_EQ(2, response1.queue_response_size());
+  EXPECT_EQ("10", response1.queue_response(0).device(0));
+  EXPECT_EQ("11", response1.queue_response(1).device(0));
+  ASSERT_EQ(1, response2.queue_response_size());
+  EXPECT_EQ("12", response2.queue_response(0).device(0));
+}
+
+TEST(EnqueueBatcherTest, SendsWhenWindowElapses) {
+  FakeSender sender;
+  EnqueueBatcher batcher(Env::Default(), /*window_micros=*/1000,
+                         /*max_batch_items=*/100, sender.send_fn());
+  EnqueueResponse response1, response2;
+  BlockingCounter done(2);
+  EnqueueRequest request1 = MakeRequest(1, {10});
+  EnqueueRequest request2 = MakeRequest(1, {11});
+  batcher.Enqueue(&request1, &response1, [&done](const Status& s) {
+    TF_EXPECT_OK(s);
+    done.DecrementCount();
+  });
+  batcher.Enqueue(&request2, &response2, [&done](const Status& s) {
+    TF_EXPECT_OK(s);
+    done.DecrementCount();
+  });
+  done.Wait();
+
+  ASSERT_EQ(1, sender.requests().size());
+  EXPECT_EQ(2, sender.requests()[0].queue_size());
+  EXPECT_EQ("11", response2.queue_response(0).device(0));
+}
+
+TEST(EnqueueBatcherTest, FlushAndContextChangeSendBatch) {
+  FakeSender sender;
+  EnqueueBatcher batcher(Env::Default(), kLongWindowMicros,
+                         /*max_batch_items=*/100, sender.send_fn());
+  EnqueueResponse response1, response2, response3;
+  EnqueueRequest request1 = MakeRequest(1, {10});
+  EnqueueRequest request2 = MakeRequest(2, {11});
+  EnqueueRequest request3 = MakeRequest(2, {12});
+  batcher.Enqueue(&request1, &response1, [](const Status& s) {});
+  batcher.Enqueue(&request2, &response2, [](const Status& s) {});
+  ASSERT_EQ(1, sender.requests().size());
+  EXPECT_EQ(1, sender.requests()[0].context_id());
+
+  batcher.Enqueue(&request3, &response3, [](const Status& s) {});
+  batcher.Flush();
+  ASSERT_EQ(2, sender.requests().size());
+  EXPECT_EQ(2, sender.requests()[1].context_id());
+  EXPECT_EQ(2, sender.requests()[1].queue_size());
+}
+
+TEST(EnqueueBatcherTest, PropagatesErrorsToAllRequests) {
+  FakeSender sender(errors::Internal("remote failure"));
+  EnqueueBatcher batcher(Env::Default(), kLongWindowMicros,
+                         /*max_batch_items=*/100, sender.send_fn());
+  EnqueueResponse response1, response2;
+  Status status1, status2;
+  EnqueueRequest request1 = MakeRequest(1, {10});
+  EnqueueRequest request2 = MakeRequest(1, {11});
+  batcher.Enqueue(&request1, &response1,
+                  [&status1](const Status& s) { status1 = s; });
+  batcher.Enqueue(&request2, &response2,
+                  [&status2](const Status& s) { status2 = s; });
+  batcher.Flush();
+
+  EXPECT_TRUE(errors::IsInternal(status1));
+  EXPECT_TRUE(errors::IsInternal(status2));
+  EXPECT_EQ(0, response1.queue_response_size());
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
@@ -520,5 +520,107 @@ void RemoteCopyNode::Abort(Status status) {
   }
 }
 
+RemoteSendTensorsNode::RemoteSendTensorsNode(EagerContext* ctx,
+                                             std::vector<TensorHandle*> srcs,
+                                             Device* recv_device,
+                                             uint64 recv_op_id)
+    : AsyncEagerNode(),
+      ctx_(ctx),
+      srcs_(std::move(srcs)),
+      recv_device_(recv_device),
+      recv_op_id_(recv_op_id),
+      started_(false) {
+  DCHECK(!recv_device_->IsLocal());
+  for (TensorHandle* src : srcs_) {
+    src->Ref();
+  }
+  ctx_->Ref();
+}
+
+RemoteSendTensorsNode::~RemoteSendTensorsNode() {
+  for (TensorHandle* src : srcs_) {
+    src->Unref();
+  }
+  ctx_->Unref();
+}
+
+void RemoteSendTensorsNode::PoisonRemoteMirrors(const Status& status,
+                                                uint64 context_view_id) {
+  for (TensorHandle* src : srcs_) {
+    src->PoisonRemote(status, recv_device_, context_view_id);
+  }
+}
+
+void RemoteSendTensorsNode::RunAsync(StatusCallback done) {
+  started_ = true;
+  EnqueueRequest request;
+  request.set_context_id(ctx_->GetContextId());
+  auto* send_tensor = request.add_queue()->mutable_send_tensor();
+  send_tensor->set_op_id(recv_op_id_);
+  send_tensor->set_device_name(recv_device_->name());
+  uint64 context_view_id = ctx_->GetContextViewId();
+
+  std::vector<TensorShape> shapes;
+  shapes.reserve(srcs_.size());
+  for (TensorHandle* src : srcs_) {
+    // AsProtoTensorContent doesn't work when the tensor is on the GPU, hence
+    // copy it to the CPU before copying it out.
+    Tensor tensor;
+    Status s = src->CopyToDevice(*ctx_, ctx_->HostCPU(), &tensor);
+    if (!s.ok()) {
+      PoisonRemoteMirrors(s, context_view_id);
+      done(s);
+      return;
+    }
+    tensor.AsProtoTensorContent(send_tensor->add_tensors());
+    shapes.push_back(tensor.shape());
+  }
+
+  core::RefCountPtr<eager::EagerClient> eager_client;
+  Status s = ctx_->GetClient(recv_device_, &eager_client);
+  if (!s.ok()) {
+    PoisonRemoteMirrors(s, context_view_id);
+    done(s);
+    return;
+  }
+  // The callback may outlive this node, so it holds its own refs on the
+  // handles whose mirrors it sets.
+  std::vector<TensorHandle*> dsts = srcs_;
+  for (TensorHandle* dst : dsts) {
+    dst->Ref();
+  }
+  EnqueueResponse* response = new EnqueueResponse;
+  Device* recv_device = recv_device_;
+  eager_client->StreamingEnqueueAsync(
+      ctx_->Executor().StreamingEnqueue(),
+      /*call_opts=*/nullptr, &request, response,
+      [dsts = std::move(dsts), shapes = std::move(shapes), response,
+       recv_device, context_view_id, done](const Status& s) {
+        for (int i = 0, end = dsts.size(); i < end; ++i) {
+          if (s.ok()) {
+            Status status = dsts[i]->SetRemoteShape(shapes[i], recv_device,
+                                                    context_view_id);
+            if (!status.ok()) {
+              LOG(ERROR) << "Ignoring an error encountered when setting "
+                            "remote shape of tensor received by SendTensor "
+                            "rpc: "
+                         << status.ToString();
+            }
+          } else {
+            dsts[i]->PoisonRemote(s, recv_device, context_view_id);
+          }
+          dsts[i]->Unref();
+        }
+        done(s);
+        delete response;
+      });
+}
+
+void RemoteSendTensorsNode::Abort(Status status) {
+  if (!started_) {
+    PoisonRemoteMirrors(status, ctx_->GetContextViewId());
+  }
+}
+
 }  // namespace eager
 }  // namespace tensorflow
@@ -173,6 +173,44 @@ class RemoteCopyNode : public AsyncEagerNode {
   bool started_;
 };
 
+// Copies several local tensors to the same remote device with a single
+// EnqueueRequest holding one SendTensor op, instead of issuing one RPC per
+// tensor as RemoteCopyNode does. The i-th tensor becomes output i of
+// `recv_op_id` on `recv_device`, which must already have been added as an
+// unshaped remote mirror of the i-th source handle. This node is only used
+// when ctx->UseSendTensorRPC() is true.
+class RemoteSendTensorsNode : public AsyncEagerNode {
+ public:
+  RemoteSendTensorsNode(EagerContext* ctx, std::vector<TensorHandle*> srcs,
+                        Device* recv_device, uint64 recv_op_id);
+
+  ~RemoteSendTensorsNode() override;
+
+  void RunAsync(StatusCallback done) override;
+
+  void Abort(Status status) override;
+
+  string DebugString() const override {
+    string out = "[RemoteSendTensorsNode]";
+    strings::StrAppend(&out, " recv_device: ", recv_device_->name());
+    strings::StrAppend(&out, ", recv_op_id: ", recv_op_id_);
+    for (TensorHandle* src : srcs_) {
+      strings::StrAppend(&out, ", send_tensor: ", src->DebugString());
+    }
+    return out;
+  }
+
+ private:
+  void PoisonRemoteMirrors(const Status& status, uint64 context_view_id);
+
+  EagerContext* const ctx_;
+  // The handles whose remote mirrors are set by this node. Each holds a ref.
+  const std::vector<TensorHandle*> srcs_;
+  Device* const recv_device_;
+  const uint64 recv_op_id_;
+  bool started_;
+};
+
 }  // namespace eager
 }  // namespace tensorflow
 
@@ -181,6 +181,8 @@ Status GraphMgr::InitItem(const string& handle, const GraphDef& gdef,
   popts.flib_def = item->lib_def.get();
   popts.control_flow_added = true;
   popts.scheduling_for_recvs = graph_options.enable_recv_scheduling();
+  popts.sendrecv_packing_threshold_bytes =
+      graph_options.sendrecv_packing_threshold_bytes();
   TF_RETURN_IF_ERROR(Partition(popts, &graph, &partitions));
   if (popts.scheduling_for_recvs) {
     TF_RETURN_IF_ERROR(AddControlEdges(popts, &partitions));
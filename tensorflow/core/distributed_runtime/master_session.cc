@@ -505,6 +505,11 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
 }
 
 namespace {
+// The RunGraph requests of steps with at least this many partitions are built
+// in parallel, each costing about kRunGraphRequestCost cycles.
+constexpr int kMinPartitionsForParallelRequests = 64;
+constexpr int64_t kRunGraphRequestCost = 10000;
+
 // Helper class to manage "num" parallel RunGraph calls.
 class RunManyGraphs {
  public:
@@ -673,7 +678,7 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   const int num = partitions_.size();
   RunManyGraphs calls(num);
 
-  for (int i = 0; i < num; ++i) {
+  auto build_request = [&](int i) -> Status {
     const Part& part = partitions_[i];
     RunManyGraphs::Call* c = calls.get(i);
     c->worker_name = &part.name;
@@ -734,6 +739,27 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
         c->req->add_recv_key(key);
       }
     }
+    return OkStatus();
+  };
+
+  // Building the requests of many partitions is visible on the master for
+  // short steps, so they are built in parallel.
+  if (num < kMinPartitionsForParallelRequests) {
+    for (int i = 0; i < num; ++i) {
+      TF_RETURN_IF_ERROR(build_request(i));
+    }
+  } else {
+    std::vector<Status> statuses(num);
+    ComputePool(session_opts_)
+        ->ParallelFor(num, kRunGraphRequestCost,
+                      [&](int64_t start, int64_t limit) {
+                        for (int64_t i = start; i < limit; ++i) {
+                          statuses[i] = build_request(i);
+                        }
+                      });
+    for (const Status& s : statuses) {
+      TF_RETURN_IF_ERROR(s);
+    }
   }
 
   // Issues RunGraph calls.
@@ -1717,6 +1743,8 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
       return dtype;
     }
   };
+  popts.sendrecv_packing_threshold_bytes =
+      session_opts_.config.graph_options().sendrecv_packing_threshold_bytes();
   if (session_opts_.config.graph_options().enable_recv_scheduling()) {
     popts.scheduling_for_recvs = true;
     popts.need_to_record_start_times = true;
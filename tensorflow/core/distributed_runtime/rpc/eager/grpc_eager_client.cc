@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
+#include <memory>
 #include <string>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -72,6 +74,27 @@ bool EnableStreaming() {
   return result;
 }
 
+/* Setting environment variable "TF_EAGER_CLIENT_ENQUEUE_BATCH_WINDOW_US" to a
+ * positive value makes streaming enqueue coalesce the remote ops queued
+ * within that many microseconds into a single request, up to
+ * "TF_EAGER_CLIENT_ENQUEUE_BATCH_MAX_ITEMS" (default 256) queue items per
+ * request. This trades some latency for throughput when a client runs many
+ * small ops on a remote worker. Batching is disabled by default.
+ */
+int64_t EnqueueBatchWindowMicros() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_WINDOW_US", 0,
+                                  &result));
+  return result;
+}
+
+int64_t EnqueueBatchMaxItems() {
+  int64_t result;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_ENQUEUE_BATCH_MAX_ITEMS",
+                                  256, &result));
+  return result;
+}
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -122,8 +145,20 @@ class GrpcEagerClient : public EagerClient {
     // outlives the client.
     thread_->Ref();
     cq_ = thread->completion_queue();
+    const int64_t batch_window_micros = EnqueueBatchWindowMicros();
+    if (batch_window_micros > 0 && EnableStreaming()) {
+      enqueue_batcher_ = std::make_unique<EnqueueBatcher>(
+          Env::Default(), batch_window_micros, EnqueueBatchMaxItems(),
+          [this](const EnqueueRequest* request, EnqueueResponse* response,
+                 StatusCallback done) {
+            SendStreamingEnqueueRequest(request, response, std::move(done));
+          });
+    }
+  }
+  ~GrpcEagerClient() override {
+    enqueue_batcher_.reset();
+    thread_->Unref();
   }
-  ~GrpcEagerClient() override { thread_->Unref(); }
 
   bool allow_multiple_pending_requests() const override {
     return EnableStreaming();
@@ -133,6 +168,7 @@ class GrpcEagerClient : public EagerClient {
   void method##Async(const method##Request* request,                      \
                      method##Response* response, StatusCallback done)     \
       override {                                                          \
+    FlushEnqueueBatch();                                                  \
     StatusCallback done_wrapped = callback_wrapper(std::move(done));      \
     new RPCState<protobuf::Message>(                                      \
         &stub_, cq_, "/tensorflow.eager.EagerService/" #method, *request, \
@@ -152,6 +188,7 @@ class GrpcEagerClient : public EagerClient {
   void method##Async(CallOptions* call_opts, const method##Request* request,  \
                      method##Response* response, StatusCallback done)         \
       override {                                                              \
+    FlushEnqueueBatch();                                                      \
     StatusCallback done_wrapped = callback_wrapper(std::move(done));          \
     new RPCState<protobuf::Message>(                                          \
         &stub_, cq_, "/tensorflow.eager.EagerService/" #method, *request,     \
@@ -167,6 +204,7 @@ class GrpcEagerClient : public EagerClient {
   void CloseContextAsync(const CloseContextRequest* request,
                          CloseContextResponse* response,
                          StatusCallback done) override {
+    FlushEnqueueBatch();
     StatusCallback done_wrapped = callback_wrapper(std::move(done));
     new RPCState<protobuf::Message>(
         &stub_, cq_, "/tensorflow.eager.EagerService/CloseContext", *request,
@@ -199,19 +237,12 @@ class GrpcEagerClient : public EagerClient {
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      if (enqueue_batcher_ != nullptr) {
+        enqueue_batcher_->Enqueue(request, response, std::move(done_wrapped));
+      } else {
+        SendStreamingEnqueueRequest(request, response,
+                                    std::move(done_wrapped));
       }
-      // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -237,6 +268,35 @@ class GrpcEagerClient : public EagerClient {
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
 
+  // Null unless enqueue batching is enabled. Destroyed first, as it sends its
+  // pending requests through the members above.
+  std::unique_ptr<EnqueueBatcher> enqueue_batcher_;
+
+  void SendStreamingEnqueueRequest(const EnqueueRequest* request,
+                                   EnqueueResponse* response,
+                                   StatusCallback done) {
+    mutex_lock l(mu_);
+    auto it = enqueue_dispatchers_.find(request->context_id());
+    if (it == enqueue_dispatchers_.end()) {
+      auto it_and_bool = enqueue_dispatchers_.emplace(
+          std::piecewise_construct,
+          std::forward_as_tuple(request->context_id()),
+          std::forward_as_tuple(
+              &stub_, cq_, "/tensorflow.eager.EagerService/StreamingEnqueue"));
+      it = it_and_bool.first;
+    }
+    // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
+    it->second.SendNextRequest(*request, response, std::move(done));
+  }
+
+  // Sends the batched remote ops before any other request, so that the
+  // requests leave the client in the order they were issued.
+  void FlushEnqueueBatch() {
+    if (enqueue_batcher_ != nullptr) {
+      enqueue_batcher_->Flush();
+    }
+  }
+
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
     return [this, done = std::move(done)](const Status& status) {
@@ -269,8 +269,13 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   master_service_ = NewGrpcMasterService(master_impl_.get(), config, &builder);
   worker_impl_ = opts.worker_func ? opts.worker_func(&worker_env_, config)
                                   : NewGrpcWorker(&worker_env_, config);
+  GrpcWorkerServiceOptions worker_service_options = opts.worker_service_options;
+  if (config.rpc_options().num_worker_service_completion_queues() > 0) {
+    worker_service_options.num_serving_threads =
+        config.rpc_options().num_worker_service_completion_queues();
+  }
   worker_service_ = NewGrpcWorkerService(worker_impl_.get(), &builder,
-                                         opts.worker_service_options)
+                                         worker_service_options)
                         .release();
   eager_service_ = new eager::GrpcEagerServiceImpl(&worker_env_, &builder);
   thread::ThreadPool* compute_pool = ComputePool(sess_opts);
@@ -585,9 +590,16 @@ std::shared_ptr<::grpc::ServerCredentials> GrpcServer::GetServerCredentials(
 }
 
 ChannelCreationFunction GrpcServer::GetChannelCreationFunction() const {
+  // Only the channel pooling option applies to the channels between servers,
+  // so that every channel to a target gets its own connection.
+  RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(
+      server_def_.default_session_config()
+          .rpc_options()
+          .num_channels_per_target());
   // We can do this because SparseGrpcChannelCache is robust to nullptr being
   // returned by the channel creation function
-  return ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  return ConvertToChannelCreationFunction(NewHostPortGrpcChannel, rpc_options);
 }
 
 std::unique_ptr<Master> GrpcServer::CreateMaster(MasterEnv* master_env) {
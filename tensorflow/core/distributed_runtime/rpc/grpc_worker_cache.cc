@@ -59,7 +59,7 @@ class GrpcWorkerCache : public WorkerCachePartial {
       if (!channel) {
         return nullptr;
       }
-      size_t index = AssignWorkerToThread(target);
+      size_t index = AssignWorkerToThread(channel.get());
       return NewGrpcRemoteWorker(
           channel, worker_env_->GetCompletionQueue(index),
           worker_env_->GetThreadPool(), &logger_, target);
@@ -97,14 +97,16 @@ class GrpcWorkerCache : public WorkerCachePartial {
   }
 
  private:
-  size_t AssignWorkerToThread(const string& target) {
-    // Round-robin target assignment, but keeps the same target on the same
-    // polling thread always, as this is important for gRPC performance
+  size_t AssignWorkerToThread(const ::grpc::Channel* channel) {
+    // Round-robin channel assignment, but keeps the same channel on the same
+    // polling thread always, as this is important for gRPC performance. With
+    // RPCOptions.num_channels_per_target > 1, the channels to one target are
+    // thus polled by different threads.
     mutex_lock lock(assignment_mu_);
-    auto it = target_assignments_.find(target);
-    if (it == target_assignments_.end()) {
-      it = target_assignments_
-               .insert(std::make_pair(target,
+    auto it = channel_assignments_.find(channel);
+    if (it == channel_assignments_.end()) {
+      it = channel_assignments_
+               .insert(std::make_pair(channel,
                                       (next_round_robin_assignment_++) %
                                           worker_env_->CompletionQueueSize()))
                .first;
@@ -119,7 +121,9 @@ class GrpcWorkerCache : public WorkerCachePartial {
   GrpcWorkerEnv* worker_env_;  // Not owned
 
   mutex assignment_mu_;
-  std::unordered_map<std::string, size_t> target_assignments_
+  // Channels are never deleted by `channel_cache_`, so their address
+  // identifies them.
+  std::unordered_map<const ::grpc::Channel*, size_t> channel_assignments_
       TF_GUARDED_BY(assignment_mu_);
   size_t next_round_robin_assignment_ TF_GUARDED_BY(assignment_mu_);
 };
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <functional>
 #include <string>
@@ -22,23 +24,31 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_session.h"
 #include "tensorflow/core/distributed_runtime/server_lib.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/default_device.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/cluster.pb.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/tensorflow_server.pb.h"
 #include "tensorflow/core/public/session.h"
 
 namespace tensorflow {
 
 static const int kWorkers = 60;
+// The task resolving the groups of the collectives of BM_RecvBuf.
+static const char kCollectiveGroupLeader[] = "/job:localhost/replica:0/task:0";
 static thread::ThreadPool* worker_threads;
 
 void MakeGRPCCluster(const SessionOptions& options, int n,
@@ -82,6 +92,8 @@ void MakeGRPCCluster(const SessionOptions& options, int n,
       auto config = server.mutable_default_session_config();
       (*config->mutable_device_count())["CPU"] = num_cpus;
       (*config->mutable_device_count())["GPU"] = num_gpus;
+      config->mutable_experimental()->set_collective_group_leader(
+          kCollectiveGroupLeader);
 
       std::unique_ptr<ServerInterface> svr;
       TF_CHECK_OK(NewServer(server, &svr));
@@ -108,6 +120,8 @@ struct Cluster {
     (*options.config.mutable_device_count())["CPU"] = 1;
     options.config.set_intra_op_parallelism_threads(1);
     options.config.set_inter_op_parallelism_threads(1);
+    options.config.mutable_experimental()->set_collective_group_leader(
+        kCollectiveGroupLeader);
     MakeGRPCCluster(options, kWorkers, &workers, &devices);
     LOG(ERROR) << "C " << workers.size() << " " << devices.size() << " "
                << workers[0] << " " << workers[1];
@@ -255,4 +269,209 @@ BENCHMARK(BM_SingleDevice)
     ->ArgPair(4, 10000)
     ->ArgPair(1, 1000000);
 
+// Returns the options of a session running its graphs as built, so that
+// constant folding doesn't remove the transfers being measured.
+static SessionOptions UnoptimizedOptions(const Cluster* cluster) {
+  SessionOptions options = cluster->options;
+  GraphOptions* graph_options = options.config.mutable_graph_options();
+  graph_options->mutable_optimizer_options()->set_opt_level(
+      OptimizerOptions::L0);
+  graph_options->mutable_rewrite_options()->set_disable_meta_optimizer(true);
+  return options;
+}
+
+// Runs `step` `concurrency` times in parallel per benchmark iteration, and
+// reports the 50th and 99th percentiles of its latency in microseconds.
+static void RunConcurrentSteps(::testing::benchmark::State& state,
+                               int concurrency,
+                               const std::function<void()>& step) {
+  thread::ThreadPool pool(Env::Default(), "rpcbench_clients", concurrency);
+  mutex mu;
+  std::vector<int64_t> latencies_us;
+  auto timed_step = [&]() {
+    const uint64 start_us = Env::Default()->NowMicros();
+    step();
+    const int64_t latency_us = Env::Default()->NowMicros() - start_us;
+    mutex_lock l(mu);
+    latencies_us.push_back(latency_us);
+  };
+
+  for (auto s : state) {
+    BlockingCounter done(concurrency);
+    for (int i = 0; i < concurrency; ++i) {
+      pool.Schedule([&]() {
+        timed_step();
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+
+  if (latencies_us.empty()) return;
+  std::sort(latencies_us.begin(), latencies_us.end());
+  auto percentile = [&](double p) {
+    return static_cast<double>(
+        latencies_us[static_cast<size_t>(p * (latencies_us.size() - 1))]);
+  };
+  state.counters["p50_us"] = percentile(0.5);
+  state.counters["p99_us"] = percentile(0.99);
+  state.SetItemsProcessed(state.iterations() * concurrency);
+}
+
+// Measures RecvTensor: each step fetches a tensor of `tensor_size` floats from
+// each of `num_channels` remote workers into worker 0, with `concurrency`
+// steps in flight.
+static void BM_RecvTensor(::testing::benchmark::State& state) {
+  const int num_channels = state.range(0);
+  const int tensor_size = state.range(1);
+  const int concurrency = state.range(2);
+  const Cluster* cluster = GetCluster();
+  CHECK_LT(num_channels, cluster->devices.size());
+
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Scope s = Scope::NewRootScope();
+  std::vector<Output> remote_tensors;
+  for (int i = 1; i <= num_channels; ++i) {
+    remote_tensors.push_back(
+        Const(s.WithOpName(strings::StrCat("x", i))
+                  .WithDevice(cluster->devices[i].name()),
+              0.0f, {tensor_size}));
+  }
+  AddN(s.WithOpName("y").WithDevice(cluster->devices[0].name()),
+       remote_tensors);
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+
+  std::unique_ptr<Session> session(NewSession(UnoptimizedOptions(cluster)));
+  TF_CHECK_OK(session->Create(def));
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, {"y"}, nullptr));
+  }
+
+  state.SetLabel(strings::StrCat(num_channels, " channels; ", concurrency,
+                                 " concurrent steps; tensor bytes/send: ",
+                                 tensor_size * sizeof(float)));
+  RunConcurrentSteps(state, concurrency, [&session]() {
+    TF_CHECK_OK(session->Run({}, {}, {"y"}, nullptr));
+  });
+  state.SetBytesProcessed(state.iterations() * concurrency * num_channels *
+                          tensor_size * sizeof(float));
+  TF_CHECK_OK(session->Close());
+}
+BENCHMARK(BM_RecvTensor)
+    ->Args({1, 1, 1})
+    ->Args({1, 1, 16})
+    ->Args({1, 1 << 20, 1})
+    ->Args({1, 1 << 20, 4})
+    ->Args({8, 1, 1})
+    ->Args({8, 1 << 16, 4})
+    ->Args({32, 1 << 16, 16})
+    ->UseRealTime();
+
+// Measures RunGraph: each step runs an empty partition on each of
+// `num_workers` workers, with `concurrency` steps in flight.
+static void BM_RunGraph(::testing::benchmark::State& state) {
+  const int num_workers = state.range(0);
+  const int concurrency = state.range(1);
+  const Cluster* cluster = GetCluster();
+  CHECK_LE(num_workers, cluster->devices.size());
+
+  using namespace ::tensorflow::ops;  // NOLINT(build/namespaces)
+  Scope s = Scope::NewRootScope();
+  std::vector<string> targets;
+  for (int i = 0; i < num_workers; ++i) {
+    targets.push_back(strings::StrCat("noop", i));
+    NoOp(s.WithOpName(targets.back()).WithDevice(cluster->devices[i].name()));
+  }
+  GraphDef def;
+  TF_CHECK_OK(s.ToGraphDef(&def));
+
+  std::unique_ptr<Session> session(NewSession(UnoptimizedOptions(cluster)));
+  TF_CHECK_OK(session->Create(def));
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, targets, nullptr));
+  }
+
+  state.SetLabel(strings::StrCat(num_workers, " workers; ", concurrency,
+                                 " concurrent steps"));
+  RunConcurrentSteps(state, concurrency, [&session, &targets]() {
+    TF_CHECK_OK(session->Run({}, {}, targets, nullptr));
+  });
+  TF_CHECK_OK(session->Close());
+}
+BENCHMARK(BM_RunGraph)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 16)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 16)
+    ->ArgPair(60, 1)
+    ->ArgPair(60, 4)
+    ->UseRealTime();
+
+// Measures RecvBuf: each step all-reduces a tensor of `tensor_size` floats
+// with a ring across `group_size` workers, whose chunks are transferred with
+// RecvBuf.
+static void BM_RecvBuf(::testing::benchmark::State& state) {
+  const int group_size = state.range(0);
+  const int tensor_size = state.range(1);
+  const Cluster* cluster = GetCluster();
+  CHECK_LE(group_size, cluster->devices.size());
+  // Collective instances are resolved once per worker process, so each run of
+  // the benchmark needs its own instance. Groups of the same size have the same
+  // members and can be shared.
+  static std::atomic<int> next_instance_key{1};
+  const int instance_key = next_instance_key++;
+
+  GraphDef def;
+  std::vector<string> targets;
+  for (int i = 0; i < group_size; ++i) {
+    const string& device = cluster->devices[i].name();
+    Tensor value(DT_FLOAT, TensorShape({tensor_size}));
+    value.flat<float>().setConstant(1.0f);
+    NodeDef* input = def.add_node();
+    TF_CHECK_OK(NodeDefBuilder(strings::StrCat("x", i), "Const")
+                    .Device(device)
+                    .Attr("dtype", DT_FLOAT)
+                    .Attr("value", value)
+                    .Finalize(input));
+    targets.push_back(strings::StrCat("reduce", i));
+    TF_CHECK_OK(NodeDefBuilder(targets.back(), "CollectiveReduce")
+                    .Device(device)
+                    .Input(input->name(), 0, DT_FLOAT)
+                    .Attr("group_size", group_size)
+                    .Attr("group_key", group_size)
+                    .Attr("instance_key", instance_key)
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Id")
+                    .Attr("subdiv_offsets", std::vector<int>({0}))
+                    .Attr("communication_hint", "ring")
+                    .Finalize(def.add_node()));
+  }
+
+  std::unique_ptr<Session> session(NewSession(UnoptimizedOptions(cluster)));
+  TF_CHECK_OK(session->Create(def));
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, targets, nullptr));
+  }
+
+  state.SetLabel(strings::StrCat(group_size, " workers; tensor bytes: ",
+                                 tensor_size * sizeof(float)));
+  // Collectives of a step must all run before the next step starts, so steps
+  // are not concurrent.
+  RunConcurrentSteps(state, 1, [&session, &targets]() {
+    TF_CHECK_OK(session->Run({}, {}, targets, nullptr));
+  });
+  // A ring all-reduce sends 2 * (n - 1) / n times the tensor from each worker.
+  state.SetBytesProcessed(state.iterations() * 2 * (group_size - 1) *
+                          tensor_size * sizeof(float));
+  TF_CHECK_OK(session->Close());
+}
+BENCHMARK(BM_RecvBuf)
+    ->ArgPair(2, 1 << 10)
+    ->ArgPair(2, 1 << 20)
+    ->ArgPair(8, 1 << 10)
+    ->ArgPair(8, 1 << 20)
+    ->ArgPair(16, 1 << 20)
+    ->UseRealTime();
+
 }  // namespace tensorflow
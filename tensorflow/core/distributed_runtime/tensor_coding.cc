@@ -30,6 +30,7 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  staging_allocator_ = nullptr;
   already_used_ = false;
   ClearTensor();
 }
@@ -48,6 +49,14 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
     on_host_ = true;
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
+  if (on_host_) {
+    staging_allocator_ = allocator_;
+  } else {
+    AllocatorAttributes staging_attrs;
+    staging_attrs.set_on_host(true);
+    staging_attrs.set_gpu_compatible(true);
+    staging_allocator_ = device_->GetAllocator(staging_attrs);
+  }
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
@@ -80,15 +89,22 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
+  if (already_used_) {
+    ClearTensor();
+  }
+  already_used_ = true;
   if (!on_host_) {
+    Status s;
+    if (ParseFastToDevice(source, &s)) return s;
+    meta_.Clear();
+
     protobuf::io::CodedInputStream input(source->contents());
 
-    // Pre-parse into local storage, then delegate to device.
+    // Slow path: pre-parse into local storage, then delegate to device.
     if (!meta_.ParseFromCodedStream(&input) || !input.ConsumedEntireMessage()) {
       return errors::InvalidArgument("Cannot parse tensor from response");
     }
-    Status s =
-        device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
+    s = device_->MakeTensorFromProto(meta_.tensor(), alloc_attrs_, &tensor_);
     // Reduce memory usage for big tensors.
     {
       TensorProto empty;
@@ -97,10 +113,6 @@ Status TensorResponse::ParseFrom(Source* source) {
     meta_.clear_tensor();
     return s;
   }
-  if (already_used_) {
-    ClearTensor();
-  }
-  already_used_ = true;
   if (ParseFast(source)) return OkStatus();
   meta_.Clear();
   if (ParseSlow(source)) return OkStatus();
@@ -155,7 +167,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(staging_allocator_, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -195,12 +207,12 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(staging_allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
+        // This is the only copy of the content on the receive side: the
+        // stream's buffers are neither owned by us nor aligned for the
+        // allocator, so they are read straight into the destination tensor.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -275,6 +287,23 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+bool TensorResponse::ParseFastToDevice(Source* source, Status* status) {
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device_->tensorflow_accelerator_device_info();
+  if (device_info == nullptr || device_info->default_context == nullptr ||
+      staging_allocator_ == nullptr) {
+    return false;
+  }
+  if (!ParseFast(source)) return false;
+  Tensor staging = std::move(tensor_);
+  tensor_ = Tensor(allocator_, staging.dtype(), staging.shape());
+  if (staging.NumElements() > 0) {
+    *status = device_info->default_context->CopyCPUTensorToDeviceSync(
+        &staging, static_cast<Device*>(device_), &tensor_);
+  }
+  return true;
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
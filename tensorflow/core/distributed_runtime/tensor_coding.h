@@ -95,11 +95,18 @@ class TensorResponse {
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
+  // Parses into a host tensor allocated from staging_allocator_, then copies
+  // it to the device. Returns false if the parse needs the slow path.
+  bool ParseFastToDevice(Source* source, Status* status);
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // Allocator of the host tensor that the fast path reads tensor content
+  // into. Same as allocator_ on host; for an accelerator, it allocates host
+  // memory the device can DMA from (e.g. pinned memory for GPUs).
+  Allocator* staging_allocator_ = nullptr;
   bool already_used_ = false;
   Tensor tensor_;
   RecvTensorResponse meta_;
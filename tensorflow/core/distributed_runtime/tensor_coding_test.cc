@@ -17,8 +17,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +48,63 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// Copies from host to "device" tensors, which live in host memory here.
+class DummyDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()),
+           cpu_tensor->tensor_data().data(), cpu_tensor->TotalBytes());
+    done(OkStatus());
+  }
+
+  int num_copies() const { return num_copies_; }
+
+ private:
+  mutable int num_copies_ = 0;
+};
+
+class DummyAcceleratorDevice : public DeviceBase {
+ public:
+  explicit DummyAcceleratorDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("GPU");
+    context_ = new DummyDeviceContext;
+    device_info_.default_context = context_;
+    set_tensorflow_accelerator_device_info(&device_info_);
+  }
+  ~DummyAcceleratorDevice() override { context_->Unref(); }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (attr.on_host() && attr.gpu_compatible()) ++num_staging_allocators_;
+    return cpu_allocator();
+  }
+
+  Status MakeTensorFromProto(const TensorProto& tensor_proto,
+                             const AllocatorAttributes alloc_attrs,
+                             Tensor* tensor) override {
+    ++num_protos_;
+    if (!tensor->FromProto(cpu_allocator(), tensor_proto)) {
+      return errors::InvalidArgument("Cannot parse tensor from proto");
+    }
+    return OkStatus();
+  }
+
+  const DummyDeviceContext* context() const { return context_; }
+  int num_staging_allocators() const { return num_staging_allocators_; }
+  int num_protos() const { return num_protos_; }
+
+ private:
+  DeviceAttributes attr_;
+  AcceleratorDeviceInfo device_info_;
+  DummyDeviceContext* context_;
+  int num_staging_allocators_ = 0;
+  int num_protos_ = 0;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +215,43 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, ParsesIntoStagingMemoryForAccelerator) {
+  Tensor src(DT_FLOAT, TensorShape({4, 1000}));
+  test::FillIota<float>(&src, 0.5f);
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  DummyAcceleratorDevice device(Env::Default());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  EXPECT_EQ(device.num_staging_allocators(), 1);
+  for (int i = 0; i < 2; i++) {  // Twice so we exercise reuse of "response"
+    StringSource source(&encoded, 1024);
+    TF_EXPECT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+    test::ExpectTensorEqual<float>(response.tensor(), src);
+  }
+  // Content is copied to the device from the staging tensor, and never goes
+  // through a TensorProto.
+  EXPECT_EQ(device.context()->num_copies(), 2);
+  EXPECT_EQ(device.num_protos(), 0);
+
+  // Tensors the fast path can't decode still go through the device.
+  Tensor strings(DT_STRING, TensorShape({2}));
+  test::FillValues<tstring>(&strings, {"a", "b"});
+  proto.Clear();
+  strings.AsProtoTensorContent(proto.mutable_tensor());
+  encoded.clear();
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+  TF_EXPECT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<tstring>(response.tensor(), strings);
+  EXPECT_EQ(device.num_protos(), 1);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
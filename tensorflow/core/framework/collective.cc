@@ -88,6 +88,7 @@ CollInstanceParams& CollInstanceParams::operator=(
         other.impl_details.subdiv_source_rank.begin(),
         other.impl_details.subdiv_source_rank.end());
     impl_details.dependencies = other.impl_details.dependencies;
+    impl_details.sub_chunk_bytes = other.impl_details.sub_chunk_bytes;
     devices.assign(other.devices.begin(), other.devices.end());
     permutation.assign(other.permutation.begin(), other.permutation.end());
   }
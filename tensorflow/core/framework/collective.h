@@ -116,6 +116,11 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // When positive, tensors exchanged with peers in other tasks are split into
+  // sub-chunks of about this many bytes, each transferred separately so that
+  // the transfer of one sub-chunk overlaps with the copy of the previous ones
+  // to the device. All members of the collective must use the same value.
+  int64_t sub_chunk_bytes = 0;
 };
 
 // Data common to all members of a collective instance.
@@ -286,15 +291,19 @@ class CollectiveRemoteAccess {
                             Tensor* to_tensor,
                             const DeviceLocality& client_locality,
                             int dev_to_dev_stream_index,
+                            int64_t sub_chunk_bytes,
                             CancellationManager* cancellation_manager,
                             const StatusCallback& done) = 0;
 
+  // `sub_chunk_bytes` must match between the sender and the receiver. See
+  // `CollImplDetails::sub_chunk_bytes`.
   virtual void PostToPeer(const string& peer_device, const string& peer_task,
                           const string& key, Device* from_device,
                           DeviceContext* from_device_ctx,
                           const AllocatorAttributes& from_alloc_attr,
                           const Tensor* from_tensor,
                           const DeviceLocality& client_locality,
+                          int64_t sub_chunk_bytes,
                           CancellationManager* cancellation_manager,
                           const StatusCallback& done) = 0;
 
@@ -828,6 +828,13 @@ Status DatasetBase::Get(OpKernelContext* ctx, int64 index,
       "Random access is not implemented for this dataset.");
 }
 
+Status DatasetBase::Get(IteratorContext* ctx, int64 index,
+                        std::vector<Tensor>* out_tensors) const {
+  return errors::Unimplemented("Random access from an iterator is not "
+                               "implemented for this dataset of type ",
+                               DebugString(), ".");
+}
+
 StatusOr<DatasetBase*> DatasetBase::Finalize(
     OpKernelContext* ctx,
     std::function<StatusOr<core::RefCountPtr<DatasetBase>>()>
@@ -1027,6 +1027,10 @@ class IteratorBase : public Checkpointable {
     return 0;
   }
 
+  // Returns the autotuning model owned by this iterator, if any. Only the
+  // iterator at the root of an autotuned input pipeline owns one.
+  virtual std::shared_ptr<model::Model> GetModel() const { return nullptr; }
+
  protected:
   // Returns a node that models this iterator.
   virtual std::shared_ptr<model::Node> CreateNode(
@@ -1275,6 +1279,12 @@ class DatasetBase : public core::RefCounted {
   virtual Status Get(OpKernelContext* ctx, int64 index,
                      std::vector<Tensor>* out_tensors) const;
 
+  // Same as above, for datasets that are randomly accessed from one of their
+  // consumers' iterators (e.g. a dataset that permutes the indices of its
+  // input) rather than from an op kernel.
+  virtual Status Get(IteratorContext* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const;
+
   // Return a finalized version of the dataset.  The returned DatasetBase is
   // unowned and lives for as long as this dataset.
   virtual StatusOr<DatasetBase*> Finalize(
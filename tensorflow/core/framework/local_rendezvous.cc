@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
@@ -118,19 +119,27 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
   }
 }
 
+namespace {
+uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
+
+// How often the destructor checks for callbacks that are still running.
+constexpr int64_t kPendingCallbackPollMicros = 50;
+}  // namespace
+
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
   bool table_not_empty = false;
   for (int i = 0; i < num_buckets_; ++i) {
     auto& bucket = table_buckets_[i];
-    {
-      mutex_lock l(bucket.mu);
-      while (bucket.pending_callback_counter != 0) {
-        bucket.pending_callback_cond_var.wait_for(
-            l, std::chrono::milliseconds(50));
-      }
+    // Callbacks are only pending here when the owner is not refcounted, as
+    // pending items otherwise keep the owner alive. The counter is
+    // decremented without holding a lock, so poll it.
+    while (bucket.pending_callback_counter.load(std::memory_order_acquire) !=
+           0) {
+      Env::Default()->SleepForMicroseconds(kPendingCallbackPollMicros);
     }
+    mutex_lock l(bucket.mu);
     if (!bucket.table.empty()) {
       table_not_empty = true;
     }
@@ -140,10 +149,6 @@ LocalRendezvous::~LocalRendezvous() {
   }
 }
 
-namespace {
-uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
-}  // namespace
-
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -205,19 +210,13 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   } else {
     queue->head = item->next;
   }
-  bucket.pending_callback_counter++;
+  bucket.pending_callback_counter.fetch_add(1, std::memory_order_relaxed);
   // Invoke the done-callback, without holding the lock.
   bucket.mu.unlock();
 
   DCHECK_EQ(item->type, Item::kRecv);
   (*item->recv_state.waiter)(OkStatus(), send_args, item->args, val, is_dead);
-  {
-    mutex_lock l(bucket.mu);
-    bucket.pending_callback_counter--;
-    if (bucket.pending_callback_counter == 0) {
-      bucket.pending_callback_cond_var.notify_all();
-    }
-  }
+  bucket.pending_callback_counter.fetch_sub(1, std::memory_order_release);
   // Delete the item at last since it may unref and destruct the rendezvous.
   delete item;
   return OkStatus();
@@ -362,20 +361,14 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   } else {
     queue->head = item->next;
   }
-  bucket.pending_callback_counter++;
+  bucket.pending_callback_counter.fetch_add(1, std::memory_order_relaxed);
   // Invoke the done-callback, without holding the lock.
   bucket.mu.unlock();
 
   DCHECK_EQ(item->type, Item::kSend);
   done(OkStatus(), item->args, recv_args, *item->send_state.value,
        item->send_state.is_dead);
-  {
-    mutex_lock l(bucket.mu);
-    bucket.pending_callback_counter--;
-    if (bucket.pending_callback_counter == 0) {
-      bucket.pending_callback_cond_var.notify_all();
-    }
-  }
+  bucket.pending_callback_counter.fetch_sub(1, std::memory_order_release);
   // Delete the item at last since it may unref and destruct the rendezvous.
   delete item;
 }
@@ -400,6 +393,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
 
   // Keeps one Item to make sure the current rendezvous won't be destructed.
@@ -434,6 +428,9 @@ void LocalRendezvous::DoAbort(const Status& status) {
 }
 
 Status LocalRendezvous::status() {
+  if (TF_PREDICT_TRUE(!aborted_.load(std::memory_order_acquire))) {
+    return OkStatus();
+  }
   tf_shared_lock ml(mu_);
   return status_;
 }
@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -89,19 +91,25 @@ class LocalRendezvous {
   // nullptr otherwise.
   Rendezvous* rc_owner_;
 
-  struct TableBucket {
+  // Buckets are cache line aligned, so that Send and RecvAsync calls on keys
+  // of different buckets do not contend on the same cache line.
+  struct ABSL_CACHELINE_ALIGNED TableBucket {
     mutex mu;
     Table table TF_GUARDED_BY(mu);
 
-    // Track the number of pening callbacks using a counter.
-    int pending_callback_counter TF_GUARDED_BY(mu) = 0;
-    condition_variable pending_callback_cond_var TF_GUARDED_BY(mu);
+    // Track the number of pending callbacks using a counter. It is
+    // incremented under `mu`, but decremented without it, so that matching a
+    // Send with a RecvAsync only locks `mu` once.
+    std::atomic<int> pending_callback_counter{0};
   };
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
+  // True iff `status_` is not OK. Lets Send and RecvAsync, which read the
+  // status on every call, skip `mu_` until the rendezvous is aborted.
+  std::atomic<bool> aborted_{false};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
@@ -126,6 +126,13 @@ auto* tf_data_buffered_vs_budget_ratio_histogram =
         {tsl::monitoring::Buckets::Explicit(
             {0.0, 0.2, 0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0})});
 
+auto* tf_data_padding_ratio_histogram = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/data/padding_ratio",
+     "Fraction of the values in padded tf.data batches which are padding."},
+    // Uniform linear buckets with count 10 from 0 to 1
+    {tsl::monitoring::Buckets::Explicit(
+        {0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0})});
+
 auto* tf_data_iterator_busy_counter = tsl::monitoring::Counter<0>::New(
     "/tensorflow/data/iterator_busy",
     "The time (in microseconds) during which a "
@@ -241,6 +248,12 @@ auto* tf_data_autotune_stopping_criteria_counter =
         "algorithm stopping criterion is met.",
         "name");
 
+auto* tf_data_autotune_cpu_budget = tsl::monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/data/autotune_cpu_budget",
+    "The CPU budget of tf.data autotuning ('configured'), and the number of "
+    "cores measured to be available for it ('available').",
+    "type");
+
 auto* parse_dense_feature_counter = tsl::monitoring::Counter<0>::New(
     "/tensorflow/data/dense_feature",
     "The number of dense features parsed by ops for parsing tf.Example.");
@@ -407,7 +420,9 @@ tsl::monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
 }
 
 void RecordTFDataBytesFetched(int64_t num_bytes) {
-  tf_data_bytes_fetched_counter->GetCell()->IncrementBy(num_bytes);
+  static auto* tf_data_bytes_fetched_cell =
+      tf_data_bytes_fetched_counter->GetCell();
+  tf_data_bytes_fetched_cell->IncrementBy(num_bytes);
 }
 
 void RecordTFDataExperiment(const string& name) {
@@ -436,6 +451,12 @@ void RecordTFDataAutotuneMaxBufferBudgetRatio(const double ratio) {
   tf_data_buffered_vs_budget_ratio_histogram_cell->Add(ratio);
 }
 
+void RecordTFDataPaddingRatio(const double ratio) {
+  static auto* tf_data_padding_ratio_histogram_cell =
+      tf_data_padding_ratio_histogram->GetCell();
+  tf_data_padding_ratio_histogram_cell->Add(ratio);
+}
+
 void RecordTFDataIteratorBusy(uint64 duration_us) {
   static auto* tf_data_iterator_busy_cell =
       tf_data_iterator_busy_counter->GetCell();
@@ -555,6 +576,12 @@ void RecordTFDataAutotuneStoppingCriteria(const string& name) {
   tf_data_autotune_stopping_criteria_counter->GetCell(name)->IncrementBy(1);
 }
 
+void RecordTFDataAutotuneCpuBudget(int64_t cpu_budget,
+                                   int64_t available_cpus) {
+  tf_data_autotune_cpu_budget->GetCell("configured")->Set(cpu_budget);
+  tf_data_autotune_cpu_budget->GetCell("available")->Set(available_cpus);
+}
+
 void RecordParseDenseFeature(int64 num_features) {
   static auto* parse_dense_feature_counter_cell =
       parse_dense_feature_counter->GetCell();
@@ -95,6 +95,10 @@ void RecordTFDataAutotuneUsedRamBudgetRatio(const double ratio);
 // bytes over the ram budget.
 void RecordTFDataAutotuneMaxBufferBudgetRatio(const double ratio);
 
+// Records the histogram of the fraction of values in a padded tf.data batch
+// that are padding.
+void RecordTFDataPaddingRatio(const double ratio);
+
 // Records the number of times each tf.data fingerprint is used
 // to measure duplicate pre-processing.
 //
@@ -188,6 +192,10 @@ void RecordTFDataAutoShardRewriteBatchSize(
 // criterion is met.
 void RecordTFDataAutotuneStoppingCriteria(const string& name);
 
+// Records the CPU budget of tf.data autotuning, and the number of cores
+// measured to be actually available for it.
+void RecordTFDataAutotuneCpuBudget(int64_t cpu_budget, int64_t available_cpus);
+
 // Records parsing of dense tensor features.
 void RecordParseDenseFeature(int64_t num_features);
 
@@ -20,14 +20,19 @@ limitations under the License.
 #include <memory>
 #include <queue>
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -36,6 +41,36 @@ namespace model {
 constexpr int64_t Model::kOptimizationPeriodMinMs;
 constexpr int64_t Model::kOptimizationPeriodMaxMs;
 
+RamBudgetManager& RamBudgetManager::Get() {
+  static RamBudgetManager* manager = new RamBudgetManager();
+  return *manager;
+}
+
+RamBudgetManager::RamBudgetManager() {
+  int64_t budget;
+  Status s = ReadInt64FromEnvVar("TF_DATA_RAM_BUDGET_BYTES", 0, &budget);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring TF_DATA_RAM_BUDGET_BYTES: " << s;
+    budget = 0;
+  }
+  budget_ = budget;
+}
+
+int64_t RamBudgetManager::ModelRamBudget(int64_t model_ram_budget,
+                                         int64_t model_buffered_bytes) const {
+  const int64_t budget = budget_;
+  if (budget <= 0) {
+    return model_ram_budget;
+  }
+  const int64_t others_buffered_bytes =
+      std::max<int64_t>(0, buffered_bytes_ - model_buffered_bytes);
+  // Leave every model at least one byte so that autotuning still runs.
+  const int64_t available =
+      std::max<int64_t>(1, budget - others_buffered_bytes);
+  return model_ram_budget > 0 ? std::min(model_ram_budget, available)
+                              : available;
+}
+
 namespace {
 
 // This is the number of the latest gap times used to compute the target time
@@ -222,6 +257,36 @@ std::string RemoveArrayIndices(absl::string_view s) {
   return res;
 }
 
+// Reads `fname` in full. Unlike `ReadFileToString`, this does not rely on the
+// reported file size, which is zero for the files of /proc.
+Status ReadSystemFile(Env* env, const std::string& fname, std::string* data) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(fname, &file));
+  constexpr size_t kChunkSize = 4096;
+  std::string chunk(kChunkSize, '\0');
+  data->clear();
+  while (true) {
+    StringPiece result;
+    Status s = file->Read(data->size(), kChunkSize, &result, chunk.data());
+    data->append(result.data(), result.size());
+    if (errors::IsOutOfRange(s)) {
+      return OkStatus();
+    }
+    TF_RETURN_IF_ERROR(s);
+  }
+}
+
+// Returns the sum of the `parallelism` parameters.
+double TotalParallelism(const Model::ModelParameters& parameters) {
+  double parallelism = 0.0;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      parallelism += pair.second->value;
+    }
+  }
+  return parallelism;
+}
+
 // Returns true if all parameters have reached their max values.
 bool AreAllParametersMax(const Model::ModelParameters& parameters) {
   for (const auto& pair : parameters) {
@@ -659,11 +724,11 @@ class AsyncInterleaveMany : public Node {
 
   // The output time is the sum of self processing time and expected wait time
   // from the buffer model estimated using `ComputeWaitTime(producer_time,
-  // consumer_time, parallelism, ...)`, where `producer_time` is the average
+  // consumer_time, buffer_size, ...)`, where `producer_time` is the average
   // output time of inputs comprising the interleave "cycle" divided by
   // `parallelism`, `consumer_time` is the `input_time` specified through
-  // `input_times` divided by `num_inputs() - 1`, and if the node has
-  // parallelism parameter, then `buffer_size` is derived from `parallelism`.
+  // `input_times` divided by `num_inputs() - 1`, and `buffer_size` is
+  // `parallelism` plus the size of the reorder buffer, if the node has one.
   void OutputTimeLocked(const NodeValues& input_times,
                         ParameterGradients* gradients, NodeValues* output_times,
                         NodeValues* output_time_gradients) const override
@@ -692,12 +757,20 @@ class AsyncInterleaveMany : public Node {
         (*output_times)[inputs_.front()->long_name()];
     producer_time = output_time_for_inputs /
                     static_cast<double>(num_inputs() - 1) / parallelism;
+    // Results buffered in the reorder buffer let the consumer ride out slow
+    // cycle elements, just like a larger buffer would.
+    double buffer_size = parallelism;
+    auto* reorder_buffer_parameter =
+        gtl::FindOrNull(parameters_, kReorderBufferSize);
+    if (reorder_buffer_parameter) {
+      buffer_size += (*reorder_buffer_parameter)->value;
+    }
 
     if (gradients) {
       double producer_time_der = 0.0L;
       double consumer_time_der = 0.0L;
       double buffer_size_der = 0.0L;
-      wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
+      wait_time = ComputeWaitTime(producer_time, consumer_time, buffer_size,
                                   &producer_time_der, &consumer_time_der,
                                   &buffer_size_der);
       double inputs_time_der_sum =
@@ -726,8 +799,14 @@ class AsyncInterleaveMany : public Node {
         (*gradients)[std::make_pair(long_name(), (*parameter)->name)] =
             buffer_size_der - producer_time_der * producer_time / parallelism;
       }
+      if (reorder_buffer_parameter &&
+          (*reorder_buffer_parameter)->state->tunable) {
+        (*gradients)[std::make_pair(long_name(),
+                                    (*reorder_buffer_parameter)->name)] =
+            buffer_size_der;
+      }
     } else {
-      wait_time = ComputeWaitTime(producer_time, consumer_time, parallelism,
+      wait_time = ComputeWaitTime(producer_time, consumer_time, buffer_size,
                                   /*producer_time_derivative=*/nullptr,
                                   /*consumer_time_derivative=*/nullptr,
                                   /*buffer_size_derivative=*/nullptr);
@@ -758,14 +837,20 @@ class AsyncInterleaveMany : public Node {
   }
 
   double MaximumBufferedBytes() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    double buffered_elements = 0.0;
+    auto* reorder_buffer_parameter =
+        gtl::FindOrNull(parameters_, kReorderBufferSize);
+    if (reorder_buffer_parameter) {
+      buffered_elements += (*reorder_buffer_parameter)->value;
+    }
     auto* parameter = gtl::FindOrNull(parameters_, kMaxBufferedElements);
     if (parameter == nullptr) {
       parameter = gtl::FindOrNull(parameters_, kParallelism);
-      if (parameter == nullptr) {
-        return 0.0;
-      }
     }
-    return (*parameter)->value * AverageBufferedElementSize();
+    if (parameter) {
+      buffered_elements += (*parameter)->value;
+    }
+    return buffered_elements * AverageBufferedElementSize();
   }
 
   Status ToProto(ModelProto::Node* node_proto) const {
@@ -2175,6 +2260,133 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+AvailableCpuEstimator::AvailableCpuEstimator(Env* env) : env_(env) {}
+
+int64_t AvailableCpuEstimator::Estimate(int64_t max_cpus) {
+  max_cpus = std::max<int64_t>(max_cpus, 1);
+  double available = max_cpus;
+  std::optional<double> quota = ReadCgroupCpuQuota();
+  if (quota.has_value()) {
+    available = std::min(available, *quota);
+  }
+
+  std::string stat;
+  std::optional<CpuTimes> host_times;
+  if (ReadSystemFile(env_, "/proc/stat", &stat).ok()) {
+    host_times = ParseProcStat(stat);
+  }
+  std::optional<uint64_t> process_time;
+  if (ReadSystemFile(env_, "/proc/self/stat", &stat).ok()) {
+    process_time = ParseProcSelfStat(stat);
+  }
+  const double host_cpus = port::NumTotalCPUs();
+  if (host_times.has_value() && last_host_times_.has_value() &&
+      host_times->total > last_host_times_->total && host_cpus > 0) {
+    // All the counters are in clock ticks summed over the cores of the host.
+    const double total = host_times->total - last_host_times_->total;
+    const double idle =
+        static_cast<double>(host_times->idle) - last_host_times_->idle;
+    const double steal =
+        static_cast<double>(host_times->steal) - last_host_times_->steal;
+    double busy_by_others = (total - idle - steal) / total * host_cpus;
+    if (process_time.has_value() && last_process_time_.has_value()) {
+      busy_by_others -=
+          (static_cast<double>(*process_time) - *last_process_time_) / total *
+          host_cpus;
+    }
+    available =
+        std::min(available, host_cpus * (1.0 - steal / total) -
+                                std::max(busy_by_others, 0.0));
+  }
+  last_host_times_ = host_times;
+  last_process_time_ = process_time;
+  return std::clamp<int64_t>(std::floor(available), 1, max_cpus);
+}
+
+std::optional<double> AvailableCpuEstimator::ParseCgroupV2CpuMax(
+    absl::string_view cpu_max) {
+  // The file holds "$MAX $PERIOD", where $MAX is "max" without a quota.
+  std::vector<absl::string_view> fields = absl::StrSplit(
+      absl::StripAsciiWhitespace(cpu_max), ' ', absl::SkipEmpty());
+  double quota, period;
+  if (fields.size() != 2 || !absl::SimpleAtod(fields[0], &quota) ||
+      !absl::SimpleAtod(fields[1], &period) || quota <= 0 || period <= 0) {
+    return std::nullopt;
+  }
+  return quota / period;
+}
+
+std::optional<double> AvailableCpuEstimator::ParseCgroupV1CpuQuota(
+    absl::string_view quota, absl::string_view period) {
+  // The quota is -1 without a limit.
+  double quota_us, period_us;
+  if (!absl::SimpleAtod(absl::StripAsciiWhitespace(quota), &quota_us) ||
+      !absl::SimpleAtod(absl::StripAsciiWhitespace(period), &period_us) ||
+      quota_us <= 0 || period_us <= 0) {
+    return std::nullopt;
+  }
+  return quota_us / period_us;
+}
+
+std::optional<AvailableCpuEstimator::CpuTimes>
+AvailableCpuEstimator::ParseProcStat(absl::string_view stat) {
+  // The first line aggregates all the cores:
+  //   cpu user nice system idle iowait irq softirq steal guest guest_nice
+  // The guest times are already accounted for in the user times.
+  absl::string_view line = stat.substr(0, stat.find('\n'));
+  std::vector<absl::string_view> fields =
+      absl::StrSplit(line, ' ', absl::SkipEmpty());
+  if (fields.size() < 5 || fields[0] != "cpu") {
+    return std::nullopt;
+  }
+  uint64_t values[8] = {0};
+  for (size_t i = 0; i < 8 && i + 1 < fields.size(); ++i) {
+    if (!absl::SimpleAtoi(fields[i + 1], &values[i])) {
+      return std::nullopt;
+    }
+  }
+  CpuTimes times;
+  for (uint64_t value : values) {
+    times.total += value;
+  }
+  times.idle = values[3] + values[4];
+  times.steal = values[7];
+  return times;
+}
+
+std::optional<uint64_t> AvailableCpuEstimator::ParseProcSelfStat(
+    absl::string_view stat) {
+  // The command name, in parentheses, may contain spaces. The user and system
+  // times are the 14th and 15th fields, i.e. the 12th and 13th after it.
+  absl::string_view::size_type pos = stat.rfind(')');
+  if (pos == absl::string_view::npos) {
+    return std::nullopt;
+  }
+  std::vector<absl::string_view> fields =
+      absl::StrSplit(stat.substr(pos + 1), ' ', absl::SkipEmpty());
+  uint64_t user_time, system_time;
+  if (fields.size() < 13 || !absl::SimpleAtoi(fields[11], &user_time) ||
+      !absl::SimpleAtoi(fields[12], &system_time)) {
+    return std::nullopt;
+  }
+  return user_time + system_time;
+}
+
+std::optional<double> AvailableCpuEstimator::ReadCgroupCpuQuota() {
+  std::string quota;
+  if (ReadSystemFile(env_, "/sys/fs/cgroup/cpu.max", &quota).ok()) {
+    return ParseCgroupV2CpuMax(quota);
+  }
+  std::string period;
+  if (ReadSystemFile(env_, "/sys/fs/cgroup/cpu/cpu.cfs_quota_us", &quota)
+          .ok() &&
+      ReadSystemFile(env_, "/sys/fs/cgroup/cpu/cpu.cfs_period_us", &period)
+          .ok()) {
+    return ParseCgroupV1CpuQuota(quota, period);
+  }
+  return std::nullopt;
+}
+
 Model::Model()
     : optimization_period_ms_(kOptimizationPeriodMinMs),
       safe_to_collect_metrics_(std::make_shared<GuardedBool>(true)) {
@@ -2260,6 +2472,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     tf_shared_lock l(mu_);
     snapshot = output_->Snapshot();
   }
+  // Shrink the buffers of this model when the pipelines of the process
+  // together exceed the process-wide budget.
+  ram_budget = RamBudgetManager::Get().ModelRamBudget(
+      ram_budget, static_cast<int64_t>(TotalBufferedBytes(snapshot)));
   if (!port::JobName().empty()) {
     RecordAutotuneRamUsage(ram_budget, TotalMaximumBufferedBytes(snapshot));
   }
@@ -2413,8 +2629,8 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
       model_input_time = ComputeTargetTimeNsec();
     }
-    Optimize(algorithm, cpu_budget, ram_budget, model_input_time,
-             cancellation_manager);
+    Optimize(algorithm, EffectiveCpuBudget(cpu_budget), ram_budget,
+             model_input_time, cancellation_manager);
     int64_t end_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     VLOG(2) << "Optimized for " << end_ms - start_ms << " ms.";
 
@@ -2431,6 +2647,20 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   }
 }
 
+int64_t Model::EffectiveCpuBudget(int64_t cpu_budget) {
+  if (!experiments_.contains(kAvailableCpuBudgetExperiment)) {
+    return cpu_budget;
+  }
+  if (!cpu_estimator_) {
+    cpu_estimator_ = std::make_unique<AvailableCpuEstimator>();
+  }
+  const int64_t available_cpus = cpu_estimator_->Estimate(cpu_budget);
+  VLOG(2) << "Optimizing for " << available_cpus << " available cores out of "
+          << "a CPU budget of " << cpu_budget << ".";
+  metrics::RecordTFDataAutotuneCpuBudget(cpu_budget, available_cpus);
+  return available_cpus;
+}
+
 void Model::OptimizeGradientDescent(
     std::shared_ptr<Node> snapshot,
     const OptimizationParams& optimization_params,
@@ -2526,6 +2756,11 @@ void Model::OptimizeHillClimbHelper(
            "every "
            "10 minutes).";
   }
+  // When tuning for the available cores, the parallelism is handed out one
+  // core at a time to the node that improves the output time the most, and no
+  // longer taken into account once it adds up to the CPU budget.
+  const bool enforce_cpu_budget =
+      experiments_.contains(kAvailableCpuBudgetExperiment);
   // Initialize the parameter values to minimal before tuning.
   for (auto& pair : parameters) {
     if (skip_buffer_sizes && (pair.second->name == kBufferSize)) {
@@ -2541,12 +2776,16 @@ void Model::OptimizeHillClimbHelper(
                     TotalMaximumBufferedBytes(snapshot))) {
       break;
     }
+    const bool cpu_budget_reached =
+        enforce_cpu_budget &&
+        TotalParallelism(parameters) >= optimization_params.cpu_budget();
 
     double best_delta = -1.0L;
     Parameter* best_parameter = nullptr;
     for (auto& pair : parameters) {
       if (pair.second->value >= pair.second->max ||
-          (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
+          (skip_buffer_sizes && (pair.second->name == kBufferSize)) ||
+          (cpu_budget_reached && pair.second->name == kParallelism)) {
         continue;
       }
       pair.second->value++;
@@ -2554,8 +2793,10 @@ void Model::OptimizeHillClimbHelper(
           OutputTime(snapshot, optimization_params.model_input_time(),
                      /*gradients=*/nullptr);
       double delta = output_time - new_output_time;
+      const bool is_buffer_size = pair.second->name == kBufferSize ||
+                                  pair.second->name == kReorderBufferSize;
       if (delta > best_delta &&
-          (delta > kBufferSizeMinDelta || pair.second->name != kBufferSize)) {
+          (delta > kBufferSizeMinDelta || !is_buffer_size)) {
         best_delta = delta;
         best_parameter = pair.second.get();
       }
@@ -2573,6 +2814,50 @@ void Model::OptimizeHillClimbHelper(
   }
   UpdateStateValues(&parameters);
 }
+
+int64_t Model::cpu_budget() const {
+  tf_shared_lock l(mu_);
+  return optimization_params_.cpu_budget();
+}
+
+absl::flat_hash_map<std::string, int64_t> Model::TunedParallelism() const {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock l(mu_);
+    snapshot = snapshot_;
+  }
+  absl::flat_hash_map<std::string, int64_t> parallelism;
+  if (snapshot == nullptr) {
+    return parallelism;
+  }
+  for (const auto& pair : snapshot->CollectTunableParameters()) {
+    if (pair.second->name == kParallelism) {
+      parallelism[pair.first] = std::round(pair.second->value);
+    }
+  }
+  return parallelism;
+}
+
+absl::flat_hash_map<std::string, int64_t> Model::BufferedBytesPerNode() const {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  absl::flat_hash_map<std::string, int64_t> buffered_bytes;
+  if (output == nullptr) {
+    return buffered_bytes;
+  }
+  Node::NodeVector nodes = output->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(output);
+  for (const auto& node : nodes) {
+    if (node->buffered_bytes() > 0) {
+      buffered_bytes[node->long_name()] = node->buffered_bytes();
+    }
+  }
+  return buffered_bytes;
+}
+
 void Model::RecordIteratorGapTime(uint64_t duration_usec) {
   mutex_lock l(gap_mu_);
   // Drop duration if it is too large.
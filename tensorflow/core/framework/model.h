@@ -16,11 +16,13 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_MODEL_H_
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <list>
 #include <memory>
+#include <optional>
 #include <string>
 // TODO(b/114492873): Move this include into core/platform.
 #include <thread>  // NOLINT
@@ -29,6 +31,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/model.pb.h"
@@ -56,10 +59,16 @@ constexpr char kBufferSize[] = "buffer_size";
 constexpr char kCycleLength[] = "cycle_length";
 constexpr char kDeterministic[] = "deterministic";
 constexpr char kMaxBufferedElements[] = "max_buffered_elements";
+constexpr char kReorderBufferSize[] = "reorder_buffer_size";
 
 // A key used to identify the input time of the model.
 constexpr char kModelInputTimeKey[] = "model_input_time";
 
+// Experiment that makes autotuning measure the CPU cores actually available to
+// the process, instead of assuming the configured CPU budget is free.
+constexpr char kAvailableCpuBudgetExperiment[] =
+    "autotune_available_cpu_budget";
+
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
@@ -133,6 +142,51 @@ std::shared_ptr<Parameter> MakeParameter(const string& name,
 std::shared_ptr<Parameter> MakeNonTunableParameter(const string& name,
                                                    double value);
 
+// Process-wide accounting of the bytes buffered by the nodes of all tf.data
+// models, checked against an optional RAM budget shared by all the input
+// pipelines of the process.
+//
+// The budget is read from the `TF_DATA_RAM_BUDGET_BYTES` environment variable
+// and can be overridden with `SetBudget()`; 0 disables it. When it is set,
+// asynchronous transformations stop producing ahead of their consumer while
+// the process is over budget, and autotuning caps the RAM budget of each model
+// to the share the other pipelines leave.
+class RamBudgetManager {
+ public:
+  // Returns the process-wide instance.
+  static RamBudgetManager& Get();
+
+  // Returns the RAM budget of the process in bytes, or 0 if it is unlimited.
+  int64_t budget() const { return budget_; }
+  void SetBudget(int64_t budget) { budget_ = budget; }
+
+  // Returns the bytes currently buffered by all nodes.
+  int64_t buffered_bytes() const { return buffered_bytes_; }
+
+  // Records a change in the bytes buffered by a node.
+  void RecordBufferEvent(int64_t bytes_delta) {
+    buffered_bytes_ += bytes_delta;
+  }
+
+  // Returns whether the process buffers more than its budget.
+  bool IsOverBudget() const {
+    const int64_t budget = budget_;
+    return budget > 0 && buffered_bytes_ > budget;
+  }
+
+  // Returns the RAM budget to autotune a model with: `model_ram_budget`,
+  // capped to what the other models leave of the process budget given that
+  // the model itself buffers `model_buffered_bytes`.
+  int64_t ModelRamBudget(int64_t model_ram_budget,
+                         int64_t model_buffered_bytes) const;
+
+ private:
+  RamBudgetManager();
+
+  std::atomic<int64_t> budget_;
+  std::atomic<int64_t> buffered_bytes_{0};
+};
+
 // Abstract representation of a TensorFlow input pipeline node. It collects
 // information about inputs to this node, processing time spent executing the
 // node logic, number of elements produced by the node, various other
@@ -189,6 +243,9 @@ class Node {
         output_(args.output.get()) {}
 
   virtual ~Node() {
+    // Stop accounting for what this node still buffers, e.g. when its iterator
+    // is destroyed with a non-empty buffer.
+    RamBudgetManager::Get().RecordBufferEvent(-recorded_buffered_bytes_);
     // Clear the sub-nodes instead of relying on implicit shared pointer
     // destructor to avoid potential stack overflow when the tree is deep.
     std::deque<std::shared_ptr<Node>> queue;
@@ -321,6 +378,8 @@ class Node {
   // Records the change in this node's buffer.
   void record_buffer_event(int64_t bytes_delta, int64_t elements_delta) {
     buffered_bytes_ += bytes_delta;
+    recorded_buffered_bytes_ += bytes_delta;
+    RamBudgetManager::Get().RecordBufferEvent(bytes_delta);
     peak_buffered_bytes_.store(std::max(peak_buffered_bytes_, buffered_bytes_));
     buffered_elements_ += elements_delta;
     // There is no need to maintain watermarks for synchronous ops because we
@@ -691,6 +750,10 @@ class Node {
   // from computation of output time and processing time.
   std::atomic<bool> autotune_;
   std::atomic<int64_t> buffered_bytes_;
+  // The part of `buffered_bytes_` recorded through `record_buffer_event()`,
+  // and thus accounted for by `RamBudgetManager`. Unlike `buffered_bytes_`, it
+  // isn't copied to snapshots.
+  std::atomic<int64_t> recorded_buffered_bytes_{0};
   std::atomic<int64_t> peak_buffered_bytes_;
   std::atomic<int64_t> buffered_elements_;
   std::atomic<int64_t> buffered_elements_low_;
@@ -764,6 +827,56 @@ std::shared_ptr<Node> MakeAsyncUnknownRatioNode(
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Estimates the number of CPU cores available to the process, accounting for
+// the CPU quota of its cgroup, for the CPU time stolen by the hypervisor and
+// for the cores kept busy by the other processes of the host. The steal and
+// contention measurements cover the time since the previous estimate.
+//
+// The measurements rely on the Linux /proc and /sys/fs/cgroup files; the ones
+// that cannot be read are ignored.
+class AvailableCpuEstimator {
+ public:
+  // CPU time counters, in clock ticks.
+  struct CpuTimes {
+    // Time spent by all the cores of the host, in any state.
+    uint64_t total = 0;
+    // Time spent idle or waiting for IO.
+    uint64_t idle = 0;
+    // Time stolen by the hypervisor.
+    uint64_t steal = 0;
+  };
+
+  explicit AvailableCpuEstimator(Env* env = Env::Default());
+
+  // Returns the number of cores available to the process, between 1 and
+  // `max_cpus`.
+  int64_t Estimate(int64_t max_cpus);
+
+  // Parses the `cpu.max` file of a cgroup v2 and returns its CPU quota in
+  // cores, or nullopt if there is no quota.
+  static std::optional<double> ParseCgroupV2CpuMax(absl::string_view cpu_max);
+
+  // Parses the `cpu.cfs_quota_us` and `cpu.cfs_period_us` files of a cgroup v1
+  // and returns its CPU quota in cores, or nullopt if there is no quota.
+  static std::optional<double> ParseCgroupV1CpuQuota(absl::string_view quota,
+                                                     absl::string_view period);
+
+  // Parses the aggregated `cpu` line of /proc/stat.
+  static std::optional<CpuTimes> ParseProcStat(absl::string_view stat);
+
+  // Parses /proc/self/stat and returns the CPU time used by the process, in
+  // clock ticks.
+  static std::optional<uint64_t> ParseProcSelfStat(absl::string_view stat);
+
+ private:
+  // Returns the CPU quota of the cgroup of the process in cores, if any.
+  std::optional<double> ReadCgroupCpuQuota();
+
+  Env* const env_;
+  std::optional<CpuTimes> last_host_times_;
+  std::optional<uint64_t> last_process_time_;
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -863,6 +976,20 @@ class Model {
   // algorithm.
   double ComputeTargetTimeNsec();
 
+  // Returns the CPU budget used by the last optimization, or 0 if the model
+  // has not been optimized yet.
+  int64_t cpu_budget() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the `parallelism` values picked by the last optimization, keyed by
+  // the long name of their node.
+  absl::flat_hash_map<std::string, int64_t> TunedParallelism() const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the bytes currently buffered by each node of the model that
+  // buffers any, keyed by the long name of the node.
+  absl::flat_hash_map<std::string, int64_t> BufferedBytesPerNode() const
+      TF_LOCKS_EXCLUDED(mu_);
+
  private:
   // Determines whether optimization should stop given total processing time,
   // estimated output time, and estimated number of buffers bytes.
@@ -877,6 +1004,11 @@ class Model {
   // a vector which contains pairs of node names and tunable parameters.
   ModelParameters CollectTunableParameters(std::shared_ptr<Node> node);
 
+  // Returns the CPU budget to optimize for: `cpu_budget`, or the number of
+  // cores actually available to the process if it is lower and the
+  // `kAvailableCpuBudgetExperiment` is enabled.
+  int64_t EffectiveCpuBudget(int64_t cpu_budget);
+
   // Downsizes buffers that are too large for all nodes rooted at `snapshot`.
   // Returns true if any buffer is downsized.
   bool DownsizeBuffers(std::shared_ptr<Node> snapshot);
@@ -1024,6 +1156,9 @@ class Model {
   std::shared_ptr<Node> snapshot_ TF_GUARDED_BY(mu_);
   // Stores the optimization parameters used by autotune.
   OptimizationParams optimization_params_ TF_GUARDED_BY(mu_);
+  // Measures the available CPU cores for `kAvailableCpuBudgetExperiment`. Only
+  // used by the optimization loop.
+  std::unique_ptr<AvailableCpuEstimator> cpu_estimator_;
 };
 
 // Class to compute timing information for a model.
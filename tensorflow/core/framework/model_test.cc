@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -3179,6 +3180,175 @@ TEST_F(ModelTimingTest, SelfTime) {
   EXPECT_DOUBLE_EQ(910, node_2->ComputeSelfTime());
 }
 
+TEST(OptimizeHillClimbTest, AvailableCpuBudgetCapsParallelism) {
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/model::kAutotune,
+                                        std::make_shared<mutex>(),
+                                        std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/10)});
+  std::shared_ptr<Node> node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", node1}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/model::kAutotune,
+                                        std::make_shared<mutex>(),
+                                        std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/10)});
+  for (const auto& node : {node1, node2}) {
+    node->record_element();
+    node->add_processing_time(1000);
+  }
+
+  model::Model model;
+  model.AddExperiment(kAvailableCpuBudgetExperiment);
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+
+  CancellationManager cancellation_manager;
+  model.Optimize(AutotuneAlgorithm::HILL_CLIMB, /*cpu_budget=*/4,
+                 /*ram_budget=*/1 << 30, /*model_input_time=*/0,
+                 &cancellation_manager);
+  EXPECT_LE(node1->parameter_value("parallelism") +
+                node2->parameter_value("parallelism"),
+            4);
+  EXPECT_EQ(model.cpu_budget(), 4);
+  absl::flat_hash_map<std::string, int64_t> parallelism =
+      model.TunedParallelism();
+  EXPECT_EQ(parallelism.size(), 2);
+  EXPECT_EQ(parallelism[node1->long_name()],
+            node1->parameter_value("parallelism"));
+}
+
+TEST(AvailableCpuEstimatorTest, ParseCgroupV2CpuMax) {
+  EXPECT_EQ(AvailableCpuEstimator::ParseCgroupV2CpuMax("250000 100000\n"),
+            2.5);
+  EXPECT_EQ(AvailableCpuEstimator::ParseCgroupV2CpuMax("max 100000\n"),
+            std::nullopt);
+  EXPECT_EQ(AvailableCpuEstimator::ParseCgroupV2CpuMax(""), std::nullopt);
+}
+
+TEST(AvailableCpuEstimatorTest, ParseCgroupV1CpuQuota) {
+  EXPECT_EQ(
+      AvailableCpuEstimator::ParseCgroupV1CpuQuota("400000\n", "100000\n"),
+      4.0);
+  EXPECT_EQ(AvailableCpuEstimator::ParseCgroupV1CpuQuota("-1\n", "100000\n"),
+            std::nullopt);
+}
+
+TEST(AvailableCpuEstimatorTest, ParseProcStat) {
+  std::optional<AvailableCpuEstimator::CpuTimes> times =
+      AvailableCpuEstimator::ParseProcStat(
+          "cpu  100 10 50 800 20 5 5 10 0 0\n"
+          "cpu0 50 5 25 400 10 2 3 5 0 0\n");
+  ASSERT_TRUE(times.has_value());
+  EXPECT_EQ(times->total, 1000);
+  EXPECT_EQ(times->idle, 820);
+  EXPECT_EQ(times->steal, 10);
+  EXPECT_FALSE(AvailableCpuEstimator::ParseProcStat("intr 1 2 3").has_value());
+}
+
+TEST(AvailableCpuEstimatorTest, ParseProcSelfStat) {
+  EXPECT_EQ(AvailableCpuEstimator::ParseProcSelfStat(
+                "42 (python3 (x)) S 1 42 42 0 -1 4194560 1000 0 0 0 "
+                "300 45 0 0 20 0 10 0 100 1000000 500"),
+            345);
+  EXPECT_EQ(AvailableCpuEstimator::ParseProcSelfStat("42 (python3) S 1"),
+            std::nullopt);
+}
+
+TEST(AvailableCpuEstimatorTest, EstimateIsWithinBudget) {
+  AvailableCpuEstimator estimator;
+  for (int i = 0; i < 3; ++i) {
+    int64_t available = estimator.Estimate(/*max_cpus=*/2);
+    EXPECT_GE(available, 1);
+    EXPECT_LE(available, 2);
+  }
+  EXPECT_EQ(estimator.Estimate(/*max_cpus=*/0), 1);
+}
+
+TEST(RamBudgetManagerTest, TracksBufferedBytesOfLiveNodes) {
+  RamBudgetManager& manager = RamBudgetManager::Get();
+  const int64_t initial_bytes = manager.buffered_bytes();
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1, {});
+  node->record_buffer_event(/*bytes_delta=*/100, /*elements_delta=*/1);
+  node->record_buffer_event(/*bytes_delta=*/50, /*elements_delta=*/1);
+  EXPECT_EQ(manager.buffered_bytes(), initial_bytes + 150);
+
+  // Snapshots don't account for the buffered bytes again.
+  std::shared_ptr<Node> snapshot = node->Snapshot();
+  EXPECT_EQ(snapshot->buffered_bytes(), 150);
+  snapshot.reset();
+  EXPECT_EQ(manager.buffered_bytes(), initial_bytes + 150);
+
+  node->record_buffer_event(/*bytes_delta=*/-50, /*elements_delta=*/-1);
+  EXPECT_EQ(manager.buffered_bytes(), initial_bytes + 100);
+  node.reset();
+  EXPECT_EQ(manager.buffered_bytes(), initial_bytes);
+}
+
+TEST(RamBudgetManagerTest, CapsModelRamBudget) {
+  RamBudgetManager& manager = RamBudgetManager::Get();
+  const int64_t initial_budget = manager.budget();
+  manager.SetBudget(0);
+  EXPECT_FALSE(manager.IsOverBudget());
+  EXPECT_EQ(manager.ModelRamBudget(/*model_ram_budget=*/1000,
+                                   /*model_buffered_bytes=*/0),
+            1000);
+
+  std::shared_ptr<Node> node = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1, {});
+  node->record_buffer_event(/*bytes_delta=*/600, /*elements_delta=*/1);
+  manager.SetBudget(manager.buffered_bytes() + 400);
+  EXPECT_FALSE(manager.IsOverBudget());
+  // Another model may use what `node` leaves of the budget.
+  EXPECT_EQ(manager.ModelRamBudget(/*model_ram_budget=*/1000,
+                                   /*model_buffered_bytes=*/0),
+            400);
+  // The model of `node` may use what it already buffers, plus the rest.
+  EXPECT_EQ(manager.ModelRamBudget(/*model_ram_budget=*/2000,
+                                   /*model_buffered_bytes=*/600),
+            1000);
+  EXPECT_EQ(manager.ModelRamBudget(/*model_ram_budget=*/500,
+                                   /*model_buffered_bytes=*/600),
+            500);
+
+  node->record_buffer_event(/*bytes_delta=*/500, /*elements_delta=*/1);
+  EXPECT_TRUE(manager.IsOverBudget());
+  EXPECT_EQ(manager.ModelRamBudget(/*model_ram_budget=*/1000,
+                                   /*model_buffered_bytes=*/0),
+            1);
+  node.reset();
+  manager.SetBudget(initial_budget);
+}
+
+TEST(ModelTest, BufferedBytesPerNode) {
+  std::shared_ptr<Node> node1;
+  std::shared_ptr<Node> node2;
+  model::Model model;
+  model.AddNode(
+      [](model::Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(std::move(args), 1, {});
+      },
+      "1", nullptr, &node1);
+  model.AddNode(
+      [](model::Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(std::move(args), 1, {});
+      },
+      "2", node1, &node2);
+  node2->record_buffer_event(/*bytes_delta=*/100, /*elements_delta=*/1);
+
+  absl::flat_hash_map<std::string, int64_t> buffered_bytes =
+      model.BufferedBytesPerNode();
+  EXPECT_EQ(buffered_bytes.size(), 1);
+  EXPECT_EQ(buffered_bytes[node2->long_name()], 100);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
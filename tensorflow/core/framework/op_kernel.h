@@ -617,6 +617,11 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, serves the allocations that would otherwise be made from
+    // the device allocator with default attributes, e.g. to plan the
+    // allocations of the step. Not owned.
+    Allocator* step_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -478,6 +479,44 @@ void BM_RecvSend(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_RecvSend);
 
+void BM_SendRecvManyThreads(::testing::benchmark::State& state) {
+  const int num_shards = state.range(0);
+  const int num_threads = 16;
+  const int messages_per_thread = 1000;
+  thread::ThreadPool* pool =
+      new thread::ThreadPool(Env::Default(), "test", num_threads);
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < num_threads; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+
+  // Every thread sends and receives its own key, so that threads only
+  // contend on the rendezvous itself.
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous(num_shards);
+    BlockingCounter counter(num_threads);
+    for (int i = 0; i < num_threads; ++i) {
+      pool->Schedule([rendez, &keys, &counter, i, messages_per_thread]() {
+        Tensor orig = V("val");
+        Tensor val(DT_STRING, TensorShape({}));
+        bool is_dead = false;
+        Rendezvous::Args args;
+        for (int j = 0; j < messages_per_thread; ++j) {
+          TF_CHECK_OK(rendez->Send(keys[i], args, orig, is_dead));
+          TF_CHECK_OK(rendez->Recv(keys[i], args, &val, &is_dead));
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    rendez->Unref();
+  }
+  state.SetItemsProcessed(num_threads * messages_per_thread *
+                          state.iterations());
+  delete pool;
+}
+BENCHMARK(BM_SendRecvManyThreads)->Arg(1)->Arg(16);
+
 void BM_PingPong(::testing::benchmark::State& state) {
   const int messages_count = state.range(0);
   auto* cm = new CancellationManager();
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 
@@ -39,4 +41,39 @@ Status Var::AsGraphDef(GraphDefBuilder* builder, Node** out) const {
       ops::UnaryOp("Identity", var, builder->opts().WithControlInput(assign));
   return OkStatus();
 }
+
+void Var::MarkRowsDirty(const Tensor& indices) {
+  if (!tracks_dirty_rows()) return;
+  mutex_lock l(dirty_rows_mu_);
+  if (all_rows_dirty_) return;
+  if (indices.dtype() == DT_INT32) {
+    const auto flat = indices.flat<int32>();
+    dirty_rows_.insert(flat.data(), flat.data() + flat.size());
+  } else if (indices.dtype() == DT_INT64) {
+    const auto flat = indices.flat<int64_t>();
+    dirty_rows_.insert(flat.data(), flat.data() + flat.size());
+  } else {
+    all_rows_dirty_ = true;
+    dirty_rows_.clear();
+  }
+}
+
+void Var::MarkAllRowsDirty() {
+  if (!tracks_dirty_rows()) return;
+  mutex_lock l(dirty_rows_mu_);
+  all_rows_dirty_ = true;
+  dirty_rows_.clear();
+}
+
+bool Var::TakeDirtyRows(std::vector<int64_t>* rows) {
+  mutex_lock l(dirty_rows_mu_);
+  tracks_dirty_rows_.store(true, std::memory_order_relaxed);
+  rows->assign(dirty_rows_.begin(), dirty_rows_.end());
+  std::sort(rows->begin(), rows->end());
+  dirty_rows_.clear();
+  const bool known = !all_rows_dirty_;
+  all_rows_dirty_ = false;
+  return known;
+}
+
 }  //  end namespace tensorflow
@@ -16,9 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/resource_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 // Forward declarations to avoid introducing a dependency on headers in
 // "tensorflow/core/graph/...".
@@ -41,7 +47,7 @@ namespace tensorflow {
 // outstanding aliases. Sparse operations are not supported in copy-on-write
 // mode.
 //
-// When a variable is accessed sparsely it switches to copy-on-read mode. To
+// When a variable is written sparsely it switches to copy-on-read mode. To
 // switch we need to grab an exclusive lock and might (if there are aliases)
 // need to copy the entire tensor. Once copy-on-read mode is enabled, no tensor
 // is allowed to alias the variable's internal tensor. This means dense reads
@@ -60,9 +66,12 @@ namespace tensorflow {
 // Transitioning a variable from copy-on-read mode to copy-on-write mode is
 // currently not supported. To upgrade a variable from copy-on-write to
 // copy-on-read use `EnsureSparseVariableAccess()`, and then grab the variable's
-// mutex as desired. To access the variable in dense mode grab the mutex either
-// directly or via `MaybeLockVariableInputMutexesInOrder` on all variables being
-// modified and then call `PrepareToUpdateVariable` on them in any order.
+// mutex as desired. Sparse reads that hold the mutex for as long as they read
+// the buffer, like the gather kernels, work in either mode and don't upgrade
+// the variable, as that would copy the buffer if it is aliased. To access the
+// variable in dense mode grab the mutex either directly or via
+// `MaybeLockVariableInputMutexesInOrder` on all variables being modified and
+// then call `PrepareToUpdateVariable` on them in any order.
 class Var : public ResourceBase {
  public:
   explicit Var(DataType dtype) : tensor_(dtype) {}
@@ -103,10 +112,39 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Dirty row tracking, used to write delta checkpoints of large embedding
+  // variables (see `BundleWriter::AddDeltaRows()`). Tracking starts on the
+  // first call to `TakeDirtyRows()`. From then on sparse updates record the
+  // rows they write, and dense updates mark all the rows as dirty.
+  bool tracks_dirty_rows() const {
+    return tracks_dirty_rows_.load(std::memory_order_relaxed);
+  }
+
+  // Records that the rows `indices`, an int32 or int64 tensor, were written.
+  // Does nothing if the variable does not track dirty rows.
+  void MarkRowsDirty(const Tensor& indices);
+
+  // Records that all the rows were written, e.g. by a dense update. Does
+  // nothing if the variable does not track dirty rows.
+  void MarkAllRowsDirty();
+
+  // Starts tracking dirty rows if needed, and returns in `rows` the sorted
+  // rows written since the previous call. Returns false if they are unknown,
+  // i.e. on the first call or after a dense update, in which case all the
+  // rows must be considered dirty.
+  bool TakeDirtyRows(std::vector<int64_t>* rows);
+
  private:
   mutex mu_;
   Tensor tensor_;
 
+  std::atomic<bool> tracks_dirty_rows_{false};
+  // Sparse writes may hold `mu_` in shared mode, so dirty rows are guarded by
+  // their own mutex.
+  mutex dirty_rows_mu_;
+  bool all_rows_dirty_ TF_GUARDED_BY(dirty_rows_mu_) = true;
+  absl::flat_hash_set<int64_t> dirty_rows_ TF_GUARDED_BY(dirty_rows_mu_);
+
   ~Var() override {}
   TF_DISALLOW_COPY_AND_ASSIGN(Var);
 };
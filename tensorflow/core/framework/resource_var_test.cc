@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include <vector>
+
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -34,5 +36,35 @@ TEST(ResourceVarTest, Uninitialize) {
   EXPECT_FALSE(var->is_initialized);
   EXPECT_TRUE(var->tensor()->data() == nullptr);
 }
+
+TEST(ResourceVarTest, DirtyRows) {
+  RefCountPtr<Var> var{new Var(DT_FLOAT)};
+  Tensor indices(DT_INT64, TensorShape({2}));
+  indices.vec<int64_t>()(0) = 7;
+  indices.vec<int64_t>()(1) = 3;
+  // Rows are not tracked until the first call to TakeDirtyRows().
+  var->MarkRowsDirty(indices);
+  EXPECT_FALSE(var->tracks_dirty_rows());
+  std::vector<int64_t> rows;
+  EXPECT_FALSE(var->TakeDirtyRows(&rows));
+  EXPECT_TRUE(rows.empty());
+  EXPECT_TRUE(var->tracks_dirty_rows());
+
+  var->MarkRowsDirty(indices);
+  Tensor more_indices(DT_INT32, TensorShape({2}));
+  more_indices.vec<int32>()(0) = 3;
+  more_indices.vec<int32>()(1) = 1;
+  var->MarkRowsDirty(more_indices);
+  EXPECT_TRUE(var->TakeDirtyRows(&rows));
+  EXPECT_EQ(rows, std::vector<int64_t>({1, 3, 7}));
+  EXPECT_TRUE(var->TakeDirtyRows(&rows));
+  EXPECT_TRUE(rows.empty());
+
+  var->MarkRowsDirty(indices);
+  var->MarkAllRowsDirty();
+  EXPECT_FALSE(var->TakeDirtyRows(&rows));
+  EXPECT_TRUE(rows.empty());
+}
+
 }  // namespace core
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 #include <list>
 #include <memory>
+#include <set>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
@@ -829,6 +830,21 @@ class RunHandlerPool::Impl {
     return !free_handlers_.empty();
   }
 
+  // A request waiting in Get() for a free handler.
+  struct HandlerWaiter {
+    Impl* pool;
+    int64_t priority;
+  };
+
+  // Returns true if `waiter` may take a free handler: free handlers go to the
+  // highest-priority waiting request first.
+  static bool CanAcquireHandler(HandlerWaiter* waiter)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    Impl* pool = waiter->pool;
+    return pool->has_free_handler() &&
+           waiter->priority >= *pool->waiting_priorities_.rbegin();
+  }
+
   std::unique_ptr<RunHandler> Get(
       int64_t step_id, int64_t timeout_in_ms,
       const RunOptions::Experimental::RunHandlerPoolOptions& options)
@@ -844,9 +860,11 @@ class RunHandlerPool::Impl {
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    const int64_t priority = options.priority();
     {
       mutex_lock l(mu_);
-      if (!has_free_handler()) {
+      if (!has_free_handler() || (!waiting_priorities_.empty() &&
+                                  priority < *waiting_priorities_.rbegin())) {
         profiler::TraceMe activity(
             [&] {
               return strings::StrCat("WaitingForHandler#step_id=", step_id,
@@ -857,11 +875,18 @@ class RunHandlerPool::Impl {
             strings::StrCat("RunHandlerPool::Impl::Get waiting for a handler "
                             "with timeout in millisecond",
                             timeout_in_ms));
+        HandlerWaiter waiter{this, priority};
+        auto waiting_it = waiting_priorities_.insert(priority);
+        bool acquired = true;
         if (timeout_in_ms == 0) {
-          mu_.Await(Condition(this, &Impl::has_free_handler));
-        } else if (!mu_.AwaitWithDeadline(
-                       Condition(this, &Impl::has_free_handler),
-                       EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000)) {
+          mu_.Await(Condition(&Impl::CanAcquireHandler, &waiter));
+        } else {
+          acquired = mu_.AwaitWithDeadline(
+              Condition(&Impl::CanAcquireHandler, &waiter),
+              EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000);
+        }
+        waiting_priorities_.erase(waiting_it);
+        if (!acquired) {
           return nullptr;
         }
       }
@@ -873,7 +898,6 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
@@ -960,6 +984,8 @@ class RunHandlerPool::Impl {
   // bottleneck.
   std::list<RunHandler::Impl*> sorted_active_handlers_ TF_GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ TF_GUARDED_BY(mu_);
+  // Priorities of the requests waiting in Get() for a free handler.
+  std::multiset<int64_t> waiting_priorities_ TF_GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ TF_GUARDED_BY(mu_);
 
   // Histogram of elapsed runtime of every handler (in ms).
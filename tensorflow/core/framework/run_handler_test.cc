@@ -811,5 +811,54 @@ TEST_F(RunHandlerTest, TestWaitTimeout) {
   EXPECT_NE(next_handle.get(), nullptr);
 }
 
+TEST_F(RunHandlerTest, TestWaitingHigherPriorityRequestGetsHandlerFirst) {
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(1, 1));
+
+  // Take every handler in the pool.
+  std::vector<std::unique_ptr<RunHandler>> blocking_handles;
+  const int32_t kMaxConcurrentHandlers = 128;  // Copied from run_handler.cc.
+  blocking_handles.reserve(kMaxConcurrentHandlers);
+  for (int i = 0; i < kMaxConcurrentHandlers; ++i) {
+    blocking_handles.push_back(pool->Get(i));
+  }
+
+  auto tp = std::make_unique<thread::ThreadPool>(Env::Default(), "test", 2);
+  std::atomic<bool> low_acquired(false);
+  std::atomic<bool> high_acquired(false);
+  std::unique_ptr<RunHandler> low_handle;
+  std::unique_ptr<RunHandler> high_handle;
+  RunOptions::Experimental::RunHandlerPoolOptions low_options;
+  low_options.set_priority(1);
+  RunOptions::Experimental::RunHandlerPoolOptions high_options;
+  high_options.set_priority(5);
+
+  // The low-priority request starts waiting first.
+  tp->Schedule([&]() {
+    low_handle = pool->Get(/*step_id=*/200, /*timeout_in_ms=*/0, low_options);
+    low_acquired = true;
+  });
+  Env::Default()->SleepForMicroseconds(20000);
+  tp->Schedule([&]() {
+    high_handle =
+        pool->Get(/*step_id=*/201, /*timeout_in_ms=*/0, high_options);
+    high_acquired = true;
+  });
+  Env::Default()->SleepForMicroseconds(20000);
+
+  // The first released handler goes to the high-priority request.
+  blocking_handles[0].reset();
+  while (!high_acquired) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  Env::Default()->SleepForMicroseconds(20000);
+  EXPECT_FALSE(low_acquired);
+
+  blocking_handles[1].reset();
+  tp.reset();
+  EXPECT_TRUE(low_acquired);
+  EXPECT_NE(low_handle.get(), nullptr);
+  EXPECT_NE(high_handle.get(), nullptr);
+}
+
 }  // namespace
 }  // namespace tensorflow
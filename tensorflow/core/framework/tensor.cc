@@ -156,6 +156,28 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// A buffer that owns the `tensor_content` string of a parsed `TensorProto`,
+// so that the tensor can reference the parsed bytes without a copy.
+class ProtoContentBuffer : public TensorBuffer {
+ public:
+  explicit ProtoContentBuffer(std::unique_ptr<std::string> content)
+      : TensorBuffer(content->data()), content_(std::move(content)) {}
+
+  size_t size() const override { return content_->size(); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("ProtoContentBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Returns the parsed bytes. The buffer must not be used afterwards.
+  std::string Release() { return std::move(*content_); }
+
+ private:
+  std::unique_ptr<std::string> content_;
+};
+
 void LogUnexpectedSize(int64_t actual, int64_t expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -1087,6 +1109,32 @@ bool Tensor::FromProto(Allocator* a, const TensorProto& proto) {
   return true;
 }
 
+bool Tensor::FromProto(TensorProto&& proto) {
+  const DataType dtype = proto.dtype();
+  if (!DataTypeCanUseMemcpy(dtype) || dtype == DT_BOOL ||
+      !TensorShape::IsValid(proto.tensor_shape())) {
+    return FromProto(proto);
+  }
+  TensorShape shape(proto.tensor_shape());
+  const int64_t num_bytes = shape.num_elements() * DataTypeSize(dtype);
+  if (num_bytes <= 0 || proto.tensor_content().size() != num_bytes) {
+    return FromProto(proto);
+  }
+  auto* buf = new ProtoContentBuffer(std::make_unique<std::string>(
+      std::move(*proto.mutable_tensor_content())));
+  if (reinterpret_cast<intptr_t>(buf->data()) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    // Let the copying path allocate an aligned buffer.
+    *proto.mutable_tensor_content() = buf->Release();
+    buf->Unref();
+    return FromProto(proto);
+  }
+  shape_ = shape;
+  set_dtype(dtype);
+  UnrefIfNonNull(buf_);
+  buf_ = buf;
+  return true;
+}
+
 void Tensor::AsProtoField(TensorProto* proto) const {
   proto->Clear();
   shape_.AsProto(proto->mutable_tensor_shape());
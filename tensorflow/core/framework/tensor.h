@@ -394,6 +394,15 @@ class Tensor {
   bool FromProto(const TensorProto& other) TF_MUST_USE_RESULT;
   bool FromProto(Allocator* a, const TensorProto& other) TF_MUST_USE_RESULT;
 
+  /// \brief Like `FromProto(other)`, but may take ownership of the bytes of
+  /// `other.tensor_content()` instead of copying them.
+  ///
+  /// The bytes are kept, and the resulting tensor references them directly,
+  /// when `other` has a simple (memcpy-able, non-bool) dtype and the string
+  /// happens to be aligned for the tensor's data. `other` is left in a valid
+  /// but unspecified state either way.
+  bool FromProto(TensorProto&& other) TF_MUST_USE_RESULT;
+
   /// \brief Fills in `proto` with `*this` tensor's content.
   ///
   /// `AsProtoField()` fills in the repeated field for `proto.dtype()`, while
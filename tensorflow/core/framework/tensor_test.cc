@@ -1392,6 +1392,46 @@ TEST(TensorFromProto, CompressedTensorProto) {
   ASSERT_TRUE(b.FromProto(p));
 }
 
+TEST(TensorFromProto, MovesTensorContent) {
+  Tensor a(DT_FLOAT, TensorShape({64, 64}));
+  test::FillIota<float>(&a, 0.0f);
+  TensorProto p;
+  a.AsProtoTensorContent(&p);
+  const char* content = p.tensor_content().data();
+  Tensor b;
+  ASSERT_TRUE(b.FromProto(std::move(p)));
+  test::ExpectTensorEqual<float>(a, b);
+  EXPECT_TRUE(b.IsAligned());
+  if (reinterpret_cast<intptr_t>(content) % EIGEN_MAX_ALIGN_BYTES == 0) {
+    EXPECT_EQ(b.tensor_data().data(), content);
+  }
+}
+
+TEST(TensorFromProto, MoveFallsBackToCopy) {
+  // Typed fields, bools and strings are not aliased, but parse the same.
+  Tensor f = test::AsTensor<float>({1, 2, 3});
+  TensorProto p;
+  f.AsProtoField(&p);
+  Tensor parsed;
+  ASSERT_TRUE(parsed.FromProto(std::move(p)));
+  test::ExpectTensorEqual<float>(f, parsed);
+
+  Tensor b = test::AsTensor<bool>({true, false});
+  b.AsProtoTensorContent(&p);
+  ASSERT_TRUE(parsed.FromProto(std::move(p)));
+  test::ExpectTensorEqual<bool>(b, parsed);
+
+  Tensor s = test::AsTensor<tstring>({"a", "bc"});
+  s.AsProtoTensorContent(&p);
+  ASSERT_TRUE(parsed.FromProto(std::move(p)));
+  test::ExpectTensorEqual<tstring>(s, parsed);
+
+  // A content size that doesn't match the shape is still rejected.
+  f.AsProtoTensorContent(&p);
+  p.mutable_tensor_content()->pop_back();
+  EXPECT_FALSE(parsed.FromProto(std::move(p)));
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
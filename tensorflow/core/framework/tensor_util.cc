@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/type_traits.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
@@ -425,6 +426,30 @@ bool CompressTensorProtoInPlace(int64_t min_num_elements,
 
 #undef HANDLE_COMPRESS_CASE
 
+absl::Cord SerializeTensorToCord(const Tensor& tensor) {
+  TensorProto proto;
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) || tensor.NumElements() == 0) {
+    tensor.AsProtoTensorContent(&proto);
+    return absl::Cord(proto.SerializeAsString());
+  }
+  proto.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto.mutable_tensor_shape());
+  std::string header = proto.SerializeAsString();
+  // Appends `tensor_content` (field 4, length-delimited) by hand, so that its
+  // bytes can be an external chunk. The wire format allows fields in any
+  // order, so this parses like the output of `AsProtoTensorContent()`.
+  constexpr uint32 kTensorContentTag =
+      (TensorProto::kTensorContentFieldNumber << 3) | 2;
+  core::PutVarint32(&header, kTensorContentTag);
+  const StringPiece data = tensor.tensor_data();
+  core::PutVarint64(&header, data.size());
+  absl::Cord serialized(std::move(header));
+  // The releaser holds a reference to the tensor's buffer.
+  serialized.Append(absl::MakeCordFromExternal(
+      absl::string_view(data.data(), data.size()), [tensor]() {}));
+  return serialized;
+}
+
 Status MakeShape(const Tensor& shape, TensorShape* out) {
   if (!TensorShapeUtils::IsVector(shape.shape())) {
     return errors::InvalidArgument(
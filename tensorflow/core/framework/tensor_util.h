@@ -19,6 +19,7 @@ limitations under the License.
 #include <algorithm>
 #include <vector>
 
+#include "absl/strings/cord.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -322,6 +323,13 @@ inline bool CompressTensorProtoInPlace(TensorProto* tensor) {
                                     kDefaultMinCompressionRatio, tensor);
 }
 
+// Serializes `tensor` as a `TensorProto` with its content in
+// `tensor_content`, like `tensor.AsProtoTensorContent()` followed by
+// `SerializeToString()`. For simple dtypes the serialized content is a chunk
+// of the returned Cord that references the tensor's buffer, which is kept
+// alive by the Cord, instead of a copy.
+absl::Cord SerializeTensorToCord(const Tensor& tensor);
+
 // Make a TensorShape from the contents of shape_t. Shape_t must be a
 // 1-dimensional tensor of type int32 or int64.
 Status MakeShape(const Tensor& shape_t, TensorShape* out);
@@ -708,5 +708,32 @@ TEST(TensorProtoUtil, CompressTensorProtoNegatizeZero) {
   }
 }
 
+TEST(TensorUtil, SerializeTensorToCord) {
+  for (const Tensor& t :
+       {test::AsTensor<float>({1, 2, 3, 4}, {2, 2}),
+        test::AsTensor<int64_t>({}, {0, 3}),
+        test::AsTensor<tstring>({"a", "bc"})}) {
+    TensorProto expected;
+    t.AsProtoTensorContent(&expected);
+    TensorProto parsed;
+    ASSERT_TRUE(parsed.ParseFromString(
+        std::string(tensor::SerializeTensorToCord(t))));
+    EXPECT_EQ(parsed.SerializeAsString(), expected.SerializeAsString());
+  }
+}
+
+TEST(TensorUtil, SerializeTensorToCordKeepsBufferAlive) {
+  absl::Cord serialized;
+  {
+    Tensor t = test::AsTensor<float>({1, 2, 3});
+    serialized = tensor::SerializeTensorToCord(t);
+  }
+  TensorProto parsed;
+  ASSERT_TRUE(parsed.ParseFromString(std::string(serialized)));
+  Tensor round_trip;
+  ASSERT_TRUE(round_trip.FromProto(parsed));
+  test::ExpectTensorEqual<float>(round_trip, test::AsTensor<float>({1, 2, 3}));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -169,6 +169,68 @@ TEST(CostModelTest, WorksWithManager) {
   }
 }
 
+TEST(CostModelTest, WorksWithSampledStepStatsCollector) {
+  auto graph = CreateBasicTestGraph();
+  SampledStepStatsCollector collector(/*sample_period=*/1,
+                                      /*max_sampled_nodes=*/3);
+  collector.StartStep();
+  int num_recorded = 0;
+  for (const Node* node : graph->op_nodes()) {
+    NodeExecStatsInterface* stats =
+        collector.CreateNodeExecStats(&node->def());
+    if (stats == nullptr) {
+      continue;
+    }
+    EXPECT_FALSE(stats->TrackAllocations());
+    stats->RecordExecutorStarted();
+    stats->RecordComputeStarted();
+    stats->RecordComputeEnded();
+    stats->RecordExecutorEnded();
+    stats->Done("DummyDevice");
+    ++num_recorded;
+  }
+  // Only as many nodes as there are preallocated slots are recorded.
+  EXPECT_EQ(num_recorded, 3);
+  collector.EndStep();
+  EXPECT_EQ(collector.num_sampled_nodes(), 3);
+
+  std::unordered_map<string, HistogramProto> histograms;
+  collector.GetOpTypeHistograms(&histograms);
+  double num_histogram_samples = 0;
+  for (const auto& itr : histograms) {
+    EXPECT_TRUE(itr.first == "Input" || itr.first == "Mul") << itr.first;
+    num_histogram_samples += itr.second.num();
+  }
+  EXPECT_EQ(num_histogram_samples, 3);
+
+  CostModelManager cost_model_manager;
+  collector.BuildCostModel(&cost_model_manager,
+                           {{"DummyDevice", graph.get()}});
+  CostGraphDef cost_graph_def;
+  TF_ASSERT_OK(
+      cost_model_manager.AddToCostGraphDef(graph.get(), &cost_graph_def));
+  EXPECT_EQ(cost_graph_def.node_size(), 6);
+}
+
+TEST(CostModelTest, SampledStepStatsCollectorSamplesSubset) {
+  auto graph = CreateBasicTestGraph();
+  const NodeDef& node_def = FindNode(*graph, "C")->def();
+  SampledStepStatsCollector collector(/*sample_period=*/4,
+                                      /*max_sampled_nodes=*/1000);
+  for (int step = 0; step < 2; ++step) {
+    collector.StartStep();
+    for (int i = 0; i < 1000; ++i) {
+      NodeExecStatsInterface* stats = collector.CreateNodeExecStats(&node_def);
+      if (stats != nullptr) {
+        stats->Done("DummyDevice");
+      }
+    }
+    collector.EndStep();
+    EXPECT_GT(collector.num_sampled_nodes(), 150);
+    EXPECT_LT(collector.num_sampled_nodes(), 350);
+  }
+}
+
 TEST(CostModelTest, GlobalId) {
   auto graph = CreateBasicTestGraph();
   CostModel cm_local(/*is_global=*/false);
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <algorithm>
 #include <deque>
+#include <map>
 #include <queue>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -26,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -780,6 +785,237 @@ Status AddControlFlow(const PartitionOptions& opts, Graph* g,
   return OkStatus();
 }
 
+// Returns true iff the shape of the tensor produced at `slot` of `node` is
+// statically known, and if so stores it in `shape`.
+bool GetStaticOutputShape(const Node* node, int slot, TensorShape* shape) {
+  if (node->IsConstant()) {
+    const TensorProto* value;
+    if (!TryGetNodeAttr(node->attrs(), "value", &value)) return false;
+    return TensorShape::BuildTensorShape(value->tensor_shape(), shape).ok();
+  }
+  std::vector<PartialTensorShape> shapes;
+  return GetNodeAttr(node->attrs(), "_output_shapes", &shapes).ok() &&
+         slot < shapes.size() && shapes[slot].AsTensorShape(shape);
+}
+
+// The data types of the tensors that can be packed, all of which have
+// Reshape, ConcatV2 and SplitV kernels on CPU and GPU.
+constexpr DataTypeSet kPackableTypes =
+    ToSet(DT_FLOAT) | ToSet(DT_DOUBLE) | ToSet(DT_HALF) | ToSet(DT_BFLOAT16) |
+    ToSet(DT_INT32) | ToSet(DT_INT64) | ToSet(DT_BOOL);
+
+// Returns true iff the memory type of a tensor of type `dtype` at `port` of
+// `node` matches the one of the ops that pack and unpack it.
+bool HasPackingMemoryType(const Node* node, int port, bool is_input,
+                          DataType dtype, const GraphInfo& info) {
+  if (info.device_types[node->id()] == DEVICE_CPU) return true;
+  const MemoryTypeMap& types = is_input ? info.input_types : info.output_types;
+  auto it = types.find({node->id(), port});
+  return it != types.end() && it->second == MTypeFromDType(dtype);
+}
+
+// Returns true iff the tensor of `edge` crosses partitions and can be packed
+// with others.
+bool IsPackableEdge(const PartitionOptions& opts, const Edge* edge,
+                    const GraphInfo& info) {
+  if (edge->IsControlEdge()) return false;
+  const Node* src = edge->src();
+  const Node* dst = edge->dst();
+  if (!src->IsOp() || !dst->IsOp()) return false;
+  if (opts.node_to_loc(src) == opts.node_to_loc(dst)) return false;
+  const DataType dtype = src->output_type(edge->src_output());
+  if (!kPackableTypes.Contains(dtype) ||
+      dst->input_type(edge->dst_input()) != dtype) {
+    return false;
+  }
+  TensorShape shape;
+  return GetStaticOutputShape(src, edge->src_output(), &shape) &&
+         shape.num_elements() * DataTypeSize(dtype) <=
+             opts.sendrecv_packing_threshold_bytes &&
+         HasPackingMemoryType(src, edge->src_output(), /*is_input=*/false,
+                              dtype, info) &&
+         HasPackingMemoryType(dst, edge->dst_input(), /*is_input=*/true, dtype,
+                              info);
+}
+
+// Packing the tensors of `edges` makes every destination of `edges` depend
+// on every source. Removes from `edges` the ones whose source is reachable
+// from one of the destinations, as packing them would create a cycle.
+void RemoveCyclicEdges(const Graph& g, std::vector<const Edge*>* edges) {
+  std::vector<bool> reachable;
+  std::vector<const Node*> stack;
+  while (!edges->empty()) {
+    reachable.assign(g.num_node_ids(), false);
+    for (const Edge* edge : *edges) stack.push_back(edge->dst());
+    while (!stack.empty()) {
+      const Node* node = stack.back();
+      stack.pop_back();
+      if (reachable[node->id()]) continue;
+      reachable[node->id()] = true;
+      for (const Node* out : node->out_nodes()) {
+        if (!reachable[out->id()]) stack.push_back(out);
+      }
+    }
+    const size_t num_edges = edges->size();
+    edges->erase(std::remove_if(edges->begin(), edges->end(),
+                                [&reachable](const Edge* edge) {
+                                  return reachable[edge->src()->id()];
+                                }),
+                 edges->end());
+    if (edges->size() == num_edges) break;
+  }
+}
+
+Status AddInt32Const(const PartitionOptions& opts, const string& device,
+                     const Tensor& value, Graph* g, Node** node) {
+  TF_RETURN_IF_ERROR(NodeBuilder(opts.new_name("PackedSendRecv/Const"),
+                                 "Const", g->op_registry())
+                         .Attr("dtype", DT_INT32)
+                         .Attr("value", value)
+                         .Finalize(g, node));
+  (*node)->set_assigned_device_name(device);
+  return OkStatus();
+}
+
+Status AddInt32Const(const PartitionOptions& opts, const string& device,
+                     const std::vector<int32>& values, Graph* g, Node** node) {
+  Tensor value(DT_INT32, TensorShape({static_cast<int64_t>(values.size())}));
+  std::copy(values.begin(), values.end(), value.flat<int32>().data());
+  return AddInt32Const(opts, device, value, g, node);
+}
+
+// Replaces the tensors of `edges`, which all have the same type and the same
+// source and destination devices, by slices of a single tensor that is the
+// concatenation of all of them. The graph partitioning then sends this tensor
+// with a single Send/Recv pair.
+Status PackEdges(const PartitionOptions& opts,
+                 const std::vector<const Edge*>& edges, Graph* g) {
+  // The distinct tensors sent over `edges`, and the one of each edge.
+  std::vector<std::pair<Node*, int>> tensors;
+  std::vector<int> edge_tensors;
+  for (const Edge* edge : edges) {
+    std::pair<Node*, int> tensor(edge->src(), edge->src_output());
+    auto it = std::find(tensors.begin(), tensors.end(), tensor);
+    edge_tensors.push_back(it - tensors.begin());
+    if (it == tensors.end()) tensors.push_back(tensor);
+  }
+  if (tensors.size() < 2) return OkStatus();
+
+  const string& src_device = edges[0]->src()->assigned_device_name();
+  const string& dst_device = edges[0]->dst()->assigned_device_name();
+  const Tensor axis(0);
+  Node* src_axis;
+  TF_RETURN_IF_ERROR(AddInt32Const(opts, src_device, axis, g, &src_axis));
+  Node* flat_shape;
+  TF_RETURN_IF_ERROR(AddInt32Const(opts, src_device, std::vector<int32>{-1},
+                                   g, &flat_shape));
+  std::vector<NodeBuilder::NodeOut> flat_tensors;
+  std::vector<int32> sizes;
+  std::vector<TensorShape> shapes;
+  for (const auto& tensor : tensors) {
+    TensorShape shape;
+    if (!GetStaticOutputShape(tensor.first, tensor.second, &shape)) {
+      return errors::Internal("Unknown shape for output ", tensor.second,
+                              " of ", tensor.first->name());
+    }
+    Node* flat;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(opts.new_name(strings::StrCat(tensor.first->name(),
+                                                  "/PackedSendRecv")),
+                    "Reshape", g->op_registry())
+            .Input(tensor.first, tensor.second)
+            .Input(flat_shape)
+            .Finalize(g, &flat));
+    flat->set_assigned_device_name(src_device);
+    flat_tensors.emplace_back(flat, 0);
+    sizes.push_back(shape.num_elements());
+    shapes.push_back(shape);
+  }
+  Node* packed;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(opts.new_name("PackedSendRecv/Pack"), "ConcatV2",
+                  g->op_registry())
+          .Input(flat_tensors)
+          .Input(src_axis)
+          .Finalize(g, &packed));
+  packed->set_assigned_device_name(src_device);
+
+  Node* dst_axis;
+  TF_RETURN_IF_ERROR(AddInt32Const(opts, dst_device, axis, g, &dst_axis));
+  Node* size_splits;
+  TF_RETURN_IF_ERROR(AddInt32Const(opts, dst_device, sizes, g, &size_splits));
+  Node* unpacked;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(opts.new_name("PackedSendRecv/Unpack"), "SplitV",
+                  g->op_registry())
+          .Input(packed)
+          .Input(size_splits)
+          .Input(dst_axis)
+          .Attr("num_split", static_cast<int64_t>(tensors.size()))
+          .Finalize(g, &unpacked));
+  unpacked->set_assigned_device_name(dst_device);
+  std::vector<Node*> outputs;
+  for (int i = 0; i < tensors.size(); ++i) {
+    std::vector<int32> dims(shapes[i].dims());
+    for (int d = 0; d < dims.size(); ++d) dims[d] = shapes[i].dim_size(d);
+    Node* shape;
+    TF_RETURN_IF_ERROR(AddInt32Const(opts, dst_device, dims, g, &shape));
+    Node* output;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(opts.new_name(strings::StrCat(tensors[i].first->name(),
+                                                  "/PackedSendRecv")),
+                    "Reshape", g->op_registry())
+            .Input(unpacked, i)
+            .Input(shape)
+            .Finalize(g, &output));
+    output->set_assigned_device_name(dst_device);
+    outputs.push_back(output);
+  }
+
+  // Collect the destinations first, as updating an edge deletes it.
+  std::vector<std::pair<Node*, int>> dsts;
+  for (const Edge* edge : edges) {
+    dsts.emplace_back(edge->dst(), edge->dst_input());
+  }
+  for (int i = 0; i < dsts.size(); ++i) {
+    TF_RETURN_IF_ERROR(g->UpdateEdge(outputs[edge_tensors[i]], 0,
+                                     dsts[i].first, dsts[i].second));
+  }
+  return OkStatus();
+}
+
+// Packs the small tensors sent between each pair of devices, as described
+// for PartitionOptions::sendrecv_packing_threshold_bytes.
+Status PackSmallSendRecvs(const PartitionOptions& opts, Graph* g) {
+  for (const Node* node : g->op_nodes()) {
+    if (node->IsSwitch()) return OkStatus();
+  }
+  GraphInfo info;
+  TF_RETURN_IF_ERROR(BuildMemoryDeviceInfo(*g, &info));
+
+  // Use an ordered map so that the rewritten graph is deterministic.
+  std::map<std::tuple<string, string, DataType>, std::vector<const Edge*>>
+      groups;
+  for (const Edge* edge : g->edges()) {
+    if (!IsPackableEdge(opts, edge, info)) continue;
+    groups[std::make_tuple(edge->src()->assigned_device_name(),
+                           edge->dst()->assigned_device_name(),
+                           edge->src()->output_type(edge->src_output()))]
+        .push_back(edge);
+  }
+  for (auto& group : groups) {
+    std::vector<const Edge*>& edges = group.second;
+    // Edge ids follow the order in which edges were added to the graph.
+    std::sort(edges.begin(), edges.end(), [](const Edge* a, const Edge* b) {
+      return a->id() < b->id();
+    });
+    RemoveCyclicEdges(*g, &edges);
+    if (edges.size() < 2) continue;
+    TF_RETURN_IF_ERROR(PackEdges(opts, edges, g));
+  }
+  return OkStatus();
+}
+
 struct PriorityTopoSortNode {
   PriorityTopoSortNode(const NodeDef* n, int64_t st)
       : node(n), start_time(st) {}
@@ -994,6 +1230,11 @@ Status Partition(const PartitionOptions& opts, Graph* g,
     if (!status.ok()) return status;
   }
 
+  if (opts.sendrecv_packing_threshold_bytes > 0) {
+    status = PackSmallSendRecvs(opts, g);
+    if (!status.ok()) return status;
+  }
+
   // At this point, all the graph mutations have been done. Build memory
   // and device type info for every node and edge in the graph.
   status = BuildMemoryDeviceInfo(*g, &g_info);
@@ -80,6 +80,15 @@ struct PartitionOptions {
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
+
+  // If positive, data edges between the same pair of devices whose tensors
+  // have a statically known size of at most this many bytes are packed, per
+  // data type, into a single tensor that is sent with one Send/Recv pair and
+  // unpacked on the receiving device. Sizes are taken from the "value" attr
+  // of Const nodes, or from the "_output_shapes" attr of other nodes. Edges
+  // are only packed when doing so can not introduce a cycle, and not at all
+  // in graphs with control flow, where a packed tensor could become dead.
+  int64_t sendrecv_packing_threshold_bytes = 0;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
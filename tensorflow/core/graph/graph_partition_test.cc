@@ -75,7 +75,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               int64_t sendrecv_packing_threshold_bytes = 0) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -95,6 +96,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.sendrecv_packing_threshold_bytes = sendrecv_packing_threshold_bytes;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -372,6 +374,60 @@ TEST_F(GraphPartitionTest, CrossDevice_DataControl) {
   ExpectMatchB();
 }
 
+int CountOps(const GraphDef& graph_def, const string& op) {
+  int count = 0;
+  for (const NodeDef& node : graph_def.node()) {
+    if (node.op() == op) ++count;
+  }
+  return count;
+}
+
+TEST_F(GraphPartitionTest, PackSmallTensors) {
+  auto a1 = Const(in_.WithOpName("A1"), {1.0f, 2.0f, 3.0f});
+  auto a2 = Const(in_.WithOpName("A2"), {{4.0f}, {5.0f}});
+  auto a3 = Const(in_.WithOpName("A3"), 6.0f, {256});
+  Combine(in_.WithOpName("B1"), a1, a2);
+  Combine(in_.WithOpName("B2"), a1, a3);
+
+  Partition(ToGraphDef(), &partitions_,
+            /*sendrecv_packing_threshold_bytes=*/64);
+  EXPECT_EQ(2, partitions_.size());
+
+  // A1 and A2 are packed, while A3 is too large and is sent on its own.
+  string a = "/job:a/replica:0/task:0/cpu:0";
+  string b = "/job:a/replica:0/task:0/cpu:1";
+  EXPECT_EQ(2, CountOps(partitions_[a], "_Send"));
+  EXPECT_EQ(1, CountOps(partitions_[a], "ConcatV2"));
+  EXPECT_EQ(2, CountOps(partitions_[b], "_Recv"));
+  EXPECT_EQ(1, CountOps(partitions_[b], "SplitV"));
+  EXPECT_EQ(2, CountOps(partitions_[b], "Reshape"));
+}
+
+TEST_F(GraphPartitionTest, PackSmallTensorsWithoutCycle) {
+  auto a1 = Const(in_.WithOpName("A1"), {1.0f, 2.0f});
+  auto b1 = Identity(in_.WithOpName("B1"), a1);
+  auto a2 = Combine(in_.WithOpName("A2"), b1, b1);
+  Combine(in_.WithOpName("B2"), a1, a2);
+  GraphDef graph_def = ToGraphDef();
+  for (NodeDef& node : *graph_def.mutable_node()) {
+    if (node.name() == "A2") {
+      TensorShapeProto shape;
+      shape.add_dim()->set_size(2);
+      *(*node.mutable_attr())["_output_shapes"].mutable_list()->add_shape() =
+          shape;
+    }
+  }
+
+  // Packing A1 and A2 would make A2 depend on itself through B1.
+  Partition(graph_def, &partitions_,
+            /*sendrecv_packing_threshold_bytes=*/64);
+  EXPECT_EQ(2, partitions_.size());
+
+  string a = "/job:a/replica:0/task:0/cpu:0";
+  EXPECT_EQ(2, CountOps(partitions_[a], "_Send"));
+  EXPECT_EQ(0, CountOps(partitions_[a], "ConcatV2"));
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceLoopSimple) {
   auto a1 = BoolInput(in_.WithOpName("A1"));
   auto a2 = ::tensorflow::ops::internal::Enter(in_.WithOpName("A2"), a1, "foo");
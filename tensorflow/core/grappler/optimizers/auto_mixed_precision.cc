@@ -1073,6 +1073,8 @@ class AutoMixedPrecisionImpl {
         return std::make_unique<AutoMixedPrecisionListsCuda>(
             /*cuda_version=*/10000,   // Hardcode cuda and cudnn version so
             /*cudnn_version=*/8000);  // CPU emulates the same ops on GPU.
+      case AutoMixedPrecisionMode::CPU_BF16:
+        return std::make_unique<AutoMixedPrecisionListsCpuBf16>();
     }
   }
   Status PrintDebugLogs(bool preop, size_t timestamp);
@@ -1391,6 +1393,11 @@ Status AutoMixedPrecisionImpl::Optimize() {
         "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
         "UNSAFE_FORCE_ALL when oneDNN is used");
   }
+  if (force_all_fp16_ && mode_ == AutoMixedPrecisionMode::CPU_BF16) {
+    return errors::InvalidArgument(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_LEVEL cannot be set to "
+        "UNSAFE_FORCE_ALL when converting to bfloat16 on CPUs");
+  }
 
   treat_infer_as_deny_ = optimization_level == "TREAT_INFER_AS_DENY";
   VLOG(2) << "Optimization Level: " << optimization_level;
@@ -1428,6 +1435,7 @@ Status AutoMixedPrecisionImpl::Optimize() {
         break;
       case AutoMixedPrecisionMode::BF16:
       case AutoMixedPrecisionMode::CPU:
+      case AutoMixedPrecisionMode::CPU_BF16:
         device_type = DEVICE_CPU;
         should_process = !MustPreserve(node) && IsOnDevice(node, device_type);
         break;
@@ -1856,15 +1864,17 @@ void AutoMixedPrecisionImpl::PropagateAllowThroughClear(
 void AutoMixedPrecisionImpl::AddInferToAllowIfFollowAllow(
     const absl::flat_hash_set<int>& deny_set,
     absl::flat_hash_set<int>* allow_set) const {
-  // Currently only target for oneDNN
-  if (mode_ != AutoMixedPrecisionMode::BF16) {
+  // Currently only target for bfloat16 on CPUs
+  if (mode_ != AutoMixedPrecisionMode::BF16 &&
+      mode_ != AutoMixedPrecisionMode::CPU_BF16) {
     return;
   }
   for (int item_idx = 0; item_idx < graph_type_view_.num_nodes(); ++item_idx) {
     const NodeTypeId& item = *graph_type_view_.GetNode(item_idx);
     if (!ShouldProcess(*item.node) || deny_set.count(item_idx) ||
         allow_set->count(item_idx) || !f16_inferlist_.count(item.node->op()) ||
-        !IsFloat32(item) || !SupportsF16DataType(item)) {
+        !IsFloat32(item) || !SupportsF16DataType(item) ||
+        (mode_ == AutoMixedPrecisionMode::CPU_BF16 && !SupportsF16(item))) {
       continue;
     }
 
@@ -1891,11 +1901,21 @@ void AutoMixedPrecisionImpl::AddInferToAllowIfFollowAllow(
 // If ops have one or more type_attr, But this type_attr could not be converted
 // to F16. Such as FusedBatchNormV2/FusedBatchNormV3, its type_attr 'U' only
 // support float. So we will remove this node from allow_set.
-// Also don't convert quantized ops to FP16.
+// Also don't convert quantized ops to FP16. When converting to bfloat16 with
+// the default CPU kernels, also remove allowlist ops without such a kernel.
 void AutoMixedPrecisionImpl::RemoveAllowsetWithFp32(
     absl::flat_hash_set<int>* allow_set) const {
   for (int root_idx = 0; root_idx < graph_type_view_.num_nodes(); ++root_idx) {
     const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
+    if (mode_ == AutoMixedPrecisionMode::CPU_BF16 &&
+        f16_allowlist_.count(root.node->op()) && allow_set->count(root_idx) &&
+        !SupportsF16(root)) {
+      allow_set->erase(root_idx);
+      VLOG(2) << "UnPainting type " << root.type_attr.DebugString()
+              << " of node " << root.node->name() << " ALLOW because its op "
+              << root.node->op() << " has no bfloat16 CPU kernel";
+      continue;
+    }
     if (f16_allowlist_.count(root.node->op()) && allow_set->count(root_idx) &&
         (!SupportsF16DataType(root) || IsQuantized(root))) {
       auto erased = allow_set->erase(root_idx);
@@ -2305,6 +2325,16 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
     return OkStatus();
   }
 
+  if (mode_ == AutoMixedPrecisionMode::CPU_BF16 && !ShouldIgnorePerformance() &&
+      !port::TestCPUFeature(port::AVX512_BF16) &&
+      !port::TestCPUFeature(port::AMX_BF16)) {
+    // Without native bfloat16 support the conversions cost more than the
+    // bfloat16 kernels save.
+    LOG(WARNING) << "No CPU support for bfloat16 detected, skipping " << name()
+                 << " graph optimizer";
+    return OkStatus();
+  }
+
   if (num_gpus >= 1 && mode_ == AutoMixedPrecisionMode::BF16) {
     LOG(WARNING) << "Note: GPUs detected. Using " << name()
                  << " graph optimizer configured for BFloat16 on CPUs";
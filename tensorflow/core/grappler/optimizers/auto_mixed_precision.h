@@ -26,7 +26,9 @@ namespace grappler {
 // CUDA: convert to float16 on GPU
 // BF16: convert to bfloat16 on CPU
 // CPU: emulate float16 on CPU without changing operator kernel
-enum class AutoMixedPrecisionMode { CUDA, BF16, CPU };
+// CPU_BF16: convert to bfloat16 on CPUs with native bfloat16 support, using
+//   the default CPU kernels
+enum class AutoMixedPrecisionMode { CUDA, BF16, CPU, CPU_BF16 };
 
 // Convert data types to float16 or bfloat16 where appropriate to improve
 // performance on GPUs or CPUs.
@@ -34,7 +36,8 @@ class AutoMixedPrecision : public GraphOptimizer {
  public:
   // If 'mode' is CUDA, converts nodes to float16 on Nvidia GPUs. If BF16,
   // converts nodes to bfloat16 on CPUs in order to take advantage of oneDNN
-  // performance improvements with bfloat16.
+  // performance improvements with bfloat16. If CPU_BF16, converts nodes that
+  // have a bfloat16 CPU kernel to bfloat16 on CPUs with AVX512_BF16 or AMX.
   explicit AutoMixedPrecision(
       AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
       : mode_(mode) {}
@@ -49,6 +52,8 @@ class AutoMixedPrecision : public GraphOptimizer {
         return "auto_mixed_precision_onednn_bfloat16";
       case AutoMixedPrecisionMode::CPU:
         return "auto_mixed_precision_cpu";
+      case AutoMixedPrecisionMode::CPU_BF16:
+        return "auto_mixed_precision_cpu_bfloat16";
       default:
         LOG(FATAL) << "Invalid value for AutoMixedPrecisionMode: "  // Crash Ok
                    << static_cast<int>(mode_);
@@ -564,6 +564,44 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+// Lists for converting to bfloat16 with the default CPU kernels. The deny and
+// clear lists are shared with oneDNN, since they only depend on numerics, but
+// the optimizer additionally skips any op without a bfloat16 CPU kernel. The
+// allow and infer lists are restricted to ops whose Eigen kernels are fast in
+// bfloat16 on CPUs with AVX512_BF16 or AMX.
+class AutoMixedPrecisionListsCpuBf16 : public AutoMixedPrecisionListsMkl {
+ public:
+  AutoMixedPrecisionListsCpuBf16() {}
+
+  gtl::FlatSet<string> AllowList() override {
+    auto list = gtl::FlatSet<string>{"BatchMatMul",
+                                     "BatchMatMulV2",
+                                     "BatchMatMulV3",
+                                     "Conv2D",
+                                     "Conv3D",
+                                     "Einsum",
+                                     "MatMul"};
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> InferList() override {
+    auto list = gtl::FlatSet<string>{"Add",
+                                     "AddN",
+                                     "AddV2",
+                                     "BiasAdd",
+                                     "Mul",
+                                     "RealDiv",
+                                     "Sigmoid",
+                                     "Square",
+                                     "SquaredDifference",
+                                     "Sub",
+                                     "Tanh"};
+    UpdateList("INFERLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
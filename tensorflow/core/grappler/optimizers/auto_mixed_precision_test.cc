@@ -1359,6 +1359,49 @@ TEST_F(AutoMixedPrecisionCpuTest, MixedFanout) {
   }
 }
 
+TEST_F(AutoMixedPrecisionCpuTest, Bf16WithDefaultKernels) {
+  if (!port::TestCPUFeature(port::AVX512_BF16) &&
+      !port::TestCPUFeature(port::AMX_BF16)) {
+    GTEST_SKIP() << "Test requires a CPU with native bfloat16 support.";
+  }
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  Output input = ops::Const(s.WithOpName("input"), 1.f / 32, {32, 32});
+  Output deny1 = ops::Exp(s.WithOpName("deny1"), input);
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), deny1, deny1);
+  Output bias = ops::Const(s.WithOpName("bias"), 1.f / 32, {32});
+  Output infer1 = ops::BiasAdd(s.WithOpName("infer1"), allow1, bias);
+  Output clr1 = ops::Relu(s.WithOpName("clr1"), infer1);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), clr1);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::CPU_BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output_view.GetNode("deny1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_BFLOAT16);
+  // BiasAdd directly follows the MatMul, so it stays in bfloat16 rather than
+  // casting back in between.
+  EXPECT_EQ(output_view.GetNode("infer1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("clr1")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("fetch")->attr().at("T").type(), DT_FLOAT);
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(tensors.size(), tensors_expected.size());
+  EXPECT_EQ(tensors.size(), item.fetch.size());
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectClose(tensors_expected[i], tensors[i], -1, 5e-2);
+  }
+}
+
 class AutoMixedPrecisionSimulateGpuTest : public GrapplerTest {
  protected:
   void SetUp() override {
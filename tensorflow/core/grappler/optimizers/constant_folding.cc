@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "absl/status/status.h"
@@ -65,6 +66,10 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
 // We only fold/materialize constants smaller than 100kB.
 const int64_t kMaxConstantSize = 100 * 1024;
+// Each pass of folding only grows the constants of a graph by up to 10MB
+// overall, so that many constants each smaller than kMaxConstantSize don't blow
+// up the size of the graph.
+const int64_t kMaxFoldedConstantsGrowth = 10 * 1024 * 1024;
 
 namespace {
 template <typename T>
@@ -1402,6 +1407,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
   }
 
   outputs->resize(output_tensors.size());
+  int64_t outputs_size = 0;
   for (size_t i = 0; i < output_tensors.size(); i++) {
     string node_name = OptimizedNodeName(node, "-folded");
     if (output_tensors.size() > 1) {
@@ -1414,12 +1420,21 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
         *result_too_large = true;
         return s;
       }
+      outputs_size += outputs->at(i).attr().at("value").tensor().ByteSizeLong();
     } else {
       // Create an empty NodeDef to identify dead outputs (e.g. the output of a
       // switch that's not selected by the switch predicate).
       outputs->at(i) = NodeDef();
     }
   }
+  const int64_t growth =
+      std::max<int64_t>(outputs_size - total_inputs_size, 0);
+  if (folded_constants_growth_ + growth > kMaxFoldedConstantsGrowth) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Can't fold ", node.name(), ", the constants folded in this pass "
+        "would grow by more than ", kMaxFoldedConstantsGrowth, " bytes"));
+  }
+  folded_constants_growth_ += growth;
   return OkStatus();
 }
 
@@ -1648,6 +1663,7 @@ Status ConstantFolding::FoldGraph(
   // copy other nodes that might be needed at the end of this function.
   absl::flat_hash_set<string> processed_nodes;
   std::deque<NodeDef*> queue;
+  folded_constants_growth_ = 0;
   for (int i = 0; i < graph_->node_size(); i++) {
     const NodeDef& node = graph_->node(i);
     if (IsFoldable(node, &properties) &&
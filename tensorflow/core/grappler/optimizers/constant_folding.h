@@ -34,6 +34,7 @@ namespace grappler {
 const char kConstantFoldingConst[] = "ConstantFolding";
 const char kConstantFoldingCtrl[] = "ConstantFoldingCtrl";
 extern const int64_t kMaxConstantSize;
+extern const int64_t kMaxFoldedConstantsGrowth;
 
 // Constant folding optimization for a graph.
 class ConstantFolding : public GraphOptimizer {
@@ -340,6 +341,9 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  // Number of bytes by which the constants folded in the current pass are
+  // larger than their inputs.
+  int64_t folded_constants_growth_ = 0;
 };
 
 }  // end namespace grappler
@@ -2933,6 +2933,44 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, FoldedConstantsGrowthIsBounded) {
+  // Each range is a bit smaller than kMaxConstantSize, and so can be folded on
+  // its own, but folding all of them would grow the graph by more than
+  // kMaxFoldedConstantsGrowth.
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  const int64_t range_size = kMaxConstantSize / sizeof(float) - 1000;
+  const int num_ranges =
+      kMaxFoldedConstantsGrowth / (range_size * sizeof(float)) + 10;
+  GrapplerItem item;
+  for (int i = 0; i < num_ranges; ++i) {
+    const string name = absl::StrCat("range_", i);
+    Output start = ops::Const(scope.WithOpName(name + "_start"), 1.0f * i);
+    Output limit =
+        ops::Const(scope.WithOpName(name + "_limit"), 1.0f * (i + range_size));
+    Output delta = ops::Const(scope.WithOpName(name + "_delta"), 1.0f);
+    ops::Range(scope.WithOpName(name), start, limit, delta);
+    item.fetch.push_back(name);
+  }
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int num_folded = 0;
+  int64_t folded_size = 0;
+  for (const auto& node : output.node()) {
+    if (absl::StartsWith(node.name(), "range_") && node.op() == "Const" &&
+        node.attr().at("value").tensor().tensor_shape().dim_size() == 1) {
+      ++num_folded;
+      folded_size += node.attr().at("value").tensor().ByteSizeLong();
+    }
+  }
+  EXPECT_GT(num_folded, 0);
+  EXPECT_LT(num_folded, num_ranges);
+  EXPECT_LE(folded_size, kMaxFoldedConstantsGrowth);
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
@@ -0,0 +1,149 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Vectorizers of constants and of the element-wise ops. An element-wise op
+// computes the same function on the values of a stacked tensor whether or not
+// they have a batch dimension, so its vectorization keeps the node as is.
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorizer.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ConstVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const std::vector<VectorizedTensor>& inputs, NodeDef* node,
+                   VectorizedTensor* output) override {
+    auto it = node->attr().find("value");
+    if (it == node->attr().end()) {
+      return errors::InvalidArgument("Const node ", node->name(),
+                                     " has no value.");
+    }
+    output->stacked = false;
+    output->element_rank = it->second.tensor().tensor_shape().dim_size();
+    return OkStatus();
+  }
+};
+
+class UnaryCwiseVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const std::vector<VectorizedTensor>& inputs, NodeDef* node,
+                   VectorizedTensor* output) override {
+    if (inputs.size() != 1) {
+      return errors::InvalidArgument("Expected one input for ", node->op(),
+                                     ", got ", inputs.size());
+    }
+    *output = inputs[0];
+    return OkStatus();
+  }
+};
+
+class BinaryCwiseVectorizer : public Vectorizer {
+ public:
+  Status Vectorize(const std::vector<VectorizedTensor>& inputs, NodeDef* node,
+                   VectorizedTensor* output) override {
+    if (inputs.size() != 2) {
+      return errors::InvalidArgument("Expected two inputs for ", node->op(),
+                                     ", got ", inputs.size());
+    }
+    const VectorizedTensor& x = inputs[0];
+    const VectorizedTensor& y = inputs[1];
+    const bool ranks_known = x.element_rank >= 0 && y.element_rank >= 0;
+    output->stacked = x.stacked || y.stacked;
+    output->element_rank =
+        ranks_known ? std::max(x.element_rank, y.element_rank) : -1;
+    if (x.stacked && y.stacked) {
+      // The batch dimensions are only aligned if the element ranks are equal.
+      if (!ranks_known || x.element_rank != y.element_rank) {
+        return errors::Unimplemented("Cannot vectorize ", node->op(),
+                                     " of stacked inputs of different or "
+                                     "unknown ranks.");
+      }
+    } else if (x.stacked || y.stacked) {
+      // An unstacked input broadcasts against the values of the stacked input
+      // as it does against a single element if it doesn't have more
+      // dimensions.
+      const VectorizedTensor& stacked = x.stacked ? x : y;
+      const VectorizedTensor& unstacked = x.stacked ? y : x;
+      if (unstacked.element_rank != 0 &&
+          (!ranks_known || unstacked.element_rank > stacked.element_rank)) {
+        return errors::Unimplemented(
+            "Cannot vectorize ", node->op(),
+            " of a stacked input and an unstacked input of higher or unknown "
+            "rank.");
+      }
+      output->element_rank = stacked.element_rank;
+    }
+    return OkStatus();
+  }
+};
+
+REGISTER_VECTORIZER("Const", ConstVectorizer);
+
+REGISTER_VECTORIZER("Abs", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Cast", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Ceil", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Cos", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Exp", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Floor", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Identity", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("IsFinite", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Log", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("LogicalNot", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Neg", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Reciprocal", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Relu", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Round", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Rsqrt", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Sigmoid", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Sign", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Sin", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Sqrt", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Square", UnaryCwiseVectorizer);
+REGISTER_VECTORIZER("Tanh", UnaryCwiseVectorizer);
+
+REGISTER_VECTORIZER("Add", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("AddV2", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Div", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("DivNoNan", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Equal", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("FloorDiv", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("FloorMod", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Greater", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("GreaterEqual", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Less", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("LessEqual", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("LogicalAnd", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("LogicalOr", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Maximum", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Minimum", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Mul", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("NotEqual", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Pow", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("RealDiv", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("SquaredDifference", BinaryCwiseVectorizer);
+REGISTER_VECTORIZER("Sub", BinaryCwiseVectorizer);
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
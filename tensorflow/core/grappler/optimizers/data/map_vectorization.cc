@@ -0,0 +1,408 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/vectorizer.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kMapDefun[] = "MapDefun";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+bool IsControlInput(const string& input) {
+  return absl::StartsWith(input, "^");
+}
+
+// Returns the name of the node or of the argument referenced by `input`, a
+// node input or a return value of a function.
+string ReferencedName(StringPiece input) {
+  absl::ConsumePrefix(&input, "^");
+  return string(input.substr(0, input.find(':')));
+}
+
+// Returns the indices of the nodes of `function` in a topological order.
+Status TopologicalOrder(const FunctionDef& function, std::vector<int>* order) {
+  const int num_nodes = function.node_def_size();
+  absl::flat_hash_map<string, int> node_indices;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_indices[function.node_def(i).name()] = i;
+  }
+  std::vector<int> num_pending_inputs(num_nodes, 0);
+  std::vector<std::vector<int>> fanouts(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : function.node_def(i).input()) {
+      auto it = node_indices.find(ReferencedName(input));
+      if (it != node_indices.end()) {
+        ++num_pending_inputs[i];
+        fanouts[it->second].push_back(i);
+      }
+    }
+  }
+  std::deque<int> ready;
+  for (int i = 0; i < num_nodes; ++i) {
+    if (num_pending_inputs[i] == 0) ready.push_back(i);
+  }
+  order->clear();
+  while (!ready.empty()) {
+    const int index = ready.front();
+    ready.pop_front();
+    order->push_back(index);
+    for (int fanout : fanouts[index]) {
+      if (--num_pending_inputs[fanout] == 0) ready.push_back(fanout);
+    }
+  }
+  if (order->size() != num_nodes) {
+    return errors::InvalidArgument("The function ", function.signature().name(),
+                                   " has a cycle.");
+  }
+  return OkStatus();
+}
+
+// Replaces `node` of `function` by a `MapDefun` node which runs `node` once per
+// element of its stacked inputs, described by `inputs`. The function called by
+// the `MapDefun` node is added to `library`.
+Status AddMapDefunFallback(const std::vector<VectorizedTensor>& inputs,
+                           const FunctionLibraryDefinition& function_library,
+                           FunctionDefLibrary* library, FunctionDef* function,
+                           NodeDef* node) {
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(function_library.LookUpOpDef(node->op(), &op_def));
+  NodeDef node_with_defaults = *node;
+  AddDefaultsToNodeDef(*op_def, &node_with_defaults);
+  DataTypeVector input_types;
+  TF_RETURN_IF_ERROR(
+      InputTypesForNode(node_with_defaults, *op_def, &input_types));
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(
+      OutputTypesForNode(node_with_defaults, *op_def, &output_types));
+  NameRangeMap output_ranges;
+  TF_RETURN_IF_ERROR(NameRangesForNode(node_with_defaults, *op_def,
+                                       /*inputs=*/nullptr, &output_ranges));
+  if (input_types.size() != inputs.size()) {
+    return errors::InvalidArgument("Expected ", input_types.size(),
+                                   " data inputs for ", node->name(), ", got ",
+                                   inputs.size());
+  }
+
+  // The function called by `MapDefun` runs `node` on one element. Its
+  // arguments are the stacked inputs of `node`, followed by the unstacked ones.
+  FunctionDef per_element_function;
+  graph_utils::SetUniqueGraphFunctionName(
+      strings::StrCat(function->signature().name(), "/", node->name()), library,
+      &per_element_function);
+  NodeDef* per_element_node = per_element_function.add_node_def();
+  *per_element_node = node_with_defaults;
+  per_element_node->clear_input();
+
+  NodeDef map_defun;
+  map_defun.set_op(kMapDefun);
+  function_utils::SetUniqueFunctionNodeName(
+      strings::StrCat(node->name(), "/map_defun"), function, &map_defun);
+  std::vector<string> data_inputs;
+  std::vector<string> control_inputs;
+  for (const string& input : node->input()) {
+    if (IsControlInput(input)) {
+      control_inputs.push_back(input);
+      continue;
+    }
+    per_element_node->add_input(strings::StrCat("arg_", data_inputs.size()));
+    data_inputs.push_back(input);
+  }
+  DataTypeVector argument_types;
+  DataTypeVector captured_types;
+  for (bool stacked : {true, false}) {
+    for (int i = 0; i < data_inputs.size(); ++i) {
+      if (inputs[i].stacked != stacked) continue;
+      OpDef::ArgDef* arg =
+          per_element_function.mutable_signature()->add_input_arg();
+      arg->set_name(strings::StrCat("arg_", i));
+      arg->set_type(input_types[i]);
+      map_defun.add_input(data_inputs[i]);
+      (stacked ? argument_types : captured_types).push_back(input_types[i]);
+    }
+  }
+  for (const string& input : control_inputs) {
+    map_defun.add_input(input);
+  }
+
+  for (int i = 0; i < output_types.size(); ++i) {
+    OpDef::ArgDef* arg =
+        per_element_function.mutable_signature()->add_output_arg();
+    arg->set_name(strings::StrCat("output_", i));
+    arg->set_type(output_types[i]);
+  }
+  for (const auto& output_range : output_ranges) {
+    for (int i = output_range.second.first; i < output_range.second.second;
+         ++i) {
+      const string output = strings::StrCat(node->name(), ":",
+                                            output_range.first, ":",
+                                            i - output_range.second.first);
+      (*per_element_function.mutable_ret())[strings::StrCat("output_", i)] =
+          output;
+      function_utils::ReplaceReferences(
+          output, strings::StrCat(map_defun.name(), ":output:", i), function);
+    }
+  }
+
+  AddNodeAttr("Targuments", argument_types, &map_defun);
+  AddNodeAttr("Tcaptured", captured_types, &map_defun);
+  AddNodeAttr("output_types", output_types, &map_defun);
+  AddNodeAttr("output_shapes",
+              std::vector<PartialTensorShape>(output_types.size()), &map_defun);
+  AttrValue f;
+  f.mutable_func()->set_name(per_element_function.signature().name());
+  (*map_defun.mutable_attr())["f"] = std::move(f);
+  AddNodeAttr("max_intra_op_parallelism", 1, &map_defun);
+
+  *library->add_function() = std::move(per_element_function);
+  *node = std::move(map_defun);
+  return OkStatus();
+}
+
+// Returns the output shapes of `batch_node` for elements of `input_shapes`.
+std::vector<PartialTensorShape> BatchedShapes(
+    const NodeDef& batch_node,
+    const std::vector<PartialTensorShape>& input_shapes) {
+  int64_t batch_size = -1;
+  auto it = batch_node.attr().find(kOutputShapes);
+  if (it != batch_node.attr().end() && it->second.list().shape_size() > 0) {
+    PartialTensorShape shape(it->second.list().shape(0));
+    if (shape.dims() > 0) batch_size = shape.dim_size(0);
+  }
+  std::vector<PartialTensorShape> batched_shapes;
+  batched_shapes.reserve(input_shapes.size());
+  for (const PartialTensorShape& shape : input_shapes) {
+    batched_shapes.push_back(
+        shape.unknown_rank() ? PartialTensorShape()
+                             : PartialTensorShape({batch_size}).Concatenate(
+                                   shape));
+  }
+  return batched_shapes;
+}
+
+}  // namespace
+
+Status VectorizeMapFunction(const FunctionDef& function, int num_stacked_args,
+                            const std::vector<int>& arg_ranks,
+                            const FunctionLibraryDefinition& function_library,
+                            FunctionDefLibrary* library,
+                            FunctionDef* vectorized_function) {
+  *vectorized_function = function;
+  graph_utils::SetUniqueGraphFunctionName(
+      strings::StrCat("vectorized/", function.signature().name()), library,
+      vectorized_function);
+
+  // The tensors of the vectorized function, by node or argument name. All the
+  // outputs of a node are either stacked or unstacked.
+  absl::flat_hash_map<string, VectorizedTensor> tensors;
+  const auto& args = function.signature().input_arg();
+  for (int i = 0; i < args.size(); ++i) {
+    VectorizedTensor arg;
+    if (i < num_stacked_args) {
+      arg.stacked = true;
+      arg.element_rank = i < arg_ranks.size() ? arg_ranks[i] : -1;
+    }
+    tensors[args[i].name()] = arg;
+  }
+
+  std::vector<int> order;
+  TF_RETURN_IF_ERROR(TopologicalOrder(*vectorized_function, &order));
+  int num_vectorized_nodes = 0;
+  for (int index : order) {
+    NodeDef* node = vectorized_function->mutable_node_def(index);
+    std::vector<VectorizedTensor> inputs;
+    bool has_stacked_input = false;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) continue;
+      auto it = tensors.find(ReferencedName(input));
+      if (it == tensors.end()) {
+        return errors::InvalidArgument("Unknown input ", input, " of node ",
+                                       node->name());
+      }
+      inputs.push_back(it->second);
+      has_stacked_input |= it->second.stacked;
+    }
+
+    VectorizedTensor output;
+    Vectorizer* vectorizer = VectorizerRegistry::Global()->Get(node->op());
+    NodeDef vectorized_node = *node;
+    if (vectorizer != nullptr &&
+        vectorizer->Vectorize(inputs, &vectorized_node, &output).ok()) {
+      *node = std::move(vectorized_node);
+      if (output.stacked) ++num_vectorized_nodes;
+    } else if (!has_stacked_input) {
+      // The function is stateless, so the node has the same outputs for every
+      // element and runs once per batch.
+      output = VectorizedTensor();
+    } else {
+      TF_RETURN_IF_ERROR(AddMapDefunFallback(inputs, function_library, library,
+                                             vectorized_function, node));
+      output.stacked = true;
+    }
+    tensors[node->name()] = output;
+  }
+
+  for (const auto& ret : vectorized_function->ret()) {
+    auto it = tensors.find(ReferencedName(ret.second));
+    if (it == tensors.end() || !it->second.stacked) {
+      return errors::Unimplemented("The output ", ret.first, " of ",
+                                   function.signature().name(),
+                                   " is not stacked.");
+    }
+  }
+  if (num_vectorized_nodes == 0) {
+    return errors::Unimplemented("None of the ops of ",
+                                 function.signature().name(),
+                                 " can be vectorized.");
+  }
+  return OkStatus();
+}
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDataset && node.op() != kBatchDatasetV2) {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || (map_node->op() != kMapDataset &&
+                                map_node->op() != kParallelMapDatasetV2)) {
+      continue;
+    }
+    // The map can only be moved after the batch if the batch is its only
+    // consumer.
+    if (graph.GetFanouts(*map_node, /*include_controlling_edges=*/true)
+            .size() != 1) {
+      continue;
+    }
+    const FunctionDef* map_function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (map_function == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *map_function,
+                                           /*skip_assert=*/true)) {
+      continue;
+    }
+
+    // The first arguments of the map function are the components of the
+    // input elements, the others are captured inputs.
+    const int num_components =
+        map_function->signature().input_arg_size() -
+        map_node->attr().at("Targuments").list().type_size();
+    NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    DataTypeVector input_types;
+    if (num_components <= 0 || input_node == nullptr ||
+        !graph_utils::GetDatasetOutputTypesAttr(*input_node, &input_types)
+             .ok() ||
+        input_types.size() != num_components) {
+      continue;
+    }
+    std::vector<PartialTensorShape> input_shapes(num_components);
+    auto shapes = input_node->attr().find(kOutputShapes);
+    if (shapes != input_node->attr().end() &&
+        shapes->second.list().shape_size() == num_components) {
+      for (int i = 0; i < num_components; ++i) {
+        input_shapes[i] = PartialTensorShape(shapes->second.list().shape(i));
+      }
+    }
+    std::vector<int> arg_ranks;
+    for (const PartialTensorShape& shape : input_shapes) {
+      arg_ranks.push_back(shape.dims());
+    }
+
+    FunctionDefLibrary library = output->library();
+    FunctionDef vectorized_function;
+    Status s = VectorizeMapFunction(*map_function, num_components, arg_ranks,
+                                    function_library, &library,
+                                    &vectorized_function);
+    if (!s.ok()) {
+      VLOG(2) << "Not vectorizing " << map_node->name() << ": " << s;
+      continue;
+    }
+    *library.add_function() = vectorized_function;
+    *output->mutable_library() = std::move(library);
+
+    NodeDef new_batch_node = batch_node;
+    graph_utils::SetUniqueGraphNodeName(
+        strings::StrCat("vectorized/", batch_node.name()), output,
+        &new_batch_node);
+    new_batch_node.set_input(0, map_node->input(0));
+    SetAttrValue(input_types, &(*new_batch_node.mutable_attr())[kOutputTypes]);
+    SetAttrValue(BatchedShapes(batch_node, input_shapes),
+                 &(*new_batch_node.mutable_attr())[kOutputShapes]);
+    NodeDef* new_batch = graph.AddNode(std::move(new_batch_node));
+
+    NodeDef new_map_node = *map_node;
+    graph_utils::SetUniqueGraphNodeName(
+        strings::StrCat("vectorized/", map_node->name()), output,
+        &new_map_node);
+    new_map_node.set_input(0, new_batch->name());
+    (*new_map_node.mutable_attr())["f"].mutable_func()->set_name(
+        vectorized_function.signature().name());
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map_node);
+    NodeDef* new_map = graph.AddNode(std::move(new_map_node));
+
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Vectorizes the function of a stateless map transformation which is followed
+// by a batch transformation, and moves the map after the batch:
+//
+//   input.map(f).batch(b) -> input.batch(b).map(vectorized_f)
+//
+// so that `vectorized_f` runs once per batch instead of once per element. The
+// ops of `f` are vectorized with the vectorizers of `VectorizerRegistry`; an op
+// without a vectorizer for its inputs runs once per element of the batch in a
+// `MapDefun`. The map is left as is if none of its ops is vectorized.
+class MapVectorization : public TFDataOptimizerBase {
+ public:
+  MapVectorization() = default;
+  ~MapVectorization() override = default;
+
+  string name() const override { return "map_vectorization"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+};
+
+// Vectorizes `function`, whose first `num_stacked_args` arguments are stacked
+// and whose other arguments are unstacked. `arg_ranks` holds the element ranks
+// of the stacked arguments, or -1 if unknown. The functions called by the
+// `MapDefun` fallbacks are added to `library`. Returns an error if `function`
+// can't be vectorized or if none of its ops has a vectorizer.
+Status VectorizeMapFunction(const FunctionDef& function, int num_stacked_args,
+                            const std::vector<int>& arg_ranks,
+                            const FunctionLibraryDefinition& function_library,
+                            FunctionDefLibrary* library,
+                            FunctionDef* vectorized_function);
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_VECTORIZATION_H_
@@ -0,0 +1,157 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+Status OptimizeWithMapVectorization(const GrapplerItem& item,
+                                    GraphDef* output) {
+  MapVectorization optimizer;
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+// Returns a function which computes `Unique(Neg(x))`. `Unique` has no
+// vectorizer, so it is run once per element with `MapDefun`.
+FunctionDef NegUnique() {
+  return FunctionDefHelper::Create(
+      "NegUnique", {"x: int64"}, {"y: int64"}, {},
+      {{{"neg"}, "Neg", {"x"}, {{"T", DT_INT64}}},
+       {{"unique"},
+        "Unique",
+        {"neg:y:0"},
+        {{"T", DT_INT64}, {"out_idx", DT_INT32}}}},
+      {{"y", "unique:y:0"}});
+}
+
+GrapplerItem MakeMapAndBatchItem(const string& function_name,
+                                 const FunctionDef& function,
+                                 bool map_has_other_consumer = false) {
+  GrapplerItem item;
+  std::vector<NodeDef> nodes = {
+      NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+      NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+      NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+      NDef("range", "RangeDataset", {"start", "stop", "step"},
+           {{"output_shapes", gtl::ArraySlice<TensorShape>{{}}},
+            {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}}),
+      MakeMapNode("map", "range", function_name),
+      NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+      NDef("drop_remainder", "Const", {},
+           {{"value", false}, {"dtype", DT_BOOL}}),
+      MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                      /*parallel_copy=*/false),
+      NDef("Sink", "Identity", {"batch"}, {})};
+  if (map_has_other_consumer) {
+    nodes.push_back(NDef("OtherSink", "Identity", {"map"}, {}));
+  }
+  item.graph = test::function::GDef(nodes, {function});
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+const FunctionDef* FindVectorizedFunction(const GraphDef& graph) {
+  for (const FunctionDef& function : graph.library().function()) {
+    if (absl::StartsWith(function.signature().name(), "vectorized/")) {
+      return &function;
+    }
+  }
+  return nullptr;
+}
+
+TEST(MapVectorizationTest, VectorizesCwiseFunction) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("XTimesTwo", test::function::XTimesTwo());
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  const NodeDef& map_node =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(map_node.input(0), batch_node.name());
+  EXPECT_EQ(batch_node.input(0), "range");
+  const NodeDef& sink_node =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink_node.input(0), map_node.name());
+
+  const FunctionDef* vectorized_function = FindVectorizedFunction(output);
+  ASSERT_NE(vectorized_function, nullptr);
+  EXPECT_EQ(map_node.attr().at("f").func().name(),
+            vectorized_function->signature().name());
+  EXPECT_EQ(function_utils::FindFunctionNodeWithOp("MapDefun",
+                                                   *vectorized_function),
+            -1);
+}
+
+TEST(MapVectorizationTest, FallsBackToMapDefun) {
+  GrapplerItem item = MakeMapAndBatchItem("NegUnique", NegUnique());
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+
+  const FunctionDef* vectorized_function = FindVectorizedFunction(output);
+  ASSERT_NE(vectorized_function, nullptr);
+  EXPECT_NE(function_utils::FindFunctionNodeWithOp("Neg", *vectorized_function),
+            -1);
+  EXPECT_NE(
+      function_utils::FindFunctionNodeWithOp("MapDefun", *vectorized_function),
+      -1);
+  EXPECT_EQ(
+      function_utils::FindFunctionNodeWithOp("Unique", *vectorized_function),
+      -1);
+}
+
+TEST(MapVectorizationTest, StatefulFunctionIsNotVectorized) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("RandomUniformFn", test::function::RandomUniform());
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, MapWithOtherConsumersIsNotVectorized) {
+  GrapplerItem item =
+      MakeMapAndBatchItem("XTimesTwo", test::function::XTimesTwo(),
+                          /*map_has_other_consumer=*/true);
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
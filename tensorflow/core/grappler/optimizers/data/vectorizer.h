@@ -0,0 +1,101 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Describes a tensor of a vectorized map function. A tensor is "stacked" if it
+// has an extra leading dimension holding its values for every element of a
+// batch, and "unstacked" if it has the same value for every element, e.g.
+// because it is computed from constants.
+struct VectorizedTensor {
+  bool stacked = false;
+  // The rank of the value of the tensor for a single element, or -1 if it is
+  // unknown.
+  int element_rank = -1;
+};
+
+// Interface for the vectorization of a single op of a map function.
+class Vectorizer {
+ public:
+  virtual ~Vectorizer() = default;
+
+  // Vectorizes `node`, whose data inputs are described by `inputs`. `node` may
+  // be modified in place, and on success `*output` describes its outputs.
+  // Returns an error if `node` can't be vectorized with these inputs, in which
+  // case the caller falls back to running `node` once per element with
+  // `MapDefun`.
+  virtual Status Vectorize(const std::vector<VectorizedTensor>& inputs,
+                           NodeDef* node, VectorizedTensor* output) = 0;
+};
+
+// Registry of the vectorizers, by op type.
+class VectorizerRegistry {
+ public:
+  // Returns the global registry.
+  static VectorizerRegistry* Global();
+
+  // Returns the vectorizer of `op_type`, or nullptr if there is none.
+  Vectorizer* Get(const string& op_type) TF_LOCKS_EXCLUDED(mu_);
+
+  // Registers `vectorizer` for `op_type`. Dies if `op_type` already has one.
+  void Register(const string& op_type, std::unique_ptr<Vectorizer> vectorizer)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<string, std::unique_ptr<Vectorizer>> vectorizers_
+      TF_GUARDED_BY(mu_);
+};
+
+namespace vectorizer_registration {
+
+class VectorizerRegistration {
+ public:
+  VectorizerRegistration(const string& op_type,
+                         std::unique_ptr<Vectorizer> vectorizer) {
+    VectorizerRegistry::Global()->Register(op_type, std::move(vectorizer));
+  }
+};
+
+}  // namespace vectorizer_registration
+
+#define REGISTER_VECTORIZER(op_type, vectorizer) \
+  REGISTER_VECTORIZER_UNIQ_HELPER(__COUNTER__, op_type, vectorizer)
+
+#define REGISTER_VECTORIZER_UNIQ_HELPER(ctr, op_type, vectorizer) \
+  REGISTER_VECTORIZER_UNIQ(ctr, op_type, vectorizer)
+
+#define REGISTER_VECTORIZER_UNIQ(ctr, op_type, vectorizer)               \
+  static ::tensorflow::grappler::vectorizer_registration::              \
+      VectorizerRegistration vectorizer_registration_##ctr(             \
+          op_type, ::std::unique_ptr<::tensorflow::grappler::Vectorizer>( \
+                       new vectorizer()))
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_VECTORIZER_H_
@@ -0,0 +1,277 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_fusion.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kFusedEmbeddingLookups[] = "_FusedEmbeddingLookups";
+constexpr char kMinGroupSize[] = "min_group_size";
+
+// A `ResourceGather` feeding a `SparseSegment{Sum,Mean,SqrtN}`.
+struct Lookup {
+  NodeDef* gather;
+  NodeDef* segment_reduction;
+  // Names of the nodes the lookup depends on.
+  absl::flat_hash_set<std::string> ancestors;
+};
+
+bool GetCombiner(const NodeDef& node, std::string* combiner) {
+  if (node.op() == "SparseSegmentSum") {
+    *combiner = "sum";
+  } else if (node.op() == "SparseSegmentMean") {
+    *combiner = "mean";
+  } else if (node.op() == "SparseSegmentSqrtN") {
+    *combiner = "sqrtn";
+  } else {
+    return false;
+  }
+  return true;
+}
+
+DataType GetTypeAttr(const NodeDef& node, const std::string& name,
+                     DataType default_type) {
+  auto it = node.attr().find(name);
+  return it == node.attr().end() ? default_type : it->second.type();
+}
+
+int CountInputsFrom(const NodeDef& node, const std::string& name) {
+  int count = 0;
+  for (const std::string& input : node.input()) {
+    if (NodeName(input) == name) ++count;
+  }
+  return count;
+}
+
+// Returns the names of all the nodes `lookup` transitively depends on, apart
+// from its own nodes.
+absl::flat_hash_set<std::string> CollectAncestors(const NodeMap& node_map,
+                                                  const Lookup& lookup) {
+  absl::flat_hash_set<std::string> ancestors;
+  std::deque<const NodeDef*> queue = {lookup.gather, lookup.segment_reduction};
+  while (!queue.empty()) {
+    const NodeDef* node = queue.front();
+    queue.pop_front();
+    for (const std::string& input : node->input()) {
+      const std::string input_name = NodeName(input);
+      if (input_name == lookup.gather->name() ||
+          !ancestors.insert(input_name).second) {
+        continue;
+      }
+      const NodeDef* input_node = node_map.GetNode(input_name);
+      if (input_node != nullptr) {
+        queue.push_back(input_node);
+      }
+    }
+  }
+  return ancestors;
+}
+
+}  // namespace
+
+Status EmbeddingLookupFusion::Init(
+    const tensorflow::RewriterConfig_CustomGraphOptimizer* config) {
+  if (config == nullptr) return OkStatus();
+  auto it = config->parameter_map().find(kMinGroupSize);
+  if (it != config->parameter_map().end()) {
+    min_group_size_ = it->second.i();
+    if (min_group_size_ < 2) {
+      return errors::InvalidArgument(kMinGroupSize, " must be at least 2, got ",
+                                     min_group_size_);
+    }
+  }
+  return OkStatus();
+}
+
+Status EmbeddingLookupFusion::Optimize(Cluster* cluster,
+                                       const GrapplerItem& item,
+                                       GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<std::string> nodes_to_preserve =
+      item.NodesToPreserve();
+  FrameView frame_view;
+  TF_RETURN_IF_ERROR(frame_view.InferFromGraph(*optimized_graph));
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(*optimized_graph, &topo_order));
+
+  GraphProperties properties(item);
+  bool properties_inferred = false;
+
+  // Candidate lookups in topological order, grouped by device, types and
+  // combiner.
+  std::map<std::string, std::vector<Lookup>> candidates;
+  for (const NodeDef* sorted_node : topo_order) {
+    NodeDef* node = node_map.GetNode(sorted_node->name());
+    std::string combiner;
+    if (!GetCombiner(*node, &combiner) || node->input_size() < 3 ||
+        IsControlInput(node->input(0)) || !NodeIsOnCpu(node) ||
+        frame_view.IsInFrame(*node)) {
+      continue;
+    }
+    int port;
+    const std::string gather_name = ParseNodeName(node->input(0), &port);
+    NodeDef* gather = node_map.GetNode(gather_name);
+    if (gather == nullptr || gather->op() != "ResourceGather" || port != 0 ||
+        gather->device() != node->device() ||
+        nodes_to_preserve.count(gather_name) > 0 ||
+        node_map.GetOutputs(gather_name).size() != 1 ||
+        CountInputsFrom(*node, gather_name) != 1) {
+      continue;
+    }
+    auto batch_dims = gather->attr().find("batch_dims");
+    const DataType dtype = GetTypeAttr(*gather, "dtype", DT_INVALID);
+    if ((batch_dims != gather->attr().end() && batch_dims->second.i() != 0) ||
+        dtype != GetTypeAttr(*node, "T", DT_INVALID)) {
+      continue;
+    }
+    // The fused kernel only supports vectors of ids.
+    if (!properties_inferred) {
+      TF_RETURN_IF_ERROR(properties.InferStatically(
+          /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/false,
+          /*include_output_tensor_values=*/false));
+      properties_inferred = true;
+    }
+    const auto& gather_inputs = properties.GetInputProperties(gather_name);
+    if (gather_inputs.size() < 2 || gather_inputs[1].shape().unknown_rank() ||
+        gather_inputs[1].shape().dim_size() != 1) {
+      continue;
+    }
+    const std::string key = absl::StrCat(
+        node->device(), "|", combiner, "|", dtype, "|",
+        GetTypeAttr(*gather, "Tindices", DT_INT32), "|",
+        GetTypeAttr(*node, "Tidx", DT_INT32), "|",
+        GetTypeAttr(*node, "Tsegmentids", DT_INT32));
+    Lookup lookup{gather, node, {}};
+    lookup.ancestors = CollectAncestors(node_map, lookup);
+    candidates[key].push_back(std::move(lookup));
+  }
+
+  std::set<std::string> gathers_to_delete;
+  for (auto& [key, lookups] : candidates) {
+    std::vector<Lookup*> remaining;
+    for (Lookup& lookup : lookups) remaining.push_back(&lookup);
+    while (static_cast<int>(remaining.size()) >= min_group_size_) {
+      // Greedily add lookups that do not depend on the ones already in the
+      // group. As lookups are in topological order, no lookup of the group
+      // can depend on a lookup added after it.
+      std::vector<Lookup*> group;
+      std::vector<Lookup*> left_over;
+      for (Lookup* lookup : remaining) {
+        bool independent = true;
+        for (const Lookup* member : group) {
+          if (lookup->ancestors.contains(member->segment_reduction->name())) {
+            independent = false;
+            break;
+          }
+        }
+        (independent ? group : left_over).push_back(lookup);
+      }
+      remaining = std::move(left_over);
+      if (static_cast<int>(group.size()) < min_group_size_) continue;
+
+      const NodeDef& first = *group.front()->segment_reduction;
+      std::string fused_name =
+          AddPrefixToNodeName(kFusedEmbeddingLookups, first.name());
+      while (node_map.NodeExists(fused_name)) {
+        fused_name = absl::StrCat(fused_name, "_");
+      }
+      NodeDef* fused = optimized_graph->add_node();
+      fused->set_name(fused_name);
+      fused->set_op(kFusedEmbeddingLookups);
+      fused->set_device(first.device());
+      for (const Lookup* lookup : group) {
+        fused->add_input(lookup->gather->input(0));
+      }
+      for (const Lookup* lookup : group) {
+        fused->add_input(lookup->gather->input(1));
+      }
+      for (int input : {1, 2}) {
+        for (const Lookup* lookup : group) {
+          fused->add_input(lookup->segment_reduction->input(input));
+        }
+      }
+      absl::flat_hash_set<std::string> control_inputs;
+      for (const Lookup* lookup : group) {
+        for (const NodeDef* node :
+             {lookup->gather, lookup->segment_reduction}) {
+          for (const std::string& input : node->input()) {
+            if (IsControlInput(input) && control_inputs.insert(input).second) {
+              fused->add_input(input);
+            }
+          }
+        }
+      }
+      std::string combiner;
+      GetCombiner(first, &combiner);
+      const NodeDef& first_gather = *group.front()->gather;
+      auto* attr = fused->mutable_attr();
+      SetAttrValue(static_cast<int64_t>(group.size()), &(*attr)["N"]);
+      SetAttrValue(GetTypeAttr(first_gather, "dtype", DT_INVALID),
+                   &(*attr)["dtype"]);
+      SetAttrValue(GetTypeAttr(first_gather, "Tindices", DT_INT32),
+                   &(*attr)["Tindices"]);
+      SetAttrValue(GetTypeAttr(first, "Tidx", DT_INT32), &(*attr)["Tidx"]);
+      SetAttrValue(GetTypeAttr(first, "Tsegmentids", DT_INT32),
+                   &(*attr)["Tsegmentids"]);
+      SetAttrValue(combiner, &(*attr)["combiner"]);
+
+      // The reductions become identities of the fused outputs, so that their
+      // consumers and fetches are left untouched.
+      for (size_t i = 0; i < group.size(); ++i) {
+        NodeDef* reduction = group[i]->segment_reduction;
+        const DataType dtype = GetTypeAttr(*reduction, "T", DT_INVALID);
+        reduction->set_op("Identity");
+        reduction->clear_input();
+        reduction->add_input(absl::StrCat(fused_name, ":", i));
+        reduction->clear_attr();
+        SetAttrValue(dtype, &(*reduction->mutable_attr())["T"]);
+        gathers_to_delete.insert(group[i]->gather->name());
+      }
+      VLOG(2) << "Fused " << group.size() << " embedding lookups into "
+              << fused_name;
+    }
+  }
+  EraseNodesFromGraph(gathers_to_delete, optimized_graph);
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(EmbeddingLookupFusion, "embedding_lookup_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
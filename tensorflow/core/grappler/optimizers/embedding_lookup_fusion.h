@@ -0,0 +1,60 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_FUSION_H_
+
+#include <string>
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fuses independent embedding lookups into `_FusedEmbeddingLookups` nodes.
+//
+// Recommender models typically look up dozens of feature tables with one
+// `ResourceGather` + `SparseSegment{Sum,Mean,SqrtN}` chain per table. Chains
+// placed on the same CPU device, with the same types and combiner, are
+// replaced by a single node computing all the lookups at once, without
+// materializing the gathered rows. Chains whose inputs depend on another
+// chain of the group are left alone, so fusing never creates cycles.
+//
+// The optimizer is enabled through `RewriterConfig.custom_optimizers`, with
+// the name "embedding_lookup_fusion". The optional `min_group_size` parameter
+// (default 2) sets the number of chains below which a group is not fused.
+class EmbeddingLookupFusion : public CustomGraphOptimizer {
+ public:
+  EmbeddingLookupFusion() = default;
+  ~EmbeddingLookupFusion() override = default;
+
+  std::string name() const override { return "embedding_lookup_fusion"; }
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override;
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+ private:
+  int min_group_size_ = 2;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_EMBEDDING_LOOKUP_FUSION_H_
@@ -0,0 +1,151 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/embedding_lookup_fusion.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+class EmbeddingLookupFusionTest : public GrapplerTest {
+ protected:
+  // Adds a `ResourceGather` + `SparseSegmentMean` chain named after `prefix`.
+  Output AddLookup(const Scope& s, const std::string& prefix, Input ids) {
+    Output table = ops::VarHandleOp(s.WithOpName(prefix + "_table"), DT_FLOAT,
+                                    TensorShape({10, 4}));
+    Output gather =
+        ops::ResourceGather(s.WithOpName(prefix + "_gather"), table, ids,
+                            DT_FLOAT);
+    Output indices =
+        ops::Const(s.WithOpName(prefix + "_indices"), {0, 1, 2}, {3});
+    Output segment_ids =
+        ops::Const(s.WithOpName(prefix + "_segment_ids"), {0, 0, 1}, {3});
+    return ops::SparseSegmentMean(s.WithOpName(prefix + "_mean"), gather,
+                                  indices, segment_ids);
+  }
+
+  int CountOps(const GraphDef& graph, const std::string& op) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == op) ++count;
+    }
+    return count;
+  }
+};
+
+TEST_F(EmbeddingLookupFusionTest, FusesIndependentLookups) {
+  Scope s = Scope::NewRootScope().WithDevice(kDevice);
+  AddLookup(s, "a", ops::Const(s.WithOpName("a_ids"), {1LL, 3LL, 5LL}, {3}));
+  AddLookup(s, "b", ops::Const(s.WithOpName("b_ids"), {2LL, 4LL, 6LL}, {3}));
+
+  GrapplerItem item;
+  item.fetch = {"a_mean", "b_mean"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  EmbeddingLookupFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "ResourceGather"), 0);
+  EXPECT_EQ(CountOps(output, "SparseSegmentMean"), 0);
+  const NodeDef* fused = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "_FusedEmbeddingLookups") fused = &node;
+  }
+  ASSERT_NE(fused, nullptr);
+  EXPECT_EQ(fused->attr().at("N").i(), 2);
+  EXPECT_EQ(fused->attr().at("combiner").s(), "mean");
+  EXPECT_EQ(fused->attr().at("Tindices").type(), DT_INT64);
+  ASSERT_EQ(fused->input_size(), 8);
+  EXPECT_EQ(fused->input(0), "a_table");
+  EXPECT_EQ(fused->input(1), "b_table");
+  EXPECT_EQ(fused->input(2), "a_ids");
+  EXPECT_EQ(fused->input(3), "b_ids");
+
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "a_mean" || node.name() == "b_mean") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), absl::StrCat(fused->name(), ":",
+                                            node.name() == "a_mean" ? 0 : 1));
+    }
+  }
+}
+
+TEST_F(EmbeddingLookupFusionTest, DoesNotFuseDependentLookups) {
+  Scope s = Scope::NewRootScope().WithDevice(kDevice);
+  Output a_ids = ops::Const(s.WithOpName("a_ids"), {1LL, 3LL, 5LL}, {3});
+  Output a = AddLookup(s, "a", a_ids);
+  // The ids of the second lookup are computed from the first one.
+  Output b_ids = ops::Reshape(
+      s.WithOpName("b_ids"),
+      ops::Cast(s.WithOpName("b_ids_cast"),
+                ops::Slice(s.WithOpName("b_ids_slice"), a, {0, 0}, {1, 3}),
+                DT_INT64),
+      {3});
+  AddLookup(s, "b", b_ids);
+
+  GrapplerItem item;
+  item.fetch = {"b_mean"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  EmbeddingLookupFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "_FusedEmbeddingLookups"), 0);
+  EXPECT_EQ(CountOps(output, "ResourceGather"), 2);
+}
+
+TEST_F(EmbeddingLookupFusionTest, RespectsMinGroupSize) {
+  Scope s = Scope::NewRootScope().WithDevice(kDevice);
+  AddLookup(s, "a", ops::Const(s.WithOpName("a_ids"), {1LL, 3LL, 5LL}, {3}));
+  AddLookup(s, "b", ops::Const(s.WithOpName("b_ids"), {2LL, 4LL, 6LL}, {3}));
+
+  GrapplerItem item;
+  item.fetch = {"a_mean", "b_mean"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  RewriterConfig_CustomGraphOptimizer config;
+  (*config.mutable_parameter_map())["min_group_size"].set_i(3);
+  EmbeddingLookupFusion optimizer;
+  TF_ASSERT_OK(optimizer.Init(&config));
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "_FusedEmbeddingLookups"), 0);
+  EXPECT_EQ(CountOps(output, "SparseSegmentMean"), 2);
+}
+
+TEST_F(EmbeddingLookupFusionTest, InvalidMinGroupSize) {
+  RewriterConfig_CustomGraphOptimizer config;
+  (*config.mutable_parameter_map())["min_group_size"].set_i(1);
+  EmbeddingLookupFusion optimizer;
+  EXPECT_FALSE(optimizer.Init(&config).ok());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -457,7 +458,8 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
 // When there is a GPU, the computation graph is converted to NCHW format.
 // When there is only CPU, there will be no conversion by default, unless user
 // chose to convert the graph to a desired format. Currently, NCHW -> NHWC
-// format conversion is available on CPU.
+// format conversion is available on CPU, and NHWC -> NCHW conversion is
+// available on CPU when oneDNN is enabled.
 Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
                                         const GrapplerItem& item,
                                         GraphDef* output) {
@@ -494,12 +496,36 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
       case RewriterConfig::NCHW_TO_NHWC:
         context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
         break;
-      // TODO(intel-tf): Add functionality for NHWC_TO_NCHW layout conversion on
-      // CPU.
       case RewriterConfig::NHWC_TO_NCHW:
-        return errors::Aborted(
-            "Conversion from NHWC to NCHW is currently not  available for "
-            "CPU.");
+        // Only the oneDNN kernels of these ops support NCHW on CPU. As on GPU,
+        // the layout agnostic ops between them are converted too, so that
+        // transposes are only left at the boundaries of converted subgraphs.
+        if (!IsMKLEnabled()) {
+          return errors::Aborted(
+              "Conversion from NHWC to NCHW is only available for CPU when "
+              "oneDNN is enabled.");
+        }
+        context.AssignDeviceAndDataFormats(kCPU, kNHWC, kNCHW);
+        context.supported_layout_sensitive_ops = {
+            "AvgPool",
+            "AvgPoolGrad",
+            "BiasAdd",
+            "BiasAddGrad",
+            "Conv2D",
+            "Conv2DBackpropFilter",
+            "Conv2DBackpropInput",
+            "Conv3D",
+            "Conv3DBackpropFilterV2",
+            "Conv3DBackpropInputV2",
+            "FusedBatchNorm",
+            "FusedBatchNormGrad",
+            "FusedBatchNormGradV2",
+            "FusedBatchNormGradV3",
+            "FusedBatchNormV2",
+            "FusedBatchNormV3",
+            "MaxPool",
+            "MaxPoolGrad"};
+        break;
       default:
         *output = item.graph;
         VLOG(2) << "No layout conversion will take place for CPU.";
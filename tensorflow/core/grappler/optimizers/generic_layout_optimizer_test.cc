@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -583,6 +584,70 @@ TEST_F(GenericLayoutOptimizerTest, DoNotPruneNonAddedCancellableTransposes) {
                           0);
 }
 
+TEST_F(GenericLayoutOptimizerTest, CpuNhwcToNchwWithOneDnn) {
+  using test::function::NDef;
+  if (GetNumAvailableGPUs() > 0) {
+    GTEST_SKIP() << "CPU layout conversion only happens without GPUs.";
+  }
+  constexpr char kCpu[] = "/device:CPU:0";
+
+  GenericLayoutOptimizer optimizer(
+      RewriterConfig::DEFAULT, RewriterConfig::NHWC_TO_NCHW /* CPU settings*/);
+
+  GrapplerItem item;
+  item.graph = test::function::GDef({
+      NDef("x", "Placeholder", {},
+           {{"dtype", DT_FLOAT}, {"shape", TensorShape({8, 32, 32, 3})}},
+           kCpu),
+      NDef("filter", "Const", {},
+           {{"dtype", DT_FLOAT},
+            {"value", Tensor(DT_FLOAT, TensorShape({2, 2, 3, 4}))}},
+           kCpu),
+      NDef("conv", "Conv2D", {"x", "filter"},
+           {{"T", DT_FLOAT},
+            {"strides", std::vector<int>{1, 1, 1, 1}},
+            {"padding", "VALID"},
+            {"data_format", "NHWC"}},
+           kCpu),
+      NDef("relu", "Relu", {"conv"}, {{"T", DT_FLOAT}}, kCpu),
+      NDef("pool", "MaxPool", {"relu"},
+           {{"T", DT_FLOAT},
+            {"ksize", std::vector<int>{1, 2, 2, 1}},
+            {"strides", std::vector<int>{1, 2, 2, 1}},
+            {"padding", "VALID"},
+            {"data_format", "NHWC"}},
+           kCpu),
+      NDef("output", "Identity", {"pool"}, {{"T", DT_FLOAT}}, kCpu),
+  });
+
+  GraphDef output;
+  Status status = optimizer.Optimize(virtual_cluster_.get(), item, &output);
+  if (!IsMKLEnabled()) {
+    EXPECT_TRUE(absl::IsAborted(status)) << status;
+    return;
+  }
+  TF_ASSERT_OK(status);
+
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("conv");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NCHW");
+  auto* pool_node = graph_view.GetNode("pool");
+  ASSERT_NE(pool_node, nullptr);
+  VerifyDataFormatAttributeMatch(pool_node, "NCHW");
+  // The chain stays in NCHW, with transposes only at its boundaries.
+  auto* relu_node = graph_view.GetNode("relu");
+  ASSERT_NE(relu_node, nullptr);
+  VerifyRegularFaninMatch(relu_node, 0, "conv", 0);
+  VerifyRegularFaninMatch(pool_node, 0, "relu", 0);
+  EXPECT_EQ(conv_node->GetRegularFanin(0).node_view()->GetOp(), "Transpose");
+  auto* output_node = graph_view.GetNode("output");
+  ASSERT_NE(output_node, nullptr);
+  EXPECT_EQ(output_node->GetRegularFanin(0).node_view()->GetOp(),
+            "Transpose");
+}
+
 TEST_F(GenericLayoutOptimizerTest, CancelTransposeAroundPad) {
   using test::function::NDef;
 
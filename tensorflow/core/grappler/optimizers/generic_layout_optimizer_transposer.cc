@@ -278,11 +278,16 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   // Only checks data format for layout sensitive op.
   const bool data_format_match = !IsLayoutSensitiveOp(*node_def) ||
                                  AttrDataFormatMatch(node, context.src_format);
+  const bool op_supported =
+      !IsLayoutSensitiveOp(*node_def) ||
+      context.supported_layout_sensitive_ops.empty() ||
+      context.supported_layout_sensitive_ops.contains(node_def->op());
 
   // Only transposes floating point nodes.
   const bool is_integer_conv2d = IsNonFloatingConv2D(node);
 
-  return is_on_target_device && data_format_match && !is_integer_conv2d &&
+  return is_on_target_device && data_format_match && op_supported &&
+         !is_integer_conv2d &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
@@ -83,6 +83,9 @@ struct TransposeContext {
   absl::flat_hash_map<char, int> dst_dim_indices;
   std::vector<int> src_to_dst;
   std::vector<int> dst_to_src;
+  // If not empty, only layout sensitive ops in this set are converted. This is
+  // used on CPU, where few kernels support the NCHW format.
+  absl::flat_hash_set<string> supported_layout_sensitive_ops;
 
   string enforced_layout;
 };
@@ -102,6 +105,7 @@ class Transposer {
   // Following common conditions are checked:
   // * node's device matches target device
   // * node's source format matches config's source format
+  // * node's op supports the destination format, for layout sensitive ops
   // * node has output
   bool ShouldProcess(const TransposeContext& context,
                      const utils::MutableNodeView& node) const;
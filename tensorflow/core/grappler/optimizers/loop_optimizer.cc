@@ -18,20 +18,29 @@ limitations under the License.
 #include <algorithm>
 #include <deque>
 #include <limits>
+#include <numeric>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
@@ -547,6 +556,98 @@ Status RemoveStackOps(const std::unordered_set<string>& nodes_to_preserve,
   return OkStatus();
 }
 
+// TensorList ops that modify their input list in place when they hold the
+// only reference to it, and copy the whole list otherwise.
+bool IsTensorListMutation(const NodeDef& node) {
+  static const auto* const kOps = new absl::flat_hash_set<string>{
+      "TensorListPushBack", "TensorListPopBack", "TensorListResize",
+      "TensorListScatterIntoExistingList", "TensorListSetItem"};
+  return kOps->contains(node.op());
+}
+
+// TensorList ops that only read their input list.
+bool IsTensorListRead(const NodeDef& node) {
+  static const auto* const kOps = new absl::flat_hash_set<string>{
+      "TensorListConcat", "TensorListConcatV2", "TensorListElementShape",
+      "TensorListGather", "TensorListGetItem",  "TensorListLength",
+      "TensorListStack"};
+  return kOps->contains(node.op());
+}
+
+// Returns true if `reader` can be made to run before `mutation`, both
+// consuming the list `list`, through a control dependency. The control
+// dependency must neither create a cycle nor change the deadness of
+// `mutation`, which holds if all the other inputs of `reader` are inputs of
+// `mutation` or are produced by nodes without inputs.
+bool CanOrderTensorListRead(const NodeDef& reader, const NodeDef& mutation,
+                            const TensorId& list, const NodeMap& node_map) {
+  if (!IsTensorListRead(reader) || reader.device() != mutation.device()) {
+    return false;
+  }
+  absl::flat_hash_set<string> mutation_inputs;
+  for (const string& input : mutation.input()) {
+    mutation_inputs.insert(ParseTensorName(input).ToString());
+  }
+  for (const string& input : reader.input()) {
+    const TensorId id = ParseTensorName(input);
+    if (id == list || mutation_inputs.contains(id.ToString())) continue;
+    if (IsControlInput(input)) return false;
+    const NodeDef* producer = node_map.GetNode(input);
+    if (producer == nullptr || producer->input_size() > 0) return false;
+  }
+  return true;
+}
+
+// Adds control dependencies from the ops only reading a TensorList to the op
+// mutating it, when that op is the only other consumer of the list. Without
+// them the mutating op may run while the readers still hold a reference to
+// the list, and has to copy it instead of updating it in place, which turns
+// loops appending to a list into quadratic time and memory.
+Status OrderTensorListReads(GraphDef* optimized_graph) {
+  NodeMap node_map(optimized_graph);
+  for (int i = 0; i < optimized_graph->node_size(); ++i) {
+    NodeDef* mutation = optimized_graph->mutable_node(i);
+    if (!IsTensorListMutation(*mutation) || mutation->input_size() == 0 ||
+        IsControlInput(mutation->input(0))) {
+      continue;
+    }
+    const TensorId list = ParseTensorName(mutation->input(0));
+    const NodeDef* producer = node_map.GetNode(mutation->input(0));
+    if (producer == nullptr) continue;
+
+    std::vector<const NodeDef*> readers;
+    bool can_order = true;
+    for (const NodeDef* consumer :
+         node_map.GetOutputsOrderedByNodeName(producer->name())) {
+      if (consumer == mutation) continue;
+      bool consumes_list = false;
+      for (const string& input : consumer->input()) {
+        if (!IsControlInput(input) && ParseTensorName(input) == list) {
+          consumes_list = true;
+          break;
+        }
+      }
+      if (!consumes_list) continue;
+      if (!CanOrderTensorListRead(*consumer, *mutation, list, node_map)) {
+        can_order = false;
+        break;
+      }
+      readers.push_back(consumer);
+    }
+    if (!can_order) continue;
+
+    for (const NodeDef* reader : readers) {
+      const string ctrl_dep = AsControlDependency(reader->name());
+      if (absl::c_linear_search(mutation->input(), ctrl_dep)) continue;
+      VLOG(1) << "Ordering " << reader->name() << " before "
+              << mutation->name();
+      mutation->add_input(ctrl_dep);
+      node_map.AddOutput(reader->name(), mutation->name());
+    }
+  }
+  return OkStatus();
+}
+
 bool IsSimpleBinaryOperator(const NodeDef& node) {
   return (IsLess(node) || IsLessEqual(node) || IsGreater(node) ||
           IsGreaterEqual(node) || IsEqual(node));
@@ -715,6 +816,492 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return OkStatus();
 }
 
+// Upper bounds on what FunctionalLoopInvariantMotion hoists out of one loop.
+// Every hoisted tensor becomes a loop variable that stays alive for the whole
+// loop, so hoisting trades memory for the recomputation saved.
+constexpr int kMaxHoistedTensorsPerLoop = 16;
+constexpr int64_t kMaxHoistedBytesPerLoop = 64 << 20;
+
+// Ops that are too cheap for hoisting them on their own to pay for an extra
+// loop variable.
+bool IsTrivialToRecompute(const NodeDef& node) {
+  return IsConstant(node) || IsIdentity(node) || IsIdentityN(node) ||
+         IsShape(node) || IsSize(node) || IsRank(node);
+}
+
+bool HasFunctionAttr(const NodeDef& node) {
+  for (const auto& attr : node.attr()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// A tensor in a function body, either an argument `arg` or the output
+// `node:output:index` of a node.
+struct FunctionTensor {
+  string node;
+  string output;
+  int index = 0;
+
+  bool is_arg() const { return output.empty(); }
+  string ToString() const {
+    return is_arg() ? node : StrCat(node, ":", output, ":", index);
+  }
+};
+
+FunctionTensor ParseFunctionTensor(absl::string_view input) {
+  FunctionTensor tensor;
+  std::vector<absl::string_view> parts = absl::StrSplit(input, ':');
+  tensor.node = string(parts[0]);
+  if (parts.size() > 1) tensor.output = string(parts[1]);
+  if (parts.size() > 2 && !absl::SimpleAtoi(parts[2], &tensor.index)) {
+    tensor.index = 0;
+  }
+  return tensor;
+}
+
+// Moves loop invariant computations out of the bodies of functional While
+// loops.
+//
+// A body argument is loop invariant if the body returns it unchanged, and a
+// stateless body node is loop invariant if all its inputs are. The invariant
+// subgraph feeding the rest of the body is cloned in front of the While node,
+// its outputs are threaded through the loop as extra loop variables, and the
+// body reads them from the new arguments instead of recomputing them on every
+// iteration.
+//
+// Since the hoisted tensors stay alive for the whole loop, only tensors whose
+// size is statically known are hoisted, up to kMaxHoistedBytesPerLoop per
+// loop.
+class FunctionalLoopInvariantMotion {
+ public:
+  FunctionalLoopInvariantMotion(const GrapplerItem& item,
+                                GraphDef* optimized_graph)
+      : item_(item),
+        optimized_graph_(optimized_graph),
+        flib_(OpRegistry::Global(), optimized_graph->library()) {}
+
+  Status Optimize();
+
+ private:
+  // The loop invariant tensors of a While node's body.
+  struct LoopInvariants {
+    int while_index;
+    const FunctionDef* body;
+    const FunctionDef* cond;
+    // The invariant body nodes, in the order of the body.
+    absl::flat_hash_set<string> nodes;
+    // The body tensors to hoist, and their types.
+    std::vector<FunctionTensor> tensors;
+    DataTypeVector types;
+  };
+
+  bool FindLoopInvariants(int while_index, LoopInvariants* loop) const;
+  // Flattens the output `tensor` of a body node into a node output index.
+  bool OutputIndex(const NodeDef& node, const FunctionTensor& tensor,
+                   int* index, DataType* type) const;
+  // Hoists `loop.tensors[i]` for all `i` in `selected` into `graph`, and
+  // returns the names of the hoisted tensors in the outer graph.
+  Status Hoist(const LoopInvariants& loop, const std::vector<int>& selected,
+               const std::vector<PartialTensorShape>& shapes, GraphDef* graph,
+               FunctionLibraryDefinition* flib,
+               std::vector<string>* outer_tensors) const;
+
+  const GrapplerItem& item_;
+  GraphDef* optimized_graph_;  // Not owned.
+  FunctionLibraryDefinition flib_;
+};
+
+bool FunctionalLoopInvariantMotion::OutputIndex(const NodeDef& node,
+                                                const FunctionTensor& tensor,
+                                                int* index,
+                                                DataType* type) const {
+  const OpDef* op_def = nullptr;
+  NameRangeMap outputs;
+  DataTypeVector types;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+      !NameRangesForNode(node, *op_def, nullptr, &outputs).ok() ||
+      !OutputTypesForNode(node, *op_def, &types).ok()) {
+    return false;
+  }
+  auto it = outputs.find(tensor.output);
+  if (it == outputs.end() || it->second.first + tensor.index >= types.size()) {
+    return false;
+  }
+  *index = it->second.first + tensor.index;
+  *type = types[*index];
+  return true;
+}
+
+bool FunctionalLoopInvariantMotion::FindLoopInvariants(
+    int while_index, LoopInvariants* loop) const {
+  const NodeDef& node = optimized_graph_->node(while_index);
+  const AttrValue* body_attr = AttrSlice(node).Find("body");
+  const AttrValue* cond_attr = AttrSlice(node).Find("cond");
+  const AttrValue* types_attr = AttrSlice(node).Find("T");
+  if (body_attr == nullptr || cond_attr == nullptr || types_attr == nullptr ||
+      body_attr->func().attr_size() > 0 || cond_attr->func().attr_size() > 0) {
+    return false;
+  }
+  const FunctionDef* body = flib_.Find(body_attr->func().name());
+  const FunctionDef* cond = flib_.Find(cond_attr->func().name());
+  const int num_loop_vars = types_attr->list().type_size();
+  if (body == nullptr || cond == nullptr ||
+      body->signature().input_arg_size() != num_loop_vars ||
+      body->signature().output_arg_size() != num_loop_vars ||
+      cond->signature().input_arg_size() != num_loop_vars) {
+    return false;
+  }
+  loop->while_index = while_index;
+  loop->body = body;
+  loop->cond = cond;
+
+  std::unordered_map<string, const NodeDef*> body_nodes;
+  for (const NodeDef& body_node : body->node_def()) {
+    body_nodes[body_node.name()] = &body_node;
+  }
+  // Arguments that the body returns unchanged, possibly through a chain of
+  // identities.
+  absl::flat_hash_set<string> invariant_args;
+  for (int i = 0; i < num_loop_vars; ++i) {
+    const string& arg = body->signature().input_arg(i).name();
+    auto ret = body->ret().find(body->signature().output_arg(i).name());
+    if (ret == body->ret().end()) return false;
+    FunctionTensor tensor = ParseFunctionTensor(ret->second);
+    while (!tensor.is_arg()) {
+      auto it = body_nodes.find(tensor.node);
+      if (it == body_nodes.end() || !IsIdentity(*it->second) ||
+          it->second->input_size() != 1) {
+        break;
+      }
+      tensor = ParseFunctionTensor(it->second->input(0));
+    }
+    if (tensor.is_arg() && tensor.node == arg) invariant_args.insert(arg);
+  }
+  if (invariant_args.empty()) return false;
+
+  // Grow the set of invariant nodes until it reaches a fixed point, and track
+  // which of them are worth hoisting.
+  absl::flat_hash_set<string> worth_hoisting;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const NodeDef& body_node : body->node_def()) {
+      if (loop->nodes.contains(body_node.name())) continue;
+      const OpDef* op_def = nullptr;
+      if (flib_.Contains(body_node.op()) || HasFunctionAttr(body_node) ||
+          !OpRegistry::Global()->LookUpOpDef(body_node.op(), &op_def).ok() ||
+          op_def->is_stateful()) {
+        continue;
+      }
+      bool invariant = true;
+      bool worth = !IsTrivialToRecompute(body_node);
+      for (const string& input : body_node.input()) {
+        if (IsControlInput(input)) {
+          invariant = false;
+          break;
+        }
+        const FunctionTensor tensor = ParseFunctionTensor(input);
+        if (tensor.is_arg() ? !invariant_args.contains(tensor.node)
+                            : !loop->nodes.contains(tensor.node)) {
+          invariant = false;
+          break;
+        }
+        worth |= worth_hoisting.contains(tensor.node);
+      }
+      if (!invariant) continue;
+      loop->nodes.insert(body_node.name());
+      if (worth) worth_hoisting.insert(body_node.name());
+      changed = true;
+    }
+  }
+
+  // Hoist the worthwhile invariant tensors that the rest of the body reads.
+  absl::flat_hash_set<string> seen;
+  auto maybe_hoist = [&](const string& input) {
+    if (IsControlInput(input)) return;
+    const FunctionTensor tensor = ParseFunctionTensor(input);
+    if (tensor.is_arg() || !worth_hoisting.contains(tensor.node) ||
+        !seen.insert(tensor.ToString()).second) {
+      return;
+    }
+    int index;
+    DataType type;
+    if (!OutputIndex(*body_nodes[tensor.node], tensor, &index, &type) ||
+        IsRefType(type)) {
+      return;
+    }
+    loop->tensors.push_back(tensor);
+    loop->types.push_back(type);
+  };
+  for (const NodeDef& body_node : body->node_def()) {
+    if (loop->nodes.contains(body_node.name())) continue;
+    for (const string& input : body_node.input()) maybe_hoist(input);
+  }
+  for (const OpDef::ArgDef& output : body->signature().output_arg()) {
+    maybe_hoist(body->ret().at(output.name()));
+  }
+  return !loop->tensors.empty();
+}
+
+Status FunctionalLoopInvariantMotion::Hoist(
+    const LoopInvariants& loop, const std::vector<int>& selected,
+    const std::vector<PartialTensorShape>& shapes, GraphDef* graph,
+    FunctionLibraryDefinition* flib, std::vector<string>* outer_tensors) const {
+  absl::flat_hash_set<string> graph_nodes;
+  for (const NodeDef& node : graph->node()) graph_nodes.insert(node.name());
+  const NodeDef while_node = graph->node(loop.while_index);
+  auto unique_name = [](const string& prefix,
+                        const absl::flat_hash_set<string>& taken) {
+    string name = prefix;
+    for (int i = 1; taken.contains(name); ++i) name = StrCat(prefix, "_", i);
+    return name;
+  };
+
+  // Clone the invariant nodes that the hoisted tensors depend on, reading the
+  // While inputs instead of the body arguments.
+  std::unordered_map<string, int> arg_index;
+  for (int i = 0; i < loop.body->signature().input_arg_size(); ++i) {
+    arg_index[loop.body->signature().input_arg(i).name()] = i;
+  }
+  std::unordered_map<string, const NodeDef*> body_nodes;
+  for (const NodeDef& body_node : loop.body->node_def()) {
+    body_nodes[body_node.name()] = &body_node;
+  }
+  std::vector<string> while_controls;
+  for (const string& input : while_node.input()) {
+    if (IsControlInput(input)) while_controls.push_back(input);
+  }
+  std::unordered_map<string, string> outer_names;
+  std::deque<string> queue;
+  for (int i : selected) queue.push_back(loop.tensors[i].node);
+  while (!queue.empty()) {
+    const string name = queue.front();
+    queue.pop_front();
+    if (outer_names.count(name) > 0) continue;
+    outer_names[name] =
+        unique_name(StrCat(while_node.name(), "/licm/", name), graph_nodes);
+    graph_nodes.insert(outer_names[name]);
+    for (const string& input : body_nodes[name]->input()) {
+      const FunctionTensor tensor = ParseFunctionTensor(input);
+      if (!tensor.is_arg()) queue.push_back(tensor.node);
+    }
+  }
+  auto outer_tensor = [&](const FunctionTensor& tensor) -> StatusOr<string> {
+    if (tensor.is_arg()) return while_node.input(arg_index.at(tensor.node));
+    int index;
+    DataType type;
+    if (!OutputIndex(*body_nodes.at(tensor.node), tensor, &index, &type)) {
+      return errors::Internal("Failed to resolve ", tensor.ToString(),
+                              " in function ", loop.body->signature().name());
+    }
+    const string& name = outer_names.at(tensor.node);
+    return index == 0 ? name : StrCat(name, ":", index);
+  };
+  for (const NodeDef& body_node : loop.body->node_def()) {
+    if (outer_names.count(body_node.name()) == 0) continue;
+    NodeDef* node = graph->add_node();
+    *node = body_node;
+    node->set_name(outer_names[body_node.name()]);
+    if (node->device().empty()) node->set_device(while_node.device());
+    for (int i = 0; i < node->input_size(); ++i) {
+      TF_ASSIGN_OR_RETURN(*node->mutable_input(i),
+                          outer_tensor(ParseFunctionTensor(node->input(i))));
+    }
+    for (const string& control : while_controls) node->add_input(control);
+  }
+
+  // Thread the hoisted tensors through the loop.
+  FunctionDef body = *loop.body;
+  FunctionDef cond = *loop.cond;
+  body.mutable_signature()->set_name(
+      flib->UniqueFunctionName(StrCat(loop.body->signature().name(), "_licm")));
+  cond.mutable_signature()->set_name(
+      flib->UniqueFunctionName(StrCat(loop.cond->signature().name(), "_licm")));
+  absl::flat_hash_set<string> body_names;
+  for (const auto& arg : body.signature().input_arg()) {
+    body_names.insert(arg.name());
+  }
+  for (const auto& arg : body.signature().output_arg()) {
+    body_names.insert(arg.name());
+  }
+  for (const NodeDef& body_node : body.node_def()) {
+    body_names.insert(body_node.name());
+  }
+  absl::flat_hash_set<string> cond_names;
+  for (const auto& arg : cond.signature().input_arg()) {
+    cond_names.insert(arg.name());
+  }
+  for (const NodeDef& cond_node : cond.node_def()) {
+    cond_names.insert(cond_node.name());
+  }
+
+  NodeDef* new_while = graph->mutable_node(loop.while_index);
+  new_while->clear_input();
+  for (const string& input : while_node.input()) {
+    if (!IsControlInput(input)) new_while->add_input(input);
+  }
+  AttrValue* types = &(*new_while->mutable_attr())["T"];
+  AttrValue* output_shapes = nullptr;
+  if (new_while->attr().count("output_shapes") > 0 &&
+      new_while->attr().at("output_shapes").list().shape_size() > 0) {
+    output_shapes = &(*new_while->mutable_attr())["output_shapes"];
+  }
+  AttrValue* inferred_shapes = nullptr;
+  if (new_while->attr().count("_output_shapes") > 0) {
+    inferred_shapes = &(*new_while->mutable_attr())["_output_shapes"];
+  }
+  std::unordered_map<string, string> replacements;
+  for (int k = 0; k < selected.size(); ++k) {
+    const int i = selected[k];
+    TF_ASSIGN_OR_RETURN(string hoisted, outer_tensor(loop.tensors[i]));
+    new_while->add_input(hoisted);
+    outer_tensors->push_back(hoisted);
+    types->mutable_list()->add_type(loop.types[i]);
+    PartialTensorShape shape =
+        k < shapes.size() ? shapes[k] : PartialTensorShape();
+    if (output_shapes != nullptr) {
+      shape.AsProto(output_shapes->mutable_list()->add_shape());
+    }
+    if (inferred_shapes != nullptr) {
+      shape.AsProto(inferred_shapes->mutable_list()->add_shape());
+    }
+
+    const string arg = unique_name(StrCat("licm_input_", k), body_names);
+    body_names.insert(arg);
+    const string ret = unique_name(StrCat("licm_output_", k), body_names);
+    body_names.insert(ret);
+    OpDef::ArgDef* input_arg = body.mutable_signature()->add_input_arg();
+    input_arg->set_name(arg);
+    input_arg->set_type(loop.types[i]);
+    OpDef::ArgDef* output_arg = body.mutable_signature()->add_output_arg();
+    output_arg->set_name(ret);
+    output_arg->set_type(loop.types[i]);
+    (*body.mutable_ret())[ret] = arg;
+    replacements[loop.tensors[i].ToString()] = arg;
+
+    OpDef::ArgDef* cond_arg = cond.mutable_signature()->add_input_arg();
+    cond_arg->set_name(unique_name(StrCat("licm_input_", k), cond_names));
+    cond_arg->set_type(loop.types[i]);
+    cond_names.insert(cond_arg->name());
+  }
+  for (const string& control : while_controls) new_while->add_input(control);
+  (*new_while->mutable_attr())["body"].mutable_func()->set_name(
+      body.signature().name());
+  (*new_while->mutable_attr())["cond"].mutable_func()->set_name(
+      cond.signature().name());
+
+  // Read the hoisted tensors from the new arguments, and drop the invariant
+  // nodes that nothing reads anymore.
+  for (NodeDef& body_node : *body.mutable_node_def()) {
+    for (string& input : *body_node.mutable_input()) {
+      if (IsControlInput(input)) continue;
+      auto it = replacements.find(ParseFunctionTensor(input).ToString());
+      if (it != replacements.end()) input = it->second;
+    }
+  }
+  for (auto& ret : *body.mutable_ret()) {
+    auto it = replacements.find(ParseFunctionTensor(ret.second).ToString());
+    if (it != replacements.end()) ret.second = it->second;
+  }
+  bool pruned = true;
+  while (pruned) {
+    pruned = false;
+    absl::flat_hash_set<string> used;
+    for (const NodeDef& body_node : body.node_def()) {
+      for (const string& input : body_node.input()) {
+        used.insert(ParseFunctionTensor(IsControlInput(input)
+                                            ? absl::string_view(input).substr(1)
+                                            : absl::string_view(input))
+                        .node);
+      }
+    }
+    for (const auto& ret : body.ret()) {
+      used.insert(ParseFunctionTensor(ret.second).node);
+    }
+    for (const auto& control_ret : body.control_ret()) {
+      used.insert(control_ret.second);
+    }
+    auto* nodes = body.mutable_node_def();
+    for (int i = nodes->size() - 1; i >= 0; --i) {
+      if (loop.nodes.contains(nodes->Get(i).name()) &&
+          !used.contains(nodes->Get(i).name())) {
+        nodes->DeleteSubrange(i, 1);
+        pruned = true;
+      }
+    }
+  }
+
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(body));
+  TF_RETURN_IF_ERROR(flib->AddFunctionDef(cond));
+  *graph->mutable_library()->add_function() = std::move(body);
+  *graph->mutable_library()->add_function() = std::move(cond);
+  return OkStatus();
+}
+
+Status FunctionalLoopInvariantMotion::Optimize() {
+  std::vector<LoopInvariants> loops;
+  for (int i = 0; i < optimized_graph_->node_size(); ++i) {
+    if (!IsWhile(optimized_graph_->node(i))) continue;
+    LoopInvariants loop;
+    if (FindLoopInvariants(i, &loop)) loops.push_back(std::move(loop));
+  }
+  if (loops.empty()) return OkStatus();
+
+  // Hoist everything in a copy of the graph to infer the shapes of the
+  // hoisted tensors.
+  GrapplerItem trial = item_.WithGraph(GraphDef(*optimized_graph_));
+  FunctionLibraryDefinition trial_flib(flib_);
+  std::vector<std::vector<string>> trial_tensors(loops.size());
+  for (int i = 0; i < loops.size(); ++i) {
+    std::vector<int> all(loops[i].tensors.size());
+    std::iota(all.begin(), all.end(), 0);
+    TF_RETURN_IF_ERROR(Hoist(loops[i], all, {}, &trial.graph, &trial_flib,
+                             &trial_tensors[i]));
+  }
+  GraphProperties properties(trial);
+  Status status = properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false);
+  if (!status.ok()) {
+    VLOG(1) << "Not hoisting loop invariants, shape inference failed: "
+            << status;
+    return OkStatus();
+  }
+
+  for (int i = 0; i < loops.size(); ++i) {
+    std::vector<int> selected;
+    std::vector<PartialTensorShape> shapes;
+    int64_t hoisted_bytes = 0;
+    for (int j = 0; j < loops[i].tensors.size(); ++j) {
+      if (selected.size() >= kMaxHoistedTensorsPerLoop) break;
+      const TensorId id = ParseTensorName(trial_tensors[i][j]);
+      const string node_name(id.node());
+      if (!properties.HasOutputProperties(node_name)) continue;
+      const auto& outputs = properties.GetOutputProperties(node_name);
+      if (id.index() < 0 || id.index() >= outputs.size()) continue;
+      const PartialTensorShape shape(outputs[id.index()].shape());
+      const int64_t type_size = DataTypeSize(loops[i].types[j]);
+      if (!shape.IsFullyDefined() || type_size == 0) continue;
+      const int64_t bytes = shape.num_elements() * type_size;
+      if (hoisted_bytes + bytes > kMaxHoistedBytesPerLoop) continue;
+      hoisted_bytes += bytes;
+      selected.push_back(j);
+      shapes.push_back(shape);
+    }
+    if (selected.empty()) continue;
+    VLOG(1) << "Hoisting " << selected.size() << " loop invariant tensors ("
+            << hoisted_bytes << " bytes) out of "
+            << optimized_graph_->node(loops[i].while_index).name();
+    std::vector<string> hoisted;
+    TF_RETURN_IF_ERROR(Hoist(loops[i], selected, shapes, optimized_graph_,
+                             &flib_, &hoisted));
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -726,14 +1313,16 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
+      !options_.enable_functional_loop_invariant_motion &&
       !options_.enable_stack_push_removal &&
+      !options_.enable_tensor_list_read_ordering &&
       !options_.enable_dead_branch_removal) {
     return errors::Aborted("Nothing to do.");
   }
@@ -743,9 +1332,16 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
+  if (options_.enable_functional_loop_invariant_motion) {
+    FunctionalLoopInvariantMotion licm_optimizer(item, optimized_graph);
+    TF_RETURN_IF_ERROR(licm_optimizer.Optimize());
+  }
   if (options_.enable_stack_push_removal) {
     TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
+  if (options_.enable_tensor_list_read_ordering) {
+    TF_RETURN_IF_ERROR(OrderTensorListReads(optimized_graph));
+  }
   if (options_.enable_dead_branch_removal) {
     NodeMap node_map(optimized_graph);
     absl::flat_hash_set<string> feed_nodes;
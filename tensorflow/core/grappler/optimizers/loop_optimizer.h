@@ -40,7 +40,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_functional_loop_invariant_motion;
+  }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -51,11 +53,19 @@ class LoopOptimizer : public GraphOptimizer {
   // Granular control for loop optimizer stages.
   struct LoopOptimizerOptions {
     bool enable_loop_invariant_node_motion = false;
+    // Hoists loop invariant computations out of the bodies of functional
+    // While loops into extra loop variables.
+    bool enable_functional_loop_invariant_motion = false;
     bool enable_stack_push_removal = true;
+    // Orders the ops reading a TensorList before the op mutating it, so that
+    // the latter can update the list in place.
+    bool enable_tensor_list_read_ordering = true;
     bool enable_dead_branch_removal = true;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_functional_loop_invariant_motion =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -66,16 +68,28 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_loop_invariant_node_motion = true;
   }
 
+  void EnableOnlyFunctionalLoopInvariantMotion(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_functional_loop_invariant_motion = true;
+  }
+
   void EnableOnlyStackPushRemoval(LoopOptimizer* optimizer) {
     DisableAllStages(optimizer);
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyTensorListReadOrdering(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_tensor_list_read_ordering = true;
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
     options.enable_loop_invariant_node_motion = false;
+    options.enable_functional_loop_invariant_motion = false;
     options.enable_stack_push_removal = false;
+    options.enable_tensor_list_read_ordering = false;
     optimizer->options_ = options;
   }
 };
@@ -750,6 +764,74 @@ TEST_F(LoopOptimizerTest, RemovePushWithoutMatchingPop) {
   }
 }
 
+TEST_F(LoopOptimizerTest, OrderTensorListReads) {
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  AddSimpleNode("shape", "Const", {}, &graph);
+  AddSimpleNode("index", "Const", {}, &graph);
+  AddSimpleNode("value", "Const", {}, &graph);
+  AddSimpleNode("list", "EmptyTensorList", {"shape"}, &graph);
+  AddSimpleNode("length", "TensorListLength", {"list"}, &graph);
+  AddSimpleNode("get", "TensorListGetItem", {"list", "index", "shape"},
+                &graph);
+  AddSimpleNode("push", "TensorListPushBack", {"list:0", "value"}, &graph);
+  item.fetch = {"length", "get", "push"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyTensorListReadOrdering(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  ASSERT_EQ(output.node_size(), graph.node_size());
+  for (int i = 0; i < output.node_size(); ++i) {
+    const NodeDef& node = output.node(i);
+    if (node.name() == "push") {
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "list:0");
+      EXPECT_EQ(node.input(1), "value");
+      EXPECT_EQ(node.input(2), "^get");
+      EXPECT_EQ(node.input(3), "^length");
+    } else {
+      EXPECT_EQ(node.ShortDebugString(), graph.node(i).ShortDebugString());
+    }
+  }
+}
+
+TEST_F(LoopOptimizerTest, OrderTensorListReadsNoOp) {
+  GrapplerItem item;
+  GraphDef& graph = item.graph;
+  AddSimpleNode("shape", "Const", {}, &graph);
+  AddSimpleNode("value", "Const", {}, &graph);
+  AddSimpleNode("pred", "Placeholder", {}, &graph);
+  AddSimpleNode("switch", "Switch", {"value", "pred"}, &graph);
+  // The list is mutated twice, so one of the mutations has to copy it.
+  AddSimpleNode("list1", "EmptyTensorList", {"shape"}, &graph);
+  AddSimpleNode("length1", "TensorListLength", {"list1"}, &graph);
+  AddSimpleNode("push1a", "TensorListPushBack", {"list1", "value"}, &graph);
+  AddSimpleNode("push1b", "TensorListPushBack", {"list1", "value"}, &graph);
+  // The reader may be dead while the mutation isn't.
+  AddSimpleNode("list2", "EmptyTensorList", {"shape"}, &graph);
+  AddSimpleNode("get2", "TensorListGetItem", {"list2", "switch:1", "shape"},
+                &graph);
+  AddSimpleNode("push2", "TensorListPushBack", {"list2", "value"}, &graph);
+  // The reader is on another device.
+  AddSimpleNode("list3", "EmptyTensorList", {"shape"}, &graph);
+  AddSimpleNode("length3", "TensorListLength", {"list3"}, &graph);
+  AddSimpleNode("push3", "TensorListPushBack", {"list3", "value"}, &graph);
+  graph.mutable_node(graph.node_size() - 2)->set_device("/device:CPU:1");
+  // The list is used by an op that isn't known to only read it.
+  AddSimpleNode("list4", "EmptyTensorList", {"shape"}, &graph);
+  AddSimpleNode("length4", "TensorListLength", {"list4"}, &graph);
+  AddSimpleNode("id4", "Identity", {"list4"}, &graph);
+  AddSimpleNode("push4", "TensorListPushBack", {"list4", "value"}, &graph);
+
+  LoopOptimizer optimizer;
+  EnableOnlyTensorListReadOrdering(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  VerifyGraphsEqual(item.graph, output, __FUNCTION__);
+}
+
 TEST_F(LoopOptimizerTest, RemoveDeadBranchesConstantCondition) {
   Scope scope = Scope::NewRootScope();
   Output v_in = ops::Const<float>(scope.WithOpName("v_in"), {123.0}, {});
@@ -1802,5 +1884,129 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, FunctionalWhileLoopInvariantMotion) {
+  using test::function::NDef;
+  FunctionDefLibrary library;
+  // Computes (i + 1, x * Square(w), w) while i < 3. Square(w) is loop
+  // invariant.
+  *library.add_function() = FunctionDefHelper::Create(
+      "Body", {"i: int32", "x: float", "w: float"},
+      {"i_out: int32", "x_out: float", "w_out: float"}, {},
+      {FunctionDefHelper::Const("one", 1),
+       {{"next_i"}, "Add", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"square"}, "Square", {"w"}, {{"T", DT_FLOAT}}},
+       {{"next_x"}, "Mul", {"x", "square:y:0"}, {{"T", DT_FLOAT}}},
+       {{"w_identity"}, "Identity", {"w"}, {{"T", DT_FLOAT}}}},
+      {{"i_out", "next_i:z:0"},
+       {"x_out", "next_x:z:0"},
+       {"w_out", "w_identity:output:0"}});
+  *library.add_function() = FunctionDefHelper::Create(
+      "Cond", {"i: int32", "x: float", "w: float"}, {"done: bool"}, {},
+      {FunctionDefHelper::Const("limit", 3),
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"done", "less:z:0"}});
+
+  Scope scope = Scope::NewRootScope();
+  auto i = ops::Const(scope.WithOpName("i"), 0);
+  auto x = ops::Const(scope.WithOpName("x"), {1.0f, 2.0f}, {2});
+  auto w = ops::Const(scope.WithOpName("w"), {2.0f, 3.0f}, {2});
+  GrapplerItem item;
+  TF_ASSERT_OK(scope.ToGraphDef(&item.graph));
+  *item.graph.mutable_library() = library;
+  NameAttrList body;
+  body.set_name("Body");
+  NameAttrList cond;
+  cond.set_name("Cond");
+  *item.graph.add_node() =
+      NDef("while", "While", {"i", "x", "w"},
+           {{"T", DataTypeVector{DT_INT32, DT_FLOAT, DT_FLOAT}},
+            {"body", body},
+            {"cond", cond}});
+  *item.graph.add_node() =
+      NDef("out", "Identity", {"while:1"}, {{"T", DT_FLOAT}});
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyFunctionalLoopInvariantMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* while_node = nullptr;
+  const NodeDef* hoisted = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "while") while_node = &node;
+    if (node.name() == "while/licm/square") hoisted = &node;
+  }
+  ASSERT_NE(while_node, nullptr);
+  ASSERT_NE(hoisted, nullptr);
+  EXPECT_EQ(hoisted->op(), "Square");
+  ASSERT_EQ(hoisted->input_size(), 1);
+  EXPECT_EQ(hoisted->input(0), "w");
+  ASSERT_EQ(while_node->input_size(), 4);
+  EXPECT_EQ(while_node->input(3), "while/licm/square");
+  EXPECT_EQ(while_node->attr().at("T").list().type_size(), 4);
+
+  FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  const FunctionDef* new_body =
+      flib.Find(while_node->attr().at("body").func().name());
+  ASSERT_NE(new_body, nullptr);
+  EXPECT_EQ(new_body->signature().input_arg_size(), 4);
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE(node.op(), "Square");
+    if (node.name() == "next_x") {
+      EXPECT_EQ(node.input(1), "licm_input_0");
+    }
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+}
+
+TEST_F(LoopOptimizerTest, FunctionalWhileLoopInvariantMotionSkipsStatefulOps) {
+  using test::function::NDef;
+  FunctionDefLibrary library;
+  *library.add_function() = FunctionDefHelper::Create(
+      "Body", {"i: int32", "shape: int32"},
+      {"i_out: int32", "shape_out: int32"}, {},
+      {FunctionDefHelper::Const("one", 1),
+       {{"noise"},
+        "RandomUniformInt",
+        {"shape", "one:output:0", "shape"},
+        {{"T", DT_INT32}, {"Tout", DT_INT32}}},
+       {{"next_i"}, "Add", {"i", "noise:output:0"}, {{"T", DT_INT32}}}},
+      {{"i_out", "next_i:z:0"}, {"shape_out", "shape"}});
+  *library.add_function() = FunctionDefHelper::Create(
+      "Cond", {"i: int32", "shape: int32"}, {"done: bool"}, {},
+      {FunctionDefHelper::Const("limit", 3),
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"done", "less:z:0"}});
+
+  GrapplerItem item;
+  *item.graph.mutable_library() = library;
+  NameAttrList body;
+  body.set_name("Body");
+  NameAttrList cond;
+  cond.set_name("Cond");
+  *item.graph.add_node() = NDef("i", "Const", {},
+                                {{"dtype", DT_INT32},
+                                 {"value", test::AsScalar<int32>(0)}});
+  *item.graph.add_node() = NDef("shape", "Const", {},
+                                {{"dtype", DT_INT32},
+                                 {"value", test::AsScalar<int32>(5)}});
+  *item.graph.add_node() = NDef("while", "While", {"i", "shape"},
+                                {{"T", DataTypeVector{DT_INT32, DT_INT32}},
+                                 {"body", body},
+                                 {"cond", cond}});
+
+  LoopOptimizer optimizer;
+  EnableOnlyFunctionalLoopInvariantMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(item.graph, output);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <limits>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -24,6 +25,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"  // NOLINT
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -56,6 +58,10 @@ const char* kRecomputeTriggerNodePrefix = "RecomputeTrigger";
 // recomputed.
 const char* kRecomputeHint = "_recompute_hint";
 
+// Position of a node in the memory-aware schedule. The executor prefers ready
+// nodes with a lower position, see ImmutableExecutorState::Initialize.
+const char* kSchedulingOrderAttr = "_scheduling_order";
+
 // Ops which we wouldn't mind recomputing to save memory.
 // TODO(allenl): Replace this list with a cost model.
 std::unordered_set<string> GetCheapToRecomputeOps() {
@@ -1146,6 +1152,268 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// A way to take a tensor live at the time of peak memory usage out of device
+// memory until its next use, with an estimate of the time it adds to a step.
+struct RematerializationCandidate {
+  string node;
+  int output_id;
+  int64_t memory_used;
+  // The uses of the tensor after the peak.
+  std::vector<std::pair<string, int>> uses_left;
+  // Recompute the tensor before its next use if true, swap it to the host
+  // memory and back otherwise.
+  bool recompute;
+  double added_time;
+
+  bool operator<(const RematerializationCandidate& other) const {
+    // Prefer the candidates that add the least time per byte saved.
+    return added_time * other.memory_used < other.added_time * memory_used;
+  }
+};
+
+// Returns true iff `node` can be recomputed from its inputs.
+bool IsRecomputable(const NodeDef& node,
+                    const std::unordered_set<string>& feeds) {
+  if (feeds.count(node.name()) > 0 || IsControlFlow(node) ||
+      IsPlaceholder(node) || IsVariable(node)) {
+    return false;
+  }
+  const OpDef* op_def;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok() ||
+      op_def->is_stateful()) {
+    return false;
+  }
+  DataTypeVector input_types;
+  DataTypeVector output_types;
+  if (!InOutTypesForNode(node, *op_def, &input_types, &output_types).ok()) {
+    return false;
+  }
+  return std::none_of(input_types.begin(), input_types.end(), IsRefType);
+}
+
+// Uses the memory usage and the step time estimated by the cost model to pick
+// the tensors that are recomputed or swapped to the host memory, so that the
+// peak memory usage of every GPU fits `target_peak_bytes` (or the memory of
+// the device if it is not positive), while adding as little time as
+// possible to the step. Swaps are recorded as "_swap_to_host" annotations
+// for SwappingPass, recomputations are rewritten directly.
+bool CostModelPass(Cluster* cluster, int64_t target_peak_bytes,
+                   std::unique_ptr<GraphMemory>* memory_ptr,
+                   GrapplerItem* item, std::unordered_set<string>* skip_list) {
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_run_times;
+  bool ran_virtual_cluster = false;
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  std::vector<RematerializationCandidate> selected;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    const int64_t target =
+        target_peak_bytes > 0 ? target_peak_bytes : prop.memory_size();
+    if (target <= 0) {
+      VLOG(1) << "Target peak memory usage unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= target) {
+      continue;
+    }
+    int64_t required_savings = mem_usage.used_memory - target;
+
+    if (!ran_virtual_cluster) {
+      VirtualCluster vcluster(cluster->GetDevices());
+      if (!vcluster.Provision().ok() || !vcluster.Initialize(*item).ok()) {
+        return false;
+      }
+      RunMetadata metadata;
+      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
+      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+        return false;
+      }
+      for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+        for (const auto& node_stats : dev_stats.node_stats()) {
+          op_completion_times.emplace(
+              node_stats.node_name(),
+              Costs::NanoSeconds(1) +
+                  Costs::MicroSeconds(node_stats.all_start_micros() +
+                                      node_stats.op_end_rel_micros()));
+          op_run_times.emplace(
+              node_stats.node_name(),
+              Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                  node_stats.op_start_rel_micros()));
+        }
+      }
+      ran_virtual_cluster = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_map<string, const GraphMemory::LiveTensor*> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_tensors[strings::StrCat(live_tensor.node, ":",
+                                   live_tensor.output_id)] = &live_tensor;
+    }
+
+    MutableGraphView graph(&item->graph);
+    std::vector<RematerializationCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) continue;
+
+      RematerializationCandidate candidate;
+      candidate.node = live_tensor.node;
+      candidate.output_id = live_tensor.output_id;
+      candidate.memory_used = live_tensor.memory_used;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      bool valid = true;
+      bool swappable = IsSwappable(graph, port);
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end() ||
+            skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(strings::StrCat(input.node->name(), ":",
+                                            input.port_id)) !=
+                skip_list->end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        swappable = swappable && IsSwappable(input);
+        candidate.uses_left.emplace_back(input.node->name(), input.port_id);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || candidate.uses_left.empty()) {
+        continue;
+      }
+
+      // Swapping adds the part of the transfers, assumed to run over PCIe at
+      // 16 GBps, that can not be overlapped with the computation between the
+      // allocation of the tensor and the peak, or between the peak and the
+      // next use.
+      constexpr double kInfinity = std::numeric_limits<double>::infinity();
+      double swap_time = kInfinity;
+      if (swappable) {
+        const double transfer_time = candidate.memory_used / 16.0;
+        const double time_before_peak =
+            (peak_time - live_tensor.allocation_time).count();
+        const double time_after_peak = (earliest_use - peak_time).count();
+        swap_time = std::max(0.0, transfer_time - time_before_peak) +
+                    std::max(0.0, transfer_time - time_after_peak);
+      }
+
+      // Recomputing adds the run time of the op. Its inputs must still be in
+      // memory at the next use, so that recomputing does not extend their
+      // lifetime.
+      double recompute_time = kInfinity;
+      auto run_time = op_run_times.find(live_tensor.node);
+      if (run_time != op_run_times.end() &&
+          IsRecomputable(*port.node, feeds)) {
+        bool inputs_live = true;
+        for (const string& input : port.node->input()) {
+          if (IsControlInput(input)) continue;
+          const TensorId id = ParseTensorName(input);
+          auto it = live_tensors.find(
+              strings::StrCat(id.node(), ":", std::max(id.index(), 0)));
+          if (it == live_tensors.end() ||
+              it->second->deallocation_time < earliest_use) {
+            inputs_live = false;
+            break;
+          }
+        }
+        if (inputs_live) recompute_time = run_time->second.count();
+      }
+
+      if (swap_time == kInfinity && recompute_time == kInfinity) {
+        continue;
+      }
+      candidate.recompute = recompute_time < swap_time;
+      candidate.added_time = std::min(recompute_time, swap_time);
+      candidates.push_back(std::move(candidate));
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (RematerializationCandidate& candidate : candidates) {
+      VLOG(1) << "Will " << (candidate.recompute ? "recompute" : "swap")
+              << " tensor " << candidate.node << ":" << candidate.output_id
+              << " of size " << candidate.memory_used << " on " << name
+              << ", adding " << candidate.added_time << "ns";
+      skip_list->insert(candidate.node);
+      required_savings -= candidate.memory_used;
+      selected.push_back(std::move(candidate));
+      if (required_savings <= 0) {
+        break;
+      }
+    }
+  }
+  if (selected.empty()) {
+    return false;
+  }
+
+  // Rewrite the recomputations. As in RecomputationRewritingPass, sort the
+  // graph first since it invalidates the NodeDef pointers.
+  TF_CHECK_OK(TopologicalSort(&item->graph));
+  NodeMap node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int node_number = 0; node_number < item->graph.node_size();
+       ++node_number) {
+    topological_numbering[item->graph.mutable_node(node_number)] =
+        item->graph.node_size() - node_number - 1;
+  }
+  for (const RematerializationCandidate& candidate : selected) {
+    if (candidate.recompute) {
+      std::unordered_set<NodeDef*> target_nodes;
+      for (const auto& use : candidate.uses_left) {
+        target_nodes.insert(node_map.GetNode(use.first));
+      }
+      const std::unordered_set<const NodeDef*> recomputed_source_nodes = {
+          node_map.GetNode(candidate.node)};
+      RecomputeSubgraph(recomputed_source_nodes, target_nodes, node_map,
+                        topological_numbering, &item->graph);
+      skip_list->insert(
+          AddPrefixToNodeName(candidate.node, kRecomputedNodePrefix));
+    } else {
+      for (const auto& use : candidate.uses_left) {
+        NodeDef* node = node_map.GetNode(use.first);
+        AttrValue& swap_attr = (*node->mutable_attr())["_swap_to_host"];
+        if (swap_attr.value_case() == AttrValue::kI) {
+          const int64_t input_id = swap_attr.i();
+          swap_attr.mutable_list()->add_i(input_id);
+        }
+        swap_attr.mutable_list()->add_i(use.second);
+      }
+    }
+  }
+  return true;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                   Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
                   GrapplerItem* item, std::unordered_set<string>* skip_list) {
@@ -1376,6 +1644,17 @@ Status FindAssignNodesToRelax(const GraphDef& graph,
   return OkStatus();
 }
 
+// Annotates every node in `item` with its position in a schedule that keeps
+// the amount of live memory low.
+Status AnnotateMemoryAwareSchedule(GrapplerItem* item) {
+  std::unordered_map<const NodeDef*, int> schedule;
+  TF_RETURN_IF_ERROR(EstimateMemoryAwareSchedule(*item, &schedule));
+  for (NodeDef& node : *item->graph.mutable_node()) {
+    (*node.mutable_attr())[kSchedulingOrderAttr].set_i(schedule[&node]);
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
@@ -1422,11 +1701,22 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (optimization_level_ == RewriterConfig::COST_MODEL) {
+        if (CostModelPass(cluster, target_peak_bytes_, &memory, &optimized_item,
+                          &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::COST_MODEL) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
@@ -1438,6 +1728,13 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  if (optimization_level_ == RewriterConfig::SCHEDULING_HEURISTICS) {
+    Status s = AnnotateMemoryAwareSchedule(&optimized_item);
+    if (!s.ok()) {
+      VLOG(1) << "Failed to compute a memory-aware schedule: " << s;
+    }
+  }
+
   optimized_graph->Swap(&optimized_item.graph);
   return OkStatus();
 }
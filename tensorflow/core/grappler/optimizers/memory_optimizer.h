@@ -33,11 +33,16 @@ class MemoryOptimizer : public GraphOptimizer {
   // recomputation_targets_name_scope: Name scope for potential outputs of
   //   recomputations. See
   //   RewriterConfig::memory_optimizer_target_node_name_scope.
+  // target_peak_bytes: Peak memory usage per GPU to fit with the COST_MODEL
+  //   optimization level. See
+  //   RewriterConfig::memory_optimizer_target_peak_bytes.
   explicit MemoryOptimizer(
       RewriterConfig::MemOptType optimization_level,
-      const string& recomputation_targets_name_scope = "gradients/")
+      const string& recomputation_targets_name_scope = "gradients/",
+      int64_t target_peak_bytes = 0)
       : optimization_level_(optimization_level),
-        recomputation_targets_name_scope_(recomputation_targets_name_scope) {}
+        recomputation_targets_name_scope_(recomputation_targets_name_scope),
+        target_peak_bytes_(target_peak_bytes) {}
   ~MemoryOptimizer() override {}
 
   string name() const override { return "memory_optimizer"; };
@@ -50,6 +55,7 @@ class MemoryOptimizer : public GraphOptimizer {
  private:
   RewriterConfig::MemOptType optimization_level_;
   string recomputation_targets_name_scope_;
+  int64_t target_peak_bytes_;
 };
 
 }  // end namespace grappler
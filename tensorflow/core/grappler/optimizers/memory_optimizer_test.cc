@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -346,6 +347,65 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, CostModel) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Identity(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Square(s.WithOpName("b").WithDevice("/gpu:0"), v);
+  Output c = ops::Sqrt(s.WithOpName("c").WithDevice("/gpu:0"), a);
+  Output d = ops::Identity(s.WithOpName("d").WithDevice("/gpu:0"), b);
+  Output axis = ops::Const(s.WithOpName("axis"), 0);
+  Output e =
+      ops::Concat(s.WithOpName("e").WithDevice("/gpu:0"), {a, b, c, d}, axis);
+  Output f = ops::Square(s.WithOpName("f").WithDevice("/gpu:0"), a);
+  Output g = ops::Sqrt(s.WithOpName("g").WithDevice("/gpu:0"), b);
+  Output h = ops::Exp(s.WithOpName("h").WithDevice("/gpu:0"), c);
+  Output i = ops::Log(s.WithOpName("i").WithDevice("/gpu:0"), d);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e", "f", "g", "h", "i"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The graph already fits the target, nothing is rewritten.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::COST_MODEL, "gradients/",
+                              /*target_peak_bytes=*/int64_t{1} << 40);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    EXPECT_EQ(item.graph.node_size(), output.node_size());
+  }
+
+  // Fitting the target requires tensors to be recomputed or swapped.
+  MemoryOptimizer optimizer(RewriterConfig::COST_MODEL, "gradients/",
+                            /*target_peak_bytes=*/1024 * 1024);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+  int num_rematerializations = 0;
+  for (const auto& node : output.node()) {
+    if (absl::StartsWith(node.name(), "swap_in_") ||
+        absl::StartsWith(node.name(), "Recomputed/")) {
+      ++num_rematerializations;
+    }
+  }
+  EXPECT_GT(num_rematerializations, 0);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  for (int i = 0; i < item.fetch.size(); ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
@@ -430,6 +490,8 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
       EXPECT_EQ("d", node.input(0));
       count++;
     }
+    // Every node is annotated with its position in the memory-aware schedule.
+    EXPECT_EQ(1, node.attr().count("_scheduling_order"));
   }
   EXPECT_EQ(4, count);
 
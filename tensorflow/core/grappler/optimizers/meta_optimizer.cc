@@ -60,7 +60,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -131,6 +134,78 @@ uint64 DeadlineMicroSeconds(const RewriterConfig& cfg) {
   return Env::Default()->NowMicros() + cfg.meta_optimizer_timeout_ms() * 1000;
 }
 
+// Caches the optimized library functions across MetaOptimizer runs in the
+// process, so that the same function in many graphs is optimized only once.
+// See RewriterConfig.enable_function_optimization_cache.
+class FunctionOptimizationCache {
+ public:
+  static FunctionOptimizationCache* Global() {
+    static FunctionOptimizationCache* cache = new FunctionOptimizationCache();
+    return cache;
+  }
+
+  bool Lookup(uint64 key, FunctionDef* optimized_func) {
+    mutex_lock l(mu_);
+    auto it = cache_.find(key);
+    if (it == cache_.end()) return false;
+    *optimized_func = it->second;
+    return true;
+  }
+
+  void Insert(uint64 key, const FunctionDef& optimized_func) {
+    mutex_lock l(mu_);
+    // Bound the memory used by the cache by starting over when it is full.
+    if (cache_.size() >= kMaxEntries) cache_.clear();
+    cache_.emplace(key, optimized_func);
+  }
+
+ private:
+  static constexpr int kMaxEntries = 4096;
+
+  mutex mu_;
+  absl::flat_hash_map<uint64, FunctionDef> cache_ TF_GUARDED_BY(mu_);
+};
+
+// Returns true iff `func` calls or refers to a function of `flib`. The
+// optimized body of such a function depends on the library, so it is not
+// cached.
+bool CallsLibraryFunctions(const FunctionDef& func,
+                           const FunctionLibraryDefinition& flib) {
+  for (const NodeDef& node : func.node_def()) {
+    if (flib.Contains(node.op())) return true;
+    for (const auto& attr : node.attr()) {
+      if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Returns the key of `func` in the FunctionOptimizationCache. It covers
+// everything that the optimized body depends on, besides the function
+// library: the function itself, the rewriter config, the graph version,
+// whether non-differentiable rewrites are allowed and the available devices.
+uint64 FunctionOptimizationCacheKey(const FunctionDef& func,
+                                    const RewriterConfig& cfg,
+                                    int producer,
+                                    bool allow_non_differentiable_rewrites,
+                                    const Cluster* cluster) {
+  string serialized;
+  SerializeToStringDeterministic(func, &serialized);
+  uint64 key = Fingerprint64(serialized);
+  SerializeToStringDeterministic(cfg, &serialized);
+  key = FingerprintCat64(key, Fingerprint64(serialized));
+  key = FingerprintCat64(key, producer);
+  key = FingerprintCat64(key, allow_non_differentiable_rewrites);
+  if (cluster != nullptr) {
+    for (const string& device : cluster->GetDeviceNames()) {
+      key = FingerprintCat64(key, Fingerprint64(device));
+    }
+  }
+  return key;
+}
+
 // A helper function to decide whether to enable the automatic mixed precision
 // optimizer.
 bool AutoMixedPrecisionEnabled(RewriterConfig::Toggle opt_level) {
@@ -238,6 +313,9 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+  MK_OPT("auto_mixed_precision_cpu_bfloat16",
+         "auto_mixed_precision_cpu_bfloat16",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU_BF16));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -401,6 +479,12 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu_bfloat16()) &&
+      AutoMixedPrecisionEnabled(
+          plugin_configs.toggle_config["auto_mixed_precision_cpu_bfloat16"])) {
+    optimizers->push_back(std::make_unique<AutoMixedPrecision>(
+        AutoMixedPrecisionMode::CPU_BF16));
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(std::make_unique<PinToHostOptimizer>());
   else if (BOTH_ARE_EXPERIMENTAL_MLIR(pin_to_host_optimization) ||
@@ -469,11 +553,14 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          std::make_unique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_target_peak_bytes()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_target_peak_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -651,6 +738,10 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())
             ? RewriterConfig::ON
             : RewriterConfig::OFF;
+    user_cfg.toggle_config["auto_mixed_precision_cpu_bfloat16"] =
+        AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu_bfloat16())
+            ? RewriterConfig::ON
+            : RewriterConfig::OFF;
     user_cfg.toggle_config["memory_optimization"] =
         MemoryOptimizerEnabled(cfg_.memory_optimization(),
                                config_proto_.graph_options()
@@ -681,6 +772,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
                 "auto_mixed_precision_onednn_bfloat16")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_mixed_precision_cpu_bfloat16",
+                "auto_mixed_precision_cpu_bfloat16")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -722,6 +815,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_onednn_bfloat16" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_mixed_precision_cpu_bfloat16" ||
         pair.first == "pin_to_host_optimization" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
@@ -823,6 +917,14 @@ Status MetaOptimizer::OptimizeGraph(
           *optimized_graph);
     }
 
+    // Later iterations bring the least improvement, skip them once out of
+    // budget.
+    if (iteration > 0 && SoftBudgetExceeded()) {
+      VLOG(1) << "Stopping after iteration " << iteration
+              << ", meta optimizer soft budget exceeded.";
+      break;
+    }
+
     for (const auto& optimizer : optimizers) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       // Some optimizers can run only once.
@@ -1049,6 +1151,11 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
   optimization_results_.clear();
+  soft_budget_deadline_usec_ =
+      cfg_.meta_optimizer_soft_budget_ms() > 0
+          ? Env::Default()->NowMicros() +
+                cfg_.meta_optimizer_soft_budget_ms() * 1000
+          : 0;
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1165,6 +1272,12 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      // Leave the remaining functions unoptimized once out of budget.
+      if (SoftBudgetExceeded()) {
+        VLOG(1) << "Skipping the remaining functions, meta optimizer soft "
+                   "budget exceeded.";
+        break;
+      }
 
       const string& func_name = func.signature().name();
 
@@ -1194,6 +1307,24 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
 
+      const bool allow_non_differentiable_rewrites =
+          !differentiable_functions.contains(func_name);
+      const bool use_cache = cfg_.enable_function_optimization_cache() &&
+                             !is_tpu_graph &&
+                             !CallsLibraryFunctions(func, flib);
+      uint64 cache_key = 0;
+      if (use_cache) {
+        cache_key = FunctionOptimizationCacheKey(
+            func, cfg_, producer, allow_non_differentiable_rewrites, cluster);
+        FunctionDef optimized_func;
+        if (FunctionOptimizationCache::Global()->Lookup(cache_key,
+                                                        &optimized_func)) {
+          VLOG(3) << "Reuse cached optimized function: " << func_name;
+          TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+          continue;
+        }
+      }
+
       // Make a GrapplerItem from a FunctionDef.
       GrapplerFunctionItem func_item;
       TF_RETURN_IF_ERROR(
@@ -1202,7 +1333,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // If we need to compute the gradient of optimized function at runtime, we
       // can't perform non-differentiable rewrites.
       func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
+          allow_non_differentiable_rewrites;
 
       // Device set available to the function is defined only by the runtime,
       // when we instantiate and execute the function. We can't use all devices
@@ -1252,10 +1383,12 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
+      bool added_functions = false;
       for (const FunctionDef& func_def :
            optimized_func_graph.library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+          added_functions = true;
         }
       }
 
@@ -1264,6 +1397,12 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       func_item.SwapFunctionBody(std::move(optimized_func_graph));
       TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
 
+      // The optimized function only depends on the cache key if it does not
+      // need the new functions.
+      if (use_cache && !added_functions) {
+        FunctionOptimizationCache::Global()->Insert(cache_key, optimized_func);
+      }
+
       // Replace optimized function with a new FunctionDef.
       TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
@@ -1312,6 +1451,11 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   return OkStatus();
 }
 
+bool MetaOptimizer::SoftBudgetExceeded() const {
+  return soft_budget_deadline_usec_ > 0 &&
+         Env::Default()->NowMicros() > soft_budget_deadline_usec_;
+}
+
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
@@ -1355,6 +1499,8 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         AutoMixedPrecisionEnabled(
+             rewrite_cfg.auto_mixed_precision_cpu_bfloat16()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -118,7 +118,14 @@ class MetaOptimizer : public GraphOptimizer {
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
 
+  // Returns true iff the RewriterConfig.meta_optimizer_soft_budget_ms budget
+  // of the current OptimizeConsumeItem call is exhausted.
+  bool SoftBudgetExceeded() const;
+
   std::vector<GraphOptimizationResult> optimization_results_;
+  // Time in microseconds at which the soft budget of the current
+  // OptimizeConsumeItem call is exhausted, or 0 if there is no budget.
+  uint64 soft_budget_deadline_usec_ = 0;
 };
 
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
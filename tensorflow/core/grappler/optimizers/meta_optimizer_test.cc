@@ -703,6 +703,52 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
       optimization_options_my_mul_2->allow_non_differentiable_rewrites);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithCache) {
+  using test::function::NDef;
+
+  gtl::FlatMap<string, GrapplerItem::OptimizationOptions> optimization_options;
+  GrapplerItemPropertiesAccumulator::SetOptimizationOptions(
+      &optimization_options);
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("GrapplerItemPropertiesAccumulator");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_enable_function_optimization_cache(true);
+
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyCachedMul", {"x:float", "y:float"}, {"z:float"}, {},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", DT_FLOAT}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  GrapplerItem item;
+  item.id = "main";
+  item.graph = test::function::GDef(
+      {NDef("x0", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("x1", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("mul", "MyCachedMul", {"x0", "x1"}, {}, kDevice)},
+      /*funcs=*/
+      {mul_func});
+  item.fetch = {"mul"};
+
+  GraphDef output;
+  MetaOptimizer optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(optimization_options.size(), 2);
+  EXPECT_NE(gtl::FindOrNull(optimization_options, "MyCachedMul"), nullptr);
+
+  // The second time, the optimized function is taken from the cache.
+  optimization_options.clear();
+  MetaOptimizer cached_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(cached_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(optimization_options.size(), 1);
+  EXPECT_EQ(gtl::FindOrNull(optimization_options, "MyCachedMul"), nullptr);
+
+  GrapplerItemPropertiesAccumulator::ResetOptimizationOptions();
+}
+
 class SleepingOptimizer : public CustomGraphOptimizer {
  public:
   SleepingOptimizer() {}
@@ -771,6 +817,29 @@ TEST_F(MetaOptimizerTest, MetaOptimizerTimesOut) {
   EXPECT_EQ(original_node_size + 1, output.node_size());
 }
 
+TEST_F(MetaOptimizerTest, MetaOptimizerExceedsSoftBudget) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("SleepingOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_soft_budget_ms(500);
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+
+  GraphDef output;
+  const int original_node_size = item.graph.node_size();
+  const Status status =
+      RunMetaOptimizer(std::move(item), config, nullptr, nullptr, &output);
+  TF_EXPECT_OK(status);
+  // The meta optimizer should skip the second iteration, and keep the result
+  // of the first one.
+  EXPECT_EQ(original_node_size + 1, output.node_size());
+}
+
 TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
   GrapplerItem item;
@@ -0,0 +1,390 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/quantized_matmul_rewriter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Quantization parameters of a per-tensor, signed 8 bit QDQ node.
+struct Quantization {
+  // The float tensor being fake-quantized.
+  std::string input;
+  // Size of a quantization step.
+  float scale;
+  int64_t min_val;
+  int64_t max_val;
+};
+
+template <typename T>
+T GetAttr(const NodeDef& node, const std::string& name, T default_value) {
+  T value;
+  if (!TryGetNodeAttr(node, name, &value)) return default_value;
+  return value;
+}
+
+bool GetScalarConstant(const NodeMap& node_map, const std::string& input,
+                       float* value) {
+  if (IsControlInput(input)) return false;
+  const NodeDef* node = node_map.GetNode(input);
+  if (node == nullptr || !IsConstant(*node)) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node->attr().at("value").tensor()) ||
+      tensor.dtype() != DT_FLOAT || tensor.NumElements() != 1) {
+    return false;
+  }
+  *value = tensor.flat<float>()(0);
+  return true;
+}
+
+// Returns true if `node` is a QDQ node whose quantization can be carried out
+// by the uniform quantized kernels, and fills in `quantization`.
+bool GetQuantization(const NodeMap& node_map, const NodeDef& node,
+                     Quantization* quantization) {
+  if (node.op() != "QuantizeAndDequantizeV2" &&
+      node.op() != "QuantizeAndDequantizeV4") {
+    return false;
+  }
+  if (node.input_size() < 3 || IsControlInput(node.input(0)) ||
+      GetAttr<DataType>(node, "T", DT_INVALID) != DT_FLOAT ||
+      !GetAttr<bool>(node, "signed_input", true) ||
+      GetAttr<int64_t>(node, "num_bits", 8) != 8 ||
+      !GetAttr<bool>(node, "range_given", false) ||
+      GetAttr<int64_t>(node, "axis", -1) != -1) {
+    return false;
+  }
+  float min_range, max_range;
+  if (!GetScalarConstant(node_map, node.input(1), &min_range) ||
+      !GetScalarConstant(node_map, node.input(2), &max_range)) {
+    return false;
+  }
+
+  // Mirrors ComputeQuantizationRange in quantize_and_dequantize_op.h.
+  const bool narrow_range = GetAttr<bool>(node, "narrow_range", false);
+  const int64_t min_quantized = narrow_range ? -127 : -128;
+  const int64_t max_quantized = 127;
+  const float scale_from_min_side = (min_quantized * min_range > 0)
+                                        ? min_quantized / min_range
+                                        : std::numeric_limits<float>::max();
+  const float scale_from_max_side = (max_quantized * max_range > 0)
+                                        ? max_quantized / max_range
+                                        : std::numeric_limits<float>::max();
+  float scale;
+  if (scale_from_min_side < scale_from_max_side) {
+    scale = min_range / min_quantized;
+  } else {
+    scale = max_range / max_quantized;
+  }
+  if (!(scale > 0.0f) || !std::isfinite(scale)) return false;
+
+  quantization->input = node.input(0);
+  quantization->scale = scale;
+  quantization->min_val = min_quantized;
+  quantization->max_val = max_quantized;
+  return true;
+}
+
+// Returns the only non-control consumer of `node`, or nullptr if `node` has
+// several consumers, is consumed through a control edge, or must be preserved.
+NodeDef* GetSoleConsumer(const NodeMap& node_map, const NodeDef& node,
+                         const std::unordered_set<std::string>& preserve) {
+  if (preserve.count(node.name()) > 0) return nullptr;
+  const auto& outputs = node_map.GetOutputs(node.name());
+  if (outputs.size() != 1) return nullptr;
+  NodeDef* consumer = *outputs.begin();
+  int count = 0;
+  for (const std::string& input : consumer->input()) {
+    if (NodeName(input) != node.name()) continue;
+    if (IsControlInput(input)) return nullptr;
+    ++count;
+  }
+  return count == 1 ? consumer : nullptr;
+}
+
+void CopyControlInputs(const NodeDef& from, NodeDef* to) {
+  for (const std::string& input : from.input()) {
+    if (IsControlInput(input)) to->add_input(input);
+  }
+}
+
+// Adds nodes to `graph`, all placed on the same device and named after a
+// common prefix.
+class NodeBuilder {
+ public:
+  NodeBuilder(std::string prefix, std::string device, GraphDef* graph)
+      : prefix_(std::move(prefix)), device_(std::move(device)), graph_(graph) {}
+
+  std::string Constant(const std::string& suffix, const Tensor& value) {
+    NodeDef* node = Add(suffix, "Const");
+    SetAttrValue(value.dtype(), &(*node->mutable_attr())["dtype"]);
+    value.AsProtoTensorContent(
+        (*node->mutable_attr())["value"].mutable_tensor());
+    return node->name();
+  }
+
+  NodeDef* Add(const std::string& suffix, const std::string& op) {
+    NodeDef* node = graph_->add_node();
+    node->set_name(absl::StrCat(prefix_, "/", suffix));
+    node->set_op(op);
+    node->set_device(device_);
+    return node;
+  }
+
+ private:
+  const std::string prefix_;
+  const std::string device_;
+  GraphDef* graph_;
+};
+
+void SetRangeAttrs(const std::string& prefix, int64_t min_val, int64_t max_val,
+                   NodeDef* node) {
+  auto* attr = node->mutable_attr();
+  const std::string sep = prefix.empty() ? "" : "_";
+  SetAttrValue(int64_t{-1}, &(*attr)[absl::StrCat(prefix, sep,
+                                                  "quantization_axis")]);
+  SetAttrValue(min_val,
+               &(*attr)[absl::StrCat(prefix, sep, "quantization_min_val")]);
+  SetAttrValue(max_val,
+               &(*attr)[absl::StrCat(prefix, sep, "quantization_max_val")]);
+}
+
+constexpr int64_t kInt32Min = std::numeric_limits<int32_t>::min();
+constexpr int64_t kInt32Max = std::numeric_limits<int32_t>::max();
+
+// A QDQ-wrapped `MatMul`, with its optional `BiasAdd` and output QDQ.
+struct Match {
+  NodeDef* matmul;
+  NodeDef* bias_add = nullptr;
+  NodeDef* output_qdq = nullptr;
+  std::string lhs_qdq;
+  std::string rhs_qdq;
+  Quantization lhs;
+  Quantization rhs;
+  Quantization output;
+};
+
+// Returns the node producing `input` if it is a data input read from output
+// 0, or nullptr otherwise.
+const NodeDef* GetFirstOutputProducer(const NodeMap& node_map,
+                                      const std::string& input) {
+  if (IsControlInput(input)) return nullptr;
+  int port;
+  const std::string name = ParseNodeName(input, &port);
+  return port == 0 ? node_map.GetNode(name) : nullptr;
+}
+
+}  // namespace
+
+Status QuantizedMatMulRewriter::Optimize(Cluster* cluster,
+                                         const GrapplerItem& item,
+                                         GraphDef* optimized_graph) {
+  *optimized_graph = item.graph;
+  NodeMap node_map(optimized_graph);
+  const std::unordered_set<std::string> nodes_to_preserve =
+      item.NodesToPreserve();
+
+  // Find all the patterns first, so that rewriting one doesn't hide another.
+  std::vector<Match> matches;
+  std::set<std::string> folded_qdqs;
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    if (node.op() != "MatMul" || node.input_size() < 2 ||
+        !NodeIsOnCpu(&node) ||
+        GetAttr<DataType>(node, "T", DT_INVALID) != DT_FLOAT ||
+        GetAttr<bool>(node, "transpose_a", false) ||
+        GetAttr<bool>(node, "transpose_b", false)) {
+      continue;
+    }
+    Match match;
+    match.matmul = &node;
+    const NodeDef* lhs_qdq = GetFirstOutputProducer(node_map, node.input(0));
+    const NodeDef* rhs_qdq = GetFirstOutputProducer(node_map, node.input(1));
+    if (lhs_qdq == nullptr || rhs_qdq == nullptr ||
+        !GetQuantization(node_map, *lhs_qdq, &match.lhs) ||
+        !GetQuantization(node_map, *rhs_qdq, &match.rhs)) {
+      continue;
+    }
+    match.lhs_qdq = lhs_qdq->name();
+    match.rhs_qdq = rhs_qdq->name();
+
+    // Extend the pattern with an optional BiasAdd and output QDQ.
+    NodeDef* consumer = GetSoleConsumer(node_map, node, nodes_to_preserve);
+    if (consumer != nullptr && consumer->op() == "BiasAdd" &&
+        consumer->device() == node.device() &&
+        consumer->input_size() >= 2 &&
+        NodeName(consumer->input(0)) == node.name() &&
+        !IsControlInput(consumer->input(1)) &&
+        GetAttr<std::string>(*consumer, "data_format", "NHWC") == "NHWC") {
+      match.bias_add = consumer;
+      consumer =
+          GetSoleConsumer(node_map, *match.bias_add, nodes_to_preserve);
+    }
+    if (consumer != nullptr && consumer->device() == node.device() &&
+        GetQuantization(node_map, *consumer, &match.output)) {
+      match.output_qdq = consumer;
+      folded_qdqs.insert(consumer->name());
+    }
+    matches.push_back(std::move(match));
+  }
+
+  std::set<std::string> nodes_to_delete;
+  for (Match& match : matches) {
+    NodeDef* matmul = match.matmul;
+    NodeDef* bias_add = match.bias_add;
+    NodeDef* output_qdq = match.output_qdq;
+    NodeDef* last = output_qdq != nullptr ? output_qdq
+                    : bias_add != nullptr ? bias_add
+                                          : matmul;
+    Quantization& lhs = match.lhs;
+    Quantization& rhs = match.rhs;
+    const Quantization& output = match.output;
+    // The input of a folded QDQ is deleted, but the QDQ itself still produces
+    // values on the quantization grid, so quantizing them again is exact.
+    if (folded_qdqs.count(match.lhs_qdq) > 0) lhs.input = match.lhs_qdq;
+    if (folded_qdqs.count(match.rhs_qdq) > 0) rhs.input = match.rhs_qdq;
+
+    const float acc_scale = lhs.scale * rhs.scale;
+    NodeBuilder builder(absl::StrCat(last->name(), "/int8"), last->device(),
+                        optimized_graph);
+    if (node_map.NodeExists(absl::StrCat(last->name(), "/int8/dot"))) continue;
+
+    const std::string zero_point =
+        builder.Constant("zero_point", Tensor(int32_t{0}));
+    const std::string lhs_scale =
+        builder.Constant("lhs_scale", Tensor(lhs.scale));
+    const std::string rhs_scale =
+        builder.Constant("rhs_scale", Tensor(rhs.scale));
+    const std::string acc_scale_name =
+        builder.Constant("acc_scale", Tensor(acc_scale));
+
+    auto quantize = [&](const std::string& suffix, const Quantization& q,
+                        const std::string& scale, DataType out_type) {
+      NodeDef* node = builder.Add(suffix, "UniformQuantize");
+      node->add_input(q.input);
+      node->add_input(scale);
+      node->add_input(zero_point);
+      SetAttrValue(DT_FLOAT, &(*node->mutable_attr())["Tin"]);
+      SetAttrValue(out_type, &(*node->mutable_attr())["Tout"]);
+      SetRangeAttrs("", q.min_val, q.max_val, node);
+      return node->name();
+    };
+    const std::string lhs_q = quantize("lhs", lhs, lhs_scale, DT_QINT8);
+    const std::string rhs_q = quantize("rhs", rhs, rhs_scale, DT_QINT8);
+
+    NodeDef* dot = builder.Add("dot", "UniformQuantizedDot");
+    for (const std::string& input :
+         {lhs_q, rhs_q, lhs_scale, zero_point, rhs_scale, zero_point,
+          acc_scale_name, zero_point}) {
+      dot->add_input(input);
+    }
+    CopyControlInputs(*matmul, dot);
+    SetAttrValue(DT_QINT8, &(*dot->mutable_attr())["Tin"]);
+    SetAttrValue(DT_QINT32, &(*dot->mutable_attr())["Tout"]);
+    SetRangeAttrs("lhs", lhs.min_val, lhs.max_val, dot);
+    SetRangeAttrs("rhs", rhs.min_val, rhs.max_val, dot);
+    SetRangeAttrs("output", kInt32Min, kInt32Max, dot);
+    std::string acc = dot->name();
+
+    if (bias_add != nullptr) {
+      // The bias is added to the int32 accumulator, at its scale.
+      const std::string bias_q = quantize(
+          "bias", {bias_add->input(1), acc_scale, kInt32Min, kInt32Max},
+          acc_scale_name, DT_QINT32);
+      NodeDef* add = builder.Add("bias_add", "UniformQuantizedAdd");
+      for (const std::string& input :
+           {acc, bias_q, acc_scale_name, zero_point, acc_scale_name,
+            zero_point, acc_scale_name, zero_point}) {
+        add->add_input(input);
+      }
+      CopyControlInputs(*bias_add, add);
+      SetAttrValue(DT_QINT32, &(*add->mutable_attr())["T"]);
+      SetRangeAttrs("lhs", kInt32Min, kInt32Max, add);
+      SetRangeAttrs("rhs", kInt32Min, kInt32Max, add);
+      SetRangeAttrs("output", kInt32Min, kInt32Max, add);
+      acc = add->name();
+    }
+
+    // Fold the output QDQ into a requantization of the accumulator.
+    std::string result = acc;
+    std::string result_scale = acc_scale_name;
+    DataType result_type = DT_QINT32;
+    int64_t result_min = kInt32Min;
+    int64_t result_max = kInt32Max;
+    if (output_qdq != nullptr) {
+      const std::string output_scale =
+          builder.Constant("output_scale", Tensor(output.scale));
+      NodeDef* requantize = builder.Add("requantize", "UniformRequantize");
+      for (const std::string& input :
+           {acc, acc_scale_name, zero_point, output_scale, zero_point}) {
+        requantize->add_input(input);
+      }
+      CopyControlInputs(*output_qdq, requantize);
+      SetAttrValue(DT_QINT32, &(*requantize->mutable_attr())["Tin"]);
+      SetAttrValue(DT_QINT8, &(*requantize->mutable_attr())["Tout"]);
+      SetRangeAttrs("input", kInt32Min, kInt32Max, requantize);
+      SetRangeAttrs("output", output.min_val, output.max_val, requantize);
+      result = requantize->name();
+      result_scale = output_scale;
+      result_type = DT_QINT8;
+      result_min = output.min_val;
+      result_max = output.max_val;
+    }
+
+    // The last node of the pattern becomes the dequantization of the result.
+    last->set_op("UniformDequantize");
+    last->clear_input();
+    last->add_input(result);
+    last->add_input(result_scale);
+    last->add_input(zero_point);
+    last->clear_attr();
+    SetAttrValue(result_type, &(*last->mutable_attr())["Tin"]);
+    SetAttrValue(DT_FLOAT, &(*last->mutable_attr())["Tout"]);
+    SetRangeAttrs("", result_min, result_max, last);
+
+    for (NodeDef* node : {matmul, bias_add, output_qdq}) {
+      if (node != nullptr && node != last) nodes_to_delete.insert(node->name());
+    }
+    VLOG(2) << "Rewrote " << matmul->name() << " into int8 kernels ending in "
+            << last->name();
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(QuantizedMatMulRewriter,
+                            "quantized_matmul_rewriter");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,69 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_QUANTIZED_MATMUL_REWRITER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_QUANTIZED_MATMUL_REWRITER_H_
+
+#include <string>
+
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Rewrites fake-quantized matmuls into int8 uniform quantized kernels.
+//
+// Graphs produced by quantization-aware training wrap the operands of a
+// `MatMul` in `QuantizeAndDequantizeV2`/`V4` nodes, so on CPU the matmul still
+// runs in float. When both operands are quantized per-tensor to signed 8 bits
+// with a constant range, the pattern
+//
+//   [QDQ(]BiasAdd(MatMul(QDQ(lhs), QDQ(rhs)), bias)[)]
+//
+// (with the `BiasAdd` and the output QDQ being optional) is replaced by
+// `UniformQuantize` of both operands, a `UniformQuantizedDot` accumulating in
+// int32, a `UniformQuantizedAdd` of the bias quantized to int32, a
+// `UniformRequantize` to the output range if there is an output QDQ, and a
+// final `UniformDequantize`. The last node keeps the name of the last node of
+// the pattern, so consumers and fetches are left untouched.
+//
+// The int8 kernels round ties away from zero, like the QDQ "HALF_UP" rounding
+// mode, so graphs using "HALF_TO_EVEN" may differ in the last quantization
+// step on exact ties.
+//
+// The optimizer is enabled through `RewriterConfig.custom_optimizers`, with
+// the name "quantized_matmul_rewriter".
+class QuantizedMatMulRewriter : public CustomGraphOptimizer {
+ public:
+  QuantizedMatMulRewriter() = default;
+  ~QuantizedMatMulRewriter() override = default;
+
+  std::string name() const override { return "quantized_matmul_rewriter"; }
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return OkStatus();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_QUANTIZED_MATMUL_REWRITER_H_
@@ -0,0 +1,169 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/quantized_matmul_rewriter.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+class QuantizedMatMulRewriterTest : public GrapplerTest {
+ protected:
+  // Adds a per-tensor int8 `QuantizeAndDequantizeV4` of `input` named `name`
+  // with the constant range [-`range`, `range`].
+  Output AddQdq(const Scope& s, const std::string& name, Input input,
+                float range, bool range_given = true) {
+    Output min = ops::Const(s.WithOpName(name + "_min"), -range);
+    Output max = ops::Const(s.WithOpName(name + "_max"), range);
+    return ops::QuantizeAndDequantizeV4(
+        s.WithOpName(name), input, min, max,
+        ops::QuantizeAndDequantizeV4::RangeGiven(range_given));
+  }
+
+  int CountOps(const GraphDef& graph, const std::string& op) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == op) ++count;
+    }
+    return count;
+  }
+};
+
+TEST_F(QuantizedMatMulRewriterTest, RewritesMatMulWithBiasAndOutputQdq) {
+  Scope s = Scope::NewRootScope().WithDevice(kDevice);
+  Output lhs = ops::Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                                ops::Placeholder::Shape({4, 8}));
+  Output rhs = ops::Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                                ops::Placeholder::Shape({8, 3}));
+  Output bias = ops::Const(s.WithOpName("bias"), {0.5f, -0.25f, 0.125f}, {3});
+  Output matmul =
+      ops::MatMul(s.WithOpName("matmul"), AddQdq(s, "lhs_qdq", lhs, 1),
+                  AddQdq(s, "rhs_qdq", rhs, 1));
+  Output bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  AddQdq(s, "out_qdq", bias_add, 8);
+
+  GrapplerItem item;
+  item.fetch = {"out_qdq"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  QuantizedMatMulRewriter optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "QuantizeAndDequantizeV4"), 0);
+  EXPECT_EQ(CountOps(output, "MatMul"), 0);
+  EXPECT_EQ(CountOps(output, "BiasAdd"), 0);
+  EXPECT_EQ(CountOps(output, "UniformQuantize"), 3);
+  EXPECT_EQ(CountOps(output, "UniformQuantizedDot"), 1);
+  EXPECT_EQ(CountOps(output, "UniformQuantizedAdd"), 1);
+  EXPECT_EQ(CountOps(output, "UniformRequantize"), 1);
+  const NodeDef* fetch = nullptr;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "out_qdq") fetch = &node;
+  }
+  ASSERT_NE(fetch, nullptr);
+  EXPECT_EQ(fetch->op(), "UniformDequantize");
+
+  Tensor lhs_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 8}));
+  Tensor rhs_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({8, 3}));
+  item.feed = {{"lhs", lhs_t}, {"rhs", rhs_t}};
+  std::vector<Tensor> expected = EvaluateNodes(item.graph, item.fetch,
+                                               item.feed);
+  std::vector<Tensor> actual = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(expected.size(), 1);
+  ASSERT_EQ(actual.size(), 1);
+  // The int8 path may land one output step away from the float emulation when
+  // the accumulator sits on a rounding boundary.
+  test::ExpectClose(actual[0], expected[0], /*atol=*/8.0 / 127);
+}
+
+TEST_F(QuantizedMatMulRewriterTest, RewritesChainedMatMuls) {
+  Scope s = Scope::NewRootScope().WithDevice(kDevice);
+  Output lhs = ops::Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                                ops::Placeholder::Shape({2, 4}));
+  Output w1 = ops::Placeholder(s.WithOpName("w1"), DT_FLOAT,
+                               ops::Placeholder::Shape({4, 4}));
+  Output w2 = ops::Placeholder(s.WithOpName("w2"), DT_FLOAT,
+                               ops::Placeholder::Shape({4, 2}));
+  Output first =
+      ops::MatMul(s.WithOpName("first"), AddQdq(s, "lhs_qdq", lhs, 1),
+                  AddQdq(s, "w1_qdq", w1, 1));
+  Output hidden = AddQdq(s, "hidden_qdq", first, 4);
+  ops::MatMul(s.WithOpName("second"), hidden, AddQdq(s, "w2_qdq", w2, 1));
+
+  GrapplerItem item;
+  item.fetch = {"second"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  QuantizedMatMulRewriter optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "QuantizeAndDequantizeV4"), 0);
+  EXPECT_EQ(CountOps(output, "MatMul"), 0);
+  EXPECT_EQ(CountOps(output, "UniformQuantizedDot"), 2);
+
+  Tensor lhs_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({2, 4}));
+  Tensor w1_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 4}));
+  Tensor w2_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4, 2}));
+  item.feed = {{"lhs", lhs_t}, {"w1", w1_t}, {"w2", w2_t}};
+  std::vector<Tensor> expected = EvaluateNodes(item.graph, item.fetch,
+                                               item.feed);
+  std::vector<Tensor> actual = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(expected.size(), 1);
+  ASSERT_EQ(actual.size(), 1);
+  // One step of `hidden_qdq` propagated through the second matmul.
+  test::ExpectClose(actual[0], expected[0], /*atol=*/4.0 * 4 / 127);
+}
+
+TEST_F(QuantizedMatMulRewriterTest, LeavesDynamicRangeQdqAlone) {
+  Scope s = Scope::NewRootScope().WithDevice(kDevice);
+  Output lhs = ops::Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                                ops::Placeholder::Shape({4, 8}));
+  Output rhs = ops::Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                                ops::Placeholder::Shape({8, 3}));
+  ops::MatMul(s.WithOpName("matmul"),
+              AddQdq(s, "lhs_qdq", lhs, 1, /*range_given=*/false),
+              AddQdq(s, "rhs_qdq", rhs, 1));
+
+  GrapplerItem item;
+  item.fetch = {"matmul"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  QuantizedMatMulRewriter optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "MatMul"), 1);
+  EXPECT_EQ(CountOps(output, "QuantizeAndDequantizeV4"), 2);
+  EXPECT_EQ(CountOps(output, "UniformQuantizedDot"), 0);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -68,6 +68,12 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// FusedBatchNormV3 based Keras LayerNormalization -> _MklLayerNorm with oneDNN,
+// or _FusedLayerNorm on other CPU builds.
+//
+// BatchMatMul + Mul + Softmax + BatchMatMul -> _FusedScaledDotProductAttention
+//   (CPU only).
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -85,6 +91,9 @@ constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
+constexpr char kFusedLayerNorm[] = "_FusedLayerNorm";
+constexpr char kFusedScaledDotProductAttention[] =
+    "_FusedScaledDotProductAttention";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
@@ -1539,15 +1548,20 @@ bool IsMatchedMatMulBiasAddAndGeluExact(
 // parmeter `approximate={True/False}` different types of ops are generated. We
 // distinguish them as `GeluExact` that uses Erf and `GeluApproximate` that
 // uses Tanh.
+//
+// Without oneDNN, the fusion runs on CPU with the Eigen kernel of _FusedMatMul,
+// which has no gradient, so it requires `allow_eigen_fusion`.
 bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
-                              const Cluster* cluster,
+                              const Cluster* cluster, bool allow_eigen_fusion,
                               std::map<string, int>* matched_nodes_map,
                               std::set<int>* remove_node_indices,
                               bool* is_gelu_approximate) {
-  // Gelu fusion is enabled with oneDNN or cublasLt or cuDNN library.
-  if (!IsMKLEnabled() && !BlasLtMatmulEnabled() &&
-      !RuntimeFusionEnabled(cluster))
-    return false;
+  // Gelu fusion is enabled with oneDNN or cublasLt or cuDNN library, and with
+  // the Eigen kernel on CPU.
+  const bool gpu_fusion_enabled =
+      IsMKLEnabled() || BlasLtMatmulEnabled() || RuntimeFusionEnabled(cluster);
+  const bool cpu_fusion_enabled = IsMKLEnabled() || allow_eigen_fusion;
+  if (!gpu_fusion_enabled && !cpu_fusion_enabled) return false;
 
   using utils::MatchingDirection;
   using utils::NodeStatus;
@@ -1663,14 +1677,16 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
         ctx->graph_view.GetNode(matched_nodes_map->at("matmul"))->node();
     DataType matmul_dtype = GetDataTypeFromAttr(*matmul_node, "T");
 
-    bool cpu_ok = IsMKLEnabled() && IsCpuCompatibleMatMul(*ctx, matmul_node);
-    // Currently, the fusion is not supported on CPU for transpose_a in the
-    // MatMul op.
-    cpu_ok = cpu_ok && matmul_node->attr().contains("transpose_a") &&
-             !matmul_node->attr().at("transpose_a").b();
+    bool cpu_ok =
+        cpu_fusion_enabled && IsCpuCompatibleMatMul(*ctx, matmul_node);
+    // Currently, the oneDNN fusion is not supported on CPU for transpose_a in
+    // the MatMul op.
+    cpu_ok = cpu_ok && (!IsMKLEnabled() ||
+                        (matmul_node->attr().contains("transpose_a") &&
+                         !matmul_node->attr().at("transpose_a").b()));
 
-    bool gpu_ok = NodeIsOnGpu(matmul_node) && RuntimeFusionEnabled(cluster) &&
-                  matmul_dtype == DT_HALF;
+    bool gpu_ok = gpu_fusion_enabled && NodeIsOnGpu(matmul_node) &&
+                  RuntimeFusionEnabled(cluster) && matmul_dtype == DT_HALF;
     if (!cpu_ok && !gpu_ok) return false;
 
     // Check if the leading dims of input matrices are even numbers. The CuDNN
@@ -1700,11 +1716,12 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
 
     // matmul_node is already the _FusedMatMul and we don't need to check its
     // data type again.
-    if (!IsMKLEnabled() && !NodeIsOnGpu(matmul_node)) return false;
+    if (NodeIsOnGpu(matmul_node) ? !gpu_fusion_enabled : !cpu_fusion_enabled)
+      return false;
 
-    // Currently, the fusion is not supported on CPU for transpose_a in the
-    // MatMul op.
-    if (NodeIsOnCpu(matmul_node) &&
+    // Currently, the oneDNN fusion is not supported on CPU for transpose_a in
+    // the MatMul op.
+    if (IsMKLEnabled() && NodeIsOnCpu(matmul_node) &&
         matmul_node->attr().contains("transpose_a") &&
         matmul_node->attr().at("transpose_a").b()) {
       return false;
@@ -1861,12 +1878,12 @@ bool FindSigmoidAndMul(RemapperContext* ctx, int node_index,
 
 // Keras LayerNormalization api uses multiple TensorFlow ops. Current fusion
 // pattern is only for the case, when LayerNormalization uses FusedBatcNormV3.
-// We further restrict it to only 2D or 3D tensor inputs to keras
-// LayerNormalization api.
-bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
-                      std::map<string, int>* matched_nodes_map,
-                      std::set<int>* remove_node_indices, float* epsilon) {
-  if (!IsMKLEnabled()) return false;
+// With oneDNN, we further restrict it to only 2D or 3D tensor inputs to keras
+// LayerNormalization api. Otherwise, the pattern is fused into
+// _FusedLayerNorm, which normalizes over the innermost dimension only.
+bool FindLayerNorm(RemapperContext* ctx, int node_index,
+                   std::map<string, int>* matched_nodes_map,
+                   std::set<int>* remove_node_indices, float* epsilon) {
 
   // The following pattern will be searched in the graph with additional
   // contraints. Here * means any type of op.
@@ -1880,7 +1897,7 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
   //           Reshape  Fill   Fill  /     /         *(input) *(gamma)  *(beta)
   //              \      /      /   /     /                \     |      /
   //               \    /      /   /     /                  \    |     /
-  //          F u s e d B a t c h N o r m V 3              _MklLayerNorm
+  //          F u s e d B a t c h N o r m V 3            _{Mkl,Fused}LayerNorm
   //                 \
   //                  \   *
   //                   \ /
@@ -1997,14 +2014,184 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
     if (ShapesSymbolicallyEqual(input_props[0].shape(),
                                 output_props[0].shape())) {
       int rank = Rank(input_props[0].shape());
-      if (rank < 2 || rank > 3) return false;
+      if (IsMKLEnabled() && (rank < 2 || rank > 3)) return false;
+      if (rank < 1) return false;
     } else {
       return false;
     }
+
+    if (!IsMKLEnabled()) {
+      const DataType dtype = GetDataTypeFromAttr(*output_node_def, "T");
+      if (dtype != DT_FLOAT && dtype != DT_BFLOAT16) return false;
+
+      // _FusedLayerNorm only normalizes over the innermost dimension, so gamma
+      // and beta must be vectors of its size. This rules out Keras layers
+      // normalizing over several axes.
+      const TensorShapeProto& input_shape = input_props[0].shape();
+      const auto& depth = input_shape.dim(input_shape.dim_size() - 1);
+      if (!IsKnown(depth)) return false;
+      for (const char* name : {"gamma", "beta"}) {
+        NodeDef* node_def =
+            ctx->graph_view.GetNode(matched_nodes_map->at(name))->node();
+        const auto& props =
+            ctx->graph_properties.GetOutputProperties(node_def->name());
+        if (props.empty()) return false;
+        const TensorShapeProto& shape = props[0].shape();
+        if (Rank(shape) != 1 || shape.dim(0).size() != depth.size())
+          return false;
+      }
+    }
   }
   return found_op_type_match;
 }
 
+// Scaled dot-product attention, as written out by most Transformer
+// implementations, is a chain of four ops:
+// clang-format off
+//
+//   *(query)  *(key)
+//        \     /
+//     BatchMatMul(adj_y)
+//           \
+//           Mul  Const(scale)             *(query) *(key) *(value)
+//             \  /                              \    |    /
+//            Softmax                   _FusedScaledDotProductAttention
+//                 \
+//                  \  *(value)
+//                   \ /
+//               BatchMatMul(output)
+//
+// clang-format on
+// The Mul is optional, e.g. when the query has already been scaled. The fused
+// kernel never materializes the [batch, M, N] attention scores, and does not
+// support broadcasting of the batch dimensions.
+bool FindScaledDotProductAttention(RemapperContext* ctx, int node_index,
+                                   std::map<string, int>* matched_nodes_map,
+                                   std::set<int>* remove_node_indices,
+                                   float* scale) {
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+
+  auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsAnyBatchMatMul(*node_def) || !NodeIsOnCpu(node_def) ||
+      !HasDataType(node_def, DT_FLOAT)) {
+    return false;
+  }
+
+  // clang-format off
+  utils::OpTypePattern scores =
+    {"BatchMatMul|BatchMatMulV2", "scores", NodeStatus::kRemove,
+      {
+        {"*", "query", NodeStatus::kRemain},
+        {"*", "key", NodeStatus::kRemain}
+      }
+    };
+  utils::OpTypePattern scaled_attention_pattern =
+    {"BatchMatMul|BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove,
+          {
+            {"Mul", "scaled_scores", NodeStatus::kRemove,
+              {
+                scores,
+                {"Const", "scale", NodeStatus::kRemain}
+              }
+            }
+          }
+        },
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  utils::OpTypePattern attention_pattern =
+    {"BatchMatMul|BatchMatMulV2", "output", NodeStatus::kReplace,
+      {
+        {"Softmax", "softmax", NodeStatus::kRemove, {scores}},
+        {"*", "value", NodeStatus::kRemain}
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  if (!graph_matcher.GetMatchedNodes(scaled_attention_pattern,
+                                     ctx->nodes_to_preserve, node_view,
+                                     matched_nodes_map, remove_node_indices)) {
+    matched_nodes_map->clear();
+    remove_node_indices->clear();
+    if (!graph_matcher.GetMatchedNodes(attention_pattern,
+                                       ctx->nodes_to_preserve, node_view,
+                                       matched_nodes_map,
+                                       remove_node_indices)) {
+      return false;
+    }
+  }
+
+  // Only plain products are supported, with the key transposed.
+  const auto has_adjoints = [](const NodeDef& node, bool adj_x, bool adj_y) {
+    bool node_adj_x = false;
+    bool node_adj_y = false;
+    TryGetNodeAttr(node, "adj_x", &node_adj_x);
+    TryGetNodeAttr(node, "adj_y", &node_adj_y);
+    return node_adj_x == adj_x && node_adj_y == adj_y;
+  };
+  const NodeDef* scores_node =
+      ctx->graph_view.GetNode(matched_nodes_map->at("scores"))->node();
+  if (!has_adjoints(*node_def, false, false) ||
+      !has_adjoints(*scores_node, false, true) ||
+      !HaveSameDataType(node_def, scores_node) ||
+      !NodeIsOnCpu(scores_node)) {
+    return false;
+  }
+
+  *scale = 1.0f;
+  if (matched_nodes_map->count("scale")) {
+    const NodeDef* scale_node =
+        ctx->graph_view.GetNode(matched_nodes_map->at("scale"))->node();
+    Tensor scale_tensor;
+    if (!scale_node->attr().contains("value") ||
+        !scale_tensor.FromProto(scale_node->attr().at("value").tensor()) ||
+        scale_tensor.dtype() != DT_FLOAT || scale_tensor.NumElements() != 1) {
+      return false;
+    }
+    *scale = scale_tensor.flat<float>()(0);
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+
+  // The query, key and value must have the same rank and batch dimensions,
+  // because the fused kernel does not broadcast.
+  const auto& scores_props =
+      ctx->graph_properties.GetInputProperties(scores_node->name());
+  const auto& output_props =
+      ctx->graph_properties.GetInputProperties(node_def->name());
+  if (scores_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_props[0].shape();
+  const TensorShapeProto& key_shape = scores_props[1].shape();
+  const TensorShapeProto& value_shape = output_props[1].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 2 || Rank(key_shape) != rank || Rank(value_shape) != rank)
+    return false;
+  for (int i = 0; i < rank - 2; ++i) {
+    const auto& dim = query_shape.dim(i);
+    if (!IsKnown(dim) || key_shape.dim(i).size() != dim.size() ||
+        value_shape.dim(i).size() != dim.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool FindFusedBatchNorm(const RemapperContext& ctx, int node_index,
                         FusedBatchNorm* matched) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -3422,12 +3609,11 @@ Status AddFusedMatMulBiasAddAndGelu(
   return OkStatus();
 }
 
-Status AddMklLayerNorm(RemapperContext* ctx,
-                       const std::map<string, int>& matched_nodes_map,
-                       const std::set<int>& remove_node_indices,
-                       std::vector<bool>* invalidated_nodes,
-                       std::vector<bool>* nodes_to_delete,
-                       const float epsilon) {
+Status AddLayerNorm(RemapperContext* ctx,
+                    const std::map<string, int>& matched_nodes_map,
+                    const std::set<int>& remove_node_indices,
+                    std::vector<bool>* invalidated_nodes,
+                    std::vector<bool>* nodes_to_delete, const float epsilon) {
   auto* pre_reshape_node =
       ctx->graph_view.GetNode(matched_nodes_map.at("pre_reshape"))->node();
   auto* scale_node =
@@ -3437,7 +3623,7 @@ Status AddMklLayerNorm(RemapperContext* ctx,
 
   NodeDef fused_node;
   fused_node.set_name(output_node->name());
-  fused_node.set_op("_MklLayerNorm");
+  fused_node.set_op(IsMKLEnabled() ? "_MklLayerNorm" : kFusedLayerNorm);
   fused_node.set_device(output_node->device());
   fused_node.add_input(pre_reshape_node->input(0));
   fused_node.add_input(scale_node->name());
@@ -3460,6 +3646,40 @@ Status AddMklLayerNorm(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddScaledDotProductAttention(
+    RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
+    const std::set<int>& remove_node_indices,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete,
+    const float scale) {
+  auto* output_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  auto* scores_node =
+      ctx->graph_view.GetNode(matched_nodes_map.at("scores"))->node();
+
+  NodeDef fused_node;
+  fused_node.set_name(output_node->name());
+  fused_node.set_op(kFusedScaledDotProductAttention);
+  fused_node.set_device(output_node->device());
+  fused_node.add_input(scores_node->input(0));
+  fused_node.add_input(scores_node->input(1));
+  fused_node.add_input(output_node->input(1));
+  auto* attr = fused_node.mutable_attr();
+  (*attr)["T"] = output_node->attr().at("T");
+  SetAttrValue(scale, &(*attr)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_node), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return OkStatus();
+}
+
 Status ReplaceMulMaximumWithLeakyRelu(
     RemapperContext* ctx, const std::map<string, int>& matched_nodes_map,
     const std::set<int>& remove_node_indices,
@@ -4516,18 +4736,6 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
         continue;
       }
 
-      // Remap smaller ops from layernorm python api into _MklLayerNorm
-      matched_nodes_map.clear();
-      remove_node_indices.clear();
-      float epsilon = 0.001;
-      if (FindMklLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
-                           &epsilon)) {
-        TF_RETURN_IF_ERROR(
-            AddMklLayerNorm(&ctx, matched_nodes_map, remove_node_indices,
-                            &invalidated_nodes, &nodes_to_delete, epsilon));
-        continue;
-      }
-
       // Remap ops that make up instancenorm followed by Relu or LeakyRelu
       // into _MklFusedInstanceNorm
       matched_nodes_map.clear();
@@ -4555,14 +4763,44 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     std::map<string, int> matched_nodes_map;
     std::set<int> remove_node_indices;
     bool is_gelu_approximate = false;
-    if (FindMatMulBiasAddAndGelu(&ctx, i, cluster, &matched_nodes_map,
-                                 &remove_node_indices, &is_gelu_approximate)) {
+    if (FindMatMulBiasAddAndGelu(&ctx, i, cluster,
+                                 allow_non_differentiable_rewrites,
+                                 &matched_nodes_map, &remove_node_indices,
+                                 &is_gelu_approximate)) {
       TF_RETURN_IF_ERROR(AddFusedMatMulBiasAddAndGelu(
           &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
           &nodes_to_delete, is_gelu_approximate));
       continue;
     }
 
+    // Remap smaller ops from layernorm python api into _MklLayerNorm, or into
+    // _FusedLayerNorm without oneDNN.
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
+    float epsilon = 0.001;
+    if ((IsMKLEnabled() || allow_non_differentiable_rewrites) &&
+        FindLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                      &epsilon)) {
+      TF_RETURN_IF_ERROR(AddLayerNorm(&ctx, matched_nodes_map,
+                                      remove_node_indices, &invalidated_nodes,
+                                      &nodes_to_delete, epsilon));
+      continue;
+    }
+
+    // Remap BatchMatMul+Mul+Softmax+BatchMatMul into the
+    // _FusedScaledDotProductAttention.
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
+    float attention_scale = 1.0f;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledDotProductAttention(&ctx, i, &matched_nodes_map,
+                                      &remove_node_indices, &attention_scale)) {
+      TF_RETURN_IF_ERROR(AddScaledDotProductAttention(
+          &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
+          &nodes_to_delete, attention_scale));
+      continue;
+    }
+
     // Remap {Conv2D,DepthwiseConv2D,MatMul}+BiasAdd into the
     // _Fused{Conv2D,DepthwiseConv2dNative,MatMul}
     ContractionWithBiasAdd contract_with_bias;
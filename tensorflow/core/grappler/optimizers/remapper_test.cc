@@ -2717,5 +2717,223 @@ TEST_F(RemapperFuseFusedConvWithFusedActivation, Conv3D_BF16) {
   RunTest<3, DT_BFLOAT16>();
 }
 
+TEST_F(RemapperTest, FuseMatMulWithBiasAndGeluExactOnCpu) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to Eigen.";
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto lhs = Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({8, 32}));
+  auto rhs = Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({32, 64}));
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                          ops::Placeholder::Shape({64}));
+
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+
+  // 0.5 * x * (1 + erf(x / sqrt(2)))
+  auto square_root_one_half =
+      ops::Const(s.WithOpName("square_root_one_half"), {0.707106f}, {});
+  auto erf = ops::Erf(s.WithOpName("erf"),
+                      ops::Mul(s.WithOpName("bias_add_times_square_root"),
+                               bias_add, square_root_one_half));
+  auto one = ops::Const(s.WithOpName("one"), {1.0f}, {});
+  auto erf_plus_one = ops::AddV2(s.WithOpName("one_plus_erf"), erf, one);
+  auto one_half = ops::Const(s.WithOpName("one_half"), {0.5f}, {});
+  auto erf_plus_one_times_one_half = ops::Mul(
+      s.WithOpName("erf_plus_one_times_one_half"), erf_plus_one, one_half);
+  auto gelu = ops::Mul(s.WithOpName("gelu"), erf_plus_one_times_one_half,
+                       bias_add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), gelu);
+
+  auto lhs_t = GenerateTensorWithSetRandom<DT_FLOAT>({8, 32});
+  auto rhs_t = GenerateTensorWithSetRandom<DT_FLOAT>({32, 64});
+  auto bias_t = GenerateTensorWithSetRandom<DT_FLOAT>({64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"lhs", lhs_t}, {"rhs", rhs_t}, {"bias", bias_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "gelu") {
+      EXPECT_EQ(node.op(), "_FusedMatMul");
+      ASSERT_GE(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "lhs");
+      EXPECT_EQ(node.input(1), "rhs");
+      EXPECT_EQ(node.input(2), "bias");
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 2);
+      EXPECT_EQ(fused_ops[0], "BiasAdd");
+      EXPECT_EQ(fused_ops[1], "GeluExact");
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseLayerNormOnCpu) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to Eigen.";
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The subgraph of Keras LayerNormalization(axis=-1) for a [2, 3, 8] input.
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 8}));
+  auto gamma = Placeholder(s.WithOpName("gamma"), DT_FLOAT,
+                           ops::Placeholder::Shape({8}));
+  auto beta = Placeholder(s.WithOpName("beta"), DT_FLOAT,
+                          ops::Placeholder::Shape({8}));
+  auto pre_shape = ops::Const(s.WithOpName("pre_shape"), {1, 6, 8, 1}, {4});
+  auto pre_reshape =
+      ops::Reshape(s.WithOpName("pre_reshape"), input, pre_shape);
+  auto fill_scale =
+      ops::Fill(s.WithOpName("fill_scale"),
+                ops::Const(s.WithOpName("dims_fill_scale"), {6}, {1}),
+                ops::Const(s.WithOpName("unit_gamma"), 1.0f));
+  auto fill_offset =
+      ops::Fill(s.WithOpName("fill_offset"),
+                ops::Const(s.WithOpName("dims_fill_offset"), {6}, {1}),
+                ops::Const(s.WithOpName("zero_beta"), 0.0f));
+  auto empty = ops::Const(s.WithOpName("empty"),
+                          Input::Initializer(Tensor(DT_FLOAT, {0})));
+  auto fused_batch_norm = ops::FusedBatchNormV3(
+      s.WithOpName("fused_batch_norm"), pre_reshape, fill_scale, fill_offset,
+      empty, empty,
+      ops::FusedBatchNormV3::Attrs().IsTraining(true).DataFormat("NCHW"));
+  auto post_shape = ops::Const(s.WithOpName("post_shape"), {2, 3, 8}, {3});
+  auto post_reshape = ops::Reshape(s.WithOpName("post_reshape"),
+                                   fused_batch_norm.y, post_shape);
+  auto scale = ops::Mul(s.WithOpName("scale"), post_reshape, gamma);
+  auto layer_norm = ops::AddV2(s.WithOpName("layer_norm"), scale, beta);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), layer_norm);
+
+  auto input_t = GenerateTensorWithSetRandom<DT_FLOAT>({2, 3, 8});
+  auto gamma_t = GenerateTensorWithSetRandom<DT_FLOAT>({8});
+  auto beta_t = GenerateTensorWithSetRandom<DT_FLOAT>({8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}, {"gamma", gamma_t}, {"beta", beta_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "layer_norm") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "gamma");
+      EXPECT_EQ(node.input(2), "beta");
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-5);
+}
+
+class RemapperFuseScaledDotProductAttentionTest : public RemapperTest {
+ public:
+  void RunTest(bool with_scale) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 4, 8}));
+    auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 6, 8}));
+    auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                             ops::Placeholder::Shape({2, 6, 3}));
+
+    Output scores =
+        ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                           ops::BatchMatMulV2::Attrs().AdjY(true));
+    if (with_scale) {
+      scores = ops::Mul(s.WithOpName("scaled_scores"), scores,
+                        ops::Const(s.WithOpName("scale"), 0.35f));
+    }
+    auto softmax = ops::Softmax(s.WithOpName("softmax"), scores);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    auto query_t = GenerateTensorWithSetRandom<DT_FLOAT>({2, 4, 8});
+    auto key_t = GenerateTensorWithSetRandom<DT_FLOAT>({2, 6, 8});
+    auto value_t = GenerateTensorWithSetRandom<DT_FLOAT>({2, 6, 3});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.op(), "Softmax");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        EXPECT_FLOAT_EQ(node.attr().at("scale").f(), with_scale ? 0.35f : 1.0f);
+        found++;
+      }
+    }
+    EXPECT_EQ(1, found);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectClose(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperFuseScaledDotProductAttentionTest, Scaled) { RunTest(true); }
+TEST_F(RemapperFuseScaledDotProductAttentionTest, Unscaled) { RunTest(false); }
+
 }  // namespace grappler
 }  // namespace tensorflow
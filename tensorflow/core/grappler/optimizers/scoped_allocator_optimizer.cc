@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/scoped_allocator.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -524,7 +527,8 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count",
+                    static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -889,12 +893,276 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Elides a ConcatV2 or Pack whose inputs are contiguous slices of its output.
+// The producers of the inputs allocate them directly in a ScopedAllocator
+// backing tensor, which a _ScopedAllocatorConcat then outputs without copying:
+//
+//   p1   p2             sa
+//    \   /             /  \   (control edges)
+//    concat    =>    p1    p2
+//      |               \  /
+//                       sac
+//                        |
+//                  concat (Identity)
+//
+// The original node becomes an Identity of the new _ScopedAllocatorConcat so
+// that its name, consumers and fetches are unchanged.  Inputs that can't be
+// allocated in the output, for example Const ops or tensors with other
+// consumers, are copied into it by a new Identity, which costs the same as the
+// copy done by the concat.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesEachNode() const override { return true; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    for (NodeDef* concat : ops) {
+      TF_RETURN_IF_ERROR(
+          RewriteConcat(sa_opti, invocation_count, graph, concat, applied));
+    }
+    return OkStatus();
+  }
+
+ private:
+  // Returns true if the inputs of `concat` are contiguous slices of its output
+  // which can each be allocated from a ScopedAllocator field without padding,
+  // and populates their type and shapes.
+  bool IsContiguousConcat(NodeMap* node_map, const NodeDef& concat,
+                          DataType* dtype, TensorShape* output_shape,
+                          std::vector<TensorShape>* input_shapes) {
+    int num_inputs = 0;
+    if (!GetNodeAttr(concat, "N", &num_inputs).ok() || num_inputs < 2 ||
+        !GetNodeAttr(concat, "T", dtype).ok()) {
+      return false;
+    }
+    if (!DataTypeCanUseMemcpy(*dtype) ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return false;
+    }
+    if (!graph_properties_->HasInputProperties(concat.name()) ||
+        !graph_properties_->HasOutputProperties(concat.name())) {
+      return false;
+    }
+    const auto& input_props =
+        graph_properties_->GetInputProperties(concat.name());
+    const auto& output_props =
+        graph_properties_->GetOutputProperties(concat.name());
+    if (static_cast<int>(input_props.size()) < num_inputs ||
+        output_props.size() != 1 ||
+        !PartialTensorShape(output_props[0].shape()).IsFullyDefined()) {
+      return false;
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+
+    int64_t axis = 0;
+    if (IsPack(concat)) {
+      if (!GetNodeAttr(concat, "axis", &axis).ok()) return false;
+    } else {
+      const NodeDef* axis_node = node_map->GetNode(concat.input(num_inputs));
+      Tensor axis_tensor;
+      if (axis_node == nullptr || !IsConstant(*axis_node) ||
+          !HasNodeAttr(*axis_node, "value") ||
+          !axis_tensor.FromProto(axis_node->attr().at("value").tensor()) ||
+          axis_tensor.NumElements() != 1) {
+        return false;
+      }
+      axis = axis_tensor.dtype() == DT_INT32 ? axis_tensor.flat<int32>()(0)
+                                             : axis_tensor.flat<int64_t>()(0);
+    }
+    if (axis < 0) axis += output_shape->dims();
+    if (axis < 0 || axis >= output_shape->dims()) return false;
+    // The slices are contiguous iff all the dimensions before the axis are 1.
+    for (int d = 0; d < axis; ++d) {
+      if (output_shape->dim_size(d) != 1) return false;
+    }
+    for (int i = 0; i < num_inputs; ++i) {
+      if (!PartialTensorShape(input_props[i].shape()).IsFullyDefined()) {
+        return false;
+      }
+      TensorShape input_shape(input_props[i].shape());
+      // ScopedAllocator pads every field to kAllocatorAlignment, which would
+      // leave gaps between the slices.
+      const int64_t num_bytes =
+          input_shape.num_elements() * DataTypeSize(*dtype);
+      if (num_bytes == 0 || num_bytes % Allocator::kAllocatorAlignment != 0) {
+        return false;
+      }
+      input_shapes->push_back(std::move(input_shape));
+    }
+    return true;
+  }
+
+  // Returns true if output `output_slot` of `producer` can be allocated
+  // directly in the output of `concat`.
+  bool CanAllocateInOutput(ScopedAllocatorOptimizer* sa_opti,
+                           const NodeDef& producer, int output_slot,
+                           const NodeDef& concat) {
+    if (IsConstant(producer) || IsArg(producer) || IsControlFlow(producer) ||
+        producer.device() != concat.device() ||
+        sa_opti->nodes_to_preserve().count(producer.name()) > 0) {
+      return false;
+    }
+    if (!graph_properties_->HasOutputProperties(producer.name())) {
+      return false;
+    }
+    const auto& output_props =
+        graph_properties_->GetOutputProperties(producer.name());
+    if (output_slot >= static_cast<int>(output_props.size()) ||
+        IsRefType(output_props[output_slot].dtype())) {
+      return false;
+    }
+    // An output can only be allocated from one ScopedAllocator.
+    std::vector<int32> scope_ids;
+    if (GetNodeAttr(producer, kScopedAllocatorAttrName, &scope_ids).ok()) {
+      for (size_t i = 0; i + 1 < scope_ids.size(); i += 2) {
+        if (scope_ids[i] == output_slot) return false;
+      }
+    }
+    // The output must be consumed only once, by `concat`.
+    int num_uses = 0;
+    for (const NodeDef* consumer :
+         sa_opti->node_map()->GetOutputs(producer.name())) {
+      for (const string& input : consumer->input()) {
+        int position = 0;
+        if (ParseNodeName(input, &position) == producer.name() &&
+            position == output_slot) {
+          ++num_uses;
+        }
+      }
+    }
+    return num_uses == 1;
+  }
+
+  Status RewriteConcat(ScopedAllocatorOptimizer* sa_opti,
+                       int64_t invocation_count, GraphDef* graph,
+                       NodeDef* concat, bool* applied) {
+    NodeMap* node_map = sa_opti->node_map();
+    DataType dtype;
+    TensorShape output_shape;
+    std::vector<TensorShape> input_shapes;
+    if (!IsContiguousConcat(node_map, *concat, &dtype, &output_shape,
+                            &input_shapes)) {
+      VLOG(1) << "Not eliding " << concat->name()
+              << ": its inputs are not contiguous slices of its output";
+      return OkStatus();
+    }
+    const int num_inputs = input_shapes.size();
+    std::vector<InputDesc> inputs;
+    std::vector<bool> needs_copy;
+    for (int i = 0; i < num_inputs; ++i) {
+      int output_slot = 0;
+      ParseNodeName(concat->input(i), &output_slot);
+      NodeDef* producer = node_map->GetNode(concat->input(i));
+      if (producer == nullptr) {
+        return errors::Internal("Did not find node ", concat->input(i));
+      }
+      inputs.emplace_back(producer, output_slot, concat);
+      needs_copy.push_back(
+          !CanAllocateInOutput(sa_opti, *producer, output_slot, *concat));
+    }
+    if (std::all_of(needs_copy.begin(), needs_copy.end(),
+                    [](bool b) { return b; })) {
+      VLOG(1) << "Not eliding " << concat->name()
+              << ": none of its inputs can be allocated in its output";
+      return OkStatus();
+    }
+    VLOG(1) << "Eliding " << concat->name();
+
+    for (int i = 0; i < num_inputs; ++i) {
+      if (!needs_copy[i]) continue;
+      int unique_id;
+      LOG_WARNING_AND_RETURN_IF_ERROR(sa_opti->NewIdentityId(&unique_id));
+      const string identity_name = strings::StrCat(
+          "scoped_allocator_identity_", unique_id, "_", invocation_count);
+      NodeDefBuilder identity_builder(identity_name, "Identity");
+      identity_builder.Device(concat->device());
+      identity_builder.Attr("T", dtype);
+      identity_builder.Input(NodeDefBuilder::NodeOut(
+          inputs[i].from_node_def->name(), inputs[i].output_slot, dtype));
+      NodeDef* identity = graph->add_node();
+      LOG_WARNING_AND_RETURN_IF_ERROR(identity_builder.Finalize(identity));
+      node_map->AddNode(identity_name, identity);
+      node_map->AddOutput(inputs[i].from_node_def->name(), identity_name);
+      inputs[i] = InputDesc(identity, 0, concat);
+    }
+
+    const int sa_id = sa_opti->NewScopedAllocatorId(num_inputs);
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    std::vector<ScopedAllocator::Field> sa_fields;
+    const int64_t num_bytes = ScopedAllocatorMgr::PopulateFields(
+        0 /*scope_id*/, input_shapes, dtype, &sa_fields);
+    const TensorShape sa_shape({num_bytes / DataTypeSize(dtype)});
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, {concat}, concat->device(), dtype, sa_id,
+        sa_name, input_shapes, inputs, sa_shape));
+
+    const string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id,
+                                            "_", invocation_count);
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(concat->device());
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", num_inputs);
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    for (const InputDesc& input : inputs) {
+      sac_inputs.emplace_back(input.from_node_def->name(), input.output_slot,
+                              dtype);
+    }
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    for (const string& input : sac_node->input()) {
+      node_map->AddOutput(NodeName(input), sac_name);
+    }
+
+    // Replace the concat by an Identity of the _ScopedAllocatorConcat, which
+    // is stateful and so needs a unique name.  The control inputs and the
+    // allocation of its output, if the concat is itself the input of an
+    // elided concat, stay on the Identity.
+    std::vector<string> control_inputs;
+    for (const string& input : concat->input()) {
+      node_map->RemoveOutput(NodeName(input), concat->name());
+      if (IsControlInput(input)) control_inputs.push_back(input);
+    }
+    concat->set_op("Identity");
+    concat->clear_input();
+    concat->add_input(sac_name);
+    for (const string& input : control_inputs) concat->add_input(input);
+    for (const string& input : concat->input()) {
+      node_map->AddOutput(NodeName(input), concat->name());
+    }
+    std::vector<string> attrs_to_remove;
+    for (const auto& attr : concat->attr()) {
+      if (attr.first != kScopedAllocatorAttrName) {
+        attrs_to_remove.push_back(attr.first);
+      }
+    }
+    for (const string& attr : attrs_to_remove) {
+      concat->mutable_attr()->erase(attr);
+    }
+    AddNodeAttr("T", dtype, concat);
+    *applied = true;
+    return OkStatus();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -904,7 +1172,8 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] =
+          op_name == "ConcatV2" || op_name == "Pack" ? concat_rewriter : r;
     }
   }
 }
@@ -1110,6 +1379,16 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesEachNode()) {
+          for (NodeDef* node : it.second) {
+            bool applied = false;
+            status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                       {node}, &applied);
+            if (!status.ok()) break;
+          }
+          if (!status.ok()) break;
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
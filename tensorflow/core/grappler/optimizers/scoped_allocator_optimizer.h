@@ -72,6 +72,11 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   NodeMap* node_map() { return node_map_.get(); }
 
+  // Nodes that cannot be removed from the graph, typically fetch nodes.
+  const std::unordered_set<string>& nodes_to_preserve() const {
+    return nodes_to_preserve_;
+  }
+
   const absl::flat_hash_set<string>& repeated_outputs() {
     return repeated_outputs_;
   }
@@ -93,6 +98,10 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // If true, Rewrite is called with each node of the op on its own instead
+    // of with groups of parallel nodes.
+    virtual bool RewritesEachNode() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
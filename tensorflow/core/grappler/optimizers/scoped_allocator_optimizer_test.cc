@@ -279,11 +279,54 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     }
   }
 
+  // Constructs the following graph, where a, b and c are [rows, cols] Const
+  // ops, and concat is a ConcatV2 on `axis`, or a Pack if `pack` is true.
+  //
+  // s1 only feeds concat so it can be allocated in its output, while s2 and c
+  // have to be copied into it.
+  /*
+        a    b    c
+         \  / \  /|
+          s1   s2 |
+           \  /|  |
+           concat n2
+             |
+            out
+  */
+  void BuildConcatGraph(GraphDef* graph_def, int rows, int cols, int axis,
+                        bool pack) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    std::vector<float> a_values, b_values, c_values;
+    for (int i = 0; i < rows * cols; ++i) {
+      a_values.push_back(i);
+      b_values.push_back(-2 * i);
+      c_values.push_back(i % 7);
+    }
+    Output a = ops::Const<float>(s.WithOpName("a"), a_values, {rows, cols});
+    Output b = ops::Const<float>(s.WithOpName("b"), b_values, {rows, cols});
+    Output c = ops::Const<float>(s.WithOpName("c"), c_values, {rows, cols});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, c);
+    Output n2 = ops::Neg(s.WithOpName("n2"), s2);
+    Output concat;
+    if (pack) {
+      concat = ops::Stack(s.WithOpName("concat"), {s1, s2, c},
+                          ops::Stack::Axis(axis));
+    } else {
+      concat = ops::Concat(s.WithOpName("concat"), {s1, s2, c}, axis);
+    }
+    Output out = ops::Abs(s.WithOpName("out"), concat);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   // Invokes ScopedAllocatorOptimizer on `graph_def`, then executes it and
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const std::vector<string>& enable_ops = {"Abs"}) {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +340,9 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    for (const string& op : enable_ops) {
+      rwcfg->mutable_scoped_allocator_opts()->add_enable_op(op);
+    }
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +641,108 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewriteOnly) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*rows=*/4, /*cols=*/16, /*axis=*/0,
+                   /*pack=*/false);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  // The concat is now an Identity of a _ScopedAllocatorConcat of the backing
+  // tensor, s1 itself and copies of s2 and c.
+  NodeMap node_map(&optimized_graph);
+  NodeDef* concat = nullptr;
+  GetNode(&node_map, "concat", &concat);
+  EXPECT_EQ(concat->op(), "Identity");
+  ASSERT_EQ(concat->input_size(), 1);
+  NodeDef* sac = nullptr;
+  GetNode(&node_map, concat->input(0), &sac);
+  EXPECT_EQ(sac->op(), "_ScopedAllocatorConcat");
+  EXPECT_TRUE(sac->attr().at("reshape").b());
+  EXPECT_EQ(TensorShape(sac->attr().at("shape").shape()),
+            TensorShape({12, 16}));
+  ASSERT_EQ(sac->input_size(), 4);
+  NodeDef* sa = nullptr;
+  GetNode(&node_map, sac->input(0), &sa);
+  EXPECT_EQ(sa->op(), "_ScopedAllocator");
+  EXPECT_EQ(sac->input(1), "s1");
+  for (int i = 2; i < 4; ++i) {
+    NodeDef* identity = nullptr;
+    GetNode(&node_map, sac->input(i), &identity);
+    EXPECT_TRUE(IsIdentity(*identity));
+    EXPECT_EQ(identity->input(0), i == 2 ? "s2" : "c");
+  }
+  for (const string& name :
+       std::vector<string>{"s1", sac->input(2), sac->input(3)}) {
+    EXPECT_EQ(ValidateSAControlInput(&optimized_graph, &node_map, name), sa);
+    NodeDef* input = nullptr;
+    GetNode(&node_map, name, &input);
+    EXPECT_TRUE(HasNodeAttr(*input, "_scoped_allocator"));
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*rows=*/4, /*cols=*/16, /*axis=*/0,
+                   /*pack=*/false);
+  const std::vector<Tensor> expected = EvaluateNodes(graph_def, {"out", "n2"});
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"out:0", "n2:0"}, &outputs,
+               /*enable_ops=*/{"ConcatV2"});
+  test::ExpectTensorEqual<float>(outputs[0], expected[0]);
+  test::ExpectTensorEqual<float>(outputs[1], expected[1]);
+}
+
+// The slices of a concat on an inner axis are contiguous if all the outer
+// dimensions are 1.
+TEST_F(ScopedAllocatorOptimizerTest, ConcatOnInnerAxisExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*rows=*/1, /*cols=*/32, /*axis=*/-1,
+                   /*pack=*/false);
+  const std::vector<Tensor> expected = EvaluateNodes(graph_def, {"out", "n2"});
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"out:0", "n2:0"}, &outputs,
+               /*enable_ops=*/{"ConcatV2"});
+  test::ExpectTensorEqual<float>(outputs[0], expected[0]);
+  test::ExpectTensorEqual<float>(outputs[1], expected[1]);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, PackExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*rows=*/4, /*cols=*/16, /*axis=*/0,
+                   /*pack=*/true);
+  const std::vector<Tensor> expected = EvaluateNodes(graph_def, {"out", "n2"});
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"out:0", "n2:0"}, &outputs,
+               /*enable_ops=*/{"Pack"});
+  test::ExpectTensorEqual<float>(outputs[0], expected[0]);
+  test::ExpectTensorEqual<float>(outputs[1], expected[1]);
+}
+
+// Concats whose inputs are not contiguous slices of their output, or would be
+// padded by the ScopedAllocator, are left alone.
+TEST_F(ScopedAllocatorOptimizerTest, NonContiguousConcatNotRewritten) {
+  // {rows, cols, axis}
+  for (const std::vector<int>& c : std::vector<std::vector<int>>{
+           {4, 16, 1}, {3, 5, 0}}) {
+    GrapplerItem item;
+    BuildConcatGraph(&item.graph, c[0], c[1], c[2], /*pack=*/false);
+    ScopedAllocatorOptions opts;
+    opts.add_enable_op("ConcatV2");
+    ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+    GraphDef optimized_graph;
+    TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+    NodeMap node_map(&optimized_graph);
+    NodeDef* concat = nullptr;
+    GetNode(&node_map, "concat", &concat);
+    EXPECT_EQ(concat->op(), "ConcatV2")
+        << "[" << c[0] << ", " << c[1] << "] inputs, axis " << c[2];
+  }
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
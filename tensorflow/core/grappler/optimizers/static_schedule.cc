@@ -16,8 +16,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 
 #include <deque>
+#include <queue>
+#include <tuple>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
@@ -199,5 +203,108 @@ Status EstimateRequiredTimes(
   return OkStatus();
 }
 
+Status EstimateMemoryAwareSchedule(
+    const GrapplerItem& item,
+    std::unordered_map<const NodeDef*, int>* schedule) {
+  const int num_nodes = item.graph.node_size();
+  std::unordered_map<string, int> name_map;
+  for (int i = 0; i < num_nodes; ++i) {
+    name_map[item.graph.node(i).name()] = i;
+  }
+
+  std::vector<int> pending_inputs(num_nodes);
+  std::vector<int> remaining_consumers(num_nodes, 0);
+  std::vector<std::vector<int>> fanouts(num_nodes);
+  std::vector<std::vector<int>> data_fanins(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = item.graph.node(i);
+    // Merge nodes are processed as soon as one of the input becomes available.
+    pending_inputs[i] = IsMerge(node) ? std::min(node.input_size(), 1)
+                                      : node.input_size();
+    for (const string& input : node.input()) {
+      auto it = name_map.find(NodeName(input));
+      if (it == name_map.end()) {
+        return errors::InvalidArgument(
+            strings::StrCat("Unknown input node ", input));
+      }
+      fanouts[it->second].push_back(i);
+      if (!IsControlInput(input)) {
+        data_fanins[i].push_back(it->second);
+        ++remaining_consumers[it->second];
+      }
+    }
+  }
+  name_map.clear();
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(
+      properties.InferStatically(/*assume_valid_feeds=*/true,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false));
+  std::vector<int64_t> output_bytes(num_nodes, 0);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = item.graph.node(i);
+    if (!properties.HasOutputProperties(node.name())) continue;
+    for (const auto& output : properties.GetOutputProperties(node.name())) {
+      const PartialTensorShape shape(output.shape());
+      if (!shape.IsFullyDefined()) continue;
+      output_bytes[i] += shape.num_elements() * DataTypeSize(output.dtype());
+    }
+  }
+
+  // Ready nodes are keyed by the net amount of memory running them releases at
+  // the time they become ready, with ties broken in graph order.
+  using ReadyNode = std::tuple<int64_t, int>;
+  auto later = [](const ReadyNode& a, const ReadyNode& b) {
+    if (std::get<0>(a) != std::get<0>(b)) {
+      return std::get<0>(a) < std::get<0>(b);
+    }
+    return std::get<1>(a) > std::get<1>(b);
+  };
+  std::priority_queue<ReadyNode, std::vector<ReadyNode>, decltype(later)>
+      ready_nodes(later);
+  auto push_ready = [&](int i) {
+    int64_t freed_bytes = 0;
+    for (int fanin : data_fanins[i]) {
+      if (remaining_consumers[fanin] == 1) freed_bytes += output_bytes[fanin];
+    }
+    ready_nodes.emplace(freed_bytes - output_bytes[i], i);
+  };
+  for (int i = 0; i < num_nodes; ++i) {
+    if (pending_inputs[i] == 0) push_ready(i);
+  }
+
+  std::vector<bool> scheduled(num_nodes, false);
+  int order = 0;
+  while (!ready_nodes.empty()) {
+    const int i = std::get<1>(ready_nodes.top());
+    ready_nodes.pop();
+    if (scheduled[i]) continue;
+    scheduled[i] = true;
+    (*schedule)[&item.graph.node(i)] = order++;
+
+    for (int fanin : data_fanins[i]) {
+      --remaining_consumers[fanin];
+    }
+    for (int fanout : fanouts[i]) {
+      int pending = pending_inputs[fanout];
+      if (pending == 0) {
+        // Already processed. Avoid going through loops more than once.
+        continue;
+      } else if (pending == 1) {
+        push_ready(fanout);
+      }
+      pending_inputs[fanout]--;
+    }
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (!scheduled[i]) {
+      (*schedule)[&item.graph.node(i)] = order++;
+    }
+  }
+  return OkStatus();
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -44,6 +44,16 @@ Status EstimateRequiredTimes(
         execution_times,
     std::unordered_map<const NodeDef*, Costs::NanoSeconds>* required_times);
 
+// Compute a topological order of the nodes in the graph that greedily keeps
+// the amount of live memory low: among the nodes that are ready to run, the
+// ones that free the most memory (inputs they are the last consumer of, minus
+// the outputs they allocate) are scheduled first. Tensor sizes are inferred
+// statically; tensors of unknown size are assumed to be empty. Nodes that
+// can't be reached (e.g. in malformed loops) are appended in graph order.
+Status EstimateMemoryAwareSchedule(
+    const GrapplerItem& item,
+    std::unordered_map<const NodeDef*, int>* schedule);
+
 }  // namespace grappler
 }  // end namespace tensorflow
 
@@ -196,6 +196,43 @@ TEST_F(StaticScheduleTest, RequiredTimes) {
                                       "Sign_2", "Sign_3", "y"}));
 }
 
+TEST_F(StaticScheduleTest, MemoryAwareSchedule) {
+  // Two independent branches that each produce a large tensor and immediately
+  // reduce it to a scalar.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  Output dims = ops::Const(s.WithOpName("dims"), {100, 100});
+  Output value = ops::Const(s.WithOpName("value"), 1.0f);
+  Output axes = ops::Const(s.WithOpName("axes"), {0, 1});
+  Output big1 = ops::Fill(s.WithOpName("big1"), dims, value);
+  Output big2 = ops::Fill(s.WithOpName("big2"), dims, value);
+  Output small1 = ops::Sum(s.WithOpName("small1"), big1, axes);
+  Output small2 = ops::Sum(s.WithOpName("small2"), big2, axes);
+  Output out = ops::AddN(s.WithOpName("out"), {small1, small2});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  std::unordered_map<const NodeDef*, int> schedule;
+  TF_EXPECT_OK(EstimateMemoryAwareSchedule(item, &schedule));
+  EXPECT_EQ(item.graph.node_size(), schedule.size());
+
+  std::map<int, std::string> ordered_nodes;
+  for (const auto& node_order : schedule) {
+    ordered_nodes[node_order.second] = node_order.first->name();
+  }
+  std::vector<std::string> ordered_node_names;
+  for (const auto& order_node : ordered_nodes) {
+    ordered_node_names.push_back(order_node.second);
+  }
+
+  // The smallest constant goes first. Each large tensor is then consumed
+  // before the next one is produced, so at most one of them is live at a time.
+  EXPECT_EQ(ordered_node_names,
+            (std::vector<std::string>{"value", "dims", "axes", "big1", "small1",
+                                      "big2", "small2", "out"}));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -54,6 +54,7 @@ constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
 constexpr char kFullBatchSchedulingBoostMicros[] =
     "_full_batch_scheduling_boost_micros";
+constexpr char kBatchLatencySloMicrosAttr[] = "_batch_latency_slo_micros";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -178,17 +179,19 @@ class BatchResource : public serving::BatchResourceBase {
       int32_t max_batch_size, int32_t batch_timeout_micros,
       int32_t max_enqueued_batches,
       const std::vector<int32>& allowed_batch_sizes,
-      std::unique_ptr<BatchResource>* resource) {
+      int64_t latency_slo_micros, std::unique_ptr<BatchResource>* resource) {
     std::shared_ptr<AdaptiveBatcherT> batcher;
     TF_RETURN_IF_ERROR(AdaptiveBatcherT::Create(
         adaptive_shared_batch_scheduler_options, &batcher));
 
-    resource->reset(new BatchResource(
-        has_process_batch_function, std::move(batcher),
+    AdaptiveBatcherT::QueueOptions batcher_queue_options =
         GetAdaptiveBatcherQueueOptions(
             max_batch_size, batch_timeout_micros, max_enqueued_batches,
             true /* enable large batch split */, allowed_batch_sizes,
-            /*disable_padding=*/false),
+            /*disable_padding=*/false);
+    batcher_queue_options.latency_slo_micros = latency_slo_micros;
+    resource->reset(new BatchResource(
+        has_process_batch_function, std::move(batcher), batcher_queue_options,
         allowed_batch_sizes));
     return OkStatus();
   }
@@ -371,6 +374,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           /*has_process_batch_function=*/true,
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
+          adaptive_batch_scheduler_options_->latency_slo_micros,
           &new_resource));
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
@@ -563,6 +567,15 @@ void BatchFunctionKernel::SetAdaptiveBatchSchedulerOptions(
                                  &options.full_batch_scheduling_boost_micros));
   }
 
+  if (c->HasAttr(kBatchLatencySloMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kBatchLatencySloMicrosAttr,
+                                 &options.latency_slo_micros));
+    OP_REQUIRES(c, options.latency_slo_micros >= 0,
+                errors::InvalidArgument(
+                    kBatchLatencySloMicrosAttr, " can't be negative; was ",
+                    options.latency_slo_micros));
+  }
+
   // At this point, the batch kernel is configured to use adaptive scheduling.
   // To validate or return error at kernel construction time, invokes
   // `GetOrCreateBatchThreadsPool` and validates returned `thread_pool` is
@@ -106,6 +106,9 @@ class BatchFunctionKernel : public AsyncOpKernel {
     int32 max_in_flight_batches_limit = kMaxInflightBatches;
     int32 batches_to_average_over = kBatchesToAverageOver;
     int64 full_batch_scheduling_boost_micros = -1;
+    // If positive, the batch timeout and batch size are tuned online to keep
+    // average batch latency within this SLO.
+    int64 latency_slo_micros = 0;
   };
   absl::optional<AdaptiveBatchSchedulerOptions>
       adaptive_batch_scheduler_options_ = absl::nullopt;
@@ -47,6 +47,8 @@ class ASBSBatch;
 
 template <typename TaskType>
 class ASBSQueue;
+
+class ASBSLatencyController;
 }  // namespace internal
 
 // Shared batch scheduler designed to minimize latency. The scheduler keeps
@@ -171,6 +173,20 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // If positive, the queue tunes its batch timeout and the size at which it
+    // closes batches online, so that the average time from the arrival of a
+    // batch's first task until the batch finishes processing stays within this
+    // latency SLO. `batch_timeout_micros` is the initial timeout, and
+    // `max_batch_size` bounds the batch size.
+    int64_t latency_slo_micros = 0;
+    // Number of processed batches between adjustments made for
+    // `latency_slo_micros`.
+    int64_t latency_slo_batches_to_average_over = 16;
+    // Batch sizes the model is padded to. If non-empty, the batch size tuned
+    // for `latency_slo_micros` is rounded down to one of them, so that tuned
+    // batches need no padding.
+    std::vector<int32> allowed_batch_sizes;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -291,6 +307,104 @@ class AdaptiveSharedBatchScheduler
 // Implementation details follow. API users need not read.
 
 namespace internal {
+// Tunes the batch timeout and target batch size of a queue to meet a latency
+// SLO, from the queueing delay and processing time of its batches.
+//
+// Every `batches_to_average_over` batches, the average batch latency is
+// compared with the SLO. Above it, the timeout and the target batch size are
+// cut multiplicatively, so the controller recovers quickly from load spikes.
+// Comfortably below it, they grow additively, trading latency headroom for
+// fuller batches. The timeout is also capped so that, with the average
+// processing time, a batch still fits within the SLO.
+class ASBSLatencyController {
+ public:
+  ASBSLatencyController(int64_t latency_slo_micros,
+                        int64_t initial_batch_timeout_micros,
+                        int max_batch_size,
+                        std::vector<int32> allowed_batch_sizes,
+                        int64_t batches_to_average_over)
+      : latency_slo_micros_(latency_slo_micros),
+        max_batch_size_(max_batch_size),
+        allowed_batch_sizes_(std::move(allowed_batch_sizes)),
+        batches_to_average_over_(batches_to_average_over),
+        batch_timeout_micros_(
+            std::min(initial_batch_timeout_micros, latency_slo_micros)),
+        target_batch_size_(max_batch_size) {}
+
+  // Returns the timeout to give a new batch.
+  int64_t batch_timeout_micros() const {
+    mutex_lock l(mu_);
+    return static_cast<int64_t>(batch_timeout_micros_);
+  }
+
+  // Returns the size at which a batch should be closed.
+  int target_batch_size() const {
+    mutex_lock l(mu_);
+    const int target = std::max(1, static_cast<int>(target_batch_size_));
+    // Round down to an allowed batch size, if there is one this small.
+    int rounded = 0;
+    for (int32 allowed : allowed_batch_sizes_) {
+      if (allowed <= target) rounded = std::max<int>(rounded, allowed);
+    }
+    return rounded > 0 ? rounded : target;
+  }
+
+  // Records a batch that waited `queueing_micros` from its creation until it
+  // started processing, and then took `processing_micros` to process.
+  void RecordBatch(int64_t queueing_micros, int64_t processing_micros) {
+    mutex_lock l(mu_);
+    latency_sum_micros_ += queueing_micros + processing_micros;
+    processing_sum_micros_ += processing_micros;
+    if (++batch_count_ < batches_to_average_over_) return;
+
+    const double avg_latency_micros =
+        static_cast<double>(latency_sum_micros_) / batch_count_;
+    const double avg_processing_micros =
+        static_cast<double>(processing_sum_micros_) / batch_count_;
+    if (avg_latency_micros > latency_slo_micros_) {
+      batch_timeout_micros_ *= kDecreaseMultiplier;
+      target_batch_size_ *= kDecreaseMultiplier;
+    } else if (avg_latency_micros < kHeadroom * latency_slo_micros_) {
+      batch_timeout_micros_ += kTimeoutStepFraction * latency_slo_micros_;
+      target_batch_size_ += std::max(1.0, kBatchSizeStepFraction *
+                                              max_batch_size_);
+    }
+    batch_timeout_micros_ =
+        std::min(batch_timeout_micros_,
+                 std::max(0.0, latency_slo_micros_ - avg_processing_micros));
+    target_batch_size_ =
+        std::max(1.0, std::min(target_batch_size_,
+                               static_cast<double>(max_batch_size_)));
+    batch_count_ = 0;
+    latency_sum_micros_ = 0;
+    processing_sum_micros_ = 0;
+  }
+
+ private:
+  // Multiplier applied to the timeout and target batch size when over the SLO.
+  constexpr static double kDecreaseMultiplier = 0.5;
+  // Fraction of the SLO below which the timeout and target batch size grow.
+  constexpr static double kHeadroom = 0.8;
+  // Timeout increase, as a fraction of the SLO.
+  constexpr static double kTimeoutStepFraction = 0.05;
+  // Target batch size increase, as a fraction of the maximum batch size.
+  constexpr static double kBatchSizeStepFraction = 0.0625;  // 1/16
+
+  const double latency_slo_micros_;
+  const int max_batch_size_;
+  const std::vector<int32> allowed_batch_sizes_;
+  const int64_t batches_to_average_over_;
+
+  mutable mutex mu_;
+  double batch_timeout_micros_ TF_GUARDED_BY(mu_);
+  double target_batch_size_ TF_GUARDED_BY(mu_);
+  int64_t batch_count_ TF_GUARDED_BY(mu_) = 0;
+  int64_t latency_sum_micros_ TF_GUARDED_BY(mu_) = 0;
+  int64_t processing_sum_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ASBSLatencyController);
+};
+
 // Consolidates tasks into batches, passing them off to the
 // AdaptiveSharedBatchScheduler for processing.
 template <typename TaskType>
@@ -325,12 +439,23 @@ class ASBSQueue : public BatchScheduler<TaskType> {
   // Number of size 1 tasks which could currently be scheduled without failing.
   size_t SchedulingCapacityLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Size at which the current batch is closed.
+  int TargetBatchSize() const {
+    return latency_controller_ == nullptr
+               ? options_.max_batch_size
+               : std::min(options_.max_batch_size,
+                          latency_controller_->target_batch_size());
+  }
+
   // Returns uint64 one greater than was returned by the previous call.
   // Context id is reused after std::numeric_limits<uint64>::max is exhausted.
   static uint64 NewTraceMeContextIdForBatch();
 
   std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
+  // Set if options_.latency_slo_micros is positive. Shared with the batches of
+  // this queue, which may outlive it.
+  const std::shared_ptr<ASBSLatencyController> latency_controller_;
   // Owned by scheduler_.
   ASBSBatch<TaskType>* current_batch_ TF_GUARDED_BY(mu_) = nullptr;
   int64_t num_enqueued_batches_ TF_GUARDED_BY(mu_) = 0;
@@ -344,11 +469,13 @@ template <typename TaskType>
 class ASBSBatch : public Batch<TaskType> {
  public:
   ASBSBatch(ASBSQueue<TaskType>* queue, int64_t creation_time_micros,
-            int64_t batch_timeout_micros, uint64 traceme_context_id)
+            int64_t batch_timeout_micros, uint64 traceme_context_id,
+            std::shared_ptr<ASBSLatencyController> latency_controller = nullptr)
       : queue_(queue),
         creation_time_micros_(creation_time_micros),
         schedulable_time_micros_(creation_time_micros + batch_timeout_micros),
-        traceme_context_id_(traceme_context_id) {}
+        traceme_context_id_(traceme_context_id),
+        latency_controller_(std::move(latency_controller)) {}
 
   ~ASBSBatch() override {}
 
@@ -360,11 +487,17 @@ class ASBSBatch : public Batch<TaskType> {
 
   uint64 traceme_context_id() const { return traceme_context_id_; }
 
+  // The latency controller of the queue, or null if it has none.
+  const std::shared_ptr<ASBSLatencyController>& latency_controller() const {
+    return latency_controller_;
+  }
+
  private:
   ASBSQueue<TaskType>* queue_;
   const int64_t creation_time_micros_;
   const int64_t schedulable_time_micros_;
   const uint64 traceme_context_id_;
+  const std::shared_ptr<ASBSLatencyController> latency_controller_;
   TF_DISALLOW_COPY_AND_ASSIGN(ASBSBatch);
 };
 }  // namespace internal
@@ -464,6 +597,17 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
           options.max_batch_size);
     }
   }
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros can't be negative; was ",
+        options.latency_slo_micros);
+  }
+  if (options.latency_slo_micros > 0 &&
+      options.latency_slo_batches_to_average_over < 1) {
+    return errors::InvalidArgument(
+        "latency_slo_batches_to_average_over must be positive; was ",
+        options.latency_slo_batches_to_average_over);
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
@@ -639,9 +783,17 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       profiler::ContextType::kAdaptiveSharedBatchScheduler,
       batch->traceme_context_id());
   const int64_t start_time = batch->creation_time_micros();
+  // The callback takes ownership of the batch.
+  const std::shared_ptr<internal::ASBSLatencyController> latency_controller =
+      batch->latency_controller();
+  const int64_t processing_start_time = GetEnv()->NowMicros();
   callback(std::unique_ptr<Batch<TaskType>>(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
+  if (latency_controller != nullptr) {
+    latency_controller->RecordBatch(processing_start_time - start_time,
+                                    end_time - processing_start_time);
+  }
   mutex_lock l(mu_);
   if (is_express) {
     in_flight_express_batches_--;
@@ -707,7 +859,15 @@ template <typename TaskType>
 ASBSQueue<TaskType>::ASBSQueue(
     std::shared_ptr<AdaptiveSharedBatchScheduler<TaskType>> scheduler,
     const QueueOptions& options)
-    : scheduler_(scheduler), options_(options) {}
+    : scheduler_(scheduler),
+      options_(options),
+      latency_controller_(
+          options.latency_slo_micros > 0
+              ? std::make_shared<ASBSLatencyController>(
+                    options.latency_slo_micros, options.batch_timeout_micros,
+                    options.max_batch_size, options.allowed_batch_sizes,
+                    options.latency_slo_batches_to_average_over)
+              : nullptr) {}
 
 template <typename TaskType>
 ASBSQueue<TaskType>::~ASBSQueue() {
@@ -783,7 +943,10 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         // are processed in the same batch and should share traceme_context_id.
         current_batch_ = new ASBSBatch<TaskType>(
             this, scheduler_->GetEnv()->NowMicros(),
-            options_.batch_timeout_micros, NewTraceMeContextIdForBatch());
+            latency_controller_ != nullptr
+                ? latency_controller_->batch_timeout_micros()
+                : options_.batch_timeout_micros,
+            NewTraceMeContextIdForBatch(), latency_controller_);
         new_batches.push_back(current_batch_);
       }
 
@@ -803,8 +966,7 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       bool reached_max_tasks =
           (options_.max_tasks_per_batch.has_value() &&
            current_batch_->num_tasks() >= options_.max_tasks_per_batch.value());
-      if (current_batch_->size() == options_.max_batch_size ||
-          reached_max_tasks) {
+      if (current_batch_->size() >= TargetBatchSize() || reached_max_tasks) {
         current_batch_->Close();
         closed_batch = true;
         current_batch_ = nullptr;
@@ -516,6 +516,57 @@ TEST(AdaptiveSharedBatchSchedulerTest, MaxTasksPerBatch) {
     if (processed_batches == 3) break;
   }
 }
+
+TEST(AdaptiveSharedBatchSchedulerTest, BadLatencySloOptions) {
+  auto queue_callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(AdaptiveSharedBatchScheduler<FakeTask>::Create({}, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.latency_slo_micros = -1;
+  EXPECT_FALSE(
+      scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.latency_slo_micros = 1000;
+  queue_options.latency_slo_batches_to_average_over = 0;
+  EXPECT_FALSE(
+      scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options.latency_slo_batches_to_average_over = 1;
+  TF_EXPECT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, LatencyControllerTracksSlo) {
+  internal::ASBSLatencyController controller(
+      /*latency_slo_micros=*/1000, /*initial_batch_timeout_micros=*/400,
+      /*max_batch_size=*/64, /*allowed_batch_sizes=*/{8, 16, 32, 64},
+      /*batches_to_average_over=*/2);
+  EXPECT_EQ(controller.batch_timeout_micros(), 400);
+  EXPECT_EQ(controller.target_batch_size(), 64);
+
+  // Adjustments are only made once per two batches.
+  controller.RecordBatch(400, 1100);
+  EXPECT_EQ(controller.batch_timeout_micros(), 400);
+  EXPECT_EQ(controller.target_batch_size(), 64);
+
+  // Over the SLO: timeout and batch size are halved.
+  controller.RecordBatch(400, 1100);
+  EXPECT_EQ(controller.batch_timeout_micros(), 0);
+  EXPECT_EQ(controller.target_batch_size(), 32);
+  controller.RecordBatch(0, 1200);
+  controller.RecordBatch(0, 1200);
+  EXPECT_EQ(controller.batch_timeout_micros(), 0);
+  EXPECT_EQ(controller.target_batch_size(), 16);
+
+  // Well under the SLO: timeout and batch size grow additively, with the
+  // batch size rounded down to an allowed size.
+  controller.RecordBatch(0, 100);
+  controller.RecordBatch(0, 100);
+  EXPECT_EQ(controller.batch_timeout_micros(), 50);
+  EXPECT_EQ(controller.target_batch_size(), 16);
+  for (int i = 0; i < 8; ++i) controller.RecordBatch(0, 100);
+  EXPECT_EQ(controller.batch_timeout_micros(), 250);
+  EXPECT_EQ(controller.target_batch_size(), 32);
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
@@ -423,6 +423,7 @@ BatchResourceBase::GetAdaptiveBatcherQueueOptions(
   } else {
     batcher_queue_options.max_batch_size = *allowed_batch_sizes.rbegin();
   }
+  batcher_queue_options.allowed_batch_sizes = allowed_batch_sizes;
 
   if (enable_large_batch_splitting) {
     batcher_queue_options.split_input_task_func =
@@ -562,15 +563,21 @@ Status BatchResourceBase::ConcatInputTensors(
           // In this context, Concat can be further optimized to get rid of
           // some (probably all) memcpy when input tensors are slices of
           // another copy.
-          std::vector<Tensor> to_concatenate;
-          to_concatenate.reserve(output->size());
-          for (int j = 0; j < output->size(); ++j) {
-            to_concatenate.push_back(std::move((*output)[j][i]));
-          }
-          const auto concat_status =
-              Concat(op_kernel_context, to_concatenate, &output_tensor);
-          if (!concat_status.ok()) {
-            status->Update(concat_status);
+          if (output->size() == 1) {
+            // The task went to a single batch as a whole (e.g. when the open
+            // batch was full), so its output needs no copy.
+            output_tensor = std::move((*output)[0][i]);
+          } else {
+            std::vector<Tensor> to_concatenate;
+            to_concatenate.reserve(output->size());
+            for (int j = 0; j < output->size(); ++j) {
+              to_concatenate.push_back(std::move((*output)[j][i]));
+            }
+            const auto concat_status =
+                Concat(op_kernel_context, to_concatenate, &output_tensor);
+            if (!concat_status.ok()) {
+              status->Update(concat_status);
+            }
           }
 
           op_kernel_context->set_output(i, std::move(output_tensor));
@@ -21,6 +21,7 @@ limitations under the License.
 #include <deque>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -116,6 +117,18 @@ class SharedBatchScheduler
   using BatchTaskUniqueptr = std::unique_ptr<Batch<TaskType>>;
   using BatchUniquePtr =
       absl::variant<BatchTaskUniqueptr, BatchTaskHandleUniquePtr>;
+  // Limits on the batches processed concurrently on one device, e.g. a GPU
+  // shared by the queues of several models or model versions.
+  struct DeviceCapacity {
+    // The maximum number of batches processed concurrently on the device, or
+    // 0 for no limit.
+    int max_in_flight_batches = 0;
+
+    // The maximum total cost, as estimated by `QueueOptions::batch_cost_fn`,
+    // of the batches processed concurrently on the device, or 0 for no limit.
+    int64_t max_in_flight_cost = 0;
+  };
+
   // TODO(b/25089730): Tune defaults based on best practices as they develop.
   struct Options {
     // The name to use for the pool of batch threads.
@@ -128,6 +141,14 @@ class SharedBatchScheduler
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
+
+    // Admission limits keyed by `QueueOptions::device`. A batch of a queue
+    // whose device has an entry is only handed to a batch thread if the
+    // device stays within its limits; the queue is skipped otherwise, and
+    // retried once processing batches complete. A device with no batch in
+    // flight always admits one, so that a batch above the cost limit can't
+    // starve. Queues of devices without an entry are not limited.
+    std::map<string, DeviceCapacity> device_capacities;
   };
   // Ownership is shared between the caller of Create() and any queues created
   // via AddQueue().
@@ -221,6 +242,24 @@ class SharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // If true, once a task is split into several subtasks, the batch holding
+    // the last subtask becomes schedulable right away instead of waiting for
+    // more tasks or for `batch_timeout_micros`. All the subtasks of a large
+    // task then execute concurrently on the available batch threads, at the
+    // cost of a smaller last batch.
+    //
+    // Only has an effect if `enable_large_batch_splitting` is true.
+    bool schedule_split_tasks_immediately = false;
+
+    // The device processing the batches of this queue, used to look up its
+    // entry in `Options::device_capacities`.
+    string device;
+
+    // Estimates the cost of processing a batch of `batch_size` tasks, e.g.
+    // its device memory footprint or its measured processing time, counted
+    // against `DeviceCapacity::max_in_flight_cost`. Batches cost 0 if unset.
+    std::function<int64_t(size_t batch_size)> batch_cost_fn;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -230,8 +269,21 @@ class SharedBatchScheduler
  private:
   explicit SharedBatchScheduler(const Options& options);
 
+  // The batches currently processed on a device of
+  // `Options::device_capacities`.
+  struct DeviceUsage {
+    int in_flight_batches = 0;
+    int64_t in_flight_cost = 0;
+  };
+
+  // Obtains the next batch to process, if any, round-robin across the
+  // queues. When the batch is admitted against a device capacity, the usage
+  // it was charged to and its cost are stored in `device_usage_out` and
+  // `batch_cost_out`; `device_usage_out` is set to nullptr otherwise.
   void GetNextWorkItem_Locked(internal::Queue<TaskType>** queue_for_batch_out,
-                              BatchUniquePtr* batch_to_process_out)
+                              BatchUniquePtr* batch_to_process_out,
+                              DeviceUsage** device_usage_out,
+                              int64_t* batch_cost_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
@@ -253,6 +305,10 @@ class SharedBatchScheduler
 
   mutex mu_;
 
+  // Usage of the devices of `options_.device_capacities`. Entries are never
+  // erased, so pointers to them stay valid while a batch is processed.
+  std::map<string, DeviceUsage> device_usage_ TF_GUARDED_BY(mu_);
+
   // A list of queues. (We use std::list instead of std::vector to ensure that
   // iterators are not invalidated by adding/removing elements. It also offers
   // efficient removal of elements from the middle.)
@@ -306,6 +362,8 @@ class Queue {
   using ProcessBatchCallback =
       std::function<void(std::unique_ptr<Batch<TaskType>>)>;
   using SchedulableBatchCallback = std::function<void()>;
+  // Decides whether a batch of `batch_size` tasks may be processed now.
+  using AdmitBatchCallback = std::function<bool(size_t batch_size)>;
   using SplitInputTaskIntoSubtasksCallback = std::function<Status(
       std::unique_ptr<TaskType>* input_task, int open_batch_remaining_slot,
       int max_execution_batch_size,
@@ -347,15 +405,28 @@ class Queue {
   // size that's provided by caller of batch scheduler.
   size_t max_execution_batch_size() const { return max_execution_batch_size_; }
 
+  // Returns the device processing the batches of this queue.
+  const string& device() const { return options_.device; }
+
+  // Returns the estimated cost of processing a batch of `batch_size` tasks.
+  int64_t EstimateBatchCost(size_t batch_size) const {
+    return options_.batch_cost_fn ? options_.batch_cost_fn(batch_size) : 0;
+  }
+
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
   // returns a batch, the batch is guaranteed to be closed.
-  typename SharedBatchScheduler<TaskType>::BatchUniquePtr ScheduleBatch();
+  //
+  // If `admit_batch` is set, a ready batch is only returned if `admit_batch`
+  // accepts its size; otherwise it stays enqueued.
+  typename SharedBatchScheduler<TaskType>::BatchUniquePtr ScheduleBatch(
+      const AdmitBatchCallback& admit_batch = nullptr);
 
   // A variant of `ScheduleBatch`.
   // Batches are guaranteed to form at task enqueue time.
-  std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit();
+  std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit(
+      const AdmitBatchCallback& admit_batch);
 
   // Processes a batch that has been returned earlier by ScheduleBatch().
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
@@ -476,6 +547,10 @@ class Queue {
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
 
+  // Whether the open batch holds the last subtask of a split task, and is
+  // schedulable right away per `QueueOptions.schedule_split_tasks_immediately`.
+  bool open_batch_has_split_task_ TF_GUARDED_BY(mu_) = false;
+
   // The number of batches currently being processed by batch threads.
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
@@ -665,9 +740,12 @@ bool SharedBatchScheduler<TaskType>::BatchExists(
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
-    BatchUniquePtr* batch_to_process_out) {
+    BatchUniquePtr* batch_to_process_out, DeviceUsage** device_usage_out,
+    int64_t* batch_cost_out) {
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+  DeviceUsage* device_usage = nullptr;
+  int64_t batch_cost = 0;
   const int num_queues = queues_.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
@@ -680,11 +758,43 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     // calling ScheduleBatch().
     const bool queue_closed = (*next_queue_to_schedule_)->closed();
 
+    // If the queue's device has a capacity, only accept a batch that fits
+    // in what the batches already being processed leave.
+    internal::Queue<TaskType>* queue = next_queue_to_schedule_->get();
+    typename internal::Queue<TaskType>::AdmitBatchCallback admit_batch;
+    DeviceUsage* queue_device_usage = nullptr;
+    auto capacity_it = options_.device_capacities.find(queue->device());
+    if (capacity_it != options_.device_capacities.end()) {
+      const DeviceCapacity& capacity = capacity_it->second;
+      queue_device_usage = &device_usage_[queue->device()];
+      admit_batch = [queue, &capacity, queue_device_usage,
+                     &batch_cost](size_t batch_size) {
+        if (queue_device_usage->in_flight_batches == 0) {
+          batch_cost = queue->EstimateBatchCost(batch_size);
+          return true;
+        }
+        if (capacity.max_in_flight_batches > 0 &&
+            queue_device_usage->in_flight_batches >=
+                capacity.max_in_flight_batches) {
+          return false;
+        }
+        batch_cost = queue->EstimateBatchCost(batch_size);
+        return capacity.max_in_flight_cost <= 0 ||
+               queue_device_usage->in_flight_cost + batch_cost <=
+                   capacity.max_in_flight_cost;
+      };
+    }
+
     // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-    batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+    batch_to_process = queue->ScheduleBatch(admit_batch);
 
     if (BatchExists(batch_to_process)) {
-      queue_for_batch = next_queue_to_schedule_->get();
+      queue_for_batch = queue;
+      if (queue_device_usage != nullptr) {
+        device_usage = queue_device_usage;
+        ++device_usage->in_flight_batches;
+        device_usage->in_flight_cost += batch_cost;
+      }
     }
 
     // Advance 'next_queue_to_schedule_'.
@@ -703,6 +813,8 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
   }
   *queue_for_batch_out = queue_for_batch;
   *batch_to_process_out = std::move(batch_to_process);
+  *device_usage_out = device_usage;
+  *batch_cost_out = batch_cost;
 }
 
 template <typename TaskType>
@@ -711,10 +823,14 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   BatchUniquePtr batch_to_process;
   // The queue with which 'batch_to_process' is associated.
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+  // The device usage 'batch_to_process' is charged to, if any, and its cost.
+  DeviceUsage* device_usage = nullptr;
+  int64_t batch_cost = 0;
   {
     mutex_lock l(mu_);
     while (true) {
-      GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process);
+      GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process,
+                             &device_usage, &batch_cost);
       if (BatchExists(batch_to_process)) break;
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
@@ -751,6 +867,14 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   }
 
   queue_for_batch->ProcessBatch(std::move(batch_to_schedule));
+
+  if (device_usage != nullptr) {
+    mutex_lock l(mu_);
+    --device_usage->in_flight_batches;
+    device_usage->in_flight_cost -= batch_cost;
+    // Batches declined for lack of capacity may fit now.
+    schedulable_batch_cv_.notify_one();
+  }
 }
 
 namespace internal {
@@ -851,6 +975,9 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
 
       task_handle_batches_.back()->AddTask(std::move(task_handles[i]));
     }
+    if (options_.schedule_split_tasks_immediately && task_handles.size() > 1) {
+      open_batch_has_split_task_ = true;
+    }
 
     if (!schedulable_batch_) {
       if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
@@ -926,6 +1053,9 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
           batches_.back()->traceme_context_id());
       batches_.back()->AddTask(std::move(output_tasks[i]));
     }
+    if (options_.schedule_split_tasks_immediately && output_tasks.size() > 1) {
+      open_batch_has_split_task_ = true;
+    }
 
     if (!schedulable_batch_) {
       if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
@@ -1021,8 +1151,8 @@ Status Queue<TaskType>::ValidateBatchTaskQueueCapacity(TaskType* task) const {
 }
 
 template <typename TaskType>
-std::unique_ptr<Batch<TaskType>>
-Queue<TaskType>::ScheduleBatchWithEagerSplit() {
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatchWithEagerSplit(
+    const AdmitBatchCallback& admit_batch) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -1031,15 +1161,20 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
     mutex_lock l(mu_);
 
     // Consider closing the open batch at this time, to schedule it.
-    if (batches_.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
-    }
-
-    if (batches_.size() >= 2) {
-      // There is at least one closed batch that is ready to be scheduled.
-      ++num_batches_being_processed_;
-      batch_to_schedule = std::move(batches_.front());
-      batches_.pop_front();
+    const bool schedule_open_batch =
+        batches_.size() == 1 && IsOpenBatchSchedulable();
+
+    if (batches_.size() >= 2 || schedule_open_batch) {
+      // The front batch is ready to be scheduled. If it isn't admitted, it
+      // stays enqueued, and `schedulable_batch_` stays set.
+      if (admit_batch == nullptr || admit_batch(batches_.front()->size())) {
+        if (schedule_open_batch) {
+          StartNewBatch();
+        }
+        ++num_batches_being_processed_;
+        batch_to_schedule = std::move(batches_.front());
+        batches_.pop_front();
+      }
     } else {
       schedulable_batch_ = false;
     }
@@ -1050,9 +1185,9 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
 
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchUniquePtr
-Queue<TaskType>::ScheduleBatch() {
+Queue<TaskType>::ScheduleBatch(const AdmitBatchCallback& admit_batch) {
   if (!options_.enable_lazy_split) {
-    return ScheduleBatchWithEagerSplit();
+    return ScheduleBatchWithEagerSplit(admit_batch);
   }
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
@@ -1063,15 +1198,21 @@ Queue<TaskType>::ScheduleBatch() {
     mutex_lock l(mu_);
 
     // Consider closing the open batch at this time, to schedule it.
-    if (task_handle_batches_.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
-    }
-
-    if (task_handle_batches_.size() >= 2) {
-      // There is at least one closed batch that is ready to be scheduled.
-      ++num_batches_being_processed_;
-      task_handles_to_schedule = std::move(task_handle_batches_.front());
-      task_handle_batches_.pop_front();
+    const bool schedule_open_batch =
+        task_handle_batches_.size() == 1 && IsOpenBatchSchedulable();
+
+    if (task_handle_batches_.size() >= 2 || schedule_open_batch) {
+      // The front batch is ready to be scheduled. If it isn't admitted, it
+      // stays enqueued, and `schedulable_batch_` stays set.
+      if (admit_batch == nullptr ||
+          admit_batch(task_handle_batches_.front()->size())) {
+        if (schedule_open_batch) {
+          StartNewBatch();
+        }
+        ++num_batches_being_processed_;
+        task_handles_to_schedule = std::move(task_handle_batches_.front());
+        task_handle_batches_.pop_front();
+      }
     } else {
       schedulable_batch_ = false;
     }
@@ -1136,6 +1277,7 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  open_batch_has_split_task_ = false;
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
     task_handle_batches_.emplace_back(new Batch<BatchInputTaskHandle<TaskType>>(
@@ -1163,7 +1305,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch_has_split_task_ ||
+         open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
              open_batch_start_time_micros_ + options_.batch_timeout_micros;
 }
@@ -1178,7 +1321,8 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch_has_split_task_ ||
+         open_batch->size() >= max_execution_batch_size() ||
          env_->NowMicros() >=
              open_batch_start_time_micros_ + options_.batch_timeout_micros;
 }
@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/container/fixed_array.h"
@@ -27,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
@@ -793,6 +796,137 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+// Tests that with `schedule_split_tasks_immediately`, the batch holding the
+// last subtask of a split task doesn't wait for the batch timeout.
+TEST_P(SharedBatchSchedulerTest, SchedulesSplitTasksImmediately) {
+  if (!enable_input_batch_split()) {
+    return;
+  }
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> batch_sizes;
+    BlockingCounter batches_processed(3);
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      {
+        mutex_lock l(mu);
+        batch_sizes.push_back(batch->size());
+      }
+      batches_processed.DecrementCount();
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(3, &env);
+
+    QueueOptions options =
+        CreateQueueOptions(/*max_execution_batch_size=*/10,
+                           /*input_batch_size_limit=*/100,
+                           /*batch_timeout_micros=*/1000,
+                           /*max_enqueued_batches=*/10);
+    options.schedule_split_tasks_immediately = true;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // The task is split into subtasks of sizes 10, 10 and 5, and the clock
+    // never reaches the timeout.
+    TF_ASSERT_OK(ScheduleTask(25, queue.get()));
+    batches_processed.Wait();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(batch_sizes, ::testing::UnorderedElementsAre(10, 10, 5));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+// Tests that batches of queues sharing a device are only processed
+// concurrently while they fit in the device capacity.
+TEST_P(SharedBatchSchedulerTest, ObeysDeviceCapacity) {
+  Notification large_batch_processing, large_batch_proceed;
+  auto large_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    large_batch_processing.Notify();
+    large_batch_proceed.WaitForNotification();
+  };
+  std::atomic<bool> medium_batch_processed(false);
+  Notification medium_batch_done;
+  auto medium_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    medium_batch_processed = true;
+    medium_batch_done.Notify();
+  };
+  Notification small_batch_done;
+  auto small_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    small_batch_done.Notify();
+  };
+
+  Scheduler::Options options;
+  options.num_batch_threads = 3;
+  options.device_capacities["/device:GPU:0"].max_in_flight_cost = 10;
+  std::shared_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+  QueueOptions queue_options =
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/0,
+                         /*max_enqueued_batches=*/2);
+  queue_options.device = "/device:GPU:0";
+  queue_options.batch_cost_fn = [](size_t batch_size) { return batch_size; };
+  std::unique_ptr<Queue> large_queue =
+      CreateQueue(scheduler, queue_options, large_callback);
+  std::unique_ptr<Queue> medium_queue =
+      CreateQueue(scheduler, queue_options, medium_callback);
+  std::unique_ptr<Queue> small_queue =
+      CreateQueue(scheduler, queue_options, small_callback);
+
+  TF_ASSERT_OK(ScheduleTask(6, large_queue.get()));
+  large_batch_processing.WaitForNotification();
+
+  // A batch of cost 5 doesn't fit next to the one of cost 6, but a batch of
+  // cost 4 does.
+  TF_ASSERT_OK(ScheduleTask(5, medium_queue.get()));
+  TF_ASSERT_OK(ScheduleTask(4, small_queue.get()));
+  small_batch_done.WaitForNotification();
+  Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+  EXPECT_FALSE(medium_batch_processed);
+
+  large_batch_proceed.Notify();
+  medium_batch_done.WaitForNotification();
+}
+
+// Tests that a device always admits a batch when it has none in flight, even
+// if the batch exceeds its capacity.
+TEST_P(SharedBatchSchedulerTest, AdmitsBatchAboveDeviceCapacityWhenIdle) {
+  Notification batch_done;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    batch_done.Notify();
+  };
+
+  Scheduler::Options options;
+  options.num_batch_threads = 1;
+  options.device_capacities["/device:GPU:0"].max_in_flight_cost = 1;
+  std::shared_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+  QueueOptions queue_options =
+      CreateQueueOptions(/*max_execution_batch_size=*/10,
+                         /*input_batch_size_limit=*/10,
+                         /*batch_timeout_micros=*/0,
+                         /*max_enqueued_batches=*/2);
+  queue_options.device = "/device:GPU:0";
+  queue_options.batch_cost_fn = [](size_t batch_size) { return batch_size; };
+  std::unique_ptr<Queue> queue =
+      CreateQueue(scheduler, queue_options, callback);
+
+  TF_ASSERT_OK(ScheduleTask(5, queue.get()));
+  batch_done.WaitForNotification();
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
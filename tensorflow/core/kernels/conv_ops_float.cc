@@ -15,14 +15,61 @@ limitations under the License.
 
 // See docs in ../ops/nn_ops.cc.
 
+#include <array>
+#include <map>
+
 #include "tensorflow/core/kernels/conv_ops_impl.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Identifies a convolution for DeepConv2D autotuning: its shape, padding,
+// strides and the number of CPU threads available to compute it.
+using DeepConvAutotuneKey = std::array<int64_t, 14>;
+
+// Process-wide cache of DeepConv2D autotuning decisions. Maps a convolution
+// to true if DeepConv2D was measured to be faster than the direct
+// convolution for it.
+class DeepConvAutotuneMap {
+ public:
+  static DeepConvAutotuneMap* Global() {
+    static DeepConvAutotuneMap* map = new DeepConvAutotuneMap;
+    return map;
+  }
+
+  bool Find(const DeepConvAutotuneKey& key, bool* use_deep_conv) const {
+    tf_shared_lock l(mu_);
+    auto it = decisions_.find(key);
+    if (it == decisions_.end()) {
+      return false;
+    }
+    *use_deep_conv = it->second;
+    return true;
+  }
+
+  void Insert(const DeepConvAutotuneKey& key, bool use_deep_conv) {
+    mutex_lock l(mu_);
+    decisions_.emplace(key, use_deep_conv);
+  }
+
+ private:
+  mutable mutex mu_;
+  std::map<DeepConvAutotuneKey, bool> decisions_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
 // Conditionally launches DeepConv operation based on convolution parameters.
+// When DeepConv2D autotuning is enabled, the first run of each convolution
+// times DeepConv2D against the direct convolution and the faster one is used
+// for every later run.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
  public:
@@ -32,9 +79,14 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  Padding padding, Tensor* output, TensorFormat data_format) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
-        dilation_cols != 1 ||
+        dilation_cols != 1) {
+      return false;
+    }
+    const bool autotune = UseDeepConv2DAutotune(stride_rows, stride_cols,
+                                                filter_rows, filter_cols);
+    if (!autotune &&
         !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
                           in_depth, out_depth, out_rows, out_cols)) {
       return false;
@@ -57,8 +109,56 @@ class LaunchDeepConvOp<CPUDevice, float> {
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
 
+    if (!autotune) {
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      return true;
+    }
+
+    const int num_threads =
+        ctx->device()->tensorflow_cpu_worker_threads()->num_threads;
+    const DeepConvAutotuneKey key = {batch,       input_rows,  input_cols,
+                                     in_depth,    filter_rows, filter_cols,
+                                     pad_rows,    pad_cols,    out_rows,
+                                     out_cols,    out_depth,   stride_rows,
+                                     stride_cols, num_threads};
+    bool use_deep_conv;
+    if (DeepConvAutotuneMap::Global()->Find(key, &use_deep_conv)) {
+      if (!use_deep_conv) {
+        return false;
+      }
+      profiler::ScopedAnnotation trace("DeepConv2D");
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+      return true;
+    }
+
+    // Both implementations write a complete result to 'output', so the one
+    // that runs last provides the output of this step.
+    profiler::ScopedAnnotation trace("deep_conv2d_autotuning");
+    Env* env = Env::Default();
+    uint64 start_us = env->NowMicros();
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
+    const uint64 deep_conv_us = env->NowMicros() - start_us;
+    start_us = env->NowMicros();
+    LaunchConv2DOp<CPUDevice, float>()(
+        ctx, /*use_cudnn=*/false, /*cudnn_use_autotune=*/false, input, filter,
+        dilation_rows, dilation_cols, stride_rows, stride_cols, padding,
+        /*explicit_paddings=*/{}, output, data_format);
+    const uint64 direct_conv_us = env->NowMicros() - start_us;
+    if (!ctx->status().ok()) {
+      return true;
+    }
+
+    use_deep_conv = deep_conv_us < direct_conv_us;
+    VLOG(1) << "DeepConv2D autotuning for " << ctx->op_kernel().name()
+            << " (input " << input.shape().DebugString() << ", filter "
+            << filter.shape().DebugString() << ", threads " << num_threads
+            << "): deep_conv_us: " << deep_conv_us
+            << " direct_conv_us: " << direct_conv_us
+            << " use_deep_conv: " << use_deep_conv;
+    DeepConvAutotuneMap::Global()->Insert(key, use_deep_conv);
     return true;
   }
 };
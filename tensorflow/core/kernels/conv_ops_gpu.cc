@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 #include "tensorflow/core/util/use_cudnn.h"
 
@@ -81,6 +82,7 @@ StatusOr<AutotuneEntry<se::dnn::FusedConvOp>> AutotuneFusedConv(
     se::DeviceMemory<T> output_ptr, se::DeviceMemory<T> bias_ptr,
     se::DeviceMemory<T> side_input_ptr, int64_t scratch_size_limit) {
 #if GOOGLE_CUDA
+  InitAutotuneMapsFromEnv();
   AutotuneEntry<se::dnn::FusedConvOp> autotune_entry;
   auto* stream = ctx->op_device_context()->stream();
 
@@ -242,6 +244,7 @@ StatusOr<AutotuneEntry<se::dnn::ConvOp>> AutotuneUnfusedConv(
     const se::dnn::ConvolutionDescriptor& conv_desc,
     const se::dnn::BatchDescriptor& output_desc, se::DeviceMemory<T> output_ptr,
     int64_t scratch_size_limit) {
+  InitAutotuneMapsFromEnv();
   AutotuneEntry<se::dnn::ConvOp> autotune_entry;
 
   auto* stream = ctx->op_device_context()->stream();
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -46,6 +47,7 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudgetBytes;
 
 namespace {
 
@@ -70,6 +72,26 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+constexpr char kSpillPrefetchThread[] = "tf_data_cache_spill_prefetch";
+
+int64_t ElementBytes(const std::vector<Tensor>& element) {
+  int64_t bytes = 0;
+  for (const Tensor& tensor : element) {
+    bytes += tensor.TotalBytes();
+  }
+  return bytes;
+}
+
+// Returns all elements of a completed `cache`, reading back spilled ones.
+Status GetAllElements(MemoryCache* cache,
+                      std::vector<std::vector<Tensor>>* elements) {
+  *elements = cache->data();
+  for (size_t i = elements->size(); i < cache->size(); ++i) {
+    elements->emplace_back();
+    TF_RETURN_IF_ERROR(cache->GetElement(i, &elements->back()));
+  }
+  return OkStatus();
+}
 }  // namespace
 
 class PartialCache {
@@ -726,10 +748,12 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
  public:
   explicit MemoryDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                             std::shared_ptr<MemoryCache> cache)
+                             std::shared_ptr<MemoryCache> cache,
+                             int64_t memory_budget_bytes)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
-        cache_(std::move(cache)) {
+        cache_(std::move(cache)),
+        memory_budget_bytes_(memory_budget_bytes) {
     input_->Ref();
   }
 
@@ -821,8 +845,15 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex_lock l(mu_);
       if (cache_->IsCompleted()) {
         TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCacheCompleted), ""));
-        TF_RETURN_IF_ERROR(
-            WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        if (cache_->spill_file() == nullptr) {
+          TF_RETURN_IF_ERROR(
+              WriteElementsToCheckpoint(writer, prefix(), cache_->data()));
+        } else {
+          std::vector<std::vector<Tensor>> elements;
+          TF_RETURN_IF_ERROR(GetAllElements(cache_, &elements));
+          TF_RETURN_IF_ERROR(
+              WriteElementsToCheckpoint(writer, prefix(), elements));
+        }
       }
       return SaveInput(ctx, writer, iterator_);
     }
@@ -850,7 +881,7 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 
       ~MemoryWriterIterator() override {
         mutex_lock l(mu_);
-        if (!temp_cache_.empty() && !cache_->IsCompleted()) {
+        if (NumCachedElements() > 0 && !cache_->IsCompleted()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           cache_->Reset();
         }
@@ -870,16 +901,32 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           if (!cache_->IsCompleted()) {
             VLOG(2) << "Finalizing the cache because EOF has been reached.";
-            cache_->Complete(std::move(temp_cache_));
+            TF_RETURN_IF_ERROR(CompleteCache());
           }
           return OkStatus();
         }
-        RecordBufferEnqueue(ctx, *out_tensors);
-        temp_cache_.emplace_back(*out_tensors);
-        if (temp_cache_.size() == dataset()->input_->Cardinality()) {
+        const int64_t element_bytes = ElementBytes(*out_tensors);
+        const int64_t budget = dataset()->memory_budget_bytes_;
+        if (spill_file_ == nullptr &&
+            (budget < 0 || temp_cache_bytes_ + element_bytes <= budget)) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          temp_cache_.emplace_back(*out_tensors);
+          temp_cache_bytes_ += element_bytes;
+        } else {
+          // Once an element is spilled, so are all following ones, so the
+          // in-memory elements always precede the spilled ones.
+          if (spill_file_ == nullptr) {
+            VLOG(2) << "Spilling cached elements to disk after "
+                    << temp_cache_.size() << " elements ("
+                    << temp_cache_bytes_ << " bytes).";
+            TF_RETURN_IF_ERROR(SpillFile::Create(ctx->env(), &spill_file_));
+          }
+          TF_RETURN_IF_ERROR(spill_file_->Append(*out_tensors));
+        }
+        if (NumCachedElements() == dataset()->input_->Cardinality()) {
           VLOG(2) << "Finalizing the cache because its size matches the "
                      "expected input cardinality.";
-          cache_->Complete(std::move(temp_cache_));
+          TF_RETURN_IF_ERROR(CompleteCache());
         }
         return OkStatus();
       }
@@ -895,27 +942,62 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         if (!cache_->IsCompleted()) {
-          TF_RETURN_IF_ERROR(
-              WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          if (spill_file_ == nullptr) {
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), temp_cache_));
+          } else {
+            std::vector<std::vector<Tensor>> elements = temp_cache_;
+            for (size_t i = 0; i < spill_file_->size(); ++i) {
+              elements.emplace_back();
+              TF_RETURN_IF_ERROR(spill_file_->Read(i, &elements.back()));
+            }
+            TF_RETURN_IF_ERROR(
+                WriteElementsToCheckpoint(writer, prefix(), elements));
+          }
         }
         return SaveInput(ctx, writer, input_impl_);
       }
 
+      // Restored elements are all kept in memory; only elements produced
+      // after the restore are subject to the memory budget.
       Status RestoreInternal(IteratorContext* ctx,
                              IteratorStateReader* reader) override {
         mutex_lock l(mu_);
         if (!reader->Contains(full_name(kCacheCompleted))) {
           TF_RETURN_IF_ERROR(
               ReadElementsFromCheckpoint(ctx, reader, prefix(), &temp_cache_));
+          spill_file_.reset();
+          temp_cache_bytes_ = 0;
+          for (const auto& element : temp_cache_) {
+            temp_cache_bytes_ += ElementBytes(element);
+          }
         }
         return RestoreInput(ctx, reader, input_impl_);
       }
 
      private:
+      int64_t NumCachedElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        return temp_cache_.size() +
+               (spill_file_ != nullptr ? spill_file_->size() : 0);
+      }
+
+      Status CompleteCache() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (spill_file_ != nullptr) {
+          TF_RETURN_IF_ERROR(spill_file_->Finalize());
+        }
+        cache_->Complete(std::move(temp_cache_), std::move(spill_file_));
+        temp_cache_bytes_ = 0;
+        return OkStatus();
+      }
+
       mutex mu_;
       std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       std::vector<std::vector<Tensor>> temp_cache_ TF_GUARDED_BY(mu_);
+      // Bytes held by `temp_cache_`, compared against the memory budget.
+      int64_t temp_cache_bytes_ TF_GUARDED_BY(mu_) = 0;
+      // Elements beyond the memory budget, if any.
+      std::unique_ptr<SpillFile> spill_file_ TF_GUARDED_BY(mu_);
     };  // MemoryWriterIterator
 
     class MemoryReaderIterator : public DatasetIterator<MemoryDatasetBase> {
@@ -925,6 +1007,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
             cache_(cache),
             index_(0) {}
 
+      ~MemoryReaderIterator() override { cancelled_ = true; }
+
       Status Initialize(IteratorContext* ctx) override {
         // The memory allocated for the cache is owned by the parent
         // dataset but performance modeling uses the iterator abstraction and
@@ -932,9 +1016,16 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
         // is that this is incorrect if there are concurrent instances of this
         // iterator.
         tf_shared_lock l(mu_);
-        for (size_t i = 0; i < cache_->size(); ++i) {
+        for (size_t i = 0; i < cache_->in_memory_size(); ++i) {
           RecordBufferEnqueue(ctx, cache_->at(i));
         }
+        // Warms up the spilled elements while the in-memory ones are read.
+        std::shared_ptr<SpillFile> spill_file = cache_->spill_file();
+        if (spill_file != nullptr) {
+          prefetch_thread_ = ctx->StartThread(
+              kSpillPrefetchThread,
+              [this, spill_file]() { spill_file->Prefetch(cancelled_); });
+        }
         return OkStatus();
       }
 
@@ -943,7 +1034,8 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         if (index_ < cache_->size()) {
-          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+          std::vector<Tensor> cache_tensors;
+          TF_RETURN_IF_ERROR(cache_->GetElement(index_, &cache_tensors));
           out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
                               cache_tensors.end());
           index_++;
@@ -988,6 +1080,10 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
       mutex mu_;
       MemoryCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
       size_t index_ TF_GUARDED_BY(mu_);
+      std::atomic<bool> cancelled_{false};
+      // Declared last so that it is joined before the members it uses are
+      // destroyed.
+      std::unique_ptr<Thread> prefetch_thread_;
     };  // MemoryReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -1015,6 +1111,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
   mutable mutex mu_;
   const DatasetBase* const input_;
   const std::shared_ptr<MemoryCache> cache_;
+  // Bytes of elements kept in memory before spilling the rest to disk, or -1
+  // to keep all elements in memory.
+  const int64_t memory_budget_bytes_;
   mutable std::unique_ptr<PartialCache> partial_cache_ TF_GUARDED_BY(mu_);
 };  // MemoryDatasetBase
 
@@ -1024,8 +1123,9 @@ class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
 class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
  public:
   MemoryDataset(OpKernelContext* ctx, const DatasetBase* input,
-                MemoryCacheManager* manager, ResourceHandle&& resource_handle)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                MemoryCacheManager* manager, ResourceHandle&& resource_handle,
+                int64_t memory_budget_bytes)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget_bytes),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()) {}
@@ -1047,8 +1147,11 @@ class CacheDatasetOp::MemoryDataset : public CacheDatasetOp::MemoryDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(tstring(""), &filename_node));
-    TF_RETURN_IF_ERROR(
-        b->AddDataset(this, {input_node, filename_node}, output));
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_node, filename_node},
+        {{kMemoryBudgetBytes, memory_budget_bytes}}, output));
     return OkStatus();
   }
 
@@ -1066,8 +1169,8 @@ class CacheDatasetOp::MemoryDatasetV2
  public:
   MemoryDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
                   MemoryCacheManager* manager, ResourceHandle&& resource_handle,
-                  bool owns_resource)
-      : MemoryDatasetBase(ctx, input, manager->get()),
+                  bool owns_resource, int64_t memory_budget_bytes)
+      : MemoryDatasetBase(ctx, input, manager->get(), memory_budget_bytes),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -1096,8 +1199,11 @@ class CacheDatasetOp::MemoryDatasetV2
     Tensor handle(DT_RESOURCE, TensorShape({}));
     handle.scalar<ResourceHandle>()() = resource_handle_;
     TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
+    AttrValue memory_budget_bytes;
+    b->BuildAttrValue(memory_budget_bytes_, &memory_budget_bytes);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node},
+        {{kMemoryBudgetBytes, memory_budget_bytes}}, output));
     return OkStatus();
   }
 
@@ -1110,7 +1216,9 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudgetBytes, &memory_budget_bytes_));
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1143,7 +1251,7 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       }
       // Ownership of manager is transferred onto `MemoryDatasetV2`.
       *output = new MemoryDatasetV2(ctx, input, manager, std::move(handle),
-                                    owns_resource);
+                                    owns_resource, memory_budget_bytes_);
     } else {
       MemoryCacheManager* manager;
       OP_REQUIRES_OK(
@@ -1155,7 +1263,8 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       auto handle =
           MakeResourceHandle<MemoryCacheManager>(ctx, container, name);
       // Ownership of manager is transferred onto `MemoryDataset`.
-      *output = new MemoryDataset(ctx, input, manager, std::move(handle));
+      *output = new MemoryDataset(ctx, input, manager, std::move(handle),
+                                  memory_budget_bytes_);
     }
   } else {
     if (op_version_ == 2) {
@@ -30,6 +30,8 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kMemoryBudgetBytes =
+      "memory_budget_bytes";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +46,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   const int op_version_;
+  int64_t memory_budget_bytes_;
 };
 
 }  // namespace data
@@ -14,14 +14,21 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_ops.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
 namespace data {
@@ -29,14 +36,290 @@ namespace {
 
 constexpr char kMemoryCache[] = "MemoryCache";
 
+// Alignment of tensor payloads in a spill file.
+constexpr uint64 kSpillFileAlignment = EIGEN_MAX_ALIGN_BYTES;
+
+// Encodings of tensor payloads in a spill file.
+constexpr uint32 kRawEncoding = 0;
+constexpr uint32 kProtoEncoding = 1;
+
+// Size of the fixed part of a component header: dtype, encoding, and rank.
+constexpr size_t kComponentHeaderSize = 3 * sizeof(uint32);
+
+// Chunk size used when prefetching a spill file.
+constexpr size_t kSpillFilePrefetchChunkSize = 1 << 20;  // 1MB
+
+uint64 PaddingFor(uint64 offset) {
+  return (kSpillFileAlignment - offset % kSpillFileAlignment) %
+         kSpillFileAlignment;
+}
+
+// A TensorBuffer aliasing part of a memory-mapped spill file. It does not own
+// its memory, so kernels never forward it as an output to update in place.
+class SpillTensorBuffer : public TensorBuffer {
+ public:
+  SpillTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                    const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("CacheSpillFile");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  // Keeps the mapping alive.
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Decodes the element stored in `data`, which starts at `offset` in the spill
+// file, and appends its components to `element`. If `region` is not null,
+// `data` points into it and raw payloads are aliased rather than copied.
+Status DecodeSpilledElement(StringPiece data, uint64 offset,
+                            const std::shared_ptr<ReadOnlyMemoryRegion>& region,
+                            std::vector<Tensor>* element) {
+  const char* const begin = data.data();
+  while (!data.empty()) {
+    if (data.size() < kComponentHeaderSize) {
+      return errors::DataLoss("Truncated component header in cache spill file");
+    }
+    const auto dtype = static_cast<DataType>(core::DecodeFixed32(data.data()));
+    const uint32 encoding = core::DecodeFixed32(data.data() + sizeof(uint32));
+    const uint32 rank = core::DecodeFixed32(data.data() + 2 * sizeof(uint32));
+    const size_t header_size =
+        kComponentHeaderSize + (rank + 1) * sizeof(uint64);
+    if (data.size() < header_size) {
+      return errors::DataLoss("Truncated component header in cache spill file");
+    }
+    std::vector<int64_t> dim_sizes(rank);
+    for (uint32 i = 0; i < rank; ++i) {
+      dim_sizes[i] = core::DecodeFixed64(data.data() + kComponentHeaderSize +
+                                         i * sizeof(uint64));
+    }
+    const uint64 payload_size = core::DecodeFixed64(
+        data.data() + kComponentHeaderSize + rank * sizeof(uint64));
+    const uint64 payload_offset =
+        header_size +
+        PaddingFor(offset + (data.data() - begin) + header_size);
+    if (data.size() < payload_offset + payload_size) {
+      return errors::DataLoss("Truncated component in cache spill file");
+    }
+    const char* payload = data.data() + payload_offset;
+    data.remove_prefix(payload_offset + payload_size);
+
+    if (encoding == kProtoEncoding) {
+      TensorProto proto;
+      Tensor tensor;
+      if (!proto.ParseFromArray(payload, payload_size) ||
+          !tensor.FromProto(proto)) {
+        return errors::DataLoss("Unable to parse tensor in cache spill file");
+      }
+      element->push_back(std::move(tensor));
+      continue;
+    }
+    if (encoding != kRawEncoding || !DataTypeCanUseMemcpy(dtype)) {
+      return errors::DataLoss("Unexpected encoding ", encoding, " of ",
+                              DataTypeString(dtype),
+                              " tensor in cache spill file");
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShapeUtils::MakeShape(dim_sizes.data(), rank, &shape));
+    if (shape.num_elements() * DataTypeSize(dtype) != payload_size) {
+      return errors::DataLoss("Inconsistent tensor size in cache spill file");
+    }
+    if (region != nullptr && payload_size > 0) {
+      element->emplace_back(dtype, shape,
+                            core::RefCountPtr<TensorBuffer>(
+                                new SpillTensorBuffer(region, payload,
+                                                      payload_size)));
+    } else {
+      Tensor tensor(dtype, shape);
+      std::copy_n(payload, payload_size,
+                  const_cast<char*>(tensor.tensor_data().data()));
+      element->push_back(std::move(tensor));
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 string MemoryCacheManager::DebugString() const { return kMemoryCache; }
 
+Status SpillFile::Create(Env* env, std::unique_ptr<SpillFile>* spill_file) {
+  string filename;
+  if (!env->LocalTempFilename(&filename)) {
+    return errors::Unavailable(
+        "Failed to create a local temporary file for spilling cached dataset "
+        "elements.");
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  spill_file->reset(new SpillFile(env, filename, std::move(file)));
+  return OkStatus();
+}
+
+SpillFile::SpillFile(Env* env, const string& filename,
+                     std::unique_ptr<WritableFile> file)
+    : env_(env), filename_(filename), file_(std::move(file)) {}
+
+SpillFile::~SpillFile() {
+  mutex_lock l(mu_);
+  if (file_ != nullptr) {
+    file_->Close().IgnoreError();
+  }
+  reader_.reset();
+  region_.reset();
+  Status s = env_->DeleteFile(filename_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete cache spill file " << filename_ << ": "
+                 << s;
+  }
+}
+
+Status SpillFile::Append(const std::vector<Tensor>& element) {
+  mutex_lock l(mu_);
+  if (file_ == nullptr) {
+    return errors::FailedPrecondition("Cache spill file ", filename_,
+                                      " has already been finalized.");
+  }
+  uint64 offset = offsets_.back();
+  for (const Tensor& tensor : element) {
+    uint32 encoding = kRawEncoding;
+    StringPiece payload;
+    string proto_payload;
+    if (DataTypeCanUseMemcpy(tensor.dtype())) {
+      payload = tensor.tensor_data();
+    } else {
+      encoding = kProtoEncoding;
+      TensorProto proto;
+      tensor.AsProtoField(&proto);
+      if (!proto.SerializeToString(&proto_payload)) {
+        return errors::Internal("Unable to serialize ",
+                                DataTypeString(tensor.dtype()),
+                                " tensor for the cache spill file");
+      }
+      payload = proto_payload;
+    }
+    string header;
+    core::PutFixed32(&header, tensor.dtype());
+    core::PutFixed32(&header, encoding);
+    core::PutFixed32(&header, tensor.dims());
+    for (int i = 0; i < tensor.dims(); ++i) {
+      core::PutFixed64(&header, tensor.dim_size(i));
+    }
+    core::PutFixed64(&header, payload.size());
+    header.append(PaddingFor(offset + header.size()), '\0');
+    TF_RETURN_IF_ERROR(file_->Append(header));
+    TF_RETURN_IF_ERROR(file_->Append(payload));
+    offset += header.size() + payload.size();
+  }
+  offsets_.push_back(offset);
+  return OkStatus();
+}
+
+Status SpillFile::Finalize() {
+  mutex_lock l(mu_);
+  if (file_ == nullptr) return OkStatus();
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env_->NewReadOnlyMemoryRegionFromFile(filename_, &region);
+  if (s.ok()) {
+    region_ = std::move(region);
+  } else if (errors::IsUnimplemented(s)) {
+    VLOG(1) << "Unable to memory-map cache spill file " << filename_
+            << ", falling back to reads: " << s;
+  } else {
+    return s;
+  }
+  return OkStatus();
+}
+
+Status SpillFile::Read(int64_t index, std::vector<Tensor>* element) {
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  RandomAccessFile* reader = nullptr;
+  uint64 begin;
+  uint64 end;
+  {
+    mutex_lock l(mu_);
+    if (index < 0 || index + 1 >= offsets_.size()) {
+      return errors::OutOfRange("Index ", index,
+                                " out of range for cache spill file with ",
+                                offsets_.size() - 1, " elements");
+    }
+    begin = offsets_[index];
+    end = offsets_[index + 1];
+    region = region_;
+    if (region == nullptr) {
+      if (file_ != nullptr) {
+        TF_RETURN_IF_ERROR(file_->Flush());
+      }
+      if (reader_ == nullptr) {
+        TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &reader_));
+      }
+      // `reader_` is never reset while this object is alive.
+      reader = reader_.get();
+    }
+  }
+  if (region != nullptr) {
+    return DecodeSpilledElement(
+        StringPiece(static_cast<const char*>(region->data()) + begin,
+                    end - begin),
+        begin, region, element);
+  }
+  string scratch(end - begin, '\0');
+  StringPiece data;
+  TF_RETURN_IF_ERROR(reader->Read(begin, end - begin, &data, &scratch[0]));
+  if (data.size() != end - begin) {
+    return errors::DataLoss("Truncated cache spill file ", filename_);
+  }
+  return DecodeSpilledElement(data, begin, /*region=*/nullptr, element);
+}
+
+void SpillFile::Prefetch(const std::atomic<bool>& cancelled) {
+  uint64 size;
+  {
+    mutex_lock l(mu_);
+    size = offsets_.back();
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  Status s = env_->NewRandomAccessFile(filename_, &file);
+  string scratch(kSpillFilePrefetchChunkSize, '\0');
+  for (uint64 offset = 0; s.ok() && offset < size && !cancelled;
+       offset += kSpillFilePrefetchChunkSize) {
+    StringPiece unused;
+    s = file->Read(offset,
+                   std::min<uint64>(kSpillFilePrefetchChunkSize, size - offset),
+                   &unused, &scratch[0]);
+  }
+  if (!s.ok()) {
+    VLOG(1) << "Failed to prefetch cache spill file " << filename_ << ": " << s;
+  }
+}
+
+size_t SpillFile::size() {
+  mutex_lock l(mu_);
+  return offsets_.size() - 1;
+}
+
 void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache) {
+  Complete(std::move(cache), /*spill_file=*/nullptr);
+}
+
+void MemoryCache::Complete(std::vector<std::vector<Tensor>>&& cache,
+                           std::unique_ptr<SpillFile> spill_file) {
   mutex_lock l(mu_);
   if (!completed_) {
     cache_ = std::move(cache);
+    spill_file_ = std::move(spill_file);
     completed_ = true;
   }
 }
@@ -50,6 +333,7 @@ void MemoryCache::Reset() {
   mutex_lock l(mu_);
   completed_ = false;
   cache_.clear();
+  spill_file_.reset();
 }
 
 const std::vector<Tensor>& MemoryCache::at(int64_t index) {
@@ -58,7 +342,31 @@ const std::vector<Tensor>& MemoryCache::at(int64_t index) {
   return cache_[index];
 }
 
+Status MemoryCache::GetElement(int64_t index, std::vector<Tensor>* element) {
+  std::shared_ptr<SpillFile> spill_file;
+  int64_t spill_index;
+  {
+    tf_shared_lock l(mu_);
+    if (index < cache_.size()) {
+      element->insert(element->end(), cache_[index].begin(),
+                      cache_[index].end());
+      return OkStatus();
+    }
+    spill_file = spill_file_;
+    spill_index = index - cache_.size();
+  }
+  if (spill_file == nullptr) {
+    return errors::OutOfRange("Index ", index, " out of range for cache");
+  }
+  return spill_file->Read(spill_index, element);
+}
+
 size_t MemoryCache::size() {
+  tf_shared_lock l(mu_);
+  return cache_.size() + (spill_file_ != nullptr ? spill_file_->size() : 0);
+}
+
+size_t MemoryCache::in_memory_size() {
   tf_shared_lock l(mu_);
   return cache_.size();
 }
@@ -68,6 +376,11 @@ const std::vector<std::vector<Tensor>>& MemoryCache::data() {
   return cache_;
 }
 
+std::shared_ptr<SpillFile> MemoryCache::spill_file() {
+  tf_shared_lock l(mu_);
+  return spill_file_;
+}
+
 AnonymousMemoryCacheHandleOp::AnonymousMemoryCacheHandleOp(
     OpKernelConstruction* ctx)
     : AnonymousResourceOp<MemoryCacheManager>(ctx,
@@ -16,17 +16,77 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_OPS_H_
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
 
+// An append-only local file holding the dataset elements that a `MemoryCache`
+// could not keep within its memory budget.
+//
+// Every component of an element is stored as a small header followed by its
+// payload, aligned to `EIGEN_MAX_ALIGN_BYTES` in the file. Payloads of
+// memcpy-able dtypes are the raw tensor bytes, so once the file is finalized
+// it is memory-mapped (where the file system supports it) and such tensors are
+// returned without copying. Other dtypes are stored as `TensorProto`s.
+class SpillFile {
+ public:
+  // Creates an empty spill file in a local temporary directory.
+  static Status Create(Env* env, std::unique_ptr<SpillFile>* spill_file);
+
+  // Deletes the file.
+  ~SpillFile();
+
+  // Appends `element` to the file.
+  // REQUIRES: Finalize() has not been called.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Finishes writing the file and prepares it for reading.
+  Status Finalize();
+
+  // Appends the components of the element at `index` to `element`. Tensors
+  // read from a memory-mapped file do not own their memory, so they are never
+  // updated in place by downstream kernels.
+  Status Read(int64_t index, std::vector<Tensor>* element);
+
+  // Reads through the whole file once so that it is in the page cache by the
+  // time it is needed, returning early once `cancelled` becomes true.
+  void Prefetch(const std::atomic<bool>& cancelled);
+
+  // Returns the number of elements in the file.
+  size_t size();
+
+ private:
+  SpillFile(Env* env, const string& filename,
+            std::unique_ptr<WritableFile> file);
+
+  Env* const env_;
+  const string filename_;
+
+  mutex mu_;
+  std::unique_ptr<WritableFile> file_ TF_GUARDED_BY(mu_);
+  // Used to read the file when it is being appended to, or cannot be mapped.
+  std::unique_ptr<RandomAccessFile> reader_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
+  // Offset of each element in the file, followed by the file size.
+  std::vector<uint64> offsets_ TF_GUARDED_BY(mu_) = {0};
+};
+
 // A thread-safe data structure for caching dataset elements.
 //
 // The expected use is that a single `MemoryWriterIterator` populates the
 // cache with dataset elements. Once all elements are cached, the cache can
 // be used by one or more `MemoryReaderIterator`s.
+//
+// When the writer runs out of its memory budget, the remaining elements are
+// kept in a `SpillFile` instead, following the in-memory elements.
 class MemoryCache {
  public:
   MemoryCache() = default;
@@ -34,6 +94,11 @@ class MemoryCache {
   // Marks the cache as completed.
   void Complete(std::vector<std::vector<Tensor>>&& cache);
 
+  // Marks the cache as completed, with the elements following `cache` held in
+  // the finalized `spill_file`, if not null.
+  void Complete(std::vector<std::vector<Tensor>>&& cache,
+                std::unique_ptr<SpillFile> spill_file);
+
   // Returns whether the cache is completed.
   bool IsCompleted();
 
@@ -41,20 +106,32 @@ class MemoryCache {
   void Reset();
 
   // Returns the element at the given index.
+  // REQUIRES: index < in_memory_size()
   const std::vector<Tensor>& at(int64_t index);
 
+  // Appends the components of the element at the given index, which may be
+  // held in memory or in the spill file, to `element`.
+  Status GetElement(int64_t index, std::vector<Tensor>* element);
+
   // Returns the size of the cache.
   size_t size();
 
-  // Returns a reference to the cache's data. The returned reference will be
-  // invalidated by any call to Reset().
+  // Returns the number of elements held in memory.
+  size_t in_memory_size();
+
+  // Returns a reference to the cache's in-memory data. The returned reference
+  // will be invalidated by any call to Reset().
   const std::vector<std::vector<Tensor>>& data();
 
+  // Returns the spill file of the cache, or null if nothing was spilled.
+  std::shared_ptr<SpillFile> spill_file();
+
  private:
   mutex mu_;
   // Determines whether all elements of the dataset have been cached.
   bool completed_ TF_GUARDED_BY(mu_) = false;
   std::vector<std::vector<Tensor>> cache_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<SpillFile> spill_file_ TF_GUARDED_BY(mu_);
 };
 
 // A resource wrapping a shared instance of a memory cache.
@@ -126,6 +126,18 @@ class ConcatenateDatasetOp::Dataset : public DatasetBase {
     return OkStatus();
   }
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    if (index < input_cardinality_) {
+      TF_RETURN_IF_ERROR(input_->Get(ctx, index, out_tensors));
+    } else {
+      TF_RETURN_IF_ERROR(
+          to_concatenate_->Get(ctx, index - input_cardinality_, out_tensors));
+    }
+    return OkStatus();
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -0,0 +1,672 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in bucket_by_sequence_length_dataset_op.h and used both
+// here and in test cases.
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOtherArguments;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kBucketBatchSizes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddedShapes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kElementLengthFunc;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kTarguments;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kPadToBucketBoundary;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kSortWindowSize;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    BucketBySequenceLengthDatasetOp::kNumPaddedShapes;
+
+namespace {
+
+constexpr char kEndOfInput[] = "end_of_input";
+constexpr char kBuckets[] = "buckets";
+constexpr char kLengths[] = "lengths";
+constexpr char kNumReadyBatches[] = "num_ready_batches";
+constexpr char kReadyBatches[] = "ready_batches";
+constexpr char kBucketIndex[] = "bucket_index";
+
+}  // namespace
+
+// Assigns every element of its input to the bucket of its length, computed by
+// `element_length_func`, and emits padded batches of each bucket. Compared to
+// `GroupByWindowDataset` followed by `PaddedBatchDataset`, no function is run
+// per bucket and each batch is padded directly into its output tensors.
+//
+// If `sort_window_size` is greater than one, a bucket collects that many
+// batches worth of elements and sorts them by length before batching them, so
+// that elements of similar lengths are padded together.
+class BucketBySequenceLengthDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::unique_ptr<CapturedFunction> captured_func,
+          std::vector<int64_t> bucket_boundaries,
+          std::vector<int64_t> bucket_batch_sizes,
+          std::vector<PartialTensorShape> padded_shapes,
+          std::vector<Tensor> padding_values, bool drop_remainder,
+          bool pad_to_bucket_boundary, int64_t sort_window_size,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        captured_func_(std::move(captured_func)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        drop_remainder_(drop_remainder),
+        pad_to_bucket_boundary_(pad_to_bucket_boundary),
+        sort_window_size_(sort_window_size),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    TF_RETURN_IF_ERROR(captured_func_->CheckExternalState());
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    std::vector<Node*> other_arguments;
+    DataTypeVector other_arguments_types;
+    TF_RETURN_IF_ERROR(captured_func_->AddToGraph(ctx, b, &other_arguments,
+                                                  &other_arguments_types));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* bucket_batch_sizes = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_batch_sizes_, &bucket_batch_sizes));
+
+    std::vector<Node*> padded_shapes;
+    padded_shapes.reserve(padded_shapes_.size());
+    for (const PartialTensorShape& padded_shape : padded_shapes_) {
+      Node* node;
+      Tensor t(DT_INT64, TensorShape({padded_shape.dims()}));
+      for (int j = 0; j < padded_shape.dims(); ++j) {
+        t.vec<int64_t>()(j) = padded_shape.dim_size(j);
+      }
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padded_shapes.push_back(node);
+    }
+
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.push_back(node);
+    }
+
+    Node* drop_remainder = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder));
+
+    AttrValue element_length_func;
+    b->BuildAttrValue(captured_func_->func(), &element_length_func);
+    AttrValue other_arguments_types_attr;
+    b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+    AttrValue pad_to_bucket_boundary;
+    b->BuildAttrValue(pad_to_bucket_boundary_, &pad_to_bucket_boundary);
+    AttrValue sort_window_size;
+    b->BuildAttrValue(sort_window_size_, &sort_window_size);
+    AttrValue output_types;
+    b->BuildAttrValue(output_dtypes(), &output_types);
+    AttrValue num_padded_shapes;
+    b->BuildAttrValue<int64_t>(padded_shapes_.size(), &num_padded_shapes);
+
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {2, bucket_boundaries},
+         {3, bucket_batch_sizes},
+         {6, drop_remainder}},
+        {{1, other_arguments}, {4, padded_shapes}, {5, padding_values}},
+        {{kElementLengthFunc, element_length_func},
+         {kTarguments, other_arguments_types_attr},
+         {kPadToBucketBoundary, pad_to_bucket_boundary},
+         {kSortWindowSize, sort_window_size},
+         {kToutputTypes, output_types},
+         {kNumPaddedShapes, num_padded_shapes}},
+        output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->bucket_batch_sizes_.size()) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      TF_RETURN_IF_ERROR(
+          dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+      return dataset()->captured_func_->Instantiate(ctx, &instantiated_func_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      Batch batch;
+      {
+        mutex_lock l(mu_);
+        while (ready_batches_.empty()) {
+          if (!input_impl_) {
+            *end_of_sequence = true;
+            return OkStatus();
+          }
+          std::vector<Tensor> element;
+          bool end_of_input = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            for (int64_t i = 0; i < buckets_.size(); ++i) {
+              FlushBucket(i);
+            }
+            continue;
+          }
+          int64_t length;
+          TF_RETURN_IF_ERROR(ElementLength(ctx, element, length));
+          const std::vector<int64_t>& boundaries =
+              dataset()->bucket_boundaries_;
+          const int64_t bucket_index =
+              std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+              boundaries.begin();
+          if (dataset()->pad_to_bucket_boundary_ &&
+              bucket_index == boundaries.size()) {
+            return errors::InvalidArgument(
+                "When pad_to_bucket_boundary=True, elements must have length "
+                "< max(bucket_boundaries), but got an element of length ",
+                length, ".");
+          }
+          Bucket& bucket = buckets_[bucket_index];
+          bucket.elements.push_back(std::move(element));
+          bucket.lengths.push_back(length);
+          if (bucket.elements.size() ==
+              dataset()->bucket_batch_sizes_[bucket_index] *
+                  dataset()->sort_window_size_) {
+            FlushBucket(bucket_index);
+          }
+        }
+        batch = std::move(ready_batches_.front());
+        ready_batches_.pop_front();
+      }
+      *end_of_sequence = false;
+      return CopyBatch(ctx, std::move(batch), out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+          dataset()->captured_func_->CheckExternalState()));
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kEndOfInput, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        const Bucket& bucket = buckets_[i];
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, BucketPrefix(i), bucket.elements));
+        Tensor lengths(DT_INT64, TensorShape({static_cast<int64_t>(
+                                     bucket.lengths.size())}));
+        std::copy(bucket.lengths.begin(), bucket.lengths.end(),
+                  lengths.vec<int64_t>().data());
+        TF_RETURN_IF_ERROR(writer->WriteTensor(BucketPrefix(i), kLengths,
+                                               lengths));
+      }
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kNumReadyBatches,
+          static_cast<int64_t>(ready_batches_.size())));
+      for (int64_t i = 0; i < ready_batches_.size(); ++i) {
+        const Batch& batch = ready_batches_[i];
+        TF_RETURN_IF_ERROR(writer->WriteScalar(ReadyBatchPrefix(i),
+                                               kBucketIndex,
+                                               batch.bucket_index));
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, ReadyBatchPrefix(i), batch.elements));
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t end_of_input;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEndOfInput,
+                                            &end_of_input));
+      if (static_cast<bool>(end_of_input)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      for (int64_t i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        bucket.elements.clear();
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, BucketPrefix(i), &bucket.elements));
+        Tensor lengths;
+        TF_RETURN_IF_ERROR(reader->ReadTensor(BucketPrefix(i), kLengths,
+                                              &lengths));
+        if (lengths.NumElements() != bucket.elements.size()) {
+          return errors::DataLoss("Expected ", bucket.elements.size(),
+                                  " lengths for bucket ", i, ", but found ",
+                                  lengths.NumElements(), ".");
+        }
+        auto lengths_vec = lengths.vec<int64_t>();
+        bucket.lengths.assign(lengths_vec.data(),
+                              lengths_vec.data() + lengths_vec.size());
+      }
+      int64_t num_ready_batches;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumReadyBatches,
+                                            &num_ready_batches));
+      ready_batches_.clear();
+      for (int64_t i = 0; i < num_ready_batches; ++i) {
+        Batch batch;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            ReadyBatchPrefix(i), kBucketIndex, &batch.bucket_index));
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, ReadyBatchPrefix(i), &batch.elements));
+        ready_batches_.push_back(std::move(batch));
+      }
+      return OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      const int64_t num_values = num_values_.load();
+      const double padding_ratio =
+          num_values == 0 ? 0.0
+                          : static_cast<double>(num_padding_values_.load()) /
+                                num_values;
+      return {{"padding_ratio", strings::Printf("%.2f", padding_ratio)}};
+    }
+
+   private:
+    // The elements of a bucket which are not batched yet, and their lengths.
+    struct Bucket {
+      std::vector<std::vector<Tensor>> elements;
+      std::vector<int64_t> lengths;
+    };
+
+    // The elements of a batch of one bucket, which are not padded yet.
+    struct Batch {
+      int64_t bucket_index = 0;
+      std::vector<std::vector<Tensor>> elements;
+    };
+
+    std::string BucketPrefix(int64_t bucket_index) const {
+      return full_name(strings::StrCat(kBuckets, "[", bucket_index, "]"));
+    }
+
+    std::string ReadyBatchPrefix(int64_t batch_index) const {
+      return full_name(strings::StrCat(kReadyBatches, "[", batch_index, "]"));
+    }
+
+    // Runs `element_length_func` on `element`.
+    Status ElementLength(IteratorContext* ctx,
+                         const std::vector<Tensor>& element, int64_t& length)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<Tensor> func_output;
+      TF_RETURN_IF_ERROR(instantiated_func_->RunWithBorrowedArgs(
+          ctx, element, &func_output, model_node()));
+      if (func_output.size() != 1 ||
+          !TensorShapeUtils::IsScalar(func_output[0].shape()) ||
+          (func_output[0].dtype() != DT_INT32 &&
+           func_output[0].dtype() != DT_INT64)) {
+        return errors::InvalidArgument(
+            "`element_length_func` must return a scalar int32 or int64.");
+      }
+      length = func_output[0].dtype() == DT_INT32
+                   ? func_output[0].scalar<int32>()()
+                   : func_output[0].scalar<int64_t>()();
+      return OkStatus();
+    }
+
+    // Moves the elements of a bucket into batches that are ready to be padded.
+    // Only the last batch can be partial, and it is dropped if
+    // `drop_remainder` is set.
+    void FlushBucket(int64_t bucket_index) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[bucket_index];
+      const int64_t num_elements = bucket.elements.size();
+      std::vector<int64_t> order(num_elements);
+      std::iota(order.begin(), order.end(), 0);
+      if (dataset()->sort_window_size_ > 1) {
+        std::stable_sort(order.begin(), order.end(),
+                         [&bucket](int64_t a, int64_t b) {
+                           return bucket.lengths[a] < bucket.lengths[b];
+                         });
+      }
+      const int64_t batch_size = dataset()->bucket_batch_sizes_[bucket_index];
+      for (int64_t start = 0; start < num_elements; start += batch_size) {
+        const int64_t end = std::min(start + batch_size, num_elements);
+        if (end - start < batch_size && dataset()->drop_remainder_) {
+          break;
+        }
+        Batch batch;
+        batch.bucket_index = bucket_index;
+        batch.elements.reserve(end - start);
+        for (int64_t i = start; i < end; ++i) {
+          batch.elements.push_back(std::move(bucket.elements[order[i]]));
+        }
+        ready_batches_.push_back(std::move(batch));
+      }
+      bucket.elements.clear();
+      bucket.lengths.clear();
+    }
+
+    // Pads the elements of `batch` into one output tensor per component.
+    Status CopyBatch(IteratorContext* ctx, Batch batch,
+                     std::vector<Tensor>* out_tensors) {
+      const int64_t num_batch_elements = batch.elements.size();
+      // The size of the dimensions with unknown padded size, when the batch is
+      // padded to its bucket boundary.
+      const int64_t bucket_padded_size =
+          dataset()->pad_to_bucket_boundary_
+              ? dataset()->bucket_boundaries_[batch.bucket_index] - 1
+              : 0;
+      int64_t num_values = 0;
+      int64_t num_element_values = 0;
+      out_tensors->reserve(dataset()->padded_shapes_.size());
+      for (size_t component_index = 0;
+           component_index < dataset()->padded_shapes_.size();
+           ++component_index) {
+        const PartialTensorShape& padded_shape =
+            dataset()->padded_shapes_[component_index];
+        TensorShape component_shape;
+        for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+          TF_RETURN_IF_ERROR(component_shape.AddDimWithStatus(
+              padded_shape.dim_size(dim) == -1 ? bucket_padded_size
+                                               : padded_shape.dim_size(dim)));
+        }
+        for (const std::vector<Tensor>& element : batch.elements) {
+          const TensorShape& element_shape = element[component_index].shape();
+          if (element_shape.dims() != padded_shape.dims()) {
+            return errors::InvalidArgument(
+                "All elements in a batch must have the same rank as the "
+                "padded shape for component ",
+                component_index, ": expected rank ", padded_shape.dims(),
+                " but got element with rank ", element_shape.dims());
+          }
+          for (int dim = 0; dim < padded_shape.dims(); ++dim) {
+            if (padded_shape.dim_size(dim) == -1 &&
+                !dataset()->pad_to_bucket_boundary_) {
+              component_shape.set_dim(
+                  dim, std::max(component_shape.dim_size(dim),
+                                element_shape.dim_size(dim)));
+            } else if (element_shape.dim_size(dim) >
+                       component_shape.dim_size(dim)) {
+              return errors::DataLoss(
+                  "Attempted to pad to a smaller size than the input "
+                  "element.");
+            }
+          }
+        }
+
+        TensorShape batch_component_shape({num_batch_elements});
+        batch_component_shape.AppendShape(component_shape);
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  output_dtypes()[component_index],
+                                  batch_component_shape);
+        Tensor& batch_component = out_tensors->back();
+        bool needs_padding = false;
+        for (const std::vector<Tensor>& element : batch.elements) {
+          needs_padding |= element[component_index].shape() != component_shape;
+        }
+        if (needs_padding) {
+          TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+              &batch_component, dataset()->padding_values_[component_index]));
+        }
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          Tensor& value = batch.elements[i][component_index];
+          num_element_values += value.NumElements();
+          if (value.shape() == component_shape) {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
+                std::move(value), &batch_component, i));
+          } else {
+            TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+                value, &batch_component, i));
+          }
+        }
+        num_values += batch_component.NumElements();
+      }
+      if (num_values > 0) {
+        num_values_ += num_values;
+        num_padding_values_ += num_values - num_element_values;
+        metrics::RecordTFDataPaddingRatio(
+            static_cast<double>(num_values - num_element_values) / num_values);
+      }
+      return OkStatus();
+    }
+
+    mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    std::deque<Batch> ready_batches_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<InstantiatedCapturedFunction> instantiated_func_;
+    // Number of values and of padding values in the produced batches.
+    std::atomic<int64_t> num_values_{0};
+    std::atomic<int64_t> num_padding_values_{0};
+  };
+
+  const DatasetBase* const input_;
+  const std::unique_ptr<CapturedFunction> captured_func_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const std::vector<int64_t> bucket_batch_sizes_;
+  const std::vector<PartialTensorShape> padded_shapes_;
+  const std::vector<Tensor> padding_values_;
+  const bool drop_remainder_;
+  const bool pad_to_bucket_boundary_;
+  const int64_t sort_window_size_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};  // BucketBySequenceLengthDatasetOp::Dataset
+
+BucketBySequenceLengthDatasetOp::BucketBySequenceLengthDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, FunctionMetadata::Create(ctx, kElementLengthFunc,
+                                               /*params=*/{}, &func_metadata_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr(kPadToBucketBoundary, &pad_to_bucket_boundary_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kSortWindowSize, &sort_window_size_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kToutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void BucketBySequenceLengthDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                                  DatasetBase* input,
+                                                  DatasetBase** output) {
+  std::vector<int64_t> bucket_boundaries;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBoundaries,
+                                                   &bucket_boundaries));
+  OP_REQUIRES(
+      ctx,
+      std::adjacent_find(bucket_boundaries.begin(), bucket_boundaries.end(),
+                         std::greater_equal<int64_t>()) ==
+          bucket_boundaries.end(),
+      errors::InvalidArgument(
+          "Bucket boundaries must be strictly increasing."));
+  std::vector<int64_t> bucket_batch_sizes;
+  OP_REQUIRES_OK(ctx, ParseVectorArgument<int64_t>(ctx, kBucketBatchSizes,
+                                                   &bucket_batch_sizes));
+  OP_REQUIRES(
+      ctx, bucket_batch_sizes.size() == bucket_boundaries.size() + 1,
+      errors::InvalidArgument(
+          "The number of bucket batch sizes (", bucket_batch_sizes.size(),
+          ") must be one more than the number of bucket boundaries (",
+          bucket_boundaries.size(), ")."));
+  for (int64_t batch_size : bucket_batch_sizes) {
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument(
+                    "Bucket batch sizes must be greater than zero."));
+  }
+  bool drop_remainder;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<bool>(ctx, kDropRemainder, &drop_remainder));
+
+  OpInputList padded_shape_tensors;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddedShapes, &padded_shape_tensors));
+  OP_REQUIRES(ctx, padded_shape_tensors.size() == input->output_shapes().size(),
+              errors::InvalidArgument("Number of padded shapes (",
+                                      padded_shape_tensors.size(),
+                                      ") must match the number of components "
+                                      "in the input dataset's elements (",
+                                      input->output_shapes().size(), ")"));
+  std::vector<PartialTensorShape> padded_shapes;
+  padded_shapes.reserve(padded_shape_tensors.size());
+  for (const Tensor& padded_shape_t : padded_shape_tensors) {
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(padded_shape_t.shape()),
+                errors::InvalidArgument("All padded shapes must be vectors"));
+    PartialTensorShape padded_shape;
+    OP_REQUIRES_OK(ctx, PartialTensorShape::MakePartialShape(
+                            padded_shape_t.vec<int64_t>().data(),
+                            padded_shape_t.NumElements(), &padded_shape));
+    padded_shapes.push_back(std::move(padded_shape));
+  }
+
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == input->output_shapes().size(),
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  input->output_shapes().size(), ")"));
+  std::vector<Tensor> padding_values;
+  padding_values.reserve(padding_values_list.size());
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  std::unique_ptr<CapturedFunction> captured_func;
+  OP_REQUIRES_OK(ctx,
+                 CapturedFunction::Create(ctx, func_metadata_, kOtherArguments,
+                                          &captured_func));
+
+  *output = new Dataset(ctx, input, std::move(captured_func),
+                        std::move(bucket_boundaries),
+                        std::move(bucket_batch_sizes), std::move(padded_shapes),
+                        std::move(padding_values), drop_remainder,
+                        pad_to_bucket_boundary_, sort_window_size_,
+                        output_types_, output_shapes_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(
+    Name("BucketBySequenceLengthDataset").Device(DEVICE_CPU),
+    BucketBySequenceLengthDatasetOp);
+
+REGISTER_INPUT_COLOCATION_EXEMPTION("BucketBySequenceLengthDataset");
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
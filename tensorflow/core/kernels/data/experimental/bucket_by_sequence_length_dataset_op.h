@@ -0,0 +1,70 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_BUCKET_BY_SEQUENCE_LENGTH_DATASET_OP_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_BUCKET_BY_SEQUENCE_LENGTH_DATASET_OP_H_
+
+#include "tensorflow/core/data/captured_function.h"
+#include "tensorflow/core/framework/dataset.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See
+// tensorflow/core/api_def/base_api/api_def_BucketBySequenceLengthDataset.pbtxt
+// for the API definition that corresponds to this kernel.
+class BucketBySequenceLengthDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  // Names of op parameters, public so that they can be accessed by test cases.
+  // Make sure that these are kept in sync with the REGISTER_OP call in
+  // tensorflow/core/ops/experimental_dataset_ops.cc
+  static constexpr const char* const kDatasetType = "BucketBySequenceLength";
+  static constexpr const char* const kInputDataset = "input_dataset";
+  static constexpr const char* const kOtherArguments = "other_arguments";
+  static constexpr const char* const kBucketBoundaries = "bucket_boundaries";
+  static constexpr const char* const kBucketBatchSizes = "bucket_batch_sizes";
+  static constexpr const char* const kPaddedShapes = "padded_shapes";
+  static constexpr const char* const kPaddingValues = "padding_values";
+  static constexpr const char* const kDropRemainder = "drop_remainder";
+  static constexpr const char* const kElementLengthFunc = "element_length_func";
+  static constexpr const char* const kTarguments = "Targuments";
+  static constexpr const char* const kPadToBucketBoundary =
+      "pad_to_bucket_boundary";
+  static constexpr const char* const kSortWindowSize = "sort_window_size";
+  static constexpr const char* const kToutputTypes = "Toutput_types";
+  static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kNumPaddedShapes = "N";
+
+  explicit BucketBySequenceLengthDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  std::shared_ptr<FunctionMetadata> func_metadata_ = nullptr;
+  bool pad_to_bucket_boundary_;
+  int64_t sort_window_size_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_BUCKET_BY_SEQUENCE_LENGTH_DATASET_OP_H_
@@ -0,0 +1,319 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_sequence_length_dataset_op.h"
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_sequence_length_dataset";
+
+class BucketBySequenceLengthDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketBySequenceLengthDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      std::vector<int64_t> bucket_batch_sizes,
+      std::vector<Tensor> padded_shapes, std::vector<Tensor> padding_values,
+      bool drop_remainder, bool pad_to_bucket_boundary,
+      int64_t sort_window_size, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        bucket_batch_sizes_(std::move(bucket_batch_sizes)),
+        padded_shapes_(std::move(padded_shapes)),
+        padding_values_(std::move(padding_values)),
+        drop_remainder_(drop_remainder),
+        pad_to_bucket_boundary_(pad_to_bucket_boundary),
+        sort_window_size_(sort_window_size) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors;
+    input_tensors.push_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+        bucket_boundaries_));
+    input_tensors.push_back(CreateTensor<int64_t>(
+        TensorShape({static_cast<int64_t>(bucket_batch_sizes_.size())}),
+        bucket_batch_sizes_));
+    for (const Tensor& padded_shape : padded_shapes_) {
+      input_tensors.push_back(padded_shape);
+    }
+    for (const Tensor& padding_value : padding_values_) {
+      input_tensors.push_back(padding_value);
+    }
+    input_tensors.push_back(
+        CreateTensor<bool>(TensorShape({}), {drop_remainder_}));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketBySequenceLengthDatasetOp::kInputDataset,
+                    BucketBySequenceLengthDatasetOp::kBucketBoundaries,
+                    BucketBySequenceLengthDatasetOp::kBucketBatchSizes};
+    for (int i = 0; i < padded_shapes_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketBySequenceLengthDatasetOp::kPaddedShapes, "_", i));
+    }
+    for (int i = 0; i < padding_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketBySequenceLengthDatasetOp::kPaddingValues, "_", i));
+    }
+    input_names->push_back(BucketBySequenceLengthDatasetOp::kDropRemainder);
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {
+        {BucketBySequenceLengthDatasetOp::kElementLengthFunc,
+         FunctionDefHelper::FunctionRef("ElementLength", {})},
+        {BucketBySequenceLengthDatasetOp::kTarguments, DataTypeVector()},
+        {BucketBySequenceLengthDatasetOp::kPadToBucketBoundary,
+         pad_to_bucket_boundary_},
+        {BucketBySequenceLengthDatasetOp::kSortWindowSize, sort_window_size_},
+        {BucketBySequenceLengthDatasetOp::kToutputTypes, output_dtypes_},
+        {BucketBySequenceLengthDatasetOp::kOutputShapes, output_shapes_},
+        {BucketBySequenceLengthDatasetOp::kNumPaddedShapes,
+         static_cast<int64_t>(padded_shapes_.size())},
+        {"metadata", ""}};
+    return OkStatus();
+  }
+
+  std::vector<FunctionDef> func_lib() const override {
+    // Returns the number of values of an int64 element.
+    return {FunctionDefHelper::Define(
+        "ElementLength", {"x: int64"}, {"y: int64"}, {},
+        {{{"y"}, "Size", {"x"}, {{"T", DT_INT64}, {"out_type", DT_INT64}}}})};
+  }
+
+  string dataset_type() const override {
+    return BucketBySequenceLengthDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  std::vector<int64_t> bucket_batch_sizes_;
+  std::vector<Tensor> padded_shapes_;
+  std::vector<Tensor> padding_values_;
+  bool drop_remainder_;
+  bool pad_to_bucket_boundary_;
+  int64_t sort_window_size_;
+};
+
+class BucketBySequenceLengthDatasetOpTest : public DatasetOpsTestBase {};
+
+// Three elements of length 2 followed by three elements of length 1 when
+// `long_first` is set, and the other way around otherwise.
+ConcatenateDatasetParams MixedLengthDatasetParams(bool long_first) {
+  auto short_elements = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3, 1}, {0, 1, 2})},
+      /*node_name=*/"short_elements");
+  auto long_elements = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(TensorShape{3, 2},
+                                            {3, 4, 5, 6, 7, 8})},
+      /*node_name=*/"long_elements");
+  return ConcatenateDatasetParams(
+      long_first ? long_elements : short_elements,
+      long_first ? short_elements : long_elements,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/"concatenate");
+}
+
+BucketBySequenceLengthDatasetParams MakeParams(
+    bool long_first, std::vector<int64_t> bucket_boundaries,
+    std::vector<int64_t> bucket_batch_sizes, bool drop_remainder,
+    bool pad_to_bucket_boundary, int64_t sort_window_size) {
+  return BucketBySequenceLengthDatasetParams(
+      MixedLengthDatasetParams(long_first), std::move(bucket_boundaries),
+      std::move(bucket_batch_sizes),
+      /*padded_shapes=*/{CreateTensor<int64_t>(TensorShape{1}, {-1})},
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      drop_remainder, pad_to_bucket_boundary, sort_window_size,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// Test case 1: full batches of each bucket, then the partial ones.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams1() {
+  return MakeParams(/*long_first=*/false, /*bucket_boundaries=*/{2},
+                    /*bucket_batch_sizes=*/{2, 2}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/false, /*sort_window_size=*/1);
+}
+
+// Test case 2: padding to the bucket boundaries and dropping the remainders.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams2() {
+  return MakeParams(/*long_first=*/false, /*bucket_boundaries=*/{2, 4},
+                    /*bucket_batch_sizes=*/{2, 2, 2}, /*drop_remainder=*/true,
+                    /*pad_to_bucket_boundary=*/true, /*sort_window_size=*/1);
+}
+
+// Test case 3: a single bucket whose elements are sorted by length.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams3() {
+  return MakeParams(/*long_first=*/true, /*bucket_boundaries=*/{},
+                    /*bucket_batch_sizes=*/{2}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/false, /*sort_window_size=*/2);
+}
+
+// Test case 4: a single bucket whose elements are padded to the batch maximum.
+BucketBySequenceLengthDatasetParams BucketBySequenceLengthDatasetParams4() {
+  return MakeParams(/*long_first=*/true, /*bucket_boundaries=*/{},
+                    /*bucket_batch_sizes=*/{4}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/false, /*sort_window_size=*/1);
+}
+
+// Test case 5: an element is too long to be padded to a bucket boundary.
+BucketBySequenceLengthDatasetParams TooLongElementParams() {
+  return MakeParams(/*long_first=*/false, /*bucket_boundaries=*/{2},
+                    /*bucket_batch_sizes=*/{2, 2}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/true, /*sort_window_size=*/1);
+}
+
+BucketBySequenceLengthDatasetParams InvalidBucketBatchSizesCountParams() {
+  return MakeParams(/*long_first=*/false, /*bucket_boundaries=*/{2},
+                    /*bucket_batch_sizes=*/{2}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/false, /*sort_window_size=*/1);
+}
+
+BucketBySequenceLengthDatasetParams InvalidBucketBatchSizeParams() {
+  return MakeParams(/*long_first=*/false, /*bucket_boundaries=*/{2},
+                    /*bucket_batch_sizes=*/{2, 0}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/false, /*sort_window_size=*/1);
+}
+
+BucketBySequenceLengthDatasetParams UnsortedBucketBoundariesParams() {
+  return MakeParams(/*long_first=*/false, /*bucket_boundaries=*/{3, 2},
+                    /*bucket_batch_sizes=*/{2, 2, 2}, /*drop_remainder=*/false,
+                    /*pad_to_bucket_boundary=*/false, /*sort_window_size=*/1);
+}
+
+std::vector<Tensor> ExpectedOutputs1() {
+  return {CreateTensor<int64_t>(TensorShape{2, 1}, {0, 1}),
+          CreateTensor<int64_t>(TensorShape{2, 2}, {3, 4, 5, 6}),
+          CreateTensor<int64_t>(TensorShape{1, 1}, {2}),
+          CreateTensor<int64_t>(TensorShape{1, 2}, {7, 8})};
+}
+
+std::vector<GetNextTestCase<BucketBySequenceLengthDatasetParams>>
+GetNextTestCases() {
+  return {
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+       /*expected_outputs=*/ExpectedOutputs1()},
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams2(),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape{2, 1}, {0, 1}),
+        CreateTensor<int64_t>(TensorShape{2, 3}, {3, 4, -1, 5, 6, -1})}},
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams3(),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape{2, 2}, {0, -1, 3, 4}),
+        CreateTensor<int64_t>(TensorShape{2, 2}, {5, 6, 7, 8}),
+        CreateTensor<int64_t>(TensorShape{2, 1}, {1, 2})}},
+      {/*dataset_params=*/BucketBySequenceLengthDatasetParams4(),
+       /*expected_outputs=*/
+       {CreateTensor<int64_t>(TensorShape{4, 2}, {3, 4, 5, 6, 7, 8, 0, -1}),
+        CreateTensor<int64_t>(TensorShape{2, 1}, {1, 2})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         GetNextTestCases())
+
+TEST_F(BucketBySequenceLengthDatasetOpTest, TooLongElement) {
+  auto dataset_params = TooLongElementParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  // The first batch only holds short elements.
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence));
+  EXPECT_EQ(
+      iterator_->GetNext(iterator_ctx_.get(), &out_tensors, &end_of_sequence)
+          .code(),
+      absl::StatusCode::kInvalidArgument);
+}
+
+std::vector<DatasetNodeNameTestCase<BucketBySequenceLengthDatasetParams>>
+DatasetNodeNameTestCases() {
+  return {{/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+           /*expected_node_name=*/kNodeName}};
+}
+
+DATASET_NODE_NAME_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                         BucketBySequenceLengthDatasetParams,
+                         DatasetNodeNameTestCases())
+
+std::vector<DatasetTypeStringTestCase<BucketBySequenceLengthDatasetParams>>
+DatasetTypeStringTestCases() {
+  return {{/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+           /*expected_dataset_type_string=*/name_utils::OpName(
+               BucketBySequenceLengthDatasetOp::kDatasetType)}};
+}
+
+DATASET_TYPE_STRING_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                           BucketBySequenceLengthDatasetParams,
+                           DatasetTypeStringTestCases())
+
+std::vector<CardinalityTestCase<BucketBySequenceLengthDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+           /*expected_cardinality=*/kUnknownCardinality}};
+}
+
+DATASET_CARDINALITY_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                           BucketBySequenceLengthDatasetParams,
+                           CardinalityTestCases())
+
+std::vector<
+    IteratorSaveAndRestoreTestCase<BucketBySequenceLengthDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/BucketBySequenceLengthDatasetParams1(),
+           /*breakpoints=*/{0, 1, 2, 3, 5},
+           /*expected_outputs=*/ExpectedOutputs1()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketBySequenceLengthDatasetOpTest,
+                                 BucketBySequenceLengthDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+class ParameterizedInvalidArgumentTest
+    : public BucketBySequenceLengthDatasetOpTest,
+      public ::testing::WithParamInterface<
+          BucketBySequenceLengthDatasetParams> {};
+
+TEST_P(ParameterizedInvalidArgumentTest, InvalidArguments) {
+  auto dataset_params = GetParam();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BucketBySequenceLengthDatasetOpTest, ParameterizedInvalidArgumentTest,
+    ::testing::ValuesIn({InvalidBucketBatchSizesCountParams(),
+                         InvalidBucketBatchSizeParams(),
+                         UnsortedBucketBoundariesParams()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -12,6 +12,9 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstdint>
+#include <cstring>
+
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
@@ -26,6 +29,38 @@ namespace data {
 namespace experimental {
 namespace {
 
+// Returns the first byte of [begin, end) which is one of `a`, `b`, `c` or `d`,
+// or `end` if there is none. The bytes are compared eight at a time within a
+// 64-bit word, so that long fields don't cost a branch per byte.
+const char* FindFirstOf(const char* begin, const char* end, char a, char b,
+                        char c, char d) {
+  constexpr uint64_t kOnes = 0x0101010101010101ULL;
+  constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+  const uint64_t a_word = kOnes * static_cast<uint8_t>(a);
+  const uint64_t b_word = kOnes * static_cast<uint8_t>(b);
+  const uint64_t c_word = kOnes * static_cast<uint8_t>(c);
+  const uint64_t d_word = kOnes * static_cast<uint8_t>(d);
+  // `(x - kOnes) & ~x & kHighBits` is non-zero if and only if `x` has a zero
+  // byte.
+  auto has_zero_byte = [](uint64_t x) {
+    return ((x - kOnes) & ~x & kHighBits) != 0;
+  };
+  while (end - begin >= static_cast<ptrdiff_t>(sizeof(uint64_t))) {
+    uint64_t word;
+    memcpy(&word, begin, sizeof(word));
+    if (has_zero_byte(word ^ a_word) || has_zero_byte(word ^ b_word) ||
+        has_zero_byte(word ^ c_word) || has_zero_byte(word ^ d_word)) {
+      break;
+    }
+    begin += sizeof(uint64_t);
+  }
+  for (; begin < end; ++begin) {
+    const char ch = *begin;
+    if (ch == a || ch == b || ch == c || ch == d) break;
+  }
+  return begin;
+}
+
 class CSVDatasetOp : public DatasetOpKernel {
  public:
   explicit CSVDatasetOp(OpKernelConstruction* ctx)
@@ -508,7 +543,8 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter reads up to a quote, filling buffer if
+                        // necessary
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -520,49 +556,52 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
-          char ch = buffer_[pos_];
-          if (ch == '"') {
-            // When we encounter a quote, we look ahead to the next character to
-            // decide what to do
-            pos_++;
-            if (pos_ >= buffer_.size()) {
-              Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
-              if (errors::IsOutOfRange(s)) {
-                // This was the last field. We are done
-                *end_of_record = true;
-                parse_result.Update(QuotedFieldToOutput(
-                    ctx, StringPiece(), out_tensors, earlier_pieces, include));
-                return parse_result;
-              } else if (!s.ok()) {
-                return s;
-              }
-            }
-
-            char next = buffer_[pos_];
-            pos_++;
-            if (next == dataset()->delim_) {
-              parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              return parse_result;
+          // Skip to the next quote, the only character which can end the field.
+          const char* quote = static_cast<const char*>(
+              memchr(&buffer_[pos_], '"', buffer_.size() - pos_));
+          if (quote == nullptr) {
+            pos_ = buffer_.size();
+            continue;
+          }
+          pos_ = quote - buffer_.data();
 
-            } else if (next == '\n' || next == '\r') {
+          // When we encounter a quote, we look ahead to the next character to
+          // decide what to do
+          pos_++;
+          if (pos_ >= buffer_.size()) {
+            Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
+            if (errors::IsOutOfRange(s)) {
+              // This was the last field. We are done
               *end_of_record = true;
               parse_result.Update(QuotedFieldToOutput(
-                  ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
-                  out_tensors, earlier_pieces, include));
-              if (next == '\r') SkipNewLineIfNecessary();
+                  ctx, StringPiece(), out_tensors, earlier_pieces, include));
               return parse_result;
-            } else if (next != '"') {
-              // Take note of the error, but keep going to end of field.
-              include = false;  // So we don't get funky errors when trying to
-                                // unescape the quotes.
-              parse_result.Update(errors::InvalidArgument(
-                  "Quote inside a string has to be escaped by another quote"));
+            } else if (!s.ok()) {
+              return s;
             }
+          }
 
-          } else {
-            pos_++;
+          char next = buffer_[pos_];
+          pos_++;
+          if (next == dataset()->delim_) {
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            return parse_result;
+
+          } else if (next == '\n' || next == '\r') {
+            *end_of_record = true;
+            parse_result.Update(QuotedFieldToOutput(
+                ctx, StringPiece(&buffer_[start], pos_ - 1 - start),
+                out_tensors, earlier_pieces, include));
+            if (next == '\r') SkipNewLineIfNecessary();
+            return parse_result;
+          } else if (next != '"') {
+            // Take note of the error, but keep going to end of field.
+            include = false;  // So we don't get funky errors when trying to
+                              // unescape the quotes.
+            parse_result.Update(errors::InvalidArgument(
+                "Quote inside a string has to be escaped by another quote"));
           }
         }
       }
@@ -641,7 +680,11 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        const char delim = dataset()->delim_;
+        // Quotes are only looked for to report them as errors.
+        const char quote = dataset()->use_quote_delim_ ? '"' : '\n';
+        while (true) {  // Each iter skips to the next special char, filling
+                        // buffer if necessary
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -657,6 +700,12 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          const char* buffer_end = buffer_.data() + buffer_.size();
+          pos_ = FindFirstOf(&buffer_[pos_], buffer_end, delim, '\n', '\r',
+                             quote) -
+                 buffer_.data();
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -789,7 +838,8 @@ class CSVDatasetOp : public DatasetOpKernel {
               component.scalar<tstring>()() =
                   dataset()->record_defaults_[output_idx].flat<tstring>()(0);
             } else {
-              component.scalar<tstring>()() = string(field);
+              component.scalar<tstring>()().assign(field.data(),
+                                                   field.size());
             }
             break;
           }
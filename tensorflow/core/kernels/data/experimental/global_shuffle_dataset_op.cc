@@ -0,0 +1,255 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <array>
+#include <atomic>
+#include <utility>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
+#include "tensorflow/core/platform/hash.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kNextIndex[] = "next_index";
+constexpr char kEpoch[] = "epoch";
+
+// Number of rounds of the `random::index_shuffle` cipher, see
+// random_index_shuffle.h.
+constexpr int32_t kShuffleRounds = 8;
+
+}  // namespace
+
+// Emits the elements of a random access compatible input in the order of a
+// pseudo-random permutation of [0, cardinality). Each element is read with
+// `DatasetBase::Get`, and its position is computed with a stateless bijection,
+// so unlike `ShuffleDataset` no buffer of elements is kept and every epoch is
+// a uniform shuffle of the whole input rather than of a window of it.
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t cardinality,
+          std::pair<int64_t, int64_t> seeds, bool reshuffle_each_iteration)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        cardinality_(cardinality),
+        seeds_(std::move(seeds)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    // Every new iterator is a new epoch, unless the permutation is fixed.
+    const int64_t epoch = reshuffle_each_iteration_ ? next_epoch_++ : 0;
+    return std::make_unique<Iterator>(
+        Iterator::Params{this,
+                         name_utils::IteratorPrefix(kDatasetType, prefix)},
+        epoch);
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return cardinality_;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+  // Random access uses the permutation of the first epoch.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx, ShuffledIndex(index, /*epoch=*/0), out_tensors);
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx, ShuffledIndex(index, /*epoch=*/0), out_tensors);
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed = nullptr;
+    Node* seed2 = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.first, &seed));
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.second, &seed2));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {input_graph_node, seed, seed2},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    Iterator(const Params& params, int64_t epoch)
+        : DatasetIterator<Dataset>(params), epoch_(epoch) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      int64_t next_index;
+      int64_t epoch;
+      {
+        mutex_lock l(mu_);
+        if (next_index_ >= dataset()->cardinality_) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        next_index = next_index_++;
+        epoch = epoch_;
+      }
+      *end_of_sequence = false;
+      return dataset()->input_->Get(
+          ctx, dataset()->ShuffledIndex(next_index, epoch), out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      // The input is read by index rather than through an input iterator.
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNextIndex),
+                                             next_index_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kEpoch), epoch_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNextIndex),
+                                            &next_index_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpoch), &epoch_));
+      return OkStatus();
+    }
+
+   private:
+    mutex mu_;
+    int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+    int64_t epoch_ TF_GUARDED_BY(mu_);
+  };
+
+  // Returns the position in the input of the `index`-th element of `epoch`.
+  int64_t ShuffledIndex(int64_t index, int64_t epoch) const {
+    const uint64 hash =
+        Hash64Combine(Hash64Combine(seeds_.first, seeds_.second), epoch);
+    const std::array<uint32_t, 3> key = {static_cast<uint32_t>(hash),
+                                         static_cast<uint32_t>(hash >> 32),
+                                         static_cast<uint32_t>(epoch)};
+    return static_cast<int64_t>(
+        random::index_shuffle(index, key, cardinality_ - 1, kShuffleRounds));
+  }
+
+  const DatasetBase* const input_;
+  const int64_t cardinality_;
+  const std::pair<int64_t, int64_t> seeds_;
+  const bool reshuffle_each_iteration_;
+  mutable std::atomic<int64_t> next_epoch_{0};
+};  // GlobalShuffleDatasetOp::Dataset
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  int64_t seed;
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  const int64_t cardinality = input->Cardinality(options);
+  OP_REQUIRES(
+      ctx, cardinality != kInfiniteCardinality &&
+               cardinality != kUnknownCardinality,
+      errors::FailedPrecondition(
+          "`global_shuffle` requires the input dataset to have a known, finite "
+          "cardinality, but the cardinality of ",
+          input->DebugString(), " is ",
+          cardinality == kInfiniteCardinality ? "infinite" : "unknown", "."));
+
+  // The seeds are resolved here rather than in the iterators, so that all the
+  // iterators of the dataset agree on the permutation of every epoch and a
+  // serialized dataset keeps producing the same permutations.
+  *output = new Dataset(ctx, input, cardinality,
+                        MaybeOverrideSeeds({seed, seed2}),
+                        reshuffle_each_iteration_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
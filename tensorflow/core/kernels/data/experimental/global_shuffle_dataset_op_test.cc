@@ -0,0 +1,232 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+constexpr int64_t kRandomSeed = 42;
+constexpr int64_t kRandomSeed2 = 7;
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params,
+                             bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {kRandomSeed}),
+            CreateTensor<int64_t>(TensorShape({}), {kRandomSeed2})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Reads all the remaining elements of `iterator`.
+  std::vector<int64_t> ReadAll(TestIterator* iterator) {
+    std::vector<int64_t> values;
+    bool end_of_sequence = false;
+    while (true) {
+      std::vector<Tensor> out_tensors;
+      TF_EXPECT_OK(iterator->GetNext(&out_tensors, &end_of_sequence));
+      if (end_of_sequence) break;
+      values.push_back(out_tensors[0].scalar<int64_t>()());
+    }
+    return values;
+  }
+
+  // Checks that `values` is a permutation of [0, n) and not the identity.
+  void ExpectShuffled(std::vector<int64_t> values, int64_t n) {
+    std::vector<int64_t> range(n);
+    for (int64_t i = 0; i < n; ++i) range[i] = i;
+    EXPECT_NE(values, range);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(values, range);
+  }
+};
+
+GlobalShuffleDatasetParams ReshuffleParams() {
+  return GlobalShuffleDatasetParams(RangeDatasetParams(0, 100, 1),
+                                    /*reshuffle_each_iteration=*/true,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/{PartialTensorShape({})},
+                                    /*node_name=*/kNodeName);
+}
+
+GlobalShuffleDatasetParams FixedOrderParams() {
+  return GlobalShuffleDatasetParams(RangeDatasetParams(0, 100, 1),
+                                    /*reshuffle_each_iteration=*/false,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/{PartialTensorShape({})},
+                                    /*node_name=*/kNodeName);
+}
+
+GlobalShuffleDatasetParams EmptyInputParams() {
+  return GlobalShuffleDatasetParams(RangeDatasetParams(0, 0, 1),
+                                    /*reshuffle_each_iteration=*/true,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/{PartialTensorShape({})},
+                                    /*node_name=*/kNodeName);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ReshuffleEachIteration) {
+  auto dataset_params = ReshuffleParams();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> first_iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &first_iterator));
+  std::unique_ptr<TestIterator> second_iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &second_iterator));
+
+  std::vector<int64_t> first_epoch = ReadAll(first_iterator.get());
+  std::vector<int64_t> second_epoch = ReadAll(second_iterator.get());
+  ExpectShuffled(first_epoch, 100);
+  ExpectShuffled(second_epoch, 100);
+  EXPECT_NE(first_epoch, second_epoch);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, FixedOrder) {
+  auto dataset_params = FixedOrderParams();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::unique_ptr<TestIterator> first_iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &first_iterator));
+  std::unique_ptr<TestIterator> second_iterator;
+  TF_ASSERT_OK(MakeIterator(dataset_params, *dataset, &second_iterator));
+
+  std::vector<int64_t> first_epoch = ReadAll(first_iterator.get());
+  ExpectShuffled(first_epoch, 100);
+  EXPECT_EQ(first_epoch, ReadAll(second_iterator.get()));
+
+  // Random access follows the permutation of the first epoch.
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset->dataset()->Get(dataset->op_kernel_context(), i,
+                                         &out_tensors));
+    EXPECT_EQ(out_tensors[0].scalar<int64_t>()(), first_epoch[i]);
+  }
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, EmptyInput) {
+  auto dataset_params = EmptyInputParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(/*expected_outputs=*/{},
+                                    /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, SaveAndRestore) {
+  auto dataset_params = FixedOrderParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs;
+  bool end_of_sequence = false;
+  while (true) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(iterator_->GetNext(iterator_ctx_.get(), &out_tensors,
+                                    &end_of_sequence));
+    if (end_of_sequence) break;
+    expected_outputs.push_back(out_tensors[0]);
+  }
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(dataset_params.iterator_prefix(),
+                                           expected_outputs,
+                                           /*breakpoints=*/{0, 3, 50, 101},
+                                           /*compare_order=*/true));
+}
+
+std::vector<DatasetNodeNameTestCase<GlobalShuffleDatasetParams>>
+DatasetNodeNameTestCases() {
+  return {{/*dataset_params=*/ReshuffleParams(),
+           /*expected_node_name=*/kNodeName}};
+}
+
+DATASET_NODE_NAME_TEST_P(GlobalShuffleDatasetOpTest,
+                         GlobalShuffleDatasetParams, DatasetNodeNameTestCases())
+
+std::vector<DatasetTypeStringTestCase<GlobalShuffleDatasetParams>>
+DatasetTypeStringTestCases() {
+  return {{/*dataset_params=*/ReshuffleParams(),
+           /*expected_dataset_type_string=*/name_utils::OpName(
+               GlobalShuffleDatasetOp::kDatasetType)}};
+}
+
+DATASET_TYPE_STRING_TEST_P(GlobalShuffleDatasetOpTest,
+                           GlobalShuffleDatasetParams,
+                           DatasetTypeStringTestCases())
+
+std::vector<CardinalityTestCase<GlobalShuffleDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/ReshuffleParams(),
+           /*expected_cardinality=*/100},
+          {/*dataset_params=*/EmptyInputParams(),
+           /*expected_cardinality=*/0}};
+}
+
+DATASET_CARDINALITY_TEST_P(GlobalShuffleDatasetOpTest,
+                           GlobalShuffleDatasetParams, CardinalityTestCases())
+
+std::vector<IteratorPrefixTestCase<GlobalShuffleDatasetParams>>
+IteratorOutputPrefixTestCases() {
+  return {{/*dataset_params=*/ReshuffleParams(),
+           /*expected_iterator_prefix=*/name_utils::IteratorPrefix(
+               GlobalShuffleDatasetOp::kDatasetType,
+               ReshuffleParams().iterator_prefix())}};
+}
+
+ITERATOR_PREFIX_TEST_P(GlobalShuffleDatasetOpTest, GlobalShuffleDatasetParams,
+                       IteratorOutputPrefixTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,303 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/indexed_tf_record_dataset_op.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/utils.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in indexed_tf_record_dataset_op.h and used both here and
+// in test cases.
+/* static */ constexpr const char* const IndexedTFRecordDatasetOp::kDatasetType;
+/* static */ constexpr const char* const IndexedTFRecordDatasetOp::kFileNames;
+/* static */ constexpr const char* const IndexedTFRecordDatasetOp::kCoalesceGap;
+/* static */ constexpr const char* const
+    IndexedTFRecordDatasetOp::kIndexFileSuffix;
+
+namespace {
+
+constexpr char kNextIndex[] = "next_index";
+
+// Number of consecutive records that an iterator reads at once.
+constexpr int64_t kReadAheadRecords = 64;
+
+}  // namespace
+
+// A TFRecord dataset whose files come with a record index, which makes the
+// dataset random access compatible: `Get(index)` costs a couple of positioned
+// reads instead of a scan of the file. Iterators read their records in small
+// batches, which `io::IndexedRecordReader` coalesces into one read each.
+class IndexedTFRecordDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<int64_t> file_limits, int64_t coalesce_gap)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        file_limits_(std::move(file_limits)),
+        coalesce_gap_(coalesce_gap),
+        files_(filenames_.size()) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    static DataTypeVector* dtypes = new DataTypeVector({DT_STRING});
+    return *dtypes;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    static std::vector<PartialTensorShape>* shapes =
+        new std::vector<PartialTensorShape>({{}});
+    return *shapes;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return file_limits_.empty() ? 0 : file_limits_.back();
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override { return OkStatus(); }
+
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    std::vector<tstring> records;
+    TF_RETURN_IF_ERROR(ReadRecords(ctx->env(), index, 1, &records));
+    out_tensors->clear();
+    out_tensors->emplace_back(DT_STRING, TensorShape({}));
+    out_tensors->back().scalar<tstring>()() = std::move(records[0]);
+    return OkStatus();
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    std::vector<tstring> records;
+    TF_RETURN_IF_ERROR(ReadRecords(ctx->env(), index, 1, &records));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx->allocator({}), DT_STRING, TensorShape({}));
+    out_tensors->back().scalar<tstring>()() = std::move(records[0]);
+    return OkStatus();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    AttrValue coalesce_gap;
+    b->BuildAttrValue(coalesce_gap_, &coalesce_gap);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {filenames},
+                                     {{kCoalesceGap, coalesce_gap}}, output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (buffer_position_ == buffer_.size()) {
+        const int64_t cardinality = dataset()->Cardinality();
+        if (next_index_ >= cardinality) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        // Read ahead up to the end of the current file.
+        const int64_t file_limit = *std::upper_bound(
+            dataset()->file_limits_.begin(), dataset()->file_limits_.end(),
+            next_index_);
+        const int64_t n = std::min(kReadAheadRecords, file_limit - next_index_);
+        buffer_position_ = 0;
+        Status s = dataset()->ReadRecords(ctx->env(), next_index_, n, &buffer_);
+        next_index_ += n;
+        if (!s.ok()) {
+          // Move past the records that could not be read, so that this works
+          // with `ignore_errors`.
+          buffer_.clear();
+          return s;
+        }
+      }
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(buffer_[buffer_position_].size());
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING, TensorShape({}));
+      out_tensors->back().scalar<tstring>()() =
+          std::move(buffer_[buffer_position_++]);
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      // Records that were read ahead but not produced yet are read again.
+      const int64_t next_index =
+          next_index_ - static_cast<int64_t>(buffer_.size() - buffer_position_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kNextIndex), next_index));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNextIndex), &next_index_));
+      buffer_.clear();
+      buffer_position_ = 0;
+      return OkStatus();
+    }
+
+   private:
+    mutex mu_;
+    // Index of the record after the last one in `buffer_`.
+    int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+    std::vector<tstring> buffer_ TF_GUARDED_BY(mu_);
+    size_t buffer_position_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  // A TFRecord file and its record index, opened on first use.
+  struct File {
+    std::unique_ptr<RandomAccessFile> records;
+    std::unique_ptr<RandomAccessFile> index;
+    std::unique_ptr<io::IndexedRecordReader> reader;
+  };
+
+  // Reads the `n` records starting at `index`, which must all be in the same
+  // file.
+  Status ReadRecords(Env* env, int64_t index, int64_t n,
+                     std::vector<tstring>* records) const {
+    const size_t file_index =
+        std::upper_bound(file_limits_.begin(), file_limits_.end(), index) -
+        file_limits_.begin();
+    const int64_t file_start =
+        file_index == 0 ? 0 : file_limits_[file_index - 1];
+    io::IndexedRecordReader* reader;
+    TF_RETURN_IF_ERROR(GetReader(env, file_index, &reader));
+    std::vector<uint64> indices(n);
+    for (int64_t i = 0; i < n; ++i) indices[i] = index - file_start + i;
+    return reader->ReadRecords(indices, records);
+  }
+
+  Status GetReader(Env* env, size_t file_index,
+                   io::IndexedRecordReader** reader) const {
+    mutex_lock l(mu_);
+    File& file = files_[file_index];
+    if (!file.reader) {
+      const string filename = TranslateFileName(filenames_[file_index]);
+      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file.records));
+      TF_RETURN_IF_ERROR(
+          env->NewRandomAccessFile(filename + kIndexFileSuffix, &file.index));
+      file.reader = std::make_unique<io::IndexedRecordReader>(
+          file.records.get(), file.index.get(), coalesce_gap_);
+    }
+    // The reader is thread safe and lives as long as the dataset.
+    *reader = file.reader.get();
+    return OkStatus();
+  }
+
+  const std::vector<string> filenames_;
+  // `file_limits_[i]` is the number of records in the files `[0, i]`.
+  const std::vector<int64_t> file_limits_;
+  const int64_t coalesce_gap_;
+  mutable mutex mu_;
+  mutable std::vector<File> files_ TF_GUARDED_BY(mu_);
+};
+
+IndexedTFRecordDatasetOp::IndexedTFRecordDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kCoalesceGap, &coalesce_gap_));
+  OP_REQUIRES(ctx, coalesce_gap_ >= 0,
+              errors::InvalidArgument("`coalesce_gap` must be >= 0"));
+}
+
+void IndexedTFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                           DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+
+  // Only the number of records of each file is needed up front, which is
+  // given by the size of its index.
+  std::vector<string> filenames;
+  std::vector<int64_t> file_limits;
+  filenames.reserve(filenames_tensor->NumElements());
+  file_limits.reserve(filenames_tensor->NumElements());
+  int64_t num_records = 0;
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    metrics::RecordTFDataFilename(kDatasetType, filenames[i]);
+    const string index_filename =
+        TranslateFileName(filenames[i]) + kIndexFileSuffix;
+    uint64 index_size;
+    OP_REQUIRES_OK(ctx, ctx->env()->GetFileSize(index_filename, &index_size));
+    OP_REQUIRES(ctx, index_size % io::IndexedRecordReader::kIndexEntrySize == 0,
+                errors::DataLoss("Truncated record index ", index_filename,
+                                 " of size ", index_size));
+    num_records += index_size / io::IndexedRecordReader::kIndexEntrySize;
+    file_limits.push_back(num_records);
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(file_limits),
+                        coalesce_gap_);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("IndexedTFRecordDataset").Device(DEVICE_CPU),
+                        IndexedTFRecordDatasetOp);
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
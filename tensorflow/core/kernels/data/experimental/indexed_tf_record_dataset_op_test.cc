@@ -0,0 +1,213 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/indexed_tf_record_dataset_op.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "indexed_tf_record_dataset";
+
+class IndexedTFRecordDatasetParams : public DatasetParams {
+ public:
+  IndexedTFRecordDatasetParams(std::vector<tstring> filenames,
+                               int64_t coalesce_gap, string node_name)
+      : DatasetParams({DT_STRING}, {PartialTensorShape({})},
+                      std::move(node_name)),
+        filenames_(std::move(filenames)),
+        coalesce_gap_(coalesce_gap) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    int num_files = filenames_.size();
+    return {CreateTensor<tstring>(TensorShape({num_files}), filenames_)};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {IndexedTFRecordDatasetOp::kFileNames};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{IndexedTFRecordDatasetOp::kCoalesceGap, coalesce_gap_}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return IndexedTFRecordDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<tstring> filenames_;
+  int64_t coalesce_gap_;
+};
+
+class IndexedTFRecordDatasetOpTest : public DatasetOpsTestBase {};
+
+// Writes `contents[i]` to the TFRecord file `filenames[i]`, along with its
+// record index.
+Status CreateTestFiles(const std::vector<tstring>& filenames,
+                       const std::vector<std::vector<string>>& contents) {
+  Env* env = Env::Default();
+  for (int i = 0; i < filenames.size(); ++i) {
+    const string filename = filenames[i];
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(
+        filename + IndexedTFRecordDatasetOp::kIndexFileSuffix, &index_file));
+    io::RecordWriterOptions options;
+    options.index_file = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : contents[i]) {
+      TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Close());
+    TF_RETURN_IF_ERROR(index_file->Close());
+  }
+  return OkStatus();
+}
+
+// The contents of the test files. The first file has more records than an
+// iterator reads at once.
+std::vector<std::vector<string>> TestContents() {
+  std::vector<string> large_file;
+  for (int i = 0; i < 100; ++i) large_file.push_back(absl::StrCat("record", i));
+  return {large_file, {"a", "bb", "ccc"}, {}};
+}
+
+std::vector<Tensor> ExpectedOutputs() {
+  std::vector<Tensor> outputs;
+  for (const auto& file_contents : TestContents()) {
+    for (const string& record : file_contents) {
+      outputs.push_back(CreateTensor<tstring>(TensorShape({}), {record}));
+    }
+  }
+  return outputs;
+}
+
+IndexedTFRecordDatasetParams IndexedTFRecordDatasetParams1() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_1"),
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_2"),
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_3")};
+  if (!CreateTestFiles(filenames, TestContents()).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return IndexedTFRecordDatasetParams(filenames, /*coalesce_gap=*/1 << 16,
+                                      /*node_name=*/kNodeName);
+}
+
+IndexedTFRecordDatasetParams NoCoalescingParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_no_coalescing_1"),
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_no_coalescing_2"),
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_no_coalescing_3")};
+  if (!CreateTestFiles(filenames, TestContents()).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return IndexedTFRecordDatasetParams(filenames, /*coalesce_gap=*/0,
+                                      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<IndexedTFRecordDatasetParams>> GetNextTestCases() {
+  return {{/*dataset_params=*/IndexedTFRecordDatasetParams1(),
+           /*expected_outputs=*/ExpectedOutputs()},
+          {/*dataset_params=*/NoCoalescingParams(),
+           /*expected_outputs=*/ExpectedOutputs()}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(IndexedTFRecordDatasetOpTest,
+                         IndexedTFRecordDatasetParams, GetNextTestCases())
+
+TEST_F(IndexedTFRecordDatasetOpTest, RandomAccess) {
+  auto dataset_params = IndexedTFRecordDatasetParams1();
+  TF_ASSERT_OK(InitializeRuntime(dataset_params));
+  std::unique_ptr<TestDataset> dataset;
+  TF_ASSERT_OK(MakeDataset(dataset_params, &dataset));
+  std::vector<Tensor> expected_outputs = ExpectedOutputs();
+  for (int64_t index : {101, 0, 64, 99, 100, 5}) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset->dataset()->Get(dataset->op_kernel_context(), index,
+                                         &out_tensors));
+    test::ExpectEqual(out_tensors[0], expected_outputs[index]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_TRUE(errors::IsOutOfRange(dataset->dataset()->Get(
+      dataset->op_kernel_context(), 103, &out_tensors)));
+}
+
+TEST_F(IndexedTFRecordDatasetOpTest, MissingIndex) {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/indexed_tf_record_missing_index")};
+  TF_ASSERT_OK(WriteDataToTFRecordFile(filenames[0], {"1", "22"},
+                                       CompressionParams()));
+  auto dataset_params = IndexedTFRecordDatasetParams(
+      filenames, /*coalesce_gap=*/0, /*node_name=*/kNodeName);
+  EXPECT_TRUE(errors::IsNotFound(Initialize(dataset_params)));
+}
+
+std::vector<DatasetNodeNameTestCase<IndexedTFRecordDatasetParams>>
+DatasetNodeNameTestCases() {
+  return {{/*dataset_params=*/IndexedTFRecordDatasetParams1(),
+           /*expected_node_name=*/kNodeName}};
+}
+
+DATASET_NODE_NAME_TEST_P(IndexedTFRecordDatasetOpTest,
+                         IndexedTFRecordDatasetParams,
+                         DatasetNodeNameTestCases())
+
+std::vector<DatasetTypeStringTestCase<IndexedTFRecordDatasetParams>>
+DatasetTypeStringTestCases() {
+  return {{/*dataset_params=*/IndexedTFRecordDatasetParams1(),
+           /*expected_dataset_type_string=*/name_utils::OpName(
+               IndexedTFRecordDatasetOp::kDatasetType)}};
+}
+
+DATASET_TYPE_STRING_TEST_P(IndexedTFRecordDatasetOpTest,
+                           IndexedTFRecordDatasetParams,
+                           DatasetTypeStringTestCases())
+
+std::vector<CardinalityTestCase<IndexedTFRecordDatasetParams>>
+CardinalityTestCases() {
+  return {{/*dataset_params=*/IndexedTFRecordDatasetParams1(),
+           /*expected_cardinality=*/103}};
+}
+
+DATASET_CARDINALITY_TEST_P(IndexedTFRecordDatasetOpTest,
+                           IndexedTFRecordDatasetParams,
+                           CardinalityTestCases())
+
+std::vector<IteratorSaveAndRestoreTestCase<IndexedTFRecordDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/IndexedTFRecordDatasetParams1(),
+           /*breakpoints=*/{0, 2, 70, 101, 110},
+           /*expected_outputs=*/ExpectedOutputs()}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(IndexedTFRecordDatasetOpTest,
+                                 IndexedTFRecordDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
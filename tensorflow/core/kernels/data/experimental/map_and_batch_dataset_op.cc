@@ -482,6 +482,10 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
                     offset);
                 break;
               }
+              if (tensor.SharesBufferWith(*batch)) {
+                // The batch already aliases `tensor`.
+                continue;
+              }
               // TODO(mrry): Add a version of DoParallelConcat that allows us
               // to move `tensor` where possible, to speed up string tensor
               // batching.
@@ -542,6 +546,15 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       for (size_t i = 0; i < num_components; ++i) {
         TensorShape component_shape({dataset()->batch_size_});
         component_shape.AppendShape(return_values->at(i).shape());
+        if (dataset()->batch_size_ == 1) {
+          // A batch of one element aliases the function output instead of
+          // copying it.
+          Tensor batch;
+          if (batch.CopyFrom(return_values->at(i), component_shape)) {
+            result->output.push_back(std::move(batch));
+            continue;
+          }
+        }
         AllocatorAttributes attr;
         attr.set_gpu_compatible(true);
         result->output.emplace_back(ctx->allocator(attr),
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <functional>
 #include <utility>
@@ -91,7 +92,8 @@ class MultiDeviceIterator : public ResourceBase {
         flib_def_(std::move(flib_def)),
         flr_(flr),
         pflr_(std::move(pflr)),
-        function_handle_cache_(std::move(function_handle_cache)) {
+        function_handle_cache_(std::move(function_handle_cache)),
+        pin_host_memory_(HasNonCpuDevice(devices)) {
     DCHECK(flr_ != nullptr);
     VLOG(2) << "Creating multi-device iterator.";
   }
@@ -169,6 +171,17 @@ class MultiDeviceIterator : public ResourceBase {
   IteratorMetricsCollector& metrics_collector() { return metrics_collector_; }
 
  private:
+  static bool HasNonCpuDevice(const std::vector<string>& devices) {
+    for (const string& device : devices) {
+      DeviceNameUtils::ParsedName parsed_name;
+      if (DeviceNameUtils::ParseFullName(device, &parsed_name) &&
+          parsed_name.has_type && parsed_name.type != DEVICE_CPU) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   // A private class that uses a background thread to keep a per device buffer
   // full.
   class MultiDeviceBuffer {
@@ -285,6 +298,17 @@ class MultiDeviceIterator : public ResourceBase {
       if (!background_thread_) {
         IteratorContext::Params params(ctx);
         params.cancellation_manager = &cancellation_manager_;
+        if (parent_->pin_host_memory_) {
+          // Makes the host iterator produce its elements in memory the
+          // devices can copy from directly, so that their host-to-device
+          // copies don't need to be staged.
+          params.allocator_getter =
+              [allocator_getter = std::move(params.allocator_getter)](
+                  AllocatorAttributes attrs) {
+                attrs.set_gpu_compatible(true);
+                return allocator_getter(attrs);
+              };
+        }
         background_thread_ =
             parent_->unbounded_thread_pool_.get_thread_factory()->StartThread(
                 "tf_data_multi_device_iterator",
@@ -372,6 +396,10 @@ class MultiDeviceIterator : public ResourceBase {
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
         }
+        if (elem.status.ok() && !elem.end_of_sequence &&
+            parent_->pin_host_memory_) {
+          PinHostMemory(ctx.get(), &elem.value);
+        }
 
         std::shared_ptr<HostBuffer::CallbackContainer> callback_container;
         {
@@ -421,6 +449,39 @@ class MultiDeviceIterator : public ResourceBase {
       }
     }
 
+    // Copies the components of `element` which are in pageable host memory,
+    // e.g. because they were not allocated through the iterator context, to
+    // pinned host memory. This is done ahead of time by the background thread
+    // so that the host-to-device copy of an element doesn't stage it while the
+    // device waits for it.
+    void PinHostMemory(IteratorContext* ctx, std::vector<Tensor>* element) {
+      AllocatorAttributes attrs;
+      attrs.set_on_host(true);
+      attrs.set_gpu_compatible(true);
+      Allocator* pinned_allocator = ctx->allocator(attrs);
+      if (pinned_allocator == nullptr ||
+          pinned_allocator->GetMemoryType() !=
+              AllocatorMemoryType::kHostPinned) {
+        return;
+      }
+      for (Tensor& component : *element) {
+        if (component.TotalBytes() == 0 ||
+            !DataTypeCanUseMemcpy(component.dtype()) ||
+            component.GetMemoryType() != AllocatorMemoryType::kHostPageable) {
+          continue;
+        }
+        Tensor pinned(pinned_allocator, component.dtype(), component.shape());
+        if (!pinned.IsInitialized()) {
+          // Out of pinned memory, the copy to the device stages the component.
+          continue;
+        }
+        const StringPiece data = component.tensor_data();
+        std::memcpy(const_cast<char*>(pinned.tensor_data().data()),
+                    data.data(), data.size());
+        component = std::move(pinned);
+      }
+    }
+
     struct HostBuffer {
       condition_variable cond_var;
       std::deque<HostBufferElement> data;
@@ -465,6 +526,9 @@ class MultiDeviceIterator : public ResourceBase {
   FunctionLibraryRuntime* const flr_ = nullptr;  // not owned.
   const std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
   const std::unique_ptr<FunctionHandleCache> function_handle_cache_;
+  // Whether elements are produced in pinned host memory, because they are
+  // copied to non-CPU devices.
+  const bool pin_host_memory_;
   ResourceMgr resource_mgr_;
   CancellationManager cancellation_manager_;
 
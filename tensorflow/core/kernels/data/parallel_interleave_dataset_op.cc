@@ -89,6 +89,7 @@ constexpr char kParallelism[] = "parallelism";
 constexpr char kBlockIndex[] = "block_index";
 constexpr char kCycleIndex[] = "cycle_index";
 constexpr char kMaxBufferedElements[] = "max_buffered_elements";
+constexpr char kReorderBufferSize[] = "reorder_buffer_size";
 constexpr char kEndOfInput[] = "end_of_input";
 constexpr char kElementIdCounter[] = "element_id_counter";
 constexpr char kCurrentElements[] = "current_elements";
@@ -120,6 +121,18 @@ constexpr int kDefaultCyclePrefetchFactor = 2;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// Experiment that lets deterministic iterators buffer results of cycle elements
+// beyond `buffer_output_elements`, into a reorder buffer shared by the cycle.
+// The order of the results is unchanged, but elements behind a slow element
+// keep making progress instead of idling once their own buffer is full.
+constexpr char kReorderBufferExperiment[] = "interleave_reorder_buffer";
+
+// `kDefaultReorderBufferFactor * cycle_length * buffer_output_elements` is the
+// initial size of the reorder buffer, and `kMaxReorderBufferFactor` times that
+// is the largest size autotuning can pick.
+constexpr int64_t kDefaultReorderBufferFactor = 1;
+constexpr int64_t kMaxReorderBufferFactor = 8;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -359,6 +372,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               params.dataset->num_parallel_calls_, mu_,
               num_parallel_calls_cond_var_)),
           deterministic_(deterministic),
+          reorder_buffer_enabled_(
+              deterministic &&
+              GetExperiments().contains(kReorderBufferExperiment)),
+          reorder_buffer_size_(std::make_shared<model::SharedState>(
+              model::kAutotune, mu_, std::make_shared<condition_variable>())),
           current_elements_(params.dataset->cycle_length_) {}
 
     ~ParallelInterleaveIterator() override { CancelThreads(/*wait=*/true); }
@@ -394,6 +412,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         num_parallel_calls_->value = std::min(
             GetAutotuneDefaultParallelism(ctx), dataset()->cycle_length_);
       }
+      reorder_buffer_size_->value = kDefaultReorderBufferFactor *
+                                    dataset()->cycle_length_ *
+                                    dataset()->buffer_output_elements_;
+      reorder_buffer_size_seen_ = reorder_buffer_size_->value;
       cancellation_manager_ = std::make_unique<CancellationManager>();
       IteratorContext::Params params(ctx);
       params.interleave_depth += 1;
@@ -420,6 +442,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         EnsureInitialElementsCreated(ctx);
         EnsureThreadsStarted(ctx);
+        MaybeScheduleReorderedElements();
         while (!cancelled_ && !Consume(ctx, &result)) {
           RecordStop(ctx);
           if (deterministic_) {
@@ -469,19 +492,26 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                     static_cast<double>(dataset()->cycle_length_),
                     std::ceil(std::pow(27 * dataset()->cycle_length_, 0.5)))
               : 1;
-      return model::MakeAsyncInterleaveManyNode(
-          std::move(args),
-          {model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
-                                /*max=*/dataset()->cycle_length_),
-           model::MakeNonTunableParameter(kCycleLength,
-                                          dataset()->cycle_length_),
-           model::MakeNonTunableParameter(kDeterministic,
-                                          deterministic_ ? 1.0 : 0.0),
-           model::MakeNonTunableParameter(
-               kMaxBufferedElements,
-               ComputeMaxBufferedElements(dataset()->prefetch_input_elements_,
-                                          dataset()->buffer_output_elements_,
-                                          dataset()->cycle_length_))});
+      std::vector<std::shared_ptr<model::Parameter>> parameters = {
+          model::MakeParameter(kParallelism, num_parallel_calls_, /*min=*/min,
+                               /*max=*/dataset()->cycle_length_),
+          model::MakeNonTunableParameter(kCycleLength,
+                                         dataset()->cycle_length_),
+          model::MakeNonTunableParameter(kDeterministic,
+                                         deterministic_ ? 1.0 : 0.0),
+          model::MakeNonTunableParameter(
+              kMaxBufferedElements,
+              ComputeMaxBufferedElements(dataset()->prefetch_input_elements_,
+                                         dataset()->buffer_output_elements_,
+                                         dataset()->cycle_length_))};
+      if (reorder_buffer_enabled_) {
+        parameters.push_back(model::MakeParameter(
+            kReorderBufferSize, reorder_buffer_size_, /*min=*/0,
+            /*max=*/kMaxReorderBufferFactor * dataset()->cycle_length_ *
+                dataset()->buffer_output_elements_));
+      }
+      return model::MakeAsyncInterleaveManyNode(std::move(args),
+                                                std::move(parameters));
     }
 
     Status SaveInternal(SerializationContext* ctx,
@@ -1091,7 +1121,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(*element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= ResultsBufferLimit(*element)) {
           break;
         }
       }
@@ -1185,7 +1215,38 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < ResultsBufferLimit(*element);
+    }
+
+    // Returns the number of results the element may buffer. Elements of the
+    // current cycle get an equal share of the reorder buffer on top of their
+    // `buffer_output_elements`.
+    int64_t ResultsBufferLimit(const Element& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!reorder_buffer_enabled_ || element.cycle_index == -1) {
+        return dataset()->buffer_output_elements_;
+      }
+      return dataset()->buffer_output_elements_ +
+             CeilDiv(static_cast<int64_t>(reorder_buffer_size_->value),
+                     dataset()->cycle_length_);
+    }
+
+    // Wakes up current workers for elements that stopped at their previous
+    // share of the reorder buffer, if autotuning has grown the buffer since.
+    void MaybeScheduleReorderedElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!reorder_buffer_enabled_ ||
+          reorder_buffer_size_->value <= reorder_buffer_size_seen_) {
+        reorder_buffer_size_seen_ = reorder_buffer_size_->value;
+        return;
+      }
+      reorder_buffer_size_seen_ = reorder_buffer_size_->value;
+      for (int i = 0; i <= last_valid_current_element_; ++i) {
+        const auto& element = current_elements_[i];
+        if (NeedsProcessing(element) && !element->active) {
+          elements_to_process_.push_back(i);
+        }
+      }
+      current_workers_cond_var_.notify_all();
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1654,6 +1715,17 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
+    // Whether cycle elements may buffer results in the reorder buffer. Only
+    // used when `deterministic` is true.
+    const bool reorder_buffer_enabled_;
+
+    // Total number of results the elements of the current cycle may buffer
+    // beyond `buffer_output_elements`. Tuned by autotuning.
+    const std::shared_ptr<model::SharedState> reorder_buffer_size_;
+
+    // The reorder buffer size the current workers were last woken up for.
+    double reorder_buffer_size_seen_ TF_GUARDED_BY(mu_) = 0;
+
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
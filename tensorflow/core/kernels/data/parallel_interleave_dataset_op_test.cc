@@ -634,6 +634,25 @@ GetNextTestCases() {
 ITERATOR_GET_NEXT_TEST_P(ParallelInterleaveDatasetOpTest,
                          ParallelInterleaveDatasetParams, GetNextTestCases());
 
+// Test that buffering results in the reorder buffer keeps the order of the
+// results of a deterministic iterator.
+TEST_F(ParallelInterleaveDatasetOpTest, ReorderBufferKeepsDeterministicOrder) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "interleave_reorder_buffer",
+         /*overwrite=*/1);
+  auto dataset_params = LongCycleDeterministicParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(
+          TensorShape{1},
+          {{"a"}, {"d"}, {"g"}, {"b"}, {"e"}, {"h"}, {"c"}, {"f"}, {"i"}}),
+      /*compare_order=*/true));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 // TODO(b/241923343): The next 2 tests are brittle because they directly inspect
 // the GraphDefs to check the value of `cycle_length` when the
 // `ParallelInterleave` is serialized to a graph. Revisit this test when we
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <deque>
 #include <limits>
 
@@ -54,6 +55,9 @@ namespace {
 
 // Determines the fraction of slack time by which to delay prefetching of data.
 constexpr double kSleepFactor = 0.2;
+// How often a producer throttled by the process-wide RAM budget checks whether
+// the process is back within budget, in case other pipelines release memory.
+constexpr int64_t kRamBudgetCheckPeriodMs = 1;
 constexpr char kBuffer[] = "buffer";
 constexpr char kStatus[] = "status";
 constexpr char kSizeSuffix[] = ".size";
@@ -113,6 +117,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     return input_->Get(ctx, index, out_tensors);
   }
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return input_->Get(ctx, index, out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -387,6 +396,13 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       return buffer_size_->value;
     }
 
+    // Whether the producer must wait for the consumer because the process is
+    // over its tf.data RAM budget. The producer is never throttled while the
+    // buffer is empty, so that the pipeline keeps making progress.
+    bool ThrottledByRamBudget() const TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      return !buffer_.empty() && model::RamBudgetManager::Get().IsOverBudget();
+    }
+
     void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
       cancellation_manager_->StartCancel();
       mutex_lock l(*mu_);
@@ -483,9 +499,15 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         // 1. Wait for a slot in the buffer.
         {
           mutex_lock l(*mu_);
-          while (!cancelled_ && buffer_.size() >= buffer_limit()) {
+          while (!cancelled_ && (buffer_.size() >= buffer_limit() ||
+                                 ThrottledByRamBudget())) {
             RecordStop(ctx.get());
-            cond_var_->wait(l);
+            if (buffer_.size() >= buffer_limit()) {
+              cond_var_->wait(l);
+            } else {
+              cond_var_->wait_for(
+                  l, std::chrono::milliseconds(kRamBudgetCheckPeriodMs));
+            }
             RecordStart(ctx.get());
           }
 
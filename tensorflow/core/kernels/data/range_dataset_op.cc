@@ -219,6 +219,13 @@ class RangeDatasetOp::Dataset : public DatasetBase {
                               start_ + (index * step_));
   }
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return ConvertOutputTypes(output_dtypes(), out_tensors,
+                              start_ + (index * step_));
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -105,6 +105,12 @@ class ShardDatasetOp::Dataset : public DatasetBase {
     return input_->Get(ctx, index_ + (num_shards_ * index), out_tensors);
   }
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx, index_ + (num_shards_ * index), out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
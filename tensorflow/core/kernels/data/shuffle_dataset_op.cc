@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
@@ -229,6 +230,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       this->RecordBufferDequeue(ctx, *out_tensors);
       std::swap(buffer_->at(index),
                 buffer_->at(slices_.front()->start % buffer_->size()));
+      checkpoint_indices_.insert(index);
+      checkpoint_indices_.insert(slices_.front()->start % buffer_->size());
       slices_.front()->start++;
       num_elements_--;
       return OkStatus();
@@ -273,7 +276,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kEpoch), epoch_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kNumElements), num_elements_));
-      TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      // A symbolic checkpoint keeps the buffer of the previous save, so only
+      // the elements which changed since then need to be written.
+      if (ctx->symbolic_checkpoint() && buffer_checkpointed_) {
+        TF_RETURN_IF_ERROR(UpdateCheckpointElements(
+            writer, prefix(), *buffer_, checkpoint_indices_));
+      } else {
+        TF_RETURN_IF_ERROR(
+            WriteElementsToCheckpoint(writer, prefix(), *buffer_));
+      }
+      checkpoint_indices_.clear();
+      buffer_checkpointed_ = ctx->symbolic_checkpoint();
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(this->full_name(kSlicesSize), slices_.size()));
       for (size_t i = 0; i < slices_.size(); ++i) {
@@ -338,6 +351,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       buffer_ = std::make_unique<std::vector<std::vector<Tensor>>>();
       TF_RETURN_IF_ERROR(
           ReadElementsFromCheckpoint(ctx, reader, prefix(), buffer_.get()));
+      checkpoint_indices_.clear();
+      buffer_checkpointed_ = false;
       for (const auto& element : *buffer_) {
         RecordBufferEnqueue(ctx, element);
       }
@@ -500,9 +515,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       this->RecordBufferEnqueue(ctx, element);
       if (num_elements_ == buffer_->size()) {
         DCHECK(IsShuffleAll());
+        checkpoint_indices_.insert(buffer_->size());
         buffer_->push_back(element);
       } else {
         size_t index = slices_.back()->end % buffer_->size();
+        checkpoint_indices_.insert(index);
         buffer_->at(index) = std::move(element);
       }
       num_elements_++;
@@ -543,6 +560,11 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_GUARDED_BY(mu_);
     int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
+    // Indices of the elements of `buffer_` which changed since the last save.
+    absl::flat_hash_set<int64_t> checkpoint_indices_ TF_GUARDED_BY(mu_);
+    // Whether the whole of `buffer_` was written to a symbolic checkpoint, so
+    // that later saves only need to write `checkpoint_indices_`.
+    bool buffer_checkpointed_ TF_GUARDED_BY(mu_) = false;
   };
 
   const DatasetBase* const input_;
@@ -45,6 +45,9 @@ class TakeDataset : public DatasetBase {
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override;
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override;
+
   Status CheckExternalState() const override;
 
  protected:
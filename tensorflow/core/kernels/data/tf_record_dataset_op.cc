@@ -36,6 +36,7 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kAsyncBuffering;
 
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
@@ -55,7 +56,8 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64_t buffer_size)
+                   const string& compression_type, int64_t buffer_size,
+                   bool async_buffering)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
@@ -64,6 +66,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    options_.async_buffering = async_buffering;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -103,8 +106,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    AttrValue async_buffering;
+    b->BuildAttrValue(options_.async_buffering, &async_buffering);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {filenames, compression_type, buffer_size}, output));
+        this, {filenames, compression_type, buffer_size},
+        {{kAsyncBuffering, async_buffering}}, output));
     return OkStatus();
   }
 
@@ -278,7 +284,9 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kAsyncBuffering, &async_buffering_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -326,8 +334,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, async_buffering_);
 }
 
 namespace {
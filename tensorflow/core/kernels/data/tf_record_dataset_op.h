@@ -26,6 +26,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
   static constexpr const char* const kFileNames = "filenames";
   static constexpr const char* const kCompressionType = "compression_type";
   static constexpr const char* const kBufferSize = "buffer_size";
+  static constexpr const char* const kAsyncBuffering = "async_buffering";
 
   explicit TFRecordDatasetOp(OpKernelConstruction* ctx);
 
@@ -34,6 +35,8 @@ class TFRecordDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+
+  bool async_buffering_;
 };
 
 }  // namespace data
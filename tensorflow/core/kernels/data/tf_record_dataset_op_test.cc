@@ -23,12 +23,13 @@ class TFRecordDatasetParams : public DatasetParams {
  public:
   TFRecordDatasetParams(std::vector<tstring> filenames,
                         CompressionType compression_type, int64_t buffer_size,
-                        string node_name)
+                        string node_name, bool async_buffering = false)
       : DatasetParams({DT_STRING}, {PartialTensorShape({})},
                       std::move(node_name)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
-        buffer_size_(buffer_size) {}
+        buffer_size_(buffer_size),
+        async_buffering_(async_buffering) {}
 
   std::vector<Tensor> GetInputTensors() const override {
     int num_files = filenames_.size();
@@ -51,6 +52,8 @@ class TFRecordDatasetParams : public DatasetParams {
   Status GetAttributes(AttributeVector* attr_vector) const override {
     attr_vector->clear();
     attr_vector->emplace_back("metadata", "");
+    attr_vector->emplace_back(TFRecordDatasetOp::kAsyncBuffering,
+                              async_buffering_);
     return OkStatus();
   }
 
@@ -62,6 +65,7 @@ class TFRecordDatasetParams : public DatasetParams {
   std::vector<tstring> filenames_;
   CompressionType compression_type_;
   int64_t buffer_size_;
+  bool async_buffering_;
 };
 
 class TFRecordDatasetOpTest : public DatasetOpsTestBase {};
@@ -138,6 +142,25 @@ TFRecordDatasetParams TFRecordDatasetParams3() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 4: multiple text files without compression, read asynchronously.
+TFRecordDatasetParams TFRecordDatasetParams4() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_ASYNC_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_ASYNC_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName,
+                               /*async_buffering=*/true);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -148,6 +171,9 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
@@ -187,6 +213,13 @@ std::vector<SkipTestCase<TFRecordDatasetParams>> SkipTestCases() {
            /*expected_outputs=*/
            CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
           {/*dataset_params=*/TFRecordDatasetParams3(),
+           /*num_to_skip*/ 7, /*expected_num_skipped*/ 6},
+
+          {/*dataset_params=*/TFRecordDatasetParams4(),
+           /*num_to_skip*/ 4, /*expected_num_skipped*/ 4, /*get_next*/ true,
+           /*expected_outputs=*/
+           CreateTensors<tstring>(TensorShape({}), {{"bb"}})},
+          {/*dataset_params=*/TFRecordDatasetParams4(),
            /*num_to_skip*/ 7, /*expected_num_skipped*/ 6}};
 }
 
@@ -256,6 +289,10 @@ IteratorSaveAndRestoreTestCases() {
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
       {/*dataset_params=*/TFRecordDatasetParams3(),
+       /*breakpoints=*/{0, 2, 7},
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})},
+      {/*dataset_params=*/TFRecordDatasetParams4(),
        /*breakpoints=*/{0, 2, 7},
        CreateTensors<tstring>(
            TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
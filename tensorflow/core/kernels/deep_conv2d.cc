@@ -91,23 +91,34 @@ static bool ReadBoolFromEnvVar(const char* env_var_name, bool default_val) {
   return default_val;
 }
 
+// Returns true if convolution parameters are supported by DeepConv2D and
+// deep convolution is enabled by environment variable.
+// TODO(andydavis) Add support for multiple filter sizes and strides.
+static bool IsDeepConv2DEnabled(int stride_rows, int stride_cols,
+                                int filter_rows, int filter_cols) {
+  if (stride_rows > 1 || stride_cols > 1 || filter_rows != 3 ||
+      filter_cols != 3) {
+    return false;
+  }
+  // NOTE: IF this environment variable name changes, update conv_ops_test.py.
+  return ReadBoolFromEnvVar("TF_USE_DEEP_CONV2D", false);
+}
+
+bool UseDeepConv2DAutotune(int stride_rows, int stride_cols, int filter_rows,
+                           int filter_cols) {
+  return IsDeepConv2DEnabled(stride_rows, stride_cols, filter_rows,
+                             filter_cols) &&
+         ReadBoolFromEnvVar("TF_AUTOTUNE_DEEP_CONV2D", false);
+}
+
 // Returns true if convolution can be computed efficiently by DeepConv2D,
 // returns false otherwise.
 // TODO(andydavis) Add support for other filter sizes and strides.
-// TODO(andydavis) Add support for autotuning.
 bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols) {
-  // Check if convolution parameters are supported.
-  // TODO(andydavis) Add support for multiple filter sizes and strides.
-  if (stride_rows > 1 || stride_cols > 1 || filter_rows != 3 ||
-      filter_cols != 3) {
-    return false;
-  }
-
-  // Check if deep convolution is enabled by environment variable.
-  // NOTE: IF this environment variable name changes, update conv_ops_test.py.
-  if (!ReadBoolFromEnvVar("TF_USE_DEEP_CONV2D", false)) {
+  if (!IsDeepConv2DEnabled(stride_rows, stride_cols, filter_rows,
+                           filter_cols)) {
     return false;
   }
 
@@ -101,6 +101,14 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols);
 
+// Returns true if the choice between DeepConv2D and the direct convolution
+// should be made by timing both implementations on the first run of each
+// convolution shape, instead of by the flop cost model in CanUseDeepConv2D.
+// Requires both TF_USE_DEEP_CONV2D and TF_AUTOTUNE_DEEP_CONV2D to be set, and
+// convolution parameters that DeepConv2D supports.
+bool UseDeepConv2DAutotune(int stride_rows, int stride_cols, int filter_rows,
+                           int filter_cols);
+
 namespace functor {
 
 // Calls DeepConv2D implementation (see deep_conv2d.cc for details).
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 #include "tensorflow/core/util/example_proto_helper.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
@@ -51,6 +52,9 @@ class ParseExampleOp : public OpKernel {
   explicit ParseExampleOp(OpKernelConstruction* ctx)
       : OpKernel(ctx), op_version_(ctx->def().op() == kParseExampleV2 ? 2 : 1) {
     OP_REQUIRES_OK(ctx, attrs_.Init(ctx, op_version_));
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_PARSE_EXAMPLE_COLUMNAR",
+                                           /*default_val=*/false,
+                                           &columnar_batch_parsing_));
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -231,6 +235,7 @@ class ParseExampleOp : public OpKernel {
       config.ragged.emplace_back(ragged_keys_t[d], attrs_.ragged_value_types[d],
                                  attrs_.ragged_split_types[d]);
     }
+    config.columnar_batch_parsing = columnar_batch_parsing_;
     return config;
   }
 
@@ -289,6 +294,9 @@ class ParseExampleOp : public OpKernel {
 
   ParseExampleAttrs attrs_;
   int op_version_;
+  // Whether to parse batches with the columnar parser, set by the
+  // TF_PARSE_EXAMPLE_COLUMNAR environment variable.
+  bool columnar_batch_parsing_ = false;
   absl::once_flag flag_;
 };
 
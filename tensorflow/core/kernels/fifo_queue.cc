@@ -107,6 +107,15 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // The element shapes are the same for every element of the batch, so they
+  // are computed once instead of once per element and component.
+  std::vector<TensorShape> element_shapes;
+  element_shapes.reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    element_shapes.push_back(tuple[i].shape());
+    element_shapes.back().RemoveDim(0);
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -117,30 +126,35 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     if (!already_cancelled) {
       enqueue_attempts_.emplace_back(
           batch_size, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          [tuple, element_shapes,
+           this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             if (closed_) {
               attempt->context->SetStatus(
                   errors::Cancelled("FIFOQueue '", name_, "' is closed."));
               return kComplete;
             }
-            RunResult result = kNoProgress;
-            while (queues_[0].size() < static_cast<size_t>(capacity_)) {
-              result = kProgress;
-              const int64_t index =
-                  tuple[0].dim_size(0) - attempt->elements_requested;
+            // Enqueue as many elements as currently fit in one pass.
+            const int64_t num_to_enqueue = std::min<int64_t>(
+                capacity_ - static_cast<int64_t>(queues_[0].size()),
+                attempt->elements_requested);
+            if (num_to_enqueue <= 0) return kNoProgress;
+            const int64_t start =
+                tuple[0].dim_size(0) - attempt->elements_requested;
+            for (int64_t index = start; index < start + num_to_enqueue;
+                 ++index) {
               for (int i = 0; i < num_components(); ++i) {
                 Tensor element;
-                attempt->context->SetStatus(GetElementComponentFromBatch(
-                    tuple, index, i, attempt->context, &element));
+                attempt->context->SetStatus(attempt->context->allocate_temp(
+                    tuple[i].dtype(), element_shapes[i], &element));
+                if (!attempt->context->status().ok()) return kComplete;
+                attempt->context->SetStatus(
+                    batch_util::CopySliceToElement(tuple[i], &element, index));
                 if (!attempt->context->status().ok()) return kComplete;
-                queues_[i].push_back(element);
+                queues_[i].push_back(std::move(element));
               }
               --attempt->elements_requested;
-              if (attempt->elements_requested == 0) {
-                return kComplete;
-              }
             }
-            return result;
+            return attempt->elements_requested == 0 ? kComplete : kProgress;
           });
     }
   }
@@ -324,19 +338,22 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
                 }
               }
               result = kProgress;
-              Tuple tuple;
-              DequeueLocked(attempt->context, &tuple);
+              // Move each component straight from the front of its queue
+              // into the batch, without building an intermediate tuple.
               const int64_t index =
                   attempt->tuple[0].dim_size(0) - attempt->elements_requested;
               for (int i = 0; i < num_components(); ++i) {
-                attempt->context->SetStatus(batch_util::CopyElementToSlice(
-                    std::move(tuple[i]), &attempt->tuple[i], index));
-                if (!attempt->context->status().ok()) return kComplete;
+                Tensor element = std::move(queues_[i].front());
+                queues_[i].pop_front();
+                if (attempt->context->status().ok()) {
+                  attempt->context->SetStatus(batch_util::CopyElementToSlice(
+                      std::move(element), &attempt->tuple[i], index));
+                }
               }
-              tuple.clear();
+              if (!attempt->context->status().ok()) return kComplete;
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
-                tuple = attempt->tuple;
+                Tuple tuple = attempt->tuple;
                 attempt->done_callback = [callback, tuple]() {
                   callback(tuple);
                 };
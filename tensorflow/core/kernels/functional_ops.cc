@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #define EIGEN_USE_THREADS
 
+#include "absl/algorithm/container.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 typedef Eigen::GpuDevice GPUDevice;
@@ -359,6 +361,14 @@ class WhileOp : public AsyncOpKernel {
   explicit WhileOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("cond", &cond_func_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("body", &body_func_));
+    // Fusing the body with the next evaluation of the cond changes the order
+    // in which their ops may run relative to each other, so it is only done
+    // when neither function has side effects.
+    if (type_string() == "StatelessWhile") {
+      OP_REQUIRES_OK(
+          ctx, ReadBoolFromEnvVar("TF_FUSE_STATELESS_WHILE_ITERATIONS",
+                                  /*default_val=*/false, &fuse_iterations_));
+    }
   }
 
   ~WhileOp() override {}
@@ -370,11 +380,9 @@ class WhileOp : public AsyncOpKernel {
       OP_REQUIRES_OK_ASYNC(ctx, DoComputeSync(ctx), done);
       done();
     } else {
-      FHandle cond_handle;
-      FHandle body_handle;
-      OP_REQUIRES_OK_ASYNC(ctx, GetHandles(ctx, &cond_handle, &body_handle),
-                           done);
-      (new State(this, ctx, cond_handle, body_handle, done))->Start();
+      const Handles* handles;
+      OP_REQUIRES_OK_ASYNC(ctx, GetHandles(ctx, &handles), done);
+      (new State(this, ctx, handles, done))->Start();
     }
   }
 
@@ -392,12 +400,28 @@ class WhileOp : public AsyncOpKernel {
   }
 
  private:
+  // The functions instantiated for one `FunctionLibraryRuntime`.
+  struct Handles {
+    FHandle cond = kInvalidHandle;
+    FHandle body = kInvalidHandle;
+    // If valid, a function that runs the body and then the cond on its
+    // results, returning the new loop variables followed by the cond result.
+    // Running one iteration as a single function call lets the executor
+    // overlap the next cond with the parts of the body it doesn't depend on,
+    // and halves the number of function calls per iteration.
+    FHandle step = kInvalidHandle;
+    DataTypeVector step_ret_types;
+    // Owns the definition of the step function, which must outlive `step`.
+    std::unique_ptr<FunctionLibraryDefinition> step_lib_def;
+  };
+
   NameAttrList cond_func_;
   NameAttrList body_func_;
+  bool fuse_iterations_ = false;
 
   mutex mu_;
-  std::unordered_map<FunctionLibraryRuntime*, std::pair<FHandle, FHandle>>
-      handles_ ABSL_GUARDED_BY(mu_);
+  std::unordered_map<FunctionLibraryRuntime*, Handles> handles_
+      ABSL_GUARDED_BY(mu_);
 
   static Status CondResultToBool(OpKernelContext* ctx,
                                  const FunctionLibraryRuntime::Options& opts,
@@ -502,12 +526,13 @@ class WhileOp : public AsyncOpKernel {
 
   class State {
    public:
-    State(WhileOp* kernel, OpKernelContext* ctx, FHandle cond_handle,
-          FHandle body_handle, DoneCallback done)
+    State(WhileOp* kernel, OpKernelContext* ctx, const Handles* handles,
+          DoneCallback done)
         : kernel_(kernel),
           ctx_(ctx),
-          cond_handle_(cond_handle),
-          body_handle_(body_handle),
+          cond_handle_(handles->cond),
+          body_handle_(handles->body),
+          step_handle_(handles->step),
           done_(std::move(done)),
           lib_(CHECK_NOTNULL(ctx_->function_library())),
           opts_(ctx->step_id()) {
@@ -515,6 +540,10 @@ class WhileOp : public AsyncOpKernel {
       GetArgsFromContext(ctx, &args_, &loop_var_types_);
       body_frame_ =
           std::make_unique<BodyFuncCallFrame>(&args_, &rets_, loop_var_types_);
+      if (step_handle_ != kInvalidHandle) {
+        step_frame_ = std::make_unique<BodyFuncCallFrame>(
+            &args_, &rets_, handles->step_ret_types);
+      }
     }
 
     ~State() {}
@@ -526,6 +555,7 @@ class WhileOp : public AsyncOpKernel {
     OpKernelContext* const ctx_;
     const FHandle cond_handle_;
     const FHandle body_handle_;
+    const FHandle step_handle_;
     const DoneCallback done_;
     FunctionLibraryRuntime* const lib_;
     FunctionLibraryRuntime::Options opts_;
@@ -533,6 +563,7 @@ class WhileOp : public AsyncOpKernel {
     TensorVec rets_;
     DataTypeVector loop_var_types_;
     std::unique_ptr<BodyFuncCallFrame> body_frame_;
+    std::unique_ptr<BodyFuncCallFrame> step_frame_;
 
     void EvalCond() {
       profiler::TraceMe trace_me("WhileOp-EvalCond");
@@ -569,6 +600,9 @@ class WhileOp : public AsyncOpKernel {
       if (!cond) {
         return Finish(OkStatus());
       }
+      if (step_handle_ != kInvalidHandle) {
+        return StartStep();
+      }
       rets_.clear();
       rets_.resize(args_.size());
       profiler::TraceMe trace_me("WhileOp-StartBody");
@@ -592,6 +626,33 @@ class WhileOp : public AsyncOpKernel {
           });
     }
 
+    // Runs the body and the next evaluation of the cond as a single function.
+    void StartStep() {
+      rets_.clear();
+      rets_.resize(args_.size() + 1);
+      profiler::TraceMe trace_me("WhileOp-StartStep");
+      lib_->Run(
+          opts_, step_handle_, step_frame_.get(),
+          // Done callback
+          [this](const Status& s) {
+            if (!s.ok()) {
+              return Finish(s);
+            }
+            if (args_.size() + 1 != rets_.size()) {
+              return Finish(errors::InvalidArgument(
+                  "While loop body returned ", rets_.size() - 1,
+                  " arguments. Expected: ", args_.size()));
+            }
+            Tensor cond_t = std::move(rets_.back());
+            rets_.pop_back();
+            args_.clear();
+            using std::swap;
+            swap(args_, rets_);
+            rets_.push_back(std::move(cond_t));
+            StartBody();
+          });
+    }
+
     void Finish(Status s) {
       if (s.ok()) {
         s = SetOutputs(kernel_, ctx_, args_);
@@ -603,9 +664,11 @@ class WhileOp : public AsyncOpKernel {
   };
 
   Status DoComputeSync(OpKernelContext* ctx) {
-    FHandle cond_handle;
-    FHandle body_handle;
-    TF_RETURN_IF_ERROR(GetHandles(ctx, &cond_handle, &body_handle));
+    const Handles* handles;
+    TF_RETURN_IF_ERROR(GetHandles(ctx, &handles));
+    const FHandle cond_handle = handles->cond;
+    const FHandle body_handle = handles->body;
+    const FHandle step_handle = handles->step;
     auto lib = ctx->function_library();
     FunctionLibraryRuntime::Options opts;
     SetRunOptions(ctx, &opts, false /* always_collect_stats */);
@@ -619,13 +682,15 @@ class WhileOp : public AsyncOpKernel {
     std::vector<Tensor> cond_rets;
     cond_rets.reserve(1);
     std::vector<Tensor> body_rets;
-    body_rets.reserve(num_loop_vars);
+    body_rets.reserve(num_loop_vars + 1);
 
     // Implement the logic of the while loop as a single C++ do-while loop that
     // executes the cond and body functions synchronously.
+    bool eval_cond = true;
     do {
-      // Evaluate the cond function on the current loop variables.
-      {
+      // Evaluate the cond function on the current loop variables, unless the
+      // step function already did.
+      if (eval_cond) {
         profiler::TraceMe trace_me("WhileOp-EvalCond");
         TF_RETURN_IF_ERROR(lib->RunSync(opts, cond_handle, args, &cond_rets));
       }
@@ -644,6 +709,21 @@ class WhileOp : public AsyncOpKernel {
         return SetOutputs(this, ctx, args);
       }
 
+      if (step_handle != kInvalidHandle) {
+        profiler::TraceMe trace_me("WhileOp-StartStep");
+        body_rets.resize(num_loop_vars + 1);
+        BodyFuncCallFrame call_frame(&args, &body_rets,
+                                     handles->step_ret_types);
+        TF_RETURN_IF_ERROR(lib->RunSync(opts, step_handle, &call_frame));
+        cond_rets.clear();
+        cond_rets.push_back(std::move(body_rets.back()));
+        body_rets.pop_back();
+        std::swap(body_rets, args);
+        body_rets.clear();
+        eval_cond = false;
+        continue;
+      }
+
       // Evaluate the body function on the current loop variables, to get an
       // updated vector of loop variables.
       {
@@ -657,39 +737,132 @@ class WhileOp : public AsyncOpKernel {
     } while (true);
   }
 
-  Status GetHandles(OpKernelContext* ctx, FHandle* cond_handle,
-                    FHandle* body_handle) {
+  Status GetHandles(OpKernelContext* ctx, const Handles** handles) {
     // TODO(b/37549631): Because this op has `SetIsStateful()` in its
     // op registration, this kernel may be shared by multiple
     // subgraphs, which have different associated
     // `FunctionLibraryRuntime` objects and hence different `FHandle`
     // namespaces. We currently work around this by caching the map
-    // from `FunctionLibraryRuntime*` to `FHandle` pairs for the two
-    // functions this op uses.
+    // from `FunctionLibraryRuntime*` to `Handles` for the functions
+    // this op uses.
     auto lib = ctx->function_library();
     if (lib == nullptr) return errors::Internal("No function library");
-    *cond_handle = kInvalidHandle;
-    *body_handle = kInvalidHandle;
     {
       tf_shared_lock l(mu_);
       const auto iter = handles_.find(lib);
       if (TF_PREDICT_TRUE(iter != handles_.end())) {
-        *cond_handle = iter->second.first;
-        *body_handle = iter->second.second;
+        *handles = &iter->second;
+        return OkStatus();
       }
     }
-    if (TF_PREDICT_FALSE(*cond_handle == kInvalidHandle)) {
-      mutex_lock l(mu_);
-      const auto iter = handles_.find(lib);
-      if (TF_PREDICT_TRUE(iter != handles_.end())) {
-        *cond_handle = iter->second.first;
-        *body_handle = iter->second.second;
-      } else {
-        TF_RETURN_IF_ERROR(Instantiate(ctx, cond_func_, cond_handle));
-        TF_RETURN_IF_ERROR(Instantiate(ctx, body_func_, body_handle));
-        handles_[lib] = {*cond_handle, *body_handle};
+    mutex_lock l(mu_);
+    const auto iter = handles_.find(lib);
+    if (TF_PREDICT_TRUE(iter != handles_.end())) {
+      *handles = &iter->second;
+      return OkStatus();
+    }
+    Handles new_handles;
+    TF_RETURN_IF_ERROR(Instantiate(ctx, cond_func_, &new_handles.cond));
+    TF_RETURN_IF_ERROR(Instantiate(ctx, body_func_, &new_handles.body));
+    if (fuse_iterations_) {
+      Status s = InstantiateStep(ctx, &new_handles);
+      if (!s.ok()) {
+        // The loop still runs correctly with separate cond and body calls.
+        VLOG(1) << "Not fusing the iterations of " << name() << ": " << s;
+        new_handles.step = kInvalidHandle;
+        new_handles.step_ret_types.clear();
       }
     }
+    // `unordered_map` doesn't move its elements on rehash, so the pointer
+    // stays valid for the lifetime of the kernel.
+    *handles = &(handles_[lib] = std::move(new_handles));
+    return OkStatus();
+  }
+
+  // Builds and instantiates the function running the body followed by the
+  // cond on its results, which `StartStep` runs once per iteration.
+  Status InstantiateStep(OpKernelContext* ctx, Handles* handles) {
+    FunctionLibraryRuntime* lib = ctx->function_library();
+    const FunctionLibraryDefinition* lib_def =
+        lib->GetFunctionLibraryDefinition();
+    const FunctionDef* cond_fdef = lib_def->Find(cond_func_.name());
+    const FunctionDef* body_fdef = lib_def->Find(body_func_.name());
+    if (cond_fdef == nullptr || body_fdef == nullptr) {
+      return errors::NotFound("Cond or body is not a library function.");
+    }
+    const int num_loop_vars = input_types().size();
+    const OpDef::ArgDef* cond_ret = nullptr;
+    if (cond_fdef->signature().output_arg_size() == 1) {
+      cond_ret = &cond_fdef->signature().output_arg(0);
+    }
+    if (cond_ret == nullptr ||
+        body_fdef->signature().output_arg_size() != num_loop_vars) {
+      return errors::InvalidArgument(
+          "Unexpected number of cond or body return values.");
+    }
+    auto is_list = [](const OpDef::ArgDef& ret) {
+      return !ret.number_attr().empty() || !ret.type_list_attr().empty();
+    };
+    if (is_list(*cond_ret) ||
+        absl::c_any_of(body_fdef->signature().output_arg(), is_list)) {
+      return errors::Unimplemented("List return values are not supported.");
+    }
+    DataType cond_type = cond_ret->type();
+    if (!cond_ret->type_attr().empty()) {
+      const auto attr = cond_func_.attr().find(cond_ret->type_attr());
+      if (attr == cond_func_.attr().end()) {
+        return errors::InvalidArgument("Missing cond attr ",
+                                       cond_ret->type_attr());
+      }
+      cond_type = attr->second.type();
+    }
+
+    FunctionDef step;
+    OpDef* signature = step.mutable_signature();
+    signature->set_name(lib_def->UniqueFunctionName(
+        strings::StrCat(body_func_.name(), "_step_")));
+    NodeDef* body = step.add_node_def();
+    body->set_name("body");
+    body->set_op(body_func_.name());
+    *body->mutable_attr() = body_func_.attr();
+    NodeDef* cond = step.add_node_def();
+    cond->set_name("cond");
+    cond->set_op(cond_func_.name());
+    *cond->mutable_attr() = cond_func_.attr();
+    for (int i = 0; i < num_loop_vars; ++i) {
+      OpDef::ArgDef* arg = signature->add_input_arg();
+      arg->set_name(strings::StrCat("arg", i));
+      arg->set_type(input_type(i));
+      body->add_input(arg->name());
+
+      OpDef::ArgDef* ret = signature->add_output_arg();
+      ret->set_name(strings::StrCat("ret", i));
+      ret->set_type(input_type(i));
+      const string body_ret = strings::StrCat(
+          "body:", body_fdef->signature().output_arg(i).name(), ":0");
+      cond->add_input(body_ret);
+      (*step.mutable_ret())[ret->name()] = body_ret;
+      handles->step_ret_types.push_back(input_type(i));
+    }
+    OpDef::ArgDef* cond_arg = signature->add_output_arg();
+    cond_arg->set_name("cond");
+    cond_arg->set_type(cond_type);
+    (*step.mutable_ret())[cond_arg->name()] =
+        strings::StrCat("cond:", cond_ret->name(), ":0");
+    handles->step_ret_types.push_back(cond_type);
+
+    // The step function only lives in a library private to this kernel, next
+    // to the functions it calls.
+    auto step_lib_def = std::make_unique<FunctionLibraryDefinition>(
+        lib_def->ReachableDefinitions(step));
+    TF_RETURN_IF_ERROR(step_lib_def->AddFunctionDef(step));
+
+    FunctionLibraryRuntime::InstantiateOptions opts;
+    opts.executor_type = ctx->executor_type();
+    opts.lib_def = step_lib_def.get();
+    TF_RETURN_IF_ERROR(
+        lib->Instantiate(signature->name(), AttrSlice(), opts, &handles->step));
+    handles->step_lib_def = std::move(step_lib_def);
     return OkStatus();
   }
 };
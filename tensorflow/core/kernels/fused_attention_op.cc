@@ -0,0 +1,162 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Computes `softmax(scale * query * key^T) * value` for every batch, which is
+// what a BatchMatMul + Mul + Softmax + BatchMatMul chain computes. The work is
+// split into blocks of query rows, so that only one block of attention scores
+// is live per thread instead of the whole [batch, M, N] scores tensor.
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+
+    const int dims = query.dims();
+    OP_REQUIRES(context, dims >= 2,
+                errors::InvalidArgument(
+                    "query must be at least 2-dimensional: ",
+                    query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == dims && value.dims() == dims,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+    for (int i = 0; i < dims - 2; ++i) {
+      OP_REQUIRES(context,
+                  query.dim_size(i) == key.dim_size(i) &&
+                      query.dim_size(i) == value.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions: ",
+                      query.shape().DebugString(), " vs. ",
+                      key.shape().DebugString(), " vs. ",
+                      value.shape().DebugString()));
+    }
+    const int64_t m = query.dim_size(dims - 2);
+    const int64_t k = query.dim_size(dims - 1);
+    const int64_t n = key.dim_size(dims - 2);
+    const int64_t d = value.dim_size(dims - 1);
+    OP_REQUIRES(context, key.dim_size(dims - 1) == k,
+                errors::InvalidArgument(
+                    "query and key must have the same inner dimension: ",
+                    query.shape().DebugString(), " vs. ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(dims - 2) == n,
+                errors::InvalidArgument(
+                    "key and value must have the same number of rows: ",
+                    key.shape().DebugString(), " vs. ",
+                    value.shape().DebugString()));
+
+    TensorShape output_shape = query.shape();
+    output_shape.set_dim(dims - 1, d);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    if (n == 0) {
+      // The second BatchMatMul contracts over an empty dimension.
+      output->flat<T>().setZero();
+      return;
+    }
+
+    using Matrix =
+        Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using ConstMatrixMap = Eigen::Map<const Matrix>;
+    using MatrixMap = Eigen::Map<Matrix>;
+
+    int64_t batch = 1;
+    for (int i = 0; i < dims - 2; ++i) batch *= query.dim_size(i);
+    const int64_t blocks_per_batch = (m + kRowBlock - 1) / kRowBlock;
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const T scale = static_cast<T>(scale_);
+
+    auto attend = [&](int64_t start, int64_t limit) {
+      Matrix scores;
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / blocks_per_batch;
+        const int64_t row = (unit % blocks_per_batch) * kRowBlock;
+        const int64_t rows = std::min(kRowBlock, m - row);
+
+        ConstMatrixMap q(query_data + (b * m + row) * k, rows, k);
+        ConstMatrixMap key_b(key_data + b * n * k, n, k);
+        ConstMatrixMap value_b(value_data + b * n * d, n, d);
+        MatrixMap out(output_data + (b * m + row) * d, rows, d);
+
+        scores.noalias() = (q * key_b.transpose()) * scale;
+        for (int64_t r = 0; r < rows; ++r) {
+          auto s = scores.row(r);
+          s = (s.array() - s.maxCoeff()).exp();
+          s /= s.sum();
+        }
+        out.noalias() = scores * value_b;
+      }
+    };
+
+    const int64_t cost_per_block = kRowBlock * n * (2 * k + 2 * d + 10);
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          batch * blocks_per_batch, cost_per_block, attend);
+  }
+
+ private:
+  // Number of query rows whose attention scores are computed together.
+  static constexpr int64_t kRowBlock = 32;
+
+  float scale_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedScaledDotProductAttentionOp);
+};
+
+#define REGISTER_CPU_KERNEL(T)                                    \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention") \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<T>("T"),            \
+                          FusedScaledDotProductAttentionOp<T>);
+
+TF_CALL_float(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
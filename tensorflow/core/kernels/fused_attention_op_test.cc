@@ -0,0 +1,112 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<float> MakeValues(int size, float seed) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i) values[i] = std::sin(seed * (i + 1));
+  return values;
+}
+
+class FusedScaledDotProductAttentionOpTest : public OpsTestBase {
+ protected:
+  Status Init(float scale) {
+    TF_CHECK_OK(NodeDefBuilder("op", "_FusedScaledDotProductAttention")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Attr("scale", scale)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  // Checks the kernel against softmax(scale * q * k^T) * v computed one batch
+  // at a time.
+  void RunTest(int batch, int m, int n, int k, int d, float scale) {
+    const std::vector<float> query = MakeValues(batch * m * k, 0.3f);
+    const std::vector<float> key = MakeValues(batch * n * k, 0.7f);
+    const std::vector<float> value = MakeValues(batch * n * d, 1.1f);
+    TF_ASSERT_OK(Init(scale));
+    AddInputFromArray<float>(TensorShape({batch, m, k}), query);
+    AddInputFromArray<float>(TensorShape({batch, n, k}), key);
+    AddInputFromArray<float>(TensorShape({batch, n, d}), value);
+    TF_ASSERT_OK(RunOpKernel());
+
+    std::vector<float> expected(batch * m * d, 0.0f);
+    for (int b = 0; b < batch; ++b) {
+      for (int i = 0; i < m; ++i) {
+        std::vector<float> scores(n);
+        float max_score = -INFINITY;
+        for (int j = 0; j < n; ++j) {
+          float dot = 0;
+          for (int l = 0; l < k; ++l) {
+            dot += query[(b * m + i) * k + l] * key[(b * n + j) * k + l];
+          }
+          scores[j] = dot * scale;
+          max_score = std::max(max_score, scores[j]);
+        }
+        float sum = 0;
+        for (int j = 0; j < n; ++j) {
+          scores[j] = std::exp(scores[j] - max_score);
+          sum += scores[j];
+        }
+        for (int j = 0; j < n; ++j) {
+          for (int l = 0; l < d; ++l) {
+            expected[(b * m + i) * d + l] +=
+                scores[j] / sum * value[(b * n + j) * d + l];
+          }
+        }
+      }
+    }
+    test::ExpectClose(
+        *GetOutput(0),
+        test::AsTensor<float>(expected, TensorShape({batch, m, d})),
+        /*atol=*/1e-5);
+  }
+};
+
+TEST_F(FusedScaledDotProductAttentionOpTest, Small) {
+  RunTest(/*batch=*/2, /*m=*/3, /*n=*/5, /*k=*/4, /*d=*/2, /*scale=*/0.5f);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, MultipleRowBlocks) {
+  RunTest(/*batch=*/3, /*m=*/70, /*n=*/17, /*k=*/8, /*d=*/6, /*scale=*/0.35f);
+}
+
+TEST_F(FusedScaledDotProductAttentionOpTest, BatchMismatch) {
+  TF_ASSERT_OK(Init(1.0f));
+  AddInputFromArray<float>(TensorShape({2, 1, 1}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1, 1, 1}), {1});
+  AddInputFromArray<float>(TensorShape({1, 1, 1}), {1});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -133,6 +133,36 @@ struct LeakyRelu {
   };
 };
 
+// Applies `Gelu` with the tanh approximation to the passed input expression.
+struct GeluApproximate {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    // sqrt(2 / pi)
+    const Scalar kAlpha = static_cast<Scalar>(0.7978845608028654);
+    const Scalar kBeta = static_cast<Scalar>(0.044715);
+    return expr.constant(static_cast<Scalar>(0.5)) * expr *
+           (expr.constant(static_cast<Scalar>(1)) +
+            ((expr + expr.cube() * expr.constant(kBeta)) *
+             expr.constant(kAlpha))
+                .tanh());
+  };
+};
+
+// Applies `Gelu` with the exact erf formulation to the passed input
+// expression.
+struct GeluExact {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    // sqrt(1 / 2)
+    const Scalar kAlpha = static_cast<Scalar>(0.7071067811865476);
+    return expr.constant(static_cast<Scalar>(0.5)) * expr *
+           (expr.constant(static_cast<Scalar>(1)) +
+            (expr * expr.constant(kAlpha)).erf());
+  };
+};
+
 template <typename T>
 struct BiasAddArgs {
   const T* bias_add_data = nullptr;
@@ -143,7 +173,9 @@ struct BiasAddArgs {
            fusion == FusedComputationType::kBiasAddWithRelu ||
            fusion == FusedComputationType::kBiasAddWithRelu6 ||
            fusion == FusedComputationType::kBiasAddWithElu ||
-           fusion == FusedComputationType::kBiasAddWithLeakyRelu;
+           fusion == FusedComputationType::kBiasAddWithLeakyRelu ||
+           fusion == FusedComputationType::kBiasAddWithGeluApproximate ||
+           fusion == FusedComputationType::kBiasAddWithGeluExact;
   }
 };
 
@@ -360,6 +392,10 @@ using WithBiasAddAndElu = BiasAddOutputKernel<T, Elu>;
 template <typename T>
 using WithBiasAddAndLeakyRelu = BiasAddOutputKernel<T, LeakyRelu>;
 template <typename T>
+using WithBiasAddAndGeluApproximate = BiasAddOutputKernel<T, GeluApproximate>;
+template <typename T>
+using WithBiasAddAndGeluExact = BiasAddOutputKernel<T, GeluExact>;
+template <typename T>
 using WithFusedBatchNorm = FusedBatchNormOutputKernel<T>;
 template <typename T>
 using WithFusedBatchNormAndRelu = FusedBatchNormOutputKernel<T, Relu>;
@@ -0,0 +1,273 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/resource_variable_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtN };
+
+// Position of the rows of one segment in the `indices` of a lookup.
+struct SegmentRange {
+  int64_t start;
+  int64_t end;
+};
+
+}  // namespace
+
+// Computes the embedding lookups of several variables in one pass. Lookup `i`
+// reduces the rows `ids[i][indices[i][j]]` of variable `i` into the output row
+// `segment_ids[i][j]`, which is what a `ResourceGather` followed by a
+// `SparseSegment{Sum,Mean,SqrtN}` computes, without the gathered rows being
+// materialized in between.
+template <typename T, typename Tindices, typename Tidx, typename Tsegmentids>
+class FusedEmbeddingLookupsOp : public OpKernel {
+ public:
+  // Half precision embeddings are reduced in float, like in
+  // `SparseSegmentReductionOpBase`.
+  using Accumulator =
+      typename std::conditional<std::is_same<T, double>::value, double,
+                                float>::type;
+
+  explicit FusedEmbeddingLookupsOp(OpKernelConstruction* c) : OpKernel(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("N", &num_lookups_));
+    std::string combiner;
+    OP_REQUIRES_OK(c, c->GetAttr("combiner", &combiner));
+    if (combiner == "sum") {
+      combiner_ = Combiner::kSum;
+    } else if (combiner == "mean") {
+      combiner_ = Combiner::kMean;
+    } else {
+      combiner_ = Combiner::kSqrtN;
+    }
+  }
+
+  void Compute(OpKernelContext* c) override {
+    std::vector<int> resource_inputs(num_lookups_);
+    for (int i = 0; i < num_lookups_; ++i) {
+      resource_inputs[i] = i;
+    }
+    // All the variables are read at once, so their locks are acquired in
+    // address order, like sparse training ops do.
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        c, /*do_lock=*/false, /*sparse=*/true, resource_inputs);
+
+    std::vector<Tensor> params(num_lookups_);
+    std::vector<std::vector<SegmentRange>> segments(num_lookups_);
+    std::vector<int64_t> segment_offsets(num_lookups_ + 1, 0);
+    int64_t total_rows = 0;
+    int64_t total_cols = 0;
+    for (int i = 0; i < num_lookups_; ++i) {
+      OP_REQUIRES_OK(c, GetInputTensorFromVariable<CPUDevice, T>(
+                            c, i, /*lock_held=*/true, /*sparse=*/true,
+                            &params[i]));
+      OP_REQUIRES_OK(c, ValidateLookup(c, i, params[i], &segments[i]));
+      const int64_t num_segments = segments[i].size();
+      segment_offsets[i + 1] = segment_offsets[i] + num_segments;
+      total_rows += c->input(2 * num_lookups_ + i).NumElements();
+      total_cols += params[i].NumElements() /
+                    std::max<int64_t>(params[i].dim_size(0), 1);
+
+      TensorShape output_shape = params[i].shape();
+      OP_REQUIRES_OK(c, output_shape.SetDimWithStatus(0, num_segments));
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(c, c->allocate_output(i, output_shape, &output));
+    }
+
+    const int64_t total_segments = segment_offsets[num_lookups_];
+    if (total_segments == 0) {
+      return;
+    }
+    // A single sharded loop over the segments of all the lookups.
+    auto work = [&](int64_t begin, int64_t end) {
+      int lookup = std::upper_bound(segment_offsets.begin(),
+                                    segment_offsets.end(), begin) -
+                   segment_offsets.begin() - 1;
+      std::vector<Accumulator> sum;
+      for (int64_t s = begin; s < end; ++s) {
+        while (s >= segment_offsets[lookup + 1]) {
+          ++lookup;
+        }
+        ReduceSegment(c, lookup, params[lookup],
+                      segments[lookup][s - segment_offsets[lookup]],
+                      s - segment_offsets[lookup], &sum);
+      }
+    };
+    const int64_t cost_per_segment =
+        (total_rows / total_segments + 1) * (total_cols / num_lookups_ + 1);
+    auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, total_segments,
+          cost_per_segment, work);
+  }
+
+ private:
+  // Checks the inputs of lookup `i` and computes the range of `indices` that
+  // each of its output rows reduces.
+  Status ValidateLookup(OpKernelContext* c, int i, const Tensor& params,
+                        std::vector<SegmentRange>* segments) {
+    const Tensor& ids = c->input(num_lookups_ + i);
+    const Tensor& indices = c->input(2 * num_lookups_ + i);
+    const Tensor& segment_ids = c->input(3 * num_lookups_ + i);
+    if (!TensorShapeUtils::IsVectorOrHigher(params.shape())) {
+      return errors::InvalidArgument("params must be at least 1 dimensional");
+    }
+    if (!TensorShapeUtils::IsVector(ids.shape())) {
+      return errors::InvalidArgument("ids should be a vector, got shape ",
+                                     ids.shape().DebugString());
+    }
+    if (!TensorShapeUtils::IsVector(indices.shape())) {
+      return errors::InvalidArgument("indices should be a vector, got shape ",
+                                     indices.shape().DebugString());
+    }
+    if (!TensorShapeUtils::IsVector(segment_ids.shape())) {
+      return errors::InvalidArgument(
+          "segment_ids should be a vector, got shape ",
+          segment_ids.shape().DebugString());
+    }
+    const int64_t num_indices = indices.NumElements();
+    if (num_indices != segment_ids.NumElements()) {
+      return errors::InvalidArgument(
+          "segment_ids and indices should have same size.");
+    }
+    const auto ids_vec = ids.vec<Tindices>();
+    const auto indices_vec = indices.vec<Tidx>();
+    const auto segment_vec = segment_ids.vec<Tsegmentids>();
+    const int64_t num_ids = ids.NumElements();
+    const int64_t num_rows = params.dim_size(0);
+    // Segment ids must be sorted, so the last one defines the output size.
+    const int64_t num_segments =
+        num_indices > 0
+            ? internal::SubtleMustCopy(segment_vec(num_indices - 1)) + 1
+            : 0;
+    if (num_segments < 0) {
+      return errors::InvalidArgument("segment ids must be >= 0");
+    }
+    segments->assign(num_segments, SegmentRange{0, 0});
+    Tsegmentids previous = -1;
+    for (int64_t j = 0; j < num_indices; ++j) {
+      const Tsegmentids segment = internal::SubtleMustCopy(segment_vec(j));
+      if (segment < previous) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+      if (!FastBoundsCheck(segment, num_segments)) {
+        return errors::InvalidArgument(
+            "Segment id ", segment, " out of range [0, ", num_segments,
+            "), possibly because 'segment_ids' input is not sorted.");
+      }
+      const Tidx index = internal::SubtleMustCopy(indices_vec(j));
+      if (!FastBoundsCheck(index, num_ids)) {
+        return errors::InvalidArgument("indices[", j, "] = ", index,
+                                       " is not in [0, ", num_ids, ")");
+      }
+      const Tindices id = internal::SubtleMustCopy(ids_vec(index));
+      if (!FastBoundsCheck(id, num_rows)) {
+        return errors::InvalidArgument("ids[", index, "] = ", id,
+                                       " is not in [0, ", num_rows, ")");
+      }
+      if (segment != previous) {
+        (*segments)[segment].start = j;
+        previous = segment;
+      }
+      (*segments)[segment].end = j + 1;
+    }
+    return OkStatus();
+  }
+
+  // Computes output row `segment` of lookup `i`.
+  void ReduceSegment(OpKernelContext* c, int i, const Tensor& params,
+                     const SegmentRange& range, int64_t segment,
+                     std::vector<Accumulator>* sum) {
+    const auto params_flat = params.flat_outer_dims<T>();
+    const int64_t num_cols = params_flat.dimension(1);
+    const auto ids_vec = c->input(num_lookups_ + i).vec<Tindices>();
+    const auto indices_vec = c->input(2 * num_lookups_ + i).vec<Tidx>();
+    auto output_flat = c->mutable_output(i)->flat_outer_dims<T>();
+    sum->assign(num_cols, Accumulator(0));
+    for (int64_t j = range.start; j < range.end; ++j) {
+      const int64_t row = ids_vec(indices_vec(j));
+      const T* values = &params_flat(row, 0);
+      for (int64_t k = 0; k < num_cols; ++k) {
+        (*sum)[k] += static_cast<Accumulator>(values[k]);
+      }
+    }
+    Accumulator scale = 1;
+    const int64_t count = range.end - range.start;
+    if (count > 0 && combiner_ == Combiner::kMean) {
+      scale = Accumulator(1) / static_cast<Accumulator>(count);
+    } else if (count > 0 && combiner_ == Combiner::kSqrtN) {
+      scale = Accumulator(1) / std::sqrt(static_cast<Accumulator>(count));
+    }
+    T* out = &output_flat(segment, 0);
+    for (int64_t k = 0; k < num_cols; ++k) {
+      out[k] = static_cast<T>((*sum)[k] * scale);
+    }
+  }
+
+  int num_lookups_;
+  Combiner combiner_;
+};
+
+#define REGISTER_KERNEL(type, index_type, idx_type, segment_id_type) \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("_FusedEmbeddingLookups")                                 \
+          .Device(DEVICE_CPU)                                        \
+          .TypeConstraint<type>("dtype")                             \
+          .TypeConstraint<index_type>("Tindices")                    \
+          .TypeConstraint<idx_type>("Tidx")                          \
+          .TypeConstraint<segment_id_type>("Tsegmentids"),           \
+      FusedEmbeddingLookupsOp<type, index_type, idx_type, segment_id_type>);
+
+#define REGISTER_KERNEL_WITH_SEGMENT_ID_TYPES(type, index_type, idx_type) \
+  REGISTER_KERNEL(type, index_type, idx_type, int32);                     \
+  REGISTER_KERNEL(type, index_type, idx_type, int64_t);
+
+#define REGISTER_KERNEL_WITH_IDX_TYPES(type, index_type)            \
+  REGISTER_KERNEL_WITH_SEGMENT_ID_TYPES(type, index_type, int32);   \
+  REGISTER_KERNEL_WITH_SEGMENT_ID_TYPES(type, index_type, int64_t);
+
+#define REGISTER_CPU_KERNELS(type)              \
+  REGISTER_KERNEL_WITH_IDX_TYPES(type, int32);  \
+  REGISTER_KERNEL_WITH_IDX_TYPES(type, int64_t);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNEL_WITH_IDX_TYPES
+#undef REGISTER_KERNEL_WITH_SEGMENT_ID_TYPES
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
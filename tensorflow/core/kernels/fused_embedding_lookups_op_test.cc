@@ -0,0 +1,123 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedEmbeddingLookupsOpTest : public OpsTestBase {
+ protected:
+  Status Init(int num_lookups, const std::string& combiner) {
+    TF_CHECK_OK(NodeDefBuilder("op", "_FusedEmbeddingLookups")
+                    .Input(FakeInput(num_lookups, DT_RESOURCE))
+                    .Input(FakeInput(num_lookups, DT_INT64))
+                    .Input(FakeInput(num_lookups, DT_INT32))
+                    .Input(FakeInput(num_lookups, DT_INT32))
+                    .Attr("dtype", DT_FLOAT)
+                    .Attr("combiner", combiner)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  void AddVariable(const std::string& name, const TensorShape& shape,
+                   const std::vector<float>& values) {
+    Var* var = new Var(DT_FLOAT);
+    *var->tensor() = test::AsTensor<float>(values, shape);
+    var->is_initialized = true;
+    AddResourceInput("", name, var);
+  }
+};
+
+TEST_F(FusedEmbeddingLookupsOpTest, Mean) {
+  TF_ASSERT_OK(Init(/*num_lookups=*/2, "mean"));
+  AddVariable("table0", TensorShape({4, 2}), {0, 1, 2, 3, 4, 5, 6, 7});
+  AddVariable("table1", TensorShape({3, 1}), {10, 20, 30});
+  AddInputFromArray<int64_t>(TensorShape({3}), {3, 0, 1});
+  AddInputFromArray<int64_t>(TensorShape({2}), {2, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 2});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Segment 1 of the first lookup is empty.
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({3, 4, 0, 0, 2, 3}, TensorShape({3, 2})));
+  test::ExpectTensorEqual<float>(
+      *GetOutput(1), test::AsTensor<float>({30}, TensorShape({1, 1})));
+}
+
+TEST_F(FusedEmbeddingLookupsOpTest, Sum) {
+  TF_ASSERT_OK(Init(/*num_lookups=*/1, "sum"));
+  AddVariable("table", TensorShape({3, 1}), {1, 2, 4});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0), test::AsTensor<float>({3, 4}, TensorShape({2, 1})));
+}
+
+TEST_F(FusedEmbeddingLookupsOpTest, SqrtN) {
+  TF_ASSERT_OK(Init(/*num_lookups=*/1, "sqrtn"));
+  AddVariable("table", TensorShape({3, 1}), {1, 2, 4});
+  AddInputFromArray<int64_t>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 1, 2});
+  AddInputFromArray<int32>(TensorShape({3}), {0, 0, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({3 / std::sqrt(2.0f), 4}, TensorShape({2, 1})),
+      1e-6);
+}
+
+TEST_F(FusedEmbeddingLookupsOpTest, IdOutOfRange) {
+  TF_ASSERT_OK(Init(/*num_lookups=*/1, "mean"));
+  AddVariable("table", TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int64_t>(TensorShape({1}), {2});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  Status status = RunOpKernel();
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+  EXPECT_TRUE(absl::StrContains(status.message(), "ids[0] = 2"));
+}
+
+TEST_F(FusedEmbeddingLookupsOpTest, UnsortedSegmentIds) {
+  TF_ASSERT_OK(Init(/*num_lookups=*/1, "mean"));
+  AddVariable("table", TensorShape({2, 1}), {1, 2});
+  AddInputFromArray<int64_t>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  Status status = RunOpKernel();
+  EXPECT_EQ(error::INVALID_ARGUMENT, status.code());
+}
+
+}  // namespace
+}  // namespace tensorflow
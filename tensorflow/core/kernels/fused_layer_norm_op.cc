@@ -0,0 +1,129 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Layer normalization over the innermost dimension of `x`. Every row of `x` is
+// normalized with its own mean and (biased) variance, then scaled and shifted
+// by `scale` and `offset`, which is what the Keras LayerNormalization
+// subgraph computes with a training mode FusedBatchNormV3. Statistics are
+// accumulated in float for all input types.
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+
+    OP_REQUIRES(context, x.dims() >= 1,
+                errors::InvalidArgument("x must be at least 1-dimensional: ",
+                                        x.shape().DebugString()));
+    const int64_t depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(scale.shape()) &&
+                    scale.NumElements() == depth,
+                errors::InvalidArgument("scale must be a vector of size ",
+                                        depth, ": ",
+                                        scale.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(offset.shape()) &&
+                    offset.NumElements() == depth,
+                errors::InvalidArgument("offset must be a vector of size ",
+                                        depth, ": ",
+                                        offset.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    const auto x_rows = x.flat_inner_dims<T>();
+    const auto scale_vec = scale.vec<T>();
+    const auto offset_vec = offset.vec<T>();
+    auto y_rows = y->flat_inner_dims<T>();
+    const float epsilon = epsilon_;
+
+    auto normalize = [&](int64_t start, int64_t limit) {
+      std::vector<float> row(depth);
+      for (int64_t r = start; r < limit; ++r) {
+        float sum = 0.0f;
+        for (int64_t i = 0; i < depth; ++i) {
+          row[i] = static_cast<float>(x_rows(r, i));
+          sum += row[i];
+        }
+        const float mean = sum / depth;
+        float sum_of_squares = 0.0f;
+        for (int64_t i = 0; i < depth; ++i) {
+          row[i] -= mean;
+          sum_of_squares += row[i] * row[i];
+        }
+        const float inv_stddev =
+            1.0f / std::sqrt(sum_of_squares / depth + epsilon);
+        for (int64_t i = 0; i < depth; ++i) {
+          const float normalized = row[i] * inv_stddev;
+          y_rows(r, i) =
+              static_cast<T>(normalized * static_cast<float>(scale_vec(i)) +
+                             static_cast<float>(offset_vec(i)));
+        }
+      }
+    };
+
+    // Three passes over the row, with a handful of flops per element each.
+    const int64_t cost_per_row = 10 * depth;
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          x_rows.dimension(0), cost_per_row, normalize);
+  }
+
+ private:
+  float epsilon_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedLayerNormOp);
+};
+
+#define REGISTER_CPU_KERNEL(T)                                           \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>);
+
+TF_CALL_float(REGISTER_CPU_KERNEL);
+TF_CALL_bfloat16(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,95 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  Status Init(DataType dtype, float epsilon) {
+    TF_CHECK_OK(NodeDefBuilder("op", "_FusedLayerNorm")
+                    .Input(FakeInput(dtype))
+                    .Input(FakeInput(dtype))
+                    .Input(FakeInput(dtype))
+                    .Attr("epsilon", epsilon)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, Float) {
+  const float epsilon = 0.001f;
+  const std::vector<float> x = {1, 2, 3, 4, -3, 0, 3, 6};
+  const std::vector<float> scale = {1, 2, 1, 0.5};
+  const std::vector<float> offset = {0, 0, 1, -1};
+  TF_ASSERT_OK(Init(DT_FLOAT, epsilon));
+  AddInputFromArray<float>(TensorShape({2, 1, 4}), x);
+  AddInputFromArray<float>(TensorShape({4}), scale);
+  AddInputFromArray<float>(TensorShape({4}), offset);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected(x.size());
+  for (int row = 0; row < 2; ++row) {
+    const float* values = x.data() + row * 4;
+    float mean = 0, variance = 0;
+    for (int i = 0; i < 4; ++i) mean += values[i] / 4;
+    for (int i = 0; i < 4; ++i) {
+      variance += (values[i] - mean) * (values[i] - mean) / 4;
+    }
+    for (int i = 0; i < 4; ++i) {
+      expected[row * 4 + i] =
+          (values[i] - mean) / std::sqrt(variance + epsilon) * scale[i] +
+          offset[i];
+    }
+  }
+  test::ExpectClose(*GetOutput(0),
+                    test::AsTensor<float>(expected, TensorShape({2, 1, 4})),
+                    /*atol=*/1e-5);
+}
+
+TEST_F(FusedLayerNormOpTest, Bfloat16) {
+  TF_ASSERT_OK(Init(DT_BFLOAT16, 0.0f));
+  AddInputFromArray<bfloat16>(TensorShape({1, 2}), {bfloat16(1), bfloat16(3)});
+  AddInputFromArray<bfloat16>(TensorShape({2}), {bfloat16(1), bfloat16(1)});
+  AddInputFromArray<bfloat16>(TensorShape({2}), {bfloat16(0), bfloat16(0)});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<bfloat16>(
+      *GetOutput(0), test::AsTensor<bfloat16>({bfloat16(-1), bfloat16(1)},
+                                              TensorShape({1, 2})));
+}
+
+TEST_F(FusedLayerNormOpTest, ScaleSizeMismatch) {
+  TF_ASSERT_OK(Init(DT_FLOAT, 0.001f));
+  AddInputFromArray<float>(TensorShape({1, 4}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  AddInputFromArray<float>(TensorShape({4}), {0, 0, 0, 0});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,197 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Approximate cost of decoding a JPEG image, in cycles per output pixel. The
+// images of a batch are large units of work, so they are all sharded.
+constexpr int64_t kCostPerPixel = 1000;
+
+struct Interpolation {
+  int64_t lower;
+  int64_t upper;
+  float lerp;
+};
+
+// Computes the interpolation weights of the `out_size` output pixels, as
+// `ResizeBilinear` does.
+void ComputeInterpolation(int64_t out_size, int64_t in_size,
+                          bool half_pixel_centers,
+                          std::vector<Interpolation>* interpolation) {
+  const float scale = static_cast<float>(in_size) / out_size;
+  interpolation->resize(out_size);
+  for (int64_t i = 0; i < out_size; ++i) {
+    const float in = half_pixel_centers
+                         ? (static_cast<float>(i) + 0.5f) * scale - 0.5f
+                         : static_cast<float>(i) * scale;
+    const float in_f = std::floor(in);
+    Interpolation& weights = (*interpolation)[i];
+    weights.lower = std::max(static_cast<int64_t>(in_f), int64_t{0});
+    weights.upper =
+        std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1);
+    weights.lerp = in - in_f;
+  }
+}
+
+class BatchDecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit BatchDecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("height", &height_));
+    OP_REQUIRES_OK(context, context->GetAttr("width", &width_));
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    OP_REQUIRES_OK(context, context->GetAttr("half_pixel_centers",
+                                             &half_pixel_centers_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    const Tensor& crop_windows = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    const int64_t batch_size = contents.NumElements();
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsMatrix(crop_windows.shape()) &&
+                    crop_windows.dim_size(0) == batch_size &&
+                    crop_windows.dim_size(1) == 4,
+                errors::InvalidArgument(
+                    "crop_windows must have shape [", batch_size,
+                    ", 4], got ", crop_windows.shape().DebugString()));
+
+    Tensor* images = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({batch_size, height_, width_, channels_}),
+                       &images));
+    if (batch_size == 0) return;
+
+    const auto contents_vec = contents.vec<tstring>();
+    const auto windows = crop_windows.matrix<int32>();
+    float* images_data = images->flat<float>().data();
+    const int64_t image_size = int64_t{height_} * width_ * channels_;
+    std::vector<Status> statuses(batch_size);
+    auto decode_range = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        statuses[i] = DecodeAndResize(contents_vec(i), windows(i, 0),
+                                      windows(i, 1), windows(i, 2),
+                                      windows(i, 3),
+                                      images_data + i * image_size);
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          kCostPerPixel * height_ * width_, decode_range);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      OP_REQUIRES_OK(context, statuses[i]);
+    }
+  }
+
+ private:
+  // Decodes the window of `contents` at (`crop_y`, `crop_x`) of size
+  // `crop_height` x `crop_width`, or the whole image if the window is empty,
+  // and resizes it into the `height_` x `width_` x `channels_` `output`.
+  Status DecodeAndResize(const tstring& contents, int crop_y, int crop_x,
+                         int crop_height, int crop_width,
+                         float* output) const {
+    jpeg::UncompressFlags flags;
+    flags.components = channels_;
+    if (crop_height > 0 && crop_width > 0) {
+      // The window is cropped while decoding, so that the rows above and
+      // below it are skipped.
+      flags.crop = true;
+      flags.crop_y = crop_y;
+      flags.crop_x = crop_x;
+      flags.crop_height = crop_height;
+      flags.crop_width = crop_width;
+    }
+    int in_width = 0;
+    int in_height = 0;
+    int components = 0;
+    std::unique_ptr<uint8[]> decoded(jpeg::Uncompress(
+        contents.data(), contents.size(), flags, &in_width, &in_height,
+        &components, /*nwarn=*/nullptr));
+    if (decoded == nullptr) {
+      return errors::InvalidArgument(
+          "Invalid JPEG data or crop window, data size ", contents.size());
+    }
+    if (components != channels_ || in_width <= 0 || in_height <= 0) {
+      return errors::InvalidArgument("Unexpected decoded image of size ",
+                                     in_height, "x", in_width, "x",
+                                     components);
+    }
+
+    std::vector<Interpolation> ys;
+    std::vector<Interpolation> xs;
+    ComputeInterpolation(height_, in_height, half_pixel_centers_, &ys);
+    ComputeInterpolation(width_, in_width, half_pixel_centers_, &xs);
+    const int64_t in_row_size = int64_t{in_width} * channels_;
+    for (int64_t y = 0; y < height_; ++y) {
+      const uint8* top = decoded.get() + ys[y].lower * in_row_size;
+      const uint8* bottom = decoded.get() + ys[y].upper * in_row_size;
+      const float y_lerp = ys[y].lerp;
+      for (int64_t x = 0; x < width_; ++x) {
+        const int64_t left = xs[x].lower * channels_;
+        const int64_t right = xs[x].upper * channels_;
+        const float x_lerp = xs[x].lerp;
+        for (int c = 0; c < channels_; ++c) {
+          const float top_left = top[left + c];
+          const float top_right = top[right + c];
+          const float bottom_left = bottom[left + c];
+          const float bottom_right = bottom[right + c];
+          const float top_value = top_left + (top_right - top_left) * x_lerp;
+          const float bottom_value =
+              bottom_left + (bottom_right - bottom_left) * x_lerp;
+          *output++ = top_value + (bottom_value - top_value) * y_lerp;
+        }
+      }
+    }
+    return OkStatus();
+  }
+
+  int32 height_;
+  int32 width_;
+  int32 channels_;
+  bool half_pixel_centers_;
+};
+
+}  // namespace
+
+REGISTER_KERNEL_BUILDER(Name("_BatchDecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        BatchDecodeAndResizeJpegOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,97 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns a grayscale JPEG image whose left half is black and whose right half
+// is white.
+tstring HalfWhiteJpeg(int height, int width) {
+  std::vector<uint8> pixels(height * width);
+  for (int y = 0; y < height; ++y) {
+    for (int x = width / 2; x < width; ++x) {
+      pixels[y * width + x] = 255;
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_GRAYSCALE;
+  flags.quality = 100;
+  return jpeg::Compress(pixels.data(), width, height, flags);
+}
+
+class BatchDecodeAndResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(int height, int width) {
+    TF_ASSERT_OK(NodeDefBuilder("decode", "_BatchDecodeAndResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("height", height)
+                     .Attr("width", width)
+                     .Attr("channels", 1)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, CropsAndResizes) {
+  MakeOp(4, 4);
+  const tstring image = HalfWhiteJpeg(64, 64);
+  AddInputFromArray<tstring>(TensorShape({3}), {image, image, image});
+  // The first window selects the whole image, the second its white half and
+  // the third its black half.
+  AddInputFromArray<int32>(TensorShape({3, 4}),
+                           {0, 0, 0, 0, 0, 40, 32, 16, 16, 0, 32, 16});
+  TF_ASSERT_OK(RunOpKernel());
+
+  const Tensor& images = *GetOutput(0);
+  ASSERT_EQ(images.shape(), TensorShape({3, 4, 4, 1}));
+  const auto values = images.tensor<float, 4>();
+  for (int y = 0; y < 4; ++y) {
+    EXPECT_NEAR(values(0, y, 0, 0), 0.0f, 4.0f);
+    EXPECT_NEAR(values(0, y, 3, 0), 255.0f, 4.0f);
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_NEAR(values(1, y, x, 0), 255.0f, 4.0f);
+      EXPECT_NEAR(values(2, y, x, 0), 0.0f, 4.0f);
+    }
+  }
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, InvalidCropWindow) {
+  MakeOp(4, 4);
+  AddInputFromArray<tstring>(TensorShape({1}), {HalfWhiteJpeg(16, 16)});
+  AddInputFromArray<int32>(TensorShape({1, 4}), {8, 8, 16, 16});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(BatchDecodeAndResizeJpegOpTest, InvalidJpeg) {
+  MakeOp(4, 4);
+  AddInputFromArray<tstring>(TensorShape({1}), {"not a jpeg"});
+  AddInputFromArray<int32>(TensorShape({1, 4}), {0, 0, 0, 0});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -145,30 +145,6 @@ static inline float IOU(typename TTypes<T, 2>::ConstTensor boxes, int i,
   return intersection_area / (area_i + area_j - intersection_area);
 }
 
-static inline float IOU(const float* boxes, int i, int j) {
-  const float ymin_i = Eigen::numext::mini<float>(boxes[i], boxes[i + 2]);
-  const float xmin_i = Eigen::numext::mini<float>(boxes[i + 1], boxes[i + 3]);
-  const float ymax_i = Eigen::numext::maxi<float>(boxes[i], boxes[i + 2]);
-  const float xmax_i = Eigen::numext::maxi<float>(boxes[i + 1], boxes[i + 3]);
-  const float ymin_j = Eigen::numext::mini<float>(boxes[j], boxes[j + 2]);
-  const float xmin_j = Eigen::numext::mini<float>(boxes[j + 1], boxes[j + 3]);
-  const float ymax_j = Eigen::numext::maxi<float>(boxes[j], boxes[j + 2]);
-  const float xmax_j = Eigen::numext::maxi<float>(boxes[j + 1], boxes[j + 3]);
-  const float area_i = (ymax_i - ymin_i) * (xmax_i - xmin_i);
-  const float area_j = (ymax_j - ymin_j) * (xmax_j - xmin_j);
-  if (area_i <= 0 || area_j <= 0) {
-    return 0.0;
-  }
-  const float intersection_ymin = Eigen::numext::maxi<float>(ymin_i, ymin_j);
-  const float intersection_xmin = Eigen::numext::maxi<float>(xmin_i, xmin_j);
-  const float intersection_ymax = Eigen::numext::mini<float>(ymax_i, ymax_j);
-  const float intersection_xmax = Eigen::numext::mini<float>(xmax_i, xmax_j);
-  const float intersection_area =
-      Eigen::numext::maxi<float>(intersection_ymax - intersection_ymin, 0.0) *
-      Eigen::numext::maxi<float>(intersection_xmax - intersection_xmin, 0.0);
-  return intersection_area / (area_i + area_j - intersection_area);
-}
-
 template <typename T>
 static inline T Overlap(typename TTypes<T, 2>::ConstTensor overlaps, int i,
                         int j) {
@@ -337,6 +313,77 @@ struct ResultCandidate {
   float box_coord[4];
 };
 
+// The corners and areas of the boxes selected by the NMS of a class, stored
+// as one array per coordinate so that a candidate box can be compared to a
+// block of them with vector instructions.
+class SelectedBoxes {
+ public:
+  explicit SelectedBoxes(int capacity) {
+    ymin_.reserve(capacity);
+    xmin_.reserve(capacity);
+    ymax_.reserve(capacity);
+    xmax_.reserve(capacity);
+    area_.reserve(capacity);
+  }
+
+  int size() const { return area_.size(); }
+
+  void Add(const float* box) {
+    ymin_.push_back(Eigen::numext::mini<float>(box[0], box[2]));
+    xmin_.push_back(Eigen::numext::mini<float>(box[1], box[3]));
+    ymax_.push_back(Eigen::numext::maxi<float>(box[0], box[2]));
+    xmax_.push_back(Eigen::numext::maxi<float>(box[1], box[3]));
+    area_.push_back((ymax_.back() - ymin_.back()) *
+                    (xmax_.back() - xmin_.back()));
+  }
+
+  // Returns true if the IOU of `box` with any of the selected boxes is greater
+  // than `iou_threshold`. The IOUs are computed as `IOU()` does.
+  bool Overlaps(const float* box, float iou_threshold) const {
+    const float ymin_i = Eigen::numext::mini<float>(box[0], box[2]);
+    const float xmin_i = Eigen::numext::mini<float>(box[1], box[3]);
+    const float ymax_i = Eigen::numext::maxi<float>(box[0], box[2]);
+    const float xmax_i = Eigen::numext::maxi<float>(box[1], box[3]);
+    const float area_i = (ymax_i - ymin_i) * (xmax_i - xmin_i);
+    if (area_i <= 0) return false;
+    // Overlapping boxes are likely to have similar scores, therefore the
+    // blocks of the latest selected boxes are compared first.
+    for (int end = size(); end > 0; end -= kBlockSize) {
+      const int begin = std::max(0, end - kBlockSize);
+      bool overlaps = false;
+      for (int j = begin; j < end; ++j) {
+        const float intersection_ymin =
+            Eigen::numext::maxi<float>(ymin_i, ymin_[j]);
+        const float intersection_xmin =
+            Eigen::numext::maxi<float>(xmin_i, xmin_[j]);
+        const float intersection_ymax =
+            Eigen::numext::mini<float>(ymax_i, ymax_[j]);
+        const float intersection_xmax =
+            Eigen::numext::mini<float>(xmax_i, xmax_[j]);
+        const float intersection_area =
+            Eigen::numext::maxi<float>(intersection_ymax - intersection_ymin,
+                                       0.0) *
+            Eigen::numext::maxi<float>(intersection_xmax - intersection_xmin,
+                                       0.0);
+        const float iou =
+            intersection_area / (area_i + area_[j] - intersection_area);
+        overlaps |= area_[j] > 0 && iou > iou_threshold;
+      }
+      if (overlaps) return true;
+    }
+    return false;
+  }
+
+ private:
+  static constexpr int kBlockSize = 16;
+
+  std::vector<float> ymin_;
+  std::vector<float> xmin_;
+  std::vector<float> ymax_;
+  std::vector<float> xmax_;
+  std::vector<float> area_;
+};
+
 void DoNMSPerClass(int batch_idx, int class_idx, const float* boxes_data,
                    const float* scores_data, int num_boxes, int q,
                    int num_classes, const int size_per_class,
@@ -361,44 +408,29 @@ void DoNMSPerClass(int batch_idx, int class_idx, const float* boxes_data,
     }
   }
 
-  std::vector<int> selected;
+  SelectedBoxes selected(size_per_class);
   Candidate next_candidate;
 
-  int candidate_box_data_idx, selected_box_data_idx, class_box_idx;
+  int candidate_box_data_idx, class_box_idx;
   class_box_idx = (q > 1) ? class_idx : 0;
 
-  float iou;
   while (selected.size() < size_per_class &&
          !candidate_priority_queue.empty()) {
     next_candidate = candidate_priority_queue.top();
     candidate_priority_queue.pop();
 
     candidate_box_data_idx = (next_candidate.box_index * q + class_box_idx) * 4;
+    const float* candidate_box = boxes_data + candidate_box_data_idx;
 
-    // Overlapping boxes are likely to have similar scores,
-    // therefore we iterate through the previously selected boxes backwards
-    // in order to see if `next_candidate` should be suppressed.
-    bool should_select = true;
-    for (int j = selected.size() - 1; j >= 0; --j) {
-      selected_box_data_idx = (selected[j] * q + class_box_idx) * 4;
-      iou = IOU(boxes_data, candidate_box_data_idx, selected_box_data_idx);
-      if (iou > iou_threshold) {
-        should_select = false;
-        break;
-      }
-    }
-
-    if (should_select) {
+    if (!selected.Overlaps(candidate_box, iou_threshold)) {
       // Add the selected box to the result candidate. Sorted by score
       result_candidate_vec[selected.size() + size_per_class * class_idx] = {
           next_candidate.box_index,
           next_candidate.score,
           class_idx,
-          {boxes_data[candidate_box_data_idx],
-           boxes_data[candidate_box_data_idx + 1],
-           boxes_data[candidate_box_data_idx + 2],
-           boxes_data[candidate_box_data_idx + 3]}};
-      selected.push_back(next_candidate.box_index);
+          {candidate_box[0], candidate_box[1], candidate_box[2],
+           candidate_box[3]}};
+      selected.Add(candidate_box);
     }
   }
 }
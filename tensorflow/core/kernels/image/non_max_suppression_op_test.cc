@@ -1086,6 +1086,38 @@ TEST_F(CombinedNonMaxSuppressionOpTest, TestSelectFromThreeClusters) {
   test::ExpectTensorEqual<int>(expected_valid_d, *GetOutput(3));
 }
 
+TEST_F(CombinedNonMaxSuppressionOpTest, TestSuppressByEarlySelectedBox) {
+  MakeOp();
+  // 40 disjoint boxes, and a last box with the lowest score which overlaps the
+  // first one.
+  const int num_disjoint_boxes = 40;
+  std::vector<float> boxes;
+  std::vector<float> scores;
+  for (int i = 0; i < num_disjoint_boxes; ++i) {
+    boxes.insert(boxes.end(), {0, i * 0.02f, 0.01f, i * 0.02f + 0.01f});
+    scores.push_back(1.0f - i * 0.01f);
+  }
+  boxes.insert(boxes.end(), {0, 0.001f, 0.01f, 0.011f});
+  scores.push_back(0.1f);
+  AddInputFromArray<float>(TensorShape({1, num_disjoint_boxes + 1, 1, 4}),
+                           boxes);
+  AddInputFromArray<float>(TensorShape({1, num_disjoint_boxes + 1, 1}),
+                           scores);
+  AddInputFromArray<int>(TensorShape({}), {50});
+  AddInputFromArray<int>(TensorShape({}), {50});
+  AddInputFromArray<float>(TensorShape({}), {.5f});
+  AddInputFromArray<float>(TensorShape({}), {0.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_valid_d(allocator(), DT_INT32, TensorShape({1}));
+  test::FillValues<int>(&expected_valid_d, {num_disjoint_boxes});
+  test::ExpectTensorEqual<int>(expected_valid_d, *GetOutput(3));
+  const auto output_scores = GetOutput(1)->matrix<float>();
+  for (int i = 0; i < num_disjoint_boxes; ++i) {
+    EXPECT_EQ(output_scores(0, i), scores[i]);
+  }
+}
+
 TEST_F(CombinedNonMaxSuppressionOpTest,
        TestSelectFromThreeClustersNoBoxClipping) {
   MakeOp(false, false);
@@ -527,6 +527,56 @@ TEST_P(ResizeBilinearOpTest, TestInvalidSizeElements) {
       << s;
 }
 
+class ResizeBilinearUint8OpTest : public ResizeBilinearOpTestBase {
+ public:
+  ResizeBilinearUint8OpTest() { half_pixel_centers_ = true; }
+
+  void SetUp() override {
+    TF_EXPECT_OK(NodeDefBuilder("resize_bilinear_op", "ResizeBilinear")
+                     .Input(FakeInput(DT_UINT8))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("align_corners", align_corners_)
+                     .Attr("half_pixel_centers", half_pixel_centers_)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+
+  void TestResize(int batch_size, int input_height, int input_width,
+                  int channels, int output_height, int output_width) {
+    inputs_.clear();
+    const TensorShape shape({batch_size, input_height, input_width, channels});
+    std::vector<uint8> values(shape.num_elements());
+    std::vector<float> float_values(shape.num_elements());
+    for (int64_t i = 0; i < values.size(); ++i) {
+      values[i] = static_cast<uint8>((i * 7919 + 13) % 256);
+      float_values[i] = values[i];
+    }
+    const Tensor float_input = test::AsTensor<float>(float_values, shape);
+    AddInputFromArray<uint8>(shape, values);
+    AddInputFromArray<int32>(TensorShape({2}), {output_height, output_width});
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({batch_size, output_height,
+                                           output_width, channels}));
+    ResizeBilinearBaseline(float_input.tensor<float, 4>(),
+                           expected.tensor<float, 4>());
+    test::ExpectClose(expected, *GetOutput(0), /*atol=*/1e-3);
+  }
+};
+
+TEST_P(ResizeBilinearUint8OpTest, TestResize3Channels) {
+  for (int batch_size : {1, 3}) {
+    TestResize(batch_size, 183, 299, 3, 299, 299);
+    TestResize(batch_size, 299, 299, 3, 224, 224);
+    TestResize(batch_size, 7, 5, 3, 20, 13);
+  }
+}
+
+TEST_P(ResizeBilinearUint8OpTest, TestResize1Channel) {
+  TestResize(2, 183, 299, 1, 299, 299);
+  TestResize(2, 7, 5, 1, 20, 13);
+}
+
 INSTANTIATE_TEST_SUITE_P(ResizeBilinearOpTestCpu, ResizeBilinearOpTest,
                          ::testing::Values(TestDevice::CPU));
 INSTANTIATE_TEST_SUITE_P(ResizeBilinearHalfPixelCentersOpTestCpu,
@@ -535,6 +585,9 @@ INSTANTIATE_TEST_SUITE_P(ResizeBilinearHalfPixelCentersOpTestCpu,
 INSTANTIATE_TEST_SUITE_P(ResizeBilinearOpAlignCornersTestCpu,
                          ResizeBilinearOpAlignCornersTest,
                          ::testing::Values(TestDevice::CPU));
+INSTANTIATE_TEST_SUITE_P(ResizeBilinearUint8OpTestCpu,
+                         ResizeBilinearUint8OpTest,
+                         ::testing::Values(TestDevice::CPU));
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 // Instantiate tests for GPU.
 INSTANTIATE_TEST_SUITE_P(ResizeBilinearOpTestGpu, ResizeBilinearOpTest,
@@ -194,6 +194,11 @@ class InitializableLookupTable : public LookupInterface {
   // underlying data structure.
   virtual Status DoInsert(const Tensor& keys, const Tensor& values) = 0;
 
+  // Called once all the entries were inserted, before the table is marked as
+  // initialized. Implementations may convert the table into a read-only
+  // representation.
+  virtual Status DoFinalize() { return OkStatus(); }
+
   // Performs the batch find operation on the underlying data structure.
   virtual Status DoFind(const Tensor& keys, Tensor* values,
                         const Tensor& default_value) = 0;
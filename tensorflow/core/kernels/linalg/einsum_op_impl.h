@@ -21,6 +21,8 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <memory>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_split.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -39,6 +41,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/math/math_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/einsum_op_util.h"
@@ -492,18 +496,16 @@ class EinsumOp : public OpKernel {
     OpInputList inputs;
     OP_REQUIRES_OK(ctx, ctx->input_list("inputs", &inputs));
 
-    OperandLabels input_labels(input_labels_);
-    Labels output_labels(output_labels_);
-    std::vector<EinsumDimensionType> label_types(label_types_);
-    OperandLabelCounts input_label_counts(input_label_counts_);
-    LabelCounts output_label_counts(output_label_counts_);
-    LabelToDimSizes label_to_dim_sizes;
-
-    OP_REQUIRES_OK(ctx, EinsumHelper::ProcessDimensions(
-                            inputs, input_has_ellipsis_, output_has_ellipsis_,
-                            &input_labels, &output_labels, &label_types,
-                            &input_label_counts, &output_label_counts,
-                            &label_to_dim_sizes));
+    std::shared_ptr<const Dimensions> dimensions;
+    OP_REQUIRES_OK(ctx, GetDimensions(inputs, &dimensions));
+    OperandLabels input_labels(dimensions->input_labels);
+    const Labels& output_labels = dimensions->output_labels;
+    const std::vector<EinsumDimensionType>& label_types =
+        dimensions->label_types;
+    const OperandLabelCounts& input_label_counts =
+        dimensions->input_label_counts;
+    const LabelCounts& output_label_counts = dimensions->output_label_counts;
+    const LabelToDimSizes& label_to_dim_sizes = dimensions->label_to_dim_sizes;
 
     // The reduction phase (a) sums across reduction dimensions, (b) takes
     // generalized diagonals, and (c) reshapes it into shape
@@ -619,6 +621,55 @@ class EinsumOp : public OpKernel {
   }
 
  private:
+  // The equation processed against the shapes of a set of inputs.
+  struct Dimensions {
+    OperandLabels input_labels;
+    Labels output_labels;
+    std::vector<EinsumDimensionType> label_types;
+    OperandLabelCounts input_label_counts;
+    LabelCounts output_label_counts;
+    LabelToDimSizes label_to_dim_sizes;
+  };
+
+  // Returns the dimensions for the shapes of 'inputs'. The result for the
+  // most recent input shapes is cached, since the shapes of an Einsum node
+  // rarely change from one step to the next.
+  Status GetDimensions(const OpInputList& inputs,
+                       std::shared_ptr<const Dimensions>* dimensions) {
+    ShapeVec shapes_key;
+    for (const Tensor& input : inputs) {
+      shapes_key.push_back(input.dims());
+      for (int i = 0; i < input.dims(); ++i) {
+        shapes_key.push_back(input.dim_size(i));
+      }
+    }
+    {
+      tf_shared_lock l(mu_);
+      if (cached_dimensions_ != nullptr && cached_shapes_key_ == shapes_key) {
+        *dimensions = cached_dimensions_;
+        return OkStatus();
+      }
+    }
+
+    auto processed = std::make_shared<Dimensions>();
+    processed->input_labels = input_labels_;
+    processed->output_labels = output_labels_;
+    processed->label_types = label_types_;
+    processed->input_label_counts = input_label_counts_;
+    processed->output_label_counts = output_label_counts_;
+    TF_RETURN_IF_ERROR(EinsumHelper::ProcessDimensions(
+        inputs, input_has_ellipsis_, output_has_ellipsis_,
+        &processed->input_labels, &processed->output_labels,
+        &processed->label_types, &processed->input_label_counts,
+        &processed->output_label_counts, &processed->label_to_dim_sizes));
+    *dimensions = processed;
+
+    mutex_lock l(mu_);
+    cached_shapes_key_ = std::move(shapes_key);
+    cached_dimensions_ = std::move(processed);
+    return OkStatus();
+  }
+
   string equation_;
   OperandLabels input_labels_;
   Labels output_labels_;
@@ -627,6 +678,10 @@ class EinsumOp : public OpKernel {
   LabelCounts output_label_counts_;
   gtl::InlinedVector<bool, 2> input_has_ellipsis_;
   bool output_has_ellipsis_ = false;
+
+  mutex mu_;
+  ShapeVec cached_shapes_key_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const Dimensions> cached_dimensions_ TF_GUARDED_BY(mu_);
 };
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -15,15 +15,20 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -100,5 +105,208 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+class MutableHashTableShardsTest : public OpsTestBase {
+ protected:
+  // Creates a MutableHashTableV2 from int64 to float with `num_shards` shards.
+  void MakeTable(int num_shards) {
+    TF_ASSERT_OK(NodeDefBuilder("table", "MutableHashTableV2")
+                     .Attr("key_dtype", DT_INT64)
+                     .Attr("value_dtype", DT_FLOAT)
+                     .Attr("num_shards", num_shards)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    TF_ASSERT_OK(RunOpKernel());
+    TF_ASSERT_OK(LookupResource(context_.get(),
+                                GetOutput(0)->scalar<ResourceHandle>()(),
+                                &table_));
+  }
+
+  void TearDown() override {
+    if (table_ != nullptr) table_->Unref();
+  }
+
+  Tensor Find(const std::vector<int64_t>& keys) {
+    Tensor key_tensor = test::AsTensor<int64_t>(keys);
+    Tensor values(DT_FLOAT, key_tensor.shape());
+    TF_EXPECT_OK(table_->Find(context_.get(), key_tensor, &values,
+                              test::AsScalar<float>(-1)));
+    return values;
+  }
+
+  lookup::LookupInterface* table_ = nullptr;
+};
+
+TEST_F(MutableHashTableShardsTest, InsertFindRemove) {
+  MakeTable(4);
+  std::vector<int64_t> keys;
+  std::vector<float> values;
+  for (int64_t i = 0; i < 100; ++i) {
+    keys.push_back(i);
+    values.push_back(i / 2.0f);
+  }
+  // The last of duplicate keys in a batch wins.
+  keys.push_back(7);
+  values.push_back(100);
+  TF_ASSERT_OK(table_->Insert(context_.get(), test::AsTensor<int64_t>(keys),
+                              test::AsTensor<float>(values)));
+  EXPECT_EQ(100, table_->size());
+  test::ExpectTensorEqual<float>(Find({7, 50, 1000}),
+                                 test::AsTensor<float>({100, 25, -1}));
+
+  TF_ASSERT_OK(table_->Remove(context_.get(), test::AsTensor<int64_t>({50})));
+  EXPECT_EQ(99, table_->size());
+  test::ExpectTensorEqual<float>(Find({7, 50, 99}),
+                                 test::AsTensor<float>({100, -1, 49.5}));
+}
+
+TEST_F(MutableHashTableShardsTest, ConcurrentInsertAndFind) {
+  MakeTable(8);
+  const int kNumThreads = 4;
+  const int kKeysPerThread = 1000;
+  {
+    thread::ThreadPool pool(Env::Default(), "insert", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([this, t]() {
+        for (int i = 0; i < kKeysPerThread; i += 10) {
+          std::vector<int64_t> keys;
+          std::vector<float> values;
+          for (int j = i; j < i + 10; ++j) {
+            keys.push_back(t * kKeysPerThread + j);
+            values.push_back(t);
+          }
+          TF_EXPECT_OK(table_->Insert(context_.get(),
+                                      test::AsTensor<int64_t>(keys),
+                                      test::AsTensor<float>(values)));
+          Find(keys);
+        }
+      });
+    }
+  }
+  EXPECT_EQ(kNumThreads * kKeysPerThread, table_->size());
+  test::ExpectTensorEqual<float>(
+      Find({0, kKeysPerThread, 2 * kKeysPerThread + 1, 4 * kKeysPerThread}),
+      test::AsTensor<float>({0, 1, 2, -1}));
+}
+
+class HashTableCompactStorageTest : public OpsTestBase,
+                                    public ::testing::WithParamInterface<bool> {
+ protected:
+  // Creates a HashTableV2 from string to int64, compact if the test parameter
+  // is set.
+  void MakeTable() {
+    TF_ASSERT_OK(NodeDefBuilder("table", "HashTableV2")
+                     .Attr("key_dtype", DT_STRING)
+                     .Attr("value_dtype", DT_INT64)
+                     .Attr("compact_storage", GetParam())
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    TF_ASSERT_OK(RunOpKernel());
+    TF_ASSERT_OK(LookupResource(context_.get(),
+                                GetOutput(0)->scalar<ResourceHandle>()(),
+                                &table_));
+  }
+
+  void TearDown() override {
+    if (table_ != nullptr) table_->Unref();
+  }
+
+  Tensor Find(const std::vector<tstring>& keys) {
+    Tensor key_tensor = test::AsTensor<tstring>(keys);
+    Tensor values(DT_INT64, key_tensor.shape());
+    TF_EXPECT_OK(table_->Find(context_.get(), key_tensor, &values,
+                              test::AsScalar<int64_t>(-1)));
+    return values;
+  }
+
+  lookup::LookupInterface* table_ = nullptr;
+};
+
+TEST_P(HashTableCompactStorageTest, ImportAndFind) {
+  MakeTable();
+  std::vector<tstring> keys;
+  std::vector<int64_t> values;
+  for (int64_t i = 0; i < 1000; ++i) {
+    keys.push_back(absl::StrCat("token_", i));
+    values.push_back(2 * i);
+  }
+  keys.push_back("");
+  values.push_back(-2);
+  // Duplicates with the same value are allowed.
+  keys.push_back("token_7");
+  values.push_back(14);
+  TF_ASSERT_OK(table_->ImportValues(context_.get(),
+                                    test::AsTensor<tstring>(keys),
+                                    test::AsTensor<int64_t>(values)));
+  EXPECT_EQ(1001, table_->size());
+  test::ExpectTensorEqual<int64_t>(
+      Find({"token_7", "", "token_999", "token_1000", "token_0", "token"}),
+      test::AsTensor<int64_t>({14, -2, 1998, -1, 0, -1}));
+  EXPECT_GT(table_->MemoryUsed(), 0);
+}
+
+TEST_P(HashTableCompactStorageTest, ConflictingDuplicatesAreAnError) {
+  MakeTable();
+  Status s = table_->ImportValues(context_.get(),
+                                  test::AsTensor<tstring>({"a", "b", "a"}),
+                                  test::AsTensor<int64_t>({1, 2, 3}));
+  EXPECT_TRUE(errors::IsFailedPrecondition(s)) << s;
+  EXPECT_EQ(0, table_->size());
+}
+
+INSTANTIATE_TEST_SUITE_P(CompactStorage, HashTableCompactStorageTest,
+                         ::testing::Bool());
+
+TEST(CompactHashMapTest, StringValuesAndExport) {
+  absl::flat_hash_map<tstring, tstring> table;
+  for (int i = 0; i < 100; ++i) {
+    table[absl::StrCat("key_", i)] = absl::StrCat("value_", i);
+  }
+  lookup::CompactHashMap<tstring, tstring> compact;
+  ASSERT_TRUE(compact.Build(table));
+  EXPECT_EQ(100, compact.size());
+
+  const Tensor keys = test::AsTensor<tstring>({"key_3", "key_100", "key_99"});
+  Tensor values(DT_STRING, keys.shape());
+  compact.Find(keys.flat<tstring>(), values.flat<tstring>(), "none");
+  test::ExpectTensorEqual<tstring>(
+      values, test::AsTensor<tstring>({"value_3", "none", "value_99"}));
+
+  Tensor exported_keys(DT_STRING, TensorShape({100}));
+  Tensor exported_values(DT_STRING, TensorShape({100}));
+  compact.Export(exported_keys.flat<tstring>(),
+                 exported_values.flat<tstring>());
+  absl::flat_hash_map<tstring, tstring> exported;
+  for (int i = 0; i < 100; ++i) {
+    exported[exported_keys.flat<tstring>()(i)] =
+        exported_values.flat<tstring>()(i);
+  }
+  EXPECT_EQ(exported, table);
+}
+
+TEST(CompactHashMapTest, Empty) {
+  lookup::CompactHashMap<tstring, int64_t> compact;
+  ASSERT_TRUE(compact.Build({}));
+  EXPECT_EQ(0, compact.size());
+  const Tensor keys = test::AsTensor<tstring>({"a", ""});
+  Tensor values(DT_INT64, keys.shape());
+  compact.Find(keys.flat<tstring>(), values.flat<int64_t>(), -1);
+  test::ExpectTensorEqual<int64_t>(values, test::AsTensor<int64_t>({-1, -1}));
+}
+
+TEST(CompactHashMapTest, IntegerKeys) {
+  absl::flat_hash_map<int64_t, float> table;
+  for (int64_t i = 0; i < 5000; ++i) {
+    table[i * 7919] = i;
+  }
+  lookup::CompactHashMap<int64_t, float> compact;
+  ASSERT_TRUE(compact.Build(table));
+
+  const Tensor keys = test::AsTensor<int64_t>({0, 7919, 7920, 4999 * 7919});
+  Tensor values(DT_FLOAT, keys.shape());
+  compact.Find(keys.flat<int64_t>(), values.flat<float>(), -1);
+  test::ExpectTensorEqual<float>(values,
+                                 test::AsTensor<float>({0, 1, -1, 4999}));
+}
+
 }  // namespace
 }  // namespace tensorflow
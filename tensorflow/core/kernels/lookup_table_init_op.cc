@@ -146,9 +146,10 @@ class InitializeTableFromTextFileOp : public OpKernel {
       memory_used_before = table->MemoryUsed();
     }
     OP_REQUIRES_OK(
-        ctx, lookup::InitializeTableFromTextFile(
+        ctx, lookup::InitializeTableFromTextFileInParallel(
                  vocab_filename, vocab_size_, delimiter_, key_index_,
                  value_index_, offset_, ctx->env(),
+                 ctx->device()->tensorflow_cpu_worker_threads()->workers,
                  MakeInitializerSerializer(vocab_filename_tensor), table));
     if (ctx->track_allocations()) {
       ctx->record_persistent_memory_allocation(table->MemoryUsed() -
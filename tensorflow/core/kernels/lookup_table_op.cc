@@ -16,9 +16,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -36,6 +41,184 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+namespace {
+
+template <typename T>
+inline uint64 HashScalar(const T& key) {
+  return static_cast<uint64>(key);
+}
+
+inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
+
+// Returns the "num_shards" attr of the op creating a mutable hash table, or 1
+// for the table ops that do not have it.
+int64_t GetNumShards(OpKernel* kernel) {
+  int64_t num_shards = 1;
+  TryGetNodeAttr(kernel->def(), "num_shards", &num_shards);
+  return std::max<int64_t>(num_shards, 1);
+}
+
+}  // namespace
+
+// An unordered_map split into independently locked shards. Used by the
+// mutable hash tables so that lookups and inserts touching different shards do
+// not contend on a single lock.
+//
+// Batched accessors first compute the shard of every key in one branch-free
+// pass, which vectorizes for integer keys, and then lock each shard at most
+// once per batch. Within a shard keys are visited in batch order, so the last
+// of several duplicate keys in an insert batch wins, as with a single map.
+template <class K, class ValueType>
+class ShardedHashMap {
+ public:
+  typedef std::unordered_map<K, ValueType> Map;
+
+  explicit ShardedHashMap(int64_t num_shards)
+      : num_shards_(num_shards), shards_(new Shard[num_shards]) {}
+
+  int64_t num_shards() const { return num_shards_; }
+
+  size_t size() const {
+    size_t size = 0;
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      tf_shared_lock l(shards_[s].mu);
+      size += shards_[s].map.size();
+    }
+    return size;
+  }
+
+  // Calls `fn(map, i)` for every index `i` of `keys`, where `map` is the shard
+  // owning `keys(i)` and is read-locked for the duration of the call.
+  template <typename KeyFlat, typename Fn>
+  void VisitShared(const KeyFlat& keys, Fn fn) const {
+    if (num_shards_ == 1) {
+      tf_shared_lock l(shards_[0].mu);
+      for (int64_t i = 0; i < keys.size(); ++i) {
+        fn(shards_[0].map, i);
+      }
+      return;
+    }
+    std::vector<int64_t> order;
+    std::vector<int64_t> offsets;
+    GroupByShard(keys, &order, &offsets);
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      tf_shared_lock l(shards_[s].mu);
+      for (int64_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        fn(shards_[s].map, order[j]);
+      }
+    }
+  }
+
+  // Like VisitShared(), but `map` is write-locked. If `clear` is true, all
+  // shards are locked and emptied before any key is visited, so concurrent
+  // readers observe either the old or the new contents of the whole table.
+  template <typename KeyFlat, typename Fn>
+  void VisitExclusive(const KeyFlat& keys, bool clear,
+                      Fn fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<mutex_lock> all_locks;
+    if (clear) {
+      all_locks.reserve(num_shards_);
+      for (int64_t s = 0; s < num_shards_; ++s) {
+        all_locks.emplace_back(shards_[s].mu);
+        shards_[s].map.clear();
+      }
+    }
+    if (num_shards_ == 1) {
+      absl::optional<mutex_lock> l;
+      if (!clear) l.emplace(shards_[0].mu);
+      for (int64_t i = 0; i < keys.size(); ++i) {
+        fn(shards_[0].map, i);
+      }
+      return;
+    }
+    std::vector<int64_t> order;
+    std::vector<int64_t> offsets;
+    GroupByShard(keys, &order, &offsets);
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      if (offsets[s] == offsets[s + 1]) continue;
+      absl::optional<mutex_lock> l;
+      if (!clear) l.emplace(shards_[s].mu);
+      for (int64_t j = offsets[s]; j < offsets[s + 1]; ++j) {
+        fn(shards_[s].map, order[j]);
+      }
+    }
+  }
+
+  // Calls `fn(maps)` with every shard read-locked, where `maps` holds the
+  // per-shard maps. Used to take a consistent snapshot of the whole table.
+  template <typename Fn>
+  Status VisitAllShared(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<tf_shared_lock> all_locks;
+    all_locks.reserve(num_shards_);
+    std::vector<const Map*> maps;
+    maps.reserve(num_shards_);
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      all_locks.emplace_back(shards_[s].mu);
+      maps.push_back(&shards_[s].map);
+    }
+    return fn(maps);
+  }
+
+  // Returns the number of buckets of all shards, counting each empty bucket
+  // as one entry.
+  int64_t BucketEntries() const {
+    int64_t ret = 0;
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      tf_shared_lock l(shards_[s].mu);
+      const Map& map = shards_[s].map;
+      for (unsigned i = 0; i < map.bucket_count(); ++i) {
+        size_t bucket_size = map.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
+      }
+    }
+    return ret;
+  }
+
+ private:
+  struct Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  // Computes a permutation `order` of the indices of `keys` grouping them by
+  // shard, such that the keys of shard `s` are at
+  // `order[offsets[s]:offsets[s + 1]]`, in increasing index order.
+  template <typename KeyFlat>
+  void GroupByShard(const KeyFlat& keys, std::vector<int64_t>* order,
+                    std::vector<int64_t>* offsets) const {
+    const int64_t num_keys = keys.size();
+    std::vector<uint32> shard_ids(num_keys);
+    const uint64 num_shards = num_shards_;
+    // Fibonacci hashing followed by a multiply-shift range reduction; no
+    // branches or divisions, so the loop vectorizes for integer keys.
+    for (int64_t i = 0; i < num_keys; ++i) {
+      const uint64 mixed = HashScalar(keys(i)) * 0x9E3779B97F4A7C15ULL;
+      shard_ids[i] = static_cast<uint32>(((mixed >> 32) * num_shards) >> 32);
+    }
+    // Counting sort of the indices by shard.
+    offsets->assign(num_shards_ + 1, 0);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      ++(*offsets)[shard_ids[i] + 1];
+    }
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      (*offsets)[s + 1] += (*offsets)[s];
+    }
+    std::vector<int64_t> next(offsets->begin(), offsets->end() - 1);
+    order->resize(num_keys);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      (*order)[next[shard_ids[i]]++] = i;
+    }
+  }
+
+  const int64_t num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
@@ -53,12 +236,10 @@ std::string UniqueNodeName(const std::string& base) {
 template <class K, class V>
 class MutableHashTableOfScalars final : public LookupInterface {
  public:
-  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
+  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel)
+      : table_(GetNumShards(kernel)) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,8 +251,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.VisitShared(key_values, [&](const Map& table, int64_t i) {
       // is_full_size_default is true:
       //   Each key has an independent default value, key_values(i)
       //   corresponding uses default_flat(i) as its default value.
@@ -79,9 +259,9 @@ class MutableHashTableOfScalars final : public LookupInterface {
       // is_full_size_default is false:
       //   All keys will share the default_flat(0) as default value.
       value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
+          table, SubtleMustCopyIfIntegral(key_values(i)),
           is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    });
 
     return OkStatus();
   }
@@ -90,14 +270,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+    table_.VisitExclusive(key_values, clear, [&](Map& table, int64_t i) {
+      gtl::InsertOrUpdate(&table, SubtleMustCopyIfIntegral(key_values(i)),
                           SubtleMustCopyIfIntegral(value_values(i)));
-    }
+    });
     return OkStatus();
   }
 
@@ -109,10 +285,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.VisitExclusive(
+        key_values, /*clear=*/false, [&](Map& table, int64_t i) {
+          table.erase(SubtleMustCopyIfIntegral(key_values(i)));
+        });
     return OkStatus();
   }
 
@@ -122,17 +298,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return OkStatus();
+    return table_.VisitAllShared([&](const std::vector<const Map*>& tables) {
+      int64_t size = TotalSize(tables);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(tables, keys, values);
+      return OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +321,20 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.BucketEntries();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(
+        table_.VisitAllShared([&](const std::vector<const Map*>& tables) {
+          int64_t size = TotalSize(tables);
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(), TensorShape({size}));
+          ExportKeysAndValues(tables, &keys, &values);
+          return OkStatus();
+        }));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -176,7 +348,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
             .WithName(UniqueNodeName("MutableHashTableFromGraphDef"))
             .WithAttr("use_node_name_sharing", true)
             .WithAttr("key_dtype", key_dtype())
-            .WithAttr("value_dtype", value_dtype()));
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("num_shards", table_.num_shards()));
     Node* keys_node = ops::SourceOp(
         "Const",
         builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
@@ -195,21 +368,30 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef typename ShardedHashMap<K, V>::Map Map;
+
+  static int64_t TotalSize(const std::vector<const Map*>& tables) {
+    int64_t size = 0;
+    for (const Map* table : tables) size += table->size();
+    return size;
+  }
+
+  // Writes all keys and values of the read-locked `tables` into `keys` and
+  // `values`, which must point to tensors of size `TotalSize(tables)`.
+  void ExportKeysAndValues(const std::vector<const Map*>& tables, Tensor* keys,
+                           Tensor* values) const {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const Map* table : tables) {
+      for (auto it = table->begin(); it != table->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  ShardedHashMap<K, V> table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -217,7 +399,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
  public:
-  MutableHashTableOfTensors(OpKernelContext* ctx, OpKernel* kernel) {
+  MutableHashTableOfTensors(OpKernelContext* ctx, OpKernel* kernel)
+      : table_(GetNumShards(kernel)) {
     OP_REQUIRES_OK(ctx,
                    GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
     OP_REQUIRES(
@@ -226,10 +409,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,10 +422,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
+    table_.VisitShared(key_values, [&](const Map& table, int64_t i) {
+      const ValueArray* value_vec =
+          gtl::FindOrNull(table, SubtleMustCopyIfIntegral(key_values(i)));
       if (value_vec != nullptr) {
         for (int64_t j = 0; j < value_dim; j++) {
           value_values(i, j) = value_vec->at(j);
@@ -262,7 +441,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
               is_full_size_default ? default_flat(i, j) : default_flat(0, j);
         }
       }
-    }
+    });
 
     return OkStatus();
   }
@@ -272,19 +451,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    table_.VisitExclusive(key_values, clear, [&](Map& table, int64_t i) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+      gtl::InsertOrUpdate(&table, SubtleMustCopyIfIntegral(key_values(i)),
                           value_vec);
-    }
+    });
     return OkStatus();
   }
 
@@ -296,10 +471,10 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.VisitExclusive(
+        key_values, /*clear=*/false, [&](Map& table, int64_t i) {
+          table.erase(SubtleMustCopyIfIntegral(key_values(i)));
+        });
     return OkStatus();
   }
 
@@ -309,18 +484,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return OkStatus();
+    return table_.VisitAllShared([&](const std::vector<const Map*>& tables) {
+      int64_t size = TotalSize(tables);
+      int64_t value_dim = value_shape_.dim_size(0);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(tables, keys, values);
+      return OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +508,21 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.BucketEntries();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    TF_RETURN_IF_ERROR(
+        table_.VisitAllShared([&](const std::vector<const Map*>& tables) {
+          int64_t size = TotalSize(tables);
+          keys = Tensor(key_dtype(), TensorShape({size}));
+          values = Tensor(value_dtype(),
+                          TensorShape({size, value_shape_.dim_size(0)}));
+          ExportKeysAndValues(tables, &keys, &values);
+          return OkStatus();
+        }));
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -365,7 +537,8 @@ class MutableHashTableOfTensors final : public LookupInterface {
                           .WithAttr("use_node_name_sharing", true)
                           .WithAttr("key_dtype", key_dtype())
                           .WithAttr("value_dtype", value_dtype())
-                          .WithAttr("value_shape", value_shape_));
+                          .WithAttr("value_shape", value_shape_)
+                          .WithAttr("num_shards", table_.num_shards()));
     Node* keys_node = ops::SourceOp(
         "Const",
         builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
@@ -384,39 +557,41 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  typedef typename ShardedHashMap<K, ValueArray>::Map Map;
+
+  static int64_t TotalSize(const std::vector<const Map*>& tables) {
+    int64_t size = 0;
+    for (const Map* table : tables) size += table->size();
+    return size;
+  }
+
+  // Writes all keys and values of the read-locked `tables` into `keys` and
+  // `values`, which must point to tensors of size `TotalSize(tables)`.
+  void ExportKeysAndValues(const std::vector<const Map*>& tables, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Map* table : tables) {
+      for (auto it = table->begin(); it != table->end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  ShardedHashMap<K, ValueArray> table_;
 };
 
 namespace {
 
-template <typename T>
-inline uint64 HashScalar(const T& key) {
-  return static_cast<uint64>(key);
-}
-
-inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
-
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
@@ -16,9 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 #define TENSORFLOW_CORE_KERNELS_LOOKUP_TABLE_OP_H_
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -30,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -200,11 +211,201 @@ inline const ResourceHandle& SubtleMustCopyIfIntegral(
 // Returns a unique node name starting with "base".
 std::string UniqueNodeName(const std::string& base);
 
+// A column of table keys or values, stored contiguously.
+template <class T>
+class CompactColumn {
+ public:
+  static uint64 Hash(const T& value) { return absl::Hash<T>{}(value); }
+
+  bool Append(const T& value) {
+    data_.push_back(value);
+    return true;
+  }
+
+  bool Equals(size_t i, const T& value) const { return data_[i] == value; }
+
+  void CopyTo(size_t i, T* out) const { *out = data_[i]; }
+
+  void ShrinkToFit() { data_.shrink_to_fit(); }
+
+  int64_t MemoryUsed() const { return data_.capacity() * sizeof(T); }
+
+ private:
+  std::vector<T> data_;
+};
+
+// Strings are concatenated into one arena instead of being allocated one by
+// one. The arena is limited to 4GB so that offsets fit in 32 bits.
+template <>
+class CompactColumn<tstring> {
+ public:
+  static uint64 Hash(const tstring& value) {
+    return absl::Hash<absl::string_view>{}(
+        absl::string_view(value.data(), value.size()));
+  }
+
+  bool Append(const tstring& value) {
+    if (arena_.size() + value.size() > std::numeric_limits<uint32>::max()) {
+      return false;
+    }
+    arena_.append(value.data(), value.size());
+    ends_.push_back(arena_.size());
+    return true;
+  }
+
+  bool Equals(size_t i, const tstring& value) const {
+    return Get(i) == absl::string_view(value.data(), value.size());
+  }
+
+  void CopyTo(size_t i, tstring* out) const {
+    const absl::string_view s = Get(i);
+    out->assign(s.data(), s.size());
+  }
+
+  void ShrinkToFit() {
+    arena_.shrink_to_fit();
+    ends_.shrink_to_fit();
+  }
+
+  int64_t MemoryUsed() const {
+    return arena_.capacity() + ends_.capacity() * sizeof(uint32);
+  }
+
+ private:
+  absl::string_view Get(size_t i) const {
+    const uint32 begin = i == 0 ? 0 : ends_[i - 1];
+    return absl::string_view(arena_.data() + begin, ends_[i] - begin);
+  }
+
+  std::string arena_;
+  std::vector<uint32> ends_;
+};
+
+// Immutable map built once from the entries of an initialized HashTable.
+//
+// The entries are sorted by hash bucket, with one bucket per entry (rounded
+// up to a power of two), so the index is a single array of bucket offsets
+// plus a one byte fingerprint per entry. Keys and values are stored in
+// columns, which for strings are a single arena. A lookup reads the bucket
+// offsets, the fingerprints of the bucket, and the key and value of the
+// matching entry; batched lookups prefetch the buckets ahead of probing them.
+template <class K, class V>
+class CompactHashMap {
+ public:
+  // Builds the map from `table`. Returns false if the entries don't fit, in
+  // which case the map must not be used.
+  bool Build(const absl::flat_hash_map<K, V>& table) {
+    if (table.size() >= std::numeric_limits<uint32>::max()) {
+      return false;
+    }
+    num_entries_ = table.size();
+    size_t num_buckets = 1;
+    while (num_buckets < num_entries_) num_buckets <<= 1;
+    bucket_mask_ = num_buckets - 1;
+
+    // Counting sort of the entries by bucket.
+    bucket_starts_.assign(num_buckets + 1, 0);
+    for (const auto& entry : table) {
+      ++bucket_starts_[Bucket(CompactColumn<K>::Hash(entry.first)) + 1];
+    }
+    for (size_t b = 0; b < num_buckets; ++b) {
+      bucket_starts_[b + 1] += bucket_starts_[b];
+    }
+    std::vector<uint32> next(bucket_starts_.begin(), bucket_starts_.end() - 1);
+    std::vector<const std::pair<const K, V>*> sorted(num_entries_);
+    fingerprints_.resize(num_entries_);
+    for (const auto& entry : table) {
+      const uint64 hash = CompactColumn<K>::Hash(entry.first);
+      const uint32 position = next[Bucket(hash)]++;
+      sorted[position] = &entry;
+      fingerprints_[position] = Fingerprint(hash);
+    }
+    for (const auto* entry : sorted) {
+      if (!keys_.Append(entry->first) || !values_.Append(entry->second)) {
+        return false;
+      }
+    }
+    keys_.ShrinkToFit();
+    values_.ShrinkToFit();
+    return true;
+  }
+
+  size_t size() const { return num_entries_; }
+
+  void Find(typename TTypes<K>::ConstFlat keys, typename TTypes<V>::Flat values,
+            const V& default_value) const {
+    // Hashes a block of keys and prefetches their buckets, then probes them.
+    constexpr int64_t kBlockSize = 16;
+    uint64 hashes[kBlockSize];
+    for (int64_t begin = 0; begin < keys.size(); begin += kBlockSize) {
+      const int64_t end = std::min<int64_t>(begin + kBlockSize, keys.size());
+      for (int64_t i = begin; i < end; ++i) {
+        hashes[i - begin] =
+            CompactColumn<K>::Hash(SubtleMustCopyIfIntegral(keys(i)));
+        port::prefetch<port::PREFETCH_HINT_T0>(
+            &bucket_starts_[Bucket(hashes[i - begin])]);
+      }
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t entry =
+            FindEntry(SubtleMustCopyIfIntegral(keys(i)), hashes[i - begin]);
+        if (entry < 0) {
+          values(i) = default_value;
+        } else {
+          values_.CopyTo(entry, &values(i));
+        }
+      }
+    }
+  }
+
+  void Export(typename TTypes<K>::Flat keys,
+              typename TTypes<V>::Flat values) const {
+    for (size_t i = 0; i < num_entries_; ++i) {
+      keys_.CopyTo(i, &keys(i));
+      values_.CopyTo(i, &values(i));
+    }
+  }
+
+  int64_t MemoryUsed() const {
+    return bucket_starts_.capacity() * sizeof(uint32) +
+           fingerprints_.capacity() + keys_.MemoryUsed() +
+           values_.MemoryUsed();
+  }
+
+ private:
+  size_t Bucket(uint64 hash) const { return hash & bucket_mask_; }
+
+  static uint8 Fingerprint(uint64 hash) { return hash >> 56; }
+
+  // Returns the index of the entry of `key`, or -1 if there is none.
+  int64_t FindEntry(const K& key, uint64 hash) const {
+    const size_t bucket = Bucket(hash);
+    const uint8 fingerprint = Fingerprint(hash);
+    for (uint32 i = bucket_starts_[bucket]; i < bucket_starts_[bucket + 1];
+         ++i) {
+      if (fingerprints_[i] == fingerprint && keys_.Equals(i, key)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  size_t num_entries_ = 0;
+  uint64 bucket_mask_ = 0;
+  std::vector<uint32> bucket_starts_;
+  std::vector<uint8> fingerprints_;
+  CompactColumn<K> keys_;
+  CompactColumn<V> values_;
+};
+
 // Lookup table that wraps an flat_hash_map, where the key and value data type
 // is specified.
 //
 // This table is recommended for any variations to key values.
 //
+// If the op has `compact_storage` set, the entries are moved to a
+// CompactHashMap once the table is initialized, which uses a fraction of the
+// memory of the flat_hash_map for large tables of strings.
+//
 // For look up, the table is required to be initialized (allocated
 // and populated). Once the table is marked as initialized it becomes read-only.
 //
@@ -217,7 +418,12 @@ std::string UniqueNodeName(const std::string& base);
 template <class K, class V>
 class HashTable : public InitializableLookupTable {
  public:
-  HashTable(OpKernelContext* ctx, OpKernel* kernel) {}
+  HashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    if (kernel != nullptr &&
+        !TryGetNodeAttr(kernel->def(), "compact_storage", &compact_storage_)) {
+      compact_storage_ = false;
+    }
+  }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
     // We set use_node_name_sharing with a unique node name so that the resource
@@ -226,13 +432,16 @@ class HashTable : public InitializableLookupTable {
     // it is created in.
     // TODO(b/181695913): Provide a mechanism for deleting this resource
     // earlier when appropriate.
+    const GraphDefBuilder::Options opts =
+        builder->opts()
+            .WithName(UniqueNodeName("HashTableFromGraphDef"))
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("use_node_name_sharing", true);
     Node* hash_table_node = ops::SourceOp(
-        "HashTableV2", builder->opts()
-                           .WithName(UniqueNodeName("HashTableFromGraphDef"))
-                           .WithAttr("key_dtype", key_dtype())
-                           .WithAttr("value_dtype", value_dtype())
-                           .WithAttr("use_node_name_sharing", true));
-    if (table_.empty()) {
+        "HashTableV2",
+        compact_storage_ ? opts.WithAttr("compact_storage", true) : opts);
+    if (size() == 0) {
       *out = hash_table_node;
       return OkStatus();
     }
@@ -255,6 +464,8 @@ class HashTable : public InitializableLookupTable {
   size_t size() const override {
     if (!is_initialized())
       return 0;
+    else if (compact_table_ != nullptr)
+      return compact_table_->size();
     else
       return table_.size();
   }
@@ -264,7 +475,7 @@ class HashTable : public InitializableLookupTable {
       return errors::Aborted("HashTable is not initialized.");
     }
 
-    const int64_t size = table_.size();
+    const int64_t size = this->size();
 
     Tensor* keys;
     Tensor* values;
@@ -275,6 +486,10 @@ class HashTable : public InitializableLookupTable {
 
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
+    if (compact_table_ != nullptr) {
+      compact_table_->Export(keys_data, values_data);
+      return OkStatus();
+    }
     int64_t i = 0;
     for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
       keys_data(i) = it->first;
@@ -318,12 +533,31 @@ class HashTable : public InitializableLookupTable {
     return OkStatus();
   }
 
+  Status DoFinalize() override {
+    if (!compact_storage_) {
+      return OkStatus();
+    }
+    auto compact_table = std::make_unique<CompactHashMap<K, V>>();
+    if (!compact_table->Build(table_)) {
+      LOG(WARNING) << "HashTable of " << table_.size()
+                   << " entries is too large for compact storage.";
+      return OkStatus();
+    }
+    compact_table_ = std::move(compact_table);
+    absl::flat_hash_map<K, V>().swap(table_);
+    return OkStatus();
+  }
+
   Status DoFind(const Tensor& key, Tensor* value,
                 const Tensor& default_value) override {
     const V default_val = default_value.flat<V>()(0);
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
+    if (compact_table_ != nullptr) {
+      compact_table_->Find(key_values, value_values, default_val);
+      return OkStatus();
+    }
     for (int64_t i = 0; i < key_values.size(); ++i) {
       value_values(i) = gtl::FindWithDefault(
           table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
@@ -335,12 +569,18 @@ class HashTable : public InitializableLookupTable {
     if (!is_initialized()) {
       return 0;
     }
+    if (compact_table_ != nullptr) {
+      return compact_table_->MemoryUsed();
+    }
     const int64_t num_elements = table_.size();
     return num_elements * (sizeof(K) + sizeof(V));
   }
 
  private:
+  bool compact_storage_ = false;
   absl::flat_hash_map<K, V> table_;
+  // Replaces `table_` once the table is initialized with `compact_storage_`.
+  std::unique_ptr<CompactHashMap<K, V>> compact_table_;
 };
 
 }  // namespace lookup
@@ -15,7 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -24,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
 
 namespace tensorflow {
@@ -34,29 +39,92 @@ using InitializerSerializer =
     ::tensorflow::lookup::InitializableLookupTable::InitializerSerializer;
 
 static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
+// The size of the chunks of a file whose lines are parsed in parallel.
+static const int kParallelChunkSize = 16 * 1024 * 1024; /* bytes */
+// The estimated cost of parsing a line, in cycles.
+static const int kParseLineCost = 1000;
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
 
+// Counts the lines of `vocab_file` the way `InputBuffer::ReadLine` reads them,
+// without copying them: the last line needs no trailing newline.
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64_t* num_lines) {
   std::unique_ptr<RandomAccessFile> file;
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(vocab_file, &file));
 
-  io::InputBuffer input_buffer(file.get(), kInputBufferSize);
-  string line;
-  Status s = input_buffer.ReadLine(&line);
+  std::unique_ptr<char[]> scratch(new char[kInputBufferSize]);
+  uint64 offset = 0;
   int64_t next_id = 0;
-  while (s.ok()) {
-    next_id++;
-    s = input_buffer.ReadLine(&line);
+  bool ends_with_newline = true;
+  while (true) {
+    StringPiece chunk;
+    Status s = file->Read(offset, kInputBufferSize, &chunk, scratch.get());
+    if (!s.ok() && !absl::IsOutOfRange(s)) {
+      return s;
+    }
+    if (!chunk.empty()) {
+      next_id += std::count(chunk.begin(), chunk.end(), '\n');
+      ends_with_newline = chunk.back() == '\n';
+      offset += chunk.size();
+    }
+    if (!s.ok() || chunk.size() < kInputBufferSize) break;
   }
-  if (!absl::IsOutOfRange(s)) {
-    return s;
+  if (!ends_with_newline) {
+    next_id++;
   }
   *num_lines = next_id;
   return OkStatus();
 }
 
+// Parses `token` of line `line_number` into element `i` of `tensor`. Integer
+// values are offset by `offset`.
+Status ParseToken(StringPiece token, int64_t line_number, int64_t offset,
+                  int64_t i, Tensor* tensor) {
+  const DataType& dtype = tensor->dtype();
+  switch (dtype) {
+    case DT_INT32: {
+      int32_t value;
+      if (!strings::safe_strto32(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int32.");
+      }
+      tensor->flat<int32>()(i) = value + offset;
+    } break;
+    case DT_INT64: {
+      int64_t value;
+      if (!strings::safe_strto64(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid int64.");
+      }
+      tensor->flat<int64_t>()(i) = value;
+    } break;
+    case DT_FLOAT: {
+      float value;
+      if (!strings::safe_strtof(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid float.");
+      }
+      tensor->flat<float>()(i) = value;
+    } break;
+    case DT_DOUBLE: {
+      double value;
+      if (!strings::safe_strtod(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ",
+                                       line_number, " is not a valid double.");
+      }
+      tensor->flat<double>()(i) = value;
+    } break;
+    case DT_STRING:
+      tensor->flat<tstring>()(i).assign(token.data(), token.size());
+      break;
+    default:
+      return errors::InvalidArgument("Data type ", DataTypeString(dtype),
+                                     " not supported.");
+  }
+  return OkStatus();
+}
+
 // Iterator that reads a text file. Each iteration process one line, it parses
 // the line and populates the keys and values tensors used for initialization
 // with a single key and corresponding value.
@@ -213,58 +281,320 @@ class TextFileLineIterator
       return OkStatus();
     }
     const string& token = (index == kWholeLine) ? line : tokens[index];
-    const DataType& dtype = tensor->dtype();
-    switch (dtype) {
-      case DT_INT32: {
-        int32_t value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int32.");
-        }
-        tensor->flat<int32>()(0) = value + offset_;
-      } break;
-      case DT_INT64: {
-        int64_t value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int64.");
-        }
-        tensor->flat<int64_t>()(0) = value;
-      } break;
-      case DT_FLOAT: {
-        float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid float.");
-        }
-        tensor->flat<float>()(0) = value;
-      } break;
-      case DT_DOUBLE: {
-        double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid double.");
-        }
-        tensor->flat<double>()(0) = value;
-      } break;
-      case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+    Status s = ParseToken(token, next_id_, offset_, /*i=*/0, tensor);
+    if (!s.ok()) {
+      valid_ = false;
+    }
+    return s;
+  }
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TextFileLineIterator);
+};
+
+// Iterator that reads a text file by chunks like `TextFileLineIterator`, and
+// yields each chunk as a batch of keys and values. The lines of a chunk are
+// parsed in parallel into the batch, which the table then inserts at once.
+class TextFileChunkIterator
+    : public InitializableLookupTable::InitTableIterator {
+ public:
+  TextFileChunkIterator()
+      : valid_(false),
+        vocab_size_(-1),
+        status_(errors::FailedPrecondition("Not initialized")) {}
+
+  // Initialize iterator, with the same arguments as
+  // `TextFileLineIterator::Init`. Lines are parsed on `thread_pool`, or on the
+  // calling thread if it is null.
+  Status Init(const string& filename, int64_t vocab_size, char delimiter,
+              DataType key_dtype, int64_t key_index, DataType value_dtype,
+              int64_t value_index, int64_t offset, Env* env,
+              thread::ThreadPool* thread_pool) {
+    filename_ = filename;
+    vocab_size_ = vocab_size;
+    delimiter_ = delimiter;
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
+    key_index_ = key_index;
+    value_index_ = value_index;
+    env_ = env;
+    thread_pool_ = thread_pool;
+
+    status_ = env->NewRandomAccessFile(filename_, &file_);
+    if (!status_.ok()) return status_;
+
+    valid_ = true;
+    next_id_ = 0;
+    offset_ = offset;
+    file_offset_ = 0;
+    end_of_file_ = false;
+    truncated_ = false;
+    ignore_split_ = std::max(key_index_, value_index_) < 0;
+    Next();
+    return status_;
+  }
+
+  void Next() override {
+    if (!valid_) return;
+
+    if (truncated_) {
+      FinishTruncated();
+      return;
+    }
+    status_ = ReadLines();
+    if (status_.ok() && lines_.empty()) {
+      if (truncated_) {
+        FinishTruncated();
+        return;
+      }
+      status_ = errors::OutOfRange("End of file");
+      if (vocab_size_ != -1 && next_id_ != vocab_size_) {
+        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
+                                          ": expected ", vocab_size_,
+                                          " but got ", next_id_);
+      }
+    }
+    if (status_.ok()) {
+      status_ = ParseLines();
+    }
+    if (!status_.ok()) {
+      valid_ = false;
+      return;
+    }
+    next_id_ += lines_.size();
+  }
+
+  bool Valid() const override { return valid_; }
+
+  const Tensor& keys() const override { return keys_; }
+
+  const Tensor& values() const override { return values_; }
+
+  Status status() const override { return status_; }
+
+  int64_t total_size() const override {
+    if (vocab_size_ == -1) {
+      int64_t new_size = -1;
+      Status status = GetNumLinesInTextFile(env_, filename_, &new_size);
+      if (!status.ok()) {
+        LOG(WARNING) << "Unable to get line count: " << status;
+        new_size = -1;
+      }
+      *const_cast<int64_t*>(&vocab_size_) = new_size;
+    }
+    return vocab_size_;
+  }
+
+ private:
+  void FinishTruncated() {
+    LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                 << vocab_size_ << " records.";
+    status_ = errors::OutOfRange("Finished reading ", vocab_size_,
+                                 " of lines from ", filename_);
+    valid_ = false;
+  }
+
+  // Reads the complete lines of the next chunk of the file into `lines_`,
+  // keeping a trailing partial line in `buffer_` for the next chunk.
+  Status ReadLines() {
+    buffer_.erase(0, consumed_);
+    consumed_ = 0;
+    lines_.clear();
+    line_ends_.clear();
+    size_t last_newline = string::npos;
+    while (!end_of_file_) {
+      const size_t size = buffer_.size();
+      buffer_.resize(size + kParallelChunkSize);
+      StringPiece chunk;
+      Status s = file_->Read(file_offset_, kParallelChunkSize, &chunk,
+                             &buffer_[size]);
+      if (!s.ok() && !absl::IsOutOfRange(s)) return s;
+      if (chunk.data() != &buffer_[size]) {
+        std::memmove(&buffer_[size], chunk.data(), chunk.size());
+      }
+      buffer_.resize(size + chunk.size());
+      file_offset_ += chunk.size();
+      end_of_file_ = !s.ok() || chunk.size() < kParallelChunkSize;
+      // Data carried over from the previous chunk has no newline.
+      last_newline = buffer_.rfind('\n');
+      if (last_newline != string::npos) break;
+    }
+    size_t end = last_newline == string::npos ? 0 : last_newline + 1;
+    if (end_of_file_) {
+      end = buffer_.size();
+    }
+    // The file offset of the start of `buffer_`.
+    const uint64 buffer_offset = file_offset_ - buffer_.size();
+    size_t start = 0;
+    while (start < end) {
+      size_t newline = buffer_.find('\n', start);
+      if (newline == string::npos || newline >= end) newline = end;
+      size_t line_end = newline;
+      if (line_end > start && buffer_[line_end - 1] == '\r') --line_end;
+      const int64_t line_number = next_id_ + lines_.size();
+      if (vocab_size_ != -1 && line_number >= vocab_size_) {
+        truncated_ = true;
         break;
-      default:
-        valid_ = false;
-        return errors::InvalidArgument("Data type ", DataTypeString(dtype),
-                                       " not supported.");
+      }
+      lines_.emplace_back(&buffer_[start], line_end - start);
+      start = std::min(newline + 1, end);
+      line_ends_.push_back(buffer_offset + start);
     }
+    consumed_ = end;
     return OkStatus();
   }
 
-  TF_DISALLOW_COPY_AND_ASSIGN(TextFileLineIterator);
+  // Parses `lines_` into `keys_` and `values_` in parallel. Returns the error
+  // of the first invalid line, if any.
+  Status ParseLines() {
+    const int64_t num_lines = lines_.size();
+    keys_ = Tensor(key_dtype_, TensorShape({num_lines}));
+    values_ = Tensor(value_dtype_, TensorShape({num_lines}));
+    mutex mu;
+    int64_t first_error_line = num_lines;
+    Status first_error;
+    auto parse = [&](int64_t begin, int64_t end) {
+      std::vector<StringPiece> tokens;  // Reused across lines.
+      for (int64_t i = begin; i < end; ++i) {
+        Status s = ParseLine(i, &tokens);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < first_error_line) {
+            first_error_line = i;
+            first_error = s;
+          }
+          return;
+        }
+      }
+    };
+    if (thread_pool_ == nullptr) {
+      parse(0, num_lines);
+    } else {
+      thread_pool_->ParallelFor(num_lines, kParseLineCost, parse);
+    }
+    return first_error;
+  }
+
+  // Parses line `i` of the chunk into element `i` of the batch.
+  Status ParseLine(int64_t i, std::vector<StringPiece>* tokens) {
+    const StringPiece line = lines_[i];
+    const int64_t line_number = next_id_ + i;
+    if (line.empty()) {
+      return errors::InvalidArgument("Invalid content in ", filename_,
+                                     ": empty line found at position ",
+                                     line_ends_[i], ".");
+    }
+    if (!ignore_split_) {
+      tokens->clear();
+      for (StringPiece token : absl::StrSplit(line, delimiter_)) {
+        tokens->push_back(token);
+      }
+      const auto expected_size =
+          static_cast<size_t>(std::max(key_index_, value_index_) + 1);
+      if (tokens->size() < expected_size) {
+        return errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", line_number,
+            " (", line, ") : expected at least ", expected_size, " got ",
+            tokens->size());
+      }
+    }
+    TF_RETURN_IF_ERROR(SetValue(line, *tokens, key_index_, line_number, i,
+                                &keys_));
+    return SetValue(line, *tokens, value_index_, line_number, i, &values_);
+  }
+
+  Status SetValue(StringPiece line, const std::vector<StringPiece>& tokens,
+                  int64_t index, int64_t line_number, int64_t i,
+                  Tensor* tensor) {
+    if (index == kLineNumber) {
+      tensor->flat<int64_t>()(i) = line_number + offset_;
+      return OkStatus();
+    }
+    const StringPiece token = (index == kWholeLine) ? line : tokens[index];
+    return ParseToken(token, line_number, offset_, i, tensor);
+  }
+
+  Tensor keys_;
+  Tensor values_;
+  bool valid_;  // true if the iterator points to an existing range.
+  DataType key_dtype_;
+  DataType value_dtype_;
+  int64_t key_index_;
+  int64_t value_index_;
+  Env* env_;
+  thread::ThreadPool* thread_pool_;  // Not owned.
+  int64_t next_id_;
+  int64_t offset_;
+  int64_t vocab_size_;
+  string filename_;
+  char delimiter_;
+  Status status_;
+  bool ignore_split_;
+  std::unique_ptr<RandomAccessFile> file_;
+  uint64 file_offset_;
+  bool end_of_file_;
+  // Whether the current chunk reached `vocab_size_` lines before the end of
+  // the file.
+  bool truncated_;
+  // The data read from the file which isn't parsed yet, the first `consumed_`
+  // bytes of which are the lines of the current chunk.
+  string buffer_;
+  size_t consumed_ = 0;
+  // The lines of the current chunk, pointing into `buffer_`.
+  std::vector<StringPiece> lines_;
+  // The file offsets of the ends of `lines_`, for error messages.
+  std::vector<uint64> line_ends_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(TextFileChunkIterator);
 };
 
+Status CheckTextFileIndices(int32_t key_index, int32_t value_index,
+                            const InitializableLookupTable& table) {
+  if (key_index == kLineNumber && table.key_dtype() != DT_INT64) {
+    return errors::InvalidArgument(
+        "Key index for line number requires table key dtype of int64, got ",
+        DataTypeString(table.key_dtype()));
+  }
+  const DataType& key_dtype = table.key_dtype();
+  const DataType& value_dtype = table.value_dtype();
+  if (key_index == kWholeLine && !DataTypeIsInteger(key_dtype) &&
+      key_dtype != DT_STRING) {
+    return errors::InvalidArgument(
+        "Key index for whole line requires string or integer table key, got ",
+        DataTypeString(table.key_dtype()));
+  }
+  if (value_index == kLineNumber && value_dtype != DT_INT64) {
+    return errors::InvalidArgument(
+        "Value index for line number requires table value dtype of int64, got ",
+        DataTypeString(table.value_dtype()));
+  }
+  if (value_index == kWholeLine && !DataTypeIsInteger(value_dtype) &&
+      value_dtype != DT_STRING) {
+    return errors::InvalidArgument(
+        "Value index for whole line requires table value dtype of integer or "
+        "string, got ",
+        DataTypeString(table.value_dtype()));
+  }
+  return OkStatus();
+}
+
+// Initializes `table` from `iter`. For initialization from files, ignore if
+// the table is already initialized. The table shared name should contain the
+// filename to avoid trying to initialize the same table from the same file at
+// the same time.
+Status InitializeTableFromTextFileIterator(
+    const string& filename,
+    InitializableLookupTable::InitTableIterator& iter,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table) {
+  Status s = table->Initialize(iter, std::move(serializer));
+  if (absl::IsFailedPrecondition(s) && table->is_initialized()) {
+    LOG(INFO) << "Table trying to initialize from file " << filename
+              << " is already initialized.";
+    return OkStatus();
+  }
+  return s;
+}
+
 Status GetTableHandle(StringPiece input_name, OpKernelContext* ctx,
                       string* container, string* table_handle) {
   {
@@ -374,47 +704,30 @@ Status InitializeTableFromTextFile(
     int32_t key_index, int32_t value_index, int64_t offset, Env* env,
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table) {
-  if (key_index == kLineNumber && table->key_dtype() != DT_INT64) {
-    return errors::InvalidArgument(
-        "Key index for line number requires table key dtype of int64, got ",
-        DataTypeString(table->key_dtype()));
-  }
-  const DataType& key_dtype = table->key_dtype();
-  const DataType& value_dtype = table->value_dtype();
-  if (key_index == kWholeLine && !DataTypeIsInteger(key_dtype) &&
-      key_dtype != DT_STRING) {
-    return errors::InvalidArgument(
-        "Key index for whole line requires string or integer table key, got ",
-        DataTypeString(table->key_dtype()));
-  }
-  if (value_index == kLineNumber && value_dtype != DT_INT64) {
-    return errors::InvalidArgument(
-        "Value index for line number requires table value dtype of int64, got ",
-        DataTypeString(table->value_dtype()));
-  }
-  if (value_index == kWholeLine && !DataTypeIsInteger(value_dtype) &&
-      value_dtype != DT_STRING) {
-    return errors::InvalidArgument(
-        "Value index for whole line requires table value dtype of integer or "
-        "string, got ",
-        DataTypeString(table->value_dtype()));
-  }
-
+  TF_RETURN_IF_ERROR(CheckTextFileIndices(key_index, value_index, *table));
   TextFileLineIterator iter;
-  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, offset,
+  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter,
+                               table->key_dtype(), key_index,
+                               table->value_dtype(), value_index, offset,
                                env));
-  // For initialization from files, ignore if the table is already
-  // initialized. The table shared name should contain the filename to
-  // avoid trying to initialize the same table from the same file at the same
-  // time.
-  Status s = table->Initialize(iter, std::move(serializer));
-  if (absl::IsFailedPrecondition(s) && table->is_initialized()) {
-    LOG(INFO) << "Table trying to initialize from file " << filename
-              << " is already initialized.";
-    return OkStatus();
-  }
-  return s;
+  return InitializeTableFromTextFileIterator(filename, iter,
+                                             std::move(serializer), table);
+}
+
+Status InitializeTableFromTextFileInParallel(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    thread::ThreadPool* thread_pool,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table) {
+  TF_RETURN_IF_ERROR(CheckTextFileIndices(key_index, value_index, *table));
+  TextFileChunkIterator iter;
+  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter,
+                               table->key_dtype(), key_index,
+                               table->value_dtype(), value_index, offset, env,
+                               thread_pool));
+  return InitializeTableFromTextFileIterator(filename, iter,
+                                             std::move(serializer), table);
 }
 
 }  // namespace lookup
@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 
 namespace tensorflow {
 namespace data {
@@ -65,6 +66,17 @@ Status InitializeTableFromTextFile(
     std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
     InitializableLookupTable* table);
 
+// Initializes `table` from `filename` like `InitializeTableFromTextFile`, but
+// reads the file by chunks whose lines are parsed on `thread_pool`, and inserts
+// each chunk into the table at once. The lines are parsed on the calling
+// thread if `thread_pool` is null.
+Status InitializeTableFromTextFileInParallel(
+    const string& filename, int64_t vocab_size, char delimiter,
+    int32_t key_index, int32_t value_index, int64_t offset, Env* env,
+    thread::ThreadPool* thread_pool,
+    std::unique_ptr<InitializableLookupTable::InitializerSerializer> serializer,
+    InitializableLookupTable* table);
+
 }  // namespace lookup
 }  // namespace tensorflow
 
@@ -0,0 +1,176 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/lookup_util.h"
+
+#include <string>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr int kLineNumber = -1;
+constexpr int kWholeLine = -2;
+
+using StringToInt64Table = HashTable<tstring, int64_t>;
+
+class InitializeTableFromTextFileTest : public ::testing::TestWithParam<bool> {
+ protected:
+  InitializeTableFromTextFileTest()
+      : thread_pool_(Env::Default(), "lookup_util_test", 4) {}
+
+  string WriteVocabulary(const string& contents) {
+    const string filename =
+        io::JoinPath(testing::TmpDir(), absl::StrCat("vocab_", file_id_++));
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+    return filename;
+  }
+
+  // Initializes `table` sequentially or in parallel, depending on the test
+  // parameter.
+  Status Initialize(const string& filename, int64_t vocab_size,
+                    int32_t key_index, int32_t value_index,
+                    InitializableLookupTable* table) {
+    if (GetParam()) {
+      return InitializeTableFromTextFileInParallel(
+          filename, vocab_size, '\t', key_index, value_index, /*offset=*/0,
+          Env::Default(), &thread_pool_, /*serializer=*/nullptr, table);
+    }
+    return InitializeTableFromTextFile(filename, vocab_size, '\t', key_index,
+                                       value_index, /*offset=*/0,
+                                       Env::Default(), table);
+  }
+
+  int64_t Find(StringToInt64Table* table, const string& key) {
+    Tensor keys = test::AsTensor<tstring>({key});
+    Tensor values(DT_INT64, TensorShape({1}));
+    TF_CHECK_OK(table->Find(/*ctx=*/nullptr, keys, &values,
+                            test::AsScalar<int64_t>(-1)));
+    return values.flat<int64_t>()(0);
+  }
+
+  thread::ThreadPool thread_pool_;
+  int file_id_ = 0;
+};
+
+TEST_P(InitializeTableFromTextFileTest, KeysAndValuesFromColumns) {
+  const string filename = WriteVocabulary("a\t10\nb\t20\r\nc\t30");
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize(filename, /*vocab_size=*/-1, /*key_index=*/0,
+                          /*value_index=*/1, table));
+  EXPECT_EQ(table->size(), 3);
+  EXPECT_EQ(Find(table, "a"), 10);
+  EXPECT_EQ(Find(table, "b"), 20);
+  EXPECT_EQ(Find(table, "c"), 30);
+  EXPECT_EQ(Find(table, "d"), -1);
+}
+
+TEST_P(InitializeTableFromTextFileTest, WholeLineToLineNumber) {
+  string contents;
+  for (int i = 0; i < 10000; ++i) {
+    absl::StrAppend(&contents, "token_", i, "\n");
+  }
+  const string filename = WriteVocabulary(contents);
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize(filename, /*vocab_size=*/-1, kWholeLine,
+                          kLineNumber, table));
+  EXPECT_EQ(table->size(), 10000);
+  EXPECT_EQ(Find(table, "token_0"), 0);
+  EXPECT_EQ(Find(table, "token_5000"), 5000);
+  EXPECT_EQ(Find(table, "token_9999"), 9999);
+}
+
+TEST_P(InitializeTableFromTextFileTest, LinesSpanningChunks) {
+  // Larger than a chunk of the parallel initializer.
+  const int num_lines = 1 << 20;
+  string contents;
+  for (int i = 0; i < num_lines; ++i) {
+    absl::StrAppend(&contents, "token_", i, "\t", 2 * i, "\n");
+  }
+  const string filename = WriteVocabulary(contents);
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(Initialize(filename, /*vocab_size=*/-1, /*key_index=*/0,
+                          /*value_index=*/1, table));
+  EXPECT_EQ(table->size(), num_lines);
+  for (int i = 0; i < num_lines; i += 4099) {
+    EXPECT_EQ(Find(table, absl::StrCat("token_", i)), 2 * i);
+  }
+  EXPECT_EQ(Find(table, absl::StrCat("token_", num_lines - 1)),
+            2 * (num_lines - 1));
+}
+
+TEST_P(InitializeTableFromTextFileTest, TruncatesToVocabSize) {
+  const string filename = WriteVocabulary("a\nb\nc\n");
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  TF_ASSERT_OK(
+      Initialize(filename, /*vocab_size=*/2, kWholeLine, kLineNumber, table));
+  EXPECT_EQ(table->size(), 2);
+  EXPECT_EQ(Find(table, "c"), -1);
+}
+
+TEST_P(InitializeTableFromTextFileTest, InvalidVocabSize) {
+  const string filename = WriteVocabulary("a\nb\nc\n");
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Status s =
+      Initialize(filename, /*vocab_size=*/4, kWholeLine, kLineNumber, table);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.message(), "Invalid vocab_size")) << s;
+}
+
+TEST_P(InitializeTableFromTextFileTest, ReportsFirstInvalidLine) {
+  const string filename = WriteVocabulary("a\t1\nb\tx\nc\ny\tz\n");
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Status s = Initialize(filename, /*vocab_size=*/-1, /*key_index=*/0,
+                        /*value_index=*/1, table);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.message(), "Field x in line 1")) << s;
+}
+
+TEST_P(InitializeTableFromTextFileTest, EmptyLine) {
+  const string filename = WriteVocabulary("a\n\nc\n");
+  auto* table = new StringToInt64Table(nullptr, nullptr);
+  core::ScopedUnref unref(table);
+  Status s =
+      Initialize(filename, /*vocab_size=*/-1, kWholeLine, kLineNumber, table);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(absl::StrContains(s.message(), "empty line found at position 3"))
+      << s;
+}
+
+INSTANTIATE_TEST_SUITE_P(Parallel, InitializeTableFromTextFileTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
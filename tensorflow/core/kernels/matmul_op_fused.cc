@@ -139,6 +139,13 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
       case FusedComputationType::kBiasAddWithLeakyRelu:
         executeWithOutputKernel(WithBiasAddAndLeakyRelu<T>(bias_add_args));
         break;
+      case FusedComputationType::kBiasAddWithGeluApproximate:
+        executeWithOutputKernel(
+            WithBiasAddAndGeluApproximate<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithGeluExact:
+        executeWithOutputKernel(WithBiasAddAndGeluExact<T>(bias_add_args));
+        break;
       case FusedComputationType::kUndefined:
         OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
         break;
@@ -589,6 +596,8 @@ class FusedMatMulOp : public OpKernel {
           {FCT::kBiasAddWithRelu6, {"BiasAdd", "Relu6"}},
           {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
           {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+          {FCT::kBiasAddWithGeluApproximate, {"BiasAdd", "GeluApproximate"}},
+          {FCT::kBiasAddWithGeluExact, {"BiasAdd", "GeluExact"}},
       };
     } else if (std::is_same<Device, GPUDevice>::value) {
       patterns = {
@@ -140,6 +140,32 @@ class FusedMatMulOpTest : public OpsTestBase {
       ops::Elu(root.WithOpName("with_activation"), with_bias);
     } else if (activation_type == "LeakyRelu") {
       ops::internal::LeakyRelu(root.WithOpName("with_activation"), with_bias);
+    } else if (activation_type == "GeluExact") {
+      // 0.5 * x * (1 + erf(x / sqrt(2)))
+      auto erf = ops::Erf(root.WithOpName("erf"),
+                          ops::Mul(root.WithOpName("scaled"), with_bias,
+                                   static_cast<T>(0.7071067811865476)));
+      auto half =
+          ops::Mul(root.WithOpName("half"), with_bias, static_cast<T>(0.5));
+      ops::Mul(root.WithOpName("with_activation"), half,
+               ops::AddV2(root.WithOpName("erf_plus_one"), erf,
+                          static_cast<T>(1)));
+    } else if (activation_type == "GeluApproximate") {
+      // 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+      auto cube = ops::Mul(root.WithOpName("cube"), with_bias,
+                           ops::Square(root.WithOpName("square"), with_bias));
+      auto inner = ops::Mul(
+          root.WithOpName("inner"),
+          ops::AddV2(root.WithOpName("x_plus_cube"), with_bias,
+                     ops::Mul(root.WithOpName("scaled_cube"), cube,
+                              static_cast<T>(0.044715))),
+          static_cast<T>(0.7978845608028654));
+      auto tanh = ops::Tanh(root.WithOpName("tanh"), inner);
+      auto half =
+          ops::Mul(root.WithOpName("half"), with_bias, static_cast<T>(0.5));
+      ops::Mul(root.WithOpName("with_activation"), half,
+               ops::AddV2(root.WithOpName("tanh_plus_one"), tanh,
+                          static_cast<T>(1)));
     } else {
       ops::Identity(root.WithOpName("with_activation"), with_bias);
     }
@@ -330,6 +356,15 @@ TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul1x256x1WithActivation) {
   }
 }
 
+TYPED_TEST_P(FusedMatMulWithBiasOpTest, MatMul256x256x256WithGelu) {
+  for (const string& activation : {"GeluApproximate", "GeluExact"}) {
+    this->VerifyConv2DWithBiasAndActivation(256, 256, 256, false, false,
+                                            activation);
+    this->VerifyConv2DWithBiasAndActivation(256, 256, 256, true, false,
+                                            activation);
+  }
+}
+
 REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,        //
                             MatMul256x256x256,                //
                             MatMul1x256x256,                  //
@@ -338,7 +373,8 @@ REGISTER_TYPED_TEST_SUITE_P(FusedMatMulWithBiasOpTest,        //
                             MatMul256x256x256WithActivation,  //
                             MatMul1x256x256WithActivation,    //
                             MatMul256x256x1WithActivation,    //
-                            MatMul1x256x1WithActivation);
+                            MatMul1x256x1WithActivation,      //
+                            MatMul256x256x256WithGelu);
 
 // TODO(ezhulenev): Add support for more data types.
 using FusedBiasAddDataTypes = ::testing::Types<float>;
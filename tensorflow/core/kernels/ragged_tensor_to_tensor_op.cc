@@ -18,14 +18,20 @@ limitations under the License.
 #include <stddef.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/numeric_types.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -37,9 +43,13 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -52,11 +62,67 @@ const int kValueInputIndex = 1;
 const int kDefaultValueInputIndex = 2;
 const int kFirstPartitionInputIndex = 3;
 
+// Output index maps of values smaller than this are cheaper to recompute than
+// to look up.
+constexpr int kMinCachedOutputIndexSize = 1024;
+// Upper bound on the size of the output index maps cached during a step.
+constexpr int64_t kMaxCachedOutputIndexBytes = 64 << 20;
+constexpr char kOutputIndexCacheName[] =
+    "ragged_tensor_to_tensor_output_index_cache";
+
+// The output index maps calculated by the RaggedTensorToTensor kernels of a
+// step, stored in the step container.
+//
+// Ragged features often share their row partitions, and converting them to
+// dense tensors of the same shape requires the same output index map. The
+// maps are keyed by the buffers of the row partition tensors, which the cache
+// keeps alive until the end of the step so that their addresses can't be
+// reused by other tensors in the meantime.
+template <typename INDEX_TYPE>
+class OutputIndexCache : public ResourceBase {
+ public:
+  using OutputIndex = std::shared_ptr<const vector<INDEX_TYPE>>;
+
+  string DebugString() const override {
+    return "RaggedTensorToTensor output index cache";
+  }
+
+  OutputIndex Lookup(const string& key) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : it->second.output_index;
+  }
+
+  void Insert(const string& key, vector<Tensor> row_partition_tensors,
+              OutputIndex output_index) TF_LOCKS_EXCLUDED(mu_) {
+    const int64_t bytes = output_index->size() * sizeof(INDEX_TYPE);
+    mutex_lock l(mu_);
+    if (bytes_ + bytes > kMaxCachedOutputIndexBytes) return;
+    if (entries_
+            .emplace(key, Entry{std::move(row_partition_tensors),
+                                std::move(output_index)})
+            .second) {
+      bytes_ += bytes;
+    }
+  }
+
+ private:
+  struct Entry {
+    vector<Tensor> row_partition_tensors;
+    OutputIndex output_index;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<string, Entry> entries_ TF_GUARDED_BY(mu_);
+  int64_t bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
 template <typename INDEX_TYPE>
 class RaggedTensorToTensorBaseOp : public OpKernel {
  public:
   typedef
       typename ::tensorflow::TTypes<const INDEX_TYPE>::Flat RowPartitionTensor;
+  using OutputIndex = typename OutputIndexCache<INDEX_TYPE>::OutputIndex;
 
   explicit RaggedTensorToTensorBaseOp(OpKernelConstruction* context)
       : OpKernel(context) {
@@ -208,34 +274,50 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
   }
 
   Status CalculateOutputIndexRowSplit(
-      const RowPartitionTensor& row_split,
+      OpKernelContext* context, const RowPartitionTensor& row_split,
       const vector<INDEX_TYPE>& parent_output_index,
       INDEX_TYPE output_index_multiplier, INDEX_TYPE output_size,
       vector<INDEX_TYPE>* result) {
-    INDEX_TYPE row_split_size = row_split.size();
-    if (row_split_size > 0) {
-      result->reserve(row_split(row_split_size - 1));
+    const INDEX_TYPE row_split_size = row_split.size();
+    if (row_split_size == 0) {
+      return OkStatus();
+    }
+    if (row_split(0) != 0) {
+      return errors::InvalidArgument("Invalid row split size.");
     }
     for (INDEX_TYPE i = 0; i < row_split_size - 1; ++i) {
-      INDEX_TYPE row_length = row_split(i + 1) - row_split(i);
-      INDEX_TYPE real_length = std::min(output_size, row_length);
-      INDEX_TYPE parent_output_index_current = parent_output_index[i];
-
-      if (parent_output_index_current == -1) {
-        real_length = 0;
-      }
-      for (INDEX_TYPE j = 0; j < real_length; ++j) {
-        result->push_back(parent_output_index_current);
-        parent_output_index_current += output_index_multiplier;
+      if (row_split(i + 1) < row_split(i)) {
+        return errors::InvalidArgument("Invalid row split size.");
       }
-      for (INDEX_TYPE j = 0; j < row_length - real_length; ++j) {
-        result->push_back(-1);
-      }
-    }
-    if (row_split_size > 0 && result->size() != row_split(row_split_size - 1)) {
-      return errors::InvalidArgument("Invalid row split size.");
     }
 
+    // Each row is written at a known offset of the result, so the rows are
+    // filled in parallel.
+    result->resize(row_split(row_split_size - 1));
+    INDEX_TYPE* output = result->data();
+    auto fill_rows = [&](int64_t start, int64_t limit) {
+      for (int64_t i = start; i < limit; ++i) {
+        const INDEX_TYPE row_length = row_split(i + 1) - row_split(i);
+        const INDEX_TYPE parent_output_index_current = parent_output_index[i];
+        const INDEX_TYPE real_length =
+            parent_output_index_current == -1
+                ? 0
+                : std::min(output_size, row_length);
+        INDEX_TYPE* row_output = output + row_split(i);
+        for (INDEX_TYPE j = 0; j < real_length; ++j) {
+          row_output[j] =
+              parent_output_index_current + j * output_index_multiplier;
+        }
+        std::fill(row_output + real_length, row_output + row_length, -1);
+      }
+    };
+    const int64_t num_rows = row_split_size - 1;
+    const int64_t num_values = result->size();
+    const int64_t cost_per_row =
+        std::max<int64_t>(1, num_values / std::max<int64_t>(1, num_rows));
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          cost_per_row, fill_rows);
     return OkStatus();
   }
 
@@ -336,8 +418,8 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
               parent_output_index.size());
         }
         return CalculateOutputIndexRowSplit(
-            row_partition_tensor, parent_output_index, output_index_multiplier,
-            output_size, result);
+            context, row_partition_tensor, parent_output_index,
+            output_index_multiplier, output_size, result);
       default:
         return errors::InvalidArgument(
             "Unsupported partition type:",
@@ -397,24 +479,73 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                    context->allocate_output(0, output_shape, &output_tensor));
     const INDEX_TYPE full_size = multiplier[0] * output_size[0];
     if (full_size > 0) {
-      vector<INDEX_TYPE> output_index, new_output_index;
-      int nvals = context->input(kValueInputIndex).shape().dim_size(0);
-      output_index.reserve(nvals);
-      new_output_index.reserve(nvals);
-
-      CalculateFirstParentOutputIndex(first_dimension, multiplier[0],
-                                      output_size[0], &output_index);
-      for (int i = 1; i <= ragged_rank_; ++i) {
-        OP_REQUIRES_OK(context, CalculateOutputIndex(
-                                    context, i - 1, output_index, multiplier[i],
-                                    output_size[i], &new_output_index));
-        output_index.swap(new_output_index);
-        new_output_index.clear();
+      OutputIndex output_index;
+      OP_REQUIRES_OK(context,
+                     GetOutputIndex(context, first_dimension, output_size,
+                                    multiplier, &output_index));
+      SetOutput(context, ragged_rank_, *output_index, output_tensor);
+    }
+  }
+
+  // Calculates the output index of every element of values, or looks it up in
+  // the cache of the step if another kernel of the step already calculated it
+  // for the same row partition tensors and output size.
+  Status GetOutputIndex(OpKernelContext* context, INDEX_TYPE first_dimension,
+                        const vector<INDEX_TYPE>& output_size,
+                        const vector<INDEX_TYPE>& multiplier,
+                        OutputIndex* result) {
+    const int nvals = context->input(kValueInputIndex).shape().dim_size(0);
+    core::RefCountPtr<OutputIndexCache<INDEX_TYPE>> cache;
+    string key;
+    vector<Tensor> row_partition_tensors;
+    ScopedStepContainer* step_container = context->step_container();
+    if (step_container != nullptr && nvals >= kMinCachedOutputIndexSize) {
+      OutputIndexCache<INDEX_TYPE>* step_cache = nullptr;
+      TF_RETURN_IF_ERROR(
+          step_container->LookupOrCreate<OutputIndexCache<INDEX_TYPE>>(
+              context->resource_manager(), kOutputIndexCacheName, &step_cache,
+              [](OutputIndexCache<INDEX_TYPE>** ret) {
+                *ret = new OutputIndexCache<INDEX_TYPE>();
+                return OkStatus();
+              }));
+      cache.reset(step_cache);
+      for (const INDEX_TYPE size : output_size) {
+        absl::StrAppend(&key, size, ",");
+      }
+      for (const RowPartitionType type : row_partition_types_) {
+        absl::StrAppend(&key, static_cast<int>(type), ",");
       }
+      for (int i = kFirstPartitionInputIndex; i < context->num_inputs(); ++i) {
+        const Tensor& tensor = context->input(i);
+        absl::StrAppend(
+            &key, reinterpret_cast<uintptr_t>(tensor.tensor_data().data()),
+            ":", tensor.NumElements(), ",");
+        row_partition_tensors.push_back(tensor);
+      }
+      *result = cache->Lookup(key);
+      if (*result != nullptr) return OkStatus();
+    }
 
-      SetOutput(context, ragged_rank_, output_index, output_tensor);
+    auto output_index = std::make_shared<vector<INDEX_TYPE>>();
+    vector<INDEX_TYPE> new_output_index;
+    output_index->reserve(nvals);
+    new_output_index.reserve(nvals);
+    CalculateFirstParentOutputIndex(first_dimension, multiplier[0],
+                                    output_size[0], output_index.get());
+    for (int i = 1; i <= ragged_rank_; ++i) {
+      TF_RETURN_IF_ERROR(CalculateOutputIndex(context, i - 1, *output_index,
+                                              multiplier[i], output_size[i],
+                                              &new_output_index));
+      output_index->swap(new_output_index);
+      new_output_index.clear();
+    }
+    if (cache != nullptr) {
+      cache->Insert(key, std::move(row_partition_tensors), output_index);
     }
+    *result = std::move(output_index);
+    return OkStatus();
   }
+
   virtual void SetOutput(OpKernelContext* context, int ragged_rank,
                          const vector<INDEX_TYPE>& output_index,
                          Tensor* output_tensor) = 0;
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <numeric>
+#include <vector>
+
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -504,6 +507,66 @@ TEST_F(RaggedTensorToTensorOpTest, ShapeWrongDimensions) {
   EXPECT_EQ(errors::IsInvalidArgument(RunOpKernel()), true);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, InvalidRowSplits) {
+  BuildRaggedTensorToTensorGraph<int32, int32>(
+      TensorShape({3, 4}),                // shape
+      {"ROW_SPLITS"},                     // row_partition_types
+      createVector<int32>({1, 2, 3, 4}),  // values
+      createScalar<int32>(0),             // default_value
+      {createVector<int32>({0, 3, 2, 4})}  // row_partition_tensors
+  );
+  Status status = RunOpKernel();
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+TEST_F(RaggedTensorToTensorOpTest, SharedRowSplitsInOneStep) {
+  // Large enough for the output index to be cached for the step.
+  const int num_rows = 256;
+  const int num_columns = 8;
+  std::vector<int32> row_splits = {0};
+  for (int i = 0; i < num_rows; ++i) {
+    row_splits.push_back(row_splits.back() + i % 16);
+  }
+  const int num_values = row_splits.back();
+  std::vector<int32> values(num_values);
+  std::iota(values.begin(), values.end(), 0);
+  auto expected = [&](int32 multiplier) {
+    Tensor result(DT_INT32, TensorShape({num_rows, num_columns}));
+    auto matrix = result.matrix<int32>();
+    for (int i = 0; i < num_rows; ++i) {
+      for (int j = 0; j < num_columns; ++j) {
+        matrix(i, j) = j < row_splits[i + 1] - row_splits[i]
+                           ? multiplier * values[row_splits[i] + j]
+                           : -1;
+      }
+    }
+    return result;
+  };
+
+  BuildRaggedTensorToTensorGraph<int32, int32>(
+      TensorShape({num_rows, num_columns}),  // shape
+      {"ROW_SPLITS"},                        // row_partition_types
+      createVector<int32>(values),           // values
+      createScalar<int32>(-1),               // default_value
+      {createVector<int32>(row_splits)}      // row_partition_tensors
+  );
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(*GetOutput(0), expected(1));
+
+  // Converts other values with the same row splits in the same step.
+  Tensor other_values(DT_INT32, TensorShape({num_values}));
+  for (int i = 0; i < num_values; ++i) {
+    other_values.vec<int32>()(i) = 2 * values[i];
+  }
+  gtl::InlinedVector<TensorValue, 4> inputs = inputs_;
+  inputs[1] = TensorValue(&other_values);
+  params_->inputs = inputs;
+  OpKernelContext context(params_.get());
+  device_->Compute(kernel_.get(), &context);
+  TF_ASSERT_OK(context.status());
+  test::ExpectTensorEqual<int32>(*context.mutable_output(0), expected(2));
+}
+
 class RaggedTensorToTensorOpUnknownShapeTest
     : public ::tensorflow::OpsTestBase {
  protected:
@@ -21,6 +21,8 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -76,6 +78,18 @@ struct FillPhiloxRandom {
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
 
+// True for distributions that compute each output group from a single
+// PhiloxRandom output through a static FromSample(). Such groups can be
+// computed from Philox outputs generated in batches.
+template <class Distribution, class = void>
+struct HasFromSample : std::false_type {};
+
+template <class Distribution>
+struct HasFromSample<Distribution,
+                     std::void_t<decltype(Distribution::FromSample(
+                         std::declval<PhiloxRandom::ResultType>()))>>
+    : std::true_type {};
+
 // Specialization for distribution that takes a fixed number of samples for
 // each output.
 template <class Distribution>
@@ -90,10 +104,26 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
-      offset += kGroupSize;
+    if constexpr (HasFromSample<Distribution>::value) {
+      PhiloxRandom::ResultType blocks[PhiloxRandom::kGenerateBatchSize];
+      for (int64_t index = start_group; index < limit_group_full;) {
+        const int num_blocks = static_cast<int>(
+            std::min<int64_t>(PhiloxRandom::kGenerateBatchSize,
+                              limit_group_full - index));
+        gen.Generate(blocks, num_blocks);
+        for (int i = 0; i < num_blocks; ++i) {
+          auto samples = Distribution::FromSample(blocks[i]);
+          std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+          offset += kGroupSize;
+        }
+        index += num_blocks;
+      }
+    } else {
+      for (int64_t index = start_group; index < limit_group_full; ++index) {
+        auto samples = dist(&gen);
+        std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+        offset += kGroupSize;
+      }
     }
 
     // If there are any remaining elements that need to be filled, process them
@@ -54,6 +54,7 @@ limitations under the License.
 #endif
 
 #include <memory>
+#include <numeric>
 #include <type_traits>
 #include <vector>
 
@@ -228,6 +229,74 @@ REGISTER_KERNEL_BUILDER(
     Name("_ReadVariablesOp").Device(DEVICE_DEFAULT).HostMemory("resources"),
     ReadVariablesOp);
 
+// Outputs the rows of a variable written since the previous call, for delta
+// checkpoints; see `Var::TakeDirtyRows()`.
+template <typename T>
+class ReadVariableDirtyRowsOp : public OpKernel {
+ public:
+  explicit ReadVariableDirtyRowsOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<Var> variable;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 0), &variable));
+    // Sparse updates hold the lock in shared mode, so taking it exclusively
+    // keeps the rows consistent with the dirty rows.
+    mutex_lock ml(*variable->mu());
+    const Tensor& params = *variable->tensor();
+    OP_REQUIRES(ctx, variable->is_initialized,
+                errors::FailedPrecondition(
+                    "Attempting to read dirty rows of uninitialized variable ",
+                    HandleFromInput(ctx, 0).name()));
+    OP_REQUIRES(ctx, params.dtype() == DataTypeToEnum<T>::v(),
+                errors::InvalidArgument(
+                    "Trying to read variable with wrong dtype. Expected ",
+                    DataTypeString(params.dtype()), " got ",
+                    DataTypeString(DataTypeToEnum<T>::v())));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+        errors::InvalidArgument("params must be at least 1 dimensional"));
+
+    const int64_t num_params_rows = params.dim_size(0);
+    std::vector<int64_t> dirty_rows;
+    if (!variable->TakeDirtyRows(&dirty_rows)) {
+      dirty_rows.resize(num_params_rows);
+      std::iota(dirty_rows.begin(), dirty_rows.end(), 0);
+    }
+    const int64_t num_rows = dirty_rows.size();
+
+    Tensor* row_ids = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({num_rows}),
+                                             &row_ids));
+    TensorShape rows_shape = params.shape();
+    OP_REQUIRES_OK(ctx, rows_shape.SetDimWithStatus(0, num_rows));
+    Tensor* rows = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, rows_shape, &rows));
+    if (num_rows == 0) return;
+
+    auto row_ids_vec = row_ids->vec<int64_t>();
+    const auto params_flat = params.flat_outer_dims<T>();
+    auto rows_flat = rows->flat_outer_dims<T>();
+    for (int64_t i = 0; i < num_rows; ++i) {
+      OP_REQUIRES(ctx, FastBoundsCheck(dirty_rows[i], num_params_rows),
+                  errors::Internal("Dirty row ", dirty_rows[i],
+                                   " is not in [0, ", num_params_rows, ")"));
+      row_ids_vec(i) = dirty_rows[i];
+      rows_flat.template chip<0>(i) =
+          params_flat.template chip<0>(dirty_rows[i]);
+    }
+  }
+};
+
+#define REGISTER_KERNELS(type)                                \
+  REGISTER_KERNEL_BUILDER(Name("_ReadVariableDirtyRows")      \
+                              .Device(DEVICE_CPU)             \
+                              .TypeConstraint<type>("dtype"), \
+                          ReadVariableDirtyRowsOp<type>);
+
+TF_CALL_NUMBER_TYPES(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
 VarHandleOp::VarHandleOp(OpKernelConstruction* context) : OpKernel(context) {
   OP_REQUIRES_OK(context, context->GetAttr("container", &container_));
   OP_REQUIRES_OK(context, context->GetAttr("shared_name", &name_));
@@ -462,6 +531,7 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    variable->MarkAllRowsDirty();
   }
 
  private:
@@ -516,6 +586,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
                     DataTypeString(variable->tensor()->dtype()), " got ",
                     DataTypeString(DT_VARIANT)));
     variable->is_initialized = true;
+    variable->MarkAllRowsDirty();
     *variable->tensor() = Tensor(DT_VARIANT, value.shape());
 
     if (input_alias) {
@@ -601,6 +672,7 @@ class AssignUpdateVariableOp : public OpKernel {
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
+    variable->MarkAllRowsDirty();
   }
 };
 
@@ -676,12 +748,14 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
     // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
+    // (potentially very large) tensor buffer. For the same reason the
+    // variable isn't switched to copy-on-read mode here: the gather never
+    // aliases nor writes the buffer, and switching would copy the whole
+    // buffer if a dense read still aliases it. Only sparse writes switch.
     tf_shared_lock ml(*v->mu());
     const Tensor& params = *v->tensor();
     const Tensor& indices = c->input(1);
@@ -854,12 +928,14 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
     // reference count greater than one and make a copy of the
-    // (potentially very large) tensor buffer.
+    // (potentially very large) tensor buffer. For the same reason the
+    // variable isn't switched to copy-on-read mode here: the gather never
+    // aliases nor writes the buffer, and switching would copy the whole
+    // buffer if a dense read still aliases it. Only sparse writes switch.
     tf_shared_lock ml(*v->mu());
     const Tensor& params = *v->tensor();
     const Tensor& indices = c->input(1);
@@ -1132,6 +1208,12 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (N > 0) {
       OP_REQUIRES_OK(
           c, DoScatter<Device, T, Index, op>(c, params, indices, updates, N));
+      // Indices in device memory are not read back.
+      if (isCPUDevice<Device>()) {
+        v->MarkRowsDirty(indices);
+      } else {
+        v->MarkAllRowsDirty();
+      }
     }
   }
 };
@@ -31,9 +31,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -348,8 +350,73 @@ class RestoreV2OpTest : public OpsTestBase {
       }
     }
   }
+
+  // Restores tensors spread over several data shards of one bundle.
+  void RunShardedTest(const string& name) {
+    const int kNumShards = 4;
+    const int kTensorsPerShard = 3;
+    const string prefix = io::JoinPath(testing::TmpDir(), name);
+    std::vector<tstring> shard_prefixes;
+    for (int shard = 0; shard < kNumShards; ++shard) {
+      shard_prefixes.push_back(strings::StrCat(prefix, "_part", shard));
+      BundleWriter writer(Env::Default(), shard_prefixes.back());
+      for (int i = 0; i < kTensorsPerShard; ++i) {
+        const int id = shard * kTensorsPerShard + i;
+        TF_ASSERT_OK(writer.Add(
+            strings::StrCat("tensor_", id),
+            MakeInput<float>(TensorShape({id + 1, 10}), [id](int x) -> float {
+              return id * 1000 + x;
+            })));
+      }
+      TF_ASSERT_OK(writer.Finish());
+    }
+    TF_ASSERT_OK(MergeBundles(Env::Default(), shard_prefixes, prefix));
+
+    const int num_tensors = kNumShards * kTensorsPerShard;
+    TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                     .Input(FakeInput())
+                     .Input(FakeInput())
+                     .Input(FakeInput())
+                     .Attr("dtypes", DataTypeVector(num_tensors, DT_FLOAT))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInput<tstring>(TensorShape({}),
+                      [&prefix](int x) -> tstring { return prefix; });
+    // Restores in reverse name order, so that outputs are not in file order.
+    AddInput<tstring>(TensorShape({num_tensors}), [&](int x) -> tstring {
+      return strings::StrCat("tensor_", num_tensors - 1 - x);
+    });
+    AddInput<tstring>(TensorShape({num_tensors}),
+                      [](int x) -> tstring { return ""; });
+    TF_ASSERT_OK(RunOpKernel());
+    for (int output = 0; output < num_tensors; ++output) {
+      const int id = num_tensors - 1 - output;
+      test::ExpectTensorEqual<float>(
+          *GetOutput(output),
+          MakeInput<float>(TensorShape({id + 1, 10}), [id](int x) -> float {
+            return id * 1000 + x;
+          }));
+    }
+  }
 };
 
+TEST_F(RestoreV2OpTest, RestoreShardedBundle) {
+  RunShardedTest("restore_sharded");
+}
+
+TEST_F(RestoreV2OpTest, RestoreShardedBundleSingleReader) {
+  setenv("TF_RESTORE_V2_MAX_CONCURRENCY", "1", 1);
+  RunShardedTest("restore_sharded_single_reader");
+  unsetenv("TF_RESTORE_V2_MAX_CONCURRENCY");
+}
+
+TEST_F(RestoreV2OpTest, RestoreShardedBundleSmallInflightBudget) {
+  // Every tensor exceeds the budget, so reads are serialized across readers.
+  setenv("TF_RESTORE_V2_MAX_INFLIGHT_BYTES", "1", 1);
+  RunShardedTest("restore_sharded_small_budget");
+  unsetenv("TF_RESTORE_V2_MAX_INFLIGHT_BYTES");
+}
+
 // The intended use case (write in V2, read in V2).
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 // For backward compatibility.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -32,7 +33,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -247,13 +250,20 @@ void RestoreTensor(OpKernelContext* context,
 
 namespace {
 
-// Tensors larger than this threshold will be restored from a thread-pool.
+// Tensors larger than this threshold are restored as their own work item.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
-// A restore operation for a single tensor.  Small tensors may be restored
-// directly from the op thread to improve read locality.  Large tensors can be
-// restored from a thread pool: this requires creating a separate BundleReader
-// for each restore.
+// Default number of BundleReaders used concurrently by RestoreV2, including
+// the one on the op thread.  Overridden by TF_RESTORE_V2_MAX_CONCURRENCY.
+const int64_t kDefaultRestoreConcurrency = 8;
+
+// Default bound on the bytes of tensor data being read at once by RestoreV2.
+// Overridden by TF_RESTORE_V2_MAX_INFLIGHT_BYTES.
+const int64_t kDefaultRestoreInflightBytes = 1LL << 30;  // 1G
+
+// A restore operation for a single tensor.  Small tensors are restored in file
+// order together with the other small tensors of the same data shard, to
+// improve read locality.  Large tensors are restored on their own.
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
@@ -282,17 +292,6 @@ struct RestoreOp {
     return restored_full_shape.num_elements() > kLargeShapeThreshold;
   }
 
-  // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
-    if (!reader.status().ok()) {
-      status = reader.status();
-      return;
-    }
-
-    status = run(&reader);
-  }
-
   Status run(BundleReader* reader) {
     TensorShape restored_full_shape;
     TF_RETURN_IF_ERROR(
@@ -301,7 +300,14 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && reader->use_mmap()) {
+      // Lookup the full tensor, letting the reader alias the mapped data file
+      // instead of filling a freshly allocated output.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &restored));
+      context->set_output(idx, restored);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -356,7 +362,113 @@ struct RestoreOp {
   string reader_prefix;
   DataType dtype;
 
-  ::tensorflow::Status status;
+  // Data shard and (upper bound on the) number of bytes to read, filled in
+  // before scheduling.
+  int32_t shard_id = 0;
+  int64_t num_bytes = 0;
+};
+
+// Runs groups of restore operations over up to `concurrency` BundleReaders.
+// The calling thread takes part with the reader passed to Run(); every other
+// worker opens its own reader, so that different data shards (and different
+// large tensors) are read concurrently.  The bytes being read at once are
+// bounded by `inflight_budget`, although a single operation exceeding the
+// budget is still allowed to run on its own.
+class ParallelRestorer {
+ public:
+  ParallelRestorer(const string& prefix,
+                   std::vector<std::vector<RestoreOp*>> work_items,
+                   int64_t inflight_budget)
+      : prefix_(prefix),
+        work_items_(std::move(work_items)),
+        inflight_budget_(inflight_budget) {}
+
+  Status Run(BundleReader* default_reader, int64_t concurrency) {
+    const int64_t num_workers =
+        std::min<int64_t>(concurrency, work_items_.size()) - 1;
+    std::vector<Status> statuses(std::max<int64_t>(num_workers, 0));
+    Status status;
+    {
+      std::unique_ptr<thread::ThreadPool> reader_pool;
+      if (num_workers > 0) {
+        reader_pool.reset(new thread::ThreadPool(
+            Env::Default(), "restore_tensors", num_workers));
+        for (int64_t i = 0; i < num_workers; ++i) {
+          reader_pool->Schedule([this, &statuses, i]() {
+            BundleReader reader(Env::Default(), prefix_);
+            statuses[i] = reader.status();
+            if (statuses[i].ok()) {
+              statuses[i] = RunWorker(&reader);
+            } else {
+              Cancel();
+            }
+          });
+        }
+      }
+      status = RunWorker(default_reader);
+    }
+    // The pool has shut down, so all workers are done.
+    TF_RETURN_IF_ERROR(status);
+    for (const Status& s : statuses) {
+      TF_RETURN_IF_ERROR(s);
+    }
+    return OkStatus();
+  }
+
+ private:
+  Status RunWorker(BundleReader* reader) {
+    std::vector<RestoreOp*>* work_item;
+    while ((work_item = NextWorkItem()) != nullptr) {
+      for (RestoreOp* op : *work_item) {
+        AcquireBytes(op->num_bytes);
+        Status s = op->run(reader);
+        ReleaseBytes(op->num_bytes);
+        if (!s.ok()) {
+          Cancel();
+          return s;
+        }
+      }
+    }
+    return OkStatus();
+  }
+
+  // Returns the next work item to run, or nullptr once all items have been
+  // handed out or a worker has failed.
+  std::vector<RestoreOp*>* NextWorkItem() {
+    mutex_lock l(mu_);
+    if (cancelled_ || next_work_item_ == work_items_.size()) return nullptr;
+    return &work_items_[next_work_item_++];
+  }
+
+  void AcquireBytes(int64_t num_bytes) {
+    mutex_lock l(mu_);
+    while (inflight_bytes_ > 0 &&
+           inflight_bytes_ + num_bytes > inflight_budget_) {
+      cv_.wait(l);
+    }
+    inflight_bytes_ += num_bytes;
+  }
+
+  void ReleaseBytes(int64_t num_bytes) {
+    mutex_lock l(mu_);
+    inflight_bytes_ -= num_bytes;
+    cv_.notify_all();
+  }
+
+  void Cancel() {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+
+  const string prefix_;
+  std::vector<std::vector<RestoreOp*>> work_items_;
+  const int64_t inflight_budget_;
+
+  mutex mu_;
+  condition_variable cv_;
+  size_t next_work_item_ TF_GUARDED_BY(mu_) = 0;
+  int64_t inflight_bytes_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
 };
 
 }  // namespace
@@ -384,11 +496,17 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       restore_ops, [](const RestoreOp& op) { return op.tensor_name; }));
 
   std::vector<string> mismatched_errors;
-  for (const RestoreOp& restore_op : restore_ops) {
+  for (RestoreOp& restore_op : restore_ops) {
     TensorShape restored_full_shape;
     DataType original_dtype;
     TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
         restore_op.tensor_name, &original_dtype, &restored_full_shape));
+    TF_RETURN_IF_ERROR(default_reader.LookupDataShard(restore_op.tensor_name,
+                                                      &restore_op.shard_id));
+    const int64_t element_size = DataTypeCanUseMemcpy(original_dtype)
+                                     ? DataTypeSize(original_dtype)
+                                     : sizeof(tstring);
+    restore_op.num_bytes = restored_full_shape.num_elements() * element_size;
     if (restore_op.dtype != original_dtype) {
       string error_msg = strings::StrCat(
           "tensor_name = ", restore_op.tensor_name, "; expected dtype ",
@@ -402,38 +520,37 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
-  std::vector<RestoreOp*> pool_restore_ops;
-  std::vector<RestoreOp*> direct_restore_ops;
+  // Large tensors are scheduled first, each as its own work item, followed by
+  // one work item per data shard holding the small tensors in file order.
+  std::vector<std::vector<RestoreOp*>> work_items;
+  std::vector<std::vector<RestoreOp*>> shard_work_items;
   for (RestoreOp& restore_op : restore_ops) {
     if (restore_op.should_run_in_pool(&default_reader)) {
-      pool_restore_ops.push_back(&restore_op);
+      work_items.push_back({&restore_op});
+    } else if (!shard_work_items.empty() &&
+               shard_work_items.back().front()->shard_id ==
+                   restore_op.shard_id) {
+      shard_work_items.back().push_back(&restore_op);
     } else {
-      direct_restore_ops.push_back(&restore_op);
+      shard_work_items.push_back({&restore_op});
     }
   }
-
-  {
-    // Schedule any threaded operations first, skipping thread pool creation if
-    // we don't have any expensive operations.
-    std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto* op : pool_restore_ops) {
-        reader_pool->Schedule([op]() { op->run_with_new_reader(); });
-      }
-    }
-
-    // Read small tensors from the op thread
-    for (auto* op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
-    }
+  for (auto& shard_work_item : shard_work_items) {
+    work_items.push_back(std::move(shard_work_item));
   }
 
-  // Check status of pool ops; this must come after the pool shuts down.
-  for (auto* op : pool_restore_ops) {
-    TF_RETURN_IF_ERROR(op->status);
-  }
+  int64_t concurrency;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RESTORE_V2_MAX_CONCURRENCY",
+                                         kDefaultRestoreConcurrency,
+                                         &concurrency));
+  int64_t inflight_budget;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_RESTORE_V2_MAX_INFLIGHT_BYTES",
+                                         kDefaultRestoreInflightBytes,
+                                         &inflight_budget));
+  ParallelRestorer restorer(prefix_string, std::move(work_items),
+                            inflight_budget);
+  TF_RETURN_IF_ERROR(
+      restorer.Run(&default_reader, std::max<int64_t>(concurrency, 1)));
 
   for (const RestoreOp& restore_op : restore_ops) {
     if (restore_op.dtype != context->mutable_output(restore_op.idx)->dtype()) {
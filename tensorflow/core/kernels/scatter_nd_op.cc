@@ -257,6 +257,8 @@ class ScatterNdUpdateOp : public OpKernel {
       OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
       mutex_lock m(*v->mu());
       DoCompute(c);
+      // Dirty rows are only tracked for the 1-D indices of sparse updates.
+      v->MarkAllRowsDirty();
     } else if (use_exclusive_lock_) {
       // If we're here, it means the input type is a ref.
       DCHECK(IsRefType(c->input_dtype(0)));
@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 #define TENSORFLOW_CORE_KERNELS_SEGMENT_REDUCTION_OPS_IMPL_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/types.h"
@@ -41,8 +43,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -597,9 +602,16 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
+    // Validate the segment ids and the indices while collecting the segments,
+    // i.e. the ranges of indices with the same segment id, so that they can
+    // then be reduced in parallel.
+    struct Segment {
+      int64_t start;
+      int64_t end;
+      SegmentId out_index;
+    };
+    std::vector<Segment> segments;
     int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
     SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
 
     while (true) {
@@ -623,34 +635,68 @@ class SparseSegmentReductionOpBase : public OpKernel {
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
-
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+      for (int64_t i = start; i < end; ++i) {
+        const Index index = internal::SubtleMustCopy(indices_vec(i));
+        OP_REQUIRES(context, FastBoundsCheck(index, input_flat.dimension(0)),
+                    errors::InvalidArgument("Bad: indices[", i, "] == ", index,
+                                            " out of range [0, ",
+                                            input_flat.dimension(0), ")"));
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
+      segments.push_back({start, end, out_index});
 
       start = end;
       ++end;
-      uninitialized_index = out_index + 1;
       out_index = next_index;
       if (end > num_indices) break;
     }
 
+    mutex mu;
+    Status status;
+    auto reduce_segments = [&](int64_t first_segment, int64_t last_segment) {
+      for (int64_t i = first_segment; i < last_segment; ++i) {
+        const Segment& segment = segments[i];
+        // If there is a gap between two segments, we need to set that gap to
+        // the default value.
+        const SegmentId uninitialized_index =
+            i == 0 ? 0 : segments[i - 1].out_index + 1;
+        if (segment.out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              segment.out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+
+        auto out = output_flat.template chip<0>(segment.out_index);
+        auto temp = temp_flat.template chip<0>(segment.out_index);
+        const int bad_offset =
+            Reduce<T, Index>(input_flat, indices_vec, segment.start,
+                             segment.end - segment.start, out, temp);
+        // The indices were already validated, but may have been changed
+        // concurrently since.
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          status.Update(errors::InvalidArgument(
+              "Bad: indices[", segment.start + bad_offset,
+              "] == ", indices_vec(segment.start + bad_offset),
+              " out of range [0, ", input_flat.dimension(0), ")"));
+        }
+      }
+    };
+    // Shard the segments, each of which is reduced by a single thread, so
+    // that the output does not depend on the number of threads. The cost of
+    // a segment is that of adding its rows.
+    const int64_t num_segments = segments.size();
+    const int64_t cost_per_segment =
+        std::max<int64_t>(num_indices / num_segments, 1) * num_col;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES_OK(context, status);
+    const SegmentId uninitialized_index = segments.back().out_index + 1;
+
     // Fill the gap at the end with the default value.
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
@@ -823,6 +869,14 @@ class SparseSegmentReductionOpBase : public OpKernel {
         }
       }
       for (; r < num; r += 8) {
+        // Prefetch the rows of the next iteration while these are added.
+        for (int64_t p = r + 8; p < std::min<int64_t>(r + 16, num); ++p) {
+          const auto prefetch_index = indices_vec(start + p);
+          if (FastBoundsCheck(prefetch_index, input_flat.dimension(0))) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                &input_flat(prefetch_index, 0));
+          }
+        }
         INDEX(0, r);
         INDEX(1, r + 1);
         INDEX(2, r + 2);
@@ -181,6 +181,46 @@ BM_Reduce_Arg(64, 32, 2);
 BM_Reduce_Arg(4096, 32, 2);
 BM_Reduce_Arg(4096, 128, 2);
 
+// Benchmarks SparseSegmentSum over `num_indices` ids grouped in bags of
+// `bag_size` rows of 64 elements, as in an embedding bag lookup.
+static void BM_SparseSegmentSum(::testing::benchmark::State& state) {
+  const int num_indices = state.range(0);
+  const int bag_size = state.range(1);
+  const int kNumRows = 100000;
+  const int kDim = 64;
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_FLOAT, TensorShape({kNumRows, kDim}));
+  input.flat<float>().setRandom();
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  auto indices_flat = indices.flat<int32>();
+  Tensor segments(DT_INT32, TensorShape({num_indices}));
+  auto segments_flat = segments.flat<int32>();
+  for (int i = 0; i < num_indices; ++i) {
+    indices_flat(i) = (i * 7919) % kNumRows;
+    segments_flat(i) = i / bag_size;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_indices * kDim * sizeof(float));
+}
+
+BENCHMARK(BM_SparseSegmentSum)
+    ->UseRealTime()
+    ->ArgPair(1000, 1)
+    ->ArgPair(1000, 20)
+    ->ArgPair(100000, 1)
+    ->ArgPair(100000, 20);
+
 template <DataType T>
 static void SparseSegmentMeanGradHelper(::testing::benchmark::State& state,
                                         float uniqueness, int size) {
@@ -19,11 +19,14 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -321,6 +324,93 @@ Status SparseTensorDenseMatMulImpl(
   }
   return OkStatus();
 }
+
+// Minimum nnz * rhs_right for which the row-parallel implementation is used.
+// Below it, sorting the nonzeros by row costs more than threading saves.
+static constexpr int64_t kRowParallelMinWork = 1 << 16;
+
+// Computes the same result as SparseTensorDenseMatMulImpl, in parallel over
+// the rows of the output. The nonzeros are first bucketed by output row
+// (i.e. converted to CSR) with a stable counting sort, so each shard owns a
+// disjoint set of output rows and no synchronization is needed. Since the
+// nonzeros of a row keep their relative order, every output element is
+// accumulated in the same order as in the sequential implementation.
+template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
+Status SparseTensorDenseMatMulRowParallelImpl(
+    OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const int64_t nnz = a_values.size();
+  const int64_t out_rows = out.dimension(0);
+  const int64_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+  const int64_t lhs_right = (ADJ_B ? b.dimension(1) : b.dimension(0));
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+
+  // The validated indices are kept so that they are read only once.
+  std::vector<Tindices> rows(nnz);
+  std::vector<Tindices> cols(nnz);
+  std::vector<int64_t> row_starts(out_rows + 1, 0);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, out_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, out_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+    ++row_starts[m + 1];
+  }
+  for (int64_t m = 0; m < out_rows; ++m) {
+    row_starts[m + 1] += row_starts[m];
+  }
+  std::vector<int64_t> row_nonzeros(nnz);
+  {
+    std::vector<int64_t> next(row_starts.begin(), row_starts.end() - 1);
+    for (int64_t i = 0; i < nnz; ++i) {
+      row_nonzeros[next[rows[i]]++] = i;
+    }
+  }
+
+  // Rows of the (conjugate transposed, if ADJ_B) right-hand side must be
+  // contiguous for the inner loop, so transpose B once up front.
+  Tensor b_adjoint_t;
+  const T* b_data = b.data();
+  if (ADJ_B) {
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                          TensorShape({lhs_right, rhs_right}),
+                                          &b_adjoint_t));
+    Eigen::array<int, 2> shuffle{1, 0};
+    b_adjoint_t.matrix<T>() = b.shuffle(shuffle).conjugate();
+    b_data = b_adjoint_t.flat<T>().data();
+  }
+
+  auto compute_rows = [&](int64_t begin, int64_t end) {
+    for (int64_t m = begin; m < end; ++m) {
+      Tsum* out_row = &out(m, 0);
+      for (int64_t j = row_starts[m]; j < row_starts[m + 1]; ++j) {
+        const int64_t i = row_nonzeros[j];
+        const Tindices k = cols[i];
+        const Tsum a_value =
+            static_cast<Tsum>(ADJ_A ? MaybeConj(a_values(i)) : a_values(i));
+        const T* b_row = b_data + k * rhs_right;
+        for (int64_t n = 0; n < rhs_right; ++n) {
+          out_row[n] += static_cast<Tsum>(b_row[n]) * a_value;
+        }
+      }
+    }
+  };
+  const int64_t cost_per_row =
+      (nnz / out_rows + 1) * rhs_right * (Eigen::TensorOpCost::AddCost<T>() +
+                                          Eigen::TensorOpCost::MulCost<T>());
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, out_rows,
+        cost_per_row, compute_rows);
+  return OkStatus();
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -338,8 +428,7 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto temp_out = temp_out_t.matrix<Tsum>();
       temp_out.setZero();
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              temp_out, a_indices, a_values, b));
+          (Impl<Tsum>(ctx, temp_out, a_indices, a_values, b)));
       out = temp_out.template cast<T>();
     } else {
       out.setZero();
@@ -348,11 +437,29 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
       auto out_workaround =
           *reinterpret_cast<typename TTypes<Tsum>::Matrix*>(&out);
       TF_RETURN_IF_ERROR(
-          SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
-              out_workaround, a_indices, a_values, b));
+          (Impl<Tsum>(ctx, out_workaround, a_indices, a_values, b)));
     }
     return OkStatus();
   }
+
+ private:
+  // Uses the row-parallel implementation when there are several threads and
+  // enough work to share between them.
+  template <typename Tsum>
+  static Status Impl(OpKernelContext* ctx, typename TTypes<Tsum>::Matrix out,
+                     typename TTypes<Tindices>::ConstMatrix a_indices,
+                     typename TTypes<T>::ConstVec a_values,
+                     typename TTypes<T>::ConstMatrix b) {
+    const int64_t rhs_right = (ADJ_B ? b.dimension(0) : b.dimension(1));
+    if (ctx->device()->tensorflow_cpu_worker_threads()->num_threads > 1 &&
+        a_values.size() * rhs_right >= kRowParallelMinWork) {
+      return SparseTensorDenseMatMulRowParallelImpl<T, Tsum, Tindices, ADJ_A,
+                                                    ADJ_B>(
+          ctx, out, a_indices, a_values, b);
+    }
+    return SparseTensorDenseMatMulImpl<T, Tsum, Tindices, ADJ_A, ADJ_B>(
+        out, a_indices, a_values, b);
+  }
 };
 
 }  // namespace functor
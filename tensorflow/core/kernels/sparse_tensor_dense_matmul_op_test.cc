@@ -120,4 +120,10 @@ BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, false, true);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, true);
 
+// Graph-style adjacency matrices with many nonzeros and narrow features.
+BM_SparseTensorDenseMatmul(262144, 16384, 16384, 32, false, false);
+BM_SparseTensorDenseMatmul(262144, 16384, 16384, 128, false, false);
+BM_SparseTensorDenseMatmul(262144, 16384, 16384, 128, true, false);
+BM_SparseTensorDenseMatmul(262144, 16384, 16384, 128, false, true);
+
 }  // end namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <algorithm>
+#include <cstring>
 #include <locale>
 #include <string>
 
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -209,17 +211,25 @@ class StringNGramsOp : public tensorflow::OpKernel {
       int num_separators = left_padding + right_padding + num_tokens - 1;
       ngram_size += num_separators * separator_.length();
 
-      // Build the ngram.
+      // Build the ngram. Its storage is sized once, so that it needs at most
+      // one allocation, and only if it doesn't fit inline in the tstring.
       tstring* ngram = &output[ngram_index];
-      ngram->reserve(ngram_size);
+      ngram->resize_uninitialized(ngram_size);
+      char* dst = ngram->mdata();
+      auto append = [&dst](StringPiece piece) {
+        if (!piece.empty()) {
+          memcpy(dst, piece.data(), piece.size());
+          dst += piece.size();
+        }
+      };
       for (int n = 0; n < left_padding; ++n) {
-        ngram->append(left_pad_);
-        ngram->append(separator_);
+        append(left_pad_);
+        append(separator_);
       }
       // Only output first num_tokens - 1 pairs of data and separator
       for (int n = 0; n < num_tokens - 1; ++n) {
-        ngram->append(data[data_start_index + n]);
-        ngram->append(separator_);
+        append(data[data_start_index + n]);
+        append(separator_);
       }
       // Handle case when there are no tokens or no right padding as these can
       // result in consecutive separators.
@@ -227,10 +237,10 @@ class StringNGramsOp : public tensorflow::OpKernel {
         // If we have tokens, then output last and then pair each separator with
         // the right padding that follows, to ensure ngram ends either with the
         // token or with the right pad.
-        ngram->append(data[data_start_index + num_tokens - 1]);
+        append(data[data_start_index + num_tokens - 1]);
         for (int n = 0; n < right_padding; ++n) {
-          ngram->append(separator_);
-          ngram->append(right_pad_);
+          append(separator_);
+          append(right_pad_);
         }
       } else {
         // If we don't have tokens, then the last item inserted into the ngram
@@ -238,15 +248,15 @@ class StringNGramsOp : public tensorflow::OpKernel {
         // output right pad and separator and make sure to finish with a
         // padding, not a separator.
         for (int n = 0; n < right_padding - 1; ++n) {
-          ngram->append(right_pad_);
-          ngram->append(separator_);
+          append(right_pad_);
+          append(separator_);
         }
-        ngram->append(right_pad_);
+        append(right_pad_);
       }
 
-      // In debug mode only: validate that we've reserved enough space for the
-      // ngram.
-      DCHECK_EQ(ngram_size, ngram->size());
+      // In debug mode only: validate that we've computed the exact size of
+      // the ngram.
+      DCHECK_EQ(ngram_size, dst - ngram->data());
     }
   }
 
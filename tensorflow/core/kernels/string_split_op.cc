@@ -99,8 +99,10 @@ std::vector<StringPiece> Split(const tstring& str, const tstring& delimiter,
   return SplitOnCharSet(str, delimiter, predicate);
 }
 
-std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
-                                 int maxsplit) {
+// Appends the tokens of `str` split on `sep` to `result`. The StringPieces are
+// valid as long as input `str` is valid.
+void SplitV2(const tstring& str, StringPiece sep, int maxsplit,
+             std::vector<StringPiece>* result) {
   // This SplitV2 method matches the behavior of python's str.split:
   //   If sep is given, consecutive delimiters are not grouped together
   //   and are deemed to delimit empty strings (for example, '1,,2'.split(',')
@@ -115,12 +117,10 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
   //   splitting an empty string or a string consisting of just whitespace
   //   with a None separator returns [].
 
-  std::vector<StringPiece> result;
-
   StringPiece text(str);
   if (maxsplit == 0) {
-    result.emplace_back(text);
-    return result;
+    result->emplace_back(text);
+    return;
   }
 
   if (sep.empty()) {
@@ -129,32 +129,31 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     str_util::RemoveLeadingWhitespace(&text);
     int split = 0;
     while (str_util::ConsumeNonWhitespace(&text, &token)) {
-      result.push_back(token);
+      result->push_back(token);
       str_util::RemoveLeadingWhitespace(&text);
       ++split;
       if (maxsplit > 0 && split == maxsplit) {
-        result.push_back(text);
-        return result;
+        result->push_back(text);
+        return;
       }
     }
-    return result;
+    return;
   }
   auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   int split = 0;
   while (p != text.end()) {
     StringPiece token = text.substr(0, p - text.begin());
-    result.push_back(token);
+    result->push_back(token);
     text.remove_prefix(token.size());
     text.remove_prefix(sep.size());
     ++split;
     if (maxsplit > 0 && split == maxsplit) {
-      result.push_back(StringPiece(text));
-      return result;
+      result->push_back(StringPiece(text));
+      return;
     }
     p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
   }
-  result.push_back(text);
-  return result;
+  result->push_back(text);
 }
 
 }  // namespace
@@ -272,12 +271,13 @@ class StringSplitV2Op : public OpKernel {
     int64_t max_num_entries = 0;
     std::vector<int64_t> num_indices(batch_size);
     for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
+      // The tokens of all the rows are appended to the same vector, rather
+      // than to one vector per row.
+      SplitV2(input_vec(i), sep, maxsplit_, &tokens);
+      int64_t n_entries = tokens.size() - output_size;
       num_indices[i] = n_entries;
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_TO_HASH_BUCKET_FAST_OP_H_
 
+#include <algorithm>
 #include <string>
 
 #include "tensorflow/core/framework/op_kernel.h"
@@ -23,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -44,18 +47,73 @@ class StringToHashBucketOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64_t>();
 
-    typedef decltype(input_flat.size()) Index;
-    for (Index i = 0; i < input_flat.size(); ++i) {
-      const uint64 input_hash = hash(input_flat(i));
-      const uint64 bucket_id = input_hash % num_buckets_;
+    const tstring* input_data = input_flat.data();
+    int64_t* output_data = output_flat.data();
+    const int64_t num_elements = input_flat.size();
+    auto hash_range = [this, input_data, output_data](int64_t start,
+                                                      int64_t limit) {
+      // The number of buckets is a power of two for most feature columns, in
+      // which case the bucket is the low bits of the hash, without a division.
+      const uint64 num_buckets = static_cast<uint64>(num_buckets_);
+      if ((num_buckets & (num_buckets - 1)) == 0) {
+        const uint64 mask = num_buckets - 1;
+        HashToBuckets(input_data, start, limit, output_data,
+                      [mask](uint64 h) { return h & mask; });
+      } else {
+        HashToBuckets(input_data, start, limit, output_data,
+                      [num_buckets](uint64 h) { return h % num_buckets; });
+      }
+    };
+    if (num_elements < kParallelMinElements) {
+      hash_range(0, num_elements);
+    } else {
+      const DeviceBase::CpuWorkerThreads& worker_threads =
+          *(context->device()->tensorflow_cpu_worker_threads());
+      Shard(worker_threads.num_threads, worker_threads.workers, num_elements,
+            kCostPerElement, hash_range);
+    }
+  }
+
+ private:
+  // Inputs with at least this many strings are hashed in parallel.
+  static constexpr int64_t kParallelMinElements = 8192;
+  // Approximate cost of hashing a short string, in cycles.
+  static constexpr int64_t kCostPerElement = 100;
+  // Number of strings that are hashed before their buckets are computed.
+  static constexpr int64_t kBatchSize = 16;
+
+  // Sets `output[i]` to `bucket(hash(input[i]))` for `i` in `[start, limit)`.
+  //
+  // The strings are hashed by batch, into a buffer from which the buckets are
+  // then computed in a separate loop. Short strings are stored inline in the
+  // tensor, but the data of longer ones is elsewhere, so the data of the next
+  // batch is prefetched while the current one is hashed.
+  template <typename BucketFn>
+  static void HashToBuckets(const tstring* input, int64_t start, int64_t limit,
+                            int64_t* output, const BucketFn& bucket) {
+    uint64 hashes[kBatchSize];
+    for (int64_t batch_start = start; batch_start < limit;
+         batch_start += kBatchSize) {
+      const int64_t batch_size = std::min(kBatchSize, limit - batch_start);
+      const int64_t next_limit =
+          std::min(limit, batch_start + batch_size + kBatchSize);
+      for (int64_t i = batch_start + batch_size; i < next_limit; ++i) {
+        if (input[i].type() != tstring::SMALL) {
+          port::prefetch<port::PREFETCH_HINT_T0>(input[i].data());
+        }
+      }
+      for (int64_t j = 0; j < batch_size; ++j) {
+        hashes[j] = hash(input[batch_start + j]);
+      }
       // The number of buckets is always in the positive range of int64 so is
       // the resulting bucket_id. Casting the bucket_id from uint64 to int64 is
       // safe.
-      output_flat(i) = static_cast<int64_t>(bucket_id);
+      for (int64_t j = 0; j < batch_size; ++j) {
+        output[batch_start + j] = static_cast<int64_t>(bucket(hashes[j]));
+      }
     }
   }
 
- private:
   int64_t num_buckets_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketOp);
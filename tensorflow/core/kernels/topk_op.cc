@@ -127,6 +127,113 @@ class TopK : public OpKernel {
   bool sorted_;
 };
 
+namespace {
+
+// Rows with at least this many columns select the top k with a threshold
+// filter when k is small relative to the number of columns.
+constexpr int64_t kTopKFilterMinCols = 1024;
+// The filter skips blocks of this many values that are all below the
+// threshold.
+constexpr int64_t kTopKFilterBlockSize = 64;
+// When there are fewer rows than threads, rows are split in segments of at
+// least this many columns, which are filtered in parallel.
+constexpr int64_t kTopKMinColsPerSegment = 1 << 15;
+
+// Returns whether the top k of each row are selected with `SelectTopK` rather
+// than with a heap or by partitioning all the columns.
+inline bool UseTopKFilter(int k, int64_t num_cols) {
+  return num_cols >= kTopKFilterMinCols &&
+         8 * static_cast<int64_t>(k) <= num_cols;
+}
+
+// Orders indices in `data` by decreasing value, and by increasing index among
+// equal values.
+template <typename T, typename Tidx>
+struct TopKLess {
+  const T* data;
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (data[b] < data[a]) return true;
+    if (data[a] < data[b]) return false;
+    return a < b;
+  }
+};
+
+// Sets `top` to the indices of the (at most) `k` first values of
+// `data[begin:end)` in `TopKLess` order, in no particular order.
+//
+// Candidates are collected in a buffer of up to about `2 * k` indices, which is
+// pruned to its top `k` with `std::nth_element` when full. The smallest of
+// those is then a threshold that later values must exceed, and the blocks of
+// values that don't are skipped with a vectorized maximum.
+template <typename T, typename Tidx>
+void SelectTopK(const T* data, int64_t begin, int64_t end, int k,
+                std::vector<Tidx>* top) {
+  const TopKLess<T, Tidx> less{data};
+  const int64_t capacity = 2 * static_cast<int64_t>(k);
+  top->clear();
+  top->reserve(capacity + kTopKFilterBlockSize);
+  auto prune = [&]() {
+    std::nth_element(top->begin(), top->begin() + (k - 1), top->end(), less);
+    top->resize(k);
+  };
+
+  int64_t c = begin;
+  // Until the buffer is first full, every value is a candidate.
+  for (; c < end && static_cast<int64_t>(top->size()) < capacity; ++c) {
+    top->push_back(c);
+  }
+  if (c == end) {
+    if (static_cast<int64_t>(top->size()) > k) prune();
+    return;
+  }
+  prune();
+  // Values equal to the threshold come after all of the current candidates,
+  // which have lower indices, so only greater values are candidates.
+  T threshold = data[(*top)[k - 1]];
+  while (c < end) {
+    const int64_t block_end = std::min(end, c + kTopKFilterBlockSize);
+    const T block_max =
+        Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>(data + c,
+                                                             block_end - c)
+            .maxCoeff();
+    if (threshold < block_max) {
+      for (; c < block_end; ++c) {
+        if (threshold < data[c]) top->push_back(c);
+      }
+      if (static_cast<int64_t>(top->size()) >= capacity) {
+        prune();
+        threshold = data[(*top)[k - 1]];
+      }
+    }
+    c = block_end;
+  }
+  if (static_cast<int64_t>(top->size()) > k) prune();
+}
+
+// Writes the top `k` indices of row `b`, given a superset of them in `top`,
+// and their values. The indices are in `TopKLess` order if `sorted`, and in
+// increasing order otherwise.
+template <typename T, typename Tidx>
+void WriteTopK(const T* data, int k, bool sorted, std::vector<Tidx>* top,
+               T* values, Tidx* indices) {
+  const TopKLess<T, Tidx> less{data};
+  if (static_cast<int64_t>(top->size()) > k) {
+    std::nth_element(top->begin(), top->begin() + (k - 1), top->end(), less);
+    top->resize(k);
+  }
+  if (sorted) {
+    std::sort(top->begin(), top->end(), less);
+  } else {
+    std::sort(top->begin(), top->end());
+  }
+  for (int i = 0; i < k; ++i) {
+    indices[i] = (*top)[i];
+    values[i] = data[(*top)[i]];
+  }
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename T, typename Tidx>
@@ -161,7 +268,51 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const bool use_filter = UseTopKFilter(k, num_cols);
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+
+    // With fewer rows than threads, segments of each row are filtered in
+    // parallel, and their candidates are then merged.
+    const int64_t segments_per_row =
+        use_filter ? std::min<int64_t>((worker_threads.num_threads +
+                                        num_rows - 1) /
+                                           num_rows,
+                                       num_cols / kTopKMinColsPerSegment)
+                   : 1;
+    if (segments_per_row > 1) {
+      std::vector<std::vector<Tidx>> candidates(num_rows * segments_per_row);
+      auto filter_segments = [&](int64_t start, int64_t limit) {
+        for (int64_t i = start; i < limit; ++i) {
+          const int64_t b = i / segments_per_row;
+          const int64_t segment = i % segments_per_row;
+          SelectTopK<T, Tidx>(&input(b, 0),
+                              segment * num_cols / segments_per_row,
+                              (segment + 1) * num_cols / segments_per_row, k,
+                              &candidates[i]);
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_rows * segments_per_row,
+            static_cast<int64_t>(cmp_cost * num_cols / segments_per_row),
+            filter_segments);
+      for (int64_t b = 0; b < num_rows; ++b) {
+        std::vector<Tidx> top;
+        top.reserve(segments_per_row * k);
+        for (int64_t segment = 0; segment < segments_per_row; ++segment) {
+          const std::vector<Tidx>& segment_top =
+              candidates[b * segments_per_row + segment];
+          top.insert(top.end(), segment_top.begin(), segment_top.end());
+        }
+        WriteTopK<T, Tidx>(&input(b, 0), k, sorted, &top, &values(b, 0),
+                           &indices(b, 0));
+      }
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      std::vector<Tidx> top;
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32_t a,
@@ -204,6 +355,19 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             }
             run_begin = run_end;
           }
+        } else if (use_filter) {
+          SelectTopK<T, Tidx>(input_data, 0, num_cols, k, &top);
+          WriteTopK<T, Tidx>(input_data, k, sorted, &top, &values(b, 0),
+                             &indices(b, 0));
+          continue;
+        } else if (8 * static_cast<int64_t>(k) > num_cols) {
+          // For large k, partitioning all of the columns around the k-th is
+          // cheaper than maintaining a heap of the top k.
+          top.resize(num_cols);
+          std::iota(top.begin(), top.end(), 0);
+          WriteTopK<T, Tidx>(input_data, k, sorted, &top, &values(b, 0),
+                             &indices(b, 0));
+          continue;
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
@@ -235,8 +399,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
 
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
     // If K == N, assume the cost is N*log(K + 1).
-    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
-                            Eigen::TensorOpCost::AddCost<T>();
     const double base_cost =
         cmp_cost *
         static_cast<double>(num_cols *
@@ -247,7 +409,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
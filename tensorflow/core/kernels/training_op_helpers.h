@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
+#include <algorithm>
 #include <optional>
+#include <type_traits>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -167,26 +170,23 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
   }
   std::vector<Var*> vars;
   std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
+  mutexes.reserve(input_ids.size());
   for (auto input : input_ids) {
     Var* var;
     mutex* mutex = GetTrainingVariableMutex<Device, T>(ctx, input, &var);
     if (var) vars.push_back(var);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
-      mutexes.push_back(mutex);
-    }
+    mutexes.push_back(mutex);
   }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
+  // Only lock each mutex once if duplicates exist. Fused ops pass the
+  // variables of many updates, so this sorts rather than searching for each.
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end()), mutexes.end());
 
   auto locks = std::make_unique<std::vector<mutex_lock>>();
   auto shared_locks = std::make_unique<std::vector<tf_shared_lock>>();
-  locks->reserve(acquire_order.size());
+  locks->reserve(mutexes.size());
 
-  for (auto acquire : acquire_order) {
-    mutex* mu = mutexes[acquire];
+  for (mutex* mu : mutexes) {
     if (mu != nullptr) {
       if (!sparse || do_lock) {
         locks->emplace_back(*mu);
@@ -273,6 +273,8 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
     }
     TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, T>(
         ctx, var->tensor(), var->copy_on_read_mode.load()));
+    // The variable is about to be updated densely.
+    var->MarkAllRowsDirty();
     *out = *var->tensor();
     return OkStatus();
   }
@@ -280,6 +282,29 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
   return OkStatus();
 }
 
+// Records that the rows `indices` of the resource variables at inputs
+// `input_ids` were written by a sparse update, for the variables that track
+// dirty rows (see `Var::TakeDirtyRows()`). Indices are only read on CPU:
+// on other devices all the rows are marked as dirty instead.
+template <typename Device>
+void MarkVariableRowsDirty(OpKernelContext* ctx,
+                           const std::vector<int>& input_ids,
+                           const Tensor& indices) {
+  for (int input : input_ids) {
+    if (ctx->input_dtype(input) != DT_RESOURCE) continue;
+    core::RefCountPtr<Var> var;
+    if (!LookupResource(ctx, HandleFromInput(ctx, input), &var).ok() ||
+        !var->tracks_dirty_rows()) {
+      continue;
+    }
+    if (std::is_same<Device, Eigen::ThreadPoolDevice>::value) {
+      var->MarkRowsDirty(indices);
+    } else {
+      var->MarkAllRowsDirty();
+    }
+  }
+}
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
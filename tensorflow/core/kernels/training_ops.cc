@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -1285,6 +1287,7 @@ class SparseApplyAdadeltaOp : public OpKernel {
           epsilon.scalar<T>(), grad.flat_outer_dims<T>(), indices_vec);
     }
 
+    MarkVariableRowsDirty<Device>(ctx, {0, 1, 2}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -1544,6 +1547,7 @@ class SparseApplyProximalGradientDescentOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsDirty<CPUDevice>(ctx, {0}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -1947,6 +1951,7 @@ class SparseApplyAdagradOp : public OpKernel {
                  lr.scalar<T>(), lr.scalar<T>(), grad.flat_outer_dims<T>(),
                  indices.vec<Tindex>(), inner_dim, update_slots_));
 
+    MarkVariableRowsDirty<Device>(ctx, {0, 1}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2080,6 +2085,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
                  lr.scalar<T>(), epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
                  indices.vec<Tindex>(), inner_dim, update_slots_));
 
+    MarkVariableRowsDirty<Device>(ctx, {0, 1}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2228,6 +2234,7 @@ class SparseApplyProximalAdagradOp : public OpKernel {
                  lr.scalar<T>(), l1.scalar<T>(), l2.scalar<T>(),
                  grad.flat_outer_dims<T>(), indices.vec<Tindex>(), inner_dim));
 
+    MarkVariableRowsDirty<Device>(ctx, {0, 1}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2557,6 +2564,7 @@ class SparseApplyAdagradDAOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsDirty<CPUDevice>(ctx, {0, 1, 2}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2930,6 +2938,7 @@ class SparseApplyFtrlOp : public OpKernel {
                  lr_power.scalar<T>(), grad.flat_outer_dims<T>(), indices_vec,
                  inner_dim, multiply_linear_by_lr_));
 
+    MarkVariableRowsDirty<Device>(ctx, {0, 1, 2}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -3250,6 +3259,7 @@ class SparseApplyMomentumOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsDirty<CPUDevice>(ctx, {0, 1}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -3453,6 +3463,7 @@ class SparseApplyKerasMomentumOp : public OpKernel {
             "indices", SliceDebugString(indices.shape(), bad_i), " = ",
             indices_flat(bad_i), " is not in [0, ", var.dim_size(0), ")"));
 
+    MarkVariableRowsDirty<Device>(ctx, {0, 1}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -4291,6 +4302,7 @@ class SparseApplyRMSPropOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsDirty<CPUDevice>(ctx, {0, 1, 2}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -4433,6 +4445,7 @@ class SparseApplyCenteredRMSPropOp : public OpKernel {
       }
     }
 
+    MarkVariableRowsDirty<CPUDevice>(ctx, {0, 1, 2, 3}, indices);
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -4689,4 +4702,219 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+// Returns the ids of the `num_slots * num_vars` resource inputs of a fused
+// apply op, which start at input 0.
+static std::vector<int> FusedApplyVariableInputs(int num_slots, int num_vars) {
+  std::vector<int> input_ids(num_slots * num_vars);
+  std::iota(input_ids.begin(), input_ids.end(), 0);
+  return input_ids;
+}
+
+// Reads the variables of a fused apply op into `*vars`, where variable `i` of
+// slot `slot` is `(*vars)[slot * num_vars + i]`, and checks that they have the
+// shapes of the `num_vars` gradients starting at input `grad_start`.
+template <typename Device, typename T>
+static Status GetFusedApplyVariables(OpKernelContext* ctx, bool use_lock,
+                                     int num_slots, int num_vars,
+                                     int grad_start,
+                                     std::vector<Tensor>* vars) {
+  vars->resize(num_slots * num_vars);
+  for (int i = 0; i < num_slots * num_vars; ++i) {
+    Tensor& var = (*vars)[i];
+    TF_RETURN_IF_ERROR(GetInputTensorFromVariable<Device, T>(
+        ctx, i, use_lock, /*sparse=*/false, &var));
+    if (!var.IsInitialized()) {
+      return errors::FailedPrecondition(
+          "Attempting to use uninitialized variables: ",
+          ctx->op_kernel().requested_input(i));
+    }
+    const Tensor& grad = ctx->input(grad_start + i % num_vars);
+    if (!var.shape().IsSameSize(grad.shape())) {
+      return errors::InvalidArgument(
+          ctx->op_kernel().requested_input(i),
+          " and its grad do not have the same shape",
+          var.shape().DebugString(), " ", grad.shape().DebugString());
+    }
+  }
+  return OkStatus();
+}
+
+// Checks that the inputs of a fused apply op named `names` starting at input
+// `start` are scalars.
+static Status CheckFusedApplyScalars(OpKernelContext* ctx, int start,
+                                     std::initializer_list<const char*> names) {
+  int i = start;
+  for (const char* name : names) {
+    const Tensor& scalar = ctx->input(i++);
+    if (!TensorShapeUtils::IsScalar(scalar.shape())) {
+      return errors::InvalidArgument(name, " is not a scalar: ",
+                                     scalar.shape().DebugString());
+    }
+  }
+  return OkStatus();
+}
+
+// The fused apply ops update `N` variables in a single op, rather than
+// scheduling one op, with its locking and dispatch overhead, per variable.
+template <typename Device, typename T>
+class FusedApplyAdamOp : public OpKernel {
+ public:
+  explicit FusedApplyAdamOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int scalars_start = 3 * num_vars_;
+    const int grad_start = scalars_start + 6;
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        FusedApplyVariableInputs(3, num_vars_));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetFusedApplyVariables<Device, T>(
+                            ctx, use_exclusive_lock_, 3, num_vars_,
+                            grad_start, &vars));
+    OP_REQUIRES_OK(ctx, CheckFusedApplyScalars(
+                            ctx, scalars_start,
+                            {"beta1_power", "beta2_power", "lr", "beta1",
+                             "beta2", "epsilon"}));
+    const Tensor& beta1_power = ctx->input(scalars_start);
+    const Tensor& beta2_power = ctx->input(scalars_start + 1);
+    const Tensor& lr = ctx->input(scalars_start + 2);
+    const Tensor& beta1 = ctx->input(scalars_start + 3);
+    const Tensor& beta2 = ctx->input(scalars_start + 4);
+    const Tensor& epsilon = ctx->input(scalars_start + 5);
+
+    const Device& device = ctx->template eigen_device<Device>();
+    for (int i = 0; i < num_vars_; ++i) {
+      functor::ApplyAdam<Device, T>()(
+          device, vars[i].flat<T>(), vars[num_vars_ + i].flat<T>(),
+          vars[2 * num_vars_ + i].flat<T>(), beta1_power.scalar<T>(),
+          beta2_power.scalar<T>(), lr.scalar<T>(), beta1.scalar<T>(),
+          beta2.scalar<T>(), epsilon.scalar<T>(),
+          ctx->input(grad_start + i).flat<T>(), use_nesterov_);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+template <typename Device, typename T>
+class FusedApplyMomentumOp : public OpKernel {
+ public:
+  explicit FusedApplyMomentumOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int scalars_start = 2 * num_vars_;
+    const int grad_start = scalars_start + 2;
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        FusedApplyVariableInputs(2, num_vars_));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetFusedApplyVariables<Device, T>(
+                            ctx, use_exclusive_lock_, 2, num_vars_,
+                            grad_start, &vars));
+    OP_REQUIRES_OK(ctx, CheckFusedApplyScalars(ctx, scalars_start,
+                                               {"lr", "momentum"}));
+    const Tensor& lr = ctx->input(scalars_start);
+    const Tensor& momentum = ctx->input(scalars_start + 1);
+
+    const Device& device = ctx->template eigen_device<Device>();
+    for (int i = 0; i < num_vars_; ++i) {
+      functor::ApplyMomentum<Device, T>()(
+          device, vars[i].flat<T>(), vars[num_vars_ + i].flat<T>(),
+          lr.scalar<T>(), ctx->input(grad_start + i).flat<T>(),
+          momentum.scalar<T>(), use_nesterov_);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+template <typename Device, typename T>
+class FusedApplyAdagradV2Op : public OpKernel {
+ public:
+  explicit FusedApplyAdagradV2Op(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int scalars_start = 2 * num_vars_;
+    const int grad_start = scalars_start + 2;
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false,
+        FusedApplyVariableInputs(2, num_vars_));
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(ctx, GetFusedApplyVariables<Device, T>(
+                            ctx, use_exclusive_lock_, 2, num_vars_,
+                            grad_start, &vars));
+    OP_REQUIRES_OK(ctx, CheckFusedApplyScalars(ctx, scalars_start,
+                                               {"lr", "epsilon"}));
+    const Tensor& lr = ctx->input(scalars_start);
+    const Tensor& epsilon = ctx->input(scalars_start + 1);
+
+    const Device& device = ctx->template eigen_device<Device>();
+    for (int i = 0; i < num_vars_; ++i) {
+      functor::ApplyAdagradV2<Device, T>()(
+          device, vars[i].flat<T>(), vars[num_vars_ + i].flat<T>(),
+          lr.scalar<T>(), epsilon.scalar<T>(),
+          ctx->input(grad_start + i).flat<T>(), update_slots_);
+    }
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool update_slots_;
+};
+
+#define REGISTER_KERNELS(D, T)                                       \
+  REGISTER_KERNEL_BUILDER(Name("_FusedResourceApplyAdam")            \
+                              .Device(DEVICE_##D)                    \
+                              .HostMemory("var")                     \
+                              .HostMemory("m")                       \
+                              .HostMemory("v")                       \
+                              .TypeConstraint<T>("T"),               \
+                          FusedApplyAdamOp<D##Device, T>);           \
+  REGISTER_KERNEL_BUILDER(Name("_FusedResourceApplyMomentum")        \
+                              .Device(DEVICE_##D)                    \
+                              .HostMemory("var")                     \
+                              .HostMemory("accum")                   \
+                              .TypeConstraint<T>("T"),               \
+                          FusedApplyMomentumOp<D##Device, T>);       \
+  REGISTER_KERNEL_BUILDER(Name("_FusedResourceApplyAdagradV2")       \
+                              .Device(DEVICE_##D)                    \
+                              .HostMemory("var")                     \
+                              .HostMemory("accum")                   \
+                              .TypeConstraint<T>("T"),               \
+                          FusedApplyAdagradV2Op<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+TF_CALL_COMPLEX_TYPES(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+// The GPU functor specializations are declared with the unfused kernels above.
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+REGISTER_KERNELS(GPU, complex64);
+REGISTER_KERNELS(GPU, complex128);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 }  // namespace tensorflow
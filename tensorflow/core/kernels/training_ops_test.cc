@@ -13,9 +13,18 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session_options.h"
@@ -420,4 +429,139 @@ static void BM_PowerSign(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_PowerSign)->Arg(128 << 10)->Arg(256 << 10);
 
+class FusedApplyOpTest : public OpsTestBase {
+ protected:
+  // `Var` also names the graph helper above.
+  using ResourceVar = class Var;
+
+  // Adds a resource input holding a float variable, which stays owned by the
+  // resource manager of the test.
+  ResourceVar* AddVariable(const std::string& name, const TensorShape& shape,
+                           const std::vector<float>& values) {
+    ResourceVar* var = new ResourceVar(DT_FLOAT);
+    *var->tensor() = test::AsTensor<float>(values, shape);
+    var->is_initialized = true;
+    AddResourceInput("", name, var);
+    return var;
+  }
+
+  void AddScalar(float value) {
+    AddInputFromArray<float>(TensorShape({}), {value});
+  }
+};
+
+TEST_F(FusedApplyOpTest, Adam) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "_FusedResourceApplyAdam")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  auto* var0 = AddVariable("var0", TensorShape({2}), {1, 2});
+  auto* var1 = AddVariable("var1", TensorShape({1, 1}), {3});
+  AddVariable("m0", TensorShape({2}), {0, 0});
+  AddVariable("m1", TensorShape({1, 1}), {0});
+  AddVariable("v0", TensorShape({2}), {0, 0});
+  AddVariable("v1", TensorShape({1, 1}), {0});
+  AddScalar(0.9);    // beta1_power
+  AddScalar(0.999);  // beta2_power
+  AddScalar(0.1);    // lr
+  AddScalar(0.9);    // beta1
+  AddScalar(0.999);  // beta2
+  AddScalar(1e-8);   // epsilon
+  AddInputFromArray<float>(TensorShape({2}), {1, -1});
+  AddInputFromArray<float>(TensorShape({1, 1}), {1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  // In the first step, Adam moves each variable by `lr` against the sign of
+  // its gradient.
+  test::ExpectTensorNear<float>(
+      *var0->tensor(), test::AsTensor<float>({0.9, 2.1}, TensorShape({2})),
+      1e-5);
+  test::ExpectTensorNear<float>(
+      *var1->tensor(), test::AsTensor<float>({2.9}, TensorShape({1, 1})),
+      1e-5);
+}
+
+TEST_F(FusedApplyOpTest, Momentum) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "_FusedResourceApplyMomentum")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  auto* var0 = AddVariable("var0", TensorShape({2}), {1, 2});
+  auto* var1 = AddVariable("var1", TensorShape({1}), {3});
+  auto* accum0 = AddVariable("accum0", TensorShape({2}), {1, 1});
+  auto* accum1 = AddVariable("accum1", TensorShape({1}), {0});
+  AddScalar(0.5);  // lr
+  AddScalar(0.9);  // momentum
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({1}), {4});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(
+      *accum0->tensor(), test::AsTensor<float>({1.9, 2.9}), 1e-5);
+  test::ExpectTensorNear<float>(*accum1->tensor(), test::AsTensor<float>({4}),
+                                1e-5);
+  test::ExpectTensorNear<float>(
+      *var0->tensor(), test::AsTensor<float>({0.05, 0.55}), 1e-5);
+  test::ExpectTensorNear<float>(*var1->tensor(), test::AsTensor<float>({1}),
+                                1e-5);
+}
+
+TEST_F(FusedApplyOpTest, AdagradV2) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "_FusedResourceApplyAdagradV2")
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(1, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(1, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  auto* var = AddVariable("var", TensorShape({2}), {1, 2});
+  auto* accum = AddVariable("accum", TensorShape({2}), {0, 5});
+  AddScalar(0.5);  // lr
+  AddScalar(0);    // epsilon
+  AddInputFromArray<float>(TensorShape({2}), {2, 2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(*accum->tensor(),
+                                test::AsTensor<float>({4, 9}), 1e-5);
+  test::ExpectTensorNear<float>(
+      *var->tensor(), test::AsTensor<float>({0.5, 2 - 1 / 3.0f}), 1e-5);
+}
+
+TEST_F(FusedApplyOpTest, GradShapeMismatch) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "_FusedResourceApplyMomentum")
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(2, DT_RESOURCE))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  auto* var0 = AddVariable("var0", TensorShape({1}), {1});
+  AddVariable("var1", TensorShape({2}), {1, 2});
+  AddVariable("accum0", TensorShape({1}), {0});
+  AddVariable("accum1", TensorShape({2}), {0, 0});
+  AddScalar(0.5);  // lr
+  AddScalar(0.9);  // momentum
+  AddInputFromArray<float>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_EQ(error::INVALID_ARGUMENT, RunOpKernel().code());
+
+  // No variable is updated if any of them can't be.
+  test::ExpectTensorEqual<float>(*var0->tensor(), test::AsTensor<float>({1}));
+}
+
 }  // end namespace tensorflow
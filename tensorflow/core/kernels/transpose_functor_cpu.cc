@@ -16,6 +16,9 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <complex>
+#include <functional>
+#include <memory>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -26,6 +29,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
+#ifdef TENSORFLOW_USE_XLA_TRANSPOSE_PLAN
+#include "tensorflow/compiler/xla/pjrt/transpose.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#endif  // TENSORFLOW_USE_XLA_TRANSPOSE_PLAN
+
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
 namespace tensorflow {
@@ -68,12 +77,69 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+#ifdef TENSORFLOW_USE_XLA_TRANSPOSE_PLAN
+// Tensors smaller than this are transposed with Eigen, for which the lookup of
+// a plan would be a significant part of the cost.
+constexpr int64_t kMinTransposePlanElements = 4096;
+
+// Transposes `in` into `out` with a cache-blocked `xla::TransposePlan`, which
+// is much faster than an Eigen shuffle for permutations that move the minor
+// dimension of large tensors. Returns false if no plan could be made, in which
+// case `out` is left untouched.
+bool TransposeUsingPlan(const CPUDevice& device, size_t elem_size,
+                        const Tensor& in, const gtl::ArraySlice<int32> perm,
+                        Tensor* out) {
+  static mutex* mu = new mutex();
+  // Plans are keyed by element size, shape, permutation and number of
+  // threads, so for a given model the cache holds a handful of plans.
+  static xla::TransposePlanCache* cache =
+      new xla::TransposePlanCache(/*capacity=*/64);
+
+  const gtl::InlinedVector<int64_t, 4> dims = in.shape().dim_sizes();
+  const gtl::InlinedVector<int64_t, 8> permutation(perm.begin(), perm.end());
+  std::shared_ptr<xla::TransposePlan> plan;
+  {
+    mutex_lock l(*mu);
+    auto plan_or = cache->GetOrCreate(
+        elem_size, dims, permutation,
+        /*input_layout=*/xla::TransposePlan::Tiling{},
+        /*output_tiling=*/xla::TransposePlan::Tiling{},
+        xla::TransposePlan::Transformation::kNone, device.numThreads());
+    if (!plan_or.ok()) {
+      VLOG(1) << "Couldn't make a transpose plan: " << plan_or.status();
+      return false;
+    }
+    plan = *std::move(plan_or);
+  }
+  plan->Execute(in.tensor_data().data(),
+                const_cast<char*>(out->tensor_data().data()),
+                [&device](std::function<void()> fn) {
+                  device.getPool()->Schedule(std::move(fn));
+                });
+  return true;
+}
+#endif  // TENSORFLOW_USE_XLA_TRANSPOSE_PLAN
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+#ifdef TENSORFLOW_USE_XLA_TRANSPOSE_PLAN
+    // The plan moves bytes, so it is only used for types that can be copied
+    // as such, and conjugation is applied as a second, element-wise pass.
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      if (in.NumElements() >= kMinTransposePlanElements &&
+          TransposeUsingPlan(d, sizeof(T), in, perm, out)) {
+        if (conjugate) {
+          auto out_flat = out->flat<T>();
+          out_flat.device(d) = out_flat.conjugate();
+        }
+        return;
+      }
+    }
+#endif  // TENSORFLOW_USE_XLA_TRANSPOSE_PLAN
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,10 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -130,4 +137,52 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+// Transposes a tensor large enough for the cache-blocked transpose plan, and
+// checks the result against an element-wise transpose.
+template <typename T>
+void TestLargeTranspose(bool conjugate) {
+  thread::ThreadPool pool(Env::Default(), "test", /*num_threads=*/4);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), 4);
+
+  Tensor in(DataTypeToEnum<T>::value, TensorShape({3, 37, 129}));
+  auto in_flat = in.flat<T>();
+  for (int64_t i = 0; i < in.NumElements(); ++i) {
+    in_flat(i) = T(i % 251);
+  }
+  Tensor out(DataTypeToEnum<T>::value, TensorShape({129, 3, 37}));
+  const std::vector<int32> perm = {2, 0, 1};
+  if (conjugate) {
+    TF_ASSERT_OK(DoConjugateTranspose(device, in, perm, &out));
+  } else {
+    TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+  }
+
+  Tensor expected(DataTypeToEnum<T>::value, out.shape());
+  auto in_tensor = in.tensor<T, 3>();
+  auto expected_tensor = expected.tensor<T, 3>();
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 37; ++j) {
+      for (int k = 0; k < 129; ++k) {
+        expected_tensor(k, i, j) = conjugate
+                                       ? Eigen::numext::conj(in_tensor(i, j, k))
+                                       : in_tensor(i, j, k);
+      }
+    }
+  }
+  test::ExpectTensorEqual<T>(out, expected);
+}
+
+TEST(TransposeFunctorTest, LargeTranspose) {
+  TestLargeTranspose<uint8>(/*conjugate=*/false);
+  TestLargeTranspose<Eigen::half>(/*conjugate=*/false);
+  TestLargeTranspose<float>(/*conjugate=*/false);
+  TestLargeTranspose<double>(/*conjugate=*/false);
+  TestLargeTranspose<complex128>(/*conjugate=*/false);
+}
+
+TEST(TransposeFunctorTest, LargeConjugateTranspose) {
+  TestLargeTranspose<complex64>(/*conjugate=*/true);
+  TestLargeTranspose<complex128>(/*conjugate=*/true);
+}
+
 }  // namespace tensorflow
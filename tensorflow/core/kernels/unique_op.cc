@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +73,177 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Integer inputs with at least this many elements are uniquified in parallel.
+constexpr int64_t kParallelUniqueMinElements = 1 << 17;
+
+// Returns the partition of `value` out of `1 << partition_bits` when
+// uniquifying in parallel. A multiplicative hash is cheap enough for the
+// compiler to vectorize the loop that computes it over the whole input.
+template <typename T>
+inline uint8 UniquePartition(T value, int partition_bits) {
+  return static_cast<uint8>((static_cast<uint64>(value) *
+                             uint64{0x9E3779B97F4A7C15}) >>
+                            (64 - partition_bits));
+}
+
+// Uniquifies the elements of `input` in parallel with the same result as the
+// serial implementation, in which the unique elements are ordered by their
+// first occurrence. Allocates the output `y` with `input_shape`, with `axis`
+// set to the number of unique elements, and the output `count` if
+// `compute_counts`.
+//
+// The elements are partitioned by hash, and their positions are sorted by
+// partition, so that each partition can be uniquified independently with its
+// own map by visiting its elements in input order. A prefix sum over the first
+// occurrences of the unique elements then gives their indices in the output.
+template <typename T, typename TIndex>
+void ParallelUnique(OpKernelContext* context,
+                    typename TTypes<T>::ConstFlat input,
+                    const TensorShape& input_shape, int64_t axis,
+                    bool compute_counts, typename TTypes<TIndex>::Vec idx) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *(context->device()->tensorflow_cpu_worker_threads());
+  const int64_t n = input.size();
+
+  // Uses 4 partitions per thread, up to 256, so that a partition with more
+  // elements than the others doesn't hold up the whole op.
+  int partition_bits = 1;
+  while (partition_bits < 8 &&
+         (1 << partition_bits) < 4 * worker_threads.num_threads) {
+    ++partition_bits;
+  }
+  const int num_partitions = 1 << partition_bits;
+  // The input is split in as many blocks as there are partitions.
+  const int64_t block_size = (n + num_partitions - 1) / num_partitions;
+  const int64_t num_blocks = (n + block_size - 1) / block_size;
+  auto for_each_block = [&](int64_t cost_per_element,
+                            const std::function<void(int64_t, int64_t,
+                                                     int64_t)>& fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          block_size * cost_per_element,
+          [&](int64_t first_block, int64_t last_block) {
+            for (int64_t b = first_block; b < last_block; ++b) {
+              fn(b, b * block_size, std::min(n, (b + 1) * block_size));
+            }
+          });
+  };
+
+  // The partition of every element, and the number of elements of each
+  // partition in each block.
+  std::vector<uint8> partitions(n);
+  std::vector<int64_t> offsets(num_blocks * num_partitions, 0);
+  for_each_block(/*cost_per_element=*/5,
+                 [&](int64_t b, int64_t start, int64_t end) {
+                   for (int64_t i = start; i < end; ++i) {
+                     partitions[i] = UniquePartition(input(i), partition_bits);
+                   }
+                   int64_t* block_counts = &offsets[b * num_partitions];
+                   for (int64_t i = start; i < end; ++i) {
+                     ++block_counts[partitions[i]];
+                   }
+                 });
+
+  // Sorts the positions of the elements by partition, keeping them in input
+  // order within each partition.
+  std::vector<int64_t> partition_starts(num_partitions + 1);
+  int64_t offset = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_starts[p] = offset;
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      const int64_t count = offsets[b * num_partitions + p];
+      offsets[b * num_partitions + p] = offset;
+      offset += count;
+    }
+  }
+  partition_starts[num_partitions] = offset;
+  std::vector<int32> positions(n);
+  for_each_block(/*cost_per_element=*/5,
+                 [&](int64_t b, int64_t start, int64_t end) {
+                   int64_t* block_offsets = &offsets[b * num_partitions];
+                   for (int64_t i = start; i < end; ++i) {
+                     positions[block_offsets[partitions[i]]++] = i;
+                   }
+                 });
+
+  // Uniquifies each partition. Until the unique elements are ordered, `idx`
+  // holds the index of every element among the unique elements of its
+  // partition.
+  std::vector<uint8> is_first_occurrence(n, 0);
+  std::vector<std::vector<TIndex>> partition_counts(num_partitions);
+  std::vector<std::vector<TIndex>> partition_to_output(num_partitions);
+  Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+        /*cost_per_unit=*/100 * block_size, [&](int64_t first, int64_t last) {
+          for (int64_t p = first; p < last; ++p) {
+            typename UniqueOpHashMap<T, TIndex>::map_type uniq;
+            uniq.reserve(partition_starts[p + 1] - partition_starts[p]);
+            std::vector<TIndex>& counts = partition_counts[p];
+            for (int64_t j = partition_starts[p]; j < partition_starts[p + 1];
+                 ++j) {
+              const int32 i = positions[j];
+              auto it = uniq.emplace(input(i), counts.size());
+              idx(i) = it.first->second;
+              if (it.second) {
+                is_first_occurrence[i] = 1;
+                counts.push_back(0);
+              }
+              ++counts[it.first->second];
+            }
+            partition_to_output[p].resize(uniq.size());
+          }
+        });
+
+  // Numbers the first occurrences of the unique elements in input order, with
+  // a prefix sum of their number in each block.
+  std::vector<int64_t> block_starts(num_blocks + 1);
+  for_each_block(/*cost_per_element=*/1,
+                 [&](int64_t b, int64_t start, int64_t end) {
+                   int64_t count = 0;
+                   for (int64_t i = start; i < end; ++i) {
+                     count += is_first_occurrence[i];
+                   }
+                   block_starts[b + 1] = count;
+                 });
+  block_starts[0] = 0;
+  for (int64_t b = 0; b < num_blocks; ++b) {
+    block_starts[b + 1] += block_starts[b];
+  }
+  const int64_t uniq_size = block_starts[num_blocks];
+
+  TensorShape output_shape(input_shape);
+  output_shape.set_dim(axis, uniq_size);
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+  auto output_flat = output->flat<T>();
+  TIndex* count_data = nullptr;
+  if (compute_counts) {
+    Tensor* count_output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                2, TensorShape({uniq_size}), &count_output));
+    count_data = count_output->vec<TIndex>().data();
+  }
+
+  for_each_block(
+      /*cost_per_element=*/5, [&](int64_t b, int64_t start, int64_t end) {
+        TIndex next = block_starts[b];
+        for (int64_t i = start; i < end; ++i) {
+          if (!is_first_occurrence[i]) continue;
+          output_flat(next) = input(i);
+          const TIndex local = idx(i);
+          partition_to_output[partitions[i]][local] = next;
+          if (count_data != nullptr) {
+            count_data[next] = partition_counts[partitions[i]][local];
+          }
+          ++next;
+        }
+      });
+  for_each_block(/*cost_per_element=*/5,
+                 [&](int64_t b, int64_t start, int64_t end) {
+                   for (int64_t i = start; i < end; ++i) {
+                     idx(i) = partition_to_output[partitions[i]][idx(i)];
+                   }
+                 });
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -150,6 +326,18 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
 
+      if constexpr (std::is_same<T, int32>::value ||
+                    std::is_same<T, int64_t>::value) {
+        if (N >= kParallelUniqueMinElements &&
+            context->device()->tensorflow_cpu_worker_threads()->num_threads >
+                1) {
+          ParallelUnique<T, TIndex>(context, Tin, input.shape(), axis,
+                                    /*compute_counts=*/num_outputs() > 2,
+                                    idx_vec);
+          return;
+        }
+      }
+
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
       for (Eigen::Index i = 0, j = 0; i < N; ++i) {
@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -37,6 +42,49 @@ namespace {
 
 const int kMaxStrLen = 40;
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large enough inputs are uniquified in parallel, which must also order the
+// unique elements by their first occurrence.
+TEST_F(UniqueOpTest, LargeInt64WithCounts) {
+  TF_ASSERT_OK(NodeDefBuilder("op", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  const int n = 1 << 18;
+  std::vector<int64_t> values(n);
+  for (int i = 0; i < n; ++i) {
+    values[i] = (static_cast<int64_t>(std::rand()) % 30011) - 15000;
+  }
+  AddInputFromArray<int64_t>(TensorShape({n}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  absl::flat_hash_map<int64_t, int32> expected_index;
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx(n);
+  std::vector<int32> expected_count;
+  for (int i = 0; i < n; ++i) {
+    auto it = expected_index.emplace(values[i], expected_y.size());
+    if (it.second) {
+      expected_y.push_back(values[i]);
+      expected_count.push_back(0);
+    }
+    expected_idx[i] = it.first->second;
+    ++expected_count[it.first->second];
+  }
+  const int64_t uniq_size = expected_y.size();
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0),
+      test::AsTensor<int64_t>(expected_y, TensorShape({uniq_size})));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1), test::AsTensor<int32>(expected_idx, TensorShape({n})));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(2),
+      test::AsTensor<int32>(expected_count, TensorShape({uniq_size})));
+}
+
 TensorProto GetRandomInt32TensorProto(int dim, int max_int) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_INT32);
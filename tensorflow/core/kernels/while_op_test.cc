@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstdlib>
+
 #include "tensorflow/c/experimental/stream_executor/stream_executor.h"
 #include "tensorflow/c/experimental/stream_executor/stream_executor_internal.h"
 #include "tensorflow/c/experimental/stream_executor/stream_executor_test_util.h"
@@ -220,5 +222,47 @@ TEST_F(WhileOpTest, WhileOpCPUBuildWithPluggableDevice) {
   }
 }
 
+TEST_F(WhileOpTest, StatelessWhileWithFusedIterations) {
+  setenv("TF_FUSE_STATELESS_WHILE_ITERATIONS", "1", /*overwrite=*/1);
+  Scope root = Scope::NewRootScope().ExitOnError();
+  FunctionDefLibrary f_lib_proto;
+  *f_lib_proto.add_function() = test::function::XTimesTwo();
+  *f_lib_proto.add_function() = test::function::LessThanOrEqualToN(8);
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+
+  auto a = ops::Placeholder(root.WithOpName("A"), DT_FLOAT);
+  AttrValue cond_func;
+  cond_func.mutable_func()->set_name("LessThanOrEqualToN");
+  (*cond_func.mutable_func()->mutable_attr())["T"].set_type(DT_FLOAT);
+  AttrValue body_func;
+  body_func.mutable_func()->set_name("XTimesTwo");
+  (*body_func.mutable_func()->mutable_attr())["T"].set_type(DT_FLOAT);
+
+  Node* node;
+  TF_EXPECT_OK(
+      NodeBuilder("while_test", "StatelessWhile", &root.graph()->flib_def())
+          .Input({NodeBuilder::NodeOut(a.node())})
+          .Attr("T", {DT_FLOAT})
+          .Attr("cond", cond_func)
+          .Attr("body", body_func)
+          .Attr("parallel_iterations", 100)
+          .Finalize(root.graph(), &node));
+  auto c = ops::Identity(root.WithOpName("C"), Output(node));
+  TF_ASSERT_OK(root.DoShapeInference(node));
+
+  ClientSession session(root);
+  for (float initial : {1.f, 3.f, 9.f}) {
+    ClientSession::FeedType feeds;
+    feeds.emplace(Output(a.node()), Input::Initializer(initial));
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(session.Run(feeds, {Output(c.node())}, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    float expected = initial;
+    while (expected <= 8) expected *= 2;
+    EXPECT_EQ(out_tensors[0].scalar<float>()(), expected);
+  }
+  unsetenv("TF_FUSE_STATELESS_WHILE_ITERATIONS");
+}
+
 }  // namespace
 }  // namespace tensorflow
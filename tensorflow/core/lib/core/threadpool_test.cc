@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -371,6 +372,27 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+#if defined(__linux__)
+TEST(ThreadPool, CpuSets) {
+  // Bind the threads to the CPU of the test, which is schedulable.
+  const int cpu = port::GetCurrentCPU();
+  ASSERT_GE(cpu, 0);
+  ThreadOptions thread_options;
+  thread_options.cpu_sets = {{cpu}, {cpu}};
+  ThreadPool pool(Env::Default(), thread_options, "test", kNumThreads);
+  absl::BlockingCounter counter(kNumThreads);
+  std::atomic<int> num_on_cpu(0);
+  for (int t = 0; t < kNumThreads; ++t) {
+    pool.Schedule([&]() {
+      if (port::GetCurrentCPU() == cpu) ++num_on_cpu;
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+  EXPECT_EQ(num_on_cpu, kNumThreads);
+}
+#endif  // defined(__linux__)
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
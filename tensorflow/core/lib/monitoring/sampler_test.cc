@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/lib/monitoring/sampler.h"
 
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace monitoring {
@@ -112,6 +114,31 @@ TEST(ExponentialSamplerTest, ExponentialBucketBoundaries) {
   EqHistograms(expected, cell->value());
 }
 
+TEST(UnlabeledSamplerTest, ConcurrentAdds) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumSamplesPerThread = 1000;
+  // Sampler automatically adds DBL_MAX to the list of buckets.
+  Histogram expected({10.0, 20.0, DBL_MAX});
+  auto* cell = sampler_with_labels->GetCell("ConcurrentAdds");
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([cell]() {
+        for (int i = 0; i < kNumSamplesPerThread; ++i) {
+          cell->Add(i % 30);
+        }
+      });
+    }
+  }
+  for (int t = 0; t < kNumThreads; ++t) {
+    for (int i = 0; i < kNumSamplesPerThread; ++i) {
+      expected.Add(i % 30);
+    }
+  }
+
+  EqHistograms(expected, cell->value());
+}
+
 TEST(ExplicitSamplerTest, SameName) {
   auto* same_sampler = Sampler<1>::New({"/tensorflow/test/sampler_with_labels",
                                         "Sampler with one label.", "MyLabel"},
@@ -22,12 +22,14 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #if GOOGLE_CUDA
 #include "tensorflow/compiler/xla/stream_executor/cuda/cuda_activation.h"
 #elif TENSORFLOW_USE_ROCM
@@ -75,6 +77,9 @@ struct NcclManager::NcclStream : public core::RefCounted {
   ~NcclStream() = default;
 
   se::StreamExecutor* executor = nullptr;
+  // Index of the communicators, among those for the same set of devices,
+  // whose kernels run on this stream.
+  int slot = 0;
 
   // The stream on which to run the nccl collective.
   // This is a different stream than the tensorflow compute stream.
@@ -111,12 +116,18 @@ struct NcclManager::CommunicatorMember {
 struct NcclManager::Communicator {
  public:
   explicit Communicator(std::vector<CommunicatorMember> members,
-                        const string& key)
-      : num_devices(members.size()), members(std::move(members)), key(key) {}
+                        const string& key, int slot)
+      : num_devices(members.size()),
+        members(std::move(members)),
+        key(key),
+        slot(slot) {}
 
   const int num_devices;
   std::vector<CommunicatorMember> members;
   const string key;
+  // Distinguishes the communicators created for the same set of devices in
+  // single-node collectives; see `num_communicators_per_device_set_`.
+  const int slot;
 };
 
 namespace {
@@ -225,7 +236,31 @@ struct NcclManager::Collective : public core::RefCounted {
   Status status;
 };
 
-NcclManager::NcclManager() {
+namespace {
+
+// Returns the number of communicators to spread the single-node collectives
+// over each set of devices across, read from TF_NCCL_NUM_COMMUNICATORS.
+int NumCommunicatorsPerDeviceSet() {
+#if TENSORFLOW_USE_ROCM
+  // On ROCm all communicators share the device context's nccl stream, so
+  // more than one communicator per device set could not overlap anyway.
+  return 1;
+#else
+  int64_t num_communicators;
+  Status status = ReadInt64FromEnvVar("TF_NCCL_NUM_COMMUNICATORS",
+                                      /*default_val=*/1, &num_communicators);
+  if (!status.ok() || num_communicators < 1) {
+    LOG(ERROR) << "Invalid TF_NCCL_NUM_COMMUNICATORS, using 1: " << status;
+    return 1;
+  }
+  return static_cast<int>(num_communicators);
+#endif
+}
+
+}  // namespace
+
+NcclManager::NcclManager()
+    : num_communicators_per_device_set_(NumCommunicatorsPerDeviceSet()) {
   VLOG(2) << "New NcclManager " << this;
 #if TENSORFLOW_USE_ROCM
   ++instance_count;
@@ -285,6 +320,18 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     return status_;
   }
 
+  // Single-node collectives over the same devices are spread across
+  // `num_communicators_per_device_set_` communicators by collective key.
+  // Each of them runs on its own stream per device, so that kernels of
+  // independent collectives can overlap instead of queuing behind each
+  // other on one stream.
+  int slot = 0;
+  if (collective->communicator_key.empty() &&
+      num_communicators_per_device_set_ > 1) {
+    slot = Hash64(collective->collective_key) %
+           num_communicators_per_device_set_;
+  }
+
   if (collective->communicator_key.empty()) {
     // For single-node collectives, when the caller does not specify a
     // `communicator_key`, we identify a communicator uniquely by the set of
@@ -308,7 +355,8 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     // kernels to per-stream launch queues.  The launch queues are processed by
     // LoopKernelLaunches.
     for (auto& comm : communicators_) {
-      if (comm->num_devices == collective->num_global_devices) {
+      if (comm->num_devices == collective->num_global_devices &&
+          comm->slot == slot) {
         int i;
         for (i = 0; i < collective->num_local_devices; ++i) {
           if (comm->members[i].nccl_stream->executor !=
@@ -358,7 +406,7 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     auto& streams = device_to_comm_streams_[executor];
     NcclStream* nccl_stream = nullptr;
     for (const auto& s : streams) {
-      if (used_streams.insert(s).second) {
+      if (s->slot == slot && used_streams.insert(s).second) {
         nccl_stream = s;
         break;
       }
@@ -366,6 +414,7 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     if (nccl_stream == nullptr) {
       nccl_stream = new NcclStream();
       nccl_stream->executor = executor;
+      nccl_stream->slot = slot;
 #if TENSORFLOW_USE_ROCM
       nccl_stream->stream = collective->participants[i]->context->nccl_stream();
 #else
@@ -432,7 +481,7 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     members[i].nccl_comm = nccl_comms[i];
   }
   communicators_.emplace_back(
-      new Communicator(std::move(members), collective->communicator_key));
+      new Communicator(std::move(members), collective->communicator_key, slot));
   *communicator = communicators_.back().get();
   return OkStatus();
 }
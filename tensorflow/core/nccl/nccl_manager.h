@@ -269,6 +269,13 @@ class NcclManager {
 
   std::vector<std::unique_ptr<Communicator>> communicators_ TF_GUARDED_BY(mu_);
 
+  // The number of communicators, each with its own stream on every device,
+  // created for one set of devices in single-node collectives. Collectives
+  // are assigned to them by the hash of their key. Read from the environment
+  // variable TF_NCCL_NUM_COMMUNICATORS; defaults to 1, which runs all
+  // collectives over a set of devices on one stream per device.
+  const int num_communicators_per_device_set_;
+
   Status status_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(NcclManager);
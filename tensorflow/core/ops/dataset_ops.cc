@@ -731,6 +731,7 @@ REGISTER_OP("CacheDataset")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("memory_budget_bytes: int = -1")
     // TODO(mdan): Should these use type inference instead?
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
@@ -749,6 +750,7 @@ REGISTER_OP("CacheDatasetV2")
     .Attr("output_types: list(type) >= 1")
     .Attr("output_shapes: list(shape) >= 1")
     .Attr("metadata: string = ''")
+    .Attr("memory_budget_bytes: int = -1")
     .SetTypeConstructor(full_type::VariadicTensorContainer(TFT_DATASET,
                                                            "output_types"))
     .SetShapeFn([](shape_inference::InferenceContext* c) {
@@ -765,6 +767,7 @@ REGISTER_OP("TextLineDataset")
     .Input("compression_type: string")
     .Input("buffer_size: int64")
     .Attr("metadata: string = ''")
+    .Attr("async_buffering: bool = false")
     .Output("handle: variant")
     .SetDoNotOptimize()  // TODO(b/123753214): See comment in dataset_ops.cc.
     .SetTypeConstructor(full_type::UnaryTensorContainer(TFT_DATASET,
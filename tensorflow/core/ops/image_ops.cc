@@ -526,6 +526,50 @@ REGISTER_OP("DecodeAndCropJpeg")
       return OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("_BatchDecodeAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_windows: int32")
+    .Attr("height: int >= 1")
+    .Attr("width: int >= 1")
+    .Attr("channels: int = 3")
+    .Attr("half_pixel_centers: bool = true")
+    .Output("images: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      DimensionHandle batch = c->Dim(contents, 0);
+      ShapeHandle crop_windows;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &crop_windows));
+      TF_RETURN_IF_ERROR(c->Merge(batch, c->Dim(crop_windows, 0), &batch));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(crop_windows, 1), 4, &unused));
+      int32_t height, width, channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("height", &height));
+      TF_RETURN_IF_ERROR(c->GetAttr("width", &width));
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+      c->set_output(0, c->MakeShape({batch, height, width, channels}));
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Decodes a batch of JPEG images, crops and resizes them into a dense batch.
+
+Every image is cropped to its window while it is decoded, as in
+`DecodeAndCropJpeg`, and then resized to `[height, width]` with bilinear
+interpolation, as in `ResizeBilinear`. The images are decoded in parallel.
+
+contents: The JPEG-encoded images, a 1-D string tensor of size `batch`.
+crop_windows: A `[batch, 4]` tensor of `[crop_y, crop_x, crop_height,
+  crop_width]` windows. A window with a non-positive height or width selects
+  the whole image.
+channels: The number of color channels of the images, 1 or 3.
+images: A `[batch, height, width, channels]` tensor of the resized images.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -374,6 +374,7 @@ REGISTER_OP("HashTableV2")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("compact_storage: bool = false")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
@@ -381,6 +382,7 @@ REGISTER_OP("AnonymousHashTable")
     .Output("table_handle: resource")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("compact_storage: bool = false")
     .SetIsStateful()
     .SetShapeFn(ScalarOutput);
 
@@ -401,6 +403,7 @@ REGISTER_OP("MutableHashTableV2")
     .Attr("use_node_name_sharing: bool = false")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
+    .Attr("num_shards: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn(MutableHashTableShapeFn);
 
@@ -430,6 +433,7 @@ REGISTER_OP("MutableHashTableOfTensorsV2")
     .Attr("key_dtype: type")
     .Attr("value_dtype: type")
     .Attr("value_shape: shape = {}")
+    .Attr("num_shards: int >= 1 = 1")
     .SetIsStateful()
     .SetShapeFn(MutableHashTableOfTensorsShapeFn);
 
@@ -344,6 +344,80 @@ expected to create these operators.
 )doc");
 // --------------------------------------------------------------------------
 
+REGISTER_OP("_FusedLayerNorm")
+    .Input("x: T")
+    .Input("scale: T")
+    .Input("offset: T")
+    .Output("y: T")
+    .Attr("T: {float, bfloat16}")
+    .Attr("epsilon: float = 0.001")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle x;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &x));
+      DimensionHandle depth = c->Dim(x, -1);
+      for (int i = 1; i < 3; ++i) {
+        ShapeHandle vec;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 1, &vec));
+        TF_RETURN_IF_ERROR(c->Merge(depth, c->Dim(vec, 0), &depth));
+      }
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(x, -1, depth, &out));
+      c->set_output(0, out);
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Internal LayerNorm operation: reserved for internal use.
+
+Normalizes `x` over its innermost dimension, then scales and shifts it by the
+vectors `scale` and `offset`.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
+REGISTER_OP("_FusedScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Output("output: T")
+    .Attr("T: {float}")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query, key, value;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 2, &query));
+      if (!c->RankKnown(query)) return shape_inference::UnknownShape(c);
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), c->Rank(query), &key));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), c->Rank(query), &value));
+
+      // query: [..., M, K], key: [..., N, K], value: [..., N, D].
+      ShapeHandle batch;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -2, &batch));
+      for (ShapeHandle input : {key, value}) {
+        ShapeHandle input_batch;
+        TF_RETURN_IF_ERROR(c->Subshape(input, 0, -2, &input_batch));
+        TF_RETURN_IF_ERROR(c->Merge(batch, input_batch, &batch));
+      }
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(query, -1), c->Dim(key, -1), &unused));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(key, -2), c->Dim(value, -2), &unused));
+
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          batch, c->Matrix(c->Dim(query, -2), c->Dim(value, -1)), &out));
+      c->set_output(0, out);
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Internal attention operation: reserved for internal use.
+
+Computes `softmax(scale * query * key^T) * value` over the two innermost
+dimensions, with identical batch dimensions on all inputs.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+// --------------------------------------------------------------------------
+
 REGISTER_OP("BiasAdd")
     .Attr("T: numbertype")
     .Input("value: T")
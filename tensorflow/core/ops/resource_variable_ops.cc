@@ -159,6 +159,35 @@ REGISTER_OP("_ReadVariablesOp")
     .Attr("dtypes: list(type)")
     .SetShapeFn(ReadVariablesShapeFn);
 
+REGISTER_OP("_ReadVariableDirtyRows")
+    .Input("resource: resource")
+    .Output("row_ids: int64")
+    .Output("rows: dtype")
+    .Attr("dtype: type")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->Vector(c->UnknownDim()));
+      ShapeHandle rows = c->UnknownShape();
+      auto* handle_data = c->input_handle_shapes_and_types(0);
+      if (handle_data != nullptr && !handle_data->empty()) {
+        TF_RETURN_IF_ERROR(
+            c->WithRankAtLeast(handle_data->at(0).shape, 1, &rows));
+        TF_RETURN_IF_ERROR(c->ReplaceDim(rows, 0, c->UnknownDim(), &rows));
+      }
+      c->set_output(1, rows);
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Reads the rows of a variable written since the previous read.
+
+The first read of a variable returns all its rows, and starts tracking the rows
+written by sparse updates. Dense updates mark all the rows as written. Used to
+write delta checkpoints of large embedding variables.
+
+row_ids: The sorted ids of the rows written since the previous read.
+rows: The values of the rows `row_ids`.
+)doc");
+
 Status ReadGrad(const AttrSlice& attrs, FunctionDef* g) {
   // clang-format off
   *g = FunctionDefHelper::Define(
@@ -309,6 +338,63 @@ REGISTER_OP("ResourceGather")
       return OkStatus();
     });
 
+REGISTER_OP("_FusedEmbeddingLookups")
+    .Input("resources: N * resource")
+    .Input("ids: N * Tindices")
+    .Input("indices: N * Tidx")
+    .Input("segment_ids: N * Tsegmentids")
+    .Output("outputs: N * dtype")
+    .Attr("N: int >= 1")
+    .Attr("dtype: {bfloat16, half, float, double}")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .SetShapeFn([](InferenceContext* c) {
+      int32_t n;
+      TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+      DataType dtype;
+      TF_RETURN_IF_ERROR(c->GetAttr("dtype", &dtype));
+      for (int i = 0; i < n; ++i) {
+        ShapeHandle unused;
+        TF_RETURN_IF_ERROR(c->WithRank(c->input(n + i), 1, &unused));
+        ShapeHandle indices_shape;
+        TF_RETURN_IF_ERROR(
+            c->WithRank(c->input(2 * n + i), 1, &indices_shape));
+        TF_RETURN_IF_ERROR(
+            c->Merge(indices_shape, c->input(3 * n + i), &unused));
+        ShapeHandle params = c->UnknownShape();
+        auto* handle_data = c->input_handle_shapes_and_types(i);
+        if (handle_data != nullptr && !handle_data->empty()) {
+          if (handle_data->at(0).dtype != dtype) {
+            return errors::InvalidArgument(
+                "Trying to read variable with wrong dtype. Expected ",
+                DataTypeString(handle_data->at(0).dtype), " got ",
+                DataTypeString(dtype));
+          }
+          params = handle_data->at(0).shape;
+        }
+        TF_RETURN_IF_ERROR(c->WithRankAtLeast(params, 1, &params));
+        ShapeHandle params_subshape;
+        TF_RETURN_IF_ERROR(c->Subshape(params, 1, &params_subshape));
+        ShapeHandle out;
+        TF_RETURN_IF_ERROR(
+            c->Concatenate(c->Vector(InferenceContext::kUnknownDim),
+                           params_subshape, &out));
+        c->set_output(i, out);
+      }
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Computes several embedding lookups, one per variable, in a single kernel.
+
+Lookup `i` produces the same result as
+`SparseSegment<Combiner>(ResourceGather(resources[i], ids[i]), indices[i],
+segment_ids[i])` without materializing the gathered rows. This op is generated
+by the `embedding_lookup_fusion` Grappler optimizer and is not meant to be
+used directly.
+)doc");
+
 REGISTER_OP("ResourceGatherNd")
     .Input("resource: resource")
     .Input("indices: Tindices")
@@ -1173,4 +1173,80 @@ REGISTER_OP("ResourceApplyPowerSign")
     .Attr("use_locking: bool = false")
     .SetShapeFn(ApplyPowerSignShapeFn</*is_resource=*/true>);
 
+// Shape function of the fused ops below, which apply an optimizer to the `N`
+// variables of each of the `num_slots` resource lists (the variables and their
+// slots) starting at input 0. These are followed by `num_scalars` scalar
+// hyperparameters and by the `N` gradients.
+template <int num_slots, int num_scalars>
+static Status FusedResourceApplyShapeFn(InferenceContext* c) {
+  int32_t n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  for (int i = 0; i < num_scalars; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(num_slots * n + i), 0, &unused));
+  }
+  const int grad_start = num_slots * n + num_scalars;
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);
+    for (int slot = 1; slot < num_slots; ++slot) {
+      TF_RETURN_IF_ERROR(c->Merge(
+          s, ShapeOrHandleShape</*is_resource=*/true>(c, slot * n + i), &s));
+    }
+    TF_RETURN_IF_ERROR(
+        HandleGradAndIndicesInputs</*is_sparse=*/false, /*is_resource=*/true>(
+            c, grad_start + i, &s));
+  }
+  return OkStatus();
+}
+
+REGISTER_OP("_FusedResourceApplyAdam")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(FusedResourceApplyShapeFn</*num_slots=*/3, /*num_scalars=*/6>)
+    .Doc(R"doc(
+Applies `ResourceApplyAdam` to `N` variables in a single kernel.
+)doc");
+
+REGISTER_OP("_FusedResourceApplyMomentum")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("momentum: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(FusedResourceApplyShapeFn</*num_slots=*/2, /*num_scalars=*/2>)
+    .Doc(R"doc(
+Applies `ResourceApplyMomentum` to `N` variables in a single kernel.
+)doc");
+
+REGISTER_OP("_FusedResourceApplyAdagradV2")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn(FusedResourceApplyShapeFn</*num_slots=*/2, /*num_scalars=*/2>)
+    .Doc(R"doc(
+Applies `ResourceApplyAdagradV2` to `N` variables in a single kernel.
+)doc");
+
 }  // namespace tensorflow
@@ -73,6 +73,7 @@ using tsl::port::PREFETCHW;
 using tsl::port::PREFETCHWT1;
 using tsl::port::RDRAND;
 using tsl::port::RDSEED;
+using tsl::port::SetCurrentThreadCpuAffinity;
 using tsl::port::SMAP;
 using tsl::port::SSE;
 using tsl::port::SSE2;
@@ -15,9 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/multi_xplanes_to_op_stats.h"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/convert/op_stats_combiner.h"
 #include "tensorflow/core/profiler/convert/preprocess_single_host_xplane.h"
 #include "tensorflow/core/profiler/convert/repository.h"
@@ -32,17 +38,37 @@ namespace profiler {
 Status ConvertMultiXSpacesToCombinedOpStats(
     const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
     OpStats* combined_op_stats) {
-  // Read multiple XSpaces and convert to multiple OpStats.
+  // Read multiple XSpaces and convert to multiple OpStats, the XSpaces of
+  // different hosts in parallel. Each thread only holds the XSpace it is
+  // converting.
   // TODO(profiler): Change the combiner to convert and combine one OpStats at a
   // time, to reduce peak memory usage.
-  std::vector<OpStats> all_op_stats;
-  all_op_stats.reserve(session_snapshot.XSpaceSize());
-  for (int i = 0; i < session_snapshot.XSpaceSize(); i++) {
-    TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
-                        session_snapshot.GetXSpace(i));
-    PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
+  const int num_xspaces = session_snapshot.XSpaceSize();
+  std::vector<OpStats> all_op_stats(num_xspaces);
+  std::vector<Status> statuses(num_xspaces);
+  auto convert_xspace = [&](int i) {
+    StatusOr<std::unique_ptr<XSpace>> xspace = session_snapshot.GetXSpace(i);
+    if (!xspace.ok()) {
+      statuses[i] = xspace.status();
+      return;
+    }
+    PreprocessSingleHostXSpace(xspace->get(), /*step_grouping=*/true,
                                /*derived_timeline=*/false);
-    all_op_stats.push_back(ConvertXSpaceToOpStats(*xspace, options));
+    all_op_stats[i] = ConvertXSpaceToOpStats(**xspace, options);
+  };
+  const int num_threads = std::min(num_xspaces, port::MaxParallelism());
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_xspaces; i++) convert_xspace(i);
+  } else {
+    // The destructor of the pool waits for all the conversions.
+    thread::ThreadPool pool(Env::Default(), "convert_xspaces_to_op_stats",
+                            num_threads);
+    for (int i = 0; i < num_xspaces; i++) {
+      pool.Schedule([&convert_xspace, i] { convert_xspace(i); });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
   }
 
   // Combine OpStats.
@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/convert/multi_xplanes_to_op_stats.h"
@@ -123,6 +124,34 @@ TEST(ConvertXPlaneToOpStats, GpuRunEnvironment) {
   EXPECT_EQ(2, run_env.device_core_count());
 }
 
+TEST(ConvertXPlaneToOpStats, MultiHostGpuRunEnvironment) {
+  constexpr int kNumHosts = 8;
+  std::vector<std::string> xspace_paths;
+  std::vector<std::unique_ptr<XSpace>> xspaces;
+  for (int i = 0; i < kNumHosts; ++i) {
+    auto space = std::make_unique<XSpace>();
+    XPlaneBuilder device_plane(
+        GetOrCreateGpuXPlane(space.get(), /*device_ordinal=*/0));
+    device_plane.AddStatValue(*device_plane.GetOrCreateStatMetadata(
+                                  GetStatTypeStr(StatType::kDevVendor)),
+                              kDeviceVendorNvidia);
+    space->add_hostnames(absl::StrCat("host", i));
+    xspace_paths.push_back(absl::StrCat("host", i, ".xplane.pb"));
+    xspaces.push_back(std::move(space));
+  }
+  auto session_snapshot_or =
+      SessionSnapshot::Create(std::move(xspace_paths), std::move(xspaces));
+  TF_CHECK_OK(session_snapshot_or.status());
+  OpStats op_stats;
+  TF_CHECK_OK(ConvertMultiXSpacesToCombinedOpStats(
+      session_snapshot_or.value(), OpStatsOptions(), &op_stats));
+  const RunEnvironment& run_env = op_stats.run_environment();
+
+  EXPECT_EQ("Nvidia GPU", run_env.device_type());
+  EXPECT_EQ(kNumHosts, run_env.host_count());
+  EXPECT_EQ(kNumHosts, run_env.device_core_count());
+}
+
 TEST(ConvertXPlaneToOpStats, CpuOnlyStepDbTest) {
   constexpr int64_t kStepNum = 123;
   constexpr int64_t kStepId = 0;
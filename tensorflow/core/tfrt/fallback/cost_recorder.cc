@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -55,6 +56,13 @@ uint64_t CostRecorder::GetCost(int64_t op_key) const {
 }
 
 Status CostRecorder::WriteToFile() const {
+  std::string measured_cost_path;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(MesuredCostPathEnvVarName(), "",
+                                          &measured_cost_path));
+  return WriteToFile(measured_cost_path);
+}
+
+Status CostRecorder::WriteToFile(absl::string_view path) const {
   OpCostMapProto op_cost_map_proto;
   {
     tf_shared_lock l(op_cost_map_mutex_);
@@ -64,11 +72,21 @@ Status CostRecorder::WriteToFile() const {
     }
   }
 
-  std::string measured_cost_path;
-  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(MesuredCostPathEnvVarName(), "",
-                                          &measured_cost_path));
   return tensorflow::WriteTextProto(tensorflow::Env::Default(),
-                                    measured_cost_path, op_cost_map_proto);
+                                    std::string(path), op_cost_map_proto);
+}
+
+Status CostRecorder::ReadFromFile(absl::string_view path) {
+  OpCostMapProto op_cost_map_proto;
+  TF_RETURN_IF_ERROR(tensorflow::ReadTextProto(
+      tensorflow::Env::Default(), std::string(path), &op_cost_map_proto));
+
+  mutex_lock l(op_cost_map_mutex_);
+  for (const auto& [op_key, avg_op_cost] : op_cost_map_proto.op_cost_map()) {
+    op_cost_map_[op_key].first += avg_op_cost;
+    op_cost_map_[op_key].second += 1;
+  }
+  return OkStatus();
 }
 
 size_t CostRecorder::size() const {
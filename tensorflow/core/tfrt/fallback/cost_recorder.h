@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -54,6 +55,14 @@ class CostRecorder {
   // TODO(b/263837451): Fix the op_key unstableness during serialization.
   Status WriteToFile() const;
 
+  // Writes the op cost map (in format of `OpCostMapProto`) to `path`.
+  Status WriteToFile(absl::string_view path) const;
+
+  // Records the average execution durations in the op cost map (in format of
+  // `OpCostMapProto`) read from `path`, e.g. written by `WriteToFile()` in a
+  // previous run of the same model, as one execution of each op.
+  Status ReadFromFile(absl::string_view path);
+
   size_t size() const;
 
   static const char* MesuredCostPathEnvVarName() {
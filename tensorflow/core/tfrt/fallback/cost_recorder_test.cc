@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status.h"
@@ -108,6 +109,26 @@ TEST_P(CostRecorderTest, ProtoRecordsTest) {
             kTestAvgCost);
 }
 
+TEST_P(CostRecorderTest, ReadFromFileTest) {
+  CostRecorder recorder(GetParam().normalize_ratio);
+  recorder.RecordCost(kTestOpKey, kTestCost);
+  recorder.RecordCost(kTestOpKey, 2 * kTestCost);
+
+  std::string measured_cost_path;
+  tensorflow::Env::Default()->LocalTempFilename(&measured_cost_path);
+  TF_CHECK_OK(recorder.WriteToFile(measured_cost_path));
+
+  // The costs read back are the ones measured by `recorder`.
+  CostRecorder read_recorder(GetParam().normalize_ratio);
+  TF_CHECK_OK(read_recorder.ReadFromFile(measured_cost_path));
+  ASSERT_EQ(read_recorder.size(), 1);
+  EXPECT_EQ(read_recorder.GetCost(kTestOpKey), recorder.GetCost(kTestOpKey));
+
+  EXPECT_FALSE(
+      read_recorder.ReadFromFile(absl::StrCat(measured_cost_path, "_missing"))
+          .ok());
+}
+
 INSTANTIATE_TEST_SUITE_P(CostRecorderTests, CostRecorderTest,
                          ::testing::Values(TestParams{1}, TestParams{100}));
 
@@ -14,16 +14,36 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "absl/base/casts.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
 
+OpKernelRunner* OpKernelRunnerCache::Find(const OpLocationKey& key,
+                                          size_t hash, size_t* slot) const {
+  if (slot != nullptr) *slot = kNumSlots;
+  for (size_t i = 0; i < kMaxProbes; ++i) {
+    const size_t index = (hash + i) % kNumSlots;
+    Entry* entry = slots_[index].load(std::memory_order_acquire);
+    if (entry == nullptr) {
+      // The slots are filled in probing order and never cleared, so `key`
+      // isn't in any of the next slots either.
+      if (slot != nullptr) *slot = index;
+      return nullptr;
+    }
+    if (entry->key == key) return &entry->runner;
+  }
+  return nullptr;
+}
+
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
     absl::string_view device_name, int num_args,
@@ -32,21 +52,25 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     const tensorflow::ProcessFunctionLibraryRuntime&
         process_function_library_runtime) {
   OpLocationKey key(loc);
-  {
-    tf_shared_lock lock(mu_);
-    auto it = map_.find(key);
-    if (it != map_.end()) {
-      DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-      return it->second.get();
-    }
+  const size_t hash = absl::Hash<OpLocationKey>()(key);
+  if (auto* runner = Find(key, hash)) {
+    DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+    return runner;
   }
 
   mutex_lock lock(mu_);
 
-  auto it = map_.find(key);
-  if (it != map_.end()) {
-    DCHECK_EQ(it->second->op_kernel()->name(), op_name);
-    return it->second.get();
+  size_t slot;
+  if (auto* runner = Find(key, hash, &slot)) {
+    DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+    return runner;
+  }
+  if (slot == kNumSlots) {
+    auto it = overflow_map_.find(key);
+    if (it != overflow_map_.end()) {
+      DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
+      return it->second.get();
+    }
   }
 
   VLOG(1) << "KernelFallbackExecuteCompat creating op " << op_name
@@ -60,13 +84,19 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
                        op_name, node_name, device_name, num_args, attr_builder,
                        device_manager, process_function_library_runtime));
 
-  auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
-
-  auto* runner_ptr = runner_uptr.get();
-  auto r = map_.emplace(key, std::move(runner_uptr)).second;
-  DCHECK(r);
+  if (slot == kNumSlots) {
+    auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
+    auto* runner_ptr = runner_uptr.get();
+    auto r = overflow_map_.emplace(key, std::move(runner_uptr)).second;
+    DCHECK(r);
+    return runner_ptr;
+  }
 
-  return runner_ptr;
+  entries_.push_back(std::make_unique<Entry>(key, std::move(runner)));
+  Entry* entry = entries_.back().get();
+  // Publishes the fully constructed entry to the lock-free readers.
+  slots_[slot].store(entry, std::memory_order_release);
+  return &entry->runner;
 }
 
 }  // namespace tfrt_stub
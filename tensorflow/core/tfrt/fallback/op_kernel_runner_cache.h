@@ -15,9 +15,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tfrt/host_context/location.h"  // from @tf_runtime
@@ -47,9 +52,16 @@ class OpLocationKey {
 };
 
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// Runners are never removed from the cache, so the lookup of a cached runner
+// is lock-free: the runners are kept in a fixed-size open-addressing table of
+// atomic pointers, which is only written to under `mu_`. The runners that
+// don't fit in the table are kept in a map guarded by `mu_`.
 class OpKernelRunnerCache {
  public:
   OpKernelRunnerCache() = default;
+  OpKernelRunnerCache(const OpKernelRunnerCache&) = delete;
+  OpKernelRunnerCache& operator=(const OpKernelRunnerCache&) = delete;
 
   StatusOr<OpKernelRunner*> GetOrCreate(
       tfrt::Location loc, absl::string_view op_name,
@@ -60,9 +72,32 @@ class OpKernelRunnerCache {
           process_function_library_runtime);
 
  private:
+  struct Entry {
+    Entry(OpLocationKey key, OpKernelRunner runner)
+        : key(key), runner(std::move(runner)) {}
+
+    const OpLocationKey key;
+    OpKernelRunner runner;
+  };
+
+  static constexpr size_t kNumSlots = 1024;
+  // The number of slots probed for a key before it is looked up in
+  // `overflow_map_`.
+  static constexpr size_t kMaxProbes = 16;
+
+  // Returns the runner of `key` if it is in `slots_`. If `slot` is not null,
+  // it is set to the first empty slot probed for `key`, if any, or to
+  // `kNumSlots` otherwise.
+  OpKernelRunner* Find(const OpLocationKey& key, size_t hash,
+                       size_t* slot = nullptr) const;
+
+  std::array<std::atomic<Entry*>, kNumSlots> slots_{};
+
   mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
-      TF_GUARDED_BY(mu_);
+  // Owns the entries of `slots_`.
+  std::vector<std::unique_ptr<Entry>> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>>
+      overflow_map_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tfrt_stub
@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -122,6 +123,40 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, OpKernelRunnerCacheManyLocations) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  OpKernelRunnerCache cache;
+  auto get_or_create = [&](int data) {
+    return cache.GetOrCreate(
+        tfrt::Location(/*handler=*/nullptr, data),
+        /*op_name=*/"TestOp",
+        /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+        /*num_args=*/1,
+        /*attr_builder=*/[](tensorflow::AttrValueMap*) { return OkStatus(); },
+        fallback_state->device_manager(),
+        fallback_state->process_function_library_runtime());
+  };
+
+  // More locations than the lock-free table of the cache has slots, so that
+  // some of the runners end up in its overflow map.
+  constexpr int kNumLocations = 1500;
+  std::vector<OpKernelRunner*> runners;
+  for (int i = 0; i < kNumLocations; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(auto* runner, get_or_create(i));
+    ASSERT_TRUE(runner);
+    EXPECT_EQ(runner->op_kernel()->name(), absl::StrCat("TestOp_", i, "_0"));
+    runners.push_back(runner);
+  }
+  for (int i = 0; i < kNumLocations; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(auto* runner, get_or_create(i));
+    EXPECT_EQ(runner, runners[i]);
+  }
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <optional>
 #include <ostream>
+#include <string>
 
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
@@ -68,6 +69,14 @@ struct GraphExecutionOptions {
   // TODO(b/278298965): Maybe remove normalization.
   uint64_t online_cost_analysis_normalize_ratio = 1;
 
+  // If non-empty and `enable_online_cost_analysis` is true, the op costs
+  // recorded for each client graph are also written to a file in this
+  // directory. When a client graph with the same name is loaded again, e.g. by
+  // a later run of the same model with the same compile options, its op costs
+  // are read from that file and used to re-compile it, instead of being
+  // measured again on its first request.
+  std::string measured_op_costs_dir;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
@@ -46,7 +46,10 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/tfrt/translate/tfrt_compile_options.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -468,6 +471,15 @@ void CreateSortedNamesAndOriginalIndices(absl::Span<const std::string> names,
   }
 }
 
+// Returns the path of the file in `measured_op_costs_dir` storing the op costs
+// of the client graph named `client_graph_name`.
+std::string MeasuredOpCostsPath(absl::string_view measured_op_costs_dir,
+                                absl::string_view client_graph_name) {
+  return tensorflow::io::JoinPath(
+      measured_op_costs_dir,
+      absl::StrCat(tensorflow::Fingerprint64(client_graph_name), ".pbtxt"));
+}
+
 }  // namespace
 
 tensorflow::Status GraphExecutor::Run(
@@ -537,10 +549,23 @@ tensorflow::Status GraphExecutor::Run(
 
   // Conduct cost analysis for the first request on this `loaded_client_graph`.
   std::unique_ptr<CostRecorder> cost_recorder;
+  std::string measured_op_costs_path;
   if (options_.enable_online_cost_analysis) {
     cost_recorder = loaded_client_graph.MaybeCreateCostRecorder(
         options_.online_cost_analysis_normalize_ratio);
   }
+  if (cost_recorder != nullptr && !options_.measured_op_costs_dir.empty()) {
+    measured_op_costs_path = MeasuredOpCostsPath(
+        options_.measured_op_costs_dir, loaded_client_graph.name());
+    // Use the op costs measured by a previous run instead of measuring them
+    // again. This request still runs with the current executable.
+    if (tensorflow::Env::Default()->FileExists(measured_op_costs_path).ok()) {
+      TF_RETURN_IF_ERROR(cost_recorder->ReadFromFile(measured_op_costs_path));
+      TF_RETURN_IF_ERROR(
+          loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
+      cost_recorder.reset();
+    }
+  }
 
   std::vector<tensorflow::Tensor> flat_outputs;
   TF_RETURN_IF_ERROR(GraphExecutionRunOnFunction(
@@ -554,6 +579,13 @@ tensorflow::Status GraphExecutor::Run(
   if (cost_recorder != nullptr) {
     TF_RETURN_IF_ERROR(
         loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
+    if (!measured_op_costs_path.empty()) {
+      if (auto status = cost_recorder->WriteToFile(measured_op_costs_path);
+          !status.ok()) {
+        LOG(WARNING) << "TFRT failed to write the op costs of client graph "
+                     << loaded_client_graph.name() << ": " << status;
+      }
+    }
   }
 
   // Create the outputs from the actual function results, which are sorted
@@ -44,8 +44,15 @@ LoadedExecutable::LoadedExecutable(bc::Executable executable,
   }
 
   functions_.reserve(executable_.functions().size());
+  decoded_kernels_.reserve(executable_.functions().size());
   for (auto function : executable_.functions()) {
     functions_[function.name().Get()] = function;
+
+    auto& decoded_kernels = decoded_kernels_[DecodedKernelsKey(function)];
+    decoded_kernels.reserve(function.kernels().size());
+    for (auto kernel : function.kernels()) {
+      decoded_kernels.push_back({kernels_[kernel.code()], kernel});
+    }
   }
 }
 
@@ -70,11 +70,27 @@ class KernelRegistry {
 
 class LoadedExecutable {
  public:
+  // A kernel invocation of a function, decoded from the bytecode at load time.
+  struct DecodedKernel {
+    KernelImplementation implementation;
+    bc::Kernel kernel;
+  };
+
   LoadedExecutable(bc::Executable executable,
                    const KernelRegistry& kernel_registry);
 
   absl::Span<const KernelImplementation> kernels() const { return kernels_; }
 
+  // Returns the kernels of `function` in program order, with their
+  // implementations already resolved, so that the interpreter doesn't have to
+  // decode them from the bytecode on every invocation.
+  absl::Span<const DecodedKernel> GetDecodedKernels(
+      bc::Function function) const {
+    auto iter = decoded_kernels_.find(DecodedKernelsKey(function));
+    DCHECK(iter != decoded_kernels_.end());
+    return iter->second;
+  }
+
   bc::Function GetFunction(absl::string_view name) const {
     if (auto iter = functions_.find(name); iter != functions_.end()) {
       return iter->second;
@@ -86,10 +102,20 @@ class LoadedExecutable {
   bc::Executable executable() const { return executable_; }
 
  private:
+  // The kernels of two functions can only start at the same address if one
+  // of them has no kernels, hence the size in the key.
+  using DecodedKernelsKeyType = std::pair<const char*, size_t>;
+  static DecodedKernelsKeyType DecodedKernelsKey(bc::Function function) {
+    auto kernels = function.kernels();
+    return {kernels.begin().data(), kernels.size()};
+  }
+
   bc::Executable executable_;
 
   absl::flat_hash_map<std::string, bc::Function> functions_;
   std::vector<KernelImplementation> kernels_;
+  absl::flat_hash_map<DecodedKernelsKeyType, std::vector<DecodedKernel>>
+      decoded_kernels_;
 };
 
 // A helper structure that holds states for a kernel. Typical usuage is that a
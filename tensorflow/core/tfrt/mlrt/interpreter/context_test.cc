@@ -19,6 +19,8 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
+#include "tensorflow/core/tfrt/mlrt/bytecode/executable.h"
 
 namespace mlrt {
 namespace {
@@ -60,6 +62,45 @@ TEST(ContextTest, MergeKernelRegistry) {
   EXPECT_TRUE(reg_a.Get(C::kName));
 }
 
+TEST(ContextTest, DecodedKernels) {
+  bc::Buffer buffer;
+  bc::Allocator allocator(&buffer);
+
+  auto executable_ctor = bc::New<bc::Executable>(&allocator);
+  executable_ctor.construct_kernel_names(2).Assign({A::kName, B::kName});
+
+  auto functions_ctor = executable_ctor.construct_functions(2);
+  {
+    auto function_ctor = functions_ctor.ConstructAt(0);
+    function_ctor.construct_name("f");
+    auto kernels_ctor = function_ctor.construct_kernels(2);
+    kernels_ctor.ConstructAt(0).set_code(1);
+    kernels_ctor.ConstructAt(1).set_code(0);
+  }
+  {
+    auto function_ctor = functions_ctor.ConstructAt(1);
+    function_ctor.construct_name("g");
+    function_ctor.construct_kernels(0);
+  }
+
+  KernelRegistry registry;
+  registry.Register<A>();
+  registry.Register<B>();
+  LoadedExecutable loaded_executable(bc::Executable(buffer.Get(0)), registry);
+
+  auto f_kernels =
+      loaded_executable.GetDecodedKernels(loaded_executable.GetFunction("f"));
+  ASSERT_EQ(f_kernels.size(), 2);
+  EXPECT_EQ(f_kernels[0].implementation, registry.Get(B::kName));
+  EXPECT_EQ(f_kernels[0].kernel.code(), 1);
+  EXPECT_EQ(f_kernels[1].implementation, registry.Get(A::kName));
+  EXPECT_EQ(f_kernels[1].kernel.code(), 0);
+
+  EXPECT_TRUE(
+      loaded_executable.GetDecodedKernels(loaded_executable.GetFunction("g"))
+          .empty());
+}
+
 struct TestContext0 : UserContext<TestContext0> {
   int v = 0;
 };
@@ -35,11 +35,10 @@ void Execute(ExecutionContext& context) {
     FunctionContext* current_function = &context.function_stack_.back();
     int64_t pc = current_function->pc_;
 
-    auto kernels = context.loaded_executable().kernels();
+    auto kernels = context.loaded_executable().GetDecodedKernels(
+        current_function->function_object());
 
-    auto kernel_object_iter =
-        current_function->function_object().kernels().begin();
-    kernel_object_iter += pc;
+    auto kernel_iter = kernels.begin() + pc;
 
     KernelFrame::State kstate(current_function);
     KernelFrame frame(&kstate);
@@ -48,12 +47,10 @@ void Execute(ExecutionContext& context) {
     // the execution state to break this loop for context-switching or error
     // handling.
     for (; context.state_ == ExecutionContext::State::kRunning; ++pc) {
-      DCHECK(kernel_object_iter <
-             current_function->function_object().kernels().end());
-      bc::Kernel kernel_object = *kernel_object_iter;
-      frame.set_kernel(kernel_object);
-      kernels[kernel_object.code()](frame);
-      ++kernel_object_iter;
+      DCHECK(kernel_iter < kernels.end());
+      frame.set_kernel(kernel_iter->kernel);
+      kernel_iter->implementation(frame);
+      ++kernel_iter;
     }
 
     // Update the program counter if we need to break the sequential execution
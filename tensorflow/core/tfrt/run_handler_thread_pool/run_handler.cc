@@ -17,6 +17,7 @@ limitations under the License.
 #include <atomic>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -26,7 +27,10 @@ limitations under the License.
 #include <optional>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -48,6 +52,29 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+// Records the time a request with `priority` waited for a handler.
+void RecordQueueingDelay(int priority, uint64_t delay_us) {
+  static auto* cell = tensorflow::monitoring::Sampler<1>::New(
+      {"/tensorflow/tfrt/run_handler/queueing_delay",
+       "Tracks the time (in microseconds) requests wait for a run handler, by "
+       "request priority.",
+       "priority"},
+      // Buckets of [1us, ~50s].
+      tensorflow::monitoring::Buckets::Exponential(1, 2, 26));
+  cell->GetCell(absl::StrCat(priority))->Add(static_cast<double>(delay_us));
+}
+
+// Records a request with `priority` dropped because its deadline expired
+// before it got a handler.
+void RecordExpiredRequest(int priority) {
+  static auto* cell = tensorflow::monitoring::Counter<1>::New(
+      "/tensorflow/tfrt/run_handler/expired_requests",
+      "Counts the requests dropped because their deadline expired before they "
+      "got a run handler, by request priority.",
+      "priority");
+  cell->GetCell(absl::StrCat(priority))->IncrementBy(1);
+}
+
 }  // namespace
 
 namespace internal {
@@ -776,6 +803,14 @@ class RunHandlerPool::Impl {
     return !free_handlers_.empty();
   }
 
+  // Returns true if a request with `priority` can take a free handler, i.e. a
+  // handler is free and no request with a higher priority is waiting for one.
+  bool can_acquire_handler(int priority) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return has_free_handler() &&
+           (waiting_priorities_.empty() ||
+            priority >= waiting_priorities_.begin()->first);
+  }
+
   std::unique_ptr<RunHandler> Get(int64_t step_id, int64_t timeout_in_ms,
                                   const RunHandlerOptions& options)
       TF_LOCKS_EXCLUDED(mu_) {
@@ -786,21 +821,47 @@ class RunHandlerPool::Impl {
     uint64_t version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    const uint64_t wait_start_us = tensorflow::EnvTime::NowMicros();
+    if (options.deadline_us != 0 &&
+        wait_start_us >= static_cast<uint64_t>(options.deadline_us)) {
+      RecordExpiredRequest(options.priority);
+      return nullptr;
+    }
     {
       tensorflow::mutex_lock l(mu_);
-      if (!has_free_handler()) {
+      if (!can_acquire_handler(options.priority)) {
         tensorflow::profiler::TraceMe activity(
             [step_id] {
               return tensorflow::profiler::TraceMeEncode(
                   "WaitingForHandler", {{"step_id", step_id}});
             },
             tensorflow::profiler::TraceMeLevel::kInfo);
-        if (timeout_in_ms == 0) {
-          mu_.Await(tensorflow::Condition(this, &Impl::has_free_handler));
-        } else if (!mu_.AwaitWithDeadline(
-                       tensorflow::Condition(this, &Impl::has_free_handler),
-                       tensorflow::EnvTime::NowNanos() +
-                           timeout_in_ms * 1000 * 1000)) {
+        uint64_t deadline_ns = 0;
+        if (timeout_in_ms != 0) {
+          deadline_ns = tensorflow::EnvTime::NowNanos() +
+                        timeout_in_ms * 1000 * 1000;
+        }
+        if (options.deadline_us != 0) {
+          const uint64_t request_deadline_ns =
+              static_cast<uint64_t>(options.deadline_us) * 1000;
+          if (deadline_ns == 0 || request_deadline_ns < deadline_ns) {
+            deadline_ns = request_deadline_ns;
+          }
+        }
+        HandlerWaiter waiter{this, options.priority};
+        ++waiting_priorities_[options.priority];
+        bool acquired = true;
+        if (deadline_ns == 0) {
+          mu_.Await(tensorflow::Condition(&waiter, &HandlerWaiter::Ready));
+        } else {
+          acquired = mu_.AwaitWithDeadline(
+              tensorflow::Condition(&waiter, &HandlerWaiter::Ready),
+              deadline_ns);
+        }
+        auto waiting = waiting_priorities_.find(options.priority);
+        if (--waiting->second == 0) waiting_priorities_.erase(waiting);
+        if (!acquired) {
+          if (options.deadline_us != 0) RecordExpiredRequest(options.priority);
           return nullptr;
         }
       }
@@ -828,6 +889,8 @@ class RunHandlerPool::Impl {
       }
       version = ++version_;
     }
+    RecordQueueingDelay(options.priority,
+                        tensorflow::EnvTime::NowMicros() - wait_start_us);
     RecomputePoolStats(num_active_requests, version, *thread_work_sources);
     return std::unique_ptr<RunHandler>(new RunHandler(handler_impl));
   }
@@ -910,6 +973,17 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // A request waiting in Get() for a handler.
+  struct HandlerWaiter {
+    // Called by Await() with `mu_` held.
+    bool Ready() TF_NO_THREAD_SAFETY_ANALYSIS {
+      return pool->can_acquire_handler(priority);
+    }
+
+    Impl* pool;
+    int priority;
+  };
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -929,6 +1003,8 @@ class RunHandlerPool::Impl {
   std::list<RunHandler::Impl*> sorted_active_handlers_ TF_GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ TF_GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ TF_GUARDED_BY(mu_);
+  // The number of requests waiting for a handler, by decreasing priority.
+  std::map<int, int, std::greater<int>> waiting_priorities_ TF_GUARDED_BY(mu_);
 
   // Histogram of elapsed runtime of every handler (in ms).
   tensorflow::histogram::Histogram time_hist_ TF_GUARDED_BY(mu_);
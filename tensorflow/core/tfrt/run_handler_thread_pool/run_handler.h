@@ -44,10 +44,16 @@ class RunHandler;
 
 // Options for RunHanler.
 struct RunHandlerOptions {
-  RunHandlerOptions() : priority(0) {}
+  RunHandlerOptions() : priority(0), deadline_us(0) {}
 
-  // Request priority.
+  // Request priority. When no handler is free, the waiting request with the
+  // highest priority gets the next handler released to the pool.
   int priority;
+
+  // If non-zero, the time (in microseconds since the epoch, as returned by
+  // tensorflow::EnvTime::NowMicros()) after which the request is dropped if it
+  // didn't get a handler yet.
+  int64_t deadline_us;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -119,7 +125,10 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
+  // Will block unless there is an inactive handler, and while there are
+  // requests with a higher priority waiting for one. Returns null if
+  // `timeout_in_ms` is non-zero and no handler was available within it, or if
+  // the deadline of `options` expired before a handler was available.
   std::unique_ptr<RunHandler> Get(
       int64_t step_id = 0, int64_t timeout_in_ms = 0,
       const RunHandlerOptions& options = RunHandlerOptions());
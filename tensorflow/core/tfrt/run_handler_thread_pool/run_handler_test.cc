@@ -119,6 +119,58 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, HigherPriorityWaiterGetsReleasedHandler) {
+  RunHandlerPool::Options pool_options;
+  pool_options.max_concurrent_handler = 1;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options;
+  auto handler = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  ASSERT_TRUE(handler);
+
+  tensorflow::mutex mu;
+  std::vector<int> acquired_priorities;
+  auto get_handler = [&](int step_id, int priority) {
+    RunHandlerOptions waiter_options;
+    waiter_options.priority = priority;
+    auto waiter_handler = pool->Get(step_id, /*timeout_in_ms=*/0,
+                                    waiter_options);
+    ASSERT_TRUE(waiter_handler);
+    tensorflow::mutex_lock l(mu);
+    acquired_priorities.push_back(priority);
+  };
+  {
+    tensorflow::thread::ThreadPool test_pool(tensorflow::Env::Default(),
+                                             "test", /*num_threads=*/2);
+    // The low priority request starts waiting first.
+    test_pool.Schedule([&]() { get_handler(/*step_id=*/2, /*priority=*/1); });
+    tensorflow::Env::Default()->SleepForMicroseconds(100 * 1000);
+    test_pool.Schedule([&]() { get_handler(/*step_id=*/3, /*priority=*/2); });
+    tensorflow::Env::Default()->SleepForMicroseconds(100 * 1000);
+    handler.reset();
+  }
+  EXPECT_EQ(acquired_priorities, std::vector<int>({2, 1}));
+}
+
+TEST(RunHandlerUtilTest, ExpiredRequestIsDropped) {
+  RunHandlerPool::Options pool_options;
+  pool_options.max_concurrent_handler = 1;
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  // The deadline already expired, even though a handler is free.
+  RunHandlerOptions options;
+  options.deadline_us = tensorflow::EnvTime::NowMicros() - 1;
+  EXPECT_FALSE(pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options));
+
+  options.deadline_us = 0;
+  auto handler = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  ASSERT_TRUE(handler);
+
+  // The deadline expires while waiting for the handler.
+  options.deadline_us = tensorflow::EnvTime::NowMicros() + 50 * 1000;
+  EXPECT_FALSE(pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options));
+}
+
 TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   int num_threads = 2;
   RunHandlerPool::Options pool_options;
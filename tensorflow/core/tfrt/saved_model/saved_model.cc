@@ -26,7 +26,6 @@ limitations under the License.
 #include <vector>
 
 #include "learning/brain/experimental/tfrt/native_lowering/kernels/math_kernels.h"
-#include "absl/cleanup/cleanup.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
@@ -46,6 +45,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -135,6 +135,20 @@ auto* saved_model_init_time_seconds =
         "/tensorflow/tfrt/saved_model/init_time",
         "Record the initialization time for the savedmodel.", "model_name");
 
+auto* saved_model_signature_load_time_milli_seconds =
+    tensorflow::monitoring::Gauge<int64_t, 2>::New(
+        "/tensorflow/tfrt/saved_model/signature_load_time",
+        "Record the time of lazily loading a signature (or a combination of "
+        "signatures) of the savedmodel.",
+        "model_name", "signature_name");
+
+auto* saved_model_signature_ready =
+    tensorflow::monitoring::Gauge<bool, 2>::New(
+        "/tensorflow/tfrt/saved_model/signature_ready",
+        "Record whether a lazily loaded signature (or a combination of "
+        "signatures) of the savedmodel is loaded and ready to run.",
+        "model_name", "signature_name");
+
 // TODO(b/279197040) clean up this retention after input spec validation is
 // enabled everywhere.
 auto* saved_model_input_spec_validation_failure =
@@ -747,7 +761,21 @@ SavedModelImpl::SavedModelImpl(
       fallback_state_(std::move(fallback_state)),
       runner_table_(std::move(runner_table)),
       resource_array_(std::move(resource_array)),
-      graph_executor_(std::move(graph_executor)) {}
+      graph_executor_(std::move(graph_executor)) {
+  if (options_.enable_lazy_loading &&
+      !options_.lazy_loading_use_graph_executor &&
+      !options_.lazy_loading_warmup_signatures.empty()) {
+    warmup_thread_.reset(tensorflow::Env::Default()->StartThread(
+        tensorflow::ThreadOptions(), "tfrt_saved_model_warmup",
+        [this]() { WarmUpLazyLoadingSignatures(); }));
+  }
+}
+
+SavedModelImpl::~SavedModelImpl() {
+  // Stops the warmup after the signature being loaded, if any.
+  cancel_warmup_ = true;
+  warmup_thread_.reset();
+}
 
 std::vector<std::string> SavedModelImpl::GetFunctionNames() const {
   std::vector<std::string> result;
@@ -1103,13 +1131,34 @@ SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
       JoinSignatures(names, signatures_, meta_graph_def_.signature_def()));
 
   LOG(INFO) << "TFRT loading joined signature " << joined_signature.name;
-  absl::Cleanup log_finish([&joined_signature, start_time = absl::Now()]() {
-    LOG(INFO) << "TFRT finished loading joined signature "
-              << joined_signature.name << ". Took "
-              << absl::ToInt64Milliseconds(absl::Now() - start_time) << " ms.";
-  });
+  const auto start_time = absl::Now();
+  auto loading_result = LoadJoinedSignature(joined_signature);
+  const auto load_duration = absl::Now() - start_time;
+  LOG(INFO) << "TFRT finished loading joined signature "
+            << joined_signature.name << ". Took "
+            << absl::ToInt64Milliseconds(load_duration) << " ms.";
+  if (loading_result.ok()) {
+    const auto& model_name =
+        options_.graph_execution_options.model_metadata.name();
+    saved_model_signature_load_time_milli_seconds
+        ->GetCell(model_name, joined_signature.name)
+        ->Set(absl::ToInt64Milliseconds(load_duration));
+    saved_model_signature_ready->GetCell(model_name, joined_signature.name)
+        ->Set(true);
+  }
+  return loading_result;
+}
 
-  return LoadJoinedSignature(joined_signature);
+void SavedModelImpl::WarmUpLazyLoadingSignatures() {
+  const RunOptions run_options;
+  for (const auto& name : options_.lazy_loading_warmup_signatures) {
+    if (cancel_warmup_) return;
+    const auto loading_result = GetOrCreateLoadingResult(run_options, {name});
+    if (!loading_result.ok()) {
+      LOG(WARNING) << "TFRT failed to warm up signature " << name << ": "
+                   << loading_result.status();
+    }
+  }
 }
 
 }  // namespace tfrt_stub
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 #define TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <limits>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -130,6 +132,13 @@ class SavedModel {
     // TODO(b/216379787): Remove this option once b/279197040 is unblocked.
     bool lazy_loading_use_graph_executor = false;
 
+    // If lazy loading is enabled, the signatures listed here are loaded in the
+    // background, one after the other in the given order, once the saved model
+    // is loaded, so that their first invocation doesn't have to wait for their
+    // compilation. The other signatures are still loaded on first use. It has
+    // no effect if `lazy_loading_use_graph_executor` is true.
+    std::vector<std::string> lazy_loading_warmup_signatures;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -235,7 +244,7 @@ class SavedModelImpl final : public SavedModel {
       std::unique_ptr<tfd::FallbackResourceArray> resource_array,
       std::unique_ptr<GraphExecutor> graph_executor);
 
-  ~SavedModelImpl() override = default;
+  ~SavedModelImpl() override;
 
   SavedModelImpl(const SavedModelImpl&) = delete;
   SavedModelImpl& operator=(const SavedModelImpl&) = delete;
@@ -295,6 +304,10 @@ class SavedModelImpl final : public SavedModel {
                            absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Loads the signatures in `options_.lazy_loading_warmup_signatures`, until
+  // `cancel_warmup_` is set.
+  void WarmUpLazyLoadingSignatures();
+
   SymbolUids symbol_uids_;
   // `meta_graph_def_` only contains metadata of the model. The graph_def field
   // is removed.
@@ -321,6 +334,10 @@ class SavedModelImpl final : public SavedModel {
                       std::unique_ptr<LoadingResult>>
       loading_result_cache_ TF_GUARDED_BY(loading_result_cache_mu_);
   std::unique_ptr<GraphExecutor> graph_executor_;
+  // The thread running `WarmUpLazyLoadingSignatures()`, if any. It is the last
+  // member so that it is joined before the states it uses are destroyed.
+  std::atomic<bool> cancel_warmup_{false};
+  std::unique_ptr<tensorflow::Thread> warmup_thread_;
 };
 
 class SavedModelMiraImpl;
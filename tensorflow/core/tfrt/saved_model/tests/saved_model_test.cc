@@ -23,6 +23,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
@@ -1084,6 +1085,48 @@ TEST(SavedModelTest, DisableCompilation) {
   TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
 }
 
+TEST(SavedModelTest, LazyLoadingWarmup) {
+  // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
+  // using the following python code:
+  //  x = tf.placeholder(tf.int32, shape=(3))
+  //  y = tf.compat.v1.get_variable(name='y', initializer=[1, 2, 3])
+  //  r = tf.matmul(x, y)
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.lazy_loading_warmup_signatures = {"toy"};
+
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_CHECK_OK(saved_model.status());
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+
+  std::vector<tensorflow::Tensor> outputs;
+
+  // The signature is loaded in the background, so it eventually runs without
+  // being compiled by `Run()`.
+  tfrt::SavedModel::RunOptions run_options;
+  run_options.disable_compilation = true;
+  tensorflow::Status status;
+  for (int i = 0; i < 600; ++i) {
+    status = (*saved_model)->Run(run_options, "toy", inputs, &outputs);
+    if (status.ok()) break;
+    tensorflow::Env::Default()->SleepForMicroseconds(100 * 1000);
+  }
+  TF_ASSERT_OK(status);
+  ASSERT_EQ(outputs.size(), 1);
+
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+}
+
 TEST(SavedModelTest, CustomModelConfig) {
   // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
   // using the following python code:
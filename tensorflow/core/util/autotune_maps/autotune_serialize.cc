@@ -16,16 +16,24 @@ limitations under the License.
 // For Google-internal use only.
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include <cstdlib>
 #include <map>
+#include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/stream_executor/dnn.h"
 #include "tensorflow/compiler/xla/stream_executor/dnn.pb.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/str_util.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
@@ -169,16 +177,100 @@ Status PopulateConvMap(
   return OkStatus();
 }
 
+StatusOr<AutotuneMapsProto> AutotuneMapsToProto() {
+  AutotuneMapsProto proto;
+  TF_ASSIGN_OR_RETURN(*proto.mutable_conv_map(),
+                      ConvMapToProto(*ConvAutotuneMap::GetInstance()));
+  TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
+                      ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+  return proto;
+}
+
+Status PopulateAutotuneMaps(const AutotuneMapsProto &proto) {
+  TF_RETURN_IF_ERROR(
+      PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
+  TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
+                                     FusedConvAutotuneMap::GetInstance()));
+  // TODO(b/189530096): Populate autotune maps for more ops.
+  return OkStatus();
+}
+
+// Adds the entries of `from` whose key isn't in `to` to `to`.
+Status MergeConvMap(const ConvMapProto &from, ConvMapProto *to) {
+  std::set<std::string> keys;
+  std::string serialized_key;
+  for (const ConvMapProto::Entry &kv : to->kv_pairs()) {
+    TF_RET_CHECK(
+        tsl::SerializeToStringDeterministic(kv.key(), &serialized_key));
+    keys.insert(serialized_key);
+  }
+  for (const ConvMapProto::Entry &kv : from.kv_pairs()) {
+    TF_RET_CHECK(
+        tsl::SerializeToStringDeterministic(kv.key(), &serialized_key));
+    if (keys.insert(serialized_key).second) {
+      *to->add_kv_pairs() = kv;
+    }
+  }
+  return OkStatus();
+}
+
+std::optional<se::dnn::VersionInfo> LookUpDnnVersion() {
+  StatusOr<se::Platform *> platform =
+      se::MultiPlatformManager::PlatformWithName(se::GpuPlatformName());
+  if (!platform.ok() || (*platform)->VisibleDeviceCount() == 0) {
+    return std::nullopt;
+  }
+  StatusOr<se::StreamExecutor *> executor = (*platform)->ExecutorForDevice(0);
+  if (!executor.ok() || (*executor)->AsDnn() == nullptr) {
+    return std::nullopt;
+  }
+  StatusOr<se::dnn::VersionInfo> version = (*executor)->AsDnn()->GetVersion();
+  if (!version.ok()) return std::nullopt;
+  return *version;
+}
+
+// Returns the version of the DNN library of the GPUs, or nullopt if it isn't
+// known. The version is only looked up by the first call, so that later calls
+// don't need the GPU platform, e.g. while the process exits.
+const std::optional<se::dnn::VersionInfo> &GetDnnVersion() {
+  static const auto *const version =
+      new std::optional<se::dnn::VersionInfo>(LookUpDnnVersion());
+  return *version;
+}
+
+bool HasDnnVersion(const AutotuneMapsProto &proto,
+                   const std::optional<se::dnn::VersionInfo> &version) {
+  if (!version.has_value()) return !proto.has_dnn_version();
+  return proto.has_dnn_version() &&
+         se::dnn::VersionInfo(proto.dnn_version()).as_tuple() ==
+             version->as_tuple();
+}
+
+bool IsTextProtoFile(const std::string &path) {
+  return absl::EndsWith(path, ".pbtxt") || absl::EndsWith(path, ".txt");
+}
+
+Status ReadAutotuneMapsFile(const std::string &path, AutotuneMapsProto *proto) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(Env::Default(), path, &contents));
+  const bool parsed =
+      IsTextProtoFile(path)
+          ? protobuf::TextFormat::ParseFromString(contents, proto)
+          : proto->ParseFromString(contents);
+  if (!parsed) {
+    return errors::InvalidArgument("Failed to parse the autotune maps from ",
+                                   path);
+  }
+  return OkStatus();
+}
+
 }  // namespace
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
 Status SerializeAutotuneMaps(std::string *output) {
   AutotuneMapsProto proto;
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
-  TF_ASSIGN_OR_RETURN(*proto.mutable_conv_map(),
-                      ConvMapToProto(*ConvAutotuneMap::GetInstance()));
-  TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
-                      ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
+  TF_ASSIGN_OR_RETURN(proto, AutotuneMapsToProto());
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return OkStatus();
@@ -194,15 +286,94 @@ Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
-  TF_RETURN_IF_ERROR(
-      PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
-  TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
-                                     FusedConvAutotuneMap::GetInstance()));
-  // TODO(b/189530096): Populate autotune maps for more ops.
+  TF_RETURN_IF_ERROR(PopulateAutotuneMaps(proto));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   return OkStatus();
 }
 
+Status LoadAutotuneMapsFromFile(const std::string &path) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  AutotuneMapsProto proto;
+  TF_RETURN_IF_ERROR(ReadAutotuneMapsFile(path, &proto));
+  if (!HasDnnVersion(proto, GetDnnVersion())) {
+    return errors::Aborted(
+        "Aborted because the autotune maps in ", path,
+        " were autotuned with a different version of the DNN library.");
+  }
+  return PopulateAutotuneMaps(proto);
+#else
+  return errors::Unimplemented(
+      "Autotune maps are only supported in GPU builds.");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+Status SaveAutotuneMapsToFile(const std::string &path) {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  TF_ASSIGN_OR_RETURN(AutotuneMapsProto proto, AutotuneMapsToProto());
+  const std::optional<se::dnn::VersionInfo> &version = GetDnnVersion();
+  if (version.has_value()) {
+    *proto.mutable_dnn_version() = version->ToProto();
+  }
+
+  // Keeps the entries of the file, unless they are for another version of the
+  // DNN library.
+  Env *env = Env::Default();
+  if (env->FileExists(path).ok()) {
+    AutotuneMapsProto file_proto;
+    Status status = ReadAutotuneMapsFile(path, &file_proto);
+    if (!status.ok()) {
+      LOG(WARNING) << "Overwriting the autotune maps in " << path << ": "
+                   << status;
+    } else if (HasDnnVersion(file_proto, version)) {
+      TF_RETURN_IF_ERROR(
+          MergeConvMap(file_proto.conv_map(), proto.mutable_conv_map()));
+      TF_RETURN_IF_ERROR(MergeConvMap(file_proto.fused_conv_map(),
+                                      proto.mutable_fused_conv_map()));
+    }
+  }
+
+  std::string contents;
+  if (IsTextProtoFile(path)) {
+    TF_RET_CHECK(protobuf::TextFormat::PrintToString(proto, &contents));
+  } else {
+    TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, &contents));
+  }
+  // Writes to a temporary file first, so that other processes never read a
+  // partially written file.
+  const std::string tmp_path =
+      strings::StrCat(path, ".tmp.", env->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, contents));
+  return env->RenameFile(tmp_path, path);
+#else
+  return errors::Unimplemented(
+      "Autotune maps are only supported in GPU builds.");
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+void InitAutotuneMapsFromEnv() {
+  static const bool initialized = []() {
+    const char *path = std::getenv("TF_AUTOTUNE_MAPS_FILE");
+    if (path == nullptr || *path == '\0') return true;
+    static const std::string *const maps_path = new std::string(path);
+    if (Env::Default()->FileExists(*maps_path).ok()) {
+      Status status = LoadAutotuneMapsFromFile(*maps_path);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to load the autotune maps from " << *maps_path
+                     << ": " << status;
+      }
+    }
+    std::atexit([]() {
+      Status status = SaveAutotuneMapsToFile(*maps_path);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to save the autotune maps to " << *maps_path
+                     << ": " << status;
+      }
+    });
+    return true;
+  }();
+  (void)initialized;
+}
+
 void ResetAutotuneMaps() {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
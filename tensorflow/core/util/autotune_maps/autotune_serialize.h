@@ -40,6 +40,24 @@ Status LoadSerializedAutotuneMaps(absl::string_view s);
 // LoadSerializedAutotuneMaps.
 Status SerializeAutotuneMaps(std::string* output);
 
+// Loads the autotune maps from the file `path`, as written by
+// SaveAutotuneMapsToFile, and uses them to update the runtime autotune maps.
+// Files whose name ends in ".pbtxt" or ".txt" hold a text proto, other files a
+// binary one. The maps aren't loaded if they were autotuned with a different
+// version of the DNN library.
+Status LoadAutotuneMapsFromFile(const std::string &path);
+
+// Writes all the autotune maps to the file `path`, merged with the ones already
+// in it, if any. The entries of the runtime maps replace the ones of the file,
+// and the other entries of the file, e.g. those of other GPU models, are kept.
+Status SaveAutotuneMapsToFile(const std::string &path);
+
+// If the TF_AUTOTUNE_MAPS_FILE environment variable is set, loads the autotune
+// maps from that file, if it exists, and saves them back to it with
+// SaveAutotuneMapsToFile when the process exits. This persists the autotune
+// results across the restarts of a job. Only the first call has an effect.
+void InitAutotuneMapsFromEnv();
+
 // Resets all autotune maps. For test use only.
 void ResetAutotuneMaps();
 
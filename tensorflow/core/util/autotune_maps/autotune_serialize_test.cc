@@ -18,9 +18,11 @@ limitations under the License.
 
 #include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/types/variant.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_driver.h"
 #include "tensorflow/compiler/xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
@@ -182,6 +184,63 @@ TEST(AutotuneSerializeTest, VersionControl) {
                HasSubstr("Aborted because the loaded autotune results")));
   EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 0);
 }
+
+// Tests that SaveAutotuneMapsToFile keeps the entries already in the file, and
+// that LoadAutotuneMapsFromFile loads all of them back.
+TEST(AutotuneSerializeTest, SaveAndLoadFile) {
+  TF_CHECK_OK(GpuDriver::Init());
+  for (const char* extension : {".pb", ".pbtxt"}) {
+    const std::string path = io::JoinPath(
+        testing::TmpDir(), absl::StrCat("autotune_maps", extension));
+    ResetAutotuneMaps();
+    ConvParameters conv_params_example_a = {
+        GetStreamExec(),
+        /*batch=*/1,
+        /*in_depths=*/1,
+        /*in=*/{{1, 1}},
+        /*data_format=*/TensorFormat::FORMAT_NCHW,
+        /*out_depths=*/1,
+        /*filter=*/{{1, 1}},
+        /*dilation=*/{{1, 1}},
+        /*stride=*/{{1, 1}},
+        /*padding=*/{{1, 1}},
+        /*dtype=*/DataType::DT_INT8,
+        /*group_count=*/1};
+    ConvParameters conv_params_example_b = {
+        GetStreamExec(),
+        /*batch=*/2,
+        /*in_depths=*/1,
+        /*in=*/{{1, 1}},
+        /*data_format=*/TensorFormat::FORMAT_NCHW,
+        /*out_depths=*/1,
+        /*filter=*/{{1, 1}},
+        /*dilation=*/{{1, 1}},
+        /*stride=*/{{1, 1}},
+        /*padding=*/{{1, 1}},
+        /*dtype=*/DataType::DT_INT8,
+        /*group_count=*/1};
+    AlgorithmDesc algorithm(/*algo_id=*/1, /*use_tensor_ops=*/true);
+    AutotuneEntry<se::dnn::ConvOp> example_a(algorithm, absl::nullopt);
+
+    // Simulates two processes, each autotuning a different convolution.
+    ConvAutotuneMap::GetInstance()->Insert(conv_params_example_a, example_a);
+    TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+    ResetAutotuneMaps();
+    ConvAutotuneMap::GetInstance()->Insert(conv_params_example_b, example_a);
+    TF_CHECK_OK(SaveAutotuneMapsToFile(path));
+
+    ResetAutotuneMaps();
+    TF_CHECK_OK(LoadAutotuneMapsFromFile(path));
+    EXPECT_EQ(ConvAutotuneMap::GetInstance()->GetMap().size(), 2);
+    AutotuneEntry<se::dnn::ConvOp> entry;
+    EXPECT_TRUE(
+        ConvAutotuneMap::GetInstance()->Find(conv_params_example_a, &entry));
+    EXPECT_EQ(entry, example_a);
+    EXPECT_TRUE(
+        ConvAutotuneMap::GetInstance()->Find(conv_params_example_b, &entry));
+    EXPECT_EQ(entry, example_a);
+  }
+}
 }  // namespace
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
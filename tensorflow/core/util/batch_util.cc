@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -45,6 +47,25 @@ Status ValidateInput(const Tensor& parent, const Tensor& element,
   return OkStatus();
 }
 
+// A buffer aliasing memory owned by the buffer of `base`, which it keeps
+// alive.
+class AliasedBuffer : public TensorBuffer {
+ public:
+  AliasedBuffer(Tensor base, void* data, size_t size)
+      : TensorBuffer(data), base_(std::move(base)), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const Tensor base_;
+  const size_t size_;
+};
+
 template <typename T>
 Status HandleElementToSlice(const Tensor& /* element */, T* src, T* dest,
                             int64_t num_values) {
@@ -415,5 +436,35 @@ Status SetElementZero(Tensor* element, const Tensor& padding) {
                                element->dtype());
 }
 
+bool MaybeBatchWithoutCopy(const std::vector<Tensor>& elements, Tensor* batch) {
+  if (elements.empty()) return false;
+  const Tensor& first = elements[0];
+  TensorShape batch_shape({static_cast<int64_t>(elements.size())});
+  batch_shape.AppendShape(first.shape());
+  if (elements.size() == 1) {
+    return batch->CopyFrom(first, batch_shape);
+  }
+  // Only check adjacency for memcpy-able types: for other types the slices
+  // hold objects that must not be aliased by two batches.
+  if (!DataTypeCanUseMemcpy(first.dtype()) || first.NumElements() == 0) {
+    return false;
+  }
+  const size_t element_bytes = first.TotalBytes();
+  const char* base = first.tensor_data().data();
+  for (size_t i = 1; i < elements.size(); ++i) {
+    const Tensor& element = elements[i];
+    if (element.dtype() != first.dtype() || element.shape() != first.shape() ||
+        !element.SharesBufferWith(first) ||
+        element.tensor_data().data() != base + i * element_bytes) {
+      return false;
+    }
+  }
+  *batch = Tensor(first.dtype(), batch_shape,
+                  core::RefCountPtr<TensorBuffer>(new AliasedBuffer(
+                      first, const_cast<char*>(base),
+                      element_bytes * elements.size())));
+  return true;
+}
+
 }  // namespace batch_util
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_BATCH_UTIL_H_
 #define TENSORFLOW_CORE_UTIL_BATCH_UTIL_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 
@@ -60,6 +62,17 @@ Status SetElementZero(Tensor* element, const Tensor& padding);
 Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
                                 int index);
 
+// Sets `*batch` to a tensor of shape `[elements.size()] + elements[0].shape()`
+// aliasing the memory of `elements` instead of copying it, if possible, and
+// returns whether it did. This is possible when there is a single element, or
+// when the elements are adjacent slices of one buffer, in order (e.g. rows of
+// a tensor returned by `Tensor::Slice()`). All elements must have the same
+// shape and dtype.
+//
+// A batch aliasing several elements doesn't own its memory, so it is never
+// forwarded and overwritten by a consumer op.
+bool MaybeBatchWithoutCopy(const std::vector<Tensor>& elements, Tensor* batch);
+
 }  // namespace batch_util
 }  // namespace tensorflow
 
@@ -0,0 +1,68 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/batch_util.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace batch_util {
+namespace {
+
+TEST(BatchUtilTest, BatchesSingleElementWithoutCopy) {
+  Tensor element = test::AsTensor<tstring>({"a", "b"}, {2});
+  Tensor batch;
+  ASSERT_TRUE(MaybeBatchWithoutCopy({element}, &batch));
+  EXPECT_TRUE(batch.SharesBufferWith(element));
+  test::ExpectTensorEqual<tstring>(
+      batch, test::AsTensor<tstring>({"a", "b"}, {1, 2}));
+}
+
+TEST(BatchUtilTest, BatchesAdjacentSlicesWithoutCopy) {
+  Tensor rows = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+  std::vector<Tensor> elements;
+  for (int i = 0; i < 3; ++i) {
+    elements.push_back(rows.SubSlice(i));
+  }
+  Tensor batch;
+  ASSERT_TRUE(MaybeBatchWithoutCopy(elements, &batch));
+  EXPECT_EQ(batch.tensor_data().data(), rows.tensor_data().data());
+  test::ExpectTensorEqual<float>(batch, rows);
+
+  // The batch keeps the memory alive, and doesn't allow it to be forwarded.
+  rows = Tensor();
+  elements.clear();
+  EXPECT_FALSE(batch.RefCountIsOne());
+  test::ExpectTensorEqual<float>(
+      batch, test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2}));
+}
+
+TEST(BatchUtilTest, CopiesNonAdjacentElements) {
+  Tensor rows = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+  Tensor batch;
+  EXPECT_FALSE(
+      MaybeBatchWithoutCopy({rows.SubSlice(0), rows.SubSlice(2)}, &batch));
+  EXPECT_FALSE(
+      MaybeBatchWithoutCopy({rows.SubSlice(1), rows.SubSlice(0)}, &batch));
+  EXPECT_FALSE(MaybeBatchWithoutCopy(
+      {test::AsTensor<float>({1, 2}), test::AsTensor<float>({3, 4})}, &batch));
+}
+
+}  // namespace
+}  // namespace batch_util
+}  // namespace tensorflow
@@ -36,15 +36,37 @@ EventsWriter::EventsWriter(const string& file_prefix)
     // TODO(jeff,sanjay): Pass in env and use that here instead of Env::Default
     : env_(Env::Default()),
       file_prefix_(file_prefix),
-      num_outstanding_events_(0) {}
+      num_outstanding_events_(0),
+      async_(false) {}
+
+EventsWriter::EventsWriter(const string& file_prefix,
+                           const AsyncOptions& options)
+    : env_(Env::Default()),
+      file_prefix_(file_prefix),
+      num_outstanding_events_(0),
+      async_(true),
+      async_options_(options) {
+  writer_thread_.reset(env_->StartThread(ThreadOptions(), "events_writer",
+                                         [this]() { WriterLoop(); }));
+}
 
 EventsWriter::~EventsWriter() {
+  if (async_) {
+    {
+      mutex_lock l(queue_mu_);
+      cancelled_ = true;
+    }
+    queue_cv_.notify_all();
+    // Joins the thread, which writes the remaining queued events first.
+    writer_thread_.reset();
+  }
   Close().IgnoreError();  // Autoclose in destructor.
 }
 
 Status EventsWriter::Init() { return InitWithSuffix(""); }
 
 Status EventsWriter::InitWithSuffix(const string& suffix) {
+  mutex_lock l(file_mu_);
   file_suffix_ = suffix;
   return InitIfNeeded();
 }
@@ -93,13 +115,14 @@ Status EventsWriter::InitIfNeeded() {
     event.set_file_version(strings::StrCat(kVersionPrefix, kCurrentVersion));
     SourceMetadata* source_metadata = event.mutable_source_metadata();
     source_metadata->set_writer(kWriterSourceMetadata);
-    WriteEvent(event);
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(Flush(), "Flushing first event.");
+    WriteSerializedEventLocked(event.SerializeAsString());
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(FlushLocked(), "Flushing first event.");
   }
   return OkStatus();
 }
 
 string EventsWriter::FileName() {
+  mutex_lock l(file_mu_);
   if (filename_.empty()) {
     InitIfNeeded().IgnoreError();
   }
@@ -107,6 +130,32 @@ string EventsWriter::FileName() {
 }
 
 void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
+  if (!async_) {
+    mutex_lock l(file_mu_);
+    WriteSerializedEventLocked(event_str);
+    return;
+  }
+  const size_t max_queued_events = async_options_.max_queued_events;
+  {
+    mutex_lock l(queue_mu_);
+    if (queue_.size() >= max_queued_events) {
+      if (async_options_.drop_events_when_full) {
+        if (num_dropped_events_++ == 0) {
+          LOG(WARNING) << "Dropping events for " << file_prefix_
+                       << " because the write queue is full.";
+        }
+        return;
+      }
+      while (queue_.size() >= max_queued_events && !cancelled_) {
+        queue_cv_.wait(l);
+      }
+    }
+    queue_.emplace_back(event_str);
+  }
+  queue_cv_.notify_all();
+}
+
+void EventsWriter::WriteSerializedEventLocked(StringPiece event_str) {
   if (recordio_writer_ == nullptr) {
     if (!InitIfNeeded().ok()) {
       LOG(ERROR) << "Write failed because file could not be opened.";
@@ -125,7 +174,81 @@ void EventsWriter::WriteEvent(const Event& event) {
   WriteSerializedEvent(record);
 }
 
+void EventsWriter::WriterLoop() {
+  std::deque<std::string> batch;
+  while (true) {
+    int64_t flush_id;
+    bool flush;
+    bool cancelled;
+    {
+      mutex_lock l(queue_mu_);
+      while (queue_.empty() && flushes_done_ == flushes_requested_ &&
+             !cancelled_) {
+        queue_cv_.wait(l);
+      }
+      batch.swap(queue_);
+      flush_id = flushes_requested_;
+      flush = flushes_requested_ > flushes_done_;
+      cancelled = cancelled_;
+    }
+    // Wakes up writers blocked on a full queue.
+    queue_cv_.notify_all();
+    Status flush_status;
+    {
+      mutex_lock l(file_mu_);
+      for (const std::string& event_str : batch) {
+        WriteSerializedEventLocked(event_str);
+      }
+      if (flush) {
+        flush_status = FlushLocked();
+      }
+    }
+    batch.clear();
+    {
+      mutex_lock l(queue_mu_);
+      if (flush) {
+        flushes_done_ = flush_id;
+        last_flush_status_ = flush_status;
+      }
+    }
+    queue_cv_.notify_all();
+    if (cancelled) return;
+  }
+}
+
 Status EventsWriter::Flush() {
+  if (!async_) {
+    mutex_lock l(file_mu_);
+    return FlushLocked();
+  }
+  mutex_lock l(queue_mu_);
+  if (cancelled_) return OkStatus();
+  const int64_t flush_id = ++flushes_requested_;
+  queue_cv_.notify_all();
+  while (flushes_done_ < flush_id) {
+    queue_cv_.wait(l);
+  }
+  return last_flush_status_;
+}
+
+void EventsWriter::RequestFlush() {
+  if (!async_) {
+    Flush().IgnoreError();
+    return;
+  }
+  {
+    mutex_lock l(queue_mu_);
+    ++flushes_requested_;
+  }
+  queue_cv_.notify_all();
+}
+
+int64_t EventsWriter::num_dropped_events() const {
+  mutex_lock l(queue_mu_);
+  return num_dropped_events_;
+}
+
+Status EventsWriter::FlushLocked() {
   if (num_outstanding_events_ == 0) return OkStatus();
   CHECK(recordio_file_ != nullptr) << "Unexpected NULL file";
 
@@ -142,6 +265,11 @@ Status EventsWriter::Flush() {
 
 Status EventsWriter::Close() {
   Status status = Flush();
+  mutex_lock l(file_mu_);
+  if (async_ && writer_thread_ == nullptr) {
+    // The background thread is gone, so flush what it wrote here.
+    status = FlushLocked();
+  }
   if (recordio_file_ != nullptr) {
     Status close_status = recordio_file_->Close();
     if (!close_status.ok()) {
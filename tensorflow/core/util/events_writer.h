@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_EVENTS_WRITER_H_
 #define TENSORFLOW_CORE_UTIL_EVENTS_WRITER_H_
 
+#include <deque>
 #include <memory>
 #include <string>
 
@@ -23,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/event.pb.h"
 
@@ -47,6 +50,21 @@ class EventsWriter {
   // Note that it is not recommended to simultaneously have two
   // EventWriters writing to the same file_prefix.
   explicit EventsWriter(const std::string& file_prefix);
+
+  // Options for writing events from a background thread, so that callers
+  // don't wait on the filesystem.
+  struct AsyncOptions {
+    // Maximum number of events queued for the background thread.
+    int64_t max_queued_events = 1024;
+    // If true, events written while the queue is full are dropped and
+    // counted in `num_dropped_events()`. Otherwise the writes block until
+    // the background thread catches up.
+    bool drop_events_when_full = false;
+  };
+
+  // Creates a writer whose Write*() calls only enqueue the event. A
+  // background thread appends queued events to the file in batches.
+  EventsWriter(const std::string& file_prefix, const AsyncOptions& options);
   ~EventsWriter();
 
   // Sets the event file filename and opens file for writing.  If not called by
@@ -78,20 +96,51 @@ class EventsWriter {
   // be written too.
   //   Close() calls Flush() and then closes the current events file.
   // Returns true only if both the flush and the closure were successful.
+  // With `AsyncOptions`, Flush() waits for the events written before the
+  // call to reach the file.
   Status Flush();
   Status Close();
 
+  // With `AsyncOptions`, asks the background thread to flush the events
+  // written so far, without waiting for it. Otherwise same as Flush().
+  void RequestFlush();
+
+  // Number of events dropped because the async queue was full.
+  int64_t num_dropped_events() const;
+
  private:
-  Status FileStillExists();  // OK if event_file_path_ exists.
-  Status InitIfNeeded();
+  // OK if event_file_path_ exists.
+  Status FileStillExists() TF_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  Status InitIfNeeded() TF_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  void WriteSerializedEventLocked(StringPiece event_str)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  Status FlushLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(file_mu_);
+  // Body of the background thread: appends queued events and runs the
+  // requested flushes until the writer is destroyed.
+  void WriterLoop();
 
   Env* env_;
   const std::string file_prefix_;
-  std::string file_suffix_;
-  std::string filename_;
-  std::unique_ptr<WritableFile> recordio_file_;
-  std::unique_ptr<io::RecordWriter> recordio_writer_;
-  int num_outstanding_events_;
+  mutex file_mu_;
+  std::string file_suffix_ TF_GUARDED_BY(file_mu_);
+  std::string filename_ TF_GUARDED_BY(file_mu_);
+  std::unique_ptr<WritableFile> recordio_file_ TF_GUARDED_BY(file_mu_);
+  std::unique_ptr<io::RecordWriter> recordio_writer_ TF_GUARDED_BY(file_mu_);
+  int num_outstanding_events_ TF_GUARDED_BY(file_mu_);
+
+  // State shared with the background thread, if there is one.
+  const bool async_;
+  const AsyncOptions async_options_;
+  mutable mutex queue_mu_;
+  condition_variable queue_cv_;
+  std::deque<std::string> queue_ TF_GUARDED_BY(queue_mu_);
+  // Flushes are numbered; the background thread runs them in order.
+  int64_t flushes_requested_ TF_GUARDED_BY(queue_mu_) = 0;
+  int64_t flushes_done_ TF_GUARDED_BY(queue_mu_) = 0;
+  Status last_flush_status_ TF_GUARDED_BY(queue_mu_);
+  int64_t num_dropped_events_ TF_GUARDED_BY(queue_mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(queue_mu_) = false;
+  std::unique_ptr<Thread> writer_thread_;
   TF_DISALLOW_COPY_AND_ASSIGN(EventsWriter);
 };
 
@@ -209,5 +209,47 @@ TEST(EventWriter, FileDeletionBeforeWriting) {
   VerifyFile(filename1);
 }
 
+TEST(EventWriter, AsyncWriteFlush) {
+  string file_prefix = GetDirName("/asyncwriteflush_test");
+  EventsWriter writer(file_prefix, EventsWriter::AsyncOptions());
+  WriteFile(&writer);
+  TF_EXPECT_OK(writer.Flush());
+  string filename = writer.FileName();
+  VerifyFile(filename);
+}
+
+TEST(EventWriter, AsyncWriteDelete) {
+  string file_prefix = GetDirName("/asyncwritedelete_test");
+  EventsWriter::AsyncOptions options;
+  // Writers block until the background thread has made room.
+  options.max_queued_events = 1;
+  auto writer = std::make_unique<EventsWriter>(file_prefix, options);
+  WriteFile(writer.get());
+  writer->RequestFlush();
+  string filename = writer->FileName();
+  writer.reset();
+  VerifyFile(filename);
+}
+
+TEST(EventWriter, AsyncDropsEventsWhenFull) {
+  string file_prefix = GetDirName("/asyncdrop_test");
+  EventsWriter::AsyncOptions options;
+  options.max_queued_events = 0;
+  options.drop_events_when_full = true;
+  EventsWriter writer(file_prefix, options);
+  WriteFile(&writer);
+  TF_EXPECT_OK(writer.Close());
+  EXPECT_EQ(writer.num_dropped_events(), 2);
+
+  std::unique_ptr<RandomAccessFile> event_file;
+  TF_ASSERT_OK(env()->NewRandomAccessFile(writer.FileName(), &event_file));
+  io::RecordReader reader(event_file.get());
+  uint64 offset = 0;
+  Event event;
+  ASSERT_TRUE(ReadEventProto(&reader, &offset, &event));
+  EXPECT_FALSE(event.file_version().empty());
+  EXPECT_FALSE(ReadEventProto(&reader, &offset, &event));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
 #include <optional>
 #include <utility>
@@ -117,6 +118,49 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Appends the varints packed in [`p`, `end`) to `int64_list`. Runs of eight
+// single-byte varints, the common case for small ids and counts, are detected
+// with one word-wide test and emitted without per-byte continuation checks.
+template <typename Result>
+bool DecodePackedVarint64s(const uint8* p, const uint8* end,
+                           Result* int64_list) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  while (p < end) {
+    if (end - p >= 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < 8; ++i) {
+          int64_list->push_back(static_cast<int64_t>(p[i]));
+        }
+        p += 8;
+        continue;
+      }
+    }
+    uint64 n = 0;
+    for (int shift = 0;; shift += 7) {
+      // A varint is at most 10 bytes long.
+      if (p == end || shift >= 70) return false;
+      const uint8 byte = *p++;
+      n |= static_cast<uint64>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    int64_list->push_back(static_cast<int64_t>(n));
+  }
+  return true;
+}
+
+// Returns the number of varints packed in [`p`, `end`), i.e. the number of
+// bytes without a continuation bit. The loop is simple enough for compilers to
+// vectorize.
+size_t CountPackedVarints(const uint8* p, const uint8* end) {
+  size_t count = 0;
+  for (; p < end; ++p) {
+    count += (*p & 0x80) == 0;
+  }
+  return count;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -170,6 +214,79 @@ class Feature {
     return true;
   }
 
+  bool GetNumElementsInFloatList(int* num_elements) {
+    protobuf::io::CodedInputStream stream(
+        reinterpret_cast<const uint8*>(serialized_.data()), serialized_.size());
+    EnableAliasing(&stream);
+    uint32 length = 0;
+    if (!stream.ReadVarint32(&length)) return false;
+    auto limit = stream.PushLimit(length);
+    *num_elements = 0;
+    if (!stream.ExpectAtEnd()) {
+      constexpr int32_t kNumFloatBytes = 4;
+      uint8 peek_tag = PeekTag(&stream);
+      if (peek_tag == kDelimitedTag(1)) {  // packed
+        if (!stream.ExpectTag(kDelimitedTag(1))) return false;
+        uint32 packed_length;
+        if (!stream.ReadVarint32(&packed_length)) return false;
+        if (!stream.Skip(packed_length)) return false;
+        // Matches ParseFloatList, which ignores anything after the first
+        // packed run.
+        *num_elements = packed_length / kNumFloatBytes;
+      } else if (peek_tag == kFixed32Tag(1)) {  // non-packed
+        while (!stream.ExpectAtEnd()) {
+          if (!stream.ExpectTag(kFixed32Tag(1))) return false;
+          if (!stream.Skip(kNumFloatBytes)) return false;
+          ++*num_elements;
+        }
+      } else {
+        return false;
+      }
+    }
+    stream.PopLimit(limit);
+    return true;
+  }
+
+  bool GetNumElementsInInt64List(int* num_elements) {
+    protobuf::io::CodedInputStream stream(
+        reinterpret_cast<const uint8*>(serialized_.data()), serialized_.size());
+    EnableAliasing(&stream);
+    uint32 length = 0;
+    if (!stream.ReadVarint32(&length)) return false;
+    auto limit = stream.PushLimit(length);
+    *num_elements = 0;
+    if (!stream.ExpectAtEnd()) {
+      uint8 peek_tag = PeekTag(&stream);
+      if (peek_tag == kDelimitedTag(1)) {  // packed
+        if (!stream.ExpectTag(kDelimitedTag(1))) return false;
+        uint32 packed_length;
+        if (!stream.ReadVarint32(&packed_length)) return false;
+        const void* data;
+        int size;
+        if (packed_length > 0) {
+          if (!stream.GetDirectBufferPointer(&data, &size) ||
+              static_cast<uint32>(size) < packed_length) {
+            return false;
+          }
+          const uint8* begin = static_cast<const uint8*>(data);
+          *num_elements = CountPackedVarints(begin, begin + packed_length);
+          if (!stream.Skip(packed_length)) return false;
+        }
+      } else if (peek_tag == kVarintTag(1)) {  // non-packed
+        while (!stream.ExpectAtEnd()) {
+          if (!stream.ExpectTag(kVarintTag(1))) return false;
+          protobuf_uint64 n;
+          if (!stream.ReadVarint64(&n)) return false;
+          ++*num_elements;
+        }
+      } else {
+        return false;
+      }
+    }
+    stream.PopLimit(limit);
+    return true;
+  }
+
   // Helper methods
   tstring* construct_at_end(LimitedArraySlice<tstring>* bytes_list) {
     if (bytes_list->EndDistance() <= 0) {
@@ -305,6 +422,16 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
+        const void* data;
+        int size;
+        if (stream.GetDirectBufferPointer(&data, &size) &&
+            static_cast<uint32>(size) == packed_length) {
+          const uint8* begin = static_cast<const uint8*>(data);
+          if (!DecodePackedVarint64s(begin, begin + size, int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(size)) return false;
+        }
         while (!stream.ExpectAtEnd()) {
           protobuf_uint64 n;  // There is no API for int64
           if (!stream.ReadVarint64(&n)) return false;
@@ -1129,6 +1256,575 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
   }
 }
 
+// Calculates the number of minibatches that FastParseExample() splits
+// `serialized` into.
+size_t NumMinibatches(gtl::ArraySlice<tstring> serialized) {
+  // This parameter affects performance in a big and data-dependent way.
+  const size_t kMiniBatchSizeBytes = 50000;
+
+  // In main regime make each minibatch around kMiniBatchSizeBytes bytes.
+  // Apply 'special logic' below for small and big regimes.
+  size_t result = 0;
+  size_t minibatch_bytes = 0;
+  for (size_t i = 0; i < serialized.size(); i++) {
+    if (minibatch_bytes == 0) {  // start minibatch
+      result++;
+    }
+    minibatch_bytes += serialized[i].size() + 1;
+    if (minibatch_bytes > kMiniBatchSizeBytes) {
+      minibatch_bytes = 0;
+    }
+  }
+  // 'special logic'
+  const size_t min_minibatches = std::min<size_t>(8, serialized.size());
+  const size_t max_minibatches = 64;
+  return std::max<size_t>(min_minibatches,
+                          std::min<size_t>(max_minibatches, result));
+}
+
+// -----------------------------------------------------------------------------
+// Columnar batch parsing, used when `Config::columnar_batch_parsing` is set.
+//
+// A first pass over each minibatch locates the configured features of every
+// example, validates them and counts their values. The output tensors are
+// then allocated at their final sizes, and a second pass decodes each feature
+// column straight into them, without going through SparseBuffers.
+
+// A perfect hash from the feature names of a config to their column: dense
+// features first, then sparse, then ragged ones. Each name is hashed once to
+// pick a bucket, and every bucket stores the displacement that moves its names
+// to distinct free slots, so a lookup is a single probe and name comparison.
+class FeatureNameIndex {
+ public:
+  Status Init(const Config& config) {
+    for (const auto& dense : config.dense) names_.push_back(dense.feature_name);
+    for (const auto& sparse : config.sparse) {
+      names_.push_back(sparse.feature_name);
+    }
+    for (const auto& ragged : config.ragged) {
+      names_.push_back(ragged.feature_name);
+    }
+    size_t num_slots = 1;
+    while (num_slots < 2 * names_.size()) num_slots <<= 1;
+    mask_ = num_slots - 1;
+    const size_t num_buckets = std::max<size_t>(1, (names_.size() + 3) / 4);
+    for (int attempt = 0; attempt < 100; ++attempt, ++seed_) {
+      if (TryBuild(num_slots, num_buckets)) return OkStatus();
+    }
+    return errors::Internal("Could not build a perfect hash of ",
+                            names_.size(),
+                            " feature names. Are they all distinct?");
+  }
+
+  // Returns the column of `name`, or -1 if it is not in the config.
+  int Find(StringPiece name) const {
+    const uint64 h = Hash(name);
+    const int column = slots_[Slot(h, displacements_[Bucket(h)])];
+    if (column < 0 || names_[column] != name) return -1;
+    return column;
+  }
+
+  StringPiece name(int column) const { return names_[column]; }
+
+ private:
+  uint64 Hash(StringPiece name) const {
+    return Hash64(name.data(), name.size(), seed_);
+  }
+  size_t Bucket(uint64 h) const {
+    return ((h >> 32) * displacements_.size()) >> 32;
+  }
+  // The step is odd and the table size a power of two, so the displacements
+  // of a name visit every slot.
+  size_t Slot(uint64 h, uint64 displacement) const {
+    return (h + displacement * ((h >> 16) | 1)) & mask_;
+  }
+
+  bool TryBuild(size_t num_slots, size_t num_buckets) {
+    slots_.assign(num_slots, -1);
+    displacements_.assign(num_buckets, 0);
+    std::vector<std::vector<int>> buckets(num_buckets);
+    for (size_t column = 0; column < names_.size(); ++column) {
+      buckets[Bucket(Hash(names_[column]))].push_back(column);
+    }
+    // Place the largest buckets first, while most slots are still free.
+    std::vector<size_t> order(num_buckets);
+    for (size_t b = 0; b < num_buckets; ++b) order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return buckets[a].size() > buckets[b].size();
+    });
+    std::vector<size_t> bucket_slots;
+    for (size_t b : order) {
+      const std::vector<int>& bucket = buckets[b];
+      if (bucket.empty()) break;
+      bool placed = false;
+      for (uint64 displacement = 0; !placed && displacement < num_slots;
+           ++displacement) {
+        placed = true;
+        bucket_slots.clear();
+        for (int column : bucket) {
+          const size_t slot = Slot(Hash(names_[column]), displacement);
+          if (slots_[slot] >= 0 ||
+              std::find(bucket_slots.begin(), bucket_slots.end(), slot) !=
+                  bucket_slots.end()) {
+            placed = false;
+            break;
+          }
+          bucket_slots.push_back(slot);
+        }
+        if (placed) {
+          displacements_[b] = displacement;
+          for (size_t i = 0; i < bucket.size(); ++i) {
+            slots_[bucket_slots[i]] = bucket[i];
+          }
+        }
+      }
+      if (!placed) return false;
+    }
+    return true;
+  }
+
+  std::vector<StringPiece> names_;
+  uint64 seed_ = 0xDECAFCAFFE;
+  size_t mask_ = 0;
+  std::vector<int> slots_;
+  std::vector<uint64> displacements_;
+};
+
+// A configured feature of one example, as located by the first pass.
+struct ColumnCell {
+  // The serialized feature, after its data type tag.
+  parsed::Feature feature;
+  // The number of values in `feature`.
+  int num_values = 0;
+  bool present = false;
+};
+
+// Locates the configured features of `serialized_example`, validates them the
+// same way as FastParseSerializedExample() does, and fills in their cells. The
+// cell of column `c` is `cells[c * batch_size + example_index]`.
+Status LocateExampleFeatures(const tstring& serialized_example,
+                             StringPiece example_name,
+                             const size_t example_index, const Config& config,
+                             const FeatureNameIndex& feature_index,
+                             const size_t batch_size, ColumnCell* cells,
+                             PerExampleFeatureStats* output_stats) {
+  parsed::Example parsed_example;
+  if (!ParseExample(serialized_example, &parsed_example)) {
+    return errors::InvalidArgument("Could not parse example input, value: '",
+                                   serialized_example, "'");
+  }
+  const size_t parsed_example_size = parsed_example.size();
+  if (output_stats) {
+    output_stats->features_count = parsed_example_size;
+  }
+  const int num_dense = config.dense.size();
+  const int num_sparse = config.sparse.size();
+
+  for (size_t i = 0; i < parsed_example_size; ++i) {
+    // Last entry in the map overwrites all the previous ones.
+    parsed::FeatureMapEntry& name_and_feature =
+        parsed_example[parsed_example_size - i - 1];
+    const StringPiece feature_name = name_and_feature.first;
+    parsed::Feature& feature = name_and_feature.second;
+
+    const int column = feature_index.Find(feature_name);
+    if (column < 0) continue;
+    ColumnCell& cell = cells[column * batch_size + example_index];
+
+    auto example_error = [&](StringPiece suffix) {
+      return errors::InvalidArgument("Name: ", example_name,
+                                     ", Key: ", feature_name,
+                                     ", Index: ", example_index, ".  ", suffix);
+    };
+
+    auto parse_error = [&] {
+      return example_error("Can't parse serialized Example.");
+    };
+
+    auto count_values = [&](DataType dtype, int* num_values) {
+      switch (dtype) {
+        case DT_INT64:
+          return feature.GetNumElementsInInt64List(num_values);
+        case DT_FLOAT:
+          return feature.GetNumElementsInFloatList(num_values);
+        case DT_STRING:
+          return feature.GetNumElementsInBytesList(num_values);
+        default:
+          LOG(FATAL) << "Should not happen.";
+          return false;
+      }
+    };
+
+    DataType example_dtype;
+    TF_RETURN_IF_ERROR(feature.ParseDataType(&example_dtype));
+
+    int num_values = 0;
+    if (column < num_dense) {
+      const Config::Dense& dense = config.dense[column];
+      if (example_dtype == DT_INVALID) continue;
+      if (cell.present) {
+        LogDenseFeatureDataLoss(feature_name);
+        continue;
+      }
+      if (example_dtype != dense.dtype) {
+        return example_error(strings::StrCat(
+            "Data types don't match. Data type: ",
+            DataTypeString(example_dtype),
+            " but expected type: ", DataTypeString(dense.dtype)));
+      }
+      if (!count_values(dense.dtype, &num_values)) return parse_error();
+
+      const char* type_str = dense.dtype == DT_INT64   ? "int64"
+                             : dense.dtype == DT_FLOAT ? "float"
+                                                       : "bytes";
+      const size_t num_elements = dense.elements_per_stride;
+      if (!dense.variable_length) {
+        // A bytes list does not fit into its output slice.
+        if (dense.dtype == DT_STRING &&
+            static_cast<size_t>(num_values) > num_elements) {
+          return parse_error();
+        }
+        if (static_cast<size_t>(num_values) != num_elements) {
+          return example_error(strings::StrCat(
+              "Number of ", type_str,
+              " values != expected.  "
+              "Values size: ",
+              num_values, " but output shape: ", dense.shape.DebugString()));
+        }
+        if (output_stats) {
+          output_stats->feature_values_count += num_elements;
+        }
+      } else {
+        if (num_values % num_elements != 0) {
+          return example_error(strings::StrCat(
+              "Number of ", type_str,
+              " values is not a multiple of stride length. Saw ", num_values,
+              " values but output shape is: ", dense.shape.DebugString()));
+        }
+        if (output_stats) {
+          output_stats->feature_values_count += num_values;
+        }
+      }
+    } else {
+      // Feature is sparse or ragged.
+      const bool is_ragged = column >= num_dense + num_sparse;
+      const DataType feature_dtype =
+          is_ragged ? config.ragged[column - num_dense - num_sparse].dtype
+                    : config.sparse[column - num_dense].dtype;
+      if (cell.present) {
+        LogSparseFeatureDataLoss(feature_name);
+        continue;
+      }
+      if (example_dtype != DT_INVALID && example_dtype != feature_dtype) {
+        return example_error(
+            strings::StrCat("Data types don't match. ",
+                            "Expected type: ", DataTypeString(feature_dtype),
+                            ", Actual type: ", DataTypeString(example_dtype)));
+      }
+      if (example_dtype != DT_INVALID &&
+          !count_values(feature_dtype, &num_values)) {
+        return parse_error();
+      }
+      if (output_stats) {
+        output_stats->feature_values_count += num_values;
+      }
+    }
+    cell.feature = feature;
+    cell.num_values = num_values;
+    cell.present = true;
+  }
+
+  // Check for missing required dense features.
+  for (int d = 0; d < num_dense; ++d) {
+    if (config.dense[d].variable_length) continue;
+    if (cells[d * batch_size + example_index].present) continue;
+    if (config.dense[d].default_value.NumElements() == 0) {
+      return errors::InvalidArgument(
+          "Name: ", example_name, ", Feature: ", config.dense[d].feature_name,
+          " (data type: ", DataTypeString(config.dense[d].dtype), ")",
+          " is required but could not be found.");
+    }
+  }
+  return OkStatus();
+}
+
+bool ParseFeatureList(parsed::Feature* feature,
+                      LimitedArraySlice<int64_t>* slice) {
+  return feature->ParseInt64List(slice);
+}
+bool ParseFeatureList(parsed::Feature* feature,
+                      LimitedArraySlice<float>* slice) {
+  return feature->ParseFloatList(slice);
+}
+bool ParseFeatureList(parsed::Feature* feature,
+                      LimitedArraySlice<tstring>* slice) {
+  return feature->ParseBytesList(slice);
+}
+
+// Decodes the values of `cell`, counted by the first pass, into `out`.
+template <typename T>
+bool DecodeCell(const ColumnCell& cell, T* out) {
+  parsed::Feature feature = cell.feature;
+  LimitedArraySlice<T> slice(out, cell.num_values);
+  return ParseFeatureList(&feature, &slice) && slice.EndDistance() == 0;
+}
+
+// Decodes examples [`begin`, `end`) of a dense column into `values`, where each
+// example takes `row_size` values.
+template <typename T>
+bool DecodeDenseColumn(const Config::Dense& dense, const ColumnCell* cells,
+                       size_t row_size, size_t begin, size_t end,
+                       Tensor* values, size_t* failed_example) {
+  if (row_size == 0) return true;
+  T* data = values->flat<T>().data();
+  const T* default_data = dense.default_value.flat<T>().data();
+  for (size_t e = begin; e < end; ++e) {
+    T* row = data + e * row_size;
+    if (!dense.variable_length) {
+      if (!cells[e].present) {
+        std::copy_n(default_data, row_size, row);
+      } else if (!DecodeCell(cells[e], row)) {
+        *failed_example = e;
+        return false;
+      }
+    } else {
+      if (cells[e].num_values > 0 && !DecodeCell(cells[e], row)) {
+        *failed_example = e;
+        return false;
+      }
+      std::fill(row + cells[e].num_values, row + row_size, default_data[0]);
+    }
+  }
+  return true;
+}
+
+// Decodes examples [`begin`, `end`) of a sparse or ragged column into
+// `values`, starting at `offsets[e]` for example `e`, and fills in the
+// corresponding rows of the sparse `indices`, if not null.
+template <typename T>
+bool DecodeListColumn(const ColumnCell* cells,
+                      const std::vector<int64_t>& offsets, size_t begin,
+                      size_t end, Tensor* indices, Tensor* values,
+                      size_t* failed_example) {
+  T* data = values->flat<T>().data();
+  int64_t* ix_p =
+      indices != nullptr ? indices->flat<int64_t>().data() : nullptr;
+  for (size_t e = begin; e < end; ++e) {
+    const int num_values = cells[e].num_values;
+    if (num_values == 0) continue;
+    if (!DecodeCell(cells[e], data + offsets[e])) {
+      *failed_example = e;
+      return false;
+    }
+    if (ix_p != nullptr) {
+      int64_t* row = ix_p + 2 * offsets[e];
+      for (int k = 0; k < num_values; ++k) {
+        // Column 0: example index
+        row[2 * k] = e;
+        // Column 1: the feature index in the example
+        row[2 * k + 1] = k;
+      }
+    }
+  }
+  return true;
+}
+
+Status FastParseExampleColumnar(const Config& config,
+                                gtl::ArraySlice<tstring> serialized,
+                                gtl::ArraySlice<tstring> example_names,
+                                thread::ThreadPool* thread_pool,
+                                Result* result) {
+  FeatureNameIndex feature_index;
+  TF_RETURN_IF_ERROR(feature_index.Init(config));
+
+  const size_t batch_size = serialized.size();
+  const size_t num_dense = config.dense.size();
+  const size_t num_sparse = config.sparse.size();
+  const size_t num_ragged = config.ragged.size();
+  const size_t num_columns = num_dense + num_sparse + num_ragged;
+
+  auto example_name = [&](size_t e) -> StringPiece {
+    return !example_names.empty() ? StringPiece(example_names[e])
+                                  : StringPiece("<unknown>");
+  };
+
+  const size_t num_minibatches = NumMinibatches(serialized);
+  auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
+    return (batch_size * minibatch) / num_minibatches;
+  };
+
+  // Pass one: locate, validate and count the features of every example.
+  std::vector<ColumnCell> cells(num_columns * batch_size);
+  std::vector<Status> status_of_minibatch(num_minibatches);
+  auto LocateMiniBatch = [&](size_t minibatch) {
+    size_t start = first_example_of_minibatch(minibatch);
+    size_t end = first_example_of_minibatch(minibatch + 1);
+    for (size_t e = start; e < end; ++e) {
+      PerExampleFeatureStats* stats = nullptr;
+      if (config.collect_feature_stats) {
+        stats = &result->feature_stats[e];
+      }
+      status_of_minibatch[minibatch] =
+          LocateExampleFeatures(serialized[e], example_name(e), e, config,
+                                feature_index, batch_size, cells.data(), stats);
+      if (!status_of_minibatch[minibatch].ok()) break;
+    }
+  };
+  ParallelFor(LocateMiniBatch, num_minibatches, thread_pool);
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  // Allocate the outputs at their final sizes.
+  result->sparse_indices.reserve(num_sparse);
+  result->sparse_values.reserve(num_sparse);
+  result->sparse_shapes.reserve(num_sparse);
+  result->dense_values.reserve(num_dense);
+  result->ragged_values.reserve(num_ragged);
+  result->ragged_splits.reserve(num_ragged);
+
+  // Values per example of each dense column.
+  std::vector<size_t> row_sizes(num_dense);
+  for (size_t d = 0; d < num_dense; ++d) {
+    const Config::Dense& dense = config.dense[d];
+    TensorShape values_shape;
+    values_shape.AddDim(batch_size);
+    if (!dense.variable_length) {
+      for (const int64_t dim : dense.shape.dim_sizes()) {
+        values_shape.AddDim(dim);
+      }
+      row_sizes[d] = dense.elements_per_stride;
+    } else {
+      const ColumnCell* column_cells = &cells[d * batch_size];
+      size_t max_num_values = 0;
+      for (size_t e = 0; e < batch_size; ++e) {
+        max_num_values =
+            std::max<size_t>(max_num_values, column_cells[e].num_values);
+      }
+      DCHECK_EQ(max_num_values % dense.elements_per_stride, 0);
+      values_shape.AddDim(max_num_values / dense.elements_per_stride);
+      for (int i = 1; i < dense.shape.dims(); ++i) {
+        values_shape.AddDim(dense.shape.dim_size(i));
+      }
+      row_sizes[d] = max_num_values;
+    }
+    result->dense_values.emplace_back(dense.dtype, values_shape);
+  }
+
+  // Offsets of the values of each example in sparse and ragged columns,
+  // followed by the total number of values.
+  std::vector<std::vector<int64_t>> offsets(num_sparse + num_ragged);
+  auto compute_offsets = [&](size_t column,
+                             std::vector<int64_t>* column_offsets) {
+    const ColumnCell* column_cells = &cells[column * batch_size];
+    int64_t max_num_values = 0;
+    column_offsets->resize(batch_size + 1);
+    (*column_offsets)[0] = 0;
+    for (size_t e = 0; e < batch_size; ++e) {
+      (*column_offsets)[e + 1] =
+          (*column_offsets)[e] + column_cells[e].num_values;
+      max_num_values =
+          std::max<int64_t>(max_num_values, column_cells[e].num_values);
+    }
+    return max_num_values;
+  };
+  for (size_t d = 0; d < num_sparse; ++d) {
+    std::vector<int64_t>& sparse_offsets = offsets[d];
+    const int64_t max_num_features =
+        compute_offsets(num_dense + d, &sparse_offsets);
+    const int64_t total_num_features = sparse_offsets.back();
+
+    result->sparse_indices.emplace_back(DT_INT64,
+                                        TensorShape({total_num_features, 2}));
+    result->sparse_values.emplace_back(config.sparse[d].dtype,
+                                       TensorShape({total_num_features}));
+    result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
+    auto shapes_shape_t = result->sparse_shapes.back().vec<int64_t>();
+    shapes_shape_t(0) = batch_size;
+    shapes_shape_t(1) = max_num_features;
+  }
+  for (size_t d = 0; d < num_ragged; ++d) {
+    std::vector<int64_t>& ragged_offsets = offsets[num_sparse + d];
+    compute_offsets(num_dense + num_sparse + d, &ragged_offsets);
+
+    result->ragged_values.emplace_back(
+        config.ragged[d].dtype, TensorShape({ragged_offsets.back()}));
+    result->ragged_splits.emplace_back(
+        config.ragged[d].splits_dtype,
+        TensorShape({static_cast<int64_t>(batch_size + 1)}));
+    Tensor& row_splits = result->ragged_splits.back();
+    if (config.ragged[d].splits_dtype == DT_INT64) {
+      std::copy(ragged_offsets.begin(), ragged_offsets.end(),
+                row_splits.flat<int64_t>().data());
+    } else {
+      std::copy(ragged_offsets.begin(), ragged_offsets.end(),
+                row_splits.flat<int32>().data());
+    }
+  }
+
+  // Pass two: decode each column of a minibatch straight into the outputs.
+  auto decode_column = [&](size_t column, size_t begin, size_t end,
+                           size_t* failed_example) -> bool {
+    const ColumnCell* column_cells = &cells[column * batch_size];
+    if (column < num_dense) {
+      const Config::Dense& dense = config.dense[column];
+      Tensor* values = &result->dense_values[column];
+      const size_t row_size = row_sizes[column];
+      switch (dense.dtype) {
+        case DT_INT64:
+          return DecodeDenseColumn<int64_t>(dense, column_cells, row_size,
+                                            begin, end, values, failed_example);
+        case DT_FLOAT:
+          return DecodeDenseColumn<float>(dense, column_cells, row_size, begin,
+                                          end, values, failed_example);
+        case DT_STRING:
+          return DecodeDenseColumn<tstring>(dense, column_cells, row_size,
+                                            begin, end, values, failed_example);
+        default:
+          LOG(FATAL) << "Should not happen.";
+          return false;
+      }
+    }
+    const size_t d = column - num_dense;
+    const bool is_ragged = d >= num_sparse;
+    Tensor* indices = is_ragged ? nullptr : &result->sparse_indices[d];
+    Tensor* values = is_ragged ? &result->ragged_values[d - num_sparse]
+                               : &result->sparse_values[d];
+    switch (values->dtype()) {
+      case DT_INT64:
+        return DecodeListColumn<int64_t>(column_cells, offsets[d], begin, end,
+                                         indices, values, failed_example);
+      case DT_FLOAT:
+        return DecodeListColumn<float>(column_cells, offsets[d], begin, end,
+                                       indices, values, failed_example);
+      case DT_STRING:
+        return DecodeListColumn<tstring>(column_cells, offsets[d], begin, end,
+                                         indices, values, failed_example);
+      default:
+        LOG(FATAL) << "Should not happen.";
+        return false;
+    }
+  };
+  auto DecodeMiniBatch = [&](size_t minibatch) {
+    size_t start = first_example_of_minibatch(minibatch);
+    size_t end = first_example_of_minibatch(minibatch + 1);
+    for (size_t column = 0; column < num_columns; ++column) {
+      size_t e;
+      if (!decode_column(column, start, end, &e)) {
+        status_of_minibatch[minibatch] = errors::InvalidArgument(
+            "Name: ", example_name(e), ", Key: ", feature_index.name(column),
+            ", Index: ", e, ".  Can't parse serialized Example.");
+        return;
+      }
+    }
+  };
+  ParallelFor(DecodeMiniBatch, num_minibatches, thread_pool);
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 Status FastParseExample(const Config& config,
@@ -1143,6 +1839,11 @@ Status FastParseExample(const Config& config,
     result->feature_stats.resize(serialized.size());
   }
 
+  if (config.columnar_batch_parsing) {
+    return FastParseExampleColumnar(config, serialized, example_names,
+                                    thread_pool, result);
+  }
+
   size_t config_size =
       config.dense.size() + config.sparse.size() + config.ragged.size();
   SeededHasher hasher;
@@ -1187,30 +1888,8 @@ Status FastParseExample(const Config& config,
     fixed_dense_values[d] = Tensor(config.dense[d].dtype, out_shape);
   }
 
-  // This parameter affects performance in a big and data-dependent way.
-  const size_t kMiniBatchSizeBytes = 50000;
-
   // Calculate number of minibatches.
-  // In main regime make each minibatch around kMiniBatchSizeBytes bytes.
-  // Apply 'special logic' below for small and big regimes.
-  const size_t num_minibatches = [&] {
-    size_t result = 0;
-    size_t minibatch_bytes = 0;
-    for (size_t i = 0; i < serialized.size(); i++) {
-      if (minibatch_bytes == 0) {  // start minibatch
-        result++;
-      }
-      minibatch_bytes += serialized[i].size() + 1;
-      if (minibatch_bytes > kMiniBatchSizeBytes) {
-        minibatch_bytes = 0;
-      }
-    }
-    // 'special logic'
-    const size_t min_minibatches = std::min<size_t>(8, serialized.size());
-    const size_t max_minibatches = 64;
-    return std::max<size_t>(min_minibatches,
-                            std::min<size_t>(max_minibatches, result));
-  }();
+  const size_t num_minibatches = NumMinibatches(serialized);
 
   auto first_example_of_minibatch = [&](size_t minibatch) -> size_t {
     return (serialized.size() * minibatch) / num_minibatches;
@@ -96,6 +96,13 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // If `true`, `FastParseExample()` parses the batch column by column: it
+  // first locates and counts the values of every feature in every example,
+  // then decodes each feature directly into output tensors allocated at their
+  // final sizes. This avoids the intermediate buffering of variable-length
+  // features and pays off for configs with many features.
+  bool columnar_batch_parsing = false;
 };
 
 // Statistics about the features in each example passed to
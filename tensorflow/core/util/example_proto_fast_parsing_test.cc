@@ -19,8 +19,12 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -317,6 +321,19 @@ TEST(FastParse, StatsCollection) {
       }
     }
 
+    {
+      FastParseExampleConfig columnar_config = config;
+      columnar_config.columnar_batch_parsing = true;
+      Result result;
+      TF_CHECK_OK(
+          FastParseExample(columnar_config, serialized, {}, nullptr, &result));
+      EXPECT_EQ(kNumExamples, result.feature_stats.size());
+      for (const PerExampleFeatureStats& stats : result.feature_stats) {
+        EXPECT_EQ(7, stats.features_count);
+        EXPECT_EQ(7, stats.feature_values_count);
+      }
+    }
+
     {
       Result result;
       TF_CHECK_OK(FastParseSingleExample(config, serialized[0], &result));
@@ -327,6 +344,127 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+// Returns a batch of examples with every kind of feature, where some features
+// are missing or empty, and int64 lists mix runs of small and large varints.
+std::vector<tstring> MixedExampleBatch(int batch_size) {
+  std::vector<tstring> serialized;
+  for (int i = 0; i < batch_size; ++i) {
+    Example example;
+    auto& features = *example.mutable_features()->mutable_feature();
+    if (i % 5 != 0) {
+      Int64List* dense_int64 = features["dense_int64"].mutable_int64_list();
+      dense_int64->add_value(i);
+      dense_int64->add_value(i * 1000);
+      dense_int64->add_value(-i);
+    }
+    features["dense_float"].mutable_float_list()->add_value(i * 0.5f);
+    features["dense_float"].mutable_float_list()->add_value(-i * 0.5f);
+    if (i % 3 != 0) {
+      features["dense_string"].mutable_bytes_list()->add_value(
+          strings::StrCat("dense", i));
+    }
+    FloatList* varlen_float = features["varlen_float"].mutable_float_list();
+    for (int k = 0; k < i % 4; ++k) varlen_float->add_value(i + k);
+    if (i % 3 != 0) {
+      Int64List* sparse_int64 = features["sparse_int64"].mutable_int64_list();
+      for (int k = 0; k < 10 + i % 7; ++k) sparse_int64->add_value(k);
+      sparse_int64->add_value(300 + i);
+    }
+    BytesList* sparse_string = features["sparse_string"].mutable_bytes_list();
+    for (int k = 0; k < i % 2; ++k) {
+      sparse_string->add_value(strings::StrCat("sparse", i, "_", k));
+    }
+    if (i % 4 != 1) {
+      FloatList* ragged_float = features["ragged_float"].mutable_float_list();
+      for (int k = 0; k < i % 3; ++k) ragged_float->add_value(k - i);
+    }
+    features["ragged_int64"].mutable_int64_list()->add_value(int64_t{1} << 40);
+    features["ignored"].mutable_int64_list()->add_value(i);
+    serialized.push_back(Serialize(example));
+  }
+  return serialized;
+}
+
+FastParseExampleConfig MixedConfig() {
+  FastParseExampleConfig config;
+  AddDenseFeature("dense_int64", DT_INT64, {3}, false, 3, &config);
+  config.dense.back().default_value = test::AsTensor<int64_t>({7, 8, 9});
+  AddDenseFeature("dense_float", DT_FLOAT, {2}, false, 2, &config);
+  AddDenseFeature("dense_string", DT_STRING, {1}, false, 1, &config);
+  config.dense.back().default_value = test::AsTensor<tstring>({"default"});
+  AddDenseFeature("varlen_float", DT_FLOAT, {-1}, true, 1, &config);
+  config.dense.back().default_value = test::AsScalar<float>(-1.0f);
+  AddSparseFeature("sparse_int64", DT_INT64, &config);
+  AddSparseFeature("sparse_string", DT_STRING, &config);
+  config.ragged.emplace_back("ragged_float", DT_FLOAT, DT_INT32);
+  config.ragged.emplace_back("ragged_int64", DT_INT64, DT_INT64);
+  return config;
+}
+
+void ExpectTensorsEqual(const std::vector<Tensor>& expected,
+                        const std::vector<Tensor>& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    test::ExpectEqual(expected[i], actual[i]);
+  }
+}
+
+TEST(FastParse, ColumnarMatchesRowParsing) {
+  const std::vector<tstring> serialized = MixedExampleBatch(100);
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  for (thread::ThreadPool* pool :
+       {&thread_pool, static_cast<thread::ThreadPool*>(nullptr)}) {
+    FastParseExampleConfig config = MixedConfig();
+    Result expected;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, pool, &expected));
+
+    config.columnar_batch_parsing = true;
+    Result actual;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, pool, &actual));
+
+    ExpectTensorsEqual(expected.dense_values, actual.dense_values);
+    ExpectTensorsEqual(expected.sparse_indices, actual.sparse_indices);
+    ExpectTensorsEqual(expected.sparse_values, actual.sparse_values);
+    ExpectTensorsEqual(expected.sparse_shapes, actual.sparse_shapes);
+    ExpectTensorsEqual(expected.ragged_values, actual.ragged_values);
+    ExpectTensorsEqual(expected.ragged_splits, actual.ragged_splits);
+  }
+}
+
+TEST(FastParse, ColumnarReportsInvalidExamples) {
+  std::vector<tstring> serialized = MixedExampleBatch(20);
+  FastParseExampleConfig config = MixedConfig();
+  config.columnar_batch_parsing = true;
+
+  // Mismatched data type.
+  config.sparse[0].dtype = DT_FLOAT;
+  Result result;
+  Status status = FastParseExample(config, serialized, {}, nullptr, &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(),
+                                "Data types don't match"))
+      << status;
+  config.sparse[0].dtype = DT_INT64;
+
+  // Missing required dense feature.
+  config.dense[0].default_value = Tensor(DT_INT64, {});
+  status = FastParseExample(config, serialized, {}, nullptr, &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(),
+                                "is required but could not be found"))
+      << status;
+
+  // Wrong number of values for a fixed-length dense feature.
+  config.dense[0].default_value = test::AsTensor<int64_t>({7, 8, 9});
+  config.dense[0].shape = PartialTensorShape({2});
+  config.dense[0].elements_per_stride = 2;
+  status = FastParseExample(config, serialized, {}, nullptr, &result);
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(),
+                                "values != expected"))
+      << status;
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
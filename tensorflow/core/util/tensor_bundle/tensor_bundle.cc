@@ -21,9 +21,11 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
@@ -424,6 +426,16 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
+  if (options_.data_alignment == 1) {
+    bool align_for_mmap;
+    Status s = ReadBoolFromEnvVar("TF_BUNDLE_WRITER_ALIGN_FOR_MMAP", false,
+                                  &align_for_mmap);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+    } else if (align_for_mmap) {
+      options_.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    }
+  }
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
 
@@ -461,6 +473,12 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
+  status_ = WriteEntryData(val, entry);
+  return status_;
+}
+
+Status BundleWriter::WriteEntryData(const Tensor& val,
+                                    BundleEntryProto* entry) {
   entry->set_shard_id(0);
   entry->set_offset(size_);
 
@@ -486,6 +504,62 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   return status_;
 }
 
+Status BundleWriter::AddDeltaRows(StringPiece key,
+                                  const TensorShape& full_tensor_shape,
+                                  const Tensor& row_ids, const Tensor& rows) {
+  if (!status_.ok()) return status_;
+  CHECK_NE(key, kHeaderEntryKey);
+  if (options_.base_prefix.empty()) {
+    return errors::FailedPrecondition("Adding delta rows for ", key,
+                                      " to a bundle without a base bundle");
+  }
+  if (!DataTypeCanUseMemcpy(rows.dtype())) {
+    return errors::Unimplemented("Delta rows of ", key, " are of dtype ",
+                                 DataTypeString(rows.dtype()),
+                                 ", which cannot be memcpy-ed");
+  }
+  if (row_ids.dtype() != DT_INT64 ||
+      !TensorShapeUtils::IsVector(row_ids.shape())) {
+    return errors::InvalidArgument("Row ids of ", key,
+                                   " must be an int64 vector, got ",
+                                   DataTypeString(row_ids.dtype()), " ",
+                                   row_ids.shape().DebugString());
+  }
+  if (full_tensor_shape.dims() < 1) {
+    return errors::InvalidArgument("Cannot add delta rows of scalar ", key);
+  }
+  TensorShape rows_shape = full_tensor_shape;
+  TF_RETURN_IF_ERROR(rows_shape.SetDimWithStatus(0, row_ids.NumElements()));
+  if (rows.shape() != rows_shape) {
+    return errors::InvalidArgument("Delta rows of ", key, " have shape ",
+                                   rows.shape().DebugString(), ", expected ",
+                                   rows_shape.DebugString());
+  }
+  const auto ids = row_ids.vec<int64_t>();
+  for (int64_t i = 0; i < ids.size(); ++i) {
+    if (ids(i) < 0 || ids(i) >= full_tensor_shape.dim_size(0)) {
+      return errors::InvalidArgument("Row id ", ids(i), " of ", key,
+                                     " is not in [0, ",
+                                     full_tensor_shape.dim_size(0), ")");
+    }
+  }
+  const string key_string(key);
+  if (entries_.find(key_string) != entries_.end()) {
+    status_ = errors::InvalidArgument("Adding duplicate key: ", key);
+    return status_;
+  }
+
+  BundleEntryProto* entry = &entries_[key_string];
+  entry->set_dtype(rows.dtype());
+  full_tensor_shape.AsProto(entry->mutable_shape());
+  BundleEntryProto* ids_entry = entry->mutable_delta_row_ids();
+  ids_entry->set_dtype(DT_INT64);
+  row_ids.shape().AsProto(ids_entry->mutable_shape());
+  TF_RETURN_IF_ERROR(WriteEntryData(row_ids, ids_entry));
+  status_ = WriteEntryData(rows, entry);
+  return status_;
+}
+
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
                               const TensorShape& full_tensor_shape,
                               const TensorSlice& slice_spec,
@@ -552,6 +626,7 @@ Status BundleWriter::Finish() {
     // platforms (e.g. Android).  The metadata file is small, so this is fine.
     table::Options options;
     options.compression = table::kNoCompression;
+    options.filter_bits_per_key = options_.index_filter_bits_per_key;
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
@@ -561,6 +636,7 @@ Status BundleWriter::Finish() {
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    header.set_base_prefix(options_.base_prefix);
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -595,6 +671,7 @@ struct MergeState {
   bool seen_first_bundle = false;
   BundleHeaderProto_Endianness endianness;
   VersionDef version;
+  string base_prefix;
 
   // Tensor key -> BundleEntryProto.
   std::map<string, BundleEntryProto> entries;
@@ -636,6 +713,7 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
       merge_state->version = header.version();
+      merge_state->base_prefix = header.base_prefix();
     } else {
       // Validates "endianness".
       if (merge_state->endianness != header.endianness()) {
@@ -651,6 +729,13 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
             "Merging bundles with different format versions: merged ",
             merge_version, " vs. curr ", curr_version);
       }
+      // Validates "base_prefix".
+      if (merge_state->base_prefix != header.base_prefix()) {
+        return errors::InvalidArgument(
+            "Merging bundles with different base bundles: merged \"",
+            merge_state->base_prefix, "\" vs. curr \"", header.base_prefix(),
+            "\"");
+      }
     }
     num_shards = header.num_shards();
     iter->Next();
@@ -698,6 +783,11 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
         {DataFilename(prefix, to_merge_entry.shard_id(), num_shards),
          merge_state->shard_ids.size()});
     to_merge_entry.set_shard_id(result.first->second);
+    if (to_merge_entry.has_delta_row_ids()) {
+      // The row ids are stored in the same data file as the rows.
+      to_merge_entry.mutable_delta_row_ids()->set_shard_id(
+          result.first->second);
+    }
     merge_state->entries[key] = to_merge_entry;
   }
   return OkStatus();
@@ -745,6 +835,7 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
     header.set_num_shards(merge.num_shards);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
+    header.set_base_prefix(merge.base_prefix);
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
     // All others.
     for (const auto& p : merge.entries) {
@@ -763,11 +854,66 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
   return status;
 }
 
+Status CopyBundle(Env* env, StringPiece src_prefix, StringPiece dst_prefix) {
+  const string src_metadata = MetaFilename(src_prefix);
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(src_metadata, &file_size));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(src_metadata, &file));
+
+  // Reads the number of data files from the header.
+  table::Table* table = nullptr;
+  TF_RETURN_IF_ERROR(
+      table::Table::Open(TableBuilderOptions(), file.get(), file_size, &table));
+  std::unique_ptr<table::Table> table_deleter(table);
+  std::unique_ptr<table::Iterator> iter(table->NewIterator());
+  iter->Seek(kHeaderEntryKey);
+  if (!iter->Valid()) {
+    return CorruptFileError(iter->status(), src_metadata,
+                            "failed to seek to header entry");
+  }
+  BundleHeaderProto header;
+  Status s = ParseEntryProto(iter->key(), iter->value(), &header);
+  if (!s.ok()) {
+    return CorruptFileError(s, src_metadata, "unable to parse header");
+  }
+
+  s = env->CreateDir(string(io::Dirname(dst_prefix)));
+  if (!s.ok() && !errors::IsAlreadyExists(s)) return s;
+  const int num_shards = header.num_shards();
+  for (int shard_id = 0; shard_id < num_shards; ++shard_id) {
+    const string src_data = DataFilename(src_prefix, shard_id, num_shards);
+    const string dst_data = DataFilename(dst_prefix, shard_id, num_shards);
+    VLOG(1) << "Copying " << src_data << " to " << dst_data;
+    TF_RETURN_IF_ERROR(env->CopyFile(src_data, dst_data));
+  }
+
+  const string dst_metadata = MetaFilename(dst_prefix);
+  bool use_temp_file;
+  TF_RETURN_IF_ERROR(env->HasAtomicMove(dst_metadata, &use_temp_file));
+  if (!use_temp_file) return env->CopyFile(src_metadata, dst_metadata);
+  const string temp_metadata =
+      strings::StrCat(dst_metadata, ".tempstate", random::New64());
+  s = env->CopyFile(src_metadata, temp_metadata);
+  if (s.ok()) s = env->RenameFile(temp_metadata, dst_metadata);
+  if (!s.ok()) env->DeleteFile(temp_metadata).IgnoreError();
+  return s;
+}
+
 // Interface for reading a tensor bundle.
 
 BundleReader::BundleReader(
     Env* env, StringPiece prefix,
     bool enable_multi_threading_for_testing /* = false */)
+    : BundleReader(env, prefix, [&] {
+        Options options;
+        options.enable_multi_threading_for_testing =
+            enable_multi_threading_for_testing;
+        return options;
+      }()) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
       metadata_(nullptr),
@@ -775,7 +921,17 @@ BundleReader::BundleReader(
       index_cache_(nullptr),
       iter_(nullptr),
       need_to_swap_bytes_(false),
-      enable_multi_threading_for_testing_(enable_multi_threading_for_testing) {
+      enable_multi_threading_for_testing_(
+          options.enable_multi_threading_for_testing) {
+  use_mmap_ = options.use_mmap;
+  if (!use_mmap_) {
+    Status s =
+        ReadBoolFromEnvVar("TF_BUNDLE_READER_USE_MMAP", false, &use_mmap_);
+    if (!s.ok()) {
+      LOG(WARNING) << s;
+    }
+  }
+
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -788,12 +944,16 @@ BundleReader::BundleReader(
   metadata_ = wrapper.release();
 
   table::Options o;
-  int64_t cache_size;
-  Status s =
-      ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_SIZE_IN_MB", 0, &cache_size);
-  if (s.ok() && cache_size > 0) {
-    index_cache_ = table::NewLRUCache(cache_size << 20);
-    o.block_cache = index_cache_;
+  if (options.index_cache != nullptr) {
+    o.block_cache = options.index_cache;
+  } else {
+    int64_t cache_size;
+    Status s =
+        ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_SIZE_IN_MB", 0, &cache_size);
+    if (s.ok() && cache_size > 0) {
+      index_cache_ = table::NewLRUCache(cache_size << 20);
+      o.block_cache = index_cache_;
+    }
   }
 
   status_ = table::Table::Open(o, metadata_, file_size, &table_);
@@ -814,6 +974,7 @@ BundleReader::BundleReader(
     return;
   }
   num_shards_ = header.num_shards();
+  base_prefix_ = header.base_prefix();
   if ((header.endianness() == BundleHeaderProto::BIG && port::kLittleEndian) ||
       (header.endianness() == BundleHeaderProto::LITTLE &&
        !port::kLittleEndian)) {
@@ -850,6 +1011,9 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  if (!table_->KeyMayMatch(key)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -867,7 +1031,113 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return OkStatus();
 }
 
+Status BundleReader::GetMappedShard(
+    int32_t shard_id, std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  auto it = mapped_data_.find(shard_id);
+  if (it != mapped_data_.end()) {
+    *region = it->second;
+    return OkStatus();
+  }
+  std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+  const string filename = DataFilename(prefix_, shard_id, num_shards_);
+  Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &new_region);
+  if (errors::IsUnimplemented(s)) {
+    VLOG(1) << "Unable to memory-map " << filename
+            << ", falling back to reads: " << s;
+    new_region = nullptr;
+  } else {
+    TF_RETURN_IF_ERROR(s);
+  }
+  *region = std::move(new_region);
+  mapped_data_[shard_id] = *region;
+  return OkStatus();
+}
+
+namespace {
+
+// A TensorBuffer aliasing part of a memory-mapped data file.  It does not own
+// its memory, so Tensor::RefCountIsOne() is always false for tensors using it,
+// and kernels that would otherwise update such a tensor in place copy it
+// first.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReaderMmap");
+  }
+  bool OwnsMemory() const override { return false; }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  // Keeps the mapping alive.
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+}  // namespace
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                                    bool* mapped) {
+  *mapped = false;
+  if (!DataTypeCanUseMemcpy(entry.dtype()) || need_to_swap_bytes_ ||
+      entry.size() == 0 || entry.offset() % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return OkStatus();
+  }
+  const TensorShape stored_shape(entry.shape());
+  if (val->NumElements() != 0 && (val->dtype() != entry.dtype() ||
+                                 !val->shape().IsSameSize(stored_shape))) {
+    // Let the regular read path deal with (or report) the mismatch.
+    return OkStatus();
+  }
+  if (entry.size() !=
+      stored_shape.num_elements() * DataTypeSize(entry.dtype())) {
+    return OkStatus();
+  }
+
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  TF_RETURN_IF_ERROR(GetMappedShard(entry.shard_id(), &region));
+  if (region == nullptr) {
+    return OkStatus();
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry of ", entry.size(),
+                            " bytes at offset ", entry.offset(),
+                            " exceeds the file size ", region->length());
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+  *val = Tensor(entry.dtype(), stored_shape,
+                core::RefCountPtr<TensorBuffer>(new MappedTensorBuffer(
+                    std::move(region), data, entry.size())));
+  *mapped = true;
+  return OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (use_mmap_) {
+    bool mapped;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+    if (mapped) return OkStatus();
+  }
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -1013,7 +1283,9 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
 
-  if (entry.slices().empty()) {
+  if (entry.has_delta_row_ids()) {
+    return GetDeltaValue(key, entry, val);
+  } else if (entry.slices().empty()) {
     return GetValue(entry, val);
   } else {
     return GetSliceValue(
@@ -1031,7 +1303,9 @@ Status BundleReader::ReadCurrent(Tensor* val) {
                             entry.shape().ShortDebugString());
   }
 
-  if (entry.slices().empty()) {
+  if (entry.has_delta_row_ids()) {
+    return GetDeltaValue(iter_->key(), entry, val);
+  } else if (entry.slices().empty()) {
     return GetValue(entry, val);
   } else {
     return GetSliceValue(
@@ -1057,9 +1331,74 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
   CHECK(val != nullptr);
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(full_tensor_key, &entry));
+  if (entry.has_delta_row_ids()) {
+    return errors::Unimplemented("Looking up a slice of delta entry ",
+                                 full_tensor_key, " is not supported");
+  }
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
+Status BundleReader::GetDeltaValue(StringPiece key,
+                                   const BundleEntryProto& entry,
+                                   Tensor* val) {
+  if (base_prefix_.empty()) {
+    return errors::DataLoss("Delta entry ", key, " in bundle ", prefix_,
+                            " which has no base bundle");
+  }
+  if (base_reader_ == nullptr) {
+    Options options;
+    options.use_mmap = use_mmap_;
+    options.enable_multi_threading_for_testing =
+        enable_multi_threading_for_testing_;
+    base_reader_ = std::make_unique<BundleReader>(env_, base_prefix_, options);
+  }
+  TF_RETURN_IF_ERROR(base_reader_->status());
+
+  const TensorShape full_shape(entry.shape());
+  TF_RETURN_IF_ERROR(base_reader_->Lookup(key, val));
+  if (val->dtype() != entry.dtype() || val->shape() != full_shape) {
+    return errors::DataLoss("Delta entry ", key, " of dtype ",
+                            DataTypeString(entry.dtype()), " and shape ",
+                            full_shape.DebugString(), " does not match its ",
+                            DataTypeString(val->dtype()), " ",
+                            val->shape().DebugString(), " base in ",
+                            base_prefix_);
+  }
+  if (base_reader_->use_mmap() && !val->RefCountIsOne()) {
+    // The base tensor may alias a read-only mapped data file.
+    *val = tensor::DeepCopy(*val);
+  }
+
+  Tensor row_ids;
+  TF_RETURN_IF_ERROR(GetValue(entry.delta_row_ids(), &row_ids));
+  if (row_ids.dtype() != DT_INT64 ||
+      !TensorShapeUtils::IsVector(row_ids.shape()) ||
+      !DataTypeCanUseMemcpy(entry.dtype()) || full_shape.dims() < 1) {
+    return errors::DataLoss("Invalid delta entry ", key, " in bundle ",
+                            prefix_);
+  }
+  const int64_t num_rows = row_ids.NumElements();
+  if (num_rows == 0) return OkStatus();
+  BundleEntryProto rows_entry = entry;
+  rows_entry.clear_delta_row_ids();
+  rows_entry.mutable_shape()->mutable_dim(0)->set_size(num_rows);
+  Tensor rows;
+  TF_RETURN_IF_ERROR(GetValue(rows_entry, &rows));
+
+  const auto ids = row_ids.vec<int64_t>();
+  const size_t row_bytes = rows.TotalBytes() / num_rows;
+  const char* src = rows.tensor_data().data();
+  char* dst = const_cast<char*>(val->tensor_data().data());
+  for (int64_t i = 0; i < num_rows; ++i) {
+    if (ids(i) < 0 || ids(i) >= full_shape.dim_size(0)) {
+      return errors::DataLoss("Row id ", ids(i), " of delta entry ", key,
+                              " is not in [0, ", full_shape.dim_size(0), ")");
+    }
+    memcpy(dst + ids(i) * row_bytes, src + i * row_bytes, row_bytes);
+  }
+  return OkStatus();
+}
+
 Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
                                    const BundleEntryProto& full_tensor_entry,
                                    const TensorSlice& slice_spec, Tensor* val) {
@@ -1176,6 +1515,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (!table_->KeyMayMatch(key)) return false;
   Seek(key);
   return Valid() && (this->key() == key);
 }
@@ -1194,6 +1534,13 @@ Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   return LookupDtypeAndShape(key, &ignored, shape);
 }
 
+Status BundleReader::LookupDataShard(StringPiece key, int32_t* shard_id) {
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  *shard_id = entry.slices().empty() ? entry.shard_id() : 0;
+  return OkStatus();
+}
+
 string BundleReader::DebugString() {
   // Format used below emulates that of TensorSliceReader::DebugString().
   string shape_str;
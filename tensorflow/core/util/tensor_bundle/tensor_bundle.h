@@ -115,7 +115,20 @@ class BundleWriter {
     Options() {}
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
+    //
+    // Setting the TF_BUNDLE_WRITER_ALIGN_FOR_MMAP environment variable to
+    // "true" raises the default to EIGEN_MAX_ALIGN_BYTES, so that readers
+    // using BundleReader::Options::use_mmap can alias every numeric tensor
+    // of the bundle, e.g. for the variables of an exported SavedModel.
     int data_alignment{1};
+    // If non-empty, writes a delta bundle on top of the bundle with this
+    // prefix; see AddDeltaRows().
+    string base_prefix;
+    // If positive, the metadata table holds a bloom filter of the tensor
+    // names with this many bits per name, so that readers can tell that a
+    // tensor isn't in the bundle without reading the metadata block that
+    // would hold it; see table::Options::filter_bits_per_key.
+    int index_filter_bits_per_key = 0;
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -144,14 +157,33 @@ class BundleWriter {
                   const TensorShape& full_tensor_shape,
                   const TensorSlice& slice_spec, const Tensor& slice_tensor);
 
+  // Delta bundles support.
+  // Adds the rows "row_ids" of the full tensor keyed by "key", with values
+  // "rows", which must have shape [len(row_ids)] + full_tensor_shape[1:].  The
+  // other rows of the tensor are read from the base bundle named by
+  // Options::base_prefix, which allows checkpointing large embedding variables
+  // by only writing the rows that changed.
+  //
+  // A delta bundle must still hold every tensor of the checkpoint: tensors
+  // that are not added with AddDeltaRows() are added in full with Add().
+  //
+  // Returns an error if the writer has no base bundle, or if "rows" is of a
+  // dtype that cannot be memcpy-ed.
+  Status AddDeltaRows(StringPiece key, const TensorShape& full_tensor_shape,
+                      const Tensor& row_ids, const Tensor& rows);
+
   // Finishes the writer and flushes.
   Status Finish() TF_MUST_USE_RESULT;
 
   Status status() const { return status_; }
 
  private:
+  // Appends the values of "val" to the data file, and records their location
+  // and checksum in "entry".
+  Status WriteEntryData(const Tensor& val, BundleEntryProto* entry);
+
   Env* const env_;  // Not owned.
-  const Options options_;
+  Options options_;
   const string prefix_;
   string metadata_path_;
   string data_path_;
@@ -186,18 +218,55 @@ class BundleWriter {
 //
 // Returns a NotFoundError when "allow_missing_files" is set to false and
 // any data file named in "prefixes" does not exist.
+//
+// Delta bundles can only be merged with delta bundles of the same base.
 Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
                     StringPiece merged_prefix,
                     bool allow_missing_files = false);
 
+// Copies the bundle with prefix "src_prefix" to "dst_prefix", e.g. to upload a
+// bundle that was quickly saved to local storage when a preemption notice
+// arrived, or to restore from the copy of a peer.  The data files are copied
+// first and the metadata file last, atomically on file systems that support
+// it, so that readers of "dst_prefix" never see a partial bundle.
+//
+// A delta bundle still refers to its base bundle by its original prefix.
+Status CopyBundle(Env* env, StringPiece src_prefix, StringPiece dst_prefix);
+
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
+  struct Options {
+    Options() {}
+    // If true, the data files are memory-mapped and Lookup() returns tensors
+    // that alias the mapped pages instead of copying into "val", for every
+    // tensor that is:
+    //   * of a memcpy-able dtype (i.e. not DT_STRING, DT_VARIANT or
+    //     DT_RESOURCE),
+    //   * stored with the host's endianness, and
+    //   * stored at an offset aligned to EIGEN_MAX_ALIGN_BYTES (see
+    //     BundleWriter::Options::data_alignment).
+    // Other tensors, and file systems that cannot map files, fall back to the
+    // regular read path.  Mapped tensors do not own their memory, so kernels
+    // that update a variable in place copy it first (copy-on-write).
+    //
+    // Also enabled by setting the TF_BUNDLE_READER_USE_MMAP environment
+    // variable to "true".
+    bool use_mmap = false;
+    // If non-null, the blocks of the metadata table are cached in it, instead
+    // of in a cache of the reader sized by the TF_TABLE_INDEX_CACHE_SIZE_IN_MB
+    // environment variable.  Not owned, and may be shared by several readers,
+    // e.g. of the shards of a checkpoint.  Must outlive the reader.
+    table::Cache* index_cache = nullptr;
+    bool enable_multi_threading_for_testing = false;
+  };
+
   BundleReader(Env* const env, StringPiece prefix,
                bool enable_multi_threading_for_testing = false);
+  BundleReader(Env* const env, StringPiece prefix, const Options& options);
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -232,12 +301,20 @@ class BundleReader {
   Status LookupTensorShape(StringPiece key,
                            TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the data shard holding the tensor keyed by "key".  Partitioned
+  // tensors report shard 0, as their slices may be spread over any shards.
+  // REQUIRES: status().ok()
+  Status LookupDataShard(StringPiece key,
+                         int32_t* shard_id) TF_MUST_USE_RESULT;
+
   // Looks up the tensor keyed by "key".  If "key" refers to a partitioned
   // tensor, attempts to look up the full contents using all stored slices.
   //
   // Caller must make sure "val" has the same shape and dtype as the
   // corresponding contents, so that its buffer can be filled without needing
   // extra allocation.  These can be queried via "LookupDtypeAndShape()".
+  // If the reader uses mmap and the tensor can be mapped, "val" is instead
+  // replaced by a tensor aliasing the data file; see Options::use_mmap.
   //
   // On error, "val" may contain nonsense data.  Returns a NotFound error if
   // tensor keyed by "key" does not exist in this bundle.
@@ -288,6 +365,9 @@ class BundleReader {
   // REQUIRES: status().ok() && Valid()
   StringPiece value() const { return iter_->value(); }
 
+  // Returns true if data files are memory-mapped; see Options::use_mmap.
+  bool use_mmap() const { return use_mmap_; }
+
   string DebugString();
 
  private:
@@ -302,6 +382,18 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // If the tensor described by "entry" can be mapped (see Options::use_mmap),
+  // sets "*val" to a tensor aliasing the mapped data file and "*mapped" to
+  // true.  Otherwise sets "*mapped" to false and leaves "val" untouched.
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
+  // Returns the mapped data file of shard "shard_id", or nullptr if the file
+  // system does not support mapping it.
+  Status GetMappedShard(int32_t shard_id,
+                        std::shared_ptr<ReadOnlyMemoryRegion>* region)
+      TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -310,6 +402,12 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Reads the tensor keyed by "key" from the base bundle, and overwrites it
+  // with the rows stored in the delta entry "entry".
+  // REQUIRES: entry.has_delta_row_ids()
+  Status GetDeltaValue(StringPiece key, const BundleEntryProto& entry,
+                       Tensor* val) TF_MUST_USE_RESULT;
+
   Env* env_;  // Not owned.
   const string prefix_;
 
@@ -321,6 +419,13 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Whether data files are memory-mapped, and the mapped files by shard id.
+  // A null region marks a shard whose file system cannot map it.  Regions are
+  // shared with the tensors aliasing them, which may outlive the reader.
+  bool use_mmap_ = false;
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -333,6 +438,11 @@ class BundleReader {
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
 
+  // Prefix of the base bundle of a delta bundle, and its reader, opened on
+  // the first lookup of a delta entry.
+  string base_prefix_;
+  std::unique_ptr<BundleReader> base_reader_;
+
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
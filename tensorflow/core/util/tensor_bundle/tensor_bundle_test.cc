@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/table_builder.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -1147,6 +1149,266 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, MmapRestore) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mmap"), opts);
+    TF_EXPECT_OK(writer.Add("float", Constant_100x100<float>(1.5)));
+    TF_EXPECT_OK(writer.Add("int", Constant_2x3<int32>(7)));
+    TF_EXPECT_OK(writer.Add("string", Constant_2x3<tstring>("hello")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor mapped_float;
+  {
+    BundleReader::Options options;
+    options.use_mmap = true;
+    BundleReader reader(Env::Default(), Prefix("mmap"), options);
+    TF_ASSERT_OK(reader.status());
+    EXPECT_TRUE(reader.use_mmap());
+    Expect<float>(&reader, "float", Constant_100x100<float>(1.5));
+    Expect<int32>(&reader, "int", Constant_2x3<int32>(7));
+    Expect<tstring>(&reader, "string", Constant_2x3<tstring>("hello"));
+
+    // Numeric tensors alias the mapped file and so never claim to be the sole
+    // owner of their buffer; string tensors are read into owned memory.
+    TF_ASSERT_OK(reader.Lookup("float", &mapped_float));
+    EXPECT_FALSE(mapped_float.RefCountIsOne());
+    EXPECT_TRUE(mapped_float.IsAligned());
+    Tensor string_val;
+    TF_ASSERT_OK(reader.Lookup("string", &string_val));
+    EXPECT_TRUE(string_val.RefCountIsOne());
+  }
+  // Mapped tensors stay valid after the reader is gone.
+  test::ExpectTensorEqual<float>(mapped_float, Constant_100x100<float>(1.5));
+}
+
+TEST(TensorBundleTest, MmapRestoreWithAlignForMmapEnvVar) {
+  setenv("TF_BUNDLE_WRITER_ALIGN_FOR_MMAP", "true", /*overwrite=*/1);
+  {
+    BundleWriter writer(Env::Default(), Prefix("mmap_env"));
+    // The bool would leave "float" unaligned in a densely packed bundle.
+    TF_EXPECT_OK(writer.Add("a", Constant(true, TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  unsetenv("TF_BUNDLE_WRITER_ALIGN_FOR_MMAP");
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap_env"), options);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("float", &val));
+  EXPECT_FALSE(val.RefCountIsOne());
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2));
+}
+
+TEST(TensorBundleTest, IndexFilterAndSharedIndexCache) {
+  {
+    BundleWriter::Options opts;
+    opts.index_filter_bits_per_key = 10;
+    BundleWriter writer(Env::Default(), Prefix("filter"), opts);
+    for (int i = 0; i < 100; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("tensor_", i),
+                              Constant_2x3<int32>(i)));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  std::unique_ptr<table::Cache> index_cache(table::NewLRUCache(1 << 20));
+  BundleReader::Options options;
+  options.index_cache = index_cache.get();
+  for (int r = 0; r < 2; ++r) {
+    BundleReader reader(Env::Default(), Prefix("filter"), options);
+    TF_ASSERT_OK(reader.status());
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_TRUE(reader.Contains(strings::StrCat("tensor_", i)));
+      EXPECT_FALSE(reader.Contains(strings::StrCat("missing_", i)));
+    }
+    Expect<int32>(&reader, "tensor_42", Constant_2x3<int32>(42));
+    Tensor val;
+    EXPECT_TRUE(errors::IsNotFound(reader.Lookup("missing_42", &val)));
+  }
+}
+
+TEST(TensorBundleTest, MmapRestoreUnalignedFallsBack) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("mmap_unaligned"));
+    TF_EXPECT_OK(writer.Add("a", Constant(true, TensorShape({3}))));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap_unaligned"), options);
+  TF_ASSERT_OK(reader.status());
+  // "b" is densely packed after "a", so it cannot be aliased.
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("b", &val));
+  EXPECT_TRUE(val.RefCountIsOne());
+  test::ExpectTensorEqual<float>(val, Constant_2x3<float>(2));
+}
+
+TEST(TensorBundleTest, MmapRestoreChecksum) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mmap_checksum"), opts);
+    TF_EXPECT_OK(writer.Add("foo", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Corrupts the first byte of the data file.
+  const string datafile = DataFilename(Prefix("mmap_checksum"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data[0] = ~data[0];
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+
+  BundleReader::Options options;
+  options.use_mmap = true;
+  BundleReader reader(Env::Default(), Prefix("mmap_checksum"), options);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  const Status status = reader.Lookup("foo", &val);
+  EXPECT_TRUE(errors::IsDataLoss(status));
+  EXPECT_TRUE(absl::StrContains(status.ToString(), "Checksum does not match"));
+}
+
+TEST(TensorBundleTest, DeltaRows) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta_base"));
+    TF_EXPECT_OK(writer.Add(
+        "embedding",
+        test::AsTensor<float>({0, 1, 2, 3, 4, 5, 6, 7}, TensorShape({4, 2}))));
+    TF_EXPECT_OK(writer.Add("step", Constant<int64_t>(1, TensorShape({}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("delta_base");
+    BundleWriter writer(Env::Default(), Prefix("delta_1"), opts);
+    TF_EXPECT_OK(writer.AddDeltaRows(
+        "embedding", TensorShape({4, 2}), test::AsTensor<int64_t>({1, 3}),
+        test::AsTensor<float>({10, 11, 30, 31}, TensorShape({2, 2}))));
+    TF_EXPECT_OK(writer.Add("step", Constant<int64_t>(2, TensorShape({}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    // A delta on top of a delta, with no changed rows.
+    BundleWriter::Options opts;
+    opts.base_prefix = Prefix("delta_1");
+    BundleWriter writer(Env::Default(), Prefix("delta_2"), opts);
+    TF_EXPECT_OK(writer.AddDeltaRows(
+        "embedding", TensorShape({4, 2}),
+        test::AsTensor<int64_t>({}, TensorShape({0})),
+        Tensor(DT_FLOAT, TensorShape({0, 2}))));
+    TF_EXPECT_OK(writer.Add("step", Constant<int64_t>(3, TensorShape({}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const Tensor expected_embedding =
+      test::AsTensor<float>({0, 1, 10, 11, 4, 5, 30, 31}, TensorShape({4, 2}));
+  {
+    BundleReader reader(Env::Default(), Prefix("delta_1"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "embedding", expected_embedding);
+    Expect<int64_t>(&reader, "step", Constant<int64_t>(2, TensorShape({})));
+  }
+  {
+    BundleReader reader(Env::Default(), Prefix("delta_2"));
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "embedding", expected_embedding);
+    Expect<int64_t>(&reader, "step", Constant<int64_t>(3, TensorShape({})));
+    reader.Seek("embedding");
+    Tensor val;
+    TF_ASSERT_OK(reader.ReadCurrent(&val));
+    test::ExpectTensorEqual<float>(val, expected_embedding);
+  }
+}
+
+TEST(TensorBundleTest, DeltaRowsErrors) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta_no_base"));
+    EXPECT_TRUE(errors::IsFailedPrecondition(writer.AddDeltaRows(
+        "foo", TensorShape({2, 1}), test::AsTensor<int64_t>({0}),
+        Constant<float>(1, TensorShape({1, 1})))));
+  }
+  BundleWriter::Options opts;
+  opts.base_prefix = Prefix("delta_base_errors");
+  BundleWriter writer(Env::Default(), Prefix("delta_errors"), opts);
+  // Out of range row id.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.AddDeltaRows(
+      "foo", TensorShape({2, 1}), test::AsTensor<int64_t>({2}),
+      Constant<float>(1, TensorShape({1, 1})))));
+  // Mismatched rows shape.
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.AddDeltaRows(
+      "foo", TensorShape({2, 1}), test::AsTensor<int64_t>({0}),
+      Constant<float>(1, TensorShape({1, 2})))));
+  EXPECT_TRUE(errors::IsUnimplemented(writer.AddDeltaRows(
+      "foo", TensorShape({2, 1}), test::AsTensor<int64_t>({0}),
+      Constant<tstring>("a", TensorShape({1, 1})))));
+}
+
+TEST(TensorBundleTest, MergeDeltaBundles) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("merge_delta_base"));
+    TF_EXPECT_OK(writer.Add("a", Constant<float>(0, TensorShape({3, 1}))));
+    TF_EXPECT_OK(writer.Add("b", Constant<float>(0, TensorShape({3, 1}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleWriter::Options opts;
+  opts.base_prefix = Prefix("merge_delta_base");
+  {
+    BundleWriter writer(Env::Default(), Prefix("merge_delta_0"), opts);
+    TF_EXPECT_OK(writer.AddDeltaRows("a", TensorShape({3, 1}),
+                                     test::AsTensor<int64_t>({2}),
+                                     Constant<float>(1, TensorShape({1, 1}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("merge_delta_1"), opts);
+    TF_EXPECT_OK(writer.AddDeltaRows("b", TensorShape({3, 1}),
+                                     test::AsTensor<int64_t>({0}),
+                                     Constant<float>(2, TensorShape({1, 1}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(),
+                            {Prefix("merge_delta_0"), Prefix("merge_delta_1")},
+                            Prefix("merge_delta")));
+
+  BundleReader reader(Env::Default(), Prefix("merge_delta"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "a",
+                test::AsTensor<float>({0, 0, 1}, TensorShape({3, 1})));
+  Expect<float>(&reader, "b",
+                test::AsTensor<float>({2, 0, 0}, TensorShape({3, 1})));
+}
+
+TEST(TensorBundleTest, CopyBundle) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("copy_0"));
+    TF_EXPECT_OK(writer.Add("a", Constant<float>(1, TensorShape({2, 3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("copy_1"));
+    TF_EXPECT_OK(writer.Add("b", Constant<int32>(2, TensorShape({4}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(Env::Default(),
+                            {Prefix("copy_0"), Prefix("copy_1")},
+                            Prefix("copy_src")));
+  TF_ASSERT_OK(CopyBundle(Env::Default(), Prefix("copy_src"),
+                          Prefix("copy_dst/ckpt")));
+
+  BundleReader reader(Env::Default(), Prefix("copy_dst/ckpt"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(AllTensorKeys(&reader), std::vector<string>({"a", "b"}));
+  Expect<float>(&reader, "a", Constant<float>(1, TensorShape({2, 3})));
+  Expect<int32>(&reader, "b", Constant<int32>(2, TensorShape({4})));
+
+  EXPECT_TRUE(errors::IsNotFound(CopyBundle(
+      Env::Default(), Prefix("copy_missing"), Prefix("copy_dst/other"))));
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
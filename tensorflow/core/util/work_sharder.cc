@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
@@ -54,6 +57,42 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
       max_parallelism);
 }
 
+int64_t AdaptiveShardCost::CostPerUnit(int64_t total) const {
+  const int64_t cost_per_unit_ps =
+      cost_per_unit_ps_[Log2Floor64(std::max<int64_t>(1, total))].load(
+          std::memory_order_relaxed);
+  if (cost_per_unit_ps == 0) return initial_cost_per_unit_;
+  return std::max<int64_t>(1, cost_per_unit_ps / 1000);
+}
+
+void AdaptiveShardCost::Update(int64_t total, int64_t nanos) {
+  if (total <= 0) return;
+  std::atomic<int64_t>& cost_per_unit_ps =
+      cost_per_unit_ps_[Log2Floor64(total)];
+  const int64_t measured = std::max<int64_t>(1, nanos * 1000 / total);
+  const int64_t previous = cost_per_unit_ps.load(std::memory_order_relaxed);
+  // The moving average follows changes in the cost without being thrown off
+  // by a single slow call, e.g. one preempted. Concurrent updates may be lost,
+  // which is fine for an estimate.
+  cost_per_unit_ps.store(
+      previous == 0 ? measured : previous + (measured - previous) / 8,
+      std::memory_order_relaxed);
+}
+
+void ShardWithAdaptiveCost(int max_parallelism, thread::ThreadPool* workers,
+                           int64_t total, AdaptiveShardCost* cost,
+                           std::function<void(int64_t, int64_t)> work) {
+  std::atomic<int64_t> work_nanos(0);
+  Shard(max_parallelism, workers, total, cost->CostPerUnit(total),
+        [&work, &work_nanos](int64_t start, int64_t limit) {
+          const uint64 start_nanos = EnvTime::NowNanos();
+          work(start, limit);
+          work_nanos.fetch_add(EnvTime::NowNanos() - start_nanos,
+                               std::memory_order_relaxed);
+        });
+  cost->Update(total, work_nanos.load(std::memory_order_relaxed));
+}
+
 // DEPRECATED: Prefer threadpool->ParallelFor with SchedulingStrategy, which
 // allows you to specify the strategy for choosing shard sizes, including using
 // a fixed shard size.
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 
+#include <atomic>
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -59,6 +60,48 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
            int64_t cost_per_unit, std::function<void(int64_t, int64_t)> work);
 
+// Estimates the cost per unit of the work of a Shard() call site from the time
+// its previous calls took, instead of a static estimate that may be off by an
+// order of magnitude. The estimate is kept per power of 2 of "total", as the
+// cost per unit often depends on the size of the work, e.g. once its data
+// doesn't fit in a cache anymore. Thread-safe, so a call site (e.g. a kernel)
+// can own a static instance:
+//
+//   static AdaptiveShardCost* cost =
+//       new AdaptiveShardCost(/*initial_cost_per_unit=*/100);
+//   ShardWithAdaptiveCost(worker_threads.num_threads,
+//                         worker_threads.workers, total, cost, work);
+class AdaptiveShardCost {
+ public:
+  // "initial_cost_per_unit" is used until a call of a similar size is
+  // measured.
+  explicit AdaptiveShardCost(int64_t initial_cost_per_unit)
+      : initial_cost_per_unit_(initial_cost_per_unit) {}
+
+  // Returns the estimated cost per unit of a call of "total" units, in
+  // nanoseconds.
+  int64_t CostPerUnit(int64_t total) const;
+
+  // Updates the estimate with a call of "total" units, whose shards took
+  // "nanos" nanoseconds in all.
+  void Update(int64_t total, int64_t nanos);
+
+ private:
+  const int64_t initial_cost_per_unit_;
+  // A moving average of the cost per unit in picoseconds, to keep the
+  // precision of cheap units, or 0 if there is no measure yet, by the power of
+  // 2 of the total.
+  std::atomic<int64_t> cost_per_unit_ps_[64] = {};
+};
+
+// Like Shard() above, but with the cost per unit estimated by "cost", which is
+// updated with the time the shards take.
+//
+// REQUIRES: cost != nullptr
+void ShardWithAdaptiveCost(int max_parallelism, thread::ThreadPool* workers,
+                           int64_t total, AdaptiveShardCost* cost,
+                           std::function<void(int64_t, int64_t)> work);
+
 // Each thread has an associated option to express the desired maximum
 // parallelism. Its default is a very large quantity.
 //
@@ -93,6 +93,34 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(AdaptiveShardCost, EstimatesByPowerOfTwoOfTotal) {
+  AdaptiveShardCost cost(/*initial_cost_per_unit=*/100);
+  EXPECT_EQ(cost.CostPerUnit(1000), 100);
+
+  cost.Update(/*total=*/1000, /*nanos=*/10000);
+  EXPECT_EQ(cost.CostPerUnit(1000), 10);
+  EXPECT_EQ(cost.CostPerUnit(600), 10);
+  EXPECT_EQ(cost.CostPerUnit(1 << 20), 100);
+
+  // Later measures only move the estimate part of the way.
+  cost.Update(/*total=*/1000, /*nanos=*/90000);
+  EXPECT_EQ(cost.CostPerUnit(1000), 20);
+}
+
+TEST(Shard, AdaptiveCost) {
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  // The initial estimate is far too high for the work.
+  AdaptiveShardCost cost(/*initial_cost_per_unit=*/1 << 30);
+  const int64_t total = 1000;
+  std::atomic<int64_t> num_elements(0);
+  ShardWithAdaptiveCost(4, &threads, total, &cost,
+                        [&num_elements](int64_t start, int64_t limit) {
+                          num_elements += limit - start;
+                        });
+  EXPECT_EQ(num_elements.load(), total);
+  EXPECT_LT(cost.CostPerUnit(total), 1 << 30);
+}
+
 void BM_Sharding(::testing::benchmark::State& state) {
   const int arg = state.range(0);
 
@@ -318,7 +318,25 @@ class DTensorDevice {
                               eager_executor_->WaitForAllPendingNodes());
 
     if (TF_GetCode(status) != TF_OK) {
-      first_bad_status.reset(status);
+      // Copied, as `first_bad_status` owns its status.
+      first_bad_status.reset(TF_NewStatus());
+      TF_SetStatus(first_bad_status.get(), TF_GetCode(status),
+                   TF_Message(status));
+    }
+
+    std::vector<Future<Status>> pending_executions;
+    {
+      mutex_lock lock(mu_pending_executions_);
+      pending_executions.swap(pending_executions_);
+    }
+    for (Future<Status>& execution : pending_executions) {
+      const Status execution_status = execution.Await();
+      if (!execution_status.ok() &&
+          (first_bad_status == nullptr ||
+           TF_GetCode(first_bad_status.get()) == TF_CANCELLED)) {
+        first_bad_status.reset(TF_NewStatus());
+        Set_TF_Status_from_Status(first_bad_status.get(), execution_status);
+      }
     }
 
     for (const auto& pair : mesh_to_device_map_) {
@@ -694,6 +712,13 @@ class DTensorDevice {
   // Dispatchs functions for Pathways.
   std::unique_ptr<ParallelExecutor> parallel_executor_;
 
+  // In async mode, the executions of `parallel_executor_` that AsyncWait()
+  // hasn't waited for yet. Their outputs are handed out before they complete,
+  // so that the ops of other meshes can be dispatched in the meantime.
+  mutex mu_pending_executions_;
+  std::vector<Future<Status>> pending_executions_
+      TF_GUARDED_BY(mu_pending_executions_);
+
   // Dispatchs functions for TensorFlow.
   std::unique_ptr<EagerExecutor> eager_executor_;
 
@@ -1297,12 +1322,16 @@ bool DTensorDevice::IsSparseDTensor(TFE_Context* context,
 std::unordered_map<std::string, int> DTensorDevice::GetFunctionCacheStats(
     TFE_Context* context, TF_Status* status) const {
   const auto stats = function_manager_->GetStats();
+  const auto module_stats = module_manager_->GetStats();
 
   const auto eager_stats = tensorflow::unwrap(context)->GetCacheStats();
   std::unordered_map<std::string, int> result{
       {"hit", stats.hits},
       {"miss", stats.misses},
       {"size", stats.size},
+      {"module_cache.hit", module_stats.hits},
+      {"module_cache.miss", module_stats.misses},
+      {"module_cache.size", module_stats.size},
       {"device_cache.size", eager_stats.device_cache_size},
       {"kernel_cache.size", eager_stats.kernel_cache_size},
       {"local_rendezvous_cache.active.size",
@@ -1824,7 +1853,23 @@ void DTensorDevice::ParallelExecuteRegularOperation(
       ParallelExecutor::ExecutionResult execution_result,
       parallel_executor_->Execute(context, inputs, mlir_module, attributes),
       status);
-  RETURN_C_STATUS_IF_NOT_OK(execution_result.status.Await(), status);
+  if (is_async_) {
+    // The outputs are filled when the execution completes, and the parallel
+    // executor orders the executions reading them after it. Errors are
+    // reported by AsyncWait().
+    mutex_lock lock(mu_pending_executions_);
+    // Drops the executions that already succeeded, so that the list doesn't
+    // grow unbounded between calls to AsyncWait().
+    pending_executions_.erase(
+        std::remove_if(pending_executions_.begin(), pending_executions_.end(),
+                       [](Future<Status>& execution) {
+                         return execution.IsReady() && execution.Await().ok();
+                       }),
+        pending_executions_.end());
+    pending_executions_.push_back(std::move(execution_result.status));
+  } else {
+    RETURN_C_STATUS_IF_NOT_OK(execution_result.status.Await(), status);
+  }
 
   std::vector<TensorWithLayout*> typed_outputs = execution_result.outputs;
   // assign outputs and take outputs' ownership
@@ -365,7 +365,9 @@ class DTensorDevice(object):
         'miss': number of cache misses;
         'hit': number of cache hits; and
         'size': size of cache;
-      miss count.
+      miss count. The same counts for the cache of the MLIR modules the
+      functions are lowered from are under 'module_cache.miss',
+      'module_cache.hit' and 'module_cache.size'.
     """
     return _pywrap_dtensor_device.GetFunctionCacheStats(
         context.context()._handle,  # pylint: disable=protected-access,
@@ -125,6 +125,10 @@ class AsyncSubgraph {
   // `task` should not be nullptr.
   // Returns kTfLiteError if any backend kernels failed to schedule
   // the execution.
+  // Several tasks, each with its own buffers, can be scheduled before waiting
+  // for any of them, e.g. to prepare the inputs of the next execution while
+  // the backend runs the current one. Their completion is signaled by the
+  // synchronization objects of their outputs.
   TfLiteStatus InvokeAsync(TfLiteExecutionTask* task);
 
   // Blocks and wait for execution tied to `task` to finish.
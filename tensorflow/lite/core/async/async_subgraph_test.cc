@@ -155,6 +155,32 @@ TEST_F(AsyncSubgraphTest, BasicTest) {
   EXPECT_NE(handle, another_handle);
 }
 
+TEST_F(AsyncSubgraphTest, MultipleTasksInFlight) {
+  BuildAsyncSubgraph();
+
+  EXPECT_CALL(*kernel_, Eval(_, _, _)).Times(2);
+  EXPECT_CALL(*kernel_, Wait(_, _)).Times(2);
+  EXPECT_CALL(*kernel_, Finish(_, _)).Times(2);
+
+  auto* task = subgraph_->CreateTask();
+  auto* next_task = subgraph_->CreateTask();
+  EXPECT_EQ(kTfLiteOk, subgraph_->InvokeAsync(task));
+  // The next execution is scheduled before the first one finished.
+  EXPECT_EQ(kTfLiteOk, subgraph_->InvokeAsync(next_task));
+  EXPECT_TRUE(task->task->Scheduled());
+  EXPECT_TRUE(next_task->task->Scheduled());
+
+  EXPECT_EQ(kTfLiteOk, subgraph_->Wait(task));
+  EXPECT_FALSE(task->task->Scheduled());
+  EXPECT_TRUE(next_task->task->Scheduled());
+  EXPECT_EQ(kTfLiteOk, subgraph_->Wait(next_task));
+  EXPECT_FALSE(next_task->task->Scheduled());
+
+  // Deletes the tasks.
+  subgraph_->Finish(task);
+  subgraph_->Finish(next_task);
+}
+
 TEST_F(AsyncSubgraphTest, OutOfBoundTest) {
   BuildAsyncSubgraph();
   auto* attrs = new TfLiteAttributeMap(kTfLiteAttrMapTypeBuffer);
@@ -371,8 +371,10 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
             reinterpret_cast<const char*>(op->custom_options()->data()),
             op->custom_options()->size(), nullptr, registration);
       } else if (op->custom_options_offset() > 1 && allocation_) {
-        if (op->custom_options_offset() + op->custom_options_size() >
-            allocation_->bytes()) {
+        // Written so that a huge offset or size can't overflow the sum.
+        if (op->custom_options_offset() > allocation_->bytes() ||
+            op->custom_options_size() >
+                allocation_->bytes() - op->custom_options_offset()) {
           TF_LITE_REPORT_ERROR(
               error_reporter_,
               "Custom Option Offset for opcode_index %d is out of bound\n",
@@ -643,7 +645,9 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
           *buffer_data = reinterpret_cast<const char*>(array->data());
           return kTfLiteOk;
         } else if (offset > 1 && allocation_) {
-          if (offset + buffer->size() > allocation_->bytes()) {
+          // Written so that a huge offset or size can't overflow the sum.
+          if (offset > allocation_->bytes() ||
+              buffer->size() > allocation_->bytes() - offset) {
             TF_LITE_REPORT_ERROR(
                 error_reporter_,
                 "Constant buffer %d specified an out of range offset.\n",
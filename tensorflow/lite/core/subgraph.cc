@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/lite/simple_planner.h"
 #else
 #include "tensorflow/lite/arena_planner.h"
+#include "tensorflow/lite/offline_planner.h"
 #endif
 #ifdef TF_LITE_TENSORFLOW_PROFILER
 #include "tensorflow/lite/tensorflow_profiler_logger.h"
@@ -130,6 +131,34 @@ bool HasDynamicTensor(const TfLiteContext& context,
                               dynamic_tensor_index);
 }
 
+// Fills `signature` with what the preparation of `node` depends on: the number
+// of threads, and the types and shapes of its inputs. Returns false if the
+// preparation may also depend on the contents of its inputs, i.e. if one of
+// them is computed when its producer is prepared.
+bool GetPrepareSignature(const TfLiteContext& context, const TfLiteNode& node,
+                         std::vector<int>* signature) {
+  signature->clear();
+  signature->push_back(context.recommended_num_threads);
+  signature->push_back(node.inputs->size);
+  for (int i : TfLiteIntArrayView(node.inputs)) {
+    if (i == kTfLiteOptionalTensor) {
+      signature->push_back(kTfLiteOptionalTensor);
+      continue;
+    }
+    const TfLiteTensor& tensor = context.tensors[i];
+    if (tensor.allocation_type == kTfLitePersistentRo) {
+      return false;
+    }
+    signature->push_back(tensor.type);
+    const TfLiteIntArray* dims = tensor.dims;
+    signature->push_back(dims == nullptr ? -1 : dims->size);
+    if (dims != nullptr) {
+      signature->insert(signature->end(), dims->data, dims->data + dims->size);
+    }
+  }
+  return true;
+}
+
 // Gets the legacy TfLiteQuantizationParams from the current TfLiteQuantization.
 TfLiteQuantizationParams GetLegacyQuantization(
     const TfLiteQuantization& quantization) {
@@ -918,7 +947,12 @@ TfLiteStatus Subgraph::AllocateTensors() {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
-  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  // When only input tensors were resized, the nodes whose inputs kept their
+  // shapes don't need to be prepared again.
+  skip_prepare_of_unchanged_nodes_ = true;
+  const TfLiteStatus prepare_status = PrepareOpsAndTensors();
+  skip_prepare_of_unchanged_nodes_ = false;
+  TF_LITE_ENSURE_STATUS(prepare_status);
 
   state_ = kStateInvokable;
 
@@ -990,6 +1024,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
     return kTfLiteError;
   }
   state_ = kStateUninvokable;
+  prepare_signatures_.clear();
 
   TF_LITE_ENSURE_OK(&context_, CheckTensorIndices("node inputs", inputs.data(),
                                                   inputs.size()));
@@ -1142,6 +1177,7 @@ TfLiteStatus Subgraph::ResizeInputTensorStrict(int tensor_index,
 
 TfLiteStatus Subgraph::ReleaseNonPersistentMemory() {
   state_ = kStateUninvokable;
+  prepare_signatures_.clear();
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ReleaseNonPersistentMemory());
   }
@@ -1366,22 +1402,35 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     has_dynamic_tensors_ =
         HasDynamicTensorImpl(context_, outputs(), &dynamic_tensor_index_);
   }
+  if (prepare_signatures_.size() < nodes_and_registration_.size()) {
+    prepare_signatures_.resize(nodes_and_registration_.size());
+  }
+  std::vector<int> signature;
   for (int execution_plan_index = first_execution_plan_index;
        execution_plan_index < execution_plan.size(); execution_plan_index++) {
     int node_index = execution_plan[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
-    EnsureTensorsVectorCapacity();
+    const bool has_signature = GetPrepareSignature(context_, node, &signature);
+    std::vector<int>& prepared_signature = prepare_signatures_[node_index];
+    if (!skip_prepare_of_unchanged_nodes_ || !has_signature ||
+        signature != prepared_signature) {
+      prepared_signature.clear();
+      EnsureTensorsVectorCapacity();
 #ifdef TF_LITE_TENSORFLOW_PROFILER
-    tflite::OnTfLiteOpPrepare(GetTFLiteOpName(registration), subgraph_index_,
-                              node_index);
+      tflite::OnTfLiteOpPrepare(GetTFLiteOpName(registration),
+                                subgraph_index_, node_index);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
-    const TfLiteStatus op_prepare_status = OpPrepare(registration, &node);
-    if (op_prepare_status != kTfLiteOk) {
-      ReportOpError(&context_, node, registration, node_index,
-                    "failed to prepare");
-      return op_prepare_status;
+      const TfLiteStatus op_prepare_status = OpPrepare(registration, &node);
+      if (op_prepare_status != kTfLiteOk) {
+        ReportOpError(&context_, node, registration, node_index,
+                      "failed to prepare");
+        return op_prepare_status;
+      }
+      if (has_signature) {
+        prepared_signature.swap(signature);
+      }
     }
 
     *last_execution_plan_index_prepared = execution_plan_index;
@@ -1431,9 +1480,18 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
-        &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
-        kDefaultTensorAlignment, subgraph_index_);
+    std::vector<int32_t> offline_offsets;
+    if (ShouldUseOfflineMemoryPlanner(&offline_offsets)) {
+      auto offline_planner = std::make_unique<OfflinePlanner>(
+          &context_, CreateGraphInfo(), kDefaultTensorAlignment,
+          subgraph_index_, std::move(offline_offsets));
+      offline_planner_ = offline_planner.get();
+      memory_planner_ = std::move(offline_planner);
+    } else {
+      memory_planner_ = std::make_unique<ArenaPlanner>(
+          &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
+          kDefaultTensorAlignment, subgraph_index_);
+    }
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1783,6 +1841,8 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
   }
 
   TfLiteTensor& tensor = context_.tensors[tensor_index];
+  // The nodes reading the tensor may depend on its contents.
+  prepare_signatures_.clear();
   if (type == tensor.type &&
       EqualArrayAndTfLiteIntArray(tensor.dims, ndims, dims)) {
     // Fast path which does not invalidate the invokable property.
@@ -1850,6 +1910,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadWrite(
   }
 
   TfLiteTensor& tensor = context_.tensors[tensor_index];
+  prepare_signatures_.clear();
 
   TfLiteTensorReset(type, name, ConvertArrayToTfLiteIntArray(ndims, dims),
                     GetLegacyQuantization(quantization),
@@ -2067,6 +2128,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
 
   // After undoing delegates, the graph is uninvokable, but mutable.
   state_ = kStateUninvokable;
+  prepare_signatures_.clear();
 
   delegates_undone_ = true;
   return kTfLiteOk;
@@ -2119,6 +2181,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
+    prepare_signatures_.clear();
     TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
@@ -2126,6 +2189,39 @@ TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   return kTfLiteOk;
 }
 
+bool Subgraph::ShouldUseOfflineMemoryPlanner(
+    std::vector<int32_t>* offline_offsets) {
+  offline_offsets->clear();
+  // OfflinePlanner frees tensors once they are no longer used.
+  if (ShouldPreserveAllTensors()) return false;
+#ifndef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+  if (metadata_) {
+    auto itr = metadata_->find(kOfflineMemoryAllocationMetadata);
+    if (itr != metadata_->end() &&
+        FindOfflineMemoryPlan(itr->second, subgraph_index_, offline_offsets)) {
+      if (offline_offsets->size() == tensors_.size()) return true;
+      TFLITE_LOG(tflite::TFLITE_LOG_WARNING,
+                 "Ignoring the offline memory plan of subgraph %d: it has %zu "
+                 "tensors but the plan has %zu.",
+                 subgraph_index_, tensors_.size(), offline_offsets->size());
+      offline_offsets->clear();
+    }
+  }
+#endif
+  return options_ && options_->GetUseOfflineMemoryPlanner();
+}
+
+TfLiteStatus Subgraph::GetOfflineMemoryPlan(
+    std::vector<int32_t>* offsets) const {
+#ifndef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+  if (offline_planner_ != nullptr && state_ != kStateUninvokable) {
+    *offsets = offline_planner_->tensor_offsets();
+    return kTfLiteOk;
+  }
+#endif
+  return kTfLiteError;
+}
+
 TfLiteStatus Subgraph::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
   auto status = ModifyGraphWithDelegateImpl(delegate);
   telemetry::TelemetryReportEvent(&context_, "ModifyGraphWithDelegate", status);
@@ -2171,6 +2267,7 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
     // tensors.
     // Reset the state to force tensor/op reallocation.
     state_ = kStateUninvokable;
+    prepare_signatures_.clear();
   } else if (!delegate_supports_dynamic_shapes) {
     // Check if graph has dynamic tensors by preparing ops.
     int last_execution_plan_index_prepared;
@@ -2211,6 +2308,7 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
     // CASE 1: Current delegate does not support dynamic shapes.
     // Reset the state to force tensor/op reallocation.
     state_ = kStateUninvokable;
+    prepare_signatures_.clear();
     TF_LITE_ENSURE_STATUS(
         reset_delegation_if_not_ok(EnsureMemoryAllocations()));
     // After using a delegate which doesn't support dynamic tensors, make the
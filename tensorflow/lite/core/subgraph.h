@@ -42,6 +42,8 @@ limitations under the License.
 
 namespace tflite {
 
+class OfflinePlanner;
+
 #ifndef DOXYGEN_SKIP
 class SingleOpModel;  // Class for friend declarations.
 
@@ -447,6 +449,13 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Copies to `offsets` the non-persistent arena offsets of all tensors, as
+  // planned by OfflinePlanner, so that they can be saved in the model metadata
+  // with AppendOfflineMemoryPlan. Fails if the subgraph doesn't use
+  // OfflinePlanner, or if its tensors aren't allocated.
+  TfLiteStatus GetOfflineMemoryPlan(std::vector<int32_t>* offsets) const;
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -838,6 +847,11 @@ class Subgraph {
   // Ensures the memory required is planned and allocated.
   TfLiteStatus EnsureMemoryAllocations();
 
+  // Returns true if the memory of this subgraph should be planned by
+  // OfflinePlanner, and sets `offline_offsets` to the offsets persisted in the
+  // model metadata for it, if any.
+  bool ShouldUseOfflineMemoryPlanner(std::vector<int32_t>* offline_offsets);
+
   // Enables cancellation of in flight invocation with `Cancel` call.
   // Should only be called by the interpreter when building the subgraph.
   // `flag` should be nullptr otherwise cancellation is disabled.
@@ -979,6 +993,16 @@ class Subgraph {
   // TODO(b/127354079): Improve ArenaPlanner and remove this mechanism.
   int next_execution_plan_index_to_plan_allocation_;
 
+  // The signature (see `GetPrepareSignature`) of each node the last time it
+  // was prepared, or an empty vector if it has to be prepared again. Cleared
+  // whenever the graph changes in a way that may change what its nodes are
+  // prepared with, other than by resizing input tensors.
+  std::vector<std::vector<int>> prepare_signatures_;
+
+  // True while `AllocateTensors` prepares the nodes, in which case the nodes
+  // whose signature didn't change since they were last prepared are skipped.
+  bool skip_prepare_of_unchanged_nodes_ = false;
+
   // WARNING: This is an experimental interface that is subject to change.
   // This is a list of node indices (to index into nodes_and_registration).
   // This represents a valid topological sort (dependency ordered) execution
@@ -1006,6 +1030,9 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Set if memory_planner_ is an OfflinePlanner.
+  OfflinePlanner* offline_planner_ = nullptr;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
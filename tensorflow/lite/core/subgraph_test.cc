@@ -258,5 +258,76 @@ TEST_F(SubgraphResizeTensorTest,
   std::fill_n(tensor_.dims->data, tensor_.dims->size, 1);
 }
 
+// A copy op whose nodes count how many times they are prepared, in the int
+// pointed to by their init data.
+TfLiteRegistration CountingCopyRegistration() {
+  TfLiteRegistration registration = {};
+  registration.init = [](TfLiteContext*, const char* buffer, size_t) {
+    return static_cast<void*>(const_cast<char*>(buffer));
+  };
+  registration.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++*static_cast<int*>(node->user_data);
+    const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+    TfLiteTensor& output = context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, &output,
+                                 TfLiteIntArrayCopy(input.dims));
+  };
+  registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+    TfLiteTensor& output = context->tensors[node->outputs->data[0]];
+    std::copy_n(input.data.raw, input.bytes, output.data.raw);
+    return kTfLiteOk;
+  };
+  return registration;
+}
+
+TEST(SubgraphPrepareTest, OnlyNodesWithResizedInputsArePreparedAgain) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(4), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({2, 3}), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {1}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  TfLiteRegistration registration = CountingCopyRegistration();
+  int first_prepare_count = 0;
+  int second_prepare_count = 0;
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {0}, {2}, reinterpret_cast<const char*>(&first_prepare_count),
+                sizeof(int), nullptr, &registration),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AddNodeWithParameters(
+                {1}, {3}, reinterpret_cast<const char*>(&second_prepare_count),
+                sizeof(int), nullptr, &registration),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(first_prepare_count, 1);
+  EXPECT_EQ(second_prepare_count, 1);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(first_prepare_count, 2);
+  EXPECT_EQ(second_prepare_count, 1);
+  EXPECT_THAT(std::vector<int>(interpreter.tensor(2)->dims->data,
+                               interpreter.tensor(2)->dims->data + 1),
+              ElementsAreArray({3}));
+
+  std::fill_n(interpreter.typed_tensor<float>(0), 3, 1.0f);
+  interpreter.typed_tensor<float>(1)[0] = 2.0f;
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_THAT(std::vector<float>(interpreter.typed_tensor<float>(2),
+                                 interpreter.typed_tensor<float>(2) + 3),
+              ElementsAreArray({1.0f, 1.0f, 1.0f}));
+  EXPECT_EQ(interpreter.typed_tensor<float>(3)[0], 2.0f);
+
+  // Releasing the memory requires all the nodes to be prepared again.
+  ASSERT_EQ(interpreter.ReleaseNonPersistentMemory(), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(first_prepare_count, 3);
+  EXPECT_EQ(second_prepare_count, 2);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -188,6 +188,21 @@ class Delegate {
     }
   }
 
+  // If serialization is enabled without a model_token, derives the token from
+  // the model of `context`, so that every model gets its own entries.
+  void PrepareSerialization(const TfLiteContext* context) {
+    if (!(options_.experimental_flags &
+          TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION) ||
+        options_.model_token || !options_.serialization_dir) {
+      return;
+    }
+    const std::string model_token = delegates::StrModelFingerprint(context);
+    SerializationParams params;
+    params.model_token = model_token.c_str();
+    params.cache_dir = options_.serialization_dir;
+    serialization_ = std::make_unique<Serialization>(params);
+  }
+
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
@@ -1462,6 +1477,7 @@ TfLiteRegistration CreateAsyncRegistration() {
 
 TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   auto* gpu_delegate = GetDelegate(delegate);
+  gpu_delegate->PrepareSerialization(context);
 
   const TfLiteRegistration kRegistration =
 #if defined(__ANDROID__)
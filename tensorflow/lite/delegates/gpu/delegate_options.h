@@ -67,8 +67,8 @@ enum TfLiteGpuExperimentalFlags {
   // model or inference params. Later initializations are fast.
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // NOTE: User also needs to set serialization_dir in
+  // TfLiteGpuDelegateOptionsV2, and should set model_token if it is known.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
 };
@@ -133,8 +133,10 @@ typedef struct {
   // For an example of how to generate this from a TFLite model, see
   // StrFingerprint() in lite/delegates/serialization.h.
   //
-  // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(). If serialization is
+  // enabled and the token is nullptr, the delegate derives a token from the
+  // tensors and constants of the model (see StrModelFingerprint()), which reads
+  // all the constants of the model on every initialization.
   const char* model_token;
 
 #ifdef TFLITE_DEBUG_DELEGATE
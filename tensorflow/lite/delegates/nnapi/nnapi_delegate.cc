@@ -6925,12 +6925,16 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
       .version = 1,
   };
 
-  // Initialize caching, if applicable, from Options.
+  // Initialize caching, if applicable, from Options. Without a model_token,
+  // the token is derived from the model, so that every model gets its own
+  // cache entries.
   const char* cache_dir = delegate_options.cache_dir;
-  const char* model_token = delegate_options.model_token;
-  delegates::SerializationParams params = {model_token, cache_dir};
-  if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir &&
-      model_token) {
+  if (nnapi->android_sdk_version >= kMinSdkVersionForNNAPI12 && cache_dir) {
+    const std::string model_token =
+        delegate_options.model_token
+            ? std::string(delegate_options.model_token)
+            : delegates::StrModelFingerprint(context);
+    delegates::SerializationParams params = {model_token.c_str(), cache_dir};
     delegate_data->cache = std::make_unique<delegates::Serialization>(params);
   }
 
@@ -71,11 +71,14 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     const char* cache_dir = nullptr;
 
     // The unique nul-terminated token string for NNAPI model.
-    // Default to nullptr, which implies the NNAPI will not try caching the
-    // compilation. It is the caller's responsibility to ensure there is no
-    // clash of the tokens.
-    // NOTE: when using compilation caching, it is not recommended to use the
-    // same delegate instance for multiple models.
+    // Default to nullptr. If cache_dir is set and the token is nullptr, the
+    // delegate derives a token from the tensors and constants of the model
+    // (see StrModelFingerprint() in lite/delegates/serialization.h), which
+    // reads all the constants of the model every time the delegate is
+    // applied. Otherwise, it is the caller's responsibility to ensure there is
+    // no clash of the tokens.
+    // NOTE: when using compilation caching with an explicit token, it is not
+    // recommended to use the same delegate instance for multiple models.
     const char* model_token = nullptr;
 
     // Whether to disallow NNAPI CPU usage. Only effective on Android 10 and
@@ -77,6 +77,35 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
       ::util::Fingerprint64(reinterpret_cast<const char*>(data), num_bytes));
 }
 
+std::string StrModelFingerprint(const TfLiteContext* context) {
+  const uint64_t num_tensors = context->tensors_size;
+  uint64_t fingerprint = ::util::Fingerprint64(
+      reinterpret_cast<const char*>(&num_tensors), sizeof(num_tensors));
+  std::vector<int32_t> tensor_data;
+  for (size_t i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    tensor_data.clear();
+    tensor_data.push_back(tensor.type);
+    if (tensor.dims) {
+      tensor_data.insert(tensor_data.end(), tensor.dims->data,
+                         tensor.dims->data + tensor.dims->size);
+    }
+    fingerprint = CombineFingerprints(
+        fingerprint,
+        ::util::Fingerprint64(reinterpret_cast<char*>(tensor_data.data()),
+                                tensor_data.size() * sizeof(int32_t)));
+    if (tensor.allocation_type == kTfLiteMmapRo &&
+        tensor.data.raw_const != nullptr) {
+      fingerprint = CombineFingerprints(
+          fingerprint,
+          ::util::Fingerprint64(
+              reinterpret_cast<const char*>(tensor.data.raw_const),
+              tensor.bytes));
+    }
+  }
+  return std::to_string(fingerprint);
+}
+
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
                                        const uint64_t fingerprint)
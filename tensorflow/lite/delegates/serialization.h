@@ -80,6 +80,13 @@ namespace delegates {
 //    model_token.
 std::string StrFingerprint(const void* data, const size_t num_bytes);
 
+// Helper to generate a model_token for the model of `context`, for clients
+// that don't have the model flatbuffer at hand. It fingerprints the type and
+// dims of every tensor, and the data of the read-only (constant) tensors, so
+// that models with different constants get different tokens.
+// NOTE: This reads all the constants of the model.
+std::string StrModelFingerprint(const TfLiteContext* context);
+
 // Encapsulates a unique blob of data serialized by a delegate.
 // Needs to be initialized with a Serialization instance.
 // Any data set with this entry is 'keyed' by a 64-bit fingerprint unique to the
@@ -232,6 +232,37 @@ TEST_F(SerializationTest, ModelTokenFingerprint) {
   ASSERT_EQ(entry1.GetFingerprint(), entry3.GetFingerprint());
 }
 
+TEST_F(SerializationTest, StrModelFingerprint) {
+  std::vector<float> constant1 = {1, 2, 3, 4};
+  std::vector<float> constant2 = {1, 2, 3, 5};
+  TfLiteContext context1 = GenerateTfLiteContext(/*num_tensors*/ 3);
+  TfLiteContext context2 = GenerateTfLiteContext(/*num_tensors*/ 3);
+  for (TfLiteContext* context : {&context1, &context2}) {
+    TfLiteTensor& tensor = context->tensors[1];
+    tensor.type = kTfLiteFloat32;
+    tensor.allocation_type = kTfLiteMmapRo;
+    tensor.bytes = constant1.size() * sizeof(float);
+  }
+  context1.tensors[1].data.raw_const =
+      reinterpret_cast<const char*>(constant1.data());
+  context2.tensors[1].data.raw_const =
+      reinterpret_cast<const char*>(constant1.data());
+
+  // Same tensors and constants.
+  EXPECT_EQ(StrModelFingerprint(&context1), StrModelFingerprint(&context2));
+
+  // Different constants.
+  context2.tensors[1].data.raw_const =
+      reinterpret_cast<const char*>(constant2.data());
+  EXPECT_NE(StrModelFingerprint(&context1), StrModelFingerprint(&context2));
+
+  // Different tensor types.
+  context2.tensors[1].data.raw_const =
+      reinterpret_cast<const char*>(constant1.data());
+  context2.tensors[0].type = kTfLiteInt32;
+  EXPECT_NE(StrModelFingerprint(&context1), StrModelFingerprint(&context2));
+}
+
 TEST_F(SerializationTest, SerializationData) {
   // Sample data to store in serialization.
   float value1 = 456.24;
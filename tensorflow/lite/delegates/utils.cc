@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstring>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/builtin_ops.h"
@@ -135,6 +136,61 @@ std::vector<int> GraphPartitionHelper::GetNodesOfFirstNLargestPartitionsImpl(
   return ops_to_replace;
 }
 
+namespace {
+
+// Returns the estimated latency saved by delegating 'partition'.
+double EstimatePartitionSaving(TfLiteContext* context,
+                               const TfLiteDelegateParams& partition,
+                               const PartitionCostModel& cost_model) {
+  double saving = -cost_model.partition_overhead;
+  for (int node_index : TfLiteIntArrayView(partition.nodes_to_replace)) {
+    saving +=
+        cost_model.node_saving ? cost_model.node_saving(context, node_index)
+                               : 1.0;
+  }
+  size_t transfer_bytes = 0;
+  for (const TfLiteIntArray* tensors :
+       {partition.input_tensors, partition.output_tensors}) {
+    if (!tensors) continue;
+    for (int tensor_index : TfLiteIntArrayView(tensors)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = context->tensors[tensor_index];
+      if (tensor.allocation_type != kTfLiteMmapRo) {
+        transfer_bytes += tensor.bytes;
+      }
+    }
+  }
+  return saving - cost_model.transfer_cost_per_byte * transfer_bytes;
+}
+
+}  // namespace
+
+std::vector<int> GraphPartitionHelper::GetNodesOfFirstNProfitablePartitions(
+    const PartitionCostModel& cost_model, int n) const {
+  std::vector<std::pair<double, TfLiteDelegateParams*>> profitable_partitions;
+  for (TfLiteDelegateParams* partition : partitions_) {
+    const double saving =
+        EstimatePartitionSaving(context_, *partition, cost_model);
+    if (saving > 0) profitable_partitions.emplace_back(saving, partition);
+  }
+  // Reverse sort, on the savings only so that ties keep the original order.
+  std::stable_sort(
+      profitable_partitions.begin(), profitable_partitions.end(),
+      [](const auto& left, const auto& right) {
+        return left.first > right.first;
+      });
+
+  std::vector<int> ops_to_replace;
+  const int total = profitable_partitions.size();
+  for (int i = 0; i < std::min(total, n); ++i) {
+    const TfLiteIntArray* nodes =
+        profitable_partitions[i].second->nodes_to_replace;
+    ops_to_replace.insert(ops_to_replace.end(), nodes->data,
+                          nodes->data + nodes->size);
+  }
+  return ops_to_replace;
+}
+
 TfLiteStatus GraphPartitionHelper::PrepareSupportedNodes(
     std::set<std::string>* unsupported_nodes_info, int start_node_index,
     int end_node_index) {
@@ -96,6 +96,22 @@ using IsNodeSupportedFn =
     std::function<bool(TfLiteContext*, TfLiteNode*, TfLiteRegistration*,
                        std::string* unsupported_details)>;
 
+// Latency estimates used by GraphPartitionHelper to only delegate the
+// partitions that are estimated to run faster with the delegate than on the
+// CPU. The unit of the estimates is up to the caller, e.g. microseconds from a
+// profile of the model.
+struct PartitionCostModel {
+  // Returns the estimated latency saved by delegating the node at
+  // 'node_index', i.e. its CPU latency minus its latency with the delegate.
+  // If not set, delegating any node is estimated to save 1.
+  std::function<double(TfLiteContext* context, int node_index)> node_saving;
+  // The estimated latency of copying one byte between the CPU and the
+  // delegate, paid for every non-constant input and output of a partition.
+  double transfer_cost_per_byte = 0.0;
+  // The estimated fixed latency of invoking a delegated partition.
+  double partition_overhead = 0.0;
+};
+
 // A utility class to help model graph parition.
 // Note the class *needs* to be used in TfLiteDelegate::Prepare.
 class GraphPartitionHelper {
@@ -160,6 +176,14 @@ class GraphPartitionHelper {
     return GetNodesOfFirstNLargestPartitionsImpl(n, min_nodes_per_partition);
   }
 
+  // Returns a list of node indices of all nodes from the first n partitions
+  // that save the most estimated latency under 'cost_model'. Partitions that
+  // aren't estimated to save any latency, e.g. small partitions with large
+  // inputs or outputs, are never returned.
+  std::vector<int> GetNodesOfFirstNProfitablePartitions(
+      const PartitionCostModel& cost_model,
+      int n = std::numeric_limits<int>::max()) const;
+
   int num_total_nodes() const { return num_total_nodes_; }
   int num_supported_nodes() const { return num_supported_nodes_; }
   int num_partitions() const { return partitions_.size(); }
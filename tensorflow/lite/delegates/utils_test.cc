@@ -295,6 +295,49 @@ TEST(GraphPartitionHelper, CheckPartitionsWithSupportedNodeList) {
   EXPECT_THAT(nodes, testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
 }
 
+TEST(GraphPartitionHelper, CheckProfitablePartitions) {
+  // The mocked TfLiteContext has 4 partitions: {1}, {0,3,7,8}, {2,4,9}, {5,6}.
+  MockTfLiteContext mocked_context;
+  GraphPartitionHelper helper(&mocked_context, IsNodeSupported);
+  EXPECT_EQ(kTfLiteOk, helper.Partition(nullptr));
+
+  // Every node saves 1, so only the partitions of more than 2 nodes are worth
+  // the overhead of 2.
+  PartitionCostModel cost_model;
+  cost_model.partition_overhead = 2;
+  EXPECT_THAT(helper.GetNodesOfFirstNProfitablePartitions(cost_model),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
+  EXPECT_THAT(helper.GetNodesOfFirstNProfitablePartitions(cost_model, 1),
+              testing::ElementsAreArray({0, 3, 7, 8}));
+
+  // Node 5 saves more than all the other nodes together.
+  cost_model.node_saving = [](TfLiteContext*, int node_index) {
+    return node_index == 5 ? 100.0 : 1.0;
+  };
+  EXPECT_THAT(helper.GetNodesOfFirstNProfitablePartitions(cost_model, 1),
+              testing::ElementsAreArray({5, 6}));
+
+  // The {0,3,7,8} partition has a large output, but its constant input isn't
+  // transferred.
+  std::vector<TfLiteTensor> tensors(2);
+  tensors[0].bytes = 1000;
+  tensors[0].allocation_type = kTfLiteMmapRo;
+  tensors[1].bytes = 1000;
+  tensors[1].allocation_type = kTfLiteArenaRw;
+  mocked_context.tensors = tensors.data();
+  mocked_context.tensors_size = tensors.size();
+  TfLiteDelegateParams& partition = mocked_context.delegate_params()[1];
+  partition.input_tensors = ConvertVectorToTfLiteIntArray({0});
+  partition.output_tensors = ConvertVectorToTfLiteIntArray({1});
+  cost_model.node_saving = nullptr;
+  cost_model.transfer_cost_per_byte = 0.001;
+  EXPECT_THAT(helper.GetNodesOfFirstNProfitablePartitions(cost_model),
+              testing::ElementsAreArray({0, 3, 7, 8, 2, 4, 9}));
+  cost_model.transfer_cost_per_byte = 0.002;
+  EXPECT_THAT(helper.GetNodesOfFirstNProfitablePartitions(cost_model),
+              testing::ElementsAreArray({2, 4, 9}));
+}
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
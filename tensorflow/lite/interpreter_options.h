@@ -29,7 +29,8 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_use_offline_memory_planner_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +94,28 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  /// Plans the non-persistent arena with `OfflinePlanner`, which packs it
+  /// tighter than the default planner at a higher planning cost. The planned
+  /// offsets can be saved in the model metadata, from which the planner is
+  /// then selected without this option.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetUseOfflineMemoryPlanner(bool value = true) {
+    experimental_use_offline_memory_planner_ = value;
+  }
+
+  /// Returns if the `experimental_use_offline_memory_planner_` feature is
+  /// enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetUseOfflineMemoryPlanner() {
+    return experimental_use_offline_memory_planner_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  bool experimental_use_offline_memory_planner_;
 };
 
 }  // namespace tflite
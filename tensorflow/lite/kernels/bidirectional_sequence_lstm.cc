@@ -1315,6 +1315,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
+          /*fused_input_weights=*/nullptr,
+          /*fused_recurrent_weights=*/nullptr,
+          /*fused_gate_products=*/nullptr,
           CpuBackendContext::GetFromContext(context));
       TF_LITE_ENSURE_OK(context, fw_pass_status);
 
@@ -1360,6 +1363,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
+          /*fused_input_weights=*/nullptr,
+          /*fused_recurrent_weights=*/nullptr,
+          /*fused_gate_products=*/nullptr,
           CpuBackendContext::GetFromContext(context));
       TF_LITE_ENSURE_OK(context, bw_pass_status);
       return kTfLiteOk;
@@ -386,10 +386,14 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
     const int per_channel_quantization_size = affine_quantization->scale->size;
     const bool is_per_channel = per_channel_quantization_size > 1;
     if (is_per_channel) {
-      //  Currently only Int8/Int16 is supported for per channel quantization.
+      //  Currently only Int8/Int16 is supported for per channel quantization,
+      //  with Int8 filters, or Int4 filters for Int8 inputs.
       TF_LITE_ENSURE(context,
                      input->type == kTfLiteInt8 || input->type == kTfLiteInt16);
-      TF_LITE_ENSURE(context, (filter->type == kTfLiteInt8));
+      TF_LITE_ENSURE(context,
+                     filter->type == kTfLiteInt8 ||
+                         (filter->type == kTfLiteInt4 &&
+                          input->type == kTfLiteInt8));
       TF_LITE_ENSURE_EQ(context, affine_quantization->scale->size,
                         per_channel_quantization_size);
       TF_LITE_ENSURE_EQ(
@@ -1062,20 +1066,35 @@ void FullyConnectedPerChannelInt8(const OpData* data, const TfLiteTensor* input,
   op_params.quantized_activation_max = data->output_activation_max;
   op_params.lhs_cacheable = IsConstantTensor(filter);
   op_params.rhs_cacheable = IsConstantTensor(input);
+
+  const int8_t* filter_data;
+  std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
+
+  if (filter->type == kTfLiteInt4) {
+    const size_t bytes_unpacked = filter->bytes * 2;
+    unpacked_filter_data = std::make_unique<int8_t[]>(bytes_unpacked);
+    tflite::tensor_utils::UnpackDenseInt4IntoInt8(
+        GetTensorData<int8_t>(filter), GetTensorShape(filter).FlatSize(),
+        unpacked_filter_data.get());
+    filter_data = unpacked_filter_data.get();
+  } else {
+    filter_data = GetTensorData<int8_t>(filter);
+  }
+
   if (kernel_type == kReference) {
     reference_integer_ops::FullyConnectedPerChannel(
         op_params, data->per_channel_output_multiplier.data(),
         data->per_channel_output_shift.data(), GetTensorShape(input),
-        GetTensorData<int8_t>(input), GetTensorShape(filter),
-        GetTensorData<int8_t>(filter), GetTensorShape(bias),
+        GetTensorData<int8_t>(input), GetTensorShape(filter), filter_data,
+        GetTensorShape(bias),
         GetTensorData<int32_t>(bias), GetTensorShape(output),
         GetTensorData<int8_t>(output));
   } else {
     optimized_integer_ops::FullyConnectedPerChannel(
         op_params, data->per_channel_output_multiplier.data(),
         data->per_channel_output_shift.data(), GetTensorShape(input),
-        GetTensorData<int8_t>(input), GetTensorShape(filter),
-        GetTensorData<int8_t>(filter), GetTensorShape(bias),
+        GetTensorData<int8_t>(input), GetTensorShape(filter), filter_data,
+        GetTensorShape(bias),
         GetTensorData<int32_t>(bias), GetTensorShape(output),
         GetTensorData<int8_t>(output), cpu_backend_context);
   }
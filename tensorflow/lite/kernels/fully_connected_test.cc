@@ -174,7 +174,8 @@ class BaseFullyConnectedOpModel : public SingleOpModel {
                              per_channel_quantization_offsets,
                              0});
       } else {
-        weights_ = AddInput({input.type,
+        weights_ = AddInput({filter_type == kTfLiteInt4 ? TensorType_INT4
+                                                        : input.type,
                              {units_, input_size_},
                              0,
                              0,
@@ -374,12 +375,12 @@ class PerChannelQuantizedFullyConnectedOpModel
       ActivationFunctionType activation_func = ActivationFunctionType_RELU,
       FullyConnectedOptionsWeightsFormat weights_format =
           FullyConnectedOptionsWeightsFormat_DEFAULT,
-      int input_size = -1)
+      int input_size = -1, TfLiteType filter_type = kTfLiteNoType)
       : BaseFullyConnectedOpModel(
             registration, units, batches, input, output, bias_type,
             keep_num_dims, bias_tensor_optional, activation_func,
-            weights_format, input_size, true, per_channel_quantization_scales) {
-  }
+            weights_format, input_size, true, per_channel_quantization_scales,
+            filter_type) {}
 
   void SetBias(const std::vector<float>& data) {
     PerChannelQuantizeBias(bias_, data);
@@ -796,6 +797,35 @@ TEST_P(QuantizedFullyConnectedOpTest, SimpleTestPerChannelQuantizedInt8) {
   EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAre(23, 24, 25, 57, 58, 59));
 }
 
+TEST_P(QuantizedFullyConnectedOpTest, SimpleTestPerChannelQuantizedInt4) {
+  PerChannelQuantizedFullyConnectedOpModel m(
+      GetRegistration(), /*units=*/3, /*batches*/ 2,
+      /*input=*/{TensorType_INT8, {2, 10}, -63.5, 64},
+      /*per_channel_quantization_scales=*/{0.1, 0.2, 0.3},
+      /*output=*/{TensorType_INT8, {}, -127, 128}, TensorType_INT32, false,
+      false, ActivationFunctionType_RELU,
+      FullyConnectedOptionsWeightsFormat_DEFAULT, -1, kTfLiteInt4);
+
+  // The quantized weights are the same on all channels, and fit in 4 bits.
+  m.SetWeights<int8_t>({
+      0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, -0.1, -0.2, -0.3,  // u = 0
+      0.2, 0.4, 0.6, 0.8, 1.0, 1.2, 1.4, -0.2, -0.4, -0.6,  // u = 1
+      0.3, 0.6, 0.9, 1.2, 1.5, 1.8, 2.1, -0.3, -0.6, -0.9,  // u = 2
+  });
+  m.SetBias({1, 2, 3});
+
+  m.SetInput<int8_t>({
+      1, 2, 3, 4, 5, 6, 7, 8,  -9, -10,  // b = 0
+      1, 2, 3, 4, 5, 6, 7, -8, 9,  -10,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetDequantizedOutput<int8_t>(),
+              ElementsAreArray(ArrayFloatNear({19, 38, 57, 17, 34, 51})));
+  EXPECT_THAT(m.GetOutput<int8_t>(), ElementsAre(18, 37, 56, 16, 33, 50));
+}
+
 TEST_P(QuantizedFullyConnectedOpTest, SimpleTestQuantizedInt16Bias32) {
   const float scale = 128.0 / 65536;
   QuantizedFullyConnectedOpModel m(
@@ -2144,6 +2174,39 @@ TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16Test) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 2, 25, 0, 2, 21));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestMultiThreaded) {
+  std::vector<float> weight_data = {
+      1,  2,  3,  4,  -1, -2, -3, -4, 1,  2,  3,  4, -4, -3, -2, -1,  // u = 0
+      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0,  0,   // u = 1
+      -1, -2, -3, -4, 4,  3,  2,  1,  -1, -2, -3, 4, 1,  2,  3,  4,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 16}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {16};
+  // With more threads than batches, the rows of the weights are sliced.
+  for (int num_threads = 1; num_threads <= 4; ++num_threads) {
+    SparseQuantizedFullyConnectedOpModel m(
+        GetRegistration(),
+        /*units=*/3, /*batches=*/2,
+        /*input=*/{TensorType_INT8, {2, 16}, 0, 0, 1}, weight, weight_data,
+        /*output=*/{TensorType_INT8, {}, 0, 0, 1},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+
+    m.SetBias({1, 2, 3});
+    m.SetInput({
+        1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+        4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(11, 2, 25, 0, 2, 21));
+  }
+}
+
 TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestNoBias) {
   std::vector<float> weight_data = {
       1,  2,  3,  4,  -1, -2, -3, -4, 1,  2,  3,  4, -4, -3, -2, -1,  // u = 0
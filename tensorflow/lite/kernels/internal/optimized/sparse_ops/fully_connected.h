@@ -76,15 +76,19 @@ inline void FullyConnectedSparseWeight(
   }
 }
 
+// Computes the rows [row_start, row_end) of the output of the batches
+// [thread_start, thread_end).
 inline void FullyConnectedSparseWeight1x16Impl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
     const RuntimeShape& weights_shape, const int8_t* weights_data,
     const RuntimeShape& bias_shape, const int32_t* bias_data,
     const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
-    int thread_end, const CpuBackendContext& cpu_backend_context) {
+    int thread_end, int row_start, int row_end,
+    const CpuBackendContext& cpu_backend_context) {
   ruy::profiler::ScopeLabel label("FullyConnected");
   ruy::profiler::ScopeLabel inner_label("1x16 Block Sparse");
+  constexpr int kBlockSize = 16;
 
   const int input_dims_count = input_shape.DimensionsCount();
   const int output_dims_count = output_shape.DimensionsCount();
@@ -104,12 +108,32 @@ inline void FullyConnectedSparseWeight1x16Impl(
   const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
   const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
 
-  tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
-      weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
-      weights_shape.Dims(1), input_data + thread_start * input_depth, bias_data,
-      batches, input_offset, output_multiplier, output_shift, output_offset,
-      output_activation_min, output_activation_max,
-      output_data + thread_start * output_depth);
+  if (row_start == 0 && row_end == output_depth) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_data, w1_segments, w1_indices, weights_shape.Dims(0),
+        weights_shape.Dims(1), input_data + thread_start * input_depth,
+        bias_data, batches, input_offset, output_multiplier, output_shift,
+        output_offset, output_activation_min, output_activation_max,
+        output_data + thread_start * output_depth);
+    return;
+  }
+
+  // The output rows of a batch are contiguous, but not those of consecutive
+  // batches, so a slice of the rows is computed one batch at a time. The
+  // blocks of the rows before 'row_start' are skipped in 'weights_data', the
+  // segments and indices point into the whole weights.
+  const int8_t* weights_slice =
+      weights_data + w1_segments[row_start] * kBlockSize;
+  const int32_t* bias_slice =
+      bias_data != nullptr ? bias_data + row_start : nullptr;
+  for (int b = thread_start; b < thread_end; ++b) {
+    tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        weights_slice, w1_segments + row_start, w1_indices,
+        row_end - row_start, weights_shape.Dims(1),
+        input_data + b * input_depth, bias_slice, /*n_batch=*/1, input_offset,
+        output_multiplier, output_shift, output_offset, output_activation_min,
+        output_activation_max, output_data + b * output_depth + row_start);
+  }
 }
 
 inline void FullyConnectedSparseWeight1x4Impl(
@@ -196,6 +220,60 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
   const CpuBackendContext& cpu_backend_context;
 };
 
+struct FullyConnectedSparseWeight1x16Task : cpu_backend_threadpool::Task {
+  FullyConnectedSparseWeight1x16Task(
+      const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+      const RuntimeShape& input_shape, const int8_t* input_data,
+      const RuntimeShape& weights_shape, const int8_t* weights_data,
+      const RuntimeShape& bias_shape, const int32_t* bias_data,
+      const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
+      int thread_end, int row_start, int row_end,
+      const CpuBackendContext& cpu_backend_context_x)
+      : sparsity(sparsity),
+        params(params),
+        input_shape(input_shape),
+        input_data(input_data),
+        weights_shape(weights_shape),
+        weights_data(weights_data),
+        bias_shape(bias_shape),
+        bias_data(bias_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        thread_start(thread_start),
+        thread_end(thread_end),
+        row_start(row_start),
+        row_end(row_end),
+        cpu_backend_context(cpu_backend_context_x) {}
+
+  void Run() override {
+    FullyConnectedSparseWeight1x16Impl(
+        sparsity, params, input_shape, input_data, weights_shape, weights_data,
+        bias_shape, bias_data, output_shape, output_data, thread_start,
+        thread_end, row_start, row_end, cpu_backend_context);
+  }
+
+ private:
+  const TfLiteSparsity& sparsity;
+  const FullyConnectedParams& params;
+  const RuntimeShape& input_shape;
+  const int8_t* input_data;
+  const RuntimeShape& weights_shape;
+  const int8_t* weights_data;
+  const RuntimeShape& bias_shape;
+  const int32_t* bias_data;
+  const RuntimeShape& output_shape;
+  int8_t* output_data;
+  int thread_start;
+  int thread_end;
+  int row_start;
+  int row_end;
+  const CpuBackendContext& cpu_backend_context;
+};
+
+// The multi-threaded kernel slices the workload along the batch dimension if
+// there are at least as many batches as threads, and else along the rows of
+// the weights, so that a single batch, the common case, also uses all the
+// threads.
 inline void FullyConnectedSparseWeight1x16(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
@@ -206,14 +284,43 @@ inline void FullyConnectedSparseWeight1x16(
   const int output_elements = output_shape.FlatSize();
   memset(output_data, 0, output_elements * sizeof(int8_t));
 
+  const int max_threads = cpu_backend_context->max_num_threads();
   const int batches =
       FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  const int rows = weights_shape.Dims(0);
+  const bool slice_batches = batches >= max_threads;
+  const int slices = slice_batches ? batches : rows;
+  const int thread_count = std::max(1, std::min(slices, max_threads));
+  if (thread_count == 1) {
+    return FullyConnectedSparseWeight1x16Impl(
+        sparsity, params, input_shape, input_data, weights_shape, weights_data,
+        bias_shape, bias_data, output_shape, output_data, 0, batches, 0, rows,
+        *cpu_backend_context);
+  }
+  std::vector<FullyConnectedSparseWeight1x16Task> tasks;
+  tasks.reserve(thread_count);
+  int slice_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    // The first mod(slices, thread_count) tasks process one more slice than
+    // the rest.
+    int slice_end = slice_start + slices / thread_count;
+    if (i < slices % thread_count) slice_end++;
 
-  // TODO(b/220851507): Add multi-thread support for quantized sparse kernel.
-  return FullyConnectedSparseWeight1x16Impl(
-      sparsity, params, input_shape, input_data, weights_shape, weights_data,
-      bias_shape, bias_data, output_shape, output_data, 0, batches,
-      *cpu_backend_context);
+    if (slice_batches) {
+      tasks.emplace_back(sparsity, params, input_shape, input_data,
+                         weights_shape, weights_data, bias_shape, bias_data,
+                         output_shape, output_data, slice_start, slice_end, 0,
+                         rows, *cpu_backend_context);
+    } else {
+      tasks.emplace_back(sparsity, params, input_shape, input_data,
+                         weights_shape, weights_data, bias_shape, bias_data,
+                         output_shape, output_data, 0, batches, slice_start,
+                         slice_end, *cpu_backend_context);
+    }
+    slice_start = slice_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
 }
 
 // The multi-threaded kernel slices the workload along the batch dimension. If
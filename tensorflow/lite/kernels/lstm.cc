@@ -2039,6 +2039,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
               /*recurrent_to_forget_is_diag=*/false,
               /*recurrent_to_cell_is_diag=*/false,
               /*recurrent_to_output_is_diag=*/false,
+              /*fused_input_weights=*/nullptr,
+              /*fused_recurrent_weights=*/nullptr,
+              /*fused_gate_products=*/nullptr,
               CpuBackendContext::GetFromContext(context));
         }
         return lstm_eval::EvalHybrid(
@@ -2086,6 +2089,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             /*recurrent_to_forget_is_diag=*/false,
             /*recurrent_to_cell_is_diag=*/false,
             /*recurrent_to_output_is_diag=*/false,
+            /*fused_input_weights=*/nullptr,
+            /*fused_recurrent_weights=*/nullptr,
+            /*fused_gate_products=*/nullptr,
             CpuBackendContext::GetFromContext(context));
       }
       const int num_intermediate_tensors = node->intermediates->size;
@@ -353,8 +353,29 @@ void CalculateLstmOutputFloat(int n_batch, int n_cell, int n_output,
 // LINT.ThenChange(../tools/optimize/calibration/builtin_logging_ops/lstm.cc,\
 //                 ../experimental/kernels/fp16/lstm_eval.cc)
 
+// Adds `matrix_scale` times the rows of a fused gate product to `gate`. The
+// fused product has `product_stride` values per batch, of which the n_cell
+// values starting at `product` belong to this gate.
+void AccumulateFusedGateProduct(const float* product, int product_stride,
+                                float matrix_scale, int n_cell, int n_batch,
+                                float* gate) {
+  for (int b = 0; b < n_batch; ++b) {
+    const float* product_ptr = product + b * product_stride;
+    float* gate_ptr = gate + b * n_cell;
+    for (int i = 0; i < n_cell; ++i) {
+      gate_ptr[i] += matrix_scale * product_ptr[i];
+    }
+  }
+}
+
 // Calculates a single LSTM gate, hybrid version.
 // Implements the same functionality as CalculateLstmGateFloat.
+//
+// If `fused_input_product` (resp. `fused_recurrent_product`) is not null, it
+// holds the input (resp. recurrent) weights times the quantized input (resp.
+// output state) for all the gates, not yet multiplied by the weights scale,
+// with `fused_product_stride` values per batch. It is used instead of the
+// matmul with the gate's own weights.
 void CalculateLstmGateHybrid(
     // Input and weights
     const int8_t* input, const float* input_sf, const int32_t* input_zp,
@@ -393,7 +414,10 @@ void CalculateLstmGateHybrid(
     float* scratch0,         // size: n_batch
     float* scratch1,         // size: n_cell, only used if peephole LSTM
     int32_t* accum_scratch,  // For MatrixBatchVectorMultiplyAccumulate
-    bool recurrent_is_diag) {
+    bool recurrent_is_diag,
+    // Products computed for all the gates at once (optional)
+    const float* fused_input_product, const float* fused_recurrent_product,
+    int fused_product_stride) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
@@ -407,7 +431,11 @@ void CalculateLstmGateHybrid(
   // For each batch and cell: compute input_weight * input.
   // Skip if input is all zeros.
   if (!is_input_all_zeros) {
-    if (input_to_gate_weights_ledger != nullptr) {
+    if (fused_input_product != nullptr) {
+      AccumulateFusedGateProduct(fused_input_product, fused_product_stride,
+                                 input_to_gate_weights_scale, n_cell, n_batch,
+                                 gate);
+    } else if (input_to_gate_weights_ledger != nullptr) {
       std::vector<float> scales(n_batch);
       for (int i = 0; i < n_batch; i++) {
         scales[i] = input_to_gate_weights_scale * input_sf[i];
@@ -436,7 +464,11 @@ void CalculateLstmGateHybrid(
   // For each batch and cell: compute recurrent_weight * output_state.
   // Skip if output state is all zeros.
   if (!is_output_state_all_zeros) {
-    if (recurrent_to_gate_weights_ledger != nullptr) {
+    if (fused_recurrent_product != nullptr) {
+      AccumulateFusedGateProduct(fused_recurrent_product, fused_product_stride,
+                                 recurrent_to_gate_weights_scale, n_cell,
+                                 n_batch, gate);
+    } else if (recurrent_to_gate_weights_ledger != nullptr) {
       std::vector<float> scales(n_batch);
       for (int i = 0; i < n_batch; i++) {
         scales[i] = recurrent_to_gate_weights_scale * input_sf[i];
@@ -1059,6 +1091,14 @@ inline void LstmStepFloat(
 // Temporary pre-allocated storage for recovered values:
 //   recovered_cell_weights (same size as cell_to_*_weights)
 //
+// Input and recurrent weights of all the gates, packed in input, forget, cell,
+// output gate order (without the input gate for CIFG). If set, each of them is
+// multiplied with its vector in a single matmul instead of one per gate:
+//   fused_input_weights_ptr     - optional, size 'n_gates * n_cell * n_input'
+//   fused_recurrent_weights_ptr - optional, size 'n_gates * n_cell * n_output'
+//   fused_gate_products_ptr     - scratch of size 'n_batch * n_gates * n_cell'
+//                                 per fused weights, if any is set
+//
 // Outputs:
 //   output_state_ptr - size 'n_batch * n_output'
 //   cell_state_ptr   - size 'n_batch * n_cell'
@@ -1127,6 +1167,8 @@ inline void LstmStepHybrid(
     bool* compute_row_sums, bool asymmetric_quantize_inputs,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
+    const int8_t* fused_input_weights_ptr,
+    const int8_t* fused_recurrent_weights_ptr, float* fused_gate_products_ptr,
     CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepHybrid");
   // Since we have already checked that weights are all there or none, we
@@ -1231,6 +1273,47 @@ inline void LstmStepHybrid(
         output_state_ptr, n_batch, n_output, quantized_output_state_ptr,
         output_state_sf, output_state_zp, asymmetric_quantize_inputs);
   }
+  // Multiply the packed weights of all the gates at once. The products are
+  // scaled by the weights scale of each gate in CalculateLstmGateHybrid. The
+  // row sums of the gates are contiguous in the same order as the packed
+  // weights, so they are the row sums of the packed weights too.
+  const int n_gates = use_cifg ? 3 : 4;
+  const int fused_product_stride = n_gates * n_cell;
+  float* fused_input_product = nullptr;
+  float* fused_recurrent_product = nullptr;
+  float* fused_products_ptr = fused_gate_products_ptr;
+  if (fused_input_weights_ptr != nullptr && !is_input_all_zeros) {
+    fused_input_product = fused_products_ptr;
+    fused_products_ptr += n_batch * fused_product_stride;
+    std::fill_n(fused_input_product, n_batch * fused_product_stride, 0.0f);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        fused_input_weights_ptr, fused_product_stride, n_input,
+        quantized_input_ptr, /*matrix_scaling_factor=*/1.0f, input_sf, n_batch,
+        fused_input_product, /*per_channel_scale=*/nullptr, input_zp,
+        accum_scratch_ptr,
+        use_cifg ? input_to_forget_row_sums : input_to_input_row_sums,
+        compute_row_sums, scaling_factors_scratch, context);
+  }
+  if (fused_recurrent_weights_ptr != nullptr && !is_output_state_all_zeros) {
+    fused_recurrent_product = fused_products_ptr;
+    std::fill_n(fused_recurrent_product, n_batch * fused_product_stride,
+                0.0f);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        fused_recurrent_weights_ptr, fused_product_stride, n_output,
+        quantized_output_state_ptr, /*matrix_scaling_factor=*/1.0f,
+        output_state_sf, n_batch, fused_recurrent_product,
+        /*per_channel_scale=*/nullptr, output_state_zp, accum_scratch_ptr,
+        use_cifg ? recurrent_to_forget_row_sums : recurrent_to_input_row_sums,
+        compute_row_sums, scaling_factors_scratch, context);
+  }
+  // Offset of the products of each gate in the fused products.
+  const int input_gate_offset = 0;
+  const int forget_gate_offset = use_cifg ? 0 : n_cell;
+  const int cell_gate_offset = forget_gate_offset + n_cell;
+  const int output_gate_offset = cell_gate_offset + n_cell;
+  auto fused_product = [](float* product, int offset) -> const float* {
+    return product != nullptr ? product + offset : nullptr;
+  };
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateHybrid(
@@ -1249,7 +1332,10 @@ inline void LstmStepHybrid(
         input_gate_scratch, is_input_all_zeros, is_aux_input_all_zeros,
         is_output_state_all_zeros, compute_row_sums, context,
         scaling_factors_scratch, recovered_cell_weights, accum_scratch_ptr,
-        recurrent_to_input_is_diag);
+        recurrent_to_input_is_diag,
+        fused_product(fused_input_product, input_gate_offset),
+        fused_product(fused_recurrent_product, input_gate_offset),
+        fused_product_stride);
   }
   // Calculate the forget gate.
   CalculateLstmGateHybrid(
@@ -1268,7 +1354,10 @@ inline void LstmStepHybrid(
       forget_gate_scratch, is_input_all_zeros, is_aux_input_all_zeros,
       is_output_state_all_zeros, compute_row_sums, context,
       scaling_factors_scratch, recovered_cell_weights, accum_scratch_ptr,
-      recurrent_to_forget_is_diag);
+      recurrent_to_forget_is_diag,
+      fused_product(fused_input_product, forget_gate_offset),
+      fused_product(fused_recurrent_product, forget_gate_offset),
+      fused_product_stride);
   // Calculate the cell update gate.
   CalculateLstmGateHybrid(
       quantized_input_ptr, input_sf, input_zp, input_to_cell_weights_ptr,
@@ -1286,7 +1375,10 @@ inline void LstmStepHybrid(
       params->activation, cell_gate_scratch, is_input_all_zeros,
       is_aux_input_all_zeros, is_output_state_all_zeros, compute_row_sums,
       context, scaling_factors_scratch, recovered_cell_weights,
-      accum_scratch_ptr, recurrent_to_cell_is_diag);
+      accum_scratch_ptr, recurrent_to_cell_is_diag,
+      fused_product(fused_input_product, cell_gate_offset),
+      fused_product(fused_recurrent_product, cell_gate_offset),
+      fused_product_stride);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -1308,7 +1400,10 @@ inline void LstmStepHybrid(
       output_gate_scratch, is_input_all_zeros, is_aux_input_all_zeros,
       is_output_state_all_zeros, compute_row_sums, context,
       scaling_factors_scratch, recovered_cell_weights, accum_scratch_ptr,
-      recurrent_to_output_is_diag);
+      recurrent_to_output_is_diag,
+      fused_product(fused_input_product, output_gate_offset),
+      fused_product(fused_recurrent_product, output_gate_offset),
+      fused_product_stride);
   // Update the output state.
   CalculateLstmOutputHybrid(
       n_batch, n_cell, n_output, cell_state_ptr, output_gate_scratch,
@@ -2030,7 +2125,9 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* output_state_zp, TfLiteTensor* row_sums, int row_sums_size,
     bool* compute_row_sums, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context) {
+    bool recurrent_to_output_is_diag, const TfLiteTensor* fused_input_weights,
+    const TfLiteTensor* fused_recurrent_weights,
+    TfLiteTensor* fused_gate_products, CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
   int max_time, n_batch;
@@ -2169,7 +2266,10 @@ TfLiteStatus EvalHybrid(
           input_zp_ptr, aux_input_zp_ptr, output_state_zp_ptr, row_sums_ptr,
           row_sums_size, compute_row_sums, params->asymmetric_quantize_inputs,
           recurrent_to_input_is_diag, recurrent_to_forget_is_diag,
-          recurrent_to_cell_is_diag, recurrent_to_output_is_diag, context);
+          recurrent_to_cell_is_diag, recurrent_to_output_is_diag,
+          GetTensorData<int8_t>(fused_input_weights),
+          GetTensorData<int8_t>(fused_recurrent_weights),
+          GetTensorData<float>(fused_gate_products), context);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -2273,7 +2373,10 @@ TfLiteStatus EvalHybrid(
             row_sums_ptr, row_sums_size, compute_row_sums,
             params->asymmetric_quantize_inputs, recurrent_to_input_is_diag,
             recurrent_to_forget_is_diag, recurrent_to_cell_is_diag,
-            recurrent_to_output_is_diag, context);
+            recurrent_to_output_is_diag,
+            GetTensorData<int8_t>(fused_input_weights),
+            GetTensorData<int8_t>(fused_recurrent_weights),
+            GetTensorData<float>(fused_gate_products), context);
       }
     }
   }
@@ -126,6 +126,10 @@ TfLiteStatus EvalFloat(
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
     CpuBackendContext* context);
 
+// `fused_input_weights` and `fused_recurrent_weights` are optional copies of
+// the input and recurrent weights of all the gates packed together, which are
+// then multiplied at once. `fused_gate_products` is the scratch for their
+// products, of 'n_batch * n_gates * n_cell' floats per packed weights.
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_input_weights_ledger,
@@ -172,7 +176,9 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* output_state_zp, TfLiteTensor* row_sums, int row_sums_size,
     bool* compute_row_sums, bool recurrent_to_input_is_diag,
     bool recurrent_to_forget_is_diag, bool recurrent_to_cell_is_diag,
-    bool recurrent_to_output_is_diag, CpuBackendContext* context);
+    bool recurrent_to_output_is_diag, const TfLiteTensor* fused_input_weights,
+    const TfLiteTensor* fused_recurrent_weights,
+    TfLiteTensor* fused_gate_products, CpuBackendContext* context);
 
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -18,6 +18,7 @@ limitations under the License.
 #include <stdlib.h>
 
 #include <algorithm>
+#include <initializer_list>
 #include <memory>
 #include <vector>
 
@@ -896,7 +897,7 @@ class HybridLstmParam : public BaseLstmParam {
   };
 };
 
-void TestOneHybridAsymmLSTM() {
+void TestOneHybridAsymmLSTM(bool use_fused_gate_weights) {
   CpuBackendContext context;
   HybridLstmParam one_parameter;
   auto activation = one_parameter.GetActivation();
@@ -905,16 +906,52 @@ void TestOneHybridAsymmLSTM() {
   auto param = one_parameter.GetLSTMParam();
   bool compute_row_sums = true;
   constexpr float kDefaultScale = 18.0;
+  TfLiteTensor* i2i =
+      HybridLstmParam::addScale(one_parameter.Geti2i(), kDefaultScale);
+  TfLiteTensor* i2f =
+      HybridLstmParam::addScale(one_parameter.Geti2f(), kDefaultScale);
+  TfLiteTensor* i2c =
+      HybridLstmParam::addScale(one_parameter.Geti2c(), kDefaultScale);
+  TfLiteTensor* i2o =
+      HybridLstmParam::addScale(one_parameter.Geti2o(), kDefaultScale);
+  TfLiteTensor* r2i =
+      HybridLstmParam::addScale(one_parameter.Getr2i(), kDefaultScale);
+  TfLiteTensor* r2f =
+      HybridLstmParam::addScale(one_parameter.Getr2f(), kDefaultScale);
+  TfLiteTensor* r2c =
+      HybridLstmParam::addScale(one_parameter.Getr2c(), kDefaultScale);
+  TfLiteTensor* r2o =
+      HybridLstmParam::addScale(one_parameter.Getr2o(), kDefaultScale);
+  TfLiteTensor* accum_scratch = one_parameter.GetAccumScratchBuffer();
+
+  // Pack the weights of the gates the way the kernels do.
+  const int n_cell = i2o->dims->data[0];
+  const int n_batch = output->dims->data[0];
+  auto pack = [](std::initializer_list<const TfLiteTensor*> gate_weights) {
+    std::vector<int8_t> packed;
+    for (const TfLiteTensor* weights : gate_weights) {
+      const int size = weights->dims->data[0] * weights->dims->data[1];
+      packed.insert(packed.end(), weights->data.int8,
+                    weights->data.int8 + size);
+    }
+    return packed;
+  };
+  std::vector<int8_t> fused_input_weights = pack({i2i, i2f, i2c, i2o});
+  std::vector<int8_t> fused_recurrent_weights = pack({r2i, r2f, r2c, r2o});
+  std::vector<float> fused_gate_products(2 * n_batch * 4 * n_cell);
+  std::vector<int32_t> fused_accum_scratch(n_batch * 4 * n_cell);
+  TfLiteTensor fused_input_weights_tensor;
+  fused_input_weights_tensor.data.int8 = fused_input_weights.data();
+  TfLiteTensor fused_recurrent_weights_tensor;
+  fused_recurrent_weights_tensor.data.int8 = fused_recurrent_weights.data();
+  TfLiteTensor fused_gate_products_tensor;
+  fused_gate_products_tensor.data.f = fused_gate_products.data();
+  TfLiteTensor fused_accum_scratch_tensor;
+  fused_accum_scratch_tensor.data.i32 = fused_accum_scratch.data();
+
   ops::builtin::lstm_eval::EvalHybrid(
-      one_parameter.GetFloatInput(),
-      HybridLstmParam::addScale(one_parameter.Geti2i(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Geti2f(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Geti2c(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Geti2o(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Getr2i(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Getr2f(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Getr2c(), kDefaultScale), nullptr,
-      HybridLstmParam::addScale(one_parameter.Getr2o(), kDefaultScale), nullptr,
+      one_parameter.GetFloatInput(), i2i, nullptr, i2f, nullptr, i2c, nullptr,
+      i2o, nullptr, r2i, nullptr, r2f, nullptr, r2c, nullptr, r2o, nullptr,
       /*cell_to_input_weights=*/nullptr,
       /*cell_to_forget_weights=*/nullptr,
       /*cell_to_output_weights=*/nullptr, one_parameter.GetInputLayerNorm(),
@@ -940,14 +977,19 @@ void TestOneHybridAsymmLSTM() {
       /*aux_input_quantized=*/nullptr,
       one_parameter.GetActivationStateQuantized(),
       one_parameter.GetCellStateQuantized(), activation, cell,
-      one_parameter.GetAccumScratchBuffer(), output,
-      one_parameter.GetInputZeroPoints(), one_parameter.GetAuxInputZeroPoints(),
+      use_fused_gate_weights ? &fused_accum_scratch_tensor : accum_scratch,
+      output, one_parameter.GetInputZeroPoints(),
+      one_parameter.GetAuxInputZeroPoints(),
       one_parameter.GetOutputStateZeroPoints(), one_parameter.GetRowSums(),
       one_parameter.GetNumRowSums(), &compute_row_sums,
       /*recurrent_to_input_is_diag=*/false,
       /*recurrent_to_forget_is_diag=*/false,
       /*recurrent_to_cell_is_diag=*/false,
-      /*recurrent_to_output_is_diag=*/false, &context);
+      /*recurrent_to_output_is_diag=*/false,
+      use_fused_gate_weights ? &fused_input_weights_tensor : nullptr,
+      use_fused_gate_weights ? &fused_recurrent_weights_tensor : nullptr,
+      use_fused_gate_weights ? &fused_gate_products_tensor : nullptr,
+      &context);
   const std::vector<float> expected_cell = {
       7.83134,  1.96158, 2.18285, 3.28739,  0.483214,
       0.618206, 1.21539, 1.4052,  -3.17735, 2.24296,  //
@@ -966,7 +1008,11 @@ void TestOneHybridAsymmLSTM() {
 }
 
 TEST(TestOneHybridAsymmLSTM, TestOneHybridAsymmLSTM) {
-  TestOneHybridAsymmLSTM();
+  TestOneHybridAsymmLSTM(/*use_fused_gate_weights=*/false);
+}
+
+TEST(TestOneHybridAsymmLSTM, TestOneHybridAsymmLSTMWithFusedGateWeights) {
+  TestOneHybridAsymmLSTM(/*use_fused_gate_weights=*/true);
 }
 
 }  // namespace
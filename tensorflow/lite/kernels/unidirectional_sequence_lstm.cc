@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
+#include <initializer_list>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -42,6 +44,10 @@ struct OpData {
   // The scratch tensor index.
   int scratch_tensor_index;
   bool compute_row_sums = false;
+  // Whether the hybrid kernel multiplies packed weights of all the gates at
+  // once, and whether they need to be packed on the next Eval.
+  bool use_fused_gate_weights = false;
+  bool pack_fused_gate_weights = false;
 
   bool recurrent_to_input_is_diag = false;
   bool recurrent_to_forget_is_diag = false;
@@ -404,9 +410,50 @@ enum TemporaryTensor {
   kInputZeroPoints = 9,
   kOutputStateZeroPoints = 10,
   kRowSums = 11,
-  kNumTemporaryTensors = 12,
+  kFusedInputWeights = 12,
+  kFusedRecurrentWeights = 13,
+  kFusedGateProducts = 14,
+  kNumTemporaryTensors = 15,
 };
 
+// Returns whether a hybrid LSTM should multiply the input and the output state
+// with the weights of all the gates packed together, in one matmul each,
+// rather than with one matmul per gate. This is only done for streaming inputs
+// of a single time step, which run the most invokes per frame of data: the
+// packed copy doubles the memory used by the weights.
+bool UseFusedGateWeights(TfLiteContext* context, TfLiteNode* node,
+                         int max_time) {
+  if (max_time != 1) return false;
+  for (const int tensor : {lstm::full::kInputToInputWeightsTensor,
+                           lstm::full::kInputToForgetWeightsTensor,
+                           lstm::full::kInputToCellWeightsTensor,
+                           lstm::full::kInputToOutputWeightsTensor,
+                           lstm::full::kRecurrentToInputWeightsTensor,
+                           lstm::full::kRecurrentToForgetWeightsTensor,
+                           lstm::full::kRecurrentToCellWeightsTensor,
+                           lstm::full::kRecurrentToOutputWeightsTensor}) {
+    const TfLiteTensor* weights = GetOptionalInputTensor(context, node, tensor);
+    // The input gate weights are missing for CIFG.
+    if (weights == nullptr) continue;
+    if (!IsConstantTensor(weights) || weights->dims->size != 2) return false;
+  }
+  return true;
+}
+
+// Copies the weights of the gates one after the other into `packed`, skipping
+// the missing input gate of CIFG.
+void PackGateWeights(TfLiteContext* context, TfLiteNode* node,
+                     std::initializer_list<int> weights_tensors,
+                     TfLiteTensor* packed) {
+  char* packed_ptr = packed->data.raw;
+  for (const int tensor : weights_tensors) {
+    const TfLiteTensor* weights = GetOptionalInputTensor(context, node, tensor);
+    if (weights == nullptr) continue;
+    std::memcpy(packed_ptr, weights->data.raw_const, weights->bytes);
+    packed_ptr += weights->bytes;
+  }
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* op_data = new OpData();
   context->AddTensors(context, kNumTemporaryTensors,
@@ -918,6 +965,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       reinterpret_cast<TfLiteUnidirectionalSequenceLSTMParams*>(
           node->builtin_data);
   const bool time_major = params->time_major;
+  const int max_time =
+      time_major ? input->dims->data[0] : input->dims->data[1];
   const int n_batch = time_major ? input->dims->data[1] : input->dims->data[0];
   const int n_input = input->dims->data[2];
 
@@ -986,7 +1035,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
 
   TfLiteIntArrayFree(node->temporaries);
   if (IsHybridOp(input, input_to_output_weights)) {
-    node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
+    op_data->use_fused_gate_weights =
+        UseFusedGateWeights(context, node, max_time);
+    // The fused gate temporaries come last, and are only used if needed.
+    node->temporaries = TfLiteIntArrayCreate(
+        op_data->use_fused_gate_weights ? kNumTemporaryTensors
+                                        : kFusedInputWeights);
   } else if (is_integer) {
     node->temporaries = TfLiteIntArrayCreate(6);
   } else {
@@ -1146,11 +1200,15 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                                                 &accum_scratch));
     accum_scratch->type = kTfLiteInt32;
     accum_scratch->allocation_type = kTfLiteArenaRw;
-    int accum_scratch_dims[2] = {n_cell, n_batch};
+    // The fused gate matmuls produce the rows of all the gates at once.
+    const int n_gates = use_cifg ? 3 : 4;
+    const int accum_scratch_rows =
+        op_data->use_fused_gate_weights ? n_gates * n_cell : n_cell;
+    int accum_scratch_dims[2] = {accum_scratch_rows, n_batch};
     if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2,
                                    accum_scratch_dims)) {
       TfLiteIntArray* accum_size = TfLiteIntArrayCreate(2);
-      accum_size->data[0] = n_cell;
+      accum_size->data[0] = accum_scratch_rows;
       accum_size->data[1] = n_batch;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, accum_scratch, accum_size));
@@ -1203,6 +1261,37 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, row_sums, row_sums_size));
     }
+
+    if (op_data->use_fused_gate_weights) {
+      // Allocate persistent tensors for the packed input and recurrent
+      // weights, and a temporary tensor for their products.
+      op_data->pack_fused_gate_weights = true;
+      const int fused_rows = n_gates * n_cell;
+      const int fused_tensor_dims[3][2] = {{fused_rows, n_input},
+                                           {fused_rows, n_output},
+                                           {2, n_batch * fused_rows}};
+      for (const int index :
+           {kFusedInputWeights, kFusedRecurrentWeights, kFusedGateProducts}) {
+        node->temporaries->data[index] = scratch_tensor_index + index;
+        TfLiteTensor* fused_tensor;
+        TF_LITE_ENSURE_OK(
+            context, GetTemporarySafe(context, node, index, &fused_tensor));
+        const bool is_weights = index != kFusedGateProducts;
+        fused_tensor->type =
+            is_weights ? input_to_output_weights->type : kTfLiteFloat32;
+        fused_tensor->allocation_type =
+            is_weights ? kTfLiteArenaRwPersistent : kTfLiteArenaRw;
+        const int* dims = fused_tensor_dims[index - kFusedInputWeights];
+        if (!TfLiteIntArrayEqualsArray(fused_tensor->dims, 2, dims)) {
+          TfLiteIntArray* fused_tensor_size = TfLiteIntArrayCreate(2);
+          fused_tensor_size->data[0] = dims[0];
+          fused_tensor_size->data[1] = dims[1];
+          TF_LITE_ENSURE_OK(context, context->ResizeTensor(
+                                         context, fused_tensor,
+                                         fused_tensor_size));
+        }
+      }
+    }
   }
 
   if (is_integer) {
@@ -1408,6 +1497,23 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         TF_LITE_ENSURE_OK(context,
                           GetTemporarySafe(context, node, kRowSums, &row_sums));
         const int row_sums_size = row_sums->dims->data[0];
+
+        const bool use_fused_gate_weights = op_data->use_fused_gate_weights;
+        if (op_data->pack_fused_gate_weights) {
+          PackGateWeights(context, node,
+                          {lstm::full::kInputToInputWeightsTensor,
+                           lstm::full::kInputToForgetWeightsTensor,
+                           lstm::full::kInputToCellWeightsTensor,
+                           lstm::full::kInputToOutputWeightsTensor},
+                          GetTemporary(context, node, kFusedInputWeights));
+          PackGateWeights(context, node,
+                          {lstm::full::kRecurrentToInputWeightsTensor,
+                           lstm::full::kRecurrentToForgetWeightsTensor,
+                           lstm::full::kRecurrentToCellWeightsTensor,
+                           lstm::full::kRecurrentToOutputWeightsTensor},
+                          GetTemporary(context, node, kFusedRecurrentWeights));
+          op_data->pack_fused_gate_weights = false;
+        }
         return lstm_eval::EvalHybrid(
             input, input_to_input_weights,
             /*input_to_input_weights_ledger*/ nullptr, input_to_forget_weights,
@@ -1459,6 +1565,15 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             (recurrent_to_cell_weights->dims->size == 1),
             /*recurrent_to_output_is_diag=*/
             (recurrent_to_output_weights->dims->size == 1),
+            use_fused_gate_weights
+                ? GetTemporary(context, node, kFusedInputWeights)
+                : nullptr,
+            use_fused_gate_weights
+                ? GetTemporary(context, node, kFusedRecurrentWeights)
+                : nullptr,
+            use_fused_gate_weights
+                ? GetTemporary(context, node, kFusedGateProducts)
+                : nullptr,
             CpuBackendContext::GetFromContext(context));
       } else {
         TfLiteTensor* scratch0;
@@ -0,0 +1,490 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/offline_planner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+
+namespace {
+
+constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
+constexpr int32_t kNoOffset = -1;
+// Offsets are persisted as int32.
+constexpr size_t kMaxOffset = std::numeric_limits<int32_t>::max();
+constexpr size_t kArenaAlignment = 64;
+constexpr int32_t kOfflineMemoryPlanVersion = 1;
+// Version, subgraph index and number of tensors.
+constexpr size_t kOfflineMemoryPlanHeaderSize = 3;
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+void AppendInt32(int32_t value, std::string* out) {
+  const uint32_t bits = static_cast<uint32_t>(value);
+  for (int i = 0; i < 4; ++i) {
+    out->push_back(static_cast<char>((bits >> (8 * i)) & 0xFF));
+  }
+}
+
+int32_t ReadInt32(const std::string& in, size_t index) {
+  const unsigned char* p =
+      reinterpret_cast<const unsigned char*>(in.data()) + 4 * index;
+  return static_cast<int32_t>(static_cast<uint32_t>(p[0]) |
+                              (static_cast<uint32_t>(p[1]) << 8) |
+                              (static_cast<uint32_t>(p[2]) << 16) |
+                              (static_cast<uint32_t>(p[3]) << 24));
+}
+
+}  // namespace
+
+void AppendOfflineMemoryPlan(int subgraph_index,
+                             const std::vector<int32_t>& offsets,
+                             std::string* metadata) {
+  AppendInt32(kOfflineMemoryPlanVersion, metadata);
+  AppendInt32(subgraph_index, metadata);
+  AppendInt32(static_cast<int32_t>(offsets.size()), metadata);
+  for (int32_t offset : offsets) {
+    AppendInt32(offset, metadata);
+  }
+}
+
+bool FindOfflineMemoryPlan(const std::string& metadata, int subgraph_index,
+                           std::vector<int32_t>* offsets) {
+  if (metadata.size() % 4 != 0) return false;
+  const size_t num_values = metadata.size() / 4;
+  size_t record = 0;
+  while (record + kOfflineMemoryPlanHeaderSize <= num_values) {
+    if (ReadInt32(metadata, record) != kOfflineMemoryPlanVersion) return false;
+    const int32_t num_tensors = ReadInt32(metadata, record + 2);
+    if (num_tensors < 0 || record + kOfflineMemoryPlanHeaderSize +
+                                   static_cast<size_t>(num_tensors) >
+                               num_values) {
+      return false;
+    }
+    const size_t first_offset = record + kOfflineMemoryPlanHeaderSize;
+    if (ReadInt32(metadata, record + 1) == subgraph_index) {
+      offsets->resize(num_tensors);
+      for (int32_t i = 0; i < num_tensors; ++i) {
+        (*offsets)[i] = ReadInt32(metadata, first_offset + i);
+      }
+      return true;
+    }
+    record = first_offset + num_tensors;
+  }
+  return false;
+}
+
+OfflinePlanner::OfflinePlanner(TfLiteContext* context,
+                               std::unique_ptr<GraphInfo> graph_info,
+                               int tensor_alignment, int subgraph_index,
+                               std::vector<int32_t> offline_offsets)
+    : context_(context),
+      graph_info_(std::move(graph_info)),
+      tensor_alignment_(tensor_alignment),
+      offline_offsets_(std::move(offline_offsets)),
+      persistent_arena_(kArenaAlignment, subgraph_index) {}
+
+OfflinePlanner::~OfflinePlanner() { persistent_arena_.ReleaseBuffer(); }
+
+std::intptr_t OfflinePlanner::BasePointer(TfLiteAllocationType type) {
+  if (type == kTfLiteArenaRwPersistent) {
+    return persistent_arena_.BasePointer();
+  }
+  if (type == kTfLiteArenaRw) {
+    return reinterpret_cast<std::intptr_t>(arena_);
+  }
+  return 0;
+}
+
+TfLiteStatus OfflinePlanner::ResetAllocations() {
+  TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
+  persistent_allocs_.clear();
+  persistent_allocs_.resize(graph_info_->num_tensors());
+  offsets_.assign(graph_info_->num_tensors(), kNoOffset);
+  arena_size_ = 0;
+  return kTfLiteOk;
+}
+
+TfLiteStatus OfflinePlanner::ResetAllocationsAfter(int node) {
+  TfLiteTensor* tensors = graph_info_->tensors();
+  for (int i = 0; i < static_cast<int>(offsets_.size()); ++i) {
+    if (alloc_node_[i] != kNodeNotAssigned && alloc_node_[i] > node &&
+        offsets_[i] != kNoOffset) {
+      TfLiteTensor& tensor = tensors[i];
+      if (tensor.allocation_type == kTfLiteArenaRw) {
+        offsets_[i] = kNoOffset;
+        tensor.data.raw = nullptr;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus OfflinePlanner::PlanAllocations() {
+  // Invalidate any existing data.
+  TF_LITE_ENSURE_STATUS(ResetAllocations());
+  alloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
+  dealloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
+
+  // Keeps track of references to each tensor.
+  std::vector<int> refcounts(graph_info_->num_tensors(), 0);
+
+  auto allocate = [this](int node, int tensor) -> TfLiteStatus {
+    if (alloc_node_[tensor] != kNodeNotAssigned) {
+      // Tensor has already been allocated.
+      return kTfLiteOk;
+    }
+    TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
+    alloc_node_[tensor] = node;
+    return kTfLiteOk;
+  };
+
+  auto deallocate = [this](int node, int tensor) -> TfLiteStatus {
+    if (alloc_node_[tensor] == kNodeNotAssigned) {
+      // We don't need to deallocate the tensor, that is never allocated.
+      // This happened with the constant tensors.
+      return kTfLiteOk;
+    }
+    TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
+    dealloc_node_[tensor] = node;
+    return kTfLiteOk;
+  };
+
+  // We must make sure the output tensors are never overwritten. We do that by
+  // artificially adding one to their ref-counts so they are never selected
+  // for deallocation.
+  for (int tensor_index : graph_info_->outputs()) {
+    refcounts[tensor_index]++;
+  }
+
+  // Variable tensors also should be ensured to be never overwritten and need to
+  // be alive all the time.
+  for (int tensor_index : graph_info_->variables()) {
+    refcounts[tensor_index]++;
+    TF_LITE_ENSURE(context_, tensor_index != kTfLiteOptionalTensor);
+    TF_LITE_ENSURE_STATUS(allocate(0, tensor_index));
+  }
+
+  // Queue all graph inputs for allocation and make sure they are never
+  // overwritten.
+  for (int tensor_index : graph_info_->inputs()) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      refcounts[tensor_index]++;
+      TF_LITE_ENSURE_STATUS(allocate(0, tensor_index));
+    }
+  }
+
+  // Count references to node input tensors.
+  const size_t num_execution_nodes = graph_info_->num_execution_nodes();
+  for (size_t i = 0; i < num_execution_nodes; ++i) {
+    const TfLiteNode& node = graph_info_->node(i);
+    TfLiteIntArray* node_inputs = node.inputs;
+    for (int j = 0; j < node_inputs->size; ++j) {
+      int tensor_index = node_inputs->data[j];
+      if (tensor_index != kTfLiteOptionalTensor) {
+        refcounts[tensor_index]++;
+      }
+    }
+  }
+
+  // Go through the graph in execution order.
+  for (size_t i = 0; i < num_execution_nodes; ++i) {
+    const TfLiteNode& node = graph_info_->node(i);
+
+    // First queue output tensors for allocation.
+    TfLiteIntArray* node_outputs = node.outputs;
+    for (int j = 0; j < node_outputs->size; ++j) {
+      int tensor_index = node_outputs->data[j];
+      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+    }
+
+    // Then update the ref-counts of the node's inputs, and if necessary queue
+    // them for deallocation.
+    TfLiteIntArray* node_inputs = node.inputs;
+    for (int j = 0; j < node_inputs->size; ++j) {
+      int tensor_index = node_inputs->data[j];
+      if (tensor_index != kTfLiteOptionalTensor) {
+        refcounts[tensor_index]--;
+        if (refcounts[tensor_index] == 0) {
+          TF_LITE_ENSURE_STATUS(deallocate(i, tensor_index));
+        }
+      }
+    }
+  }
+
+  // Note that graph outputs will never be scheduled for deallocation. We
+  // could do that here for completeness, but it won't have any effect.
+  return kTfLiteOk;
+}
+
+TfLiteStatus OfflinePlanner::ExecuteAllocations(int first_node, int last_node) {
+  // Grow the size of the per-tensor vectors if necessary. This allows
+  // allocating temporary tensors in op's `prepare` function.
+  const size_t num_tensors = graph_info_->num_tensors();
+  TF_LITE_ENSURE(context_, num_tensors >= offsets_.size());
+  alloc_node_.resize(num_tensors, kNodeNotAssigned);
+  dealloc_node_.resize(num_tensors, kNodeNotAssigned);
+  offsets_.resize(num_tensors, kNoOffset);
+  persistent_allocs_.resize(num_tensors);
+  // Set allocation and deallocation for temporary tensors.
+  const size_t num_execution_nodes = graph_info_->num_execution_nodes();
+  for (size_t i = first_node;
+       i <= static_cast<size_t>(last_node) && i < num_execution_nodes; ++i) {
+    const TfLiteNode& node = graph_info_->node(i);
+    TfLiteIntArray* node_temporaries = node.temporaries;
+    for (int j = 0; j < node_temporaries->size; ++j) {
+      int tensor_index = node_temporaries->data[j];
+      alloc_node_[tensor_index] = i;
+      dealloc_node_[tensor_index] = i;
+    }
+  }
+
+  // Collect the tensors first used by the nodes in [first_node, last_node].
+  TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<int32_t> tensors_to_place;
+  for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
+    if (alloc_node_[i] < first_node || alloc_node_[i] > last_node) continue;
+    TfLiteTensor& tensor = tensors[i];
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      offsets_[i] = kNoOffset;
+      if (tensor.bytes > 0) tensors_to_place.push_back(i);
+    } else if (tensor.allocation_type == kTfLiteArenaRwPersistent &&
+               persistent_allocs_[i].size == 0) {
+      TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
+          context_, tensor_alignment_, tensor.bytes, i,
+          /*first_node=*/alloc_node_[i],
+          /*last_node=*/std::numeric_limits<int32_t>::max(),
+          &persistent_allocs_[i]));
+    }
+  }
+
+  used_offline_offsets_ = false;
+  if (first_node == 0 && AssignOfflineOffsets(tensors_to_place)) {
+    used_offline_offsets_ = true;
+  } else {
+    TF_LITE_ENSURE_STATUS(AssignBestFitOffsets(std::move(tensors_to_place)));
+  }
+
+  // The arena must hold every tensor that has an offset.
+  arena_size_ = 0;
+  for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
+    if (offsets_[i] != kNoOffset) {
+      arena_size_ = std::max(arena_size_, offsets_[i] + tensors[i].bytes);
+    }
+  }
+  EnsureArenaBuffer();
+  bool persistent_reallocated = false;
+  TF_LITE_ENSURE_STATUS(
+      persistent_arena_.Commit(context_, &persistent_reallocated));
+
+  // Resolving is cheap, so every tensor is resolved rather than tracking the
+  // ones whose buffer moved.
+  for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
+    TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
+  }
+  return kTfLiteOk;
+}
+
+bool OfflinePlanner::LifetimesOverlap(int32_t tensor1, int32_t tensor2) const {
+  return alloc_node_[tensor1] <= dealloc_node_[tensor2] &&
+         alloc_node_[tensor2] <= dealloc_node_[tensor1];
+}
+
+bool OfflinePlanner::AssignOfflineOffsets(
+    const std::vector<int32_t>& tensors_to_place) {
+  if (offline_offsets_.size() != offsets_.size()) return false;
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<int32_t> placed;
+  placed.reserve(tensors_to_place.size());
+  for (int32_t tensor_index : tensors_to_place) {
+    const int32_t offset = offline_offsets_[tensor_index];
+    if (offset < 0 || offset % tensor_alignment_ != 0) return false;
+    placed.push_back(tensor_index);
+  }
+  // The offsets may come from a plan made for other tensor sizes, e.g. before
+  // an input was resized, so make sure no two live tensors overlap.
+  std::sort(placed.begin(), placed.end(), [this](int32_t a, int32_t b) {
+    return offline_offsets_[a] < offline_offsets_[b];
+  });
+  for (size_t i = 0; i < placed.size(); ++i) {
+    const size_t end = offline_offsets_[placed[i]] + tensors[placed[i]].bytes;
+    for (size_t j = i + 1;
+         j < placed.size() &&
+         static_cast<size_t>(offline_offsets_[placed[j]]) < end;
+         ++j) {
+      if (LifetimesOverlap(placed[i], placed[j])) return false;
+    }
+  }
+  for (int32_t tensor_index : placed) {
+    offsets_[tensor_index] = offline_offsets_[tensor_index];
+  }
+  return true;
+}
+
+TfLiteStatus OfflinePlanner::AssignBestFitOffsets(
+    std::vector<int32_t> tensors_to_place) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  // Tensors that live through the whole inference go first, then the others
+  // from largest to smallest: large tensors leave gaps the smaller ones fill.
+  auto whole_inference = [this](int32_t t) {
+    return alloc_node_[t] == 0 && dealloc_node_[t] == kNodeNotAssigned;
+  };
+  std::sort(tensors_to_place.begin(), tensors_to_place.end(),
+            [&](int32_t a, int32_t b) {
+              if (whole_inference(a) != whole_inference(b)) {
+                return whole_inference(a);
+              }
+              if (tensors[a].bytes != tensors[b].bytes) {
+                return tensors[a].bytes > tensors[b].bytes;
+              }
+              if (alloc_node_[a] != alloc_node_[b]) {
+                return alloc_node_[a] < alloc_node_[b];
+              }
+              return a < b;
+            });
+
+  // Placed tensors, ordered by offset.
+  std::vector<int32_t> placed;
+  for (int i = 0; i < static_cast<int>(offsets_.size()); ++i) {
+    if (offsets_[i] != kNoOffset) placed.push_back(i);
+  }
+  auto by_offset = [this](int32_t a, int32_t b) {
+    return offsets_[a] < offsets_[b];
+  };
+  std::sort(placed.begin(), placed.end(), by_offset);
+
+  for (int32_t tensor_index : tensors_to_place) {
+    const size_t size = tensors[tensor_index].bytes;
+    // Find the smallest gap between live tensors that fits this one, falling
+    // back to the end of the live tensors.
+    size_t best_offset = 0;
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t current = 0;
+    for (int32_t other : placed) {
+      if (!LifetimesOverlap(tensor_index, other)) continue;
+      const size_t other_offset = offsets_[other];
+      if (other_offset >= current) {
+        const size_t gap = other_offset - current;
+        if (gap >= size && gap < best_gap) {
+          best_gap = gap;
+          best_offset = current;
+        }
+      }
+      current = std::max(
+          current,
+          AlignTo(tensor_alignment_, other_offset + tensors[other].bytes));
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) {
+      best_offset = current;
+    }
+    TF_LITE_ENSURE(context_, best_offset <= kMaxOffset);
+    offsets_[tensor_index] = static_cast<int32_t>(best_offset);
+    placed.insert(
+        std::upper_bound(placed.begin(), placed.end(), tensor_index, by_offset),
+        tensor_index);
+  }
+  return kTfLiteOk;
+}
+
+void OfflinePlanner::EnsureArenaBuffer() {
+  if (arena_buffer_size_ >= arena_size_ && arena_buffer_ != nullptr) return;
+  if (arena_size_ == 0) return;
+  std::unique_ptr<char[]> new_buffer(new char[arena_size_ + kArenaAlignment]);
+  char* new_arena = reinterpret_cast<char*>(AlignTo(
+      kArenaAlignment, reinterpret_cast<std::uintptr_t>(new_buffer.get())));
+  // Tensors allocated before the arena grew keep their contents.
+  if (arena_ != nullptr) {
+    std::memcpy(new_arena, arena_,
+                std::min(arena_buffer_size_, arena_size_));
+  }
+  arena_buffer_ = std::move(new_buffer);
+  arena_ = new_arena;
+  arena_buffer_size_ = arena_size_;
+}
+
+TfLiteStatus OfflinePlanner::ReleaseNonPersistentMemory() {
+  arena_buffer_.reset();
+  arena_ = nullptr;
+  arena_buffer_size_ = 0;
+  // Set data pointers for all non-persistent tensors to nullptr.
+  TfLiteTensor* tensors = graph_info_->tensors();
+  for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+    TfLiteTensor& tensor = tensors[i];
+    if (tensor.allocation_type == kTfLiteArenaRw) {
+      tensor.data.raw = nullptr;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus OfflinePlanner::AcquireNonPersistentMemory() {
+  EnsureArenaBuffer();
+  // Resolve allocations for all tensors not on the persistent arena.
+  TfLiteTensor* tensors = graph_info_->tensors();
+  for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+    if (tensors[i].allocation_type == kTfLiteArenaRw) {
+      TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool OfflinePlanner::HasNonPersistentMemory() {
+  return arena_buffer_size_ != 0;
+}
+
+void OfflinePlanner::DumpDebugInfo(
+    const std::vector<int>& execution_plan) const {
+  persistent_arena_.DumpDebugInfo("kTfLiteArenaRwPersistent Dump:",
+                                  execution_plan);
+}
+
+void OfflinePlanner::GetAllocInfo(size_t* arena_size,
+                                  size_t* arena_persist_size) const {
+  *arena_size = arena_buffer_size_;
+  *arena_persist_size = persistent_arena_.GetBufferSize();
+}
+
+TfLiteStatus OfflinePlanner::ResolveTensorAllocation(int32_t tensor_index) {
+  TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+  if (tensor.allocation_type == kTfLiteArenaRw) {
+    // Skip resolution if the tensor has no offset, e.g. because its size is
+    // zero, leaving it as a nullptr.
+    if (offsets_[tensor_index] != kNoOffset && arena_ != nullptr) {
+      tensor.data.raw = arena_ + offsets_[tensor_index];
+    }
+  }
+  if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
+    return persistent_arena_.ResolveAlloc(
+        context_, persistent_allocs_[tensor_index], &tensor.data.raw);
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
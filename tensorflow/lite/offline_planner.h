@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_OFFLINE_PLANNER_H_
+#define TENSORFLOW_LITE_OFFLINE_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+
+// Name of the model metadata entry holding precomputed arena offsets.
+//
+// The entry is a sequence of records of little-endian int32 values, one record
+// per planned subgraph:
+//   [version (1), subgraph index, number of tensors N, offset_0 ... offset_N-1]
+// An offset of -1 leaves the tensor to be planned at runtime. The first record
+// uses the same layout as the TFLite Micro entry of the same name.
+constexpr char kOfflineMemoryAllocationMetadata[] = "OfflineMemoryAllocation";
+
+// Appends the record of the arena offsets of subgraph `subgraph_index` to
+// `metadata`, the contents of a kOfflineMemoryAllocationMetadata entry.
+void AppendOfflineMemoryPlan(int subgraph_index,
+                             const std::vector<int32_t>& offsets,
+                             std::string* metadata);
+
+// Reads the arena offsets of subgraph `subgraph_index` from `metadata`.
+// Returns false if there is no well-formed record for the subgraph.
+bool FindOfflineMemoryPlan(const std::string& metadata, int subgraph_index,
+                           std::vector<int32_t>* offsets);
+
+// A memory planner that packs the non-persistent arena ahead of time.
+//
+// Unlike ArenaPlanner, which places each tensor while walking the allocation
+// queue, this planner solves the whole packing problem once the tensor sizes
+// are known: tensors are placed largest first, each into the smallest gap left
+// by the already placed tensors whose lifetimes overlap with it (best-fit).
+// The resulting offsets can be persisted in the model metadata (see
+// kOfflineMemoryAllocationMetadata) and handed back to the planner, which then
+// uses them as is, provided they are still valid for the current tensor sizes.
+//
+// Incremental planning, needed after dynamic tensors are resized, keeps the
+// tensors already allocated in place and fits the new ones around them.
+class OfflinePlanner : public MemoryPlanner {
+ public:
+  // Ownership of 'context' is not taken and it must remain util the
+  // OfflinePlanner is destroyed. The inputs to the graph will not share
+  // memory with any other tensor, effectively preserving them until the end
+  // of inference. `offline_offsets`, if not empty, holds one arena offset per
+  // tensor of the graph, as returned by tensor_offsets().
+  OfflinePlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
+                 int tensor_alignment, int subgraph_index = 0,
+                 std::vector<int32_t> offline_offsets = {});
+  ~OfflinePlanner() override;
+  OfflinePlanner(const OfflinePlanner&) = delete;
+  OfflinePlanner& operator=(const OfflinePlanner&) = delete;
+
+  TfLiteStatus ResetAllocations() override;
+  TfLiteStatus ResetAllocationsAfter(int node) override;
+  TfLiteStatus PlanAllocations() override;
+  TfLiteStatus ExecuteAllocations(int first_node, int last_node) override;
+  TfLiteStatus ReleaseNonPersistentMemory() override;
+  TfLiteStatus AcquireNonPersistentMemory() override;
+  bool HasNonPersistentMemory() override;
+  void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
+  void GetAllocInfo(size_t* arena_size,
+                    size_t* arena_persist_size) const override;
+
+  // Returns the base arena location for a given allocation type.
+  std::intptr_t BasePointer(TfLiteAllocationType type);
+
+  // Returns the offset of every tensor in the non-persistent arena, or -1 for
+  // tensors that are not allocated there.
+  const std::vector<int32_t>& tensor_offsets() const { return offsets_; }
+
+  // Returns true if the last plan of the whole graph used the offline offsets.
+  bool used_offline_offsets() const { return used_offline_offsets_; }
+
+ private:
+  // Returns true if the lifetimes of both tensors overlap.
+  bool LifetimesOverlap(int32_t tensor1, int32_t tensor2) const;
+
+  // Assigns `tensors` the offline offsets. Returns false, without assigning
+  // anything, if these are missing or invalid for the current tensor sizes.
+  bool AssignOfflineOffsets(const std::vector<int32_t>& tensors);
+
+  // Assigns `tensors` best-fit offsets around the already placed tensors.
+  TfLiteStatus AssignBestFitOffsets(std::vector<int32_t> tensors);
+
+  // Makes sure the arena buffer holds `arena_size_` bytes, keeping the data.
+  void EnsureArenaBuffer();
+
+  // Assign absolute memory location to a tensor.
+  TfLiteStatus ResolveTensorAllocation(int32_t tensor_index);
+
+  TfLiteContext* context_;
+  std::unique_ptr<GraphInfo> graph_info_;
+  const int tensor_alignment_;
+  const std::vector<int32_t> offline_offsets_;
+  bool used_offline_offsets_ = false;
+
+  // Offset of each tensor in the non-persistent arena, or -1 if it has none.
+  std::vector<int32_t> offsets_;
+
+  // Non-persistent arena, sized to the planned offsets.
+  std::unique_ptr<char[]> arena_buffer_;
+  char* arena_ = nullptr;
+  size_t arena_buffer_size_ = 0;
+  size_t arena_size_ = 0;
+
+  // Persistent tensors are never reused, so they are stacked in this arena.
+  SimpleMemoryArena persistent_arena_;
+  std::vector<ArenaAllocWithUsageInterval> persistent_allocs_;
+
+  // First node, that uses the tensor. It needs to be allocated before
+  // execution of the node's operation.
+  std::vector<int32_t> alloc_node_;
+
+  // Last node, that uses the tensor. It can be deallocated after execution of
+  // the node's operation.
+  std::vector<int32_t> dealloc_node_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_OFFLINE_PLANNER_H_
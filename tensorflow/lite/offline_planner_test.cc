@@ -0,0 +1,395 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/offline_planner.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/graph_info.h"
+#include "tensorflow/lite/testing/util.h"
+
+namespace tflite {
+namespace {
+
+// A simple op to be used in tests, as syntactic sugar.
+class TestOp {
+ public:
+  TestOp(std::initializer_list<int> inputs, std::initializer_list<int> outputs,
+         std::initializer_list<int> temporaries)
+      : inputs_(inputs), outputs_(outputs), temporaries_(temporaries) {}
+
+  const std::vector<int>& inputs() const { return inputs_; }
+  const std::vector<int>& outputs() const { return outputs_; }
+  const std::vector<int>& temporaries() const { return temporaries_; }
+  const TfLiteRegistration& registration() const { return registration_; }
+
+ private:
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::vector<int> temporaries_;
+  TfLiteRegistration registration_;
+};
+
+// A test graph where inputs are processed by the given nodes to produce
+// outputs.
+class TestGraph {
+ public:
+  TestGraph(std::initializer_list<int> inputs,
+            std::initializer_list<TestOp> nodes,
+            std::initializer_list<int> outputs)
+      : inputs_(inputs), outputs_(outputs) {
+    int max_tensor_index = 0;
+
+    for (int t : inputs) {
+      max_tensor_index = std::max(max_tensor_index, t);
+    }
+    for (int t : outputs) {
+      max_tensor_index = std::max(max_tensor_index, t);
+    }
+    for (const auto& node : nodes) {
+      auto int_array = [](const std::vector<int>& x) {
+        TfLiteIntArray* lite = TfLiteIntArrayCreate(x.size());
+        for (size_t i = 0; i < x.size(); i++) lite->data[i] = x[i];
+        return lite;
+      };
+
+      registrations_.push_back(node.registration());
+      nodes_.push_back(TfLiteNode());
+      nodes_.back().inputs = int_array(node.inputs());
+      for (int t : node.inputs()) {
+        max_tensor_index = std::max(max_tensor_index, t);
+      }
+      nodes_.back().outputs = int_array(node.outputs());
+      for (int t : node.outputs()) {
+        max_tensor_index = std::max(max_tensor_index, t);
+      }
+      nodes_.back().temporaries = int_array(node.temporaries());
+      for (int t : node.temporaries()) {
+        max_tensor_index = std::max(max_tensor_index, t);
+      }
+    }
+
+    for (int i = 0; i <= max_tensor_index; ++i) {
+      tensors_.push_back(TfLiteTensor());
+      // Set some default values for allocation_type and bytes, which are the
+      // only fields used by the arena planner.
+      tensors_.back().allocation_type = kTfLiteArenaRw;
+      tensors_.back().bytes = (i + 1) * 3;
+    }
+  }
+
+  ~TestGraph() {
+    for (auto node : nodes_) {
+      TfLiteIntArrayFree(node.inputs);
+      TfLiteIntArrayFree(node.outputs);
+      TfLiteIntArrayFree(node.temporaries);
+    }
+  }
+
+  const std::vector<TfLiteNode>& nodes() { return nodes_; }
+  std::vector<TfLiteTensor>* tensors() { return &tensors_; }
+  const std::vector<int>& inputs() { return inputs_; }
+  const std::vector<int>& outputs() { return outputs_; }
+  const std::vector<int>& variables() { return variables_; }
+  const std::vector<TfLiteRegistration>& registrations() {
+    return registrations_;
+  }
+
+  void SetVariables(const std::vector<int>& variables) {
+    variables_ = variables;
+  }
+
+  void Swap(TestGraph* other) {
+    std::swap(nodes_, other->nodes_);
+    std::swap(tensors_, other->tensors_);
+    std::swap(inputs_, other->inputs_);
+    std::swap(outputs_, other->outputs_);
+    std::swap(variables_, other->variables_);
+  }
+
+ private:
+  std::vector<TfLiteNode> nodes_;
+  std::vector<TfLiteTensor> tensors_;
+  std::vector<TfLiteRegistration> registrations_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  std::vector<int> variables_;
+};
+
+// The GraphInfo for a TestGraph.
+class TestGraphInfo : public GraphInfo {
+ public:
+  explicit TestGraphInfo(TestGraph* graph) : graph_(graph) {}
+
+  size_t num_tensors() const override { return graph_->tensors()->size(); }
+  const TfLiteRegistration& registration(size_t index) const override {
+    return graph_->registrations()[index];
+  }
+  TfLiteTensor* tensor(size_t index) override {
+    return &graph_->tensors()->at(index);
+  }
+  TfLiteTensor* tensors() override { return graph_->tensors()->data(); }
+  size_t num_execution_nodes() const override { return graph_->nodes().size(); }
+  size_t num_total_nodes() const override { return graph_->nodes().size(); }
+  const TfLiteNode& node(size_t index) const override {
+    return graph_->nodes()[index];
+  }
+  size_t node_index(size_t index) const override { return index; }
+  const std::vector<int>& inputs() const override { return graph_->inputs(); }
+  const std::vector<int>& outputs() const override { return graph_->outputs(); }
+  const std::vector<int>& variables() const override {
+    return graph_->variables();
+  }
+
+ private:
+  TestGraph* graph_;
+};
+
+void ReportError(TfLiteContext* context, const char* format, ...) {
+  const size_t kBufferSize = 1024;
+  char temp_buffer[kBufferSize];
+
+  va_list args;
+  va_start(args, format);
+  vsnprintf(temp_buffer, kBufferSize, format, args);
+  va_end(args);
+
+  LOG(INFO) << temp_buffer;
+}
+
+constexpr const int kTensorAlignment = 4;
+
+class OfflinePlannerTest : public ::testing::Test {
+ protected:
+  void SetGraph(TestGraph* graph, std::vector<int32_t> offline_offsets = {}) {
+    graph_ = graph;
+    context_.ReportError = ReportError;
+    planner_ = std::make_unique<OfflinePlanner>(
+        &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
+        kTensorAlignment, /*subgraph_index=*/0, std::move(offline_offsets));
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+    CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  }
+
+  void Execute(int start, int end) {
+    CHECK(planner_->ExecuteAllocations(start, end) == kTfLiteOk);
+  }
+
+  // Returns the actual offset of a given tensor, relative to the start of its
+  // arena.
+  std::ptrdiff_t GetOffset(int tensor_index) {
+    const TfLiteTensor& tensor = (*graph_->tensors())[tensor_index];
+    return reinterpret_cast<std::intptr_t>(tensor.data.raw) -
+           planner_->BasePointer(tensor.allocation_type);
+  }
+
+  TfLiteContext context_;
+  TestGraph* graph_;
+  std::unique_ptr<OfflinePlanner> planner_;
+};
+
+TestGraph MakeSimpleGraph() {
+  return TestGraph({0, 1},
+                   {
+                       /* in, out, tmp */
+                       {{0, 1}, {2}, {}},     // First op
+                       {{2, 0}, {4, 5}, {}},  // Second op
+                       {{4, 5}, {3}, {}}      // Third op
+                   },
+                   {3});
+}
+
+TEST_F(OfflinePlannerTest, EmptyGraph) {
+  TestGraph graph({}, {}, {});
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_FALSE(planner_->HasNonPersistentMemory());
+}
+
+TEST_F(OfflinePlannerTest, ZeroSizedTensors) {
+  TestGraph graph({1}, {{{1}, {2}, {}}}, {2});
+  (*graph.tensors())[1].bytes = 0;
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_EQ((*graph.tensors())[1].data.raw, nullptr);
+  EXPECT_EQ(GetOffset(2), 0);
+}
+
+TEST_F(OfflinePlannerTest, SimpleGraphIsPackedBestFit) {
+  TestGraph graph = MakeSimpleGraph();
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Sizes are 3 * (index + 1). The inputs live through the whole inference
+  // and go first, then the others from largest to smallest; 2 and 3 are never
+  // live at the same time so they share memory.
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(0), 8);
+  EXPECT_EQ(GetOffset(5), 12);
+  EXPECT_EQ(GetOffset(4), 32);
+  EXPECT_EQ(GetOffset(3), 48);
+  EXPECT_EQ(GetOffset(2), 48);
+  EXPECT_FALSE(planner_->used_offline_offsets());
+
+  size_t arena_size, persistent_arena_size;
+  planner_->GetAllocInfo(&arena_size, &persistent_arena_size);
+  EXPECT_EQ(arena_size, size_t{60});
+  EXPECT_EQ(planner_->tensor_offsets(),
+            (std::vector<int32_t>{8, 0, 48, 48, 32, 12}));
+}
+
+TEST_F(OfflinePlannerTest, SmallTensorsFillGaps) {
+  // Tensors 1 and 3 are dead by the time tensor 5 is allocated, leaving a gap
+  // between tensors 2 and 4 that tensor 5 fills.
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},     // First op
+                      {{1}, {2}, {}},     // Second op
+                      {{0, 2}, {3}, {}},  // Third op
+                      {{3}, {4}, {}},     // Fourth op
+                      {{2, 4}, {5}, {}}   // Fifth op
+                  },
+                  {5});
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  tensors[0].bytes = 16;
+  tensors[1].bytes = 32;
+  tensors[2].bytes = 64;
+  tensors[3].bytes = 48;
+  tensors[4].bytes = 8;
+  tensors[5].bytes = 4;
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(2), 16);
+  EXPECT_EQ(GetOffset(3), 80);
+  EXPECT_EQ(GetOffset(1), 80);
+  EXPECT_EQ(GetOffset(4), 128);
+  EXPECT_EQ(GetOffset(5), 80);
+}
+
+TEST_F(OfflinePlannerTest, UsesOfflineOffsets) {
+  TestGraph graph = MakeSimpleGraph();
+  const std::vector<int32_t> offline_offsets = {0, 4, 12, 12, 24, 40};
+  SetGraph(&graph, offline_offsets);
+  Execute(0, 10);
+
+  EXPECT_TRUE(planner_->used_offline_offsets());
+  EXPECT_EQ(planner_->tensor_offsets(), offline_offsets);
+  for (int i = 0; i < static_cast<int>(offline_offsets.size()); ++i) {
+    EXPECT_EQ(GetOffset(i), offline_offsets[i]);
+  }
+}
+
+TEST_F(OfflinePlannerTest, ReplansInvalidOfflineOffsets) {
+  TestGraph graph = MakeSimpleGraph();
+  // Overlaps 2, which is live at the same time as 4.
+  (*graph.tensors())[2].bytes = 20;
+  SetGraph(&graph, {0, 4, 12, 12, 24, 40});
+  Execute(0, 10);
+  EXPECT_FALSE(planner_->used_offline_offsets());
+  EXPECT_EQ(GetOffset(2), 12);
+  EXPECT_EQ(GetOffset(3), 12);
+
+  // Misaligned and missing offsets are not used either.
+  TestGraph graph2 = MakeSimpleGraph();
+  SetGraph(&graph2, {0, 4, 13, 12, 24, 40});
+  Execute(0, 10);
+  EXPECT_FALSE(planner_->used_offline_offsets());
+  TestGraph graph3 = MakeSimpleGraph();
+  SetGraph(&graph3, {0, 4, 12, -1, 24, 40});
+  Execute(0, 10);
+  EXPECT_FALSE(planner_->used_offline_offsets());
+}
+
+TEST_F(OfflinePlannerTest, OfflineOffsetsRoundTrip) {
+  TestGraph graph = MakeSimpleGraph();
+  SetGraph(&graph);
+  Execute(0, 10);
+  const std::vector<int32_t> planned = planner_->tensor_offsets();
+
+  std::string metadata;
+  AppendOfflineMemoryPlan(/*subgraph_index=*/0, {1, 2}, &metadata);
+  AppendOfflineMemoryPlan(/*subgraph_index=*/1, planned, &metadata);
+  std::vector<int32_t> loaded;
+  ASSERT_TRUE(FindOfflineMemoryPlan(metadata, /*subgraph_index=*/1, &loaded));
+  EXPECT_EQ(loaded, planned);
+  EXPECT_FALSE(FindOfflineMemoryPlan(metadata, /*subgraph_index=*/2, &loaded));
+  EXPECT_FALSE(FindOfflineMemoryPlan(metadata.substr(0, metadata.size() - 4),
+                                     /*subgraph_index=*/1, &loaded));
+
+  TestGraph graph2 = MakeSimpleGraph();
+  SetGraph(&graph2, loaded);
+  Execute(0, 10);
+  EXPECT_TRUE(planner_->used_offline_offsets());
+  EXPECT_EQ(planner_->tensor_offsets(), planned);
+}
+
+TEST_F(OfflinePlannerTest, StepwiseAllocationKeepsOffsets) {
+  TestGraph graph = MakeSimpleGraph();
+  SetGraph(&graph);
+  Execute(0, 0);
+  const std::ptrdiff_t offset0 = GetOffset(0);
+  const std::ptrdiff_t offset1 = GetOffset(1);
+  const std::ptrdiff_t offset2 = GetOffset(2);
+  const int32_t value = 1234;
+  memcpy((*graph.tensors())[2].data.raw, &value, sizeof(value));
+
+  Execute(1, 2);
+  EXPECT_EQ(GetOffset(0), offset0);
+  EXPECT_EQ(GetOffset(1), offset1);
+  EXPECT_EQ(GetOffset(2), offset2);
+  // The arena grew, but the data of tensors already allocated was kept.
+  int32_t read;
+  memcpy(&read, (*graph.tensors())[2].data.raw, sizeof(read));
+  EXPECT_EQ(read, value);
+  // 4 and 5 are live at the same time as 2 and are placed after it.
+  EXPECT_GE(GetOffset(4), offset2 + 9);
+  EXPECT_GE(GetOffset(5), offset2 + 9);
+}
+
+TEST_F(OfflinePlannerTest, ReleaseAndAcquireNonPersistentMemory) {
+  TestGraph graph = MakeSimpleGraph();
+  (*graph.tensors())[1].allocation_type = kTfLiteArenaRwPersistent;
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_TRUE(planner_->HasNonPersistentMemory());
+  EXPECT_NE((*graph.tensors())[1].data.raw, nullptr);
+
+  CHECK(planner_->ReleaseNonPersistentMemory() == kTfLiteOk);
+  EXPECT_FALSE(planner_->HasNonPersistentMemory());
+  EXPECT_EQ((*graph.tensors())[0].data.raw, nullptr);
+  EXPECT_NE((*graph.tensors())[1].data.raw, nullptr);
+
+  CHECK(planner_->AcquireNonPersistentMemory() == kTfLiteOk);
+  EXPECT_TRUE(planner_->HasNonPersistentMemory());
+  EXPECT_EQ(GetOffset(0), planner_->tensor_offsets()[0]);
+  EXPECT_EQ(planner_->tensor_offsets()[1], -1);
+}
+
+}  // namespace
+}  // namespace tflite
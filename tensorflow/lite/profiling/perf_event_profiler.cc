@@ -0,0 +1,199 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+constexpr int kDefaultCacheLineSize = 64;
+
+int GetCacheLineSize() {
+  std::ifstream file(
+      "/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size");
+  int size = 0;
+  if (file >> size && size > 0) return size;
+  return kDefaultCacheLineSize;
+}
+
+#if defined(__linux__)
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Only the leader starts disabled, the other counters follow it.
+  attr.disabled = group_fd < 0 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return static_cast<int>(syscall(__NR_perf_event_open, &attr, /*pid=*/0,
+                                  /*cpu=*/-1, group_fd, /*flags=*/0));
+}
+#endif  // __linux__
+
+}  // namespace
+
+PerfEventProfiler::PerfEventProfiler() : cache_line_size_(GetCacheLineSize()) {
+#if defined(__linux__)
+  constexpr uint64_t kConfigs[kNumCounters] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_REFERENCES, PERF_COUNT_HW_CACHE_MISSES};
+  for (uint64_t config : kConfigs) {
+    int fd = OpenCounter(config, group_fd_);
+    if (fd < 0) {
+      // Either the counters are not accessible, or the PMU doesn't implement
+      // one of the events. Partial groups would make the IPC misleading.
+      for (int open_fd : fds_) close(open_fd);
+      fds_.clear();
+      group_fd_ = -1;
+      return;
+    }
+    if (group_fd_ < 0) group_fd_ = fd;
+    fds_.push_back(fd);
+  }
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif  // __linux__
+}
+
+PerfEventProfiler::~PerfEventProfiler() {
+#if defined(__linux__)
+  for (int fd : fds_) close(fd);
+#endif  // __linux__
+}
+
+bool PerfEventProfiler::ReadCounters(uint64_t* values) const {
+#if defined(__linux__)
+  // With PERF_FORMAT_GROUP, the number of counters precedes their values.
+  uint64_t buffer[1 + kNumCounters];
+  if (read(group_fd_, buffer, sizeof(buffer)) != sizeof(buffer) ||
+      buffer[0] != kNumCounters) {
+    return false;
+  }
+  std::memcpy(values, buffer + 1, sizeof(uint64_t) * kNumCounters);
+  return true;
+#else   // __linux__
+  return false;
+#endif  // __linux__
+}
+
+uint32_t PerfEventProfiler::BeginEvent(const char* tag, EventType event_type,
+                                       int64_t event_metadata1,
+                                       int64_t event_metadata2) {
+  // Delegated nodes are counted as part of the delegate kernel node running
+  // them, so only the operator invocations of the subgraphs are profiled.
+  if (!enabled_ || !IsSupported() ||
+      event_type != EventType::OPERATOR_INVOKE_EVENT) {
+    return 0;
+  }
+  // For operator invocations, the tag is the op name, the first metadata is
+  // the node index and the second is the subgraph index.
+  OpenEvent event{tag, /*subgraph_index=*/event_metadata2,
+                  /*node_index=*/event_metadata1, {}};
+  if (!ReadCounters(event.begin)) return 0;
+  open_events_.push_back(std::move(event));
+  return open_events_.size();
+}
+
+void PerfEventProfiler::EndEvent(uint32_t event_handle) {
+  if (!event_handle || open_events_.size() < event_handle) return;
+  uint64_t end[kNumCounters];
+  if (ReadCounters(end)) {
+    const OpenEvent& event = open_events_[event_handle - 1];
+    OpHardwareCounters& counters =
+        op_counters_[{event.subgraph_index, event.node_index}];
+    if (counters.invocations == 0) {
+      counters.op_name = event.tag;
+      counters.subgraph_index = event.subgraph_index;
+      counters.node_index = event.node_index;
+    }
+    ++counters.invocations;
+    counters.cycles += end[kCycles] - event.begin[kCycles];
+    counters.instructions += end[kInstructions] - event.begin[kInstructions];
+    counters.cache_references +=
+        end[kCacheReferences] - event.begin[kCacheReferences];
+    counters.cache_misses += end[kCacheMisses] - event.begin[kCacheMisses];
+  }
+  // Operator events are nested like scopes, so this also drops any event
+  // which was left open inside the ending one.
+  open_events_.resize(event_handle - 1);
+}
+
+void PerfEventProfiler::Reset() {
+  open_events_.clear();
+  op_counters_.clear();
+}
+
+std::vector<OpHardwareCounters> PerfEventProfiler::GetOpCounters() const {
+  std::vector<OpHardwareCounters> result;
+  result.reserve(op_counters_.size());
+  for (const auto& entry : op_counters_) result.push_back(entry.second);
+  return result;
+}
+
+std::string PerfEventProfiler::GetOutputString() const {
+  std::stringstream stream;
+  stream << std::left << std::setw(10) << "subgraph" << std::setw(8) << "node"
+         << std::setw(28) << "op" << std::right << std::setw(8) << "count"
+         << std::setw(16) << "avg cycles" << std::setw(8) << "IPC"
+         << std::setw(16) << "avg cache refs" << std::setw(16)
+         << "avg cache miss" << std::setw(10) << "miss %" << std::setw(16)
+         << "avg bytes moved" << "\n";
+  stream << std::fixed;
+  for (const auto& entry : op_counters_) {
+    const OpHardwareCounters& counters = entry.second;
+    const double invocations = counters.invocations;
+    const double ipc =
+        counters.cycles == 0
+            ? 0.0
+            : static_cast<double>(counters.instructions) / counters.cycles;
+    const double miss_rate =
+        counters.cache_references == 0
+            ? 0.0
+            : 100.0 * counters.cache_misses / counters.cache_references;
+    stream << std::left << std::setw(10) << counters.subgraph_index
+           << std::setw(8) << counters.node_index << std::setw(28)
+           << counters.op_name << std::right << std::setw(8)
+           << counters.invocations << std::setprecision(0) << std::setw(16)
+           << counters.cycles / invocations << std::setprecision(2)
+           << std::setw(8) << ipc << std::setprecision(0) << std::setw(16)
+           << counters.cache_references / invocations << std::setw(16)
+           << counters.cache_misses / invocations << std::setprecision(2)
+           << std::setw(10) << miss_rate << std::setprecision(0)
+           << std::setw(16)
+           << counters.cache_misses * cache_line_size_ / invocations << "\n";
+  }
+  return stream.str();
+}
+
+}  // namespace profiling
+}  // namespace tflite
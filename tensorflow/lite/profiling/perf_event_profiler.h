@@ -0,0 +1,115 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_PERF_EVENT_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_PERF_EVENT_PROFILER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+// Hardware counters accumulated over all the invocations of a node.
+struct OpHardwareCounters {
+  std::string op_name;
+  int64_t subgraph_index = 0;
+  int64_t node_index = 0;
+  int64_t invocations = 0;
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  uint64_t cache_references = 0;
+  uint64_t cache_misses = 0;
+};
+
+// Profiler reading the Linux perf_event hardware counters around each
+// operator invocation, so that instructions per cycle and cache misses can be
+// reported per node.
+//
+// The counters are opened for the thread creating the profiler, which must be
+// the thread calling `Invoke`. Work that kernels or delegates hand off to
+// worker threads is not counted, so the numbers are only complete for single
+// threaded runs. Only user space is counted, which works with the default
+// `perf_event_paranoid` setting of 2.
+//
+// On platforms without perf_event, or when the kernel denies access to the
+// counters, `IsSupported` returns false and no event is recorded.
+class PerfEventProfiler : public tflite::Profiler {
+ public:
+  PerfEventProfiler();
+  ~PerfEventProfiler() override;
+
+  PerfEventProfiler(const PerfEventProfiler&) = delete;
+  PerfEventProfiler& operator=(const PerfEventProfiler&) = delete;
+
+  // Whether the hardware counters could be opened.
+  bool IsSupported() const { return group_fd_ >= 0; }
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  void StartProfiling() { enabled_ = true; }
+  void StopProfiling() { enabled_ = false; }
+  void Reset();
+
+  // Returns the accumulated counters of every profiled node, ordered by
+  // subgraph and node index.
+  std::vector<OpHardwareCounters> GetOpCounters() const;
+
+  // Returns a table of the per node counters. Bytes moved are estimated as
+  // the cache misses times the cache line size.
+  std::string GetOutputString() const;
+
+ private:
+  enum Counter {
+    kCycles = 0,
+    kInstructions,
+    kCacheReferences,
+    kCacheMisses,
+    kNumCounters
+  };
+
+  struct OpenEvent {
+    std::string tag;
+    int64_t subgraph_index;
+    int64_t node_index;
+    uint64_t begin[kNumCounters];
+  };
+
+  // Reads all the counters of the group at once into `values`.
+  bool ReadCounters(uint64_t* values) const;
+
+  bool enabled_ = false;
+  // The group leader counts cycles, the other counters are read along with it.
+  int group_fd_ = -1;
+  std::vector<int> fds_;
+  int cache_line_size_;
+
+  // Events that began and haven't ended yet, indexed by handle minus one.
+  std::vector<OpenEvent> open_events_;
+  std::map<std::pair<int64_t, int64_t>, OpHardwareCounters> op_counters_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_PERF_EVENT_PROFILER_H_
@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using EventType = Profiler::EventType;
+
+// Runs enough work between the events for the counters to move.
+void InvokeOp(Profiler* profiler, const char* op_name, int node_index) {
+  uint32_t handle =
+      profiler->BeginEvent(op_name, EventType::OPERATOR_INVOKE_EVENT,
+                           /*event_metadata1=*/node_index,
+                           /*event_metadata2=*/0);
+  volatile int sum = 0;
+  for (int i = 0; i < 100000; ++i) sum = sum + i;
+  profiler->EndEvent(handle);
+}
+
+TEST(PerfEventProfilerTest, NothingIsRecordedWhenDisabled) {
+  PerfEventProfiler profiler;
+  InvokeOp(&profiler, "ADD", 0);
+  EXPECT_TRUE(profiler.GetOpCounters().empty());
+}
+
+TEST(PerfEventProfilerTest, OnlyOperatorInvocationsAreRecorded) {
+  PerfEventProfiler profiler;
+  profiler.StartProfiling();
+  uint32_t handle = profiler.BeginEvent(
+      "Invoke", EventType::DEFAULT, /*event_metadata1=*/0,
+      /*event_metadata2=*/0);
+  EXPECT_EQ(handle, 0);
+  profiler.EndEvent(handle);
+  EXPECT_TRUE(profiler.GetOpCounters().empty());
+}
+
+TEST(PerfEventProfilerTest, CountersAreAccumulatedPerNode) {
+  PerfEventProfiler profiler;
+  if (!profiler.IsSupported()) {
+    GTEST_SKIP() << "perf_event hardware counters are not available.";
+  }
+  profiler.StartProfiling();
+  InvokeOp(&profiler, "CONV_2D", 0);
+  InvokeOp(&profiler, "ADD", 1);
+  InvokeOp(&profiler, "CONV_2D", 0);
+  profiler.StopProfiling();
+  InvokeOp(&profiler, "ADD", 1);
+
+  std::vector<OpHardwareCounters> counters = profiler.GetOpCounters();
+  ASSERT_EQ(counters.size(), 2);
+  EXPECT_EQ(counters[0].op_name, "CONV_2D");
+  EXPECT_EQ(counters[0].node_index, 0);
+  EXPECT_EQ(counters[0].invocations, 2);
+  EXPECT_EQ(counters[1].op_name, "ADD");
+  EXPECT_EQ(counters[1].node_index, 1);
+  EXPECT_EQ(counters[1].invocations, 1);
+  for (const OpHardwareCounters& op : counters) {
+    EXPECT_GT(op.cycles, 0);
+    EXPECT_GT(op.instructions, 0);
+  }
+  EXPECT_NE(profiler.GetOutputString().find("CONV_2D"), std::string::npos);
+
+  profiler.Reset();
+  EXPECT_TRUE(profiler.GetOpCounters().empty());
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
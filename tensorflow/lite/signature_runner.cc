@@ -70,6 +70,47 @@ TfLiteStatus SignatureRunner::ResizeInputTensorStrict(
   return subgraph_->ResizeInputTensorStrict(it->second, new_size);
 }
 
+TfLiteStatus SignatureRunner::SetCustomAllocationForInputTensor(
+    const char* input_name, const TfLiteCustomAllocation& allocation,
+    int64_t flags) {
+  const auto& it = signature_def_->inputs.find(input_name);
+  if (it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  return SetCustomAllocationForTensor(it->second, allocation, flags);
+}
+
+TfLiteStatus SignatureRunner::SetCustomAllocationForOutputTensor(
+    const char* output_name, const TfLiteCustomAllocation& allocation,
+    int64_t flags) {
+  const auto& it = signature_def_->outputs.find(output_name);
+  if (it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return SetCustomAllocationForTensor(it->second, allocation, flags);
+}
+
+TfLiteStatus SignatureRunner::SetCustomAllocationForTensor(
+    int tensor_index, const TfLiteCustomAllocation& allocation,
+    int64_t flags) {
+  // Swapping the buffer of a tensor that already has a custom allocation
+  // doesn't change the memory plan, so AllocateTensors() won't run again to
+  // check the new buffer. Check it against the current size instead.
+  const TfLiteTensor* tensor = subgraph_->tensor(tensor_index);
+  if (tensor->allocation_type == kTfLiteCustom &&
+      allocation.bytes < tensor->bytes) {
+    subgraph_->ReportError(
+        "Custom allocation of %zu bytes is too small for tensor %s of %zu "
+        "bytes",
+        allocation.bytes, tensor->name ? tensor->name : "", tensor->bytes);
+    return kTfLiteError;
+  }
+  return subgraph_->SetCustomAllocationForTensor(tensor_index, allocation,
+                                                 flags);
+}
+
 TfLiteStatus SignatureRunner::Invoke() {
   // "Resets" cancellation flag so cancellation happens before this invoke will
   // not take effect.
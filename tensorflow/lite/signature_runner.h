@@ -133,6 +133,36 @@ class SignatureRunner {
   /// Updates allocations for all tensors, related to the given signature.
   TfLiteStatus AllocateTensors() { return subgraph_->AllocateTensors(); }
 
+  /// \brief Assigns (or reassigns) a custom memory allocation for the input
+  /// tensor identified by 'input_name'. `flags` is a bitmask, see
+  /// TfLiteCustomAllocationFlags. The runtime does NOT take ownership of the
+  /// underlying memory.
+  ///
+  /// The first time a tensor gets a custom allocation, the user needs to call
+  /// AllocateTensors() afterwards. Once AllocateTensors() has run, the
+  /// allocation can be swapped for another one before each Invoke() without
+  /// calling AllocateTensors() again: the new buffer is checked against the
+  /// current size of the tensor right away, and the memory plan is kept.
+  /// This allows pipelines to run on caller-owned buffers without copies.
+  ///
+  /// The allocation must satisfy the conditions documented for
+  /// Interpreter::SetCustomAllocationForTensor, in particular its data must be
+  /// aligned to kDefaultTensorAlignment unless
+  /// kTfLiteCustomAllocationFlagsSkipAlignCheck is set.
+  /// \warning This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForInputTensor(
+      const char* input_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
+  /// \brief Assigns (or reassigns) a custom memory allocation for the output
+  /// tensor identified by 'output_name', so that Invoke() writes the output
+  /// directly into caller-owned memory. See
+  /// SetCustomAllocationForInputTensor for the conditions that apply.
+  /// \warning This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForOutputTensor(
+      const char* output_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
   /// Invokes the signature runner (run the graph identified by the given
   /// signature in dependency order).
   TfLiteStatus Invoke();
@@ -152,6 +182,9 @@ class SignatureRunner {
   // SignatureRunner objects don't outlive their corresponding Subgraph objects.
   SignatureRunner(const internal::SignatureDef* signature_def,
                   Subgraph* subgraph);
+  TfLiteStatus SetCustomAllocationForTensor(
+      int tensor_index, const TfLiteCustomAllocation& allocation,
+      int64_t flags);
   friend class ::tflite::impl::Interpreter;
   friend class SignatureRunnerJNIHelper;
   friend class TensorHandle;
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/core/interpreter_builder.h"
 #include "tensorflow/lite/core/kernels/register.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace {
@@ -93,5 +94,66 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, CustomAllocationForInputsAndOutputs) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+
+  alignas(kDefaultTensorAlignment) float input_a[2] = {2, 4};
+  alignas(kDefaultTensorAlignment) float output_a[2] = {0, 0};
+  alignas(kDefaultTensorAlignment) float input_b[2] = {10, 20};
+  alignas(kDefaultTensorAlignment) float output_b[2] = {0, 0};
+  ASSERT_EQ(add_runner->SetCustomAllocationForInputTensor(
+                "dummy", {input_a, sizeof(input_a)}),
+            kTfLiteError);
+  ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor(
+                "dummy", {output_a, sizeof(output_a)}),
+            kTfLiteError);
+  ASSERT_EQ(add_runner->SetCustomAllocationForInputTensor(
+                "x", {input_a, sizeof(input_a)}),
+            kTfLiteOk);
+  ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor(
+                "output_0", {output_a, sizeof(output_a)}),
+            kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(add_runner->input_tensor("x")->data.raw,
+            reinterpret_cast<char*>(input_a));
+  ASSERT_EQ(add_runner->output_tensor("output_0")->data.raw,
+            reinterpret_cast<char*>(output_a));
+  ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+  EXPECT_EQ(output_a[0], 4);
+  EXPECT_EQ(output_a[1], 6);
+
+  // Rebinding to other buffers doesn't need AllocateTensors().
+  ASSERT_EQ(add_runner->SetCustomAllocationForInputTensor(
+                "x", {input_b, sizeof(input_b)}),
+            kTfLiteOk);
+  ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor(
+                "output_0", {output_b, sizeof(output_b)}),
+            kTfLiteOk);
+  ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+  EXPECT_EQ(output_b[0], 12);
+  EXPECT_EQ(output_b[1], 22);
+  EXPECT_EQ(output_a[0], 4);
+  EXPECT_EQ(output_a[1], 6);
+
+  // A buffer that is too small for the tensor is rejected right away.
+  ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor(
+                "output_0", {output_a, sizeof(float)}),
+            kTfLiteError);
+  ASSERT_EQ(add_runner->output_tensor("output_0")->data.raw,
+            reinterpret_cast<char*>(output_b));
+}
+
 }  // namespace
 }  // namespace tflite
@@ -0,0 +1,310 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_concurrent_models.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Initializes the interpreters one after the other, and starts running all of
+// them at the same time once they are all initialized.
+class StartGate {
+ public:
+  explicit StartGate(int num_interpreters)
+      : num_interpreters_(num_interpreters) {}
+
+  // Blocks until the 'index' interpreters before the one at 'index' are
+  // initialized.
+  void WaitForTurn(int index) {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [&] { return num_initialized_ >= index; });
+  }
+
+  // Marks one more interpreter as initialized, or as failed to initialize.
+  void MarkInitialized() {
+    std::lock_guard<std::mutex> lock(mu_);
+    ++num_initialized_;
+    cv_.notify_all();
+  }
+
+  // Blocks until all the interpreters are initialized.
+  void WaitForAll() {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [&] { return num_initialized_ >= num_interpreters_; });
+  }
+
+ private:
+  const int num_interpreters_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  int num_initialized_ = 0;
+};
+
+// Records the latencies of the regular runs of one interpreter, and holds the
+// interpreter back at 'gate' once it is initialized.
+class InterpreterRecorder : public BenchmarkListener {
+ public:
+  explicit InterpreterRecorder(StartGate* gate) : gate_(gate) {}
+
+  void OnBenchmarkStart(const BenchmarkParams& params) override {
+    started_ = true;
+    gate_->MarkInitialized();
+    gate_->WaitForAll();
+  }
+
+  void OnSingleRunStart(RunType run_type) override {
+    regular_run_ = run_type == REGULAR;
+    if (!regular_run_) return;
+    run_start_us_ = profiling::time::NowMicros();
+    first_run_start_us_ = std::min(first_run_start_us_, run_start_us_);
+  }
+
+  void OnSingleRunEnd() override {
+    if (!regular_run_) return;
+    last_run_end_us_ = profiling::time::NowMicros();
+    latencies_us_.push_back(last_run_end_us_ - run_start_us_);
+  }
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    completed_ = true;
+    results_ = results;
+  }
+
+  bool started() const { return started_; }
+  bool completed() const { return completed_; }
+  const BenchmarkResults& results() const { return results_; }
+  const std::vector<int64_t>& latencies_us() const { return latencies_us_; }
+  int64_t first_run_start_us() const { return first_run_start_us_; }
+  int64_t last_run_end_us() const { return last_run_end_us_; }
+
+ private:
+  StartGate* const gate_;
+  bool started_ = false;
+  bool completed_ = false;
+  BenchmarkResults results_;
+  bool regular_run_ = false;
+  int64_t run_start_us_ = 0;
+  // Of the regular runs only: the warmup runs aren't recorded.
+  int64_t first_run_start_us_ = std::numeric_limits<int64_t>::max();
+  int64_t last_run_end_us_ = 0;
+  std::vector<int64_t> latencies_us_;
+};
+
+// Returns the nearest-rank 'percentile' of the sorted 'values'.
+int64_t Percentile(const std::vector<int64_t>& values, int percentile) {
+  if (values.empty()) return 0;
+  const size_t rank = (values.size() * percentile + 99) / 100;
+  return values[std::max<size_t>(rank, 1) - 1];
+}
+
+}  // namespace
+
+BenchmarkConcurrentModels::BenchmarkConcurrentModels(
+    BenchmarkModelFactory create_benchmark)
+    : params_(DefaultParams()),
+      create_benchmark_(std::move(create_benchmark)) {}
+
+BenchmarkParams BenchmarkConcurrentModels::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("graphs", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("num_interpreters_per_graph",
+                  BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("run_frequencies", BenchmarkParam::Create<std::string>(""));
+  return params;
+}
+
+std::vector<Flag> BenchmarkConcurrentModels::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "graphs", &params_,
+          "A comma-separated list of models to benchmark concurrently. By "
+          "default, only the model set by --graph is benchmarked."),
+      CreateFlag<int32_t>(
+          "num_interpreters_per_graph", &params_,
+          "The number of interpreters of each model running concurrently."),
+      CreateFlag<std::string>(
+          "run_frequencies", &params_,
+          "A comma-separated list with, for each model, the number of runs "
+          "per second of each of its interpreters. If set, this overrides "
+          "--run_frequency."),
+  };
+}
+
+TfLiteStatus BenchmarkConcurrentModels::Run(int argc, char** argv) {
+  auto flag_list = GetFlags();
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list)) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return kTfLiteError;
+  }
+
+  std::vector<std::string> graphs;
+  const std::string& graphs_list = params_.Get<std::string>("graphs");
+  if (!util::SplitAndParse(graphs_list, ',', &graphs)) {
+    TFLITE_LOG(ERROR) << "Cannot parse --graphs: '" << graphs_list << "'.";
+    return kTfLiteError;
+  }
+  // An empty graph keeps the model set by --graph.
+  if (graphs.empty()) graphs.emplace_back();
+
+  std::vector<float> run_frequencies;
+  const std::string& frequencies_list =
+      params_.Get<std::string>("run_frequencies");
+  if (!util::SplitAndParse(frequencies_list, ',', &run_frequencies) ||
+      (!run_frequencies.empty() && run_frequencies.size() != graphs.size())) {
+    TFLITE_LOG(ERROR) << "Cannot parse --run_frequencies: '"
+                      << frequencies_list << "', it must have one value per "
+                      << "model.";
+    return kTfLiteError;
+  }
+
+  const int num_interpreters_per_graph =
+      params_.Get<int32_t>("num_interpreters_per_graph");
+  if (num_interpreters_per_graph <= 0) {
+    TFLITE_LOG(ERROR) << "--num_interpreters_per_graph must be positive, got "
+                      << num_interpreters_per_graph << ".";
+    return kTfLiteError;
+  }
+
+  const int num_interpreters = graphs.size() * num_interpreters_per_graph;
+  StartGate gate(num_interpreters);
+  std::vector<std::unique_ptr<BenchmarkModel>> benchmarks;
+  std::vector<std::unique_ptr<InterpreterRecorder>> recorders;
+  for (int i = 0; i < num_interpreters; ++i) {
+    const int graph_index = i / num_interpreters_per_graph;
+    std::unique_ptr<BenchmarkModel> benchmark = create_benchmark_();
+    // Every benchmark consumes the flags it knows of, so it parses its own
+    // copy of them.
+    std::vector<char*> args(argv, argv + argc);
+    args.push_back(nullptr);
+    int num_args = argc;
+    TF_LITE_ENSURE_STATUS(benchmark->ParseFlags(&num_args, args.data()));
+    BenchmarkParams* params = benchmark->mutable_params();
+    if (!graphs[graph_index].empty()) {
+      if (!params->HasParam("graph")) {
+        TFLITE_LOG(ERROR) << "--graphs is not supported by this benchmark.";
+        return kTfLiteError;
+      }
+      params->Set<std::string>("graph", graphs[graph_index]);
+    }
+    if (!run_frequencies.empty()) {
+      params->Set<float>("run_frequency", run_frequencies[graph_index]);
+    }
+
+    recorders.push_back(std::make_unique<InterpreterRecorder>(&gate));
+    benchmark->AddListener(recorders.back().get());
+    for (BenchmarkListener* listener : listeners_) {
+      benchmark->AddListener(listener);
+    }
+    benchmarks.push_back(std::move(benchmark));
+  }
+
+  std::vector<TfLiteStatus> statuses(num_interpreters, kTfLiteOk);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_interpreters; ++i) {
+    threads.emplace_back([&, i]() {
+      gate.WaitForTurn(i);
+      statuses[i] = benchmarks[i]->Run();
+      // Don't hold the other interpreters back if this one failed to
+      // initialize.
+      if (!recorders[i]->started()) gate.MarkInitialized();
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  results_.clear();
+  TfLiteStatus status = kTfLiteOk;
+  for (int graph_index = 0; graph_index < graphs.size(); ++graph_index) {
+    GraphResults results;
+    results.graph = graphs[graph_index];
+    results.num_interpreters = num_interpreters_per_graph;
+    std::vector<int64_t> latencies_us;
+    int64_t first_run_start_us = std::numeric_limits<int64_t>::max();
+    int64_t last_run_end_us = 0;
+    for (int i = graph_index * num_interpreters_per_graph;
+         i < (graph_index + 1) * num_interpreters_per_graph; ++i) {
+      const InterpreterRecorder& recorder = *recorders[i];
+      if (statuses[i] != kTfLiteOk || !recorder.completed()) {
+        ++results.num_failed_interpreters;
+        status = kTfLiteError;
+        continue;
+      }
+      latencies_us.insert(latencies_us.end(), recorder.latencies_us().begin(),
+                          recorder.latencies_us().end());
+      first_run_start_us =
+          std::min(first_run_start_us, recorder.first_run_start_us());
+      last_run_end_us = std::max(last_run_end_us, recorder.last_run_end_us());
+      const auto& init_mem_usage = recorder.results().init_mem_usage();
+      if (init_mem_usage.IsSupported()) {
+        results.init_mem_footprint_mb =
+            std::max(results.init_mem_footprint_mb, 0.0) +
+            init_mem_usage.mem_footprint_kb / 1024.0;
+      }
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    results.num_runs = latencies_us.size();
+    if (!latencies_us.empty() && last_run_end_us > first_run_start_us) {
+      results.throughput_runs_per_second =
+          results.num_runs * 1e6 / (last_run_end_us - first_run_start_us);
+    }
+    results.p50_latency_us = Percentile(latencies_us, 50);
+    results.p99_latency_us = Percentile(latencies_us, 99);
+    results_.push_back(std::move(results));
+  }
+
+  OutputResults();
+  return status;
+}
+
+void BenchmarkConcurrentModels::OutputResults() const {
+  TFLITE_LOG(INFO)
+      << "\n==============Summary of Concurrent Runs==============";
+  for (const GraphResults& results : results_) {
+    TFLITE_LOG(INFO) << "Graph: ["
+                     << (results.graph.empty() ? "--graph" : results.graph)
+                     << "] interpreters: " << results.num_interpreters
+                     << " (failed: " << results.num_failed_interpreters
+                     << ") runs: " << results.num_runs
+                     << " throughput (runs/s): "
+                     << results.throughput_runs_per_second
+                     << " latency p50 (us): " << results.p50_latency_us
+                     << " p99 (us): " << results.p99_latency_us;
+    if (results.init_mem_footprint_mb >= 0) {
+      TFLITE_LOG(INFO) << "Memory footprint delta of the initialization of "
+                       << "its interpreters (MB): "
+                       << results.init_mem_footprint_mb;
+    }
+  }
+}
+
+}  // namespace benchmark
+}  // namespace tflite
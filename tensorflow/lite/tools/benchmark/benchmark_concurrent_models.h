@@ -0,0 +1,92 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_CONCURRENT_MODELS_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_CONCURRENT_MODELS_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Benchmarks several models, and several interpreters of each of them, running
+// concurrently, e.g. to measure the latency of a model under contention.
+//
+// Each interpreter is benchmarked by its own 'BenchmarkModel' object, on its
+// own thread. They are initialized one after the other, so that the memory
+// footprint of each of them can be told apart, and then all run their warmup
+// and regular runs at the same time.
+class BenchmarkConcurrentModels {
+ public:
+  using BenchmarkModelFactory =
+      std::function<std::unique_ptr<BenchmarkModel>()>;
+
+  // The results of all the interpreters of one model.
+  struct GraphResults {
+    std::string graph;
+    int num_interpreters = 0;
+    int num_failed_interpreters = 0;
+    int64_t num_runs = 0;
+    double throughput_runs_per_second = 0.0;
+    int64_t p50_latency_us = 0;
+    int64_t p99_latency_us = 0;
+    // Sum of the memory footprint deltas of the initialization of the
+    // interpreters, or a negative value if it isn't available.
+    double init_mem_footprint_mb = -1.0;
+  };
+
+  // 'create_benchmark' creates the object benchmarking one interpreter. The
+  // objects must have a "graph" parameter if --graphs is set.
+  explicit BenchmarkConcurrentModels(BenchmarkModelFactory create_benchmark);
+
+  // Adds 'listener' to the benchmark of every interpreter. Doesn't own the
+  // memory of 'listener', which is called concurrently from the threads of
+  // the interpreters and so must be thread-safe.
+  void AddListener(BenchmarkListener* listener) {
+    listeners_.push_back(listener);
+  }
+
+  // Flags that aren't flags of this class are passed to the benchmark of
+  // every interpreter.
+  TfLiteStatus Run(int argc, char** argv);
+
+  // Returns the results of the last 'Run', one per model.
+  const std::vector<GraphResults>& results() const { return results_; }
+
+ private:
+  static BenchmarkParams DefaultParams();
+  std::vector<Flag> GetFlags();
+
+  void OutputResults() const;
+
+  BenchmarkParams params_;
+  const BenchmarkModelFactory create_benchmark_;
+  std::vector<BenchmarkListener*> listeners_;  // Doesn't own the memory.
+  std::vector<GraphResults> results_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_CONCURRENT_MODELS_H_
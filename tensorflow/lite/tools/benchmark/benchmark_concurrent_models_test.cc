@@ -0,0 +1,132 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_concurrent_models.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// A benchmark whose runs sleep for a millisecond, and which fails to
+// initialize the graph named "bad".
+class SleepingBenchmarkModel : public BenchmarkModel {
+ public:
+  SleepingBenchmarkModel() : BenchmarkModel(Params()) {}
+
+  TfLiteStatus Init() override {
+    return params_.Get<std::string>("graph") == "bad" ? kTfLiteError
+                                                      : kTfLiteOk;
+  }
+
+ protected:
+  uint64_t ComputeInputBytes() override { return 0; }
+
+  TfLiteStatus RunImpl() override {
+    util::SleepForSeconds(0.001);
+    return kTfLiteOk;
+  }
+
+ private:
+  static BenchmarkParams Params() {
+    BenchmarkParams params = DefaultParams();
+    params.AddParam("graph", BenchmarkParam::Create<std::string>(""));
+    return params;
+  }
+};
+
+class CountingListener : public BenchmarkListener {
+ public:
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    ++num_benchmarks_;
+  }
+
+  int num_benchmarks() const { return num_benchmarks_; }
+
+ private:
+  std::atomic<int> num_benchmarks_{0};
+};
+
+TfLiteStatus RunBenchmark(BenchmarkConcurrentModels* benchmark,
+                          std::vector<std::string> flags) {
+  flags.insert(flags.begin(), "benchmark");
+  flags.push_back("--num_runs=5");
+  flags.push_back("--min_secs=0");
+  flags.push_back("--warmup_min_secs=0");
+  std::vector<char*> argv;
+  for (std::string& flag : flags) {
+    argv.push_back(flag.data());
+  }
+  return benchmark->Run(argv.size(), argv.data());
+}
+
+BenchmarkConcurrentModels CreateBenchmark() {
+  return BenchmarkConcurrentModels(
+      []() { return std::make_unique<SleepingBenchmarkModel>(); });
+}
+
+TEST(BenchmarkConcurrentModelsTest, RunsAllInterpreters) {
+  BenchmarkConcurrentModels benchmark = CreateBenchmark();
+  CountingListener listener;
+  benchmark.AddListener(&listener);
+  ASSERT_EQ(RunBenchmark(&benchmark,
+                         {"--graphs=a,b", "--num_interpreters_per_graph=2"}),
+            kTfLiteOk);
+
+  EXPECT_EQ(listener.num_benchmarks(), 4);
+  ASSERT_EQ(benchmark.results().size(), 2);
+  EXPECT_EQ(benchmark.results()[0].graph, "a");
+  EXPECT_EQ(benchmark.results()[1].graph, "b");
+  for (const auto& results : benchmark.results()) {
+    EXPECT_EQ(results.num_interpreters, 2);
+    EXPECT_EQ(results.num_failed_interpreters, 0);
+    EXPECT_EQ(results.num_runs, 10);
+    EXPECT_GT(results.throughput_runs_per_second, 0.0);
+    EXPECT_GE(results.p50_latency_us, 1000);
+    EXPECT_GE(results.p99_latency_us, results.p50_latency_us);
+  }
+}
+
+TEST(BenchmarkConcurrentModelsTest, ReportsFailedInterpreters) {
+  BenchmarkConcurrentModels benchmark = CreateBenchmark();
+  EXPECT_EQ(RunBenchmark(&benchmark, {"--graphs=a,bad"}), kTfLiteError);
+
+  ASSERT_EQ(benchmark.results().size(), 2);
+  EXPECT_EQ(benchmark.results()[0].num_failed_interpreters, 0);
+  EXPECT_EQ(benchmark.results()[0].num_runs, 5);
+  EXPECT_EQ(benchmark.results()[1].num_failed_interpreters, 1);
+  EXPECT_EQ(benchmark.results()[1].num_runs, 0);
+}
+
+TEST(BenchmarkConcurrentModelsTest, RejectsMismatchedRunFrequencies) {
+  BenchmarkConcurrentModels benchmark = CreateBenchmark();
+  EXPECT_EQ(RunBenchmark(&benchmark, {"--graphs=a,b", "--run_frequencies=10"}),
+            kTfLiteError);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
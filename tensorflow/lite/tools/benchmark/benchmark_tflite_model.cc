@@ -370,6 +370,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -452,6 +454,9 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<bool>("enable_op_hardware_counters", &params_,
+                       "report per op cycles, IPC and cache misses from the "
+                       "perf_event hardware counters"),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -518,6 +523,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_hardware_counters",
+                      "Enable op hardware counters", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -775,6 +782,10 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   }
 
   AddOwnedListener(MayCreateProfilingListener());
+  if (params_.Get<bool>("enable_op_hardware_counters")) {
+    AddOwnedListener(std::unique_ptr<BenchmarkListener>(
+        new HardwareCounterListener(interpreter_.get())));
+  }
   AddOwnedListener(std::unique_ptr<BenchmarkListener>(
       new InterpreterStatePrinter(interpreter_.get())));
 
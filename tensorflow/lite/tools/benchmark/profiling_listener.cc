@@ -89,5 +89,29 @@ void ProfilingListener::WriteOutput(const std::string& header,
   (*stream) << data << std::endl;
 }
 
+HardwareCounterListener::HardwareCounterListener(Interpreter* interpreter) {
+  TFLITE_TOOLS_CHECK(interpreter);
+  if (!profiler_.IsSupported()) {
+    TFLITE_LOG(WARN) << "Hardware counters are not available, make sure "
+                        "perf_event is supported and accessible.";
+    return;
+  }
+  // Added rather than set, so that it runs along with the op profiler.
+  interpreter->AddProfiler(&profiler_);
+}
+
+void HardwareCounterListener::OnSingleRunStart(RunType run_type) {
+  if (run_type == REGULAR) profiler_.StartProfiling();
+}
+
+void HardwareCounterListener::OnSingleRunEnd() { profiler_.StopProfiling(); }
+
+void HardwareCounterListener::OnBenchmarkEnd(const BenchmarkResults& results) {
+  if (profiler_.GetOpCounters().empty()) return;
+  TFLITE_LOG(INFO) << "Operator-wise Hardware Counters for Regular Benchmark "
+                      "Runs:\n"
+                   << profiler_.GetOutputString();
+}
+
 }  // namespace benchmark
 }  // namespace tflite
@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/lite/profiling/buffered_profiler.h"
+#include "tensorflow/lite/profiling/perf_event_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -56,6 +57,22 @@ class ProfilingListener : public BenchmarkListener {
   profiling::BufferedProfiler profiler_;
 };
 
+// Dumps the per operator hardware counters of the regular benchmark runs, if
+// perf_event is available.
+class HardwareCounterListener : public BenchmarkListener {
+ public:
+  explicit HardwareCounterListener(Interpreter* interpreter);
+
+  void OnSingleRunStart(RunType run_type) override;
+
+  void OnSingleRunEnd() override;
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  profiling::PerfEventProfiler profiler_;
+};
+
 }  // namespace benchmark
 }  // namespace tflite
 
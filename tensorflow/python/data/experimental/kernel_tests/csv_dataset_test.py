@@ -534,6 +534,22 @@ class CsvDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
     self._test_dataset_on_buffer_sizes(
         inputs, expected, linebreak='\r\n', record_defaults=record_defaults)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testWithBufferSizeAndLongFields(self):
+    # Test that fields longer than the buffer, which are scanned in word-sized
+    # chunks, are parsed correctly with all buffer sizes.
+    record_defaults = [['NA']] * 3
+    long_field = 'abcdefghijklmnopqrstuvwxyz' * 3
+    inputs = [[
+        '%s,"%s",%s' % (long_field, long_field, long_field),
+        '"a""%s""b",,"%s\n%s"' % (long_field, long_field, long_field)
+    ]]
+    expected = [[long_field, long_field, long_field],
+                ['a"%s"b' % long_field, 'NA',
+                 '%s\n%s' % (long_field, long_field)]]
+    self._test_dataset_on_buffer_sizes(
+        inputs, expected, linebreak='\n', record_defaults=record_defaults)
+
   @combinations.generate(test_base.default_test_combinations())
   def testWithGzipCompressionType(self):
     record_defaults = [['NA']] * 3
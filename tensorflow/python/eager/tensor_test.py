@@ -274,6 +274,15 @@ class TFETensorTest(test_util.TensorFlowTestCase):
     t_np = t.numpy()
     self.assertTrue(np.all(t_np == t_np_orig), "%s vs %s" % (t_np, t_np_orig))
 
+  def testStringTensorFromBytesAndObjectArrays(self):
+    # Fixed width bytes elements lose their NUL padding, like in numpy.
+    t = _create_tensor(np.array([b"a", b"a\0b", b""], dtype="S4"))
+    self.assertAllEqual([b"a", b"a\0b", b""], t.numpy().tolist())
+    t = _create_tensor(np.array([[b"a", b"ab"], [b"", b"a\0"]], dtype=object))
+    self.assertAllEqual([[b"a", b"ab"], [b"", b"a\0"]], t.numpy().tolist())
+    t = _create_tensor(np.array([b"a", b"b", b"c", b"d"])[::2])
+    self.assertAllEqual([b"a", b"c"], t.numpy().tolist())
+
   def testIterateOverTensor(self):
     l = [[1, 2], [3, 4]]
     t = _create_tensor(l)
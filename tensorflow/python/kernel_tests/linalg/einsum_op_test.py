@@ -235,6 +235,28 @@ class EinsumOpTest(test.TestCase):
           ((4, 3), (None, 3)))
     check('...ij,...jk->...ik', ((3, 1, 2, 3), None), ((1, 7, 3, 4), None))
 
+  @test_util.run_deprecated_v1
+  def testChangingInputShapes(self):
+    # The kernel caches the dimensions it computed for the last input shapes;
+    # feeding different shapes to the same kernel must not reuse them.
+    with self.cached_session():
+      x = array_ops.placeholder(dtypes.float32, shape=None)
+      y = array_ops.placeholder(dtypes.float32, shape=None)
+      z = gen_linalg_ops.einsum([x, y], '...ij,...jk->...ik')
+      r = np.random.RandomState(0)
+      for x_shape, y_shape in [((2, 3), (3, 4)), ((5, 2, 3), (3, 4)),
+                               ((2, 3), (3, 4)), ((2, 1, 2, 2), (3, 2, 1))]:
+        x_np = r.randn(*x_shape).astype(np.float32)
+        y_np = r.randn(*y_shape).astype(np.float32)
+        self.assertAllClose(
+            np.einsum('...ij,...jk->...ik', x_np, y_np),
+            z.eval(feed_dict={x: x_np, y: y_np}), atol=1e-4, rtol=1e-4)
+      with self.assertRaises(errors.InvalidArgumentError):
+        z.eval(feed_dict={x: np.ones((2, 3)), y: np.ones((4, 4))})
+      self.assertAllClose(
+          np.full((2, 4), 3.0),
+          z.eval(feed_dict={x: np.ones((2, 3)), y: np.ones((3, 4))}))
+
   def testOutputRepeatedLabels(self):
     # This is the reverse operation of generalized traces, to be used for
     # computing symbolic gradients of einsum. Note: this operation is not
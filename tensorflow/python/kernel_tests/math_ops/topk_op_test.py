@@ -183,6 +183,31 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float16)
     self._testMediumTopK(dtypes.bfloat16.as_numpy_dtype)
 
+  def _testLongRowsSmallK(self, dtype, b):
+    n = 100000
+    k = 100
+    inputs = np.random.permutation(
+        np.linspace(0, 100, b * n, dtype=dtype)).reshape(b, n)
+    indices = np.argsort(-inputs, axis=1)[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+    self._validateTopK(inputs, k, values, indices, sorted=False)
+
+  def testLongRowsSmallK(self):
+    # A single row is split between threads.
+    self._testLongRowsSmallK(np.float32, b=1)
+    self._testLongRowsSmallK(np.float32, b=5)
+    self._testLongRowsSmallK(np.float64, b=2)
+
+  def testLongRowsSmallKStableSort(self):
+    b = 2
+    n = 100000
+    k = 50
+    inputs = np.random.randint(0, 4, size=(b, n)).astype(np.int32)
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -2975,6 +2975,31 @@ class DeepConv2DTest(test.TestCase):
   def testConv2D3x3FilterStride1x1Same(self):
     self._RunTestCases([1, 1], "SAME")
 
+  def testConv2D3x3FilterAutotune(self):
+    x1 = np.random.rand(2, 35, 35, 288).astype(np.float32)
+    x2 = np.random.rand(3, 3, 288, 384).astype(np.float32)
+
+    with self.cached_session(use_gpu=False):
+      conv = nn_ops.conv2d(
+          constant_op.constant(x1), constant_op.constant(x2),
+          strides=[1, 1, 1, 1], padding="SAME")
+
+      os.environ["TF_USE_DEEP_CONV2D"] = "0"
+      values_expect = self.evaluate(conv)
+
+      os.environ["TF_USE_DEEP_CONV2D"] = "1"
+      os.environ["TF_AUTOTUNE_DEEP_CONV2D"] = "1"
+      try:
+        # The first run measures both implementations, the second one uses
+        # the cached choice.
+        values_tuned = self.evaluate(conv)
+        values_cached = self.evaluate(conv)
+      finally:
+        del os.environ["TF_AUTOTUNE_DEEP_CONV2D"]
+
+      self.assertAllClose(values_expect, values_tuned, rtol=1e-5, atol=1e-5)
+      self.assertAllClose(values_expect, values_cached, rtol=1e-5, atol=1e-5)
+
 
 class Conv2DBenchmark(test.Benchmark):
 
@@ -45,6 +45,17 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5], result)
 
+  def testStringToHashBucketsFastLargeInput(self):
+    # Mixes strings stored inline in the tensor with longer ones, in an input
+    # large enough to be hashed in parallel.
+    strings = [str(i) * (i % 40) for i in range(100)]
+    for num_buckets in [16, 10]:
+      expected = self.evaluate(
+          string_ops.string_to_hash_bucket_fast(strings, num_buckets))
+      output = string_ops.string_to_hash_bucket_fast(strings * 100,
+                                                     num_buckets)
+      self.assertAllEqual(list(expected) * 100, self.evaluate(output))
+
   @test_util.run_deprecated_v1
   def testStringToOneHashBucketLegacyHash(self):
     with self.cached_session():
@@ -250,8 +250,42 @@ Status PyObjectToString(PyObject* obj, const char** ptr, Py_ssize_t* len,
 
 // Iterate over the string array 'array', extract the ptr and len of each string
 // element and call f(ptr, len).
+//
+// The elements of C-contiguous object and bytes arrays are read in place,
+// without the item objects that PyArray_GETITEM would create for bytes arrays.
 template <typename F>
 Status PyBytesArrayMap(PyArrayObject* array, F f) {
+  if (PyArray_IS_C_CONTIGUOUS(array)) {
+    const npy_intp size = PyArray_SIZE(array);
+    if (PyArray_TYPE(array) == NPY_OBJECT) {
+      PyObject** items = reinterpret_cast<PyObject**>(PyArray_DATA(array));
+      for (npy_intp i = 0; i < size; ++i) {
+        if (items[i] == nullptr) {
+          return errors::Internal(
+              "Unable to get element from the feed - no item.");
+        }
+        Py_ssize_t len;
+        const char* ptr;
+        PyObject* ptr_owner = nullptr;
+        TF_RETURN_IF_ERROR(PyObjectToString(items[i], &ptr, &len, &ptr_owner));
+        f(ptr, len);
+        Py_XDECREF(ptr_owner);
+      }
+      return OkStatus();
+    }
+    if (PyArray_TYPE(array) == NPY_STRING) {
+      const char* data = static_cast<const char*>(PyArray_DATA(array));
+      const npy_intp itemsize = PyArray_ITEMSIZE(array);
+      for (npy_intp i = 0; i < size; ++i, data += itemsize) {
+        // Like numpy, drop the NUL padding of the fixed width elements.
+        Py_ssize_t len = itemsize;
+        while (len > 0 && data[len - 1] == '\0') --len;
+        f(data, len);
+      }
+      return OkStatus();
+    }
+  }
+
   Safe_PyObjectPtr iter = tensorflow::make_safe(
       PyArray_IterNew(reinterpret_cast<PyObject*>(array)));
   while (PyArray_ITER_NOTDONE(iter.get())) {
@@ -298,25 +332,23 @@ Status CopyTF_TensorStringsToPyArray(const TF_Tensor* src, uint64 nelems,
 
   const tstring* tstr = static_cast<const tstring*>(tensor_data);
 
-  std::unique_ptr<TF_Status, decltype(&TF_DeleteStatus)> status(
-      TF_NewStatus(), TF_DeleteStatus);
-  auto iter = make_safe(PyArray_IterNew(reinterpret_cast<PyObject*>(dst)));
+  // `dst` is a newly created C-contiguous object array, so its items are
+  // replaced in place rather than through PyArray_SETITEM.
+  DCHECK_EQ(NPY_OBJECT, PyArray_TYPE(dst));
+  DCHECK(PyArray_IS_C_CONTIGUOUS(dst));
+  PyObject** items = reinterpret_cast<PyObject**>(PyArray_DATA(dst));
   for (int64_t i = 0; i < static_cast<int64_t>(nelems); ++i) {
     const tstring& tstr_i = tstr[i];
-    auto py_string =
-        make_safe(PyBytes_FromStringAndSize(tstr_i.data(), tstr_i.size()));
+    PyObject* py_string =
+        PyBytes_FromStringAndSize(tstr_i.data(), tstr_i.size());
     if (py_string == nullptr) {
       return errors::Internal(
           "failed to create a python byte array when converting element #", i,
           " of a TF_STRING tensor to a numpy ndarray");
     }
-
-    if (PyArray_SETITEM(dst, static_cast<char*>(PyArray_ITER_DATA(iter.get())),
-                        py_string.get()) != 0) {
-      return errors::Internal("Error settings element #", i,
-                              " in the numpy ndarray");
-    }
-    PyArray_ITER_NEXT(iter.get());
+    PyObject* previous_item = items[i];
+    items[i] = py_string;
+    Py_XDECREF(previous_item);
   }
   return OkStatus();
 }
@@ -42,7 +42,9 @@ def all_reduce(t,
       be done.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`. On CPU, `hierarchical_ring` reduces within each task first,
+      and `hierarchical_ring_bf16` or `hierarchical_ring_fp16` additionally
+      compress float tensors sent between tasks.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -118,7 +120,9 @@ def all_reduce_v2(t,
       value.  Can be 'Id' for no operation.
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      `nccl`. On CPU, `hierarchical_ring` reduces within each task first,
+      and `hierarchical_ring_bf16` or `hierarchical_ring_fp16` additionally
+      compress float tensors sent between tasks.
     timeout: a float. If set to a non zero, set a completion timeout to detect
       staleness.  If the timer goes off, a DeadlineExceededError is raised.  The
       timeout value in seconds. This feature is experimental.
@@ -273,6 +273,21 @@ class NestTest(parameterized.TestCase, test.TestCase):
     unflattened = nest.pack_sequence_as("goodbye", flattened)
     self.assertEqual(structure, unflattened)
 
+  def testFlatten_listAndTupleSubclassesAreIterated(self):
+
+    class ReversedList(list):
+
+      def __iter__(self):
+        return reversed(list(super().__iter__()))
+
+    class MyTuple(tuple):
+      pass
+
+    structure = [ReversedList([1, 2]), (3, MyTuple((4, [5]))), [[6], (7,)]]
+    self.assertEqual([2, 1, 3, 4, 5, 6, 7], nest.flatten(structure))
+    # Flattening the same structure again uses the cached kinds of its types.
+    self.assertEqual([2, 1, 3, 4, 5, 6, 7], nest.flatten(structure))
+
   def testPackSequenceAs_notIterableError(self):
     with self.assertRaisesRegex(TypeError, self.bad_pack_pattern):
       nest.pack_sequence_as("hi", "bye")
@@ -206,7 +206,7 @@ class CachedTypeCheck {
  private:
   std::function<int(PyObject*)> ternary_predicate_;
   mutex type_to_sequence_map_mu_;
-  std::unordered_map<PyTypeObject*, bool> type_to_sequence_map_
+  std::unordered_map<PyTypeObject*, int> type_to_sequence_map_
       TF_GUARDED_BY(type_to_sequence_map_mu_);
 };
 
@@ -697,6 +697,111 @@ bool FlattenHelper(
   return true;
 }
 
+// How Flatten() traverses the objects of a type, i.e. the result of the
+// IsNestedHelper and GetValueIterator dispatch for the type.
+enum class NestKind {
+  kLeaf = 0,
+  kList,      // Exactly a list.
+  kTuple,     // Exactly a tuple.
+  kDict,      // A dict or a subclass of dict.
+  kMapping,   // Any other mapping.
+  kAttrs,     // An attrs-decorated class.
+  kSequence,  // Any other sequence or mapping view.
+};
+
+// Returns the NestKind of `o` as an int, or -1 if an error occurred.
+// All the checks only depend on the type of `o`, so the kind is computed once
+// per type and then found with a single cache lookup.
+int GetNestKind(PyObject* o) {
+  static auto* const check_cache = new CachedTypeCheck([](PyObject* to_check) {
+    const int is_nested = IsNestedHelper(to_check);
+    if (is_nested == -1) return -1;
+    NestKind kind;
+    if (!is_nested) {
+      kind = NestKind::kLeaf;
+    } else if (PyDict_Check(to_check)) {
+      kind = NestKind::kDict;
+    } else if (IsMappingHelper(to_check)) {
+      kind = NestKind::kMapping;
+    } else if (IsAttrsHelper(to_check)) {
+      kind = NestKind::kAttrs;
+    } else if (PyList_CheckExact(to_check)) {
+      kind = NestKind::kList;
+    } else if (PyTuple_CheckExact(to_check)) {
+      kind = NestKind::kTuple;
+    } else {
+      kind = NestKind::kSequence;
+    }
+    return static_cast<int>(kind);
+  });
+  return check_cache->CachedLookup(o);
+}
+
+// Same as FlattenHelper with IsNestedHelper and GetValueIterator, but
+// dispatches on the cached NestKind of each object, and reads the items of
+// lists and tuples in place.
+bool FastFlattenHelper(PyObject* nested, PyObject* list) {
+  const int kind = GetNestKind(nested);
+  if (kind == -1) return false;
+
+  switch (static_cast<NestKind>(kind)) {
+    case NestKind::kLeaf:
+      return PyList_Append(list, nested) != -1;
+    case NestKind::kTuple: {
+      const Py_ssize_t size = PyTuple_GET_SIZE(nested);
+      for (Py_ssize_t i = 0; i < size; ++i) {
+        if (Py_EnterRecursiveCall(" in flatten")) {
+          return false;
+        }
+        // The tuple is immutable, so its items stay alive while it is.
+        const bool success =
+            FastFlattenHelper(PyTuple_GET_ITEM(nested, i), list);
+        Py_LeaveRecursiveCall();
+        if (!success) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case NestKind::kList: {
+      // The list may be modified by the `keys()` or `__getitem__` of a
+      // mapping it contains, so its size is read again and its items are
+      // referenced while they are flattened.
+      for (Py_ssize_t i = 0; i < PyList_GET_SIZE(nested); ++i) {
+        if (Py_EnterRecursiveCall(" in flatten")) {
+          return false;
+        }
+        PyObject* item = PyList_GET_ITEM(nested, i);
+        Py_INCREF(item);
+        const bool success = FastFlattenHelper(item, list);
+        Py_DECREF(item);
+        Py_LeaveRecursiveCall();
+        if (!success) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      break;
+  }
+
+  ValueIteratorPtr iter = GetValueIterator(nested);
+  if (!iter->valid()) return false;
+
+  for (Safe_PyObjectPtr item = iter->next(); item; item = iter->next()) {
+    if (Py_EnterRecursiveCall(" in flatten")) {
+      return false;
+    }
+    const bool success = FastFlattenHelper(item.get(), list);
+    Py_LeaveRecursiveCall();
+    if (!success) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Sets error using keys of 'dict1' and 'dict2'.
 // 'dict1' and 'dict2' are assumed to be Python dictionaries.
 void SetDifferentKeysError(PyObject* dict1, PyObject* dict2, string* error_msg,
@@ -989,6 +1094,13 @@ PyObject* MappingKeys(PyObject* o) {
 
 PyObject* Flatten(PyObject* nested, bool expand_composites) {
   PyObject* list = PyList_New(0);
+  if (!expand_composites) {
+    if (FastFlattenHelper(nested, list)) {
+      return list;
+    }
+    Py_DECREF(list);
+    return nullptr;
+  }
   const std::function<int(PyObject*)>& is_nested_helper =
       expand_composites ? IsNestedOrCompositeHelper : IsNestedHelper;
   const std::function<ValueIteratorPtr(PyObject*)>& get_value_iterator =
@@ -0,0 +1,78 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/benchmark_report.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace benchmark_report {
+
+void SetExtra(const string& name, double value, BenchmarkEntry* entry) {
+  (*entry->mutable_extras())[name].set_double_value(value);
+}
+
+void SetExtra(const string& name, const string& value, BenchmarkEntry* entry) {
+  (*entry->mutable_extras())[name].set_string_value(value);
+}
+
+void AddMetric(const string& name, double value, BenchmarkEntry* entry) {
+  MetricEntry* metric = entry->add_metrics();
+  metric->set_name(name);
+  metric->set_value(value);
+}
+
+Status ReportEntry(const BenchmarkEntry& entry) {
+  TestReporter reporter(entry.name());
+  TF_RETURN_IF_ERROR(reporter.Initialize());
+  TF_RETURN_IF_ERROR(reporter.Benchmark(entry.iters(), -1.0,
+                                        entry.wall_time() * entry.iters(),
+                                        entry.throughput()));
+  for (const auto& extra : entry.extras()) {
+    if (extra.second.kind_case() == EntryValue::kStringValue) {
+      TF_RETURN_IF_ERROR(
+          reporter.SetProperty(extra.first, extra.second.string_value()));
+    } else {
+      TF_RETURN_IF_ERROR(
+          reporter.SetProperty(extra.first, extra.second.double_value()));
+    }
+  }
+  for (const MetricEntry& metric : entry.metrics()) {
+    TF_RETURN_IF_ERROR(reporter.AddMetric(metric.name(), metric.value()));
+  }
+  return reporter.Close();
+}
+
+Status WriteEntries(const string& path, const BenchmarkEntries& entries) {
+  if (!absl::EndsWith(path, ".json")) {
+    return WriteTextProto(Env::Default(), path, entries);
+  }
+  string json;
+  protobuf::util::JsonPrintOptions options;
+  options.add_whitespace = true;
+  auto status = protobuf::util::MessageToJsonString(entries, &json, options);
+  if (!status.ok()) {
+    return errors::Internal("Could not convert the report to JSON: ",
+                            string(status.message()));
+  }
+  return WriteStringToFile(Env::Default(), path, json);
+}
+
+}  // namespace benchmark_report
+}  // namespace tensorflow
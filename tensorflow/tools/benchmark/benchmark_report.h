@@ -0,0 +1,46 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_REPORT_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_REPORT_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+namespace benchmark_report {
+
+// Sets the extra `name` of `entry`.
+void SetExtra(const string& name, double value, BenchmarkEntry* entry);
+void SetExtra(const string& name, const string& value, BenchmarkEntry* entry);
+
+// Adds the metric `name` to `entry`.
+void AddMetric(const string& name, double value, BenchmarkEntry* entry);
+
+// Records `entry` with a TestReporter, which writes it to the file given by
+// the TEST_REPORT_FILE_PREFIX environment variable, if set. The times of
+// `entry` are per iteration, like the ones of TestReporter.
+Status ReportEntry(const BenchmarkEntry& entry);
+
+// Writes `entries` to `path`, as JSON if the name ends with ".json" and as a
+// text proto otherwise.
+Status WriteEntries(const string& path, const BenchmarkEntries& entries);
+
+}  // namespace benchmark_report
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_REPORT_H_
@@ -0,0 +1,319 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to benchmark a serialized tf.data input pipeline, without the
+// Python runtime.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/dataset_benchmark.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/tools/benchmark/benchmark_report.h"
+
+namespace tensorflow {
+namespace dataset_benchmark {
+
+namespace {
+
+using benchmark_report::AddMetric;
+using benchmark_report::SetExtra;
+
+constexpr char kOptionsNodeName[] = "dataset_benchmark/OptionsDataset";
+
+// Adds the nodes of the autotuning model of the pipeline to `entry`, keyed by
+// their long name, e.g. "ParallelMapV2(id:3)".
+Status AddModelStats(data::model::Model* model, BenchmarkEntry* entry) {
+  data::model::ModelProto model_proto;
+  TF_RETURN_IF_ERROR(model->ToProto(&model_proto));
+  int64_t total_buffered_bytes = 0;
+  for (const auto& node_entry : model_proto.nodes()) {
+    const data::model::ModelProto::Node& node = node_entry.second;
+    const string prefix = absl::StrCat(node.name(), "(id:", node.id(), ")/");
+    SetExtra(absl::StrCat(prefix, "num_elements"), node.num_elements(), entry);
+    if (node.num_elements() > 0) {
+      // The processing time of a node excludes the time spent in its inputs.
+      SetExtra(absl::StrCat(prefix, "self_time_us"),
+               node.processing_time() / 1000.0 / node.num_elements(), entry);
+    }
+    SetExtra(absl::StrCat(prefix, "buffered_bytes"), node.buffered_bytes(),
+             entry);
+    SetExtra(absl::StrCat(prefix, "bytes_produced"), node.bytes_produced(),
+             entry);
+    for (const auto& parameter : node.parameters()) {
+      SetExtra(absl::StrCat(prefix, parameter.name()), parameter.value(),
+               entry);
+    }
+    total_buffered_bytes += node.buffered_bytes();
+  }
+  SetExtra("buffered_bytes", total_buffered_bytes, entry);
+  return OkStatus();
+}
+
+Status ReadGraph(const string& path, GraphDef* graph_def) {
+  Status s = ReadBinaryProto(Env::Default(), path, graph_def);
+  if (!s.ok()) s = ReadTextProto(Env::Default(), path, graph_def);
+  return s;
+}
+
+}  // namespace
+
+Status OverrideAutotuneOptions(const data::AutotuneOptions& autotune,
+                               GraphDef* graph_def) {
+  if (autotune.ByteSizeLong() == 0) return OkStatus();
+
+  // Like `standalone::Dataset`, uses the last `_Retval` as the dataset.
+  NodeDef* retval = nullptr;
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() == "_Retval") retval = &node;
+  }
+  if (retval == nullptr || retval->input_size() == 0) {
+    return errors::NotFound("Failed to find a _Retval op in the given dataset");
+  }
+  const string dataset_name(ParseTensorName(retval->input(0)).node());
+  const NodeDef* dataset = nullptr;
+  for (const NodeDef& node : graph_def->node()) {
+    if (node.name() == dataset_name) dataset = &node;
+    if (node.name() == kOptionsNodeName) {
+      return errors::AlreadyExists("The autotuning options of the dataset "
+                                   "were already overridden");
+    }
+  }
+  if (dataset == nullptr) {
+    return errors::NotFound("Failed to find the dataset node ", dataset_name);
+  }
+  auto output_types = dataset->attr().find("output_types");
+  auto output_shapes = dataset->attr().find("output_shapes");
+  if (output_types == dataset->attr().end() ||
+      output_shapes == dataset->attr().end()) {
+    return errors::InvalidArgument("The dataset node ", dataset_name,
+                                   " has no output types and shapes");
+  }
+
+  // Options set on a dataset take precedence over the ones of its inputs.
+  data::Options options;
+  *options.mutable_autotune_options() = autotune;
+  NodeDef options_node;
+  options_node.set_name(kOptionsNodeName);
+  options_node.set_op("OptionsDataset");
+  options_node.add_input(retval->input(0));
+  AddNodeAttr("serialized_options", options.SerializeAsString(),
+              &options_node);
+  (*options_node.mutable_attr())["output_types"] = output_types->second;
+  (*options_node.mutable_attr())["output_shapes"] = output_shapes->second;
+  retval->set_input(0, kOptionsNodeName);
+  *graph_def->add_node() = std::move(options_node);
+  return OkStatus();
+}
+
+Status RunDatasetBenchmark(const GraphDef& graph_def,
+                           const DatasetBenchmarkOptions& options,
+                           BenchmarkEntry* entry) {
+  // The allocator stats must be enabled before the pipeline allocates memory,
+  // so that the memory it frees is accounted for.
+  EnableCPUAllocatorStats();
+  Allocator* allocator = cpu_allocator();
+
+  GraphDef benchmark_graph_def = graph_def;
+  TF_RETURN_IF_ERROR(
+      OverrideAutotuneOptions(options.autotune, &benchmark_graph_def));
+
+  data::standalone::Dataset::Params params;
+  if (options.num_threads > 0) {
+    ConfigProto& config = params.session_options.config;
+    config.set_intra_op_parallelism_threads(options.num_threads);
+    config.set_inter_op_parallelism_threads(options.num_threads);
+  }
+  std::unique_ptr<data::standalone::Dataset> dataset;
+  TF_RETURN_IF_ERROR(data::standalone::Dataset::FromGraph(
+      params, benchmark_graph_def, &dataset));
+  std::unique_ptr<data::standalone::Iterator> iterator;
+  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  int64_t num_warmup_elements = 0;
+  while (!end_of_input && num_warmup_elements < options.warmup_elements) {
+    outputs.clear();
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+    if (!end_of_input) ++num_warmup_elements;
+  }
+
+  // The peak memory is measured from the start of the timed elements, which
+  // excludes the one-time allocations of the warmup.
+  allocator->ClearStats();
+  int64_t num_elements = 0;
+  int64_t num_bytes = 0;
+  const int64_t start_time = Env::Default()->NowMicros();
+  int64_t elapsed_us = 0;
+  while (!end_of_input &&
+         (options.num_elements <= 0 || num_elements < options.num_elements)) {
+    outputs.clear();
+    TF_RETURN_IF_ERROR(iterator->GetNext(&outputs, &end_of_input));
+    elapsed_us = Env::Default()->NowMicros() - start_time;
+    if (!end_of_input) {
+      ++num_elements;
+      for (const Tensor& output : outputs) num_bytes += output.TotalBytes();
+    }
+    if (options.max_time_s > 0.0 && elapsed_us / 1e6 > options.max_time_s) {
+      break;
+    }
+  }
+  const absl::optional<AllocatorStats> allocator_stats = allocator->GetStats();
+
+  entry->Clear();
+  entry->set_name(options.name);
+  entry->set_iters(num_elements);
+  const double elapsed_s = elapsed_us / 1e6;
+  if (num_elements > 0) entry->set_wall_time(elapsed_s / num_elements);
+  if (elapsed_s > 0.0) {
+    entry->set_throughput(num_bytes / elapsed_s / 1e6);
+    AddMetric("elements_per_sec", num_elements / elapsed_s, entry);
+  }
+  SetExtra("num_threads", options.num_threads, entry);
+  SetExtra("warmup_elements", num_warmup_elements, entry);
+  SetExtra("end_of_input", end_of_input ? 1.0 : 0.0, entry);
+  if (allocator_stats) {
+    SetExtra("peak_bytes_in_use", allocator_stats->peak_bytes_in_use, entry);
+  }
+  std::shared_ptr<data::model::Model> model = iterator->model();
+  if (model != nullptr && model->output() != nullptr) {
+    TF_RETURN_IF_ERROR(AddModelStats(model.get(), entry));
+  }
+  return OkStatus();
+}
+
+int Main(int argc, char** argv) {
+  string graph = "";
+  string output_path = "";
+  string autotune = "";
+  int32_t autotune_cpu_budget = 0;
+  int64_t autotune_ram_budget = 0;
+  string autotune_algorithm = "";
+  float max_time_s = 0.0f;
+  DatasetBenchmarkOptions options;
+
+  std::vector<Flag> flag_list = {
+      Flag("graph", &graph,
+           "serialized dataset graph, as a binary or text GraphDef"),
+      Flag("name", &options.name, "name of the benchmark entry"),
+      Flag("num_threads", &options.num_threads,
+           "number of threads of the runtime"),
+      Flag("autotune", &autotune,
+           "'true' or 'false' to override whether the pipeline is autotuned"),
+      Flag("autotune_cpu_budget", &autotune_cpu_budget,
+           "overrides the CPU budget of autotuning, if positive"),
+      Flag("autotune_ram_budget", &autotune_ram_budget,
+           "overrides the RAM budget of autotuning in bytes, if positive"),
+      Flag("autotune_algorithm", &autotune_algorithm,
+           "overrides the autotuning algorithm, e.g. 'STAGE_BASED'"),
+      Flag("warmup_elements", &options.warmup_elements,
+           "number of elements produced before the timed ones"),
+      Flag("num_elements", &options.num_elements,
+           "number of timed elements, or 0 to run until the end of input"),
+      Flag("max_time_s", &max_time_s,
+           "stops the timed elements after this many seconds, if positive"),
+      Flag("output", &output_path,
+           "file to write the BenchmarkEntries report to, as JSON if the "
+           "name ends with .json and as a text proto otherwise"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+
+  // We need to call this to set up global state for TensorFlow.
+  port::InitMain(argv[0], &argc, &argv);
+
+  if (!parse_result || graph.empty()) {
+    LOG(ERROR) << "\n" << usage;
+    return -1;
+  }
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+  options.max_time_s = max_time_s;
+  if (autotune == "true" || autotune == "false") {
+    options.autotune.set_enabled(autotune == "true");
+  } else if (!autotune.empty()) {
+    LOG(ERROR) << "Invalid --autotune: " << autotune << "\n" << usage;
+    return -1;
+  }
+  if (autotune_cpu_budget > 0) {
+    options.autotune.set_cpu_budget(autotune_cpu_budget);
+  }
+  if (autotune_ram_budget > 0) {
+    options.autotune.set_ram_budget(autotune_ram_budget);
+  }
+  if (!autotune_algorithm.empty()) {
+    data::model::AutotuneAlgorithm algorithm;
+    if (!data::model::AutotuneAlgorithm_Parse(autotune_algorithm, &algorithm)) {
+      LOG(ERROR) << "Invalid --autotune_algorithm: " << autotune_algorithm;
+      return -1;
+    }
+    options.autotune.set_autotune_algorithm(algorithm);
+  }
+
+  GraphDef graph_def;
+  Status s = ReadGraph(graph, &graph_def);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not read the dataset graph: " << s;
+    return -1;
+  }
+  BenchmarkEntries entries;
+  BenchmarkEntry* entry = entries.add_entry();
+  s = RunDatasetBenchmark(graph_def, options, entry);
+  if (!s.ok()) {
+    LOG(ERROR) << "Benchmark failed: " << s;
+    return -1;
+  }
+  LOG(INFO) << entry->name() << ": " << entry->iters() << " elements, "
+            << entry->wall_time() * 1e6 << " us per element, "
+            << entry->throughput() << " MB/s";
+  s = benchmark_report::ReportEntry(*entry);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not report " << entry->name() << ": " << s;
+    return -1;
+  }
+  if (!output_path.empty()) {
+    s = benchmark_report::WriteEntries(output_path, entries);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not write the report: " << s;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace dataset_benchmark
+}  // namespace tensorflow
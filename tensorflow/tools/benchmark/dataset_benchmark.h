@@ -0,0 +1,69 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_DATASET_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_DATASET_BENCHMARK_H_
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/test_log.pb.h"
+
+namespace tensorflow {
+namespace dataset_benchmark {
+
+struct DatasetBenchmarkOptions {
+  // The name of the benchmark entry.
+  string name = "dataset";
+  // The number of threads of the runtime running the pipeline. If 0, uses the
+  // default number of threads.
+  int num_threads = 0;
+  // Overrides the autotuning options of the pipeline. Fields which aren't set
+  // keep the values of the pipeline.
+  data::AutotuneOptions autotune;
+  // The number of elements produced before the timed ones.
+  int64_t warmup_elements = 0;
+  // The number of timed elements. If 0, runs until the end of the input or
+  // for `max_time_s`.
+  int64_t num_elements = 0;
+  // Stops after this many seconds, if positive.
+  double max_time_s = 0.0;
+};
+
+// Overrides the autotuning options of the dataset produced by `graph_def`, a
+// serialized dataset graph like the ones consumed by `standalone::Dataset`, by
+// applying `autotune` on top of it.
+Status OverrideAutotuneOptions(const data::AutotuneOptions& autotune,
+                               GraphDef* graph_def);
+
+// Iterates over the dataset produced by `graph_def` and reports its
+// throughput in `entry`: the time per element, the element bytes per second,
+// the peak memory allocated on the CPU while iterating and, if the pipeline is
+// autotuned, the number of elements, average self processing time, buffered
+// bytes and tuned parameters of each node of the autotuning model.
+Status RunDatasetBenchmark(const GraphDef& graph_def,
+                           const DatasetBenchmarkOptions& options,
+                           BenchmarkEntry* entry);
+
+// Handles all setup and argument parsing.
+int Main(int argc, char** argv);
+
+}  // namespace dataset_benchmark
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_DATASET_BENCHMARK_H_
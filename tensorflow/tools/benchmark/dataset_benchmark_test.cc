@@ -0,0 +1,162 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/dataset_benchmark.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace dataset_benchmark {
+namespace {
+
+// range(10)
+constexpr const char* const kRangeGraphProto = R"pb(
+  node {
+    name: "start"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 0 } }
+    }
+  }
+  node {
+    name: "stop"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 10 } }
+    }
+  }
+  node {
+    name: "step"
+    op: "Const"
+    attr {
+      key: "dtype"
+      value { type: DT_INT64 }
+    }
+    attr {
+      key: "value"
+      value { tensor { dtype: DT_INT64 tensor_shape {} int64_val: 1 } }
+    }
+  }
+  node {
+    name: "RangeDataset"
+    op: "RangeDataset"
+    input: "start"
+    input: "stop"
+    input: "step"
+    attr {
+      key: "output_shapes"
+      value { list { shape {} } }
+    }
+    attr {
+      key: "output_types"
+      value { list { type: DT_INT64 } }
+    }
+  }
+  node {
+    name: "dataset"
+    op: "_Retval"
+    input: "RangeDataset"
+    attr {
+      key: "T"
+      value { type: DT_VARIANT }
+    }
+    attr {
+      key: "index"
+      value { i: 0 }
+    }
+  }
+  library {}
+  versions { producer: 96 }
+)pb";
+
+GraphDef RangeGraph() {
+  GraphDef graph_def;
+  CHECK(protobuf::TextFormat::ParseFromString(kRangeGraphProto, &graph_def));
+  return graph_def;
+}
+
+bool HasModelStats(const BenchmarkEntry& entry) {
+  for (const auto& extra : entry.extras()) {
+    if (absl::EndsWith(extra.first, "/num_elements")) return true;
+  }
+  return false;
+}
+
+TEST(DatasetBenchmarkTest, RunsUntilEndOfInput) {
+  DatasetBenchmarkOptions options;
+  options.name = "range";
+  BenchmarkEntry entry;
+  TF_ASSERT_OK(RunDatasetBenchmark(RangeGraph(), options, &entry));
+  EXPECT_EQ(entry.name(), "range");
+  EXPECT_EQ(entry.iters(), 10);
+  EXPECT_EQ(entry.extras().at("end_of_input").double_value(), 1.0);
+  // Input pipelines are autotuned by default.
+  EXPECT_TRUE(HasModelStats(entry));
+}
+
+TEST(DatasetBenchmarkTest, WarmsUpAndStopsAfterNumElements) {
+  DatasetBenchmarkOptions options;
+  options.warmup_elements = 2;
+  options.num_elements = 4;
+  BenchmarkEntry entry;
+  TF_ASSERT_OK(RunDatasetBenchmark(RangeGraph(), options, &entry));
+  EXPECT_EQ(entry.iters(), 4);
+  EXPECT_EQ(entry.extras().at("warmup_elements").double_value(), 2.0);
+  EXPECT_EQ(entry.extras().at("end_of_input").double_value(), 0.0);
+}
+
+TEST(DatasetBenchmarkTest, OverridesAutotuneOptions) {
+  GraphDef graph_def = RangeGraph();
+  data::AutotuneOptions autotune;
+  autotune.set_enabled(false);
+  TF_ASSERT_OK(OverrideAutotuneOptions(autotune, &graph_def));
+  ASSERT_EQ(graph_def.node_size(), 6);
+  const NodeDef& options_node = graph_def.node(5);
+  EXPECT_EQ(options_node.op(), "OptionsDataset");
+  EXPECT_EQ(options_node.input(0), "RangeDataset");
+  EXPECT_EQ(graph_def.node(4).input(0), options_node.name());
+  // The options can only be overridden once.
+  EXPECT_FALSE(OverrideAutotuneOptions(autotune, &graph_def).ok());
+
+  DatasetBenchmarkOptions options;
+  options.autotune.set_enabled(false);
+  BenchmarkEntry entry;
+  TF_ASSERT_OK(RunDatasetBenchmark(RangeGraph(), options, &entry));
+  EXPECT_EQ(entry.iters(), 10);
+  EXPECT_FALSE(HasModelStats(entry));
+}
+
+TEST(DatasetBenchmarkTest, NoOverrideLeavesGraphUnchanged) {
+  GraphDef graph_def = RangeGraph();
+  TF_ASSERT_OK(OverrideAutotuneOptions(data::AutotuneOptions(), &graph_def));
+  EXPECT_EQ(graph_def.node_size(), 5);
+}
+
+}  // namespace
+}  // namespace dataset_benchmark
+}  // namespace tensorflow
@@ -0,0 +1,449 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to benchmark the kernel of an op on a sweep of input shapes and
+// thread counts, without writing a graph per benchmark.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/op_benchmark.h"
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/tools/benchmark/benchmark_report.h"
+
+namespace tensorflow {
+namespace op_benchmark {
+
+namespace {
+
+using benchmark_report::AddMetric;
+using benchmark_report::SetExtra;
+
+constexpr char kOpNodeName[] = "op";
+constexpr double kDefaultMaxTimeS = 1.0;
+
+// Exposes the node costs, which hold the number of operations of an op
+// rather than its predicted time.
+class OpWorkEstimator : public grappler::OpLevelCostEstimator {
+ public:
+  using OpLevelCostEstimator::PredictNodeCosts;
+};
+
+template <typename T>
+void FillRandomReals(std::mt19937* rng, Tensor* tensor) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  auto flat = tensor->flat<T>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = static_cast<T>(distribution(*rng));
+  }
+}
+
+// Integer inputs are kept small, so that they are valid counts or indices of
+// small dimensions. Inputs needing specific values must be constant inputs.
+template <typename T>
+void FillRandomIntegers(std::mt19937* rng, Tensor* tensor) {
+  std::uniform_int_distribution<int> distribution(0, 15);
+  auto flat = tensor->flat<T>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = static_cast<T>(distribution(*rng));
+  }
+}
+
+Status FillRandom(std::mt19937* rng, Tensor* tensor) {
+  switch (tensor->dtype()) {
+    case DT_FLOAT:
+      FillRandomReals<float>(rng, tensor);
+      break;
+    case DT_DOUBLE:
+      FillRandomReals<double>(rng, tensor);
+      break;
+    case DT_HALF:
+      FillRandomReals<Eigen::half>(rng, tensor);
+      break;
+    case DT_BFLOAT16:
+      FillRandomReals<bfloat16>(rng, tensor);
+      break;
+    case DT_INT8:
+      FillRandomIntegers<int8>(rng, tensor);
+      break;
+    case DT_UINT8:
+      FillRandomIntegers<uint8>(rng, tensor);
+      break;
+    case DT_INT16:
+      FillRandomIntegers<int16>(rng, tensor);
+      break;
+    case DT_INT32:
+      FillRandomIntegers<int32>(rng, tensor);
+      break;
+    case DT_INT64:
+      FillRandomIntegers<int64_t>(rng, tensor);
+      break;
+    case DT_BOOL:
+      FillRandomIntegers<bool>(rng, tensor);
+      break;
+    default:
+      return errors::Unimplemented(
+          "Random inputs of type ", DataTypeString(tensor->dtype()),
+          " are not supported, use a constant input instead");
+  }
+  return OkStatus();
+}
+
+int64_t TensorBytes(const OpInfo::TensorProperties& properties) {
+  const PartialTensorShape shape(properties.shape());
+  if (!shape.IsFullyDefined()) return 0;
+  return shape.num_elements() * DataTypeSize(properties.dtype());
+}
+
+SessionOptions MakeSessionOptions(int num_threads) {
+  SessionOptions options;
+  ConfigProto& config = options.config;
+  if (num_threads > 0) config.set_intra_op_parallelism_threads(num_threads);
+  // The graph runs a single op, so there is no inter-op parallelism.
+  config.set_inter_op_parallelism_threads(1);
+  // The graph must run as built: constant inputs must not be folded into the
+  // op, and the op must not be rewritten.
+  GraphOptions* graph_options = config.mutable_graph_options();
+  graph_options->mutable_optimizer_options()->set_opt_level(
+      OptimizerOptions::L0);
+  graph_options->mutable_rewrite_options()->set_disable_meta_optimizer(true);
+  return options;
+}
+
+// Runs the op on `graph` until the limits of `spec` are reached, and returns
+// the wall time of each run in microseconds.
+Status TimeRuns(const OpBenchmarkSpec& spec, const OpBenchmarkGraph& graph,
+                Session* session, std::vector<int64_t>* run_times_us) {
+  const std::vector<string> targets = {graph.op_node_name};
+  for (int i = 0; i < spec.warmup_runs(); ++i) {
+    TF_RETURN_IF_ERROR(session->Run(graph.feeds, {}, targets, nullptr));
+  }
+  double max_time_s = spec.max_time_s();
+  if (max_time_s <= 0.0 && spec.num_runs() <= 0) max_time_s = kDefaultMaxTimeS;
+  int64_t total_time_us = 0;
+  for (int i = 0; spec.num_runs() <= 0 || i < spec.num_runs(); ++i) {
+    const int64_t start_time = Env::Default()->NowMicros();
+    TF_RETURN_IF_ERROR(session->Run(graph.feeds, {}, targets, nullptr));
+    const int64_t run_time = Env::Default()->NowMicros() - start_time;
+    run_times_us->push_back(run_time);
+    total_time_us += run_time;
+    if (max_time_s > 0.0 && total_time_us / 1000000.0 > max_time_s) break;
+  }
+  return OkStatus();
+}
+
+BenchmarkEntry MakeEntry(const OpBenchmarkSpec& spec,
+                         const OpBenchmarkGraph& graph, int num_threads,
+                         const OpWork& work,
+                         std::vector<int64_t> run_times_us) {
+  BenchmarkEntry entry;
+  const string threads =
+      num_threads > 0 ? absl::StrCat(num_threads) : string("auto");
+  entry.set_name(
+      absl::StrCat(spec.op(), "/", graph.case_name, "/threads:", threads));
+  const int64_t iters = run_times_us.size();
+  int64_t total_time_us = 0;
+  for (int64_t run_time : run_times_us) total_time_us += run_time;
+  const double wall_time_s =
+      iters > 0 ? total_time_us / 1000000.0 / iters : 0.0;
+  entry.set_iters(iters);
+  entry.set_wall_time(wall_time_s);
+  if (wall_time_s > 0.0) {
+    entry.set_throughput(work.bytes_accessed / wall_time_s / 1e6);
+  }
+
+  SetExtra("op", spec.op(), &entry);
+  SetExtra("shape_case", graph.case_name, &entry);
+  SetExtra("num_threads", num_threads, &entry);
+  SetExtra("flops", work.flops, &entry);
+  SetExtra("bytes_accessed", work.bytes_accessed, &entry);
+  if (iters > 0) {
+    std::sort(run_times_us.begin(), run_times_us.end());
+    SetExtra("min_time_us", run_times_us.front(), &entry);
+    SetExtra("median_time_us", run_times_us[iters / 2], &entry);
+    SetExtra("max_time_us", run_times_us.back(), &entry);
+  }
+  if (wall_time_s > 0.0) {
+    AddMetric("gbytes_per_sec", work.bytes_accessed / wall_time_s / 1e9,
+              &entry);
+    if (work.flops > 0) {
+      AddMetric("gflops_per_sec", work.flops / wall_time_s / 1e9, &entry);
+    }
+  }
+  return entry;
+}
+
+Status ReadSuite(const string& path, OpBenchmarkSuite* suite) {
+  if (ReadTextProto(Env::Default(), path, suite).ok()) return OkStatus();
+  // A single benchmark is accepted as well.
+  OpBenchmarkSpec spec;
+  Status s = ReadTextProto(Env::Default(), path, &spec);
+  if (!s.ok()) {
+    return errors::InvalidArgument(
+        "Could not parse ", path,
+        " as an OpBenchmarkSuite or an OpBenchmarkSpec text proto: ", s);
+  }
+  *suite->add_benchmark() = std::move(spec);
+  return OkStatus();
+}
+
+}  // namespace
+
+Status BuildOpBenchmarkGraph(const OpBenchmarkSpec& spec,
+                             const OpBenchmarkShapeCase& shape_case,
+                             OpBenchmarkGraph* graph) {
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(spec.op(), &op_def));
+  NodeDef op_node;
+  op_node.set_name(kOpNodeName);
+  op_node.set_op(spec.op());
+  for (const auto& attr : spec.attr()) {
+    (*op_node.mutable_attr())[attr.first] = attr.second;
+  }
+  AddDefaultsToNodeDef(*op_def, &op_node);
+  DataTypeVector input_types;
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(
+      InOutTypesForNode(op_node, *op_def, &input_types, &output_types));
+
+  graph->graph_def.Clear();
+  graph->feeds.clear();
+  graph->fetches.clear();
+  graph->op_info.Clear();
+  graph->op_node_name = kOpNodeName;
+  graph->op_info.set_op(spec.op());
+  *graph->op_info.mutable_attr() = op_node.attr();
+  graph->op_info.mutable_device()->set_type("CPU");
+
+  // The inputs are random, but the same for every run of the tool.
+  std::mt19937 rng(0);
+  std::vector<string> shape_names;
+  for (int i = 0; i < input_types.size(); ++i) {
+    const string input_name = absl::StrCat("input_", i);
+    const DataType dtype = BaseType(input_types[i]);
+    NodeDef* input_node = graph->graph_def.add_node();
+    input_node->set_name(input_name);
+    AddNodeAttr("dtype", dtype, input_node);
+    OpInfo::TensorProperties* properties = graph->op_info.add_inputs();
+    properties->set_dtype(dtype);
+
+    Tensor value;
+    auto constant = shape_case.constant_input().find(i);
+    if (constant != shape_case.constant_input().end()) {
+      if (!value.FromProto(constant->second)) {
+        return errors::InvalidArgument("Invalid constant for input ", i,
+                                       " of ", spec.op());
+      }
+      if (value.dtype() != dtype) {
+        return errors::InvalidArgument(
+            "Constant input ", i, " of ", spec.op(), " has type ",
+            DataTypeString(value.dtype()), " instead of ",
+            DataTypeString(dtype));
+      }
+      input_node->set_op("Const");
+      AddNodeAttr("value", value, input_node);
+      *properties->mutable_value() = constant->second;
+    } else {
+      if (i >= shape_case.input_shape_size()) {
+        return errors::InvalidArgument("Missing the shape of input ", i,
+                                       " of ", spec.op(), ", which has ",
+                                       input_types.size(), " inputs");
+      }
+      TensorShape shape;
+      TF_RETURN_IF_ERROR(
+          TensorShape::BuildTensorShape(shape_case.input_shape(i), &shape));
+      value = Tensor(dtype, shape);
+      TF_RETURN_IF_ERROR(FillRandom(&rng, &value));
+      input_node->set_op("Placeholder");
+      AddNodeAttr("shape", shape, input_node);
+      graph->feeds.emplace_back(input_name, value);
+    }
+    value.shape().AsProto(properties->mutable_shape());
+    shape_names.push_back(value.shape().DebugString());
+    op_node.add_input(input_name);
+  }
+  if (shape_case.input_shape_size() > input_types.size()) {
+    return errors::InvalidArgument(shape_case.input_shape_size(),
+                                   " input shapes given for ", spec.op(),
+                                   ", which has ", input_types.size(),
+                                   " inputs");
+  }
+  for (int i = 0; i < output_types.size(); ++i) {
+    graph->fetches.push_back(absl::StrCat(kOpNodeName, ":", i));
+  }
+  *graph->graph_def.add_node() = std::move(op_node);
+  graph->case_name = shape_case.name().empty() ? absl::StrJoin(shape_names, "x")
+                                               : shape_case.name();
+  return OkStatus();
+}
+
+Status EstimateOpWork(const OpInfo& op_info, OpWork* work) {
+  OpWorkEstimator estimator;
+  grappler::OpContext op_context;
+  op_context.name = kOpNodeName;
+  op_context.op_info = op_info;
+  grappler::NodeCosts node_costs;
+  TF_RETURN_IF_ERROR(estimator.PredictNodeCosts(op_context, &node_costs));
+  // Unknown ops are costed as moving their inputs and outputs, which says
+  // nothing about their arithmetic.
+  work->flops = node_costs.num_nodes_with_unknown_op_type > 0
+                    ? 0
+                    : node_costs.num_compute_ops;
+  work->bytes_accessed = 0;
+  for (const auto& input : op_info.inputs()) {
+    work->bytes_accessed += TensorBytes(input);
+  }
+  for (const auto& output : op_info.outputs()) {
+    work->bytes_accessed += TensorBytes(output);
+  }
+  return OkStatus();
+}
+
+Status RunOpBenchmark(const OpBenchmarkSpec& spec, BenchmarkEntries* entries) {
+  std::vector<int> thread_counts(spec.num_threads().begin(),
+                                 spec.num_threads().end());
+  if (thread_counts.empty()) thread_counts.push_back(0);
+
+  for (const OpBenchmarkShapeCase& shape_case : spec.shape_case()) {
+    OpBenchmarkGraph graph;
+    TF_RETURN_IF_ERROR(BuildOpBenchmarkGraph(spec, shape_case, &graph));
+    OpWork work;
+    bool has_work = false;
+    for (int num_threads : thread_counts) {
+      std::unique_ptr<Session> session(
+          NewSession(MakeSessionOptions(num_threads)));
+      if (session == nullptr) {
+        return errors::Internal("Could not create a session");
+      }
+      TF_RETURN_IF_ERROR(session->Create(graph.graph_def));
+
+      // The first run validates the outputs and gets their shapes.
+      std::vector<Tensor> outputs;
+      TF_RETURN_IF_ERROR(
+          session->Run(graph.feeds, graph.fetches, {}, &outputs));
+      if (!has_work) {
+        for (const Tensor& output : outputs) {
+          OpInfo::TensorProperties* properties =
+              graph.op_info.add_outputs();
+          properties->set_dtype(output.dtype());
+          output.shape().AsProto(properties->mutable_shape());
+        }
+        TF_RETURN_IF_ERROR(EstimateOpWork(graph.op_info, &work));
+        has_work = true;
+      }
+
+      std::vector<int64_t> run_times_us;
+      TF_RETURN_IF_ERROR(TimeRuns(spec, graph, session.get(), &run_times_us));
+      TF_RETURN_IF_ERROR(session->Close());
+      *entries->add_entry() =
+          MakeEntry(spec, graph, num_threads, work, std::move(run_times_us));
+      const BenchmarkEntry& entry = entries->entry(entries->entry_size() - 1);
+      LOG(INFO) << entry.name() << ": " << entry.iters() << " runs, "
+                << entry.wall_time() * 1e6 << " us per run, "
+                << entry.throughput() << " MB/s";
+    }
+  }
+  return OkStatus();
+}
+
+Status RunOpBenchmarkSuite(const OpBenchmarkSuite& suite,
+                           BenchmarkEntries* entries) {
+  for (const OpBenchmarkSpec& spec : suite.benchmark()) {
+    TF_RETURN_IF_ERROR(RunOpBenchmark(spec, entries));
+  }
+  return OkStatus();
+}
+
+int Main(int argc, char** argv) {
+  string spec_path = "";
+  string output_path = "";
+
+  std::vector<Flag> flag_list = {
+      Flag("spec", &spec_path,
+           "text proto file with an OpBenchmarkSuite or an OpBenchmarkSpec"),
+      Flag("output", &output_path,
+           "file to write the BenchmarkEntries report to, as JSON if the "
+           "name ends with .json and as a text proto otherwise"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+
+  // We need to call this to set up global state for TensorFlow.
+  port::InitMain(argv[0], &argc, &argv);
+
+  if (!parse_result || spec_path.empty()) {
+    LOG(ERROR) << "\n" << usage;
+    return -1;
+  }
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  OpBenchmarkSuite suite;
+  Status s = ReadSuite(spec_path, &suite);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return -1;
+  }
+  BenchmarkEntries entries;
+  s = RunOpBenchmarkSuite(suite, &entries);
+  if (!s.ok()) {
+    LOG(ERROR) << "Benchmark failed: " << s;
+    return -1;
+  }
+  for (const BenchmarkEntry& entry : entries.entry()) {
+    s = benchmark_report::ReportEntry(entry);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not report " << entry.name() << ": " << s;
+      return -1;
+    }
+  }
+  if (!output_path.empty()) {
+    s = benchmark_report::WriteEntries(output_path, entries);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not write the report: " << s;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace op_benchmark
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_OP_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_OP_BENCHMARK_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/test_log.pb.h"
+#include "tensorflow/tools/benchmark/op_benchmark.pb.h"
+
+namespace tensorflow {
+namespace op_benchmark {
+
+// A graph running a single op on fed inputs.
+struct OpBenchmarkGraph {
+  GraphDef graph_def;
+  // The fed inputs of the op, with random values.
+  std::vector<std::pair<string, Tensor>> feeds;
+  // The name of the op node, which is the target of the benchmark runs.
+  string op_node_name;
+  // The names of the outputs of the op.
+  std::vector<string> fetches;
+  // The op and its inputs, for cost estimation. Output properties are filled
+  // in after a first run of the graph.
+  OpInfo op_info;
+  // The name of the shape case in the report.
+  string case_name;
+};
+
+// Builds the graph benchmarking `spec.op()` on the inputs of `shape_case`.
+Status BuildOpBenchmarkGraph(const OpBenchmarkSpec& spec,
+                             const OpBenchmarkShapeCase& shape_case,
+                             OpBenchmarkGraph* graph);
+
+// The work of one run of an op. The number of floating point operations comes
+// from the grappler cost model and is 0 for ops it doesn't model, while the
+// bytes are the sizes of the inputs and outputs of the op.
+struct OpWork {
+  int64_t flops = 0;
+  int64_t bytes_accessed = 0;
+};
+
+// Estimates the work of the op described by `op_info`, including outputs.
+Status EstimateOpWork(const OpInfo& op_info, OpWork* work);
+
+// Runs `spec` on each of its shape cases and thread counts, and appends one
+// entry per run configuration to `entries`. The per-iteration wall time of an
+// entry includes the session overhead of a run, which is significant for
+// small shapes.
+Status RunOpBenchmark(const OpBenchmarkSpec& spec, BenchmarkEntries* entries);
+
+// Runs all the benchmarks of `suite`.
+Status RunOpBenchmarkSuite(const OpBenchmarkSuite& suite,
+                           BenchmarkEntries* entries);
+
+// Handles all setup and argument parsing.
+int Main(int argc, char** argv);
+
+}  // namespace op_benchmark
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_OP_BENCHMARK_H_
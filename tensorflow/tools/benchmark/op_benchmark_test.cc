@@ -0,0 +1,143 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/op_benchmark.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace op_benchmark {
+namespace {
+
+OpBenchmarkSpec ParseSpec(const string& text) {
+  OpBenchmarkSpec spec;
+  CHECK(protobuf::TextFormat::ParseFromString(text, &spec));
+  return spec;
+}
+
+const char kMatMulSpec[] = R"pb(
+  op: "MatMul"
+  attr {
+    key: "T"
+    value { type: DT_FLOAT }
+  }
+  shape_case {
+    input_shape { dim { size: 8 } dim { size: 16 } }
+    input_shape { dim { size: 16 } dim { size: 32 } }
+  }
+  shape_case {
+    name: "square"
+    input_shape { dim { size: 64 } dim { size: 64 } }
+    input_shape { dim { size: 64 } dim { size: 64 } }
+  }
+  num_threads: 1
+  num_threads: 2
+  num_runs: 3
+)pb";
+
+TEST(OpBenchmarkTest, BuildsGraphOfTheOp) {
+  const OpBenchmarkSpec spec = ParseSpec(kMatMulSpec);
+  OpBenchmarkGraph graph;
+  TF_ASSERT_OK(BuildOpBenchmarkGraph(spec, spec.shape_case(0), &graph));
+
+  ASSERT_EQ(graph.graph_def.node_size(), 3);
+  EXPECT_EQ(graph.graph_def.node(0).op(), "Placeholder");
+  EXPECT_EQ(graph.graph_def.node(1).op(), "Placeholder");
+  const NodeDef& op_node = graph.graph_def.node(2);
+  EXPECT_EQ(op_node.op(), "MatMul");
+  ASSERT_EQ(op_node.input_size(), 2);
+  // Default attributes are filled in.
+  EXPECT_FALSE(op_node.attr().at("transpose_a").b());
+  ASSERT_EQ(graph.feeds.size(), 2);
+  EXPECT_EQ(graph.feeds[0].second.shape(), TensorShape({8, 16}));
+  EXPECT_EQ(graph.feeds[1].second.shape(), TensorShape({16, 32}));
+  EXPECT_EQ(graph.fetches, std::vector<string>({"op:0"}));
+  EXPECT_EQ(graph.case_name, "[8,16]x[16,32]");
+  EXPECT_EQ(graph.op_info.inputs_size(), 2);
+}
+
+TEST(OpBenchmarkTest, ConstantInputsAreNotFed) {
+  const OpBenchmarkSpec spec = ParseSpec(R"pb(
+    op: "Sum"
+    attr {
+      key: "T"
+      value { type: DT_FLOAT }
+    }
+    shape_case {
+      input_shape { dim { size: 4 } dim { size: 8 } }
+      constant_input {
+        key: 1
+        value {
+          dtype: DT_INT32
+          tensor_shape { dim { size: 1 } }
+          int_val: 1
+        }
+      }
+    }
+  )pb");
+  OpBenchmarkGraph graph;
+  TF_ASSERT_OK(BuildOpBenchmarkGraph(spec, spec.shape_case(0), &graph));
+  ASSERT_EQ(graph.graph_def.node_size(), 3);
+  EXPECT_EQ(graph.graph_def.node(1).op(), "Const");
+  EXPECT_EQ(graph.feeds.size(), 1);
+  EXPECT_EQ(graph.case_name, "[4,8]x[1]");
+  EXPECT_TRUE(graph.op_info.inputs(1).has_value());
+}
+
+TEST(OpBenchmarkTest, MissingInputShapeIsAnError) {
+  OpBenchmarkSpec spec = ParseSpec(kMatMulSpec);
+  spec.mutable_shape_case(0)->mutable_input_shape()->RemoveLast();
+  OpBenchmarkGraph graph;
+  EXPECT_FALSE(BuildOpBenchmarkGraph(spec, spec.shape_case(0), &graph).ok());
+}
+
+TEST(OpBenchmarkTest, EstimatesMatMulWork) {
+  const OpBenchmarkSpec spec = ParseSpec(kMatMulSpec);
+  OpBenchmarkGraph graph;
+  TF_ASSERT_OK(BuildOpBenchmarkGraph(spec, spec.shape_case(0), &graph));
+  OpInfo::TensorProperties* output = graph.op_info.add_outputs();
+  output->set_dtype(DT_FLOAT);
+  TensorShape({8, 32}).AsProto(output->mutable_shape());
+
+  OpWork work;
+  TF_ASSERT_OK(EstimateOpWork(graph.op_info, &work));
+  EXPECT_EQ(work.flops, 2 * 8 * 16 * 32);
+  EXPECT_EQ(work.bytes_accessed, (8 * 16 + 16 * 32 + 8 * 32) * sizeof(float));
+}
+
+TEST(OpBenchmarkTest, ReportsEachShapeCaseAndThreadCount) {
+  const OpBenchmarkSpec spec = ParseSpec(kMatMulSpec);
+  BenchmarkEntries entries;
+  TF_ASSERT_OK(RunOpBenchmark(spec, &entries));
+
+  ASSERT_EQ(entries.entry_size(), 4);
+  EXPECT_EQ(entries.entry(0).name(), "MatMul/[8,16]x[16,32]/threads:1");
+  EXPECT_EQ(entries.entry(1).name(), "MatMul/[8,16]x[16,32]/threads:2");
+  EXPECT_EQ(entries.entry(2).name(), "MatMul/square/threads:1");
+  EXPECT_EQ(entries.entry(3).name(), "MatMul/square/threads:2");
+  for (const BenchmarkEntry& entry : entries.entry()) {
+    EXPECT_EQ(entry.iters(), 3);
+    EXPECT_EQ(entry.extras().at("flops").double_value(),
+              entry.name().find("square") != string::npos ? 2 * 64 * 64 * 64
+                                                           : 2 * 8 * 16 * 32);
+    EXPECT_GT(entry.extras().at("bytes_accessed").double_value(), 0);
+  }
+}
+
+}  // namespace
+}  // namespace op_benchmark
+}  // namespace tensorflow
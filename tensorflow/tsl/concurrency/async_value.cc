@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/tsl/concurrency/async_value.h"
 
 #include <atomic>
+#include <cstddef>
 #include <cstdlib>
 #include <functional>
+#include <new>
 #include <utility>
 #include <vector>
 
@@ -63,6 +65,114 @@ void AlignedFree(void* ptr) {
 #endif
 }
 
+namespace {
+
+// A per-thread cache of the blocks of freed async values, by power of two
+// size classes from `kMinSize` to `kMaxCachedAsyncValueSize` bytes. A block
+// of a size class is aligned to its size, so that it fits any value of that
+// size whatever the alignment of its type.
+//
+// A value freed on another thread than the one that allocated it goes to the
+// cache of the thread that frees it.
+class AsyncValueCache {
+ public:
+  static constexpr size_t kMinSize = 32;
+  static constexpr int kNumSizeClasses = 4;
+  static_assert(kMinSize << (kNumSizeClasses - 1) == kMaxCachedAsyncValueSize);
+
+  // The maximum number of free blocks kept for each size class.
+  static constexpr int kMaxBlocksPerSizeClass = 256;
+
+  AsyncValueCache() = default;
+  AsyncValueCache(const AsyncValueCache&) = delete;
+  AsyncValueCache& operator=(const AsyncValueCache&) = delete;
+
+  ~AsyncValueCache() {
+    destroyed_ = true;
+    for (FreeBlock* block : free_blocks_) {
+      while (block != nullptr) {
+        FreeBlock* next = block->next;
+        AlignedFree(block);
+        block = next;
+      }
+    }
+  }
+
+  // Returns the cache of the calling thread, or nullptr if the thread is
+  // exiting and its cache was already destroyed.
+  static AsyncValueCache* Get() {
+    if (destroyed_) return nullptr;
+    static thread_local AsyncValueCache cache;
+    return &cache;
+  }
+
+  static int SizeClass(size_t size) {
+    int size_class = 0;
+    for (size_t class_size = kMinSize; class_size < size; class_size <<= 1) {
+      ++size_class;
+    }
+    return size_class;
+  }
+
+  void* Allocate(int size_class) {
+    FreeBlock* block = free_blocks_[size_class];
+    if (block == nullptr) {
+      const size_t class_size = kMinSize << size_class;
+      return AlignedAlloc(class_size, class_size);
+    }
+    free_blocks_[size_class] = block->next;
+    --num_free_blocks_[size_class];
+    return block;
+  }
+
+  void Free(void* ptr, int size_class) {
+    if (num_free_blocks_[size_class] >= kMaxBlocksPerSizeClass) {
+      AlignedFree(ptr);
+      return;
+    }
+    free_blocks_[size_class] = new (ptr) FreeBlock{free_blocks_[size_class]};
+    ++num_free_blocks_[size_class];
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Trivially destructible, so that it can still be read after the cache is
+  // destroyed, e.g. by async values dropped by other thread local objects.
+  static thread_local bool destroyed_;
+
+  FreeBlock* free_blocks_[kNumSizeClasses] = {};
+  int num_free_blocks_[kNumSizeClasses] = {};
+};
+
+thread_local bool AsyncValueCache::destroyed_ = false;
+
+}  // namespace
+
+void* AllocateAsyncValue(size_t alignment, size_t size) {
+  if (size <= kMaxCachedAsyncValueSize) {
+    const int size_class = AsyncValueCache::SizeClass(size);
+    if (AsyncValueCache* cache = AsyncValueCache::Get()) {
+      return cache->Allocate(size_class);
+    }
+    const size_t class_size = AsyncValueCache::kMinSize << size_class;
+    return AlignedAlloc(class_size, class_size);
+  }
+  return AlignedAlloc(alignment, size);
+}
+
+void FreeAsyncValue(void* ptr, size_t size) {
+  if (size <= kMaxCachedAsyncValueSize) {
+    if (AsyncValueCache* cache = AsyncValueCache::Get()) {
+      cache->Free(ptr, AsyncValueCache::SizeClass(size));
+      return;
+    }
+  }
+  AlignedFree(ptr);
+}
+
 }  // namespace internal
 
 // This is a singly linked list of nodes waiting for notification, hanging off
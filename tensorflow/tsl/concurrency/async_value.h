@@ -50,6 +50,15 @@ constexpr bool kMaybeBase = std::is_class<T>::value && !std::is_final<T>::value;
 void* AlignedAlloc(size_t alignment, size_t size);
 void AlignedFree(void* ptr);
 
+// Allocates the memory of a reference-counted async value. Values of up to
+// `kMaxCachedAsyncValueSize` bytes are allocated from a per-thread cache of
+// recently freed blocks, to avoid going to the heap for every value on hot
+// paths. The memory must be freed with `FreeAsyncValue` and the same `size`,
+// on any thread.
+inline constexpr size_t kMaxCachedAsyncValueSize = 256;
+void* AllocateAsyncValue(size_t alignment, size_t size);
+void FreeAsyncValue(void* ptr, size_t size);
+
 }  // namespace internal
 
 // This is a future of the specified value type. Arbitrary C++ types may be used
@@ -968,12 +977,14 @@ inline void AsyncValue::Destroy() {
     // explicit check and instead make ~IndirectAsyncValue go through the
     // GetTypeInfo().destructor case below.
     static_cast<IndirectAsyncValue*>(this)->~IndirectAsyncValue();
-    if (was_ref_counted) internal::AlignedFree(this);
+    if (was_ref_counted) {
+      internal::FreeAsyncValue(this, sizeof(IndirectAsyncValue));
+    }
     return;
   }
 
-  GetTypeInfo().destructor(this);
-  if (was_ref_counted) internal::AlignedFree(this);
+  size_t size = GetTypeInfo().destructor(this);
+  if (was_ref_counted) internal::FreeAsyncValue(this, size);
 }
 
 }  // namespace tsl
@@ -24,6 +24,12 @@ RCReference<IndirectAsyncValue> MakeIndirectAsyncValue() {
   return TakeRef(internal::AllocateAndConstruct<IndirectAsyncValue>());
 }
 
+AsyncValueRef<Chain> GetReadyChain() {
+  static auto* const ready_chain =
+      new AsyncValueRef<Chain>(MakeAvailableAsyncValueRef<Chain>());
+  return ready_chain->CopyRef();
+}
+
 RCReference<ErrorAsyncValue> MakeErrorAsyncValueRef(absl::Status status) {
   auto* error_value =
       internal::AllocateAndConstruct<ErrorAsyncValue>(std::move(status));
@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "tensorflow/tsl/concurrency/async_value.h"
+#include "tensorflow/tsl/concurrency/chain.h"
 #include "tensorflow/tsl/concurrency/ref_count.h"
 
 namespace tsl {
@@ -307,6 +308,10 @@ RCReference<ErrorAsyncValue> MakeErrorAsyncValueRef(std::string_view message);
 // Construct an empty IndirectAsyncValue, not forwarding to anything.
 RCReference<IndirectAsyncValue> MakeIndirectAsyncValue();
 
+// Returns a reference to an available Chain shared by the whole process, to
+// signal a completion that is already done without allocating an async value.
+AsyncValueRef<Chain> GetReadyChain();
+
 //===----------------------------------------------------------------------===//
 
 namespace internal {
@@ -318,8 +323,7 @@ T* PlacementConstruct(void* buf, Args&&... args) {
 
 template <typename T, typename... Args>
 T* AllocateAndConstruct(Args&&... args) {
-  // TODO(ezhulenev): `port::AlignedMalloc` has a different order of arguments!
-  void* buf = internal::AlignedAlloc(alignof(T), sizeof(T));
+  void* buf = internal::AllocateAsyncValue(alignof(T), sizeof(T));
   return PlacementConstruct<T, Args...>(buf, std::forward<Args>(args)...);
 }
 
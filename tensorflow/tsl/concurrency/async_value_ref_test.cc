@@ -187,4 +187,10 @@ TEST(AsyncValueRefTest, Nullptr) {
   EXPECT_FALSE(av_int2);
 }
 
+TEST(AsyncValueRefTest, GetReadyChain) {
+  AsyncValueRef<Chain> chain = GetReadyChain();
+  EXPECT_TRUE(chain.IsConcrete());
+  EXPECT_EQ(chain.GetAsyncValue(), GetReadyChain().GetAsyncValue());
+}
+
 }  // namespace tsl
@@ -179,4 +179,24 @@ TEST(AsyncValueTest, StackAllocatedAsyncValue) {
   EXPECT_EQ(2, counter);
 }
 
+TEST(AsyncValueTest, ReusesMemoryOfFreedValues) {
+  AsyncValue* value = MakeAvailableAsyncValueRef<int32_t>(1).release();
+  AsyncValue* freed_value = value;
+  value->DropRef();
+
+  // A value of the same size class reuses the block cached by this thread.
+  value = MakeAvailableAsyncValueRef<int64_t>(2).release();
+  EXPECT_EQ(freed_value, value);
+  EXPECT_EQ(2, value->get<int64_t>());
+  value->DropRef();
+}
+
+TEST(AsyncValueTest, LargeValuesAreNotCached) {
+  struct Large {
+    char data[2 * internal::kMaxCachedAsyncValueSize];
+  };
+  AsyncValueRef<Large> value = MakeAvailableAsyncValueRef<Large>();
+  EXPECT_TRUE(value.IsConcrete());
+}
+
 }  // namespace tsl
@@ -94,6 +94,16 @@ struct CoordinatedTaskEqual {
   }
 };
 
+// Returns a fingerprint of the tasks that does not depend on their order,
+// which lets a barrier check the tasks passed by each caller in constant time.
+uint64_t FingerprintTasks(const std::vector<CoordinatedTask>& tasks) {
+  uint64_t fingerprint = 0;
+  for (const auto& task : tasks) {
+    fingerprint += CoordinatedTaskHash()(task);
+  }
+  return fingerprint;
+}
+
 // Standalone implementation of the coordination service.
 class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
  public:
@@ -163,17 +173,18 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
     absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
                         CoordinatedTaskEqual>
         tasks_at_barrier;
+    // `FingerprintTasks` of the keys of `tasks_at_barrier`.
+    uint64_t tasks_fingerprint = 0;
     std::vector<StatusCallback> done_callbacks;
   };
   void PassBarrier(absl::string_view barrier_id, Status result,
                    BarrierState* barrier)
       TF_EXCLUSIVE_LOCKS_REQUIRED(state_mu_);
   // Check if participating tasks are specified correctly across barrier calls.
-  bool ValidateTaskArgs(
-      const std::vector<CoordinatedTask>& tasks_args,
-      const absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
-                                CoordinatedTaskEqual>& tasks_at_barrier,
-      int64_t cluster_size);
+  // `tasks_args_fingerprint` is `FingerprintTasks(tasks_args)`.
+  bool ValidateTaskArgs(const std::vector<CoordinatedTask>& tasks_args,
+                        uint64_t tasks_args_fingerprint,
+                        const BarrierState& barrier, int64_t cluster_size);
   bool isRecoverableJob(const absl::string_view task_name) const;
 
   class TaskState {
@@ -216,6 +227,9 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
 
     CoordinatedTaskState state_ = CoordinatedTaskState::TASKSTATE_DISCONNECTED;
     Status status_;
+    // Unlike the rest of the task state, which is guarded by `state_mu_`, the
+    // last heartbeat time has its own lock so that heartbeats can be recorded
+    // under a shared `state_mu_`.
     mutex last_heartbeat_mu_;
     uint64_t last_heartbeat_us_ TF_GUARDED_BY(last_heartbeat_mu_);
     // This denotes the deadline after which we stop accepting heartbeats from a
@@ -384,10 +398,10 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
               return;
             }
           }
-          // Heartbeat check.
-          Status status = OkStatus();
+          // Heartbeat check. Stale tasks are looked for under a shared lock,
+          // so that the scan over all tasks does not block heartbeats.
           {
-            mutex_lock l(state_mu_);
+            tf_shared_lock l(state_mu_);
             for (const auto& [task_name, task_state] : cluster_state_) {
               // Skip tasks that are not registered or in error state
               if (task_state->GetState() !=
@@ -400,14 +414,32 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
                        << " stale?=" << is_stale;
               if (is_stale) {
                 stale_task_names.push_back(task_name);
-                status = MakeCoordinationError(errors::Unavailable(
-                    "Task ", task_name,
-                    " heartbeat timeout. This indicates that the remote task "
-                    "has failed, got preempted, or crashed unexpectedly."));
-                SetTaskError(task_name, status);
               }
             }
           }
+          if (!stale_task_names.empty()) {
+            mutex_lock l(state_mu_);
+            // Tasks may have sent a heartbeat or changed state since the scan
+            // above, so check them again before setting the error.
+            int num_stale_tasks = 0;
+            for (absl::string_view task_name : stale_task_names) {
+              auto it = cluster_state_.find(task_name);
+              if (it == cluster_state_.end() ||
+                  it->second->GetState() !=
+                      CoordinatedTaskState::TASKSTATE_CONNECTED ||
+                  it->second->TimeSinceLastHeartbeatMs() <=
+                      heartbeat_timeout_ms_) {
+                continue;
+              }
+              const Status status = MakeCoordinationError(errors::Unavailable(
+                  "Task ", task_name,
+                  " heartbeat timeout. This indicates that the remote task "
+                  "has failed, got preempted, or crashed unexpectedly."));
+              SetTaskError(task_name, status);
+              stale_task_names[num_stale_tasks++] = task_name;
+            }
+            stale_task_names.resize(num_stale_tasks);
+          }
           // Propagate heartbeat timeout errors to other connected tasks.
           if (!stale_task_names.empty()) {
             if (!has_service_to_client_connection) {
@@ -712,26 +744,29 @@ Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   const std::string& task_name = GetTaskName(task);
   Status s = OkStatus();
   {
-    mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
+    // Heartbeats only update the heartbeat time of the task, which has its own
+    // lock, so heartbeats from different tasks are processed concurrently.
+    tf_shared_lock l(state_mu_);
+    auto it = cluster_state_.find(task_name);
+    if (it == cluster_state_.end()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Unexpected task request with task_name=", task_name));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
+    TaskState* task_state = it->second.get();
+    if (!task_state->GetStatus().ok()) {
+      return task_state->GetStatus();
+    } else if (task_state->GetState() ==
                    CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages"));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
@@ -993,6 +1028,8 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
     StatusCallback done) {
   VLOG(3) << "Task " << GetTaskName(task) << "invoked BarrierAsync("
           << barrier_id << ").";
+  const uint64_t participating_tasks_fingerprint =
+      FingerprintTasks(participating_tasks);
   mutex_lock l(state_mu_);
   auto pair = barriers_.try_emplace(barrier_id);
   auto it = pair.first;
@@ -1027,6 +1064,9 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
       }
     }
     barrier->num_pending_tasks = barrier->tasks_at_barrier.size();
+    for (const auto& pending_task : barrier->tasks_at_barrier) {
+      barrier->tasks_fingerprint += CoordinatedTaskHash()(pending_task.first);
+    }
 
     // Fail the barrier immediately if any tasks are already in error.
     for (const auto& pending_task : barrier->tasks_at_barrier) {
@@ -1091,8 +1131,8 @@ void CoordinationServiceStandaloneImpl::BarrierAsync(
   }
 
   // Check if task args are specified consistently across barrier calls.
-  if (!ValidateTaskArgs(participating_tasks, barrier->tasks_at_barrier,
-                        cluster_state_.size())) {
+  if (!ValidateTaskArgs(participating_tasks, participating_tasks_fingerprint,
+                        *barrier, cluster_state_.size())) {
     Status error = MakeCoordinationError(errors::InvalidArgument(absl::StrCat(
         "Conflicting tasks specified for the same barrier: ", barrier_id)));
     PassBarrier(barrier_id, error, barrier);
@@ -1195,23 +1235,16 @@ void CoordinationServiceStandaloneImpl::PassBarrier(
 }
 
 bool CoordinationServiceStandaloneImpl::ValidateTaskArgs(
-
     const std::vector<CoordinatedTask>& tasks_args,
-    const absl::flat_hash_map<CoordinatedTask, bool, CoordinatedTaskHash,
-                              CoordinatedTaskEqual>& tasks_at_barrier,
+    uint64_t tasks_args_fingerprint, const BarrierState& barrier,
     int64_t cluster_size) {
   if (tasks_args.empty()) {
-    return tasks_at_barrier.size() == cluster_size;
-  } else if (tasks_at_barrier.size() != tasks_args.size()) {
-    return false;
-  } else {
-    for (const auto& task : tasks_args) {
-      if (!tasks_at_barrier.contains(task)) {
-        return false;
-      }
-    }
+    return barrier.tasks_at_barrier.size() == cluster_size;
   }
-  return true;
+  // Comparing fingerprints instead of looking up every task keeps the cost of
+  // each barrier call independent of the number of participating tasks.
+  return barrier.tasks_at_barrier.size() == tasks_args.size() &&
+         barrier.tasks_fingerprint == tasks_args_fingerprint;
 }
 
 void CoordinationServiceStandaloneImpl::AggregateClusterDevices() {
@@ -910,6 +910,32 @@ TEST_F(CoordinationBarrierTest, BarrierWithSubsetOfTasks) {
   TF_EXPECT_OK(barrier_status_1);
 }
 
+TEST_F(CoordinationBarrierTest, BarrierWithTasksInDifferentOrder) {
+  const std::string barrier_id = "barrier_id";
+  absl::Duration timeout = absl::Seconds(5);
+  Status barrier_status_0;
+  Status barrier_status_1;
+  Status barrier_status_2;
+
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(0),
+      /*participating_tasks=*/{GetTask(0), GetTask(1), GetTask(2)},
+      [&barrier_status_0](Status s) { barrier_status_0 = s; });
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(1),
+      /*participating_tasks=*/{GetTask(2), GetTask(0), GetTask(1)},
+      [&barrier_status_1](Status s) { barrier_status_1 = s; });
+  // Listing every task is the same as listing none.
+  GetCoordinationService()->BarrierAsync(
+      barrier_id, timeout, GetTask(2),
+      /*participating_tasks=*/{},
+      [&barrier_status_2](Status s) { barrier_status_2 = s; });
+
+  TF_EXPECT_OK(barrier_status_0);
+  TF_EXPECT_OK(barrier_status_1);
+  TF_EXPECT_OK(barrier_status_2);
+}
+
 TEST_F(CoordinationBarrierTest, BarrierWithMismatchedTasks) {
   const std::string barrier_id = "barrier_id";
   absl::Duration timeout = absl::Seconds(5);
@@ -136,6 +136,14 @@ const ::grpc::ChannelArguments* GetDefaultChannelArguments() {
       VLOG(5) << "Disabling TCP connection sharing";
       args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
     }
+    if (rpc_options->num_channels_per_target() > 1) {
+      // Channels with the same target and arguments otherwise share one
+      // connection from the global subchannel pool.
+      VLOG(5) << "Using one connection per channel for "
+              << rpc_options->num_channels_per_target()
+              << " channels per target";
+      args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, true);
+    }
   }
   return args;
 }
@@ -166,6 +174,21 @@ ChannelCreationFunction ConvertToChannelCreationFunction(
   };
 }
 
+ChannelCreationFunction ConvertToChannelCreationFunction(
+    const std::function<Status(string, const RPCOptions*,
+                               SharedGrpcChannelPtr*)>& new_channel_func_ptr,
+    const RPCOptions& rpc_options) {
+  return [new_channel_func_ptr,
+          rpc_options](const string& target) -> SharedGrpcChannelPtr {
+    SharedGrpcChannelPtr channel_ptr;
+    if (new_channel_func_ptr(target, &rpc_options, &channel_ptr).ok()) {
+      return channel_ptr;
+    } else {
+      return nullptr;
+    }
+  };
+}
+
 Status GrpcChannelSpec::AddHostPortsJob(
     const string& job_id, const std::map<int, string>& host_ports) {
   if (!job_ids_.insert(job_id).second) {
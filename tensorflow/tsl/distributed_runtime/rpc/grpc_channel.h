@@ -91,6 +91,12 @@ ChannelCreationFunction ConvertToChannelCreationFunction(
     const std::function<Status(string, const RPCOptions*,
                                SharedGrpcChannelPtr*)>& new_channel_func_ptr);
 
+// Like above, but passes `rpc_options` to `new_channel_func_ptr`.
+ChannelCreationFunction ConvertToChannelCreationFunction(
+    const std::function<Status(string, const RPCOptions*,
+                               SharedGrpcChannelPtr*)>& new_channel_func_ptr,
+    const RPCOptions& rpc_options);
+
 Status NewHostPortGrpcChannel(const string& target,
                               const RPCOptions* rpc_options,
                               SharedGrpcChannelPtr* channel_pointer);
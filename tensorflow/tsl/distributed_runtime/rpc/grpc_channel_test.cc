@@ -399,4 +399,25 @@ TEST(GrpcChannelTest, NewHostPortGrpcChannelValidation) {
           .ok());
 }
 
+// Returns whether `args` have a local subchannel pool, which gives each channel
+// its own connection.
+bool UsesLocalSubchannelPool(const ::grpc::ChannelArguments& args) {
+  const grpc_channel_args c_args = args.c_channel_args();
+  for (size_t i = 0; i < c_args.num_args; ++i) {
+    if (std::string(c_args.args[i].key) == GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL) {
+      return c_args.args[i].value.integer != 0;
+    }
+  }
+  return false;
+}
+
+TEST(GrpcChannelTest, MultiChannelPerTargetUsesOneConnectionPerChannel) {
+  RPCOptions rpc_options;
+  EXPECT_FALSE(UsesLocalSubchannelPool(GetChannelArguments(&rpc_options)));
+  rpc_options.set_num_channels_per_target(1);
+  EXPECT_FALSE(UsesLocalSubchannelPool(GetChannelArguments(&rpc_options)));
+  rpc_options.set_num_channels_per_target(4);
+  EXPECT_TRUE(UsesLocalSubchannelPool(GetChannelArguments(&rpc_options)));
+}
+
 }  // namespace tsl
@@ -39,6 +39,20 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+
+// Returns the index of the thread cache used by the calling thread.  Threads
+// are assigned round-robin the first time they allocate, which spreads a
+// fixed pool of worker threads evenly across the caches.
+int ThreadCacheIndexForCurrentThread(int num_caches) {
+  static std::atomic<int> next_index{0};
+  thread_local const int index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index % num_caches;
+}
+
+}  // namespace
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -84,6 +98,14 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.thread_cache_bytes > 0) {
+    VLOG(1) << "Enabling " << kNumThreadCaches << " thread caches of "
+            << strings::HumanReadableNumBytes(opts.thread_cache_bytes)
+            << " for BFCAllocator " << name;
+    thread_caches_.reset(new ThreadCache[kNumThreadCaches]);
+    thread_cache_index_.reset(new ThreadCacheIndexShard[kNumThreadCaches]);
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -427,6 +449,18 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
   // so all memory addresses are nicely byte aligned.
   size_t rounded_bytes = RoundedBytes(num_bytes);
 
+  if (thread_cache_enabled() && freed_before == 0 &&
+      timing_counter_ == nullptr && rounded_bytes <= kMaxThreadCacheChunkSize) {
+    const int cache_class = ThreadCacheClassForRequest(rounded_bytes);
+    void* ptr = AllocateFromThreadCache(cache_class, num_bytes);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+    // Round up to the size class so that the chunk can later be reused for
+    // any request of the same class.
+    rounded_bytes = kMinAllocationSize << cache_class;
+  }
+
   // The BFC allocator tries to find the best fit first.
   BinNum bin_num = BinNumForSize(rounded_bytes);
 
@@ -464,6 +498,16 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Chunks parked in thread caches are unavailable to the bins; give them back
+  // before resorting to more expensive measures.
+  if (thread_cache_enabled() && FlushThreadCaches()) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -609,6 +653,15 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (thread_cache_enabled()) {
+          UpdateThreadCachePeak(thread_cache_bytes_in_use_.fetch_add(
+                                    chunk->size, std::memory_order_relaxed) +
+                                chunk->size);
+          if (timing_counter_ == nullptr &&
+              chunk->size <= kMaxThreadCacheChunkSize) {
+            RegisterThreadCacheChunk(*chunk);
+          }
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -693,8 +746,21 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     VLOG(2) << "tried to deallocate nullptr";
     return;
   }
+  if (thread_cache_enabled() && timing_counter_ == nullptr &&
+      DeallocateToThreadCache(ptr)) {
+    return;
+  }
   mutex_lock l(lock_);
+  if (thread_cache_enabled()) {
+    UnregisterThreadCacheChunk(ptr);
+    thread_cache_bytes_in_use_.fetch_sub(
+        ChunkFromHandle(region_manager_.get_handle(ptr))->size,
+        std::memory_order_relaxed);
+  }
+  FreeChunk(ptr);
+}
 
+void BFCAllocator::FreeChunk(void* ptr) {
   // Find the chunk from the ptr.
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle);
@@ -937,6 +1003,10 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  ThreadCacheEntry entry;
+  if (LookupThreadCacheEntry(ptr, &entry)) {
+    return entry.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -946,6 +1016,10 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
+  ThreadCacheEntry entry;
+  if (LookupThreadCacheEntry(ptr, &entry)) {
+    return entry.size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -955,6 +1029,10 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64_t BFCAllocator::AllocationId(const void* ptr) const {
+  ThreadCacheEntry entry;
+  if (LookupThreadCacheEntry(ptr, &entry)) {
+    return entry.allocation_id;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1207,7 +1285,18 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  if (!thread_cache_enabled()) {
+    return stats_;
+  }
+  // Chunks parked in thread caches are free from the client's point of view,
+  // even though the bins still consider them in use.
+  AllocatorStats stats = stats_;
+  stats.num_allocs += thread_cache_num_allocs_.load(std::memory_order_relaxed);
+  stats.bytes_in_use =
+      thread_cache_bytes_in_use_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use =
+      thread_cache_peak_bytes_in_use_.load(std::memory_order_relaxed);
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
@@ -1215,9 +1304,184 @@ bool BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  if (thread_cache_enabled()) {
+    thread_cache_num_allocs_.store(0, std::memory_order_relaxed);
+    thread_cache_peak_bytes_in_use_.store(
+        thread_cache_bytes_in_use_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
   return true;
 }
 
+BFCAllocator::ThreadCacheIndexShard& BFCAllocator::IndexShardFor(
+    const void* ptr) const {
+  const std::uintptr_t p = reinterpret_cast<std::uintptr_t>(ptr);
+  return thread_cache_index_[(p >> kMinAllocationBits) % kNumThreadCaches];
+}
+
+int BFCAllocator::ThreadCacheClassForRequest(size_t rounded_bytes) {
+  DCHECK_LE(rounded_bytes, kMaxThreadCacheChunkSize);
+  int cache_class = BinNumForSize(rounded_bytes);
+  if (BinNumToSize(cache_class) < rounded_bytes) {
+    ++cache_class;
+  }
+  DCHECK_LT(cache_class, kNumThreadCacheClasses);
+  return cache_class;
+}
+
+void* BFCAllocator::AllocateFromThreadCache(int cache_class,
+                                            size_t num_bytes) {
+  ThreadCache& cache =
+      thread_caches_[ThreadCacheIndexForCurrentThread(kNumThreadCaches)];
+  CachedChunk chunk;
+  {
+    mutex_lock l(cache.mu);
+    std::vector<CachedChunk>& free_chunks = cache.free_chunks[cache_class];
+    if (free_chunks.empty()) {
+      return nullptr;
+    }
+    chunk = free_chunks.back();
+    free_chunks.pop_back();
+    cache.bytes -= chunk.size;
+  }
+  {
+    ThreadCacheIndexShard& shard = IndexShardFor(chunk.ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.entries.find(chunk.ptr);
+    CHECK(it != shard.entries.end() && it->second.cached);
+    it->second.cached = false;
+    it->second.requested_size = num_bytes;
+    it->second.allocation_id = next_allocation_id_++;
+  }
+  thread_cache_num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  UpdateThreadCachePeak(thread_cache_bytes_in_use_.fetch_add(
+                            chunk.size, std::memory_order_relaxed) +
+                        chunk.size);
+  VLOG(4) << "Returning cached: " << chunk.ptr;
+  return chunk.ptr;
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  size_t size;
+  {
+    ThreadCacheIndexShard& shard = IndexShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.entries.find(ptr);
+    if (it == shard.entries.end()) {
+      return false;
+    }
+    CHECK(!it->second.cached) << "Double free of " << ptr;
+    it->second.cached = true;
+    it->second.allocation_id = -1;
+    size = it->second.size;
+  }
+  thread_cache_bytes_in_use_.fetch_sub(size, std::memory_order_relaxed);
+
+  // Chunks may be larger than their size class, so file them under the
+  // largest class they can satisfy.
+  const int cache_class = BinNumForSize(size);
+  DCHECK_LT(cache_class, kNumThreadCacheClasses);
+  ThreadCache& cache =
+      thread_caches_[ThreadCacheIndexForCurrentThread(kNumThreadCaches)];
+  std::vector<CachedChunk> to_release;
+  {
+    mutex_lock l(cache.mu);
+    cache.free_chunks[cache_class].push_back({ptr, size});
+    cache.bytes += size;
+    if (cache.bytes > opts_.thread_cache_bytes) {
+      // Return the older half of every class to the bins in one batch, so the
+      // allocator lock is taken once per many deallocations.
+      for (std::vector<CachedChunk>& free_chunks : cache.free_chunks) {
+        const size_t n = (free_chunks.size() + 1) / 2;
+        for (size_t i = 0; i < n; ++i) {
+          cache.bytes -= free_chunks[i].size;
+          to_release.push_back(free_chunks[i]);
+        }
+        free_chunks.erase(free_chunks.begin(), free_chunks.begin() + n);
+      }
+    }
+  }
+  if (!to_release.empty()) {
+    mutex_lock l(lock_);
+    ReleaseCachedChunks(to_release);
+  }
+  return true;
+}
+
+void BFCAllocator::RegisterThreadCacheChunk(const Chunk& chunk) {
+  ThreadCacheIndexShard& shard = IndexShardFor(chunk.ptr);
+  mutex_lock l(shard.mu);
+  ThreadCacheEntry& entry = shard.entries[chunk.ptr];
+  entry.size = chunk.size;
+  entry.requested_size = chunk.requested_size;
+  entry.allocation_id = chunk.allocation_id;
+  entry.cached = false;
+}
+
+void BFCAllocator::UnregisterThreadCacheChunk(const void* ptr) {
+  ThreadCacheIndexShard& shard = IndexShardFor(ptr);
+  mutex_lock l(shard.mu);
+  shard.entries.erase(ptr);
+}
+
+bool BFCAllocator::LookupThreadCacheEntry(const void* ptr,
+                                          ThreadCacheEntry* entry) const {
+  if (!thread_cache_enabled()) {
+    return false;
+  }
+  ThreadCacheIndexShard& shard = IndexShardFor(ptr);
+  mutex_lock l(shard.mu);
+  auto it = shard.entries.find(ptr);
+  if (it == shard.entries.end() || it->second.cached) {
+    return false;
+  }
+  *entry = it->second;
+  return true;
+}
+
+bool BFCAllocator::IsThreadCached(const void* ptr) const {
+  if (!thread_cache_enabled()) {
+    return false;
+  }
+  ThreadCacheIndexShard& shard = IndexShardFor(ptr);
+  mutex_lock l(shard.mu);
+  auto it = shard.entries.find(ptr);
+  return it != shard.entries.end() && it->second.cached;
+}
+
+void BFCAllocator::ReleaseCachedChunks(const std::vector<CachedChunk>& chunks) {
+  for (const CachedChunk& chunk : chunks) {
+    UnregisterThreadCacheChunk(chunk.ptr);
+    FreeChunk(chunk.ptr);
+  }
+}
+
+bool BFCAllocator::FlushThreadCaches() {
+  std::vector<CachedChunk> to_release;
+  for (int i = 0; i < kNumThreadCaches; ++i) {
+    ThreadCache& cache = thread_caches_[i];
+    mutex_lock l(cache.mu);
+    for (std::vector<CachedChunk>& free_chunks : cache.free_chunks) {
+      to_release.insert(to_release.end(), free_chunks.begin(),
+                        free_chunks.end());
+      free_chunks.clear();
+    }
+    cache.bytes = 0;
+  }
+  VLOG(2) << "Flushing " << to_release.size() << " chunks from thread caches";
+  ReleaseCachedChunks(to_release);
+  return !to_release.empty();
+}
+
+void BFCAllocator::UpdateThreadCachePeak(int64_t bytes_in_use) {
+  int64_t peak =
+      thread_cache_peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak &&
+         !thread_cache_peak_bytes_in_use_.compare_exchange_weak(
+             peak, bytes_in_use, std::memory_order_relaxed)) {
+  }
+}
+
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
 BFCAllocator::get_bin_debug_info() {
   std::array<BinDebugInfo, kNumBins> bin_infos;
@@ -1229,7 +1493,9 @@ BFCAllocator::get_bin_debug_info() {
       BinDebugInfo& bin_info = bin_infos[bin_num];
       bin_info.total_bytes_in_bin += c->size;
       bin_info.total_chunks_in_bin++;
-      if (c->in_use()) {
+      if (c->in_use() && IsThreadCached(c->ptr)) {
+        // Parked in a thread cache: free for the client, but not in a bin.
+      } else if (c->in_use()) {
         bin_info.total_bytes_in_use += c->size;
         bin_info.total_requested_bytes_in_use += c->requested_size;
         bin_info.total_chunks_in_use++;
@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
@@ -68,6 +70,14 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If non-zero, small allocations (up to 64KiB) are served from
+    // per-thread caches of recently freed chunks without taking the allocator
+    // lock.  Each cache holds at most this many bytes; once the limit is
+    // exceeded, part of the cache is returned to the bins in a single batch.
+    // Chunks are never cached while a timing counter is set, since cached
+    // chunks bypass freed_at_count tracking.
+    size_t thread_cache_bytes = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -120,6 +130,10 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns the chunk containing 'ptr' to the bins, coalescing it with its
+  // neighbors where possible.
+  void FreeChunk(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -517,6 +531,91 @@ class BFCAllocator : public Allocator {
   // size over total free memory, and returns a value within [0, 1].
   double GetFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Per-thread caching of small chunks.
+  //
+  // Chunks of at most kMaxThreadCacheChunkSize bytes are tracked in
+  // thread_cache_index_ from the moment they are handed out by the bins.  When
+  // such a chunk is deallocated it is parked in the caller's ThreadCache
+  // instead of being returned to the bins; it stays marked in-use in chunks_,
+  // so it can never be split, merged or handed out by FindChunkPtr.  A later
+  // allocation of the same size class on the same thread pops it without
+  // touching lock_.
+  //
+  // Lock order: lock_ may be held while acquiring a ThreadCache::mu or a
+  // ThreadCacheIndexShard::mu, never the other way round.
+  static constexpr int kNumThreadCacheClasses = 9;
+  static constexpr size_t kMaxThreadCacheChunkSize =
+      kMinAllocationSize << (kNumThreadCacheClasses - 1);
+  static constexpr int kNumThreadCaches = 16;
+
+  struct CachedChunk {
+    void* ptr;
+    size_t size;
+  };
+
+  // Free chunks parked by the threads mapped to this cache.  Every chunk in
+  // free_chunks[c] has at least kMinAllocationSize << c bytes.
+  struct ThreadCache {
+    mutex mu;
+    std::array<std::vector<CachedChunk>, kNumThreadCacheClasses> free_chunks
+        TF_GUARDED_BY(mu);
+    size_t bytes TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Metadata of a cacheable chunk, readable without holding lock_.
+  struct ThreadCacheEntry {
+    size_t size = 0;
+    size_t requested_size = 0;
+    int64_t allocation_id = -1;
+    // True while the chunk sits in a ThreadCache.
+    bool cached = false;
+  };
+
+  struct ThreadCacheIndexShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, ThreadCacheEntry> entries
+        TF_GUARDED_BY(mu);
+  };
+
+  bool thread_cache_enabled() const { return thread_caches_ != nullptr; }
+
+  ThreadCacheIndexShard& IndexShardFor(const void* ptr) const;
+
+  // Returns the first size class whose chunks can hold 'rounded_bytes'.
+  int ThreadCacheClassForRequest(size_t rounded_bytes);
+
+  // Pops a cached chunk of size class 'cache_class' for the calling thread, or
+  // returns nullptr if its cache has none.
+  void* AllocateFromThreadCache(int cache_class, size_t num_bytes);
+
+  // Parks 'ptr' in the calling thread's cache.  Returns false if 'ptr' is not
+  // a cacheable chunk, in which case nothing is done.
+  bool DeallocateToThreadCache(void* ptr);
+
+  // Records a chunk that was just handed out by the bins as cacheable.
+  void RegisterThreadCacheChunk(const Chunk& chunk)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Forgets a chunk that is being returned to the bins.
+  void UnregisterThreadCacheChunk(const void* ptr)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Looks up the metadata of an in-use cacheable chunk.
+  bool LookupThreadCacheEntry(const void* ptr, ThreadCacheEntry* entry) const;
+
+  // Returns true if 'ptr' is parked in a ThreadCache.
+  bool IsThreadCached(const void* ptr) const;
+
+  // Returns the given cached chunks to the bins.
+  void ReleaseCachedChunks(const std::vector<CachedChunk>& chunks)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Empties every ThreadCache back into the bins.  Returns true if any chunk
+  // was released.
+  bool FlushThreadCaches() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  void UpdateThreadCachePeak(int64_t bytes_in_use);
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -606,8 +705,19 @@ class BFCAllocator : public Allocator {
   ChunkHandle free_chunks_list_ TF_GUARDED_BY(lock_);
 
   // Counter containing the next unique identifier to assign to a
-  // newly-created chunk.
-  int64_t next_allocation_id_ TF_GUARDED_BY(lock_);
+  // newly-created chunk.  Atomic so that thread cache hits can draw from it
+  // without holding lock_.
+  std::atomic<int64_t> next_allocation_id_;
+
+  // Thread cache state; all null/zero unless Options::thread_cache_bytes > 0.
+  std::unique_ptr<ThreadCache[]> thread_caches_;
+  std::unique_ptr<ThreadCacheIndexShard[]> thread_cache_index_;
+  // Allocations served by the thread caches, not counted in stats_.num_allocs.
+  std::atomic<int64_t> thread_cache_num_allocs_{0};
+  // Bytes in use by clients and its peak.  Unlike stats_.bytes_in_use these
+  // exclude chunks parked in thread caches.
+  std::atomic<int64_t> thread_cache_bytes_in_use_{0};
+  std::atomic<int64_t> thread_cache_peak_bytes_in_use_{0};
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
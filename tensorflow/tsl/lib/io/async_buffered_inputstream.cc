@@ -0,0 +1,177 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/async_buffered_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+AsyncBufferedInputStream::AsyncBufferedInputStream(RandomAccessFile* file,
+                                                   size_t buffer_bytes,
+                                                   Env* env)
+    : file_(file), size_(buffer_bytes) {
+  DCHECK_GT(size_, 0);
+  fetch_thread_.reset(env->StartThread(ThreadOptions(),
+                                       "TF_async_buffered_input_stream",
+                                       [this] { FetchLoop(); }));
+}
+
+AsyncBufferedInputStream::~AsyncBufferedInputStream() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+  }
+  // Destroying fetch_thread_ blocks until FetchLoop() returns, once the read
+  // in flight, if any, completes.
+  fetch_thread_.reset();
+}
+
+void AsyncBufferedInputStream::FetchLoop() {
+  mutex_lock l(mu_);
+  while (true) {
+    while (!cancelled_ && (next_ != nullptr || fetch_done_)) {
+      cond_var_.wait(l);
+    }
+    if (cancelled_) {
+      return;
+    }
+    const uint64 generation = generation_;
+    auto chunk = std::make_unique<Chunk>();
+    chunk->offset = fetch_offset_;
+    mu_.unlock();  // Release the lock while reading the file.
+    chunk->data.resize_uninitialized(size_);
+    StringPiece data;
+    chunk->status = file_->Read(chunk->offset, size_, &data, &chunk->data[0]);
+    if (data.data() != chunk->data.data()) {
+      memmove(&chunk->data[0], data.data(), data.size());
+    }
+    chunk->data.resize(data.size());
+    mu_.lock();
+    if (generation != generation_) {
+      // The stream was repositioned during the read.
+      continue;
+    }
+    fetch_offset_ += data.size();
+    fetch_done_ = !chunk->status.ok();
+    next_ = std::move(chunk);
+    cond_var_.notify_all();
+  }
+}
+
+Status AsyncBufferedInputStream::NextChunk() {
+  if (!current_.status.ok()) {
+    return current_.status;
+  }
+  {
+    mutex_lock l(mu_);
+    while (next_ == nullptr) {
+      cond_var_.wait(l);
+    }
+    current_ = std::move(*next_);
+    next_.reset();
+    // Let the background thread read the chunk after this one.
+    cond_var_.notify_all();
+  }
+  pos_ = 0;
+  if (current_.data.empty()) {
+    return current_.status;
+  }
+  return OkStatus();
+}
+
+void AsyncBufferedInputStream::Seek(int64_t offset) {
+  {
+    mutex_lock l(mu_);
+    ++generation_;
+    next_.reset();
+    fetch_offset_ = offset;
+    fetch_done_ = false;
+    cond_var_.notify_all();
+  }
+  current_ = Chunk();
+  current_.offset = offset;
+  pos_ = 0;
+}
+
+Status AsyncBufferedInputStream::ReadNBytes(int64_t bytes_to_read,
+                                            tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  while (result->size() < static_cast<size_t>(bytes_to_read)) {
+    if (pos_ == current_.data.size()) {
+      TF_RETURN_IF_ERROR(NextChunk());
+    }
+    const size_t bytes_to_copy = std::min<size_t>(
+        current_.data.size() - pos_, bytes_to_read - result->size());
+    result->append(current_.data.data() + pos_, bytes_to_copy);
+    pos_ += bytes_to_copy;
+  }
+  return OkStatus();
+}
+
+Status AsyncBufferedInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can only skip forward, not ",
+                                   bytes_to_skip);
+  }
+  // Skip through the buffered chunks as long as what is left to skip is
+  // smaller than a chunk; past that, restarting the reads is cheaper.
+  while (bytes_to_skip > 0) {
+    if (pos_ == current_.data.size()) {
+      if (static_cast<size_t>(bytes_to_skip) >= size_) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(NextChunk());
+    }
+    const size_t bytes_skipped =
+        std::min<size_t>(current_.data.size() - pos_, bytes_to_skip);
+    pos_ += bytes_skipped;
+    bytes_to_skip -= bytes_skipped;
+  }
+  if (bytes_to_skip == 0) {
+    return OkStatus();
+  }
+  // Restart the reads at the last skipped byte, which must exist.
+  Seek(Tell() + bytes_to_skip - 1);
+  tstring last_byte;
+  Status s = ReadNBytes(1, &last_byte);
+  if (errors::IsOutOfRange(s)) {
+    return errors::OutOfRange("reached end of file");
+  }
+  return s;
+}
+
+int64_t AsyncBufferedInputStream::Tell() const {
+  return current_.offset + pos_;
+}
+
+Status AsyncBufferedInputStream::Reset() {
+  Seek(0);
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,108 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ASYNC_BUFFERED_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_ASYNC_BUFFERED_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+
+namespace tsl {
+namespace io {
+
+// Provides a double buffer on top of a RandomAccessFile: while the caller
+// consumes a buffer-sized chunk of the file, the next chunk is read on a
+// background thread. This overlaps the file I/O with the processing of the
+// data, at the cost of one extra buffer.
+//
+// Reads must be mostly sequential: skipping forward past the buffered data, or
+// calling Reset(), discards the buffered chunks and restarts the background
+// reads at the new position.
+//
+// A single instance of AsyncBufferedInputStream is NOT safe for concurrent use
+// by multiple threads.
+class AsyncBufferedInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of file. file must outlive *this.
+  AsyncBufferedInputStream(RandomAccessFile* file, size_t buffer_bytes,
+                           Env* env = Env::Default());
+
+  ~AsyncBufferedInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // A chunk of the file, read by the background thread.
+  struct Chunk {
+    // The offset of the chunk in the file.
+    int64_t offset = 0;
+    tstring data;
+    // The status of the read. It is OUT_OF_RANGE for the chunk at the end of
+    // the file, which can be partial, and no chunk follows a non-OK one.
+    Status status;
+  };
+
+  // Reads the chunks of the file on the background thread, one ahead of the
+  // chunk being consumed.
+  void FetchLoop();
+
+  // Replaces the consumed current_ chunk with the next one, waiting for its
+  // read to complete. Returns the status ending the file after the last chunk.
+  Status NextChunk();
+
+  // Discards the buffered chunks and restarts the reads at `offset`.
+  void Seek(int64_t offset);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t size_;             // Buffer size.
+
+  // The chunk being consumed, and the position of the next byte to return in
+  // it. Only accessed by the caller's thread.
+  Chunk current_;
+  size_t pos_ = 0;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  // The chunk following current_, once it has been read.
+  std::unique_ptr<Chunk> next_ TF_GUARDED_BY(mu_);
+  // The offset of the next chunk to read.
+  int64_t fetch_offset_ TF_GUARDED_BY(mu_) = 0;
+  // Whether the background reads reached the end of the file, or an error.
+  bool fetch_done_ TF_GUARDED_BY(mu_) = false;
+  // Incremented on every Seek(), to discard the chunks read before it.
+  uint64 generation_ TF_GUARDED_BY(mu_) = 0;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+  std::unique_ptr<Thread> fetch_thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AsyncBufferedInputStream);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ASYNC_BUFFERED_INPUTSTREAM_H_
@@ -0,0 +1,137 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/async_buffered_inputstream.h"
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+static std::vector<int> BufferSizes() {
+  return {1,  2,  3,  4,  5,  6,  7,  8,  9,  10,   11,
+          12, 13, 14, 15, 16, 17, 18, 19, 20, 65536};
+}
+
+TEST(AsyncBufferedInputStream, ReadNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    tstring read;
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(0, &read));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "3456");
+    EXPECT_EQ(7, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "789");
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST(AsyncBufferedInputStream, ReadPastEndOfFile) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    tstring read;
+    TF_ASSERT_OK(in.ReadNBytes(8, &read));
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+    EXPECT_EQ(read, "89");
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    EXPECT_EQ(read, "");
+  }
+}
+
+TEST(AsyncBufferedInputStream, SkipNBytes) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    tstring read;
+    TF_ASSERT_OK(in.SkipNBytes(1));
+    EXPECT_EQ(1, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "12");
+    TF_ASSERT_OK(in.SkipNBytes(5));
+    EXPECT_EQ(8, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(1, &read));
+    EXPECT_EQ(read, "8");
+    // Skipping right to the end of the file succeeds.
+    TF_ASSERT_OK(in.SkipNBytes(1));
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+  }
+  for (auto buf_size : BufferSizes()) {
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(11)));
+  }
+}
+
+TEST(AsyncBufferedInputStream, Reset) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    AsyncBufferedInputStream in(file.get(), buf_size);
+    tstring read;
+    TF_ASSERT_OK(in.ReadNBytes(6, &read));
+    EXPECT_EQ(read, "012345");
+    TF_ASSERT_OK(in.Reset());
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_EQ(read, "0123");
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(7, &read)));
+    TF_ASSERT_OK(in.Reset());
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(read, "0123456789");
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
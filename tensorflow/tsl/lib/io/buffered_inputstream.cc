@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/buffered_inputstream.h"
 
+#include <cstring>
+
 #include "absl/status/status.h"
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
 
@@ -56,37 +58,52 @@ Status BufferedInputStream::FillBuffer() {
   return s;
 }
 
+namespace {
+
+// Appends [begin, end) to `result`, dropping any '\r'.
+template <typename StringType>
+void AppendWithoutCarriageReturns(const char* begin, const char* end,
+                                  StringType* result) {
+  while (begin < end) {
+    const char* cr =
+        static_cast<const char*>(memchr(begin, '\r', end - begin));
+    const char* piece_end = cr != nullptr ? cr : end;
+    result->append(begin, piece_end - begin);
+    begin = piece_end + 1;
+  }
+}
+
+}  // namespace
+
 template <typename StringType>
 Status BufferedInputStream::ReadLineHelper(StringType* result,
                                            bool include_eol) {
   result->clear();
   Status s;
-  size_t start_pos = pos_;
   while (true) {
     if (pos_ == limit_) {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
       // Get more data into buffer
       s = FillBuffer();
       if (limit_ == 0) {
         break;
       }
-      start_pos = pos_;
     }
-    char c = buf_[pos_];
-    if (c == '\n') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
+    // Scan the buffered data for the end of the line with `memchr`, which
+    // examines many bytes at a time, rather than one character at a time.
+    const char* begin = buf_.data() + pos_;
+    const char* end = buf_.data() + limit_;
+    const char* eol =
+        static_cast<const char*>(memchr(begin, '\n', end - begin));
+    // We don't append '\r' to *result
+    AppendWithoutCarriageReturns(begin, eol != nullptr ? eol : end, result);
+    if (eol != nullptr) {
       if (include_eol) {
-        result->append(1, c);
+        result->append(1, '\n');
       }
-      pos_++;
+      pos_ = eol - buf_.data() + 1;
       return OkStatus();
     }
-    // We don't append '\r' to *result
-    if (c == '\r') {
-      result->append(buf_.data() + start_pos, pos_ - start_pos);
-      start_pos = pos_ + 1;
-    }
-    pos_++;
+    pos_ = limit_;
   }
   if (absl::IsOutOfRange(s) && !result->empty()) {
     return OkStatus();
@@ -239,11 +256,15 @@ Status BufferedInputStream::SkipLine() {
         break;
       }
     }
-    char c = buf_[pos_++];
     skipped = true;
-    if (c == '\n') {
+    const char* begin = buf_.data() + pos_;
+    const char* eol =
+        static_cast<const char*>(memchr(begin, '\n', limit_ - pos_));
+    if (eol != nullptr) {
+      pos_ = eol - buf_.data() + 1;
       return OkStatus();
     }
+    pos_ = limit_;
   }
   if (absl::IsOutOfRange(s) && skipped) {
     return OkStatus();
@@ -189,6 +189,32 @@ TEST(BufferedInputStream, ReadLine_CRLF) {
   }
 }
 
+TEST(BufferedInputStream, ReadLine_LongLines) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string long_line(100, 'x');
+  TF_ASSERT_OK(WriteStringToFile(env, fname,
+                                 long_line + "\n" + long_line + "\r" +
+                                     long_line + "\r\n" + long_line));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessInputStream> input_stream(
+        new RandomAccessInputStream(file.get()));
+    BufferedInputStream in(input_stream.get(), buf_size);
+    string line;
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, long_line);
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, long_line + long_line);
+    TF_ASSERT_OK(in.ReadLine(&line));
+    EXPECT_EQ(line, long_line);
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadLine(&line)));
+  }
+}
+
 TEST(BufferedInputStream, SkipLine1) {
   Env* env = Env::Default();
   string fname;
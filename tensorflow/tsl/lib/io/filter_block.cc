@@ -0,0 +1,163 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/filter_block.h"
+
+#include <algorithm>
+
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/hash.h"
+#include "tensorflow/tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace table {
+
+const char kBloomFilterBlockKey[] = "filter.tsl.BuiltinBloomFilter";
+
+namespace {
+
+constexpr uint32 kHashSeed = 0xbc9f1d34;
+// Filters with more probes than this are reserved for other encodings, and
+// treated as matching every key.
+constexpr int kMaxNumProbes = 30;
+
+uint32 KeyHash(const StringPiece& key) {
+  return Hash32(key.data(), key.size(), kHashSeed);
+}
+
+// Appends to "dst" a bloom filter of the keys with hashes "key_hashes".  The
+// filter probes the bits by double hashing, and ends with its number of
+// probes.
+void AppendBloomFilter(const std::vector<uint32>& key_hashes, int bits_per_key,
+                       string* dst) {
+  // Rounding down 0.69 (~ ln(2)) minimizes the false positive rate, and
+  // saves some probes.
+  const int num_probes =
+      std::min(std::max(static_cast<int>(bits_per_key * 0.69), 1),
+               kMaxNumProbes);
+
+  // A small number of keys would have a very high false positive rate with a
+  // very short filter, so use at least 64 bits.
+  size_t bits = std::max<size_t>(key_hashes.size() * bits_per_key, 64);
+  const size_t bytes = (bits + 7) / 8;
+  bits = bytes * 8;
+
+  const size_t init_size = dst->size();
+  dst->resize(init_size + bytes, 0);
+  dst->push_back(static_cast<char>(num_probes));
+  char* array = &(*dst)[init_size];
+  for (uint32 h : key_hashes) {
+    const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+    for (int j = 0; j < num_probes; ++j) {
+      const uint32 bit = h % bits;
+      array[bit / 8] |= (1 << (bit % 8));
+      h += delta;
+    }
+  }
+}
+
+bool BloomFilterMayMatch(const StringPiece& filter, const StringPiece& key) {
+  const size_t len = filter.size();
+  if (len < 2) return false;
+  const int num_probes = static_cast<uint8>(filter[len - 1]);
+  if (num_probes > kMaxNumProbes) return true;
+
+  const char* array = filter.data();
+  const size_t bits = (len - 1) * 8;
+  uint32 h = KeyHash(key);
+  const uint32 delta = (h >> 17) | (h << 15);  // Rotate right 17 bits
+  for (int j = 0; j < num_probes; ++j) {
+    const uint32 bit = h % bits;
+    if ((array[bit / 8] & (1 << (bit % 8))) == 0) return false;
+    h += delta;
+  }
+  return true;
+}
+
+}  // namespace
+
+FilterBlockBuilder::FilterBlockBuilder(int bits_per_key)
+    : bits_per_key_(bits_per_key) {}
+
+void FilterBlockBuilder::AddKey(const StringPiece& key) {
+  key_hashes_.push_back(KeyHash(key));
+}
+
+void FilterBlockBuilder::FinishBlock(uint64 block_offset) {
+  filter_offsets_.push_back(result_.size());
+  block_offsets_.push_back(block_offset);
+  AppendBloomFilter(key_hashes_, bits_per_key_, &result_);
+  key_hashes_.clear();
+}
+
+StringPiece FilterBlockBuilder::Finish() {
+  const uint32 filters_end = result_.size();
+  for (uint32 offset : filter_offsets_) {
+    core::PutFixed32(&result_, offset);
+  }
+  core::PutFixed32(&result_, filters_end);
+  for (uint64 offset : block_offsets_) {
+    core::PutFixed64(&result_, offset);
+  }
+  core::PutFixed32(&result_, block_offsets_.size());
+  return StringPiece(result_);
+}
+
+FilterBlockReader::FilterBlockReader(const StringPiece& contents) {
+  const size_t size = contents.size();
+  if (size < 8) return;  // Corrupt or empty: no filters.
+  const size_t n = core::DecodeFixed32(contents.data() + size - 4);
+  // The offsets take 4 bytes per filter plus 4 for the end of the filters,
+  // and 8 bytes per block, on top of the 4 bytes of "n".
+  if (n > (size - 8) / 12) return;
+  const char* filter_offsets = contents.data() + size - 8 - 12 * n;
+  const size_t filters_end = core::DecodeFixed32(filter_offsets + 4 * n);
+  if (filters_end > static_cast<size_t>(filter_offsets - contents.data())) {
+    return;
+  }
+  filters_ = StringPiece(contents.data(), filters_end);
+  filter_offsets_ = filter_offsets;
+  block_offsets_ = filter_offsets + 4 * (n + 1);
+  num_filters_ = n;
+}
+
+bool FilterBlockReader::KeyMayMatch(uint64 block_offset,
+                                    const StringPiece& key) const {
+  // The data blocks are written in order, so their offsets are sorted.
+  size_t lo = 0;
+  size_t hi = num_filters_;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (core::DecodeFixed64(block_offsets_ + 8 * mid) < block_offset) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == num_filters_ ||
+      core::DecodeFixed64(block_offsets_ + 8 * lo) != block_offset) {
+    return true;
+  }
+  const size_t start = core::DecodeFixed32(filter_offsets_ + 4 * lo);
+  const size_t limit = lo + 1 < num_filters_
+                           ? core::DecodeFixed32(filter_offsets_ + 4 * (lo + 1))
+                           : filters_.size();
+  if (start > limit || limit > filters_.size()) return true;
+  return BloomFilterMayMatch(StringPiece(filters_.data() + start, limit - start),
+                             key);
+}
+
+}  // namespace table
+}  // namespace tsl
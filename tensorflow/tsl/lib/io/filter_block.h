@@ -0,0 +1,89 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_FILTER_BLOCK_H_
+#define TENSORFLOW_TSL_LIB_IO_FILTER_BLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace table {
+
+// The key of the handle of the filter block in the metaindex block.
+extern const char kBloomFilterBlockKey[];
+
+// A filter block holds a bloom filter of the keys of each data block of a
+// table, so that a lookup of a key that isn't in the table can usually skip
+// reading the data block that would hold it.
+//
+// The filter block is stored as:
+//    filter[0] ... filter[n-1]
+//    filter_offset[0] ... filter_offset[n-1]: uint32
+//    filters_end: uint32
+//    block_offset[0] ... block_offset[n-1]: uint64
+//    n: uint32
+// where filter[i] is the filter of the data block at block_offset[i].
+class FilterBlockBuilder {
+ public:
+  explicit FilterBlockBuilder(int bits_per_key);
+
+  // Adds "key" to the filter of the current data block.
+  void AddKey(const StringPiece& key);
+
+  // Ends the filter of the current data block, which was written at
+  // "block_offset".
+  void FinishBlock(uint64 block_offset);
+
+  // Returns the contents of the filter block.  The returned slice remains
+  // valid for the lifetime of this builder.
+  StringPiece Finish();
+
+ private:
+  const int bits_per_key_;
+  string result_;
+  std::vector<uint32> key_hashes_;  // Of the keys of the current data block.
+  std::vector<uint32> filter_offsets_;
+  std::vector<uint64> block_offsets_;
+
+  FilterBlockBuilder(const FilterBlockBuilder&) = delete;
+  void operator=(const FilterBlockBuilder&) = delete;
+};
+
+class FilterBlockReader {
+ public:
+  // REQUIRES: "contents" remains live while *this is live.
+  explicit FilterBlockReader(const StringPiece& contents);
+
+  // Returns false if "key" is certainly not in the data block at
+  // "block_offset".  Returns true if it may be, or if the block has no filter.
+  bool KeyMayMatch(uint64 block_offset, const StringPiece& key) const;
+
+ private:
+  StringPiece filters_;
+  const char* filter_offsets_ = nullptr;
+  const char* block_offsets_ = nullptr;
+  size_t num_filters_ = 0;
+};
+
+}  // namespace table
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_FILTER_BLOCK_H_
@@ -17,7 +17,12 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/lib/io/async_buffered_inputstream.h"
 #include "tensorflow/tsl/lib/io/buffered_inputstream.h"
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
@@ -59,7 +64,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
     : options_(options),
       input_stream_(new RandomAccessInputStream(file)),
       last_read_failed_(false) {
-  if (options.buffer_size > 0) {
+  if (options.buffer_size > 0 && options.async_buffering) {
+    input_stream_.reset(
+        new AsyncBufferedInputStream(file, options.buffer_size));
+  } else if (options.buffer_size > 0) {
     input_stream_.reset(new BufferedInputStream(input_stream_.release(),
                                                 options.buffer_size, true));
   }
@@ -259,5 +267,144 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+namespace {
+// Upper bound on the size of a single coalesced read of records, so that
+// reading a large batch of nearby records does not need an unbounded buffer.
+constexpr uint64 kMaxCoalescedReadSize = 16 << 20;  // 16MB
+
+// Reads exactly "n" bytes at "offset" of "file" into "*buffer".
+Status ReadExactly(RandomAccessFile* file, uint64 offset, size_t n,
+                   std::string* buffer, StringPiece* result) {
+  buffer->resize(n);
+  Status s = file->Read(offset, n, result, &(*buffer)[0]);
+  if (result->size() == n) return OkStatus();
+  if (s.ok() || errors::IsOutOfRange(s)) {
+    return errors::OutOfRange("Read ", result->size(), " bytes at offset ",
+                              offset, " instead of ", n);
+  }
+  return s;
+}
+}  // namespace
+
+IndexedRecordReader::IndexedRecordReader(RandomAccessFile* file,
+                                         RandomAccessFile* index_file,
+                                         uint64 coalesce_gap)
+    : file_(file), index_file_(index_file), coalesce_gap_(coalesce_gap) {}
+
+Status IndexedRecordReader::ReadRecord(uint64 index, tstring* record) {
+  std::vector<tstring> records;
+  TF_RETURN_IF_ERROR(ReadRecords({index}, &records));
+  *record = std::move(records[0]);
+  return OkStatus();
+}
+
+Status IndexedRecordReader::ReadLocations(const std::vector<uint64>& indices,
+                                          std::vector<Location>* locations) {
+  locations->clear();
+  locations->reserve(indices.size());
+  std::string buffer;
+  size_t i = 0;
+  while (i < indices.size()) {
+    // Read the entries of a run of nearby indices together.
+    size_t end = i + 1;
+    while (end < indices.size() &&
+           (indices[end] - indices[end - 1]) * kIndexEntrySize <=
+               coalesce_gap_) {
+      ++end;
+    }
+    const uint64 first = indices[i];
+    const size_t n = (indices[end - 1] - first + 1) * kIndexEntrySize;
+    StringPiece entries;
+    Status s =
+        ReadExactly(index_file_, first * kIndexEntrySize, n, &buffer, &entries);
+    if (errors::IsOutOfRange(s)) {
+      return errors::OutOfRange("Record index ", indices[end - 1],
+                                " is out of range of the record index");
+    }
+    TF_RETURN_IF_ERROR(s);
+    for (; i < end; ++i) {
+      const char* entry =
+          entries.data() + (indices[i] - first) * kIndexEntrySize;
+      locations->push_back({core::DecodeFixed64(entry),
+                            core::DecodeFixed64(entry + sizeof(uint64))});
+    }
+  }
+  return OkStatus();
+}
+
+Status IndexedRecordReader::ReadRecords(const std::vector<uint64>& indices,
+                                        std::vector<tstring>* records) {
+  records->clear();
+  records->resize(indices.size());
+  if (indices.empty()) return OkStatus();
+
+  // Visit the records in the order of the file, reading each one once even if
+  // it is requested several times.
+  std::vector<size_t> order(indices.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(),
+            [&indices](size_t a, size_t b) { return indices[a] < indices[b]; });
+  std::vector<uint64> sorted_indices;
+  sorted_indices.reserve(indices.size());
+  for (size_t i : order) {
+    if (sorted_indices.empty() || sorted_indices.back() != indices[i]) {
+      sorted_indices.push_back(indices[i]);
+    }
+  }
+  std::vector<Location> locations;
+  TF_RETURN_IF_ERROR(ReadLocations(sorted_indices, &locations));
+
+  std::string buffer;
+  size_t next = 0;  // Position in `order` of the next record to fill in.
+  size_t i = 0;
+  while (i < locations.size()) {
+    // Coalesce the records that are close enough to the previous one.
+    const uint64 start = locations[i].offset;
+    uint64 limit = start + RecordReader::kHeaderSize + locations[i].length +
+                   RecordReader::kFooterSize;
+    size_t end = i + 1;
+    while (end < locations.size() && locations[end].offset >= limit &&
+           locations[end].offset - limit <= coalesce_gap_) {
+      const uint64 record_limit = locations[end].offset +
+                                  RecordReader::kHeaderSize +
+                                  locations[end].length +
+                                  RecordReader::kFooterSize;
+      if (record_limit - start > kMaxCoalescedReadSize) break;
+      limit = record_limit;
+      ++end;
+    }
+
+    StringPiece data;
+    Status s = ReadExactly(file_, start, limit - start, &buffer, &data);
+    if (errors::IsOutOfRange(s)) {
+      return errors::DataLoss("truncated record at ", start);
+    }
+    TF_RETURN_IF_ERROR(s);
+
+    for (; i < end; ++i) {
+      const Location& location = locations[i];
+      const char* header = data.data() + (location.offset - start);
+      const uint32 length_crc = core::DecodeFixed32(header + sizeof(uint64));
+      if (crc32c::Unmask(length_crc) != crc32c::Value(header, sizeof(uint64)) ||
+          core::DecodeFixed64(header) != location.length) {
+        return errors::DataLoss("corrupted record header at ",
+                                location.offset);
+      }
+      const char* record_data = header + RecordReader::kHeaderSize;
+      const uint32 data_crc =
+          core::DecodeFixed32(record_data + location.length);
+      if (crc32c::Unmask(data_crc) !=
+          crc32c::Value(record_data, location.length)) {
+        return errors::DataLoss("corrupted record at ", location.offset);
+      }
+      const uint64 index = sorted_indices[i];
+      for (; next < order.size() && indices[order[next]] == index; ++next) {
+        (*records)[order[next]].assign(record_data, location.length);
+      }
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace io
 }  // namespace tsl
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/tsl/lib/io/inputstream_interface.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
@@ -46,6 +48,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If async_buffering is true and buffer_size is non-zero, the next
+  // buffer_size bytes of the file are read on a background thread while the
+  // current ones are decoded. This doubles the memory used for buffering.
+  bool async_buffering = false;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -173,6 +180,59 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Interface to read the records of an uncompressed TFRecord file in any order,
+// using the index written by a `RecordWriter` with
+// `RecordWriterOptions::index_file` set. The index holds one entry of
+// `kIndexEntrySize` bytes per record:
+//  uint64    offset of the record in the file
+//  uint64    length of the record data
+//
+// Records and index entries are read with positioned reads, so reading a
+// record costs O(1) reads of the files regardless of its position.
+//
+// This class is thread safe, as long as the underlying files are.
+class IndexedRecordReader {
+ public:
+  static constexpr size_t kIndexEntrySize = 2 * sizeof(uint64);
+
+  // Records that are at most this many bytes apart are read together.
+  static constexpr uint64 kDefaultCoalesceGap = 64 << 10;  // 64KB
+
+  // Create a reader that will return records from "*file", using the index in
+  // "*index_file". Both must remain live while this reader is in use.
+  IndexedRecordReader(tsl::RandomAccessFile* file,
+                      tsl::RandomAccessFile* index_file,
+                      uint64 coalesce_gap = kDefaultCoalesceGap);
+
+  // Reads the "index"-th record of the file into *record. Returns OK on
+  // success, OUT_OF_RANGE if the index has no such record, or something else
+  // for an error.
+  Status ReadRecord(uint64 index, tstring* record);
+
+  // Reads the records at "indices" into *records, in the same order. Nearby
+  // records are read with a single read of the file, which makes reading a
+  // batch of records much cheaper than reading them one by one on high
+  // latency file systems.
+  Status ReadRecords(const std::vector<uint64>& indices,
+                     std::vector<tstring>* records);
+
+ private:
+  struct Location {
+    uint64 offset;
+    uint64 length;
+  };
+
+  // Reads the index entries of "indices", which must be sorted.
+  Status ReadLocations(const std::vector<uint64>& indices,
+                       std::vector<Location>* locations);
+
+  tsl::RandomAccessFile* const file_;
+  tsl::RandomAccessFile* const index_file_;
+  const uint64 coalesce_gap_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
 }  // namespace io
 }  // namespace tsl
 
@@ -162,6 +162,63 @@ TEST(RecordReaderWriterTest, TestBasics) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestAsyncBuffering) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_async_test";
+  std::vector<string> records;
+  for (int i = 0; i < 50; ++i) {
+    records.push_back(string(i * 7 % 23, 'a' + i % 26));
+  }
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = buf_size;
+    options.async_buffering = true;
+    io::SequentialRecordReader reader(read_file.get(), options);
+    tstring record;
+    for (const string& expected : records) {
+      TF_ASSERT_OK(reader.ReadRecord(&record));
+      EXPECT_EQ(expected, record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+  }
+
+  for (auto buf_size : BufferSizes()) {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = buf_size;
+    options.async_buffering = true;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    int num_skipped;
+    tstring record;
+    TF_ASSERT_OK(reader.SkipRecords(&offset, 30, &num_skipped));
+    EXPECT_EQ(30, num_skipped);
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[30], record);
+    // Reading backwards restarts the background reads.
+    uint64 first_offset = 0;
+    TF_ASSERT_OK(reader.ReadRecord(&first_offset, &record));
+    EXPECT_EQ(records[0], record);
+    io::RecordReader::Metadata md;
+    TF_ASSERT_OK(reader.GetMetadata(&md));
+    EXPECT_EQ(records.size(), md.stats.entries);
+    EXPECT_EQ(GetFileSize(fname), md.stats.file_size);
+  }
+}
+
 TEST(RecordReaderWriterTest, TestSkipBasic) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_skip_basic_test";
@@ -366,4 +423,57 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestIndexedReads) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  string index_fname = fname + ".index";
+  std::vector<string> records;
+  for (int i = 0; i < 100; ++i) {
+    records.push_back(strings::StrCat(i, string(i * 37, 'a' + i % 26)));
+  }
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    std::unique_ptr<WritableFile> index_file;
+    TF_CHECK_OK(env->NewWritableFile(index_fname, &index_file));
+    io::RecordWriterOptions options;
+    options.index_file = index_file.get();
+    io::RecordWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_EXPECT_OK(writer.WriteRecord(record));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+    TF_CHECK_OK(index_file->Close());
+  }
+  EXPECT_EQ(GetFileSize(index_fname),
+            records.size() * io::IndexedRecordReader::kIndexEntrySize);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+  std::unique_ptr<RandomAccessFile> index_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(index_fname, &index_file));
+
+  // Both without coalescing and with every record coalesced into one read.
+  for (uint64 coalesce_gap : {uint64{0}, uint64{1} << 20}) {
+    io::IndexedRecordReader reader(file.get(), index_file.get(),
+                                   coalesce_gap);
+    tstring record;
+    for (int i : {57, 0, 99, 3}) {
+      TF_ASSERT_OK(reader.ReadRecord(i, &record));
+      EXPECT_EQ(record, records[i]);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(100, &record)));
+
+    std::vector<uint64> indices = {42, 7, 8, 99, 7, 0, 43};
+    std::vector<tstring> batch;
+    TF_ASSERT_OK(reader.ReadRecords(indices, &batch));
+    ASSERT_EQ(batch.size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+      EXPECT_EQ(batch[i], records[indices[i]]);
+    }
+  }
+}
+
 }  // namespace tsl
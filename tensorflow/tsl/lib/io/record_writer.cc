@@ -85,6 +85,10 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Unspecified compression type :" << options.compression_type;
   }
 #endif
+  if (options.index_file != nullptr &&
+      options.compression_type != RecordWriterOptions::NONE) {
+    LOG(FATAL) << "A record index is only supported for uncompressed files.";
+  }
 }
 
 RecordWriter::~RecordWriter() {
@@ -112,7 +116,8 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AddToIndex(data.size());
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,10 +137,21 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AddToIndex(data.size());
 }
 #endif
 
+Status RecordWriter::AddToIndex(size_t n) {
+  const uint64 offset = offset_;
+  offset_ += kHeaderSize + n + kFooterSize;
+  if (options_.index_file == nullptr) return OkStatus();
+  char entry[kIndexEntrySize];
+  core::EncodeFixed64(entry, offset);
+  core::EncodeFixed64(entry + sizeof(uint64), n);
+  return options_.index_file->Append(StringPiece(entry, sizeof(entry)));
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
   if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
@@ -48,6 +48,13 @@ struct RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If set, the location of every record is appended to "*index_file", so
+  // that the records can be read back in any order with an
+  // `IndexedRecordReader`. See `IndexedRecordReader` for the format of the
+  // index. Only supported for uncompressed files. "*index_file" must be
+  // initially empty and must remain live while the writer is in use.
+  WritableFile* index_file = nullptr;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
@@ -65,6 +72,11 @@ class RecordWriter {
   static constexpr size_t kHeaderSize = sizeof(uint64) + sizeof(uint32);
   static constexpr size_t kFooterSize = sizeof(uint32);
 
+  // Format of a single entry of the record index, if any:
+  //  uint64    offset of the record in the file
+  //  uint64    length of the record data
+  static constexpr size_t kIndexEntrySize = 2 * sizeof(uint64);
+
   // Create a writer that will append data to "*dest".
   // "*dest" must be initially empty.
   // "*dest" must remain live while this Writer is in use.
@@ -111,8 +123,14 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends the index entry of a record of "n" bytes, if there is an index,
+  // and advances "offset_" past the record.
+  Status AddToIndex(size_t n);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // Offset of the next record in the uncompressed file.
+  uint64 offset_ = 0;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/table.h"
 
+#include <memory>
+
 #include "tensorflow/tsl/lib/io/block.h"
 #include "tensorflow/tsl/lib/io/cache.h"
+#include "tensorflow/tsl/lib/io/filter_block.h"
 #include "tensorflow/tsl/lib/io/format.h"
 #include "tensorflow/tsl/lib/io/table_options.h"
 #include "tensorflow/tsl/lib/io/two_level_iterator.h"
@@ -28,7 +31,10 @@ namespace tsl {
 namespace table {
 
 struct Table::Rep {
-  ~Rep() { delete index_block; }
+  ~Rep() {
+    delete index_block;
+    if (filter_data_heap_allocated) delete[] filter_data;
+  }
 
   Options options;
   Status status;
@@ -37,8 +43,20 @@ struct Table::Rep {
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
+
+  // The filters of the data blocks, if the table has them.
+  std::unique_ptr<FilterBlockReader> filter;
+  const char* filter_data = nullptr;
+  bool filter_data_heap_allocated = false;
 };
 
+namespace {
+
+// The size of a block without entries, which only holds its restart array.
+constexpr uint64 kEmptyBlockSize = 2 * sizeof(uint32);
+
+}  // namespace
+
 Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
                    Table** table) {
   *table = nullptr;
@@ -74,6 +92,7 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     rep->index_block = index_block;
     rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
     *table = new Table(rep);
+    (*table)->ReadFilter();
   } else {
     if (index_block) delete index_block;
   }
@@ -83,6 +102,32 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
 
 Table::~Table() { delete rep_; }
 
+void Table::ReadFilter() {
+  // Tables without meta blocks have an empty metaindex block, which isn't
+  // worth a read.
+  if (rep_->metaindex_handle.size() <= kEmptyBlockSize) return;
+
+  // Errors here don't prevent reading the table, only make it slower, so
+  // they are ignored.
+  BlockContents contents;
+  if (!ReadBlock(rep_->file, rep_->metaindex_handle, &contents).ok()) return;
+  Block meta_block(contents);
+  std::unique_ptr<Iterator> iter(meta_block.NewIterator());
+  iter->Seek(kBloomFilterBlockKey);
+  if (!iter->Valid() || iter->key() != StringPiece(kBloomFilterBlockKey)) {
+    return;
+  }
+
+  BlockHandle filter_handle;
+  StringPiece handle_value = iter->value();
+  if (!filter_handle.DecodeFrom(&handle_value).ok()) return;
+  BlockContents filter_contents;
+  if (!ReadBlock(rep_->file, filter_handle, &filter_contents).ok()) return;
+  rep_->filter_data = filter_contents.data.data();
+  rep_->filter_data_heap_allocated = filter_contents.heap_allocated;
+  rep_->filter.reset(new FilterBlockReader(filter_contents.data));
+}
+
 static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
@@ -163,7 +208,7 @@ Status Table::InternalGet(const StringPiece& k, void* arg,
   Status s;
   Iterator* iiter = rep_->index_block->NewIterator();
   iiter->Seek(k);
-  if (iiter->Valid()) {
+  if (iiter->Valid() && BlockMayContain(iiter->value(), k)) {
     Iterator* block_iter = BlockReader(this, iiter->value());
     block_iter->Seek(k);
     if (block_iter->Valid()) {
@@ -179,6 +224,23 @@ Status Table::InternalGet(const StringPiece& k, void* arg,
   return s;
 }
 
+bool Table::BlockMayContain(const StringPiece& index_value,
+                            const StringPiece& key) const {
+  if (rep_->filter == nullptr) return true;
+  BlockHandle handle;
+  StringPiece input = index_value;
+  if (!handle.DecodeFrom(&input).ok()) return true;
+  return rep_->filter->KeyMayMatch(handle.offset(), key);
+}
+
+bool Table::KeyMayMatch(const StringPiece& key) const {
+  if (rep_->filter == nullptr) return true;
+  std::unique_ptr<Iterator> index_iter(rep_->index_block->NewIterator());
+  index_iter->Seek(key);
+  if (!index_iter->Valid()) return !index_iter->status().ok();
+  return BlockMayContain(index_iter->value(), key);
+}
+
 uint64 Table::ApproximateOffsetOf(const StringPiece& key) const {
   Iterator* index_iter = rep_->index_block->NewIterator();
   index_iter->Seek(key);
@@ -61,6 +61,12 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Returns false if "key" is certainly not in the table, using the filters
+  // of the table (see Options::filter_bits_per_key).  Returns true if it may
+  // be, which is always the case for tables without filters.  Cheaper than a
+  // lookup, as it never reads a data block.
+  bool KeyMayMatch(const StringPiece& key) const;
+
  private:
   struct Rep;
   Rep* rep_;
@@ -68,6 +74,14 @@ class Table {
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const StringPiece&);
 
+  // Reads the filters of the data blocks, if the table has them.
+  void ReadFilter();
+
+  // Returns false if the filter of the data block with the encoded handle
+  // "index_value" says that "key" is not in it.
+  bool BlockMayContain(const StringPiece& index_value,
+                       const StringPiece& key) const;
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
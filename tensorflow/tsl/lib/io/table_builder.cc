@@ -17,8 +17,11 @@ limitations under the License.
 
 #include <assert.h>
 
+#include <memory>
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/block_builder.h"
+#include "tensorflow/tsl/lib/io/filter_block.h"
 #include "tensorflow/tsl/lib/io/format.h"
 #include "tensorflow/tsl/lib/io/table_options.h"
 #include "tensorflow/tsl/platform/coding.h"
@@ -76,6 +79,7 @@ struct TableBuilder::Rep {
   Status status;
   BlockBuilder data_block;
   BlockBuilder index_block;
+  std::unique_ptr<FilterBlockBuilder> filter_block;  // Null if no filters.
   string last_key;
   int64_t num_entries;
   bool closed;  // Either Finish() or Abandon() has been called.
@@ -105,6 +109,9 @@ struct TableBuilder::Rep {
         closed(false),
         pending_index_entry(false) {
     index_block_options.block_restart_interval = 1;
+    if (opt.filter_bits_per_key > 0) {
+      filter_block.reset(new FilterBlockBuilder(opt.filter_bits_per_key));
+    }
   }
 };
 
@@ -143,6 +150,7 @@ void TableBuilder::Add(const StringPiece& key, const StringPiece& value) {
   r->last_key.assign(key.data(), key.size());
   r->num_entries++;
   r->data_block.Add(key, value);
+  if (r->filter_block != nullptr) r->filter_block->AddKey(key);
 
   const size_t estimated_block_size = r->data_block.CurrentSizeEstimate();
   if (estimated_block_size >= r->options.block_size) {
@@ -159,6 +167,9 @@ void TableBuilder::Flush() {
   WriteBlock(&r->data_block, &r->pending_handle);
   if (ok()) {
     r->pending_index_entry = true;
+    if (r->filter_block != nullptr) {
+      r->filter_block->FinishBlock(r->pending_handle.offset());
+    }
     // We don't flush the underlying file as that can be slow.
   }
 }
@@ -226,11 +237,22 @@ Status TableBuilder::Finish() {
   assert(!r->closed);
   r->closed = true;
 
-  BlockHandle metaindex_block_handle, index_block_handle;
+  BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle;
+
+  // Write filter block
+  if (ok() && r->filter_block != nullptr) {
+    WriteRawBlock(r->filter_block->Finish(), kNoCompression,
+                  &filter_block_handle);
+  }
 
   // Write metaindex block
   if (ok()) {
     BlockBuilder meta_index_block(&r->options);
+    if (r->filter_block != nullptr) {
+      string handle_encoding;
+      filter_block_handle.EncodeTo(&handle_encoding);
+      meta_index_block.Add(kBloomFilterBlockKey, handle_encoding);
+    }
     // TODO(postrelease): Add stats and other meta blocks
     WriteBlock(&meta_index_block, &metaindex_block_handle);
   }
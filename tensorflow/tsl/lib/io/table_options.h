@@ -68,6 +68,13 @@ struct Options {
 
   // If non-null, use the specified cache for blocks.
   Cache* block_cache = nullptr;
+
+  // If positive, the builder writes a bloom filter of the keys of each data
+  // block, with this many bits per key, so that lookups of keys that aren't in
+  // the table can usually skip reading a data block.  10 bits per key give a
+  // false positive rate of about 1%.  Readers use the filters of a table
+  // whatever this option is set to.
+  int filter_bits_per_key = 0;
 };
 
 }  // namespace table
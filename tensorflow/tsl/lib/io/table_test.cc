@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -245,6 +246,10 @@ class TableConstructor : public Constructor {
     return table_->ApproximateOffsetOf(key);
   }
 
+  bool KeyMayMatch(const StringPiece& key) const {
+    return table_->KeyMayMatch(key);
+  }
+
   uint64 BytesRead() const { return source_->BytesRead(); }
 
  private:
@@ -633,5 +638,56 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+static string FilterTestKey(int i) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "k%04d", i);
+  return buf;
+}
+
+TEST(TableTest, FilterSkipsAbsentKeys) {
+  TableConstructor c;
+  for (int i = 0; i < 1000; ++i) {
+    c.Add(FilterTestKey(2 * i), "value");
+  }
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  options.filter_bits_per_key = 10;
+  c.Finish(options, &keys, &kvmap);
+
+  const uint64 bytes_read = c.BytesRead();
+  int num_false_positives = 0;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(c.KeyMayMatch(FilterTestKey(2 * i)));
+    if (c.KeyMayMatch(FilterTestKey(2 * i + 1))) {
+      ++num_false_positives;
+    }
+  }
+  // About 1% of false positives with 10 bits per key.
+  EXPECT_LT(num_false_positives, 50);
+  EXPECT_FALSE(c.KeyMayMatch("z"));
+  // The filters are read when the table is opened.
+  EXPECT_EQ(c.BytesRead(), bytes_read);
+
+  std::unique_ptr<Iterator> iter(c.NewIterator());
+  iter->Seek("k1000");
+  ASSERT_TRUE(iter->Valid());
+  EXPECT_EQ(iter->key(), "k1000");
+}
+
+TEST(TableTest, KeyMayMatchWithoutFilter) {
+  TableConstructor c;
+  c.Add("k01", "value");
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.compression = kNoCompression;
+  c.Finish(options, &keys, &kvmap);
+  EXPECT_TRUE(c.KeyMayMatch("k01"));
+  EXPECT_TRUE(c.KeyMayMatch("k02"));
+}
+
 }  // namespace table
 }  // namespace tsl
@@ -112,6 +112,9 @@ class Sampler {
 
 #include <float.h>
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <tuple>
@@ -143,18 +146,29 @@ using tensorflow::HistogramProto;
 class SamplerCell {
  public:
   explicit SamplerCell(const std::vector<double>& bucket_limits)
-      : histogram_(bucket_limits) {}
+      : bucket_limits_(bucket_limits),
+        buckets_(new std::atomic<int64_t>[bucket_limits.size()]()),
+        min_(bucket_limits.back()) {}
 
   ~SamplerCell() {}
 
-  // Atomically adds a sample.
+  // Adds a sample. Lock-free, but the fields of the histogram are updated
+  // separately, so a concurrent value() may only count the sample in some of
+  // them.
   void Add(double sample);
 
   // Returns the current histogram value as a proto.
   HistogramProto value() const;
 
  private:
-  histogram::ThreadSafeHistogram histogram_;
+  const std::vector<double> bucket_limits_;
+  // The number of samples of each bucket, like in histogram::Histogram.
+  std::unique_ptr<std::atomic<int64_t>[]> buckets_;
+  std::atomic<int64_t> num_{0};
+  std::atomic<double> min_;
+  std::atomic<double> max_{-DBL_MAX};
+  std::atomic<double> sum_{0.0};
+  std::atomic<double> sum_squares_{0.0};
 
   TF_DISALLOW_COPY_AND_ASSIGN(SamplerCell);
 };
@@ -282,11 +296,56 @@ class Sampler {
 //  Implementation details follow. API readers may skip.
 ////
 
-inline void SamplerCell::Add(const double sample) { histogram_.Add(sample); }
+namespace internal {
+
+// Atomically adds `value` to `sum`.
+inline void AtomicAdd(std::atomic<double>* sum, double value) {
+  double current = sum->load(std::memory_order_relaxed);
+  while (!sum->compare_exchange_weak(current, current + value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+// Atomically sets `extremum` to `value` if `value` is before it in the order
+// of `Compare`.
+template <typename Compare>
+inline void AtomicUpdateExtremum(std::atomic<double>* extremum, double value,
+                                 Compare compare) {
+  double current = extremum->load(std::memory_order_relaxed);
+  while (compare(value, current) &&
+         !extremum->compare_exchange_weak(current, value,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace internal
+
+inline void SamplerCell::Add(const double sample) {
+  const int bucket =
+      std::upper_bound(bucket_limits_.begin(), bucket_limits_.end(), sample) -
+      bucket_limits_.begin();
+  // Samples above the last limit go to the last bucket.
+  buckets_[std::min<size_t>(bucket, bucket_limits_.size() - 1)].fetch_add(
+      1, std::memory_order_relaxed);
+  internal::AtomicUpdateExtremum(&min_, sample, std::less<double>());
+  internal::AtomicUpdateExtremum(&max_, sample, std::greater<double>());
+  num_.fetch_add(1, std::memory_order_relaxed);
+  internal::AtomicAdd(&sum_, sample);
+  internal::AtomicAdd(&sum_squares_, sample * sample);
+}
 
 inline HistogramProto SamplerCell::value() const {
+  // Like histogram::Histogram::EncodeToProto() with preserve_zero_buckets.
   HistogramProto pb;
-  histogram_.EncodeToProto(&pb, true /* preserve_zero_buckets */);
+  pb.set_min(min_.load(std::memory_order_relaxed));
+  pb.set_max(max_.load(std::memory_order_relaxed));
+  pb.set_num(num_.load(std::memory_order_relaxed));
+  pb.set_sum(sum_.load(std::memory_order_relaxed));
+  pb.set_sum_squares(sum_squares_.load(std::memory_order_relaxed));
+  for (size_t i = 0; i < bucket_limits_.size(); ++i) {
+    pb.add_bucket_limit(bucket_limits_[i]);
+    pb.add_bucket(buckets_[i].load(std::memory_order_relaxed));
+  }
   return pb;
 }
 
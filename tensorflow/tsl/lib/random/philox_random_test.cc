@@ -69,6 +69,34 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that Generate() produces the same stream as repeated calls
+// to operator(), including for counts that are not a multiple of the batch
+// size and counters that carry into the higher words.
+TEST(PhiloxRandomTest, GenerateMatchesOperatorTest) {
+  const uint64 test_seed = GetTestSeed();
+  for (uint64 skip : {uint64{0}, uint64{0xfffffffa}, ~uint64{0} - 3}) {
+    for (int count : {1, 15, 16, 17, 100}) {
+      PhiloxRandom gen1(test_seed, test_seed ^ 0x12345678);
+      gen1.Skip(skip);
+      PhiloxRandom gen2 = gen1;
+      std::vector<PhiloxRandom::ResultType> generated(count);
+      gen1.Generate(generated.data(), count);
+      for (int i = 0; i < count; ++i) {
+        const PhiloxRandom::ResultType expected = gen2();
+        for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+          ASSERT_EQ(generated[i][j], expected[j]) << i << " " << j;
+        }
+      }
+      // Both generators continue from the same counter.
+      const PhiloxRandom::ResultType next1 = gen1();
+      const PhiloxRandom::ResultType next2 = gen2();
+      for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(next1[j], next2[j]);
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
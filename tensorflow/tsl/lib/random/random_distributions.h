@@ -123,8 +123,11 @@ class UniformDistribution<Generator, float> {
   typedef float ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Converts a single output of the generator to kResultElementCount values.
+  PHILOX_DEVICE_INLINE
+  static ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint32ToFloat(sample[i]);
@@ -147,8 +150,11 @@ class UniformDistribution<Generator, double> {
   typedef double ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Converts a single output of the generator to kResultElementCount values.
+  PHILOX_DEVICE_INLINE
+  static ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; ++i) {
       result[i] = Uint64ToDouble(sample[2 * i], sample[2 * i + 1]);
@@ -449,8 +455,11 @@ class NormalDistribution<Generator, float> {
   typedef float ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Converts a single output of the generator to kResultElementCount values.
+  PHILOX_DEVICE_INLINE
+  static ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       BoxMullerFloat(sample[i], sample[i + 1], &result[i], &result[i + 1]);
@@ -473,8 +482,11 @@ class NormalDistribution<Generator, double> {
   typedef double ResultElementType;
 
   PHILOX_DEVICE_INLINE
-  ResultType operator()(Generator* gen) {
-    typename Generator::ResultType sample = (*gen)();
+  ResultType operator()(Generator* gen) { return FromSample((*gen)()); }
+
+  // Converts a single output of the generator to kResultElementCount values.
+  PHILOX_DEVICE_INLINE
+  static ResultType FromSample(const typename Generator::ResultType& sample) {
     ResultType result;
     for (int i = 0; i < kResultElementCount; i += 2) {
       const int i2 = 2 * i;
@@ -56,6 +56,14 @@ class FileBlockCacheStatsInterface {
   /// RecordBlockLoadRequest is called to record the size of a missed block.
   virtual void RecordCacheMissBlockSize(size_t bytes_transferred) = 0;
 
+  /// RecordCachePrefetchBlockSize is called to record the size of a block
+  /// fetched by readahead, before any read asked for it.
+  virtual void RecordCachePrefetchBlockSize(size_t bytes_transferred) {}
+
+  /// RecordCachePrefetchWasteBlockSize is called to record the size of a
+  /// prefetched block that was evicted without ever being read.
+  virtual void RecordCachePrefetchWasteBlockSize(size_t bytes_transferred) {}
+
   virtual ~FileBlockCacheStatsInterface() = default;
 };
 
@@ -29,6 +29,7 @@ limitations under the License.
 #include <cstring>
 #include <fstream>
 #include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -162,6 +163,11 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The ranges read with GcsRandomAccessFile::ReadV() that are less than 256KB
+// apart are merged into a single request, of up to 16MB.
+constexpr uint64 kReadVMaxGap = 256 * 1024;
+constexpr uint64 kReadVMaxMergedSize = 16 * 1024 * 1024;
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return OkStatus();
@@ -331,7 +337,78 @@ class GcsRandomAccessFile : public RandomAccessFile {
     return read_fn_(filename_, offset, n, result, scratch);
   }
 
+  /// Merges the ranges that are close to each other into a single read, to
+  /// save the latency of the requests. Thread safe.
+  Status ReadV(absl::Span<ReadRange> ranges) const override {
+    std::vector<ReadRange*> sorted_ranges;
+    sorted_ranges.reserve(ranges.size());
+    for (ReadRange& range : ranges) {
+      sorted_ranges.push_back(&range);
+    }
+    std::sort(sorted_ranges.begin(), sorted_ranges.end(),
+              [](const ReadRange* a, const ReadRange* b) {
+                return a->offset < b->offset;
+              });
+
+    Status status;
+    for (size_t begin = 0; begin < sorted_ranges.size();) {
+      const uint64 start = sorted_ranges[begin]->offset;
+      uint64 end = start + sorted_ranges[begin]->n;
+      size_t last = begin + 1;
+      for (; last < sorted_ranges.size(); ++last) {
+        const ReadRange& next = *sorted_ranges[last];
+        const uint64 next_end = std::max(end, next.offset + next.n);
+        if (next.offset > end + kReadVMaxGap ||
+            next_end - start > kReadVMaxMergedSize) {
+          break;
+        }
+        end = next_end;
+      }
+      ReadMerged(start, end - start,
+                 absl::MakeSpan(sorted_ranges).subspan(begin, last - begin));
+      for (size_t i = begin; i < last; ++i) {
+        status.Update(sorted_ranges[i]->status);
+      }
+      begin = last;
+    }
+    return status;
+  }
+
  private:
+  /// Reads `n` bytes from `offset`, which cover all of `ranges`, and copies
+  /// them to the ranges.
+  void ReadMerged(uint64 offset, size_t n,
+                  absl::Span<ReadRange* const> ranges) const {
+    if (ranges.size() == 1) {
+      ReadRange& range = *ranges[0];
+      range.status = Read(range.offset, range.n, &range.result, range.scratch);
+      return;
+    }
+    std::unique_ptr<char[]> buffer(new char[n]);
+    StringPiece data;
+    const Status s = read_fn_(filename_, offset, n, &data, buffer.get());
+    for (ReadRange* range : ranges) {
+      const uint64 range_start = range->offset - offset;
+      const size_t copy_size =
+          range_start < data.size()
+              ? std::min<size_t>(range->n, data.size() - range_start)
+              : 0;
+      if (copy_size > 0) {
+        memcpy(range->scratch, data.data() + range_start, copy_size);
+      }
+      range->result = StringPiece(range->scratch, copy_size);
+      if (copy_size == range->n) {
+        range->status = OkStatus();
+      } else if (s.ok() || errors::IsOutOfRange(s)) {
+        range->status = errors::OutOfRange("EOF reached, ", copy_size,
+                                           " bytes were read out of ",
+                                           range->n, " bytes requested.");
+      } else {
+        range->status = s;
+      }
+    }
+  }
+
   /// The filename of this file.
   const string filename_;
   /// The implementation of the read operation (provided by the GCSFileSystem).
@@ -848,12 +925,22 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kReadaheadBlocks, strings::safe_strtou64, &value)) {
+    readahead_blocks_ = value;
+  }
+
+  if (GetEnvVar(kMaxParallelFetches, strings::safe_strtou64, &value)) {
+    max_parallel_fetches_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "readahead blocks = " << readahead_blocks_ << " ; "
+          << "max parallel fetches = " << max_parallel_fetches_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -1083,7 +1170,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), readahead_blocks_, max_parallel_fetches_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -62,6 +62,15 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets the number of blocks prefetched in the
+// background past a sequential read of a file. 0 (the default) disables
+// readahead.
+constexpr char kReadaheadBlocks[] = "GCS_READ_CACHE_READAHEAD_BLOCKS";
+constexpr size_t kDefaultReadaheadBlocks = 0;
+// The environment variable that sets the number of range requests a single
+// read spanning several blocks can issue in parallel.
+constexpr char kMaxParallelFetches[] = "GCS_READ_CACHE_MAX_PARALLEL_FETCHES";
+constexpr size_t kDefaultMaxParallelFetches = 1;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -415,6 +424,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The readahead and parallel fetch settings of file_block_cache_.
+  size_t readahead_blocks_ = kDefaultReadaheadBlocks;
+  size_t max_parallel_fetches_ = kDefaultMaxParallelFetches;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -105,6 +105,57 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_NoBlockCache) {
   EXPECT_EQ("6789", result);
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_ReadVMergesCloseRanges) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-7\n"
+           "Timeouts: 5 1 20\n",
+           "01234567"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 1000000-1000003\n"
+           "Timeouts: 5 1 20\n",
+           "ab")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  // The first two ranges are read with a single request.
+  char scratch[3][4];
+  RandomAccessFile::ReadRange ranges[3];
+  ranges[0].offset = 6;
+  ranges[0].n = 2;
+  ranges[0].scratch = scratch[0];
+  ranges[1].offset = 1000000;
+  ranges[1].n = 4;
+  ranges[1].scratch = scratch[1];
+  ranges[2].offset = 0;
+  ranges[2].n = 3;
+  ranges[2].scratch = scratch[2];
+  EXPECT_TRUE(errors::IsOutOfRange(file->ReadV(ranges)));
+
+  TF_EXPECT_OK(ranges[0].status);
+  EXPECT_EQ("67", ranges[0].result);
+  EXPECT_TRUE(errors::IsOutOfRange(ranges[1].status));
+  EXPECT_EQ("ab", ranges[1].result);
+  TF_EXPECT_OK(ranges[2].status);
+  EXPECT_EQ("012", ranges[2].result);
+}
+
 TEST(GcsFileSystemTest, NewRandomAccessFile_Buffered) {
   std::vector<HttpRequest*> requests({
       new FakeHttpRequest(
@@ -19,9 +19,17 @@ limitations under the License.
 #include <memory>
 
 #include "absl/cleanup/cleanup.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/env.h"
 
 namespace tsl {
+namespace {
+
+// The maximum number of files whose access pattern is tracked for readahead.
+// The access patterns are all forgotten once there are more.
+constexpr size_t kMaxReadStates = 1024;
+
+}  // namespace
 
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
@@ -41,6 +49,7 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
+      entry->second->accessed = true;
       return entry->second;
     } else {
       // Remove the stale block and continue.
@@ -48,9 +57,15 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return InsertBlock(key, /*prefetched=*/false);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::InsertBlock(
+    const Key& key, bool prefetched) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
+  new_entry->prefetched = prefetched;
   lru_list_.push_front(key);
   lra_list_.push_front(key);
   new_entry->lru_iterator = lru_list_.begin();
@@ -137,7 +152,11 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
         status.Update(block_fetcher_(key.first, key.second, block_size_,
                                      block->data.data(), &bytes_transferred));
         if (cache_stats_ != nullptr) {
-          cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+          if (block->prefetched) {
+            cache_stats_->RecordCachePrefetchBlockSize(bytes_transferred);
+          } else {
+            cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+          }
         }
         block->mu.lock();  // Reacquire the lock immediately afterwards
         if (status.ok()) {
@@ -175,7 +194,12 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   }
   if (!IsCacheEnabled() || (n > max_bytes_)) {
     // The cache is effectively disabled, so we pass the read through to the
-    // fetcher without breaking it up into blocks.
+    // fetcher without breaking it up into blocks, unless it is large enough to
+    // be split into parallel requests.
+    if (fetch_pool_ != nullptr && max_parallel_fetches_ > 1 &&
+        n > block_size_) {
+      return ParallelFetch(filename, offset, n, buffer, bytes_transferred);
+    }
     return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
   }
   // Calculate the block-aligned start and end of the read.
@@ -184,15 +208,49 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  if (readahead_blocks_ > 0) {
+    MaybeReadahead(filename, offset, n, finish);
+  }
+  // When the read spans several blocks, look them all up first and fetch the
+  // missing ones in parallel. The loop below then waits for each of them.
+  std::vector<std::shared_ptr<Block>> blocks;
+  if (max_parallel_fetches_ > 1 && finish - start > block_size_) {
+    for (size_t pos = start; pos < finish; pos += block_size_) {
+      blocks.push_back(Lookup(std::make_pair(filename, pos)));
+    }
+    // The first block is fetched by this thread in the loop below.
+    for (size_t i = 1; i < blocks.size(); ++i) {
+      fetch_pool_->Schedule(
+          [this, key = std::make_pair(filename, start + i * block_size_),
+           block = blocks[i]] {
+            // Errors are returned by the MaybeFetch() of the loop below, which
+            // retries the failed blocks.
+            MaybeFetch(key, block).IgnoreError();
+          });
+    }
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
     // Look up the block, fetching and inserting it if necessary, and update the
     // LRU iterator for the key and block.
-    std::shared_ptr<Block> block = Lookup(key);
+    std::shared_ptr<Block> block =
+        blocks.empty() ? Lookup(key) : blocks[(pos - start) / block_size_];
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
+    if (!blocks.empty() && block->data.size() < block_size_) {
+      // The block ends the file, so the blocks fetched in parallel past it
+      // are empty. Drop them before they make the cache look inconsistent.
+      mutex_lock lock(mu_);
+      for (size_t i = (pos - start) / block_size_ + 1; i < blocks.size(); ++i) {
+        auto entry = block_map_.find(
+            std::make_pair(filename, start + i * block_size_));
+        if (entry != block_map_.end() && entry->second == blocks[i]) {
+          RemoveBlock(entry);
+        }
+      }
+    }
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
     const auto& data = block->data;
@@ -229,6 +287,120 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   return OkStatus();
 }
 
+void RamFileBlockCache::MaybeReadahead(const string& filename, size_t offset,
+                                       size_t n, size_t finish) {
+  size_t readahead_start;
+  size_t readahead_finish = finish + readahead_blocks_ * block_size_;
+  {
+    mutex_lock lock(mu_);
+    auto it = read_states_.find(filename);
+    if (it == read_states_.end()) {
+      if (read_states_.size() >= kMaxReadStates) {
+        read_states_.clear();
+      }
+      read_states_[filename].next_offset = offset + n;
+      return;
+    }
+    ReadState& state = it->second;
+    const bool sequential = state.next_offset == offset;
+    state.next_offset = offset + n;
+    if (!sequential) {
+      return;
+    }
+    // Only prefetch the blocks past those of the previous readahead.
+    readahead_start = std::max(finish, state.readahead_offset);
+    if (readahead_start >= readahead_finish) {
+      return;
+    }
+    state.readahead_offset = readahead_finish;
+  }
+  fetch_pool_->Schedule([this, filename, readahead_start, readahead_finish] {
+    Readahead(filename, readahead_start, readahead_finish);
+  });
+}
+
+void RamFileBlockCache::Readahead(const string& filename, size_t start,
+                                  size_t finish) {
+  // Only fetch a block once the block before it is known to be a full block:
+  // the cache would consider an empty block fetched past the end of the file
+  // inconsistent with the partial block ending it.
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    Key previous_key = std::make_pair(filename, pos - block_size_);
+    std::shared_ptr<Block> previous_block;
+    {
+      mutex_lock lock(mu_);
+      auto entry = block_map_.find(previous_key);
+      if (entry == block_map_.end()) {
+        // The blocks this readahead follows have been evicted already.
+        return;
+      }
+      previous_block = entry->second;
+    }
+    // Wait for the previous block, which may still be fetched by a read or by
+    // the previous readahead.
+    if (!MaybeFetch(previous_key, previous_block).ok() ||
+        previous_block->data.size() < block_size_) {
+      // The file ends before `pos`, or its size can't be told.
+      return;
+    }
+    Key key = std::make_pair(filename, pos);
+    std::shared_ptr<Block> block;
+    {
+      mutex_lock lock(mu_);
+      if (block_map_.find(key) != block_map_.end()) {
+        // The block is already cached, or being fetched by a read.
+        continue;
+      }
+      block = InsertBlock(key, /*prefetched=*/true);
+    }
+    Status status = MaybeFetch(key, block);
+    if (status.ok()) {
+      status = UpdateLRU(key, block);
+    }
+    if (!status.ok()) {
+      VLOG(1) << "Readahead of " << filename << " at position " << pos
+              << " failed: " << status;
+      return;
+    }
+  }
+}
+
+Status RamFileBlockCache::ParallelFetch(const string& filename, size_t offset,
+                                        size_t n, char* buffer,
+                                        size_t* bytes_transferred) {
+  const size_t num_chunks = (n + block_size_ - 1) / block_size_;
+  std::vector<Status> statuses(num_chunks);
+  std::vector<size_t> chunk_bytes_transferred(num_chunks, 0);
+  auto fetch_chunk = [&](size_t i) {
+    const size_t chunk_offset = i * block_size_;
+    statuses[i] = block_fetcher_(filename, offset + chunk_offset,
+                                 std::min(block_size_, n - chunk_offset),
+                                 buffer + chunk_offset,
+                                 &chunk_bytes_transferred[i]);
+  };
+  BlockingCounter counter(num_chunks - 1);
+  for (size_t i = 1; i < num_chunks; ++i) {
+    fetch_pool_->Schedule([&fetch_chunk, &counter, i] {
+      fetch_chunk(i);
+      counter.DecrementCount();
+    });
+  }
+  fetch_chunk(0);
+  counter.Wait();
+  // Stitch the chunks together, stopping at the first partial chunk, which
+  // signals EOF.
+  *bytes_transferred = 0;
+  for (size_t i = 0; i < num_chunks; ++i) {
+    TF_RETURN_IF_ERROR(statuses[i]);
+    *bytes_transferred += chunk_bytes_transferred[i];
+    if (chunk_bytes_transferred[i] <
+        std::min(block_size_, n - i * block_size_)) {
+      break;
+    }
+  }
+  return OkStatus();
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
@@ -273,6 +445,7 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  read_states_.clear();
   cache_size_ = 0;
 }
 
@@ -282,6 +455,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  read_states_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -295,6 +469,11 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
+  if (cache_stats_ != nullptr && entry->second->prefetched &&
+      !entry->second->accessed) {
+    cache_stats_->RecordCachePrefetchWasteBlockSize(
+        entry->second->data.size());
+  }
   lru_list_.erase(entry->second->lru_iterator);
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.capacity();
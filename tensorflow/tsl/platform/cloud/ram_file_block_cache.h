@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -50,22 +52,38 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// `readahead_blocks` is the number of blocks fetched in the background
+  /// past the end of a read that continues the previous read of the same
+  /// file. `max_parallel_fetches` is the number of concurrent calls to
+  /// `block_fetcher` a single read spanning several blocks can issue.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t readahead_blocks = 0,
+                    size_t max_parallel_fetches = 1)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
+        readahead_blocks_(readahead_blocks),
+        max_parallel_fetches_(std::max<size_t>(max_parallel_fetches, 1)),
         block_fetcher_(block_fetcher),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (block_size_ > 0 &&
+        (readahead_blocks_ > 0 || max_parallel_fetches_ > 1)) {
+      fetch_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_fetch_FBC", static_cast<int>(max_parallel_fetches_));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying fetch_pool_ will block until the pending fetches, which use
+    // the other members, return.
+    fetch_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -109,6 +127,8 @@ class RamFileBlockCache : public FileBlockCache {
   size_t block_size() const override { return block_size_; }
   size_t max_bytes() const override { return max_bytes_; }
   uint64 max_staleness() const override { return max_staleness_; }
+  size_t readahead_blocks() const { return readahead_blocks_; }
+  size_t max_parallel_fetches() const { return max_parallel_fetches_; }
 
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
@@ -127,6 +147,10 @@ class RamFileBlockCache : public FileBlockCache {
   const size_t max_bytes_;
   /// The maximum staleness of any block in the LRU cache, in seconds.
   const uint64 max_staleness_;
+  /// The number of blocks to prefetch past a sequential read.
+  const size_t readahead_blocks_;
+  /// The maximum number of concurrent fetches issued by a single read.
+  const size_t max_parallel_fetches_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
@@ -158,10 +182,12 @@ class RamFileBlockCache : public FileBlockCache {
   /// was cached, a coordination lock, and state & condition variables.
   ///
   /// Thread safety:
-  /// The iterator and timestamp fields should only be accessed while holding
-  /// the block-cache-wide mu_ instance variable. The state variable should only
-  /// be accessed while holding the Block's mu lock. The data vector should only
-  /// be accessed after state == FINISHED, and it should never be modified.
+  /// The iterator, timestamp and accessed fields should only be accessed while
+  /// holding the block-cache-wide mu_ instance variable. The prefetched field
+  /// is set before the block is inserted into the cache and never modified.
+  /// The state variable should only be accessed while holding the Block's mu
+  /// lock. The data vector should only be accessed after state == FINISHED,
+  /// and it should never be modified.
   ///
   /// In order to prevent deadlocks, never grab the block-cache-wide mu_ lock
   /// AFTER grabbing any block's mu lock. It is safe to grab mu without locking
@@ -175,6 +201,10 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was inserted by readahead rather than by a read.
+    bool prefetched = false;
+    /// Whether a read has looked up the prefetched block.
+    bool accessed = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -188,6 +218,14 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The access pattern of a file, used to detect sequential reads.
+  struct ReadState {
+    /// The offset right past the end of the last read of the file.
+    size_t next_offset = 0;
+    /// The offset up to which blocks of the file have been prefetched.
+    size_t readahead_offset = 0;
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
@@ -197,6 +235,26 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new empty block for `key` into the block cache.
+  std::shared_ptr<Block> InsertBlock(const Key& key, bool prefetched)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Record the read of [offset, offset + n) of `filename` and, if it
+  /// continues the previous read of the file, schedule the readahead of the
+  /// blocks following `finish`.
+  void MaybeReadahead(const string& filename, size_t offset, size_t n,
+                      size_t finish) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetch the blocks of `filename` in [start, finish) that are not cached
+  /// yet, in order, stopping at the end of the file.
+  void Readahead(const string& filename, size_t start, size_t finish)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Read `n` bytes of `filename` at `offset` straight from the fetcher,
+  /// splitting the read into block-sized requests issued in parallel.
+  Status ParallelFetch(const string& filename, size_t offset, size_t n,
+                       char* buffer, size_t* bytes_transferred);
+
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
@@ -221,6 +279,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads running readahead and parallel fetches, if either is on.
+  std::unique_ptr<thread::ThreadPool> fetch_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -243,6 +304,9 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The access pattern of the recently read files, if readahead is on.
+  std::map<string, ReadState> read_states_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tsl
@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <vector>
 
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/cloud/now_seconds_env.h"
 #include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/notification.h"
 #include "tensorflow/tsl/platform/test.h"
 
@@ -566,5 +570,222 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+// A fetcher for a file of `file_size` bytes, each byte of which holds its
+// offset modulo 256. It records the offset of every fetch.
+class FakeFile {
+ public:
+  explicit FakeFile(size_t file_size) : file_size_(file_size) {}
+
+  RamFileBlockCache::BlockFetcher fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      {
+        mutex_lock l(mu_);
+        offsets_.push_back(offset);
+      }
+      *bytes_transferred = 0;
+      for (size_t i = offset; i < std::min(offset + n, file_size_); ++i) {
+        buffer[(*bytes_transferred)++] = static_cast<char>(i % 256);
+      }
+      return OkStatus();
+    };
+  }
+
+  std::vector<size_t> offsets() {
+    mutex_lock l(mu_);
+    return offsets_;
+  }
+
+  std::vector<char> Contents(size_t offset, size_t n) const {
+    std::vector<char> contents;
+    for (size_t i = offset; i < std::min(offset + n, file_size_); ++i) {
+      contents.push_back(static_cast<char>(i % 256));
+    }
+    return contents;
+  }
+
+ private:
+  const size_t file_size_;
+  mutex mu_;
+  std::vector<size_t> offsets_ TF_GUARDED_BY(mu_);
+};
+
+// Waits up to 10 seconds for the background fetches to fill `cache` up to
+// `size` bytes.
+bool WaitForCacheSize(const RamFileBlockCache& cache, size_t size) {
+  for (int i = 0; i < 1000; ++i) {
+    if (cache.CacheSize() >= size) return true;
+    Env::Default()->SleepForMicroseconds(10000);
+  }
+  return false;
+}
+
+class FakeFileBlockCacheStats : public FileBlockCacheStatsInterface {
+ public:
+  void Configure(const FileBlockCache* block_cache) override {}
+  void RecordCacheHitBlockSize(size_t bytes_transferred) override {
+    hit_bytes_ += bytes_transferred;
+  }
+  void RecordCacheMissBlockSize(size_t bytes_transferred) override {
+    miss_bytes_ += bytes_transferred;
+  }
+  void RecordCachePrefetchBlockSize(size_t bytes_transferred) override {
+    prefetch_bytes_ += bytes_transferred;
+  }
+  void RecordCachePrefetchWasteBlockSize(size_t bytes_transferred) override {
+    prefetch_waste_bytes_ += bytes_transferred;
+  }
+
+  std::atomic<size_t> hit_bytes_{0};
+  std::atomic<size_t> miss_bytes_{0};
+  std::atomic<size_t> prefetch_bytes_{0};
+  std::atomic<size_t> prefetch_waste_bytes_{0};
+};
+
+TEST(RamFileBlockCacheTest, ReadaheadOnSequentialReads) {
+  const size_t block_size = 8;
+  FakeFile file(64);
+  FakeFileBlockCacheStats stats;
+  RamFileBlockCache cache(block_size, 64, 0, file.fetcher(), Env::Default(),
+                          /*readahead_blocks=*/2);
+  cache.SetStats(&stats);
+  std::vector<char> out;
+  // The first read of the file does not trigger readahead.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 4, &out));
+  EXPECT_EQ(out, file.Contents(0, 4));
+  EXPECT_EQ(file.offsets(), std::vector<size_t>({0}));
+  // The second read continues the first, so the two following blocks are
+  // fetched in the background.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 4, &out));
+  EXPECT_EQ(out, file.Contents(4, 4));
+  ASSERT_TRUE(WaitForCacheSize(cache, 24));
+  EXPECT_EQ(file.offsets(), std::vector<size_t>({0, 8, 16}));
+  // Reading the prefetched block does not fetch it again, and moves the
+  // readahead window forward by one block.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 8, 8, &out));
+  EXPECT_EQ(out, file.Contents(8, 8));
+  ASSERT_TRUE(WaitForCacheSize(cache, 32));
+  EXPECT_EQ(file.offsets(), std::vector<size_t>({0, 8, 16, 24}));
+  EXPECT_EQ(stats.miss_bytes_, 8);
+  EXPECT_EQ(stats.prefetch_bytes_, 24);
+}
+
+TEST(RamFileBlockCacheTest, NoReadaheadOnRandomReads) {
+  const size_t block_size = 8;
+  FakeFile file(64);
+  RamFileBlockCache cache(block_size, 64, 0, file.fetcher(), Env::Default(),
+                          /*readahead_blocks=*/2);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 40, 4, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 4, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 24, 4, &out));
+  // Give a readahead, if any, the time to run.
+  Env::Default()->SleepForMicroseconds(100000);
+  EXPECT_EQ(file.offsets(), std::vector<size_t>({40, 0, 24}));
+}
+
+TEST(RamFileBlockCacheTest, ReadaheadStopsAtEndOfFile) {
+  const size_t block_size = 8;
+  FakeFile file(12);
+  RamFileBlockCache cache(block_size, 64, 0, file.fetcher(), Env::Default(),
+                          /*readahead_blocks=*/4);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 4, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 4, &out));
+  ASSERT_TRUE(WaitForCacheSize(cache, 12));
+  // Give the readahead the time to (wrongly) fetch past the partial block.
+  Env::Default()->SleepForMicroseconds(100000);
+  EXPECT_EQ(file.offsets(), std::vector<size_t>({0, 8}));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 8, 8, &out));
+  EXPECT_EQ(out, file.Contents(8, 4));
+}
+
+TEST(RamFileBlockCacheTest, RecordsPrefetchWaste) {
+  const size_t block_size = 8;
+  FakeFile file(64);
+  FakeFileBlockCacheStats stats;
+  RamFileBlockCache cache(block_size, 64, 0, file.fetcher(), Env::Default(),
+                          /*readahead_blocks=*/2);
+  cache.SetStats(&stats);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 4, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 4, &out));
+  ASSERT_TRUE(WaitForCacheSize(cache, 24));
+  // Only one of the two prefetched blocks is read before the file is removed.
+  // The read does not continue the previous one, so it prefetches nothing.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 9, 4, &out));
+  cache.RemoveFile("a");
+  EXPECT_EQ(stats.prefetch_waste_bytes_, 8);
+}
+
+TEST(RamFileBlockCacheTest, ParallelBlockFetches) {
+  // This fetcher won't respond until `callers` threads are calling it
+  // concurrently, or 10 seconds have elapsed.
+  const int callers = 4;
+  const size_t block_size = 8;
+  FakeFile file(28);
+  BlockingCounter counter(callers);
+  auto fetcher = [&counter, &file](const string& filename, size_t offset,
+                                   size_t n, char* buffer,
+                                   size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    return file.fetcher()(filename, offset, n, buffer, bytes_transferred);
+  };
+  RamFileBlockCache cache(block_size, 64, 0, fetcher, Env::Default(),
+                          /*readahead_blocks=*/0,
+                          /*max_parallel_fetches=*/callers);
+  std::vector<char> out;
+  // The file ends within the last block of the read.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 32, &out));
+  EXPECT_EQ(out, file.Contents(0, 32));
+  // The partial block is still consistent with the rest of the cache.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 24, 8, &out));
+  EXPECT_EQ(out, file.Contents(24, 8));
+  EXPECT_EQ(file.offsets().size(), callers);
+}
+
+TEST(RamFileBlockCacheTest, ParallelFetchesPastEndOfFile) {
+  const size_t block_size = 8;
+  FakeFile file(12);
+  RamFileBlockCache cache(block_size, 64, 0, file.fetcher(), Env::Default(),
+                          /*readahead_blocks=*/0,
+                          /*max_parallel_fetches=*/4);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 32, &out));
+  EXPECT_EQ(out, file.Contents(0, 32));
+  // Only the blocks up to the end of the file are kept.
+  EXPECT_EQ(cache.CacheSize(), 12);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 8, 8, &out));
+  EXPECT_EQ(out, file.Contents(8, 8));
+}
+
+TEST(RamFileBlockCacheTest, ParallelPassThrough) {
+  // A read larger than the cache is split into block-sized range requests,
+  // issued concurrently.
+  const int callers = 5;
+  const size_t block_size = 8;
+  FakeFile file(36);
+  BlockingCounter counter(callers);
+  auto fetcher = [&counter, &file](const string& filename, size_t offset,
+                                   size_t n, char* buffer,
+                                   size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    return file.fetcher()(filename, offset, n, buffer, bytes_transferred);
+  };
+  RamFileBlockCache cache(block_size, 16, 0, fetcher, Env::Default(),
+                          /*readahead_blocks=*/0,
+                          /*max_parallel_fetches=*/callers);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 2, 40, &out));
+  EXPECT_EQ(out, file.Contents(2, 40));
+  EXPECT_EQ(cache.CacheSize(), 0);
+}
+
 }  // namespace
 }  // namespace tsl
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_PLATFORM_CPU_INFO_H_
 
 #include <string>
+#include <vector>
 
 // TODO(ahentz): This is not strictly required here but, for historical
 // reasons, many people depend on cpu_info.h in order to use kLittleEndian.
@@ -64,6 +65,10 @@ int NumTotalCPUs();
 // identified.  If successful, the return value will be in [0, NumTotalCPUs()).
 int GetCurrentCPU();
 
+// If possible sets the affinity of the current thread to the given CPUs, whose
+// ids are in [0, NumTotalCPUs()). Returns false if it isn't supported or fails.
+bool SetCurrentThreadCpuAffinity(const std::vector<int>& cpus);
+
 // Returns an estimate of the number of hyperthreads per physical core
 // on the CPU
 int NumHyperthreadsPerCore();
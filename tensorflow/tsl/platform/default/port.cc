@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/base/internal/sysinfo.h"
 #include "tensorflow/tsl/platform/cpu_info.h"
 #include "tensorflow/tsl/platform/logging.h"
@@ -162,6 +165,26 @@ int GetCurrentCPU() {
   return kUnknownCPU;
 }
 
+bool SetCurrentThreadCpuAffinity(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  if (cpus.empty()) return false;
+  const int num_cpus = *std::max_element(cpus.begin(), cpus.end()) + 1;
+  const size_t setsize = CPU_ALLOC_SIZE(num_cpus);
+  cpu_set_t* mask = CPU_ALLOC(num_cpus);
+  if (!mask) return false;
+  CPU_ZERO_S(setsize, mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0) CPU_SET_S(cpu, setsize, mask);
+  }
+  // A pid of 0 sets the affinity of the calling thread.
+  const bool success = sched_setaffinity(0, setsize, mask) == 0;
+  CPU_FREE(mask);
+  return success;
+#else
+  return false;
+#endif
+}
+
 int NumHyperthreadsPerCore() {
   static const int ht_per_core = tsl::port::CPUIDNumSMT();
   return (ht_per_core > 0) ? ht_per_core : 1;
@@ -29,6 +29,8 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+
 #include "tensorflow/tsl/platform/default/posix_file_system.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
@@ -45,11 +47,21 @@ using ::tsl::errors::IOError;
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(__linux__)
+// Reads of at least 64KB are followed by a hint to read ahead the next bytes,
+// see PosixRandomAccessFile::Read().
+constexpr size_t kPosixReadAheadMinSize = 64 * 1024;
+#endif
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
   string filename_;
   int fd_;
+#if defined(__linux__)
+  // The offset right after the last read, to tell sequential reads apart.
+  mutable std::atomic<uint64> next_read_offset_{0};
+#endif
 
  public:
   PosixRandomAccessFile(const string& fname, int fd)
@@ -67,6 +79,20 @@ class PosixRandomAccessFile : public RandomAccessFile {
 
   Status Read(uint64 offset, size_t n, StringPiece* result,
               char* scratch) const override {
+#if defined(__linux__)
+    // A large read from the start of the file or from where the previous read
+    // ended, e.g. by an InputBuffer, is likely to be followed by a read of the
+    // next `n` bytes. Let the kernel fetch them while the caller processes
+    // these, instead of only when they are read, which can be well past the
+    // default readahead window of the kernel. This is only a hint, so errors
+    // are ignored.
+    if (n >= kPosixReadAheadMinSize &&
+        next_read_offset_.exchange(offset + n, std::memory_order_relaxed) ==
+            offset) {
+      posix_fadvise(fd_, static_cast<off_t>(offset + n), static_cast<off_t>(n),
+                    POSIX_FADV_WILLNEED);
+    }
+#endif
     Status s;
     char* dst = scratch;
     while (n > 0 && s.ok()) {
@@ -97,6 +123,20 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+#if defined(__linux__)
+  Status ReadV(absl::Span<ReadRange> ranges) const override {
+    // Lets the kernel fetch all the ranges at once, so that they are mostly
+    // read from the page cache one by one below.
+    for (const ReadRange& range : ranges) {
+      if (range.n > 0) {
+        posix_fadvise(fd_, static_cast<off_t>(range.offset),
+                      static_cast<off_t>(range.n), POSIX_FADV_WILLNEED);
+      }
+    }
+    return RandomAccessFile::ReadV(ranges);
+  }
+#endif
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
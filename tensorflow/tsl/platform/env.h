@@ -598,6 +598,11 @@ struct ThreadOptions {
   /// Guard area size to use near thread stacks to use (in bytes)
   size_t guard_size = 0;  // 0: use system default value
   int numa_node = port::kNUMANoAffinity;
+  /// If not empty, the threads of a ThreadPool are split into contiguous
+  /// groups, one per set of CPUs. The threads of a group only run on its CPUs,
+  /// and steal work from the other threads of the group first, e.g. to keep
+  /// threads sharing a L3 cache together. Ignored by Env::StartThread.
+  std::vector<std::vector<int>> cpu_sets;
 };
 
 /// A utility routine: copy contents of `src` in file system `src_fs`
@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/tsl/platform/cord.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/file_statistics.h"
@@ -762,6 +763,36 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// \brief A range of the file to read with `ReadV`.
+  struct ReadRange {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// `scratch[0..n-1]` may be written by `ReadV`, as by `Read`.
+    char* scratch = nullptr;
+    /// Set by `ReadV` to what `Read` would have stored in `*result`.
+    StringPiece result;
+    /// Set by `ReadV` to what `Read` would have returned.
+    tsl::Status status;
+  };
+
+  /// \brief Reads each of `ranges` as `Read` does.
+  ///
+  /// Implementations may read the ranges concurrently, or merge them into
+  /// fewer reads, so that callers can read many ranges at once without a
+  /// thread per range. The default implementation reads them one by one.
+  ///
+  /// Returns the first non-OK status of the ranges, if any.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual tsl::Status ReadV(absl::Span<ReadRange> ranges) const {
+    tsl::Status status;
+    for (ReadRange& range : ranges) {
+      range.status = Read(range.offset, range.n, &range.result, range.scratch);
+      status.Update(range.status);
+    }
+    return status;
+  }
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
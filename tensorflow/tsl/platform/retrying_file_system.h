@@ -189,6 +189,23 @@ class RetryingRandomAccessFile : public RandomAccessFile {
         retry_config_);
   }
 
+  Status ReadV(absl::Span<ReadRange> ranges) const override {
+    Status status = base_file_->ReadV(ranges);
+    if (status.ok()) {
+      return status;
+    }
+    // Retries the ranges that failed one by one.
+    status = OkStatus();
+    for (ReadRange& range : ranges) {
+      if (!range.status.ok() && !errors::IsOutOfRange(range.status)) {
+        range.status =
+            Read(range.offset, range.n, &range.result, range.scratch);
+      }
+      status.Update(range.status);
+    }
+    return status;
+  }
+
  private:
   std::unique_ptr<RandomAccessFile> base_file_;
   const RetryConfig retry_config_;
@@ -250,6 +250,46 @@ TEST(RetryingFileSystemTest, NewRandomAccessFile_SuccessWith3rdTry) {
   TF_EXPECT_OK(random_access_file->Read(0, 10, &result, scratch));
 }
 
+TEST(RetryingFileSystemTest, NewRandomAccessFile_ReadVRetriesFailedRanges) {
+  // Configure the mock base random access file: the second range fails when
+  // all the ranges are read, and then on its first retry.
+  ExpectedCalls expected_file_calls(
+      {std::make_tuple("Read", OkStatus()),
+       std::make_tuple("Read", errors::Unavailable("Something is wrong")),
+       std::make_tuple("Read", errors::OutOfRange("EOF")),
+       std::make_tuple("Read", errors::Unavailable("Wrong again")),
+       std::make_tuple("Read", OkStatus())});
+  std::unique_ptr<RandomAccessFile> base_file(
+      new MockRandomAccessFile(expected_file_calls));
+
+  // Configure the mock base file system.
+  ExpectedCalls expected_fs_calls(
+      {std::make_tuple("NewRandomAccessFile", OkStatus())});
+  std::unique_ptr<MockFileSystem> base_fs(
+      new MockFileSystem(expected_fs_calls));
+  base_fs->random_access_file_to_return = std::move(base_file);
+  RetryingFileSystem<MockFileSystem> fs(
+      std::move(base_fs), RetryConfig(0 /* init_delay_time_us */));
+
+  // Retrieve the wrapped random access file.
+  std::unique_ptr<RandomAccessFile> random_access_file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("filename.txt", nullptr, &random_access_file));
+
+  // Use it and check the results: only the range at EOF isn't retried.
+  char scratch[30];
+  RandomAccessFile::ReadRange ranges[3];
+  for (int i = 0; i < 3; ++i) {
+    ranges[i].offset = i * 10;
+    ranges[i].n = 10;
+    ranges[i].scratch = scratch + i * 10;
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(random_access_file->ReadV(ranges)));
+  TF_EXPECT_OK(ranges[0].status);
+  TF_EXPECT_OK(ranges[1].status);
+  EXPECT_TRUE(errors::IsOutOfRange(ranges[2].status));
+}
+
 TEST(RetryingFileSystemTest, NewRandomAccessFile_AllRetriesFailed) {
   // Configure the mock base random access file.
   ExpectedCalls expected_file_calls = CreateRetriableErrors("Read", 11);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/context.h"
+#include "tensorflow/tsl/platform/cpu_info.h"
 #include "tensorflow/tsl/platform/denormal.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/mutex.h"
@@ -40,6 +41,17 @@ namespace tsl {
 
 namespace thread {
 
+namespace {
+
+// Returns the index of the set of CPUs of ThreadOptions::cpu_sets that the
+// thread with the given index is bound to. The threads of each set are
+// contiguous.
+int CpuSetOfThread(int thread, int num_threads, int num_cpu_sets) {
+  return static_cast<int64_t>(thread) * num_cpu_sets / num_threads;
+}
+
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
@@ -54,12 +66,24 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  const int num_threads_;
+  // The number of threads created so far, Eigen creates them in order.
+  int num_created_threads_ = 0;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name, int num_threads)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        num_threads_(num_threads) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
+    const std::vector<int>* cpu_set = nullptr;
+    if (!thread_options_.cpu_sets.empty()) {
+      cpu_set = &thread_options_.cpu_sets[CpuSetOfThread(
+          num_created_threads_, num_threads_, thread_options_.cpu_sets.size())];
+    }
+    ++num_created_threads_;
     return env_->StartThread(thread_options_, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
@@ -68,6 +92,9 @@ struct EigenEnvironment {
       if (thread_options_.numa_node != port::kNUMANoAffinity) {
         port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
       }
+      if (cpu_set != nullptr && !port::SetCurrentThreadCpuAffinity(*cpu_set)) {
+        VLOG(1) << "Could not set the CPU affinity of a thread of " << name_;
+      }
       f();
     });
   }
@@ -115,8 +142,23 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
 
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name, num_threads)));
   underlying_threadpool_ = eigen_threadpool_.get();
+  if (!thread_options.cpu_sets.empty()) {
+    // Each thread steals work from the threads bound to the same CPUs first.
+    const int num_cpu_sets = thread_options.cpu_sets.size();
+    std::vector<std::pair<unsigned, unsigned>> partitions(num_threads);
+    int start = 0;
+    for (int i = 0; i < num_threads; ++i) {
+      const int cpu_set = CpuSetOfThread(i, num_threads, num_cpu_sets);
+      if (i + 1 == num_threads ||
+          CpuSetOfThread(i + 1, num_threads, num_cpu_sets) != cpu_set) {
+        for (int j = start; j <= i; ++j) partitions[j] = {start, i + 1};
+        start = i + 1;
+      }
+    }
+    eigen_threadpool_->SetStealPartitions(partitions);
+  }
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
 }
@@ -103,6 +103,11 @@ int GetCurrentCPU() {
   return GetCurrentProcessorNumber();
 }
 
+bool SetCurrentThreadCpuAffinity(const std::vector<int>& cpus) {
+  // Not yet implemented.
+  return false;
+}
+
 bool NUMAEnabled() {
   // Not yet implemented: coming soon.
   return false;
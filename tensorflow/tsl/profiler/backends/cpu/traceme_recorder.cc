@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <new>
 #include <utility>
@@ -45,6 +46,16 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// Bits of g_record_mode, which tells where TraceMeRecorder::Record() stores the
+// events of a thread.
+constexpr int kRecordSession = 1;     // Into the EventQueue of the thread.
+constexpr int kRecordContinuous = 2;  // Into the EventRing of the thread.
+
+std::atomic<int> g_record_mode(0);
+
+// The number of slots of the EventRings created by continuous recording.
+std::atomic<size_t> g_ring_capacity(1);
+
 // Track events created by ActivityStart and merge their data into events
 // created by ActivityEnd. TraceMe records events in its destructor, so this
 // results in complete events sorted by their end_time in the thread they ended.
@@ -237,6 +248,93 @@ class EventQueue {
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
 };
 
+// A fixed-size ring buffer of Events, which keeps the last Events pushed.
+//
+// Push is only called by the owner thread; Snapshot and Clear are only called
+// by the tracing control thread. Each slot has a state that is claimed with a
+// compare-and-swap before accessing its event, so neither side ever waits for
+// the other: Push drops its event if the control thread is reading the slot it
+// would overwrite, and Snapshot skips a slot that the owner thread is writing.
+class EventRing {
+ public:
+  explicit EventRing(size_t capacity)
+      : capacity_(capacity), slots_(new Slot[capacity]) {}
+
+  // Overwrites the oldest event of the ring. Fast and lock-free.
+  void Push(TraceMeRecorder::Event&& event) {
+    size_t next = next_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[next];
+    int state = slot.state.load(std::memory_order_relaxed);
+    if (TF_PREDICT_FALSE(state == kBusy ||
+                         !slot.state.compare_exchange_strong(
+                             state, kBusy, std::memory_order_acquire))) {
+      return;
+    }
+    slot.event = std::move(event);
+    slot.state.store(kFull, std::memory_order_release);
+    next_.store(next + 1 == capacity_ ? 0 : next + 1,
+                std::memory_order_relaxed);
+  }
+
+  // Removes all events from the ring.
+  void Clear() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      Slot& slot = slots_[i];
+      int state = kFull;
+      if (slot.state.compare_exchange_strong(state, kBusy,
+                                             std::memory_order_acquire)) {
+        slot.event = TraceMeRecorder::Event();
+        slot.state.store(kEmpty, std::memory_order_release);
+      }
+    }
+  }
+
+  // Returns a copy of the events in the ring, from the oldest to the newest.
+  // As in EventQueue::Consume, start events are only passed to
+  // split_event_tracker.
+  TF_MUST_USE_RESULT std::deque<TraceMeRecorder::Event> Snapshot(
+      SplitEventTracker* split_event_tracker) {
+    std::deque<TraceMeRecorder::Event> result;
+    const size_t oldest = next_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < capacity_; ++i) {
+      Slot& slot = slots_[(oldest + i) % capacity_];
+      int state = kFull;
+      if (!slot.state.compare_exchange_strong(state, kBusy,
+                                              std::memory_order_acquire)) {
+        continue;
+      }
+      TraceMeRecorder::Event event = slot.event;
+      slot.state.store(kFull, std::memory_order_release);
+      if (event.IsStart()) {
+        split_event_tracker->AddStart(std::move(event));
+        continue;
+      }
+      result.emplace_back(std::move(event));
+      if (result.back().IsEnd()) {
+        split_event_tracker->AddEnd(&result.back());
+      }
+    }
+    return result;
+  }
+
+ private:
+  // States of a slot.
+  static constexpr int kEmpty = 0;
+  static constexpr int kFull = 1;
+  static constexpr int kBusy = 2;  // Accessed by one of the threads.
+
+  struct Slot {
+    std::atomic<int> state{kEmpty};
+    TraceMeRecorder::Event event;
+  };
+
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  // The slot of the next Push, i.e. of the oldest event. Only written by the
+  // producer thread.
+  std::atomic<size_t> next_{0};
+};
+
 }  // namespace
 
 // To avoid unnecessary synchronization between threads, each thread has a
@@ -251,6 +349,8 @@ class TraceMeRecorder::ThreadLocalRecorder {
     env->GetCurrentThreadName(&info_.name);
   }
 
+  ~ThreadLocalRecorder() { delete ring_.load(std::memory_order_acquire); }
+
   uint32 ThreadId() const { return info_.tid; }
 
   // IsActive is called from the control thread.
@@ -259,21 +359,54 @@ class TraceMeRecorder::ThreadLocalRecorder {
   void SetInactive() { active_.store(0, std::memory_order_release); }
 
   // Record is only called from the owner thread.
-  void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
+  void Record(TraceMeRecorder::Event&& event) {
+    const int mode = g_record_mode.load(std::memory_order_acquire);
+    if (mode & kRecordContinuous) {
+      EventRing* ring = ring_.load(std::memory_order_relaxed);
+      if (TF_PREDICT_FALSE(ring == nullptr)) {
+        ring = new EventRing(g_ring_capacity.load(std::memory_order_relaxed));
+        ring_.store(ring, std::memory_order_release);
+      }
+      if (mode & kRecordSession) {
+        ring->Push(TraceMeRecorder::Event(event));
+      } else {
+        ring->Push(std::move(event));
+        return;
+      }
+    }
+    if (mode & kRecordSession) queue_.Push(std::move(event));
+  }
 
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
   void Clear() { queue_.Clear(); }
 
+  // ClearRing is called from the control thread when continuous recording
+  // starts.
+  void ClearRing() {
+    EventRing* ring = ring_.load(std::memory_order_acquire);
+    if (ring != nullptr) ring->Clear();
+  }
+
   // Consume is called from the control thread when tracing stops.
   TF_MUST_USE_RESULT TraceMeRecorder::ThreadEvents Consume(
       SplitEventTracker* split_event_tracker) {
     return {info_, queue_.Consume(split_event_tracker)};
   }
 
+  // Snapshot is called from the control thread during continuous recording.
+  TF_MUST_USE_RESULT TraceMeRecorder::ThreadEvents Snapshot(
+      SplitEventTracker* split_event_tracker) {
+    EventRing* ring = ring_.load(std::memory_order_acquire);
+    if (ring == nullptr) return {info_, {}};
+    return {info_, ring->Snapshot(split_event_tracker)};
+  }
+
  private:
   TraceMeRecorder::ThreadInfo info_;
   EventQueue queue_;
+  // Created by the owner thread the first time it records continuously.
+  std::atomic<EventRing*> ring_{nullptr};
   std::atomic<int> active_{1};  // std::atomic<bool> is not always lock-free.
 };
 
@@ -354,8 +487,9 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
       result.push_back(std::move(events));
     }
     // We can have an active thread here. If a thread is destroyed while tracing
-    // is active, its ThreadLocalRecorder is kept alive in UnregisterThread.
-    if (!recorder->IsActive()) {
+    // is active, its ThreadLocalRecorder is kept alive in UnregisterThread,
+    // and until continuous recording stops for its ring buffer.
+    if (!recorder->IsActive() && continuous_level_ == kTracingDisabled) {
       threads_.erase(iter++);
     } else {
       ++iter;
@@ -365,18 +499,27 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
   return result;
 }
 
+void TraceMeRecorder::EraseInactiveThreads() {
+  for (auto iter = threads_.begin(); iter != threads_.end();) {
+    if (!iter->second->IsActive()) {
+      threads_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
 bool TraceMeRecorder::StartRecording(int level) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
-  // Change trace_level_ while holding mutex_.
-  int expected = kTracingDisabled;
-  bool started = internal::g_trace_level.compare_exchange_strong(
-      expected, level, std::memory_order_acq_rel);
-  if (started) {
-    // We may have old events in buffers because Record() raced with Stop().
-    Clear();
-  }
-  return started;
+  // Change trace_level_ and the record mode while holding mutex_.
+  const int mode = g_record_mode.load(std::memory_order_relaxed);
+  if (mode & kRecordSession) return false;
+  g_record_mode.store(mode | kRecordSession, std::memory_order_release);
+  internal::g_trace_level.store(level, std::memory_order_release);
+  // We may have old events in buffers because Record() raced with Stop().
+  Clear();
+  return true;
 }
 
 void TraceMeRecorder::Record(Event&& event) {
@@ -387,14 +530,90 @@ void TraceMeRecorder::Record(Event&& event) {
 TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   TraceMeRecorder::Events events;
   mutex_lock lock(mutex_);
-  // Change trace_level_ while holding mutex_.
-  if (internal::g_trace_level.exchange(
-          kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
+  // Change trace_level_ and the record mode while holding mutex_.
+  const int mode = g_record_mode.load(std::memory_order_relaxed);
+  if (mode & kRecordSession) {
+    internal::g_trace_level.store(continuous_level_, std::memory_order_release);
+    g_record_mode.store(mode & ~kRecordSession, std::memory_order_release);
     events = Consume();
   }
   return events;
 }
 
+bool TraceMeRecorder::StartContinuousRecording(int level,
+                                               size_t events_per_thread) {
+  level = std::max(0, level);
+  mutex_lock lock(mutex_);
+  const int mode = g_record_mode.load(std::memory_order_relaxed);
+  if (mode & kRecordContinuous) return false;
+  continuous_level_ = level;
+  g_ring_capacity.store(std::max<size_t>(1, events_per_thread),
+                        std::memory_order_relaxed);
+  for (auto& id_and_recorder : threads_) {
+    id_and_recorder.second->ClearRing();
+  }
+  g_record_mode.store(mode | kRecordContinuous, std::memory_order_release);
+  // A recording session keeps its own level until it stops.
+  if (!(mode & kRecordSession)) {
+    internal::g_trace_level.store(level, std::memory_order_release);
+  }
+  return true;
+}
+
+void TraceMeRecorder::StopContinuousRecording() {
+  mutex_lock lock(mutex_);
+  const int mode = g_record_mode.load(std::memory_order_relaxed);
+  if (!(mode & kRecordContinuous)) return;
+  continuous_level_ = kTracingDisabled;
+  g_record_mode.store(mode & ~kRecordContinuous, std::memory_order_release);
+  if (!(mode & kRecordSession)) {
+    internal::g_trace_level.store(kTracingDisabled, std::memory_order_release);
+    EraseInactiveThreads();
+  }
+}
+
+TraceMeRecorder::Events TraceMeRecorder::SnapshotContinuousRecording(
+    int64_t since_ns) {
+  TraceMeRecorder::Events result;
+  mutex_lock lock(mutex_);
+  result.reserve(threads_.size());
+  const bool session_active =
+      g_record_mode.load(std::memory_order_relaxed) & kRecordSession;
+  SplitEventTracker split_event_tracker;
+  for (auto iter = threads_.begin(); iter != threads_.end();) {
+    auto& recorder = iter->second;
+    TraceMeRecorder::ThreadEvents events =
+        recorder->Snapshot(&split_event_tracker);
+    if (!events.events.empty()) {
+      result.push_back(std::move(events));
+    }
+    // The events of a destroyed thread are only part of one snapshot, unless
+    // a recording session still needs its ThreadLocalRecorder.
+    if (!recorder->IsActive() && !session_active) {
+      threads_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  split_event_tracker.HandleCrossThreadEvents();
+  // Filter out the old events once the split events are merged, as the tracker
+  // points into the events.
+  for (auto& thread : result) {
+    auto& events = thread.events;
+    events.erase(std::remove_if(events.begin(), events.end(),
+                                [since_ns](const Event& event) {
+                                  return event.end_time < since_ns;
+                                }),
+                 events.end());
+  }
+  result.erase(std::remove_if(result.begin(), result.end(),
+                              [](const ThreadEvents& thread) {
+                                return thread.events.empty();
+                              }),
+               result.end());
+  return result;
+}
+
 /*static*/ int64_t TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_TRACEME_RECORDER_H_
 #define TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_TRACEME_RECORDER_H_
 
+#include <stddef.h>
+
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -89,6 +91,28 @@ class TraceMeRecorder {
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Starts continuous recording of TraceMe() into a fixed-size ring buffer per
+  // thread, which keeps the last events_per_thread events of the thread.
+  // Recording sessions (Start/Stop) can run while continuous recording is
+  // active; while a session is active its level applies to both.
+  // Only traces <= level will be recorded.
+  // The ring buffer of a thread is sized the first time the thread records an
+  // event continuously, later calls don't resize it.
+  static bool StartContinuous(int level, size_t events_per_thread) {
+    return Get()->StartContinuousRecording(level, events_per_thread);
+  }
+
+  // Stops continuous recording. The events in the ring buffers are kept until
+  // continuous recording starts again.
+  static void StopContinuous() { Get()->StopContinuousRecording(); }
+
+  // Returns a copy of the events in the ring buffers that ended at or after
+  // since_ns (in ns since the Unix epoch), e.g. the last seconds of execution.
+  // Doesn't stop continuous recording nor remove the events.
+  static Events Snapshot(int64_t since_ns) {
+    return Get()->SnapshotContinuousRecording(since_ns);
+  }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
@@ -120,6 +144,10 @@ class TraceMeRecorder {
   bool StartRecording(int level);
   Events StopRecording();
 
+  bool StartContinuousRecording(int level, size_t events_per_thread);
+  void StopContinuousRecording();
+  Events SnapshotContinuousRecording(int64_t since_ns);
+
   // Clears events from all active threads that were added due to Record
   // racing with StopRecording.
   void Clear() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
@@ -127,6 +155,9 @@ class TraceMeRecorder {
   // Gathers events from all active threads, and clears their buffers.
   TF_MUST_USE_RESULT Events Consume() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Removes the threads that were destroyed while recording was active.
+  void EraseInactiveThreads() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   mutex mutex_;
   // A ThreadLocalRecorder stores trace events. Ownership is shared with
   // ThreadLocalRecorderWrapper, which is allocated in thread_local storage.
@@ -137,6 +168,8 @@ class TraceMeRecorder {
   // stops so the events can be retrieved.
   absl::flat_hash_map<uint32, std::shared_ptr<ThreadLocalRecorder>> threads_
       TF_GUARDED_BY(mutex_);
+  // The level of continuous recording, or kTracingDisabled if it is inactive.
+  int continuous_level_ TF_GUARDED_BY(mutex_) = kTracingDisabled;
 };
 
 }  // namespace profiler
@@ -56,6 +56,42 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, ContinuousKeepsLastEvents) {
+  int64_t start_time = GetCurrentTimeNanos();
+
+  ASSERT_TRUE(TraceMeRecorder::StartContinuous(/*level=*/1,
+                                               /*events_per_thread=*/2));
+  EXPECT_FALSE(TraceMeRecorder::StartContinuous(/*level=*/1,
+                                                /*events_per_thread=*/2));
+  EXPECT_TRUE(TraceMeRecorder::Active(1));
+  TraceMeRecorder::Record({"first", start_time, start_time + 1});
+  TraceMeRecorder::Record({"second", start_time, start_time + 2});
+  TraceMeRecorder::Record({"third", start_time, start_time + 3});
+
+  // A recording session can run during continuous recording.
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  TraceMeRecorder::Record({"during", start_time, start_time + 4});
+  auto results = TraceMeRecorder::Stop();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("during")));
+  EXPECT_TRUE(TraceMeRecorder::Active(1));
+
+  // The snapshot doesn't remove the events.
+  results = TraceMeRecorder::Snapshot(/*since_ns=*/0);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("third"), Named("during")));
+  results = TraceMeRecorder::Snapshot(/*since_ns=*/start_time + 4);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("during")));
+
+  TraceMeRecorder::StopContinuous();
+  EXPECT_FALSE(TraceMeRecorder::Active(1));
+  TraceMeRecorder::Record({"after", start_time, start_time + 5});
+  results = TraceMeRecorder::Snapshot(/*since_ns=*/0);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("third"), Named("during")));
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //